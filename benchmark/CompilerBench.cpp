@@ -0,0 +1,216 @@
+// Benchmarks of the throughput of the analyses and passes that dominate the
+// compile time of kernels, run over a corpus of TTGIR modules.
+//
+// The corpus is the directory of `.mlir` and `.ttgir` files that
+// TRITON_BENCHMARK_CORPUS points to, or the one checked in next to this file.
+// Files may hold several modules separated by `// -----` lines, like lit
+// tests do. Modules dumped from real kernels, e.g. the `.ttgir` files of the
+// cache, make the best corpus.
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "triton/Tools/LinearLayout.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <functional>
+
+using namespace mlir;
+
+namespace {
+
+struct Corpus {
+  MLIRContext context;
+  SmallVector<OwningOpRef<ModuleOp>> modules;
+  // The layouts of the operand and result of each layout conversion of the
+  // modules that have linear layouts.
+  SmallVector<std::pair<triton::LinearLayout, triton::LinearLayout>>
+      conversions;
+
+  Corpus();
+  void load(StringRef path);
+};
+
+Corpus::Corpus() : context(MLIRContext::Threading::DISABLED) {
+  DialectRegistry registry;
+  registry.insert<triton::TritonDialect, triton::gpu::TritonGPUDialect,
+                  triton::nvidia_gpu::TritonNvidiaGPUDialect,
+                  arith::ArithDialect, scf::SCFDialect, math::MathDialect,
+                  cf::ControlFlowDialect, gpu::GPUDialect>();
+  context.appendDialectRegistry(registry);
+  context.loadAllAvailableDialects();
+
+  const char *dir = std::getenv("TRITON_BENCHMARK_CORPUS");
+  if (!dir)
+    dir = TRITON_BENCHMARK_CORPUS;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(dir, ec), end; it != end && !ec;
+       it.increment(ec)) {
+    StringRef ext = llvm::sys::path::extension(it->path());
+    if (ext == ".mlir" || ext == ".ttgir")
+      load(it->path());
+  }
+  if (ec || modules.empty())
+    llvm::errs() << "no TTGIR modules in the corpus at " << dir << "\n";
+
+  for (auto &module : modules) {
+    module->walk([&](triton::gpu::ConvertLayoutOp op) {
+      auto srcTy = op.getSrc().getType();
+      auto dstTy = op.getType();
+      auto src = triton::gpu::toLinearLayout(srcTy.getShape(),
+                                             srcTy.getEncoding());
+      auto dst = triton::gpu::toLinearLayout(dstTy.getShape(),
+                                             dstTy.getEncoding());
+      if (src && dst)
+        conversions.emplace_back(*src, *dst);
+    });
+  }
+}
+
+void Corpus::load(StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    llvm::errs() << "cannot read " << path << "\n";
+    return;
+  }
+  // The modules that don't parse, e.g. the invalid IR of lit tests, are left
+  // out of the corpus rather than reported.
+  ScopedDiagnosticHandler handler(&context,
+                                  [](Diagnostic &) { return success(); });
+  StringRef rest = (*buffer)->getBuffer();
+  while (!rest.empty()) {
+    auto [chunk, next] = rest.split("// -----");
+    if (auto module = parseSourceString<ModuleOp>(chunk, &context))
+      modules.push_back(std::move(module));
+    rest = next;
+  }
+}
+
+Corpus &getCorpus() {
+  static Corpus corpus;
+  return corpus;
+}
+
+// Runs `fn` on a copy of each module of the corpus, for the benchmarks that
+// modify the IR. Copying is left out of the timings.
+void runOnClones(benchmark::State &state,
+                 const std::function<void(ModuleOp)> &fn) {
+  Corpus &corpus = getCorpus();
+  for (auto _ : state) {
+    for (auto &module : corpus.modules) {
+      state.PauseTiming();
+      OwningOpRef<ModuleOp> clone = module->clone();
+      state.ResumeTiming();
+      fn(*clone);
+      state.PauseTiming();
+      clone = nullptr;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.modules.size());
+}
+
+void runPass(benchmark::State &state,
+             const std::function<std::unique_ptr<Pass>()> &createPass) {
+  PassManager pm(&getCorpus().context);
+  pm.addPass(createPass());
+  runOnClones(state, [&](ModuleOp module) {
+    if (failed(pm.run(module)))
+      state.SkipWithError("pass failed on a module of the corpus");
+  });
+}
+
+void BM_AllocationAnalysis(benchmark::State &state) {
+  Corpus &corpus = getCorpus();
+  for (auto _ : state) {
+    for (auto &module : corpus.modules) {
+      ModuleAllocation allocation(*module);
+      benchmark::DoNotOptimize(allocation.getSharedMemorySize());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.modules.size());
+}
+BENCHMARK(BM_AllocationAnalysis)->Unit(benchmark::kMicrosecond);
+
+void BM_MembarAnalysis(benchmark::State &state) {
+  // The analysis inserts barriers, so it runs on copies, whose allocation is
+  // computed outside the timings.
+  Corpus &corpus = getCorpus();
+  for (auto _ : state) {
+    for (auto &module : corpus.modules) {
+      state.PauseTiming();
+      OwningOpRef<ModuleOp> clone = module->clone();
+      auto allocation = std::make_unique<ModuleAllocation>(*clone);
+      state.ResumeTiming();
+      ModuleMembarAnalysis membar(allocation.get());
+      membar.run();
+      state.PauseTiming();
+      allocation = nullptr;
+      clone = nullptr;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.modules.size());
+}
+BENCHMARK(BM_MembarAnalysis)->Unit(benchmark::kMicrosecond);
+
+void BM_ModuleAxisInfoAnalysis(benchmark::State &state) {
+  Corpus &corpus = getCorpus();
+  for (auto _ : state) {
+    for (auto &module : corpus.modules) {
+      ModuleAxisInfoAnalysis analysis(*module);
+      benchmark::DoNotOptimize(&analysis);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.modules.size());
+}
+BENCHMARK(BM_ModuleAxisInfoAnalysis)->Unit(benchmark::kMicrosecond);
+
+void BM_RemoveLayoutConversions(benchmark::State &state) {
+  runPass(state, [] {
+    return triton::gpu::createTritonGPURemoveLayoutConversions();
+  });
+}
+BENCHMARK(BM_RemoveLayoutConversions)->Unit(benchmark::kMicrosecond);
+
+void BM_Pipeline(benchmark::State &state) {
+  int32_t numStages = state.range(0);
+  runPass(state, [=] {
+    return triton::gpu::createTritonGPUPipeline({numStages});
+  });
+}
+BENCHMARK(BM_Pipeline)->Arg(2)->Arg(3)->Arg(4)->Unit(benchmark::kMicrosecond);
+
+void BM_InvertAndCompose(benchmark::State &state) {
+  Corpus &corpus = getCorpus();
+  for (auto _ : state) {
+    for (auto &[src, dst] : corpus.conversions)
+      benchmark::DoNotOptimize(src.invertAndCompose(dst));
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.conversions.size());
+}
+BENCHMARK(BM_InvertAndCompose)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
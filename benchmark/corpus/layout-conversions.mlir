@@ -0,0 +1,170 @@
+// Elementwise, reduction and load chains with layout conversions, from
+// test/TritonGPU/combine.mlir.
+
+#layout0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#layout1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+#layout2 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#layout3 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.target" = "cuda:80"} {
+
+tt.func @cst() -> tensor<1024xi32, #layout1> {
+  %cst = arith.constant dense<0> : tensor<1024xi32, #layout0>
+  %1 = triton_gpu.convert_layout %cst : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  tt.return %1: tensor<1024xi32, #layout1>
+}
+
+tt.func @range() -> tensor<1024xi32, #layout1> {
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #layout0>
+  %1 = triton_gpu.convert_layout %0 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  tt.return %1: tensor<1024xi32, #layout1>
+}
+
+tt.func @splat(%arg0: i32) -> tensor<1024xi32, #layout1> {
+  %0 = tt.splat %arg0 : i32 -> tensor<1024xi32, #layout0>
+  %1 = triton_gpu.convert_layout %0 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  tt.return %1: tensor<1024xi32, #layout1>
+}
+
+tt.func @remat(%arg0: i32) -> tensor<1024xi32, #layout1> {
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #layout0>
+  %1 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #layout0>
+  %2 = arith.muli %0, %1 : tensor<1024xi32, #layout0>
+  %3 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  %4 = tt.splat %arg0 : i32 -> tensor<1024xi32, #layout0>
+  %5 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+  %6 = arith.addi %3, %5 : tensor<1024xi32, #layout1>
+  tt.return %6: tensor<1024xi32, #layout1>
+}
+
+tt.func @remat_single_value(%arg: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %0 = tt.splat %arg : !tt.ptr<i32> -> tensor<1x!tt.ptr<i32>, #layout1>
+  %1 = tt.load %0 : tensor<1x!tt.ptr<i32>, #layout1>
+  %2 = triton_gpu.convert_layout %1 : tensor<1xi32, #layout1> -> tensor<1xi32, #layout0>
+  %3 = triton_gpu.convert_layout %0 : tensor<1x!tt.ptr<i32>, #layout1> -> tensor<1x!tt.ptr<i32>, #layout0>
+  tt.store %3, %2 : tensor<1x!tt.ptr<i32>, #layout0>
+  tt.return
+}
+
+tt.func @remat_fast_load(%arg: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %0 = tt.splat %arg : !tt.ptr<i32> -> tensor<16x!tt.ptr<i32>, #layout1>
+  %1 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32, #layout1>
+  %2 = tt.addptr %0, %1 : tensor<16x!tt.ptr<i32>, #layout1>, tensor<16xi32, #layout1>
+  %3 = tt.load %2 : tensor<16x!tt.ptr<i32>, #layout1>
+  %4 = triton_gpu.convert_layout %3 : tensor<16xi32, #layout1> -> tensor<16xi32, #layout0>
+  %5 = triton_gpu.convert_layout %2 : tensor<16x!tt.ptr<i32>, #layout1> -> tensor<16x!tt.ptr<i32>, #layout0>
+  tt.store %5, %4 : tensor<16x!tt.ptr<i32>, #layout0>
+  tt.return
+}
+
+tt.func @hoist_above_ext(%arg0: tensor<1024xf16, #layout0>, %arg1: f32) -> tensor<1024xf32, #layout1> {
+  %0 = arith.extf %arg0 : tensor<1024xf16, #layout0> to tensor<1024xf32, #layout0>
+  %1 = tt.splat %arg1 : f32 -> tensor<1024xf32, #layout0>
+  %2 = arith.addf %0, %1 : tensor<1024xf32, #layout0>
+  %3 = triton_gpu.convert_layout %2 : tensor<1024xf32, #layout0> -> tensor<1024xf32, #layout1>
+  tt.return %3 : tensor<1024xf32, #layout1>
+}
+
+tt.func @hoist_above_ext2(%arg0: tensor<1024xf16, #layout0>, %arg1: f16) -> tensor<1024xf32, #layout1> {
+  %0 = arith.extf %arg0 : tensor<1024xf16, #layout0> to tensor<1024xf32, #layout0>
+  %1 = tt.splat %arg1 : f16 -> tensor<1024xf16, #layout0>
+  %2 = arith.extf %1 : tensor<1024xf16, #layout0> to tensor<1024xf32, #layout0>
+  %3 = arith.addf %0, %2 : tensor<1024xf32, #layout0>
+  %4 = triton_gpu.convert_layout %3 : tensor<1024xf32, #layout0> -> tensor<1024xf32, #layout1>
+  tt.return %4 : tensor<1024xf32, #layout1>
+}
+
+tt.func @hoist_above_fptofp(%arg0: tensor<1024xf8E4M3FNUZ, #layout0>) -> tensor<1024xf32, #layout1> {
+  %0 = tt.fp_to_fp %arg0, rounding = rtne : tensor<1024xf8E4M3FNUZ, #layout0> -> tensor<1024xf32, #layout0>
+  %1 = triton_gpu.convert_layout %0 : tensor<1024xf32, #layout0> -> tensor<1024xf32, #layout1>
+  tt.return %1 : tensor<1024xf32, #layout1>
+}
+
+tt.func @dont_hoist_above_trunc_fptofp(%arg0: tensor<1024xf32, #layout0>) -> tensor<1024xf8E4M3FNUZ, #layout1> {
+  %0 = tt.fp_to_fp %arg0, rounding = rtne : tensor<1024xf32, #layout0> -> tensor<1024xf8E4M3FNUZ, #layout0>
+  %1 = triton_gpu.convert_layout %0 : tensor<1024xf8E4M3FNUZ, #layout0> -> tensor<1024xf8E4M3FNUZ, #layout1>
+  tt.return %1 : tensor<1024xf8E4M3FNUZ, #layout1>
+}
+
+tt.func @hoist_above_broadcast(%arg0: tensor<1024x1xf32, #layout2>, %arg1: f32) -> tensor<1024x128xf32, #layout3> {
+  %0 = tt.broadcast %arg0 : tensor<1024x1xf32, #layout2> -> tensor<1024x128xf32, #layout2>
+  %1 = tt.splat %arg1 : f32 -> tensor<1024x128xf32, #layout2>
+  %2 = arith.addf %0, %1 : tensor<1024x128xf32, #layout2>
+  %3 = triton_gpu.convert_layout %2 : tensor<1024x128xf32, #layout2> -> tensor<1024x128xf32, #layout3>
+  tt.return %3 : tensor<1024x128xf32, #layout3>
+}
+
+tt.func @if(%arg0: i32, %arg1: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %c32_i32 = arith.constant dense<32> : tensor<1024xi32, #layout1>
+  %0 = tt.get_program_id x : i32
+  %1 = tt.splat %0 : i32 -> tensor<1024xi32, #layout1>
+  %2 = arith.muli %1, %c32_i32 : tensor<1024xi32, #layout1>
+  %3 = arith.addi %2, %c32_i32 : tensor<1024xi32, #layout1>
+  %4 = arith.cmpi sgt, %0, %arg0 : i32
+  %5 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<1024x!tt.ptr<i32>, #layout0>
+  scf.if %4 {
+    %6 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout1> -> tensor<1024xi32, #layout0>
+    tt.store %5, %6 : tensor<1024x!tt.ptr<i32>, #layout0>
+  }
+  tt.return
+}
+
+tt.func @if_convert_else_not(%arg0: i32, %arg1: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %c32_i32 = arith.constant dense<32> : tensor<1024xi32, #layout0>
+  %0 = tt.get_program_id x : i32
+  %1 = tt.splat %0 : i32 -> tensor<1024xi32, #layout0>
+  %9 = tt.splat %0 : i32 -> tensor<1024xi32, #layout1>
+  %2 = arith.muli %1, %c32_i32 : tensor<1024xi32, #layout0>
+  %3 = arith.addi %2, %c32_i32 : tensor<1024xi32, #layout0>
+  %4 = arith.cmpi sgt, %0, %arg0 : i32
+  %5 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<1024x!tt.ptr<i32>, #layout1>
+  %8 = scf.if %4 -> tensor<1024xi32, #layout1> {
+    %6 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+    scf.yield %6 : tensor<1024xi32, #layout1>
+  } else {
+    scf.yield %9 : tensor<1024xi32, #layout1>
+  }
+  tt.store %5, %8 : tensor<1024x!tt.ptr<i32>, #layout1>
+  tt.return
+}
+
+tt.func @if_not_else_convert(%arg0: i32, %arg1: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %c32_i32 = arith.constant dense<32> : tensor<1024xi32, #layout0>
+  %0 = tt.get_program_id x : i32
+  %1 = tt.splat %0 : i32 -> tensor<1024xi32, #layout0>
+  %9 = tt.splat %0 : i32 -> tensor<1024xi32, #layout1>
+  %2 = arith.muli %1, %c32_i32 : tensor<1024xi32, #layout0>
+  %3 = arith.addi %2, %c32_i32 : tensor<1024xi32, #layout0>
+  %4 = arith.cmpi sgt, %0, %arg0 : i32
+  %5 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<1024x!tt.ptr<i32>, #layout1>
+  %8 = scf.if %4 -> tensor<1024xi32, #layout1> {
+    scf.yield %9 : tensor<1024xi32, #layout1>
+  } else {
+    %7 = triton_gpu.convert_layout %3 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+    scf.yield %7 : tensor<1024xi32, #layout1>
+  }
+  tt.store %5, %8 : tensor<1024x!tt.ptr<i32>, #layout1>
+  tt.return
+}
+
+tt.func @if_else_both_convert(%arg0: i32, %arg1: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+  %c32_i32 = arith.constant dense<32> : tensor<1024xi32, #layout0>
+  %0 = tt.get_program_id x : i32
+  %1 = tt.splat %0 : i32 -> tensor<1024xi32, #layout0>
+  %2 = arith.muli %1, %c32_i32 : tensor<1024xi32, #layout0>
+  %3 = arith.addi %2, %c32_i32 : tensor<1024xi32, #layout0>
+  %4 = arith.cmpi sgt, %0, %arg0 : i32
+  %5 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<1024x!tt.ptr<i32>, #layout1>
+  %8 = scf.if %4 -> tensor<1024xi32, #layout1> {
+    %6 = triton_gpu.convert_layout %2 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+    scf.yield %6 : tensor<1024xi32, #layout1>
+  } else {
+    %7 = triton_gpu.convert_layout %3 : tensor<1024xi32, #layout0> -> tensor<1024xi32, #layout1>
+    scf.yield %7 : tensor<1024xi32, #layout1>
+  }
+  tt.store %5, %8 : tensor<1024x!tt.ptr<i32>, #layout1>
+  tt.return
+}
+
+}
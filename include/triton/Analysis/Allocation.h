@@ -12,6 +12,7 @@
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include <atomic>
 #include <limits>
+#include <optional>
 
 namespace mlir {
 
@@ -54,6 +55,16 @@ private:
 
 template <class T> Interval(T, T) -> Interval<T>;
 
+/// Strategies for assigning shared memory offsets to buffers.
+/// Greedy: first-fit placement followed by graph coloring.
+/// BestFit: places buffers by decreasing size and lifetime and, for small
+/// buffer counts, refines the placement with a bounded branch-and-bound search.
+enum class AllocationStrategy { Greedy, BestFit };
+
+/// Parses the textual name of an allocation strategy ("greedy" or
+/// "best-fit").
+std::optional<AllocationStrategy> parseAllocationStrategy(StringRef name);
+
 class Allocation {
 public:
   /// A unique identifier for shared memory buffers
@@ -67,7 +78,9 @@ public:
   Allocation() = default;
   /// Creates a new Allocation analysis that computes the shared memory
   /// information for all associated shared memory values.
-  explicit Allocation(Operation *operation) : operation(operation) {}
+  explicit Allocation(Operation *operation,
+                      AllocationStrategy strategy = AllocationStrategy::Greedy)
+      : operation(operation), strategy(strategy) {}
 
   /// Runs allocation analysis on the given top-level operation.
   void run(FuncAllocMapT &funcAllocMap);
@@ -135,6 +148,14 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns the maximum number of bytes that are live at the same time.
+  /// This is a lower bound of getSharedMemorySize(); the difference is the
+  /// fragmentation cost of the allocation strategy.
+  size_t getPeakLiveSize() const { return peakLiveSize; }
+
+  /// Returns the strategy used to place the buffers.
+  AllocationStrategy getStrategy() const { return strategy; }
+
 private:
   /// A class that represents a shared memory buffer
   struct BufferT {
@@ -195,12 +216,14 @@ private:
 
 private:
   Operation *operation = nullptr;
+  AllocationStrategy strategy = AllocationStrategy::Greedy;
   OpScratchMapT opScratch;
   OpScratchMapT opVirtual;
   ValueBufferMapT valueBuffer;
   AliasBufferMapT aliasBuffer;
   BufferSetT bufferSet;
   size_t sharedMemorySize = 0;
+  size_t peakLiveSize = 0;
 
   friend class triton::AllocationAnalysis;
 };
@@ -211,18 +234,29 @@ private:
 /// Each call op is treated like convert_layout that allocates a scratch buffer.
 /// At each call, we compute the start offset of the scratch buffer and pass it
 /// as an argument to the callee.
+///
+/// The strategy is read from the `triton_gpu.allocation-strategy` module
+/// attribute when it is not given explicitly, so that every pass re-running
+/// the analysis observes the offsets assigned by the allocate-shared-memory
+/// pass.
 class ModuleAllocation : public CallGraph<Allocation> {
 public:
   using FuncOffsetMapT = DenseMap<FunctionOpInterface, Value>;
 
+  static constexpr char kStrategyAttrName[] = "triton_gpu.allocation-strategy";
+
   explicit ModuleAllocation(ModuleOp moduleOp)
+      : ModuleAllocation(moduleOp, getStrategy(moduleOp)) {}
+
+  ModuleAllocation(ModuleOp moduleOp, AllocationStrategy strategy)
       : CallGraph<Allocation>(moduleOp) {
     walk<WalkOrder::PreOrder, WalkOrder::PostOrder>(
         // Pre-order edge walk callback
         [](CallOpInterface callOp, FunctionOpInterface funcOp) {},
         // Post-order node walk callback
         [&](FunctionOpInterface funcOp) {
-          auto [iter, inserted] = funcMap.try_emplace(funcOp, funcOp);
+          auto [iter, inserted] =
+              funcMap.try_emplace(funcOp, funcOp, strategy);
           if (inserted)
             iter->second.run(funcMap);
         });
@@ -249,6 +283,14 @@ public:
     return sharedMemoryValue[funcOp];
   }
 
+  /// Returns the strategy recorded on the module, or Greedy if there is none.
+  static AllocationStrategy getStrategy(ModuleOp moduleOp) {
+    if (auto attr = moduleOp->getAttrOfType<StringAttr>(kStrategyAttrName))
+      if (auto strategy = parseAllocationStrategy(attr.getValue()))
+        return *strategy;
+    return AllocationStrategy::Greedy;
+  }
+
 private:
   FuncOffsetMapT sharedMemoryValue;
 };
@@ -12,6 +12,7 @@
 
 #include <optional>
 #include <type_traits>
+#include <utility>
 
 namespace mlir::triton {
 
@@ -23,6 +24,7 @@ namespace mlir::triton {
 class AxisInfo {
 public:
   typedef SmallVector<int64_t> DimVectorT;
+  typedef std::pair<int64_t, int64_t> RangeT;
 
 public:
   AxisInfo() : AxisInfo({}, {}, {}) {}
@@ -31,9 +33,10 @@ public:
       : AxisInfo(contiguity, divisibility, constancy, std::nullopt) {}
 
   AxisInfo(DimVectorT contiguity, DimVectorT divisibility, DimVectorT constancy,
-           std::optional<int64_t> constantValue)
+           std::optional<int64_t> constantValue,
+           std::optional<RangeT> range = std::nullopt)
       : contiguity(contiguity), divisibility(divisibility),
-        constancy(constancy), constantValue(constantValue) {
+        constancy(constancy), constantValue(constantValue), range(range) {
     assert(divisibility.size() == contiguity.size());
     assert(constancy.size() == contiguity.size());
   }
@@ -111,6 +114,16 @@ public:
 
   std::optional<int64_t> getConstantValue() const { return constantValue; }
 
+  // range is an interval [min, max] that contains all the elements, read as
+  // signed integers of the bitwidth of their type. It is not tracked for
+  // pointers and i1 values.
+  //
+  // For example, tt.make_range {start = 0, end = 128} has range [0, 127].
+  //
+  // This allows proving comparisons such as the masks `offs < N` of interior
+  // tiles always true.
+  std::optional<RangeT> getRange() const { return range; }
+
   template <class T>
   static void
   initPessimisticStateFromFunc(int argNumber, T funcOp, DimVectorT *contiguity,
@@ -119,12 +132,13 @@ public:
   bool operator==(const AxisInfo &other) const {
     return contiguity == other.contiguity &&
            divisibility == other.divisibility && constancy == other.constancy &&
-           constantValue == other.constantValue;
+           constantValue == other.constantValue && range == other.range;
   }
 
   static AxisInfo getPessimisticValueState(Value value);
 
-  // The gcd of both arguments for each dimension
+  // The gcd of both arguments for each dimension, the range is kept only if it
+  // is the same for both
   static AxisInfo join(const AxisInfo &lhs, const AxisInfo &rhs);
 
   void print(raw_ostream &os) const {
@@ -141,6 +155,11 @@ public:
       os << *constantValue;
     else
       os << "<none>";
+    os << ", range = ";
+    if (range)
+      os << "[" << range->first << ", " << range->second << "]";
+    else
+      os << "<none>";
   }
 
 private:
@@ -150,6 +169,9 @@ private:
 
   // The constant value of the lattice if we can infer it.
   std::optional<int64_t> constantValue;
+
+  // The range of the values of the lattice if we can infer it.
+  std::optional<RangeT> range;
 };
 
 // Module level axis info analysis based on the call graph, assuming that we do
@@ -187,6 +209,12 @@ public:
     }
   }
 
+  /// Allows the analysis to be cached by the pass manager with
+  /// getAnalysis<ModuleAxisInfoAnalysis>() and reused by later passes that
+  /// preserve it.
+  explicit ModuleAxisInfoAnalysis(Operation *op)
+      : ModuleAxisInfoAnalysis(cast<ModuleOp>(op)) {}
+
   AxisInfo *getAxisInfo(Value value) {
     auto funcOp =
         value.getParentRegion()->getParentOfType<FunctionOpInterface>();
@@ -205,6 +233,14 @@ public:
   unsigned getPtrAlignment(Value ptr);
   unsigned getMaskAlignment(Value mask);
 
+  /// Incremental updates for passes that rewrite ops without changing the
+  /// values they compute, e.g. cloning an op with a different encoding.
+  /// Axis info does not depend on the layout, so `to` gets the info of `from`.
+  void copyAxisInfo(Value from, Value to);
+  /// Drop the info of the results of `op` before it is erased, so that ops
+  /// created later at the same address don't pick it up.
+  void eraseAxisInfo(Operation *op);
+
 private:
   void initialize(FunctionOpInterface funcOp);
   void update(CallOpInterface callOp, FunctionOpInterface funcOp);
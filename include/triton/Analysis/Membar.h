@@ -5,6 +5,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 
 #include <set>
+#include <tuple>
 
 namespace mlir {
 
@@ -14,8 +15,38 @@ struct BlockInfo {
   using BufferIdSetT = Allocation::BufferIdSetT;
   using IntervalSetT = std::set<Interval<size_t>>;
 
+  /// An access moving a tensor between registers and a memory descriptor, for
+  /// which the warp accessing each element is known from the tensor layout.
+  struct WarpAccess {
+    Interval<size_t> interval;
+    bool isWrite;
+    Value memDesc;
+    RankedTensorType tensorType;
+    /// The access is already ordered with the later accesses of the warps of
+    /// its group of this many consecutive warps, 0 if it is not.
+    unsigned syncedWarps = 0;
+
+    bool operator<(const WarpAccess &other) const {
+      return std::make_tuple(interval, isWrite,
+                             memDesc.getAsOpaquePointer(),
+                             tensorType.getAsOpaquePointer(), syncedWarps) <
+             std::make_tuple(other.interval, other.isWrite,
+                             other.memDesc.getAsOpaquePointer(),
+                             other.tensorType.getAsOpaquePointer(),
+                             other.syncedWarps);
+    }
+    bool operator==(const WarpAccess &other) const {
+      return !(*this < other) && !(other < *this);
+    }
+  };
+
   IntervalSetT syncReadIntervals;
   IntervalSetT syncWriteIntervals;
+  /// Pending accesses whose warps are known. They are not part of the
+  /// interval sets above.
+  std::set<WarpAccess> warpAccesses;
+  /// Whether there is a path from the function entry without any barrier.
+  bool unsyncedSinceEntry = false;
 
   BlockInfo() = default;
 
@@ -25,9 +56,38 @@ struct BlockInfo {
                              other.syncReadIntervals.end());
     syncWriteIntervals.insert(other.syncWriteIntervals.begin(),
                               other.syncWriteIntervals.end());
+    warpAccesses.insert(other.warpAccesses.begin(), other.warpAccesses.end());
+    unsyncedSinceEntry |= other.unsyncedSinceEntry;
     return *this;
   }
 
+  /// Returns the intervals moved by the given number of bytes, e.g. from the
+  /// shared memory of a callee to the scratch buffer of its call. The warps
+  /// of the accesses are not tracked across functions.
+  BlockInfo shift(size_t offset) const {
+    BlockInfo shifted;
+    auto shiftInterval = [&](const Interval<size_t> &interval) {
+      return Interval<size_t>(interval.start() + offset,
+                              interval.end() + offset);
+    };
+    for (auto &interval : syncReadIntervals)
+      shifted.syncReadIntervals.insert(shiftInterval(interval));
+    for (auto &interval : syncWriteIntervals)
+      shifted.syncWriteIntervals.insert(shiftInterval(interval));
+    for (auto &access : warpAccesses) {
+      auto &intervals = access.isWrite ? shifted.syncWriteIntervals
+                                       : shifted.syncReadIntervals;
+      intervals.insert(shiftInterval(access.interval));
+    }
+    return shifted;
+  }
+
+  /// Returns the number of consecutive warps that a barrier between the
+  /// accesses of this BlockInfo and the later accesses of other has to
+  /// synchronize: 0 if no barrier is needed, and numWarps if all the warps of
+  /// the CTA have to be synchronized.
+  unsigned getNumWarpsToSync(const BlockInfo &other, unsigned numWarps) const;
+
   /// Returns true if intervals in two BlockInfo objects are intersected.
   bool isIntersected(const BlockInfo &other) const {
     return /*RAW*/ isIntersected(syncWriteIntervals, other.syncReadIntervals) ||
@@ -41,12 +101,27 @@ struct BlockInfo {
   void sync() {
     syncReadIntervals.clear();
     syncWriteIntervals.clear();
+    warpAccesses.clear();
+    unsyncedSinceEntry = false;
+  }
+
+  /// Orders the accesses whose warps are known within groups of numWarps
+  /// consecutive warps, because a named barrier is inserted.
+  void syncWarps(unsigned numWarps) {
+    std::set<WarpAccess> synced;
+    for (WarpAccess access : warpAccesses) {
+      access.syncedWarps = std::max(access.syncedWarps, numWarps);
+      synced.insert(access);
+    }
+    warpAccesses = std::move(synced);
   }
 
   /// Compares two BlockInfo objects.
   bool operator==(const BlockInfo &other) const {
     return syncReadIntervals == other.syncReadIntervals &&
-           syncWriteIntervals == other.syncWriteIntervals;
+           syncWriteIntervals == other.syncWriteIntervals &&
+           warpAccesses == other.warpAccesses &&
+           unsyncedSinceEntry == other.unsyncedSinceEntry;
   }
 
   bool operator!=(const BlockInfo &other) const { return !(*this == other); }
@@ -62,12 +137,27 @@ private:
   }
 };
 
+/// Summary of the shared memory accesses of a function, relative to its own
+/// shared memory base, used to place the barriers around its calls.
+struct FuncBlockInfo {
+  /// Accesses that may happen before the first barrier of the function. A
+  /// barrier is needed before the call only if they conflict with the
+  /// pending accesses of the caller.
+  BlockInfo entry;
+  /// Accesses that may still be pending when the function returns.
+  BlockInfo exit;
+  /// Whether the function may return without executing any barrier, in
+  /// which case the pending accesses of the caller are still pending after
+  /// the call.
+  bool mayReturnUnsynced = false;
+};
+
 //===----------------------------------------------------------------------===//
 // Shared Memory Barrier Analysis
 //===----------------------------------------------------------------------===//
 class MembarAnalysis {
 public:
-  using FuncBlockInfoMapT = CallGraph<BlockInfo>::FuncDataMapT;
+  using FuncBlockInfoMapT = CallGraph<FuncBlockInfo>::FuncDataMapT;
   /// Creates a new Membar analysis that generates the shared memory barrier
   /// in the following circumstances:
   /// - RAW: If a shared memory write is followed by a shared memory read, and
@@ -81,13 +171,32 @@ public:
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
   /// analysis.
+  ///
+  /// In precise mode, accesses through a memdesc_subview with constant
+  /// offsets only cover the selected slices of a multi-buffered allocation,
+  /// so that accesses to different slices are not considered intersected.
+  /// Subviews with a non-constant offset, such as the loop-carried stage
+  /// index of the software pipeliner, still cover the whole allocation:
+  /// proving that two such indices differ would need symbolic reasoning over
+  /// the loop, which intervals cannot express.
+  ///
+  /// With named barriers, a local_store or local_alloc followed by a
+  /// local_load of the same memory descriptor (or the reverse) is only
+  /// synchronized within the groups of warps that exchange elements, as
+  /// determined by the layouts of the tensors, using a named_barrier.
   MembarAnalysis() = default;
-  explicit MembarAnalysis(Allocation *allocation) : allocation(allocation) {}
+  explicit MembarAnalysis(Allocation *allocation, bool precise = false,
+                          bool namedBarriers = false)
+      : allocation(allocation), precise(precise),
+        namedBarriers(namedBarriers) {}
 
   /// Runs the membar analysis to the given operation, inserts a barrier if
   /// necessary.
   void run(FuncBlockInfoMapT &funcBlockInfoMap);
 
+  /// Returns the number of barriers inserted by the last run.
+  unsigned getNumInsertedBarriers() const { return numInsertedBarriers; }
+
 private:
   /// Applies the barrier analysis based on the SCF dialect, in which each
   /// region has a single basic block only.
@@ -113,22 +222,40 @@ private:
   /// Collects the successors of the terminator
   void visitTerminator(Operation *operation, SmallVector<Block *> &successors);
 
-  void insertBarrier(Operation *operation, OpBuilder *builder);
+  /// Inserts a barrier synchronizing groups of numWarpsToSync warps before
+  /// the operation, and updates blockInfo accordingly.
+  void insertBarrier(Operation *operation, OpBuilder *builder,
+                     BlockInfo *blockInfo, unsigned numWarpsToSync);
+
+  /// Returns the shared memory interval of the given buffer that is accessed
+  /// through value.
+  Interval<size_t> getAccessInterval(Value value,
+                                     Allocation::BufferId bufferId) const;
 
 private:
   Allocation *allocation = nullptr;
+  bool precise = false;
+  bool namedBarriers = false;
+  unsigned numWarps = 1;
+  unsigned numInsertedBarriers = 0;
+  /// Accesses of the function that may happen before its first barrier.
+  BlockInfo entryBlockInfo;
 };
 
 /// Postorder traversal on the callgraph to insert membar instructions
 /// of each function.
-/// Each function maintains a BlockInfo map that includes all potential buffers
-/// after returning. This way users do not have to explicitly insert membars
-/// before and after function calls, but might be a bit conservative.
-class ModuleMembarAnalysis : public CallGraph<BlockInfo> {
+/// Each function maintains a summary of the buffers it may access before its
+/// first barrier and of those still pending after returning. At each call,
+/// the summary is moved to the scratch buffer of the call, so that barriers
+/// are only inserted around calls whose accesses actually conflict with the
+/// caller's, as if the callee was inlined.
+class ModuleMembarAnalysis : public CallGraph<FuncBlockInfo> {
 public:
-  ModuleMembarAnalysis(ModuleAllocation *moduleAllocation)
-      : CallGraph<BlockInfo>(moduleAllocation->getModuleOp()),
-        moduleAllocation(moduleAllocation) {}
+  ModuleMembarAnalysis(ModuleAllocation *moduleAllocation,
+                       bool precise = false, bool namedBarriers = false)
+      : CallGraph<FuncBlockInfo>(moduleAllocation->getModuleOp()),
+        moduleAllocation(moduleAllocation), precise(precise),
+        namedBarriers(namedBarriers) {}
 
   void run() {
     walk<WalkOrder::PreOrder, WalkOrder::PostOrder>(
@@ -137,16 +264,25 @@ public:
         // Post-order walk callback
         [&](FunctionOpInterface funcOp) {
           auto *allocation = moduleAllocation->getFuncData(funcOp);
-          auto [it, inserted] = funcMap.try_emplace(funcOp, BlockInfo());
+          auto [it, inserted] = funcMap.try_emplace(funcOp, FuncBlockInfo());
           if (inserted) {
-            MembarAnalysis analysis(allocation);
+            MembarAnalysis analysis(allocation, precise, namedBarriers);
             analysis.run(funcMap);
+            numInsertedBarriers[funcOp] = analysis.getNumInsertedBarriers();
           }
         });
   }
 
+  /// Returns the number of barriers inserted in the given function.
+  unsigned getNumInsertedBarriers(FunctionOpInterface funcOp) const {
+    return numInsertedBarriers.lookup(funcOp);
+  }
+
 private:
   ModuleAllocation *moduleAllocation;
+  bool precise;
+  bool namedBarriers;
+  DenseMap<FunctionOpInterface, unsigned> numInsertedBarriers;
 };
 
 } // namespace mlir
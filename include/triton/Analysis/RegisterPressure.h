@@ -0,0 +1,42 @@
+#ifndef TRITON_ANALYSIS_REGISTER_PRESSURE_H
+#define TRITON_ANALYSIS_REGISTER_PRESSURE_H
+
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace mlir {
+
+/// Estimates the number of 32-bit registers per thread that hold the values
+/// live at each operation of a function. A tensor takes the registers of the
+/// elements its layout distributes to each thread; tensors in shared memory
+/// take none. The estimate ignores the temporaries of the lowering of each
+/// operation, so it is a lower bound of what the backend allocates.
+class RegisterPressureAnalysis {
+public:
+  explicit RegisterPressureAnalysis(FunctionOpInterface funcOp);
+
+  /// Returns the registers of the values live at `op`.
+  unsigned getRegisters(Operation *op) const {
+    return registers.lookup(op);
+  }
+
+  /// Returns the registers of the values live at the operation with the
+  /// highest pressure of the function.
+  unsigned getMaxRegisters() const { return maxRegisters; }
+
+  /// Returns the operation with the highest pressure, or null if the function
+  /// has no operations.
+  Operation *getMaxOp() const { return maxOp; }
+
+  /// Returns the registers per thread of a value of type `type`.
+  static unsigned getRegisters(Type type);
+
+private:
+  DenseMap<Operation *, unsigned> registers;
+  unsigned maxRegisters = 0;
+  Operation *maxOp = nullptr;
+};
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_REGISTER_PRESSURE_H
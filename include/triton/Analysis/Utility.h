@@ -6,6 +6,7 @@
 #include "mlir/Support/LLVM.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Tools/LinearLayout.h"
 
 namespace mlir {
 
@@ -72,6 +73,12 @@ public:
 
   bool isReduceWithinCTA();
 
+  // Whether the partial reductions of each operand are the same in every
+  // thread, like the counts of a Welford reduction of constant weights. These
+  // depend only on splat inputs and on each other, and need neither shuffles
+  // nor shared memory. Reductions of only uniform operands have none.
+  SmallVector<bool> getUniformOperands();
+
   unsigned getAxis() { return axis; }
 
 private:
@@ -151,6 +158,68 @@ private:
   SmallVector<Type> srcElementTypes;
 };
 
+class HistogramOpHelper {
+public:
+  explicit HistogramOpHelper(triton::HistogramOp op) : histogramOp(op) {}
+  // Return the number of bins, padded to at least one bin per lane.
+  unsigned getNumBins();
+  // Return true if the input is counted with shared memory atomics,
+  // aggregated across the lanes of a warp that hit the same bin, rather than
+  // with the ballot based warp-level histogram.
+  bool useWarpAggregatedAtomics();
+  // Return the number of sub-histograms the warps are spread over when using
+  // warp aggregated atomics.
+  unsigned getNumPrivateHistograms();
+  // Return the size of the scratch space needed for histogram lowering.
+  unsigned getScratchSizeInBytes();
+
+private:
+  triton::HistogramOp histogramOp;
+};
+
+class SortOpHelper {
+public:
+  explicit SortOpHelper(triton::SortOp op) : sortOp(op) {}
+  // Return, for each bit of the position along the sorted dimension, the
+  // input dimension of the linear layout ("register", "lane" or "warp") and
+  // the bit of it that holds it. Return std::nullopt if a bit of the layout
+  // mixes the sorted dimension with another one.
+  std::optional<SmallVector<std::pair<StringAttr, int>>> getAxisBits();
+  // Return true if all the exchanges of the sort are within warps.
+  bool isWarpSynchronous();
+  // Return the size of the scratch space needed for the sort lowering.
+  unsigned getScratchSizeInBytes();
+
+private:
+  triton::SortOp sortOp;
+};
+
+class GatherOpHelper {
+public:
+  explicit GatherOpHelper(triton::GatherOp op);
+  // Return true if every element of the result is in the same warp as the
+  // element of the source it reads. This holds when the positions along the
+  // axis of the source are only spread across lanes, and the threads holding
+  // the other coordinates are the same for the source and the indices.
+  bool isWarpLocal() { return warpLocal; }
+  // Return the lane bits holding the bits of the position along the axis of
+  // the source, from the lowest. Only valid for warp local gathers.
+  ArrayRef<int> getAxisLaneBits() { return axisLaneBits; }
+  // Return the register of the source holding the coordinates of register
+  // `reg` of the indices but the one along the axis. Only valid for warp
+  // local gathers.
+  unsigned getSrcRegister(unsigned reg);
+  // Return the size of the scratch space needed for the gather lowering.
+  unsigned getScratchSizeInBytes();
+
+private:
+  triton::GatherOp gatherOp;
+  bool warpLocal = false;
+  SmallVector<int> axisLaneBits;
+  // The register of the source for each bit of the register of the indices.
+  SmallVector<unsigned> srcRegisterBases;
+};
+
 // Decomposes a reshape into simpler pieces.
 //
 // As an example, suppose we have a reshape from [4,4,4] to [2,2,8,2].
@@ -180,6 +249,10 @@ bool maybeSharedAllocationOp(Operation *op);
 
 bool supportMFMA(triton::DotOp op);
 
+// Returns true if `op` can run on MFMA instructions once its operands are
+// converted to aElemTy and bElemTy.
+bool supportMFMA(triton::DotOp op, Type aElemTy, Type bElemTy);
+
 bool supportWMMA(triton::DotOp op);
 
 bool supportMMA(triton::DotOp op, int version);
@@ -190,6 +263,68 @@ bool isSingleValue(Value value);
 
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy);
 
+// Returns the size of the smallest groups of consecutive warps such that each
+// element of a tensor is held by warps of the same group in the layouts of
+// srcTy and dstTy, i.e. the number of warps that a barrier between writing the
+// tensor to shared memory in one layout and reading it back in the other has
+// to synchronize. Returns numWarps if it can't be determined.
+unsigned getNumWarpsExchangingData(RankedTensorType srcTy,
+                                   RankedTensorType dstTy, unsigned numWarps);
+
+// If every thread holds, in the layout of dstTy, elements that it already holds
+// in the layout of srcTy, at registers that don't depend on its lane, warp or
+// block, returns the linear layout mapping each destination register to a
+// source register holding the same element. Such conversions are lowered to a
+// renaming of the registers, without shared memory nor barriers.
+std::optional<triton::LinearLayout>
+getRegisterPermutationLayout(RankedTensorType srcTy, RankedTensorType dstTy);
+
+// If converting from srcTy to dstTy only moves data between lanes of the same
+// warp, and each destination register reads the same source register in every
+// lane, returns the linear layout mapping a destination (register, lane) to
+// the source (register, lane) holding the same element. Such conversions are
+// lowered to warp shuffles without going through shared memory.
+std::optional<triton::LinearLayout>
+getWarpShuffleLayout(RankedTensorType srcTy, RankedTensorType dstTy);
+
+// A layout conversion done in rounds of lane permutes, one round per
+// destination register k. In round k lane l reads from lane
+// roundLane(k) ^ laneLane(l), which sends its source register
+// roundSrcReg(k) ^ senderReg(sending lane), and keeps the value in destination
+// register k ^ dstReg(l). Every map is linear over xor and is given by its
+// values on the bits of its argument.
+struct LanePermuteConversion {
+  SmallVector<int32_t> roundLane;
+  SmallVector<int32_t> roundSrcReg;
+  SmallVector<int32_t> laneLane;
+  SmallVector<int32_t> senderReg;
+  SmallVector<int32_t> dstReg;
+
+  // Applies the map given by `bases` to `x`.
+  static int32_t apply(ArrayRef<int32_t> bases, int32_t x) {
+    int32_t result = 0;
+    for (auto [i, basis] : llvm::enumerate(bases)) {
+      if (x & (1 << i))
+        result ^= basis;
+    }
+    return result;
+  }
+};
+
+// If converting the AMD MFMA tensor srcTy to the blocked tensor dstTy only
+// moves data between lanes of the same warp, and each permute round can pick
+// the registers to send and receive with a few selects, returns how to do it
+// with lane permutes. Such conversions don't go through shared memory.
+std::optional<LanePermuteConversion>
+getMfmaToBlockedLanePermute(RankedTensorType srcTy, RankedTensorType dstTy);
+
+// Models the shared memory accesses of one warp moving the tensor `regTy` to
+// or from the buffer `memTy`, as local_alloc, local_store and local_load do.
+// Returns std::nullopt if the layouts can't be modeled, e.g. if one of them has
+// no linear layout or the buffer is accessed by wgmma rather than ld/st.shared.
+std::optional<triton::SharedMemoryAccessStats>
+getSharedMemoryAccessStats(RankedTensorType regTy, triton::MemDescType memTy);
+
 bool isMfmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy);
 
 bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy);
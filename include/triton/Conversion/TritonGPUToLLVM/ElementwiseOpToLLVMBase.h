@@ -28,6 +28,34 @@ SmallVector<Value> packI32(const SmallVector<Value> &inValues, Type srcTy,
 
 Type getElementType(Value value);
 
+// Returns the signedness of the i8 `value` if it holds an int4 unpacked from a
+// byte: `x >> 4` gives a signed int4, `x >>> 4` and `x & 15` unsigned ones.
+std::optional<bool> getUnpackedInt4Signedness(Value value);
+
+// Converts 4 i8 values, which hold int4 when `bitWidth` is 4, to f16 or bf16.
+// The integers are or-ed into the mantissa of a power of two, which is then
+// subtracted from pairs of elements. bf16 only has room for int4.
+SmallVector<Value> convertPackedIntToFp(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        ArrayRef<Value> values, Type outElemTy,
+                                        unsigned bitWidth, bool isSigned);
+
+// Converts up to 4 bytes, each holding two sub-byte elements of `format`, the
+// lower nibble first, to i8, f16, bf16 or f32. The bytes are converted in a
+// single i32, two elements at a time.
+SmallVector<Value> convertPackedNibbles(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        ArrayRef<Value> values, Type outElemTy,
+                                        PackedElemType format);
+
+// Rounds the `srcTy` value `v` stochastically to the precision of `dstTy`,
+// given the random i32 `rbits`. The result is a `srcTy` value that converts
+// exactly to `dstTy` where their ranges overlap, so any rounding mode can
+// then be used to convert it.
+Value applyStochasticRounding(Location loc, ConversionPatternRewriter &rewriter,
+                              Value v, Value rbits, FloatType srcTy,
+                              FloatType dstTy);
+
 class MultipleOperandsRange
     : public iterator_range<SmallVector<SmallVector<Value>>::iterator> {
   using ContainerT = SmallVector<SmallVector<Value>>;
@@ -43,6 +71,39 @@ public:
   ContainerT::size_type size() const { return end() - begin(); }
 };
 
+// Packs operand `i` of the first two operand sets in a vector<2 x elemTy>.
+inline Value packOperandPair(Location loc, ConversionPatternRewriter &rewriter,
+                             Type elemTy, MultipleOperandsRange operands,
+                             unsigned i) {
+  auto vecTy = vec_ty(elemTy, 2);
+  Value vec = undef(vecTy);
+  for (int j = 0; j < 2; j++)
+    vec = insert_element(vecTy, vec, operands[j][i], i32_val(j));
+  return vec;
+}
+
+inline SmallVector<Value> unpackPair(Location loc,
+                                     ConversionPatternRewriter &rewriter,
+                                     Type elemTy, Value vec) {
+  return {extract_element(elemTy, vec, i32_val(0)),
+          extract_element(elemTy, vec, i32_val(1))};
+}
+
+// Applies DestOp to the first two operand sets at once, as a vector op on
+// pairs of elements. The backends select packed instructions for the f16
+// pairs, e.g. add.f16x2 or v_pk_add_f16, which LLVM often fails to form from
+// the scalar ops.
+template <typename DestOp>
+SmallVector<Value> createPackedOp(Location loc,
+                                  ConversionPatternRewriter &rewriter,
+                                  Type elemTy, MultipleOperandsRange operands) {
+  SmallVector<Value> vecOperands;
+  for (unsigned i = 0; i < operands[0].size(); i++)
+    vecOperands.push_back(packOperandPair(loc, rewriter, elemTy, operands, i));
+  Value ret = rewriter.create<DestOp>(loc, vec_ty(elemTy, 2), vecOperands);
+  return unpackPair(loc, rewriter, elemTy, ret);
+}
+
 // Base pattern for elementwise conversion using ConcreteT. Unpacks individual
 // elements from a `!llvm.struct` via `llvm.extactvalue`, calls
 // ConcreteT::createDestOps on each element, and packs them back into an
@@ -26,6 +26,7 @@ constexpr int patternBenefitDefault = 1;
 constexpr int patternBenefitPrioritizeOverLLVMConversions = 10;
 constexpr int patternBenefitClampOptimizedPattern = 20;
 constexpr int patternBenefitConvertLayoutOptimizedPattern = 20;
+constexpr int patternBenefitFastMathPattern = 20;
 
 void populateElementwiseOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
@@ -42,6 +43,19 @@ void populateAssertOpToLLVMPattern(LLVMTypeConverter &typeConverter,
                                    const TargetInfoBase &targetInfo,
                                    PatternBenefit benefit);
 
+// Number of failures of the recorded asserts whose assert and program ids are
+// kept, the later ones are only counted.
+constexpr int maxRecordedAssertFailures = 16;
+
+// Make the asserts of `mod` record their failures rather than trap. The
+// asserts are numbered with a `tt.assert_id` attribute and described in the
+// `tt.device_asserts` JSON module attribute, and the failures are recorded in
+// the `triton_assert_failures` global that this adds to the module:
+// struct { i32 count; [maxRecordedAssertFailures x [5 x i32]] records; },
+// where a record holds the assert id, the x, y and z program ids and the
+// row-major index of the failing element in the condition.
+void prepareRecordedAsserts(ModuleOp mod);
+
 void populateMakeRangeOpToLLVMPattern(LLVMTypeConverter &typeConverter,
                                       const TargetInfoBase &targetInfo,
                                       RewritePatternSet &patterns,
@@ -66,6 +80,14 @@ void populateHistogramOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
                                        RewritePatternSet &patterns,
                                        const TargetInfoBase &targetInfo,
                                        PatternBenefit benefit);
+void populateSortOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                  RewritePatternSet &patterns,
+                                  const TargetInfoBase &targetInfo,
+                                  PatternBenefit benefit);
+void populateGatherOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                    RewritePatternSet &patterns,
+                                    const TargetInfoBase &targetInfo,
+                                    PatternBenefit benefit);
 void populateReduceOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
                                     RewritePatternSet &patterns,
                                     const TargetInfoBase &targetInfo,
@@ -98,6 +120,18 @@ void populatePrintOpToLLVMPattern(LLVMTypeConverter &typeConverter,
                                   const TargetInfoBase &targetInfo,
                                   PatternBenefit benefit);
 
+// Make the prints of `mod` append binary records to a ring rather than call
+// printf. The prints are numbered with a `tt.print_id` attribute and
+// described in the `tt.device_prints` JSON module attribute, and the records
+// are appended to the `triton_print_ring` global that this adds to the module:
+// struct { i32 cursor; [numRecords x [8 x i32]] records; }, where numRecords is
+// a power of two, the cursor counts the records ever appended and the record
+// of an element holds the print id, the operand, the x, y and z program ids,
+// the index of the element in its tensor, with dim 0 the fastest, and the low
+// and high words of its bits. A print without operands appends a single
+// record.
+void prepareBinaryPrints(ModuleOp mod, int numRecords);
+
 } // namespace triton
 } // namespace mlir
 
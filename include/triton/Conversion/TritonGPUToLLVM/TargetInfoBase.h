@@ -13,6 +13,10 @@ public:
   virtual Value ballot(RewriterBase &rewriter, Location loc, Type type,
                        Value cmp) const = 0;
 
+  // Synchronize all threads of all CTAs in the cluster, making their shared
+  // memory writes visible to each other.
+  virtual void clusterBarrier(RewriterBase &rewriter, Location loc) const = 0;
+
   // Store/load a value from shared memory, either in the same CTA or, if
   // `ctaId` is non-nullopt, in another CTA in the same group.
   //
@@ -61,6 +65,25 @@ public:
       ArrayRef<unsigned> outOrd, unsigned accumNumReplicates,
       int swizzleByteWidth = 0) const = 0;
 
+  // Load/store the registers of `registerTy` from/to shared memory with
+  // instructions that move whole 8x8 matrices per warp, if the target has them
+  // and the layouts map onto them.  Otherwise emit nothing and return
+  // std::nullopt/false.
+  virtual std::optional<SmallVector<Value>>
+  loadMatricesFromShared(RewriterBase &rewriter, Location loc,
+                         RankedTensorType registerTy, MemDescType sharedTy,
+                         Type elemLlvmTy, Value shmemBase,
+                         ArrayRef<Value> shmemStrides) const {
+    return std::nullopt;
+  }
+  virtual bool storeMatricesToShared(RewriterBase &rewriter, Location loc,
+                                     RankedTensorType registerTy,
+                                     MemDescType sharedTy, Type elemLlvmTy,
+                                     ArrayRef<Value> vals, Value shmemBase,
+                                     ArrayRef<Value> shmemStrides) const {
+    return false;
+  }
+
   virtual std::string getMulhiFuncName(Type resultElementTy) const = 0;
   // Emits LLVM code with |rewriter| to print a message following the given
   // format from the device. |formatStrStart| is the pointer to the start of
@@ -394,10 +394,18 @@ inline Value getThreadIdInCTA(RewriterBase &rewriter, Location loc) {
   return rewriter.create<arith::IndexCastOp>(loc, i32_ty, tid);
 }
 
-// Returns CTA level thread idx.
+// Returns CTA level thread idx. The producer warps of warp-specialized kernels
+// are numbered from 0 too, as they run the code of a CTA of their own.
 inline Value getThreadId(RewriterBase &rewriter, Location loc) {
   Value tid = getThreadIdInCTA(rewriter, loc);
   auto mod = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+  if (triton::gpu::TritonGPUDialect::getNumProducerWarps(mod) > 0) {
+    int numConsumerThreads =
+        triton::gpu::TritonGPUDialect::getNumWarps(mod) *
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value isProducer = icmp_uge(tid, i32_val(numConsumerThreads));
+    tid = select(isProducer, sub(tid, i32_val(numConsumerThreads)), tid);
+  }
   return tid;
 }
 
@@ -1258,6 +1266,23 @@ emitIndices(Location loc, RewriterBase &rewriter, const TargetInfoBase &target,
     const TargetInfoBase &target,
     std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback);
 
+// Like emitTransferBetweenRegistersAndShared, but for instructions with which
+// a warp moves whole 8x8 matrices of 16-byte rows, like ldmatrix and stmatrix.
+//
+// Returns false without emitting anything unless every lane holds 32-bit
+// pieces of the rows of such matrices, either as they are laid out in shared
+// memory or, for 16-bit elements, transposed.  Otherwise calls
+// perInstrCallback once per instruction with the number of matrices (1, 2 or
+// 4), whether they are transposed, the shared memory address of the lane, and
+// the indices of the registers moved, the 32 bits of each matrix in turn.
+[[nodiscard]] bool emitTransferBetweenRegistersAndSharedWithMatrices(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    Value shmemBase, ArrayRef<Value> shmemStrides, Location loc,
+    RewriterBase &rewriter,
+    std::function<void(int /*numMatrices*/, bool /*trans*/,
+                       ArrayRef<int> /*regs*/, Value /*shmemAddr*/)>
+        perInstrCallback);
+
 inline DenseMap<unsigned, Value> getSwizzledSharedPtrs(
     Location loc, const TargetInfoBase &target, unsigned inVec,
     RankedTensorType srcTy, triton::gpu::SharedEncodingAttr resSharedLayout,
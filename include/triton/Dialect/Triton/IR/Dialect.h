@@ -27,6 +27,12 @@ struct GlobalMemory : public SideEffects::Resource::Base<GlobalMemory> {
   StringRef getName() final { return "<GlobalMemory>"; }
 };
 
+// The shared memory of the other CTAs of a cluster
+struct DistributedSharedMemory
+    : public SideEffects::Resource::Base<DistributedSharedMemory> {
+  StringRef getName() final { return "<DistributedSharedMemory>"; }
+};
+
 class DialectInferLayoutInterface
     : public DialectInterface::Base<DialectInferLayoutInterface> {
 public:
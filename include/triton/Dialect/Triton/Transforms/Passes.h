@@ -10,6 +10,18 @@ std::unique_ptr<Pass> createCombineOpsPass();
 
 std::unique_ptr<Pass> createReorderBroadcastPass();
 std::unique_ptr<Pass> createRewriteTensorPointerPass();
+std::unique_ptr<Pass> createRewriteTensorPointerPass(bool tmaDescriptors);
+std::unique_ptr<Pass> createForwardStoreToLoadPass();
+std::unique_ptr<Pass> createNarrowOffsetsPass();
+std::unique_ptr<Pass> createEvictionHintsPass();
+std::unique_ptr<Pass> createAllocateWorkspacePass();
+std::unique_ptr<Pass> createDynamicProgramIdsPass();
+std::unique_ptr<Pass> createMagicDivisorsPass();
+std::unique_ptr<Pass> createPersistentKernelPass();
+std::unique_ptr<Pass> createPersistentKernelPass(StringRef scheduler,
+                                                 int groupSize);
+std::unique_ptr<Pass> createTileSwizzlePass();
+std::unique_ptr<Pass> createTileSwizzlePass(int groupSize);
 
 } // namespace triton
 
@@ -5,10 +5,48 @@
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Dialect.h"
+#include "llvm/Support/RWMutex.h"
+
+#include <map>
+#include <tuple>
 
 // TritonGPU depends on Triton
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
+#include "triton/Tools/LinearLayout.h"
+
+namespace mlir::triton::gpu {
+
+// Interns the linear layouts of the encodings and of the conversions between
+// them, which involve Gaussian elimination over F2, so that lowering and cost
+// models querying the same (shape, encoding) pairs build each one only once.
+class LinearLayoutCache {
+public:
+  // (shape, layout, layout converted to or null, element bit width)
+  using Key = std::tuple<std::vector<int64_t>, const void *, const void *,
+                         std::optional<int32_t>>;
+
+  std::optional<LinearLayout>
+  getOrBuild(Key key, llvm::function_ref<std::optional<LinearLayout>()> build) {
+    {
+      llvm::sys::SmartScopedReader<true> lock(mutex);
+      auto it = cache.find(key);
+      if (it != cache.end())
+        return it->second;
+    }
+    // Build outside of the lock, the conversions look up their layouts here.
+    std::optional<LinearLayout> result = build();
+    llvm::sys::SmartScopedWriter<true> lock(mutex);
+    return cache.try_emplace(std::move(key), std::move(result)).first->second;
+  }
+
+private:
+  std::map<Key, std::optional<LinearLayout>> cache;
+  llvm::sys::SmartRWMutex<true> mutex;
+};
+
+} // namespace mlir::triton::gpu
+
 #include "triton/Dialect/TritonGPU/IR/Dialect.h.inc"
 #include "triton/Dialect/TritonGPU/IR/Types.h"
 
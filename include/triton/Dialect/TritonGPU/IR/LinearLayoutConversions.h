@@ -6,6 +6,7 @@
 
 #include <optional>
 
+#include "triton/Dialect/TritonGPU/IR/Attributes.h"
 #include "triton/Tools/LinearLayout.h"
 
 namespace mlir::triton::gpu {
@@ -44,6 +45,29 @@ std::optional<LinearLayout>
 toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
                std::optional<int32_t> elemBitWidth = std::nullopt);
 
+// Returns the layout converting srcLayout to dstLayout, i.e.
+// toLinearLayout(shape, srcLayout).invertAndCompose(
+//     toLinearLayout(shape, dstLayout)),
+// or std::nullopt if either layout can't be converted to an LL.
+//
+// Both functions memoize their results in the TritonGPU dialect, so repeated
+// queries of the same shape and layouts are cheap.
+std::optional<LinearLayout>
+toLinearLayoutConversion(ArrayRef<int64_t> shape, Attribute srcLayout,
+                         Attribute dstLayout,
+                         std::optional<int32_t> elemBitWidth = std::nullopt);
+
+// Returns the layout of the result of a tt.reshape to dstShape that keeps
+// every element where `layout` puts it in the source, or std::nullopt if
+// dstShape isn't made of powers of two.
+std::optional<LinearLayout> reshapeLayout(const LinearLayout &layout,
+                                          ArrayRef<int64_t> dstShape);
+
+// Returns the single-CTA blocked encoding whose layout for `shape` is
+// `layout`, or std::nullopt if there is none.
+std::optional<BlockedEncodingAttr>
+toBlockedEncoding(const LinearLayout &layout, ArrayRef<int64_t> shape);
+
 } // namespace mlir::triton::gpu
 
 #endif // TRITON_DIALECT_TRITONGPU_IR_LINEARLAYOUTCONVERSIONS_H
@@ -23,6 +23,12 @@ void addDep(Operation *op, DenseSet<Operation *> &deps, bool includeArg = true,
 void addOps(scf::ForOp forOp, int stage,
             std::vector<std::pair<Operation *, unsigned>> &schedule,
             std::function<bool(Operation *)> filter);
+
+/// Rewrite a `scf.while` loop that counts an induction variable up to a
+/// loop-invariant bound, with a constant positive step, into a `scf.for` loop
+/// with a dynamic trip count, so that it can be pipelined.
+FailureOr<scf::ForOp> convertWhileToFor(RewriterBase &rewriter,
+                                        scf::WhileOp whileOp);
 } // namespace triton
 } // namespace mlir
 
@@ -33,6 +33,13 @@ bool isLoadFromTensorPtr(triton::LoadOp op);
 // order (so that result[i] is the index of the i-th largest element of 'arr')
 SmallVector<unsigned, 4> argSort(const SmallVector<int64_t> &arr);
 
+// Return the dimensions sorted by decreasing contiguity. Ties are broken by
+// the position of the dimensions in defaultOrder, so accesses without a
+// contiguous dimension, like gathers, keep the order of their current layout.
+SmallVector<unsigned, 4>
+getOrderFromContiguity(const SmallVector<int64_t> &contiguity,
+                       ArrayRef<unsigned> defaultOrder);
+
 // Return the operand used to access the memory in the operation
 Value getMemAccessPtr(Operation *op);
 
@@ -148,6 +155,11 @@ LogicalResult getConvertBackwardSlice(
 // Populate pattern to remove dead cycles in ForOp.
 void populateForOpDeadArgumentElimination(RewritePatternSet &patterns);
 
+// Populate pattern to compute dots with fewer than 16 rows or columns as
+// products reduced over K, which splits K across the lanes.
+void populateDotToGemvPatterns(RewritePatternSet &patterns,
+                               PatternBenefit benefit = 1);
+
 // Convert an \param index to a multi-dim coordinate given \param shape and
 // \param order.
 SmallVector<Value> delinearize(OpBuilder &b, Location loc, Value linear,
@@ -172,6 +184,18 @@ bool isPureUnaryInlineAsm(Operation *op);
 // read the compute capability from the module attributes
 int getNVIDIAComputeCapability(Operation *module);
 
+// Re-picks the swizzling of `sharedEnc`, the encoding of a buffer written from
+// registers in `srcEncoding` and read back as the MMAv2 dot operand
+// `dotOpEnc`, to minimize shared memory bank conflicts on both sides.  The
+// search keeps vec and order and only considers swizzles the ldmatrix-based
+// operand loader supports.  Returns `sharedEnc` if it is already optimal or if
+// the accesses can't be modeled.
+triton::gpu::SharedEncodingAttr
+optimizeSharedSwizzle(triton::gpu::SharedEncodingAttr sharedEnc,
+                      ArrayRef<int64_t> shape, Type eltTy,
+                      Attribute srcEncoding,
+                      triton::gpu::DotOperandEncodingAttr dotOpEnc);
+
 } // namespace mlir
 
 #endif // TRITON_DIALECT_TRITONGPU_TRANSFORMS_UTILITY_H_
@@ -52,6 +52,10 @@ createTritonNvidiaGPUFenceInsertionPass(int computeCapability = 90);
 
 std::unique_ptr<Pass> createTritonNvidiaGPUTMALoweringPass();
 
+std::unique_ptr<Pass> createTritonNvidiaGPUWarpSpecializationPass(
+    int numConsumerGroups = 1, int numBuffers = 3, int producerRegCount = 40,
+    int consumerRegCount = 232);
+
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
 #include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h.inc"
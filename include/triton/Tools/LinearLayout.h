@@ -668,6 +668,50 @@ private:
   checkInvariants(bool requireSurjective);
 };
 
+// How one warp accesses shared memory; see getSharedMemoryAccessStats.
+struct SharedMemoryAccessStats {
+  // Bits each lane moves per access instruction.
+  int32_t vectorBits = 0;
+  // Wavefronts needed in total, and the number that would be needed without
+  // any bank conflicts.
+  int32_t numWavefronts = 0;
+  int32_t numIdealWavefronts = 0;
+  // The worst bank conflict of any single wavefront phase.
+  int32_t maxConflictWays = 0;
+};
+
+// Models one warp moving the registers of `regLayout` to or from
+// `sharedLayout`.
+//
+//  - regLayout maps ("register", "lane", ...) to a tensor index.  All other
+//    in-dims (e.g. "warp" and "block") are taken to be 0.
+//  - sharedLayout maps ("offset", ...) to the same tensor dims.  Offsets are
+//    measured in elements of `elemBitWidth` bits.
+//
+// Each lane accesses runs of consecutive registers which are also consecutive
+// in shared memory, up to 16 bytes at a time.  Accesses wider than 4 bytes are
+// split into phases of 128 bytes, the way the hardware does, and each phase
+// costs as many wavefronts as the most conflicted of the 32 4-byte banks, i.e.
+// the number of distinct words it reads from that bank.
+SharedMemoryAccessStats
+getSharedMemoryAccessStats(const LinearLayout &regLayout,
+                           const LinearLayout &sharedLayout,
+                           int32_t elemBitWidth);
+
+inline int32_t getNumSharedMemoryWavefronts(const LinearLayout &regLayout,
+                                            const LinearLayout &sharedLayout,
+                                            int32_t elemBitWidth) {
+  return getSharedMemoryAccessStats(regLayout, sharedLayout, elemBitWidth)
+      .numWavefronts;
+}
+
+// Returns the index of the layout in `sharedLayouts` that needs the fewest
+// wavefronts in total to be accessed with every layout in `regLayouts`.  Ties
+// go to the earliest candidate, so callers can put their default first.
+int32_t findMinBankConflictLayout(ArrayRef<LinearLayout> regLayouts,
+                                  ArrayRef<LinearLayout> sharedLayouts,
+                                  int32_t elemBitWidth);
+
 inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
                                      const LinearLayout &layout) {
   os << layout.toString();
@@ -1,6 +1,7 @@
 #include "triton/Analysis/Allocation.h"
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <numeric>
 
@@ -37,6 +38,12 @@ namespace triton {
 // Bitwidth of pointers
 constexpr int kPtrBitWidth = 64;
 
+// Maximum number of buffers for which the best-fit strategy runs the
+// branch-and-bound search over placement orders
+constexpr size_t kMaxSearchBuffers = 12;
+// Maximum number of search tree nodes visited by the branch-and-bound search
+constexpr size_t kMaxSearchNodes = 1 << 16;
+
 static std::pair<SmallVector<unsigned>, SmallVector<unsigned>>
 getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
   auto srcMmaLayout = mlir::dyn_cast<NvidiaMmaEncodingAttr>(srcLayout);
@@ -136,6 +143,10 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   if (auto dstBlockedLayout = mlir::dyn_cast<BlockedEncodingAttr>(dstLayout)) {
     paddedDim = dstBlockedLayout.getOrder()[0];
   }
+  // Padding only avoids bank conflicts between rows, so a single row is kept
+  // dense.
+  if (product<unsigned>(repShape) == repShape[paddedDim])
+    return repShape;
   unsigned pad = std::max(inVec, outVec);
   repShape[paddedDim] += pad;
   return repShape;
@@ -246,11 +257,31 @@ private:
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
                                                           scratchAlignment);
     } else if (auto histogram = dyn_cast<triton::HistogramOp>(op)) {
-      auto dstTy = histogram.getType();
-      int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(
-          op->getParentOfType<ModuleOp>());
-      auto bytes = std::max<int>(dstTy.getNumElements(), threadsPerWarp) *
-                   std::max<int>(8, dstTy.getElementTypeBitWidth()) / 8;
+      HistogramOpHelper helper(histogram);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
+                                                          scratchAlignment);
+    } else if (auto sortOp = dyn_cast<triton::SortOp>(op)) {
+      SortOpHelper helper(sortOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
+                                                          scratchAlignment);
+    } else if (auto gatherOp = dyn_cast<triton::GatherOp>(op)) {
+      GatherOpHelper helper(gatherOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
+                                                          scratchAlignment);
+    } else if (auto clusterReduce = dyn_cast<triton::ClusterReduceOp>(op)) {
+      // Every thread stores its elements for the peer CTAs to read.
+      auto srcTy = clusterReduce.getSrc().getType();
+      auto mod = op->getParentOfType<ModuleOp>();
+      unsigned numThreads =
+          triton::gpu::TritonGPUDialect::getNumWarps(mod) *
+          triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+      unsigned bytes = 0;
+      if (clusterReduce.getClusterSize() > 1)
+        bytes = triton::gpu::getTotalElemsPerThread(srcTy) * numThreads *
+                std::max<int>(8, srcTy.getElementTypeBitWidth()) / 8;
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes,
                                                           scratchAlignment);
     } else if (auto cvtLayout = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
@@ -467,6 +498,12 @@ private:
       buffers.emplace_back(bufferIter.first);
     }
 
+    allocation->peakLiveSize = computePeakLiveSize(buffers);
+    if (allocation->strategy == AllocationStrategy::BestFit) {
+      computeBestFitOffsets(buffers);
+      return;
+    }
+
     calculateStarts(buffers);
 
     // NOTE: The original paper doesn't consider interference between
@@ -614,6 +651,105 @@ private:
     }
   }
 
+  /// Returns the maximum total size of the buffers that are live at the same
+  /// time, ignoring alignment.
+  size_t computePeakLiveSize(const SmallVector<BufferT *> &buffers) {
+    size_t peak = 0;
+    // The live size can only increase at the start of a liveness range.
+    for (auto x : buffers) {
+      auto point = bufferRange.lookup(x).start();
+      size_t live = 0;
+      for (auto y : buffers) {
+        if (bufferRange.lookup(y).contains(point))
+          live += y->size;
+      }
+      peak = std::max(peak, live);
+    }
+    return peak;
+  }
+
+  /// Returns the lowest aligned offset at which buffer x does not overlap any
+  /// of the placed buffers whose liveness range intersects with x's.
+  size_t getLowestFreeOffset(BufferT *x, ArrayRef<BufferT *> placed) {
+    auto xRange = bufferRange.lookup(x);
+    SmallVector<Interval<size_t>> occupied;
+    for (auto y : placed) {
+      if (bufferRange.lookup(y).intersects(xRange))
+        occupied.push_back({y->offset, y->offset + y->size});
+    }
+    llvm::sort(occupied);
+    size_t offset = 0;
+    for (auto interval : occupied) {
+      if (offset + x->size <= interval.start())
+        break;
+      offset = std::max(offset, llvm::alignTo(interval.end(), x->alignment));
+    }
+    return offset;
+  }
+
+  /// Computes the shared memory offsets with the best-fit strategy.
+  /// Buffers are first placed by decreasing size, then by decreasing lifetime,
+  /// each at the lowest offset that does not conflict with the buffers placed
+  /// before it. If that is worse than the peak liveness and there are few
+  /// buffers, a branch-and-bound search over placement orders looks for a
+  /// smaller footprint.
+  void computeBestFitOffsets(const SmallVector<BufferT *> &buffers) {
+    SmallVector<BufferT *> order = buffers;
+    llvm::stable_sort(order, [&](BufferT *x, BufferT *y) {
+      if (x->size != y->size)
+        return x->size > y->size;
+      return bufferRange.lookup(x).size() > bufferRange.lookup(y).size();
+    });
+
+    size_t bestSize = 0;
+    SmallVector<BufferT *> placed;
+    for (auto x : order) {
+      x->offset = getLowestFreeOffset(x, placed);
+      placed.push_back(x);
+      bestSize = std::max(bestSize, x->offset + x->size);
+    }
+    SmallVector<size_t> bestOffsets;
+    for (auto x : order)
+      bestOffsets.push_back(x->offset);
+
+    if (order.size() <= kMaxSearchBuffers &&
+        bestSize > allocation->peakLiveSize) {
+      size_t numNodes = 0;
+      SmallVector<bool> used(order.size(), false);
+      placed.clear();
+      std::function<void(size_t)> search = [&](size_t curSize) {
+        if (++numNodes > kMaxSearchNodes ||
+            bestSize == allocation->peakLiveSize)
+          return;
+        if (placed.size() == order.size()) {
+          bestSize = curSize;
+          for (auto [i, x] : llvm::enumerate(order))
+            bestOffsets[i] = x->offset;
+          return;
+        }
+        for (auto [i, x] : llvm::enumerate(order)) {
+          if (used[i])
+            continue;
+          x->offset = getLowestFreeOffset(x, placed);
+          size_t newSize = std::max(curSize, x->offset + x->size);
+          // Prune orders that cannot beat the best placement found so far.
+          if (newSize >= bestSize)
+            continue;
+          used[i] = true;
+          placed.push_back(x);
+          search(newSize);
+          placed.pop_back();
+          used[i] = false;
+        }
+      };
+      search(0);
+    }
+
+    for (auto [i, x] : llvm::enumerate(order))
+      x->offset = bestOffsets[i];
+    allocation->sharedMemorySize = bestSize;
+  }
+
 private:
   Operation *operation;
   Allocation::FuncAllocMapT *funcAllocMap;
@@ -623,6 +759,14 @@ private:
 
 } // namespace triton
 
+std::optional<AllocationStrategy> parseAllocationStrategy(StringRef name) {
+  if (name == "greedy")
+    return AllocationStrategy::Greedy;
+  if (name == "best-fit")
+    return AllocationStrategy::BestFit;
+  return std::nullopt;
+}
+
 void Allocation::run(FuncAllocMapT &funcAllocMap) {
   triton::AllocationAnalysis(getOperation(), &funcAllocMap, this);
 }
@@ -1,6 +1,7 @@
 #include "mlir/Analysis/DataFlowFramework.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "triton/Analysis/AxisInfo.h"
@@ -14,6 +15,8 @@
 namespace mlir::triton {
 namespace {
 
+using RangeT = AxisInfo::RangeT;
+
 int64_t gcdImpl(int64_t a, int64_t b, int64_t *x, int64_t *y) {
   // Base Case
   if (a == 0) {
@@ -51,6 +54,40 @@ int64_t multiplyDivisor(int64_t lhs, int64_t rhs) {
   return lhs * rhs;
 }
 
+// Drop the range if the values of type are not integers that can hold it
+std::optional<RangeT> fitRange(Type type, std::optional<RangeT> range) {
+  if (!range.has_value())
+    return std::nullopt;
+  type = getElementTypeOrSelf(type);
+  unsigned bitWidth = 0;
+  if (type.isIndex())
+    bitWidth = 64;
+  else if (auto intTy = dyn_cast<IntegerType>(type))
+    bitWidth = intTy.getWidth();
+  if (bitWidth <= 1 || bitWidth > 64)
+    return std::nullopt;
+  if (range->first > range->second || range->first < llvm::minIntN(bitWidth) ||
+      range->second > llvm::maxIntN(bitWidth))
+    return std::nullopt;
+  return range;
+}
+
+bool isNonNegative(const std::optional<RangeT> &range) {
+  return range.has_value() && range->first >= 0;
+}
+
+// Read the [min, max] hint of a function argument
+template <class T>
+std::optional<RangeT> getRangeFromFunc(int argNumber, T funcOp) {
+  auto attr = dyn_cast_or_null<DenseElementsAttr>(
+      funcOp.getArgAttr(argNumber, "tt.range"));
+  if (!attr || attr.getNumElements() != 2 ||
+      !attr.getElementType().isIntOrIndex())
+    return std::nullopt;
+  auto vals = llvm::to_vector(attr.getValues<APInt>());
+  return RangeT{vals[0].getSExtValue(), vals[1].getSExtValue()};
+}
+
 class AxisInfoVisitor {
 public:
   AxisInfoVisitor() = default;
@@ -103,7 +140,12 @@ public:
     auto lhsInfo = operands[0]->getValue();
     auto rhsInfo = operands[1]->getValue();
     auto rank = lhsInfo.getRank();
-    assert(operands.size() == 2 && "Expected two operands");
+    // The magic numbers of tt.magic_divui and tt.magic_remui follow the
+    // divisor and don't change the result
+    assert((operands.size() == 2 ||
+            isa<triton::MagicDivUIOp, triton::MagicRemUIOp>(
+                op.getOperation())) &&
+           "Expected two operands");
     AxisInfo::DimVectorT contiguity;
     AxisInfo::DimVectorT divisibility;
     AxisInfo::DimVectorT constancy;
@@ -121,7 +163,10 @@ public:
         divisibility.push_back(getDivisibility(op, lhsInfo, rhsInfo, d));
       }
     }
-    return AxisInfo(contiguity, divisibility, constancy, constantValue);
+    std::optional<RangeT> range;
+    if (lhsInfo.getRange().has_value() && rhsInfo.getRange().has_value())
+      range = getRange(op, *lhsInfo.getRange(), *rhsInfo.getRange());
+    return AxisInfo(contiguity, divisibility, constancy, constantValue, range);
   }
 
 protected:
@@ -144,6 +189,12 @@ protected:
                                                   const AxisInfo &rhs) {
     return {};
   }
+
+  // Only called if the ranges of both operands are known
+  virtual std::optional<RangeT> getRange(OpTy op, const RangeT &lhs,
+                                         const RangeT &rhs) {
+    return {};
+  }
 };
 
 class AxisInfoVisitorList {
@@ -211,7 +262,14 @@ public:
   AxisInfo
   getAxisInfo(OpTy op,
               ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
-    return operands[0]->getValue();
+    auto opInfo = operands[0]->getValue();
+    if constexpr (std::is_same_v<OpTy, arith::ExtUIOp>) {
+      // Zero extension changes the value of negative integers
+      if (!isNonNegative(opInfo.getRange()))
+        return AxisInfo(opInfo.getContiguity(), opInfo.getDivisibility(),
+                        opInfo.getConstancy(), opInfo.getConstantValue());
+    }
+    return opInfo;
   }
 };
 
@@ -227,7 +285,24 @@ public:
     auto end = op.getEnd();
     return AxisInfo(/*contiguity=*/{end - start},
                     /*divisibility=*/{highestPowOf2Divisor(start)},
-                    /*constancy=*/{1});
+                    /*constancy=*/{1}, /*knownConstantValue=*/std::nullopt,
+                    /*range=*/RangeT{start, end - 1});
+  }
+};
+
+template <typename OpTy>
+class ProgramInfoOpAxisInfoVisitor final : public AxisInfoVisitorImpl<OpTy> {
+public:
+  using AxisInfoVisitorImpl<OpTy>::AxisInfoVisitorImpl;
+
+  AxisInfo
+  getAxisInfo(OpTy op,
+              ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) override {
+    // Program ids are in [0, num_programs), and there is at least one program
+    int64_t minValue = std::is_same_v<OpTy, triton::GetNumProgramsOp> ? 1 : 0;
+    return AxisInfo(/*contiguity=*/{1}, /*divisibility=*/{1},
+                    /*constancy=*/{1}, /*knownConstantValue=*/std::nullopt,
+                    /*range=*/RangeT{minValue, llvm::maxIntN(32)});
   }
 };
 
@@ -243,19 +318,29 @@ public:
     auto boolAttr = dyn_cast<BoolAttr>(op.getValue());
     if (intAttr || boolAttr) {
       int64_t value{};
-      if (intAttr)
+      std::optional<RangeT> range;
+      if (intAttr) {
         value = intAttr.getValue().getZExtValue();
-      else
+        if (intAttr.getValue().getBitWidth() <= 64) {
+          int64_t signedValue = intAttr.getValue().getSExtValue();
+          range = RangeT{signedValue, signedValue};
+        }
+      } else {
         value = boolAttr.getValue() ? 1 : 0;
+      }
       return AxisInfo(/*contiguity=*/{1},
                       /*divisibility=*/{highestPowOf2Divisor(value)},
                       /*constancy=*/{1},
-                      /*knownConstantValue=*/{value});
+                      /*knownConstantValue=*/{value}, range);
     }
     // TODO: generalize to dense attr
     auto splatAttr = dyn_cast<SplatElementsAttr>(op.getValue());
     if (splatAttr && splatAttr.getElementType().isIntOrIndex()) {
-      int64_t value = splatAttr.template getSplatValue<APInt>().getZExtValue();
+      APInt splatValue = splatAttr.template getSplatValue<APInt>();
+      int64_t value = splatValue.getZExtValue();
+      std::optional<RangeT> range;
+      if (splatValue.getBitWidth() <= 64)
+        range = RangeT{splatValue.getSExtValue(), splatValue.getSExtValue()};
       TensorType ty = cast<TensorType>(splatAttr.getType());
       return AxisInfo(
           /*contiguity=*/AxisInfo::DimVectorT(ty.getRank(), 1),
@@ -263,7 +348,7 @@ public:
           AxisInfo::DimVectorT(ty.getRank(), highestPowOf2Divisor(value)),
           /*constancy=*/
           AxisInfo::DimVectorT(ty.getShape().begin(), ty.getShape().end()),
-          /*knownConstantValue=*/{value});
+          /*knownConstantValue=*/{value}, range);
     }
     return AxisInfo();
   }
@@ -334,6 +419,24 @@ private:
     }
     return {};
   }
+
+  std::optional<RangeT> getRange(OpTy op, const RangeT &lhs,
+                                 const RangeT &rhs) override {
+    int64_t minValue, maxValue;
+    if constexpr (std::is_same_v<OpTy, arith::AddIOp> ||
+                  std::is_same_v<OpTy, LLVM::AddOp>) {
+      if (llvm::AddOverflow(lhs.first, rhs.first, minValue) ||
+          llvm::AddOverflow(lhs.second, rhs.second, maxValue))
+        return {};
+      return RangeT{minValue, maxValue};
+    } else if constexpr (std::is_same_v<OpTy, arith::SubIOp>) {
+      if (llvm::SubOverflow(lhs.first, rhs.second, minValue) ||
+          llvm::SubOverflow(lhs.second, rhs.first, maxValue))
+        return {};
+      return RangeT{minValue, maxValue};
+    }
+    return {};
+  }
 };
 
 class MulIOpAxisInfoVisitor final : public BinaryOpVisitorImpl<arith::MulIOp> {
@@ -385,6 +488,19 @@ private:
       return {lhs.getConstantValue().value() * rhs.getConstantValue().value()};
     return {};
   }
+
+  std::optional<RangeT> getRange(arith::MulIOp op, const RangeT &lhs,
+                                 const RangeT &rhs) override {
+    // The extrema are reached at the corners
+    int64_t products[4];
+    if (llvm::MulOverflow(lhs.first, rhs.first, products[0]) ||
+        llvm::MulOverflow(lhs.first, rhs.second, products[1]) ||
+        llvm::MulOverflow(lhs.second, rhs.first, products[2]) ||
+        llvm::MulOverflow(lhs.second, rhs.second, products[3]))
+      return {};
+    return RangeT{*std::min_element(products, products + 4),
+                  *std::max_element(products, products + 4)};
+  }
 };
 
 template <typename OpTy>
@@ -449,6 +565,14 @@ private:
       return {lhs.getConstantValue().value() / rhs.getConstantValue().value()};
     return {};
   }
+
+  std::optional<RangeT> getRange(OpTy op, const RangeT &lhs,
+                                 const RangeT &rhs) override {
+    // Signed and unsigned divisions agree on non-negative integers
+    if (lhs.first < 0 || rhs.first <= 0)
+      return {};
+    return RangeT{lhs.first / rhs.second, lhs.second / rhs.first};
+  }
 };
 
 template <typename OpTy>
@@ -514,6 +638,13 @@ private:
       return {0};
     return {};
   }
+
+  std::optional<RangeT> getRange(OpTy op, const RangeT &lhs,
+                                 const RangeT &rhs) override {
+    if (lhs.first < 0 || rhs.first <= 0)
+      return {};
+    return RangeT{0, std::min(lhs.second, rhs.second - 1)};
+  }
 };
 
 class SplatOpAxisInfoVisitor final
@@ -536,7 +667,8 @@ public:
       constancy.push_back(retTy.getShape()[d]);
     }
     return AxisInfo(contiguity, divisibility, constancy,
-                    operands[0]->getValue().getConstantValue());
+                    operands[0]->getValue().getConstantValue(),
+                    operands[0]->getValue().getRange());
   }
 };
 
@@ -601,7 +733,8 @@ public:
     divisibility.insert(divisibility.begin() + op.getAxis(), newDivisibility);
     constancy.insert(constancy.begin() + op.getAxis(), 1);
     return AxisInfo(contiguity, divisibility, constancy,
-                    operands[0]->getValue().getConstantValue());
+                    operands[0]->getValue().getConstantValue(),
+                    operands[0]->getValue().getRange());
   }
 };
 
@@ -630,7 +763,8 @@ public:
                                           : opInfo.getConstancy(d));
     }
     return AxisInfo(contiguity, divisibility, constancy,
-                    operands[0]->getValue().getConstantValue());
+                    operands[0]->getValue().getConstantValue(),
+                    operands[0]->getValue().getRange());
   }
 };
 
@@ -652,6 +786,21 @@ public:
 
     AxisInfo::DimVectorT contiguity, divisibility, constancy;
     std::optional<int64_t> constantValue;
+    // The ranges of the operands may decide the comparison for all elements,
+    // e.g. the mask of offsets that are known to be in bounds
+    if (!lhsInfo.getConstantValue().has_value() ||
+        !rhsInfo.getConstantValue().has_value()) {
+      if (lhsInfo.getRange().has_value() && rhsInfo.getRange().has_value()) {
+        if (auto result = compare(getPredicate(op), *lhsInfo.getRange(),
+                                  *rhsInfo.getRange())) {
+          return AxisInfo(/*contiguity=*/AxisInfo::DimVectorT(rank, 1),
+                          /*divisibility=*/AxisInfo::DimVectorT(rank, 1),
+                          /*constancy=*/
+                          AxisInfo::DimVectorT(shape.begin(), shape.end()),
+                          /*knownConstantValue=*/{*result ? 1 : 0});
+        }
+      }
+    }
     for (short d = 0; d < rank; ++d) {
       int64_t constHint = 1;
       if (lhsInfo.getConstantValue().has_value() &&
@@ -760,6 +909,58 @@ private:
     }
     llvm_unreachable("unknown comparison predicate");
   }
+
+  // Returns the result of the comparison if it is the same for all the
+  // elements in the ranges
+  static std::optional<bool> compare(arith::CmpIPredicate predicate,
+                                     const RangeT &lhs, const RangeT &rhs) {
+    switch (predicate) {
+    case arith::CmpIPredicate::eq:
+      if (lhs.first == lhs.second && lhs == rhs)
+        return true;
+      if (lhs.second < rhs.first || rhs.second < lhs.first)
+        return false;
+      return {};
+    case arith::CmpIPredicate::ne:
+      if (auto result = compare(arith::CmpIPredicate::eq, lhs, rhs))
+        return !*result;
+      return {};
+    case arith::CmpIPredicate::slt:
+      if (lhs.second < rhs.first)
+        return true;
+      if (lhs.first >= rhs.second)
+        return false;
+      return {};
+    case arith::CmpIPredicate::sle:
+      if (lhs.second <= rhs.first)
+        return true;
+      if (lhs.first > rhs.second)
+        return false;
+      return {};
+    case arith::CmpIPredicate::sgt:
+      return compare(arith::CmpIPredicate::slt, rhs, lhs);
+    case arith::CmpIPredicate::sge:
+      return compare(arith::CmpIPredicate::sle, rhs, lhs);
+    default:
+      break;
+    }
+    // Unsigned comparisons agree with the signed ones on non-negative integers
+    if (lhs.first < 0 || rhs.first < 0)
+      return {};
+    switch (predicate) {
+    case arith::CmpIPredicate::ult:
+      return compare(arith::CmpIPredicate::slt, lhs, rhs);
+    case arith::CmpIPredicate::ule:
+      return compare(arith::CmpIPredicate::sle, lhs, rhs);
+    case arith::CmpIPredicate::ugt:
+      return compare(arith::CmpIPredicate::sgt, lhs, rhs);
+    case arith::CmpIPredicate::uge:
+      return compare(arith::CmpIPredicate::sge, lhs, rhs);
+    default:
+      break;
+    }
+    llvm_unreachable("unknown comparison predicate");
+  }
 };
 
 template <typename OpTy>
@@ -777,17 +978,20 @@ public:
 
     AxisInfo::DimVectorT contiguity, divisibility, constancy;
     std::optional<int64_t> constantValue;
+    std::optional<RangeT> range;
     if (operands[0]->getValue().getConstantValue().has_value()) {
       if (operands[0]->getValue().getConstantValue() == 0) {
         contiguity = rhsInfo.getContiguity();
         divisibility = rhsInfo.getDivisibility();
         constancy = rhsInfo.getConstancy();
         constantValue = rhsInfo.getConstantValue();
+        range = rhsInfo.getRange();
       } else {
         contiguity = lhsInfo.getContiguity();
         divisibility = lhsInfo.getDivisibility();
         constancy = lhsInfo.getConstancy();
         constantValue = lhsInfo.getConstantValue();
+        range = lhsInfo.getRange();
       }
     } else {
       // The condition can be either a tensor or i1.
@@ -830,9 +1034,13 @@ public:
           rhsInfo.getConstantValue().has_value() &&
           lhsInfo.getConstantValue() == rhsInfo.getConstantValue())
         constantValue = lhsInfo.getConstantValue();
+      if (lhsInfo.getRange().has_value() && rhsInfo.getRange().has_value())
+        range = RangeT{
+            std::min(lhsInfo.getRange()->first, rhsInfo.getRange()->first),
+            std::max(lhsInfo.getRange()->second, rhsInfo.getRange()->second)};
     }
 
-    return AxisInfo(contiguity, divisibility, constancy, constantValue);
+    return AxisInfo(contiguity, divisibility, constancy, constantValue, range);
   }
 };
 
@@ -864,6 +1072,18 @@ private:
     }
     return {};
   }
+
+  std::optional<RangeT> getRange(OpTy op, const RangeT &lhs,
+                                 const RangeT &rhs) override {
+    // Masking a non-negative integer can only clear bits
+    if constexpr (std::is_same_v<OpTy, arith::AndIOp>) {
+      if (lhs.first >= 0 && rhs.first >= 0)
+        return RangeT{0, std::min(lhs.second, rhs.second)};
+      if (lhs.first >= 0 || rhs.first >= 0)
+        return RangeT{0, lhs.first >= 0 ? lhs.second : rhs.second};
+    }
+    return {};
+  }
 };
 
 class ShLIOpAxisInfoVisitor final : public BinaryOpVisitorImpl<arith::ShLIOp> {
@@ -962,6 +1182,7 @@ public:
     auto rhsInfo = operands[1]->getValue();
     auto rank = lhsInfo.getRank();
     std::optional<int64_t> constantValue;
+    auto range = getRange(lhsInfo.getRange(), rhsInfo.getRange());
     if (lhsInfo.getConstantValue().has_value() &&
         rhsInfo.getConstantValue().has_value()) {
       if constexpr (std::is_same_v<OpTy, arith::MaxSIOp> ||
@@ -976,7 +1197,7 @@ public:
       return AxisInfo(/*knownContiguity=*/AxisInfo::DimVectorT(rank, 1),
                       /*knownDivisibility=*/AxisInfo::DimVectorT(rank, 1),
                       /*knownConstancy=*/AxisInfo::DimVectorT(rank, 1),
-                      /*constantValue=*/constantValue);
+                      /*constantValue=*/constantValue, range);
     } else {
       AxisInfo::DimVectorT contiguity, divisibility, constancy;
       for (auto d = 0; d < rank; ++d) {
@@ -987,8 +1208,28 @@ public:
         contiguity.push_back(
             std::min(lhsInfo.getContiguity(d), rhsInfo.getContiguity(d)));
       }
-      return AxisInfo(contiguity, divisibility, constancy, std::nullopt);
+      return AxisInfo(contiguity, divisibility, constancy, std::nullopt,
+                      range);
+    }
+  }
+
+private:
+  static std::optional<RangeT> getRange(const std::optional<RangeT> &lhs,
+                                        const std::optional<RangeT> &rhs) {
+    if (!lhs.has_value() || !rhs.has_value())
+      return {};
+    if constexpr (std::is_same_v<OpTy, arith::MaxUIOp> ||
+                  std::is_same_v<OpTy, arith::MinUIOp>) {
+      // Unsigned and signed orders agree on non-negative integers
+      if (lhs->first < 0 || rhs->first < 0)
+        return {};
     }
+    if constexpr (std::is_same_v<OpTy, arith::MaxSIOp> ||
+                  std::is_same_v<OpTy, arith::MaxUIOp>)
+      return RangeT{std::max(lhs->first, rhs->first),
+                    std::max(lhs->second, rhs->second)};
+    return RangeT{std::min(lhs->first, rhs->first),
+                  std::min(lhs->second, rhs->second)};
   }
 };
 
@@ -1009,10 +1250,14 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
                   CastOpAxisInfoVisitor<arith::IndexCastOp>,
                   CastOpAxisInfoVisitor<triton::gpu::ConvertLayoutOp>,
                   CastOpAxisInfoVisitor<mlir::UnrealizedConversionCastOp>,
-                  CastOpAxisInfoVisitor<triton::BitcastOp>>();
+                  CastOpAxisInfoVisitor<triton::BitcastOp>,
+                  CastOpAxisInfoVisitor<triton::IntToPtrOp>,
+                  CastOpAxisInfoVisitor<triton::PtrToIntOp>>();
   // TODO: Remove rules for LLVM::ConstantOp, LLVM::AddOp
   // when scf.for supports integer induction variables
   visitors.append<MakeRangeOpAxisInfoVisitor>();
+  visitors.append<ProgramInfoOpAxisInfoVisitor<triton::GetProgramIdOp>,
+                  ProgramInfoOpAxisInfoVisitor<triton::GetNumProgramsOp>>();
   visitors.append<ConstantOpAxisInfoVisitor<arith::ConstantOp>,
                   ConstantOpAxisInfoVisitor<LLVM::ConstantOp>>();
   visitors.append<AddSubOpAxisInfoVisitor<triton::AddPtrOp>,
@@ -1021,9 +1266,11 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
                   AddSubOpAxisInfoVisitor<LLVM::AddOp>>();
   visitors.append<MulIOpAxisInfoVisitor>();
   visitors.append<DivOpAxisInfoVisitor<arith::DivSIOp>,
-                  DivOpAxisInfoVisitor<arith::DivUIOp>>();
+                  DivOpAxisInfoVisitor<arith::DivUIOp>,
+                  DivOpAxisInfoVisitor<triton::MagicDivUIOp>>();
   visitors.append<RemOpAxisInfoVisitor<arith::RemSIOp>,
-                  RemOpAxisInfoVisitor<arith::RemUIOp>>();
+                  RemOpAxisInfoVisitor<arith::RemUIOp>,
+                  RemOpAxisInfoVisitor<triton::MagicRemUIOp>>();
   visitors.append<BroadcastOpAxisInfoVisitor>();
   visitors.append<SplatOpAxisInfoVisitor>();
   visitors.append<ExpandDimsOpAxisInfoVisitor>();
@@ -1068,8 +1315,12 @@ void AxisInfoAnalysis::visitOperation(
     auto vals = cast<DenseElementsAttr>(attr).getValues<int>();
     newConstancy = AxisInfo::DimVectorT(vals.begin(), vals.end());
   }
+  // Ranges that overflow the result type are not meaningful
+  std::optional<RangeT> newRange;
+  if (op->getNumResults() > 0)
+    newRange = fitRange(op->getResult(0).getType(), curr.getRange());
   curr = AxisInfo(newContiguity, newDivisibility, newConstancy,
-                  curr.getConstantValue());
+                  curr.getConstantValue(), newRange);
   // join all lattice elements
   for (auto *result : results)
     propagateIfChanged(result, result->join(curr));
@@ -1078,14 +1329,30 @@ void AxisInfoAnalysis::visitOperation(
 void AxisInfoAnalysis::visitForOpInductionVar(
     scf::ForOp op, ArrayRef<dataflow::Lattice<AxisInfo> *> argLattices) {
   auto lb = getLatticeElementFor(op, op.getLowerBound())->getValue();
+  auto ub = getLatticeElementFor(op, op.getUpperBound())->getValue();
   auto step = getLatticeElementFor(op, op.getStep())->getValue();
 
   AxisInfo::DimVectorT knownContiguity(1, 1);
   AxisInfo::DimVectorT knownDivisibility(1, 1);
   AxisInfo::DimVectorT knownConstancy(1, 1);
   knownDivisibility[0] = gcd(lb.getDivisibility(0), step.getDivisibility(0));
-  auto inductionVar =
-      AxisInfo(knownContiguity, knownDivisibility, knownConstancy);
+  // With a positive step, the induction variable is in [lb, ub)
+  std::optional<RangeT> range;
+  auto lbRange = lb.getRange();
+  auto ubRange = ub.getRange();
+  auto stepValue = step.getConstantValue();
+  if (lbRange.has_value() && ubRange.has_value() && stepValue.has_value() &&
+      *stepValue > 0 && lbRange->first < ubRange->second) {
+    int64_t maxValue = ubRange->second - 1;
+    // The last iteration is on the step grid of a constant lower bound
+    if (lbRange->first == lbRange->second)
+      maxValue = lbRange->first +
+                 (maxValue - lbRange->first) / *stepValue * *stepValue;
+    range = fitRange(op.getInductionVar().getType(),
+                     RangeT{lbRange->first, maxValue});
+  }
+  auto inductionVar = AxisInfo(knownContiguity, knownDivisibility,
+                               knownConstancy, std::nullopt, range);
   (void)argLattices[0]->join(inductionVar);
 }
 
@@ -1124,22 +1391,25 @@ void AxisInfo::initPessimisticStateFromFunc(int argNumber, T funcOp,
   DimVectorT knownContiguity(rank, 1);
   DimVectorT knownDivisibility(rank, 1);
   DimVectorT knownConstancy(rank, 1);
+  std::optional<RangeT> knownRange;
 
   BlockArgument blockArg = dyn_cast<BlockArgument>(value);
 
   if (blockArg && blockArg.getOwner()->isEntryBlock()) {
     Operation *op = blockArg.getOwner()->getParentOp();
-    if (auto fun = dyn_cast<FunctionOpInterface>(op))
+    if (auto fun = dyn_cast<FunctionOpInterface>(op)) {
       initPessimisticStateFromFunc(blockArg.getArgNumber(), fun,
                                    &knownContiguity, &knownDivisibility,
                                    &knownConstancy);
-    // llvm codegen check alignment to generate vector load/store
-    // would be nice if this wasn't the case
-    else if (auto fun = dyn_cast<LLVM::LLVMFuncOp>(op))
+      knownRange = getRangeFromFunc(blockArg.getArgNumber(), fun);
+    } else if (auto fun = dyn_cast<LLVM::LLVMFuncOp>(op)) {
+      // llvm codegen check alignment to generate vector load/store
+      // would be nice if this wasn't the case
       initPessimisticStateFromFunc(blockArg.getArgNumber(), fun,
                                    &knownContiguity, &knownDivisibility,
                                    &knownConstancy);
-    else if (isa<RegionBranchOpInterface>(op)) {
+      knownRange = getRangeFromFunc(blockArg.getArgNumber(), fun);
+    } else if (isa<RegionBranchOpInterface>(op)) {
       // scf::ForOp, scf::IfOp, scf::WhileOp
       // Control flow operations are initialized with "unknown" state:
       // the maximum possible divisibility, contiguity, and constancy.
@@ -1172,7 +1442,8 @@ void AxisInfo::initPessimisticStateFromFunc(int argNumber, T funcOp,
     }
   }
 
-  return AxisInfo(knownContiguity, knownDivisibility, knownConstancy);
+  return AxisInfo(knownContiguity, knownDivisibility, knownConstancy,
+                  std::nullopt, fitRange(value.getType(), knownRange));
 }
 
 /*static*/ AxisInfo AxisInfo::join(const AxisInfo &lhs, const AxisInfo &rhs) {
@@ -1194,7 +1465,12 @@ void AxisInfo::initPessimisticStateFromFunc(int argNumber, T funcOp,
       rhs.getConstantValue().has_value() &&
       lhs.getConstantValue() == rhs.getConstantValue())
     constantValue = lhs.getConstantValue();
-  return AxisInfo(contiguity, divisibility, constancy, constantValue);
+  // Keeping only equal ranges instead of their union makes sure that the
+  // ranges of loop-carried values converge
+  std::optional<RangeT> range;
+  if (lhs.getRange() == rhs.getRange())
+    range = lhs.getRange();
+  return AxisInfo(contiguity, divisibility, constancy, constantValue, range);
 }
 
 unsigned ModuleAxisInfoAnalysis::getPtrContiguity(Value ptr) {
@@ -1267,6 +1543,26 @@ unsigned ModuleAxisInfoAnalysis::getMaskAlignment(Value mask) {
   return alignment;
 }
 
+void ModuleAxisInfoAnalysis::copyAxisInfo(Value from, Value to) {
+  auto *fromInfo = getAxisInfo(from);
+  auto funcOp = to.getParentRegion()->getParentOfType<FunctionOpInterface>();
+  auto *axisInfoMap = getFuncData(funcOp);
+  if (!fromInfo || !axisInfoMap)
+    return;
+  // Copy first, the insertion may invalidate fromInfo
+  AxisInfo info = *fromInfo;
+  (*axisInfoMap)[to] = info;
+}
+
+void ModuleAxisInfoAnalysis::eraseAxisInfo(Operation *op) {
+  auto funcOp = op->getParentOfType<FunctionOpInterface>();
+  auto *axisInfoMap = getFuncData(funcOp);
+  if (!axisInfoMap)
+    return;
+  for (Value result : op->getResults())
+    axisInfoMap->erase(result);
+}
+
 void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp) {
   std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
   AxisInfoAnalysis *analysis = solver->load<AxisInfoAnalysis>();
@@ -1,18 +1,82 @@
 #include "triton/Analysis/Membar.h"
 #include "triton/Analysis/Alias.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Interfaces/ControlFlowInterfaces.h"
 #include <deque>
 
 namespace mlir {
 
+namespace {
+// Returns the tensor moved between registers and shared memory by ops whose
+// accesses are tracked per warp.
+RankedTensorType getWarpAccessTensorType(Operation *op) {
+  if (auto localLoad = dyn_cast<triton::gpu::LocalLoadOp>(op))
+    return localLoad.getType();
+  if (auto localStore = dyn_cast<triton::gpu::LocalStoreOp>(op))
+    return localStore.getSrc().getType();
+  if (auto localAlloc = dyn_cast<triton::gpu::LocalAllocOp>(op))
+    if (localAlloc.getSrc())
+      return localAlloc.getSrc().getType();
+  return RankedTensorType();
+}
+} // namespace
+
+unsigned BlockInfo::getNumWarpsToSync(const BlockInfo &other,
+                                      unsigned numWarps) const {
+  if (isIntersected(other))
+    return numWarps;
+  auto conflicts = [](const Interval<size_t> &lhs, bool lhsIsWrite,
+                      const Interval<size_t> &rhs, bool rhsIsWrite) {
+    return (lhsIsWrite || rhsIsWrite) && lhs.intersects(rhs);
+  };
+  // Accesses whose warps are not known have to be ordered with every warp.
+  for (auto &access : warpAccesses) {
+    for (auto &interval : other.syncReadIntervals)
+      if (conflicts(access.interval, access.isWrite, interval, false))
+        return numWarps;
+    for (auto &interval : other.syncWriteIntervals)
+      if (conflicts(access.interval, access.isWrite, interval, true))
+        return numWarps;
+  }
+  for (auto &access : other.warpAccesses) {
+    for (auto &interval : syncReadIntervals)
+      if (conflicts(interval, false, access.interval, access.isWrite))
+        return numWarps;
+    for (auto &interval : syncWriteIntervals)
+      if (conflicts(interval, true, access.interval, access.isWrite))
+        return numWarps;
+  }
+  unsigned numWarpsToSync = 0;
+  for (auto &lhs : warpAccesses) {
+    for (auto &rhs : other.warpAccesses) {
+      if (!conflicts(lhs.interval, lhs.isWrite, rhs.interval, rhs.isWrite))
+        continue;
+      // Different views of the buffer may place the elements differently.
+      unsigned groupSize =
+          lhs.memDesc == rhs.memDesc
+              ? getNumWarpsExchangingData(lhs.tensorType, rhs.tensorType,
+                                          numWarps)
+              : numWarps;
+      if (groupSize <= lhs.syncedWarps)
+        continue;
+      numWarpsToSync = std::max(numWarpsToSync, groupSize);
+    }
+  }
+  return numWarpsToSync;
+}
+
 void MembarAnalysis::run(FuncBlockInfoMapT &funcBlockInfoMap) {
   FunctionOpInterface funcOp =
       dyn_cast<FunctionOpInterface>(allocation->getOperation());
+  if (auto mod = funcOp->getParentOfType<ModuleOp>())
+    if (mod->hasAttr(triton::gpu::TritonGPUDialect::getNumWarpsAttrName()))
+      numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
   OpBuilder builder(funcOp.getContext());
   resolve(funcOp, &funcBlockInfoMap, &builder);
 }
@@ -24,6 +88,8 @@ void MembarAnalysis::resolve(FunctionOpInterface funcOp,
   DenseMap<Block *, BlockInfo> inputBlockInfoMap;
   DenseMap<Block *, BlockInfo> outputBlockInfoMap;
   std::deque<Block *> blockList;
+  inputBlockInfoMap[&funcOp.getFunctionBody().front()].unsyncedSinceEntry =
+      true;
   funcOp.walk<WalkOrder::PreOrder>([&](Block *block) {
     for (auto &op : block->getOperations()) {
       // Check if the operation belongs to scf dialect, if so, we need to
@@ -73,9 +139,12 @@ void MembarAnalysis::resolve(FunctionOpInterface funcOp,
   auto &funcBlockInfo = (*funcBlockInfoMap)[funcOp];
   funcOp.walk<WalkOrder::PreOrder>([&](Block *block) {
     block->walk([&](triton::ReturnOp returnOp) {
-      funcBlockInfo.join(outputBlockInfoMap[block]);
+      funcBlockInfo.exit.join(outputBlockInfoMap[block]);
     });
   });
+  funcBlockInfo.mayReturnUnsynced = funcBlockInfo.exit.unsyncedSinceEntry;
+  funcBlockInfo.exit.unsyncedSinceEntry = false;
+  funcBlockInfo.entry = entryBlockInfo;
 }
 
 void MembarAnalysis::visitTerminator(Operation *op,
@@ -92,37 +161,116 @@ void MembarAnalysis::visitTerminator(Operation *op,
   llvm_unreachable("Unknown terminator encountered in membar analysis");
 }
 
-void MembarAnalysis::insertBarrier(Operation *op, OpBuilder *builder) {
+void MembarAnalysis::insertBarrier(Operation *op, OpBuilder *builder,
+                                   BlockInfo *blockInfo,
+                                   unsigned numWarpsToSync) {
   OpBuilder::InsertionGuard g(*builder);
-  auto barrierOp = builder->create<gpu::BarrierOp>(op->getLoc());
+  ++numInsertedBarriers;
+  if (!namedBarriers || numWarpsToSync >= numWarps) {
+    builder->create<gpu::BarrierOp>(op->getLoc());
+    blockInfo->sync();
+    return;
+  }
+  // Named barriers are a limited resource, use larger groups of warps when
+  // there are not enough of them.
+  while (numWarpsToSync > 1 &&
+         numWarps / numWarpsToSync >
+             triton::gpu::NamedBarrierOp::kMaxNumGroups)
+    numWarpsToSync *= 2;
+  builder->create<triton::gpu::NamedBarrierOp>(op->getLoc(), numWarpsToSync);
+  blockInfo->syncWarps(numWarpsToSync);
+}
+
+Interval<size_t>
+MembarAnalysis::getAccessInterval(Value value,
+                                  Allocation::BufferId bufferId) const {
+  auto interval = allocation->getAllocatedInterval(bufferId);
+  if (!precise)
+    return interval;
+  // Only subviews taken directly from the allocation are refined.
+  auto subview = value.getDefiningOp<triton::gpu::MemDescSubviewOp>();
+  if (!subview || allocation->getBufferId(subview.getSrc()) != bufferId)
+    return interval;
+  auto srcTy = subview.getSrc().getType();
+  auto dstTy = subview.getType();
+  auto srcShape = srcTy.getShape();
+  auto dstShape = dstTy.getShape();
+  int64_t rankReduced = srcTy.getRank() - dstTy.getRank();
+  auto shapePerCTA = triton::gpu::getShapePerCTA(srcTy);
+  if (rankReduced > 1 || ArrayRef<int64_t>(shapePerCTA) != srcShape)
+    return interval;
+  // Slices along dim 0 are contiguous only if it is the slowest varying
+  // dimension.
+  auto sharedEnc =
+      dyn_cast<triton::gpu::SharedEncodingAttr>(srcTy.getEncoding());
+  if (!sharedEnc || sharedEnc.getOrder().size() != srcShape.size() ||
+      sharedEnc.getOrder().back() != 0)
+    return interval;
+  // The subview must select whole slices of the allocation.
+  if (ArrayRef<int64_t>(srcShape).drop_front() !=
+      ArrayRef<int64_t>(dstShape).drop_front(1 - rankReduced))
+    return interval;
+  // Non-constant offsets, e.g. the stage index of a pipelined loop, are not
+  // refined.
+  SmallVector<int64_t> offsets;
+  for (Value offset : subview.getOffsets()) {
+    APInt offsetValue;
+    if (!matchPattern(offset, m_ConstantInt(&offsetValue)))
+      return interval;
+    offsets.push_back(offsetValue.getSExtValue());
+  }
+  if (llvm::any_of(ArrayRef<int64_t>(offsets).drop_front(),
+                   [](int64_t offset) { return offset != 0; }))
+    return interval;
+  size_t sliceBytes = product<int64_t>(srcShape.drop_front()) *
+                      srcTy.getElementTypeBitWidth() / 8;
+  size_t numSlices = rankReduced ? 1 : dstShape[0];
+  size_t start = interval.start() + offsets[0] * sliceBytes;
+  size_t end = start + numSlices * sliceBytes;
+  if (offsets[0] < 0 || end > interval.end())
+    return interval;
+  return Interval<size_t>(start, end);
 }
 
 void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
                             FuncBlockInfoMapT *funcBlockInfoMap,
                             OpBuilder *builder) {
-  if (isa<gpu::BarrierOp>(op)) {
-    // If the current op is a barrier, we sync previous reads and writes
+  if (isa<gpu::BarrierOp, triton::GridSyncOp, triton::SignalWaitOp>(op)) {
+    // If the current op is a barrier, we sync previous reads and writes. Grid
+    // syncs and signal waits are lowered with barriers.
     blockInfo->sync();
     return;
   }
 
+  if (auto namedBarrier = dyn_cast<triton::gpu::NamedBarrierOp>(op)) {
+    blockInfo->syncWarps(namedBarrier.getNumWarps());
+    return;
+  }
+
   if (isa<triton::gpu::AsyncWaitOp>(op) &&
       !isa<gpu::BarrierOp>(op->getNextNode())) {
     // If the current op is an async wait and the next op is not a barrier we
     // insert a barrier op and sync
     builder->setInsertionPointAfter(op);
-    insertBarrier(op, builder);
-    blockInfo->sync();
+    insertBarrier(op, builder, blockInfo, numWarps);
     return;
   }
 
   BlockInfo curBlockInfo;
+  std::optional<FuncBlockInfo> calleeBlockInfo;
+  size_t calleeOffset = 0;
   if (isa<triton::CallOp>(op)) {
-    // Inter-function dependencies
+    // Inter-function dependencies. The callee's shared memory starts at the
+    // scratch buffer of the call.
     auto callOpInterface = dyn_cast<CallOpInterface>(op);
     if (auto callee =
-            dyn_cast<FunctionOpInterface>(callOpInterface.resolveCallable()))
-      curBlockInfo = funcBlockInfoMap->lookup(callee);
+            dyn_cast<FunctionOpInterface>(callOpInterface.resolveCallable())) {
+      calleeBlockInfo = funcBlockInfoMap->lookup(callee);
+      auto bufferId = allocation->getBufferId(op);
+      if (bufferId != Allocation::InvalidBufferId)
+        calleeOffset = allocation->getOffset(bufferId);
+      curBlockInfo = calleeBlockInfo->entry.shift(calleeOffset);
+    }
   } else {
     // Intra-function dependencies
     if (auto memoryEffectOpInterface = dyn_cast<MemoryEffectOpInterface>(op)) {
@@ -130,16 +278,25 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
       SmallVector<SideEffects::EffectInstance<MemoryEffects::Effect>>
           effectInstances;
       memoryEffectOpInterface.getEffects(effectInstances);
+      RankedTensorType warpAccessTy =
+          namedBarriers ? getWarpAccessTensorType(op) : RankedTensorType();
       for (auto effectInstance : effectInstances) {
         if (auto value = effectInstance.getValue()) {
           for (auto bufferId : allocation->getBufferIds(value)) {
             if (bufferId != Allocation::InvalidBufferId) {
-              if (isa<MemoryEffects::Write>(effectInstance.getEffect()))
+              bool isWrite =
+                  isa<MemoryEffects::Write>(effectInstance.getEffect());
+              if (warpAccessTy && isa<triton::gpu::MemDescType>(
+                                      value.getType())) {
+                curBlockInfo.warpAccesses.insert(BlockInfo::WarpAccess{
+                    getAccessInterval(value, bufferId), isWrite, value,
+                    warpAccessTy});
+              } else if (isWrite)
                 curBlockInfo.syncWriteIntervals.insert(
-                    allocation->getAllocatedInterval(bufferId));
+                    getAccessInterval(value, bufferId));
               else if (isa<MemoryEffects::Read>(effectInstance.getEffect()))
                 curBlockInfo.syncReadIntervals.insert(
-                    allocation->getAllocatedInterval(bufferId));
+                    getAccessInterval(value, bufferId));
             }
           }
         }
@@ -155,10 +312,19 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     }
   }
 
-  if (blockInfo->isIntersected(curBlockInfo)) {
+  if (unsigned numWarpsToSync =
+          blockInfo->getNumWarpsToSync(curBlockInfo, numWarps)) {
     builder->setInsertionPoint(op);
-    insertBarrier(op, builder);
-    blockInfo->sync();
+    insertBarrier(op, builder, blockInfo, numWarpsToSync);
+  }
+  if (blockInfo->unsyncedSinceEntry)
+    entryBlockInfo.join(curBlockInfo);
+  if (calleeBlockInfo) {
+    // Only the accesses after the last barrier of the callee are pending
+    // after the call.
+    if (!calleeBlockInfo->mayReturnUnsynced)
+      blockInfo->sync();
+    curBlockInfo = calleeBlockInfo->exit.shift(calleeOffset);
   }
   // Update the region info, even if barrier is inserted, we have to maintain
   // the current op's read/write buffers.
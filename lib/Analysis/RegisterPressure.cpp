@@ -0,0 +1,71 @@
+#include "triton/Analysis/RegisterPressure.h"
+
+#include <algorithm>
+
+#include "mlir/Analysis/Liveness.h"
+#include "triton/Dialect/Triton/IR/Types.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+namespace mlir {
+
+namespace {
+
+unsigned getBitWidth(Type type) {
+  if (isa<triton::PointerType>(type))
+    return 64;
+  if (type.isIntOrIndexOrFloat())
+    return type.isIndex() ? 64 : type.getIntOrFloatBitWidth();
+  return 0;
+}
+
+} // namespace
+
+unsigned RegisterPressureAnalysis::getRegisters(Type type) {
+  auto tensorType = dyn_cast<RankedTensorType>(type);
+  if (!tensorType) {
+    unsigned bits = getBitWidth(type);
+    return (bits + 31) / 32;
+  }
+  // tensors without a distributed layout are not lowered to registers
+  if (!tensorType.getEncoding())
+    return 0;
+  // elements narrower than a byte still take a byte of a register
+  unsigned bits = std::max(getBitWidth(tensorType.getElementType()), 8u);
+  unsigned elems = triton::gpu::getTotalElemsPerThread(tensorType);
+  return (elems * bits + 31) / 32;
+}
+
+RegisterPressureAnalysis::RegisterPressureAnalysis(
+    FunctionOpInterface funcOp) {
+  Liveness liveness(funcOp);
+  funcOp.walk([&](Operation *op) {
+    if (op == funcOp.getOperation())
+      return;
+    // The values live across the ops that hold the region of `op` are live
+    // at `op` too, even when the region does not use them.
+    llvm::SmallPtrSet<Value, 16> live;
+    for (Operation *cur = op; cur && cur != funcOp.getOperation();
+         cur = cur->getParentOp()) {
+      const LivenessBlockInfo *info = liveness.getLiveness(cur->getBlock());
+      if (!info)
+        continue;
+      for (Value value : info->currentlyLiveValues(cur)) {
+        // the results of the ops holding `op` are defined after it runs
+        if (cur != op && value.getDefiningOp() == cur)
+          continue;
+        live.insert(value);
+      }
+    }
+    unsigned regs = 0;
+    for (Value value : live)
+      regs += getRegisters(value.getType());
+    registers[op] = regs;
+    if (!maxOp || regs > maxRegisters) {
+      maxRegisters = regs;
+      maxOp = op;
+    }
+  });
+}
+
+} // namespace mlir
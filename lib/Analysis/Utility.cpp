@@ -1,6 +1,7 @@
 #include "triton/Analysis/Utility.h"
 
 #include <deque>
+#include <map>
 
 #include "mlir/Analysis/DataFlow/ConstantPropagationAnalysis.h"
 #include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
@@ -175,7 +176,7 @@ bool ReduceOpHelper::isWarpSynchronous() {
 SmallVector<unsigned> ReduceOpHelper::getScratchConfig() {
   SmallVector<unsigned> smemShape;
   // that case doesn't need inter-warp communication
-  if (isWarpSynchronous())
+  if (isWarpSynchronous() && isReduceWithinCTA())
     return {0, 0};
 
   smemShape = convertType<unsigned>(getSrcShape());
@@ -188,13 +189,58 @@ unsigned ReduceOpHelper::getScratchSizeInBytes() {
   auto smemShape = getScratchConfig();
   auto elems = product<unsigned>(smemShape);
 
+  SmallVector<bool> uniform = getUniformOperands();
   unsigned bytesPerElem = 0;
-  for (const auto &ty : srcElementTypes) {
-    bytesPerElem += ceil<unsigned>(ty.getIntOrFloatBitWidth(), 8);
+  for (const auto &[i, ty] : llvm::enumerate(srcElementTypes)) {
+    if (!uniform[i])
+      bytesPerElem += ceil<unsigned>(ty.getIntOrFloatBitWidth(), 8);
   }
   return bytesPerElem * elems;
 }
 
+SmallVector<bool> ReduceOpHelper::getUniformOperands() {
+  unsigned numOperands = op.getNumOperands();
+  SmallVector<bool> uniform(numOperands);
+  for (unsigned i = 0; i < numOperands; ++i) {
+    Value operand = op.getOperands()[i];
+    SplatElementsAttr splat;
+    uniform[i] = operand.getDefiningOp<triton::SplatOp>() ||
+                 matchPattern(operand, m_Constant(&splat));
+  }
+  // Drop the operands whose combination reads the other operands, until the
+  // remaining ones only depend on each other.
+  Block &combine = op.getCombineOp().front();
+  auto returnOp = cast<triton::ReduceReturnOp>(combine.getTerminator());
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (unsigned i = 0; i < numOperands; ++i) {
+      if (!uniform[i])
+        continue;
+      SmallVector<Value> worklist = {returnOp.getResult()[i]};
+      DenseSet<Value> visited;
+      while (!worklist.empty() && uniform[i]) {
+        Value value = worklist.pop_back_val();
+        if (!visited.insert(value).second)
+          continue;
+        if (auto arg = dyn_cast<BlockArgument>(value)) {
+          if (arg.getOwner() == &combine)
+            uniform[i] = uniform[arg.getArgNumber() % numOperands];
+          continue;
+        }
+        Operation *def = value.getDefiningOp();
+        if (def->getNumRegions() != 0)
+          uniform[i] = false;
+        worklist.append(def->operand_begin(), def->operand_end());
+      }
+      changed |= !uniform[i];
+    }
+  }
+  if (llvm::all_of(uniform, [](bool u) { return u; }))
+    return SmallVector<bool>(numOperands, false);
+  return uniform;
+}
+
 bool ReduceOpHelper::isReduceWithinCTA() {
   auto axis = getAxis();
   auto srcLayout = getSrcLayout();
@@ -204,12 +250,6 @@ bool ReduceOpHelper::isReduceWithinCTA() {
 }
 
 bool ReduceOpHelper::isSupportedLayout() {
-  // Layout optimization passes such as PlanCTAPass and
-  // RemoveLayoutConversionPass should avoid cross-CTA reduction
-  if (!isReduceWithinCTA()) {
-    return false;
-  }
-
   auto srcLayout = getSrcLayout();
   if (isa<BlockedEncodingAttr>(srcLayout)) {
     return true;
@@ -310,6 +350,200 @@ unsigned ScanLoweringHelper::getScratchSizeInElems() {
   return numElements;
 }
 
+unsigned HistogramOpHelper::getNumBins() {
+  auto mod = histogramOp->getParentOfType<ModuleOp>();
+  unsigned threadsPerWarp =
+      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  return std::max<unsigned>(histogramOp.getType().getDimSize(0),
+                            threadsPerWarp);
+}
+
+bool HistogramOpHelper::useWarpAggregatedAtomics() {
+  // The ballot based histogram does a popcount per input element for every
+  // bin owned by a lane, which stops paying off once each lane owns more than
+  // a few bins.
+  constexpr unsigned kMaxBinsPerLane = 4;
+  auto mod = histogramOp->getParentOfType<ModuleOp>();
+  unsigned threadsPerWarp =
+      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  return getNumBins() > kMaxBinsPerLane * threadsPerWarp;
+}
+
+unsigned HistogramOpHelper::getNumPrivateHistograms() {
+  if (!useWarpAggregatedAtomics())
+    return 1;
+  // Giving each warp its own sub-histogram removes the atomic collisions
+  // between warps, but each copy has to be cleared and merged. Only add copies
+  // while every copy still gets about one update per bin, and keep the total
+  // scratch size bounded.
+  constexpr unsigned kMaxScratchBytes = 16 * 1024;
+  auto srcType = histogramOp.getSrc().getType();
+  unsigned numBins = getNumBins();
+  unsigned numWarpsWithUniqueData = triton::gpu::getWarpsPerCTAWithUniqueData(
+      srcType.getEncoding(), srcType.getShape())[0];
+  unsigned bytesPerHistogram =
+      numBins *
+      std::max<unsigned>(1, histogramOp.getType().getElementTypeBitWidth() / 8);
+  unsigned numCopies = std::min<unsigned>(
+      {numWarpsWithUniqueData,
+       std::max<unsigned>(1, srcType.getNumElements() / numBins),
+       std::max<unsigned>(1, kMaxScratchBytes / bytesPerHistogram)});
+  return 1u << llvm::Log2_32(numCopies);
+}
+
+unsigned HistogramOpHelper::getScratchSizeInBytes() {
+  auto dstTy = histogramOp.getType();
+  return getNumBins() * getNumPrivateHistograms() *
+         std::max<unsigned>(8, dstTy.getElementTypeBitWidth()) / 8;
+}
+
+std::optional<SmallVector<std::pair<StringAttr, int>>>
+SortOpHelper::getAxisBits() {
+  auto srcTy = cast<RankedTensorType>(sortOp.getSrcs()[0].getType());
+  auto layout =
+      triton::gpu::toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  if (!layout)
+    return std::nullopt;
+  unsigned axis = srcTy.getRank() - 1;
+  StringAttr kBlock = StringAttr::get(sortOp.getContext(), "block");
+  SmallVector<std::pair<StringAttr, int>> axisBits(
+      llvm::Log2_64(srcTy.getShape().back()));
+  SmallVector<bool> found(axisBits.size(), false);
+  for (StringAttr inDim : layout->getInDimNames()) {
+    for (int i = 0; i < layout->getInDimSizeLog2(inDim); ++i) {
+      ArrayRef<int32_t> basis = layout->getBasis(inDim, i);
+      if (basis[axis] == 0)
+        continue;
+      // Each bit of the position has to come from a single bit of the
+      // hardware that moves along the sorted dimension only. The positions
+      // held by the other CTAs of a cluster can't be reached either.
+      for (unsigned d = 0; d < basis.size(); ++d)
+        if (d != axis && basis[d] != 0)
+          return std::nullopt;
+      if (inDim == kBlock || !llvm::isPowerOf2_32(basis[axis]))
+        return std::nullopt;
+      unsigned bit = llvm::Log2_32(basis[axis]);
+      if (found[bit])
+        return std::nullopt;
+      found[bit] = true;
+      axisBits[bit] = {inDim, i};
+    }
+  }
+  if (!llvm::all_of(found, [](bool f) { return f; }))
+    return std::nullopt;
+  return axisBits;
+}
+
+bool SortOpHelper::isWarpSynchronous() {
+  auto axisBits = getAxisBits();
+  if (!axisBits)
+    return true;
+  return llvm::none_of(*axisBits, [](const auto &bit) {
+    return bit.first.getValue() == "warp";
+  });
+}
+
+unsigned SortOpHelper::getScratchSizeInBytes() {
+  if (isWarpSynchronous())
+    return 0;
+  // The exchanges between warps store every element of every operand.
+  auto srcTy = cast<RankedTensorType>(sortOp.getSrcs()[0].getType());
+  auto mod = sortOp->getParentOfType<ModuleOp>();
+  unsigned numThreads = TritonGPUDialect::getNumWarps(mod) *
+                        TritonGPUDialect::getThreadsPerWarp(mod);
+  unsigned elementSizeInBytes = 0;
+  for (Value src : sortOp.getSrcs()) {
+    auto ty = cast<RankedTensorType>(src.getType());
+    elementSizeInBytes += ceil<unsigned>(ty.getElementTypeBitWidth(), 8);
+  }
+  return elementSizeInBytes * getTotalElemsPerThread(srcTy) * numThreads;
+}
+
+GatherOpHelper::GatherOpHelper(triton::GatherOp op) : gatherOp(op) {
+  auto srcTy = op.getSrc().getType();
+  auto indicesTy = op.getIndices().getType();
+  auto srcLayout =
+      triton::gpu::toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  auto indicesLayout = triton::gpu::toLinearLayout(indicesTy.getShape(),
+                                                   indicesTy.getEncoding());
+  if (!srcLayout || !indicesLayout)
+    return;
+  MLIRContext *ctx = op.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  unsigned axis = op.getAxis();
+  auto withoutAxis = [&](ArrayRef<int32_t> basis) {
+    SmallVector<int32_t> coords(basis);
+    coords[axis] = 0;
+    return coords;
+  };
+
+  axisLaneBits.assign(llvm::Log2_64(srcTy.getDimSize(axis)), -1);
+  for (StringAttr inDim : srcLayout->getInDimNames()) {
+    for (int i = 0; i < srcLayout->getInDimSizeLog2(inDim); ++i) {
+      ArrayRef<int32_t> basis = srcLayout->getBasis(inDim, i);
+      if (basis[axis] == 0)
+        continue;
+      if (inDim != kLane || !llvm::isPowerOf2_32(basis[axis]) ||
+          llvm::any_of(withoutAxis(basis), [](int32_t x) { return x != 0; }))
+        return;
+      int &laneBit = axisLaneBits[llvm::Log2_32(basis[axis])];
+      if (laneBit != -1)
+        return;
+      laneBit = i;
+    }
+  }
+  if (llvm::is_contained(axisLaneBits, -1))
+    return;
+
+  // A thread reads the lane of its own warp that has its other coordinates.
+  for (StringAttr inDim : srcLayout->getInDimNames()) {
+    if (inDim == kRegister)
+      continue;
+    if (srcLayout->getInDimSizeLog2(inDim) !=
+        indicesLayout->getInDimSizeLog2(inDim))
+      return;
+    for (int i = 0; i < srcLayout->getInDimSizeLog2(inDim); ++i) {
+      if (withoutAxis(srcLayout->getBasis(inDim, i)) !=
+          withoutAxis(indicesLayout->getBasis(inDim, i)))
+        return;
+    }
+  }
+  for (int i = 0; i < indicesLayout->getInDimSizeLog2(kRegister); ++i) {
+    auto coords = withoutAxis(indicesLayout->getBasis(kRegister, i));
+    if (llvm::all_of(coords, [](int32_t x) { return x == 0; })) {
+      srcRegisterBases.push_back(0);
+      continue;
+    }
+    int srcBit = -1;
+    for (int j = 0; j < srcLayout->getInDimSizeLog2(kRegister); ++j) {
+      if (ArrayRef<int32_t>(coords) == srcLayout->getBasis(kRegister, j))
+        srcBit = j;
+    }
+    if (srcBit == -1)
+      return;
+    srcRegisterBases.push_back(1u << srcBit);
+  }
+  warpLocal = true;
+}
+
+unsigned GatherOpHelper::getSrcRegister(unsigned reg) {
+  unsigned srcReg = 0;
+  for (unsigned i = 0; i < srcRegisterBases.size(); ++i) {
+    if (reg & (1u << i))
+      srcReg ^= srcRegisterBases[i];
+  }
+  return srcReg;
+}
+
+unsigned GatherOpHelper::getScratchSizeInBytes() {
+  if (isWarpLocal())
+    return 0;
+  auto srcTy = gatherOp.getSrc().getType();
+  return srcTy.getNumElements() *
+         ceil<unsigned>(srcTy.getElementTypeBitWidth(), 8);
+}
+
 unsigned ScanLoweringHelper::getScratchSizeInBytes() {
   unsigned axisNumWarps = getAxisNumWarpsWithUniqueData();
   if (axisNumWarps == 1)
@@ -458,12 +692,14 @@ bool supportMFMATypes(Type a, Type b) {
 }
 
 bool supportMFMA(triton::DotOp op) {
+  return supportMFMA(op, op.getA().getType().getElementType(),
+                     op.getB().getType().getElementType());
+}
+
+bool supportMFMA(triton::DotOp op, Type aElemTy, Type bElemTy) {
   auto aTy = cast<RankedTensorType>(op.getA().getType());
   auto bTy = cast<RankedTensorType>(op.getB().getType());
 
-  auto aElemTy = aTy.getElementType();
-  auto bElemTy = bTy.getElementType();
-
   if (!supportMFMATypes(aElemTy, bElemTy))
     return false;
 
@@ -632,32 +868,19 @@ bool matchMmaV3AndDotOperandLayout(RankedTensorType srcTy,
 }
 
 bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy) {
-  MLIRContext *ctx = srcTy.getContext();
   std::optional<LinearLayout> srcLayout =
       toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
   std::optional<LinearLayout> dstLayout =
       toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
   if (srcLayout.has_value() && dstLayout.has_value()) {
-    // comp describes the layout function for converting from src to dst.
-    LinearLayout comp = srcLayout->invertAndCompose(*dstLayout);
-    StringAttr kLane = StringAttr::get(ctx, "lane");
-    StringAttr kWarp = StringAttr::get(ctx, "warp");
-    StringAttr kBlock = StringAttr::get(ctx, "block");
     // In principle, there's no need for shared memory if there's no
-    // communication between warps.  However, right now we only have implemented
-    // the shortcut case where there's no communication between *threads*.
-    //
-    // TODO(jlebar): Remove the kLane layout once we add support for
-    // shuffle-based layout conversions in ConvertLayoutToLLVM.
-    if (comp.divideRight(LinearLayout::identity1D(comp.getInDimSize(kLane),
-                                                  kLane, kLane) *
-                         LinearLayout::identity1D(comp.getInDimSize(kWarp),
-                                                  kWarp, kWarp) *
-                         LinearLayout::identity1D(comp.getInDimSize(kBlock),
-                                                  kBlock, kBlock))
-            .has_value()) {
+    // communication between warps.  Right now we handle conversions with no
+    // communication between threads, and conversions within a warp that
+    // getWarpShuffleLayout or getMfmaToBlockedLanePermute accept.
+    if (getRegisterPermutationLayout(srcTy, dstTy).has_value() ||
+        getWarpShuffleLayout(srcTy, dstTy).has_value() ||
+        getMfmaToBlockedLanePermute(srcTy, dstTy).has_value())
       return false;
-    }
   }
 
   // TODO(jlebar): Remove these special cases once they're fully subsumed by the
@@ -667,6 +890,241 @@ bool cvtNeedsSharedMemory(RankedTensorType srcTy, RankedTensorType dstTy) {
          !isMfmaToDotShortcut(srcTy, dstTy);
 }
 
+unsigned getNumWarpsExchangingData(RankedTensorType srcTy,
+                                   RankedTensorType dstTy, unsigned numWarps) {
+  if (srcTy.getShape() != dstTy.getShape())
+    return numWarps;
+  std::optional<LinearLayout> srcLayout =
+      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  std::optional<LinearLayout> dstLayout =
+      toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
+  if (!srcLayout.has_value() || !dstLayout.has_value())
+    return numWarps;
+  // An element held by several threads may be accessed by any of them.
+  if (srcLayout->getTotalInDimSizeLog2() !=
+          srcLayout->getTotalOutDimSizeLog2() ||
+      dstLayout->getTotalInDimSizeLog2() != dstLayout->getTotalOutDimSizeLog2())
+    return numWarps;
+  MLIRContext *ctx = srcTy.getContext();
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  if (srcLayout->getInDimSize(kBlock) != 1)
+    return numWarps;
+  // comp maps each source location to the destination location holding the
+  // same element. As it is linear, the source and destination warps agree
+  // above some bit everywhere iff they agree on every basis vector.
+  LinearLayout comp = *toLinearLayoutConversion(
+      srcTy.getShape(), srcTy.getEncoding(), dstTy.getEncoding());
+  unsigned groupSize = 1;
+  for (StringAttr inDim : comp.getInDimNames()) {
+    for (int i = 0; i < comp.getInDimSizeLog2(inDim); ++i) {
+      int32_t srcWarp = inDim == kWarp ? 1 << i : 0;
+      uint32_t diff = srcWarp ^ comp.getBasis(inDim, i, kWarp);
+      if (diff != 0)
+        groupSize = std::max<unsigned>(groupSize, llvm::NextPowerOf2(diff));
+    }
+  }
+  return std::min(groupSize, numWarps);
+}
+
+std::optional<LinearLayout>
+getRegisterPermutationLayout(RankedTensorType srcTy, RankedTensorType dstTy) {
+  MLIRContext *ctx = srcTy.getContext();
+  std::optional<LinearLayout> srcLayout =
+      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  std::optional<LinearLayout> dstLayout =
+      toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
+  if (!srcLayout.has_value() || !dstLayout.has_value())
+    return std::nullopt;
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  // Both layouts are linear, so the elements of a thread are the ones of the
+  // first thread shifted by the same offset in both layouts iff the lane, warp
+  // and block bases agree. This holds regardless of how the layouts broadcast,
+  // whereas the conversion layout picks one of the locations of each element.
+  for (StringAttr inDim : srcLayout->getInDimNames()) {
+    if (inDim == kRegister)
+      continue;
+    if (srcLayout->getInDimSizeLog2(inDim) !=
+        dstLayout->getInDimSizeLog2(inDim))
+      return std::nullopt;
+    for (int i = 0; i < srcLayout->getInDimSizeLog2(inDim); ++i) {
+      for (StringAttr outDim : srcLayout->getOutDimNames()) {
+        if (srcLayout->getBasis(inDim, i, outDim) !=
+            dstLayout->getBasis(inDim, i, outDim))
+          return std::nullopt;
+      }
+    }
+  }
+
+  // Find a source register holding the element of every destination register
+  // basis. Any choice keeps the map linear, as xoring registers xors the
+  // elements they hold.
+  auto getElement = [&](const LinearLayout &layout, int reg) {
+    SmallVector<std::pair<StringAttr, int32_t>> ins;
+    for (StringAttr inDim : layout.getInDimNames())
+      ins.push_back({inDim, inDim == kRegister ? reg : 0});
+    return llvm::to_vector(llvm::make_second_range(layout.apply(ins)));
+  };
+  int numSrcRegs = srcLayout->getInDimSize(kRegister);
+  std::map<SmallVector<int32_t>, int32_t> srcRegOfElement;
+  for (int reg = numSrcRegs - 1; reg >= 0; --reg)
+    srcRegOfElement[getElement(*srcLayout, reg)] = reg;
+  std::vector<std::vector<int32_t>> regBases;
+  for (int i = 0; i < dstLayout->getInDimSizeLog2(kRegister); ++i) {
+    auto it = srcRegOfElement.find(getElement(*dstLayout, 1 << i));
+    if (it == srcRegOfElement.end())
+      return std::nullopt;
+    regBases.push_back({it->second});
+  }
+  return LinearLayout({{kRegister, std::move(regBases)}},
+                      {{kRegister, numSrcRegs}},
+                      /*requireSurjective=*/false);
+}
+
+std::optional<LinearLayout> getWarpShuffleLayout(RankedTensorType srcTy,
+                                                 RankedTensorType dstTy) {
+  MLIRContext *ctx = srcTy.getContext();
+  std::optional<LinearLayout> srcLayout =
+      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  std::optional<LinearLayout> dstLayout =
+      toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
+  if (!srcLayout.has_value() || !dstLayout.has_value())
+    return std::nullopt;
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  // comp maps each destination location to a source location holding the same
+  // element. The warp and block must be left unchanged.
+  LinearLayout comp = *toLinearLayoutConversion(
+      dstTy.getShape(), dstTy.getEncoding(), srcTy.getEncoding());
+  std::optional<LinearLayout> inWarp = comp.divideRight(
+      LinearLayout::identity1D(comp.getInDimSize(kWarp), kWarp, kWarp) *
+      LinearLayout::identity1D(comp.getInDimSize(kBlock), kBlock, kBlock));
+  if (!inWarp.has_value())
+    return std::nullopt;
+  // A shuffle reads the same register from every source lane, so the source
+  // register may only depend on the destination register.
+  for (int i = 0; i < inWarp->getInDimSizeLog2(kLane); ++i) {
+    if (inWarp->getBasis(kLane, i, kRegister) != 0)
+      return std::nullopt;
+  }
+  return inWarp;
+}
+
+std::optional<LanePermuteConversion>
+getMfmaToBlockedLanePermute(RankedTensorType srcTy, RankedTensorType dstTy) {
+  auto applyBases = LanePermuteConversion::apply;
+  // Every permute round lets a lane select among 2^kMaxSelectBits registers to
+  // send and to receive into; beyond that shared memory is cheaper.
+  constexpr int kMaxSelectBits = 2;
+
+  auto mfmaLayout = dyn_cast<AMDMfmaEncodingAttr>(srcTy.getEncoding());
+  if (!mfmaLayout || !isa<BlockedEncodingAttr>(dstTy.getEncoding()))
+    return std::nullopt;
+  if (!srcTy.getElementType().isIntOrFloat())
+    return std::nullopt;
+  std::optional<LinearLayout> srcLayout =
+      toLinearLayout(srcTy.getShape(), srcTy.getEncoding());
+  std::optional<LinearLayout> dstLayout =
+      toLinearLayout(dstTy.getShape(), dstTy.getEncoding());
+  if (!srcLayout.has_value() || !dstLayout.has_value())
+    return std::nullopt;
+  MLIRContext *ctx = srcTy.getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kWarp = StringAttr::get(ctx, "warp");
+  StringAttr kBlock = StringAttr::get(ctx, "block");
+  LinearLayout comp = *toLinearLayoutConversion(
+      dstTy.getShape(), dstTy.getEncoding(), srcTy.getEncoding());
+  std::optional<LinearLayout> inWarp = comp.divideRight(
+      LinearLayout::identity1D(comp.getInDimSize(kWarp), kWarp, kWarp) *
+      LinearLayout::identity1D(comp.getInDimSize(kBlock), kBlock, kBlock));
+  if (!inWarp.has_value())
+    return std::nullopt;
+
+  // Destination (register r, lane l) holds source (A(r) ^ B(l), C(r) ^ D(l)).
+  int numRegBits = inWarp->getInDimSizeLog2(kRegister);
+  int numLaneBits = inWarp->getInDimSizeLog2(kLane);
+  SmallVector<int32_t> regToReg, regToLane, laneToReg, laneToLane;
+  for (int i = 0; i < numRegBits; ++i) {
+    regToReg.push_back(inWarp->getBasis(kRegister, i, kRegister));
+    regToLane.push_back(inWarp->getBasis(kRegister, i, kLane));
+  }
+  for (int i = 0; i < numLaneBits; ++i) {
+    laneToReg.push_back(inWarp->getBasis(kLane, i, kRegister));
+    laneToLane.push_back(inWarp->getBasis(kLane, i, kLane));
+  }
+
+  // Pick, for each lane bit, a destination register offset F such that
+  // M(l) = D(l) ^ C(F(l)) is invertible: then in every round each source lane
+  // is read by exactly one lane. D alone is singular when several lanes need
+  // elements held in different registers of the same source lane; moving one
+  // of them to another round through a register of C fixes that.
+  LanePermuteConversion result;
+  result.roundLane = regToLane;
+  result.roundSrcReg = regToReg;
+  SmallVector<int32_t> span;
+  auto reduce = [&](int32_t v) {
+    for (int32_t b : span)
+      v = std::min(v, v ^ b);
+    return v;
+  };
+  for (int i = 0; i < numLaneBits; ++i) {
+    int32_t dstReg = 0;
+    int32_t lane = laneToLane[i];
+    for (int j = 0; reduce(lane) == 0 && j < numRegBits; ++j) {
+      dstReg = 1 << j;
+      lane = laneToLane[i] ^ regToLane[j];
+    }
+    if (reduce(lane) == 0)
+      return std::nullopt;
+    span.push_back(reduce(lane));
+    llvm::sort(span, std::greater<int32_t>());
+    result.laneLane.push_back(lane);
+    result.dstReg.push_back(dstReg);
+  }
+
+  // Lane l reads source register A(k ^ F(l)) ^ B(l) in round k. Written in
+  // terms of the sending lane s = C(k) ^ M(l), that is
+  // A(k) ^ E(C(k)) ^ E(s) with E = (A F ^ B) M^-1.
+  SmallVector<int32_t> invLaneLane(1 << numLaneBits);
+  for (int32_t l = 0; l < (1 << numLaneBits); ++l)
+    invLaneLane[applyBases(result.laneLane, l)] = l;
+  for (int i = 0; i < numLaneBits; ++i) {
+    int32_t l = invLaneLane[1 << i];
+    int32_t reg = applyBases(regToReg, applyBases(result.dstReg, l)) ^
+                  applyBases(laneToReg, l);
+    result.senderReg.push_back(reg);
+  }
+  for (int i = 0; i < numRegBits; ++i)
+    result.roundSrcReg[i] ^= applyBases(result.senderReg, regToLane[i]);
+
+  if (llvm::count_if(result.senderReg, [](int32_t r) { return r != 0; }) >
+          kMaxSelectBits ||
+      llvm::count_if(result.dstReg, [](int32_t r) { return r != 0; }) >
+          kMaxSelectBits)
+    return std::nullopt;
+  return result;
+}
+
+std::optional<SharedMemoryAccessStats>
+getSharedMemoryAccessStats(RankedTensorType regTy, MemDescType memTy) {
+  auto sharedEnc = dyn_cast<SharedEncodingAttr>(memTy.getEncoding());
+  Type eltTy = regTy.getElementType();
+  if (!sharedEnc || sharedEnc.getHasLeadingOffset() || !eltTy.isIntOrFloat() ||
+      regTy.getShape() != memTy.getShape())
+    return std::nullopt;
+  std::optional<LinearLayout> regLayout =
+      toLinearLayout(regTy.getShape(), regTy.getEncoding());
+  std::optional<LinearLayout> sharedLayout =
+      toLinearLayout(memTy.getShape(), sharedEnc);
+  if (!regLayout.has_value() || !sharedLayout.has_value())
+    return std::nullopt;
+  return triton::getSharedMemoryAccessStats(*regLayout, *sharedLayout,
+                                            eltTy.getIntOrFloatBitWidth());
+}
+
 bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy) {
   if (matchMmaV3AndDotOperandLayout(srcTy, dstTy))
     return true;
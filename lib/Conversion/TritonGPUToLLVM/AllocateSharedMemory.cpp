@@ -23,7 +23,19 @@ struct AllocateSharedMemory
   void runOnOperation() override {
     ModuleOp mod = getOperation();
     MLIRContext *ctx = &getContext();
-    ModuleAllocation allocation(mod);
+    auto allocStrategy = parseAllocationStrategy(strategy);
+    if (!allocStrategy) {
+      mod.emitError("unknown shared memory allocation strategy: ") << strategy;
+      return signalPassFailure();
+    }
+    // Record the strategy so that analyses re-run by later passes compute the
+    // same offsets.
+    if (*allocStrategy == AllocationStrategy::Greedy)
+      mod->removeAttr(ModuleAllocation::kStrategyAttrName);
+    else
+      mod->setAttr(ModuleAllocation::kStrategyAttrName,
+                   StringAttr::get(ctx, strategy));
+    ModuleAllocation allocation(mod, *allocStrategy);
 
     mod.walk([&](FunctionOpInterface funcOp) {
       funcOp.walk([&](Operation *op) {
@@ -43,6 +55,14 @@ struct AllocateSharedMemory
         op->setAttr("allocation.offset",
                     IntegerAttr::get(IntegerType::get(ctx, 32), offset));
       });
+      if (reportFragmentation) {
+        auto *funcAllocation = allocation.getFuncData(funcOp);
+        funcOp.emitRemark() << "shared memory: "
+                            << funcAllocation->getSharedMemorySize()
+                            << " bytes allocated, "
+                            << funcAllocation->getPeakLiveSize()
+                            << " bytes peak live";
+      }
     });
     mod->setAttr("triton_gpu.shared",
                  mlir::IntegerAttr::get(mlir::IntegerType::get(ctx, 32),
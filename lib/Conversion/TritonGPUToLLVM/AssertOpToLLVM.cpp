@@ -2,11 +2,26 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "llvm/Support/JSON.h"
 
 namespace {
 
 using namespace mlir;
 
+const char *kAssertIdAttrName = "tt.assert_id";
+const char *kAssertFailuresName = "triton_assert_failures";
+
+// The weights of a branch that is rarely taken, as for llvm.expect
+const std::pair<uint32_t, uint32_t> kUnlikelyBranchWeights = {1, 2000};
+
+LLVM::LLVMStructType getAssertFailuresType(MLIRContext *ctx) {
+  auto i32Ty = IntegerType::get(ctx, 32);
+  auto recordTy = LLVM::LLVMArrayType::get(i32Ty, 5);
+  return LLVM::LLVMStructType::getLiteral(
+      ctx, {i32Ty, LLVM::LLVMArrayType::get(recordTy,
+                                            maxRecordedAssertFailures)});
+}
+
 struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
   explicit AssertOpConversion(LLVMTypeConverter &typeConverter,
                               const TargetInfoBase &targetInfo,
@@ -23,19 +38,23 @@ struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
     auto elems = unpackLLElements(loc, adaptor.getCondition(), rewriter);
     auto elemTy = elems[0].getType();
     Value condition = int_val(elemTy.getIntOrFloatBitWidth(), 0);
+    SmallVector<Value> failed;
     for (auto elem : elems) {
       if (elemTy.isSignedInteger() || elemTy.isSignlessInteger()) {
-        condition =
-            or_(condition,
-                icmp_eq(elem, rewriter.create<LLVM::ConstantOp>(
-                                  loc, elemTy, rewriter.getZeroAttr(elemTy))));
+        failed.push_back(
+            icmp_eq(elem, rewriter.create<LLVM::ConstantOp>(
+                              loc, elemTy, rewriter.getZeroAttr(elemTy))));
+        condition = or_(condition, failed.back());
       } else {
         assert(false && "Unsupported type for assert");
         return failure();
       }
     }
-    llAssert(op, condition, adaptor.getMessage(), adaptor.getFile(),
-             adaptor.getFunc(), adaptor.getLine(), rewriter);
+    if (auto assertId = op->getAttrOfType<IntegerAttr>(kAssertIdAttrName))
+      llRecordFailure(op, condition, failed, assertId.getInt(), rewriter);
+    else
+      llAssert(op, condition, adaptor.getMessage(), adaptor.getFile(),
+               adaptor.getFunc(), adaptor.getLine(), rewriter);
     rewriter.eraseOp(op);
     return success();
   }
@@ -64,7 +83,94 @@ struct AssertOpConversion : public ConvertOpToLLVMPattern<triton::AssertOp> {
     rewriter.setInsertionPointToEnd(ifBlock);
     rewriter.create<cf::BranchOp>(loc, thenBlock);
     rewriter.setInsertionPointToEnd(prevBlock);
-    rewriter.create<cf::CondBranchOp>(loc, condition, ifBlock, thenBlock);
+    rewriter.create<LLVM::CondBrOp>(loc, condition, ifBlock, ValueRange(),
+                                    thenBlock, ValueRange(),
+                                    kUnlikelyBranchWeights);
+  }
+
+  // Count the failure, and record it if it's one of the first ones. The
+  // threads that don't fail only branch on the condition, as with
+  // __assertfail. `failed` holds whether each element of the thread fails.
+  void llRecordFailure(Operation *op, Value condition, ArrayRef<Value> failed,
+                       int assertId,
+                       ConversionPatternRewriter &rewriter) const {
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    auto ctx = rewriter.getContext();
+    auto loc = op->getLoc();
+    auto moduleOp = op->getParentOfType<ModuleOp>();
+    auto failures = moduleOp.lookupSymbol<LLVM::GlobalOp>(kAssertFailuresName);
+    assert(failures && "recorded asserts without their failures global");
+    auto failuresTy = getAssertFailuresType(ctx);
+    auto ptrTy = ptr_ty(ctx, failures.getAddrSpace());
+    // #block1
+    // if (condition) {
+    //   #block2
+    //   slot = atomicAdd(&failures.count, 1);
+    //   if (slot < maxRecordedAssertFailures) {
+    //     #block3
+    //     failures.records[slot] = {assertId, pid.x, pid.y, pid.z, index};
+    //   }
+    // }
+    // #block4
+    Block *prevBlock = op->getBlock();
+
+    Block *ifBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    rewriter.setInsertionPointToStart(ifBlock);
+    Value base = rewriter.create<LLVM::AddressOfOp>(loc, ptrTy,
+                                                    failures.getSymName());
+    Value countPtr = gep(ptrTy, failuresTy, base, ArrayRef<LLVM::GEPArg>{0, 0});
+    Value slot = rewriter.create<LLVM::AtomicRMWOp>(
+        loc, LLVM::AtomicBinOp::add, countPtr, i32_val(1),
+        LLVM::AtomicOrdering::monotonic);
+    Value isRecorded = icmp_ult(slot, i32_val(maxRecordedAssertFailures));
+
+    Block *recordBlock = rewriter.splitBlock(ifBlock, op->getIterator());
+    rewriter.setInsertionPointToStart(recordBlock);
+    SmallVector<Value> fields = {i32_val(assertId)};
+    for (int axis = 0; axis < 3; ++axis)
+      fields.push_back(targetInfo.programId(rewriter, loc, moduleOp, axis));
+    fields.push_back(getFailedIndex(
+        loc, cast<RankedTensorType>(op->getOperand(0).getType()), failed,
+        rewriter));
+    for (auto [i, field] : llvm::enumerate(fields)) {
+      Value fieldPtr =
+          gep(ptrTy, failuresTy, base,
+              ArrayRef<LLVM::GEPArg>{0, 1, slot, static_cast<int32_t>(i)});
+      store(field, fieldPtr);
+    }
+
+    Block *thenBlock = rewriter.splitBlock(recordBlock, op->getIterator());
+    rewriter.setInsertionPointToEnd(recordBlock);
+    rewriter.create<cf::BranchOp>(loc, thenBlock);
+    rewriter.setInsertionPointToEnd(ifBlock);
+    rewriter.create<cf::CondBranchOp>(loc, isRecorded, recordBlock, thenBlock);
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<LLVM::CondBrOp>(loc, condition, ifBlock, ValueRange(),
+                                    thenBlock, ValueRange(),
+                                    kUnlikelyBranchWeights);
+  }
+
+  // The row-major index in the condition of the first failing element of the
+  // thread. The condition of a failing element is always false, so its index
+  // is what tells the failures of a program apart.
+  Value getFailedIndex(Location loc, RankedTensorType condTy,
+                       ArrayRef<Value> failed,
+                       ConversionPatternRewriter &rewriter) const {
+    auto shape = llvm::to_vector(
+        llvm::map_range(condTy.getShape(), [](int64_t dim) {
+          return static_cast<unsigned>(dim);
+        }));
+    auto order = llvm::to_vector(llvm::reverse(llvm::seq<unsigned>(
+        0, static_cast<unsigned>(shape.size()))));
+    auto indices = emitIndices(loc, rewriter, targetInfo,
+                               condTy.getEncoding(), condTy,
+                               /*withCTAOffset=*/true);
+    Value index = i32_val(0);
+    for (int i = failed.size() - 1; i >= 0; --i)
+      index = select(failed[i], linearize(rewriter, loc, indices[i], shape,
+                                          order),
+                     index);
+    return index;
   }
 
 protected:
@@ -73,6 +179,38 @@ protected:
 
 } // namespace
 
+void mlir::triton::prepareRecordedAsserts(ModuleOp mod) {
+  MLIRContext *ctx = mod.getContext();
+  auto i32Ty = IntegerType::get(ctx, 32);
+  llvm::json::Array asserts;
+  mod.walk([&](triton::AssertOp op) {
+    op->setAttr(kAssertIdAttrName, IntegerAttr::get(i32Ty, asserts.size()));
+    asserts.push_back(llvm::json::Object{
+        {"message", op.getMessage().str()},
+        {"file", op.getFile().str()},
+        {"func", op.getFunc().str()},
+        {"line", op.getLine()},
+    });
+  });
+  if (asserts.empty())
+    return;
+  std::string json;
+  llvm::raw_string_ostream os(json);
+  os << llvm::json::Value(std::move(asserts));
+  mod->setAttr("tt.device_asserts", StringAttr::get(ctx, os.str()));
+
+  // A zero-initialized definition, that the launcher finds by name.
+  OpBuilder b(mod.getBodyRegion());
+  auto loc = mod.getLoc();
+  auto failuresTy = getAssertFailuresType(ctx);
+  auto global = b.create<LLVM::GlobalOp>(
+      loc, failuresTy, /*isConstant=*/false, LLVM::Linkage::External,
+      kAssertFailuresName, /*value=*/Attribute(), /*alignment=*/16,
+      /*addrSpace=*/1);
+  b.setInsertionPointToStart(b.createBlock(&global.getInitializerRegion()));
+  b.create<LLVM::ReturnOp>(loc, b.create<LLVM::ZeroOp>(loc, failuresTy));
+}
+
 void mlir::triton::populateAssertOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     const TargetInfoBase &targetInfo, PatternBenefit benefit) {
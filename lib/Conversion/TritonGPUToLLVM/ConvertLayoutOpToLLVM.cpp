@@ -309,8 +309,10 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
   // Set benefit to 2 so that this pattern applies before other convert-layout
   // conversions.  TODO(jlebar): Eventually we want this to be the only pattern.
   explicit ConvertLayoutOpUsingLinearLayoutsConversion(
-      LLVMTypeConverter &typeConverter, PatternBenefit benefit = 2)
-      : ConvertOpToLLVMPattern(typeConverter, benefit) {}
+      LLVMTypeConverter &typeConverter, const TargetInfoBase &targetInfo,
+      PatternBenefit benefit = 2)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
 
   LogicalResult
   matchAndRewrite(ConvertLayoutOp op, OpAdaptor adaptor,
@@ -341,33 +343,20 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     // We can tell which case we're in by examining `conversion`.  If e.g. the
     // block -> block mapping is {1, 2, 4, ...} then there's no movement between
     // data in different CTAs and we know we're not in case 4.
-    LinearLayout conversion = srcLayout->invertAndCompose(*dstLayout);
+    LinearLayout conversion = *gpu::toLinearLayoutConversion(
+        shape, op.getSrc().getType().getEncoding(), op.getType().getEncoding());
 
-    int numLanes = conversion.getInDimSize(str_attr("lane"));
-    int numWarps = conversion.getInDimSize(str_attr("warp"));
     int numBlocks = conversion.getInDimSize(str_attr("block"));
-
-    StringAttr kLane = str_attr("lane");
-    StringAttr kWarp = str_attr("warp");
     StringAttr kBlock = str_attr("block");
 
-    // TODO(jlebar): These checks are overly-restrictive.  For example, we can
-    // transfer by shuffling registers (case 1) if and only if all of the bases
-    // for `register` have 0s for lane, warp, and block.  But the check below is
-    // stronger than this, checking also that the choice of lane/warp/block does
-    // not affect the permutation of registers.  If we allow different
-    // lane/warp/blocks to have different permutations, we can generalize this.
-    if (std::optional<LinearLayout> c = conversion.divideRight(
-            LinearLayout::identity1D(numLanes, kLane, kLane) *
-            LinearLayout::identity1D(numWarps, kWarp, kWarp) *
-            LinearLayout::identity1D(numBlocks, kBlock, kBlock));
+    if (std::optional<LinearLayout> c =
+            getRegisterPermutationLayout(op.getSrc().getType(), op.getType());
         c.has_value()) {
       return transferWithinThread(*c, op, adaptor, rewriter);
     }
 
-    if (std::optional<LinearLayout> c = conversion.divideRight(
-            LinearLayout::identity1D(numWarps, kWarp, kWarp) *
-            LinearLayout::identity1D(numBlocks, kBlock, kBlock));
+    if (std::optional<LinearLayout> c =
+            getWarpShuffleLayout(op.getSrc().getType(), op.getType());
         c.has_value()) {
       return transferWithinLane(*c, op, adaptor, rewriter);
     }
@@ -396,10 +385,10 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
            ArrayRef{kRegister});
 
     auto inVals = unpackLLElements(loc, adaptor.getSrc(), rewriter);
-    SmallVector<Value> outVals(conversion.getOutDimSize(kRegister));
+    SmallVector<Value> outVals(conversion.getInDimSize(kRegister));
     for (int i = 0; i < conversion.getInDimSize(kRegister); i++) {
-      auto dstIdx = conversion.apply({{kRegister, i}});
-      outVals[dstIdx.begin()->second] = inVals[i];
+      auto srcIdx = conversion.apply({{kRegister, i}});
+      outVals[i] = inVals[srcIdx.begin()->second];
     }
     Value result = packLLElements(loc, getTypeConverter(), outVals, rewriter,
                                   op.getType());
@@ -407,11 +396,69 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     return success();
   }
 
+  // `conversion` maps a destination (register, lane) to the source (register,
+  // lane) holding the same element; see getWarpShuffleLayout.
   LogicalResult transferWithinLane(const LinearLayout &conversion,
                                    ConvertLayoutOp op, OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter) const {
-    // TODO(jlebar): Implement me.
-    return failure();
+    MLIRContext *ctx = op.getContext();
+    auto loc = op.getLoc();
+    StringAttr kRegister = str_attr("register");
+    StringAttr kLane = str_attr("lane");
+
+    assert(!cvtNeedsSharedMemory(op.getSrc().getType(), op.getType()));
+    assert(ArrayRef(to_vector(conversion.getInDimNames())) ==
+           (ArrayRef{kRegister, kLane}));
+
+    auto mod = op->getParentOfType<ModuleOp>();
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(threadsPerWarp));
+
+    // The source lane is a linear function of the destination lane: xor
+    // together the lane bases selected by the bits of laneId.
+    bool isLaneIdentity = true;
+    Value srcLaneBase = i32_val(0);
+    for (int i = 0; i < conversion.getInDimSizeLog2(kLane); i++) {
+      int32_t basis = conversion.getBasis(kLane, i, kLane);
+      isLaneIdentity &= basis == (1 << i);
+      Value bitSet = icmp_ne(and_(laneId, i32_val(1 << i)), i32_val(0));
+      srcLaneBase =
+          xor_(srcLaneBase, select(bitSet, i32_val(basis), i32_val(0)));
+    }
+
+    auto inVals = unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    SmallVector<Value> outVals(conversion.getInDimSize(kRegister));
+    for (int i = 0; i < conversion.getInDimSize(kRegister); i++) {
+      int32_t srcReg = 0, srcLaneOffset = 0;
+      for (auto [dim, val] : conversion.apply({{kRegister, i}, {kLane, 0}})) {
+        if (dim == kRegister)
+          srcReg = val;
+        else if (dim == kLane)
+          srcLaneOffset = val;
+      }
+      Value val = inVals[srcReg];
+      // The element already lives in this thread.
+      if (isLaneIdentity && srcLaneOffset == 0) {
+        outVals[i] = val;
+        continue;
+      }
+      Value srcLane = xor_(srcLaneBase, i32_val(srcLaneOffset));
+      outVals[i] = shuffleIdx(rewriter, loc, val, srcLane);
+    }
+    Value result = packLLElements(loc, getTypeConverter(), outVals, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
+  Value shuffleIdx(ConversionPatternRewriter &rewriter, Location loc, Value val,
+                   Value lane) const {
+    if (auto ptrTy = dyn_cast<LLVM::LLVMPointerType>(val.getType())) {
+      Value intVal = ptrtoint(i64_ty, val);
+      intVal = targetInfo.shuffleIdx(rewriter, loc, intVal, lane);
+      return inttoptr(ptrTy, intVal);
+    }
+    return targetInfo.shuffleIdx(rewriter, loc, val, lane);
   }
 
   LogicalResult transferWithinBlock(const LinearLayout &conversion,
@@ -428,6 +475,9 @@ struct ConvertLayoutOpUsingLinearLayoutsConversion
     // TODO(jlebar): Implement me.
     return failure();
   }
+
+private:
+  const TargetInfoBase &targetInfo;
 };
 
 } // namespace
@@ -440,7 +490,7 @@ void mlir::triton::populateConvertLayoutOpToLLVMPatterns(
   // Eventually the LL conversion will subsume all of the others and be the only
   // one left.
   patterns.add<gpu::ConvertLayoutOpUsingLinearLayoutsConversion>(
-      typeConverter, benefit.getBenefit() + 1);
+      typeConverter, targetInfo, benefit.getBenefit() + 1);
   patterns.add<gpu::ConvertLayoutOpConversion>(typeConverter, targetInfo,
                                                benefit);
   patterns.add<gpu::LocalLoadOpConversion>(typeConverter, targetInfo, benefit);
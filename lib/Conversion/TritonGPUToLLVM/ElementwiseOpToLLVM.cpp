@@ -1,11 +1,15 @@
+#include <cmath>
+
 #include "mlir/Conversion/LLVMCommon/Pattern.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Support/LLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/ElementwiseOpToLLVMBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
 #include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace mlir::triton::gpu;
 
@@ -17,6 +21,169 @@ Type getElementType(Value value) {
     return tensorType.getElementType();
   return type;
 }
+
+static bool isConstantInt(Value value, int64_t expected) {
+  APInt constant;
+  return matchPattern(value, m_ConstantInt(&constant)) &&
+         constant.getSExtValue() == expected;
+}
+
+std::optional<bool> getUnpackedInt4Signedness(Value value) {
+  if (!getElementTypeOrSelf(value.getType()).isInteger(8))
+    return std::nullopt;
+  if (auto shrsiOp = value.getDefiningOp<arith::ShRSIOp>()) {
+    if (isConstantInt(shrsiOp.getRhs(), 4))
+      return true;
+  } else if (auto shruiOp = value.getDefiningOp<arith::ShRUIOp>()) {
+    if (isConstantInt(shruiOp.getRhs(), 4))
+      return false;
+  } else if (auto andOp = value.getDefiningOp<arith::AndIOp>()) {
+    if (isConstantInt(andOp.getLhs(), 15) || isConstantInt(andOp.getRhs(), 15))
+      return false;
+  }
+  return std::nullopt;
+}
+
+// Converts the integers in the low bits of each half of the i32 `bits`, which
+// the caller has masked to `bitWidth` bits, to a pair of f16 or bf16.
+static SmallVector<Value>
+convertIntPairToFp(Location loc, ConversionPatternRewriter &rewriter, Value bits,
+                   Type outElemTy, unsigned bitWidth, bool isSigned) {
+  // 2^10 in f16 and 2^7 in bf16 have enough mantissa bits for the integers,
+  // which are offset by 2^(bitWidth-1) to be non-negative if they are signed.
+  uint32_t signBits = 0x00010001u << (bitWidth - 1);
+  uint32_t magic = outElemTy.isF16() ? 0x64006400 : 0x43004300;
+  double bias = (outElemTy.isF16() ? 1024 : 128) +
+                (isSigned ? 1 << (bitWidth - 1) : 0);
+  auto outVecTy = vec_ty(outElemTy, 2);
+  Value biasVec = rewriter.create<LLVM::ConstantOp>(
+      loc, outVecTy,
+      DenseElementsAttr::get(outVecTy, rewriter.getFloatAttr(outElemTy, bias)));
+  if (isSigned)
+    bits = xor_(bits, i32_val(signBits));
+  bits = or_(bits, i32_val(magic));
+  Value pair =
+      rewriter.create<LLVM::FSubOp>(loc, bitcast(bits, outVecTy), biasVec);
+  return unpackPair(loc, rewriter, outElemTy, pair);
+}
+
+static Value packBytes(Location loc, ConversionPatternRewriter &rewriter,
+                       ArrayRef<Value> values) {
+  auto inVecTy = vec_ty(i8_ty, 4);
+  Value packed = undef(inVecTy);
+  for (int i = 0; i < 4; i++)
+    packed = insert_element(inVecTy, packed,
+                            i < values.size() ? values[i] : int_val(8, 0),
+                            i32_val(i));
+  return bitcast(packed, i32_ty);
+}
+
+SmallVector<Value> convertPackedIntToFp(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        ArrayRef<Value> values, Type outElemTy,
+                                        unsigned bitWidth, bool isSigned) {
+  assert(values.size() == 4 && (bitWidth == 4 || bitWidth == 8));
+  assert((outElemTy.isF16() || (outElemTy.isBF16() && bitWidth == 4)) &&
+         "unsupported conversion");
+  Value packed = packBytes(loc, rewriter, values);
+  uint32_t mask = bitWidth == 4 ? 0x000f000f : 0x00ff00ff;
+  SmallVector<Value> ret(4);
+  // Bytes 0 and 2 are converted together, then bytes 1 and 3.
+  for (int i = 0; i < 2; i++) {
+    Value bits = and_(lshr(packed, i32_val(8 * i)), i32_val(mask));
+    auto pair = convertIntPairToFp(loc, rewriter, bits, outElemTy, bitWidth,
+                                   isSigned);
+    ret[i] = pair[0];
+    ret[i + 2] = pair[1];
+  }
+  return ret;
+}
+
+SmallVector<Value> convertPackedNibbles(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        ArrayRef<Value> values, Type outElemTy,
+                                        PackedElemType format) {
+  assert(values.size() <= 4);
+  SmallVector<Value> ret;
+  bool isSigned = format == PackedElemType::I4;
+  if (outElemTy.isInteger(8)) {
+    Value four = int_val(8, 4);
+    for (Value byte : values) {
+      if (isSigned) {
+        Value lo = shl(byte, four);
+        ret.push_back(rewriter.create<LLVM::AShrOp>(loc, lo, four));
+        ret.push_back(rewriter.create<LLVM::AShrOp>(loc, byte, four));
+      } else {
+        ret.push_back(and_(byte, int_val(8, 15)));
+        ret.push_back(lshr(byte, four));
+      }
+    }
+    return ret;
+  }
+
+  // Nibble i of the bytes is converted together with nibble i + 4, for i < 4.
+  // f32 is extended from f16, which holds all the values exactly.
+  Type pairElemTy = outElemTy.isBF16() ? outElemTy : f16_ty;
+  Value packed = packBytes(loc, rewriter, values);
+  ret.resize(8);
+  for (int i = 0; i < 4; i++) {
+    Value bits = lshr(packed, i32_val(4 * i));
+    SmallVector<Value> pair;
+    if (format == PackedElemType::E2M1) {
+      // The exponent and the mantissa of e2m1 go to the bottom of the
+      // exponent and the top of the mantissa, which scales the value by
+      // 2^(1 - bias), exactly for subnormals too.
+      bool isF16 = pairElemTy.isF16();
+      bits = or_(shl(and_(bits, i32_val(0x00070007)), i32_val(isF16 ? 9 : 6)),
+                 shl(and_(bits, i32_val(0x00080008)), i32_val(12)));
+      auto vecTy = vec_ty(pairElemTy, 2);
+      Value scale = rewriter.create<LLVM::ConstantOp>(
+          loc, vecTy,
+          DenseElementsAttr::get(
+              vecTy, rewriter.getFloatAttr(pairElemTy,
+                                           std::ldexp(1.0, isF16 ? 14 : 126))));
+      pair = unpackPair(
+          loc, rewriter, pairElemTy,
+          rewriter.create<LLVM::FMulOp>(loc, bitcast(bits, vecTy), scale));
+    } else {
+      pair = convertIntPairToFp(loc, rewriter,
+                                and_(bits, i32_val(0x000f000f)), pairElemTy,
+                                /*bitWidth=*/4, isSigned);
+    }
+    ret[i] = pair[0];
+    ret[i + 4] = pair[1];
+  }
+  if (outElemTy.isF32())
+    for (Value &value : ret)
+      value = rewriter.create<LLVM::FPExtOp>(loc, outElemTy, value);
+  ret.resize(2 * values.size());
+  return ret;
+}
+
+Value applyStochasticRounding(Location loc, ConversionPatternRewriter &rewriter,
+                              Value v, Value rbits, FloatType srcTy,
+                              FloatType dstTy) {
+  unsigned bitWidth = srcTy.getWidth();
+  unsigned mantissaBits = srcTy.getFPMantissaWidth() - 1;
+  unsigned dropBits = srcTy.getFPMantissaWidth() - dstTy.getFPMantissaWidth();
+  uint64_t dropMask = (1ull << dropBits) - 1;
+  uint64_t absMask = (1ull << (bitWidth - 1)) - 1;
+  uint64_t infBits = absMask & ~((1ull << mantissaBits) - 1);
+  auto c = [&](uint64_t value) {
+    return int_val(bitWidth, llvm::SignExtend64(value, bitWidth));
+  };
+  Type intTy = int_ty(bitWidth);
+  Value bits = bitcast(v, intTy);
+  if (bitWidth < 32)
+    rbits = trunc(intTy, rbits);
+  // Adding random bits below the kept ones carries into them with the
+  // probability of the dropped fraction, into the exponent too.
+  Value rounded = and_(add(bits, and_(rbits, c(dropMask))), c(~dropMask));
+  // NaNs, whose mantissa may carry into the sign, are kept as they are
+  Value isNaN = icmp_ugt(and_(bits, c(absMask)), c(infBits));
+  return bitcast(select(isNaN, bits, rounded), srcTy);
+}
+
 // MMA encoding has a different order depending on the element's bit width;
 // reorder if we're in this case.
 SmallVector<Value> reorderValues(const SmallVector<Value> &values, Type inType,
@@ -306,6 +473,79 @@ protected:
   const TargetInfoBase &targetInfo;
 };
 
+// Divides x <= 2^31 by a runtime divisor d as (mulhi(x, m) + x) >> s, with
+// s = ceil(log2(d)) and m = floor(2^32 * (2^s - d) / d) + 1 computed by the
+// launcher. The sum doesn't overflow since mulhi(x, m) < x <= 2^31 for x > 0.
+template <typename SourceOp>
+struct MagicDivRemOpConversion
+    : public ElementwiseOpConversionBase<SourceOp,
+                                         MagicDivRemOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, MagicDivRemOpConversion<SourceOp>>;
+  using Base::Base;
+  using Adaptor = typename Base::OpAdaptor;
+  explicit MagicDivRemOpConversion(LLVMTypeConverter &typeConverter,
+                                   ModuleAxisInfoAnalysis &axisAnalysisPass,
+                                   const TargetInfoBase &targetInfo,
+                                   PatternBenefit benefit = 1)
+      : Base(typeConverter, axisAnalysisPass, benefit),
+        targetInfo(targetInfo) {}
+
+  SmallVector<Value> createDestOps(SourceOp op, Adaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    Value x = operands[0][0];
+    Value divisor = operands[0][1];
+    Value magic = operands[0][2];
+    Value shift = operands[0][3];
+    auto funcName = targetInfo.getMulhiFuncName(elemTy);
+    Type funcType = getFunctionType(elemTy, ValueRange{x, magic});
+    LLVM::LLVMFuncOp funcOp =
+        appendOrGetExternFuncOp(rewriter, op, funcName, funcType);
+    Value hi = rewriter.create<LLVM::CallOp>(loc, funcOp, ValueRange{x, magic})
+                   .getResult();
+    Value quotient = lshr(add(hi, x), shift);
+    if (std::is_same_v<SourceOp, MagicDivUIOp>)
+      return {quotient};
+    Value remainder = sub(x, mul(quotient, divisor));
+    return {remainder};
+  }
+
+protected:
+  const TargetInfoBase &targetInfo;
+};
+
+// The result of an unpack has the layout of its source with twice the elements
+// per thread along the axis, which is the most minor one, so the nibbles of
+// each byte of a thread are next to each other in its result.
+struct UnpackOpConversion : public ConvertOpToLLVMPattern<UnpackOp> {
+  using ConvertOpToLLVMPattern<UnpackOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(UnpackOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto resultTy = op.getType();
+    auto typeConverter = getTypeConverter();
+    Type elemTy = typeConverter->convertType(resultTy.getElementType());
+    SmallVector<Value> bytes =
+        unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    SmallVector<Value> resultVals;
+    for (size_t i = 0; i < bytes.size(); i += 4) {
+      auto vals = convertPackedNibbles(
+          loc, rewriter,
+          ArrayRef(bytes).slice(i, std::min<size_t>(4, bytes.size() - i)),
+          elemTy, op.getFormat());
+      resultVals.append(vals.begin(), vals.end());
+    }
+    Value ret =
+        packLLElements(loc, typeConverter, resultVals, rewriter, resultTy);
+    rewriter.replaceOp(op, ret);
+    return success();
+  }
+};
+
 struct ExternElementwiseOpConversion
     : public ElementwiseOpConversionBase<ExternElementwiseOp,
                                          ExternElementwiseOpConversion> {
@@ -825,10 +1065,14 @@ void mlir::triton::populateElementwiseOpToLLVMPatterns(
       typeConverter, axisInfoAnalysis, benefit);
 
   patterns.add<AddPtrOpConversion>(typeConverter, benefit);
+  patterns.add<UnpackOpConversion>(typeConverter, benefit);
   patterns.add<CmpIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   patterns.add<CmpFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   patterns.add<MulhiUIOpConversion>(typeConverter, axisInfoAnalysis, targetInfo,
                                     benefit);
+  patterns.add<MagicDivRemOpConversion<MagicDivUIOp>,
+               MagicDivRemOpConversion<MagicRemUIOp>>(
+      typeConverter, axisInfoAnalysis, targetInfo, benefit);
   patterns.add<ExternElementwiseOpConversion>(typeConverter, axisInfoAnalysis,
                                               benefit);
   patterns.add<ElementwiseInlineAsmOpConversion>(typeConverter, benefit);
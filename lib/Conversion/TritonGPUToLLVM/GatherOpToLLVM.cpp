@@ -0,0 +1,139 @@
+#include "triton/Analysis/Utility.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace {
+struct GatherOpConversion : public ConvertOpToLLVMPattern<triton::GatherOp> {
+public:
+  using ConvertOpToLLVMPattern<triton::GatherOp>::ConvertOpToLLVMPattern;
+
+  explicit GatherOpConversion(LLVMTypeConverter &typeConverter,
+                              const TargetInfoBase &targetInfo,
+                              PatternBenefit benefit = 1)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  LogicalResult
+  matchAndRewrite(triton::GatherOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    GatherOpHelper helper(op);
+    SmallVector<Value> srcValues =
+        unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    SmallVector<Value> indices =
+        unpackLLElements(loc, adaptor.getIndices(), rewriter);
+    for (Value &index : indices) {
+      unsigned bitWidth = index.getType().getIntOrFloatBitWidth();
+      if (bitWidth > 32)
+        index = trunc(i32_ty, index);
+      else if (bitWidth < 32)
+        index = sext(i32_ty, index);
+    }
+
+    SmallVector<Value> results =
+        helper.isWarpLocal()
+            ? emitWarpLocalGather(loc, rewriter, op, helper, srcValues, indices)
+            : emitGatherInShared(loc, rewriter, op, srcValues, indices);
+    Value result = packLLElements(loc, getTypeConverter(), results, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
+private:
+  // Every lane reads the lane whose position along the axis is the index,
+  // and whose other coordinates are its own.
+  SmallVector<Value> emitWarpLocalGather(Location loc,
+                                         ConversionPatternRewriter &rewriter,
+                                         triton::GatherOp op,
+                                         GatherOpHelper &helper,
+                                         ArrayRef<Value> srcValues,
+                                         ArrayRef<Value> indices) const {
+    auto mod = op->getParentOfType<ModuleOp>();
+    unsigned threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    ArrayRef<int> axisLaneBits = helper.getAxisLaneBits();
+    unsigned otherLaneMask = threadsPerWarp - 1;
+    for (int laneBit : axisLaneBits)
+      otherLaneMask &= ~(1u << laneBit);
+    // The lane bits of the axis are usually consecutive, and the index is
+    // then shifted in place at once.
+    bool consecutive = true;
+    for (unsigned bit = 1; bit < axisLaneBits.size(); ++bit)
+      consecutive &= axisLaneBits[bit] == axisLaneBits[0] + bit;
+
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(threadsPerWarp));
+    Value otherLanes = and_(laneId, i32_val(otherLaneMask));
+    SmallVector<Value> results;
+    for (auto [reg, index] : llvm::enumerate(indices)) {
+      Value srcLane = otherLanes;
+      if (consecutive && !axisLaneBits.empty()) {
+        Value axisLanes = and_(index, i32_val((1 << axisLaneBits.size()) - 1));
+        srcLane = or_(srcLane, shl(axisLanes, i32_val(axisLaneBits[0])));
+      } else {
+        for (auto [bit, laneBit] : llvm::enumerate(axisLaneBits)) {
+          Value indexBit = and_(lshr(index, i32_val(bit)), i32_val(1));
+          srcLane = or_(srcLane, shl(indexBit, i32_val(laneBit)));
+        }
+      }
+      Value val = srcValues[helper.getSrcRegister(reg)];
+      results.push_back(targetInfo.shuffleIdx(rewriter, loc, val, srcLane));
+    }
+    return results;
+  }
+
+  // Store the source to shared memory in row-major order, and load the
+  // element of each index from there.
+  SmallVector<Value> emitGatherInShared(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        triton::GatherOp op,
+                                        ArrayRef<Value> srcValues,
+                                        ArrayRef<Value> indices) const {
+    auto srcTy = op.getSrc().getType();
+    auto indicesTy = op.getIndices().getType();
+    Type elemTy = getTypeConverter()->convertType(srcTy.getElementType());
+    // Booleans go through shared memory as bytes.
+    Type storageTy = elemTy.getIntOrFloatBitWidth() < 8 ? i8_ty : elemTy;
+    SmallVector<unsigned> srcShape(srcTy.getShape());
+    unsigned axis = op.getAxis();
+
+    Value baseSharedMemPtr =
+        LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
+    auto ptrTy = baseSharedMemPtr.getType();
+    auto srcIndices = emitIndices(loc, rewriter, targetInfo,
+                                  srcTy.getEncoding(), srcTy, true);
+    for (auto [val, coords] : llvm::zip(srcValues, srcIndices)) {
+      Value offset = linearize(rewriter, loc, coords, srcShape);
+      Value stored = storageTy != elemTy ? zext(storageTy, val) : val;
+      store(stored, gep(ptrTy, storageTy, baseSharedMemPtr, offset));
+    }
+    barrier();
+
+    auto resultIndices = emitIndices(loc, rewriter, targetInfo,
+                                     indicesTy.getEncoding(), indicesTy, true);
+    SmallVector<Value> results;
+    for (auto [index, coords] : llvm::zip(indices, resultIndices)) {
+      coords[axis] = index;
+      Value offset = linearize(rewriter, loc, coords, srcShape);
+      Value ptr = gep(ptrTy, storageTy, baseSharedMemPtr, offset);
+      Value val = load(storageTy, ptr);
+      if (storageTy != elemTy)
+        val = trunc(elemTy, val);
+      results.push_back(val);
+    }
+    return results;
+  }
+
+  const TargetInfoBase &targetInfo;
+};
+} // namespace
+
+void mlir::triton::populateGatherOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    const TargetInfoBase &targetInfo, PatternBenefit benefit) {
+  patterns.add<GatherOpConversion>(typeConverter, targetInfo, benefit);
+}
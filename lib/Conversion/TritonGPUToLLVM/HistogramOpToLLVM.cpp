@@ -81,6 +81,118 @@ static void atomicAdd(Value ptr, Value val, Location loc,
                                      LLVM::AtomicOrdering::monotonic);
 }
 
+// Apply the atomic add only on the threads for which `pred` holds.
+static void predicatedAtomicAdd(Value pred, Value ptr, Value val, Location loc,
+                                ConversionPatternRewriter &rewriter) {
+  Block *currentBlock = rewriter.getInsertionBlock();
+  Block *afterAtomic =
+      rewriter.splitBlock(currentBlock, rewriter.getInsertionPoint());
+  Block *atomicBlock = rewriter.createBlock(afterAtomic);
+  rewriter.setInsertionPointToEnd(currentBlock);
+  rewriter.create<LLVM::CondBrOp>(loc, pred, atomicBlock, afterAtomic);
+  rewriter.setInsertionPointToStart(atomicBlock);
+  atomicAdd(ptr, val, loc, rewriter);
+  rewriter.create<LLVM::BrOp>(loc, afterAtomic);
+  rewriter.setInsertionPointToStart(afterAtomic);
+}
+
+// Compute the histogram with shared memory atomics, for bin counts where each
+// lane would own too many bins for the warp-level histogram. The warps are
+// spread over `numPrivateHistograms` sub-histograms to avoid collisions
+// between warps. Within a warp, the lanes hitting the same bin are found with
+// one ballot per bit of the bin index, and only the lowest of them adds the
+// count of the group, so each distinct bin costs one atomic per warp.
+static SmallVector<Value> computePrivatizedHistogram(
+    Location loc, ConversionPatternRewriter &rewriter, RankedTensorType srcType,
+    SmallVector<Value> &srcValues, Value baseSharedMemPtr, int numBins,
+    int numPrivateHistograms, int numThreadPerWarp, int numWarps,
+    const SmallVector<Value> &indices, Value threadId,
+    const TargetInfoBase &targetInfo) {
+  Value zero = i32_val(0);
+  int numBits = log2Int(numBins);
+  unsigned numElementsPerThreads = triton::gpu::getTotalElemsPerThread(srcType);
+  unsigned numThreadWithUniqueData =
+      triton::gpu::getThreadsPerWarpWithUniqueData(srcType.getEncoding(),
+                                                   srcType.getShape())[0];
+  unsigned numWarpsWithUniqueData =
+      triton::gpu::getWarpsPerCTAWithUniqueData(srcType.getEncoding(),
+                                                srcType.getShape())[0];
+  Value laneId = and_(threadId, i32_val(numThreadPerWarp - 1));
+  Value warpId = udiv(threadId, i32_val(numThreadPerWarp));
+
+  // Initialize all the sub-histograms with zeros.
+  int numThreads = numThreadPerWarp * numWarps;
+  int totalBins = numBins * numPrivateHistograms;
+  for (int i = 0; i < ceil<int>(totalBins, numThreads); ++i) {
+    Value offset = add(threadId, i32_val(i * numThreads));
+    offset = urem(offset, i32_val(totalBins));
+    Value sharedMemPtr =
+        gep(baseSharedMemPtr.getType(), i32_ty, baseSharedMemPtr, offset);
+    store(i32_val(0), sharedMemPtr);
+  }
+  barrier();
+
+  uint64_t fullMaskValue =
+      numThreadPerWarp == 32 ? 0xFFFFFFFF : 0xFFFFFFFFFFFFFFFF;
+  Value fullMask = int_val(numThreadPerWarp, fullMaskValue);
+  // If not all threads have unique data, leave the redundant ones out.
+  Value uniqueMask = fullMask;
+  if (numThreadWithUniqueData < numThreadPerWarp)
+    uniqueMask =
+        int_val(numThreadPerWarp, (1ULL << numThreadWithUniqueData) - 1);
+  Value isUniqueThread =
+      and_(icmp_ult(laneId, i32_val(numThreadWithUniqueData)),
+           icmp_ult(warpId, i32_val(numWarpsWithUniqueData)));
+  // Mask of the lanes below this one.
+  Value laneBit = laneId;
+  if (numThreadPerWarp > 32)
+    laneBit = zext(int_ty(numThreadPerWarp), laneId);
+  Value lowerLanes = sub(shl(int_val(numThreadPerWarp, 1), laneBit),
+                         int_val(numThreadPerWarp, 1));
+  Value privateOffset =
+      mul(urem(warpId, i32_val(numPrivateHistograms)), i32_val(numBins));
+  Value privateBase = gep(baseSharedMemPtr.getType(), i32_ty, baseSharedMemPtr,
+                          privateOffset);
+
+  for (int i = 0; i < numElementsPerThreads; ++i) {
+    Value bin = and_(srcValues[i], i32_val(numBins - 1));
+    // Find the lanes holding the same bin: for every bit of the bin index,
+    // keep the lanes that agree with this one.
+    Value peers = uniqueMask;
+    for (int j = 0; j < numBits; ++j) {
+      Value bitSet = icmp_ne(and_(bin, i32_val(1 << j)), zero);
+      Value ballot =
+          targetInfo.ballot(rewriter, loc, int_ty(numThreadPerWarp), bitSet);
+      peers = and_(peers, select(bitSet, ballot, xor_(ballot, fullMask)));
+    }
+    Value isLeader =
+        and_(isUniqueThread, icmp_eq(and_(peers, lowerLanes),
+                                     int_val(numThreadPerWarp, 0)));
+    Value count =
+        rewriter.create<LLVM::CtPopOp>(loc, int_ty(numThreadPerWarp), peers);
+    if (numThreadPerWarp > 32)
+      count = trunc(i32_ty, count);
+    Value sharedMemPtr =
+        gep(baseSharedMemPtr.getType(), i32_ty, privateBase, bin);
+    predicatedAtomicAdd(isLeader, sharedMemPtr, count, loc, rewriter);
+  }
+  barrier();
+
+  // Merge the sub-histograms while loading the result with the right layout.
+  SmallVector<Value> histogramValues;
+  for (Value index : indices) {
+    Value val = zero;
+    for (int i = 0; i < numPrivateHistograms; ++i) {
+      Value offset = add(index, i32_val(i * numBins));
+      Value sharedMemPtr =
+          gep(baseSharedMemPtr.getType(), i32_ty, baseSharedMemPtr, offset);
+      val = add(val, load(i32_ty, sharedMemPtr));
+    }
+    histogramValues.push_back(val);
+  }
+  return histogramValues;
+}
+
 static SmallVector<Value> computeCrossWarpHistogram(
     Location loc, ConversionPatternRewriter &rewriter, RankedTensorType srcType,
     Value baseSharedMemPtr, const SmallVector<Value> &warpLevelHistogram,
@@ -167,20 +279,12 @@ public:
            numThreadsPerWarp == 64 &&
                "Only supports 32 or 64 threads per warp");
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    HistogramOpHelper helper(op);
     // Pad out the bins so that we have at least one bin per thread within a
     // warp.
-    numBins = std::max(numBins, numThreadsPerWarp);
+    numBins = helper.getNumBins();
     Value threadId = getThreadId(rewriter, loc);
     auto srcType = op.getSrc().getType();
-    // First compute a warp local histogram based on values owned by each warps.
-    SmallVector<Value> warpLevelHistogram = computeWarpLevelHistogram(
-        loc, srcType, srcValues, numBins, numThreadsPerWarp, threadId, rewriter,
-        targetInfo);
-
-    // Then use atomic to update the histogram in shared memory.
-    // TODO: we could skip this for cases with num_warps=1 as long as we can
-    // generate the right layout. Currently the warp level histogram generates
-    // data in the default blocked layout.
     Value baseSharedMemPtr =
         LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
     auto dstType = op.getType();
@@ -190,9 +294,28 @@ public:
     SmallVector<Value> innerDimIndices;
     for (int i = 0; i < indices.size(); ++i)
       innerDimIndices.push_back(indices[i][0]);
-    SmallVector<Value> histogramValue = computeCrossWarpHistogram(
-        loc, rewriter, srcType, baseSharedMemPtr, warpLevelHistogram, numBins,
-        numThreadsPerWarp, innerDimIndices, threadId, numWarps);
+
+    SmallVector<Value> histogramValue;
+    if (helper.useWarpAggregatedAtomics()) {
+      histogramValue = computePrivatizedHistogram(
+          loc, rewriter, srcType, srcValues, baseSharedMemPtr, numBins,
+          helper.getNumPrivateHistograms(), numThreadsPerWarp, numWarps,
+          innerDimIndices, threadId, targetInfo);
+    } else {
+      // First compute a warp local histogram based on values owned by each
+      // warps.
+      SmallVector<Value> warpLevelHistogram = computeWarpLevelHistogram(
+          loc, srcType, srcValues, numBins, numThreadsPerWarp, threadId,
+          rewriter, targetInfo);
+
+      // Then use atomic to update the histogram in shared memory.
+      // TODO: we could skip this for cases with num_warps=1 as long as we can
+      // generate the right layout. Currently the warp level histogram
+      // generates data in the default blocked layout.
+      histogramValue = computeCrossWarpHistogram(
+          loc, rewriter, srcType, baseSharedMemPtr, warpLevelHistogram,
+          numBins, numThreadsPerWarp, innerDimIndices, threadId, numWarps);
+    }
 
     Value results = packLLElements(loc, typeConverter, histogramValue, rewriter,
                                    op.getType());
@@ -5,9 +5,21 @@
 #include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
 
 namespace {
 
+const char *kPrintIdAttrName = "tt.print_id";
+const char *kPrintRingName = "triton_print_ring";
+
+LLVM::LLVMStructType getPrintRingType(MLIRContext *ctx, int numRecords) {
+  auto i32Ty = IntegerType::get(ctx, 32);
+  auto recordTy = LLVM::LLVMArrayType::get(i32Ty, 8);
+  return LLVM::LLVMStructType::getLiteral(
+      ctx, {i32Ty, LLVM::LLVMArrayType::get(recordTy, numRecords)});
+}
+
 // The input print op contains:
 //  - a "prefix" (string) specified by the user, and
 //  - one or more "operands" (tensors).
@@ -32,6 +44,12 @@ struct PrintOpConversion : public ConvertOpToLLVMPattern<triton::PrintOp> {
     };
     std::array<Value, 3> pid = {getPid(0), getPid(1), getPid(2)};
 
+    if (auto printId = op->getAttrOfType<IntegerAttr>(kPrintIdAttrName)) {
+      appendRecords(op, adaptor, printId.getInt(), pid, rewriter);
+      rewriter.eraseOp(op);
+      return success();
+    }
+
     // Simple printf of a string without any tensors.
     if (op.getNumOperands() == 0) {
       std::string formatStr;
@@ -168,6 +186,78 @@ struct PrintOpConversion : public ConvertOpToLLVMPattern<triton::PrintOp> {
     }
   }
 
+  // Append the record of every element of the operands that are resident in
+  // this thread, which reserves them in the ring with a single atomic. The ring
+  // wraps around, overwriting the oldest records.
+  void appendRecords(triton::PrintOp op, OpAdaptor adaptor, int printId,
+                     std::array<Value, 3> pid,
+                     ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    auto ctx = rewriter.getContext();
+    auto moduleOp = op->getParentOfType<ModuleOp>();
+    auto ring = moduleOp.lookupSymbol<LLVM::GlobalOp>(kPrintRingName);
+    assert(ring && "binary prints without their ring global");
+    auto ringTy = cast<LLVM::LLVMStructType>(ring.getGlobalType());
+    int numRecords =
+        cast<LLVM::LLVMArrayType>(ringTy.getBody()[1]).getNumElements();
+    auto ptrTy = ptr_ty(ctx, ring.getAddrSpace());
+
+    // The operand, index and bits of every record.
+    SmallVector<std::array<Value, 3>> records;
+    for (auto [i, operand] : llvm::enumerate(op.getOperands())) {
+      auto elems = unpackLLElements(loc, adaptor.getOperands()[i], rewriter);
+      SmallVector<SmallVector<Value>> indices;
+      SmallVector<unsigned> shape;
+      if (auto rankedTy = dyn_cast<RankedTensorType>(operand.getType())) {
+        indices = emitIndices(loc, rewriter, targetInfo, rankedTy.getEncoding(),
+                              rankedTy, true);
+        shape = llvm::to_vector(llvm::map_range(
+            rankedTy.getShape(), [](int64_t dim) { return unsigned(dim); }));
+      } else {
+        indices.push_back({});
+      }
+      for (auto [elem, index] : llvm::zip(elems, indices)) {
+        records.push_back({i32_val(i), linearize(rewriter, loc, index, shape),
+                           getBits(loc, elem, rewriter)});
+      }
+    }
+    if (op.getNumOperands() == 0)
+      records.push_back({i32_val(0), i32_val(0), int_val(64, 0)});
+
+    Value base = rewriter.create<LLVM::AddressOfOp>(loc, ptrTy,
+                                                    ring.getSymName());
+    Value cursorPtr = gep(ptrTy, ringTy, base, ArrayRef<LLVM::GEPArg>{0, 0});
+    Value first = rewriter.create<LLVM::AtomicRMWOp>(
+        loc, LLVM::AtomicBinOp::add, cursorPtr, i32_val(records.size()),
+        LLVM::AtomicOrdering::monotonic);
+    for (auto [k, record] : llvm::enumerate(records)) {
+      auto [operand, index, bits] = record;
+      Value slot =
+          and_(add(first, i32_val(k)), i32_val(numRecords - 1));
+      Value fields[] = {i32_val(printId), operand, pid[0], pid[1], pid[2],
+                        index, trunc(i32_ty, bits),
+                        trunc(i32_ty, lshr(bits, int_val(64, 32)))};
+      for (auto [f, field] : llvm::enumerate(fields)) {
+        Value fieldPtr =
+            gep(ptrTy, ringTy, base,
+                ArrayRef<LLVM::GEPArg>{0, 1, slot, static_cast<int32_t>(f)});
+        store(field, fieldPtr);
+      }
+    }
+  }
+
+  // The bits of `value` zero-extended to 64 bits.
+  Value getBits(Location loc, Value value,
+                ConversionPatternRewriter &rewriter) const {
+    Type type = value.getType();
+    if (isa<LLVM::LLVMPointerType>(type))
+      return ptrtoint(i64_ty, value);
+    unsigned bitWidth = type.getIntOrFloatBitWidth();
+    if (isa<FloatType>(type))
+      value = bitcast(value, int_ty(bitWidth));
+    return bitWidth < 64 ? zext(i64_ty, value) : value;
+  }
+
   std::string getFormatSubstr(Value value, bool hex = false,
                               std::optional<int> width = std::nullopt) const {
     Type type = value.getType();
@@ -236,6 +326,52 @@ protected:
 
 } // namespace
 
+void mlir::triton::prepareBinaryPrints(ModuleOp mod, int numRecords) {
+  assert(llvm::isPowerOf2_32(numRecords) &&
+         "the ring of binary prints must hold a power of two of records");
+  MLIRContext *ctx = mod.getContext();
+  auto i32Ty = IntegerType::get(ctx, 32);
+  llvm::json::Array prints;
+  mod.walk([&](triton::PrintOp op) {
+    op->setAttr(kPrintIdAttrName, IntegerAttr::get(i32Ty, prints.size()));
+    llvm::json::Array operands;
+    for (Value operand : op.getOperands()) {
+      std::string type;
+      llvm::raw_string_ostream os(type);
+      os << getElementTypeOrSelf(operand.getType());
+      llvm::json::Array shape;
+      if (auto rankedTy = dyn_cast<RankedTensorType>(operand.getType()))
+        shape = llvm::json::Array(rankedTy.getShape());
+      operands.push_back(llvm::json::Object{
+          {"type", os.str()},
+          {"shape", std::move(shape)},
+      });
+    }
+    prints.push_back(llvm::json::Object{
+        {"prefix", op.getPrefix().str()},
+        {"hex", op.getHex()},
+        {"operands", std::move(operands)},
+    });
+  });
+  if (prints.empty())
+    return;
+  std::string json;
+  llvm::raw_string_ostream os(json);
+  os << llvm::json::Value(std::move(prints));
+  mod->setAttr("tt.device_prints", StringAttr::get(ctx, os.str()));
+
+  // A zero-initialized definition, that the host finds by name.
+  OpBuilder b(mod.getBodyRegion());
+  auto loc = mod.getLoc();
+  auto ringTy = getPrintRingType(ctx, numRecords);
+  auto global = b.create<LLVM::GlobalOp>(
+      loc, ringTy, /*isConstant=*/false, LLVM::Linkage::External,
+      kPrintRingName, /*value=*/Attribute(), /*alignment=*/16,
+      /*addrSpace=*/1);
+  b.setInsertionPointToStart(b.createBlock(&global.getInitializerRegion()));
+  b.create<LLVM::ReturnOp>(loc, b.create<LLVM::ZeroOp>(loc, ringTy));
+}
+
 void mlir::triton::populatePrintOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     const TargetInfoBase &targetInfo, PatternBenefit benefit) {
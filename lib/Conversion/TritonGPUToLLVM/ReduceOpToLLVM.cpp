@@ -39,32 +39,50 @@ public:
     reduceWithinThreads(helper, srcValues, accs, indices, rewriter);
 
     // Then reduce across threads within a warp.
-    reduceWithinWarps(helper, accs, rewriter);
+    SmallVector<bool> uniform = helper.getUniformOperands();
+    reduceWithinWarps(helper, accs, uniform, rewriter);
 
-    if (helper.isWarpSynchronous()) {
+    if (helper.isWarpSynchronous() && helper.isReduceWithinCTA()) {
       // If all the values to be reduced are within the same warp there is
       // nothing left to do.
       packResults(helper, accs, rewriter);
       return success();
     }
 
-    // Compute a shared memory base per operand.
+    // Compute a shared memory base per operand. The uniform operands have
+    // none, and are the same for all the keys.
     auto smemShape = helper.getScratchConfig();
 
     SmallVector<Value> smemBases =
-        getSmemBases(op, product<unsigned>(smemShape), rewriter);
+        getSmemBases(op, product<unsigned>(smemShape), rewriter, uniform);
+    SmallVector<Value> uniformVals = accs.begin()->second;
 
     storeWarpReduceToSharedMemory(helper, accs, indices, smemBases, rewriter);
 
     sync(rewriter, loc, op);
 
+    if (helper.isReduceWithinCTA() &&
+        reduceInterWarpsInRegisters(helper, uniform)) {
+      loadPartialReductionsAndPackResult(helper, smemShape, smemBases,
+                                         uniformVals, rewriter);
+      return success();
+    }
+
     // The second round of shuffle reduction
     //   now the problem size: sizeInterWarps, s1, s2, .. , sn
     //   where sizeInterWarps is 2^m
     //
     // Each thread needs to process:
     //   elemsPerThread = sizeInterWarps * s1 * s2 .. Sn / numThreads
-    accumulatePartialReductions(helper, smemBases, rewriter);
+    accumulatePartialReductions(helper, smemBases, uniformVals, rewriter);
+
+    if (!helper.isReduceWithinCTA()) {
+      // Each CTA now holds the reduction of its own slice of the axis; combine
+      // them through distributed shared memory.
+      accumulateClusterReductions(helper, smemShape, smemBases, uniformVals,
+                                  rewriter);
+      return success();
+    }
 
     // We could avoid this barrier in some of the layouts, however this is not
     // the general case.
@@ -72,7 +90,8 @@ public:
     sync(rewriter, loc, op);
 
     // set output values
-    loadReductionAndPackResult(helper, smemShape, smemBases, rewriter);
+    loadReductionAndPackResult(helper, smemShape, smemBases, uniformVals,
+                               rewriter);
 
     return success();
   }
@@ -171,21 +190,71 @@ private:
     }
   }
 
+  // Shuffle the values across lanes. 16-bit values are shuffled in pairs,
+  // packed in a 32-bit word.
+  SmallVector<Value> shuffleXor(ConversionPatternRewriter &rewriter,
+                                Location loc, ArrayRef<Value> values,
+                                unsigned mask) const {
+    SmallVector<Value> shfl(values.size());
+    SmallVector<unsigned> halves;
+    for (unsigned i = 0; i < values.size(); ++i) {
+      Type ty = values[i].getType();
+      if (ty.isIntOrFloat() && ty.getIntOrFloatBitWidth() == 16)
+        halves.push_back(i);
+      else
+        shfl[i] = targetInfo.shuffleXor(rewriter, loc, values[i], mask);
+    }
+    if (halves.size() % 2 == 1) {
+      unsigned i = halves.pop_back_val();
+      shfl[i] = targetInfo.shuffleXor(rewriter, loc, values[i], mask);
+    }
+    for (unsigned j = 0; j < halves.size(); j += 2) {
+      Value lo = values[halves[j]];
+      Value hi = values[halves[j + 1]];
+      Value loBits = zext(i32_ty, bitcast(lo, i16_ty));
+      Value hiBits = shl(zext(i32_ty, bitcast(hi, i16_ty)), i32_val(16));
+      Value packed = or_(loBits, hiBits);
+      packed = targetInfo.shuffleXor(rewriter, loc, packed, mask);
+      shfl[halves[j]] = bitcast(trunc(i16_ty, packed), lo.getType());
+      shfl[halves[j + 1]] =
+          bitcast(trunc(i16_ty, lshr(packed, i32_val(16))), hi.getType());
+    }
+    return shfl;
+  }
+
   // Apply warp reduction across the given number of contiguous lanes using op
-  // region and the accumulator values as source.
+  // region and the accumulator values as source. The accumulators are reduced
+  // together so that their 16-bit values can share shuffles. The uniform
+  // operands are combined with themselves.
   void warpReduce(ConversionPatternRewriter &rewriter, Location loc,
-                  SmallVector<Value> &acc, triton::ReduceOp op,
-                  unsigned numLaneToReduce, unsigned interleave) const {
-    auto success = targetInfo.warpReduce(rewriter, loc, acc, op,
-                                         numLaneToReduce, interleave);
-    if (success)
+                  ArrayRef<SmallVector<Value> *> accs, triton::ReduceOp op,
+                  unsigned numLaneToReduce, unsigned interleave,
+                  ArrayRef<bool> uniform) const {
+    SmallVector<SmallVector<Value> *> shuffled;
+    for (SmallVector<Value> *acc : accs) {
+      if (!targetInfo.warpReduce(rewriter, loc, *acc, op, numLaneToReduce,
+                                 interleave))
+        shuffled.push_back(acc);
+    }
+    if (shuffled.empty())
       return;
     for (unsigned N = numLaneToReduce / 2; N > 0; N >>= 1) {
-      SmallVector<Value> shfl(acc.size());
-      for (unsigned i = 0; i < acc.size(); ++i) {
-        shfl[i] = targetInfo.shuffleXor(rewriter, loc, acc[i], N * interleave);
+      SmallVector<Value> values;
+      for (SmallVector<Value> *acc : shuffled) {
+        for (unsigned i = 0; i < acc->size(); ++i) {
+          if (!uniform[i])
+            values.push_back((*acc)[i]);
+        }
+      }
+      SmallVector<Value> shfl =
+          shuffleXor(rewriter, loc, values, N * interleave);
+      auto shflIt = shfl.begin();
+      for (SmallVector<Value> *acc : shuffled) {
+        SmallVector<Value> cur(acc->size());
+        for (unsigned i = 0; i < acc->size(); ++i)
+          cur[i] = uniform[i] ? (*acc)[i] : *shflIt++;
+        accumulate(rewriter, op.getCombineOp(), *acc, cur, false);
       }
-      accumulate(rewriter, op.getCombineOp(), acc, shfl, false);
     }
   }
 
@@ -193,17 +262,17 @@ private:
   void
   reduceWithinWarps(ReduceOpHelper &helper,
                     std::map<SmallVector<unsigned>, SmallVector<Value>> &accs,
+                    ArrayRef<bool> uniform,
                     ConversionPatternRewriter &rewriter) const {
     triton::ReduceOp op = helper.getOperation();
     unsigned sizeIntraWarps = helper.getIntraWarpSizeWithUniqueData();
     unsigned threadOffsetOnReductionAxis =
         helper.getThreadOffsetOnReductionAxis();
-    for (auto it : accs) {
-      const SmallVector<unsigned> &key = it.first;
-      SmallVector<Value> &acc = accs[key];
-      warpReduce(rewriter, op.getLoc(), acc, op, sizeIntraWarps,
-                 threadOffsetOnReductionAxis);
-    }
+    SmallVector<SmallVector<Value> *> accPtrs;
+    for (auto &it : accs)
+      accPtrs.push_back(&it.second);
+    warpReduce(rewriter, op.getLoc(), accPtrs, op, sizeIntraWarps,
+               threadOffsetOnReductionAxis, uniform);
   }
 
   // Pack the accumulator values and replace the reduce op with the result.
@@ -263,6 +332,38 @@ private:
     return multiDimWarpId;
   }
 
+  // The partials of an output are sizeInterWarps consecutive elements of the
+  // scratch, so the lanes storing or loading the same partial of different
+  // outputs hit the same banks once these outputs span more than a row of
+  // banks. Each operand has an array of its own, and within it the partials
+  // of an output are XOR-ed with the bank row of the output. The swizzle is
+  // its own inverse and stays within each output, whose partials thus remain
+  // contiguous for the warp reductions of accumulatePartialReductions.
+  Value swizzlePartialOffset(ReduceOpHelper &helper, Value offset, Type elemTy,
+                             ConversionPatternRewriter &rewriter) const {
+    constexpr unsigned kBankRowBytes = 128;
+    unsigned sizeInterWarps = helper.getInterWarpSizeWithUniqueData();
+    if (sizeInterWarps <= 1 || !llvm::isPowerOf2_32(sizeInterWarps))
+      return offset;
+    Location loc = helper.getOperation().getLoc();
+    unsigned elemBytes = ceil<unsigned>(elemTy.getIntOrFloatBitWidth(), 8);
+    unsigned rowElems = std::max(kBankRowBytes / elemBytes, sizeInterWarps);
+    Value row = lshr(offset, i32_val(llvm::Log2_32(rowElems)));
+    return xor_(offset, and_(row, i32_val(sizeInterWarps - 1)));
+  }
+
+  // The address of the partial of operand i at `offset` in the scratch
+  // layout given by getScratchConfig and getOrderWithAxisAtBeginning.
+  Value getPartialPtr(ReduceOpHelper &helper, SmallVector<Value> &smemBases,
+                      unsigned i, Value offset,
+                      ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto elemTy = getElementType(op, i);
+    return gep(ptr_ty(rewriter.getContext(), 3), elemTy, smemBases[i],
+               swizzlePartialOffset(helper, offset, elemTy, rewriter));
+  }
+
   void storeWarpReduceToSharedMemory(
       ReduceOpHelper &helper,
       std::map<SmallVector<unsigned>, SmallVector<Value>> &accs,
@@ -303,18 +404,21 @@ private:
       Value writeOffset =
           linearize(rewriter, loc, writeIdx, smemShape, smemOrder);
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        auto elemTy = getElementType(op, i);
-        Value writePtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                             smemBases[i], writeOffset);
+        if (!smemBases[i])
+          continue;
+        Value writePtr =
+            getPartialPtr(helper, smemBases, i, writeOffset, rewriter);
         targetInfo.storeShared(rewriter, loc, writePtr, acc[i], laneZero);
       }
     }
   }
 
   // Load the reduction of each warp and accumulate them to a final value and
-  // store back to shared memory.
+  // store back to shared memory. The uniform values are updated to their
+  // final value in registers.
   void accumulatePartialReductions(ReduceOpHelper &helper,
                                    SmallVector<Value> &smemBases,
+                                   SmallVector<Value> &uniformVals,
                                    ConversionPatternRewriter &rewriter) const {
     triton::ReduceOp op = helper.getOperation();
     auto srcLayout = helper.getSrcLayout();
@@ -335,23 +439,33 @@ private:
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value threadIsNeeded = icmp_slt(threadId, i32_val(elems));
     Value readOffset = threadId;
+    SmallVector<bool> uniform =
+        llvm::to_vector(llvm::map_range(smemBases, [](Value base) {
+          return !static_cast<bool>(base);
+        }));
+    SmallVector<Value> acc;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
-      SmallVector<Value> acc(op.getNumOperands());
+      acc = uniformVals;
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+        if (uniform[i])
+          continue;
         auto elemTy = getElementType(op, i);
-        Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                            smemBases[i], readOffset);
+        Value readPtr =
+            getPartialPtr(helper, smemBases, i, readOffset, rewriter);
         acc[i] = targetInfo.loadShared(rewriter, loc, readPtr, elemTy,
                                        threadIsNeeded);
       }
-      warpReduce(rewriter, loc, acc, op, sizeInterWarps, 1 /* interleave */);
+      SmallVector<Value> *accPtr = &acc;
+      warpReduce(rewriter, loc, accPtr, op, sizeInterWarps, 1 /* interleave */,
+                 uniform);
       // only the first thread in each sizeInterWarps is writing
       Value writeOffset = readOffset;
       SmallVector<Value> writePtrs(op.getNumOperands());
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        auto elemTy = getElementType(op, i);
-        writePtrs[i] = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                           smemBases[i], writeOffset);
+        if (uniform[i])
+          continue;
+        writePtrs[i] =
+            getPartialPtr(helper, smemBases, i, writeOffset, rewriter);
       }
 
       Value laneIdModSizeInterWarps = urem(laneId, i32_val(sizeInterWarps));
@@ -360,13 +474,165 @@ private:
       Value pred = and_(threadIsNeeded, laneIdModSizeInterWarpsIsZero);
 
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        targetInfo.storeShared(rewriter, loc, writePtrs[i], acc[i], pred);
+        if (!uniform[i])
+          targetInfo.storeShared(rewriter, loc, writePtrs[i], acc[i], pred);
       }
 
       if (round != elemsPerThread - 1) {
         readOffset = add(readOffset, i32_val(numThreads));
       }
     }
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      if (uniform[i])
+        uniformVals[i] = acc[i];
+    }
+  }
+
+  // Compute the shared memory index of every result element held by this
+  // thread, at position 0 along the reduction axis. The indices are the same
+  // for all operands.
+  SmallVector<SmallVector<Value>>
+  getResultReadIndices(ReduceOpHelper &helper, SmallVector<unsigned> smemShape,
+                       ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    auto resultTy = dyn_cast<RankedTensorType>(op.getResult()[0].getType());
+    if (!resultTy) {
+      // 0d-tensor -> scalar
+      return {SmallVector<Value>{i32_val(0)}};
+    }
+    // nd-tensor where n >= 1
+    auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
+    unsigned resultElems = getTotalElemsPerThread(resultTy);
+    auto resultIndices =
+        emitIndices(loc, rewriter, targetInfo, resultLayout, resultTy, true);
+    auto resultShape = resultTy.getShape();
+    auto resultCTATile = getShapePerCTATile(resultLayout, resultShape);
+    assert(resultIndices.size() == resultElems);
+
+    SmallVector<SmallVector<Value>> readIndices(resultElems);
+    for (size_t j = 0; j < resultElems; ++j) {
+      SmallVector<Value> &readIdx = readIndices[j];
+      readIdx = resultIndices[j];
+      readIdx.insert(readIdx.begin() + op.getAxis(), i32_val(0));
+      for (size_t resultIdx = 0, resultDim = resultShape.size();
+           resultIdx < resultDim; ++resultIdx) {
+        auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
+        if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
+            resultShape[resultIdx] > smemShape[smemIdx]) {
+          // When srcShape smaller then src sizePerThread, only srcShape
+          // elements is accumulated in smem. Modulo smemShape effectively
+          // replicates srcShape elements to src sizePerThread.
+          readIdx[smemIdx] =
+              urem(readIdx[smemIdx], i32_val(smemShape[smemIdx]));
+        }
+      }
+    }
+    return readIndices;
+  }
+
+  // Compute the shared memory offset of every result element held by this
+  // thread.
+  SmallVector<Value>
+  getResultReadOffsets(ReduceOpHelper &helper, SmallVector<unsigned> smemShape,
+                       ConversionPatternRewriter &rewriter) const {
+    Location loc = helper.getOperation().getLoc();
+    auto smemOrder = helper.getOrderWithAxisAtBeginning();
+    SmallVector<Value> readOffsets;
+    for (SmallVector<Value> &readIdx :
+         getResultReadIndices(helper, smemShape, rewriter))
+      readOffsets.push_back(
+          linearize(rewriter, loc, readIdx, smemShape, smemOrder));
+    return readOffsets;
+  }
+
+  // Once the warps have stored their partial reductions, either a round of
+  // warp reductions combines them in shared memory and every thread loads its
+  // results after a second barrier, or every thread loads the partial results
+  // of its own outputs and combines them in registers. Pick the cheaper one,
+  // counting shared memory accesses and shuffles as one and a barrier as
+  // kBarrierCost.
+  bool reduceInterWarpsInRegisters(ReduceOpHelper &helper,
+                                   ArrayRef<bool> uniform) const {
+    constexpr unsigned kBarrierCost = 16;
+    triton::ReduceOp op = helper.getOperation();
+    unsigned sizeInterWarps = helper.getInterWarpSizeWithUniqueData();
+    unsigned resultElems = 1;
+    if (auto resultTy = dyn_cast<RankedTensorType>(op.getResult()[0].getType()))
+      resultElems = getTotalElemsPerThread(resultTy);
+    auto mod = op->getParentOfType<ModuleOp>();
+    unsigned numThreads =
+        product<unsigned>(triton::gpu::getWarpsPerCTA(helper.getSrcLayout())) *
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    unsigned rounds = std::max<unsigned>(
+        product<unsigned>(helper.getScratchConfig()) / numThreads, 1);
+    unsigned numOperands = llvm::count(uniform, false);
+    unsigned treeCost =
+        numOperands * (rounds * (2 + llvm::Log2_32(sizeInterWarps)) +
+                       resultElems) +
+        kBarrierCost;
+    unsigned registerCost = numOperands * resultElems * sizeInterWarps;
+    return registerCost <= treeCost;
+  }
+
+  // Load the partial reductions of all the warps for every result element of
+  // this thread, combine them and replace the reduce result with them. The
+  // partials are combined as a tree, in the order of the butterfly of
+  // warpReduce, so that the chain of dependent combinations grows with log2 of
+  // the number of warps rather than with the number of warps.
+  void loadPartialReductionsAndPackResult(
+      ReduceOpHelper &helper, SmallVector<unsigned> smemShape,
+      SmallVector<Value> &smemBases, SmallVector<Value> &uniformVals,
+      ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    unsigned axis = op.getAxis();
+    unsigned sizeInterWarps = helper.getInterWarpSizeWithUniqueData();
+    auto smemOrder = helper.getOrderWithAxisAtBeginning();
+    SmallVector<SmallVector<Value>> resultVals(op.getNumOperands());
+    for (SmallVector<Value> &readIdx :
+         getResultReadIndices(helper, smemShape, rewriter)) {
+      SmallVector<SmallVector<Value>> partials(sizeInterWarps, uniformVals);
+      for (unsigned w = 0; w < sizeInterWarps; ++w) {
+        readIdx[axis] = i32_val(w);
+        Value readOffset =
+            linearize(rewriter, loc, readIdx, smemShape, smemOrder);
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          if (!smemBases[i])
+            continue;
+          auto elemTy = getElementType(op, i);
+          Value readPtr =
+              getPartialPtr(helper, smemBases, i, readOffset, rewriter);
+          partials[w][i] = load(elemTy, readPtr);
+        }
+      }
+      for (unsigned stride = 1; stride < sizeInterWarps; stride *= 2)
+        for (unsigned w = 0; w + stride < sizeInterWarps; w += 2 * stride)
+          accumulate(rewriter, op.getCombineOp(), partials[w],
+                     partials[w + stride], false);
+      for (unsigned i = 0; i < op.getNumOperands(); ++i)
+        resultVals[i].push_back(partials[0][i]);
+    }
+    packReducedValues(helper, resultVals, rewriter);
+  }
+
+  // Replace the reduce op with the per-operand result values.
+  void packReducedValues(ReduceOpHelper &helper,
+                         SmallVector<SmallVector<Value>> &resultVals,
+                         ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    SmallVector<Value> results(op.getNumOperands());
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      if (auto resultTy =
+              dyn_cast<RankedTensorType>(op.getResult()[i].getType())) {
+        results[i] = packLLElements(loc, getTypeConverter(), resultVals[i],
+                                    rewriter, resultTy);
+      } else {
+        results[i] = resultVals[i][0];
+      }
+    }
+    rewriter.replaceOp(op, results);
   }
 
   // Load the final reduction from shared memory and replace the reduce result
@@ -374,57 +640,91 @@ private:
   void loadReductionAndPackResult(ReduceOpHelper &helper,
                                   SmallVector<unsigned> smemShape,
                                   SmallVector<Value> &smemBases,
+                                  SmallVector<Value> &uniformVals,
                                   ConversionPatternRewriter &rewriter) const {
     triton::ReduceOp op = helper.getOperation();
     Location loc = op.getLoc();
-    auto srcLayout = helper.getSrcLayout();
-    auto axis = op.getAxis();
-    auto smemOrder = helper.getOrderWithAxisAtBeginning();
-    SmallVector<Value> results(op.getNumOperands());
+    SmallVector<Value> readOffsets =
+        getResultReadOffsets(helper, smemShape, rewriter);
+    SmallVector<SmallVector<Value>> resultVals(op.getNumOperands());
     for (unsigned i = 0; i < op.getNumOperands(); ++i) {
       auto elemTy = getElementType(op, i);
-      if (auto resultTy =
-              dyn_cast<RankedTensorType>(op.getResult()[i].getType())) {
-        // nd-tensor where n >= 1
-        auto resultLayout = cast<SliceEncodingAttr>(resultTy.getEncoding());
-        unsigned resultElems = getTotalElemsPerThread(resultTy);
-        auto resultIndices = emitIndices(loc, rewriter, targetInfo,
-                                         resultLayout, resultTy, true);
-        auto resultShape = resultTy.getShape();
-        auto resultCTATile = getShapePerCTATile(resultLayout, resultShape);
-        assert(resultIndices.size() == resultElems);
-
-        SmallVector<Value> resultVals(resultElems);
-        for (size_t j = 0; j < resultElems; ++j) {
-          SmallVector<Value> readIdx = resultIndices[j];
-          readIdx.insert(readIdx.begin() + op.getAxis(), i32_val(0));
-          for (size_t resultIdx = 0, resultDim = resultShape.size();
-               resultIdx < resultDim; ++resultIdx) {
-            auto smemIdx = resultIdx < op.getAxis() ? resultIdx : resultIdx + 1;
-            if (resultCTATile[resultIdx] > smemShape[smemIdx] ||
-                resultShape[resultIdx] > smemShape[smemIdx]) {
-              // When srcShape smaller then src sizePerThread, only srcShape
-              // elements is accumulated in smem. Modulo smemShape effectively
-              // replicates srcShape elements to src sizePerThread.
-              readIdx[smemIdx] =
-                  urem(readIdx[smemIdx], i32_val(smemShape[smemIdx]));
-            }
-          }
-          Value readOffset =
-              linearize(rewriter, loc, readIdx, smemShape, smemOrder);
-          Value readPtr = gep(ptr_ty(rewriter.getContext(), 3), elemTy,
-                              smemBases[i], readOffset);
-          resultVals[j] = load(elemTy, readPtr);
+      for (Value readOffset : readOffsets) {
+        if (!smemBases[i]) {
+          resultVals[i].push_back(uniformVals[i]);
+          continue;
         }
+        Value readPtr =
+            getPartialPtr(helper, smemBases, i, readOffset, rewriter);
+        resultVals[i].push_back(load(elemTy, readPtr));
+      }
+    }
+    packReducedValues(helper, resultVals, rewriter);
+  }
 
-        results[i] = packLLElements(loc, getTypeConverter(), resultVals,
-                                    rewriter, resultTy);
-      } else {
-        // 0d-tensor -> scalar
-        results[i] = load(elemTy, smemBases[i]);
+  // The reduction axis is split across the CTAs of the cluster and every CTA
+  // has left its partial reduction in its own shared memory. Read the partial
+  // results of all the CTAs sharing this CTA's slice of the other dimensions,
+  // in the same order on every CTA so that they all compute the same value,
+  // and replace the reduce result with the combination.
+  void accumulateClusterReductions(ReduceOpHelper &helper,
+                                   SmallVector<unsigned> smemShape,
+                                   SmallVector<Value> &smemBases,
+                                   SmallVector<Value> &uniformVals,
+                                   ConversionPatternRewriter &rewriter) const {
+    triton::ReduceOp op = helper.getOperation();
+    Location loc = op.getLoc();
+    unsigned axis = op.getAxis();
+    auto srcLayout = helper.getSrcLayout();
+    auto CTAsPerCGA = triton::gpu::getCTAsPerCGA(srcLayout);
+    auto CTAOrder = triton::gpu::getCTAOrder(srcLayout);
+    unsigned splitNum = triton::gpu::getCTASplitNum(srcLayout)[axis];
+
+    // CTA c along the axis holds block c % splitNum; the peers are the
+    // splitNum consecutive CTAs starting at a multiple of splitNum.
+    Value clusterCTAId = targetInfo.getClusterCTAId(rewriter, loc);
+    SmallVector<Value> multiDimCTAId =
+        delinearize(rewriter, loc, clusterCTAId, CTAsPerCGA, CTAOrder);
+    Value firstPeer =
+        mul(udiv(multiDimCTAId[axis], i32_val(splitNum)), i32_val(splitNum));
+    SmallVector<Value> peerCTAIds(splitNum);
+    for (unsigned k = 0; k < splitNum; ++k) {
+      multiDimCTAId[axis] = add(firstPeer, i32_val(k));
+      peerCTAIds[k] =
+          linearize(rewriter, loc, multiDimCTAId, CTAsPerCGA, CTAOrder);
+    }
+
+    SmallVector<Value> readOffsets =
+        getResultReadOffsets(helper, smemShape, rewriter);
+
+    // Wait for the partial reductions of all the CTAs.
+    targetInfo.clusterBarrier(rewriter, loc);
+
+    SmallVector<SmallVector<Value>> resultVals(op.getNumOperands());
+    for (Value readOffset : readOffsets) {
+      SmallVector<Value> acc;
+      for (unsigned k = 0; k < splitNum; ++k) {
+        SmallVector<Value> cur = uniformVals;
+        for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+          if (!smemBases[i])
+            continue;
+          auto elemTy = getElementType(op, i);
+          Value readPtr =
+              getPartialPtr(helper, smemBases, i, readOffset, rewriter);
+          cur[i] = targetInfo.loadDShared(rewriter, loc, readPtr, peerCTAIds[k],
+                                          elemTy, true_val());
+        }
+        accumulate(rewriter, op.getCombineOp(), acc, cur, k == 0);
       }
+      for (unsigned i = 0; i < op.getNumOperands(); ++i)
+        resultVals[i].push_back(acc[i]);
     }
-    rewriter.replaceOp(op, results);
+
+    // Keep the shared memory of this CTA alive until all the peers are done
+    // reading it.
+    targetInfo.clusterBarrier(rewriter, loc);
+
+    packReducedValues(helper, resultVals, rewriter);
   }
 };
 } // namespace
@@ -52,31 +52,34 @@ public:
   }
 
   // Helper to compute the smem bases in both reductions and scans
+  // Operands marked in `skipped` get no shared memory and a null base.
   SmallVector<Value> getSmemBases(SourceOp op, unsigned elems,
-                                  ConversionPatternRewriter &rewriter) const {
+                                  ConversionPatternRewriter &rewriter,
+                                  ArrayRef<bool> skipped = {}) const {
     auto loc = op.getLoc();
     // indices will store the index of the op operands in descending order
     // of their bitwidths
-    std::vector<unsigned> indices(op.getNumOperands());
-    std::iota(indices.begin(), indices.end(), 0);
+    std::vector<unsigned> indices;
+    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
+      if (skipped.empty() || !skipped[i])
+        indices.push_back(i);
+    }
 
     std::sort(indices.begin(), indices.end(), [&](unsigned i, unsigned j) {
       return op.getElementTypes()[i].getIntOrFloatBitWidth() >
              op.getElementTypes()[j].getIntOrFloatBitWidth();
     });
+    // smemBases[k] is the base pointer for the k-th operand
+    SmallVector<Value> smemBases(op.getNumOperands());
+    if (indices.empty())
+      return smemBases;
     // Assign base index to each operand in their order in indices
-    std::map<unsigned, Value> indexToBase;
-    indexToBase[indices[0]] =
+    smemBases[indices[0]] =
         LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
-    for (unsigned i = 1; i < op.getNumOperands(); ++i) {
-      indexToBase[indices[i]] = gep(
+    for (unsigned i = 1; i < indices.size(); ++i) {
+      smemBases[indices[i]] = gep(
           ptr_ty(rewriter.getContext(), 3), getElementType(op, indices[i - 1]),
-          indexToBase[indices[i - 1]], i32_val(elems));
-    }
-    // smemBases[k] is the base pointer for the k-th operand
-    SmallVector<Value> smemBases(op.getNumOperands());
-    for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-      smemBases[i] = indexToBase[i];
+          smemBases[indices[i - 1]], i32_val(elems));
     }
     return smemBases;
   }
@@ -0,0 +1,218 @@
+#include "triton/Analysis/Utility.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace {
+struct SortOpConversion : public ConvertOpToLLVMPattern<triton::SortOp> {
+public:
+  using ConvertOpToLLVMPattern<triton::SortOp>::ConvertOpToLLVMPattern;
+
+  explicit SortOpConversion(LLVMTypeConverter &typeConverter,
+                            const TargetInfoBase &targetInfo,
+                            PatternBenefit benefit = 1)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  // The bitonic sort of 2^m elements runs m stages, and stage s runs s steps
+  // of compare-and-swap between the elements whose positions differ in bit
+  // s - 1, s - 2, ..., 0. The pairs of stage s are sorted up or down by bit s
+  // of their position, and those of the last stage in the order of the op.
+  //
+  // The bits of the position are bits of the register, lane or warp id of
+  // the element, as given by the linear layout, so the partner of an element
+  // is in the same thread, in another lane or in another warp. The first two
+  // are swapped in registers and with shuffles, the last through shared
+  // memory.
+  LogicalResult
+  matchAndRewrite(triton::SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op.getLoc();
+    SortOpHelper helper(op);
+    auto axisBits = helper.getAxisBits();
+    if (!axisBits)
+      return op.emitError("unsupported layout for sort");
+
+    SmallVector<SmallVector<Value>> srcValues;
+    for (Value src : adaptor.getSrcs())
+      srcValues.push_back(unpackLLElements(loc, src, rewriter));
+    auto mod = op->getParentOfType<ModuleOp>();
+    unsigned threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value threadId = getThreadId(rewriter, loc);
+    Value laneId = urem(threadId, i32_val(threadsPerWarp));
+    Value warpId = udiv(threadId, i32_val(threadsPerWarp));
+    Value baseSharedMemPtr;
+    if (!helper.isWarpSynchronous())
+      baseSharedMemPtr =
+          LLVM::getSharedMemoryBase(loc, rewriter, op.getOperation());
+
+    // Return bit `bit` of the position of the element in register `reg`.
+    auto getPositionBit = [&](unsigned bit, unsigned reg) -> Value {
+      auto [inDim, i] = (*axisBits)[bit];
+      if (inDim.getValue() == "register")
+        return (reg >> i) & 1 ? true_val() : false_val();
+      Value id = inDim.getValue() == "lane" ? laneId : warpId;
+      return icmp_ne(and_(id, i32_val(1 << i)), i32_val(0));
+    };
+
+    unsigned numBits = axisBits->size();
+    bool descending = op.getDescending();
+    for (unsigned stage = 1; stage <= numBits; ++stage) {
+      for (int step = stage - 1; step >= 0; --step) {
+        // Return true if the pair of register `reg` is sorted down.
+        auto isDescending = [&](unsigned reg) -> Value {
+          if (stage == numBits)
+            return descending ? true_val() : false_val();
+          return getPositionBit(stage, reg);
+        };
+        auto [inDim, i] = (*axisBits)[step];
+        if (inDim.getValue() == "register")
+          swapRegisters(loc, rewriter, srcValues, 1 << i, isDescending);
+        else
+          swapWithPartner(loc, rewriter, mod, srcValues, inDim.getValue(), i,
+                          threadId, baseSharedMemPtr,
+                          getPositionBit(step, 0), isDescending);
+      }
+    }
+
+    SmallVector<Value> results;
+    for (auto [srcVals, resultTy] : llvm::zip(srcValues, op.getResultTypes()))
+      results.push_back(packLLElements(loc, getTypeConverter(), srcVals,
+                                       rewriter, resultTy));
+    rewriter.replaceOp(op, results);
+    return success();
+  }
+
+private:
+  static Value isLess(Location loc, ConversionPatternRewriter &rewriter,
+                      Value lhs, Value rhs) {
+    if (isa<FloatType>(lhs.getType()))
+      return fcmp_olt(lhs, rhs);
+    return icmp_slt(lhs, rhs);
+  }
+
+  // Compare-and-swap the registers `reg` and `reg | regMask` of the thread.
+  void swapRegisters(Location loc, ConversionPatternRewriter &rewriter,
+                     SmallVector<SmallVector<Value>> &srcValues,
+                     unsigned regMask,
+                     function_ref<Value(unsigned)> isDescending) const {
+    SmallVector<Value> &keys = srcValues[0];
+    for (unsigned reg = 0; reg < keys.size(); ++reg) {
+      if (reg & regMask)
+        continue;
+      unsigned other = reg | regMask;
+      Value swap = select(isDescending(reg), isLess(loc, rewriter, keys[reg],
+                                                    keys[other]),
+                          isLess(loc, rewriter, keys[other], keys[reg]));
+      for (SmallVector<Value> &vals : srcValues) {
+        Value lo = select(swap, vals[other], vals[reg]);
+        Value hi = select(swap, vals[reg], vals[other]);
+        vals[reg] = lo;
+        vals[other] = hi;
+      }
+    }
+  }
+
+  // Compare-and-swap every register with the same register of the lane or
+  // warp whose id differs in bit `idBit`. Each of the two threads keeps one
+  // of the two elements, the smaller one if `isUpper` matches the direction.
+  void swapWithPartner(Location loc, ConversionPatternRewriter &rewriter,
+                       ModuleOp mod, SmallVector<SmallVector<Value>> &srcValues,
+                       StringRef inDim, int idBit, Value threadId,
+                       Value baseSharedMemPtr, Value isUpper,
+                       function_ref<Value(unsigned)> isDescending) const {
+    SmallVector<SmallVector<Value>> partnerValues;
+    if (inDim == "lane") {
+      for (SmallVector<Value> &vals : srcValues) {
+        auto &partnerVals = partnerValues.emplace_back();
+        for (Value val : vals)
+          partnerVals.push_back(
+              targetInfo.shuffleXor(rewriter, loc, val, 1 << idBit));
+      }
+    } else {
+      partnerValues = exchangeThroughSharedMemory(
+          loc, rewriter, mod, srcValues, threadId, baseSharedMemPtr, idBit);
+    }
+
+    SmallVector<Value> &keys = srcValues[0];
+    for (unsigned reg = 0; reg < keys.size(); ++reg) {
+      Value key = keys[reg];
+      Value partnerKey = partnerValues[0][reg];
+      Value keepMin = icmp_eq(isUpper, isDescending(reg));
+      Value take = select(keepMin, isLess(loc, rewriter, partnerKey, key),
+                          isLess(loc, rewriter, key, partnerKey));
+      for (auto [vals, partnerVals] : llvm::zip(srcValues, partnerValues))
+        vals[reg] = select(take, partnerVals[reg], vals[reg]);
+    }
+  }
+
+  // Return the values of the thread of the warp whose id differs in bit
+  // `warpBit`. Every operand has its own section of the scratch buffer, in
+  // which thread t stores its register r at r * numThreads + t.
+  SmallVector<SmallVector<Value>> exchangeThroughSharedMemory(
+      Location loc, ConversionPatternRewriter &rewriter, ModuleOp mod,
+      SmallVector<SmallVector<Value>> &srcValues, Value threadId,
+      Value baseSharedMemPtr, int warpBit) const {
+    unsigned threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    unsigned numThreads =
+        triton::gpu::TritonGPUDialect::getNumWarps(mod) * threadsPerWarp;
+    Value partnerId = xor_(threadId, i32_val(threadsPerWarp << warpBit));
+    auto ptrTy = baseSharedMemPtr.getType();
+
+    SmallVector<Value> sectionPtrs;
+    unsigned offset = 0;
+    for (SmallVector<Value> &vals : srcValues) {
+      sectionPtrs.push_back(
+          gep(ptrTy, i8_ty, baseSharedMemPtr, i32_val(offset)));
+      unsigned bytes =
+          ceil<unsigned>(vals[0].getType().getIntOrFloatBitWidth(), 8);
+      offset += bytes * vals.size() * numThreads;
+    }
+    // Booleans go through shared memory as bytes.
+    auto getStorageType = [&](Type ty) -> Type {
+      return ty.getIntOrFloatBitWidth() < 8 ? i8_ty : ty;
+    };
+
+    for (auto [vals, sectionPtr] : llvm::zip(srcValues, sectionPtrs)) {
+      Type storageTy = getStorageType(vals[0].getType());
+      for (unsigned reg = 0; reg < vals.size(); ++reg) {
+        Value val = vals[reg];
+        if (storageTy != val.getType())
+          val = zext(storageTy, val);
+        Value idx = add(i32_val(reg * numThreads), threadId);
+        store(val, gep(ptrTy, storageTy, sectionPtr, idx));
+      }
+    }
+    barrier();
+    SmallVector<SmallVector<Value>> partnerValues;
+    for (auto [vals, sectionPtr] : llvm::zip(srcValues, sectionPtrs)) {
+      Type elemTy = vals[0].getType();
+      Type storageTy = getStorageType(elemTy);
+      auto &partnerVals = partnerValues.emplace_back();
+      for (unsigned reg = 0; reg < vals.size(); ++reg) {
+        Value idx = add(i32_val(reg * numThreads), partnerId);
+        Value val = load(storageTy, gep(ptrTy, storageTy, sectionPtr, idx));
+        if (storageTy != elemTy)
+          val = trunc(elemTy, val);
+        partnerVals.push_back(val);
+      }
+    }
+    // The next exchange overwrites the buffer.
+    barrier();
+    return partnerValues;
+  }
+
+  const TargetInfoBase &targetInfo;
+};
+} // namespace
+
+void mlir::triton::populateSortOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    const TargetInfoBase &targetInfo, PatternBenefit benefit) {
+  patterns.add<SortOpConversion>(typeConverter, targetInfo, benefit);
+}
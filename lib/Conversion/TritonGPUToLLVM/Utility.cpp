@@ -1,6 +1,7 @@
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/LLVMIR/NVVMDialect.h"
+#include "mlir/IR/Matchers.h"
 #include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
 #include "triton/Conversion/TritonGPUToLLVM/TypeConverter.h"
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
@@ -223,25 +224,52 @@ emitIndicesUsingLinearLayouts(Location loc, RewriterBase &rewriter,
   StringAttr kWarp = str_attr("warp");
   StringAttr kBlock = str_attr("block");
 
-  Value threadId = getThreadId(rewriter, loc);
-  Value threadsPerWarp = i32_val(ll->getInDimSize(kLane));
-  Value laneId = urem(threadId, threadsPerWarp);
-  Value warpId = udiv(threadId, threadsPerWarp);
-  Value blockId =
-      withCTAOffset ? target.getClusterCTAId(rewriter, loc) : i32_val(0);
+  // The layout is linear, so the index of a register is the index of the
+  // thread's first register xor'ed with that of the register in the first
+  // thread, a constant.  The thread-dependent part only depends on the thread
+  // and CTA ids, so it is emitted at the start of the function, where it
+  // dominates every block and every region: the CSE after the conversion then
+  // computes it once per layout for the whole function rather than once per
+  // op.
+  SmallVector<std::pair<StringAttr, Value>> threadIdxs;
+  {
+    OpBuilder::InsertionGuard guard(rewriter);
+    Operation *scope = rewriter.getInsertionBlock()->getParentOp();
+    while (scope && !scope->hasTrait<OpTrait::IsIsolatedFromAbove>())
+      scope = scope->getParentOp();
+    if (auto func = dyn_cast_or_null<FunctionOpInterface>(scope))
+      rewriter.setInsertionPointToStart(&func.getFunctionBody().front());
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value threadsPerWarp = i32_val(ll->getInDimSize(kLane));
+    Value laneId = urem(threadId, threadsPerWarp);
+    Value warpId = udiv(threadId, threadsPerWarp);
+    Value blockId =
+        withCTAOffset ? target.getClusterCTAId(rewriter, loc) : i32_val(0);
+    threadIdxs = applyLinearLayout(loc, rewriter, *ll,
+                                   {{kRegister, i32_val(0)},
+                                    {kLane, laneId},
+                                    {kWarp, warpId},
+                                    {kBlock, blockId}});
+  }
+
   unsigned rank = shape.size();
+  assert(threadIdxs.size() == rank);
+  for (unsigned k = 0; k < rank; ++k) {
+    assert(threadIdxs[k].first == str_attr("dim" + std::to_string(k)));
+  }
   SmallVector<SmallVector<Value>> ret;
-  for (unsigned reg = 0; reg < ll->getInDimSize(str_attr("register")); reg++) {
-    auto idxs = applyLinearLayout(loc, rewriter, *ll,
-                                  {{kRegister, i32_val(reg)},
-                                   {kLane, laneId},
-                                   {kWarp, warpId},
-                                   {kBlock, blockId}});
-    assert(idxs.size() == rank);
-    for (unsigned k = 0; k < rank; ++k) {
-      assert(idxs[k].first == str_attr("dim" + std::to_string(k)));
+  for (unsigned reg = 0; reg < ll->getInDimSize(kRegister); reg++) {
+    auto regIdxs =
+        ll->apply({{kRegister, reg}, {kLane, 0}, {kWarp, 0}, {kBlock, 0}});
+    SmallVector<Value> idxs;
+    for (auto [threadIdx, regIdx] :
+         llvm::zip(llvm::make_second_range(threadIdxs),
+                   llvm::make_second_range(regIdxs))) {
+      idxs.push_back(regIdx == 0 ? threadIdx
+                                 : xor_(threadIdx, i32_val(regIdx)));
     }
-    ret.push_back(llvm::to_vector(llvm::make_second_range(idxs)));
+    ret.push_back(std::move(idxs));
   }
 
   return ret;
@@ -277,14 +305,16 @@ emitOffsetForLayoutUsingLinearLayouts(Attribute layout, RankedTensorType type) {
   return offsets;
 }
 
-bool emitTransferBetweenRegistersAndShared(
-    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
-    std::optional<int32_t> maxVecElems, Value shmemBase,
-    ArrayRef<Value> shmemStrides, Location loc, RewriterBase &rewriter,
-    const TargetInfoBase &target,
-    std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback) {
-  MLIRContext *ctx = rewriter.getContext();
+namespace {
 
+// Returns the layout mapping (register, lane, warp, block) of registerTy to
+// (offsetX1, ..., offsetXN, block) of sharedTy, where the offsetX's are in
+// minor-to-major order.  Returns std::nullopt if either layout can't be
+// converted to an LL or if the registers map to shared memory of other CTAs.
+std::optional<LinearLayout> getRegToSharedLayout(MLIRContext *ctx,
+                                                 RankedTensorType registerTy,
+                                                 MemDescType sharedTy,
+                                                 int32_t elemBitWidth) {
   auto shape = registerTy.getShape();
   int rank = shape.size();
 
@@ -296,9 +326,9 @@ bool emitTransferBetweenRegistersAndShared(
   std::optional<LinearLayout> regLayout =
       triton::gpu::toLinearLayout(shape, registerTy.getEncoding());
   std::optional<LinearLayout> sharedLayout = triton::gpu::toLinearLayout(
-      shape, sharedTy.getEncoding(), elemLlvmTy.getIntOrFloatBitWidth());
+      shape, sharedTy.getEncoding(), elemBitWidth);
   if (!regLayout.has_value() || !sharedLayout.has_value()) {
-    return false;
+    return std::nullopt;
   }
   auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
 
@@ -332,35 +362,79 @@ bool emitTransferBetweenRegistersAndShared(
     // offsetX1, ..., offsetXN must all be 0.
     if (!llvm::all_of(ArrayRef(idx).drop_back(1),
                       [&](auto offset) { return offset == 0; })) {
-      return false;
+      return std::nullopt;
     }
     int32_t outBlock = idx.back();
     if (outBlock != inBlock) {
-      return false;
+      return std::nullopt;
     }
   }
+  return regToSharedLayout;
+}
+
+// Returns how many consecutive registers map to consecutive shared memory
+// elements.  If the strides are constant and those of a contiguous buffer,
+// which they are unless the memdesc slices an inner dimension, the registers
+// are consecutive across the offsetX's and not only along offsetX1.
+int32_t getNumConsecutiveSharedElems(MLIRContext *ctx,
+                                     const LinearLayout &regToSharedLayout,
+                                     ArrayRef<Value> shmemStrides,
+                                     ArrayRef<unsigned> sharedOrder) {
+  StringAttr kBlock = str_attr("block");
+  auto offsetDims =
+      llvm::to_vector(llvm::drop_end(regToSharedLayout.getOutDimNames()));
+  int32_t contiguousStride = 1;
+  for (auto [offsetDim, dim] : llvm::zip(offsetDims, sharedOrder)) {
+    APInt stride;
+    if (!matchPattern(shmemStrides[dim], m_ConstantInt(&stride)) ||
+        stride.getSExtValue() != contiguousStride)
+      return regToSharedLayout.getNumConsecutiveInOut();
+    contiguousStride *= regToSharedLayout.getOutDimSize(offsetDim);
+  }
+  return regToSharedLayout
+      .reshapeOuts({{str_attr("offset"), contiguousStride},
+                    {kBlock, regToSharedLayout.getOutDimSize(kBlock)}})
+      .getNumConsecutiveInOut();
+}
+
+} // namespace
+
+bool emitTransferBetweenRegistersAndShared(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    std::optional<int32_t> maxVecElems, Value shmemBase,
+    ArrayRef<Value> shmemStrides, Location loc, RewriterBase &rewriter,
+    const TargetInfoBase &target,
+    std::function<void(VectorType, Value /*shmemAddr*/)> perVectorCallback) {
+  MLIRContext *ctx = rewriter.getContext();
+
+  StringAttr kBlock = str_attr("block");
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+  StringAttr kWarp = str_attr("warp");
+
+  std::optional<LinearLayout> regToSharedLayout = getRegToSharedLayout(
+      ctx, registerTy, sharedTy, elemLlvmTy.getIntOrFloatBitWidth());
+  if (!regToSharedLayout.has_value()) {
+    return false;
+  }
+  auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
 
-  // Determine how many consecutive registers map to consecutive shmem elements
-  // in out-dimension offsetN.  This is our load instruction's vector width.
+  // Determine how many consecutive registers map to consecutive shmem
+  // elements.  This is our load instruction's vector width.
   //
   // It's OK if the vector width we choose here is wider than the hardware
   // supports; LLVM will legalize it.
-  //
-  // TODO(jlebar): shmemStrides are Values, but most of them are usually integer
-  // constants.  We could add those constant strides to the LL, and then before
-  // calling getNumConsecutiveInOut(), we could flatten consecutive out-dims
-  // which have known strides.  This would allow us to vectorize across multiple
-  // shmem out dimensions where possible.
-  const int vecElems =
-      std::min(regToSharedLayout.getNumConsecutiveInOut(),
-               maxVecElems.value_or(std::numeric_limits<int>::max()));
+  const int vecElems = std::min(
+      getNumConsecutiveSharedElems(ctx, *regToSharedLayout, shmemStrides,
+                                   sharedOrder),
+      maxVecElems.value_or(std::numeric_limits<int>::max()));
 
   Value threadId = getThreadId(rewriter, loc);
-  Value threadsPerWarp = i32_val(regToSharedLayout.getInDimSize(kLane));
+  Value threadsPerWarp = i32_val(regToSharedLayout->getInDimSize(kLane));
   Value laneId = urem(threadId, threadsPerWarp);
   Value warpId = udiv(threadId, threadsPerWarp);
 
-  int numElems = regToSharedLayout.getInDimSize(kRegister);
+  int numElems = regToSharedLayout->getInDimSize(kRegister);
   auto vecTy = vec_ty(elemLlvmTy, vecElems);
   auto ptrTy = ptr_ty(ctx, /*addressSpace=*/3);
   Value zero = i32_val(0);
@@ -371,7 +445,7 @@ bool emitTransferBetweenRegistersAndShared(
     // we drop_end to drop block, which we know from above will be 0.
     auto multiDimShmemOffset =
         llvm::to_vector(llvm::drop_end(llvm::make_second_range(
-            applyLinearLayout(loc, rewriter, regToSharedLayout,
+            applyLinearLayout(loc, rewriter, *regToSharedLayout,
                               {{kRegister, i32_val(i * vecElems)},
                                {kLane, laneId},
                                {kWarp, warpId},
@@ -389,10 +463,150 @@ bool emitTransferBetweenRegistersAndShared(
   return true;
 }
 
+bool emitTransferBetweenRegistersAndSharedWithMatrices(
+    RankedTensorType registerTy, MemDescType sharedTy, Type elemLlvmTy,
+    Value shmemBase, ArrayRef<Value> shmemStrides, Location loc,
+    RewriterBase &rewriter,
+    std::function<void(int /*numMatrices*/, bool /*trans*/,
+                       ArrayRef<int> /*regs*/, Value /*shmemAddr*/)>
+        perInstrCallback) {
+  MLIRContext *ctx = rewriter.getContext();
+  if (!elemLlvmTy.isIntOrFloat())
+    return false;
+  int bitWidth = elemLlvmTy.getIntOrFloatBitWidth();
+  if (bitWidth != 8 && bitWidth != 16 && bitWidth != 32)
+    return false;
+  std::optional<LinearLayout> regToSharedLayout =
+      getRegToSharedLayout(ctx, registerTy, sharedTy, bitWidth);
+  if (!regToSharedLayout.has_value())
+    return false;
+  // Threads that access 16 contiguous bytes each are as fast with plain
+  // vector loads and stores.
+  auto sharedOrder = triton::gpu::getOrder(sharedTy.getEncoding());
+  int32_t numConsecutive = getNumConsecutiveSharedElems(
+      ctx, *regToSharedLayout, shmemStrides, sharedOrder);
+  if (numConsecutive * bitWidth >= 128)
+    return false;
+
+  StringAttr kBlock = str_attr("block");
+  StringAttr kRegister = str_attr("register");
+  StringAttr kLane = str_attr("lane");
+  StringAttr kWarp = str_attr("warp");
+  if (regToSharedLayout->getInDimSizeLog2(kLane) != 5)
+    return false;
+  const auto &bases = regToSharedLayout->getBases();
+  const auto &regBases = bases.find(kRegister)->second;
+  const auto &laneBases = bases.find(kLane)->second;
+
+  // Every lane holds a 32-bit piece of a row of each 8x8 matrix, and a row is
+  // 16 bytes.
+  int elemsPerReg = 32 / bitWidth;
+  int elemBits = llvm::Log2_32(elemsPerReg);
+  int rowElems = 4 * elemsPerReg;
+  if (regBases.size() < elemBits)
+    return false;
+
+  // Whether the basis moves by `elems` elements within a row.
+  auto isInRow = [&](ArrayRef<int32_t> basis, int32_t elems) {
+    return basis[0] == elems &&
+           llvm::all_of(basis.drop_front(), [](int32_t b) { return b == 0; });
+  };
+  // Whether the basis moves by whole rows in the same CTA.  The strides of the
+  // outer dimensions are powers of two no smaller than the innermost
+  // dimension, which holds a row, so only the innermost offset can split one.
+  auto isRows = [&](ArrayRef<int32_t> basis) {
+    return basis[0] % rowElems == 0 && basis.back() == 0;
+  };
+
+  // Without transposition, a lane holds consecutive elements of the row of its
+  // lane id / 4.  With transposition, 16-bit elements are transposed in 8x8
+  // blocks: a lane holds the elements of rows 2 * (lane id % 4) and the next
+  // one, in the column of its lane id / 4.
+  bool trans;
+  SmallVector<ArrayRef<int32_t>> rowBases;
+  if (llvm::all_of(llvm::seq<int>(0, elemBits),
+                   [&](int i) { return isInRow(regBases[i], 1 << i); }) &&
+      isInRow(laneBases[0], elemsPerReg) &&
+      isInRow(laneBases[1], 2 * elemsPerReg) &&
+      llvm::all_of(ArrayRef(laneBases).drop_front(2), isRows)) {
+    trans = false;
+    rowBases = {laneBases[2], laneBases[3], laneBases[4]};
+  } else if (bitWidth == 16 && isRows(regBases[0]) && isRows(laneBases[0]) &&
+             isRows(laneBases[1]) && isInRow(laneBases[2], 1) &&
+             isInRow(laneBases[3], 2) && isInRow(laneBases[4], 4)) {
+    trans = true;
+    rowBases = {regBases[0], laneBases[0], laneBases[1]};
+  } else {
+    return false;
+  }
+  // The other registers and the warps give the matrices.
+  if (!llvm::all_of(ArrayRef(regBases).drop_front(elemBits), isRows) ||
+      !llvm::all_of(bases.find(kWarp)->second, isRows))
+    return false;
+
+  // Lanes 8 * i to 8 * i + 7 give the addresses of the rows of matrix i, which
+  // is the i-th combination of the first registers after the elements.  The
+  // remaining registers are moved by separate instructions.
+  int matrixBits = std::min<int>(2, regBases.size() - elemBits);
+  std::vector<std::vector<int32_t>> addrLaneBases;
+  for (ArrayRef<int32_t> basis : rowBases)
+    addrLaneBases.push_back(basis.vec());
+  for (int i = 0; i < 2; i++) {
+    addrLaneBases.push_back(
+        i < matrixBits ? regBases[elemBits + i]
+                       : std::vector<int32_t>(rowBases[0].size(), 0));
+  }
+  std::vector<std::vector<int32_t>> addrRegBases(
+      regBases.begin() + elemBits + matrixBits, regBases.end());
+  SmallVector<std::pair<StringAttr, int32_t>> outDims;
+  for (StringAttr outDim : regToSharedLayout->getOutDimNames())
+    outDims.push_back({outDim, regToSharedLayout->getOutDimSize(outDim)});
+  LinearLayout addrLayout({{kRegister, addrRegBases},
+                           {kLane, addrLaneBases},
+                           {kWarp, bases.find(kWarp)->second},
+                           {kBlock, bases.find(kBlock)->second}},
+                          outDims, /*requireSurjective=*/false);
+
+  Value threadId = getThreadId(rewriter, loc);
+  Value laneId = urem(threadId, i32_val(32));
+  Value warpId = udiv(threadId, i32_val(32));
+  auto ptrTy = ptr_ty(ctx, /*addressSpace=*/3);
+  Value zero = i32_val(0);
+  int numMatrices = 1 << matrixBits;
+  for (int i = 0; i < (1 << addrRegBases.size()); i++) {
+    auto multiDimShmemOffset =
+        llvm::to_vector(llvm::drop_end(llvm::make_second_range(
+            applyLinearLayout(loc, rewriter, addrLayout,
+                              {{kRegister, i32_val(i)},
+                               {kLane, laneId},
+                               {kWarp, warpId},
+                               {kBlock, zero}}))));
+    Value shmemOffset = dot(rewriter, loc, multiDimShmemOffset,
+                            applyPermutation(shmemStrides, sharedOrder));
+    auto addr = gep(ptrTy, elemLlvmTy, shmemBase, shmemOffset);
+    addr.setInbounds(true);
+
+    SmallVector<int> regs;
+    for (int matrix = 0; matrix < numMatrices; matrix++) {
+      for (int elem = 0; elem < elemsPerReg; elem++)
+        regs.push_back(elem | (matrix << elemBits) |
+                       (i << (elemBits + matrixBits)));
+    }
+    perInstrCallback(numMatrices, trans, regs, addr);
+  }
+  return true;
+}
+
 std::optional<SmallVector<Value>> loadSharedToRegistersUsingLinearLayouts(
     RankedTensorType dstTy, MemDescType srcTy, Type elemLlvmTy,
     SharedMemoryObject smemObj, Location loc, RewriterBase &rewriter,
     const TargetInfoBase &target) {
+  if (std::optional<SmallVector<Value>> vals = target.loadMatricesFromShared(
+          rewriter, loc, dstTy, srcTy, elemLlvmTy, smemObj.getBase(),
+          smemObj.getStrides())) {
+    return vals;
+  }
+
   SmallVector<Value> ret;
   bool success = emitTransferBetweenRegistersAndShared(
       dstTy, srcTy, elemLlvmTy, /*maxVecElems=*/std::nullopt, smemObj.getBase(),
@@ -417,6 +631,11 @@ bool storeDistributedToSharedUsingLinearLayouts(
     MemDescType dstTy, RankedTensorType srcTy, Type elemLlvmTy,
     ArrayRef<Value> srcVals, Value smemBase, ArrayRef<Value> dstStrides,
     Location loc, RewriterBase &rewriter, const TargetInfoBase &target) {
+  if (target.storeMatricesToShared(rewriter, loc, srcTy, dstTy, elemLlvmTy,
+                                   srcVals, smemBase, dstStrides)) {
+    return true;
+  }
+
   bool success = emitTransferBetweenRegistersAndShared(
       srcTy, dstTy, elemLlvmTy, /*maxVecElems=*/std::nullopt, smemBase,
       dstStrides, loc, rewriter, target, [&](VectorType vecTy, Value vecAddr) {
@@ -520,9 +739,11 @@ SharedMemoryObject getSharedMemoryObjectFromStruct(Location loc,
   ArrayRef<Type> types =
       cast<LLVM::LLVMStructType>(llvmStruct.getType()).getBody();
   SmallVector<Value> elems(types.size());
+  // Folding sees through the struct when it was built in the same function,
+  // which keeps the strides of allocations constant.
   for (unsigned i = 0; i < types.size(); ++i) {
-    Type type = types[i];
-    elems[i] = extract_val(type, llvmStruct, i);
+    elems[i] = rewriter.createOrFold<LLVM::ExtractValueOp>(
+        loc, llvmStruct, ArrayRef<int64_t>{i});
   }
 
   auto rank = (elems.size() - 1) / 2;
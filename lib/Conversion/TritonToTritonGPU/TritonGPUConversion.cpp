@@ -91,6 +91,9 @@ TritonGPUConversionTarget::TritonGPUConversionTarget(
     : ConversionTarget(context) {
   // TODO: we should also verify ops of TritonGPUDialect
   addLegalDialect<triton::gpu::TritonGPUDialect>();
+  // The frontend builds sparse dots without layouts.
+  addDynamicallyLegalOp<triton::gpu::SparseDotOp>(
+      [&](triton::gpu::SparseDotOp op) { return typeConverter.isLegal(op); });
 
   // Some ops from SCF are illegal
   addIllegalOp<scf::ExecuteRegionOp, scf::ParallelOp, scf::ReduceOp,
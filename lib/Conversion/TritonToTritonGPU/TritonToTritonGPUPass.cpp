@@ -402,6 +402,54 @@ struct TritonSplitOpPattern : public OpConversionPattern<triton::SplitOp> {
   }
 };
 
+struct TritonUnpackPattern : public OpConversionPattern<triton::UnpackOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(UnpackOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Value src = adaptor.getSrc();
+    auto srcTy = cast<RankedTensorType>(src.getType());
+    auto srcEnc = dyn_cast<BlockedEncodingAttr>(srcTy.getEncoding());
+    if (!srcEnc)
+      return failure();
+    unsigned axis = op.getAxis();
+
+    // The bytes of each thread must be consecutive along the axis, so that
+    // doubling its elements per thread along the axis lays out the result
+    // with the nibbles of each byte next to each other.
+    if (srcEnc.getOrder().front() != axis) {
+      auto majorize = [&](ArrayRef<unsigned> order) {
+        SmallVector<unsigned> res{axis};
+        llvm::copy_if(order, std::back_inserter(res),
+                      [&](unsigned dim) { return dim != axis; });
+        return res;
+      };
+      srcEnc = BlockedEncodingAttr::get(
+          getContext(), srcEnc.getSizePerThread(), srcEnc.getThreadsPerWarp(),
+          srcEnc.getWarpsPerCTA(), majorize(srcEnc.getOrder()),
+          CTALayoutAttr::get(getContext(), srcEnc.getCTAsPerCGA(),
+                             srcEnc.getCTASplitNum(),
+                             majorize(srcEnc.getCTAOrder())));
+      srcTy = RankedTensorType::get(srcTy.getShape(), srcTy.getElementType(),
+                                    srcEnc);
+      src = rewriter.create<ConvertLayoutOp>(op.getLoc(), srcTy, src);
+    }
+
+    SmallVector<unsigned> sizePerThread(srcEnc.getSizePerThread());
+    sizePerThread[axis] *= 2;
+    auto retEnc = BlockedEncodingAttr::get(
+        getContext(), sizePerThread, srcEnc.getThreadsPerWarp(),
+        srcEnc.getWarpsPerCTA(), srcEnc.getOrder(), srcEnc.getCTALayout());
+    auto retTy = RankedTensorType::get(op.getType().getShape(),
+                                       op.getType().getElementType(), retEnc);
+    addNamedAttrs(rewriter.replaceOpWithNewOp<UnpackOp>(
+                      op, retTy, src, op.getFormat(), op.getAxis()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonTransPattern : public OpConversionPattern<TransOp> {
   using OpConversionPattern::OpConversionPattern;
 
@@ -531,7 +579,8 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
       GenericOpPattern<triton::AdvanceOp>,
       GenericOpPattern<triton::MakeTensorPtrOp>,
       GenericOpPattern<triton::ReshapeOp>, GenericOpPattern<triton::BitcastOp>,
-      GenericOpPattern<triton::FpToFpOp>, GenericOpPattern<triton::IntToPtrOp>,
+      GenericOpPattern<triton::FpToFpOp>, TritonUnpackPattern,
+      GenericOpPattern<triton::IntToPtrOp>,
       GenericOpPattern<triton::PtrToIntOp>, GenericOpPattern<triton::SplatOp>,
       TritonBroadcastPattern, GenericOpPattern<triton::AddPtrOp>,
       TritonCatPattern, TritonJoinOpPattern, TritonSplitOpPattern,
@@ -539,12 +588,23 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
       GenericOpPattern<triton::PreciseSqrtOp>,
       GenericOpPattern<triton::PreciseDivFOp>,
       GenericOpPattern<triton::MulhiUIOp>,
+      GenericOpPattern<triton::MagicDivUIOp>,
+      GenericOpPattern<triton::MagicRemUIOp>,
       GenericOpPattern<triton::ElementwiseInlineAsmOp>, TritonReducePattern,
       GenericOpPattern<triton::ReduceReturnOp>, TritonScanPattern,
       GenericOpPattern<triton::ScanReturnOp>,
       GenericOpPattern<triton::MakeRangeOp>, TritonExpandDimsPattern,
-      TritonTransPattern, TritonDotPattern, GenericOpPattern<triton::LoadOp>,
+      TritonTransPattern, TritonDotPattern,
+      GenericOpPattern<triton::DotScaledOp>,
+      GenericOpPattern<triton::gpu::SparseDotOp>,
+      GenericOpPattern<triton::LoadOp>,
       GenericOpPattern<triton::StoreOp>, GenericOpPattern<triton::HistogramOp>,
+      GenericOpPattern<triton::SortOp>, GenericOpPattern<triton::GatherOp>,
+      GenericOpPattern<triton::ClusterReduceOp>,
+      GenericOpPattern<triton::GridSyncOp>,
+      GenericOpPattern<triton::GridDepWaitOp>,
+      GenericOpPattern<triton::GridDepLaunchDependentsOp>,
+      GenericOpPattern<triton::SignalWaitOp>,
       GenericOpPattern<triton::ExternElementwiseOp>,
       GenericOpPattern<triton::PrintOp>, GenericOpPattern<triton::AssertOp>,
       GenericOpPattern<triton::AtomicCASOp>,
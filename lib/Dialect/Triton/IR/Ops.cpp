@@ -301,6 +301,71 @@ LogicalResult DotOp::verify() {
                                                      bEncoding);
 }
 
+//-- DotScaledOp --
+LogicalResult DotScaledOp::verify() {
+  auto cShape = getC().getType().getShape();
+  if (cShape.size() != 2)
+    return emitError("scaled dots must be 2D");
+  // Checks an operand against its type and returns the size of K, or 0
+  auto verifyOperand = [&](StringRef name, Value operand,
+                           ScaleDotElemType type, Value scale,
+                           int64_t nonKDim, unsigned kAxis) -> int64_t {
+    auto ty = cast<RankedTensorType>(operand.getType());
+    Type elemTy = ty.getElementType();
+    bool valid;
+    switch (type) {
+    case ScaleDotElemType::E4M3:
+      valid = elemTy.isFloat8E4M3FNUZ() || elemTy.isFloat8E4M3FN();
+      break;
+    case ScaleDotElemType::E5M2:
+      valid = elemTy.isFloat8E5M2();
+      break;
+    case ScaleDotElemType::E2M1:
+      valid = elemTy.isInteger(8);
+      break;
+    case ScaleDotElemType::BF16:
+      valid = elemTy.isBF16();
+      break;
+    }
+    if (!valid) {
+      emitError() << name << " of type " << stringifyScaleDotElemType(type)
+                  << " can't have elements of type " << elemTy;
+      return 0;
+    }
+    auto shape = ty.getShape();
+    if (shape.size() != 2 || shape[1 - kAxis] != nonKDim) {
+      emitError() << name << " doesn't match the shape of the result";
+      return 0;
+    }
+    int64_t k = shape[kAxis] * (type == ScaleDotElemType::E2M1 ? 2 : 1);
+    if ((type == ScaleDotElemType::BF16) != !scale) {
+      emitError() << name << " must be scaled unless it's bf16";
+      return 0;
+    }
+    if (scale) {
+      auto scaleShape = cast<RankedTensorType>(scale.getType()).getShape();
+      if (k % 32 != 0 || scaleShape.size() != 2 ||
+          scaleShape[0] != nonKDim || scaleShape[1] != k / 32) {
+        emitError() << "the scale of " << name
+                    << " must have a byte per block of 32 elements along K";
+        return 0;
+      }
+    }
+    return k;
+  };
+  int64_t lhsK = verifyOperand("lhs", getLhs(), getLhsType(), getLhsScale(),
+                               cShape[0], /*kAxis=*/1);
+  if (lhsK == 0)
+    return failure();
+  int64_t rhsK = verifyOperand("rhs", getRhs(), getRhsType(), getRhsScale(),
+                               cShape[1], /*kAxis=*/0);
+  if (rhsK == 0)
+    return failure();
+  if (lhsK != rhsK)
+    return emitError("lhs and rhs must have the same size along K");
+  return success();
+}
+
 //-- MakeRangeOp --
 OpFoldResult MakeRangeOp::fold(FoldAdaptor adaptor) {
   // make_range(start, start + 1) -> constant(start)
@@ -538,6 +603,56 @@ llvm::SmallVector<Type> ScanOp::getElementTypes() {
 
 unsigned ScanOp::getNumOperands() { return this->getOperands().size(); }
 
+//-- SortOp --
+void SortOp::build(OpBuilder &builder, OperationState &state,
+                   ValueRange operands, bool descending) {
+  SortOp::build(builder, state, operands.getTypes(), operands, descending);
+}
+
+LogicalResult
+SortOp::inferReturnTypes(MLIRContext *context, std::optional<Location> location,
+                         ValueRange operands, DictionaryAttr attributes,
+                         OpaqueProperties properties, RegionRange regions,
+                         SmallVectorImpl<Type> &inferredReturnTypes) {
+  for (auto arg : operands)
+    inferredReturnTypes.push_back(arg.getType());
+  return success();
+}
+
+LogicalResult SortOp::verify() {
+  if (getSrcs().empty())
+    return emitOpError("must have at least 1 operand");
+  auto srcTy = cast<RankedTensorType>(getSrcs()[0].getType());
+  if (!llvm::isPowerOf2_64(srcTy.getShape().back()))
+    return emitOpError("the size of the last dimension must be a power of 2");
+  return success();
+}
+
+//-- GatherOp --
+LogicalResult GatherOp::verify() {
+  auto srcTy = getSrc().getType();
+  auto indicesTy = getIndices().getType();
+  auto resultTy = getType();
+  if (srcTy.getRank() != indicesTy.getRank())
+    return emitOpError("source and indices must have the same rank");
+  unsigned axis = getAxis();
+  if (axis >= srcTy.getRank())
+    return emitOpError("axis ") << axis << " is out of range";
+  for (unsigned dim = 0; dim < srcTy.getRank(); ++dim) {
+    if (dim != axis && srcTy.getDimSize(dim) != indicesTy.getDimSize(dim))
+      return emitOpError("source and indices must have the same size along "
+                         "dimension ")
+             << dim;
+  }
+  if (resultTy.getShape() != indicesTy.getShape())
+    return emitOpError("result must have the shape of the indices");
+  if (resultTy.getElementType() != srcTy.getElementType())
+    return emitOpError("result must have the element type of the source");
+  if (resultTy.getEncoding() != indicesTy.getEncoding())
+    return emitOpError("result must have the layout of the indices");
+  return success();
+}
+
 //-- SplatOp --
 OpFoldResult SplatOp::fold(FoldAdaptor adaptor) {
   auto value = adaptor.getSrc();
@@ -732,6 +847,47 @@ LogicalResult FpToFpOp::verify() {
       (!getRounding().has_value())) {
     return emitError("Rounding mode is required for FP downcast");
   }
+  bool isStochastic = getRounding() == RoundingMode::RS;
+  if (isStochastic != static_cast<bool>(getRbits()))
+    return emitError("Random bits are required by, and only by, stochastic "
+                     "rounding");
+  if (isStochastic &&
+      (!(srcType.isF32() || srcType.isF16() || srcType.isBF16()) ||
+       cast<FloatType>(dstType).getFPMantissaWidth() >=
+           cast<FloatType>(srcType).getFPMantissaWidth()))
+    return emitError("Stochastic rounding is only supported from fp32, fp16 "
+                     "and bf16 to types with fewer mantissa bits");
+  return success();
+}
+
+//-- UnpackOp --
+LogicalResult UnpackOp::verify() {
+  auto srcTy = getSrc().getType();
+  auto dstTy = getType();
+  int axis = getAxis();
+  if (axis < 0 || axis >= srcTy.getRank())
+    return emitOpError("axis out of range");
+  SmallVector<int64_t> shape(srcTy.getShape());
+  shape[axis] *= 2;
+  if (dstTy.getShape() != ArrayRef(shape))
+    return emitOpError("result must have twice as many elements along axis");
+  Type elemTy = dstTy.getElementType();
+  bool isInt = getFormat() != PackedElemType::E2M1;
+  if (!(elemTy.isF16() || elemTy.isBF16() || elemTy.isF32() ||
+        (isInt && elemTy.isInteger(8))))
+    return emitOpError("unsupported result element type ") << elemTy;
+  return success();
+}
+
+//-- ClusterReduceOp --
+LogicalResult ClusterReduceOp::verify() {
+  if (getClusterSize() < 1)
+    return emitOpError("cluster size must be positive");
+  bool isFloat = isa<FloatType>(getType().getElementType());
+  auto kind = getKind();
+  if (isFloat &&
+      (kind == ClusterReduceKind::UMAX || kind == ClusterReduceKind::UMIN))
+    return emitOpError("unsigned reductions require integer elements");
   return success();
 }
 
@@ -980,5 +1136,20 @@ void ExternElementwiseOp::getEffects(
                        SideEffects::DefaultResource::get());
 }
 
+// -- ExperimentalDescriptorLoadOp --
+LogicalResult ExperimentalDescriptorLoadOp::verify() {
+  size_t rank = getIndices().size();
+  if (rank > 5)
+    return emitOpError("TMA descriptors have at most 5 dims");
+  if (getIm2colOffsets().empty())
+    return success();
+  if (rank < 3 || getIm2colOffsets().size() != rank - 2)
+    return emitOpError("im2col loads take 3 to 5 indices and an offset for "
+                       "each spatial dim");
+  if (getResult().getType().getRank() != 2)
+    return emitOpError("im2col loads produce tensors of pixels by channels");
+  return success();
+}
+
 } // namespace triton
 } // namespace mlir
@@ -1,5 +1,6 @@
 #include <memory>
 
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
@@ -29,6 +30,14 @@ bool isZero(Value val) {
   return false;
 }
 
+bool isOne(Value val) {
+  if (auto splat = val.getDefiningOp<SplatOp>())
+    val = splat.getSrc();
+  else if (auto bc = val.getDefiningOp<BroadcastOp>())
+    val = bc.getSrc();
+  return matchPattern(val, m_One()) || matchPattern(val, m_OneFloat());
+}
+
 bool isBroadcastConstantCombinable(Attribute value) {
   if (auto denseValue = dyn_cast<DenseElementsAttr>(value)) {
     return denseValue.isSplat();
@@ -223,6 +232,276 @@ public:
   }
 };
 
+// The op combining the two arguments of the region of a reduce with a single
+// operand, if it is all the region does.
+Operation *getSingleCombiner(ReduceOp reduceOp) {
+  if (reduceOp.getNumOperands() != 1)
+    return nullptr;
+  Block &block = reduceOp.getCombineOp().front();
+  if (block.getOperations().size() != 2)
+    return nullptr;
+  Operation *op = &block.front();
+  if (op->getNumOperands() != 2 || op->getNumResults() != 1 ||
+      block.getTerminator()->getOperand(0) != op->getResult(0))
+    return nullptr;
+  Value lhs = block.getArgument(0), rhs = block.getArgument(1);
+  if (!(op->getOperand(0) == lhs && op->getOperand(1) == rhs) &&
+      !(op->getOperand(0) == rhs && op->getOperand(1) == lhs))
+    return nullptr;
+  return op;
+}
+
+// reduce(expand_dims(x, axis), axis) => x
+// reduce(broadcast(x), axis), where x has size 1 along axis
+//   => broadcast(reshape(x)) * size for sums
+//   => broadcast(reshape(x)) for max, min, and and or
+// Reductions don't promise an order of summation, and the product rounds once.
+class CombineReduceBroadcastPattern : public OpRewritePattern<ReduceOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(ReduceOp reduceOp,
+                                PatternRewriter &rewriter) const override {
+    if (reduceOp.getNumOperands() != 1)
+      return failure();
+    Value src = reduceOp.getSrcs()[0];
+    Value result = reduceOp.getResult()[0];
+    int axis = reduceOp.getAxis();
+    if (auto expandOp = src.getDefiningOp<ExpandDimsOp>()) {
+      if (expandOp.getAxis() != axis ||
+          expandOp.getSrc().getType() != result.getType())
+        return failure();
+      rewriter.replaceOp(reduceOp, expandOp.getSrc());
+      return success();
+    }
+
+    auto broadcastOp = src.getDefiningOp<BroadcastOp>();
+    auto resultTy = dyn_cast<RankedTensorType>(result.getType());
+    if (!broadcastOp || !resultTy)
+      return failure();
+    auto srcTy = cast<RankedTensorType>(src.getType());
+    auto xTy = cast<RankedTensorType>(broadcastOp.getSrc().getType());
+    if (srcTy.getEncoding() || xTy.getShape()[axis] != 1)
+      return failure();
+    Operation *combiner = getSingleCombiner(reduceOp);
+    if (!combiner)
+      return failure();
+    bool isSum = isa<arith::AddFOp, arith::AddIOp>(combiner);
+    if (!isSum &&
+        !isa<arith::MaxNumFOp, arith::MinNumFOp, arith::MaximumFOp,
+             arith::MinimumFOp, arith::MaxSIOp, arith::MinSIOp,
+             arith::MaxUIOp, arith::MinUIOp, arith::AndIOp, arith::OrIOp>(
+            combiner))
+      return failure();
+
+    Location loc = reduceOp.getLoc();
+    SmallVector<int64_t> shape(xTy.getShape());
+    shape.erase(shape.begin() + axis);
+    Value x = rewriter.create<ReshapeOp>(
+        loc, RankedTensorType::get(shape, xTy.getElementType()),
+        broadcastOp.getSrc(), /*allow_reorder=*/false);
+    if (x.getType() != resultTy)
+      x = rewriter.create<BroadcastOp>(loc, resultTy, x);
+    if (isSum) {
+      Type elemTy = resultTy.getElementType();
+      int64_t size = srcTy.getShape()[axis];
+      TypedAttr sizeAttr;
+      if (isa<FloatType>(elemTy))
+        sizeAttr = rewriter.getFloatAttr(elemTy, size);
+      else
+        sizeAttr = rewriter.getIntegerAttr(elemTy, size);
+      Value scale = rewriter.create<arith::ConstantOp>(
+          loc, DenseElementsAttr::get(resultTy, sizeAttr));
+      if (isa<FloatType>(elemTy))
+        x = rewriter.create<arith::MulFOp>(loc, x, scale);
+      else
+        x = rewriter.create<arith::MulIOp>(loc, x, scale);
+    }
+    rewriter.replaceOp(reduceOp, x);
+    return success();
+  }
+};
+
+// dot(a, ones, acc) => broadcast(expand_dims(sum(a, -1), -1)) + acc
+// dot(ones, b, acc) => broadcast(expand_dims(sum(b, -2), -2)) + acc
+// Row and column sums spelled as dots don't need tensor cores. The sums are
+// taken in the type of the accumulator, like the dot.
+class CombineDotOnesPattern : public OpRewritePattern<DotOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotOp dotOp,
+                                PatternRewriter &rewriter) const override {
+    if (dotOp.getMaxNumImpreciseAcc() != 0)
+      return failure();
+    auto dTy = cast<RankedTensorType>(dotOp.getType());
+    if (dTy.getEncoding())
+      return failure();
+    int rank = dTy.getRank();
+    Value operand;
+    int axis;
+    if (isOne(dotOp.getB())) {
+      operand = dotOp.getA();
+      axis = rank - 1;
+    } else if (isOne(dotOp.getA())) {
+      operand = dotOp.getB();
+      axis = rank - 2;
+    } else {
+      return failure();
+    }
+    auto operandTy = cast<RankedTensorType>(operand.getType());
+    Type elemTy = operandTy.getElementType();
+    Type accElemTy = dTy.getElementType();
+    bool isFloat = isa<FloatType>(accElemTy);
+    // fp8 operands can't be extended by arith
+    if (isFloat && !(elemTy.isF16() || elemTy.isBF16() || elemTy.isF32()))
+      return failure();
+
+    Location loc = dotOp.getLoc();
+    if (elemTy != accElemTy) {
+      auto extTy = operandTy.clone(accElemTy);
+      if (isFloat)
+        operand = rewriter.create<arith::ExtFOp>(loc, extTy, operand);
+      else
+        operand = rewriter.create<arith::ExtSIOp>(loc, extTy, operand);
+    }
+    auto reduce = rewriter.create<ReduceOp>(loc, ValueRange{operand}, axis);
+    Block *combine =
+        rewriter.createBlock(&reduce.getCombineOp(), {},
+                             {accElemTy, accElemTy}, {loc, loc});
+    auto add = [&](Value lhs, Value rhs) -> Value {
+      if (isFloat)
+        return rewriter.create<arith::AddFOp>(loc, lhs, rhs);
+      return rewriter.create<arith::AddIOp>(loc, lhs, rhs);
+    };
+    rewriter.create<ReduceReturnOp>(
+        loc, add(combine->getArgument(0), combine->getArgument(1)));
+    rewriter.setInsertionPoint(dotOp);
+    Value sum = rewriter.create<ExpandDimsOp>(loc, reduce.getResult()[0], axis);
+    if (sum.getType() != dTy)
+      sum = rewriter.create<BroadcastOp>(loc, dTy, sum);
+    if (!isZero(dotOp.getC()))
+      sum = add(dotOp.getC(), sum);
+    rewriter.replaceOp(dotOp, sum);
+    return success();
+  }
+};
+
+// trans(splat(x)) => splat(x)
+class CombineTransSplatPattern : public OpRewritePattern<TransOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(TransOp transOp,
+                                PatternRewriter &rewriter) const override {
+    auto splatOp = transOp.getSrc().getDefiningOp<SplatOp>();
+    if (!splatOp || !isa<RankedTensorType>(transOp.getType()))
+      return failure();
+    rewriter.replaceOpWithNewOp<SplatOp>(transOp, transOp.getType(),
+                                         splatOp.getSrc());
+    return success();
+  }
+};
+
+// log(exp(x)) => x, exp(log(x)) => x and their base 2 forms, if both ops may
+// assume that there are no NaNs nor infinities.
+template <typename OuterOp, typename InnerOp>
+class CombineInverseMathPattern : public OpRewritePattern<OuterOp> {
+public:
+  using OpRewritePattern<OuterOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(OuterOp op,
+                                PatternRewriter &rewriter) const override {
+    auto innerOp = op.getOperand().template getDefiningOp<InnerOp>();
+    if (!innerOp || !isFinite(op.getFastmath()) ||
+        !isFinite(innerOp.getFastmath()))
+      return failure();
+    rewriter.replaceOp(op, innerOp.getOperand());
+    return success();
+  }
+
+private:
+  static bool isFinite(FastMathFlags flags) {
+    return arith::bitEnumContainsAll(flags,
+                                     FastMathFlags::nnan | FastMathFlags::ninf);
+  }
+};
+
+// Returns `init` in `narrowType`, if it converts exactly.
+Value getNarrowedInit(PatternRewriter &rewriter, Value init, Type narrowType) {
+  if (auto extOp = init.getDefiningOp<arith::ExtFOp>())
+    return extOp.getIn().getType() == narrowType ? extOp.getIn() : Value();
+  Attribute attr;
+  if (!matchPattern(init, m_Constant(&attr)))
+    return {};
+  if (auto denseAttr = dyn_cast<DenseElementsAttr>(attr))
+    attr = denseAttr.isSplat() ? denseAttr.getSplatValue<Attribute>()
+                               : Attribute();
+  auto floatAttr = dyn_cast_or_null<FloatAttr>(attr);
+  if (!floatAttr)
+    return {};
+  auto narrowElemTy = cast<FloatType>(getElementTypeOrSelf(narrowType));
+  APFloat value = floatAttr.getValue();
+  bool losesInfo;
+  value.convert(narrowElemTy.getFloatSemantics(),
+                APFloat::rmNearestTiesToEven, &losesInfo);
+  if (losesInfo)
+    return {};
+  return rewriter.create<arith::TruncFOp>(init.getLoc(), narrowType, init);
+}
+
+// for (acc = init) { d = dot(a, b, truncf(acc)); yield extf(d) }
+//   => for (acc = truncf(init)) { d = dot(a, b, acc); yield d }
+// Loop-carried values that are only read truncated and are updated with
+// extended values are carried in the narrow type. This keeps the fp16
+// accumulators of dots with an fp32 acc and out_dtype=float16 in fp16 through
+// the loop. The init has to convert exactly for loops without iterations.
+class CombineTruncExtLoopCarriedPattern
+    : public OpRewritePattern<scf::ForOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(scf::ForOp forOp,
+                                PatternRewriter &rewriter) const override {
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    for (auto [i, arg] : llvm::enumerate(forOp.getRegionIterArgs())) {
+      auto extOp = yieldOp.getOperand(i).getDefiningOp<arith::ExtFOp>();
+      if (!extOp)
+        continue;
+      Type wideType = arg.getType();
+      Type narrowType = extOp.getIn().getType();
+      SmallVector<Operation *> users(arg.getUsers());
+      if (!llvm::all_of(users, [&](Operation *user) {
+            auto truncOp = dyn_cast<arith::TruncFOp>(user);
+            return truncOp && truncOp.getType() == narrowType;
+          }))
+        continue;
+      rewriter.setInsertionPoint(forOp);
+      Value init =
+          getNarrowedInit(rewriter, forOp.getInitArgs()[i], narrowType);
+      if (!init)
+        continue;
+
+      Value result = forOp.getResult(i);
+      rewriter.modifyOpInPlace(forOp, [&] {
+        forOp.getInitArgsMutable()[i].set(init);
+        arg.setType(narrowType);
+        result.setType(narrowType);
+      });
+      rewriter.modifyOpInPlace(
+          yieldOp, [&] { yieldOp->setOperand(i, extOp.getIn()); });
+      for (Operation *user : users)
+        rewriter.replaceOp(user, arg);
+      rewriter.setInsertionPointAfter(forOp);
+      auto resultExtOp =
+          rewriter.create<arith::ExtFOp>(forOp.getLoc(), wideType, result);
+      rewriter.replaceAllUsesExcept(result, resultExtOp, resultExtOp);
+      return success();
+    }
+    return failure();
+  }
+};
+
 class CombineOpsPass : public TritonCombineOpsBase<CombineOpsPass> {
 public:
   void runOnOperation() override {
@@ -240,6 +519,15 @@ public:
     patterns.add<CombineAddPtrPattern>(context);
     patterns.add<CombineBroadcastConstantPattern>(context);
     patterns.add<CombineBroadcastMulReducePattern>(context);
+    patterns.add<CombineTruncExtLoopCarriedPattern>(context);
+    patterns.add<CombineReduceBroadcastPattern>(context);
+    patterns.add<CombineDotOnesPattern>(context);
+    patterns.add<CombineTransSplatPattern>(context);
+    patterns.add<CombineInverseMathPattern<math::LogOp, math::ExpOp>,
+                 CombineInverseMathPattern<math::ExpOp, math::LogOp>,
+                 CombineInverseMathPattern<math::Log2Op, math::Exp2Op>,
+                 CombineInverseMathPattern<math::Exp2Op, math::Log2Op>>(
+        context);
 
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
       signalPassFailure();
@@ -0,0 +1,70 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+class DynamicProgramIdsPass
+    : public TritonDynamicProgramIdsBase<DynamicProgramIdsPass> {
+public:
+  void runOnOperation() override {
+    for (auto funcOp : getOperation().getOps<triton::FuncOp>()) {
+      // The launcher only provides the counter to the kernels.
+      if (!funcOp.isPublic())
+        continue;
+      SmallVector<triton::GetProgramIdOp> pidOps;
+      funcOp.walk([&](triton::GetProgramIdOp op) { pidOps.push_back(op); });
+      if (pidOps.empty())
+        continue;
+      Value pid[3];
+      takeProgramIds(funcOp, pid);
+      for (triton::GetProgramIdOp op : pidOps) {
+        op.replaceAllUsesWith(pid[op.getAxisAsInt()]);
+        op.erase();
+      }
+    }
+  }
+
+private:
+  // At the start of the kernel, takes the next linear program id from a
+  // counter in a zeroed workspace, which the launcher clears before every
+  // launch, and splits it into x, y and z the way ctaid is.
+  static void takeProgramIds(triton::FuncOp funcOp, Value pid[3]) {
+    Location loc = funcOp.getLoc();
+    auto b = OpBuilder::atBlockBegin(&funcOp.getBody().front());
+    Type i32Ty = b.getI32Type();
+    auto numPrograms = [&](triton::ProgramIDDim axis) -> Value {
+      return b.create<triton::GetNumProgramsOp>(
+          loc, i32Ty, triton::ProgramIDDimAttr::get(b.getContext(), axis));
+    };
+
+    Value counter = b.create<triton::WorkspaceOp>(
+        loc, triton::PointerType::get(i32Ty, 1), /*size=*/4, /*zeroed=*/true);
+    Value one = b.create<arith::ConstantIntOp>(loc, 1, 32);
+    // A scalar atomic is executed by one thread, whose result the others
+    // read back.
+    Value linearId = b.create<triton::AtomicRMWOp>(
+        loc, i32Ty, triton::RMWOp::ADD, counter, one, /*mask=*/Value(),
+        triton::MemSemantic::RELAXED, triton::MemSyncScope::GPU);
+    Value numX = numPrograms(triton::ProgramIDDim::X);
+    Value numY = numPrograms(triton::ProgramIDDim::Y);
+    Value idYZ = b.create<arith::DivUIOp>(loc, linearId, numX);
+    pid[0] = b.create<arith::RemUIOp>(loc, linearId, numX);
+    pid[1] = b.create<arith::RemUIOp>(loc, idYZ, numY);
+    pid[2] = b.create<arith::DivUIOp>(loc, idYZ, numY);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createDynamicProgramIdsPass() {
+  return std::make_unique<DynamicProgramIdsPass>();
+}
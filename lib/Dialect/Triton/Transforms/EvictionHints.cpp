@@ -0,0 +1,118 @@
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+// How the addresses read by a load vary between the programs of the grid.
+struct PointerReuse {
+  // The program id axes the addresses depend on.
+  unsigned programIdAxes = 0;
+  // The program ids are split into tile coordinates by divisions, e.g. the
+  // 1D grids of matmuls, and the tiles along each coordinate share addresses.
+  bool decomposed = false;
+  // The addresses depend on values that aren't known, like loaded indices.
+  bool unknown = false;
+};
+
+PointerReuse getPointerReuse(Value ptr) {
+  PointerReuse reuse;
+  SmallVector<Value> worklist = {ptr};
+  DenseSet<Value> visited;
+  auto push = [&](Value value) {
+    if (visited.insert(value).second)
+      worklist.push_back(value);
+  };
+  while (!worklist.empty() && !reuse.unknown) {
+    Value value = worklist.pop_back_val();
+    if (auto arg = dyn_cast<BlockArgument>(value)) {
+      Operation *parent = arg.getOwner()->getParentOp();
+      if (isa<triton::FuncOp>(parent))
+        continue;
+      auto forOp = dyn_cast<scf::ForOp>(parent);
+      if (!forOp) {
+        reuse.unknown = true;
+      } else if (arg == forOp.getInductionVar()) {
+        push(forOp.getLowerBound());
+        push(forOp.getStep());
+      } else {
+        push(forOp.getTiedLoopInit(arg)->get());
+        push(forOp.getTiedLoopYieldedValue(arg)->get());
+      }
+      continue;
+    }
+    Operation *op = value.getDefiningOp();
+    if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op)) {
+      reuse.programIdAxes |= 1u << pidOp.getAxisAsInt();
+      continue;
+    }
+    if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+      unsigned resultNumber = cast<OpResult>(value).getResultNumber();
+      push(forOp.getInitArgs()[resultNumber]);
+      push(forOp.getBody()->getTerminator()->getOperand(resultNumber));
+      continue;
+    }
+    if (isa<triton::LoadOp>(op) || op->getNumRegions() != 0) {
+      reuse.unknown = true;
+      continue;
+    }
+    if (isa<arith::DivSIOp, arith::DivUIOp, arith::RemSIOp, arith::RemUIOp>(op))
+      reuse.decomposed = true;
+    for (Value operand : op->getOperands())
+      push(operand);
+  }
+  return reuse;
+}
+
+bool feedsDot(triton::LoadOp loadOp) {
+  SetVector<Operation *> slice;
+  getForwardSlice(loadOp.getResult(), &slice);
+  return llvm::any_of(slice,
+                      [](Operation *op) { return isa<triton::DotOp>(op); });
+}
+
+class EvictionHintsPass : public TritonEvictionHintsBase<EvictionHintsPass> {
+public:
+  void runOnOperation() override {
+    getOperation().walk([](triton::FuncOp funcOp) {
+      unsigned kernelAxes = 0;
+      funcOp.walk([&](triton::GetProgramIdOp pidOp) {
+        kernelAxes |= 1u << pidOp.getAxisAsInt();
+      });
+      // Leave the hints chosen by the user.
+      funcOp.walk([&](triton::LoadOp loadOp) {
+        if (loadOp.getEvict() != triton::EvictionPolicy::NORMAL ||
+            loadOp.getIsVolatile())
+          return;
+        PointerReuse reuse = getPointerReuse(loadOp.getPtr());
+        if (reuse.unknown)
+          return;
+        // Every program reads the same addresses, keep them in cache.
+        if (reuse.programIdAxes == 0) {
+          loadOp.setEvict(triton::EvictionPolicy::EVICT_LAST);
+          return;
+        }
+        // Each program reads its own addresses once. The operands of dots are
+        // shared by the tiles of the same rows or columns.
+        if (reuse.programIdAxes == kernelAxes && !reuse.decomposed &&
+            !feedsDot(loadOp))
+          loadOp.setEvict(triton::EvictionPolicy::EVICT_FIRST);
+      });
+    });
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createEvictionHintsPass() {
+  return std::make_unique<EvictionHintsPass>();
+}
@@ -0,0 +1,362 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+// Returns true if op or one of the ops nested in it may write to memory. Ops
+// with unknown effects, like calls, are assumed to write.
+bool mayWrite(Operation *op) {
+  return op
+      ->walk([](Operation *nested) {
+        if (auto effects = dyn_cast<MemoryEffectOpInterface>(nested)) {
+          if (effects.hasEffect<MemoryEffects::Write>())
+            return WalkResult::interrupt();
+          return WalkResult::advance();
+        }
+        if (nested->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+          return WalkResult::advance();
+        return WalkResult::interrupt();
+      })
+      .wasInterrupted();
+}
+
+// Returns true if all lanes of v are known to hold the same value: scalars,
+// splats and splat constants.
+bool isUniform(Value v) {
+  if (!isa<RankedTensorType>(v.getType()))
+    return true;
+  if (v.getDefiningOp<triton::SplatOp>())
+    return true;
+  DenseElementsAttr attr;
+  return matchPattern(v, m_Constant(&attr)) && attr.isSplat();
+}
+
+// Returns the integer value of a uniform v, if it is a constant.
+std::optional<int64_t> getUniformConstant(Value v) {
+  if (auto splat = v.getDefiningOp<triton::SplatOp>())
+    v = splat.getSrc();
+  APInt value;
+  if (!matchPattern(v, m_ConstantInt(&value)))
+    return std::nullopt;
+  return value.getSExtValue();
+}
+
+// A term of the lanes of an integer or pointer tensor that only depends on the
+// lane index along one dimension: a make_range, possibly scaled. Its values at
+// different indices are at least `gap` apart and at most `span` apart, both
+// times the absolute value of the runtime `scale` if it is set.
+struct LaneTerm {
+  int64_t span;
+  int64_t gap;
+  Value scale;
+};
+
+// The lanes of a tensor as a uniform value plus one term per dimension at
+// most. Dimensions without a term hold the same value in all their lanes.
+// `width` is the narrowest integer type the terms were computed in.
+struct LaneMap {
+  SmallVector<std::optional<LaneTerm>> terms;
+  unsigned width = 64;
+};
+
+std::optional<LaneMap> getLaneMap(Value v) {
+  auto type = dyn_cast<RankedTensorType>(v.getType());
+  if (!type)
+    return std::nullopt;
+  std::optional<LaneMap> map;
+  if (isUniform(v)) {
+    map = LaneMap();
+    map->terms.resize(type.getRank());
+    return map;
+  }
+  Operation *def = v.getDefiningOp();
+  if (!def)
+    return std::nullopt;
+  if (auto range = dyn_cast<triton::MakeRangeOp>(def)) {
+    map = LaneMap();
+    int64_t span = int64_t(range.getEnd()) - range.getStart() - 1;
+    map->terms.push_back(LaneTerm{span, /*gap=*/1, Value()});
+  } else if (auto expand = dyn_cast<triton::ExpandDimsOp>(def)) {
+    if ((map = getLaneMap(expand.getSrc())))
+      map->terms.insert(map->terms.begin() + expand.getAxis(), std::nullopt);
+  } else if (auto broadcast = dyn_cast<triton::BroadcastOp>(def)) {
+    // The broadcast dimensions had a single lane, whose term is uniform.
+    if ((map = getLaneMap(broadcast.getSrc()))) {
+      auto srcShape =
+          cast<RankedTensorType>(broadcast.getSrc().getType()).getShape();
+      for (auto [term, srcSize] : llvm::zip(map->terms, srcShape))
+        if (srcSize == 1)
+          term = std::nullopt;
+    }
+  } else if (auto trans = dyn_cast<triton::TransOp>(def)) {
+    if (auto src = getLaneMap(trans.getSrc())) {
+      map = LaneMap();
+      map->width = src->width;
+      for (int32_t dim : trans.getOrder())
+        map->terms.push_back(src->terms[dim]);
+    }
+  } else if (isa<arith::ExtSIOp, arith::ExtUIOp>(def)) {
+    map = getLaneMap(def->getOperand(0));
+  } else if (isa<triton::AddPtrOp, arith::AddIOp, arith::SubIOp>(def)) {
+    // The terms of both sides must be on different dimensions.
+    auto lhs = getLaneMap(def->getOperand(0));
+    auto rhs = lhs ? getLaneMap(def->getOperand(1)) : std::nullopt;
+    if (!rhs)
+      return std::nullopt;
+    for (auto [term, rhsTerm] : llvm::zip(lhs->terms, rhs->terms)) {
+      if (term && rhsTerm)
+        return std::nullopt;
+      if (rhsTerm)
+        term = rhsTerm;
+    }
+    lhs->width = std::min(lhs->width, rhs->width);
+    map = lhs;
+  } else if (isa<arith::MulIOp>(def)) {
+    Value lhs = def->getOperand(0), rhs = def->getOperand(1);
+    if (isUniform(lhs))
+      std::swap(lhs, rhs);
+    if (!isUniform(rhs) || !(map = getLaneMap(lhs)))
+      return std::nullopt;
+    if (std::optional<int64_t> factor = getUniformConstant(rhs)) {
+      if (*factor == 0 || *factor == std::numeric_limits<int64_t>::min())
+        return std::nullopt;
+      for (auto &term : map->terms)
+        if (term && (llvm::MulOverflow(term->span, std::abs(*factor),
+                                       term->span) ||
+                     llvm::MulOverflow(term->gap, std::abs(*factor),
+                                       term->gap)))
+          return std::nullopt;
+    } else {
+      // A runtime stride, e.g. the row stride of a 2D tile.
+      auto splat = rhs.getDefiningOp<triton::SplatOp>();
+      if (!splat)
+        return std::nullopt;
+      for (auto &term : map->terms) {
+        if (term && term->scale)
+          return std::nullopt;
+        if (term)
+          term->scale = splat.getSrc();
+      }
+    }
+  } else {
+    return std::nullopt;
+  }
+  if (map && type.getElementType().isInteger())
+    map->width = std::min(map->width, type.getElementTypeBitWidth());
+  return map;
+}
+
+// The lanes of a lane map are pairwise different if every dimension with
+// several lanes has a term, and the terms, ordered by gap, each have a larger
+// gap than the sum of the spans of the ones before, which it then can't
+// cancel. The values must not wrap, so that sum must fit in the width of the
+// map.
+//
+// A term scaled by a runtime value may only be the last one. Returns whether
+// the constant terms are pairwise different, and sets `scaledTerm` to the
+// scaled term and `constantSpan` to the sum of the constant spans, for
+// `getScaleCondition`.
+bool hasUniqueConstantTerms(const LaneMap &map, ArrayRef<int64_t> shape,
+                            std::optional<LaneTerm> &scaledTerm,
+                            int64_t &constantSpan) {
+  SmallVector<LaneTerm> terms;
+  for (auto [term, size] : llvm::zip(map.terms, shape)) {
+    if (size == 1)
+      continue;
+    if (!term)
+      return false;
+    if (!term->scale) {
+      terms.push_back(*term);
+      continue;
+    }
+    if (scaledTerm)
+      return false;
+    scaledTerm = term;
+  }
+  llvm::sort(terms, [](const LaneTerm &a, const LaneTerm &b) {
+    return a.gap < b.gap;
+  });
+  constantSpan = 0;
+  for (const LaneTerm &term : terms) {
+    if (term.gap <= constantSpan ||
+        llvm::AddOverflow(constantSpan, term.span, constantSpan))
+      return false;
+  }
+  return constantSpan <= int64_t(APInt::getSignedMaxValue(map.width)
+                                     .getLimitedValue(INT64_MAX));
+}
+
+// Returns true if the lanes of the pointer or integer v are known to hold
+// pairwise different values:
+//   - a make_range, offset by uniform values, and reshaped or permuted
+//     without broadcasting; or
+//   - a sum of terms along different dimensions that can't cancel each
+//     other, e.g. `rows[:, None] * 64 + cols[None, :]` for 64 columns.
+// Any other definition, including function arguments and loaded values, may
+// repeat a value across lanes.
+bool hasUniqueLanes(Value v) {
+  auto type = dyn_cast<RankedTensorType>(v.getType());
+  if (!type)
+    return true;
+  if (auto map = getLaneMap(v)) {
+    std::optional<LaneTerm> scaledTerm;
+    int64_t constantSpan;
+    if (hasUniqueConstantTerms(*map, type.getShape(), scaledTerm,
+                               constantSpan) &&
+        !scaledTerm)
+      return true;
+  }
+  Operation *def = v.getDefiningOp();
+  if (!def)
+    return false;
+  if (isa<triton::MakeRangeOp>(def))
+    return true;
+  if (isa<triton::ExpandDimsOp, triton::ReshapeOp, triton::TransOp,
+          arith::ExtSIOp, arith::ExtUIOp>(def))
+    return hasUniqueLanes(def->getOperand(0));
+  if (isa<triton::AddPtrOp, arith::AddIOp, arith::SubIOp>(def)) {
+    Value lhs = def->getOperand(0), rhs = def->getOperand(1);
+    return (hasUniqueLanes(lhs) && isUniform(rhs)) ||
+           (isUniform(lhs) && hasUniqueLanes(rhs));
+  }
+  return false;
+}
+
+// Returns an i1 that is true when the lanes of the pointer or integer v are
+// pairwise different, for lane maps whose last term is scaled by a runtime
+// stride S, e.g. `rows[:, None] * stride + cols[None, :]`. That is the case
+// when |S| * gap is larger than the span of the other terms, and the values
+// don't wrap. Returns null if the lanes can't be told apart at runtime
+// either.
+Value getScaleCondition(Value v, OpBuilder &builder, Location loc) {
+  auto type = dyn_cast<RankedTensorType>(v.getType());
+  std::optional<LaneMap> map = type ? getLaneMap(v) : std::nullopt;
+  std::optional<LaneTerm> scaledTerm;
+  int64_t constantSpan;
+  if (!map ||
+      !hasUniqueConstantTerms(*map, type.getShape(), scaledTerm,
+                              constantSpan) ||
+      !scaledTerm)
+    return Value();
+  // lo < |S| <= hi
+  int64_t maxValue =
+      APInt::getSignedMaxValue(map->width).getLimitedValue(INT64_MAX);
+  int64_t lo = constantSpan / scaledTerm->gap;
+  int64_t hi = (maxValue - constantSpan) / scaledTerm->span;
+  if (lo >= hi)
+    return Value();
+  Value scale = scaledTerm->scale;
+  Type scaleType = scale.getType();
+  auto cst = [&](int64_t value) -> Value {
+    return builder.create<arith::ConstantOp>(
+        loc, scaleType, builder.getIntegerAttr(scaleType, value));
+  };
+  auto cmp = [&](arith::CmpIPredicate pred, int64_t value) -> Value {
+    return builder.create<arith::CmpIOp>(loc, pred, scale, cst(value));
+  };
+  Value positive =
+      builder.create<arith::AndIOp>(loc, cmp(arith::CmpIPredicate::sgt, lo),
+                                    cmp(arith::CmpIPredicate::sle, hi));
+  Value negative =
+      builder.create<arith::AndIOp>(loc, cmp(arith::CmpIPredicate::slt, -lo),
+                                    cmp(arith::CmpIPredicate::sge, -hi));
+  return builder.create<arith::OrIOp>(loc, positive, negative);
+}
+
+// Returns true if the store's lanes cover the ones loadOp reads and its value
+// can replace the load, assuming that no two of its lanes store to the same
+// address.
+bool canForward(triton::StoreOp storeOp, triton::LoadOp loadOp) {
+  if (loadOp.getIsVolatile() ||
+      triton::isTensorPointerType(loadOp.getPtr().getType()) ||
+      storeOp.getValue().getType() != loadOp.getType())
+    return false;
+  // The lanes the load reads must all have been written by the store.
+  return !storeOp.getMask() || storeOp.getMask() == loadOp.getMask();
+}
+
+// Returns the value loadOp reads after storeOp, built at the builder's
+// insertion point.
+Value getForwardedValue(triton::StoreOp storeOp, triton::LoadOp loadOp,
+                        OpBuilder &builder) {
+  Value mask = loadOp.getMask();
+  if (!mask || !loadOp.getOther())
+    return storeOp.getValue();
+  return builder.create<arith::SelectOp>(loadOp.getLoc(), mask,
+                                         storeOp.getValue(), loadOp.getOther());
+}
+
+// Replaces loadOp with the value storeOp stored to the same pointers. When
+// two lanes of the store write the same address, the load reads the value of
+// only one of them in both lanes, so the pointers must have unique lanes,
+// either statically or checked at runtime, in which case the load is kept
+// for the other case.
+void forward(triton::StoreOp storeOp, triton::LoadOp loadOp) {
+  OpBuilder builder(loadOp);
+  Location loc = loadOp.getLoc();
+  Value value;
+  if (hasUniqueLanes(loadOp.getPtr())) {
+    value = getForwardedValue(storeOp, loadOp, builder);
+  } else if (Value cond = getScaleCondition(loadOp.getPtr(), builder, loc)) {
+    auto ifOp = builder.create<scf::IfOp>(loc, loadOp.getType(), cond,
+                                          /*withElseRegion=*/true);
+    builder.setInsertionPointToStart(ifOp.thenBlock());
+    builder.create<scf::YieldOp>(loc,
+                                 getForwardedValue(storeOp, loadOp, builder));
+    builder.setInsertionPointToStart(ifOp.elseBlock());
+    Operation *load = builder.clone(*loadOp.getOperation());
+    builder.create<scf::YieldOp>(loc, load->getResults());
+    value = ifOp.getResult(0);
+  } else {
+    return;
+  }
+  loadOp.getResult().replaceAllUsesWith(value);
+  loadOp.erase();
+}
+
+class ForwardStoreToLoadPass
+    : public TritonForwardStoreToLoadBase<ForwardStoreToLoadPass> {
+public:
+  void runOnOperation() override {
+    // Forwarding may create blocks, which are not visited.
+    SmallVector<Block *> blocks;
+    getOperation().walk([&](Block *block) { blocks.push_back(block); });
+    for (Block *block : blocks) {
+      // The last store to each pointer since the last op that may have
+      // written to memory through another pointer.
+      DenseMap<Value, triton::StoreOp> lastStores;
+      for (Operation &op : llvm::make_early_inc_range(*block)) {
+        if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+          auto storeOp = lastStores.lookup(loadOp.getPtr());
+          if (storeOp && canForward(storeOp, loadOp))
+            forward(storeOp, loadOp);
+          continue;
+        }
+        if (!mayWrite(&op))
+          continue;
+        // Pointers with different values may alias.
+        lastStores.clear();
+        if (auto storeOp = dyn_cast<triton::StoreOp>(op))
+          lastStores[storeOp.getPtr()] = storeOp;
+      }
+    }
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createForwardStoreToLoadPass() {
+  return std::make_unique<ForwardStoreToLoadPass>();
+}
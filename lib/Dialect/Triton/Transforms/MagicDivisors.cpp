@@ -0,0 +1,156 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+// The kernel argument that value splats, if it is a divisor.
+BlockArgument getDivisorArg(Value value) {
+  if (auto splat = value.getDefiningOp<triton::SplatOp>())
+    value = splat.getSrc();
+  auto arg = dyn_cast<BlockArgument>(value);
+  if (!arg || !arg.getType().isInteger(32))
+    return {};
+  auto funcOp = dyn_cast<triton::FuncOp>(arg.getOwner()->getParentOp());
+  if (!funcOp || !funcOp.getArgAttr(arg.getArgNumber(), "tt.divisor"))
+    return {};
+  return arg;
+}
+
+// Whether AxisInfo knows nothing about the tensor beyond the defaults, so
+// computing it differently loses nothing. Scalars don't vectorize anything.
+bool isUninformative(triton::ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                     Value value) {
+  auto tensorTy = dyn_cast<RankedTensorType>(value.getType());
+  if (!tensorTy)
+    return true;
+  auto *axisInfo = axisInfoAnalysis.getAxisInfo(value);
+  if (!axisInfo)
+    return false;
+  for (int d = 0; d < tensorTy.getRank(); ++d) {
+    if (axisInfo->getContiguity(d) > 1 || axisInfo->getConstancy(d) > 1 ||
+        axisInfo->getDivisibility(d) > 1)
+      return false;
+  }
+  return true;
+}
+
+class MagicDivisorsPass : public TritonMagicDivisorsBase<MagicDivisorsPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    auto i32Ty = IntegerType::get(&getContext(), 32);
+
+    // The launcher rejects divisors that aren't positive
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      for (unsigned i = 0; i < funcOp.getNumArguments(); ++i) {
+        if (!funcOp.getArgAttr(i, "tt.divisor") ||
+            !funcOp.getArgument(i).getType().isInteger(32) ||
+            funcOp.getArgAttr(i, "tt.range"))
+          continue;
+        auto rangeTy = RankedTensorType::get({2}, i32Ty);
+        funcOp.setArgAttr(
+            i, "tt.range",
+            DenseIntElementsAttr::get(
+                rangeTy, ArrayRef<int32_t>{1, static_cast<int32_t>(
+                                                  llvm::maxIntN(32))}));
+      }
+    }
+
+    // Divisions and remainders by divisors of kernels, which the launcher
+    // provides the magic numbers of. Signed dividends that may be negative
+    // are divided by their absolute value, which loses what AxisInfo knows
+    // about the results, so tensors are only divided that way when it knows
+    // nothing about them.
+    triton::ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+    SmallVector<std::pair<Operation *, bool>> ops;
+    mod.walk([&](Operation *op) {
+      if (!isa<arith::DivSIOp, arith::DivUIOp, arith::RemSIOp, arith::RemUIOp>(
+              op))
+        return;
+      BlockArgument arg = getDivisorArg(op->getOperand(1));
+      if (!arg || !cast<triton::FuncOp>(arg.getOwner()->getParentOp())
+                       .isPublic())
+        return;
+      auto *axisInfo = axisInfoAnalysis.getAxisInfo(op->getOperand(0));
+      if (axisInfo && axisInfo->getRange() && axisInfo->getRange()->first >= 0)
+        ops.push_back({op, /*isSigned=*/false});
+      else if (isa<arith::DivSIOp, arith::RemSIOp>(op) &&
+               isUninformative(axisInfoAnalysis, op->getResult(0)))
+        ops.push_back({op, /*isSigned=*/true});
+    });
+    if (ops.empty())
+      return;
+
+    // The magic number and the shift of each divisor are appended to the
+    // arguments of the kernel
+    DenseMap<BlockArgument, std::pair<Value, Value>> magicArgs;
+    llvm::json::Array report;
+    OpBuilder b(&getContext());
+    for (auto [op, isSigned] : ops) {
+      BlockArgument arg = getDivisorArg(op->getOperand(1));
+      auto [it, inserted] = magicArgs.try_emplace(arg);
+      if (inserted) {
+        auto funcOp = cast<triton::FuncOp>(arg.getOwner()->getParentOp());
+        unsigned argIdx = funcOp.getNumArguments();
+        funcOp.insertArgument(argIdx, i32Ty, {}, funcOp.getLoc());
+        funcOp.insertArgument(argIdx + 1, i32Ty, {}, funcOp.getLoc());
+        it->second = {funcOp.getArgument(argIdx),
+                      funcOp.getArgument(argIdx + 1)};
+        report.push_back(arg.getArgNumber());
+      }
+      auto [magic, shift] = it->second;
+      Location loc = op->getLoc();
+      b.setInsertionPoint(op);
+      Value x = op->getOperand(0);
+      Value divisor = op->getOperand(1);
+      if (auto tensorTy = dyn_cast<RankedTensorType>(x.getType())) {
+        magic = b.create<triton::SplatOp>(loc, tensorTy, magic);
+        shift = b.create<triton::SplatOp>(loc, tensorTy, shift);
+      }
+      // Both the quotient and the remainder of signed divisions have the sign
+      // of the dividend. The absolute value of INT_MIN is 2^31 when unsigned.
+      Value isNeg, zero;
+      if (isSigned) {
+        zero = b.create<arith::ConstantOp>(loc, b.getZeroAttr(x.getType()));
+        isNeg =
+            b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, x, zero);
+        x = b.create<arith::SelectOp>(loc, isNeg,
+                                      b.create<arith::SubIOp>(loc, zero, x), x);
+      }
+      Value result;
+      if (isa<arith::DivSIOp, arith::DivUIOp>(op))
+        result = b.create<triton::MagicDivUIOp>(loc, x, divisor, magic, shift);
+      else
+        result = b.create<triton::MagicRemUIOp>(loc, x, divisor, magic, shift);
+      if (isSigned)
+        result = b.create<arith::SelectOp>(
+            loc, isNeg, b.create<arith::SubIOp>(loc, zero, result), result);
+      op->getResult(0).replaceAllUsesWith(result);
+      op->erase();
+    }
+
+    std::string json;
+    llvm::raw_string_ostream os(json);
+    os << llvm::json::Value(std::move(report));
+    mod->setAttr("tt.magic_divisors",
+                 StringAttr::get(&getContext(), os.str()));
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createMagicDivisorsPass() {
+  return std::make_unique<MagicDivisorsPass>();
+}
@@ -0,0 +1,195 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+bool fitsInI32(const std::optional<triton::AxisInfo::RangeT> &range) {
+  return range.has_value() && range->first >= llvm::minIntN(32) &&
+         range->second <= llvm::maxIntN(32);
+}
+
+// Whether the pointers are only accessed and are based on a kernel argument
+// with a `tt.max_size` hint, in which case the offsets of the elements that
+// are accessed are within [0, max_size).
+bool isWithinMaxSize(triton::AddPtrOp addPtrOp) {
+  Value base = addPtrOp.getPtr();
+  if (auto splat = base.getDefiningOp<triton::SplatOp>())
+    base = splat.getSrc();
+  auto arg = dyn_cast<BlockArgument>(base);
+  if (!arg)
+    return false;
+  auto funcOp = dyn_cast<triton::FuncOp>(arg.getOwner()->getParentOp());
+  if (!funcOp)
+    return false;
+  auto maxSize = dyn_cast_or_null<IntegerAttr>(
+      funcOp.getArgAttr(arg.getArgNumber(), "tt.max_size"));
+  if (!maxSize || maxSize.getInt() <= 0 ||
+      maxSize.getInt() > llvm::maxIntN(32))
+    return false;
+  Value ptr = addPtrOp.getResult();
+  return llvm::all_of(ptr.getUsers(), [&](Operation *user) {
+    if (auto loadOp = dyn_cast<triton::LoadOp>(user))
+      return loadOp.getPtr() == ptr;
+    if (auto storeOp = dyn_cast<triton::StoreOp>(user))
+      return storeOp.getPtr() == ptr && storeOp.getValue() != ptr;
+    return false;
+  });
+}
+
+// Recomputes i64 offsets with i32 arithmetic. Additions, subtractions and
+// multiplications wrap the same way at both widths, so the i32 results are
+// the low halves of the i64 ones, which are equal to them when they fit in
+// i32, whatever the intermediate values.
+class OffsetNarrower {
+public:
+  // Returns the i32 version of value, or null if it isn't computed with such
+  // ops from extended i32 values, constants and scalars.
+  Value narrow(Value value) {
+    auto it = narrowed.find(value);
+    if (it != narrowed.end())
+      return it->second;
+    Value result = narrowImpl(value);
+    narrowed[value] = result;
+    return result;
+  }
+
+  // Erases the i64 computations that aren't used anymore, and the i32 ones of
+  // the offsets that couldn't be narrowed after all.
+  void eraseDeadOps() {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (Operation *&op : ops) {
+        if (op && isOpTriviallyDead(op)) {
+          op->erase();
+          op = nullptr;
+          changed = true;
+        }
+      }
+    }
+  }
+
+private:
+  Value narrowImpl(Value value) {
+    auto *ctx = value.getContext();
+    Type i32Ty = IntegerType::get(ctx, 32);
+    Location loc = value.getLoc();
+    Operation *def = value.getDefiningOp();
+    OpBuilder builder(ctx);
+    if (def)
+      builder.setInsertionPointAfter(def);
+    else
+      builder.setInsertionPointToStart(cast<BlockArgument>(value).getOwner());
+    auto record = [&](Value result) {
+      ops.push_back(result.getDefiningOp());
+      return result;
+    };
+
+    auto tensorTy = dyn_cast<RankedTensorType>(value.getType());
+    Type narrowTy = tensorTy ? tensorTy.clone(i32Ty) : i32Ty;
+    if (isa_and_nonnull<arith::ExtSIOp, arith::ExtUIOp>(def)) {
+      ops.push_back(def);
+      Value src = def->getOperand(0);
+      unsigned bitWidth = getElementTypeOrSelf(src).getIntOrFloatBitWidth();
+      if (bitWidth == 32)
+        return src;
+      if (isa<arith::ExtSIOp>(def))
+        return record(builder.create<arith::ExtSIOp>(loc, narrowTy, src));
+      return record(builder.create<arith::ExtUIOp>(loc, narrowTy, src));
+    }
+    // Scalars are cheap to truncate where they are defined
+    if (!tensorTy)
+      return record(builder.create<arith::TruncIOp>(loc, i32Ty, value));
+    if (!def)
+      return Value();
+    ops.push_back(def);
+    if (auto cst = dyn_cast<arith::ConstantOp>(def)) {
+      auto attr = dyn_cast<DenseIntElementsAttr>(cst.getValue());
+      if (!attr)
+        return Value();
+      return record(builder.create<arith::ConstantOp>(
+          loc, attr.mapValues(i32Ty, [](const APInt &v) {
+            return v.trunc(32);
+          })));
+    }
+    if (isa<arith::AddIOp, arith::SubIOp, arith::MulIOp>(def)) {
+      Value lhs = narrow(def->getOperand(0));
+      Value rhs = narrow(def->getOperand(1));
+      if (!lhs || !rhs)
+        return Value();
+      // The overflow flags of the i64 ops don't hold in i32
+      if (isa<arith::AddIOp>(def))
+        return record(builder.create<arith::AddIOp>(loc, lhs, rhs));
+      if (isa<arith::SubIOp>(def))
+        return record(builder.create<arith::SubIOp>(loc, lhs, rhs));
+      return record(builder.create<arith::MulIOp>(loc, lhs, rhs));
+    }
+    if (auto splat = dyn_cast<triton::SplatOp>(def)) {
+      Value src = narrow(splat.getSrc());
+      if (!src)
+        return Value();
+      return record(builder.create<triton::SplatOp>(loc, narrowTy, src));
+    }
+    if (auto broadcast = dyn_cast<triton::BroadcastOp>(def)) {
+      Value src = narrow(broadcast.getSrc());
+      if (!src)
+        return Value();
+      return record(builder.create<triton::BroadcastOp>(loc, narrowTy, src));
+    }
+    if (auto expandDims = dyn_cast<triton::ExpandDimsOp>(def)) {
+      Value src = narrow(expandDims.getSrc());
+      if (!src)
+        return Value();
+      return record(builder.create<triton::ExpandDimsOp>(
+          loc, src, expandDims.getAxis()));
+    }
+    return Value();
+  }
+
+  DenseMap<Value, Value> narrowed;
+  SmallVector<Operation *> ops;
+};
+
+class NarrowOffsetsPass : public TritonNarrowOffsetsBase<NarrowOffsetsPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    triton::ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+    SmallVector<triton::AddPtrOp> addPtrOps;
+    mod.walk([&](triton::AddPtrOp addPtrOp) {
+      Value offset = addPtrOp.getOffset();
+      auto offsetTy = dyn_cast<RankedTensorType>(offset.getType());
+      if (!offsetTy || !offsetTy.getElementType().isInteger(64))
+        return;
+      auto *axisInfo = axisInfoAnalysis.getAxisInfo(offset);
+      if ((axisInfo && fitsInI32(axisInfo->getRange())) ||
+          isWithinMaxSize(addPtrOp))
+        addPtrOps.push_back(addPtrOp);
+    });
+
+    OffsetNarrower narrower;
+    for (triton::AddPtrOp addPtrOp : addPtrOps) {
+      if (Value offset = narrower.narrow(addPtrOp.getOffset()))
+        addPtrOp.getOffsetMutable().assign(offset);
+    }
+    narrower.eraseDeadOps();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createNarrowOffsetsPass() {
+  return std::make_unique<NarrowOffsetsPass>();
+}
@@ -0,0 +1,168 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+constexpr int kNumAxes = 3;
+
+bool usesProgramIds(Operation *op) {
+  return op
+      ->walk([](Operation *nested) {
+        if (isa<triton::GetProgramIdOp, triton::GetNumProgramsOp>(nested))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      })
+      .wasInterrupted();
+}
+
+// Tile order: x varies fastest, then y, then z.
+SmallVector<Value> scheduleDataParallel(OpBuilder &b, Location loc,
+                                        Value tile, ArrayRef<Value> grid) {
+  Value x = b.create<arith::RemSIOp>(loc, tile, grid[0]);
+  Value yz = b.create<arith::DivSIOp>(loc, tile, grid[0]);
+  Value y = b.create<arith::RemSIOp>(loc, yz, grid[1]);
+  Value z = b.create<arith::DivSIOp>(loc, yz, grid[1]);
+  return {x, y, z};
+}
+
+// Tile order inside each z-slice: groups of `groupSize` rows along x are
+// visited column by column, so that consecutive tiles share operands along
+// both axes. The last group may be shorter than `groupSize`.
+SmallVector<Value> scheduleGrouped(OpBuilder &b, Location loc, Value tile,
+                                   ArrayRef<Value> grid, int groupSize) {
+  Value group = b.create<arith::ConstantIntOp>(loc, groupSize, 32);
+  Value sliceSize = b.create<arith::MulIOp>(loc, grid[0], grid[1]);
+  Value z = b.create<arith::DivSIOp>(loc, tile, sliceSize);
+  Value rem = b.create<arith::RemSIOp>(loc, tile, sliceSize);
+  Value tilesPerGroup = b.create<arith::MulIOp>(loc, group, grid[1]);
+  Value groupId = b.create<arith::DivSIOp>(loc, rem, tilesPerGroup);
+  Value firstX = b.create<arith::MulIOp>(loc, groupId, group);
+  Value remainingX = b.create<arith::SubIOp>(loc, grid[0], firstX);
+  Value curGroupSize = b.create<arith::MinSIOp>(loc, remainingX, group);
+  Value inGroup = b.create<arith::RemSIOp>(loc, rem, tilesPerGroup);
+  Value offsetX = b.create<arith::RemSIOp>(loc, inGroup, curGroupSize);
+  Value x = b.create<arith::AddIOp>(loc, firstX, offsetX);
+  Value y = b.create<arith::DivSIOp>(loc, inGroup, curGroupSize);
+  return {x, y, z};
+}
+
+class PersistentKernelPass
+    : public TritonPersistentKernelBase<PersistentKernelPass> {
+public:
+  PersistentKernelPass() = default;
+  PersistentKernelPass(StringRef scheduler, int groupSize) {
+    this->scheduler = scheduler.str();
+    this->groupSize = groupSize;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    StringRef schedulerName = scheduler.getValue();
+    if (schedulerName != "data-parallel" && schedulerName != "grouped") {
+      mod.emitError("unknown tile scheduler '") << schedulerName << "'";
+      return signalPassFailure();
+    }
+    if (groupSize < 1) {
+      mod.emitError("group-size must be positive");
+      return signalPassFailure();
+    }
+
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      if (funcOp.isPublic() || !usesProgramIds(funcOp))
+        continue;
+      // The virtual grid is only visible inside the kernel itself.
+      funcOp.emitError("program ids used outside of a kernel cannot be "
+                       "remapped for persistent execution");
+      return signalPassFailure();
+    }
+
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      if (!funcOp.isPublic())
+        continue;
+      if (failed(convertKernel(funcOp)))
+        return signalPassFailure();
+    }
+  }
+
+private:
+  LogicalResult convertKernel(triton::FuncOp funcOp) {
+    if (!funcOp.getBody().hasOneBlock())
+      return funcOp.emitError("persistent kernels must have a single block");
+
+    Block &entry = funcOp.getBody().front();
+    auto returnOp = dyn_cast<triton::ReturnOp>(entry.getTerminator());
+    if (!returnOp)
+      return funcOp.emitError("expected kernel to end with tt.return");
+
+    Location loc = funcOp.getLoc();
+    OpBuilder b(funcOp.getContext());
+    Type i32Ty = b.getI32Type();
+
+    // Append the virtual grid size (x, y, z) to the kernel arguments.
+    SmallVector<Value> grid;
+    for (int i = 0; i < kNumAxes; ++i) {
+      unsigned idx = funcOp.getNumArguments();
+      funcOp.insertArgument(idx, i32Ty, b.getDictionaryAttr({}), loc);
+      grid.push_back(funcOp.getArgument(idx));
+    }
+
+    // Persistent kernels are always launched on a one-dimensional grid.
+    b.setInsertionPointToStart(&entry);
+    auto axisX =
+        triton::ProgramIDDimAttr::get(b.getContext(), triton::ProgramIDDim::X);
+    Value pid = b.create<triton::GetProgramIdOp>(loc, i32Ty, axisX);
+    Value numPrograms = b.create<triton::GetNumProgramsOp>(loc, i32Ty, axisX);
+    Value gridXY = b.create<arith::MulIOp>(loc, grid[0], grid[1]);
+    Value numTiles = b.create<arith::MulIOp>(loc, gridXY, grid[2]);
+    auto forOp = b.create<scf::ForOp>(loc, pid, numTiles, numPrograms);
+
+    // Move the original body, except the terminator, into the loop.
+    Block *loopBody = forOp.getBody();
+    loopBody->getOperations().splice(
+        loopBody->begin(), entry.getOperations(),
+        std::next(Block::iterator(forOp)), Block::iterator(returnOp));
+
+    b.setInsertionPointToStart(loopBody);
+    Value tile = forOp.getInductionVar();
+    SmallVector<Value> programIds =
+        scheduler.getValue() == "grouped"
+            ? scheduleGrouped(b, loc, tile, grid, groupSize)
+            : scheduleDataParallel(b, loc, tile, grid);
+
+    SmallVector<Operation *> toErase;
+    loopBody->walk([&](Operation *op) {
+      if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op)) {
+        pidOp.getResult().replaceAllUsesWith(programIds[pidOp.getAxisAsInt()]);
+        toErase.push_back(op);
+      } else if (auto numOp = dyn_cast<triton::GetNumProgramsOp>(op)) {
+        numOp.getResult().replaceAllUsesWith(grid[numOp.getAxisAsInt()]);
+        toErase.push_back(op);
+      }
+    });
+    for (Operation *op : toErase)
+      op->erase();
+
+    return success();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createPersistentKernelPass() {
+  return std::make_unique<PersistentKernelPass>();
+}
+
+std::unique_ptr<Pass> triton::createPersistentKernelPass(StringRef scheduler,
+                                                         int groupSize) {
+  return std::make_unique<PersistentKernelPass>(scheduler, groupSize);
+}
@@ -2,11 +2,13 @@
 #include <stack>
 
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LLVM.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/JSON.h"
 
 using namespace mlir;
 
@@ -45,9 +47,17 @@ public:
 
   unsigned int length() const { return shape.size(); }
 
+  Value getBase() const { return base; }
+
+  ArrayRef<Value> getShape() const { return shape; }
+
+  ArrayRef<Value> getStrides() const { return strides; }
+
+  ArrayRef<int64_t> getTensorShape() const { return tensorShape; }
+
   Value getOffset(unsigned i) { return offsets[i]; }
 
-  SmallVector<Value> getOffsets() { return offsets; }
+  SmallVector<Value> getOffsets() const { return offsets; }
 
   void setOffset(unsigned i, Value newOffset) {
     offsets[i] = newOffset;
@@ -190,6 +200,39 @@ public:
   }
 };
 
+// The kernel argument or the constant the launcher reads `value` from, looking
+// through integer extensions
+std::optional<llvm::json::Value> getLaunchValue(Value value,
+                                                triton::FuncOp kernel) {
+  while (isa_and_nonnull<arith::ExtSIOp, arith::ExtUIOp>(value.getDefiningOp()))
+    value = value.getDefiningOp()->getOperand(0);
+  if (auto arg = dyn_cast<BlockArgument>(value)) {
+    if (arg.getOwner() != &kernel.getBody().front())
+      return std::nullopt;
+    return llvm::json::Object{{"arg", arg.getArgNumber()}};
+  }
+  APInt constant;
+  if (matchPattern(value, m_ConstantInt(&constant)))
+    return llvm::json::Object{{"value", constant.getSExtValue()}};
+  return std::nullopt;
+}
+
+// Whether `value` is known to be a multiple of `divisor`, from the constant
+// it is or the divisibility of the kernel argument it comes from
+bool isMultipleOf(Value value, int64_t divisor, triton::FuncOp kernel) {
+  while (isa_and_nonnull<arith::ExtSIOp, arith::ExtUIOp>(value.getDefiningOp()))
+    value = value.getDefiningOp()->getOperand(0);
+  APInt constant;
+  if (matchPattern(value, m_ConstantInt(&constant)))
+    return constant.getSExtValue() % divisor == 0;
+  auto arg = dyn_cast<BlockArgument>(value);
+  if (!arg || arg.getOwner() != &kernel.getBody().front())
+    return false;
+  auto divisibility = kernel.getArgAttrOfType<IntegerAttr>(
+      arg.getArgNumber(), "tt.divisibility");
+  return divisibility && divisibility.getInt() % divisor == 0;
+}
+
 } // namespace
 
 // TODO: this pass relies on assumptions of how block pointers are created and
@@ -201,7 +244,27 @@ class RewriteTensorPointerPass
 private:
   DenseMap<Value, RewritedInfo> rewritedInfo;
 
+  // A TMA descriptor argument appended to the kernel
+  struct TMADescriptor {
+    Value base;
+    SmallVector<Value> shape;
+    SmallVector<Value> strides;
+    SmallVector<int64_t> tensorShape;
+    BlockArgument arg;
+  };
+  // The kernel that gets the descriptors, if tma-descriptors is set and the
+  // module has a single one
+  triton::FuncOp tmaKernel;
+  SmallVector<TMADescriptor> descriptors;
+  // How the launcher fills each descriptor, in the order of their arguments
+  llvm::json::Array descriptorReport;
+
 public:
+  RewriteTensorPointerPass() = default;
+  RewriteTensorPointerPass(bool tmaDescriptors) {
+    this->tmaDescriptors = tmaDescriptors;
+  }
+
   static bool needRewrite(Operation *op) {
     return std::any_of(op->getOperands().begin(), op->getOperands().end(),
                        [](Value operand) {
@@ -274,6 +337,108 @@ public:
     return nullptr;
   }
 
+  // Returns the descriptor argument for the block pointer `info` accessed by
+  // op, or null if the access can't be done with TMA. The descriptor tiles
+  // the tensor by the block shape, with the dims the block pointer has. TMA
+  // zero-fills out of bounds loads and drops out of bounds stores, which are
+  // the semantics of the boundary checks.
+  Value getTMADescriptor(OpBuilder &builder, Operation *op,
+                         const RewritedInfo &info) {
+    auto kernel = op->getParentOfType<triton::FuncOp>();
+    if (!tmaKernel || kernel != tmaKernel)
+      return Value();
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      auto padding = loadOp.getPadding();
+      if (loadOp.getIsVolatile() ||
+          (padding && *padding != triton::PaddingOption::PAD_ZERO))
+        return Value();
+    }
+
+    // The global address and the strides of the outer dims must be 16-byte
+    // aligned, and the innermost dim contiguous. The launcher fills the
+    // descriptors with fill_tma_descriptor, whose box and swizzling convention
+    // the TMA lowering relies on.
+    unsigned rank = info.length();
+    auto elemTy = cast<triton::PointerType>(info.getBase().getType())
+                      .getPointeeType();
+    if (rank < 1 || rank > 5 || !elemTy.isIntOrFloat())
+      return Value();
+    int64_t elemBytes = elemTy.getIntOrFloatBitWidth() / 8;
+    ArrayRef<int64_t> tensorShape = info.getTensorShape();
+    if ((elemBytes != 1 && elemBytes != 2 && elemBytes != 4) ||
+        tensorShape.back() * elemBytes < 32 ||
+        llvm::any_of(tensorShape, [](int64_t size) { return size > 256; }))
+      return Value();
+    APInt innerStride;
+    if (!matchPattern(info.getStrides().back(), m_ConstantInt(&innerStride)) ||
+        innerStride != 1)
+      return Value();
+    if (!isMultipleOf(info.getBase(), 16, kernel))
+      return Value();
+    for (Value stride : info.getStrides().drop_back()) {
+      if (!isMultipleOf(stride, 16 / elemBytes, kernel))
+        return Value();
+    }
+
+    for (const TMADescriptor &desc : descriptors) {
+      if (desc.base == info.getBase() &&
+          llvm::equal(desc.shape, info.getShape()) &&
+          llvm::equal(desc.strides, info.getStrides()) &&
+          llvm::equal(desc.tensorShape, tensorShape))
+        return desc.arg;
+    }
+    auto base = getLaunchValue(info.getBase(), kernel);
+    if (!base)
+      return Value();
+    llvm::json::Array shape, strides;
+    for (auto [size, stride] : llvm::zip(info.getShape(), info.getStrides())) {
+      auto launchSize = getLaunchValue(size, kernel);
+      auto launchStride = getLaunchValue(stride, kernel);
+      if (!launchSize || !launchStride)
+        return Value();
+      shape.push_back(std::move(*launchSize));
+      strides.push_back(std::move(*launchStride));
+    }
+    unsigned argIdx = kernel.getNumArguments();
+    auto descTy = triton::PointerType::get(builder.getI8Type(), 1);
+    kernel.insertArgument(
+        argIdx, descTy,
+        builder.getDictionaryAttr(
+            builder.getNamedAttr("tt.nv_tma_desc", builder.getUnitAttr())),
+        kernel.getLoc());
+    BlockArgument arg = kernel.getArgument(argIdx);
+    descriptors.push_back(
+        {info.getBase(), SmallVector<Value>(info.getShape()),
+         SmallVector<Value>(info.getStrides()),
+         SmallVector<int64_t>(tensorShape), arg});
+    descriptorReport.push_back(llvm::json::Object{
+        {"base", std::move(*base)},
+        {"shape", std::move(shape)},
+        {"strides", std::move(strides)},
+        {"block", llvm::json::Array(tensorShape)},
+        {"elem_bytes", elemBytes},
+    });
+    return arg;
+  }
+
+  void rewriteDescriptorLoadStoreOp(OpBuilder &builder, Operation *op,
+                                    Value desc, const RewritedInfo &info) {
+    SmallVector<Value> indices;
+    for (Value offset : info.getOffsets())
+      indices.push_back(builder.create<arith::TruncIOp>(
+          op->getLoc(), builder.getI32Type(), offset));
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      auto newResult = builder.create<triton::ExperimentalDescriptorLoadOp>(
+          loadOp.getLoc(), loadOp.getType(), desc, indices, loadOp.getCache(),
+          loadOp.getEvict());
+      op->getResult(0).replaceAllUsesWith(newResult);
+    } else {
+      auto storeOp = cast<triton::StoreOp>(op);
+      builder.create<triton::ExperimentalDescriptorStoreOp>(
+          storeOp.getLoc(), desc, storeOp.getValue(), indices);
+    }
+  }
+
   Operation *rewriteLoadStoreOp(OpBuilder &builder, Operation *op,
                                 std::stack<Operation *> &eraser) {
     assert(isa<triton::LoadOp>(op) || isa<triton::StoreOp>(op));
@@ -287,6 +452,14 @@ public:
     assert(rewritedInfo.count(ptr));
     auto info = rewritedInfo[ptr];
 
+    if (tmaDescriptors) {
+      if (Value desc = getTMADescriptor(builder, op, info)) {
+        rewriteDescriptorLoadStoreOp(builder, op, desc, info);
+        eraser.push(op);
+        return nullptr;
+      }
+    }
+
     // Load/store with tensor pointers implicitly will check the bound while
     // accessing memory, so we should set `mask` and `other` (according to the
     // padding). Also note that load with tensor pointers do not have `mask` and
@@ -553,8 +726,18 @@ public:
     // So here we recursively build the IR, to be specific, we have to rewrite
     // `tt.make_tensor_ptr`, `tt.advance`, `tt.load`, `tt.store`,
     // `scf.for` (tensor pointer usages may be in a loop fashion)
+    ModuleOp mod = getOperation();
+    if (tmaDescriptors) {
+      SmallVector<triton::FuncOp> kernels;
+      for (auto funcOp : mod.getOps<triton::FuncOp>())
+        if (funcOp.isPublic())
+          kernels.push_back(funcOp);
+      if (kernels.size() == 1)
+        tmaKernel = kernels.front();
+    }
+
     std::stack<Operation *> eraser;
-    visitOperation(getOperation(), eraser);
+    visitOperation(mod, eraser);
 
     // The operation could not be erased during visit, because they may have
     // later usages, so we erase after visit
@@ -564,9 +747,25 @@ public:
       eraser.pop();
       op->erase();
     }
+
+    if (!descriptorReport.empty()) {
+      std::string json;
+      llvm::raw_string_ostream os(json);
+      os << llvm::json::Value(std::move(descriptorReport));
+      mod->setAttr("tt.tma_descriptors",
+                   StringAttr::get(&getContext(), os.str()));
+    }
+    tmaKernel = nullptr;
+    descriptors.clear();
+    descriptorReport.clear();
   }
 };
 
 std::unique_ptr<Pass> triton::createRewriteTensorPointerPass() {
   return std::make_unique<RewriteTensorPointerPass>();
 }
+
+std::unique_ptr<Pass>
+triton::createRewriteTensorPointerPass(bool tmaDescriptors) {
+  return std::make_unique<RewriteTensorPointerPass>(tmaDescriptors);
+}
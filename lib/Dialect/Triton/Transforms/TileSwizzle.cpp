@@ -0,0 +1,235 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+constexpr unsigned kOperandA = 1u << 0;
+constexpr unsigned kOperandB = 1u << 1;
+
+// Returns the operands of dots, kOperandA and kOperandB, whose values depend
+// on `value`, following the values carried by loops.
+unsigned getDependentDotOperands(Value value) {
+  unsigned operands = 0;
+  SmallVector<Value> worklist = {value};
+  DenseSet<Value> visited;
+  auto push = [&](Value value) {
+    if (visited.insert(value).second)
+      worklist.push_back(value);
+  };
+  while (!worklist.empty()) {
+    Value current = worklist.pop_back_val();
+    for (OpOperand &use : current.getUses()) {
+      Operation *user = use.getOwner();
+      if (isa<triton::DotOp>(user) && use.getOperandNumber() < 2)
+        operands |= 1u << use.getOperandNumber();
+      if (auto forOp = dyn_cast<scf::ForOp>(user)) {
+        if (BlockArgument arg = forOp.getTiedLoopRegionIterArg(&use)) {
+          push(arg);
+          push(forOp.getTiedLoopResult(&use));
+        } else {
+          push(forOp.getInductionVar());
+        }
+        continue;
+      }
+      if (auto yieldOp = dyn_cast<scf::YieldOp>(user)) {
+        Operation *parent = yieldOp->getParentOp();
+        unsigned idx = use.getOperandNumber();
+        if (auto forOp = dyn_cast<scf::ForOp>(parent))
+          push(forOp.getRegionIterArgs()[idx]);
+        push(parent->getResult(idx));
+        continue;
+      }
+      for (Value result : user->getResults())
+        push(result);
+    }
+  }
+  return operands;
+}
+
+// Whether `op` is one of the divisions that split program ids into tiles.
+bool isDivision(Operation *op) {
+  return isa<arith::DivSIOp, arith::DivUIOp, arith::RemSIOp, arith::RemUIOp>(
+      op);
+}
+
+bool hasDivisionUsers(Value value) {
+  return llvm::any_of(value.getUsers(), isDivision);
+}
+
+// Whether one of `lhs` and `rhs` indexes the rows of a and the other the
+// columns of b, with `lhsIsM` set when `lhs` indexes the rows.
+bool indexDotTiles(Value lhs, Value rhs, bool &lhsIsM) {
+  unsigned lhsOperands = getDependentDotOperands(lhs);
+  unsigned rhsOperands = getDependentDotOperands(rhs);
+  lhsIsM = lhsOperands == kOperandA;
+  return (lhsIsM && rhsOperands == kOperandB) ||
+         (lhsOperands == kOperandB && rhsOperands == kOperandA);
+}
+
+// Returns the coordinates (m, n) of the `tile`-th tile of a `gm` x `gn` grid,
+// when groups of `groupSize` rows along m are visited column by column.
+std::pair<Value, Value> getGroupedTile(OpBuilder &b, Location loc, Value tile,
+                                       Value gm, Value gn, int groupSize) {
+  Value group = b.create<arith::ConstantIntOp>(loc, groupSize, tile.getType());
+  Value tilesPerGroup = b.create<arith::MulIOp>(loc, group, gn);
+  Value groupId = b.create<arith::DivSIOp>(loc, tile, tilesPerGroup);
+  Value firstM = b.create<arith::MulIOp>(loc, groupId, group);
+  Value remainingM = b.create<arith::SubIOp>(loc, gm, firstM);
+  Value curGroupSize = b.create<arith::MinSIOp>(loc, remainingM, group);
+  Value inGroup = b.create<arith::RemSIOp>(loc, tile, tilesPerGroup);
+  Value offsetM = b.create<arith::RemSIOp>(loc, inGroup, curGroupSize);
+  Value m = b.create<arith::AddIOp>(loc, firstM, offsetM);
+  Value n = b.create<arith::DivSIOp>(loc, inGroup, curGroupSize);
+  return {m, n};
+}
+
+class TileSwizzlePass : public TritonTileSwizzleBase<TileSwizzlePass> {
+public:
+  TileSwizzlePass() = default;
+  TileSwizzlePass(int groupSize) { this->groupSize = groupSize; }
+
+  void runOnOperation() override {
+    if (groupSize < 1) {
+      getOperation().emitError("group-size must be positive");
+      return signalPassFailure();
+    }
+    for (auto funcOp : getOperation().getOps<triton::FuncOp>()) {
+      if (!funcOp.isPublic())
+        continue;
+      SmallVector<triton::GetProgramIdOp> pidOps[2];
+      funcOp.walk([&](triton::GetProgramIdOp pidOp) {
+        if (pidOp.getAxisAsInt() < 2)
+          pidOps[pidOp.getAxisAsInt()].push_back(pidOp);
+      });
+      if (pidOps[0].size() != 1 || pidOps[1].size() > 1)
+        continue;
+      if (pidOps[1].empty())
+        swizzleDecomposedGrid(pidOps[0].front());
+      else
+        swizzleGrid(pidOps[0].front(), pidOps[1].front());
+    }
+  }
+
+private:
+  // A 1D grid split into tiles by `pid / n` and `pid % n`: the program id is
+  // permuted so that the quotients and remainders follow the grouped order.
+  // Programs past the last full row of tiles keep their id. A grid with fewer
+  // programs than `n` is a single row, which the grouped order leaves alone.
+  void swizzleDecomposedGrid(triton::GetProgramIdOp pidOp) {
+    Value pid = pidOp.getResult();
+    SmallVector<Operation *> users(pid.getUsers());
+    if (users.empty())
+      return;
+    Value divisor = users.front()->getOperand(1);
+    Value quotient, remainder;
+    Operation *firstUser = users.front();
+    for (Operation *user : users) {
+      if (!isa<arith::DivSIOp, arith::RemSIOp>(user) ||
+          user->getOperand(0) != pid || user->getOperand(1) != divisor ||
+          user->getBlock() != firstUser->getBlock())
+        return;
+      // Ids already split further are swizzled by hand.
+      if (hasDivisionUsers(user->getResult(0)))
+        return;
+      (isa<arith::DivSIOp>(user) ? quotient : remainder) = user->getResult(0);
+      if (user->isBeforeInBlock(firstUser))
+        firstUser = user;
+    }
+    bool quotientIsM;
+    if (!quotient || !remainder ||
+        !indexDotTiles(quotient, remainder, quotientIsM))
+      return;
+
+    OpBuilder b(firstUser);
+    Location loc = pidOp.getLoc();
+    Value numPrograms = b.create<triton::GetNumProgramsOp>(
+        loc, pid.getType(), pidOp.getAxisAttr());
+    // The tiles of the programs past the last row are never used, but they
+    // are clamped to avoid divisions by zero in the grouped order.
+    Value zero = b.create<arith::ConstantIntOp>(loc, 0, 32);
+    Value one = b.create<arith::ConstantIntOp>(loc, 1, 32);
+    Value fullRows = b.create<arith::DivSIOp>(loc, numPrograms, divisor);
+    Value rows = b.create<arith::MaxSIOp>(loc, fullRows, one);
+    Value numTiles = b.create<arith::MulIOp>(loc, rows, divisor);
+    Value inTiles = b.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                            pid, numTiles);
+    Value tile = b.create<arith::SelectOp>(loc, inTiles, pid, zero);
+    Value newQuotient, newRemainder;
+    if (quotientIsM)
+      std::tie(newQuotient, newRemainder) =
+          getGroupedTile(b, loc, tile, rows, divisor, groupSize);
+    else
+      std::tie(newRemainder, newQuotient) =
+          getGroupedTile(b, loc, tile, divisor, rows, groupSize);
+    Value rowStart = b.create<arith::MulIOp>(loc, newQuotient, divisor);
+    Value swizzled = b.create<arith::AddIOp>(loc, rowStart, newRemainder);
+    Value newPid = b.create<arith::SelectOp>(loc, inTiles, swizzled, pid);
+    for (Operation *user : users)
+      user->replaceUsesOfWith(pid, newPid);
+  }
+
+  // A 2D grid whose program ids index the tiles directly: the programs,
+  // launched in x-major order, are reassigned the tiles of the grouped order.
+  void swizzleGrid(triton::GetProgramIdOp pidXOp,
+                   triton::GetProgramIdOp pidYOp) {
+    Value pidX = pidXOp.getResult();
+    Value pidY = pidYOp.getResult();
+    bool xIsM;
+    if (pidXOp->getBlock() != pidYOp->getBlock() || hasDivisionUsers(pidX) ||
+        hasDivisionUsers(pidY) || !indexDotTiles(pidX, pidY, xIsM))
+      return;
+
+    SmallVector<Operation *> usersX(pidX.getUsers());
+    SmallVector<Operation *> usersY(pidY.getUsers());
+    OpBuilder b(pidXOp->getContext());
+    b.setInsertionPointAfter(pidXOp->isBeforeInBlock(pidYOp) ? pidYOp
+                                                             : pidXOp);
+    Location loc = pidXOp.getLoc();
+    Type i32Ty = pidX.getType();
+    Type i64Ty = b.getI64Type();
+    Value gx = b.create<triton::GetNumProgramsOp>(loc, i32Ty,
+                                                  pidXOp.getAxisAttr());
+    Value gy = b.create<triton::GetNumProgramsOp>(loc, i32Ty,
+                                                  pidYOp.getAxisAttr());
+    // The linear tile index of a 2D grid may not fit in 32 bits, the grouped
+    // order is computed in 64 bits and the coordinates truncated back.
+    auto ext = [&](Value v) -> Value {
+      return b.create<arith::ExtSIOp>(loc, i64Ty, v);
+    };
+    Value gx64 = ext(gx);
+    Value gy64 = ext(gy);
+    Value rowStart = b.create<arith::MulIOp>(loc, ext(pidY), gx64);
+    Value tile = b.create<arith::AddIOp>(loc, rowStart, ext(pidX));
+    Value x, y;
+    if (xIsM)
+      std::tie(x, y) = getGroupedTile(b, loc, tile, gx64, gy64, groupSize);
+    else
+      std::tie(y, x) = getGroupedTile(b, loc, tile, gy64, gx64, groupSize);
+    x = b.create<arith::TruncIOp>(loc, i32Ty, x);
+    y = b.create<arith::TruncIOp>(loc, i32Ty, y);
+    for (Operation *user : usersX)
+      user->replaceUsesOfWith(pidX, x);
+    for (Operation *user : usersY)
+      user->replaceUsesOfWith(pidY, y);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createTileSwizzlePass() {
+  return std::make_unique<TileSwizzlePass>();
+}
+
+std::unique_ptr<Pass> triton::createTileSwizzlePass(int groupSize) {
+  return std::make_unique<TileSwizzlePass>(groupSize);
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+constexpr int64_t kWorkspaceAlignment = 128;
+
+class AllocateWorkspacePass
+    : public TritonAllocateWorkspaceBase<AllocateWorkspacePass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    int64_t size = 0;
+    int64_t zeroedSize = 0;
+    for (auto funcOp : mod.getOps<triton::FuncOp>()) {
+      SmallVector<triton::WorkspaceOp> workspaces;
+      funcOp.walk([&](triton::WorkspaceOp op) { workspaces.push_back(op); });
+      if (workspaces.empty())
+        continue;
+      // The launcher only provides the buffer to the kernels.
+      if (!funcOp.isPublic()) {
+        workspaces.front().emitError(
+            "workspaces can't be requested by functions that aren't inlined");
+        return signalPassFailure();
+      }
+      auto [kernelSize, kernelZeroedSize] = allocate(funcOp, workspaces);
+      size = std::max(size, kernelSize);
+      zeroedSize = std::max(zeroedSize, kernelZeroedSize);
+    }
+    if (size == 0)
+      return;
+    Builder b(mod.getContext());
+    mod->setAttr("tt.workspace_size", b.getI64IntegerAttr(size));
+    mod->setAttr("tt.workspace_zeroed_size", b.getI64IntegerAttr(zeroedSize));
+  }
+
+private:
+  // Replaces the workspaces of the kernel by offsets in a new argument, and
+  // returns the bytes they span and the bytes the zeroed ones span.
+  static std::pair<int64_t, int64_t>
+  allocate(triton::FuncOp funcOp,
+           SmallVector<triton::WorkspaceOp> &workspaces) {
+    // The zeroed workspaces come first, the others keep their order.
+    std::stable_partition(
+        workspaces.begin(), workspaces.end(),
+        [](triton::WorkspaceOp op) { return op.getZeroed(); });
+
+    OpBuilder b(funcOp.getContext());
+    auto bufferTy = triton::PointerType::get(b.getI8Type(), 1);
+    unsigned argIdx = funcOp.getNumArguments();
+    funcOp.insertArgument(
+        argIdx, bufferTy,
+        b.getDictionaryAttr(b.getNamedAttr(
+            "tt.divisibility", b.getI32IntegerAttr(kWorkspaceAlignment))),
+        funcOp.getLoc());
+    Value buffer = funcOp.getArgument(argIdx);
+
+    int64_t size = 0;
+    int64_t zeroedSize = 0;
+    for (triton::WorkspaceOp op : workspaces) {
+      int64_t offset = llvm::alignTo(size, kWorkspaceAlignment);
+      size = offset + op.getSize();
+      if (op.getZeroed())
+        zeroedSize = size;
+
+      Location loc = op.getLoc();
+      b.setInsertionPoint(op);
+      Value ptr = buffer;
+      if (offset != 0) {
+        Value offsetVal = b.create<arith::ConstantIntOp>(loc, offset, 64);
+        ptr = b.create<triton::AddPtrOp>(loc, bufferTy, buffer, offsetVal);
+      }
+      if (ptr.getType() != op.getType())
+        ptr = b.create<triton::BitcastOp>(loc, op.getType(), ptr);
+      op.replaceAllUsesWith(ptr);
+      op.erase();
+    }
+    // The launcher clears the zeroed workspaces a word at a time.
+    return {llvm::alignTo(size, 4), llvm::alignTo(zeroedSize, 4)};
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> triton::createAllocateWorkspacePass() {
+  return std::make_unique<AllocateWorkspacePass>();
+}
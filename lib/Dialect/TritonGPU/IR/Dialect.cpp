@@ -8,6 +8,7 @@
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "triton/Tools/StrUtil.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include "llvm/ADT/TypeSwitch.h"
@@ -2319,13 +2320,42 @@ struct TritonGPUInferLayoutInterface
   //   - OK: 32x4 sizePerThread=[4,4] -> 128.  dst with sizePerThread=[16] will
   //     contain the same elements as before.
   //
+  // When these rules don't apply, e.g. to slice encodings, the source layout
+  // is reshaped as a linear layout instead, and the result is kept if it is a
+  // blocked encoding.
+  //
   // Users of this function require that it is symmetrical: if
   // (srcShape,srcEnc,dstShape) => dstEnc, then (dstShape,dstEnc,srcShape) =>
-  // srcEnc.
+  // srcEnc.  This only holds for the blocked rules; the results of the linear
+  // layout fallback for other encodings have to be checked by inverting them.
   LogicalResult
   inferReshapeOpNoReorderEncoding(ArrayRef<int64_t> srcShape, Attribute srcEnc,
                                   ArrayRef<int64_t> dstShape, Attribute &dstEnc,
                                   std::optional<Location> loc) const override {
+    if (succeeded(inferBlockedReshapeOpNoReorderEncoding(
+            srcShape, srcEnc, dstShape, dstEnc, /*loc=*/std::nullopt)))
+      return success();
+    auto isPowerOf2 = [](int64_t d) { return llvm::isPowerOf2_64(d); };
+    if (llvm::all_of(srcShape, isPowerOf2) &&
+        !triton::tools::getBoolEnv(
+            "TRITON_DISABLE_RESHAPE_ENCODING_INFERENCE")) {
+      if (auto srcLayout = toLinearLayout(srcShape, srcEnc)) {
+        if (auto dstLayout = reshapeLayout(*srcLayout, dstShape)) {
+          if (auto blocked = toBlockedEncoding(*dstLayout, dstShape)) {
+            dstEnc = *blocked;
+            return success();
+          }
+        }
+      }
+    }
+    // Run the rules again to report why they failed.
+    return inferBlockedReshapeOpNoReorderEncoding(srcShape, srcEnc, dstShape,
+                                                  dstEnc, loc);
+  }
+
+  LogicalResult inferBlockedReshapeOpNoReorderEncoding(
+      ArrayRef<int64_t> srcShape, Attribute srcEnc, ArrayRef<int64_t> dstShape,
+      Attribute &dstEnc, std::optional<Location> loc) const {
     auto src = mlir::dyn_cast<BlockedEncodingAttr>(srcEnc);
     if (!src) {
       return emitOptionalError(
@@ -2905,6 +2935,55 @@ void AsyncCopyGlobalToLocalOp::getEffects(
                        mlir::triton::gpu::SharedMemory::get());
 }
 
+// SparseDotOp
+void SparseDotOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  if (isa<MemDescType>(getAMeta().getType()))
+    effects.emplace_back(MemoryEffects::Read::get(), getAMeta(),
+                         mlir::triton::gpu::SharedMemory::get());
+}
+
+LogicalResult SparseDotOp::verify() {
+  auto aShape = getA().getType().getShape();
+  auto bShape = getB().getType().getShape();
+  auto cShape = getC().getType().getShape();
+  auto metaTy = cast<TensorOrMemDesc>(getAMeta().getType());
+  auto metaShape = metaTy.getShape();
+  if (aShape.size() != 2 || bShape.size() != 2 || cShape.size() != 2 ||
+      metaShape.size() != 2)
+    return emitError("expected 2d operands");
+  if (aShape[1] * 2 != bShape[0])
+    return emitError("expected the compressed operand A to hold half of the "
+                     "K dimension of operand B");
+  if (cShape[0] != aShape[0] || cShape[1] != bShape[1])
+    return emitError("expected the accumulator to be of shape [M, N]");
+  if (bShape[0] % 16 != 0 || metaShape[0] != aShape[0] ||
+      metaShape[1] != bShape[0] / 16)
+    return emitError("expected the metadata to be of shape [M, K / 16]");
+  if (!metaTy.getElementType().isInteger(16))
+    return emitError("expected i16 metadata");
+  if (getA().getType().getElementType() != getB().getType().getElementType())
+    return emitError("element types of operands A and B must match");
+  return success();
+}
+
+LogicalResult NamedBarrierOp::verify() {
+  int numWarps = getNumWarps();
+  if (numWarps <= 0 || !llvm::isPowerOf2_32(numWarps))
+    return emitError("number of warps must be a power of two");
+  auto mod = (*this)->getParentOfType<ModuleOp>();
+  if (mod && mod->hasAttr(TritonGPUDialect::getNumWarpsAttrName())) {
+    int numCTAWarps = TritonGPUDialect::getNumWarps(mod);
+    if (numCTAWarps % numWarps != 0)
+      return emitError("number of warps must divide the warps of the CTA");
+    if (numWarps > 1 && numCTAWarps / numWarps > kMaxNumGroups)
+      return emitError("at most ")
+             << kMaxNumGroups << " groups of warps can be synchronized";
+  }
+  return success();
+}
+
 LogicalResult MemDescSubviewOp::verify() {
   auto srcTy = getSrc().getType();
   auto dstTy = getType();
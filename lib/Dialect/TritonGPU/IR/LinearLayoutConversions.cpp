@@ -411,23 +411,24 @@ LinearLayout hopperMmaToLinearLayout(ArrayRef<int64_t> shape,
   return combineCtaCgaWithShape(ctaLayout, mma.getCTALayout(), shape);
 }
 
+// The 4x4, 4x64 and 64x4 mfma instructions, and tensors smaller than one
+// instruction, aren't modeled yet.
+bool isMfmaLayoutModeled(ArrayRef<int64_t> shape, AMDMfmaEncodingAttr mfma) {
+  int rank = shape.size();
+  int mIndex = rank - 2, nIndex = rank - 1;
+  return ((mfma.getMDim() == 32 && mfma.getNDim() == 32) ||
+          (mfma.getMDim() == 16 && mfma.getNDim() == 16)) &&
+         (shape[mIndex] == 1 || shape[mIndex] >= mfma.getMDim()) &&
+         (shape[nIndex] == 1 || shape[nIndex] >= mfma.getNDim());
+}
+
 LinearLayout mfmaToLinearLayout(ArrayRef<int64_t> shape,
                                 AMDMfmaEncodingAttr mfma) {
   int rank = shape.size();
   assert(rank == mfma.getWarpsPerCTA().size());
+  assert(isMfmaLayoutModeled(shape, mfma) && "Unsupported mfma layout");
 
   bool hasBatchDim = rank == 3;
-  int mIndex = 0 + hasBatchDim;
-  int nIndex = 1 + hasBatchDim;
-  (void)mIndex, (void)nIndex;
-
-  assert(((shape[mIndex] == 1 || shape[mIndex] >= mfma.getMDim()) &&
-          (shape[nIndex] == 1 || shape[nIndex] >= mfma.getNDim())) &&
-         "Unsupported tensor shape for given mfma layout");
-
-  assert(((mfma.getMDim() == 32 && mfma.getNDim() == 32) ||
-          (mfma.getMDim() == 16 && mfma.getNDim() == 16)) &&
-         "Unsupported mfma type");
 
   MLIRContext *ctx = mfma.getContext();
   SmallVector<StringAttr> outDimNames = standardOutDimNames(ctx, rank);
@@ -486,6 +487,11 @@ LinearLayout mfmaToLinearLayout(ArrayRef<int64_t> shape,
       identityND(S("warp"), mfma.getWarpsPerCTA(), order, outDimNames);
   LinearLayout ctaLayout = tileLayout * warpLayout;
 
+  // The registers repeat the CTA tile along N first, then along M and the
+  // batch, whether or not the results are transposed: that's the order in
+  // which the dot lowering packs them.
+  ctaLayout = ctaLayout.transposeOuts(
+      llvm::to_vector(llvm::reverse(ArrayRef(outDimNames))));
   return combineCtaCgaWithShape(ctaLayout, mfma.getCTALayout(), shape);
 }
 
@@ -737,15 +743,15 @@ LinearLayout sharedToLinearLayoutLeadingOffset(ArrayRef<int64_t> shape,
   return combineCtaCgaWithShape(tileLayout, shared.getCTALayout(), shape);
 }
 
-} // anonymous namespace
-
 std::optional<LinearLayout>
-toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
-               std::optional<int32_t> elemBitWidth /*= std::nullopt*/) {
+buildLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
+                  std::optional<int32_t> elemBitWidth) {
   if (auto blocked = dyn_cast<BlockedEncodingAttr>(layout)) {
     return blockedToLinearLayout(shape, blocked);
   }
   if (auto mfma = dyn_cast<AMDMfmaEncodingAttr>(layout)) {
+    if (!isMfmaLayoutModeled(shape, mfma))
+      return std::nullopt;
     return mfmaToLinearLayout(shape, mfma);
   }
   if (auto wmma = dyn_cast<AMDWmmaEncodingAttr>(layout)) {
@@ -775,4 +781,144 @@ toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
   return std::nullopt;
 }
 
+std::optional<LinearLayout>
+getOrBuild(Attribute layout, LinearLayoutCache::Key key,
+           llvm::function_ref<std::optional<LinearLayout>()> build) {
+  auto *dialect = dyn_cast<TritonGPUDialect>(&layout.getDialect());
+  if (!dialect)
+    return build();
+  return dialect->getLinearLayoutCache().getOrBuild(std::move(key), build);
+}
+
+} // anonymous namespace
+
+std::optional<LinearLayout>
+toLinearLayout(ArrayRef<int64_t> shape, Attribute layout,
+               std::optional<int32_t> elemBitWidth /*= std::nullopt*/) {
+  LinearLayoutCache::Key key(std::vector<int64_t>(shape.begin(), shape.end()),
+                             layout.getAsOpaquePointer(), nullptr,
+                             elemBitWidth);
+  return getOrBuild(layout, std::move(key), [&] {
+    return buildLinearLayout(shape, layout, elemBitWidth);
+  });
+}
+
+std::optional<LinearLayout> toLinearLayoutConversion(
+    ArrayRef<int64_t> shape, Attribute srcLayout, Attribute dstLayout,
+    std::optional<int32_t> elemBitWidth /*= std::nullopt*/) {
+  LinearLayoutCache::Key key(std::vector<int64_t>(shape.begin(), shape.end()),
+                             srcLayout.getAsOpaquePointer(),
+                             dstLayout.getAsOpaquePointer(), elemBitWidth);
+  return getOrBuild(srcLayout, std::move(key),
+                    [&]() -> std::optional<LinearLayout> {
+                      auto src = toLinearLayout(shape, srcLayout, elemBitWidth);
+                      auto dst = toLinearLayout(shape, dstLayout, elemBitWidth);
+                      if (!src.has_value() || !dst.has_value())
+                        return std::nullopt;
+                      return src->invertAndCompose(*dst);
+                    });
+}
+
+std::optional<LinearLayout> reshapeLayout(const LinearLayout &layout,
+                                          ArrayRef<int64_t> dstShape) {
+  if (layout.getNumOutDims() == 0 ||
+      !llvm::all_of(dstShape, [](int64_t d) { return llvm::isPowerOf2_64(d); }))
+    return std::nullopt;
+  int64_t numElems = product(dstShape);
+  if (numElems != layout.getTotalOutDimSize())
+    return std::nullopt;
+
+  // LLs flatten their out dims with the first one being the most minor, while
+  // a reshape flattens the tensor with the last dim being the most minor.
+  MLIRContext *ctx = (*layout.getOutDimNames().begin()).getContext();
+  SmallVector<StringAttr> dstDims = standardOutDimNames(ctx, dstShape.size());
+  SmallVector<std::pair<StringAttr, int32_t>> minorToMajor;
+  for (int i = dstShape.size() - 1; i >= 0; i--)
+    minorToMajor.push_back({dstDims[i], dstShape[i]});
+  return layout
+      .transposeOuts(llvm::to_vector(llvm::reverse(layout.getOutDimNames())))
+      .reshapeOuts(minorToMajor)
+      .transposeOuts(dstDims);
+}
+
+std::optional<BlockedEncodingAttr>
+toBlockedEncoding(const LinearLayout &layout, ArrayRef<int64_t> shape) {
+  int rank = shape.size();
+  if (rank == 0 || layout.getNumInDims() == 0)
+    return std::nullopt;
+  MLIRContext *ctx = (*layout.getInDimNames().begin()).getContext();
+  StringAttr kRegister = S("register");
+  StringAttr kLane = S("lane");
+  StringAttr kWarp = S("warp");
+  StringAttr kBlock = S("block");
+  // Blocked encodings with several CTAs are not handled.
+  if (!layout.hasInDim(kRegister) || !layout.hasInDim(kLane) ||
+      !layout.hasInDim(kWarp) || !layout.hasInDim(kBlock) ||
+      layout.getInDimSize(kBlock) != 1 ||
+      llvm::to_vector(layout.getOutDimNames()) !=
+          standardOutDimNames(ctx, rank))
+    return std::nullopt;
+
+  // Reads the sizes of one level of the blocked encoding from the bases of
+  // its in dim, which go through the dims in order, each over its
+  // consecutive multiples of the sizes of the previous levels.  The bases of
+  // the dims where the encoding is larger than the shape are zero and are
+  // counted for the preceding dim.  Returns the number of bases that were
+  // read; the remaining ones must be register repetitions.
+  SmallVector<unsigned> order;
+  SmallVector<int64_t> covered(rank, 1);
+  auto readLevel = [&](StringAttr inDim, SmallVector<unsigned> &sizes) -> int {
+    sizes.assign(rank, 1);
+    SmallVector<bool> done(rank, false);
+    int cur = -1;
+    int numBases = layout.getInDimSizeLog2(inDim);
+    int pos = 0;
+    for (; pos < numBases; pos++) {
+      ArrayRef<int32_t> basis = layout.getBasis(inDim, pos);
+      auto isNonZero = [](int32_t b) { return b != 0; };
+      int numNonZero = llvm::count_if(basis, isNonZero);
+      if (numNonZero == 0) {
+        int dim = cur >= 0 ? cur : order.empty() ? rank - 1 : order.front();
+        sizes[dim] *= 2;
+        cur = dim;
+        continue;
+      }
+      int dim = llvm::find_if(basis, isNonZero) - basis.begin();
+      if (numNonZero != 1 || basis[dim] != covered[dim] * sizes[dim] ||
+          (dim != cur && done[dim]))
+        break;
+      if (dim != cur && cur >= 0)
+        done[cur] = true;
+      cur = dim;
+      sizes[dim] *= 2;
+      if (!llvm::is_contained(order, dim))
+        order.push_back(dim);
+    }
+    for (int d = 0; d < rank; d++)
+      covered[d] *= sizes[d];
+    return pos;
+  };
+
+  SmallVector<unsigned> sizePerThread, threadsPerWarp, warpsPerCTA;
+  readLevel(kRegister, sizePerThread);
+  if (readLevel(kLane, threadsPerWarp) != layout.getInDimSizeLog2(kLane) ||
+      readLevel(kWarp, warpsPerCTA) != layout.getInDimSizeLog2(kWarp))
+    return std::nullopt;
+  for (int d = rank - 1; d >= 0; d--) {
+    if (!llvm::is_contained(order, d))
+      order.push_back(d);
+  }
+
+  auto ctaLayout = CTALayoutAttr::get(
+      ctx, /*CTAsPerCGA=*/SmallVector<unsigned>(rank, 1),
+      /*CTASplitNum=*/SmallVector<unsigned>(rank, 1),
+      /*CTAOrder=*/llvm::to_vector(llvm::seq<unsigned>(rank)));
+  auto blocked = BlockedEncodingAttr::get(
+      ctx, sizePerThread, threadsPerWarp, warpsPerCTA, order, ctaLayout);
+  // The zero bases and the register repetitions were only guessed above.
+  if (toLinearLayout(shape, blocked) != layout)
+    return std::nullopt;
+  return blocked;
+}
+
 } // namespace mlir::triton::gpu
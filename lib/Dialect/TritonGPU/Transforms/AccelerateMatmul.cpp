@@ -37,7 +37,8 @@ static int getMMAVersionSafe(int computeCapability, DotOp op) {
   return 0;
 }
 
-SmallVector<unsigned> warpsPerTileV2(DotOp dotOp, const ArrayRef<int64_t> shape,
+SmallVector<unsigned> warpsPerTileV2(Operation *dotOp,
+                                     const ArrayRef<int64_t> shape,
                                      int numWarps) {
   auto rank = shape.size();
   // Early exit for batched matmul
@@ -335,6 +336,79 @@ public:
     return success();
   }
 };
+
+// Converts 2:4 sparse dots to mma.sp, which is only available with the MMAv2
+// layouts. The metadata is read by the lowering from shared memory.
+class SparseBlockedToMMA : public mlir::OpRewritePattern<SparseDotOp> {
+  int computeCapability;
+
+public:
+  SparseBlockedToMMA(mlir::MLIRContext *context, int computeCapability)
+      : OpRewritePattern<SparseDotOp>(context),
+        computeCapability(computeCapability) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(SparseDotOp dotOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    if (computeCapability < 80)
+      return failure();
+    RankedTensorType oldRetType = dotOp.getType();
+    if (!oldRetType.getEncoding() ||
+        mlir::isa<NvidiaMmaEncodingAttr>(oldRetType.getEncoding()))
+      return failure();
+    auto oldAType = dotOp.getA().getType();
+    auto oldBType = dotOp.getB().getType();
+    Type eltType = oldAType.getElementType();
+    if (!(eltType.isF16() || eltType.isBF16()) ||
+        !oldRetType.getElementType().isF32())
+      return failure();
+
+    MLIRContext *ctx = dotOp.getContext();
+    auto retShapePerCTA = getShapePerCTA(oldRetType);
+    auto mod = dotOp->getParentOfType<mlir::ModuleOp>();
+    int numWarps = TritonGPUDialect::getNumWarps(mod);
+    auto CTALayout = getCTALayout(oldRetType.getEncoding());
+    auto instrShape =
+        mmaVersionToInstrShape(2, retShapePerCTA, oldAType, numWarps);
+    auto warpsPerTile = warpsPerTileV2(dotOp, retShapePerCTA, numWarps);
+    auto mmaEnc = NvidiaMmaEncodingAttr::get(ctx, 2, 0, warpsPerTile,
+                                             CTALayout, instrShape);
+    auto newRetType = RankedTensorType::get(
+        oldRetType.getShape(), oldRetType.getElementType(), mmaEnc);
+
+    auto oldAcc = dotOp.getC();
+    auto newAcc =
+        rewriter.create<ConvertLayoutOp>(oldAcc.getLoc(), newRetType, oldAcc);
+    auto newAType = RankedTensorType::get(
+        oldAType.getShape(), eltType,
+        DotOperandEncodingAttr::get(ctx, 0, mmaEnc, eltType));
+    Value a = rewriter.create<ConvertLayoutOp>(dotOp.getA().getLoc(),
+                                               newAType, dotOp.getA());
+    auto newBType = RankedTensorType::get(
+        oldBType.getShape(), eltType,
+        DotOperandEncodingAttr::get(ctx, 1, mmaEnc, eltType));
+    Value b = rewriter.create<ConvertLayoutOp>(dotOp.getB().getLoc(),
+                                               newBType, dotOp.getB());
+
+    // Each thread reads the metadata of its rows for every instruction,
+    // which is scattered in any distributed layout.
+    Value meta = dotOp.getAMeta();
+    if (auto metaType = dyn_cast<RankedTensorType>(meta.getType())) {
+      auto metaLayout =
+          SharedEncodingAttr::get(ctx, 1, 1, 1, {1, 0}, CTALayout);
+      auto newMetaType = MemDescType::get(
+          metaType.getShape(), metaType.getElementType(), metaLayout,
+          SharedMemorySpaceAttr::get(ctx));
+      meta = rewriter.create<LocalAllocOp>(meta.getLoc(), newMetaType, meta);
+    }
+
+    auto newDot = rewriter.create<SparseDotOp>(dotOp.getLoc(), newRetType, a,
+                                               b, newAcc, meta);
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(dotOp, oldRetType,
+                                                 newDot.getResult());
+    return success();
+  }
+};
 } // namespace
 
 static Value promoteOperand(OpBuilder &builder, Location loc, Value operand,
@@ -378,6 +452,101 @@ static void decomposeMixedModeDotOp(ModuleOp mod, int computeCapability) {
   });
 }
 
+// Sums of fp16 and bf16 2D tensors, or of their extensions to fp32, over at
+// least `threshold` elements along the axis are taken on tensor cores:
+//   reduce(x, axis=1) => max(dot(x, ones[K, 16]), axis=1)
+//   reduce(x, axis=0) => max(dot(ones[16, K], x), axis=0)
+// Every column, or row, of the dot holds the sums, which the reduction over
+// the 16 of them picks. The dots are left to BlockedToMMA; the sums whose dots
+// wouldn't use tensor cores are kept.
+static void rewriteSumsToDots(ModuleOp mod, int computeCapability,
+                              int threshold) {
+  if (threshold <= 0 || TritonGPUDialect::getNumCTAs(mod) != 1)
+    return;
+  int numWarps = TritonGPUDialect::getNumWarps(mod);
+  int threadsPerWarp = TritonGPUDialect::getThreadsPerWarp(mod);
+  constexpr int64_t kOnesWidth = 16;
+  SmallVector<ReduceOp> reduceOps;
+  mod.walk([&](ReduceOp reduceOp) { reduceOps.push_back(reduceOp); });
+  for (ReduceOp reduceOp : reduceOps) {
+    if (reduceOp.getNumOperands() != 1)
+      continue;
+    Block &combine = reduceOp.getCombineOp().front();
+    auto addOp = dyn_cast<arith::AddFOp>(combine.front());
+    if (combine.getOperations().size() != 2 || !addOp ||
+        !isa<BlockArgument>(addOp.getLhs()) ||
+        !isa<BlockArgument>(addOp.getRhs()))
+      continue;
+    Value x = reduceOp.getSrcs()[0];
+    auto srcTy = cast<RankedTensorType>(x.getType());
+    Type resultElemTy = srcTy.getElementType();
+    if (auto extOp = x.getDefiningOp<arith::ExtFOp>())
+      x = extOp.getIn();
+    auto xTy = cast<RankedTensorType>(x.getType());
+    Type elemTy = xTy.getElementType();
+    int axis = reduceOp.getAxis();
+    if (xTy.getRank() != 2 || !(elemTy.isF16() || elemTy.isBF16()) ||
+        xTy.getShape()[axis] < threshold)
+      continue;
+
+    MLIRContext *ctx = mod.getContext();
+    OpBuilder builder(reduceOp);
+    Location loc = reduceOp.getLoc();
+    Type f32Ty = builder.getF32Type();
+    SmallVector<int64_t> dShape(xTy.getShape());
+    dShape[axis] = kOnesWidth;
+    auto dEnc = getDefaultBlockedEncoding(ctx, dShape, numWarps,
+                                          threadsPerWarp, /*numCTAs=*/1);
+    auto dTy = RankedTensorType::get(dShape, f32Ty, dEnc);
+    int xOpIdx = axis == 1 ? 0 : 1;
+    SmallVector<int64_t> onesShape = {xTy.getShape()[axis], kOnesWidth};
+    if (axis == 0)
+      std::swap(onesShape[0], onesShape[1]);
+    auto onesTy = RankedTensorType::get(
+        onesShape, elemTy,
+        DotOperandEncodingAttr::get(ctx, 1 - xOpIdx, dEnc, elemTy));
+    Value ones = builder.create<arith::ConstantOp>(
+        loc,
+        DenseElementsAttr::get(onesTy, builder.getFloatAttr(elemTy, 1.0)));
+    Value operand = builder.create<ConvertLayoutOp>(
+        loc,
+        RankedTensorType::get(
+            xTy.getShape(), elemTy,
+            DotOperandEncodingAttr::get(ctx, xOpIdx, dEnc, elemTy)),
+        x);
+    Value zero = builder.create<arith::ConstantOp>(
+        loc, DenseElementsAttr::get(dTy, builder.getF32FloatAttr(0)));
+    auto dotOp = builder.create<DotOp>(
+        loc, dTy, axis == 1 ? operand : ones, axis == 1 ? ones : operand,
+        zero, InputPrecision::IEEE, 0);
+    if (getMMAVersionSafe(computeCapability, dotOp) == 0) {
+      for (Operation *op : {dotOp.getOperation(), zero.getDefiningOp(),
+                            operand.getDefiningOp(), ones.getDefiningOp()})
+        op->erase();
+      continue;
+    }
+
+    auto pick = builder.create<ReduceOp>(loc, ValueRange{dotOp}, axis);
+    Block *block = builder.createBlock(&pick.getCombineOp(), {},
+                                       {f32Ty, f32Ty}, {loc, loc});
+    builder.create<ReduceReturnOp>(
+        loc, builder.create<arith::MaximumFOp>(loc, block->getArgument(0),
+                                               block->getArgument(1))
+                 .getResult());
+    builder.setInsertionPointAfter(pick);
+    Value sum = pick.getResult()[0];
+    if (resultElemTy != f32Ty) {
+      auto sumTy = cast<RankedTensorType>(sum.getType());
+      sum = builder.create<arith::TruncFOp>(loc, sumTy.clone(resultElemTy),
+                                            sum);
+    }
+    Value result = reduceOp.getResult()[0];
+    result.replaceAllUsesWith(
+        builder.create<ConvertLayoutOp>(loc, result.getType(), sum));
+    reduceOp.erase();
+  }
+}
+
 #define GEN_PASS_DEF_TRITONGPUACCELERATEMATMUL
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
@@ -393,9 +562,13 @@ public:
     ModuleOp m = getOperation();
 
     auto computeCapability = getNVIDIAComputeCapability(m);
+    rewriteSumsToDots(m, computeCapability, reduceThreshold);
 
     mlir::RewritePatternSet patterns(context);
-    patterns.add<BlockedToMMA>(context, computeCapability);
+    patterns.add<BlockedToMMA, SparseBlockedToMMA>(context,
+                                                   computeCapability);
+    // Skinny dots would waste most of an MMA tile on padding
+    populateDotToGemvPatterns(patterns, /*benefit=*/2);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
     }
@@ -0,0 +1,105 @@
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUANNOTATEPERFORMANCE
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+constexpr char kPerfAttrName[] = "triton_gpu.perf";
+
+// Returns how a layout conversion is lowered.
+static StringRef getConversionKind(ConvertLayoutOp cvt) {
+  RankedTensorType srcTy = cvt.getSrc().getType();
+  RankedTensorType dstTy = cvt.getType();
+  if (isMmaToDotShortcut(srcTy, dstTy))
+    return "free";
+  if (getRegisterPermutationLayout(srcTy, dstTy))
+    return "registers";
+  if (getWarpShuffleLayout(srcTy, dstTy))
+    return "warp shuffle";
+  return cvtNeedsSharedMemory(srcTy, dstTy) ? "shared memory" : "registers";
+}
+
+// Returns the shared memory bytes `op` allocates, either for its results or as
+// scratch space.
+static size_t getSharedMemoryBytes(Operation *op, Allocation *allocation) {
+  size_t bytes = 0;
+  Allocation::BufferId scratch = allocation->getBufferId(op);
+  if (scratch != Allocation::InvalidBufferId &&
+      !allocation->isVirtualBuffer(scratch))
+    bytes += allocation->getAllocatedSize(scratch);
+  for (Value result : op->getResults()) {
+    Allocation::BufferId buffer = allocation->getBufferId(result);
+    if (buffer != Allocation::InvalidBufferId)
+      bytes += allocation->getAllocatedSize(buffer);
+  }
+  return bytes;
+}
+
+class TritonGPUAnnotatePerformancePass
+    : public impl::TritonGPUAnnotatePerformanceBase<
+          TritonGPUAnnotatePerformancePass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    ModuleAllocation allocation(mod);
+    Builder b(&getContext());
+    mod.walk([&](FunctionOpInterface funcOp) {
+      RegisterPressureAnalysis pressure(funcOp);
+      Allocation *funcAllocation = allocation.getFuncData(funcOp);
+      funcOp.walk([&](Operation *op) {
+        if (op == funcOp.getOperation())
+          return;
+        NamedAttrList hints;
+        if (unsigned regs = pressure.getRegisters(op))
+          hints.append("live_registers", b.getI32IntegerAttr(regs));
+        if (funcAllocation) {
+          if (size_t bytes = getSharedMemoryBytes(op, funcAllocation))
+            hints.append("shared_bytes", b.getI64IntegerAttr(bytes));
+        }
+        if (auto cvt = dyn_cast<ConvertLayoutOp>(op))
+          hints.append("conversion", b.getStringAttr(getConversionKind(cvt)));
+
+        RankedTensorType regTy;
+        MemDescType memTy;
+        if (auto alloc = dyn_cast<LocalAllocOp>(op)) {
+          if (alloc.getSrc()) {
+            regTy = alloc.getSrc().getType();
+            memTy = alloc.getType();
+          }
+        } else if (auto store = dyn_cast<LocalStoreOp>(op)) {
+          regTy = store.getSrc().getType();
+          memTy = store.getDst().getType();
+        } else if (auto load = dyn_cast<LocalLoadOp>(op)) {
+          regTy = load.getType();
+          memTy = load.getSrc().getType();
+        }
+        if (regTy) {
+          if (std::optional<SharedMemoryAccessStats> stats =
+                  getSharedMemoryAccessStats(regTy, memTy)) {
+            hints.append("vector_bits", b.getI32IntegerAttr(stats->vectorBits));
+            hints.append("conflict_ways",
+                         b.getI32IntegerAttr(stats->maxConflictWays));
+          }
+        }
+
+        if (!hints.empty())
+          op->setAttr(kPerfAttrName, hints.getDictionary(&getContext()));
+      });
+    });
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
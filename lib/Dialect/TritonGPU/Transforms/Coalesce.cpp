@@ -37,8 +37,13 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
       llvm::dbgs() << "\n";
     });
 
+    // Put the threads along the most contiguous dimension of each access, even
+    // if it is not the innermost one of the consumers (column-major inputs)
+    // or if it is the only one that is contiguous (gathers along rows). The
+    // consumers are reconciled by RemoveLayoutConversions.
     auto contiguity = axisInfoAnalysis.getAxisInfo(ptr)->getContiguity();
-    SmallVector<unsigned> order = argSort(contiguity);
+    SmallVector<unsigned> order = getOrderFromContiguity(
+        contiguity, triton::gpu::getOrder(refTensorType.getEncoding()));
     LDBG("order=[" << triton::join(order, ", ") << "]");
 
     auto matchesShape = [&refTensorType](const Value &val) {
@@ -55,8 +60,10 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
         Value val = getMemAccessPtr(use);
         if (!val || !matchesShape(val) || memAccessesSameOrder.contains(use))
           continue;
-        auto currOrder =
-            argSort(axisInfoAnalysis.getAxisInfo(val)->getContiguity());
+        auto currOrder = getOrderFromContiguity(
+            axisInfoAnalysis.getAxisInfo(val)->getContiguity(),
+            triton::gpu::getOrder(
+                cast<RankedTensorType>(val.getType()).getEncoding()));
         if (order == currOrder) {
           LDBG("multi-root-slice: insert to memAccessesSameOrder " << *use);
           memAccessesSameOrder.insert(use);
@@ -111,7 +118,8 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
                                  tensorType.getElementType(), encoding);
   }
 
-  void coalesceOp(Attribute encoding, Operation *op) {
+  void coalesceOp(ModuleAxisInfoAnalysis &axisInfoAnalysis, Attribute encoding,
+                  Operation *op) {
     OpBuilder builder(op);
     // Convert operands
     // For load/store with tensor pointers, we don't have to change the
@@ -123,8 +131,10 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
       if (tensorType &&
           !isa<triton::gpu::SharedEncodingAttr>(tensorType.getEncoding())) {
         Type newType = getNewType(tensorType, encoding);
-        newArgs.push_back(builder.create<triton::gpu::ConvertLayoutOp>(
-            op->getLoc(), newType, operand));
+        Value newArg = builder.create<triton::gpu::ConvertLayoutOp>(
+            op->getLoc(), newType, operand);
+        axisInfoAnalysis.copyAxisInfo(operand, newArg);
+        newArgs.push_back(newArg);
       } else {
         newArgs.push_back(operand);
       }
@@ -145,19 +155,22 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
     // Cast the results back to the original layout
     for (size_t i = 0; i < op->getNumResults(); i++) {
       Value newResult = newOp->getResult(i);
+      axisInfoAnalysis.copyAxisInfo(op->getResult(i), newResult);
       if (newTypes[i] != op->getResultTypes()[i]) {
         newResult = builder.create<triton::gpu::ConvertLayoutOp>(
             op->getLoc(), op->getResult(i).getType(), newResult);
+        axisInfoAnalysis.copyAxisInfo(op->getResult(i), newResult);
       }
       op->getResult(i).replaceAllUsesWith(newResult);
     }
+    axisInfoAnalysis.eraseAxisInfo(op);
     op->erase();
   }
 
   void runOnOperation() override {
     // Run axis info analysis
     ModuleOp moduleOp = getOperation();
-    ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+    auto &axisInfoAnalysis = getAnalysis<ModuleAxisInfoAnalysis>();
 
     // For each i/o operation, we determine what layout
     // the pointers should have for best memory coalescing
@@ -188,8 +201,10 @@ struct CoalescePass : public impl::TritonGPUCoalesceBase<CoalescePass> {
     // 4. Convert the output of this new memory op back to L1
     // 5. Replace all the uses of the original memory op by the new one
     for (auto &kv : layoutMap) {
-      coalesceOp(kv.second, kv.first);
+      coalesceOp(axisInfoAnalysis, kv.second, kv.first);
     }
+    // The rewrites above kept the axis info up to date
+    markAnalysesPreserved<ModuleAxisInfoAnalysis>();
   }
 };
 
@@ -0,0 +1,276 @@
+#include <cmath>
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUDECOMPOSESCALEDDOT
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// Elements of a block sharing a scale
+constexpr int kScaleBlockSize = 32;
+
+// dot_scaled(lhs, lhs_scale, rhs, rhs_scale, c) ->
+//   dot(upcast(lhs) * 2^(lhs_scale - 127), upcast(rhs) * 2^(rhs_scale - 127),
+//       c)
+// with bf16 operands. The operands are decoded with integer ops in the
+// layout they're loaded in, and the scale of each block of 32 elements is
+// broadcast along a dimension of its own, so the dot only sees bf16 values
+// and the rest of the pipeline handles them like any upcast operand.
+class DecomposeScaledDot : public OpRewritePattern<DotScaledOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotScaledOp dotOp,
+                                PatternRewriter &rewriter) const override {
+    Location loc = dotOp.getLoc();
+    RankedTensorType dTy = dotOp.getType();
+    Value a = upcast(rewriter, loc, dotOp.getLhs(), dotOp.getLhsType(),
+                     dotOp.getLhsScale(), /*kAxis=*/1);
+    Value b = upcast(rewriter, loc, dotOp.getRhs(), dotOp.getRhsType(),
+                     dotOp.getRhsScale(), /*kAxis=*/0);
+    if (!a || !b)
+      return dotOp.emitError("can't find a layout to decode the operands");
+
+    auto toDotOperand = [&](Value operand, unsigned opIdx) -> Value {
+      auto ty = cast<RankedTensorType>(operand.getType());
+      Attribute encoding = DotOperandEncodingAttr::get(
+          getContext(), opIdx, dTy.getEncoding(), ty.getElementType());
+      return rewriter.create<ConvertLayoutOp>(
+          loc,
+          RankedTensorType::get(ty.getShape(), ty.getElementType(), encoding),
+          operand);
+    };
+    rewriter.replaceOpWithNewOp<DotOp>(
+        dotOp, dTy, toDotOperand(a, 0), toDotOperand(b, 1), dotOp.getC(),
+        InputPrecision::IEEE, /*maxNumImpreciseAcc=*/0);
+    return success();
+  }
+
+private:
+  static Value splatInt(PatternRewriter &rewriter, Location loc, Type ty,
+                        int64_t value) {
+    auto tensorTy = cast<RankedTensorType>(ty);
+    return rewriter.create<arith::ConstantOp>(
+        loc, SplatElementsAttr::get(
+                 tensorTy,
+                 rewriter.getIntegerAttr(tensorTy.getElementType(), value)));
+  }
+
+  static Value splatFloat(PatternRewriter &rewriter, Location loc, Type ty,
+                          double value) {
+    auto tensorTy = cast<RankedTensorType>(ty);
+    return rewriter.create<arith::ConstantOp>(
+        loc, SplatElementsAttr::get(
+                 tensorTy,
+                 rewriter.getFloatAttr(tensorTy.getElementType(), value)));
+  }
+
+  // Reshapes value without moving its elements between threads, converting it
+  // to the default blocked layout first if its layout can't be reshaped.
+  // Returns null if neither can.
+  static Value reshape(PatternRewriter &rewriter, Location loc, Value value,
+                       ArrayRef<int64_t> shape) {
+    auto ty = cast<RankedTensorType>(value.getType());
+    auto interface = cast<DialectInferLayoutInterface>(
+        &ty.getEncoding().getDialect());
+    Attribute encoding;
+    if (failed(interface->inferReshapeOpNoReorderEncoding(
+            ty.getShape(), ty.getEncoding(), shape, encoding, std::nullopt))) {
+      auto mod = value.getParentRegion()->getParentOfType<ModuleOp>();
+      auto blocked = getDefaultBlockedEncoding(
+          rewriter.getContext(), ty.getShape(),
+          TritonGPUDialect::getNumWarps(mod),
+          TritonGPUDialect::getThreadsPerWarp(mod),
+          TritonGPUDialect::getNumCTAs(mod));
+      if (failed(interface->inferReshapeOpNoReorderEncoding(
+              ty.getShape(), blocked, shape, encoding, std::nullopt)))
+        return Value();
+      value = rewriter.create<ConvertLayoutOp>(
+          loc,
+          RankedTensorType::get(ty.getShape(), ty.getElementType(), blocked),
+          value);
+    }
+    return rewriter.create<ReshapeOp>(
+        loc, RankedTensorType::get(shape, ty.getElementType(), encoding),
+        value, /*allow_reorder=*/false);
+  }
+
+  // Decodes the minifloats held in the low bits of the i16 tensor x into
+  // bf16 tensors.
+  static Value decode(PatternRewriter &rewriter, Location loc, Value x,
+                      ScaleDotElemType type) {
+    int expBits, manBits, bias;
+    switch (type) {
+    case ScaleDotElemType::E4M3:
+      expBits = 4, manBits = 3, bias = 7;
+      break;
+    case ScaleDotElemType::E5M2:
+      expBits = 5, manBits = 2, bias = 15;
+      break;
+    case ScaleDotElemType::E2M1:
+      expBits = 2, manBits = 1, bias = 1;
+      break;
+    case ScaleDotElemType::BF16:
+      llvm_unreachable("bf16 operands aren't decoded");
+    }
+    auto i16Ty = cast<RankedTensorType>(x.getType());
+    auto f32Ty = i16Ty.clone(rewriter.getF32Type());
+    auto bf16Ty = i16Ty.clone(rewriter.getBF16Type());
+    auto c = [&](int64_t value) {
+      return splatInt(rewriter, loc, i16Ty, value);
+    };
+    auto shr = [&](Value v, int n) -> Value {
+      return rewriter.create<arith::ShRUIOp>(loc, v, c(n));
+    };
+    auto shl = [&](Value v, int n) -> Value {
+      return rewriter.create<arith::ShLIOp>(loc, v, c(n));
+    };
+    auto mask = [&](Value v, int64_t bits) -> Value {
+      return rewriter.create<arith::AndIOp>(loc, v, c(bits));
+    };
+    auto bitOr = [&](Value lhs, Value rhs) -> Value {
+      return rewriter.create<arith::OrIOp>(loc, lhs, rhs);
+    };
+    auto eq = [&](Value v, int64_t value) -> Value {
+      return rewriter.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq, v,
+                                            c(value));
+    };
+    auto select = [&](Value cond, Value lhs, Value rhs) -> Value {
+      return rewriter.create<arith::SelectOp>(loc, cond, lhs, rhs);
+    };
+
+    Value sign = shl(mask(shr(x, expBits + manBits), 1), 15);
+    Value exp = mask(shr(x, manBits), (1 << expBits) - 1);
+    Value man = mask(x, (1 << manBits) - 1);
+    // Normal numbers only have their exponent rebiased
+    Value bits = bitOr(
+        sign,
+        bitOr(shl(rewriter.create<arith::AddIOp>(loc, exp, c(127 - bias)), 7),
+              shl(man, 7 - manBits)));
+    // e5m2 has infinities and NaNs, e4m3 only NaNs, and e2m1 neither
+    if (type == ScaleDotElemType::E5M2)
+      bits = select(eq(exp, (1 << expBits) - 1),
+                    bitOr(sign, bitOr(c(0x7f80), shl(man, 7 - manBits))),
+                    bits);
+    else if (type == ScaleDotElemType::E4M3)
+      bits = select(eq(mask(x, 0x7f), 0x7f), c(0x7fc0), bits);
+    Value normal = rewriter.create<BitcastOp>(loc, bf16Ty, bits);
+    // Subnormal numbers are man * 2^(1 - bias - manBits), which is exact in
+    // f32 and bf16
+    Value subnormal = rewriter.create<arith::MulFOp>(
+        loc, rewriter.create<arith::UIToFPOp>(loc, f32Ty, man),
+        splatFloat(rewriter, loc, f32Ty, std::ldexp(1.0, 1 - bias - manBits)));
+    subnormal = select(eq(sign, 0), subnormal,
+                       rewriter.create<arith::NegFOp>(loc, subnormal));
+    subnormal = rewriter.create<arith::TruncFOp>(loc, bf16Ty, subnormal);
+    return select(eq(exp, 0), subnormal, normal);
+  }
+
+  // Returns the scaled bf16 values of an operand, whose K dimension is kAxis,
+  // or null if they can't be laid out.
+  static Value upcast(PatternRewriter &rewriter, Location loc, Value operand,
+                      ScaleDotElemType type, Value scale, unsigned kAxis) {
+    if (type == ScaleDotElemType::BF16)
+      return operand;
+    auto ty = cast<RankedTensorType>(operand.getType());
+    auto i8Ty = ty.clone(rewriter.getI8Type());
+    auto i16Ty = ty.clone(rewriter.getI16Type());
+    if (!ty.getElementType().isInteger(8))
+      operand = rewriter.create<BitcastOp>(loc, i8Ty, operand);
+    Value x = rewriter.create<arith::ExtUIOp>(loc, i16Ty, operand);
+
+    Value value;
+    SmallVector<int64_t> shape(ty.getShape());
+    if (type == ScaleDotElemType::E2M1) {
+      // Two elements per byte along K, the lower nibble first
+      Value lo = decode(rewriter, loc,
+                        rewriter.create<arith::AndIOp>(
+                            loc, x, splatInt(rewriter, loc, i16Ty, 0xf)),
+                        type);
+      Value hi = decode(rewriter, loc,
+                        rewriter.create<arith::ShRUIOp>(
+                            loc, x, splatInt(rewriter, loc, i16Ty, 4)),
+                        type);
+      Value pairs = rewriter.create<JoinOp>(loc, lo, hi);
+      if (kAxis == 0)
+        pairs = rewriter.create<TransOp>(loc, pairs,
+                                         ArrayRef<int32_t>({0, 2, 1}));
+      shape[kAxis] *= 2;
+      value = reshape(rewriter, loc, pairs, shape);
+      if (!value)
+        return Value();
+    } else {
+      value = decode(rewriter, loc, x, type);
+    }
+
+    // The blocks of the operand get a dimension of their own after K, along
+    // which their scale is broadcast: [M, K / 32, 32] or [K / 32, 32, N]
+    SmallVector<int64_t> blocksShape(shape);
+    blocksShape[kAxis] /= kScaleBlockSize;
+    blocksShape.insert(blocksShape.begin() + kAxis + 1, kScaleBlockSize);
+    Value blocks = reshape(rewriter, loc, value, blocksShape);
+    if (!blocks)
+      return Value();
+    auto blocksTy = cast<RankedTensorType>(blocks.getType());
+
+    // The scales are e8m0, i.e. the exponent of a bf16, with 0xff for NaN
+    if (kAxis == 0)
+      scale = rewriter.create<TransOp>(loc, scale, ArrayRef<int32_t>({1, 0}));
+    auto scaleTy = cast<RankedTensorType>(scale.getType());
+    auto scaleI16Ty = scaleTy.clone(rewriter.getI16Type());
+    Value scaleBits = rewriter.create<arith::ExtUIOp>(loc, scaleI16Ty, scale);
+    Value isNaN = rewriter.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, scaleBits,
+        splatInt(rewriter, loc, scaleI16Ty, 0xff));
+    scaleBits = rewriter.create<arith::SelectOp>(
+        loc, isNaN, splatInt(rewriter, loc, scaleI16Ty, 0x7fc0),
+        rewriter.create<arith::ShLIOp>(loc, scaleBits,
+                                       splatInt(rewriter, loc, scaleI16Ty, 7)));
+    Value factor = rewriter.create<BitcastOp>(
+        loc, scaleTy.clone(rewriter.getBF16Type()), scaleBits);
+    auto sliceEncoding = SliceEncodingAttr::get(
+        rewriter.getContext(), kAxis + 1, blocksTy.getEncoding());
+    factor = rewriter.create<ConvertLayoutOp>(
+        loc,
+        RankedTensorType::get(scaleTy.getShape(), rewriter.getBF16Type(),
+                              sliceEncoding),
+        factor);
+    factor = rewriter.create<ExpandDimsOp>(loc, factor, kAxis + 1);
+    factor = rewriter.create<BroadcastOp>(loc, blocksTy, factor);
+    Value scaled = rewriter.create<arith::MulFOp>(loc, blocks, factor);
+    return reshape(rewriter, loc, scaled, shape);
+  }
+};
+
+} // anonymous namespace
+
+struct DecomposeScaledDotPass
+    : public impl::TritonGPUDecomposeScaledDotBase<DecomposeScaledDotPass> {
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    ModuleOp m = getOperation();
+
+    RewritePatternSet decomposePatterns(context);
+    decomposePatterns.add<DecomposeScaledDot>(context);
+    if (applyPatternsAndFoldGreedily(m, std::move(decomposePatterns))
+            .failed()) {
+      signalPassFailure();
+    }
+    // The scaled dots that are left couldn't be decoded
+    m.walk([&](DotScaledOp) { signalPassFailure(); });
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
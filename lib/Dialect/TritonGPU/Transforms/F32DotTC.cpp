@@ -69,6 +69,75 @@ public:
   }
 };
 
+// Split the f32 inputs in bf16 terms, which each hold the next 8 bits of the
+// mantissa, e.g. with 3 terms
+// a = aHigh + aMid + aLow, b = bHigh + bMid + bLow
+// and sum the bf16 dot products of the terms whose order, i.e. the sum of the
+// indices, is low enough:
+//  bf16x3: 2 terms, order <= 1, i.e. ~16 bits of mantissa
+//  bf16x6: 3 terms, order <= 2, which drops the products of ~2^-24 and less
+//  bf16x9: 3 terms, all the products, i.e. ~24 bits of mantissa
+// The products are accumulated from the smallest to the largest.
+class BF16xN : public OpRewritePattern<DotOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotOp dotOp,
+                                PatternRewriter &rewriter) const override {
+    auto isF32 = [](Value operand) {
+      return cast<RankedTensorType>(operand.getType()).getElementType().isF32();
+    };
+    if (!isF32(dotOp.getA()) || !isF32(dotOp.getB()))
+      return failure();
+
+    int numTerms, maxOrder;
+    switch (dotOp.getInputPrecision()) {
+    case InputPrecision::BF16x3:
+      numTerms = 2;
+      maxOrder = 1;
+      break;
+    case InputPrecision::BF16x6:
+      numTerms = 3;
+      maxOrder = 2;
+      break;
+    case InputPrecision::BF16x9:
+      numTerms = 3;
+      maxOrder = 4;
+      break;
+    default:
+      return failure();
+    }
+
+    Location loc = dotOp.getLoc();
+    auto split = [&](Value value) {
+      auto f32Ty = cast<RankedTensorType>(value.getType());
+      auto bf16Ty = f32Ty.clone(rewriter.getBF16Type());
+      SmallVector<Value> terms;
+      for (int i = 0; i < numTerms; ++i) {
+        Value term = rewriter.create<arith::TruncFOp>(loc, bf16Ty, value);
+        terms.push_back(term);
+        if (i + 1 < numTerms)
+          value = rewriter.create<arith::SubFOp>(
+              loc, value, rewriter.create<arith::ExtFOp>(loc, f32Ty, term));
+      }
+      return terms;
+    };
+    SmallVector<Value> aTerms = split(dotOp.getA());
+    SmallVector<Value> bTerms = split(dotOp.getB());
+
+    Value acc = dotOp.getC();
+    for (int order = maxOrder; order >= 0; --order)
+      for (int i = std::max(0, order - numTerms + 1);
+           i < numTerms && i <= order; ++i)
+        acc = rewriter.create<DotOp>(loc, acc.getType(), aTerms[i],
+                                     bTerms[order - i], acc,
+                                     InputPrecision::IEEE,
+                                     dotOp.getMaxNumImpreciseAcc());
+    rewriter.replaceOp(dotOp, acc);
+    return success();
+  }
+};
+
 } // anonymous namespace
 
 struct F32DotTCPass : public impl::TritonGPUF32DotTCBase<F32DotTCPass> {
@@ -77,7 +146,7 @@ struct F32DotTCPass : public impl::TritonGPUF32DotTCBase<F32DotTCPass> {
     ModuleOp m = getOperation();
 
     RewritePatternSet decomposePatterns(context);
-    decomposePatterns.add<TF32x3>(context);
+    decomposePatterns.add<TF32x3, BF16xN>(context);
     if (applyPatternsAndFoldGreedily(m, std::move(decomposePatterns))
             .failed()) {
       signalPassFailure();
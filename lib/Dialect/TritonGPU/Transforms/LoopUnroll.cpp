@@ -0,0 +1,142 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Utils/Utils.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPULOOPUNROLL
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+const char *kLoopUnrollFactorAttrName = "tt.loop_unroll_factor";
+
+// With auto-unroll, loops without a factor are unrolled when their body is
+// short and loads at most this many bytes per thread and iteration.
+constexpr int kDefaultUnrollFactor = 2;
+constexpr int kMaxDefaultUnrollBodyOps = 64;
+constexpr int64_t kMaxDefaultUnrollBytesPerThread = 16;
+
+bool isInnermostLoop(scf::ForOp forOp) {
+  return !forOp.getBody()
+              ->walk([](Operation *op) {
+                return isa<LoopLikeOpInterface>(op) ? WalkResult::interrupt()
+                                                    : WalkResult::advance();
+              })
+              .wasInterrupted();
+}
+
+int getUnrollFactor(scf::ForOp forOp, bool autoUnroll) {
+  if (auto attr = forOp->getAttrOfType<IntegerAttr>(kLoopUnrollFactorAttrName))
+    return attr.getInt();
+  // Leave the loops that were explicitly given stages to the pipeliner.
+  if (!autoUnroll || forOp->hasAttr(kNumStagesAttrName))
+    return 1;
+  auto mod = forOp->getParentOfType<ModuleOp>();
+  int64_t numThreads = TritonGPUDialect::getNumWarps(mod) *
+                       TritonGPUDialect::getThreadsPerWarp(mod);
+  int numOps = 0;
+  int64_t loadedBytes = 0;
+  bool hasLoad = false;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    ++numOps;
+    auto loadOp = dyn_cast<LoadOp>(op);
+    if (!loadOp)
+      continue;
+    hasLoad = true;
+    if (auto tensorTy = dyn_cast<RankedTensorType>(loadOp.getType()))
+      loadedBytes += tensorTy.getNumElements() *
+                     llvm::divideCeil(tensorTy.getElementTypeBitWidth(), 8);
+  }
+  if (!hasLoad || numOps > kMaxDefaultUnrollBodyOps ||
+      loadedBytes > kMaxDefaultUnrollBytesPerThread * numThreads)
+    return 1;
+  return kDefaultUnrollFactor;
+}
+
+// Move the loads of the unrolled body, with the pure ops computing their
+// operands, as early as their operands and the preceding memory writes allow,
+// so that the loads of the copies of the body are issued together.
+void interleaveLoads(scf::ForOp forOp) {
+  Block *body = forOp.getBody();
+  llvm::SetVector<Operation *> toHoist;
+  SmallVector<Operation *> worklist;
+  for (Operation &op : body->without_terminator()) {
+    if (isa<LoadOp>(op))
+      worklist.push_back(&op);
+  }
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!toHoist.insert(op))
+      continue;
+    for (Value operand : op->getOperands()) {
+      Operation *def = operand.getDefiningOp();
+      if (def && def->getBlock() == body && def->getNumRegions() == 0 &&
+          isMemoryEffectFree(def))
+        worklist.push_back(def);
+    }
+  }
+
+  SmallVector<Operation *> ops;
+  for (Operation &op : body->without_terminator())
+    ops.push_back(&op);
+  for (Operation *op : ops) {
+    if (!toHoist.contains(op))
+      continue;
+    bool isLoad = isa<LoadOp>(op);
+    Operation *insertAfter = nullptr;
+    for (Operation *prev = op->getPrevNode(); prev;
+         prev = prev->getPrevNode()) {
+      bool definesOperand = llvm::any_of(op->getOperands(), [&](Value v) {
+        return v.getDefiningOp() == prev;
+      });
+      bool writesMemory = !isMemoryEffectFree(prev) && !isa<LoadOp>(prev);
+      // Hoisted ops keep their relative order.
+      if (definesOperand || toHoist.contains(prev) ||
+          (isLoad && writesMemory)) {
+        insertAfter = prev;
+        break;
+      }
+    }
+    if (insertAfter)
+      op->moveAfter(insertAfter);
+    else
+      op->moveBefore(&body->front());
+  }
+}
+
+} // namespace
+
+struct LoopUnrollPass : public impl::TritonGPULoopUnrollBase<LoopUnrollPass> {
+  using impl::TritonGPULoopUnrollBase<LoopUnrollPass>::TritonGPULoopUnrollBase;
+
+  void runOnOperation() override {
+    SmallVector<std::pair<scf::ForOp, int>> loops;
+    getOperation()->walk([&](scf::ForOp forOp) {
+      if (!isInnermostLoop(forOp))
+        return;
+      int factor = getUnrollFactor(forOp, autoUnroll);
+      if (factor > 1)
+        loops.push_back({forOp, factor});
+    });
+
+    for (auto [forOp, factor] : loops) {
+      if (failed(loopUnrollByFactor(forOp, factor)))
+        continue;
+      forOp->removeAttr(kLoopUnrollFactorAttrName);
+      interleaveLoads(forOp);
+    }
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
@@ -1,4 +1,5 @@
 #include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -73,6 +74,12 @@ public:
   }
 };
 
+// Custom conversions and arith ops, which can be computed in any layout.
+bool isElementwiseArithOrConversion(Operation *op) {
+  return isa<FpToFpOp, BitcastOp>(op) || isPureUnaryInlineAsm(op) ||
+         op->getDialect()->getTypeID() == TypeID::get<arith::ArithDialect>();
+}
+
 // Move convert-to-dot-operand "up" past elementwise ops:
 //
 //  convert(elementwise(x)) #dot_operand ->
@@ -128,8 +135,7 @@ public:
 
     // Only consider custom conversions or arith ops.
     // TODO(jlebar): Is this too restrictive?
-    if (!isa<FpToFpOp, BitcastOp>(src) && !isPureUnaryInlineAsm(src) &&
-        src->getDialect()->getTypeID() != TypeID::get<arith::ArithDialect>())
+    if (!isElementwiseArithOrConversion(src))
       return failure();
 
     // Currently, these instructions are not supported during lowering of
@@ -167,10 +173,7 @@ public:
       } else if (foundLoad) {
         // Bail out if there exists an op after Load that is not FpToFp,
         // Bitcast, or Arith.
-        if (!isa<FpToFpOp, BitcastOp>(currOp) &&
-            !isPureUnaryInlineAsm(currOp) &&
-            currOp->getDialect()->getTypeID() !=
-                TypeID::get<arith::ArithDialect>())
+        if (!isElementwiseArithOrConversion(currOp))
           return failure();
       }
     }
@@ -183,6 +186,16 @@ public:
       auto operandTy = cast<RankedTensorType>(operand.getType());
       Type newCvtTy = RankedTensorType::get(
           srcTy.getShape(), operandTy.getElementType(), cvtTy.getEncoding());
+      // Operands defined in an enclosing region, e.g. the per-channel scales
+      // and zero points of a dequantized weight inside a K loop, are converted
+      // where they are defined so that their shmem round-trip is paid once.
+      // TODO: Per-group scales loaded inside the loop and int4 operands
+      // unpacked with join/reshape are not elementwise and still go through
+      // shmem at full width. Fusing them needs a packed dot operand type that
+      // SharedToDotOperandMMAv2 can dequantize after ldmatrix.
+      OpBuilder::InsertionGuard guard(rewriter);
+      if (operand.getParentRegion()->isProperAncestor(cvt->getParentRegion()))
+        rewriter.setInsertionPointAfterValue(operand);
       newOperands.push_back(
           rewriter.create<ConvertLayoutOp>(cvt.getLoc(), newCvtTy, operand));
     }
@@ -259,10 +272,51 @@ public:
   }
 };
 
+// Returns true if `value` is computed by elementwise ops from loads of
+// narrower elements in the same region, e.g. a weight dequantized from int8.
+// Splats and broadcasts, of scales for instance, may feed the computation.
+bool isComputedFromNarrowerLoads(Value value) {
+  Operation *def = value.getDefiningOp();
+  if (!def || !isElementwiseArithOrConversion(def))
+    return false;
+  unsigned bitWidth = getElementTypeOrSelf(value).getIntOrFloatBitWidth();
+  bool foundNarrowerLoad = false;
+  SmallVector<Operation *> worklist = {def};
+  DenseSet<Operation *> visited;
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!visited.insert(op).second || isa<SplatOp, BroadcastOp>(op))
+      continue;
+    if (auto load = dyn_cast<LoadOp>(op)) {
+      Type elemTy = getElementTypeOrSelf(load.getType());
+      if (elemTy.isIntOrFloat() && elemTy.getIntOrFloatBitWidth() < bitWidth)
+        foundNarrowerLoad = true;
+      continue;
+    }
+    if (!isElementwiseArithOrConversion(op))
+      return false;
+    for (Value operand : op->getOperands()) {
+      Operation *operandDef = operand.getDefiningOp();
+      if (operandDef && operandDef->getParentRegion() == def->getParentRegion())
+        worklist.push_back(operandDef);
+    }
+  }
+  return foundNarrowerLoad;
+}
+
 // Rewrite
 //   dot(convert(lhs #mma) #shared, rhs) #mma ->
 //   dot(convert(lhs #mma) #dot_operand, rhs) #mma,
 // for fp16 or bf16 MMAv3 dots.
+//
+// An fp16 or bf16 lhs computed from narrower loads is kept in registers too:
+//   dot(alloc(elementwise(load) #blocked) #shared, rhs) #mma ->
+//   dot(convert(convert(elementwise(load) #blocked) #mma) #dot_operand, rhs),
+// and the layout conversion pass then moves the convert to #mma above the
+// elementwise ops, so that only the narrow loads go through shmem.
+//
+// An lhs allocated outside of the loop around the dot stays in shmem, where
+// the wgmma reads it in every iteration without holding registers.
 struct MMAV3UseRegOperand
     : public OpRewritePattern<triton::nvidia_gpu::WarpGroupDotOp> {
   using OpRewritePattern::OpRewritePattern;
@@ -272,6 +326,9 @@ struct MMAV3UseRegOperand
     auto alloc = dotOp.getOperand(0).getDefiningOp<LocalAllocOp>();
     if (!alloc || !alloc.getSrc())
       return failure();
+    if (auto loop = dotOp->getParentOfType<LoopLikeOpInterface>();
+        loop && loop.isDefinedOutsideOfLoop(alloc))
+      return failure();
 
     auto getEncoding = [](Value v) {
       return cast<TensorOrMemDesc>(v.getType()).getEncoding();
@@ -279,22 +336,45 @@ struct MMAV3UseRegOperand
 
     if (!isa<SharedEncodingAttr>(getEncoding(dotOp.getOperand(0))))
       return failure();
-    auto srcEnc = dyn_cast<NvidiaMmaEncodingAttr>(getEncoding(alloc.getSrc()));
     auto dstEnc =
         dyn_cast<NvidiaMmaEncodingAttr>(getEncoding(dotOp.getResult()));
-    if (!srcEnc || srcEnc.getVersionMajor() != 3 || !dstEnc ||
-        dstEnc.getVersionMajor() != 3)
+    if (!dstEnc || dstEnc.getVersionMajor() != 3)
+      return failure();
+
+    Value src = alloc.getSrc();
+    if (auto cvt = src.getDefiningOp<ConvertLayoutOp>()) {
+      if (isa<NvidiaMmaEncodingAttr>(getEncoding(cvt.getSrc())))
+        src = cvt.getSrc();
+    }
+    auto srcTy = cast<RankedTensorType>(src.getType());
+    auto srcEnc = dyn_cast<NvidiaMmaEncodingAttr>(srcTy.getEncoding());
+    if (!srcEnc) {
+      Type elemTy = srcTy.getElementType();
+      if (!(elemTy.isF16() || elemTy.isBF16()) ||
+          !isComputedFromNarrowerLoads(src))
+        return failure();
+      auto warpsPerCTA = dstEnc.getWarpsPerCTA();
+      int numWarps = product<unsigned>(warpsPerCTA);
+      srcEnc = NvidiaMmaEncodingAttr::get(
+          dotOp.getContext(), /*versionMajor=*/3, dstEnc.getVersionMinor(),
+          warpsPerCTA, dstEnc.getCTALayout(),
+          mmaVersionToInstrShape(3, srcTy.getShape(), srcTy, numWarps));
+    }
+    if (srcEnc.getVersionMajor() != 3)
       return failure();
-    auto srcTy = cast<RankedTensorType>(alloc.getSrc().getType());
+    auto mmaTy =
+        RankedTensorType::get(srcTy.getShape(), srcTy.getElementType(), srcEnc);
     auto dotOperandEnc = DotOperandEncodingAttr::get(
         dotOp.getContext(), /*opIdx=*/0, srcEnc, /*kWidth=*/0);
     auto newTy = RankedTensorType::get(srcTy.getShape(), srcTy.getElementType(),
                                        dotOperandEnc);
-    if (!isMmaToDotShortcut(srcTy, newTy))
+    if (!isMmaToDotShortcut(mmaTy, newTy))
       return failure();
 
+    if (src.getType() != mmaTy)
+      src = rewriter.create<ConvertLayoutOp>(dotOp.getLoc(), mmaTy, src);
     Value newOperand =
-        rewriter.create<ConvertLayoutOp>(dotOp.getLoc(), newTy, alloc.getSrc());
+        rewriter.create<ConvertLayoutOp>(dotOp.getLoc(), newTy, src);
     rewriter.modifyOpInPlace(dotOp, [&]() { dotOp.setOperand(0, newOperand); });
     return success();
   }
@@ -106,6 +106,12 @@ class TritonGPUOptimizeThreadLocalityPass
       signalPassFailure();
     }
 
+    IRRewriter builder(&getContext());
+    // Reductions over several axes and scans of loop-carried accumulators
+    // are moved after the loop entirely.
+    while (deferReduceAndScanChain(builder, mod))
+      ;
+
     DenseSet<triton::ReduceOp> reduceOps;
     mod.walk([&](triton::ReduceOp reduce) -> void {
       auto srcType = cast<RankedTensorType>(reduce.getOperands()[0].getType());
@@ -153,7 +159,6 @@ class TritonGPUOptimizeThreadLocalityPass
       reduceOps.insert(reduce);
     });
 
-    IRRewriter builder(&getContext());
     for (auto reduce : reduceOps) {
       builder.setInsertionPoint(reduce);
       auto srcType = cast<RankedTensorType>(reduce.getOperands()[0].getType());
@@ -229,7 +234,116 @@ class TritonGPUOptimizeThreadLocalityPass
   };
 
 private:
-  std::optional<Operation *> getReductionOp(triton::ReduceOp reduce) const {
+  // Find `acc = acc op R(x)` yielded by the loop, where R is a chain of
+  // reductions and scans combining with `op` and the accumulator is only
+  // read by the update. As `op` is associative and commutative, applying R
+  // once after the loop to the elementwise combination of every x gives the
+  // same result, without any cross-thread communication inside the loop.
+  // Returns the chain from x to the accumulated value.
+  SmallVector<Operation *> getDeferrableChain(scf::ForOp forOp,
+                                              unsigned argNum) const {
+    Value iterArg = forOp.getRegionIterArg(argNum);
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    Operation *update = yieldOp.getOperand(argNum).getDefiningOp();
+    if (!update || update->getBlock() != forOp.getBody() ||
+        !isa<arith::AddFOp, arith::MulFOp, arith::MaximumFOp, arith::MaxNumFOp,
+             arith::MinimumFOp, arith::MinNumFOp, arith::AddIOp,
+             arith::MaxSIOp, arith::MinSIOp>(update) ||
+        !update->hasOneUse() || !iterArg.hasOneUse() ||
+        *iterArg.getUsers().begin() != update)
+      return {};
+    Value accumulated = update->getOperand(0) == iterArg
+                            ? update->getOperand(1)
+                            : update->getOperand(0);
+    SmallVector<Operation *> chain;
+    bool hasScan = false;
+    while (Operation *def = accumulated.getDefiningOp()) {
+      if (!isa<triton::ReduceOp, triton::ScanOp>(def) ||
+          def->getNumOperands() != 1 || !def->hasOneUse() ||
+          def->getBlock() != forOp.getBody())
+        break;
+      auto combiner = getReductionOp(def);
+      if (!combiner || (*combiner)->getName() != update->getName() ||
+          !llvm::all_of((*combiner)->getOperands(),
+                        [](Value v) { return isa<BlockArgument>(v); }))
+        break;
+      hasScan |= isa<triton::ScanOp>(def);
+      chain.push_back(def);
+      accumulated = def->getOperand(0);
+    }
+    // A single reduction is made thread-local instead.
+    if (chain.size() == 1 && !hasScan)
+      return {};
+    std::reverse(chain.begin(), chain.end());
+    return chain;
+  }
+
+  bool deferReduceAndScanChain(IRRewriter &builder, ModuleOp mod) const {
+    scf::ForOp forOp;
+    unsigned argNum = 0;
+    SmallVector<Operation *> chain;
+    mod.walk([&](scf::ForOp loop) {
+      for (unsigned i = 0; i < loop.getNumRegionIterArgs(); ++i) {
+        chain = getDeferrableChain(loop, i);
+        if (!chain.empty()) {
+          forOp = loop;
+          argNum = i;
+          return WalkResult::interrupt();
+        }
+      }
+      return WalkResult::advance();
+    });
+    if (!forOp)
+      return false;
+
+    Value src = chain.front()->getOperand(0);
+    auto srcType = cast<RankedTensorType>(src.getType());
+    Operation *combiner = *getReductionOp(chain.front());
+    auto yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    Operation *update = yieldOp.getOperand(argNum).getDefiningOp();
+    Value iterArg = forOp.getRegionIterArg(argNum);
+    Value init = forOp.getInitArgs()[argNum];
+
+    // Accumulate x elementwise, starting from the neutral element.
+    builder.setInsertionPoint(forOp);
+    auto neutralVal = getNeutralElement(combiner);
+    assert(neutralVal && "Could not find neutral value for reduction op!");
+    Value tileInit = builder.create<arith::ConstantOp>(
+        forOp.getLoc(), srcType,
+        DenseElementsAttr::get(srcType, neutralVal.value()));
+    scf::ForOp newLoop =
+        replaceForOpWithNewSignature(builder, forOp, ValueRange{tileInit});
+    forOp.erase();
+    Block *body = newLoop.getBody();
+    yieldOp = cast<scf::YieldOp>(body->getTerminator());
+    builder.setInsertionPoint(yieldOp);
+    Operation *tileUpdate = builder.create(
+        update->getLoc(), combiner->getName().getIdentifier(),
+        ValueRange{body->getArguments().back(), src}, srcType);
+
+    // Apply the chain and the update once, after the loop.
+    builder.setInsertionPointAfter(newLoop);
+    IRMapping mapping;
+    mapping.map(src, newLoop.getResults().back());
+    for (Operation *op : chain)
+      builder.clone(*op, mapping);
+    mapping.map(iterArg, init);
+    Operation *finalUpdate = builder.clone(*update, mapping);
+    builder.replaceAllUsesWith(newLoop.getResult(argNum),
+                               finalUpdate->getResult(0));
+
+    builder.modifyOpInPlace(yieldOp, [&]() {
+      yieldOp->setOperand(argNum, iterArg);
+      yieldOp->insertOperands(yieldOp->getNumOperands(),
+                              tileUpdate->getResult(0));
+    });
+    update->erase();
+    for (Operation *op : llvm::reverse(chain))
+      op->erase();
+    return true;
+  }
+
+  std::optional<Operation *> getReductionOp(Operation *reduce) const {
     auto numRegions = reduce->getNumRegions();
     if (numRegions != 1)
       return std::nullopt;
@@ -0,0 +1,132 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUOUTLINECOLDREGIONS
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+const char *kColdRegionAttrName = "tt.cold_region";
+const char *kUnlikelyAttrName = "tt.unlikely";
+
+// Whether the condition was hinted to be rarely true
+bool isUnlikely(Value cond) {
+  if (Operation *def = cond.getDefiningOp())
+    return def->hasAttr(kUnlikelyAttrName);
+  auto arg = cast<BlockArgument>(cond);
+  auto funcOp = dyn_cast<FuncOp>(arg.getOwner()->getParentOp());
+  return funcOp && funcOp.getArgAttr(arg.getArgNumber(), kUnlikelyAttrName);
+}
+
+Region *getColdRegion(scf::IfOp ifOp) {
+  if (auto attr = ifOp->getAttrOfType<IntegerAttr>(kColdRegionAttrName))
+    return attr.getInt() == 0 ? &ifOp.getThenRegion() : &ifOp.getElseRegion();
+  if (isUnlikely(ifOp.getCondition()))
+    return &ifOp.getThenRegion();
+  return nullptr;
+}
+
+// The values that can be passed to and returned from functions. Shared memory
+// descriptors would hide the buffers from the analyses of the callers, and
+// tokens tie async copies to the function that issued them.
+bool canCrossCall(Type type) {
+  return isa<IntegerType, FloatType, IndexType, PointerType, RankedTensorType>(
+      type);
+}
+
+class OutlineColdRegionsPass
+    : public impl::TritonGPUOutlineColdRegionsBase<OutlineColdRegionsPass> {
+public:
+  using impl::TritonGPUOutlineColdRegionsBase<
+      OutlineColdRegionsPass>::TritonGPUOutlineColdRegionsBase;
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    SymbolTable symbolTable(mod);
+
+    // Inner regions come first, so that the outer ones call their functions
+    SmallVector<std::pair<scf::IfOp, Region *>> candidates;
+    mod.walk([&](scf::IfOp ifOp) {
+      Region *region = getColdRegion(ifOp);
+      if (!region || region->empty())
+        return;
+      int numOps = 0;
+      region->walk([&](Operation *) { ++numOps; });
+      if (numOps < minOps)
+        return;
+      candidates.push_back({ifOp, region});
+    });
+
+    for (auto [ifOp, region] : candidates) {
+      llvm::SetVector<Value> liveIns;
+      getUsedValuesDefinedAbove(*region, *region, liveIns);
+      Block &block = region->front();
+      auto yieldOp = cast<scf::YieldOp>(block.getTerminator());
+      if (!llvm::all_of(liveIns.getArrayRef(),
+                        [](Value v) { return canCrossCall(v.getType()); }) ||
+          !llvm::all_of(yieldOp.getOperandTypes(), canCrossCall))
+        continue;
+      outline(ifOp, block, liveIns.getArrayRef(), symbolTable);
+    }
+  }
+
+private:
+  void outline(scf::IfOp ifOp, Block &block, ArrayRef<Value> liveIns,
+               SymbolTable &symbolTable) {
+    MLIRContext *ctx = ifOp.getContext();
+    Location loc = ifOp.getLoc();
+    auto parentFunc = ifOp->getParentOfType<FuncOp>();
+    auto yieldOp = cast<scf::YieldOp>(block.getTerminator());
+
+    OpBuilder b(ctx);
+    auto funcTy = FunctionType::get(ctx, ValueRange(liveIns).getTypes(),
+                                    yieldOp.getOperandTypes());
+    SmallVector<NamedAttribute> attrs = {
+        b.getNamedAttr("sym_visibility", b.getStringAttr("private")),
+        b.getNamedAttr("noinline", b.getBoolAttr(true))};
+    auto funcOp = b.create<FuncOp>(
+        loc, (parentFunc.getName() + "__cold").str(), funcTy, attrs);
+    // The lowering of calls expects every argument to have its attributes
+    funcOp.setArgAttrsAttr(b.getArrayAttr(
+        SmallVector<Attribute>(liveIns.size(), b.getDictionaryAttr({}))));
+    symbolTable.insert(funcOp, std::next(parentFunc->getIterator()));
+
+    Block *entry = funcOp.addEntryBlock();
+    IRMapping mapping;
+    mapping.map(liveIns, entry->getArguments());
+    b.setInsertionPointToEnd(entry);
+    for (Operation &op : block.without_terminator())
+      b.clone(op, mapping);
+    SmallVector<Value> results;
+    for (Value value : yieldOp.getOperands())
+      results.push_back(mapping.lookupOrDefault(value));
+    b.create<ReturnOp>(loc, results);
+
+    // The region only calls the function now
+    b.setInsertionPoint(yieldOp);
+    auto callOp = b.create<CallOp>(loc, funcOp, liveIns);
+    yieldOp->setOperands(callOp.getResults());
+    SmallVector<Operation *> ops;
+    for (Operation &op : block.without_terminator())
+      if (&op != callOp.getOperation())
+        ops.push_back(&op);
+    for (Operation *op : llvm::reverse(ops))
+      op->erase();
+  }
+};
+
+} // namespace
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
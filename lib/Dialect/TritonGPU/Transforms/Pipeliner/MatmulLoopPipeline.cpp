@@ -1,8 +1,7 @@
-#include "PipelineExpander.h"
-#include "PipeliningUtility.h"
-#include "Schedule.h"
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
@@ -14,6 +13,9 @@
 #include "triton/Dialect/TritonGPU/IR/Attributes.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "llvm/ADT/MapVector.h"
@@ -21,8 +23,6 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Debug.h"
 
-#include <list>
-
 #define DEBUG_TYPE "triton-matmul-loop-pipeline"
 #define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
 #define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
@@ -47,147 +47,12 @@ struct LoadInfo {
   bool loadIsMMAV3 = false;
   int distToUse = 0;
   bool usedByDot = false;
+  // Small loads are prefetched in registers rather than in shared memory.
+  bool inRegisters = false;
 };
 
 } // namespace
 
-class CoarseSchedule {
-public:
-  class ClusterList {
-    std::list<int> orderClusters;
-
-  public:
-    using iterator = decltype(orderClusters)::iterator;
-    ClusterList() = default;
-    iterator begin() { return orderClusters.begin(); }
-    iterator end() { return orderClusters.end(); }
-    size_t size() { return orderClusters.size(); }
-    iterator newAtBack() {
-      orderClusters.push_back(orderClusters.size());
-      return std::prev(orderClusters.end());
-    }
-    iterator newAtFront() {
-      orderClusters.push_front(-1);
-      for (auto &clusterId : orderClusters) {
-        clusterId++;
-      }
-      return orderClusters.begin();
-    }
-    iterator newBefore(iterator cluster) {
-      auto ret = orderClusters.insert(cluster, *cluster);
-      for (auto &clusterId : llvm::make_range(cluster, orderClusters.end())) {
-        clusterId++;
-      }
-      return ret;
-    }
-  };
-
-  CoarseSchedule(int numStages) : numStages(numStages) {}
-  int numStages;
-  ClusterList clusters;
-  using Cluster = decltype(clusters)::iterator;
-
-  DenseMap<Operation *, std::pair<int, Cluster>> opToStageAndCluster;
-
-  void insert(Operation *op, int stage, Cluster cluster) {
-    opToStageAndCluster[op] = {stage, cluster};
-  }
-
-  bool insertIfAbsent(Operation *op, int stage, Cluster cluster) {
-    if (opToStageAndCluster.count(op))
-      return false;
-    insert(op, stage, cluster);
-    return true;
-  }
-
-  void insertDepsOfOp(Operation *op, int stage, CoarseSchedule::Cluster cluster,
-                      bool includeArg) {
-    for (Value operand : op->getOperands()) {
-      Value v = operand;
-      llvm::SmallDenseSet<Value> seen;
-      while (auto arg = dyn_cast<BlockArgument>(v)) {
-        if (!includeArg)
-          break;
-        if (!seen.insert(v).second)
-          break;
-        if (arg.getArgNumber() > 0 && arg.getOwner() == op->getBlock()) {
-          auto yieldOp = op->getBlock()->getTerminator();
-          v = yieldOp->getOperand(arg.getArgNumber() - 1);
-          continue;
-        }
-        break;
-      }
-      Operation *defOp = v.getDefiningOp();
-      if (defOp && defOp->getBlock() == op->getBlock()) {
-        if (insertIfAbsent(defOp, stage, cluster)) {
-          insertDepsOfOp(defOp, stage, cluster, includeArg);
-        }
-      }
-    }
-  }
-
-  void erase(Operation *op) { opToStageAndCluster.erase(op); }
-
-  int count(Operation *op) { return opToStageAndCluster.count(op); }
-
-  std::pair<int, Cluster> operator[](Operation *op) {
-    return opToStageAndCluster[op];
-  }
-
-  SmallVector<std::tuple<Operation *, int, Cluster>>
-  getOpsInOrder(scf::ForOp forOp) {
-    SmallVector<SmallVector<std::tuple<Operation *, int, Cluster>>, 8>
-        orderClusters(clusters.size());
-    for (auto &op : forOp.getBody()->without_terminator()) {
-      if (opToStageAndCluster.count(&op) == 0) {
-        continue;
-      }
-      assert(opToStageAndCluster[&op].first < numStages &&
-             "Op with invalid stage!");
-      int clusterId = *opToStageAndCluster[&op].second;
-      assert(clusterId == std::distance(clusters.begin(),
-                                        opToStageAndCluster[&op].second) &&
-             "Cluster ID mismatch!");
-      orderClusters[clusterId].push_back(
-          make_tuple(&op, opToStageAndCluster[&op].first,
-                     opToStageAndCluster[&op].second));
-    }
-    SmallVector<std::tuple<Operation *, int, Cluster>> opsInOrder;
-    for (int i = 0; i < orderClusters.size(); i++) {
-      for (auto [op, stage, cluster] : orderClusters[i]) {
-        opsInOrder.push_back({op, stage, cluster});
-      }
-    }
-
-    return opsInOrder;
-  }
-
-  std::vector<std::pair<Operation *, unsigned>>
-  createFinalSchedule(scf::ForOp forOp) {
-    SmallVector<std::tuple<Operation *, int, Cluster>> opsInOrder =
-        getOpsInOrder(forOp);
-    std::vector<std::pair<Operation *, unsigned>> schedule;
-    for (auto [op, stage, cluster] : opsInOrder) {
-      LDBG("Adding op to schedule at stage " << stage << " cluster " << *cluster
-                                             << ":" << *op);
-      schedule.push_back({op, stage});
-    }
-    return schedule;
-  }
-
-  void dump() {
-    for (int i = 0; i < numStages; i++) {
-      LDBG("- Ops in stage " << i);
-      for (auto &[op, stageAndCluster] : opToStageAndCluster) {
-        if (i == stageAndCluster.first) {
-          llvm::outs() << " cluster: " << *stageAndCluster.second << " ";
-          op->dump();
-        }
-      }
-    }
-  }
-};
-
 // Replace the ForOp's yield with a new one with the given operands appended.
 static void appendToYield(scf::ForOp forOp, ArrayRef<Value> newOperands) {
   // Fix up the yield op.
@@ -202,8 +67,8 @@ static void appendToYield(scf::ForOp forOp, ArrayRef<Value> newOperands) {
 
 static void createAsyncCopy(scf::ForOp &forOp, tt::LoadOp loadOp, Value alloc,
                             Value insertIdx, Value extractIdx,
-                            CoarseSchedule &schedule,
-                            CoarseSchedule::Cluster prefetchCluster,
+                            tt::CoarseSchedule &schedule,
+                            tt::CoarseSchedule::Cluster prefetchCluster,
                             llvm::MapVector<Operation *, LoadInfo> &loadToInfo,
                             int numStages) {
   OpBuilder builder(forOp);
@@ -305,7 +170,7 @@ static void createAsyncCopy(scf::ForOp &forOp, tt::LoadOp loadOp, Value alloc,
 static void createTMAAsyncCopy(
     scf::ForOp &forOp, tt::ExperimentalDescriptorLoadOp loadOp, Value alloc,
     Value insertIdx, Value extractIdx, Value barrier, Operation *waitOp,
-    Value phase, CoarseSchedule &schedule,
+    Value phase, tt::CoarseSchedule &schedule,
     llvm::MapVector<Operation *, LoadInfo> &loadToInfo, int numStages) {
   assert(phase && "Phase value is required for TMA async copy.");
   OpBuilder builder(forOp);
@@ -325,7 +190,8 @@ static void createTMAAsyncCopy(
 
   Value pred = builder.create<arith::ConstantIntOp>(loc, 1, 1);
   Operation *copy = builder.create<ttng::AsyncTMACopyGlobalToLocalOp>(
-      loc, loadOp.getDescPtr(), loadOp.getIndices(), barrier, view, pred);
+      loc, loadOp.getDescPtr(), loadOp.getIndices(), loadOp.getIm2colOffsets(),
+      barrier, view, pred);
 
   bool isMMV3Load = loadToInfo[loadOp].loadIsMMAV3;
   auto [stage, cluster] = schedule[loadOp];
@@ -395,6 +261,11 @@ getSharedEncIfAllUsersAreDotEnc(Value val) {
           ttg::getOrder(srcTy.getEncoding()),
           ttg::getCTALayout(srcTy.getEncoding()),
           srcTy.getElementType().getIntOrFloatBitWidth(), /*needTrans=*/false);
+      if (auto tensorTy = dyn_cast<RankedTensorType>(val.getType())) {
+        tempAttr = optimizeSharedSwizzle(tempAttr, tensorTy.getShape(),
+                                         tensorTy.getElementType(),
+                                         tensorTy.getEncoding(), dotOpEnc);
+      }
     }
     // Check that the shared encodings needed by the users are compatible.
     if (!tempAttr || (attr != nullptr && attr != tempAttr))
@@ -471,6 +342,68 @@ getSharedEncoding(Operation *loadOp, bool isMMAV3) {
                                       ctaLayout);
 }
 
+// Loops without dots whose loads stream into reductions or elementwise math,
+// like the row loops of layernorm or chunked cross-entropy, also wait on their
+// loads every iteration. They are worth pipelining when they do so little
+// arithmetic per loaded element that the load latency dominates.
+static constexpr int64_t kMaxStreamingOpsPerLoadedElement = 16;
+
+// Whether `op` or one of its nested ops may write global memory. Ops with
+// unknown effects, like calls, are assumed to.
+static bool mayWriteGlobalMemory(Operation *op) {
+  auto result = op->walk([](Operation *nested) {
+    auto memEffects = dyn_cast<MemoryEffectOpInterface>(nested);
+    if (!memEffects) {
+      if (nested->hasTrait<OpTrait::HasRecursiveMemoryEffects>() ||
+          isMemoryEffectFree(nested))
+        return WalkResult::advance();
+      return WalkResult::interrupt();
+    }
+    SmallVector<MemoryEffects::EffectInstance> effects;
+    memEffects.getEffects(effects);
+    for (const MemoryEffects::EffectInstance &effect : effects) {
+      if (isa<MemoryEffects::Write>(effect.getEffect()) &&
+          isa<tt::GlobalMemory, SideEffects::DefaultResource>(
+              effect.getResource()))
+        return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+// Loops writing global memory are left alone: their next loads would be issued
+// before the stores of the current iteration, which they may read.
+static bool isLatencyBoundStreamingLoop(scf::ForOp forOp) {
+  if (mayWriteGlobalMemory(forOp))
+    return false;
+  int64_t loadedElements = 0;
+  int64_t computedElements = 0;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (op.hasTrait<OpTrait::DotLike>())
+      return false;
+    auto getNumElements = [](Value v) -> int64_t {
+      auto tensorTy = dyn_cast<RankedTensorType>(v.getType());
+      return tensorTy ? tensorTy.getNumElements() : 0;
+    };
+    if (isa<tt::LoadOp>(op)) {
+      loadedElements += getNumElements(op.getResult(0));
+    } else if (isa<tt::ReduceOp, tt::ScanOp>(op)) {
+      // The combine region without its tt.reduce.return or tt.scan.return
+      int64_t numCombineOps =
+          op.getRegion(0).front().getOperations().size() - 1;
+      computedElements += numCombineOps * getNumElements(op.getOperand(0));
+    } else if (isa<arith::ArithDialect, math::MathDialect>(op.getDialect()) &&
+               op.getNumResults() == 1) {
+      computedElements += getNumElements(op.getResult(0));
+    }
+  }
+  LDBG("Streaming loop loads " << loadedElements << " elements and computes "
+                               << computedElements);
+  return loadedElements > 0 &&
+         computedElements <= kMaxStreamingOpsPerLoadedElement * loadedElements;
+}
+
 // Create a map from load ops to their indirection level and the
 // final use of the load op (another load op, or a dot op).
 // Indirection level is "0" for the load op directly used by the dot op,
@@ -507,9 +440,11 @@ loadOpsToIndirectionLevelAndUse(scf::ForOp forOp) {
     dfs(&op, 0, &op);
   }
 
-  // If the loop has numStages attribute, also consider pipelining other loads
-  // that are not directly used by dot ops.
-  if (forOp->hasAttr(tt::kNumStagesAttrName)) {
+  // If the loop has numStages attribute, or is bound by the latency of its
+  // loads, also consider pipelining other loads that are not directly used by
+  // dot ops.
+  if (forOp->hasAttr(tt::kNumStagesAttrName) ||
+      isLatencyBoundStreamingLoop(forOp)) {
     for (Operation &op : forOp.getBody()->without_terminator()) {
       if (!isa<tt::LoadOp, tt::ExperimentalDescriptorLoadOp>(op))
         dfs(&op, 0, &op);
@@ -519,6 +454,32 @@ loadOpsToIndirectionLevelAndUse(scf::ForOp forOp) {
   return loadOpToIndLevelAndUse;
 }
 
+// Return the number of stages requested for `loadOp` with a `tt.num_stages`
+// attribute, or the number of stages of the loop.
+static int getLoadNumStages(Operation *loadOp, int numStages) {
+  auto attr = loadOp->getAttrOfType<IntegerAttr>(tt::kNumStagesAttrName);
+  if (!attr)
+    return numStages;
+  return std::clamp<int>(attr.getInt(), 1, numStages);
+}
+
+// Loads of scales, biases and other small tiles take at most one vector load
+// per thread. Keeping them in flight in registers is cheaper than taking a
+// multi-buffered slot of shared memory that the large tiles need.
+static constexpr int64_t kMaxRegisterStagedBytesPerThread = 16;
+
+static bool canStageInRegisters(tt::LoadOp loadOp) {
+  auto tensorTy = dyn_cast<RankedTensorType>(loadOp.getType());
+  if (!tensorTy)
+    return false;
+  auto mod = loadOp->getParentOfType<ModuleOp>();
+  int64_t numThreads = ttg::TritonGPUDialect::getNumWarps(mod) *
+                       ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+  int64_t numBytes = tensorTy.getNumElements() *
+                     ceil<int64_t>(tensorTy.getElementTypeBitWidth(), 8);
+  return numBytes <= kMaxRegisterStagedBytesPerThread * numThreads;
+}
+
 static bool loadIsMMAv3(Operation *loadOp) {
   if (!loadOp->hasOneUse())
     return false;
@@ -541,9 +502,19 @@ static bool loadIsMMAv3(Operation *loadOp) {
   return oldOrder == newOrder;
 }
 
+// Whether the load only reaches its dot through register computations, like
+// the block scales of a decomposed scaled dot, rather than being one of its
+// shared memory operands.
+static bool loadFeedsDotThroughRegisters(Operation *loadOp) {
+  return llvm::none_of(loadOp->getUsers(), [](Operation *user) {
+    return isa<ttg::LocalAllocOp>(user);
+  });
+}
+
 static llvm::MapVector<Operation *, LoadInfo>
 assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
                         &loadOpToIndLevelAndUse,
+                    int numStages,
                     tt::ModuleAxisInfoAnalysis &axisInfoAnalysis) {
   llvm::MapVector<Operation *, LoadInfo> loadToInfo;
 
@@ -551,6 +522,9 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
     if (loadToInfo.count(op))
       // TODO pawel: err, we'd need to verify that the distance is the same
       continue;
+    // The load was asked not to be pipelined.
+    if (getLoadNumStages(op, numStages) == 1)
+      continue;
     LoadInfo loadInfo;
 
     if (auto loadOp = dyn_cast<tt::LoadOp>(op)) {
@@ -577,6 +551,11 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
       if (width < 32)
         continue;
     }
+    // The buffers of TMA loads of more than 2 dims are not swizzled, unlike
+    // the shared encoding chosen below.
+    if (isa<tt::ExperimentalDescriptorLoadOp>(op) &&
+        cast<RankedTensorType>(op->getResultTypes()[0]).getRank() > 2)
+      continue;
 
     if (use->hasTrait<OpTrait::DotLike>()) {
       loadInfo.usedByDot = true;
@@ -635,9 +614,21 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
       }
     }
 
+    // The indices of indirect loads keep going through shared memory.
+    auto loadOp = dyn_cast<tt::LoadOp>(op);
+    if (!loadInfo.usedByDot && !isa<tt::LoadOp>(use) && loadOp &&
+        canStageInRegisters(loadOp)) {
+      LDBG("Load " << *loadOp << " is staged in registers");
+      loadInfo.inRegisters = true;
+      loadToInfo[op] = loadInfo;
+      continue;
+    }
+
     // If we still don't have a shared encoding, try a "generic" shared
-    // encoding.
-    if (!loadInfo.sharedEncoding && !isa<ttng::WarpGroupDotOp>(use)) {
+    // encoding. The shared operands of wgmma need the encodings above, but
+    // loads that are local_loaded into registers before the wgmma can use any.
+    if (!loadInfo.sharedEncoding &&
+        (!isa<ttng::WarpGroupDotOp>(use) || loadFeedsDotThroughRegisters(op))) {
       loadInfo.sharedEncoding =
           getSharedEncoding(op, /*isMMAV3=*/loadInfo.loadIsMMAV3)
               .value_or(nullptr);
@@ -657,10 +648,9 @@ assignMemoryLayouts(llvm::SmallVector<std::tuple<Operation *, int, Operation *>>
 }
 
 static llvm::MapVector<Operation *, LoadInfo>
-scheduleLoads(scf::ForOp forOp, CoarseSchedule &schedule,
-              DenseSet<Operation *> &rootUsers, int numStages) {
-  ModuleOp moduleOp = forOp->getParentOfType<ModuleOp>();
-  tt::ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+scheduleLoads(scf::ForOp forOp, tt::CoarseSchedule &schedule,
+              DenseSet<Operation *> &rootUsers, int numStages,
+              tt::ModuleAxisInfoAnalysis &axisInfoAnalysis) {
 
   // Get all loads that are (transitively) used by dot ops and their distance
   // to the dot op.
@@ -680,7 +670,7 @@ scheduleLoads(scf::ForOp forOp, CoarseSchedule &schedule,
   // Check which loads are good for pipelining, and assign them
   // memory layouts.
   llvm::MapVector<Operation *, LoadInfo> loadToInfo =
-      assignMemoryLayouts(loadOpToIndLevelAndUse, axisInfoAnalysis);
+      assignMemoryLayouts(loadOpToIndLevelAndUse, numStages, axisInfoAnalysis);
 
   if (loadToInfo.empty())
     return {};
@@ -695,7 +685,7 @@ scheduleLoads(scf::ForOp forOp, CoarseSchedule &schedule,
   unsigned stagesBetweenLoads =
       ceil<unsigned>(numStages - 2, maxIndirectionLevel + 1);
 
-  CoarseSchedule::Cluster rootUsersCluster = schedule.clusters.newAtFront();
+  tt::CoarseSchedule::Cluster rootUsersCluster = schedule.clusters.newAtFront();
   // Put the root uses of the loads in the last stage.
   for (auto &[loadOp, dist, use] : loadOpToIndLevelAndUse) {
     if (loadToInfo.count(loadOp) == 0)
@@ -708,15 +698,19 @@ scheduleLoads(scf::ForOp forOp, CoarseSchedule &schedule,
     }
   }
 
-  SmallVector<CoarseSchedule::Cluster> loadsClusters;
+  SmallVector<tt::CoarseSchedule::Cluster> loadsClusters;
   for (int i = 0; i < maxIndirectionLevel + 1; i++) {
     loadsClusters.push_back(schedule.clusters.newAtBack());
   }
-  // Assign stages to the loads.
-  for (auto [loadOp, indLevel, _] : loadOpToIndLevelAndUse) {
+  // Assign stages to the loads. Loads asked for fewer stages are issued
+  // later, but never after the load that uses them.
+  for (auto [loadOp, indLevel, use] : loadOpToIndLevelAndUse) {
     if (loadToInfo.count(loadOp) == 0)
       continue;
     int stage = (maxIndirectionLevel - indLevel) * stagesBetweenLoads;
+    stage = std::max(stage, numStages - getLoadNumStages(loadOp, numStages));
+    if (isa<tt::LoadOp>(use) && schedule.count(use))
+      stage = std::min(stage, schedule[use].first);
     schedule.insert(loadOp, stage, loadsClusters[indLevel]);
   }
 
@@ -730,173 +724,6 @@ scheduleLoads(scf::ForOp forOp, CoarseSchedule &schedule,
   return loadToInfo;
 }
 
-// Schedule the prologue and epilogue `if` ops in the loop, pushing them as
-// close to the loop boundaries as possible. Return the cluster after the
-// prologue (or the beginning of the loop if there is no prologue).
-static CoarseSchedule::Cluster
-schedulePrologueAndEpilogue(scf::ForOp forOp, CoarseSchedule &schedule,
-                            DenseSet<Operation *> &rootUsers, int numStages) {
-  CoarseSchedule::Cluster afterPrologue = schedule.clusters.begin();
-
-  // Look for the IfOp that is in the backward slice any of the currently
-  // scheduled ops and put it at the beginning of the loop.
-  DenseMap<scf::IfOp, int> ifsToStage;
-  // Go stage by stage.
-  for (int stage = 0; stage < numStages; stage++) {
-    for (auto [op, stage_, cluster] : schedule.getOpsInOrder(forOp)) {
-      if (stage_ != stage)
-        continue;
-      SetVector<Operation *> backwardSlice;
-      BackwardSliceOptions opt;
-      opt.omitBlockArguments = true;
-      getBackwardSlice((Operation *)op, &backwardSlice, opt);
-
-      for (auto op : backwardSlice) {
-        if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
-          ifsToStage.insert({ifOp, stage});
-        }
-      }
-    }
-  }
-  CoarseSchedule::Cluster prologueCluster = schedule.clusters.newAtFront();
-  for (auto [ifOp, stage] : ifsToStage) {
-    schedule.insert(ifOp, stage, prologueCluster);
-  }
-
-  // Look for the IfOp that is in the forward slice of the root users and put it
-  // at the end of the loop.
-  CoarseSchedule::Cluster epilogueCluster = schedule.clusters.newAtBack();
-  for (auto rootUser : rootUsers) {
-    SetVector<Operation *> forwardSlice;
-    getForwardSlice(rootUser, &forwardSlice);
-
-    int stage = schedule[rootUser].first;
-    for (auto op : forwardSlice) {
-      scf::IfOp ifOp = dyn_cast<scf::IfOp>(op);
-      if (ifOp == nullptr) {
-        // check if the op is in the body of an if op that's part of the loop
-        auto parentOp = op->getParentOp();
-        if (parentOp != nullptr &&
-            parentOp->getParentOp() == forOp.getOperation()) {
-          ifOp = dyn_cast<scf::IfOp>(parentOp);
-        }
-      }
-      if (ifOp) {
-        schedule.insertIfAbsent(ifOp, stage,
-                                epilogueCluster); // after prefetch extracts
-      }
-    }
-  }
-  return afterPrologue;
-}
-
-// Add dependencies of anchor ops to the coarse schedule. Schedule them to
-// the same stage and ordering cluster as the anchor op.
-static void scheduleDependencies(scf::ForOp forOp, CoarseSchedule &schedule,
-                                 int numStages) {
-  SmallVector<std::tuple<Operation *, int, CoarseSchedule::Cluster>>
-      opsInOrder = schedule.getOpsInOrder(forOp);
-  // Schedule dependencies stage by stage.
-  for (int stage = 0; stage < numStages; stage++) {
-    for (auto [op, stage_, cluster] : opsInOrder) {
-      if (stage_ != stage)
-        continue;
-      schedule.insertDepsOfOp(op, stage, cluster, false);
-    }
-  }
-}
-
-// Find dependencies with distance of 1. They will go to the next stage,
-// but in the cluster before the current op.
-static void scheduleDistanceOneDependencies(scf::ForOp forOp,
-                                            CoarseSchedule &schedule,
-                                            int numStages) {
-  auto getNestedOperands = [](Operation *op) -> SmallVector<Value> {
-    SmallVector<Value> operands;
-    op->walk([&](Operation *nestedOp) {
-      for (Value operand : nestedOp->getOperands()) {
-        if (operand.getParentBlock()->getParentOp()->isAncestor(nestedOp))
-          operands.push_back(operand);
-      }
-    });
-    return operands;
-  };
-
-  // Mapping from the cluster to the cluster before it.
-  DenseMap<CoarseSchedule::Cluster *, CoarseSchedule::Cluster> dist1Cluster;
-  for (auto &op : forOp.getBody()->without_terminator()) {
-    if (schedule.count(&op) == 0)
-      continue;
-    auto [stage, cluster] = schedule[&op];
-    // Can't schedule past the last stage.
-    if (stage == numStages - 1)
-      continue;
-    for (Value operand : getNestedOperands(&op)) {
-      if (auto arg = dyn_cast<BlockArgument>(operand)) {
-        if (arg.getArgNumber() > 0 && arg.getOwner() == op.getBlock()) {
-          auto yieldOp = op.getBlock()->getTerminator();
-          Value v = yieldOp->getOperand(arg.getArgNumber() - 1);
-          Operation *defOp = v.getDefiningOp();
-          if (defOp && schedule.count(defOp) == 0) {
-            if (isa<tt::LoadOp>(defOp)) {
-              // Exception: Schedule loads with a distance of 1 together
-              // with the current op.
-              schedule.insertIfAbsent(defOp, stage, cluster);
-              schedule.insertDepsOfOp(defOp, stage, cluster, true);
-            } else {
-              if (dist1Cluster.count(&cluster) == 0) {
-                dist1Cluster[&cluster] = schedule.clusters.newBefore(cluster);
-              }
-              schedule.insertIfAbsent(defOp, stage + 1, dist1Cluster[&cluster]);
-              schedule.insertDepsOfOp(defOp, stage + 1, dist1Cluster[&cluster],
-                                      true);
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
-static void scheduleRemainingToLastStage(scf::ForOp forOp,
-                                         CoarseSchedule &schedule,
-                                         CoarseSchedule::Cluster afterPrologue,
-                                         int numStages) {
-  // Assign the rest of the ops to the last stage.
-  // Take care of the ordering of the ops - uses cannot be scheduled to the
-  // cluster before the definition.
-  DenseMap<Operation *, CoarseSchedule::Cluster> opToCluster;
-  for (auto &op : forOp.getBody()->without_terminator()) {
-    if (schedule.count(&op) == 0) {
-      opToCluster[&op] = afterPrologue;
-    }
-  }
-  SmallVector<Operation *> queue;
-  for (auto [op, stage, cluster] : schedule.getOpsInOrder(forOp)) {
-    // We really only care about the producers from the last stage.
-    // Others will be scheduled before these ops anyway.
-    if (stage == numStages - 1) {
-      queue.push_back(op);
-    }
-  }
-  while (!queue.empty()) {
-    Operation *op = queue.pop_back_val();
-    for (auto user : op->getUsers()) {
-      if (opToCluster.count(user)) {
-        CoarseSchedule::Cluster userCluster = opToCluster[user];
-        CoarseSchedule::Cluster opCluster = schedule[op].second;
-        if (*userCluster < *opCluster) {
-          opToCluster[user] = opCluster;
-          queue.push_back(user);
-        }
-      }
-    }
-  }
-  for (auto [op, cluster] : opToCluster) {
-    schedule.insert(op, numStages - 1, cluster);
-  }
-}
-
 // Create an allocation that can hold distance number of loadOp shapes.
 static Value createAlloc(scf::ForOp &forOp, Operation *loadOp,
                          ttg::SharedEncodingAttr sharedEnc, unsigned distance) {
@@ -950,13 +777,14 @@ struct AsyncLoad {
   Value barrier;
   Operation *waitOp = nullptr;
   bool isTMALoad = false;
+  int numBuffers = 0;
 };
 
 // Create barriers and wait ops for the async loads. Barriers may be shared by
 // multiple loads is the schedule allows it.
 static void createTMABarrierAndWait(
     scf::ForOp &forOp, SmallVector<AsyncLoad> &asyncLoads, Value insertIdx,
-    Value extractIdx, Value phase, int numBuffers, CoarseSchedule &schedule,
+    Value extractIdx, Value phase, int numBuffers, tt::CoarseSchedule &schedule,
     SmallVector<Value> &barriers,
     const llvm::MapVector<Operation *, LoadInfo> &loadToInfo) {
   llvm::SmallDenseMap<Operation *, AsyncLoad *> loadToAsyncLoad;
@@ -1059,57 +887,67 @@ static void createTMABarrierAndWait(
 // Convert load ops into their asyn version and apply multi-buffering based on
 // the required number of buffers.
 static SmallVector<Value>
-createAsyncOps(scf::ForOp &forOp, CoarseSchedule &schedule,
+createAsyncOps(scf::ForOp &forOp, tt::CoarseSchedule &schedule,
                llvm::MapVector<Operation *, LoadInfo> &loadToInfo,
                SmallVector<Value> &barriers, int numStages) {
-  // Calculate the number of buffers needed for each load.
-  // TODO pawel: we could do more fine-grained allocation here and
-  // allocate only the number of buffers that specific loads need.
-  // Instead, we allocate the maximum number of buffers needed by any load.
-  int numBuffers =
-      llvm::max_element(llvm::make_second_range(loadToInfo), [](auto &lhs,
-                                                                auto &rhs) {
-        return lhs.distToUse < rhs.distToUse;
-      })->distToUse;
+  // Calculate the number of buffers needed for each load. Loads pipelined
+  // with fewer stages than the loop need fewer buffers. TMA loads share their
+  // phase, so they all get the largest number of buffers.
+  int maxNumBuffers = 0;
+  for (auto &[loadOp, info] : loadToInfo) {
+    if (!info.inRegisters)
+      maxNumBuffers = std::max(maxNumBuffers, info.distToUse);
+  }
   bool hasMMAV3 =
       llvm::any_of(loadToInfo, [](auto &kv) { return kv.second.loadIsMMAV3; });
   if (hasMMAV3) {
     // For MMAv3, we need an extra buffer as this is assumed in the wgmma
     // pipelining post-processing.
-    numBuffers++;
+    maxNumBuffers++;
   };
 
   SmallVector<AsyncLoad> asyncLoads;
   SmallVector<Value> allocs;
+  // Loads with the same number of buffers share their counters.
+  SmallVector<int> bufferCounts;
   bool hasTMALoad = false;
   for (auto &[loadOp, info] : loadToInfo) {
+    if (info.inRegisters)
+      continue;
     assert(info.sharedEncoding && "LoadOp shared encoding not defined.");
+    bool isTMALoad = isa<tt::ExperimentalDescriptorLoadOp>(loadOp);
+    int numBuffers = maxNumBuffers;
+    if (!isTMALoad)
+      numBuffers = std::max(1, info.distToUse + (hasMMAV3 ? 1 : 0));
     Value alloc = createAlloc(forOp, loadOp, info.sharedEncoding, numBuffers);
     assert(alloc && "Failed to create alloc for the async load.");
     allocs.push_back(alloc);
     asyncLoads.emplace_back(loadOp, alloc);
-    if (isa<tt::ExperimentalDescriptorLoadOp>(loadOp)) {
+    asyncLoads.back().numBuffers = numBuffers;
+    if (!llvm::is_contained(bufferCounts, numBuffers))
+      bufferCounts.push_back(numBuffers);
+    if (isTMALoad) {
       hasTMALoad = true;
       asyncLoads.back().isTMALoad = true;
     }
   }
+  if (asyncLoads.empty())
+    return allocs;
 
   IRRewriter builder(forOp.getContext());
   builder.setInsertionPoint(forOp);
 
   Location loc = forOp.getLoc();
-  // Create two new counters to index into the allocs.
+  // Create two new counters per number of buffers to index into the allocs.
   Value minusOne = builder.create<arith::ConstantIntOp>(loc, -1, 32);
   Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
   Value one = builder.create<arith::ConstantIntOp>(loc, 1, 32);
-  Value insertIdx = minusOne;
-  Value extractIdx = minusOne;
   Value phase = Value();
-  Value numBuffersVal =
-      builder.create<arith::ConstantIntOp>(loc, numBuffers, 32);
   SmallVector<Value> newOperands;
-  newOperands.push_back(insertIdx);
-  newOperands.push_back(extractIdx);
+  for (int i = 0, e = bufferCounts.size(); i < e; ++i) {
+    newOperands.push_back(minusOne);
+    newOperands.push_back(minusOne);
+  }
   if (hasTMALoad) {
     phase = builder.create<arith::ConstantIntOp>(loc, 0, 32);
     newOperands.push_back(phase);
@@ -1120,36 +958,49 @@ createAsyncOps(scf::ForOp &forOp, CoarseSchedule &schedule,
       replaceForOpWithNewSignature(builder, forOp, newOperands);
   forOp.erase();
   forOp = newForOp;
-  insertIdx = newForOp.getBody()->getArgument(newOperandIndex);
-  extractIdx = newForOp.getBody()->getArgument(newOperandIndex + 1);
   if (phase) {
-    phase = newForOp.getBody()->getArgument(newOperandIndex + 2);
+    phase = newForOp.getBody()->getArgument(newOperandIndex +
+                                            2 * bufferCounts.size());
   }
 
   // Create two counters for the insert and extract indices to avoid creating
   // long liverange.
   builder.setInsertionPoint(newForOp.getBody(), newForOp.getBody()->begin());
-  insertIdx = builder.create<arith::AddIOp>(loc, insertIdx, one);
-  Value cndIns = builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
-                                               insertIdx, numBuffersVal);
-  insertIdx = builder.create<arith::SelectOp>(loc, cndIns, insertIdx, zero);
-
-  extractIdx = builder.create<arith::AddIOp>(loc, extractIdx, one);
-  Value cndExt = builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
-                                               extractIdx, numBuffersVal);
-  extractIdx = builder.create<arith::SelectOp>(loc, cndExt, extractIdx, zero);
+  llvm::SmallDenseMap<int, std::pair<Value, Value>> counters;
+  Value cndExtTMA;
+  for (auto [i, numBuffers] : llvm::enumerate(bufferCounts)) {
+    Value insertIdx = newForOp.getBody()->getArgument(newOperandIndex + 2 * i);
+    Value extractIdx =
+        newForOp.getBody()->getArgument(newOperandIndex + 2 * i + 1);
+    Value numBuffersVal =
+        builder.create<arith::ConstantIntOp>(loc, numBuffers, 32);
+    insertIdx = builder.create<arith::AddIOp>(loc, insertIdx, one);
+    Value cndIns = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::slt, insertIdx, numBuffersVal);
+    insertIdx = builder.create<arith::SelectOp>(loc, cndIns, insertIdx, zero);
+
+    extractIdx = builder.create<arith::AddIOp>(loc, extractIdx, one);
+    Value cndExt = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::slt, extractIdx, numBuffersVal);
+    extractIdx = builder.create<arith::SelectOp>(loc, cndExt, extractIdx, zero);
+    if (numBuffers == maxNumBuffers)
+      cndExtTMA = cndExt;
+    counters[numBuffers] = {insertIdx, extractIdx};
+  }
   if (phase) {
     Value nextPhase = builder.create<arith::XOrIOp>(loc, phase, one);
-    phase = builder.create<arith::SelectOp>(loc, cndExt, phase, nextPhase);
+    phase = builder.create<arith::SelectOp>(loc, cndExtTMA, phase, nextPhase);
+    auto [insertIdx, extractIdx] = counters[maxNumBuffers];
+    createTMABarrierAndWait(forOp, asyncLoads, insertIdx, extractIdx, phase,
+                            maxNumBuffers, schedule, barriers, loadToInfo);
   }
-  createTMABarrierAndWait(forOp, asyncLoads, insertIdx, extractIdx, phase,
-                          numBuffers, schedule, barriers, loadToInfo);
 
   // Create a cluster for the prefetches. It may end up being empty, but this
   // is OK.
-  CoarseSchedule::Cluster prefetchCluster = schedule.clusters.newAtBack();
+  tt::CoarseSchedule::Cluster prefetchCluster = schedule.clusters.newAtBack();
 
   for (AsyncLoad &asyncLoad : asyncLoads) {
+    auto [insertIdx, extractIdx] = counters[asyncLoad.numBuffers];
     if (auto loadOp = dyn_cast<tt::LoadOp>(asyncLoad.loadOp)) {
       createAsyncCopy(forOp, loadOp, asyncLoad.alloc, insertIdx, extractIdx,
                       schedule, prefetchCluster, loadToInfo, numStages);
@@ -1160,7 +1011,11 @@ createAsyncOps(scf::ForOp &forOp, CoarseSchedule &schedule,
                          schedule, loadToInfo, numStages);
     }
   }
-  SmallVector<Value> newYieldOperands = {insertIdx, extractIdx};
+  SmallVector<Value> newYieldOperands;
+  for (int numBuffers : bufferCounts) {
+    newYieldOperands.push_back(counters[numBuffers].first);
+    newYieldOperands.push_back(counters[numBuffers].second);
+  }
   if (phase)
     newYieldOperands.push_back(phase);
   // Patch the yield with the updated counters.
@@ -1190,13 +1045,15 @@ static void invalidateBarriers(OpBuilder &builder,
 }
 
 bool mlir::triton::preProcessLoopAndGetSchedule(
-    scf::ForOp &forOp, int numStages, mlir::triton::PipeliningOption &options) {
+    scf::ForOp &forOp, int numStages, mlir::triton::PipeliningOption &options,
+    ModuleAxisInfoAnalysis &axisInfoAnalysis) {
   // Schedule the loads and root ops (dot ops) in the loop. This will give us
   // a scaffold for the final schedule.
   DenseSet<Operation *> rootUsers;
-  CoarseSchedule coarseSchedule(numStages);
+  tt::CoarseSchedule coarseSchedule(numStages);
   llvm::MapVector<Operation *, LoadInfo> loadToInfo =
-      scheduleLoads(forOp, coarseSchedule, rootUsers, numStages);
+      scheduleLoads(forOp, coarseSchedule, rootUsers, numStages,
+                    axisInfoAnalysis);
   if (loadToInfo.empty())
     return false;
 
@@ -1215,26 +1072,28 @@ bool mlir::triton::preProcessLoopAndGetSchedule(
     coarseSchedule.dump();
   });
 
-  CoarseSchedule::Cluster afterPrologue =
-      schedulePrologueAndEpilogue(forOp, coarseSchedule, rootUsers, numStages);
+  tt::CoarseSchedule::Cluster afterPrologue =
+      tt::schedulePrologueAndEpilogue(forOp, coarseSchedule, rootUsers,
+                                      numStages);
   LLVM_DEBUG({
     LDBG("Coarse schedule with prologue and epilogue:");
     coarseSchedule.dump();
   });
 
-  scheduleDependencies(forOp, coarseSchedule, numStages);
+  tt::scheduleDependencies(forOp, coarseSchedule, numStages);
   LLVM_DEBUG({
     LDBG("Coarse schedule with dependencies:");
     coarseSchedule.dump();
   });
 
-  scheduleDistanceOneDependencies(forOp, coarseSchedule, numStages);
+  tt::scheduleDistanceOneDependencies(forOp, coarseSchedule, numStages);
   LLVM_DEBUG({
     LDBG("Coarse schedule with dist 1:");
     coarseSchedule.dump();
   });
 
-  scheduleRemainingToLastStage(forOp, coarseSchedule, afterPrologue, numStages);
+  tt::scheduleRemainingToLastStage(forOp, coarseSchedule, afterPrologue,
+                                   numStages);
   LLVM_DEBUG({
     LDBG("Final coarse schedule:");
     coarseSchedule.dump();
@@ -1269,30 +1128,108 @@ bool mlir::triton::preProcessLoopAndGetSchedule(
   return true;
 }
 
+static int minNumCommitsIn(Block &block);
+
+static bool runsAtLeastOnce(scf::ForOp forOp) {
+  auto lb = getConstantIntValue(forOp.getLowerBound());
+  auto ub = getConstantIntValue(forOp.getUpperBound());
+  return lb && ub && *lb < *ub;
+}
+
+/// The minimum number of async_commit_group ops that `op` executes, including
+/// the ones nested in its regions.
+static int minNumCommitsIn(Operation *op) {
+  if (isa<ttg::AsyncCommitGroupOp>(op))
+    return 1;
+  // Commits under a condition only count if both branches make them
+  if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+    if (!ifOp.elseBlock())
+      return 0;
+    return std::min(minNumCommitsIn(*ifOp.thenBlock()),
+                    minNumCommitsIn(*ifOp.elseBlock()));
+  }
+  // Loops that may not run make none, the others at least one iteration's
+  if (auto forOp = dyn_cast<scf::ForOp>(op))
+    return runsAtLeastOnce(forOp) ? minNumCommitsIn(*forOp.getBody()) : 0;
+  if (auto whileOp = dyn_cast<scf::WhileOp>(op))
+    return minNumCommitsIn(whileOp.getBefore().front());
+  return 0;
+}
+
+static int minNumCommitsIn(Block &block) {
+  int count = 0;
+  for (Operation &op : block)
+    count += minNumCommitsIn(&op);
+  return count;
+}
+
+/// The minimum number of async_commit_group ops executed from `begin` in
+/// `block` up to `sink`, which is either in `block` or nested in one of its
+/// ops, in which case the commits of the enclosing regions before `sink` count
+/// too.
+static int minNumCommitsBetween(Block *block, Block::iterator begin,
+                                Operation *sink) {
+  Operation *ancestor = block->findAncestorOpInBlock(*sink);
+  if (!ancestor)
+    return 0;
+  int count = 0;
+  for (auto it = begin; it != block->end() && &*it != ancestor; ++it)
+    count += minNumCommitsIn(&*it);
+  if (ancestor == sink)
+    return count;
+  for (Region &region : ancestor->getRegions()) {
+    for (Block &nested : region) {
+      if (nested.findAncestorOpInBlock(*sink))
+        return count + minNumCommitsBetween(&nested, nested.begin(), sink);
+    }
+  }
+  return count;
+}
+
 /// Find the minimum number of async_commit_group ops between the wait
 /// and the associated async_commit_group. This can be safely used as the wait
 /// number.
 static int minNumInterleavedCommitOps(Operation *waitOp) {
-  auto countCommitsBetween = [](Operation *op1, Operation *op2) {
-    int count = 0;
-    for (auto op = op1; op != op2; op = op->getNextNode()) {
-      if (isa<ttg::AsyncCommitGroupOp>(op))
-        count++;
-      // Intentionally skip block ops' children. This will give us
-      // convervatively low number of insert ops.
-    }
-    return count;
+  auto countCommitsBetween = [](Operation *op, Operation *sinkOp) {
+    return minNumCommitsBetween(op->getBlock(), std::next(op->getIterator()),
+                                sinkOp);
   };
 
   int minCommitNumber = INT_MAX;
+  // The loop arguments on the current path, which cycles through when the
+  // loop passes a token on unchanged
+  llvm::DenseSet<Value> onPath;
 
   // DFS the def chain of the extract op to find the insert op. On each path
   // we calculate the number of async_commit. Then we select the minimum number
-  // of async_commit ops among all the paths.
+  // of async_commit ops among all the paths. Tokens coming out of loops and
+  // branches are followed into the regions that yield them.
   std::function<int(Value, Operation *, int)> minOverHistories =
       [&](Value val, Operation *sinkOp, int thisHistorySum) -> int {
+    if (thisHistorySum >= minCommitNumber)
+      return minCommitNumber;
     if (Operation *defOp = val.getDefiningOp()) {
-      thisHistorySum += countCommitsBetween(defOp->getNextNode(), sinkOp);
+      thisHistorySum += countCommitsBetween(defOp, sinkOp);
+      unsigned resultIdx = cast<OpResult>(val).getResultNumber();
+      if (auto ifOp = dyn_cast<scf::IfOp>(defOp)) {
+        // the commits of the branch after the token was yielded count too
+        int min1 = minOverHistories(ifOp.thenYield().getOperand(resultIdx),
+                                    ifOp.thenYield(), thisHistorySum);
+        int min2 = minOverHistories(ifOp.elseYield().getOperand(resultIdx),
+                                    ifOp.elseYield(), thisHistorySum);
+        return std::min(min1, min2);
+      }
+      if (auto forOp = dyn_cast<scf::ForOp>(defOp)) {
+        Operation *yieldOp = forOp.getBody()->getTerminator();
+        int min1 = minOverHistories(yieldOp->getOperand(resultIdx), yieldOp,
+                                    thisHistorySum);
+        if (runsAtLeastOnce(forOp))
+          return min1;
+        // the loop may not run
+        int min2 = minOverHistories(forOp.getInitArgs()[resultIdx], forOp,
+                                    thisHistorySum);
+        return std::min(min1, min2);
+      }
       minCommitNumber = std::min(minCommitNumber, thisHistorySum);
       return minCommitNumber;
     }
@@ -1301,14 +1238,16 @@ static int minNumInterleavedCommitOps(Operation *waitOp) {
       auto forOp = dyn_cast<scf::ForOp>(block->getParentOp());
 
       // Failed to track, return 0 conservatively.
-      if (!forOp)
+      if (!forOp) {
+        minCommitNumber = 0;
         return 0;
+      }
+      // A token passed on unchanged adds no history
+      if (!onPath.insert(val).second)
+        return minCommitNumber;
 
-      Operation *firstForInst = &*forOp.getBody()->begin();
-      int insertsBetween = countCommitsBetween(firstForInst, sinkOp);
+      int insertsBetween = minNumCommitsBetween(block, block->begin(), sinkOp);
       thisHistorySum += insertsBetween;
-      if (thisHistorySum >= minCommitNumber)
-        return minCommitNumber;
 
       // get the value value assigned to the argument coming from outside the
       // loop
@@ -1320,16 +1259,20 @@ static int minNumInterleavedCommitOps(Operation *waitOp) {
       Operation *yieldOp = block->getTerminator();
       Value prevVal = yieldOp->getOperand(arg.getArgNumber() - 1);
       int min2 = minOverHistories(prevVal, yieldOp, thisHistorySum);
+      onPath.erase(val);
       return std::min(std::min(min1, min2), minCommitNumber);
     }
     // Failed to track, return 0 conservatively.
+    minCommitNumber = 0;
     return 0;
   };
 
-  if (waitOp->getNumOperands() != 1)
+  // Every group of the wait has to be done
+  if (waitOp->getNumOperands() == 0)
     return 0;
-  int minCommits = minOverHistories(waitOp->getOperand(0), waitOp, 0);
-  return minCommits;
+  for (Value token : waitOp->getOperands())
+    minOverHistories(token, waitOp, 0);
+  return minCommitNumber == INT_MAX ? 0 : minCommitNumber;
 }
 
 // Look for consecutive wait ops and combine them into a single wait op.
@@ -1409,6 +1352,8 @@ void mlir::triton::updateWaits(ModuleOp module) {
 //
 // Specifically, this function finds all warp_group_dot ops that elements of
 // `values` depend on.  Then it adds the MemDesc operands of those dots to the
+// wait.  An lhs in registers computed in the wait's block is added as well:
+// wgmma reads its registers asynchronously, so they must stay alive until the
 // wait.
 static void threadValuesThroughWait(ttng::WarpGroupDotWaitOp wait,
                                     MutableArrayRef<Value> values) {
@@ -1448,6 +1393,10 @@ static void threadValuesThroughWait(ttng::WarpGroupDotWaitOp wait,
         newOperands.insert(operand);
       }
     }
+    Value lhs = dot.getA();
+    if (!isa<tt::MemDescType>(lhs.getType()) &&
+        lhs.getParentBlock() == wait->getBlock())
+      newOperands.insert(lhs);
   }
 
   // We can't use replaceWithNewOp because we're changing the number of return
@@ -1522,7 +1471,16 @@ static std::optional<int> dotCanBeProperlyAsync(ttng::WarpGroupDotOp dotOp,
   auto checkOperand = [&](Value operand) {
     if (!isa<ttg::SharedEncodingAttr>(
             cast<TensorOrMemDesc>(operand.getType()).getEncoding())) {
-      return true;
+      // Rule 1a: The registers of an lhs in registers are read asynchronously
+      // too, so they must not be rewritten by the next iteration.  The lhs of
+      // a chained dot is fine, as it is computed after the `wait 0` of the
+      // first dot.
+      if (auto cvt = operand.getDefiningOp<ttg::ConvertLayoutOp>()) {
+        if (isa<ttg::NvidiaMmaEncodingAttr>(
+                cvt.getSrc().getType().getEncoding()))
+          return true;
+      }
+      return forOp.isDefinedOutsideOfLoop(operand);
     }
 
     // If it's a shmem operand, it must either be defined outside the loop, or
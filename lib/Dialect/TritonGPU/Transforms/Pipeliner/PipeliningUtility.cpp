@@ -1,6 +1,7 @@
-#include "PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
 
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
@@ -40,6 +41,16 @@ Operation *mlir::triton::predicateOp(RewriterBase &rewriter, Operation *op,
     return op;
   if (isa<ttg::LocalLoadOp>(op))
     return op;
+  // Local stores have no mask. The store of a predicated-off iteration would
+  // write values loaded under a false mask into a buffer slot, which may be
+  // the one that the live iterations read when there is a single buffer.
+  if (auto storeOp = dyn_cast<ttg::LocalStoreOp>(op)) {
+    rewriter.setInsertionPoint(storeOp);
+    auto ifOp = rewriter.create<scf::IfOp>(storeOp.getLoc(), pred,
+                                           /*withElseRegion=*/false);
+    rewriter.moveOpBefore(storeOp, ifOp.thenBlock()->getTerminator());
+    return ifOp;
+  }
   if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
     rewriter.setInsertionPoint(op);
     Value cnd = getPredMask(rewriter, ifOp.getCondition().getType(),
@@ -121,3 +132,114 @@ void mlir::triton::addOps(
     schedule.emplace_back(&op, stage);
   }
 }
+
+// Rewrite
+//   scf.while (%i = %lb, %x = %init) {
+//     %c = arith.cmpi slt, %i, %ub
+//     scf.condition(%c) %i, %x
+//   } do {
+//   ^bb0(%i, %x):
+//     ...
+//     %next = arith.addi %i, %step
+//     scf.yield %next, %x'
+//   }
+// into
+//   scf.for %i = %lb to %ub step %step iter_args(%x = %init) {
+//     ...
+//     scf.yield %x'
+//   }
+// The final value of the induction variable is only carried along when it is
+// used after the loop.
+FailureOr<scf::ForOp>
+mlir::triton::convertWhileToFor(RewriterBase &rewriter, scf::WhileOp whileOp) {
+  Block *before = whileOp.getBeforeBody();
+  Block *after = whileOp.getAfterBody();
+  scf::ConditionOp condOp = whileOp.getConditionOp();
+  // The before region must only compare the induction variable and forward
+  // the loop-carried values unchanged.
+  if (before->getOperations().size() != 2 ||
+      !llvm::equal(condOp.getArgs(), before->getArguments()))
+    return failure();
+  auto cmpOp = dyn_cast<arith::CmpIOp>(&before->front());
+  if (!cmpOp || condOp.getCondition() != cmpOp.getResult())
+    return failure();
+  Value iv, ub;
+  if (cmpOp.getPredicate() == arith::CmpIPredicate::slt) {
+    iv = cmpOp.getLhs();
+    ub = cmpOp.getRhs();
+  } else if (cmpOp.getPredicate() == arith::CmpIPredicate::sgt) {
+    iv = cmpOp.getRhs();
+    ub = cmpOp.getLhs();
+  } else {
+    return failure();
+  }
+  auto ivArg = dyn_cast<BlockArgument>(iv);
+  if (!ivArg || ivArg.getOwner() != before ||
+      !ub.getParentRegion()->isAncestor(whileOp->getParentRegion()))
+    return failure();
+  unsigned ivIdx = ivArg.getArgNumber();
+
+  scf::YieldOp yieldOp = whileOp.getYieldOp();
+  auto addOp = yieldOp.getOperand(ivIdx).getDefiningOp<arith::AddIOp>();
+  if (!addOp || addOp->getBlock() != after)
+    return failure();
+  Value afterIv = after->getArgument(ivIdx);
+  Value stepOperand = addOp.getLhs() == afterIv ? addOp.getRhs()
+                                                : addOp.getLhs();
+  APInt step;
+  if ((addOp.getLhs() != afterIv && addOp.getRhs() != afterIv) ||
+      !matchPattern(stepOperand, m_ConstantInt(&step)) ||
+      !step.isStrictlyPositive())
+    return failure();
+
+  Location loc = whileOp.getLoc();
+  bool keepIv = !whileOp.getResult(ivIdx).use_empty();
+  SmallVector<Value> inits;
+  for (auto [i, init] : llvm::enumerate(whileOp.getInits())) {
+    if (i != ivIdx)
+      inits.push_back(init);
+  }
+  Value lb = whileOp.getInits()[ivIdx];
+  if (keepIv)
+    inits.push_back(lb);
+  rewriter.setInsertionPoint(whileOp);
+  Value stepValue = rewriter.create<arith::ConstantOp>(
+      loc, rewriter.getIntegerAttr(iv.getType(), step));
+  auto forOp = rewriter.create<scf::ForOp>(loc, lb, ub, stepValue, inits);
+  forOp->setDiscardableAttrs(whileOp->getDiscardableAttrDictionary());
+
+  Block *body = forOp.getBody();
+  if (!body->empty())
+    rewriter.eraseOp(body->getTerminator());
+  SmallVector<Value> argReplacements;
+  auto iterArgs = forOp.getRegionIterArgs();
+  for (unsigned i = 0, j = 0; i < after->getNumArguments(); ++i)
+    argReplacements.push_back(i == ivIdx ? forOp.getInductionVar()
+                                         : iterArgs[j++]);
+  rewriter.mergeBlocks(after, body, argReplacements);
+
+  SmallVector<Value> yields;
+  for (auto [i, operand] : llvm::enumerate(yieldOp.getOperands())) {
+    if (i != ivIdx)
+      yields.push_back(operand);
+  }
+  if (keepIv)
+    yields.push_back(addOp.getResult());
+  rewriter.setInsertionPoint(yieldOp);
+  rewriter.replaceOpWithNewOp<scf::YieldOp>(yieldOp, yields);
+  if (addOp->use_empty())
+    rewriter.eraseOp(addOp);
+
+  SmallVector<Value> results;
+  for (unsigned i = 0, j = 0; i < whileOp.getNumResults(); ++i)
+    results.push_back(i == ivIdx ? Value() : forOp.getResult(j++));
+  if (keepIv)
+    results[ivIdx] = forOp.getResults().back();
+  for (auto [oldResult, newResult] :
+       llvm::zip(whileOp.getResults(), results)) {
+    if (newResult)
+      rewriter.replaceAllUsesWith(oldResult, newResult);
+  }
+  rewriter.eraseOp(whileOp);
+  return forOp;
+}
@@ -0,0 +1,233 @@
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "llvm/Support/Debug.h"
+
+//===----------------------------------------------------------------------===//
+// This file creates the schedule of the loops of targets without asynchronous
+// copies, on top of the CoarseSchedule/PipelineExpander infrastructure.
+//
+// Global loads feeding dot operands are staged through shared memory:
+// a. Global loads (global -> registers) are issued in stage 0.
+// b. Local stores (registers -> shared) happen in stage numStages - 2.
+// c. Local loads (shared -> registers) and the dots happen in the last stage.
+//
+// With two stages the next tile is prefetched into registers and stored into
+// a single buffer once the current tile has been consumed. With more stages,
+// up to numStages - 2 tiles are in flight in registers and the buffer is
+// doubled so that the next tile can be stored before the current one is read.
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "triton-register-staged-pipeline"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+using namespace mlir;
+namespace tt = mlir::triton;
+namespace ttg = mlir::triton::gpu;
+
+namespace {
+
+struct StagedLoad {
+  StagedLoad(tt::LoadOp loadOp, ttg::ConvertLayoutOp cvtOp)
+      : loadOp(loadOp), cvtOp(cvtOp) {}
+  tt::LoadOp loadOp;
+  // Conversion of the loaded value to a dot operand layout.
+  ttg::ConvertLayoutOp cvtOp;
+  Value alloc;
+};
+
+} // namespace
+
+// Collect the loads whose only use is a conversion to a dot operand layout.
+// Those are the ones worth staging through shared memory.
+static SmallVector<StagedLoad> collectStagedLoads(scf::ForOp forOp) {
+  SmallVector<StagedLoad> loads;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    auto loadOp = dyn_cast<tt::LoadOp>(op);
+    if (!loadOp || !loadOp->hasOneUse())
+      continue;
+    auto loadTy = dyn_cast<RankedTensorType>(loadOp.getType());
+    if (!loadTy)
+      continue;
+    auto cvtOp = dyn_cast<ttg::ConvertLayoutOp>(*loadOp->getUsers().begin());
+    if (!cvtOp || cvtOp->getBlock() != loadOp->getBlock())
+      continue;
+    if (!isa<ttg::DotOperandEncodingAttr>(cvtOp.getType().getEncoding()))
+      continue;
+    LDBG("Staged load " << *loadOp);
+    loads.emplace_back(loadOp, cvtOp);
+  }
+  return loads;
+}
+
+// Create an allocation that can hold `numBuffers` tiles of the loaded shape.
+static Value createAlloc(scf::ForOp forOp, StagedLoad &load,
+                         unsigned numBuffers) {
+  OpBuilder builder(forOp);
+  auto ty = cast<RankedTensorType>(load.loadOp.getType());
+  auto dotOpEnc =
+      cast<ttg::DotOperandEncodingAttr>(load.cvtOp.getType().getEncoding());
+  auto sharedEnc = ttg::SharedEncodingAttr::get(
+      ty.getContext(), dotOpEnc, ty.getShape(),
+      ttg::getOrder(ty.getEncoding()), ttg::getCTALayout(ty.getEncoding()),
+      ty.getElementType());
+  SmallVector<int64_t> bufferShape(ty.getShape().begin(), ty.getShape().end());
+  bufferShape.insert(bufferShape.begin(), numBuffers);
+  Type memDescType = tt::MemDescType::get(
+      bufferShape, ty.getElementType(), sharedEnc,
+      ttg::SharedMemorySpaceAttr::get(ty.getContext()),
+      /*mutableMemory=*/true);
+  return builder.create<ttg::LocalAllocOp>(load.loadOp.getLoc(), memDescType,
+                                           Value());
+}
+
+// Return a view of the `idx`-th tile of a multi-buffered allocation.
+static Value createSubview(OpBuilder &builder, Location loc, Value alloc,
+                           Value idx) {
+  auto allocTy = cast<tt::MemDescType>(alloc.getType());
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  SmallVector<Value> offsets(allocTy.getRank(), zero);
+  offsets[0] = idx;
+  auto viewTy = tt::MemDescType::get(
+      allocTy.getShape().drop_front(), allocTy.getElementType(),
+      allocTy.getEncoding(), allocTy.getMemorySpace(), /*mutableMemory=*/true);
+  return builder.create<ttg::MemDescSubviewOp>(loc, viewTy, alloc, offsets);
+}
+
+// Increment a buffer index, wrapping around at `numBuffers`.
+static Value createNextIndex(OpBuilder &builder, Location loc, Value idx,
+                             Value numBuffers) {
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  Value one = builder.create<arith::ConstantIntOp>(loc, 1, 32);
+  Value next = builder.create<arith::AddIOp>(loc, idx, one);
+  Value inRange = builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt,
+                                                next, numBuffers);
+  return builder.create<arith::SelectOp>(loc, inRange, next, zero);
+}
+
+// Replace the ForOp's yield with a new one with the given operands appended.
+static void appendToYield(scf::ForOp forOp, ArrayRef<Value> newOperands) {
+  Operation *yieldOp = forOp.getBody()->getTerminator();
+  SmallVector<Value> operands(yieldOp->getOperands());
+  operands.append(newOperands.begin(), newOperands.end());
+
+  OpBuilder builder(yieldOp);
+  builder.create<scf::YieldOp>(yieldOp->getLoc(), operands);
+  yieldOp->erase();
+}
+
+bool tt::getRegisterStagedSchedule(scf::ForOp &forOp, int numStages,
+                                   tt::PipeliningOption &options) {
+  SmallVector<StagedLoad> loads = collectStagedLoads(forOp);
+  if (loads.empty())
+    return false;
+
+  // With two stages the store of the next tile is placed after the current
+  // tile has been consumed, so a single buffer is enough.
+  unsigned numBuffers = numStages > 2 ? 2 : 1;
+  SmallVector<Value> allocs;
+  for (StagedLoad &load : loads) {
+    load.alloc = createAlloc(forOp, load, numBuffers);
+    allocs.push_back(load.alloc);
+  }
+
+  // Add the insert and extract indices as loop-carried values.
+  IRRewriter builder(forOp.getContext());
+  builder.setInsertionPoint(forOp);
+  Location loc = forOp.getLoc();
+  Value minusOne = builder.create<arith::ConstantIntOp>(loc, -1, 32);
+  Value numBuffersVal =
+      builder.create<arith::ConstantIntOp>(loc, numBuffers, 32);
+  SmallVector<Value> newOperands = {minusOne, minusOne};
+  unsigned newOperandIndex = forOp.getBody()->getNumArguments();
+  scf::ForOp newForOp =
+      replaceForOpWithNewSignature(builder, forOp, newOperands);
+  forOp.erase();
+  forOp = newForOp;
+
+  builder.setInsertionPointToStart(forOp.getBody());
+  Value insertIdx = createNextIndex(
+      builder, loc, forOp.getBody()->getArgument(newOperandIndex),
+      numBuffersVal);
+  Value extractIdx = createNextIndex(
+      builder, loc, forOp.getBody()->getArgument(newOperandIndex + 1),
+      numBuffersVal);
+
+  tt::CoarseSchedule schedule(numStages);
+  tt::CoarseSchedule::Cluster loadCluster = schedule.clusters.newAtBack();
+  tt::CoarseSchedule::Cluster storeCluster;
+  tt::CoarseSchedule::Cluster computeCluster;
+  if (numStages > 2) {
+    storeCluster = schedule.clusters.newAtBack();
+    computeCluster = schedule.clusters.newAtBack();
+  } else {
+    computeCluster = schedule.clusters.newAtBack();
+    storeCluster = schedule.clusters.newAtBack();
+  }
+
+  DenseSet<Operation *> rootUsers;
+  for (StagedLoad &load : loads) {
+    tt::LoadOp loadOp = load.loadOp;
+    schedule.insert(loadOp, 0, loadCluster);
+
+    builder.setInsertionPointAfter(loadOp);
+    Value storeView =
+        createSubview(builder, loadOp.getLoc(), load.alloc, insertIdx);
+    auto storeOp = builder.create<ttg::LocalStoreOp>(loadOp.getLoc(),
+                                                     loadOp, storeView);
+    schedule.insert(storeView.getDefiningOp(), numStages - 2, storeCluster);
+    schedule.insert(storeOp, numStages - 2, storeCluster);
+
+    builder.setInsertionPoint(load.cvtOp);
+    Value loadView =
+        createSubview(builder, load.cvtOp.getLoc(), load.alloc, extractIdx);
+    auto localLoad = builder.create<ttg::LocalLoadOp>(
+        load.cvtOp.getLoc(), load.cvtOp.getType(), loadView);
+    schedule.insert(loadView.getDefiningOp(), numStages - 1, computeCluster);
+    schedule.insert(localLoad, numStages - 1, computeCluster);
+    load.cvtOp.replaceAllUsesWith(localLoad.getResult());
+    load.cvtOp.erase();
+
+    for (Operation *user : localLoad->getUsers()) {
+      if (user->getBlock() != forOp.getBody() ||
+          !user->hasTrait<OpTrait::DotLike>())
+        continue;
+      schedule.insertIfAbsent(user, numStages - 1, computeCluster);
+      rootUsers.insert(user);
+    }
+  }
+  appendToYield(forOp, {insertIdx, extractIdx});
+
+  tt::CoarseSchedule::Cluster afterPrologue =
+      tt::schedulePrologueAndEpilogue(forOp, schedule, rootUsers, numStages);
+  tt::scheduleDependencies(forOp, schedule, numStages);
+  tt::scheduleDistanceOneDependencies(forOp, schedule, numStages);
+  tt::scheduleRemainingToLastStage(forOp, schedule, afterPrologue, numStages);
+  LLVM_DEBUG({
+    LDBG("Final coarse schedule:");
+    schedule.dump();
+  });
+
+  std::vector<std::pair<Operation *, unsigned>> finalSchedule =
+      schedule.createFinalSchedule(forOp);
+  options.getScheduleFn =
+      [finalSchedule](scf::ForOp forOp,
+                      std::vector<std::pair<Operation *, unsigned>> &s) {
+        s = std::move(finalSchedule);
+      };
+  options.peelEpilogue = false;
+  options.predicateFn = tt::predicateOp;
+  options.supportDynamicLoops = true;
+  options.annotateFn = [](Operation *op, tt::PipeliningOption::PipelinerPart,
+                          unsigned) {};
+
+  // Release the buffers once the loop is done.
+  builder.setInsertionPointAfter(forOp);
+  for (Value alloc : allocs)
+    builder.create<ttg::LocalDeallocOp>(forOp.getLoc(), alloc);
+  return true;
+}
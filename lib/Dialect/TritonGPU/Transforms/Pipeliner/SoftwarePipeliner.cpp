@@ -1,6 +1,3 @@
-#include "PipelineExpander.h"
-#include "PipeliningUtility.h"
-#include "Schedule.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/TypeUtilities.h"
@@ -9,8 +6,12 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Analysis/Utility.h"
+#include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
@@ -23,7 +24,8 @@
 // modulo schedule and an expander that rewrites the loop and emits a prologue
 // and epilogue. This pass first calls a helper that will pre-process the IR
 // to create async operations and create a modulo schedule. Then we call the
-// expander to generate the prologue and new loop.
+// expander to generate the prologue and new loop. Targets without async copies
+// stage the loads through registers instead.
 //===----------------------------------------------------------------------===//
 
 namespace mlir {
@@ -57,6 +59,14 @@ static bool preCondition(scf::ForOp forOp) {
   return true;
 }
 
+// cp.async is only available from sm80 on.
+static bool hasAsyncCopy(ModuleOp mod) {
+  auto target = mod->getAttrOfType<StringAttr>(AttrTargetName);
+  if (!target || !target.getValue().starts_with("cuda:"))
+    return true;
+  return getNVIDIAComputeCapability(mod) >= 80;
+}
+
 static void tryAndPipelineOuterLoop(scf::ForOp forOp) {
   mlir::triton::PipeliningOption options;
   bool foundSchedule = false;
@@ -70,13 +80,19 @@ static void tryAndPipelineOuterLoop(scf::ForOp forOp) {
       mlir::triton::pipelineForLoop(rewriter, forOp, options);
 }
 
-static bool pipelineLoop(scf::ForOp forOp, int numStages) {
+static bool pipelineLoop(scf::ForOp forOp, int numStages,
+                         ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                         bool asyncCopy) {
   mlir::triton::PipeliningOption options;
   if (!preCondition(forOp))
     return false;
 
   bool foundSchedule = false;
-  foundSchedule = preProcessLoopAndGetSchedule(forOp, numStages, options);
+  if (asyncCopy)
+    foundSchedule = preProcessLoopAndGetSchedule(forOp, numStages, options,
+                                                 axisInfoAnalysis);
+  else
+    foundSchedule = getRegisterStagedSchedule(forOp, numStages, options);
 
   // TODO: add more pipelines strategy.
   if (!foundSchedule)
@@ -97,17 +113,32 @@ struct PipelinePass : public impl::TritonGPUPipelineBase<PipelinePass> {
 
   using impl::TritonGPUPipelineBase<PipelinePass>::TritonGPUPipelineBase;
 
-  int getNumStagesOrDefault(scf::ForOp forOp) {
+  int getNumStagesOrDefault(Operation *loop) {
     // Use the attribute attached to the loop if it exists otherwise use the
     // global control.
-    if (!forOp->hasAttr(mlir::triton::kNumStagesAttrName))
+    if (!loop->hasAttr(mlir::triton::kNumStagesAttrName))
       return numStages;
     return mlir::cast<IntegerAttr>(
-               forOp->getAttr(mlir::triton::kNumStagesAttrName))
+               loop->getAttr(mlir::triton::kNumStagesAttrName))
         .getInt();
   }
 
+  // Loops over block tables and ragged sequences are emitted as while loops
+  // with a dynamic bound. Turn the counted ones into for loops so that the
+  // rest of the pass pipelines them like any other loop.
+  void convertWhileLoops() {
+    SmallVector<scf::WhileOp> whileLoops;
+    getOperation()->walk([&](scf::WhileOp whileOp) {
+      if (getNumStagesOrDefault(whileOp) > 1)
+        whileLoops.push_back(whileOp);
+    });
+    IRRewriter rewriter(getOperation().getContext());
+    for (scf::WhileOp whileOp : whileLoops)
+      (void)mlir::triton::convertWhileToFor(rewriter, whileOp);
+  }
+
   void runOnOperation() override {
+    convertWhileLoops();
     SmallVector<scf::ForOp> loops;
     getOperation()->walk([&](scf::ForOp forOp) {
       // Bail out for loops with num_stage <= 1.
@@ -118,12 +149,17 @@ struct PipelinePass : public impl::TritonGPUPipelineBase<PipelinePass> {
     if (loops.empty())
       return;
 
+    auto &axisInfoAnalysis = getAnalysis<ModuleAxisInfoAnalysis>();
+    bool asyncCopy = hasAsyncCopy(getOperation());
     llvm::SmallSetVector<scf::ForOp, 8> outerLoops;
     for (scf::ForOp forOp : loops) {
       auto outerLoop = dyn_cast<scf::ForOp>(forOp->getParentOp());
       int loopNumStages = getNumStagesOrDefault(forOp);
-      bool pipelined = pipelineLoop(forOp, loopNumStages);
-      if (pipelined && outerLoop && getNumStagesOrDefault(outerLoop) > 1)
+      bool pipelined =
+          pipelineLoop(forOp, loopNumStages, axisInfoAnalysis, asyncCopy);
+      // The outer loop schedule overlaps async copies with the epilogue.
+      if (pipelined && asyncCopy && outerLoop &&
+          getNumStagesOrDefault(outerLoop) > 1)
         outerLoops.insert(outerLoop);
     }
 
@@ -1,5 +1,7 @@
-#include "Schedule.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 
 using namespace mlir;
@@ -27,8 +29,19 @@ getTMAStores(scf::ForOp forOp) {
   return tmaStores;
 }
 
+// Upper bound on the shared memory spent on double-buffering the staging
+// buffers of TMA stores. Past this we fall back to a single buffer per store
+// rather than competing with the mainloop buffers.
+static constexpr int64_t kMaxDoubleBufferedBytes = 64 * 1024;
+
+static int64_t getStagingBytes(tt::ExperimentalDescriptorStoreOp storeOp) {
+  auto ty = cast<RankedTensorType>(storeOp.getSrc().getType());
+  return product(ty.getShape()) * ty.getElementTypeBitWidth() / 8;
+}
+
 static Value createAlloc(scf::ForOp &forOp,
-                         tt::ExperimentalDescriptorStoreOp storeOp) {
+                         tt::ExperimentalDescriptorStoreOp storeOp,
+                         unsigned numBuffers) {
   OpBuilder builder(forOp);
   auto ty = cast<RankedTensorType>(storeOp.getSrc().getType());
   auto order = ttg::getOrder(ty.getEncoding());
@@ -41,30 +54,71 @@ static Value createAlloc(scf::ForOp &forOp,
   }
   Attribute sharedMemorySpace =
       triton::gpu::SharedMemorySpaceAttr::get(ty.getContext());
+  SmallVector<int64_t> bufferShape(ty.getShape());
+  if (numBuffers > 1)
+    bufferShape.insert(bufferShape.begin(), numBuffers);
   Type memdescType =
-      tt::MemDescType::get(ty.getShape(), ty.getElementType(), encoding,
+      tt::MemDescType::get(bufferShape, ty.getElementType(), encoding,
                            sharedMemorySpace, /*mutableMemory*/ true);
   Value alloc = builder.create<ttg::LocalAllocOp>(storeOp->getLoc(),
                                                   memdescType, Value());
   return alloc;
 }
 
+// Returns the index of the staging buffer used by the current iteration,
+// i.e. ((iv - lb) / step) % numBuffers as an i32.
+static Value createBufferIndex(scf::ForOp forOp, unsigned numBuffers) {
+  OpBuilder builder = OpBuilder::atBlockBegin(forOp.getBody());
+  Location loc = forOp.getLoc();
+  Value iv = forOp.getInductionVar();
+  Value iter = builder.create<arith::DivSIOp>(
+      loc, builder.create<arith::SubIOp>(loc, iv, forOp.getLowerBound()),
+      forOp.getStep());
+  Value idx = builder.create<arith::RemSIOp>(
+      loc, iter,
+      builder.create<arith::ConstantOp>(
+          loc, builder.getIntegerAttr(iv.getType(), numBuffers)));
+  Type i32Ty = builder.getI32Type();
+  if (idx.getType().isIndex())
+    return builder.create<arith::IndexCastOp>(loc, i32Ty, idx);
+  unsigned width = idx.getType().getIntOrFloatBitWidth();
+  if (width > 32)
+    return builder.create<arith::TruncIOp>(loc, i32Ty, idx);
+  if (width < 32)
+    return builder.create<arith::ExtSIOp>(loc, i32Ty, idx);
+  return idx;
+}
+
 static void createTMAAsyncCopy(scf::ForOp &forOp,
                                tt::ExperimentalDescriptorStoreOp storeOp,
-                               Value alloc) {
+                               Value alloc, Value bufferIdx, int pendings) {
   OpBuilder builder(storeOp);
   auto loc = storeOp.getLoc();
-  auto ty = cast<RankedTensorType>(storeOp.getSrc().getType());
-  auto order = ttg::getOrder(ty.getEncoding());
-  auto ctaLayout = ttg::getCTALayout(ty.getEncoding());
+
+  Value buffer = alloc;
+  if (bufferIdx) {
+    auto allocTy = cast<tt::MemDescType>(alloc.getType());
+    auto bufferTy = tt::MemDescType::get(
+        allocTy.getShape().drop_front(), allocTy.getElementType(),
+        allocTy.getEncoding(), allocTy.getMemorySpace(),
+        /*mutableMemory=*/true);
+    Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+    SmallVector<Value> offsets(allocTy.getRank(), zero);
+    offsets[0] = bufferIdx;
+    buffer =
+        builder.create<ttg::MemDescSubviewOp>(loc, bufferTy, alloc, offsets);
+  }
 
   // Put wait before the local_store make the store truly async. We know
-  // that we are the only user of the CopyLocalToGlobal.
-  builder.create<ttng::TMAStoreWait>(loc, 0);
-  builder.create<ttg::LocalStoreOp>(loc, storeOp.getSrc(), alloc);
+  // that we are the only user of the CopyLocalToGlobal. Only the copy that
+  // last read this buffer needs to be done; `pendings` counts the copies
+  // issued since then.
+  builder.create<ttng::TMAStoreWait>(loc, pendings);
+  builder.create<ttg::LocalStoreOp>(loc, storeOp.getSrc(), buffer);
   builder.create<ttng::FenceAsyncSharedOp>(loc, false);
   builder.create<ttng::AsyncTMACopyLocalToGlobalOp>(
-      loc, storeOp.getDescPtr(), storeOp.getIndices(), alloc);
+      loc, storeOp.getDescPtr(), storeOp.getIndices(), buffer,
+      storeOp.getReduceKindAttr());
 
   storeOp->erase();
 }
@@ -75,13 +129,31 @@ bool mlir::triton::pipelineTMAStores(scf::ForOp forOp) {
   if (tmaStores.empty())
     return false;
 
+  // The number of copies issued per iteration is only known statically when
+  // every store executes unconditionally. Otherwise wait for all of them.
+  bool unconditional = llvm::all_of(tmaStores, [&](auto storeOp) {
+    return storeOp->getParentOp() == forOp.getOperation();
+  });
+  int64_t stagingBytes = 0;
+  for (tt::ExperimentalDescriptorStoreOp op : tmaStores)
+    stagingBytes += getStagingBytes(op);
+  unsigned numBuffers =
+      unconditional && 2 * stagingBytes <= kMaxDoubleBufferedBytes ? 2 : 1;
+  // Copies are committed in program order, one group per store. The copy
+  // that used the same buffer of a given store was issued
+  // numBuffers * #stores - 1 groups ago.
+  int pendings = unconditional ? numBuffers * tmaStores.size() - 1 : 0;
+
   DenseMap<tt::ExperimentalDescriptorStoreOp, Value> storeToAlloc;
   for (tt::ExperimentalDescriptorStoreOp op : tmaStores) {
-    storeToAlloc[op] = createAlloc(forOp, op);
+    storeToAlloc[op] = createAlloc(forOp, op, numBuffers);
   }
 
+  Value bufferIdx;
+  if (numBuffers > 1)
+    bufferIdx = createBufferIndex(forOp, numBuffers);
   for (tt::ExperimentalDescriptorStoreOp op : tmaStores) {
-    createTMAAsyncCopy(forOp, op, storeToAlloc[op]);
+    createTMAAsyncCopy(forOp, op, storeToAlloc[op], bufferIdx, pendings);
   }
 
   // Deallocate shared memory buffers.
@@ -24,6 +24,11 @@
 //   ...
 //   scf.yield %next_a, ..., %a_prefetch_next
 // }
+//
+// The first `prefetch-depth` slices of the next iteration are carried in
+// registers, the other slices are loaded one dot ahead. MMAv2, MFMA and WMMA
+// dots are prefetched, the wgmma of other Hopper dots read shared memory
+// directly.
 //===----------------------------------------------------------------------===//
 
 #include "mlir/IR/IRMapping.h"
@@ -49,6 +54,8 @@ class Prefetcher {
   ///
   // TODO: add a hook to infer prefetchWidth
   unsigned prefetchWidth = 32;
+  /// maximum number of slices prefetched from the next iteration
+  unsigned prefetchDepth;
 
   /// dots to be prefetched
   SetVector<triton::DotOp> dots;
@@ -61,15 +68,20 @@ class Prefetcher {
   DenseMap<Value, Value> dot2bYield;
   DenseMap<Value, SmallVector<Value>> dot2aVals;
   DenseMap<Value, SmallVector<Value>> dot2bVals;
-  /// operand => defining
-  DenseMap<Value, Value> operand2headPrefetch;
+  /// dot => number of slices prefetched from the next iteration
+  DenseMap<Value, unsigned> dot2NumPrefetched;
+  /// operand => defining slices
+  DenseMap<Value, SmallVector<Value>> operand2headPrefetch;
 
   LogicalResult isForOpOperand(Value v);
 
-  Value generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
-                         Attribute dotEncoding, OpBuilder &builder,
-                         std::optional<int64_t> offsetK = std::nullopt,
-                         std::optional<int64_t> shapeK = std::nullopt);
+  Value generatePrefetch(Value v, unsigned opIdx, Attribute operandEncoding,
+                         int64_t offsetK, OpBuilder &builder);
+
+  SmallVector<Value> generatePrefetchSlices(Value v, unsigned opIdx,
+                                            unsigned numSlices,
+                                            const SmallVector<Value> &vals,
+                                            OpBuilder &builder);
 
   void cloneElementwiseOps(Value &bRem, const SmallVector<Value> &vals,
                            OpBuilder &builder);
@@ -77,7 +89,8 @@ class Prefetcher {
 public:
   Prefetcher() = delete;
 
-  Prefetcher(scf::ForOp forOp) : forOp(forOp) {
+  Prefetcher(scf::ForOp forOp, unsigned prefetchDepth)
+      : forOp(forOp), prefetchDepth(prefetchDepth) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
@@ -109,26 +122,19 @@ void Prefetcher::cloneElementwiseOps(Value &ret, const SmallVector<Value> &vals,
     ret = mapping.lookup(vals.back());
 }
 
-Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
-                                   Attribute dotEncoding, OpBuilder &builder,
-                                   std::optional<int64_t> offsetK,
-                                   std::optional<int64_t> shapeK) {
+Value Prefetcher::generatePrefetch(Value v, unsigned opIdx,
+                                   Attribute operandEncoding, int64_t offsetK,
+                                   OpBuilder &builder) {
   // opIdx: 0 => a, 1 => b
   auto type = cast<triton::MemDescType>(v.getType());
   SmallVector<int64_t> shape{type.getShape().begin(), type.getShape().end()};
   SmallVector<int64_t> offset{0, 0};
   Type elementType = type.getElementType();
 
-  // k => (prefetchWidth, k - prefetchWidth)
+  // k => [offsetK, offsetK + prefetchWidth)
   int64_t kIdx = opIdx == 0 ? 1 : 0;
-
-  offset[kIdx] = isPrologue ? 0 : prefetchWidth;
-  shape[kIdx] = isPrologue ? prefetchWidth : (shape[kIdx] - prefetchWidth);
-
-  if (shapeK)
-    shape[kIdx] = *shapeK;
-  if (offsetK)
-    offset[kIdx] = *offsetK;
+  offset[kIdx] = offsetK;
+  shape[kIdx] = prefetchWidth;
 
   SmallVector<Value> offsetsVal;
   for (int64_t off : offset)
@@ -140,15 +146,34 @@ Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
                                type.getMemorySpace()),
       v, offsetsVal);
 
-  auto dotOperandEnc = triton::gpu::DotOperandEncodingAttr::get(
-      builder.getContext(), opIdx, dotEncoding, prefetchWidth / 8);
   Value prefetchSlice = builder.create<triton::gpu::LocalLoadOp>(
-      v.getLoc(), RankedTensorType::get(shape, elementType, dotOperandEnc),
+      v.getLoc(), RankedTensorType::get(shape, elementType, operandEncoding),
       newSmem);
 
   return prefetchSlice;
 }
 
+// vals[1] is the local_load of the operand.
+static Attribute getOperandEncoding(const SmallVector<Value> &vals) {
+  return cast<RankedTensorType>(vals[1].getType()).getEncoding();
+}
+
+// Loads the slices of the next iteration that are carried in registers.
+SmallVector<Value>
+Prefetcher::generatePrefetchSlices(Value v, unsigned opIdx, unsigned numSlices,
+                                   const SmallVector<Value> &vals,
+                                   OpBuilder &builder) {
+  Attribute operandEncoding = getOperandEncoding(vals);
+  SmallVector<Value> slices;
+  for (unsigned i = 0; i < numSlices; i++) {
+    Value slice = generatePrefetch(v, opIdx, operandEncoding,
+                                   i * prefetchWidth, builder);
+    cloneElementwiseOps(slice, vals, builder);
+    slices.push_back(slice);
+  }
+  return slices;
+}
+
 LogicalResult Prefetcher::initialize() {
   Block *loop = forOp.getBody();
 
@@ -159,10 +184,12 @@ LogicalResult Prefetcher::initialize() {
   SmallVector<triton::DotOp> dotsInFor;
   for (Operation &op : *loop)
     if (auto dotOp = dyn_cast<triton::DotOp>(op)) {
-      // bail out if there exist non v2 dots.
-      auto dstEnc =
-          dyn_cast<NvidiaMmaEncodingAttr>(getEncoding(dotOp.getResult()));
-      if (!dstEnc || dstEnc.getVersionMajor() != 2)
+      // bail out if there exist dots that don't take their operands in
+      // registers.
+      Attribute dstEnc = getEncoding(dotOp.getResult());
+      auto mmaEnc = dyn_cast<NvidiaMmaEncodingAttr>(dstEnc);
+      if (!(mmaEnc && mmaEnc.getVersionMajor() == 2) &&
+          !isa<AMDMfmaEncodingAttr, AMDWmmaEncodingAttr>(dstEnc))
         return failure();
       dotsInFor.push_back(dotOp);
     }
@@ -231,7 +258,11 @@ LogicalResult Prefetcher::initialize() {
 
     // works better with nvidia tensor cores
     unsigned elementWidth = aType.getElementTypeBitWidth();
-    if (aKWidth == 0)
+    if (auto mfmaEnc = dyn_cast<AMDMfmaEncodingAttr>(aEnc.getParent()))
+      prefetchWidth = mfmaEnc.getMFMAInstrShapeForOperands(aKWidth, 0)[1];
+    else if (isa<AMDWmmaEncodingAttr>(aEnc.getParent()))
+      prefetchWidth = AMDWmmaEncodingAttr::getMNKDimPerWMMAInstr()[2];
+    else if (aKWidth == 0)
       prefetchWidth = 256 / elementWidth;
     else
       prefetchWidth = 8 * aKWidth;
@@ -252,6 +283,8 @@ LogicalResult Prefetcher::initialize() {
         dots.insert(dot);
         dot2aVals[dot] = aVals;
         dot2bVals[dot] = bVals;
+        dot2NumPrefetched[dot] =
+            std::min<int64_t>(prefetchDepth, kSize / prefetchWidth);
         dot2aHeaderDef[dot] = aHeaderDef;
         dot2bHeaderDef[dot] = bHeaderDef;
         dot2aLoopArg[dot] = aSmem;
@@ -269,16 +302,12 @@ void Prefetcher::emitPrologue() {
   OpBuilder builder(forOp);
 
   for (triton::DotOp dot : dots) {
-    Attribute dotEncoding = dot.getType().getEncoding();
-    Value aPrefetched =
-        generatePrefetch(dot2aHeaderDef[dot], 0, true, dotEncoding, builder);
-    cloneElementwiseOps(aPrefetched, dot2aVals[dot], builder);
-    Value bPrefetched =
-        generatePrefetch(dot2bHeaderDef[dot], 1, true, dotEncoding, builder);
-    cloneElementwiseOps(bPrefetched, dot2bVals[dot], builder);
-
-    operand2headPrefetch[dot.getA()] = aPrefetched;
-    operand2headPrefetch[dot.getB()] = bPrefetched;
+    operand2headPrefetch[dot.getA()] =
+        generatePrefetchSlices(dot2aHeaderDef[dot], 0, dot2NumPrefetched[dot],
+                               dot2aVals[dot], builder);
+    operand2headPrefetch[dot.getB()] =
+        generatePrefetchSlices(dot2bHeaderDef[dot], 1, dot2NumPrefetched[dot],
+                               dot2bVals[dot], builder);
   }
 }
 
@@ -288,9 +317,11 @@ scf::ForOp Prefetcher::createNewForOp() {
   SmallVector<Value> loopArgs;
   for (auto v : forOp.getInitArgs())
     loopArgs.push_back(v);
+  DenseMap<triton::DotOp, unsigned> dot2PrefetchArgIdx;
   for (triton::DotOp dot : dots) {
-    loopArgs.push_back(operand2headPrefetch[dot.getA()]);
-    loopArgs.push_back(operand2headPrefetch[dot.getB()]);
+    dot2PrefetchArgIdx[dot] = loopArgs.size();
+    llvm::append_range(loopArgs, operand2headPrefetch[dot.getA()]);
+    llvm::append_range(loopArgs, operand2headPrefetch[dot.getB()]);
   }
 
   auto newForOp = builder.create<scf::ForOp>(
@@ -318,60 +349,51 @@ scf::ForOp Prefetcher::createNewForOp() {
         }
       }
     }
-    Operation *newOp = builder.clone(op, mapping);
+    Operation *newOp;
     auto dot = dyn_cast<triton::DotOp>(&op);
     if (dot && dots.contains(dot)) {
-      Attribute dotEncoding = dot.getType().getEncoding();
-      // prefetched dot
-      Operation *firstDot = builder.clone(*dot, mapping);
-      if (Value a = operand2headPrefetch.lookup(dot.getA()))
-        firstDot->setOperand(
-            0, newForOp.getTiedLoopRegionIterArg(&*a.use_begin()));
-      if (Value b = operand2headPrefetch.lookup(dot.getB()))
-        firstDot->setOperand(
-            1, newForOp.getTiedLoopRegionIterArg(&*b.use_begin()));
-
-      // remaining part
-      int64_t kOff = prefetchWidth;
-      int64_t kRem = dot.getA().getType().getShape()[1] - prefetchWidth;
-      Operation *prevDot = firstDot;
-      if (kRem == 0) {
-        // There is only one dot while prefetchWidth == kSize so delay issuing
-        // it. Meanwhile, newOp should be set to firstDot to make sure the dot
-        // result is updated to yield.
-        builder.setInsertionPoint(prevDot);
-        newOp = firstDot;
-      }
-
-      while (kRem != 0) {
-        // int64_t kShape = largestPow2(kRem);
-        int64_t kShape = prefetchWidth;
-        auto insertionPoint = builder.saveInsertionPoint();
-        builder.setInsertionPoint(prevDot);
-        Value aRem =
-            generatePrefetch(mapping.lookup(dot2aLoopArg[dot]), 0, false,
-                             dotEncoding, builder, kOff, kShape);
-        cloneElementwiseOps(aRem, dot2aVals[dot], builder);
-        Value bRem =
-            generatePrefetch(mapping.lookup(dot2bLoopArg[dot]), 1, false,
-                             dotEncoding, builder, kOff, kShape);
-        cloneElementwiseOps(bRem, dot2bVals[dot], builder);
-        builder.restoreInsertionPoint(insertionPoint);
-        newOp = builder.clone(*dot, mapping);
-        newOp->setOperand(0, aRem);
-        newOp->setOperand(1, bRem);
-        newOp->setOperand(2, prevDot->getResult(0));
-        prevDot = newOp;
-        kOff += kShape;
-        kRem -= kShape;
-        if (kRem == 0) {
-          // We want to delay issuing the last dot as long as possible, ideally
-          // until after the prefetch.  To accomplish this, set the insertion
-          // point above the dot.  If we find anything dependent on the dot (at
-          // the top of this loop), we resume inserting after it.
+      auto iterArgs = newForOp.getRegionIterArgs().drop_front(
+          dot2PrefetchArgIdx[dot]);
+      unsigned numPrefetched = dot2NumPrefetched[dot];
+      auto aPrefetched = iterArgs.take_front(numPrefetched);
+      auto bPrefetched = iterArgs.drop_front(numPrefetched);
+      Operation *prevDot = nullptr;
+      int64_t kSize = dot.getA().getType().getShape()[1];
+      for (int64_t kOff = 0; kOff < kSize; kOff += prefetchWidth) {
+        unsigned slice = kOff / prefetchWidth;
+        Value a, b;
+        if (slice < numPrefetched) {
+          a = aPrefetched[slice];
+          b = bPrefetched[slice];
+        } else {
+          // load the slice of the remaining part before the previous dot
+          auto insertionPoint = builder.saveInsertionPoint();
           builder.setInsertionPoint(prevDot);
+          a = generatePrefetch(mapping.lookup(dot2aLoopArg[dot]), 0,
+                               getOperandEncoding(dot2aVals[dot]), kOff,
+                               builder);
+          cloneElementwiseOps(a, dot2aVals[dot], builder);
+          b = generatePrefetch(mapping.lookup(dot2bLoopArg[dot]), 1,
+                               getOperandEncoding(dot2bVals[dot]), kOff,
+                               builder);
+          cloneElementwiseOps(b, dot2bVals[dot], builder);
+          builder.restoreInsertionPoint(insertionPoint);
         }
+        Operation *nextDot = builder.clone(*dot, mapping);
+        nextDot->setOperand(0, a);
+        nextDot->setOperand(1, b);
+        if (prevDot)
+          nextDot->setOperand(2, prevDot->getResult(0));
+        prevDot = nextDot;
       }
+      // We want to delay issuing the last dot as long as possible, ideally
+      // until after the prefetch.  To accomplish this, set the insertion
+      // point above the dot.  If we find anything dependent on the dot (at
+      // the top of this loop), we resume inserting after it.
+      builder.setInsertionPoint(prevDot);
+      newOp = prevDot;
+    } else {
+      newOp = builder.clone(op, mapping);
     }
     // update mapping of results
     for (unsigned dstIdx : llvm::seq(unsigned(0), op.getNumResults()))
@@ -383,16 +405,14 @@ scf::ForOp Prefetcher::createNewForOp() {
   for (Value v : forOp.getBody()->getTerminator()->getOperands())
     yieldValues.push_back(mapping.lookupOrDefault(v));
   for (triton::DotOp dot : dots) {
-    Attribute dotEncoding = dot.getType().getEncoding();
-    Value aToYield = generatePrefetch(mapping.lookup(dot2aYield[dot]), 0, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(aToYield, dot2aVals[dot], builder);
-    yieldValues.push_back(aToYield);
-    // bToYield
-    Value bToYield = generatePrefetch(mapping.lookup(dot2bYield[dot]), 1, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(bToYield, dot2bVals[dot], builder);
-    yieldValues.push_back(bToYield);
+    llvm::append_range(
+        yieldValues, generatePrefetchSlices(mapping.lookup(dot2aYield[dot]), 0,
+                                            dot2NumPrefetched[dot],
+                                            dot2aVals[dot], builder));
+    llvm::append_range(
+        yieldValues, generatePrefetchSlices(mapping.lookup(dot2bYield[dot]), 1,
+                                            dot2NumPrefetched[dot],
+                                            dot2bVals[dot], builder));
   }
   // Update ops of yield
   builder.setInsertionPointToEnd(newForOp.getBody());
@@ -404,6 +424,8 @@ scf::ForOp Prefetcher::createNewForOp() {
 } // anonymous namespace
 
 struct PrefetchPass : public impl::TritonGPUPrefetchBase<PrefetchPass> {
+  using impl::TritonGPUPrefetchBase<PrefetchPass>::TritonGPUPrefetchBase;
+
   void runOnOperation() override {
 
     // Canonicalize convert ops to make the pattern matching easier.
@@ -416,7 +438,7 @@ struct PrefetchPass : public impl::TritonGPUPrefetchBase<PrefetchPass> {
       signalPassFailure();
     }
     getOperation()->walk([&](scf::ForOp forOp) {
-      Prefetcher prefetcher(forOp);
+      Prefetcher prefetcher(forOp, std::max<int>(prefetchDepth, 1));
 
       if (prefetcher.initialize().failed())
         return;
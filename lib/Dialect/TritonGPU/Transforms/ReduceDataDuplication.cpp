@@ -1,4 +1,5 @@
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/IR/Dominance.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/IRMapping.h"
@@ -6,6 +7,7 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
@@ -17,6 +19,7 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 
 namespace mlir {
 namespace triton {
@@ -25,12 +28,36 @@ namespace gpu {
 #define GEN_PASS_DEF_TRITONGPUREDUCEDATADUPLICATION
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
+namespace {
+// Loop-invariant sources are copied to shared memory once before the loop,
+// unless the copy would hold more than this much shared memory during the
+// loop, which is better left to the pipelined buffers.
+constexpr int64_t kMaxHoistedAllocBytes = 32 * 1024;
+
+// Returns the outermost loop around op that src is defined outside of, if
+// any.
+LoopLikeOpInterface getOutermostInvariantLoop(Value src, Operation *op) {
+  LoopLikeOpInterface outermost;
+  for (auto loop = op->getParentOfType<LoopLikeOpInterface>(); loop;
+       loop = loop->getParentOfType<LoopLikeOpInterface>()) {
+    if (!loop.isDefinedOutsideOfLoop(src))
+      break;
+    outermost = loop;
+  }
+  return outermost;
+}
+} // namespace
+
 class TritonGPUReduceDataDuplicationPass
     : public impl::TritonGPUReduceDataDuplicationBase<
           TritonGPUReduceDataDuplicationPass> {
 public:
   void runOnOperation() override {
     ModuleOp mod = getOperation();
+    DominanceInfo domInfo(mod);
+    // The copies of each source to shared memory, by shared memory type.
+    DenseMap<std::pair<Value, Type>, SmallVector<triton::gpu::LocalAllocOp>>
+        allocs;
     mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
       OpBuilder builder(cvtOp);
       auto srcType = cast<RankedTensorType>(cvtOp.getSrc().getType());
@@ -42,6 +69,10 @@ public:
           dyn_cast<triton::gpu::DotOperandEncodingAttr>(dstType.getEncoding());
       if (!dstDotOp)
         return;
+      // Conversions within threads or warps don't go through shared memory,
+      // so a round trip through it would only be slower.
+      if (!cvtNeedsSharedMemory(srcType, dstType))
+        return;
       if (auto srcMmaEncoding =
               dyn_cast<triton::gpu::NvidiaMmaEncodingAttr>(srcEncoding)) {
 
@@ -72,14 +103,36 @@ public:
       }
       auto sharedMemorySpace =
           triton::gpu::SharedMemorySpaceAttr::get(srcType.getContext());
+      auto sharedEncoding = triton::gpu::SharedEncodingAttr::get(
+          mod.getContext(), dstDotOp, srcType.getShape(), sharedOrder,
+          triton::gpu::getCTALayout(srcEncoding), srcType.getElementType());
+      sharedEncoding = optimizeSharedSwizzle(sharedEncoding, srcType.getShape(),
+                                             srcType.getElementType(),
+                                             srcEncoding, dstDotOp);
       auto tmpType = triton::MemDescType::get(
-          dstType.getShape(), dstType.getElementType(),
-          triton::gpu::SharedEncodingAttr::get(
-              mod.getContext(), dstDotOp, srcType.getShape(), sharedOrder,
-              triton::gpu::getCTALayout(srcEncoding), srcType.getElementType()),
+          dstType.getShape(), dstType.getElementType(), sharedEncoding,
           sharedMemorySpace);
-      auto tmp = builder.create<triton::gpu::LocalAllocOp>(
-          cvtOp.getLoc(), tmpType, cvtOp.getSrc());
+      Value src = cvtOp.getSrc();
+      // Reuse a copy of the source made earlier for another conversion.
+      triton::gpu::LocalAllocOp tmp;
+      auto &srcAllocs = allocs[{src, tmpType}];
+      for (auto alloc : srcAllocs) {
+        if (domInfo.properlyDominates(alloc.getOperation(), cvtOp)) {
+          tmp = alloc;
+          break;
+        }
+      }
+      if (!tmp) {
+        OpBuilder::InsertionGuard guard(builder);
+        int64_t allocBytes = product<int64_t>(tmpType.getShape()) *
+                             tmpType.getElementTypeBitWidth() / 8;
+        if (auto loop = getOutermostInvariantLoop(src, cvtOp);
+            loop && allocBytes <= kMaxHoistedAllocBytes)
+          builder.setInsertionPoint(loop);
+        tmp = builder.create<triton::gpu::LocalAllocOp>(cvtOp.getLoc(),
+                                                        tmpType, src);
+        srcAllocs.push_back(tmp);
+      }
       auto newConvert = builder.create<triton::gpu::LocalLoadOp>(cvtOp.getLoc(),
                                                                  dstType, tmp);
       cvtOp.replaceAllUsesWith(newConvert.getResult());
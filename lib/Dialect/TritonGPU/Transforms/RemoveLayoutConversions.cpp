@@ -1,6 +1,7 @@
 #include <memory>
 
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/IRMapping.h"
@@ -79,6 +80,15 @@ public:
                    SmallVector<Value> &changed, Operation *op);
   // Resolve cases where a value has multiple layouts associated to it.
   void resolveConflicts();
+  // Return the encoding picked for `value`, or its current encoding if the
+  // analysis didn't map it.
+  Attribute getPickedEncoding(Value value);
+  // Return the encoding the owner of `use` will require for its operand once
+  // rewritten with the picked encodings, if it is known.
+  std::optional<Attribute> getUseEncoding(OpOperand &use);
+  // Estimated cost of the conversions on the edges into and out of `value`
+  // under the currently picked encodings.
+  int64_t getAssignmentCost(Value value);
   // Rewrite the IR for the full module.
   void rewrite();
   // Rewrite the IR for a region.
@@ -246,7 +256,8 @@ bool hasConvertToMMATransisitiveUse(Operation *op, Attribute encoding) {
 bool isLayoutAnchor(Operation *op) {
   if (isa<LoadOp, StoreOp>(op))
     return isExpensiveLoadOrStore(op);
-  if (isa<DotOp, nvidia_gpu::WarpGroupDotOp, AtomicRMWOp, AtomicCASOp>(op))
+  if (isa<DotOp, SparseDotOp, nvidia_gpu::WarpGroupDotOp, AtomicRMWOp,
+          AtomicCASOp>(op))
     return true;
 
   // Heuristic: Mark permuting reshape as a layout anchor.  Its dst can be
@@ -260,6 +271,57 @@ bool isLayoutAnchor(Operation *op) {
   return false;
 }
 
+// Cost model used to decide between keeping a layout conversion and
+// recomputing values in another layout. Costs are rough estimates expressed
+// in bytes of memory traffic; one arithmetic op per element counts as one.
+constexpr int64_t kTranscendentalCostPerElement = 4;
+// Number of sweeps used to refine the encodings picked for conflicting values.
+constexpr int kMaxResolveIterations = 4;
+
+int64_t getNumBytes(RankedTensorType type) {
+  int64_t elemBytes = isa<PointerType>(type.getElementType())
+                          ? 8
+                          : std::max<int64_t>(getElementBitWidth(type) / 8, 1);
+  return product(type.getShape()) * elemBytes;
+}
+
+// Estimated cost of converting a tensor of type `srcTy` to `dstEncoding`.
+// Conversions whose linear layout only permutes registers within a thread
+// are a register shuffle; everything else is a round trip through shared
+// memory.
+int64_t getConvertCost(RankedTensorType srcTy, Attribute dstEncoding) {
+  if (srcTy.getEncoding() == dstEncoding)
+    return 0;
+  auto dstTy = RankedTensorType::get(srcTy.getShape(), srcTy.getElementType(),
+                                     dstEncoding);
+  if (isMmaToDotShortcut(srcTy, dstTy))
+    return 0;
+  if (!cvtNeedsSharedMemory(srcTy, dstTy))
+    return product(srcTy.getShape());
+  return 2 * getNumBytes(srcTy);
+}
+
+// Estimated cost of executing `op` a second time in another layout.
+int64_t getRematCost(Operation *op) {
+  if (op->getNumResults() == 0)
+    return 0;
+  auto tensorTy = dyn_cast<RankedTensorType>(op->getResult(0).getType());
+  if (!tensorTy)
+    return 0;
+  // View-like ops are free. Control flow ops are accounted through the ops
+  // in their regions.
+  if (isa<arith::ConstantOp, SplatOp, BroadcastOp, ExpandDimsOp, ReshapeOp,
+          TransOp, ConvertLayoutOp, scf::ForOp, scf::IfOp, scf::YieldOp>(op))
+    return 0;
+  if (isa<LoadOp>(op))
+    return getNumBytes(tensorTy);
+  if (isa<math::MathDialect>(op->getDialect()) ||
+      isa<arith::DivFOp, ExternElementwiseOp, PreciseSqrtOp, PreciseDivFOp>(
+          op))
+    return kTranscendentalCostPerElement * product(tensorTy.getShape());
+  return product(tensorTy.getShape());
+}
+
 void LayoutPropagation::initAnchorLayout() {
   auto maybeAddAnchor = [&](Value v) {
     if (auto tensorType = dyn_cast<RankedTensorType>(v.getType())) {
@@ -367,6 +429,13 @@ SmallVector<Value> LayoutPropagation::propagateToUsers(Value value,
       setEncoding(user->getResults(), info, changed, user);
       continue;
     }
+    // A gather takes the layout of its indices, whatever the layout of its
+    // source.
+    if (auto gather = dyn_cast<GatherOp>(user)) {
+      if (use.getOperandNumber() == 1)
+        setEncoding(gather->getResults(), info, changed, user);
+      continue;
+    }
   }
   return changed;
 }
@@ -394,13 +463,17 @@ void LayoutPropagation::propagateLayout() {
 }
 
 void LayoutPropagation::resolveConflicts() {
+  SmallVector<std::pair<Value, SmallVector<Attribute>>> candidates;
   for (auto &it : layouts) {
     Operation *op = it.first.getDefiningOp();
     LayoutInfo &info = it.second;
     if (info.encodings.size() <= 1)
       continue;
-    // Hacky resolve, prefer block encoding.
-    // TODO: add a proper heuristic.
+    SmallVector<Attribute> conflict(info.encodings.begin(),
+                                    info.encodings.end());
+    // Pick the encoding that minimizes the cost of converting to the other
+    // candidates. On ties, prefer blocked encoding for memory ops and mma
+    // encoding otherwise.
     Attribute encoding = *info.encodings.begin();
     bool isLoadOrStore =
         op && isa<LoadOp, StoreOp, AtomicRMWOp, AtomicCASOp>(op);
@@ -411,9 +484,133 @@ void LayoutPropagation::resolveConflicts() {
         break;
       }
     }
+    auto tensorTy = cast<RankedTensorType>(it.first.getType());
+    auto getConflictCost = [&](Attribute candidate) {
+      auto candidateTy = RankedTensorType::get(
+          tensorTy.getShape(), tensorTy.getElementType(), candidate);
+      int64_t cost = 0;
+      for (Attribute e : info.encodings)
+        cost += getConvertCost(candidateTy, e);
+      return cost;
+    };
+    int64_t bestCost = getConflictCost(encoding);
+    for (Attribute e : info.encodings) {
+      int64_t cost = getConflictCost(e);
+      LDBG("resolveConflicts " << it.first << " encoding " << e << " cost "
+                               << cost);
+      if (cost < bestCost) {
+        bestCost = cost;
+        encoding = e;
+      }
+    }
     info.encodings.clear();
     info.encodings.insert(encoding);
+    if (op && op->getNumResults() == 1 &&
+        !isa<scf::ForOp, scf::IfOp, scf::WhileOp>(op))
+      candidates.push_back({it.first, std::move(conflict)});
   }
+
+  // The choice above only looks at the candidates of a value in isolation,
+  // so two neighbours may end up picking different layouts and a conversion
+  // lands between them. Refine the assignment jointly: re-pick each
+  // conflicting value against the encodings its producer and users picked
+  // until the assignment is stable. Regions of the control flow ops are
+  // tied to their results so those keep the local choice.
+  for (int iter = 0; iter < kMaxResolveIterations; ++iter) {
+    bool changed = false;
+    for (auto &[value, encodings] : candidates) {
+      LayoutInfo &info = layouts[value];
+      Attribute current = *info.encodings.begin();
+      Attribute best = current;
+      int64_t bestCost = getAssignmentCost(value);
+      for (Attribute e : encodings) {
+        if (e == current)
+          continue;
+        info.encodings.clear();
+        info.encodings.insert(e);
+        int64_t cost = getAssignmentCost(value);
+        if (cost < bestCost) {
+          bestCost = cost;
+          best = e;
+        }
+      }
+      info.encodings.clear();
+      info.encodings.insert(best);
+      if (best != current) {
+        LDBG("resolveConflicts refined " << value << " to " << best
+                                         << " cost " << bestCost);
+        changed = true;
+      }
+    }
+    if (!changed)
+      break;
+  }
+}
+
+Attribute LayoutPropagation::getPickedEncoding(Value value) {
+  auto it = layouts.find(value);
+  if (it != layouts.end())
+    return *it->second.encodings.begin();
+  if (auto tensorTy = dyn_cast<RankedTensorType>(value.getType()))
+    return tensorTy.getEncoding();
+  return {};
+}
+
+std::optional<Attribute> LayoutPropagation::getUseEncoding(OpOperand &use) {
+  Operation *user = use.getOwner();
+  Attribute encoding =
+      cast<RankedTensorType>(use.get().getType()).getEncoding();
+  if (auto forOp = dyn_cast<scf::ForOp>(user)) {
+    if (OpResult result = forOp.getTiedLoopResult(&use))
+      return getPickedEncoding(result);
+    return std::nullopt;
+  }
+  if (auto yieldOp = dyn_cast<scf::YieldOp>(user)) {
+    Operation *parent = yieldOp->getParentOp();
+    if (!isa<scf::ForOp, scf::IfOp>(parent))
+      return std::nullopt;
+    return getPickedEncoding(parent->getResult(use.getOperandNumber()));
+  }
+  if (isa<scf::WhileOp, scf::ConditionOp>(user))
+    return std::nullopt;
+  // Ops that are not rewritten get their operands converted back to their
+  // original encoding.
+  if (user->getNumResults() == 0 || !layouts.count(user->getResult(0)))
+    return encoding;
+  Value result = user->getResult(0);
+  Attribute resultEncoding = getPickedEncoding(result);
+  if (resultEncoding == cast<RankedTensorType>(result.getType()).getEncoding())
+    return encoding;
+  if (isa<ConvertLayoutOp>(user))
+    return resultEncoding;
+  if (canFoldIntoConversion(user, resultEncoding))
+    return encoding;
+  if (auto gather = dyn_cast<GatherOp>(user)) {
+    if (use.get() == gather.getSrc())
+      return std::nullopt;
+  }
+  return inferSrcEncoding(user, resultEncoding);
+}
+
+int64_t LayoutPropagation::getAssignmentCost(Value value) {
+  auto getEdgeCost = [&](OpOperand &use) -> int64_t {
+    auto tensorTy = dyn_cast<RankedTensorType>(use.get().getType());
+    if (!tensorTy)
+      return 0;
+    std::optional<Attribute> required = getUseEncoding(use);
+    if (!required || !*required)
+      return 0;
+    auto pickedTy =
+        RankedTensorType::get(tensorTy.getShape(), tensorTy.getElementType(),
+                              getPickedEncoding(use.get()));
+    return getConvertCost(pickedTy, *required);
+  };
+  int64_t cost = 0;
+  for (OpOperand &use : value.getUses())
+    cost += getEdgeCost(use);
+  for (OpOperand &operand : value.getDefiningOp()->getOpOperands())
+    cost += getEdgeCost(operand);
+  return cost;
 }
 
 void LayoutPropagation::dump() {
@@ -779,6 +976,21 @@ Operation *LayoutPropagation::rewriteOp(Operation *op) {
     map(op->getResult(0), cvt.getResult());
     return cvt.getOperation();
   }
+  if (auto gather = dyn_cast<GatherOp>(op)) {
+    Attribute srcEncoding = gather.getSrc().getType().getEncoding();
+    auto it = layouts.find(gather.getSrc());
+    if (it != layouts.end())
+      srcEncoding = *(it->second.encodings.begin());
+    Value src = getValueAs(gather.getSrc(), srcEncoding);
+    Value indices = getValueAs(gather.getIndices(), encoding);
+    auto tensorType = gather.getType();
+    auto newType = RankedTensorType::get(tensorType.getShape(),
+                                         tensorType.getElementType(), encoding);
+    auto newGather = rewriter.create<GatherOp>(op->getLoc(), newType, src,
+                                               indices, gather.getAxis());
+    map(op->getResult(0), newGather.getResult());
+    return newGather.getOperation();
+  }
   if (op->hasTrait<OpTrait::SameOperandsAndResultEncoding>() ||
       op->hasTrait<OpTrait::Elementwise>() ||
       isa<ReduceOp, ExpandDimsOp, ReshapeOp, TransOp, JoinOp, SplitOp,
@@ -801,7 +1013,7 @@ Operation *LayoutPropagation::rewriteOp(Operation *op) {
 bool canBeRemat(Operation *op) {
   if (isa<LoadOp, StoreOp>(op))
     return !isExpensiveLoadOrStore(op);
-  if (isa<AtomicRMWOp, AtomicCASOp, DotOp>(op))
+  if (isa<AtomicRMWOp, AtomicCASOp, DotOp, SparseDotOp>(op))
     return false;
   if (isa<scf::WhileOp, scf::ConditionOp>(op))
     return false;
@@ -1030,6 +1242,41 @@ LogicalResult getRematerializableSlice(
   return success();
 }
 
+// Return the cost of the ops in `slice` that would be computed twice if the
+// slice is rematerialized to feed `convertOp`. Ops whose results are only
+// used by `convertOp` or by other ops that go away are simply moved to the
+// new layout and are free.
+int64_t getSliceRematCost(const SetVector<Value> &slice,
+                          ConvertLayoutOp convertOp) {
+  SetVector<Operation *> sliceOps;
+  for (Value v : slice) {
+    if (Operation *op = v.getDefiningOp())
+      sliceOps.insert(op);
+  }
+  DenseSet<Operation *> kept;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (Operation *op : sliceOps) {
+      if (kept.contains(op))
+        continue;
+      bool isKept = llvm::any_of(op->getUsers(), [&](Operation *user) {
+        if (user == convertOp.getOperation())
+          return false;
+        return !sliceOps.contains(user) || kept.contains(user);
+      });
+      if (isKept) {
+        kept.insert(op);
+        changed = true;
+      }
+    }
+  }
+  int64_t cost = 0;
+  for (Operation *op : kept)
+    cost += getRematCost(op);
+  return cost;
+}
+
 void LayoutRematerialization::backwardRematerialization() {
   // Go through each ConvertLayoutOp.
   SmallVector<ConvertLayoutOp> convertOps;
@@ -1082,12 +1329,24 @@ void LayoutRematerialization::backwardRematerialization(
     return;
   }
 
+  // 2. Only rematerialize if recomputing the slice is cheaper than the
+  // conversion.
+  int64_t rematCost = getSliceRematCost(slice, convertOp);
+  int64_t convertCost =
+      getConvertCost(cast<RankedTensorType>(convertOp.getSrc().getType()),
+                     targetType.getEncoding());
+  LDBG("  remat cost " << rematCost << ", convert cost " << convertCost);
+  if (rematCost > convertCost) {
+    LDBG("  keeping convert, remat is more expensive");
+    return;
+  }
+
   LLVM_DEBUG({
     DBGS() << "  remat convert op " << convertOp << '\n';
     for (Value v : slice)
       DBGS() << "    " << v << '\n';
   });
-  // 2. Rewrite the slice.
+  // 3. Rewrite the slice.
   rewriteSlice(slice, layout, convertOp);
 }
 
@@ -1107,7 +1366,7 @@ void LayoutRematerialization::hoistConvertOnTopOfExtOrBroadcast(
       return true;
     }
     if (auto fpToFpOp = dyn_cast<FpToFpOp>(op)) {
-      auto srcType = cast<RankedTensorType>(fpToFpOp.getOperand().getType());
+      auto srcType = cast<RankedTensorType>(fpToFpOp.getSrc().getType());
       return getElementBitWidth(srcType) <
              getElementBitWidth(fpToFpOp.getType());
     }
@@ -1182,6 +1441,56 @@ void LayoutRematerialization::hoistConvertOnTopOfExtOrBroadcast(
   rewriteSlice(slice, layout, convertOp, mapping);
 }
 
+// reduce(cvt(reshape(cvt(x)))) -> reduce(reduce(x))
+//
+// Reductions over all the elements reshape their operands to 1D first, which
+// converts a dot accumulator out of its MMA layout, through shared memory, as
+// in the amax of a GEMM output. Reducing the columns and then the rows of the
+// accumulator combines its elements within the threads and across the lanes
+// with warp shuffles in the MMA layout instead. The reshape is allowed to
+// reorder the elements, so the combine function is commutative already.
+struct DecomposeFullReductionOfMma : public OpRewritePattern<ReduceOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(ReduceOp op,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value> srcs;
+    for (Value operand : op.getOperands()) {
+      // OptimizeThreadLocality may have picked the layout of the reshape
+      if (auto convert = operand.getDefiningOp<ConvertLayoutOp>())
+        operand = convert.getSrc();
+      auto reshape = operand.getDefiningOp<ReshapeOp>();
+      if (!reshape || !reshape.getAllowReorder() ||
+          cast<RankedTensorType>(reshape.getType()).getRank() != 1)
+        return failure();
+      Value src = reshape.getSrc();
+      if (auto convert = src.getDefiningOp<ConvertLayoutOp>())
+        src = convert.getSrc();
+      srcs.push_back(src);
+    }
+    auto srcTy = cast<RankedTensorType>(srcs.front().getType());
+    auto mmaLayout = dyn_cast<MmaEncodingTrait>(srcTy.getEncoding());
+    if (!mmaLayout || !mmaLayout.supportReduction() || srcTy.getRank() != 2)
+      return failure();
+    for (Value src : srcs) {
+      auto ty = cast<RankedTensorType>(src.getType());
+      if (ty.getShape() != srcTy.getShape() ||
+          ty.getEncoding() != srcTy.getEncoding())
+        return failure();
+    }
+
+    for (int axis : {1, 0}) {
+      auto reduce = rewriter.create<ReduceOp>(op.getLoc(), srcs, axis);
+      auto &combineOp = reduce.getCombineOp();
+      rewriter.cloneRegionBefore(op.getCombineOp(), combineOp,
+                                 combineOp.end());
+      srcs.assign(reduce.getResult().begin(), reduce.getResult().end());
+    }
+    rewriter.replaceOp(op, srcs);
+    return success();
+  }
+};
+
 void backwardRematerialization(ModuleOp module) {
   module.walk([](FuncOp funcOp) {
     LayoutRematerialization layoutRemat(funcOp);
@@ -1224,6 +1533,7 @@ public:
 
     RewritePatternSet cleanUpPatterns(context);
     ConvertLayoutOp::getCanonicalizationPatterns(cleanUpPatterns, context);
+    cleanUpPatterns.add<DecomposeFullReductionOfMma>(context);
     if (applyPatternsAndFoldGreedily(m, std::move(cleanUpPatterns)).failed()) {
       signalPassFailure();
     }
@@ -72,23 +72,43 @@ public:
     // Sink conversions into loops when they will increase
     // register pressure
     DenseMap<Operation *, Operation *> opToMove;
+    SmallVector<triton::gpu::LocalLoadOp> loadsToRepeat;
     auto moveAfter = [](Operation *lhs, Operation *rhs) {
       lhs->moveAfter(rhs);
     };
     m.walk([&](Operation *op) {
       if (!willIncreaseRegisterPressure(op))
         return;
+      auto isInOtherLoop = [&](Operation *user) {
+        return user->getParentOfType<scf::ForOp>() !=
+               op->getParentOfType<scf::ForOp>();
+      };
       auto user_begin = op->user_begin();
       auto user_end = op->user_end();
-      if (std::distance(user_begin, user_end) != 1)
+      if (std::distance(user_begin, user_end) != 1) {
+        // A loop-invariant value loaded from an immutable buffer, e.g. a dot
+        // operand, can be loaded again at each of its uses in loops instead
+        // of holding registers during them.
+        auto load = dyn_cast<triton::gpu::LocalLoadOp>(op);
+        if (load && user_begin != user_end &&
+            !load.getSrc().getType().getMutableMemory() &&
+            llvm::all_of(op->getUsers(), isInOtherLoop))
+          loadsToRepeat.push_back(load);
         return;
-      if (user_begin->getParentOfType<scf::ForOp>() ==
-          op->getParentOfType<scf::ForOp>())
+      }
+      if (!isInOtherLoop(*user_begin))
         return;
       opToMove.insert({op, *user_begin});
     });
     for (auto &kv : opToMove)
       kv.first->moveBefore(kv.second);
+    for (triton::gpu::LocalLoadOp load : loadsToRepeat) {
+      for (OpOperand &use : llvm::make_early_inc_range(load->getUses())) {
+        OpBuilder builder(use.getOwner());
+        use.set(builder.clone(*load)->getResult(0));
+      }
+      load.erase();
+    }
     // Move alloc(load) immediately after dependent load
     m.walk([&](triton::gpu::LocalAllocOp op) {
       if (!op.getSrc())
@@ -0,0 +1,78 @@
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/Support/JSON.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUREPORTSHAREDMEMORYACCESS
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+static std::string getLocString(Location loc) {
+  if (auto fileLoc = loc->findInstanceOf<FileLineColLoc>()) {
+    return (fileLoc.getFilename().str() + ":" +
+            std::to_string(fileLoc.getLine()) + ":" +
+            std::to_string(fileLoc.getColumn()));
+  }
+  return "";
+}
+
+class TritonGPUReportSharedMemoryAccessPass
+    : public impl::TritonGPUReportSharedMemoryAccessBase<
+          TritonGPUReportSharedMemoryAccessPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    llvm::json::Array report;
+    mod.walk([&](Operation *op) {
+      RankedTensorType regTy;
+      MemDescType memTy;
+      if (auto alloc = dyn_cast<LocalAllocOp>(op)) {
+        if (!alloc.getSrc())
+          return;
+        regTy = alloc.getSrc().getType();
+        memTy = alloc.getType();
+      } else if (auto store = dyn_cast<LocalStoreOp>(op)) {
+        regTy = store.getSrc().getType();
+        memTy = store.getDst().getType();
+      } else if (auto load = dyn_cast<LocalLoadOp>(op)) {
+        regTy = load.getType();
+        memTy = load.getSrc().getType();
+      } else {
+        return;
+      }
+
+      std::optional<SharedMemoryAccessStats> stats =
+          mlir::getSharedMemoryAccessStats(regTy, memTy);
+      if (!stats.has_value())
+        return;
+      op->emitRemark() << stats->vectorBits << "-bit vectors, "
+                       << stats->maxConflictWays << "-way bank conflicts ("
+                       << stats->numWavefronts << " wavefronts, "
+                       << stats->numIdealWavefronts << " without conflicts)";
+      report.push_back(llvm::json::Object{
+          {"op", op->getName().getStringRef()},
+          {"loc", getLocString(op->getLoc())},
+          {"vector_bits", stats->vectorBits},
+          {"conflict_ways", stats->maxConflictWays},
+          {"wavefronts", stats->numWavefronts},
+          {"ideal_wavefronts", stats->numIdealWavefronts},
+      });
+    });
+
+    std::string json;
+    llvm::raw_string_ostream os(json);
+    os << llvm::json::Value(std::move(report));
+    mod->setAttr("triton_gpu.shared_memory_report",
+                 StringAttr::get(&getContext(), os.str()));
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
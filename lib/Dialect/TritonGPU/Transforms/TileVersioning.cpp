@@ -0,0 +1,323 @@
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/IRMapping.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+namespace mlir {
+namespace triton {
+namespace gpu {
+
+#define GEN_PASS_DEF_TRITONGPUTILEVERSIONING
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// The check `base + maxOffset < bound` (or <= if inclusive) that decides a
+// mask `splat(base) + make_range < splat(bound)` for all the elements. base is
+// null for masks on a bare make_range.
+struct BoundsCheck {
+  Value base;
+  int64_t maxOffset;
+  Value bound;
+  bool inclusive;
+
+  bool operator==(const BoundsCheck &other) const {
+    return base == other.base && maxOffset == other.maxOffset &&
+           bound == other.bound && inclusive == other.inclusive;
+  }
+};
+
+// A masked load or store whose mask is a conjunction of bounds checks
+struct Candidate {
+  Operation *op;
+  // The outermost op enclosing op that the checks can be evaluated before
+  Operation *anchor;
+  SmallVector<BoundsCheck> checks;
+};
+
+// Look through the ops that only change the shape or the layout of a tensor
+Value skipShapeOps(Value value) {
+  while (Operation *op = value.getDefiningOp()) {
+    if (!isa<BroadcastOp, ExpandDimsOp, ConvertLayoutOp>(op))
+      break;
+    value = op->getOperand(0);
+  }
+  return value;
+}
+
+Value getSplatScalar(Value value) {
+  auto splatOp = skipShapeOps(value).getDefiningOp<SplatOp>();
+  if (!splatOp)
+    return Value();
+  auto intTy = dyn_cast<IntegerType>(splatOp.getSrc().getType());
+  if (!intTy || intTy.getWidth() <= 1 || intTy.getWidth() > 64)
+    return Value();
+  return splatOp.getSrc();
+}
+
+std::optional<int64_t> getMaxOffset(Value value) {
+  auto rangeOp = skipShapeOps(value).getDefiningOp<MakeRangeOp>();
+  if (!rangeOp)
+    return std::nullopt;
+  return static_cast<int64_t>(rangeOp.getEnd()) - 1;
+}
+
+bool matchOffsets(Value offsets, BoundsCheck &check) {
+  offsets = skipShapeOps(offsets);
+  if (auto maxOffset = getMaxOffset(offsets)) {
+    check.base = Value();
+    check.maxOffset = *maxOffset;
+    return true;
+  }
+  auto addOp = offsets.getDefiningOp<arith::AddIOp>();
+  if (!addOp)
+    return false;
+  for (auto [lhs, rhs] : {std::make_pair(addOp.getLhs(), addOp.getRhs()),
+                          std::make_pair(addOp.getRhs(), addOp.getLhs())}) {
+    Value base = getSplatScalar(lhs);
+    auto maxOffset = getMaxOffset(rhs);
+    if (base && maxOffset) {
+      check.base = base;
+      check.maxOffset = *maxOffset;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool matchMask(Value mask, SmallVectorImpl<BoundsCheck> &checks) {
+  mask = skipShapeOps(mask);
+  if (auto andOp = mask.getDefiningOp<arith::AndIOp>())
+    return matchMask(andOp.getLhs(), checks) &&
+           matchMask(andOp.getRhs(), checks);
+  auto cmpOp = mask.getDefiningOp<arith::CmpIOp>();
+  if (!cmpOp)
+    return false;
+  Value offsets = cmpOp.getLhs();
+  Value bound = cmpOp.getRhs();
+  BoundsCheck check;
+  switch (cmpOp.getPredicate()) {
+  case arith::CmpIPredicate::slt:
+    check.inclusive = false;
+    break;
+  case arith::CmpIPredicate::sle:
+    check.inclusive = true;
+    break;
+  case arith::CmpIPredicate::sgt:
+    std::swap(offsets, bound);
+    check.inclusive = false;
+    break;
+  case arith::CmpIPredicate::sge:
+    std::swap(offsets, bound);
+    check.inclusive = true;
+    break;
+  default:
+    return false;
+  }
+  check.bound = getSplatScalar(bound);
+  if (!check.bound || !matchOffsets(offsets, check))
+    return false;
+  checks.push_back(check);
+  return true;
+}
+
+Value getMask(Operation *op) {
+  if (auto loadOp = dyn_cast<LoadOp>(op))
+    return loadOp.getMask();
+  if (auto storeOp = dyn_cast<StoreOp>(op))
+    return storeOp.getMask();
+  return Value();
+}
+
+void dropMask(Operation *op) {
+  if (auto loadOp = dyn_cast<LoadOp>(op)) {
+    loadOp.getMaskMutable().clear();
+    loadOp.getOtherMutable().clear();
+  } else {
+    cast<StoreOp>(op).getMaskMutable().clear();
+  }
+}
+
+// Emit the check in 64 bits, where the sum cannot overflow
+Value createCheck(OpBuilder &builder, Location loc, const BoundsCheck &check) {
+  Type i64Ty = builder.getI64Type();
+  auto extend = [&](Value value) -> Value {
+    if (value.getType() == i64Ty)
+      return value;
+    return builder.create<arith::ExtSIOp>(loc, i64Ty, value);
+  };
+  Value last = builder.create<arith::ConstantIntOp>(loc, check.maxOffset, 64);
+  if (check.base)
+    last = builder.create<arith::AddIOp>(loc, extend(check.base), last);
+  auto predicate = check.inclusive ? arith::CmpIPredicate::sle
+                                   : arith::CmpIPredicate::slt;
+  return builder.create<arith::CmpIOp>(loc, predicate, last,
+                                       extend(check.bound));
+}
+
+int getDepth(Operation *op) {
+  int depth = 0;
+  for (Operation *parent = op->getParentOp(); !isa<FuncOp>(parent);
+       parent = parent->getParentOp())
+    ++depth;
+  return depth;
+}
+
+} // namespace
+
+class TileVersioningPass
+    : public impl::TritonGPUTileVersioningBase<TileVersioningPass> {
+public:
+  void runOnOperation() override {
+    getOperation().walk([&](FuncOp funcOp) {
+      while (versionOutermostGroup(funcOp))
+        ;
+    });
+  }
+
+private:
+  // The scf.if ops created by the pass. The boundary paths are not versioned
+  // again, so every nesting level adds at most one copy of the ops.
+  DenseSet<Operation *> versionOps;
+
+  bool isInBoundaryPath(Operation *op) {
+    for (Region *region = op->getParentRegion(); region;
+         region = region->getParentRegion()) {
+      auto ifOp = dyn_cast<scf::IfOp>(region->getParentOp());
+      if (ifOp && versionOps.contains(ifOp) &&
+          region == &ifOp.getElseRegion())
+        return true;
+    }
+    return false;
+  }
+
+  Operation *getAnchor(Operation *op, ArrayRef<BoundsCheck> checks) {
+    auto isDefinedOutside = [](Value value, Operation *parent) {
+      return !value ||
+             !parent->isAncestor(value.getParentBlock()->getParentOp());
+    };
+    Operation *anchor = op;
+    while (Operation *parent = anchor->getParentOp()) {
+      if (!isa<scf::ForOp, scf::IfOp, scf::WhileOp>(parent) ||
+          versionOps.contains(parent))
+        break;
+      if (!llvm::all_of(checks, [&](const BoundsCheck &check) {
+            return isDefinedOutside(check.base, parent) &&
+                   isDefinedOutside(check.bound, parent);
+          }))
+        break;
+      anchor = parent;
+    }
+    return anchor;
+  }
+
+  // Version the ops from the outermost anchor to the last anchor in the same
+  // block whose checks are available before it. Returns false if there is
+  // nothing left to version.
+  bool versionOutermostGroup(FuncOp funcOp) {
+    SmallVector<Candidate> candidates;
+    funcOp.walk<WalkOrder::PreOrder>([&](Operation *op) {
+      Value mask = getMask(op);
+      if (!mask || !isa<RankedTensorType>(mask.getType()) ||
+          isInBoundaryPath(op))
+        return;
+      Candidate candidate;
+      if (!matchMask(mask, candidate.checks))
+        return;
+      candidate.op = op;
+      candidate.anchor = getAnchor(op, candidate.checks);
+      candidates.push_back(std::move(candidate));
+    });
+    if (candidates.empty())
+      return false;
+
+    auto outermost = llvm::min_element(
+        candidates, [](const Candidate &lhs, const Candidate &rhs) {
+          return getDepth(lhs.anchor) < getDepth(rhs.anchor);
+        });
+    Operation *start = outermost->anchor;
+    Operation *end = start;
+    Block *block = start->getBlock();
+    DominanceInfo domInfo(funcOp);
+    SmallVector<Operation *> groupOps;
+    SmallVector<BoundsCheck> checks;
+    for (auto &candidate : llvm::make_range(outermost, candidates.end())) {
+      if (candidate.anchor->getBlock() != block)
+        continue;
+      auto isAvailable = [&](Value value) {
+        return !value || domInfo.properlyDominates(value, start);
+      };
+      if (!llvm::all_of(candidate.checks, [&](const BoundsCheck &check) {
+            return isAvailable(check.base) && isAvailable(check.bound);
+          }))
+        break;
+      end = candidate.anchor;
+      groupOps.push_back(candidate.op);
+      for (auto &check : candidate.checks)
+        if (!llvm::is_contained(checks, check))
+          checks.push_back(check);
+    }
+
+    SmallVector<Operation *> ops;
+    for (Operation &op :
+         llvm::make_range(start->getIterator(), std::next(end->getIterator())))
+      ops.push_back(&op);
+    SmallVector<Value> escaping;
+    for (Operation *op : ops)
+      for (Value result : op->getResults())
+        if (llvm::any_of(result.getUsers(), [&](Operation *user) {
+              return end->isBeforeInBlock(block->findAncestorOpInBlock(*user));
+            }))
+          escaping.push_back(result);
+
+    OpBuilder builder(start);
+    Location loc = start->getLoc();
+    Value cond;
+    for (auto &check : checks) {
+      Value term = createCheck(builder, loc, check);
+      cond = cond ? builder.create<arith::AndIOp>(loc, cond, term) : term;
+    }
+    auto ifOp = builder.create<scf::IfOp>(loc, ValueRange(escaping).getTypes(),
+                                          cond, /*withElseRegion=*/true);
+    // The boundary tiles are the rare ones
+    ifOp->setAttr("tt.cold_region", builder.getI32IntegerAttr(1));
+
+    // Interior tiles run a copy of the ops without the masks
+    OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+    IRMapping mapping;
+    for (Operation *op : ops)
+      thenBuilder.clone(*op, mapping);
+    for (Operation *op : groupOps)
+      dropMask(mapping.lookup(op));
+    for (Operation *op : llvm::to_vector(versionOps))
+      if (Operation *clonedOp = mapping.lookupOrNull(op))
+        versionOps.insert(clonedOp);
+    if (!escaping.empty()) {
+      SmallVector<Value> thenResults;
+      for (Value value : escaping)
+        thenResults.push_back(mapping.lookup(value));
+      thenBuilder.create<scf::YieldOp>(loc, thenResults);
+    }
+
+    // Boundary tiles run the original ops
+    OpBuilder elseBuilder = ifOp.getElseBodyBuilder();
+    for (Operation *op : ops)
+      op->moveBefore(elseBuilder.getInsertionBlock(),
+                     elseBuilder.getInsertionPoint());
+    if (!escaping.empty())
+      elseBuilder.create<scf::YieldOp>(loc, escaping);
+
+    for (auto [value, result] : llvm::zip(escaping, ifOp.getResults()))
+      value.replaceUsesWithIf(result, [&](OpOperand &use) {
+        return !ifOp->isAncestor(use.getOwner());
+      });
+    versionOps.insert(ifOp);
+    return true;
+  }
+};
+
+} // namespace gpu
+} // namespace triton
+} // namespace mlir
@@ -12,6 +12,7 @@
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/LinearLayoutConversions.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "llvm/Support/Debug.h"
@@ -87,6 +88,16 @@ SmallVector<unsigned, 4> argSort(const SmallVector<int64_t> &arr) {
   return ret;
 }
 
+SmallVector<unsigned, 4>
+getOrderFromContiguity(const SmallVector<int64_t> &contiguity,
+                       ArrayRef<unsigned> defaultOrder) {
+  SmallVector<unsigned, 4> ret(defaultOrder.begin(), defaultOrder.end());
+  std::stable_sort(ret.begin(), ret.end(), [&](unsigned x, unsigned y) {
+    return contiguity[x] > contiguity[y];
+  });
+  return ret;
+}
+
 Value getMemAccessPtr(Operation *op) {
   if (auto ld = dyn_cast<triton::LoadOp>(op))
     return ld.getPtr();
@@ -427,15 +438,19 @@ static std::optional<Attribute> inferSrcEncoding(triton::ReshapeOp op,
   // The encoding of x given the encoding of y in `reshape(x) -> y` is the same
   // as the encoding of x given the encoding of y in `reshape(y) -> x`.  It's an
   // invariant of inferReshapeOpNoReorderEncoding that it's symmetric in this
-  // way.
-  return inferReshapeOpDstEncoding(op.getType().getShape(), encoding,
-                                   op.getSrc().getType().getShape(),
-                                   op.getAllowReorder());
+  // way as long as the blocked rules apply, but not when it falls back to the
+  // linear layouts, so the encodings that don't reshape back to y are dropped.
+  auto srcEncoding = inferReshapeOpDstEncoding(
+      op.getType().getShape(), encoding, op.getSrc().getType().getShape(),
+      op.getAllowReorder());
+  if (srcEncoding && inferDstEncoding(op, *srcEncoding) != encoding)
+    return std::nullopt;
+  return srcEncoding;
 }
 
 std::optional<Attribute> inferSrcEncoding(Operation *op, Attribute encoding) {
-  if (isa<triton::ScanOp>(op)) {
-    // Scan only supports blocked encoding at the moment.
+  if (isa<triton::ScanOp, triton::SortOp>(op)) {
+    // Scan and sort only support blocked encoding at the moment.
     if (!isa<triton::gpu::BlockedEncodingAttr>(encoding))
       return std::nullopt;
   }
@@ -464,7 +479,7 @@ std::optional<Attribute> inferSrcEncoding(Operation *op, Attribute encoding) {
 }
 
 std::optional<Attribute> inferDstEncoding(Operation *op, Attribute encoding) {
-  if (isa<triton::ScanOp>(op)) {
+  if (isa<triton::ScanOp, triton::SortOp>(op)) {
     if (!isa<triton::gpu::BlockedEncodingAttr>(encoding))
       return std::nullopt;
   }
@@ -474,6 +489,9 @@ std::optional<Attribute> inferDstEncoding(Operation *op, Attribute encoding) {
       isa<scf::WhileOp, scf::ForOp, scf::YieldOp, scf::ConditionOp,
           nvidia_gpu::WarpGroupDotWaitOp>(op))
     return encoding;
+  // The result of a gather has the layout of its indices.
+  if (isa<triton::GatherOp>(op))
+    return encoding;
   if (auto reduceOp = dyn_cast<triton::ReduceOp>(op))
     return inferDstEncoding(reduceOp, encoding);
   if (auto expand = dyn_cast<triton::ExpandDimsOp>(op))
@@ -531,7 +549,7 @@ bool isExpensiveToRemat(Operation *op, Attribute &targetEncoding) {
   if (isa<triton::CatOp>(op))
     return triton::gpu::isExpensiveCat(cast<triton::CatOp>(op), targetEncoding);
   if (isa<triton::gpu::AsyncCopyGlobalToLocalOp, triton::AtomicRMWOp,
-          triton::AtomicCASOp, triton::DotOp>(op))
+          triton::AtomicCASOp, triton::DotOp, triton::gpu::SparseDotOp>(op))
     return true;
   if (isa<scf::YieldOp, scf::ForOp, scf::IfOp, scf::WhileOp, scf::ConditionOp>(
           op))
@@ -727,6 +745,13 @@ getConvertBackwardSlice(Value root, SetVector<Value> &slice,
         continue;
       if (isa<triton::CatOp>(definingOp))
         return failure();
+      if (auto gather = dyn_cast<triton::GatherOp>(definingOp)) {
+        // The source of a gather keeps its layout, only the indices follow
+        // the result.
+        if (slice.count(gather.getIndices()) == 0)
+          queue.push_back({gather.getIndices(), encoding});
+        continue;
+      }
       for (Value operand : definingOp->getOperands()) {
         auto srcEncoding = inferSrcEncoding(definingOp, encoding);
         if (!srcEncoding)
@@ -839,6 +864,86 @@ int getNVIDIAComputeCapability(Operation *module) {
   return computeCapability;
 }
 
+// Models the shared memory reads of ldmatrix.x4: each group of 8 lanes reads
+// one matrix of 8 rows along order[1], each row being 16 bytes contiguous
+// along order[0].  Registers repeat the pattern over the whole tensor.
+static std::optional<triton::LinearLayout>
+getLdmatrixAccessLayout(MLIRContext *ctx, ArrayRef<int64_t> shape,
+                        ArrayRef<unsigned> order, unsigned bitWidth) {
+  using triton::LinearLayout;
+  int vec = 128 / bitWidth;
+  int contig = order[0];
+  int strided = order[1];
+  if (shape[contig] < 2 * vec || shape[strided] < 16)
+    return std::nullopt;
+
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  SmallVector<StringAttr> dims = {StringAttr::get(ctx, "dim0"),
+                                  StringAttr::get(ctx, "dim1")};
+  StringAttr contigDim = dims[contig];
+  StringAttr stridedDim = dims[strided];
+  LinearLayout layout =
+      LinearLayout::identity1D(vec, kRegister, contigDim) *
+      LinearLayout::identity1D(8, kLane, stridedDim) *
+      LinearLayout::identity1D(2, kLane, contigDim) *
+      LinearLayout::identity1D(2, kLane, stridedDim) *
+      LinearLayout::identity1D(shape[contig] / (2 * vec), kRegister,
+                               contigDim) *
+      LinearLayout::identity1D(shape[strided] / 16, kRegister, stridedDim);
+  return layout.transposeOuts(dims);
+}
+
+triton::gpu::SharedEncodingAttr
+optimizeSharedSwizzle(triton::gpu::SharedEncodingAttr sharedEnc,
+                      ArrayRef<int64_t> shape, Type eltTy,
+                      Attribute srcEncoding,
+                      triton::gpu::DotOperandEncodingAttr dotOpEnc) {
+  namespace ttg = triton::gpu;
+  auto mmaEnc = dyn_cast<ttg::NvidiaMmaEncodingAttr>(dotOpEnc.getParent());
+  if (!mmaEnc || !mmaEnc.isAmpere() || shape.size() != 2 ||
+      sharedEnc.getHasLeadingOffset() ||
+      !isa<ttg::DistributedEncodingTrait>(srcEncoding))
+    return sharedEnc;
+
+  // Only the ldmatrix path of the MMAv2 operand loader is modeled.  That
+  // loader swizzles whole 8x16B matrices and computes the phase from the row
+  // within a matrix, so it requires perPhase * maxPhase == 8.
+  unsigned bitWidth = eltTy.getIntOrFloatBitWidth();
+  ArrayRef<unsigned> order = sharedEnc.getOrder();
+  unsigned kOrder = dotOpEnc.getOpIdx() == 0 ? 1 : 0;
+  bool needTrans = order[0] != kOrder;
+  if (bitWidth > 32 || dotOpEnc.getKWidth() != 32 / bitWidth ||
+      (needTrans && bitWidth != 16) ||
+      sharedEnc.getPerPhase() * sharedEnc.getMaxPhase() != 8)
+    return sharedEnc;
+
+  MLIRContext *ctx = sharedEnc.getContext();
+  std::optional<triton::LinearLayout> reader =
+      getLdmatrixAccessLayout(ctx, shape, order, bitWidth);
+  std::optional<triton::LinearLayout> writer =
+      ttg::toLinearLayout(shape, srcEncoding);
+  if (!reader.has_value() || !writer.has_value())
+    return sharedEnc;
+
+  // The current encoding goes first so that it wins ties.
+  SmallVector<ttg::SharedEncodingAttr> candidates = {sharedEnc};
+  unsigned vec = sharedEnc.getVec();
+  for (unsigned maxPhase = 1;
+       maxPhase <= 8 && maxPhase * vec <= shape[order[0]]; maxPhase *= 2) {
+    auto candidate = ttg::SharedEncodingAttr::get(
+        ctx, vec, 8 / maxPhase, maxPhase, order, sharedEnc.getCTALayout());
+    if (candidate != sharedEnc)
+      candidates.push_back(candidate);
+  }
+  SmallVector<triton::LinearLayout> sharedLayouts;
+  for (ttg::SharedEncodingAttr candidate : candidates)
+    sharedLayouts.push_back(*ttg::toLinearLayout(shape, candidate));
+  int best = triton::findMinBankConflictLayout({*reader, *writer},
+                                               sharedLayouts, bitWidth);
+  return candidates[best];
+}
+
 namespace {
 
 /// Detect dead arguments in scf.for op by assuming all the values are dead and
@@ -974,4 +1079,129 @@ void populateForOpDeadArgumentElimination(RewritePatternSet &patterns) {
   patterns.add<ForOpDeadArgElimination>(patterns.getContext());
 }
 
+namespace {
+
+// Rewrites dots with fewer than 16 rows or columns, like the GEMVs of decoding,
+// to products reduced over K:
+//   sum(a[:, :, None] * b[None, :, :], axis=1)
+// The product layout gives the threads vectors along K and splits K across the
+// lanes, so the reduction ends with warp shuffles, instead of padding the dot
+// to the tile of an MMA or keeping all of K in each thread as FMA dots do.
+struct DotToGemv : public OpRewritePattern<DotOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(DotOp dotOp,
+                                PatternRewriter &rewriter) const override {
+    RankedTensorType dTy = dotOp.getType();
+    if (dTy.getRank() != 2 ||
+        !isa_and_nonnull<triton::gpu::BlockedEncodingAttr>(
+            dTy.getEncoding()))
+      return failure();
+    auto mod = dotOp->getParentOfType<ModuleOp>();
+    if (triton::gpu::TritonGPUDialect::getNumCTAs(mod) != 1)
+      return failure();
+    int64_t M = dTy.getShape()[0];
+    int64_t N = dTy.getShape()[1];
+    int64_t K = dotOp.getA().getType().getShape()[1];
+    if (std::min(M, N) >= 16)
+      return failure();
+    Type accElemTy = dTy.getElementType();
+    unsigned bitWidth = 0;
+    for (Value operand : {dotOp.getA(), dotOp.getB()}) {
+      Type elemTy = getElementTypeOrSelf(operand.getType());
+      bool isFloat = elemTy.isF16() || elemTy.isBF16() || elemTy.isF32();
+      bool isInt8 = elemTy.isInteger(8);
+      if (!(isFloat && isa<FloatType>(accElemTy)) &&
+          !(isInt8 && accElemTy.isInteger(32)))
+        return failure();
+      if (elemTy.getIntOrFloatBitWidth() > accElemTy.getIntOrFloatBitWidth())
+        return failure();
+      bitWidth = std::max(bitWidth, elemTy.getIntOrFloatBitWidth());
+    }
+
+    // [M, K, N] with 16 bytes of K per thread, then as many lanes along K as
+    // it takes, and the warps along the wider of M and N
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    unsigned wideDim = M > N ? 0 : 2;
+    unsigned narrowDim = 2 - wideDim;
+    int64_t wide = std::max(M, N);
+    SmallVector<unsigned> sizePerThread(3, 1), threads(3, 1), warps(3, 1);
+    sizePerThread[1] = std::min<int64_t>(K, 128 / bitWidth);
+    threads[1] = std::min<int64_t>(threadsPerWarp, K / sizePerThread[1]);
+    threads[wideDim] =
+        std::min<int64_t>(threadsPerWarp / threads[1], wide);
+    threads[narrowDim] = threadsPerWarp / threads[1] / threads[wideDim];
+    warps[wideDim] =
+        std::clamp<int64_t>(wide / threads[wideDim], 1, numWarps);
+    warps[1] = std::clamp<int64_t>(K / (sizePerThread[1] * threads[1]), 1,
+                                   numWarps / warps[wideDim]);
+    warps[narrowDim] = numWarps / warps[wideDim] / warps[1];
+    SmallVector<unsigned> order = {1, wideDim, narrowDim};
+    auto ctx = dotOp.getContext();
+    auto blocked = triton::gpu::BlockedEncodingAttr::get(
+        ctx, sizePerThread, threads, warps, order,
+        triton::gpu::CTALayoutAttr::getDefault(ctx, 3));
+
+    Location loc = dotOp.getLoc();
+    SmallVector<int64_t> prodShape = {M, K, N};
+    auto prodTy = RankedTensorType::get(prodShape, accElemTy, blocked);
+    auto broadcastOperand = [&](Value operand, int axis) -> Value {
+      if (auto convert = operand.getDefiningOp<triton::gpu::ConvertLayoutOp>())
+        operand = convert.getSrc();
+      auto ty = cast<RankedTensorType>(operand.getType());
+      auto sliceTy = RankedTensorType::get(
+          ty.getShape(), ty.getElementType(),
+          triton::gpu::SliceEncodingAttr::get(ctx, axis, blocked));
+      Value v =
+          rewriter.create<triton::gpu::ConvertLayoutOp>(loc, sliceTy, operand);
+      if (ty.getElementType() != accElemTy) {
+        auto extTy = sliceTy.clone(accElemTy);
+        if (isa<FloatType>(accElemTy))
+          v = rewriter.create<arith::ExtFOp>(loc, extTy, v);
+        else
+          v = rewriter.create<arith::ExtSIOp>(loc, extTy, v);
+      }
+      v = rewriter.create<ExpandDimsOp>(loc, v, axis);
+      if (v.getType() == prodTy)
+        return v;
+      return rewriter.create<BroadcastOp>(loc, prodTy, v);
+    };
+    Value a = broadcastOperand(dotOp.getA(), 2);
+    Value b = broadcastOperand(dotOp.getB(), 0);
+    bool isFloat = isa<FloatType>(accElemTy);
+    Value prod;
+    if (isFloat)
+      prod = rewriter.create<arith::MulFOp>(loc, a, b);
+    else
+      prod = rewriter.create<arith::MulIOp>(loc, a, b);
+
+    auto reduce = rewriter.create<ReduceOp>(loc, ValueRange{prod}, 1);
+    Block *combine =
+        rewriter.createBlock(&reduce.getCombineOp(), {},
+                             {accElemTy, accElemTy}, {loc, loc});
+    auto add = [&](Value lhs, Value rhs) -> Value {
+      if (isFloat)
+        return rewriter.create<arith::AddFOp>(loc, lhs, rhs);
+      return rewriter.create<arith::AddIOp>(loc, lhs, rhs);
+    };
+    rewriter.create<ReduceReturnOp>(
+        loc, add(combine->getArgument(0), combine->getArgument(1)));
+    rewriter.setInsertionPointAfter(reduce);
+    Value sum = reduce.getResult()[0];
+    Value c = rewriter.create<triton::gpu::ConvertLayoutOp>(
+        loc, sum.getType(), dotOp.getC());
+    rewriter.replaceOpWithNewOp<triton::gpu::ConvertLayoutOp>(dotOp, dTy,
+                                                              add(c, sum));
+    return success();
+  }
+};
+
+} // namespace
+
+void populateDotToGemvPatterns(RewritePatternSet &patterns,
+                               PatternBenefit benefit) {
+  patterns.add<DotToGemv>(patterns.getContext(), benefit);
+}
+
 } // namespace mlir
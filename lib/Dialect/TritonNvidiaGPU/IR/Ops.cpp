@@ -149,12 +149,53 @@ void WaitBarrierOp::getEffects(
                        mlir::SideEffects::DefaultResource::get());
 }
 
+// -- ArriveBarrierOp --
+LogicalResult ArriveBarrierOp::verify() {
+  if (failed(verifyBarrierType(*this, getAlloc().getType())))
+    return failure();
+  if (getCount() < 1)
+    return emitOpError("arrive count must be positive");
+  return success();
+}
+
+void ArriveBarrierOp::getEffects(
+    SmallVectorImpl<SideEffects::EffectInstance<MemoryEffects::Effect>>
+        &effects) {
+  effects.emplace_back(MemoryEffects::Write::get(), getAlloc(),
+                       mlir::triton::gpu::SharedMemory::get());
+}
+
+// -- RegAllocOp / RegDeallocOp --
+static LogicalResult verifyRegCount(Operation *op, uint32_t regCount) {
+  // setmaxnreg requires a multiple of 8 in the range [24, 256].
+  if (regCount < 24 || regCount > 256 || regCount % 8 != 0)
+    return op->emitOpError(
+        "register count must be a multiple of 8 in the range [24, 256]");
+  return success();
+}
+
+LogicalResult RegAllocOp::verify() {
+  return verifyRegCount(*this, getRegCount());
+}
+
+LogicalResult RegDeallocOp::verify() {
+  return verifyRegCount(*this, getRegCount());
+}
+
 // -- AsyncTMACopyGlobalToLocalOp --
 LogicalResult AsyncTMACopyGlobalToLocalOp::verify() {
   if (failed(verifyBarrierType(*this, getBarrier().getType())))
     return failure();
   if (getCoord().size() < 1 || getCoord().size() > 5)
     return emitOpError("TMA copies must have between 1 and 5 coordinates");
+  if (getIm2colOffsets().empty())
+    return success();
+  if (getCoord().size() < 3 ||
+      getIm2colOffsets().size() != getCoord().size() - 2)
+    return emitOpError("im2col copies must have 3 to 5 coordinates and an "
+                       "offset for each spatial dim");
+  if (getResult().getType().getRank() != 2)
+    return emitOpError("im2col copies must write a 2D buffer");
   return success();
 }
 
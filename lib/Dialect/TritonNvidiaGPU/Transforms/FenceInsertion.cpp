@@ -4,6 +4,7 @@
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Debug.h"
 
 //===----------------------------------------------------------------------===//
@@ -33,9 +34,12 @@ public:
   FenceInsertionPass(int computeCapability) {
     this->computeCapability = computeCapability;
   }
-  // TODO: support more general patterns to insert fences. eg. any op(generic)
-  // to shared in use-def chain which refers by async proxy. We have generic(
-  // convertlayout with sts/stmatix) + fence + async(wgmma) up to now
+  // A fence is needed between the generic proxy writes to a shared memory
+  // buffer (local_alloc with a source, local_store) and the wgmma reading it.
+  // The writers are found per buffer, by following the operands of the wgmma
+  // back to their allocations, so that the fence can be placed right after
+  // the loops that write them, and is shared by the wgmmas reading buffers
+  // that are not written in between.
   void runOnOperation() override {
     // Only insert fences for compute capability 9.0
     if (computeCapability < 90)
@@ -43,91 +47,131 @@ public:
     if (::triton::tools::getBoolEnv("DISABLE_MMA_V3"))
       return;
     ModuleOp mod = getOperation();
-    mod.walk([&](Operation *op) {
-      if (!isa<ttng::WarpGroupDotOp>(op))
-        return WalkResult::advance();
-      OpBuilder builder(op);
-      auto a = op->getOperand(0);
-      auto b = op->getOperand(1);
+    mod.walk([&](ttng::WarpGroupDotOp dotOp) {
       auto mmaEncoding = dyn_cast<ttg::NvidiaMmaEncodingAttr>(
-          cast<RankedTensorType>(op->getResult(0).getType()).getEncoding());
+          dotOp.getType().getEncoding());
       if (!mmaEncoding || !mmaEncoding.isHopper())
-        return WalkResult::advance();
-      bool aDependsOnShared = dependOnSharedEncOperand(a);
-      bool bDependsOnShared = dependOnSharedEncOperand(b);
-      if (!aDependsOnShared && !bDependsOnShared)
-        return WalkResult::advance();
+        return;
+      llvm::SetVector<Operation *> writers;
+      DenseSet<Value> visited;
+      collectGenericWriters(dotOp.getA(), writers, visited);
+      collectGenericWriters(dotOp.getB(), writers, visited);
+      if (writers.empty())
+        return;
+      auto isWrittenIn = [&](Operation *op) {
+        return llvm::any_of(writers,
+                            [&](Operation *writer) {
+                              return op->isAncestor(writer);
+                            });
+      };
+      OpBuilder builder(dotOp);
       Operation *fence = builder.create<ttng::FenceAsyncSharedOp>(
-          op->getLoc(), /*bCluster=*/false);
-      // If there is all the dependencies are outside of the loop try to hoist
-      // the fence.
+          dotOp.getLoc(), /*bCluster=*/false);
+      // Hoist the fence out of the loops that don't write the operands.
       while (auto loopOp = fence->getParentOfType<LoopLikeOpInterface>()) {
-        if (aDependsOnShared &&
-            loopOp->isAncestor(a.getParentBlock()->getParentOp()))
-          break;
-        if (bDependsOnShared &&
-            loopOp->isAncestor(b.getParentBlock()->getParentOp()))
+        if (isWrittenIn(loopOp))
           break;
         loopOp.moveOutOfLoop(fence);
       }
-      return WalkResult::advance();
+      // An earlier fence already orders the writes if none of them happens
+      // after it.
+      for (Operation *prev = fence->getPrevNode(); prev;
+           prev = prev->getPrevNode()) {
+        if (isa<ttng::FenceAsyncSharedOp>(prev)) {
+          fence->erase();
+          break;
+        }
+        if (isWrittenIn(prev))
+          break;
+      }
     });
   }
 
 private:
-  bool dependOnSharedEncOperand(Value operand) {
-    static DenseSet<std::pair<Operation *, unsigned>> trace;
-    auto op = operand.getDefiningOp();
-    // avoid redundant insertion
-    if (op && op->hasTrait<OpTrait::DotLike>())
-      return false;
-    // reach convertlayout
-    if (op && isa<ttg::LocalAllocOp>(op) &&
-        cast<ttg::LocalAllocOp>(op).getSrc())
-      return true;
-    // root and not BlockArgument
-    if (!op && !isa<BlockArgument>(operand))
-      return false;
-    // op and not BlockArgument
-    if (op && !isa<BlockArgument>(operand)) {
-      for (auto v : op->getOperands()) {
-        if (dependOnSharedEncOperand(v))
-          return true;
-      }
+  // Collects the generic proxy writes to the shared memory buffers the
+  // memory descriptor may point to.
+  void collectGenericWriters(Value operand,
+                             llvm::SetVector<Operation *> &writers,
+                             DenseSet<Value> &visited) {
+    if (!isa<tt::MemDescType>(operand.getType()) ||
+        !visited.insert(operand).second)
+      return;
+    if (auto arg = dyn_cast<BlockArgument>(operand)) {
+      // TODO: support other scf ops, WhileOp, etc.
+      auto forOp = dyn_cast<scf::ForOp>(arg.getOwner()->getParentOp());
+      if (!forOp || arg.getArgNumber() == 0)
+        return;
+      unsigned iterArgNum = arg.getArgNumber() - 1;
+      collectGenericWriters(forOp.getInitArgs()[iterArgNum], writers, visited);
+      collectGenericWriters(
+          forOp.getBody()->getTerminator()->getOperand(iterArgNum), writers,
+          visited);
+      return;
+    }
+    Operation *op = operand.getDefiningOp();
+    if (auto alloc = dyn_cast<ttg::LocalAllocOp>(op)) {
+      if (alloc.getSrc())
+        writers.insert(alloc);
+      DenseSet<Value> visitedUses;
+      collectLocalStores(alloc.getResult(), writers, visitedUses);
+      return;
     }
-    // reach BlockArgument
-    // TODO: support other scf ops, IfOp, WhileOp, etc.
-    if (BlockArgument arg = dyn_cast<BlockArgument>(operand)) {
-      unsigned argNum = arg.getArgNumber();
-      Operation *argOwner = arg.getOwner()->getParentOp();
-      // support ForOp only
-      if (auto forOp = dyn_cast<scf::ForOp>(argOwner)) {
-        // prologue
-        auto iterOperands = forOp.getInitArgs();
-        if (argNum == 0)
-          return false;
-        if (dependOnSharedEncOperand(iterOperands[argNum - 1]))
-          return true;
-        // yield
-        auto yieldOp = forOp.getBody()->getTerminator();
-        Value v = yieldOp->getOperand(argNum - 1);
-        auto entry = std::make_pair<Operation *, unsigned>(std::move(yieldOp),
-                                                           std::move(argNum));
-        // avoid cyclic
-        if (trace.contains(entry))
-          return false;
-        else
-          trace.insert(entry);
+    if (isa<ttg::MemDescSubviewOp, tt::TransOp>(op)) {
+      collectGenericWriters(op->getOperand(0), writers, visited);
+      return;
+    }
+    if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+      unsigned resultNum = cast<OpResult>(operand).getResultNumber();
+      collectGenericWriters(forOp.getInitArgs()[resultNum], writers, visited);
+      collectGenericWriters(
+          forOp.getBody()->getTerminator()->getOperand(resultNum), writers,
+          visited);
+      return;
+    }
+    if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+      unsigned resultNum = cast<OpResult>(operand).getResultNumber();
+      collectGenericWriters(ifOp.thenYield().getOperand(resultNum), writers,
+                            visited);
+      if (ifOp.elseBlock())
+        collectGenericWriters(ifOp.elseYield().getOperand(resultNum), writers,
+                              visited);
+      return;
+    }
+    // Unknown producers of memory descriptors are conservatively considered
+    // as generic writes.
+    writers.insert(op);
+  }
 
-        if (dependOnSharedEncOperand(v))
-          return true;
-      } else if (auto whileOp = dyn_cast<scf::WhileOp>(argOwner)) {
-        assert(false && "FenceInsertionPass does not supported WhileOp");
-      } else if (auto ifOp = dyn_cast<scf::IfOp>(argOwner)) {
-        assert(false && "FenceInsertionPass does not supported IfOp");
+  // Collects the local_store ops writing to the given buffer or its views.
+  void collectLocalStores(Value buffer, llvm::SetVector<Operation *> &writers,
+                          DenseSet<Value> &visited) {
+    if (!visited.insert(buffer).second)
+      return;
+    for (OpOperand &use : buffer.getUses()) {
+      Operation *user = use.getOwner();
+      if (auto store = dyn_cast<ttg::LocalStoreOp>(user)) {
+        if (store.getDst() == buffer)
+          writers.insert(store);
+      } else if (isa<ttg::MemDescSubviewOp, tt::TransOp>(user)) {
+        collectLocalStores(user->getResult(0), writers, visited);
+      } else if (auto forOp = dyn_cast<scf::ForOp>(user)) {
+        unsigned iterArgNum =
+            use.getOperandNumber() - forOp.getNumControlOperands();
+        collectLocalStores(forOp.getRegionIterArg(iterArgNum), writers,
+                           visited);
+        collectLocalStores(forOp.getResult(iterArgNum), writers, visited);
+      } else if (auto yieldOp = dyn_cast<scf::YieldOp>(user)) {
+        Operation *parent = yieldOp->getParentOp();
+        unsigned resultNum = use.getOperandNumber();
+        if (auto forOp = dyn_cast<scf::ForOp>(parent)) {
+          collectLocalStores(forOp.getRegionIterArg(resultNum), writers,
+                             visited);
+          collectLocalStores(forOp.getResult(resultNum), writers, visited);
+        } else if (auto ifOp = dyn_cast<scf::IfOp>(parent)) {
+          collectLocalStores(ifOp.getResult(resultNum), writers, visited);
+        }
       }
     }
-    return false;
   }
 };
 } // namespace
@@ -21,6 +21,7 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <limits>
 #include <queue>
 
 #include "mlir/Support/LLVM.h"
@@ -240,9 +241,15 @@ void CTAPlanner::setTiling(llvm::ArrayRef<unsigned> CTAsPerCGA) {
 }
 
 bool CTAPlanner::processDot(triton::FuncOp &funcOp) {
-  // TODO: This is a naive implementation and should be refactored
-  auto getCTATiling = [](int64_t M, int64_t N, int64_t K,
-                         unsigned numCTAs) -> std::pair<unsigned, unsigned> {
+  // The CTAs of a row of the cluster share their tile of A, and the CTAs of a
+  // column their tile of B, which the cluster loads once and multicasts. The
+  // operands each CTA keeps in shared memory, and loads when they are not
+  // multicast, are proportional to the perimeter of its tile of D, so the
+  // cluster shape that makes the tiles squarest is chosen, among the shapes
+  // that leave each CTA at least 64 rows and columns. Ties prefer splitting M.
+  auto getLegacyCTATiling =
+      [](int64_t M, int64_t N,
+         unsigned numCTAs) -> std::pair<unsigned, unsigned> {
     // prefer a larger chunk size, at most 128; first assign splitM.
     unsigned chunk_m = 128;
     auto isLegal = [](unsigned chunk) { return chunk >= 64; };
@@ -256,7 +263,44 @@ bool CTAPlanner::processDot(triton::FuncOp &funcOp) {
     return {splitM, splitN};
   };
 
-  funcOp.walk([&](triton::DotOp dot) {
+  SmallVector<triton::DotOp> dots;
+  funcOp.walk([&](triton::DotOp dot) { dots.push_back(dot); });
+  if (dots.empty())
+    return true;
+
+  auto getMN = [](triton::DotOp dot) -> std::pair<int64_t, int64_t> {
+    auto dTy = cast<RankedTensorType>(dot.getD().getType());
+    return {dTy.getShape()[0], dTy.getShape()[1]};
+  };
+
+  // All the dots share the tiling of the cluster
+  auto firstTy = cast<RankedTensorType>(dots.front().getD().getType());
+  unsigned numCTAs = ttg::getNumCTAs(firstTy.getEncoding());
+  std::optional<std::pair<unsigned, unsigned>> tiling;
+  int64_t bestCost = std::numeric_limits<int64_t>::max();
+  for (unsigned splitM = numCTAs; splitM >= 1; splitM /= 2) {
+    unsigned splitN = numCTAs / splitM;
+    int64_t cost = 0;
+    bool legal = true;
+    for (triton::DotOp dot : dots) {
+      auto [M, N] = getMN(dot);
+      unsigned K = cast<RankedTensorType>(dot.getA().getType()).getShape()[1];
+      legal &= M / splitM >= 64 && N / splitN >= 64;
+      cost += (M / splitM + N / splitN) * K;
+    }
+    if (legal && cost < bestCost) {
+      bestCost = cost;
+      tiling = {splitM, splitN};
+    }
+  }
+  if (!tiling) {
+    auto [M, N] = getMN(dots.front());
+    tiling = getLegacyCTATiling(M, N, numCTAs);
+  }
+  auto [splitM, splitN] = *tiling;
+  setTiling({splitM, splitN, 1});
+
+  for (triton::DotOp dot : dots) {
     MLIRContext *ctx = dot.getContext();
 
     auto aTy = cast<RankedTensorType>(dot.getA().getType());
@@ -272,15 +316,6 @@ bool CTAPlanner::processDot(triton::FuncOp &funcOp) {
     auto bLayout = cast<ttg::DotOperandEncodingAttr>(bTy.getEncoding());
     auto dLayout = cast<ttg::BlockedEncodingAttr>(dTy.getEncoding());
 
-    unsigned M = dTy.getShape()[0];
-    unsigned N = dTy.getShape()[1];
-    unsigned K = aTy.getShape()[1];
-
-    unsigned splitM, splitN;
-    std::tie(splitM, splitN) = getCTATiling(M, N, K, ttg::getNumCTAs(dLayout));
-    // FIXME: Should consider IR with more than one DotOps
-    setTiling({splitM, splitN, 1});
-
     auto newCTALayout = ttg::CTALayoutAttr::get(ctx, {splitM, splitN},
                                                 {splitM, splitN}, {1, 0});
     auto newDLayout = ttg::BlockedEncodingAttr::get(
@@ -293,7 +328,7 @@ bool CTAPlanner::processDot(triton::FuncOp &funcOp) {
 
     insertCasts(dot.getOperation(), {newALayout, newBLayout, newDLayout},
                 {newDLayout});
-  });
+  }
 
   return true;
 }
@@ -1031,7 +1066,6 @@ mlir::createTritonNvidiaGPUPlanCTAPass(ttng::ClusterInfo *clusterInfo) {
  * - Use ConvertLayoutOp instead of UnrealizedConversionCastOp.
  * - Move PlanCTAPass to the front of CoalescePass.
  * - Design better tiling strategy for DotOp and ReduceOp.
- * - Consider cases where there are more than one DotOps.
  * - Use better data structure for erasing CastOps from queue (linked list?).
  * - Process eliminable CastOps in higher priority.
  * - Fix the clone func bug in PlanCTAPass::runOnOperation.
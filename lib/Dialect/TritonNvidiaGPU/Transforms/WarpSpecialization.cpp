@@ -0,0 +1,475 @@
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/IR/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+//===----------------------------------------------------------------------===//
+//
+// This pass splits a kernel whose top-level loop loads its operands with TMA
+// into a producer warp group, which only issues the TMA loads of the loop, and
+// the num_warps consumer warps, which run the whole kernel with the loads
+// replaced by the buffers the producer fills:
+//
+//   init full[i] and empty[i] barriers; bar.sync of all the warps
+//   if (tid >= num_warps * 32) {          // producer
+//     setmaxnreg.dec
+//     for k: wait empty[k % n], expect full[k % n], TMA copies into buf[k % n]
+//   } else {                              // consumers
+//     setmaxnreg.inc
+//     ...
+//     for k: wait full[k % n], use buf[k % n], arrive empty[k % n]
+//     ...
+//   }
+//
+// The layouts of the consumer code are the ones of the num_warps warps, the
+// lowering numbers the producer warps from 0 too and gives them barriers of
+// their own, see triton_gpu.num-producer-warps.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace tt = ::mlir::triton;
+namespace ttg = ::mlir::triton::gpu;
+namespace ttng = ::mlir::triton::nvidia_gpu;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonNvidiaGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// setmaxnreg applies to whole warp groups.
+constexpr int kNumWarpsPerGroup = 4;
+
+// The scalar computations that the producer warps repeat to issue the loads of
+// the loop: the coordinates and the descriptors of the loads, the bounds of the
+// loop and the loop-carried values they depend on.
+struct ProducerSlice {
+  // In program order.
+  SmallVector<Operation *> opsBeforeLoop;
+  SmallVector<Operation *> opsInLoop;
+  // Sorted indices of the loop-carried values.
+  SmallVector<unsigned> iterArgs;
+};
+
+bool isScalarComputation(Operation *op) {
+  return op->getNumRegions() == 0 && isMemoryEffectFree(op) &&
+         llvm::none_of(op->getResultTypes(),
+                       [](Type type) { return isa<ShapedType>(type); });
+}
+
+// Collects the computations of the values the producer warps need. Fails if
+// one of them isn't a scalar computed from the arguments of the kernel, the
+// induction variable and the scalar loop-carried values of `forOp`.
+LogicalResult collectProducerSlice(scf::ForOp forOp, ArrayRef<Value> roots,
+                                   ProducerSlice &slice) {
+  Block *body = forOp.getBody();
+  Block *entry = forOp->getBlock();
+  DenseSet<Operation *> ops;
+  llvm::SmallSetVector<unsigned, 4> iterArgs;
+  SmallVector<Value> worklist(roots.begin(), roots.end());
+  DenseSet<Value> visited;
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    if (!visited.insert(value).second)
+      continue;
+    if (auto arg = dyn_cast<BlockArgument>(value)) {
+      if (arg.getOwner() == entry)
+        continue;
+      if (arg.getOwner() != body || isa<ShapedType>(arg.getType()))
+        return failure();
+      if (arg == forOp.getInductionVar())
+        continue;
+      unsigned idx = arg.getArgNumber() - forOp.getNumInductionVars();
+      iterArgs.insert(idx);
+      worklist.push_back(forOp.getInitArgs()[idx]);
+      worklist.push_back(body->getTerminator()->getOperand(idx));
+      continue;
+    }
+    Operation *op = value.getDefiningOp();
+    if (!isScalarComputation(op) ||
+        (op->getBlock() != body && op->getBlock() != entry))
+      return failure();
+    ops.insert(op);
+    worklist.append(op->operand_begin(), op->operand_end());
+  }
+  for (Operation &op : *entry) {
+    if (&op == forOp.getOperation())
+      break;
+    if (ops.contains(&op))
+      slice.opsBeforeLoop.push_back(&op);
+  }
+  for (Operation &op : *body) {
+    if (ops.contains(&op))
+      slice.opsInLoop.push_back(&op);
+  }
+  slice.iterArgs = iterArgs.takeVector();
+  llvm::sort(slice.iterArgs);
+  return success();
+}
+
+// The shared memory layout of the TMA copies, which is the one of the
+// descriptors filled by the driver, see the TMA lowering.
+ttg::SharedEncodingAttr getTMASharedEncoding(RankedTensorType tensorType) {
+  auto order = ttg::getOrder(tensorType.getEncoding());
+  auto ctaLayout = ttg::getCTALayout(tensorType.getEncoding());
+  if (tensorType.getRank() == 2)
+    return ttg::SharedEncodingAttr::get(tensorType.getContext(),
+                                        tensorType.getShape(), order,
+                                        ctaLayout, tensorType.getElementType());
+  return ttg::SharedEncodingAttr::get(tensorType.getContext(), 1, 1, 1, order,
+                                      ctaLayout);
+}
+
+// Returns the buffer `index` of the buffers in `alloc`.
+Value createSubview(OpBuilder &builder, Location loc, Value alloc,
+                    Value index) {
+  auto allocTy = cast<tt::MemDescType>(alloc.getType());
+  auto viewTy = tt::MemDescType::get(
+      allocTy.getShape().drop_front(), allocTy.getElementType(),
+      allocTy.getEncoding(), allocTy.getMemorySpace(), /*mutableMemory=*/true);
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  SmallVector<Value> offsets(allocTy.getRank(), zero);
+  offsets[0] = index;
+  return builder.create<ttg::MemDescSubviewOp>(loc, viewTy, alloc, offsets);
+}
+
+// Returns the barrier `index` of the barriers in `alloc`.
+Value createBarrierView(OpBuilder &builder, Location loc, Value alloc,
+                        Value index) {
+  auto allocTy = cast<tt::MemDescType>(alloc.getType());
+  auto barrierTy = tt::MemDescType::get(
+      {1}, allocTy.getElementType(), allocTy.getEncoding(),
+      allocTy.getMemorySpace(), /*mutableMemory=*/true);
+  return builder.create<ttg::MemDescSubviewOp>(loc, barrierTy, alloc,
+                                               ValueRange{index});
+}
+
+Value createBarriers(OpBuilder &builder, Location loc, int numBarriers,
+                     int count) {
+  MLIRContext *ctx = builder.getContext();
+  auto barrierCTALayout =
+      ttg::CTALayoutAttr::get(ctx, /*CTAsPerCGA=*/{1},
+                              /*CTASplitNum=*/{1}, /*CTAOrder=*/{0});
+  auto barrierEncoding =
+      ttg::SharedEncodingAttr::get(ctx, 1, 1, 1, {0}, barrierCTALayout);
+  auto barriersTy = tt::MemDescType::get(
+      {numBarriers}, builder.getI64Type(), barrierEncoding,
+      ttg::SharedMemorySpaceAttr::get(ctx), /*mutableMemory=*/true);
+  Value barriers = builder.create<ttg::LocalAllocOp>(loc, barriersTy, Value());
+  for (int i = 0; i < numBarriers; i++) {
+    Value idx = builder.create<arith::ConstantIntOp>(loc, i, 32);
+    builder.create<ttng::InitBarrierOp>(
+        loc, createBarrierView(builder, loc, barriers, idx), count);
+  }
+  return barriers;
+}
+
+void invalidateBarriers(OpBuilder &builder, Location loc, Value barriers) {
+  int numBarriers = cast<tt::MemDescType>(barriers.getType()).getShape()[0];
+  for (int i = 0; i < numBarriers; i++) {
+    Value idx = builder.create<arith::ConstantIntOp>(loc, i, 32);
+    builder.create<ttng::InvalBarrierOp>(
+        loc, createBarrierView(builder, loc, barriers, idx));
+  }
+}
+
+// Returns the buffer and the phase of the next iteration.
+std::pair<Value, Value> createNextBuffer(OpBuilder &builder, Location loc,
+                                         Value buffer, Value phase,
+                                         int numBuffers) {
+  Value one = builder.create<arith::ConstantIntOp>(loc, 1, 32);
+  Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  Value next = builder.create<arith::AddIOp>(loc, buffer, one);
+  Value wrap = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, next,
+      builder.create<arith::ConstantIntOp>(loc, numBuffers, 32));
+  next = builder.create<arith::SelectOp>(loc, wrap, zero, next);
+  Value flipped = builder.create<arith::XOrIOp>(loc, phase, one);
+  phase = builder.create<arith::SelectOp>(loc, wrap, flipped, phase);
+  return {next, phase};
+}
+
+struct WarpSpecializationPass
+    : public TritonNvidiaGPUWarpSpecializationPassBase<WarpSpecializationPass> {
+public:
+  WarpSpecializationPass() = default;
+  WarpSpecializationPass(int numConsumerGroups, int numBuffers,
+                         int producerRegCount, int consumerRegCount) {
+    this->numConsumerGroups = numConsumerGroups;
+    this->numBuffers = numBuffers;
+    this->producerRegCount = producerRegCount;
+    this->consumerRegCount = consumerRegCount;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    int numWarps = ttg::TritonGPUDialect::getNumWarps(mod);
+    if (numWarps != numConsumerGroups * kNumWarpsPerGroup) {
+      mod.emitError("warp specialization needs num_warps to be ")
+          << kNumWarpsPerGroup << " warps per consumer group, got "
+          << numWarps << " warps for " << numConsumerGroups << " groups";
+      return signalPassFailure();
+    }
+    if (numBuffers < 1) {
+      mod.emitError("warp specialization needs at least one buffer");
+      return signalPassFailure();
+    }
+    if (ttg::TritonGPUDialect::getNumCTAs(mod) != 1)
+      return;
+
+    bool specialized = false;
+    mod.walk([&](tt::FuncOp funcOp) {
+      if (!funcOp.isPublic() || funcOp.getNumResults() != 0 ||
+          !funcOp.getBody().hasOneBlock())
+        return;
+      for (auto forOp : funcOp.getBody().front().getOps<scf::ForOp>()) {
+        ProducerSlice slice;
+        SmallVector<tt::ExperimentalDescriptorLoadOp> loads;
+        if (succeeded(analyzeLoop(forOp, loads, slice))) {
+          specialize(funcOp, forOp, loads, slice);
+          specialized = true;
+          break;
+        }
+      }
+    });
+    if (specialized)
+      mod->setAttr(ttg::TritonGPUDialect::getNumProducerWarpsAttrName(),
+                   IntegerAttr::get(IntegerType::get(mod.getContext(), 32),
+                                    kNumWarpsPerGroup));
+  }
+
+private:
+  LogicalResult
+  analyzeLoop(scf::ForOp forOp,
+              SmallVectorImpl<tt::ExperimentalDescriptorLoadOp> &loads,
+              ProducerSlice &slice) {
+    // Other loads would wait on their data in the consumer warps.
+    bool hasOtherLoads = false;
+    forOp.walk([&](Operation *op) {
+      if (auto load = dyn_cast<tt::ExperimentalDescriptorLoadOp>(op)) {
+        if (load->getBlock() == forOp.getBody())
+          loads.push_back(load);
+        else
+          hasOtherLoads = true;
+      } else if (isa<tt::LoadOp>(op)) {
+        hasOtherLoads = true;
+      }
+    });
+    if (loads.empty() || hasOtherLoads)
+      return failure();
+    SmallVector<Value> roots = {forOp.getLowerBound(), forOp.getUpperBound(),
+                                forOp.getStep()};
+    for (auto load : loads) {
+      roots.push_back(load.getDescPtr());
+      roots.append(load.getIndices().begin(), load.getIndices().end());
+      roots.append(load.getIm2colOffsets().begin(),
+                   load.getIm2colOffsets().end());
+    }
+    return collectProducerSlice(forOp, roots, slice);
+  }
+
+  void specialize(tt::FuncOp funcOp, scf::ForOp forOp,
+                  ArrayRef<tt::ExperimentalDescriptorLoadOp> loads,
+                  const ProducerSlice &slice) {
+    MLIRContext *ctx = funcOp.getContext();
+    ModuleOp mod = getOperation();
+    Location loc = forOp.getLoc();
+    Block &entry = funcOp.getBody().front();
+    int numConsumerThreads = ttg::TritonGPUDialect::getNumWarps(mod) *
+                             ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+    int numProducerThreads =
+        kNumWarpsPerGroup * ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+
+    // The buffers and the barriers are set up by all the warps.
+    OpBuilder builder(&entry, entry.begin());
+    SmallVector<Value> buffers;
+    int bytesPerIteration = 0;
+    for (auto load : loads) {
+      RankedTensorType tensorTy = load.getType();
+      SmallVector<int64_t> shape = {numBuffers.getValue()};
+      shape.append(tensorTy.getShape().begin(), tensorTy.getShape().end());
+      auto bufferTy = tt::MemDescType::get(
+          shape, tensorTy.getElementType(), getTMASharedEncoding(tensorTy),
+          ttg::SharedMemorySpaceAttr::get(ctx), /*mutableMemory=*/true);
+      buffers.push_back(
+          builder.create<ttg::LocalAllocOp>(loc, bufferTy, Value()));
+      bytesPerIteration += product(tensorTy.getShape()) *
+                           tensorTy.getElementTypeBitWidth() / 8;
+    }
+    // The producer expects the bytes of all the copies of an iteration, each
+    // consumer thread releases the buffers once it's done with them.
+    Value fullBarriers = createBarriers(builder, loc, numBuffers, 1);
+    Value emptyBarriers =
+        createBarriers(builder, loc, numBuffers, numConsumerThreads);
+    auto sync = builder.create<gpu::BarrierOp>(loc);
+    sync->setAttr("bar_id", builder.getI32IntegerAttr(0));
+    sync->setAttr("num_threads", builder.getI32IntegerAttr(
+                                     numConsumerThreads + numProducerThreads));
+    Value tid = builder.create<gpu::ThreadIdOp>(loc, gpu::Dimension::x);
+    tid = builder.create<arith::IndexCastOp>(loc, builder.getI32Type(), tid);
+    Value isProducer = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::uge, tid,
+        builder.create<arith::ConstantIntOp>(loc, numConsumerThreads, 32));
+    auto ifOp = builder.create<scf::IfOp>(loc, isProducer,
+                                          /*withElseRegion=*/true);
+
+    // The consumer warps run the kernel.
+    Block *consumerBlock = ifOp.elseBlock();
+    consumerBlock->getOperations().splice(
+        consumerBlock->getTerminator()->getIterator(), entry.getOperations(),
+        std::next(ifOp->getIterator()), entry.getTerminator()->getIterator());
+    createProducer(ifOp.thenBlock(), forOp, loads, slice, buffers,
+                   fullBarriers, emptyBarriers, bytesPerIteration);
+    createConsumer(consumerBlock, forOp, loads, buffers, fullBarriers,
+                   emptyBarriers);
+  }
+
+  void createProducer(Block *block, scf::ForOp forOp,
+                      ArrayRef<tt::ExperimentalDescriptorLoadOp> loads,
+                      const ProducerSlice &slice, ArrayRef<Value> buffers,
+                      Value fullBarriers, Value emptyBarriers,
+                      int bytesPerIteration) {
+    Location loc = forOp.getLoc();
+    OpBuilder builder(block, block->begin());
+    builder.create<ttng::RegDeallocOp>(loc, producerRegCount.getValue());
+    IRMapping mapping;
+    auto remap = [&](ValueRange values) {
+      SmallVector<Value> remapped;
+      for (Value value : values)
+        remapped.push_back(mapping.lookupOrDefault(value));
+      return remapped;
+    };
+    for (Operation *op : slice.opsBeforeLoop)
+      builder.clone(*op, mapping);
+    Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+    SmallVector<Value> initArgs;
+    for (unsigned idx : slice.iterArgs)
+      initArgs.push_back(mapping.lookupOrDefault(forOp.getInitArgs()[idx]));
+    initArgs.append({zero, zero});
+    auto producerLoop = builder.create<scf::ForOp>(
+        loc, mapping.lookupOrDefault(forOp.getLowerBound()),
+        mapping.lookupOrDefault(forOp.getUpperBound()),
+        mapping.lookupOrDefault(forOp.getStep()), initArgs);
+    producerLoop->setAttr(tt::kNumStagesAttrName, builder.getI32IntegerAttr(1));
+
+    Block *body = producerLoop.getBody();
+    builder.setInsertionPointToStart(body);
+    mapping.map(forOp.getInductionVar(), producerLoop.getInductionVar());
+    for (auto [i, idx] : llvm::enumerate(slice.iterArgs))
+      mapping.map(forOp.getRegionIterArg(idx),
+                  producerLoop.getRegionIterArg(i));
+    for (Operation *op : slice.opsInLoop)
+      builder.clone(*op, mapping);
+
+    Value buffer = body->getArgument(body->getNumArguments() - 2);
+    Value phase = body->getArgument(body->getNumArguments() - 1);
+    // The wait for the first use of a buffer returns at once, as it's for the
+    // phase before the first phase of the barrier.
+    Value one = builder.create<arith::ConstantIntOp>(loc, 1, 32);
+    Value emptyPhase = builder.create<arith::XOrIOp>(loc, phase, one);
+    Value emptyBarrier = createBarrierView(builder, loc, emptyBarriers, buffer);
+    builder.create<ttng::WaitBarrierOp>(loc, emptyBarrier, emptyPhase);
+    Value fullBarrier = createBarrierView(builder, loc, fullBarriers, buffer);
+    Value pred = builder.create<arith::ConstantIntOp>(loc, 1, 1);
+    builder.create<ttng::BarrierExpectOp>(loc, fullBarrier, bytesPerIteration,
+                                          pred);
+    for (auto [load, alloc] : llvm::zip(loads, buffers)) {
+      builder.create<ttng::AsyncTMACopyGlobalToLocalOp>(
+          load.getLoc(), mapping.lookupOrDefault(load.getDescPtr()),
+          remap(load.getIndices()), remap(load.getIm2colOffsets()),
+          fullBarrier, createSubview(builder, loc, alloc, buffer), pred);
+    }
+
+    auto [nextBuffer, nextPhase] =
+        createNextBuffer(builder, loc, buffer, phase, numBuffers);
+    SmallVector<Value> yields;
+    Operation *yield = forOp.getBody()->getTerminator();
+    for (unsigned idx : slice.iterArgs)
+      yields.push_back(mapping.lookupOrDefault(yield->getOperand(idx)));
+    yields.append({nextBuffer, nextPhase});
+    builder.create<scf::YieldOp>(loc, yields);
+  }
+
+  void createConsumer(Block *block, scf::ForOp forOp,
+                      ArrayRef<tt::ExperimentalDescriptorLoadOp> loads,
+                      ArrayRef<Value> buffers, Value fullBarriers,
+                      Value emptyBarriers) {
+    Location loc = forOp.getLoc();
+    IRRewriter rewriter(forOp.getContext());
+    rewriter.setInsertionPointToStart(block);
+    rewriter.create<ttng::RegAllocOp>(loc, consumerRegCount.getValue());
+
+    rewriter.setInsertionPoint(forOp);
+    Value zero = rewriter.create<arith::ConstantIntOp>(loc, 0, 32);
+    scf::ForOp newForOp =
+        replaceForOpWithNewSignature(rewriter, forOp, {zero, zero});
+    forOp.erase();
+    forOp = newForOp;
+    forOp->setAttr(tt::kNumStagesAttrName, rewriter.getI32IntegerAttr(1));
+    Block *body = forOp.getBody();
+    Value buffer = body->getArgument(body->getNumArguments() - 2);
+    Value phase = body->getArgument(body->getNumArguments() - 1);
+
+    rewriter.setInsertionPoint(loads.front());
+    rewriter.create<ttng::WaitBarrierOp>(
+        loc, createBarrierView(rewriter, loc, fullBarriers, buffer), phase);
+    for (auto [load, alloc] : llvm::zip(loads, buffers)) {
+      rewriter.setInsertionPoint(load);
+      Value view = createSubview(rewriter, load.getLoc(), alloc, buffer);
+      auto viewEncoding = cast<tt::MemDescType>(view.getType()).getEncoding();
+      // The allocations of the loaded tensors that are only used in the
+      // iteration read the buffer in place.
+      for (Operation *user : llvm::make_early_inc_range(load->getUsers())) {
+        auto localAlloc = dyn_cast<ttg::LocalAllocOp>(user);
+        if (!localAlloc || localAlloc->getBlock() != body ||
+            localAlloc.getType().getEncoding() != viewEncoding ||
+            llvm::any_of(localAlloc->getUsers(), [&](Operation *allocUser) {
+              return isa<scf::YieldOp>(allocUser) ||
+                     !forOp->isProperAncestor(allocUser);
+            }))
+          continue;
+        rewriter.replaceOp(localAlloc, view);
+      }
+      if (load->use_empty()) {
+        rewriter.eraseOp(load);
+        continue;
+      }
+      rewriter.replaceOpWithNewOp<ttg::LocalLoadOp>(load, load.getType(),
+                                                    view);
+    }
+
+    // The wgmmas that read the buffers are synchronous, they are done once
+    // the iteration is.
+    auto yield = cast<scf::YieldOp>(body->getTerminator());
+    rewriter.setInsertionPoint(yield);
+    Value pred = rewriter.create<arith::ConstantIntOp>(loc, 1, 1);
+    rewriter.create<ttng::ArriveBarrierOp>(
+        loc, createBarrierView(rewriter, loc, emptyBarriers, buffer), 1, pred);
+    auto [nextBuffer, nextPhase] =
+        createNextBuffer(rewriter, loc, buffer, phase, numBuffers);
+    yield->insertOperands(yield->getNumOperands(), {nextBuffer, nextPhase});
+
+    // The producer is done with the barriers once the consumers have waited
+    // for its last copies.
+    rewriter.setInsertionPointAfter(forOp);
+    invalidateBarriers(rewriter, loc, fullBarriers);
+    invalidateBarriers(rewriter, loc, emptyBarriers);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::createTritonNvidiaGPUWarpSpecializationPass(
+    int numConsumerGroups, int numBuffers, int producerRegCount,
+    int consumerRegCount) {
+  return std::make_unique<WarpSpecializationPass>(
+      numConsumerGroups, numBuffers, producerRegCount, consumerRegCount);
+}
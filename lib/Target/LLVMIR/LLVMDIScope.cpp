@@ -144,12 +144,24 @@ struct LLVMDIScopePass : public LLVMDIScopeBase<LLVMDIScopePass> {
     }
   }
 
+  // Flatten the inline stack to the location of the outermost call, which is
+  // in the file of the subprogram of the function
+  void setOutermostCallerLoc(Operation *op) {
+    Location loc = op->getLoc();
+    while (auto callSiteLoc = dyn_cast<CallSiteLoc>(loc))
+      loc = callSiteLoc.getCaller();
+    if (loc != op->getLoc())
+      op->setLoc(loc);
+  }
+
   void runOnOperation() override {
     getOperation()->walk<WalkOrder::PreOrder>([&](Operation *op) -> void {
       if (isa<LLVM::LLVMFuncOp>(op))
         setSubprogramAttr(cast<LLVM::LLVMFuncOp>(op));
-      else
+      else if (inlinedScopes)
         setLexicalBlockFileAttr(op);
+      else
+        setOutermostCallerLoc(op);
     });
   }
 };
@@ -159,3 +171,9 @@ struct LLVMDIScopePass : public LLVMDIScopeBase<LLVMDIScopePass> {
 std::unique_ptr<Pass> mlir::createLLVMDIScopePass() {
   return std::make_unique<LLVMDIScopePass>();
 }
+
+std::unique_ptr<Pass> mlir::createLLVMDIScopePass(bool inlinedScopes) {
+  auto pass = std::make_unique<LLVMDIScopePass>();
+  pass->inlinedScopes = inlinedScopes;
+  return pass;
+}
@@ -0,0 +1,192 @@
+//===----------------------------------------------------------------------===//
+/// Implements a pass scalarizing the phi and select instructions of struct
+/// type, which hold the elements of the tensors carried by loops and
+/// branches. Unlike the pass breaking phis of struct, the elements are looked
+/// up through the insertvalue chains building the structs and nested structs
+/// are split too, so that no struct is rebuilt around the new instructions
+/// unless it is used as a whole.
+//===----------------------------------------------------------------------===//
+#include "LLVMPasses.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+using namespace llvm;
+
+namespace {
+
+class StructScalarizer {
+public:
+  explicit StructScalarizer(Function &F) : F(F), builder(F.getContext()) {}
+
+  bool run();
+
+private:
+  Value *getElement(Value *agg, unsigned idx, Instruction *insertPt);
+  void splitPhi(PHINode *phi);
+  void splitSelect(SelectInst *select);
+  void replaceUses(Instruction *inst);
+
+  Function &F;
+  IRBuilder<> builder;
+  // The elements of the phis and selects being scalarized
+  DenseMap<Value *, SmallVector<Value *>> elements;
+};
+
+Value *StructScalarizer::getElement(Value *agg, unsigned idx,
+                                    Instruction *insertPt) {
+  while (auto *insert = dyn_cast<InsertValueInst>(agg)) {
+    ArrayRef<unsigned> indices = insert->getIndices();
+    if (indices[0] == idx) {
+      if (indices.size() == 1)
+        return insert->getInsertedValueOperand();
+      // only a part of the element is inserted
+      break;
+    }
+    agg = insert->getAggregateOperand();
+  }
+  auto it = elements.find(agg);
+  if (it != elements.end())
+    return it->second[idx];
+  if (auto *constant = dyn_cast<Constant>(agg))
+    if (Constant *element = constant->getAggregateElement(idx))
+      return element;
+  builder.SetInsertPoint(insertPt);
+  // extract nested elements from the outermost struct at once
+  if (auto *extract = dyn_cast<ExtractValueInst>(agg)) {
+    SmallVector<unsigned> indices(extract->getIndices());
+    indices.push_back(idx);
+    return builder.CreateExtractValue(extract->getAggregateOperand(), indices);
+  }
+  return builder.CreateExtractValue(agg, idx);
+}
+
+void StructScalarizer::splitPhi(PHINode *phi) {
+  ArrayRef<Value *> phiElements = elements[phi];
+  for (unsigned i = 0; i < phiElements.size(); ++i) {
+    auto *elementPhi = cast<PHINode>(phiElements[i]);
+    for (unsigned j = 0; j < phi->getNumIncomingValues(); ++j) {
+      BasicBlock *pred = phi->getIncomingBlock(j);
+      // the entries of a predecessor listed twice must have the same value
+      int k = elementPhi->getBasicBlockIndex(pred);
+      Value *value = k >= 0 ? elementPhi->getIncomingValue(k)
+                            : getElement(phi->getIncomingValue(j), i,
+                                         pred->getTerminator());
+      elementPhi->addIncoming(value, pred);
+    }
+  }
+}
+
+void StructScalarizer::splitSelect(SelectInst *select) {
+  auto *structTy = cast<StructType>(select->getType());
+  SmallVector<Value *> selectElements;
+  for (unsigned i = 0; i < structTy->getNumElements(); ++i) {
+    Value *trueValue = getElement(select->getTrueValue(), i, select);
+    Value *falseValue = getElement(select->getFalseValue(), i, select);
+    builder.SetInsertPoint(select);
+    selectElements.push_back(
+        builder.CreateSelect(select->getCondition(), trueValue, falseValue,
+                             select->getName() + ".elt" + Twine(i)));
+  }
+  elements[select] = std::move(selectElements);
+}
+
+void StructScalarizer::replaceUses(Instruction *inst) {
+  ArrayRef<Value *> instElements = elements[inst];
+  Value *rebuilt = nullptr;
+  for (Use &use : make_early_inc_range(inst->uses())) {
+    auto *user = cast<Instruction>(use.getUser());
+    // the phis and selects being scalarized are erased
+    if (elements.count(user))
+      continue;
+    if (auto *extract = dyn_cast<ExtractValueInst>(user)) {
+      Value *element = instElements[extract->getIndices()[0]];
+      if (extract->getNumIndices() > 1) {
+        builder.SetInsertPoint(extract);
+        element = builder.CreateExtractValue(
+            element, extract->getIndices().drop_front());
+      }
+      extract->replaceAllUsesWith(element);
+      extract->eraseFromParent();
+      continue;
+    }
+    // the other users take the struct as a whole
+    if (!rebuilt) {
+      if (isa<PHINode>(inst))
+        builder.SetInsertPoint(inst->getParent(),
+                               inst->getParent()->getFirstInsertionPt());
+      else
+        builder.SetInsertPoint(inst->getNextNode());
+      rebuilt = UndefValue::get(inst->getType());
+      for (unsigned i = 0; i < instElements.size(); ++i)
+        rebuilt = builder.CreateInsertValue(rebuilt, instElements[i], i);
+    }
+    use.set(rebuilt);
+  }
+}
+
+bool StructScalarizer::run() {
+  bool changed = false;
+  // each round splits one level of the nested structs
+  while (true) {
+    SmallVector<Instruction *> worklist;
+    ReversePostOrderTraversal<Function *> rpot(&F);
+    for (BasicBlock *block : rpot)
+      for (Instruction &inst : *block)
+        if (isa<PHINode, SelectInst>(inst) && isa<StructType>(inst.getType()))
+          worklist.push_back(&inst);
+    if (worklist.empty())
+      return changed;
+    changed = true;
+
+    // Create the phis of the elements before filling them in, the struct of
+    // a loop-carried phi is built from the elements of the phi itself.
+    for (Instruction *inst : worklist) {
+      auto *phi = dyn_cast<PHINode>(inst);
+      if (!phi)
+        continue;
+      auto *structTy = cast<StructType>(phi->getType());
+      builder.SetInsertPoint(phi);
+      SmallVector<Value *> phiElements;
+      for (unsigned i = 0; i < structTy->getNumElements(); ++i)
+        phiElements.push_back(builder.CreatePHI(
+            structTy->getElementType(i), phi->getNumIncomingValues(),
+            phi->getName() + ".elt" + Twine(i)));
+      elements[phi] = std::move(phiElements);
+    }
+    // Selects are visited in reverse post-order, after the selects that
+    // define their operands, except for loop-carried ones.
+    for (Instruction *inst : worklist) {
+      if (auto *phi = dyn_cast<PHINode>(inst))
+        splitPhi(phi);
+      else
+        splitSelect(cast<SelectInst>(inst));
+    }
+    for (Instruction *inst : worklist)
+      replaceUses(inst);
+
+    // the insertvalue chains that built the structs are dead now
+    SmallVector<WeakTrackingVH> deadCandidates;
+    for (Instruction *inst : worklist)
+      for (Value *operand : inst->operands())
+        if (isa<Instruction>(operand))
+          deadCandidates.push_back(operand);
+    for (Instruction *inst : worklist)
+      inst->dropAllReferences();
+    for (Instruction *inst : worklist)
+      inst->eraseFromParent();
+    elements.clear();
+    RecursivelyDeleteTriviallyDeadInstructionsPermissive(deadCandidates);
+  }
+}
+
+} // namespace
+
+PreservedAnalyses ScalarizeStructsPass::run(Function &F,
+                                            FunctionAnalysisManager &AM) {
+  bool changed = StructScalarizer(F).run();
+  return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
@@ -13,4 +13,14 @@ struct BreakStructPhiNodesPass : PassInfoMixin<BreakStructPhiNodesPass> {
   static StringRef name() { return "BreakStructPhiNodesPass"; }
 };
 
+// Pass to scalarize the phis and selects of struct, looking up their elements
+// through the insertvalue chains building the structs. It runs before the
+// optimization pipeline, so that the loops carry the elements of the tensors
+// instead of copies of their structs.
+struct ScalarizeStructsPass : PassInfoMixin<ScalarizeStructsPass> {
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+
+  static StringRef name() { return "ScalarizeStructsPass"; }
+};
+
 } // namespace llvm
@@ -1,6 +1,7 @@
 #include "triton/Tools/LinearLayout.h"
 
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 #include "mlir/IR/BuiltinAttributes.h"
@@ -884,4 +885,101 @@ std::string LinearLayout::toString() const {
   return ret;
 }
 
+SharedMemoryAccessStats
+getSharedMemoryAccessStats(const LinearLayout &regLayout,
+                           const LinearLayout &sharedLayout,
+                           int32_t elemBitWidth) {
+  constexpr int kNumBanks = 32;
+  constexpr int kBankBits = 32;
+  constexpr int kMaxAccessBits = 128;
+  constexpr int kWavefrontBits = kNumBanks * kBankBits;
+
+  MLIRContext *ctx = (*regLayout.getInDimNames().begin()).getContext();
+  StringAttr kRegister = StringAttr::get(ctx, "register");
+  StringAttr kLane = StringAttr::get(ctx, "lane");
+  StringAttr kOffset = StringAttr::get(ctx, "offset");
+
+  // Maps (register, lane, ...) to (offset, ...).
+  LinearLayout access = regLayout.invertAndCompose(sharedLayout);
+
+  // Registers which are consecutive in shared memory are accessed together.
+  int vecLog2 = 0;
+  while (vecLog2 < access.getInDimSizeLog2(kRegister) &&
+         (elemBitWidth << (vecLog2 + 1)) <= kMaxAccessBits &&
+         access.getBasis(kRegister, vecLog2, kOffset) == (1 << vecLog2)) {
+    vecLog2++;
+  }
+  int32_t accessBits = elemBitWidth << vecLog2;
+  int32_t numLanes = access.getInDimSize(kLane);
+  int32_t lanesPerPhase = std::min(
+      numLanes, kWavefrontBits / std::max<int32_t>(accessBits, kBankBits));
+
+  SmallVector<std::pair<StringAttr, int32_t>> ins;
+  for (StringAttr inDim : access.getInDimNames())
+    ins.push_back({inDim, 0});
+  auto setIn = [&](StringAttr inDim, int32_t val) {
+    for (auto &[dim, v] : ins) {
+      if (dim == inDim)
+        v = val;
+    }
+  };
+
+  SharedMemoryAccessStats stats;
+  stats.vectorBits = accessBits;
+  int32_t numRegs = access.getInDimSize(kRegister);
+  for (int reg = 0; reg < numRegs; reg += 1 << vecLog2) {
+    setIn(kRegister, reg);
+    for (int phase = 0; phase < numLanes; phase += lanesPerPhase) {
+      SmallVector<int64_t> words;
+      for (int lane = phase; lane < phase + lanesPerPhase; lane++) {
+        setIn(kLane, lane);
+        int64_t offset = 0;
+        for (auto [dim, val] : access.apply(ins)) {
+          if (dim == kOffset)
+            offset = val;
+        }
+        int64_t firstBit = offset * elemBitWidth;
+        for (int64_t word = firstBit / kBankBits;
+             word <= (firstBit + accessBits - 1) / kBankBits; word++) {
+          words.push_back(word);
+        }
+      }
+      // Lanes reading the same word are served by a broadcast.
+      llvm::sort(words);
+      words.erase(std::unique(words.begin(), words.end()), words.end());
+      SmallVector<int32_t> wordsPerBank(kNumBanks, 0);
+      int32_t maxWordsPerBank = 0;
+      for (int64_t word : words) {
+        maxWordsPerBank =
+            std::max(maxWordsPerBank, ++wordsPerBank[word % kNumBanks]);
+      }
+      stats.numWavefronts += maxWordsPerBank;
+      stats.numIdealWavefronts++;
+      stats.maxConflictWays = std::max(stats.maxConflictWays, maxWordsPerBank);
+    }
+  }
+  return stats;
+}
+
+int32_t findMinBankConflictLayout(ArrayRef<LinearLayout> regLayouts,
+                                  ArrayRef<LinearLayout> sharedLayouts,
+                                  int32_t elemBitWidth) {
+  assert(!sharedLayouts.empty());
+  int32_t bestIdx = 0;
+  int32_t bestWavefronts = std::numeric_limits<int32_t>::max();
+  for (auto [idx, sharedLayout] : llvm::enumerate(sharedLayouts)) {
+    int32_t numWavefronts = 0;
+    for (const LinearLayout &regLayout : regLayouts) {
+      numWavefronts +=
+          getNumSharedMemoryWavefronts(regLayout, sharedLayout, elemBitWidth);
+    }
+    LDBG("candidate " << idx << " needs " << numWavefronts << " wavefronts");
+    if (numWavefronts < bestWavefronts) {
+      bestIdx = idx;
+      bestWavefronts = numWavefronts;
+    }
+  }
+  return bestIdx;
+}
+
 } // namespace mlir::triton
@@ -420,6 +420,9 @@ class CMakeBuild(build_ext):
                 "-DCMAKE_CXX_COMPILER_LAUNCHER=ccache",
             ]
 
+        if check_env_flag("TRITON_BUILD_BENCHMARKS"):
+            cmake_args += ["-DTRITON_BUILD_BENCHMARKS=ON"]
+
         if check_env_flag("TRITON_BUILD_PROTON", "ON"):  # Default ON
             cmake_args += self.get_proton_cmake_args()
         else:
@@ -444,6 +447,14 @@ download_and_copy(
     url_func=lambda arch, version:
     f"https://anaconda.org/nvidia/cuda-nvcc/{version}/download/linux-{arch}/cuda-nvcc-{version}-0.tar.bz2",
 )
+download_and_copy(
+    name="nvptxcompiler",
+    src_path="lib/libnvptxcompiler_static.a",
+    variable="TRITON_NVPTXCOMPILER_PATH",
+    version=NVIDIA_TOOLCHAIN_VERSION,
+    url_func=lambda arch, version:
+    f"https://anaconda.org/nvidia/cuda-nvcc/{version}/download/linux-{arch}/cuda-nvcc-{version}-0.tar.bz2",
+)
 download_and_copy(
     name="cuobjdump",
     src_path="bin/cuobjdump",
@@ -485,7 +496,7 @@ download_and_copy(
     f"https://anaconda.org/nvidia/cuda-cupti/{version}/download/linux-{arch}/cuda-cupti-{version}-0.tar.bz2",
 )
 
-backends = [*BackendInstaller.copy(["nvidia", "amd"]), *BackendInstaller.copy_externals()]
+backends = [*BackendInstaller.copy(["nvidia", "amd", "cpu"]), *BackendInstaller.copy_externals()]
 
 
 def add_link_to_backends():
@@ -542,7 +553,10 @@ class plugin_egginfo(egg_info):
 
 
 package_data = {
-    "triton/tools": ["compile.h", "compile.c"],
+    "triton/tools": [
+        "compile.h", "compile.c", "compile_hip.h", "compile_hip.c", "runtime/CMakeLists.txt",
+        "runtime/triton_aot_runtime.h", "runtime/triton_aot_runtime.cc"
+    ],
     **{f"triton/backends/{b.name}": b.package_data
        for b in backends},
 }
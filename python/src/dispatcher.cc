@@ -0,0 +1,453 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+// The parameters of a JITFunction, as far as their specialization goes
+struct Param {
+  std::string name;
+  bool isConstexpr;
+  bool doNotSpecialize;
+  // Null if the parameter has no default value
+  py::object defaultValue;
+  // Null unless the parameter is bucketed, KernelParam.bucket otherwise
+  py::object bucket;
+};
+
+// Native counterpart of the binder, the specialization key, and the cache
+// lookup of JITFunction.run.
+//
+// A kernel is registered by JITFunction.run once it's launched, under a key
+// computed here from the arguments of that launch. The key tells apart at
+// least the arguments that the Python key tells apart: the types and values
+// of the constexprs, the types of the other arguments, and their
+// specialization (16-byte alignment of pointers, divisibility by 16 and
+// equality to 1 of integers, or the bucket of bucketed integers). Later launches with the same key are made from
+// here, without running Python code besides the grid function and the
+// device, stream, and data_ptr getters.
+//
+// Launches that need more (unknown argument types, changed globals, a kernel
+// dropped from the Python cache) return None so that they go through
+// JITFunction.run, which reports the errors.
+class Dispatcher {
+public:
+  Dispatcher(std::vector<Param> params, py::object kernelCache,
+             py::object getCurrentDevice, py::object getCurrentStream,
+             py::list usedGlobals)
+      : params(std::move(params)), kernelCache(std::move(kernelCache)),
+        getCurrentDevice(std::move(getCurrentDevice)),
+        getCurrentStream(std::move(getCurrentStream)) {
+    for (auto usedGlobal : usedGlobals) {
+      auto item = usedGlobal.cast<py::tuple>();
+      this->usedGlobals.push_back(
+          {item[0].cast<py::str>(), item[1], item[2].cast<py::dict>()});
+    }
+    for (size_t i = 0; i < this->params.size(); ++i)
+      paramIndices[this->params[i].name] = i;
+  }
+
+  /// Launch the kernel registered for these arguments.
+  /// Returns the kernel, or None if the launch has to go through
+  /// JITFunction.run.
+  py::object launch(py::object grid, py::tuple args, py::dict kwargs,
+                    py::object debug) {
+    Entry *entry = nullptr;
+    py::tuple launchArgs;
+    try {
+      auto device = getCurrentDevice();
+      std::vector<py::object> values;
+      entry = findEntry(device, args, kwargs, debug, values);
+      if (entry == nullptr)
+        return py::none();
+      launchArgs = makeLaunchArgs(*entry, device, grid, values);
+    } catch (py::error_already_set &) {
+      // JITFunction.run raises the error again if there is one
+      return py::none();
+    } catch (py::cast_error &) {
+      return py::none();
+    }
+    // Errors of the launch itself are raised from here, falling back to
+    // JITFunction.run would launch the kernel twice
+    entry->launcher(*launchArgs);
+    ++numLaunches;
+    return entry->kernel;
+  }
+
+  /// Register the kernel launched with these arguments. `cacheKey` is its key
+  /// in JITFunction.cache.
+  /// Returns false if the arguments can't be dispatched natively.
+  bool registerKernel(py::tuple args, py::dict kwargs, py::object debug,
+                      py::object kernel, py::object cacheKey) {
+    try {
+      auto device = getCurrentDevice();
+      std::vector<py::object> values;
+      auto key = makeKey(device, args, kwargs, debug, values);
+      if (!key)
+        return false;
+      py::object launcher = kernel.attr("run");
+      // Skip the __call__ of the launcher objects
+      if (py::hasattr(launcher, "launch"))
+        launcher = launcher.attr("launch");
+      entries[key] = {kernel, std::move(cacheKey), launcher,
+                      kernel.attr("function"),
+                      kernel.attr("packed_metadata")};
+      return true;
+    } catch (py::error_already_set &) {
+      return false;
+    } catch (py::cast_error &) {
+      return false;
+    }
+  }
+
+  /// Forget the kernels registered under `cacheKey`, once JITFunction.cache
+  /// evicted it, so that they are released.
+  void evict(py::object cacheKey) {
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second.cacheKey.equal(cacheKey))
+        it = entries.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  size_t size() const { return entries.size(); }
+
+  /// Number of launches made from here, i.e. cache hits that JITFunction.run
+  /// doesn't see.
+  size_t getNumLaunches() const { return numLaunches; }
+
+private:
+  struct UsedGlobal {
+    py::str name;
+    py::object value;
+    py::dict globals;
+  };
+
+  struct Entry {
+    py::object kernel;
+    py::object cacheKey;
+    py::object launcher;
+    py::object function;
+    py::object packedMetadata;
+  };
+
+  struct KeyHash {
+    size_t operator()(const py::object &key) const { return py::hash(key); }
+  };
+
+  struct KeyEqual {
+    bool operator()(const py::object &lhs, const py::object &rhs) const {
+      return lhs.equal(rhs);
+    }
+  };
+
+  Entry *findEntry(py::object device, py::tuple args, py::dict kwargs,
+                   py::object debug, std::vector<py::object> &values) {
+    if (!checkGlobals())
+      return nullptr;
+    auto key = makeKey(device, args, kwargs, debug, values);
+    if (!key)
+      return nullptr;
+    auto it = entries.find(key);
+    if (it == entries.end())
+      return nullptr;
+    auto &entry = it->second;
+    // The kernel has to be in the Python cache still, users clear it to force
+    // recompilations
+    auto deviceCache = kernelCache.attr("get")(device);
+    if (deviceCache.is_none() ||
+        !deviceCache.attr("get")(entry.cacheKey).is(entry.kernel))
+      return nullptr;
+    return &entry;
+  }
+
+  py::tuple makeLaunchArgs(const Entry &entry, py::object device,
+                           py::object grid,
+                           const std::vector<py::object> &values) const {
+    if (PyCallable_Check(grid.ptr())) {
+      py::dict boundArgs;
+      for (size_t i = 0; i < params.size(); ++i)
+        boundArgs[py::str(params[i].name)] = values[i];
+      grid = grid(boundArgs);
+    }
+    auto gridDims = grid.cast<py::sequence>();
+    auto gridSize = gridDims.size();
+    py::object gridX = gridDims[0];
+    py::object gridY = gridSize > 1 ? py::object(gridDims[1]) : py::int_(1);
+    py::object gridZ = gridSize > 2 ? py::object(gridDims[2]) : py::int_(1);
+
+    // Arguments of the launchers generated by the drivers: the grid, the
+    // stream, the function, the packed metadata, the launch metadata and
+    // hooks, which are unset on this path, then the non-constexpr arguments
+    size_t numArgs = 9;
+    for (auto &param : params)
+      numArgs += !param.isConstexpr;
+    py::tuple launchArgs(numArgs);
+    size_t argIdx = 0;
+    auto setArg = [&](py::object value) {
+      PyTuple_SET_ITEM(launchArgs.ptr(), argIdx++, value.release().ptr());
+    };
+    setArg(gridX);
+    setArg(gridY);
+    setArg(gridZ);
+    setArg(getCurrentStream(device));
+    setArg(entry.function);
+    setArg(entry.packedMetadata);
+    setArg(py::none());
+    setArg(py::none());
+    setArg(py::none());
+    for (size_t i = 0; i < params.size(); ++i)
+      if (!params[i].isConstexpr)
+        setArg(values[i]);
+    return launchArgs;
+  }
+
+  bool checkGlobals() const {
+    for (auto &usedGlobal : usedGlobals) {
+      auto *value = PyDict_GetItemWithError(usedGlobal.globals.ptr(),
+                                            usedGlobal.name.ptr());
+      if (value == nullptr) {
+        if (PyErr_Occurred())
+          throw py::error_already_set();
+        return false;
+      }
+      int changed =
+          PyObject_RichCompareBool(value, usedGlobal.value.ptr(), Py_NE);
+      if (changed != 0) {
+        if (changed < 0)
+          throw py::error_already_set();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the key of an argument that isn't a constexpr, or a null object
+  // if its type is unknown.
+  py::object getArgKey(const Param &param, py::handle arg) const {
+    if (arg.is_none())
+      return py::str("none");
+    if (PyBool_Check(arg.ptr())) {
+      // False is divisible by 16 and True is equal to 1
+      const char *spec = "N";
+      if (!param.doNotSpecialize)
+        spec = arg.ptr() == Py_True ? "1" : "D";
+      return py::make_tuple("i1", spec);
+    }
+    if (PyLong_Check(arg.ptr())) {
+      int overflow = 0;
+      long long value = PyLong_AsLongLongAndOverflow(arg.ptr(), &overflow);
+      const char *type = nullptr;
+      unsigned long long bits = 0;
+      if (overflow == 0) {
+        type = value >= INT32_MIN && value <= INT32_MAX ? "i32" : "i64";
+        bits = static_cast<unsigned long long>(value);
+      } else if (overflow > 0) {
+        bits = PyLong_AsUnsignedLongLong(arg.ptr());
+        if (PyErr_Occurred()) {
+          // Out of range, the compiler reports it
+          PyErr_Clear();
+          return py::object();
+        }
+        type = "u64";
+      } else {
+        return py::object();
+      }
+      // Bucketed integers are specialized on their bucket only
+      if (param.bucket)
+        return py::make_tuple(type, param.bucket(arg));
+      const char *spec = "N";
+      if (!param.doNotSpecialize) {
+        if (bits % 16 == 0)
+          spec = "D";
+        else if (overflow == 0 && value == 1)
+          spec = "1";
+      }
+      return py::make_tuple(type, spec);
+    }
+    if (PyFloat_Check(arg.ptr()))
+      return py::str("fp32");
+    if (!py::hasattr(arg, "dtype"))
+      return py::object();
+    bool aligned = false;
+    if (!param.doNotSpecialize && py::hasattr(arg, "data_ptr")) {
+      auto dataPtr = arg.attr("data_ptr")().cast<unsigned long long>();
+      aligned = dataPtr % 16 == 0;
+    }
+    return py::make_tuple(arg.attr("dtype"), aligned);
+  }
+
+  // Bind the arguments to the parameters and return their key, or a null
+  // object if the binder of JITFunction has to handle them.
+  py::object makeKey(py::object device, py::tuple args, py::dict kwargs,
+                     py::object debug, std::vector<py::object> &values) const {
+    if (args.size() > params.size())
+      return py::object();
+    values.assign(params.size(), py::object());
+    for (size_t i = 0; i < args.size(); ++i)
+      values[i] = args[i];
+    py::list excessKwargs;
+    for (auto [name, value] : kwargs) {
+      auto nameStr = name.cast<std::string>();
+      if (nameStr == "debug")
+        continue;
+      auto it = paramIndices.find(nameStr);
+      if (it == paramIndices.end()) {
+        excessKwargs.append(py::make_tuple(name, value));
+        continue;
+      }
+      // Passed both by position and by name
+      if (values[it->second])
+        return py::object();
+      values[it->second] = py::reinterpret_borrow<py::object>(value);
+    }
+    excessKwargs.attr("sort")();
+
+    py::tuple key(params.size() + 3);
+    PyTuple_SET_ITEM(key.ptr(), 0, device.release().ptr());
+    PyTuple_SET_ITEM(key.ptr(), 1, debug.release().ptr());
+    PyTuple_SET_ITEM(key.ptr(), 2,
+                     py::tuple(excessKwargs).release().ptr());
+    for (size_t i = 0; i < params.size(); ++i) {
+      auto &param = params[i];
+      if (!values[i]) {
+        if (!param.defaultValue)
+          return py::object();
+        values[i] = param.defaultValue;
+      }
+      py::object argKey;
+      if (param.isConstexpr) {
+        // The type tells apart values that compare equal, e.g. 1 and True
+        argKey = py::make_tuple(py::type::of(values[i]), values[i]);
+      } else {
+        argKey = getArgKey(param, values[i]);
+      }
+      if (!argKey)
+        return py::object();
+      PyTuple_SET_ITEM(key.ptr(), i + 3, argKey.release().ptr());
+    }
+    // Constexprs have to be hashable
+    if (PyObject_Hash(key.ptr()) == -1) {
+      PyErr_Clear();
+      return py::object();
+    }
+    return std::move(key);
+  }
+
+  std::vector<Param> params;
+  std::unordered_map<std::string, size_t> paramIndices;
+  py::object kernelCache;
+  py::object getCurrentDevice;
+  py::object getCurrentStream;
+  std::vector<UsedGlobal> usedGlobals;
+  std::unordered_map<py::object, Entry, KeyHash, KeyEqual> entries;
+  size_t numLaunches = 0;
+};
+
+// Make the launches recorded by a LaunchQueue, which are pairs of a launcher
+// and its arguments with the stream left out.
+void launchBatch(py::list launches, py::object stream) {
+  // Index of the stream in the arguments of the launchers
+  constexpr size_t StreamIdx = 3;
+  for (auto launch : launches) {
+    auto item = launch.cast<py::tuple>();
+    auto launcher = item[0];
+    auto args = item[1].cast<py::tuple>();
+    py::tuple launchArgs(args.size());
+    for (size_t i = 0; i < args.size(); ++i) {
+      py::object arg = i == StreamIdx ? stream : py::object(args[i]);
+      PyTuple_SET_ITEM(launchArgs.ptr(), i, arg.release().ptr());
+    }
+    launcher(*launchArgs);
+  }
+}
+
+// Split the tensors of the lists into chunks of at most chunkSize elements,
+// and write a row per chunk to a host tensor returned by allocate, which is
+// called with the number of int64 entries of the table.
+//
+// A row holds the address of the chunk in the tensor of each list, followed
+// by the number of elements of the chunk. Tensors at the same index in the
+// lists must have the same number of elements, and empty tensors have no
+// chunk.
+py::object buildChunkTable(std::vector<py::list> tensorLists,
+                           int64_t chunkSize, py::object allocate) {
+  if (tensorLists.empty())
+    throw py::value_error("multi_tensor_apply needs at least one list");
+  if (chunkSize <= 0)
+    throw py::value_error("the chunk size must be positive");
+  size_t numTensors = tensorLists[0].size();
+  for (auto &tensors : tensorLists)
+    if (tensors.size() != numTensors)
+      throw py::value_error("the tensor lists must have the same length");
+
+  std::vector<int64_t> table;
+  std::vector<int64_t> bases(tensorLists.size());
+  std::vector<int64_t> elemSizes(tensorLists.size());
+  for (size_t i = 0; i < numTensors; ++i) {
+    int64_t numel = -1;
+    for (size_t l = 0; l < tensorLists.size(); ++l) {
+      py::handle tensor = tensorLists[l][i];
+      if (!tensor.attr("is_contiguous")().cast<bool>())
+        throw py::value_error("the tensors must be contiguous");
+      auto tensorNumel = tensor.attr("numel")().cast<int64_t>();
+      if (numel != -1 && tensorNumel != numel)
+        throw py::value_error("tensors at the same index in the lists must "
+                              "have the same number of elements");
+      numel = tensorNumel;
+      bases[l] = tensor.attr("data_ptr")().cast<int64_t>();
+      elemSizes[l] = tensor.attr("element_size")().cast<int64_t>();
+    }
+    for (int64_t start = 0; start < numel; start += chunkSize) {
+      for (size_t l = 0; l < tensorLists.size(); ++l)
+        table.push_back(bases[l] + start * elemSizes[l]);
+      table.push_back(std::min(chunkSize, numel - start));
+    }
+  }
+
+  py::object hostTable = allocate(table.size());
+  auto dataPtr = hostTable.attr("data_ptr")().cast<intptr_t>();
+  auto *data = reinterpret_cast<int64_t *>(dataPtr);
+  std::copy(table.begin(), table.end(), data);
+  return hostTable;
+}
+
+} // namespace
+
+void init_triton_dispatcher(py::module &&m) {
+  m.def("launch_batch", &launchBatch, py::arg("launches"), py::arg("stream"));
+  m.def("build_chunk_table", &buildChunkTable, py::arg("tensor_lists"),
+        py::arg("chunk_size"), py::arg("allocate"));
+
+  py::class_<Param>(m, "param", py::module_local())
+      .def(py::init([](std::string name, bool isConstexpr,
+                       bool doNotSpecialize, bool hasDefault,
+                       py::object defaultValue, py::object bucket) {
+             return Param{std::move(name), isConstexpr, doNotSpecialize,
+                          hasDefault ? std::move(defaultValue) : py::object(),
+                          bucket.is_none() ? py::object() : std::move(bucket)};
+           }),
+           py::arg("name"), py::arg("is_constexpr"),
+           py::arg("do_not_specialize"), py::arg("has_default"),
+           py::arg("default"), py::arg("bucket") = py::none());
+
+  py::class_<Dispatcher>(m, "dispatcher", py::module_local())
+      .def(py::init<std::vector<Param>, py::object, py::object, py::object,
+                    py::list>(),
+           py::arg("params"), py::arg("kernel_cache"),
+           py::arg("get_current_device"), py::arg("get_current_stream"),
+           py::arg("used_globals"))
+      .def("launch", &Dispatcher::launch)
+      .def("register", &Dispatcher::registerKernel)
+      .def("evict", &Dispatcher::evict)
+      .def("__len__", &Dispatcher::size)
+      .def_property_readonly("num_launches", &Dispatcher::getNumLaunches);
+}
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace py = pybind11;
 
@@ -67,160 +74,117 @@ template <typename T> T atomic_fadd(T *ptr, T val, int order) {
 
 class AtomicOp {
 public:
-  AtomicOp(const uint64_t *ptr, size_t numel, int order)
-      : ptr(ptr), numel(numel), order(order) {}
-
-  void apply() {
-    for (size_t i = 0; i < numel; ++i) {
-      applyAt(reinterpret_cast<void *>(ptr[i]), i);
-    }
-  }
+  virtual void apply() = 0;
 
   virtual ~AtomicOp() = default;
-
-protected:
-  virtual void applyAt(void *, size_t i) = 0;
-
-  const uint64_t *ptr;
-  size_t numel;
-  int order;
-};
-
-template <typename DType> class AtomicRMWOpBase : public AtomicOp {
-public:
-  AtomicRMWOpBase(const uint64_t *ptr, const void *val, void *ret,
-                  const bool *mask, size_t numel, int order)
-      : AtomicOp(ptr, numel, order), val(val), ret(ret), mask(mask) {}
-
-protected:
-  void applyAt(void *loc, size_t i) override final {
-    if (mask[i]) {
-      *(static_cast<DType *>(ret) + i) =
-          applyAtMasked(static_cast<DType *>(loc),
-                        *(static_cast<const DType *>(val) + i), order);
-    }
-  }
-
-  virtual DType applyAtMasked(DType *loc, const DType value, int order) = 0;
-
-  const void *val;
-  void *ret;
-  const bool *mask;
 };
 
-template <typename DType, RMWOp Op, typename = void>
-class AtomicRMWOp : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::ADD>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+template <RMWOp Op, typename DType>
+DType atomicRMW(DType *loc, const DType value, int order) {
+  if constexpr (Op == RMWOp::ADD) {
     return __atomic_fetch_add(loc, value, order);
-  }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::FADD>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  } else if constexpr (Op == RMWOp::FADD) {
     return atomic_fadd(loc, value, order);
-  }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::AND>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  } else if constexpr (Op == RMWOp::AND) {
     return __atomic_fetch_and(loc, value, order);
-  }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::OR>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  } else if constexpr (Op == RMWOp::OR) {
     return __atomic_fetch_or(loc, value, order);
-  }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::XOR>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  } else if constexpr (Op == RMWOp::XOR) {
     return __atomic_fetch_xor(loc, value, order);
-  }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op,
-                  std::enable_if_t<Op == RMWOp::MAX || Op == RMWOp::UMAX>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
-
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
+  } else if constexpr (Op == RMWOp::MAX || Op == RMWOp::UMAX) {
     return atomic_cmp</*is_min=*/false>(loc, value, order);
+  } else if constexpr (Op == RMWOp::MIN || Op == RMWOp::UMIN) {
+    return atomic_cmp</*is_min=*/true>(loc, value, order);
+  } else {
+    static_assert(Op == RMWOp::XCHG);
+    return __atomic_exchange_n(loc, value, order);
   }
-};
-
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op,
-                  std::enable_if_t<Op == RMWOp::MIN || Op == RMWOp::UMIN>>
-    : public AtomicRMWOpBase<DType> {
-public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+}
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
-    return atomic_cmp</*is_min=*/true>(loc, value, order);
+// The same operation as atomicRMW for when no other thread can access loc
+template <RMWOp Op, typename DType>
+DType plainRMW(DType *loc, const DType value) {
+  DType old_val = *loc;
+  if constexpr (Op == RMWOp::ADD) {
+    // Wrap around on overflow like __atomic_fetch_add
+    using UType = std::make_unsigned_t<DType>;
+    *loc = static_cast<DType>(static_cast<UType>(old_val) +
+                              static_cast<UType>(value));
+  } else if constexpr (Op == RMWOp::FADD) {
+    *loc = old_val + value;
+  } else if constexpr (Op == RMWOp::AND) {
+    *loc = old_val & value;
+  } else if constexpr (Op == RMWOp::OR) {
+    *loc = old_val | value;
+  } else if constexpr (Op == RMWOp::XOR) {
+    *loc = old_val ^ value;
+  } else if constexpr (Op == RMWOp::MAX || Op == RMWOp::UMAX) {
+    *loc = std::max(old_val, value);
+  } else if constexpr (Op == RMWOp::MIN || Op == RMWOp::UMIN) {
+    *loc = std::min(old_val, value);
+  } else {
+    static_assert(Op == RMWOp::XCHG);
+    *loc = value;
   }
-};
+  return old_val;
+}
 
-template <typename DType, RMWOp Op>
-class AtomicRMWOp<DType, Op, std::enable_if_t<Op == RMWOp::XCHG>>
-    : public AtomicRMWOpBase<DType> {
+// Applies the operation to the whole array with a single virtual call, the
+// loop over the elements is specialized for the operation and the type
+template <typename DType, RMWOp Op> class AtomicRMWOp : public AtomicOp {
 public:
-  using AtomicRMWOpBase<DType>::AtomicRMWOpBase;
+  AtomicRMWOp(const uint64_t *ptr, const void *val, void *ret,
+              const bool *mask, size_t numel, int order, bool concurrent)
+      : ptr(ptr), val(static_cast<const DType *>(val)),
+        ret(static_cast<DType *>(ret)), mask(mask), numel(numel),
+        order(order), concurrent(concurrent) {}
+
+  void apply() override {
+    if (concurrent)
+      applyAll</*IsAtomic=*/true>();
+    else
+      applyAll</*IsAtomic=*/false>();
+  }
 
-protected:
-  DType applyAtMasked(DType *loc, const DType value, int order) override {
-    return __atomic_exchange_n(loc, value, order);
+private:
+  template <bool IsAtomic> void applyAll() {
+    for (size_t i = 0; i < numel; ++i) {
+      if (!mask[i])
+        continue;
+      auto *loc = reinterpret_cast<DType *>(ptr[i]);
+      if constexpr (IsAtomic)
+        ret[i] = atomicRMW<Op>(loc, val[i], order);
+      else
+        ret[i] = plainRMW<Op>(loc, val[i]);
+    }
   }
+
+  const uint64_t *ptr;
+  const DType *val;
+  DType *ret;
+  const bool *mask;
+  size_t numel;
+  int order;
+  // Whether other threads may access the same memory, otherwise the
+  // elements are updated without atomic instructions
+  bool concurrent;
 };
 
 class AtomicCASOp : public AtomicOp {
 public:
   AtomicCASOp(const uint64_t *ptr, void *expected, const void *desired,
               size_t itemsize, size_t numel, int order)
-      : AtomicOp(ptr, numel, order), expected(expected), desired(desired),
-        itemsize(itemsize) {}
+      : ptr(ptr), expected(expected), desired(desired), itemsize(itemsize),
+        numel(numel), order(order) {}
 
-protected:
-  void applyAt(void *loc, size_t i) override {
+  void apply() override {
+    for (size_t i = 0; i < numel; ++i) {
+      applyAt(reinterpret_cast<void *>(ptr[i]), i);
+    }
+  }
+
+private:
+  void applyAt(void *loc, size_t i) {
     // Atomic operations perform bitwise comparison, so it's safe to
     // use number of bytes (itemsize) to determine the type of pointers
     if (itemsize == 1) {
@@ -253,10 +217,12 @@ protected:
     }
   }
 
-private:
+  const uint64_t *ptr;
   void *expected;
   const void *desired;
   size_t itemsize;
+  size_t numel;
+  int order;
 };
 
 // This is a workaround because explicit template parameter list for lambdas is
@@ -264,7 +230,8 @@ private:
 // auto try_make_op = [&]<typename T>() {
 //   if (dtype.is(pybind11::dtype::of<T>())) {
 //     atomic_op = std::make_unique<AtomicRMWOp<T, Op>>(ptr, val, ret, mask,
-//                                                      numel, order);
+//                                                      numel, order,
+//                                                      concurrent);
 //   }
 // };
 template <RMWOp Op> struct OpCreator {
@@ -275,12 +242,13 @@ template <RMWOp Op> struct OpCreator {
   const bool *mask;
   size_t numel;
   int order;
+  bool concurrent;
   std::unique_ptr<AtomicOp> &atomic_op;
 
   template <typename T> void create() {
     if (!atomic_op && dtype.is(pybind11::dtype::of<T>())) {
-      atomic_op = std::make_unique<AtomicRMWOp<T, Op>>(ptr, val, ret, mask,
-                                                       numel, order);
+      atomic_op = std::make_unique<AtomicRMWOp<T, Op>>(
+          ptr, val, ret, mask, numel, order, concurrent);
     }
   }
 };
@@ -288,11 +256,12 @@ template <RMWOp Op> struct OpCreator {
 template <RMWOp Op, typename... SupportedDTypes>
 std::unique_ptr<AtomicOp>
 makeAtomicRMWOp(pybind11::dtype dtype, const uint64_t *ptr, const void *val,
-                void *ret, const bool *mask, size_t numel, int order) {
+                void *ret, const bool *mask, size_t numel, int order,
+                bool concurrent) {
   // Iterate over all supported data types, make one that matches, and return
   std::unique_ptr<AtomicOp> atomic_op;
-  OpCreator<Op> try_make_op{dtype, ptr,   val,   ret,
-                            mask,  numel, order, atomic_op};
+  OpCreator<Op> try_make_op{dtype, ptr,   val,        ret,      mask,
+                            numel, order, concurrent, atomic_op};
 
   (try_make_op.template create<SupportedDTypes>(), ...);
   if (!atomic_op) {
@@ -302,6 +271,329 @@ makeAtomicRMWOp(pybind11::dtype dtype, const uint64_t *ptr, const void *val,
   return atomic_op;
 }
 
+// Blocks of fewer elements per thread are copied by the calling thread
+constexpr size_t kParallelNumel = 1 << 16;
+
+// Call fn(begin, end) over chunks of [0, numel) in parallel
+template <typename Fn> void parallelFor(size_t numel, Fn &&fn) {
+  size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(),
+                                       numel / kParallelNumel);
+  if (numThreads <= 1) {
+    fn(0, numel);
+    return;
+  }
+  size_t chunk = (numel + numThreads - 1) / numThreads;
+  std::vector<std::thread> threads;
+  for (size_t begin = chunk; begin < numel; begin += chunk)
+    threads.emplace_back(fn, begin, std::min(numel, begin + chunk));
+  fn(0, chunk);
+  for (auto &thread : threads)
+    thread.join();
+}
+
+// The elements of an array in C order, which may be a broadcast view whose
+// repeated dimensions have zero strides. Splatted and broadcast tensors are
+// read through these views rather than materialized.
+class StridedArray {
+public:
+  explicit StridedArray(const py::array &array)
+      : data(static_cast<const char *>(array.data())),
+        itemSize(array.itemsize()),
+        shape(array.shape(), array.shape() + array.ndim()),
+        strides(array.strides(), array.strides() + array.ndim()) {
+    ptrdiff_t contiguousStride = itemSize;
+    for (int d = array.ndim() - 1; d >= 0; --d) {
+      if (shape[d] == 1)
+        continue;
+      contiguous &= strides[d] == contiguousStride;
+      uniform &= strides[d] == 0;
+      contiguousStride *= shape[d];
+    }
+  }
+
+  const char *at(size_t i) const {
+    if (contiguous)
+      return data + i * itemSize;
+    if (uniform)
+      return data;
+    ptrdiff_t offset = 0;
+    for (int d = int(shape.size()) - 1; d >= 0; --d) {
+      offset += static_cast<ptrdiff_t>(i % shape[d]) * strides[d];
+      i /= shape[d];
+    }
+    return data + offset;
+  }
+
+  bool test(size_t i) const { return *reinterpret_cast<const bool *>(at(i)); }
+
+  // The elements, if they are consecutive in memory
+  const char *contiguousData() const { return contiguous ? data : nullptr; }
+
+private:
+  const char *data;
+  size_t itemSize;
+  std::vector<ptrdiff_t> shape;
+  std::vector<ptrdiff_t> strides;
+  // Whether the elements are consecutive, or all the same one
+  bool contiguous = true;
+  bool uniform = true;
+};
+
+// Whether all the elements are unmasked and consecutive in memory
+bool isContiguous(const uint64_t *ptr, const StridedArray &mask, size_t numel,
+                  size_t itemSize) {
+  for (size_t i = 0; i < numel; ++i) {
+    if (!mask.test(i) || ptr[i] != ptr[0] + i * itemSize)
+      return false;
+  }
+  return true;
+}
+
+// Copies of ItemSize bytes compile to single moves, ItemSize = 0 stands for
+// the other sizes, which are given by itemSize
+template <size_t ItemSize>
+void gather(const uint64_t *ptr, const StridedArray &mask,
+            const StridedArray &other, char *ret, size_t itemSize,
+            size_t begin, size_t end) {
+  if constexpr (ItemSize != 0)
+    itemSize = ItemSize;
+  for (size_t i = begin; i < end; ++i) {
+    const char *src =
+        mask.test(i) ? reinterpret_cast<const char *>(ptr[i]) : other.at(i);
+    std::memcpy(ret + i * itemSize, src, ItemSize ? ItemSize : itemSize);
+  }
+}
+
+template <size_t ItemSize>
+void scatter(const uint64_t *ptr, const StridedArray &mask,
+             const StridedArray &value, size_t itemSize, size_t begin,
+             size_t end) {
+  if constexpr (ItemSize != 0)
+    itemSize = ItemSize;
+  for (size_t i = begin; i < end; ++i) {
+    if (mask.test(i))
+      std::memcpy(reinterpret_cast<char *>(ptr[i]), value.at(i),
+                  ItemSize ? ItemSize : itemSize);
+  }
+}
+
+#define DISPATCH_ITEM_SIZE(itemSize, FN, ...)                                  \
+  switch (itemSize) {                                                          \
+  case 1:                                                                      \
+    FN<1>(__VA_ARGS__);                                                        \
+    break;                                                                     \
+  case 2:                                                                      \
+    FN<2>(__VA_ARGS__);                                                        \
+    break;                                                                     \
+  case 4:                                                                      \
+    FN<4>(__VA_ARGS__);                                                        \
+    break;                                                                     \
+  case 8:                                                                      \
+    FN<8>(__VA_ARGS__);                                                        \
+    break;                                                                     \
+  default:                                                                     \
+    FN<0>(__VA_ARGS__);                                                        \
+  }
+
+void load(const uint64_t *ptr, const StridedArray &mask,
+          const StridedArray &other, char *ret, size_t itemSize,
+          size_t numel) {
+  if (numel == 0)
+    return;
+  if (isContiguous(ptr, mask, numel, itemSize)) {
+    std::memcpy(ret, reinterpret_cast<const char *>(ptr[0]),
+                numel * itemSize);
+    return;
+  }
+  parallelFor(numel, [&](size_t begin, size_t end) {
+    DISPATCH_ITEM_SIZE(itemSize, gather, ptr, mask, other, ret, itemSize,
+                       begin, end);
+  });
+}
+
+// Elements that are stored to the same address by several threads are
+// undefined, as they are on GPUs
+void store(const uint64_t *ptr, const StridedArray &mask,
+           const StridedArray &value, size_t itemSize, size_t numel) {
+  if (numel == 0)
+    return;
+  if (isContiguous(ptr, mask, numel, itemSize)) {
+    char *dst = reinterpret_cast<char *>(ptr[0]);
+    if (const char *src = value.contiguousData()) {
+      std::memcpy(dst, src, numel * itemSize);
+    } else {
+      for (size_t i = 0; i < numel; ++i)
+        std::memcpy(dst + i * itemSize, value.at(i), itemSize);
+    }
+    return;
+  }
+  parallelFor(numel, [&](size_t begin, size_t end) {
+    DISPATCH_ITEM_SIZE(itemSize, scatter, ptr, mask, value, itemSize, begin,
+                       end);
+  });
+}
+
+#undef DISPATCH_ITEM_SIZE
+
+// How a floating-point format encodes NaNs, which also decides whether it
+// has infinities
+enum class NaNEncoding {
+  // All ones exponents with nonzero mantissas, all ones exponents with zero
+  // mantissas being infinities
+  IEEE,
+  // All ones exponents and mantissas, without infinities (fp8e4nv)
+  AllOnes,
+  // The negative zero, without infinities (the fnuz formats of AMD)
+  NegativeZero,
+  // No NaNs nor infinities (fp8e4b15)
+  None,
+};
+
+// The floating-point formats of Triton. Those numpy lacks are stored as
+// unsigned integers of their width.
+struct FloatFormat {
+  int expBits;
+  int mantBits;
+  int bias;
+  NaNEncoding nan;
+
+  int width() const { return 1 + expBits + mantBits; }
+};
+
+const FloatFormat &getFloatFormat(const std::string &name) {
+  static const std::map<std::string, FloatFormat> formats = {
+      {"fp64", {11, 52, 1023, NaNEncoding::IEEE}},
+      {"fp32", {8, 23, 127, NaNEncoding::IEEE}},
+      {"fp16", {5, 10, 15, NaNEncoding::IEEE}},
+      {"bf16", {8, 7, 127, NaNEncoding::IEEE}},
+      {"fp8e5", {5, 2, 15, NaNEncoding::IEEE}},
+      {"fp8e5b16", {5, 2, 16, NaNEncoding::NegativeZero}},
+      {"fp8e4nv", {4, 3, 7, NaNEncoding::AllOnes}},
+      {"fp8e4b8", {4, 3, 8, NaNEncoding::NegativeZero}},
+      {"fp8e4b15", {4, 3, 15, NaNEncoding::None}},
+  };
+  auto it = formats.find(name);
+  if (it == formats.end())
+    throw std::invalid_argument("Unsupported floating-point format " + name);
+  return it->second;
+}
+
+// Every value of these formats is exact in double
+double decodeFloat(uint64_t bits, const FloatFormat &format) {
+  uint64_t expMax = (uint64_t(1) << format.expBits) - 1;
+  uint64_t mantMax = (uint64_t(1) << format.mantBits) - 1;
+  bool sign = (bits >> (format.width() - 1)) & 1;
+  uint64_t exp = (bits >> format.mantBits) & expMax;
+  uint64_t mant = bits & mantMax;
+  if ((format.nan == NaNEncoding::IEEE && exp == expMax && mant != 0) ||
+      (format.nan == NaNEncoding::AllOnes && exp == expMax &&
+       mant == mantMax) ||
+      (format.nan == NaNEncoding::NegativeZero && sign && exp == 0 &&
+       mant == 0))
+    return std::numeric_limits<double>::quiet_NaN();
+  double magnitude;
+  if (format.nan == NaNEncoding::IEEE && exp == expMax)
+    magnitude = std::numeric_limits<double>::infinity();
+  else if (exp == 0)
+    magnitude = std::ldexp(double(mant), 1 - format.bias - format.mantBits);
+  else
+    magnitude = std::ldexp(double(mant | (mantMax + 1)),
+                           int(exp) - format.bias - format.mantBits);
+  return sign ? -magnitude : magnitude;
+}
+
+// Rounds to nearest even or toward zero like the conversions of GPUs: values
+// too large for formats without infinities saturate to their largest finite
+// value, as do values rounded toward zero
+uint64_t encodeFloat(double x, const FloatFormat &format, bool rtz) {
+  uint64_t expMax = (uint64_t(1) << format.expBits) - 1;
+  uint64_t mantMax = (uint64_t(1) << format.mantBits) - 1;
+  uint64_t signBit = uint64_t(1) << (format.width() - 1);
+  bool hasInf = format.nan == NaNEncoding::IEEE;
+  if (std::isnan(x)) {
+    if (format.nan == NaNEncoding::IEEE)
+      return (expMax << format.mantBits) | (uint64_t(1) << (format.mantBits - 1));
+    if (format.nan == NaNEncoding::NegativeZero)
+      return signBit;
+    return (expMax << format.mantBits) | mantMax;
+  }
+  uint64_t sign = std::signbit(x) ? signBit : 0;
+  if (std::isinf(x) && hasInf)
+    return sign | (expMax << format.mantBits);
+  // The largest finite value, its exponent field and mantissa
+  uint64_t maxExp = hasInf ? expMax - 1 : expMax;
+  uint64_t maxMant = format.nan == NaNEncoding::AllOnes ? mantMax - 1 : mantMax;
+  double maxFinite = std::ldexp(double(maxMant | (mantMax + 1)),
+                                int(maxExp) - format.bias - format.mantBits);
+  // The mantissa of x in units of the last place of the format
+  int minExp = 1 - format.bias;
+  int exp;
+  double a = std::fabs(x);
+  std::frexp(a, &exp);
+  int ulpExp = std::max(exp - 1, minExp) - format.mantBits;
+  double ulps = std::ldexp(a, -ulpExp);
+  double rounded = std::ldexp(rtz ? std::trunc(ulps) : std::nearbyint(ulps),
+                              ulpExp);
+  if (rounded > maxFinite) {
+    if (hasInf && !rtz)
+      return sign | (expMax << format.mantBits);
+    return sign | (maxExp << format.mantBits) | maxMant;
+  }
+  if (rounded == 0)
+    return format.nan == NaNEncoding::NegativeZero ? 0 : sign;
+  std::frexp(rounded, &exp);
+  if (exp - 1 < minExp)
+    return sign | uint64_t(std::ldexp(rounded, format.mantBits - minExp));
+  uint64_t mant = uint64_t(std::ldexp(rounded, format.mantBits - (exp - 1)));
+  return sign | (uint64_t(exp - 1 + format.bias) << format.mantBits) |
+         (mant & mantMax);
+}
+
+// Calls fn with a null pointer to the unsigned integer type of the width
+template <typename Fn> void dispatchUInt(int width, Fn &&fn) {
+  switch (width) {
+  case 8:
+    fn(static_cast<uint8_t *>(nullptr));
+    break;
+  case 16:
+    fn(static_cast<uint16_t *>(nullptr));
+    break;
+  case 32:
+    fn(static_cast<uint32_t *>(nullptr));
+    break;
+  default:
+    fn(static_cast<uint64_t *>(nullptr));
+  }
+}
+
+void convertFloats(const void *src, void *dst, const FloatFormat &srcFormat,
+                   const FloatFormat &dstFormat, bool rtz, size_t numel) {
+  dispatchUInt(srcFormat.width(), [&](auto *srcTag) {
+    dispatchUInt(dstFormat.width(), [&](auto *dstTag) {
+      using SrcT = std::remove_pointer_t<decltype(srcTag)>;
+      using DstT = std::remove_pointer_t<decltype(dstTag)>;
+      auto *srcBits = static_cast<const SrcT *>(src);
+      auto *dstBits = static_cast<DstT *>(dst);
+      parallelFor(numel, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          dstBits[i] = static_cast<DstT>(encodeFloat(
+              decodeFloat(srcBits[i], srcFormat), dstFormat, rtz));
+      });
+    });
+  });
+}
+
+// Interpreted launches in progress, only changed with the GIL held
+int numRunningLaunches = 0;
+
+py::dtype getUIntDtype(int width) {
+  py::dtype dtype;
+  dispatchUInt(width, [&](auto *tag) {
+    dtype = py::dtype::of<std::remove_pointer_t<decltype(tag)>>();
+  });
+  return dtype;
+}
+
 } // namespace
 
 void init_triton_interpreter(py::module &&m) {
@@ -327,45 +619,65 @@ void init_triton_interpreter(py::module &&m) {
       .value("UMAX", RMWOp::UMAX)
       .export_values();
 
+  m.def("enter_launch", []() { ++numRunningLaunches; });
+  m.def("exit_launch", []() { --numRunningLaunches; });
+
   m.def("load",
-        [](py::array_t<uint64_t> ptr, py::array_t<bool> mask, py::array other,
+        [](py::array_t<uint64_t, py::array::c_style | py::array::forcecast> ptr,
+           py::array_t<bool, py::array::forcecast> mask, py::array other,
            py::dtype ret_dtype) -> py::array {
           int numel = ptr.size();
           auto shape =
               std::vector<ptrdiff_t>(ptr.shape(), ptr.shape() + ptr.ndim());
           py::array ret(ret_dtype, py::array::ShapeContainer{numel});
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<bool> reshaped_mask = mask.reshape({numel});
-          py::array reshaped_others = other.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i))
-              memcpy(ret.mutable_data(i),
-                     reinterpret_cast<void *>(reshaped_ptr.at(i)),
-                     ret_dtype.itemsize());
-            else
-              memcpy(ret.mutable_data(i), reshaped_others.data(i),
-                     ret_dtype.itemsize());
+          StridedArray strided_mask(mask);
+          StridedArray strided_other(other);
+          {
+            py::gil_scoped_release allow_threads;
+            load(ptr.data(), strided_mask, strided_other,
+                 static_cast<char *>(ret.mutable_data()), ret_dtype.itemsize(),
+                 numel);
           }
           return ret.reshape(shape);
         });
 
   m.def("store",
-        [](py::array_t<uint64_t> ptr, py::array value, py::array_t<bool> mask) {
+        [](py::array_t<uint64_t, py::array::c_style | py::array::forcecast> ptr,
+           py::array value, py::array_t<bool, py::array::forcecast> mask) {
           int numel = ptr.size();
-          py::array_t<uint64_t> reshaped_ptr = ptr.reshape({numel});
-          py::array_t<int8_t> reshaped_mask = mask.reshape({numel});
-          py::array reshaped_value = value.reshape({numel});
-          for (size_t i = 0; i < ptr.size(); ++i) {
-            if (reshaped_mask.at(i)) {
-              memcpy(reinterpret_cast<void *>(reshaped_ptr.mutable_at(i)),
-                     reshaped_value.data(i), value.dtype().itemsize());
-            }
+          StridedArray strided_mask(mask);
+          StridedArray strided_value(value);
+          py::gil_scoped_release allow_threads;
+          store(ptr.data(), strided_mask, strided_value,
+                value.dtype().itemsize(), numel);
+        });
+
+  m.def("convert_float",
+        [](py::array src, const std::string &src_format,
+           const std::string &dst_format, bool rtz) -> py::array {
+          const FloatFormat &srcFormat = getFloatFormat(src_format);
+          const FloatFormat &dstFormat = getFloatFormat(dst_format);
+          if (src.itemsize() * 8 != srcFormat.width())
+            throw std::invalid_argument("The array doesn't hold " +
+                                        src_format + " values");
+          py::array contiguous_src = py::array::ensure(src, py::array::c_style);
+          if (!contiguous_src)
+            throw py::error_already_set();
+          auto shape =
+              std::vector<ptrdiff_t>(src.shape(), src.shape() + src.ndim());
+          py::array ret(getUIntDtype(dstFormat.width()), shape);
+          {
+            py::gil_scoped_release allow_threads;
+            convertFloats(contiguous_src.data(), ret.mutable_data(), srcFormat,
+                          dstFormat, rtz, ret.size());
           }
+          return ret;
         });
 
   m.def("atomic_rmw",
         [](RMWOp rmw_op, py::array_t<uint64_t> ptr, py::array val,
-           py::array_t<bool> mask, MemSemantic sem) -> py::array {
+           py::array_t<bool> mask, MemSemantic sem,
+           bool concurrent) -> py::array {
           int order = mem_semantic_map[sem];
           int numel = ptr.size();
           auto shape =
@@ -379,13 +691,17 @@ void init_triton_interpreter(py::module &&m) {
           auto *mask_data = reshaped_mask.data();
           auto *val_data = static_cast<const void *>(reshaped_val.data());
           auto *ret_data = static_cast<void *>(ret.mutable_data());
+          // The other launches may access the same memory while the GIL is
+          // released by one of their operations
+          concurrent = concurrent || numRunningLaunches > 1;
 
           std::unique_ptr<AtomicOp> atomic_op;
 
 #define MAKE_ATOMIC_RMW_OP(OP_NAME, ...)                                       \
   case OP_NAME:                                                                \
     atomic_op = makeAtomicRMWOp<OP_NAME, __VA_ARGS__>(                         \
-        ret_dtype, ptr_data, val_data, ret_data, mask_data, numel, order);     \
+        ret_dtype, ptr_data, val_data, ret_data, mask_data, numel, order,      \
+        concurrent);                                                           \
     break;
 
           switch (rmw_op) {
@@ -406,7 +722,14 @@ void init_triton_interpreter(py::module &&m) {
 
 #undef MAKE_ATOMIC_RMW_OP
 
-          atomic_op->apply();
+          // Without atomic instructions, the GIL is kept so that no other
+          // launch can start accessing memory until the operation is done
+          if (concurrent) {
+            py::gil_scoped_release allow_threads;
+            atomic_op->apply();
+          } else {
+            atomic_op->apply();
+          }
           return ret.reshape(shape);
         });
 
@@ -426,10 +749,13 @@ void init_triton_interpreter(py::module &&m) {
           memcpy(static_cast<void *>(ret.mutable_data()),
                  static_cast<const void *>(reshaped_cmp.data()),
                  itemsize * numel);
-          AtomicCASOp(reshaped_ptr.data(), ret.mutable_data(),
-                      static_cast<const void *>(reshaped_val.data()), itemsize,
-                      numel, order)
-              .apply();
+          AtomicCASOp atomic_op(reshaped_ptr.data(), ret.mutable_data(),
+                                static_cast<const void *>(reshaped_val.data()),
+                                itemsize, numel, order);
+          {
+            py::gil_scoped_release allow_threads;
+            atomic_op.apply();
+          }
           return ret.reshape(shape);
         });
 }
@@ -12,6 +12,7 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Verifier.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
@@ -21,13 +22,22 @@
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Transforms/LocationSnapshot.h"
 #include "mlir/Transforms/Passes.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Types.h"
 #include "triton/Dialect/Triton/IR/Utility.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
 namespace {
 
 namespace py = pybind11;
@@ -132,6 +142,92 @@ void outputWarning(Location loc, const std::string &msg) {
                /*stack_level=*/2);
 }
 
+// Records the wall time of every pass and the statistics it collected, which
+// are written as a JSON line once the pass manager returns.
+class PassTimingInstrumentation : public PassInstrumentation {
+public:
+  PassTimingInstrumentation(std::string kernelName)
+      : kernelName(std::move(kernelName)) {}
+
+  void runBeforePass(Pass *pass, Operation *op) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+      return;
+    auto &start = starts[{pass, std::this_thread::get_id()}];
+    start.time = Clock::now();
+    start.statistics.clear();
+    for (auto *statistic : pass->getStatistics())
+      start.statistics.push_back(statistic->getValue());
+  }
+
+  void runAfterPass(Pass *pass, Operation *op) override { record(pass, op); }
+
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    record(pass, op);
+  }
+
+  // Write the records to `path`, or to stdout if it is "-". Later runs of the
+  // pass manager are recorded by other instrumentations.
+  void finish(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    llvm::json::Object line{{"kernel", kernelName},
+                            {"passes", std::move(records)}};
+    static std::mutex outputMutex;
+    std::lock_guard<std::mutex> outputLock(outputMutex);
+    if (path == "-") {
+      llvm::outs() << llvm::json::Value(std::move(line)) << "\n";
+      llvm::outs().flush();
+      return;
+    }
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Append);
+    if (ec)
+      throw std::runtime_error("Failed to open " + path + ": " + ec.message());
+    os << llvm::json::Value(std::move(line)) << "\n";
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  struct Start {
+    Clock::time_point time;
+    std::vector<uint64_t> statistics;
+  };
+
+  void record(Pass *pass, Operation *op) {
+    auto end = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+      return;
+    auto it = starts.find({pass, std::this_thread::get_id()});
+    if (it == starts.end())
+      return;
+    llvm::json::Object statistics;
+    auto passStatistics = pass->getStatistics();
+    for (size_t i = 0; i < passStatistics.size(); ++i) {
+      uint64_t value = passStatistics[i]->getValue();
+      if (i < it->second.statistics.size())
+        value -= it->second.statistics[i];
+      statistics[passStatistics[i]->getName().str()] = value;
+    }
+    std::chrono::duration<double> time = end - it->second.time;
+    records.push_back(llvm::json::Object{
+        {"pass", pass->getArgument().str()},
+        {"name", pass->getName().str()},
+        {"op", op->getName().getStringRef().str()},
+        {"time", time.count()},
+        {"statistics", std::move(statistics)}});
+    starts.erase(it);
+  }
+
+  std::string kernelName;
+  // Passes of nested pipelines may run concurrently
+  std::mutex mutex;
+  std::map<std::pair<Pass *, std::thread::id>, Start> starts;
+  llvm::json::Array records;
+  bool finished{};
+};
+
 } // anonymous namespace
 
 /*****************************************************************************/
@@ -187,6 +283,27 @@ void init_triton_ir(py::module &&m) {
       .value("UMIN", RMWOp::UMIN)
       .value("UMAX", RMWOp::UMAX);
 
+  py::enum_<ClusterReduceKind>(m, "CLUSTER_REDUCE_KIND", py::module_local())
+      .value("ADD", ClusterReduceKind::ADD)
+      .value("MAX", ClusterReduceKind::MAX)
+      .value("MIN", ClusterReduceKind::MIN)
+      .value("UMAX", ClusterReduceKind::UMAX)
+      .value("UMIN", ClusterReduceKind::UMIN);
+
+  py::enum_<DescriptorReduceKind>(m, "DESCRIPTOR_REDUCE_KIND",
+                                  py::module_local())
+      .value("ADD", DescriptorReduceKind::ADD)
+      .value("MIN", DescriptorReduceKind::MIN)
+      .value("MAX", DescriptorReduceKind::MAX)
+      .value("AND", DescriptorReduceKind::AND)
+      .value("OR", DescriptorReduceKind::OR)
+      .value("XOR", DescriptorReduceKind::XOR);
+
+  py::enum_<SignalWaitCmp>(m, "SIGNAL_WAIT_CMP", py::module_local())
+      .value("EQ", SignalWaitCmp::EQ)
+      .value("NE", SignalWaitCmp::NE)
+      .value("GE", SignalWaitCmp::GE);
+
   py::enum_<RoundingMode>(m, "ROUNDING_MODE", py::module_local())
       .value("RTZ", RoundingMode::RTZ)
       .value("RTNE", RoundingMode::RTNE);
@@ -199,9 +316,37 @@ void init_triton_ir(py::module &&m) {
       .value("TF32", InputPrecision::TF32)
       .value("TF32x3", InputPrecision::TF32x3)
       .value("IEEE", InputPrecision::IEEE)
+      .value("BF16x3", InputPrecision::BF16x3)
+      .value("BF16x6", InputPrecision::BF16x6)
+      .value("BF16x9", InputPrecision::BF16x9)
+      .export_values();
+
+  py::enum_<ScaleDotElemType>(m, "SCALE_DOT_ELEM_TYPE", py::module_local())
+      .value("E4M3", ScaleDotElemType::E4M3)
+      .value("E5M2", ScaleDotElemType::E5M2)
+      .value("E2M1", ScaleDotElemType::E2M1)
+      .value("BF16", ScaleDotElemType::BF16)
+      .export_values();
+
+  py::enum_<PackedElemType>(m, "PACKED_ELEM_TYPE", py::module_local())
+      .value("I4", PackedElemType::I4)
+      .value("U4", PackedElemType::U4)
+      .value("E2M1", PackedElemType::E2M1)
       .export_values();
 
-  py::class_<MLIRContext>(m, "context", py::module_local()).def(py::init<>());
+  py::class_<MLIRContext>(m, "context", py::module_local())
+      .def(py::init([]() {
+        // The contexts of the compilations share a thread pool, instead of
+        // each spawning a thread per core. The pass manager merges the
+        // results of the threads in order, so they are deterministic. The
+        // pool is leaked, the contexts may be destroyed at exit after it.
+        static auto *threadPool =
+            new llvm::DefaultThreadPool(llvm::hardware_concurrency());
+        auto context =
+            std::make_unique<MLIRContext>(MLIRContext::Threading::DISABLED);
+        context->setThreadPool(*threadPool);
+        return context;
+      }));
 
   m.def("load_dialects", [](MLIRContext &context) {
     DialectRegistry registry;
@@ -472,6 +617,23 @@ void init_triton_ir(py::module &&m) {
                return py::none();
              return py::int_(ret.getInt());
            })
+      .def("get_str_attr",
+           [](ModuleOp &self, std::string name) -> py::object {
+             auto ret = self->getAttrOfType<StringAttr>(name);
+             if (!ret)
+               return py::none();
+             return py::str(ret.getValue().str());
+           })
+      .def("estimate_registers_per_thread",
+           [](ModuleOp &self) -> int {
+             // the highest pressure of the functions of a TTGIR module
+             unsigned regs = 0;
+             self.walk([&](FuncOp funcOp) {
+               regs = std::max(
+                   regs, RegisterPressureAnalysis(funcOp).getMaxRegisters());
+             });
+             return regs;
+           })
       .def("create_location_snapshot",
            [](ModuleOp &self, const std::string &fileName) -> void {
              generateLocationsFromIR(/*raw_ostream=*/llvm::nulls(),
@@ -490,6 +652,10 @@ void init_triton_ir(py::module &&m) {
         values));
   });
 
+  m.def("make_unit_attr", [](MLIRContext &context) {
+    return mlir::cast<Attribute>(UnitAttr::get(&context));
+  });
+
   m.def(
       "parse_mlir_module",
       [](const std::string &inputFilename, MLIRContext &context) {
@@ -527,6 +693,19 @@ void init_triton_ir(py::module &&m) {
             self.setArgAttr(arg_no, name, IntegerAttr::get(attrTy, val));
           },
           ret::reference)
+      .def("set_arg_attr",
+           [](FuncOp &self, int arg_no, const std::string &name,
+              std::vector<int64_t> &vals) {
+             if (arg_no >= self.getNumArguments())
+               throw pybind11::index_error(
+                   "Function argument index out of range");
+             // set arg attributes "name" to the i64 tensor "vals"
+             auto attrTy = RankedTensorType::get(
+                 {static_cast<int64_t>(vals.size())},
+                 IntegerType::get(self.getContext(), 64));
+             self.setArgAttr(arg_no, name,
+                             DenseIntElementsAttr::get(attrTy, vals));
+           })
       //  .def("has_attr", &::FuncOp::hasAttr)
       .def("finalize",
            [](FuncOp &self) -> void {
@@ -876,16 +1055,27 @@ void init_triton_ir(py::module &&m) {
 
       // Cast instructions
       // Conversions for custom FP types (FP8 and non-standard rounding modes)
-      .def("create_fp_to_fp",
-           [](TritonOpBuilder &self, Value &src, Type &dstType,
-              std::optional<RoundingMode> roundingMode) -> Value {
-             if (roundingMode.has_value())
-               return self.create<FpToFpOp>(
-                   dstType, src,
-                   RoundingModeAttr::get(self.getBuilder().getContext(),
-                                         roundingMode.value()));
-             else
-               return self.create<FpToFpOp>(dstType, src);
+      .def(
+          "create_fp_to_fp",
+          [](TritonOpBuilder &self, Value &src, Type &dstType,
+             std::optional<RoundingMode> roundingMode,
+             std::optional<Value> rbits) -> Value {
+            if (roundingMode.has_value())
+              return self.create<FpToFpOp>(
+                  dstType, src,
+                  RoundingModeAttr::get(self.getBuilder().getContext(),
+                                        roundingMode.value()),
+                  rbits.value_or(Value()));
+            else
+              return self.create<FpToFpOp>(dstType, src);
+          },
+          py::arg("src"), py::arg("dst_type"), py::arg("rounding_mode"),
+          py::arg("rbits") = py::none())
+      // Conversions of sub-byte elements packed two to a byte
+      .def("create_unpack",
+           [](TritonOpBuilder &self, Value &src, PackedElemType format,
+              int axis, Type &dstType) -> Value {
+             return self.create<UnpackOp>(dstType, src, format, axis);
            })
       // Conversions for standard LLVM builtin types
       .def("create_bitcast",
@@ -1248,18 +1438,27 @@ void init_triton_ir(py::module &&m) {
            })
       .def("create_descriptor_load",
            [](TritonOpBuilder &self, Value &desc_ptr,
-              std::vector<Value> &indices, Type type,
-              CacheModifier cacheModifier,
+              std::vector<Value> &indices, std::vector<Value> &im2colOffsets,
+              Type type, CacheModifier cacheModifier,
               EvictionPolicy evictionPolicy) -> Value {
              return self.create<ExperimentalDescriptorLoadOp>(
-                 type, desc_ptr, indices, cacheModifier, evictionPolicy);
-           })
-      .def("create_descriptor_store",
-           [](TritonOpBuilder &self, Value &desc_ptr, Value value,
-              std::vector<Value> &indices) -> void {
-             self.create<ExperimentalDescriptorStoreOp>(desc_ptr, value,
-                                                        indices);
+                 type, desc_ptr, indices, im2colOffsets, cacheModifier,
+                 evictionPolicy);
            })
+      .def(
+          "create_descriptor_store",
+          [](TritonOpBuilder &self, Value &desc_ptr, Value value,
+             std::vector<Value> &indices,
+             std::optional<DescriptorReduceKind> reduceKind) -> void {
+            DescriptorReduceKindAttr reduceKindAttr;
+            if (reduceKind.has_value())
+              reduceKindAttr = DescriptorReduceKindAttr::get(
+                  self.getBuilder().getContext(), reduceKind.value());
+            self.create<ExperimentalDescriptorStoreOp>(desc_ptr, value, indices,
+                                                       reduceKindAttr);
+          },
+          py::arg("desc_ptr"), py::arg("value"), py::arg("indices"),
+          py::arg("reduce_kind") = py::none())
       .def("create_reshape",
            [](TritonOpBuilder &self, Value &arg, std::vector<int64_t> &shape,
               bool allowReorder) -> Value {
@@ -1398,6 +1597,21 @@ void init_triton_ir(py::module &&m) {
              return self.create<DotOp>(c.getType(), a, b, c, inputPrecision,
                                        maxNumImpreciseAcc);
            })
+      .def("create_dot_scaled",
+           [](TritonOpBuilder &self, Value &lhs, std::optional<Value> &lhsScale,
+              ScaleDotElemType lhsType, Value &rhs,
+              std::optional<Value> &rhsScale, ScaleDotElemType rhsType,
+              Value &c) -> Value {
+             return self.create<DotScaledOp>(
+                 c.getType(), lhs, rhs, c, lhsScale.value_or(Value()),
+                 rhsScale.value_or(Value()), lhsType, rhsType);
+           })
+      .def("create_sparse_dot",
+           [](TritonOpBuilder &self, Value &a, Value &b, Value &c,
+              Value &aMeta) -> Value {
+             return self.create<::mlir::triton::gpu::SparseDotOp>(
+                 c.getType(), a, b, c, aMeta);
+           })
       .def("create_floor",
            [](TritonOpBuilder &self, Value &val) -> Value {
              return self.create<math::FloorOp>(val);
@@ -1531,6 +1745,46 @@ void init_triton_ir(py::module &&m) {
                      IntegerType::get(operand.getContext(), 32)),
                  operand);
            })
+      .def("create_sort",
+           [](TritonOpBuilder &self, std::vector<Value> operands,
+              bool descending) -> std::vector<Value> {
+             auto op = self.create<SortOp>(operands, descending);
+             return std::vector<Value>(op->result_begin(), op->result_end());
+           })
+      .def("create_gather",
+           [](TritonOpBuilder &self, Value &src, Value &indices,
+              int axis) -> Value {
+             auto srcTy = cast<RankedTensorType>(src.getType());
+             auto indicesTy = cast<RankedTensorType>(indices.getType());
+             auto resultTy = RankedTensorType::get(indicesTy.getShape(),
+                                                   srcTy.getElementType());
+             return self.create<GatherOp>(resultTy, src, indices, axis);
+           })
+      .def("create_cluster_reduce",
+           [](TritonOpBuilder &self, Value &operand, ClusterReduceKind kind,
+              int clusterSize) -> Value {
+             return self.create<ClusterReduceOp>(operand, kind, clusterSize);
+           })
+      .def("create_grid_sync",
+           [](TritonOpBuilder &self, Value &barrier) -> void {
+             self.create<GridSyncOp>(barrier);
+           })
+      .def("create_workspace",
+           [](TritonOpBuilder &self, Type &ptrType, int64_t size,
+              bool zeroed) -> Value {
+             return self.create<WorkspaceOp>(ptrType, size, zeroed);
+           })
+      .def("create_griddep_wait",
+           [](TritonOpBuilder &self) -> void { self.create<GridDepWaitOp>(); })
+      .def("create_griddep_launch_dependents",
+           [](TritonOpBuilder &self) -> void {
+             self.create<GridDepLaunchDependentsOp>();
+           })
+      .def("create_signal_wait",
+           [](TritonOpBuilder &self, Value &flag, Value &value,
+              SignalWaitCmp cmp, MemSyncScope scope) -> void {
+             self.create<SignalWaitOp>(flag, value, cmp, scope);
+           })
       // Force GPU barrier
       .def("create_barrier",
            [](TritonOpBuilder &self) { self.create<mlir::gpu::BarrierOp>(); })
@@ -1625,7 +1879,34 @@ void init_triton_ir(py::module &&m) {
           self.enableTiming();
         }
 
-        if (failed(self.run(mod.getOperation())))
+        PassTimingInstrumentation *passTiming = nullptr;
+        auto passTimingPath =
+            triton::tools::getStrEnv("TRITON_PASS_TIMING_JSON");
+        if (!passTimingPath.empty()) {
+          // Name the records after the kernel, the first public function
+          std::string kernelName;
+          mod.walk([&](FunctionOpInterface func) {
+            if (!func.isPublic())
+              return WalkResult::advance();
+            kernelName = func.getName().str();
+            return WalkResult::interrupt();
+          });
+          auto instrumentation =
+              std::make_unique<PassTimingInstrumentation>(kernelName);
+          passTiming = instrumentation.get();
+          self.addInstrumentation(std::move(instrumentation));
+        }
+
+        LogicalResult result = failure();
+        {
+          // Release the GIL so that kernels can be compiled concurrently,
+          // every compilation has a context of its own
+          py::gil_scoped_release allow_threads;
+          result = self.run(mod.getOperation());
+        }
+        if (passTiming)
+          passTiming->finish(passTimingPath);
+        if (failed(result))
           throw std::runtime_error("PassManager::run failed");
       });
 }
@@ -33,6 +33,10 @@ struct BreakStructPhiNodesPass : PassInfoMixin<BreakStructPhiNodesPass> {
   PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
   static StringRef name() { return "BreakStructPhiNodesPass"; }
 };
+struct ScalarizeStructsPass : PassInfoMixin<ScalarizeStructsPass> {
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+  static StringRef name() { return "ScalarizeStructsPass"; }
+};
 } // namespace llvm
 
 using namespace llvm;
@@ -240,6 +244,9 @@ void init_triton_llvm(py::module &&m) {
   m.def(
       "to_module",
       [](mlir::ModuleOp &mod, llvm::LLVMContext &ctx) {
+        // Both contexts belong to a single compilation, release the GIL so
+        // that kernels can be translated concurrently
+        py::gil_scoped_release allow_threads;
         return mlir::translateModuleToLLVMIR(mod, ctx);
       },
       py::keep_alive<0, 2>());
@@ -327,6 +334,13 @@ void init_triton_llvm(py::module &&m) {
         pb.crossRegisterProxies(lam, fam, cgam, mam);
 
         ModulePassManager mpm;
+        pb.registerPipelineStartEPCallback(
+            [&](llvm::ModulePassManager &pm, llvm::OptimizationLevel level) {
+              // The loops carry the structs of the elements of tensors, split
+              // them before SROA and the loop passes run
+              pm.addPass(
+                  createModuleToFunctionPassAdaptor(ScalarizeStructsPass()));
+            });
         pb.registerVectorizerStartEPCallback(
             [&](llvm::FunctionPassManager &fpm, llvm::OptimizationLevel level) {
               // Triton generates large structure of scalars which may pessimise
@@ -335,7 +349,14 @@ void init_triton_llvm(py::module &&m) {
               fpm.addPass(BreakStructPhiNodesPass());
               fpm.addPass(InstCombinePass());
             });
-        mpm.addPass(pb.buildPerModuleDefaultPipeline(opt));
+        // The default pipeline requires optimizations
+        if (opt == OptimizationLevel::O0)
+          mpm.addPass(pb.buildO0DefaultPipeline(opt));
+        else
+          mpm.addPass(pb.buildPerModuleDefaultPipeline(opt));
+        // The module is owned by an LLVM context of its own, release the GIL
+        // so that kernels can be optimized concurrently
+        py::gil_scoped_release allow_threads;
         mpm.run(*mod, mam);
       },
       py::arg("mod"), py::arg("opt"), py::arg("triple") = "");
@@ -387,6 +408,8 @@ void init_triton_llvm(py::module &&m) {
     if (paths.empty())
       return;
 
+    // Parsing the libraries is slow, release the GIL like optimize_module
+    py::gil_scoped_release allow_threads;
     LLVMContext &ctx = dstMod->getContext();
     llvm::Linker linker(*dstMod);
     for (const std::string &path : paths) {
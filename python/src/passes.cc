@@ -7,6 +7,7 @@
 #include "triton/Analysis/Membar.h"
 #include "triton/Conversion/TritonGPUToLLVM/Passes.h"
 #include "triton/Conversion/TritonToTritonGPU/Passes.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Target/LLVMIR/Passes.h"
@@ -31,6 +32,9 @@ void init_triton_passes_common(py::module &&m) {
   ADD_PASS_WRAPPER_0("add_canonicalizer", createCanonicalizerPass);
   ADD_PASS_WRAPPER_0("add_cse", createCSEPass);
   ADD_PASS_WRAPPER_0("add_licm", createLoopInvariantCodeMotionPass);
+  ADD_FUNC_PASS_WRAPPER_0("add_func_canonicalizer", createCanonicalizerPass);
+  ADD_FUNC_PASS_WRAPPER_0("add_func_cse", createCSEPass);
+  ADD_FUNC_PASS_WRAPPER_0("add_func_licm", createLoopInvariantCodeMotionPass);
 }
 
 void init_triton_passes_ttir(py::module &&m) {
@@ -39,6 +43,18 @@ void init_triton_passes_ttir(py::module &&m) {
   ADD_PASS_WRAPPER_0("add_reorder_broadcast", createReorderBroadcastPass);
   ADD_PASS_WRAPPER_0("add_rewrite_tensor_pointer",
                      createRewriteTensorPointerPass);
+  ADD_PASS_WRAPPER_1("add_rewrite_tensor_pointer",
+                     createRewriteTensorPointerPass, bool);
+  ADD_PASS_WRAPPER_0("add_forward_store_to_load",
+                     createForwardStoreToLoadPass);
+  ADD_PASS_WRAPPER_0("add_narrow_offsets", createNarrowOffsetsPass);
+  ADD_PASS_WRAPPER_0("add_eviction_hints", createEvictionHintsPass);
+  ADD_PASS_WRAPPER_0("add_allocate_workspace", createAllocateWorkspacePass);
+  ADD_PASS_WRAPPER_0("add_dynamic_program_ids", createDynamicProgramIdsPass);
+  ADD_PASS_WRAPPER_0("add_magic_divisors", createMagicDivisorsPass);
+  ADD_PASS_WRAPPER_2("add_persistent_kernel", createPersistentKernelPass,
+                     const std::string &, int);
+  ADD_PASS_WRAPPER_1("add_tile_swizzle", createTileSwizzlePass, int);
   ADD_PASS_WRAPPER_4("add_convert_to_ttgpuir",
                      createConvertTritonToTritonGPUPass, const std::string &,
                      int, int, int);
@@ -50,11 +66,14 @@ void init_triton_passes_ttgpuir(py::module &&m) {
   ADD_PASS_WRAPPER_0("add_optimize_thread_locality",
                      createTritonGPUOptimizeThreadLocality);
   ADD_PASS_OPTION_WRAPPER_1("add_pipeline", createTritonGPUPipeline, int);
-  ADD_PASS_WRAPPER_0("add_prefetch", createTritonGPUPrefetch);
-  ADD_PASS_WRAPPER_0("add_accelerate_matmul", createTritonGPUAccelerateMatmul);
+  ADD_PASS_OPTION_WRAPPER_1("add_prefetch", createTritonGPUPrefetch, int);
+  ADD_PASS_OPTION_WRAPPER_1("add_accelerate_matmul",
+                            createTritonGPUAccelerateMatmul, int);
   ADD_PASS_WRAPPER_0("add_reorder_instructions",
                      createTritonGPUReorderInstructions);
   ADD_PASS_WRAPPER_0("add_f32_dot_tc", createTritonGPUF32DotTC);
+  ADD_PASS_WRAPPER_0("add_decompose_scaled_dot",
+                     createTritonGPUDecomposeScaledDot);
   ADD_PASS_OPTION_WRAPPER_1("add_optimize_dot_operands",
                             createTritonGPUOptimizeDotOperands, bool);
   ADD_PASS_WRAPPER_0("add_remove_layout_conversions",
@@ -65,6 +84,12 @@ void init_triton_passes_ttgpuir(py::module &&m) {
                      createAllocateSharedMemoryPass);
   ADD_PASS_WRAPPER_0("add_combine_tensor_select_and_if",
                      createTritonGPUCombineTensorSelectAndIf);
+  ADD_PASS_WRAPPER_0("add_report_shared_memory_access",
+                     createTritonGPUReportSharedMemoryAccess);
+  ADD_PASS_WRAPPER_0("add_tile_versioning", createTritonGPUTileVersioning);
+  ADD_PASS_WRAPPER_0("add_outline_cold_regions",
+                     createTritonGPUOutlineColdRegions);
+  ADD_PASS_OPTION_WRAPPER_1("add_loop_unroll", createTritonGPULoopUnroll, bool);
 }
 
 void init_triton_passes_convert(py::module &&m) {
@@ -78,6 +103,7 @@ void init_triton_passes_convert(py::module &&m) {
 void init_triton_passes_llvmir(py::module &&m) {
   using namespace mlir;
   ADD_PASS_WRAPPER_0("add_di_scope", createLLVMDIScopePass);
+  ADD_PASS_WRAPPER_1("add_di_scope", createLLVMDIScopePass, bool);
 }
 
 void init_triton_passes(py::module &&m) {
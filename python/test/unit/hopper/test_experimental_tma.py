@@ -128,3 +128,69 @@ def test_experimental_tma_matmul(num_stages, BLOCK_M, BLOCK_N, BLOCK_K):
     torch.testing.assert_close(ref_out, C, rtol=1e-3, atol=1e-3)
     if BLOCK_M >= 64 and BLOCK_N >= 64:
         assert "stmatrix.sync.aligned.m8n8.x4.shared.b16" in kernel.asm["ptx"]
+
+
+@triton.jit
+def matmul_kernel_tma_split_k(a_desc_ptr, b_desc_ptr, c_desc_ptr,  #
+                              M, N, K, BLOCK_SIZE_M: tl.constexpr, BLOCK_SIZE_N: tl.constexpr,
+                              BLOCK_SIZE_K: tl.constexpr, SPLIT_K: tl.constexpr):
+    pid = tl.program_id(axis=0)
+    pid_k = tl.program_id(axis=1)
+    num_pid_m = tl.cdiv(M, BLOCK_SIZE_M)
+    offs_am = (pid % num_pid_m) * BLOCK_SIZE_M
+    offs_bn = (pid // num_pid_m) * BLOCK_SIZE_N
+    accumulator = tl.zeros((BLOCK_SIZE_M, BLOCK_SIZE_N), dtype=tl.float32)
+    for offs_k in range(pid_k * BLOCK_SIZE_K, K, BLOCK_SIZE_K * SPLIT_K):
+        a = tl._experimental_descriptor_load(a_desc_ptr, [offs_am, offs_k], [BLOCK_SIZE_M, BLOCK_SIZE_K], tl.float16)
+        b = tl._experimental_descriptor_load(b_desc_ptr, [offs_k, offs_bn], [BLOCK_SIZE_K, BLOCK_SIZE_N], tl.float16)
+        accumulator = tl.dot(a, b, acc=accumulator)
+    tl._experimental_descriptor_store(c_desc_ptr, accumulator, [offs_am, offs_bn], reduce="add")
+
+
+def test_experimental_tma_reduce_split_k():
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    device = "cuda"
+    M, N, K = 512, 512, 1024
+    BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K = 128, 64, 64, 4
+    torch.manual_seed(42)
+    A = torch.randn((M, K), dtype=torch.float16, device=device)
+    B = torch.randn((K, N), dtype=torch.float16, device=device)
+    C = torch.zeros((M, N), dtype=torch.float32, device=device)
+    TMA_SIZE = 128
+    desc_a = np.empty(TMA_SIZE, dtype=np.int8)
+    desc_b = np.empty(TMA_SIZE, dtype=np.int8)
+    desc_c = np.empty(TMA_SIZE, dtype=np.int8)
+    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(A.data_ptr(), M, K, BLOCK_M, BLOCK_K, A.element_size(),
+                                                              desc_a)
+    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(B.data_ptr(), K, N, BLOCK_K, BLOCK_N, B.element_size(),
+                                                              desc_b)
+    # the TMA unit adds the partial tiles as the element type of the descriptor
+    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(C.data_ptr(), M, N, BLOCK_M, BLOCK_N, C.element_size(),
+                                                              desc_c, "fp32")
+
+    desc_a = torch.tensor(desc_a, device=device)
+    desc_b = torch.tensor(desc_b, device=device)
+    desc_c = torch.tensor(desc_c, device=device)
+    kernel = matmul_kernel_tma_split_k[(triton.cdiv(M, BLOCK_M) * triton.cdiv(N, BLOCK_N), SPLIT_K,
+                                        1)](desc_a, desc_b, desc_c, M, N, K, BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K,
+                                            num_warps=8)
+    ref_out = torch.matmul(A.to(torch.float32), B.to(torch.float32))
+    torch.testing.assert_close(ref_out, C, rtol=1e-3, atol=1e-3)
+    assert "cp.reduce.async.bulk.tensor.2d.global.shared::cta.add.tile.bulk_group" in kernel.asm["ptx"]
+
+
+def test_tma_descriptor_cache():
+    if not torch.cuda.is_available() or not torch.cuda.get_device_capability()[0] == 9:
+        pytest.skip("Test requires Hopper target.")
+        return
+    M, K = 256, 128
+    A = torch.randn((M, K), dtype=torch.float16, device="cuda")
+    utils = triton.runtime.driver.active.utils
+    desc = utils.get_tma_descriptor(A.data_ptr(), [M, K], [K, 1], [64, 64], A.element_size())
+    expected = np.empty(128, dtype=np.int8)
+    utils.fill_2d_tma_descriptor(A.data_ptr(), M, K, 64, 64, A.element_size(), expected)
+    assert desc.cpu().numpy().view(np.int8).tobytes() == expected.tobytes()
+    assert utils.get_tma_descriptor(A.data_ptr(), [M, K], [K, 1], [64, 64], A.element_size()) is desc
+    assert utils.get_tma_descriptor(A.data_ptr(), [M, K], [K, 1], [64, 32], A.element_size()) is not desc
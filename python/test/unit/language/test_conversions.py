@@ -352,3 +352,40 @@ def test_typeconvert_downcast(src_dtype, dst_dtype, rounding, max_repr, device):
 
     for i in range(256):
         downcast_test(getattr(tl, src_dtype), getattr(tl, dst_dtype), rounding, *stuff, max_repr, i, device=device)
+
+
+@triton.jit
+def stochastic_round_triton(src, dst, seed, BLOCK_SIZE : tl.constexpr):
+
+    idxs = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+
+    x = tl.load(src + idxs)
+    rbits = tl.randint(seed, idxs)
+    y = x.to(dst.dtype.element_ty, fp_downcast_rounding="rs", rbits=rbits)
+    tl.store(dst + idxs, y)
+
+
+@pytest.mark.parametrize("src_dtype, dst_dtype, ulp", [
+    ('float32', 'float16', 2**-10),
+    ('float32', 'bfloat16', 2**-7),
+    ('float32', 'float8e5', 2**-2),
+    ('float16', 'float8e5', 2**-2),
+    ('bfloat16', 'float8e5', 2**-2),
+])
+@pytest.mark.parametrize("sign", [1, -1])
+def test_typeconvert_stochastic(src_dtype, dst_dtype, ulp, sign, device):
+
+    if dst_dtype == 'float8e5' and is_hip():
+        pytest.skip("float8e5 is only supported on NVGPU")
+
+    # A quarter of an ulp above 1 rounds up a quarter of the time, to 1 + ulp
+    n = 2**16
+    src = torch.full((n,), sign * (1 + ulp / 4), dtype=getattr(torch, src_dtype), device=device)
+    torch_dst_dtype = {'float16': torch.float16, 'bfloat16': torch.bfloat16, 'float8e5': torch.float8_e5m2}[dst_dtype]
+    dst = torch.empty((n,), dtype=torch_dst_dtype, device=device)
+    BLOCK_SIZE = 1024
+    stochastic_round_triton[(n // BLOCK_SIZE,)](src, dst, 42, BLOCK_SIZE)
+
+    y = dst.float() * sign
+    assert torch.all((y == 1) | (y == 1 + ulp))
+    assert abs((y == 1 + ulp).float().mean().item() - 0.25) < 0.02
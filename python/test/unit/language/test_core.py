@@ -1421,7 +1421,9 @@ def test_atomic_rmw(op, dtype_x_str, mode, sem, device):
     if not is_cuda():
         return
 
-    assert f"atom.global.gpu.{sem_str}" in h.asm["ptx"]
+    # the result is unused, so the updates that don't acquire are reductions
+    instr = "red" if sem_str in ("relaxed", "release") else "atom"
+    assert f"{instr}.global.gpu.{sem_str}" in h.asm["ptx"]
 
 
 @pytest.mark.interpreter
@@ -1492,6 +1494,71 @@ def test_tensor_atomic_rmw_block(num_ctas, device):
     assert torch.min(x).item() == 0.0
 
 
+@pytest.mark.interpreter
+def test_atomic_interpreter_threads(device, monkeypatch):
+    if not is_interpreter():
+        pytest.skip("TRITON_INTERPRET_THREADS only applies to the interpreter")
+    monkeypatch.setenv("TRITON_INTERPRET_THREADS", "8")
+
+    @triton.jit
+    def kernel(X, Count, Y, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = tl.arange(0, BLOCK)
+        tl.atomic_add(X + offs, 1.0)
+        tl.atomic_add(Count, 1)
+        tl.store(Y + pid * BLOCK + offs, pid)
+
+    n_programs, BLOCK = 256, 64
+    x = torch.zeros((BLOCK, ), device=device, dtype=torch.float32)
+    count = torch.zeros((1, ), device=device, dtype=torch.int32)
+    y = torch.zeros((n_programs, BLOCK), device=device, dtype=torch.int32)
+    kernel[(n_programs, )](x, count, y, BLOCK=BLOCK)
+    assert torch.all(x == n_programs)
+    assert count.item() == n_programs
+    assert torch.equal(y.cpu(), torch.arange(n_programs, dtype=torch.int32)[:, None].expand(-1, BLOCK))
+
+
+@pytest.mark.interpreter
+def test_atomic_interpreter_python_threads():
+    if not is_interpreter():
+        pytest.skip("only the interpreter runs launches on the calling Python thread")
+    from concurrent.futures import ThreadPoolExecutor
+
+    @triton.jit
+    def kernel(X, BLOCK: tl.constexpr):
+        tl.atomic_add(X + tl.arange(0, BLOCK), 1.0)
+
+    # host tensors are shared by the launches rather than copied
+    n_launches, n_programs, BLOCK = 4, 64, 1024
+    x = torch.zeros((BLOCK, ), dtype=torch.float32)
+    with ThreadPoolExecutor(max_workers=n_launches) as executor:
+        futures = [executor.submit(lambda: kernel[(n_programs, )](x, BLOCK=BLOCK)) for _ in range(n_launches)]
+        for future in futures:
+            future.result()
+    assert torch.all(x == n_launches * n_programs)
+
+
+@pytest.mark.interpreter
+def test_atomic_scalar_operands(device):
+    # the scalar values and the default mask are splats of a single element
+
+    @triton.jit
+    def kernel(X, Y, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.atomic_add(X + offs, 3)
+        tl.atomic_cas(Y + offs, 0, 5)
+
+    BLOCK = 64
+    x = torch.arange(BLOCK, device=device, dtype=torch.int32)
+    y = torch.zeros((BLOCK, ), device=device, dtype=torch.int32)
+    y[::2] = 1
+    kernel[(1, )](x, y, BLOCK=BLOCK)
+    assert torch.equal(x.cpu(), torch.arange(BLOCK, dtype=torch.int32) + 3)
+    y_ref = torch.full((BLOCK, ), 5, dtype=torch.int32)
+    y_ref[::2] = 1
+    assert torch.equal(y.cpu(), y_ref)
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("sem", [None, 'acquire', 'release', 'acq_rel', 'relaxed'])
 @pytest.mark.parametrize("num_ctas", num_ctas_list)
@@ -1577,10 +1644,8 @@ def test_tensor_atomic_cas(sem, num_ctas, device):
 @pytest.mark.parametrize("num_ctas", num_ctas_list)
 def test_cast(dtype_x, dtype_z, bitcast, size, num_ctas, device):
     # CUDA: bfloat16 on cc < 80 will not be tested
-    # Interpreter: Only bfloat16 <-> float32 is supported
-    if not is_interpreter() or \
-        (is_interpreter() and not ((dtype_z == 'bfloat16' and dtype_x == 'float32')
-                                   or (dtype_z == 'float32' and dtype_x == 'bfloat16'))):
+    # Interpreter: bfloat16 is supported in casts
+    if not is_interpreter():
         check_type_supported(dtype_x, device)
         check_type_supported(dtype_z, device)
 
@@ -1947,6 +2012,44 @@ def test_convert_float16_to_float32(in_dtype, device):
     assert torch.all(f16_input[other] == f32_output[other])
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("format", ["int4", "uint4", "e2m1"])
+@pytest.mark.parametrize("dtype_str", ["int8", "float16", "bfloat16", "float32"])
+@pytest.mark.parametrize("axis", [0, 1])
+def test_unpack(format, dtype_str, axis, device):
+    if format == "e2m1" and dtype_str == "int8":
+        pytest.skip("e2m1 doesn't unpack to integers")
+    check_type_supported(dtype_str, device)
+
+    @triton.jit
+    def kernel(X, Z, M: tl.constexpr, N: tl.constexpr, FORMAT: tl.constexpr, AXIS: tl.constexpr):
+        offs_m = tl.arange(0, M // 2 if AXIS == 0 else M)
+        offs_n = tl.arange(0, N // 2 if AXIS == 1 else N)
+        x = tl.load(X + offs_m[:, None] * (N // 2 if AXIS == 1 else N) + offs_n[None, :])
+        z = tl.unpack(x, FORMAT, AXIS, Z.dtype.element_ty)
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        tl.store(Z + offs_m[:, None] * N + offs_n[None, :], z)
+
+    M, N = 32, 64
+    torch.manual_seed(0)
+    shape = (M // 2, N) if axis == 0 else (M, N // 2)
+    x = torch.randint(0, 256, shape, dtype=torch.uint8, device=device)
+    # the lower nibble first
+    nibbles = torch.stack([x & 0xf, x >> 4], dim=axis + 1).reshape(M, N).to(torch.int32)
+    if format == "e2m1":
+        values = torch.tensor([0, 0.5, 1, 1.5, 2, 3, 4, 6, -0.0, -0.5, -1, -1.5, -2, -3, -4, -6], device=device)
+        ref = values[nibbles]
+    elif format == "int4":
+        ref = torch.where(nibbles >= 8, nibbles - 16, nibbles)
+    else:
+        ref = nibbles
+    dtype = getattr(torch, dtype_str)
+    z = torch.empty((M, N), dtype=dtype, device=device)
+    kernel[(1, )](x, z, M, N, format, axis)
+    torch.testing.assert_close(z, ref.to(dtype), rtol=0, atol=0)
+
+
 def serialize_fp8(np_data, in_dtype):
     return np_data
 
@@ -2371,6 +2474,64 @@ def test_scan2d(op, dtype_str, shape, axis, reverse, num_warps, device):
         np.testing.assert_equal(z_ref, z_tri)
 
 
+@triton.jit
+def _segment_add(a, b):
+    return a + b
+
+
+@pytest.mark.interpreter
+@pytest.mark.parametrize("op", ['segmented_scan', 'segmented_reduce'])
+@pytest.mark.parametrize("axis", [0, 1])
+@pytest.mark.parametrize("reverse", [False, True])
+def test_segmented_scan(op, axis, reverse, device):
+    if op == 'segmented_reduce' and reverse:
+        pytest.skip("segmented_reduce has no direction")
+
+    @triton.jit
+    def kernel(X, F, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr, REVERSE: tl.constexpr,
+               OP: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        offs = range_m[:, None] * BLOCK_N + range_n[None, :]
+        x = tl.load(X + offs)
+        f = tl.load(F + offs)
+        if OP == 'segmented_scan':
+            z = tl.segmented_scan(x, f, AXIS, _segment_add, reverse=REVERSE)
+        else:
+            z = tl.segmented_reduce(x, f, AXIS, _segment_add)
+        tl.store(Z + offs, z)
+
+    shape = (32, 64)
+    rs = RandomState(17)
+    x = numpy_random(shape, dtype_str='int32', rs=rs)
+    f = (rs.randint(0, 8, shape) == 0).astype(np.int32)
+    # reference result, scanning along rows
+    x_ref = x.T if axis == 0 else x
+    f_ref = f.T if axis == 0 else f
+    z_ref = np.zeros_like(x_ref)
+    for i in range(x_ref.shape[0]):
+        segments = []
+        for j in range(x_ref.shape[1]):
+            starts = f_ref[i, j] if not reverse else j == 0 or f_ref[i, j - 1]
+            if j == 0 or starts:
+                segments.append([])
+            segments[-1].append(j)
+        for segment in segments:
+            if op == 'segmented_reduce':
+                z_ref[i, segment] = np.sum(x_ref[i, segment], dtype=x.dtype)
+            elif reverse:
+                z_ref[i, segment] = np.flip(np.cumsum(np.flip(x_ref[i, segment]), dtype=x.dtype))
+            else:
+                z_ref[i, segment] = np.cumsum(x_ref[i, segment], dtype=x.dtype)
+    if axis == 0:
+        z_ref = z_ref.T
+    x_tri = to_triton(x, device=device)
+    f_tri = to_triton(f, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(1, )](x_tri, f_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis, REVERSE=reverse, OP=op)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
 scan_layouts = [
     BlockedLayout([1, 4], [4, THREADS_PER_WARP // 4], [4, 1], [0, 1], [1, 1], [1, 1], [0, 1]),
     BlockedLayout([1, 4], [8, THREADS_PER_WARP // 8], [4, 1], [0, 1], [1, 1], [1, 1], [0, 1]),
@@ -2391,7 +2552,8 @@ scan_layouts = [
 
 
 @pytest.mark.interpreter
-@pytest.mark.parametrize("M, N", [[2048, 2], [1024, 8], [1024, 128], [256, 512], [32, 512], [8, 512], [8, 2]])
+@pytest.mark.parametrize("M, N", [[2048, 2], [1024, 8], [1024, 128], [256, 512], [32, 512], [8, 512], [8, 2], [4096, 256],
+                                  [8192, 1024], [128, 1024]])
 def test_histogram(M, N, device):
 
     @triton.jit
@@ -2413,6 +2575,138 @@ def test_histogram(M, N, device):
     assert (z_torch == z).all()
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, K, axis", [(1, 128, 128, 1), (4, 32, 64, 1), (16, 64, 16, 1), (32, 8, 8, 0)])
+@pytest.mark.parametrize("dtype_str", ['int8', 'float16', 'float32'])
+def test_gather(M, N, K, axis, dtype_str, device):
+
+    @triton.jit
+    def gather_kernel(X, I, Z, M: tl.constexpr, N: tl.constexpr, IM: tl.constexpr, IN: tl.constexpr,
+                      axis: tl.constexpr):
+        x = tl.load(X + tl.arange(0, M)[:, None] * N + tl.arange(0, N)[None, :])
+        offs_i = tl.arange(0, IM)[:, None] * IN + tl.arange(0, IN)[None, :]
+        z = tl.gather(x, tl.load(I + offs_i), axis)
+        tl.store(Z + offs_i, z)
+
+    x = torch.from_numpy(numpy_random((M, N), dtype_str=dtype_str)).to(device)
+    shape = (M, K) if axis == 1 else (K, N)
+    idx = torch.randint(0, x.shape[axis], shape, dtype=torch.int64, device=device)
+    z = torch.empty(shape, dtype=x.dtype, device=device)
+    gather_kernel[(1, )](x, idx, z, M, N, shape[0], shape[1], axis)
+    assert (z == torch.gather(x, axis, idx)).all()
+
+
+@pytest.mark.parametrize("op", ['sum', 'max', 'min'])
+@pytest.mark.parametrize("dtype_str", ['float32', 'int32'])
+@pytest.mark.parametrize("cluster_size", [1, 2, 4])
+def test_cluster_reduce(op, dtype_str, cluster_size, device):
+    if not is_cuda() or torch.cuda.get_device_capability()[0] < 9:
+        pytest.skip("cluster_reduce requires clusters of CTAs")
+
+    @triton.jit
+    def kernel(X, Z, OP: tl.constexpr, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = tl.arange(0, BLOCK)
+        x = tl.load(X + pid * BLOCK + offs)
+        z = tl.cluster_reduce(x, OP)
+        tl.store(Z + pid * BLOCK + offs, z)
+
+    BLOCK, num_clusters = 256, 3
+    x = numpy_random((num_clusters, cluster_size, BLOCK), dtype_str=dtype_str)
+    x_tri = to_triton(x, device=device)
+    z_tri = torch.empty_like(x_tri)
+    kernel[(num_clusters * cluster_size, )](x_tri, z_tri, OP=op, BLOCK=BLOCK, cluster_dims=(cluster_size, 1, 1))
+    z_ref = getattr(np, op)(x, axis=1, keepdims=True).repeat(cluster_size, axis=1)
+    np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-5)
+
+
+def test_grid_sync(device):
+    # normalizes a vector split across the programs, which exchange their partial statistics through global memory
+    @triton.jit
+    def kernel(X, Z, Partials, Barrier, BLOCK: tl.constexpr, NUM_PARTIALS: tl.constexpr):
+        pid = tl.program_id(0)
+        num_programs = tl.num_programs(0)
+        n = num_programs * BLOCK
+        x = tl.load(X + pid * BLOCK + tl.arange(0, BLOCK))
+        offs = tl.arange(0, NUM_PARTIALS)
+        mask = offs < num_programs
+        tl.store(Partials + pid, tl.sum(x, axis=0))
+        tl.grid_sync(Barrier)
+        mean = tl.sum(tl.load(Partials + offs, mask=mask, other=0.), axis=0) / n
+        # the counter is reused, and the partials are only overwritten once every program has read them
+        tl.grid_sync(Barrier)
+        tl.store(Partials + pid, tl.sum((x - mean) * (x - mean), axis=0))
+        tl.grid_sync(Barrier)
+        var = tl.sum(tl.load(Partials + offs, mask=mask, other=0.), axis=0) / n
+        tl.store(Z + pid * BLOCK + tl.arange(0, BLOCK), (x - mean) / tl.sqrt(var + 1e-5))
+
+    BLOCK = 512
+    num_programs = triton.runtime.driver.active.utils.get_device_properties(
+        triton.runtime.driver.active.get_current_device())["multiprocessor_count"]
+    x = torch.randn(num_programs * BLOCK, device=device)
+    z = torch.empty_like(x)
+    partials = torch.empty(num_programs, device=device)
+    barrier = torch.zeros(1, dtype=torch.int32, device=device)
+    compiled = kernel[(num_programs, )](x, z, partials, barrier, BLOCK=BLOCK,
+                                        NUM_PARTIALS=triton.next_power_of_2(num_programs))
+    assert compiled.metadata.cooperative
+    assert barrier.item() == 3 * num_programs
+    z_ref = (x - x.mean()) / torch.sqrt(x.var(unbiased=False) + 1e-5)
+    torch.testing.assert_close(z, z_ref, atol=1e-4, rtol=1e-4)
+
+
+@pytest.mark.parametrize("op", ["set", "add"])
+def test_signal_wait(op, device):
+
+    @triton.jit
+    def kernel(X, Buf, Flag, Z, BLOCK: tl.constexpr, OP: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        if tl.program_id(0) == 0:
+            tl.store(Buf + offs, tl.load(X + offs) * 2)
+            tl.signal(Flag, 1, op=OP, scope="gpu")
+        else:
+            tl.signal_wait(Flag, 1, cmp="eq", scope="gpu")
+            tl.store(Z + offs, tl.load(Buf + offs))
+
+    BLOCK = 256
+    x = torch.randn(BLOCK, device=device)
+    buf = torch.zeros_like(x)
+    z = torch.empty_like(x)
+    flag = torch.zeros(1, dtype=torch.int32, device=device)
+    kernel[(2, )](x, buf, flag, z, BLOCK=BLOCK, OP=op)
+    torch.testing.assert_close(z, x * 2)
+
+
+@pytest.mark.skipif(torch.cuda.device_count() < 2, reason="needs two devices")
+def test_peer_all_reduce(device):
+    # every device stores its tensor into the memory of the other, signals it and adds the tensor it received
+    @triton.jit
+    def kernel(X, PeerRecv, PeerFlag, Recv, Flag, Z, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offs)
+        tl.store(PeerRecv + offs, x)
+        tl.signal(PeerFlag + tl.program_id(0), 1)
+        tl.signal_wait(Flag + tl.program_id(0), 1)
+        tl.store(Z + offs, x + tl.load(Recv + offs))
+
+    BLOCK, num_programs = 1024, 8
+    xs, recvs, flags, zs = [], [], [], []
+    for d in range(2):
+        xs.append(torch.randn(BLOCK * num_programs, device=f"cuda:{d}"))
+        recvs.append(torch.empty_like(xs[d]))
+        flags.append(torch.zeros(num_programs, dtype=torch.int32, device=f"cuda:{d}"))
+        zs.append(torch.empty_like(xs[d]))
+    for d in range(2):
+        with torch.cuda.device(d):
+            triton.runtime.driver.active.utils.enable_peer_access(1 - d)
+    # the kernels wait for each other, so they are both launched before synchronizing
+    for d in range(2):
+        with torch.cuda.device(d):
+            kernel[(num_programs, )](xs[d], recvs[1 - d], flags[1 - d], recvs[d], flags[d], zs[d], BLOCK=BLOCK)
+    for d in range(2):
+        torch.testing.assert_close(zs[d], xs[0].to(zs[d].device) + xs[1].to(zs[d].device))
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("op", ['sum', 'max', 'min'])
 @pytest.mark.parametrize("BLOCK_N", [32, 64, 128])
@@ -3262,6 +3556,181 @@ def test_dot(M, N, K, num_warps, col_a, col_b, epilogue, input_precision, in_dty
             assert 'wgmma.mma_async.sync.aligned.m64n128k32.f32.e4m3.e4m3' in ptx
 
 
+@pytest.mark.parametrize("input_precision", ["bf16x3", "bf16x6", "bf16x9"])
+def test_dot_bf16_split(input_precision, device):
+    if is_interpreter():
+        pytest.skip("the interpreter computes f32 dots in ieee")
+    if is_cuda() and torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("bf16 dots need sm >= 80")
+
+    @triton.jit
+    def kernel(X, Y, Z, BLOCK: tl.constexpr, INPUT_PRECISION: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        x = tl.load(X + offs[:, None] * BLOCK + offs[None, :])
+        y = tl.load(Y + offs[:, None] * BLOCK + offs[None, :])
+        z = tl.dot(x, y, input_precision=INPUT_PRECISION)
+        tl.store(Z + offs[:, None] * BLOCK + offs[None, :], z)
+
+    BLOCK = 64
+    torch.manual_seed(0)
+    x = torch.randn((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    y = torch.randn((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    z = torch.empty_like(x)
+    pgm = kernel[(1, )](x, y, z, BLOCK, input_precision)
+    ref = torch.matmul(x.double(), y.double())
+    # the largest dropped terms are of about 2^-16 of the products for bf16x3,
+    # and 2^-24 for bf16x6 and bf16x9
+    atol = {"bf16x3": 1e-3, "bf16x6": 1e-4, "bf16x9": 1e-4}[input_precision]
+    torch.testing.assert_close(z.double(), ref, atol=atol, rtol=0)
+    num_dots = int(input_precision[-1])
+    assert len(re.findall(r"(tt\.dot|warp_group_dot) ", pgm.asm["ttgir"])) == num_dots
+
+
+def test_dot_amax_epilogue(device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttgir")
+    if is_cuda() and torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("reductions over mma layouts need sm >= 80")
+
+    @triton.jit
+    def kernel(X, Y, Z, Amax, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        pid = tl.program_id(0)
+        x = tl.load(X + (pid * BLOCK + offs[:, None]) * BLOCK + offs[None, :])
+        y = tl.load(Y + offs[:, None] * BLOCK + offs[None, :])
+        z = tl.dot(x, y)
+        tl.store(Z + (pid * BLOCK + offs[:, None]) * BLOCK + offs[None, :], z)
+        # the amax of the whole output, over the programs
+        tl.atomic_max(Amax, tl.max(tl.abs(z)))
+
+    BLOCK = 64
+    torch.manual_seed(0)
+    x = torch.randn((4 * BLOCK, BLOCK), device=device, dtype=torch.float16)
+    y = torch.randn((BLOCK, BLOCK), device=device, dtype=torch.float16)
+    z = torch.empty((4 * BLOCK, BLOCK), device=device, dtype=torch.float32)
+    amax = torch.zeros((1, ), device=device, dtype=torch.float32)
+    pgm = kernel[(4, )](x, y, z, amax, BLOCK)
+    torch.testing.assert_close(amax[0], z.abs().max())
+    # the accumulator is reduced in its mma layout, without the 1D reshape
+    ttgir = pgm.asm["ttgir"]
+    assert "tt.reshape" not in ttgir
+    assert re.search(r"\(tensor<64x64xf32, #mma\d*>\) -> tensor<64xf32, #triton_gpu.slice", ttgir)
+
+
+@pytest.mark.parametrize("lhs_format", ["e2m1", "e4m3", "e5m2"])
+def test_scaled_dot(lhs_format, device):
+    if is_interpreter():
+        pytest.skip("scaled dots aren't supported by the interpreter")
+    if is_cuda() and torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("bf16 dots need sm >= 80")
+
+    M, N, K = 64, 64, 128
+    PACKING = 2 if lhs_format == "e2m1" else 1
+
+    @triton.jit
+    def kernel(X, XScale, Y, Z, FORMAT: tl.constexpr, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr,
+               PACKING: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        offs_k = tl.arange(0, K)
+        offs_xk = tl.arange(0, K // PACKING)
+        x = tl.load(X + offs_m[:, None] * (K // PACKING) + offs_xk[None, :])
+        x_scale = tl.load(XScale + offs_m[:, None] * (K // 32) + tl.arange(0, K // 32)[None, :])
+        y = tl.load(Y + offs_k[:, None] * N + offs_n[None, :])
+        z = tl.dot_scaled(x, x_scale, FORMAT, y, None, "bf16")
+        tl.store(Z + offs_m[:, None] * N + offs_n[None, :], z)
+
+    torch.manual_seed(0)
+    x_bits = torch.randint(0, 256, (M, K // PACKING), device=device, dtype=torch.uint8)
+    if lhs_format == "e2m1":
+        e2m1 = torch.tensor([0, 0.5, 1, 1.5, 2, 3, 4, 6], device=device)
+        e2m1 = torch.cat([e2m1, -e2m1])
+        nibbles = torch.stack([x_bits & 0xf, x_bits >> 4], dim=-1).reshape(M, K).long()
+        x_ref = e2m1[nibbles]
+        x = x_bits
+    else:
+        dtype = torch.float8_e4m3fn if lhs_format == "e4m3" else torch.float8_e5m2
+        # the NaNs and infinities are covered by the lit tests
+        x_bits = torch.where((x_bits & 0x7f) >= 0x78, x_bits & 0x80, x_bits)
+        x = x_bits.view(dtype)
+        x_ref = x.float()
+    x_scale = torch.randint(120, 134, (M, K // 32), device=device, dtype=torch.uint8)
+    x_ref = x_ref * torch.exp2(x_scale.float() - 127).repeat_interleave(32, dim=1)
+    y = torch.randn((K, N), device=device, dtype=torch.bfloat16)
+    z = torch.empty((M, N), device=device, dtype=torch.float32)
+    kernel[(1, )](x, x_scale, y, z, lhs_format, M, N, K, PACKING)
+    # the scaled operand is exact in bf16, so only the accumulation differs
+    ref = torch.matmul(x_ref.double(), y.double())
+    torch.testing.assert_close(z.double(), ref, atol=1e-2, rtol=1e-3)
+
+
+@pytest.mark.parametrize("M, N, K, in_dtype", [(1, 128, 256, "float16"), (4, 64, 128, "float32"), (8, 64, 128, "int8"),
+                                               (64, 1, 128, "float16"), (2, 4, 64, "bfloat16")])
+def test_dot_gemv(M, N, K, in_dtype, device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttgir")
+
+    @triton.jit
+    def kernel(X, Y, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr, OUT_DTYPE: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        offs_k = tl.arange(0, K)
+        x = tl.load(X + offs_m[:, None] * K + offs_k[None, :])
+        y = tl.load(Y + offs_k[:, None] * N + offs_n[None, :])
+        z = tl.dot(x, y, out_dtype=OUT_DTYPE)
+        tl.store(Z + offs_m[:, None] * N + offs_n[None, :], z)
+
+    torch.manual_seed(0)
+    if in_dtype == "int8":
+        x = torch.randint(-128, 128, (M, K), device=device, dtype=torch.int8)
+        y = torch.randint(-128, 128, (K, N), device=device, dtype=torch.int8)
+        z = torch.empty((M, N), device=device, dtype=torch.int32)
+        out_dtype = tl.int32
+    else:
+        x = torch.randn((M, K), device=device, dtype=getattr(torch, in_dtype))
+        y = torch.randn((K, N), device=device, dtype=getattr(torch, in_dtype))
+        z = torch.empty((M, N), device=device, dtype=torch.float32)
+        out_dtype = tl.float32
+    pgm = kernel[(1, )](x, y, z, M, N, K, out_dtype)
+    ref = torch.matmul(x.double(), y.double())
+    if in_dtype == "int8":
+        torch.testing.assert_close(z.double(), ref, atol=0, rtol=0)
+    else:
+        torch.testing.assert_close(z.double(), ref, atol=1e-3, rtol=1e-4)
+    # the skinny dot is split along K, without any MMA
+    ttgir = pgm.asm["ttgir"]
+    assert "tt.dot" not in ttgir and "mma" not in ttgir
+    assert "tt.reduce" in ttgir
+
+
+def test_dot_fp16_acc_loop(device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttgir")
+
+    @triton.jit
+    def kernel(X, Y, Z, K, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        acc = tl.zeros((BLOCK, BLOCK), dtype=tl.float32)
+        for k in range(0, K, BLOCK):
+            x = tl.load(X + offs[:, None] * K + k + offs[None, :])
+            y = tl.load(Y + (k + offs[:, None]) * BLOCK + offs[None, :])
+            acc = tl.dot(x, y, acc, out_dtype=tl.float16)
+        tl.store(Z + offs[:, None] * BLOCK + offs[None, :], acc)
+
+    BLOCK, K = 64, 256
+    torch.manual_seed(0)
+    x = torch.randn((BLOCK, K), device=device, dtype=torch.float16) / 4
+    y = torch.randn((K, BLOCK), device=device, dtype=torch.float16) / 4
+    z = torch.empty((BLOCK, BLOCK), device=device, dtype=torch.float32)
+    pgm = kernel[(1, )](x, y, z, K, BLOCK)
+    ref = torch.matmul(x.float(), y.float())
+    torch.testing.assert_close(z, ref, atol=1e-2, rtol=1e-2)
+    # the accumulator is carried by the loop in fp16
+    ttgir = pgm.asm["ttgir"]
+    assert "arith.truncf" not in ttgir
+    assert re.search(r"(tt\.dot|warp_group_dot) .* -> tensor<64x64xf16", ttgir)
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("B", [1, 2, 4, 8])
 @pytest.mark.parametrize("num_warps", [1, 2, 4, 8, 16])
@@ -3414,6 +3883,44 @@ def test_max_num_imprecise_acc(device):
     assert h.asm["ptx"].count("add.f32") == (M * N) // (32 * num_warps) * (K / MAX_NUM_IMPRECISE_ACC)
 
 
+@pytest.mark.parametrize("M, N, K", [(64, 64, 64), (128, 64, 128)])
+@pytest.mark.parametrize("in_dtype", ["float16", "bfloat16"])
+def test_sparse_dot(M, N, K, in_dtype, device):
+    if not is_cuda() or torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("sparse dots need the sparse tensor cores of sm_80")
+
+    @triton.jit
+    def kernel(A, AMeta, B, C, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr):
+        off_m = tl.arange(0, M)
+        off_n = tl.arange(0, N)
+        off_k = tl.arange(0, K)
+        off_ak = tl.arange(0, K // 2)
+        off_meta = tl.arange(0, K // 16)
+        a = tl.load(A + off_m[:, None] * (K // 2) + off_ak[None, :])
+        a_meta = tl.load(AMeta + off_m[:, None] * (K // 16) + off_meta[None, :])
+        b = tl.load(B + off_k[:, None] * N + off_n[None, :])
+        c = tl.sparse_dot(a, a_meta, b)
+        tl.store(C + off_m[:, None] * N + off_n[None, :], c)
+
+    torch.manual_seed(0)
+    dtype = getattr(torch, in_dtype)
+    # the two columns kept in each group of four
+    pairs = torch.tensor([[0, 1], [0, 2], [0, 3], [1, 2], [1, 3], [2, 3]], device=device)
+    idx = pairs[torch.randint(0, len(pairs), (M, K // 4), device=device)]
+    a_compressed = torch.randn((M, K // 2), device=device).to(dtype)
+    a = torch.zeros((M, K // 4, 4), dtype=dtype, device=device)
+    a.scatter_(2, idx, a_compressed.view(M, K // 4, 2))
+    a = a.view(M, K)
+    # 4 bits per group, the first group of 16 columns in the low bits
+    nibbles = (idx[..., 0] | (idx[..., 1] << 2)).view(M, K // 16, 4)
+    meta = (nibbles << torch.tensor([0, 4, 8, 12], device=device)).sum(-1)
+    meta = torch.where(meta >= 1 << 15, meta - (1 << 16), meta).to(torch.int16)
+    b = torch.randn((K, N), device=device).to(dtype)
+    c = torch.empty((M, N), dtype=torch.float32, device=device)
+    kernel[(1, )](a_compressed, meta, b, c, M, N, K)
+    torch.testing.assert_close(c, torch.matmul(a.float(), b.float()), rtol=1e-2, atol=1e-2)
+
+
 @pytest.mark.parametrize('in_dtype', ['float32'])
 def test_dot_mulbroadcasted(in_dtype, device):
     if is_cuda():
@@ -3605,6 +4112,53 @@ def test_dot_without_load(dtype_str, device):
     assert torch.all(out == out_ref)
 
 
+@pytest.mark.parametrize("fp8_operand", [0, 1])
+@pytest.mark.parametrize("dtype_str", ['float16', 'bfloat16'])
+def test_dot_mixed_fp8(fp8_operand, dtype_str, device):
+    if not is_hip():
+        pytest.skip("fp8 operands can only be mixed with 16-bit operands on HIP")
+
+    M, N, K = 64, 64, 64
+
+    @triton.jit
+    def kernel(x_ptr, y_ptr, x_up_ptr, out_ptr, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr,
+               FP8_OPERAND: tl.constexpr):
+        offs_m = tl.arange(0, M)
+        offs_n = tl.arange(0, N)
+        offs_k = tl.arange(0, K)
+        if FP8_OPERAND == 0:
+            x_offs = offs_m[:, None] * K + offs_k[None, :]
+            y_offs = offs_k[:, None] * N + offs_n[None, :]
+        else:
+            x_offs = offs_k[:, None] * N + offs_n[None, :]
+            y_offs = offs_m[:, None] * K + offs_k[None, :]
+        x = tl.load(x_ptr + x_offs)
+        y = tl.load(y_ptr + y_offs)
+        tl.store(x_up_ptr + x_offs, x.to(y.dtype))
+        if FP8_OPERAND == 0:
+            c = tl.dot(x, y)
+        else:
+            c = tl.dot(y, x)
+        tl.store(out_ptr + offs_m[:, None] * N + offs_n[None, :], c)
+
+    dtype = getattr(torch, dtype_str)
+    x_shape, y_shape = ((M, K), (K, N)) if fp8_operand == 0 else ((K, N), (M, K))
+    # Draw nonzero fp8 magnitudes below 16 with a random sign; 0x80 is NaN.
+    x_bits = torch.randint(1, 0x60, x_shape, dtype=torch.uint8, device=device)
+    x_bits |= torch.randint(0, 2, x_shape, dtype=torch.uint8, device=device) << 7
+    x = reinterpret(x_bits, tl.float8e4b8)
+    y = torch.randn(y_shape, dtype=dtype, device=device)
+    x_up = torch.empty(x_shape, dtype=dtype, device=device)
+    out = torch.empty((M, N), dtype=torch.float32, device=device)
+    kernel[(1, )](x, y, x_up, out, M, N, K, fp8_operand)
+
+    if fp8_operand == 0:
+        out_ref = torch.matmul(x_up.float(), y.float())
+    else:
+        out_ref = torch.matmul(y.float(), x_up.float())
+    torch.testing.assert_close(out, out_ref, atol=1e-2, rtol=1e-2)
+
+
 # ---------------
 # test arange
 # ---------------
@@ -3825,6 +4379,94 @@ def test_vectorization_hints(has_hints, device):
         assert "ld.global.v4.b32" not in ptx
 
 
+@pytest.mark.parametrize("has_hint", [False, True])
+def test_max_size_hint(has_hint, device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttir")
+    M, N = 32, 64
+
+    def kernel(dst, src, stride, N: tl.constexpr):
+        row = tl.program_id(0).to(tl.int64)
+        offsets = row * stride + tl.arange(0, N)
+        tl.store(dst + offsets, tl.load(src + offsets))
+
+    kernel = triton.jit(max_size={"dst": M * N, "src": M * N} if has_hint else None)(kernel)
+    src = torch.randn((M, N), device=device)
+    dst = torch.empty_like(src)
+    pgm = kernel[(M, )](dst, src, src.stride(0), N)
+    torch.testing.assert_close(dst, src)
+    # the offsets of the rows are computed in 32 bits with the hint
+    ttir = pgm.asm["ttir"]
+    assert ("tensor<64xi64>" not in ttir) == has_hint
+
+
+def test_value_range(device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttir")
+    BLOCK = 128
+
+    @triton.jit(value_range={"n": (BLOCK, 2**20)})
+    def kernel(dst, src, n, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        # true for every n in the range
+        mask = offsets < n
+        tl.store(dst + offsets, tl.load(src + offsets, mask=mask), mask=mask)
+
+    src = torch.randn(BLOCK, device=device)
+    dst = torch.empty_like(src)
+    pgm = kernel[(1, )](dst, src, 4 * BLOCK, BLOCK)
+    torch.testing.assert_close(dst, src)
+    assert f"tt.range = dense<[{BLOCK}, {2**20}]> : tensor<2xi64>" in pgm.asm["ttir"]
+
+
+@pytest.mark.parametrize("dtype_str", ["int1", "float32"])
+def test_load_num_stages(dtype_str, device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttir")
+    BLOCK = 128
+
+    @triton.jit
+    def kernel(dst, src, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(dst + offsets, tl.load(src + offsets, num_stages=1))
+
+    src = numpy_random(BLOCK, dtype_str=dtype_str)
+    src_tri = to_triton(src, device=device)
+    dst_tri = to_triton(np.zeros_like(src), device=device)
+    pgm = kernel[(1, )](dst_tri, src_tri, BLOCK)
+    np.testing.assert_equal(to_numpy(dst_tri), src)
+    loads = [line for line in pgm.asm["ttir"].splitlines() if "tt.load" in line]
+    assert len(loads) == 1 and "tt.num_stages = 1" in loads[0]
+
+
+@pytest.mark.parametrize("divisor", [1, 3, 7, 64, 1000, 2**31 - 1])
+def test_magic_divisor(divisor, device):
+    if is_interpreter():
+        pytest.skip("the interpreter doesn't lower to ttir")
+    N = 4096
+
+    @triton.jit(specialize={"d": "divisor"})
+    def kernel(q_ptr, r_ptr, offset, d):
+        pid = tl.program_id(0)
+        # a dividend of unknown sign and a non-negative one
+        tl.store(q_ptr + pid, (pid + offset) // d)
+        tl.store(r_ptr + pid, pid % d)
+
+    offset = -N // 2
+    q = torch.empty(N, dtype=torch.int32, device=device)
+    r = torch.empty(N, dtype=torch.int32, device=device)
+    pgm = kernel[(N, )](q, r, offset, divisor)
+    pid = torch.arange(N, dtype=torch.int64, device=device)
+    torch.testing.assert_close(q, torch.div(pid + offset, divisor, rounding_mode="trunc").to(torch.int32))
+    torch.testing.assert_close(r, (pid % divisor).to(torch.int32))
+    if divisor != 1:
+        ttir = pgm.asm["ttir"]
+        assert "tt.magic_divui" in ttir and "tt.magic_remui" in ttir
+        assert "arith.divsi" not in ttir and "arith.remsi" not in ttir
+        with pytest.raises(ValueError, match="must be positive"):
+            kernel[(N, )](q, r, offset, -divisor)
+
+
 # ---------------
 # test store
 # ---------------
@@ -4543,6 +5185,37 @@ def test_if_else(device):
     assert to_numpy(out)[0] == false_val[0]
 
 
+@pytest.mark.interpreter
+def test_if_unlikely(device):
+
+    @triton.jit
+    def kernel(X, Out, Last, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = pid * BLOCK + tl.arange(0, BLOCK)
+        x = tl.load(X + offs)
+        if tl.unlikely(pid == tl.load(Last)):
+            for i in range(4):
+                x = tl.sqrt(tl.abs(x) + 1.0) * 2.0 - tl.exp(-x * x)
+            x = tl.where(x > 1.0, x, -x) + tl.max(x, axis=0)
+        tl.store(Out + offs, x)
+
+    BLOCK = 128
+    x = np.random.rand(2 * BLOCK).astype(np.float32)
+    ref = x.copy()
+    for _ in range(4):
+        ref[BLOCK:] = np.sqrt(np.abs(ref[BLOCK:]) + 1.0) * 2.0 - np.exp(-ref[BLOCK:] * ref[BLOCK:])
+    ref[BLOCK:] = np.where(ref[BLOCK:] > 1.0, ref[BLOCK:], -ref[BLOCK:]) + ref[BLOCK:].max()
+    x_tri = to_triton(x, device=device)
+    out = to_triton(np.zeros_like(x), device=device)
+    last = to_triton(np.array([1], dtype=np.int32), device=device)
+    h = kernel[(2, )](x_tri, out, last, BLOCK=BLOCK)
+    np.testing.assert_allclose(to_numpy(out), ref, rtol=1e-5)
+    if is_cuda():
+        # the branch is outlined into a noinline function
+        assert "tt.unlikely" in h.asm["ttir"]
+        assert ".func" in h.asm["ptx"]
+
+
 @pytest.mark.interpreter
 @pytest.mark.parametrize("mode", ["dynamic", "static"])
 def test_if_return(mode, device):
@@ -5459,3 +6132,46 @@ def test_num_programs(device):
 
     kernel[grid](input)
     assert torch.all(input == torch.tensor(grid, device=device))
+
+
+def test_forward_store_to_load_2d(device):
+
+    @triton.jit
+    def store_tile(C, offs, acc):
+        tl.store(C + offs, acc)
+
+    @triton.jit
+    def epilogue(C, offs, bias):
+        tl.store(C + offs, tl.maximum(tl.load(C + offs) + bias, 0))
+
+    @triton.jit
+    def kernel(X, C, bias, stride_m, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+        offs = tl.arange(0, BLOCK_M)[:, None] * stride_m + tl.arange(0, BLOCK_N)[None, :]
+        store_tile(C, offs, tl.load(X + offs) * 2)
+        epilogue(C, offs, bias)
+
+    BLOCK_M, BLOCK_N = 32, 64
+    for stride_m in [BLOCK_N, 2 * BLOCK_N]:
+        x = torch.randn((BLOCK_M, stride_m), device=device)
+        c = torch.zeros_like(x)
+        h = kernel[(1, )](x, c, 0.5, stride_m, BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N, forward_store_to_load=True)
+        # the rows don't overlap for strides of more than BLOCK_N - 1 elements, which is checked at runtime
+        assert "scf.if" in h.asm["ttir"]
+        torch.testing.assert_close(c[:, :BLOCK_N], torch.relu(x[:, :BLOCK_N] * 2 + 0.5))
+
+
+@pytest.mark.skipif(not is_cuda(), reason="recorded asserts are only reported by the CUDA launcher")
+def test_record_asserts(capfd, device):
+
+    @triton.jit
+    def kernel(X, BLOCK: tl.constexpr):
+        x = tl.load(X + tl.program_id(0) * BLOCK + tl.arange(0, BLOCK))
+        tl.device_assert(x == 0, "x != 0")
+
+    BLOCK = 128
+    x = torch.zeros(2 * BLOCK, dtype=torch.int32, device=device)
+    x[BLOCK + 5] = 1
+    kernel[(2, )](x, BLOCK=BLOCK, record_asserts=True)
+    torch.cuda.synchronize()
+    _, err = capfd.readouterr()
+    assert "Assertion `x != 0` failed on program (1, 0, 0) at element 5" in err
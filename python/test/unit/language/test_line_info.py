@@ -169,3 +169,20 @@ def test_line_info(func: str):
     elif func == "dot_combine":
         assert (check_file_lines(file_lines, "test_line_info.py", 65))
         assert (check_file_lines(file_lines, "test_line_info.py", 66, should_contain=False))
+
+
+def test_line_tables_only(monkeypatch):
+    try:
+        obj_kind, command, anchor, separator = get_disassembler_command_and_debug_line_format()
+    except BaseException:
+        pytest.skip("disassembler is not available")
+
+    monkeypatch.setenv("TRITON_LINE_TABLES_ONLY", "1")
+    kernel_call.cache[torch.cuda.current_device()].clear()
+    kernel_info = kernel_call.warmup(torch.float32, torch.float32, BLOCK=128, grid=(1, ))
+    kernel_call.cache[torch.cuda.current_device()].clear()
+    file_lines = extract_file_lines(command, anchor, separator, kernel_info.asm[obj_kind])
+    # the addition inlined from device_inline takes the line of its call
+    assert (check_file_lines(file_lines, "test_line_info.py", 28))
+    assert (check_file_lines(file_lines, "test_line_info.py", 29))
+    assert (check_file_lines(file_lines, "test_line_info.py", 21, should_contain=False))
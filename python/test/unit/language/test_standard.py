@@ -28,7 +28,7 @@ def test_maximum_minium(dtype, op, device):
 @pytest.mark.interpreter
 @pytest.mark.parametrize("M, N", [[1, 512], [8, 64], [256, 16], [512, 8]])
 @pytest.mark.parametrize("descending", [False, True])
-@pytest.mark.parametrize("dtype_str", ['int32', 'float16', 'float32', 'bfloat16'])
+@pytest.mark.parametrize("dtype_str", ['int32', 'uint8', 'float16', 'float32', 'bfloat16'])
 def test_sort(M, N, descending, dtype_str, device):
 
     @triton.jit
@@ -48,6 +48,30 @@ def test_sort(M, N, descending, dtype_str, device):
     assert (y == z).all(), (y, z)
 
 
+@pytest.mark.interpreter
+@pytest.mark.parametrize("M, N, K", [[1, 512, 8], [8, 64, 4], [128, 16, 16], [4, 256, 1]])
+@pytest.mark.parametrize("dtype_str", ['int32', 'float16', 'float32'])
+def test_topk(M, N, K, dtype_str, device):
+
+    @triton.jit
+    def topk_kernel(X, Z, I, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr):
+        offs_m = tl.arange(0, M)[:, None]
+        x = tl.load(X + offs_m * N + tl.arange(0, N)[None, :])
+        z, idx = tl.topk(x, K, return_indices=True)
+        offs_k = offs_m * K + tl.arange(0, K)[None, :]
+        tl.store(Z + offs_k, z)
+        tl.store(I + offs_k, idx)
+
+    x = numpy_random((M, N), dtype_str=dtype_str)
+    x = torch.from_numpy(x).to(device)
+    z = torch.empty((M, K), dtype=x.dtype, device=device)
+    idx = torch.empty((M, K), dtype=torch.int32, device=device)
+    topk_kernel[(1, )](x, z, idx, M, N, K, num_warps=4)
+    assert (z == torch.topk(x, K, dim=-1)[0]).all(), z
+    # Equal elements may come in any order, so only check what the indices point to
+    assert (torch.gather(x, 1, idx.long()) == z).all()
+
+
 # ---------------
 # test flip op
 # ---------------
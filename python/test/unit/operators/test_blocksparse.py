@@ -235,3 +235,66 @@ def triton_attention(
     w = sparse_softmax(w, scale=scale, is_causal=True)
     a = sparse_dot_dsd_nn(w, value)
     return a
+
+
+@pytest.mark.parametrize("MODE", ["sdd", "dsd"])
+@pytest.mark.parametrize("BLOCK", [32, 64])
+@pytest.mark.parametrize("K", [96, 200])
+def test_matmul_uneven_k(MODE, BLOCK, K, device, Z=2, H=2, M=256, N=256):
+    # The reduction of the sparse blocks doesn't need to be a multiple of the
+    # tile of K in sdd, and spans several blocks of various positions in dsd.
+    torch.manual_seed(0)
+    if MODE == "dsd":
+        K = BLOCK * (K // BLOCK)
+    shape = (M, N) if MODE == "sdd" else (M, K)
+    layout = torch.randint(2, (H, shape[0] // BLOCK, shape[1] // BLOCK))
+    a = torch.randn((Z, H, M, K), dtype=torch.float16, device=device) * .1
+    b = torch.randn((Z, H, K, N), dtype=torch.float16, device=device) * .1
+    if MODE == "dsd":
+        a = mask_tensor(a, layout, BLOCK)
+    c_ref = torch.matmul(a, b)
+    if MODE == "sdd":
+        c_ref = sparsify_tensor(c_ref, layout, BLOCK)
+    else:
+        a = sparsify_tensor(a, layout, BLOCK)
+    op = triton.ops.blocksparse.matmul(layout, BLOCK, MODE, device=device)
+    c_tri = op(a, b)
+    torch.testing.assert_close(c_ref, c_tri, atol=1e-2, rtol=0)
+
+
+# compare the block-sparse matmul with the dense one, which computes the masked
+# blocks too, for fractions of zero blocks
+bench_configs = [
+    triton.testing.Benchmark(x_names=['sparsity'], x_vals=[0., .5, .75, .875, .9375], line_arg='provider',
+                             line_vals=['triton', 'torch'], line_names=['Triton block-sparse', 'Torch dense'],
+                             styles=[('red', '-'), ('blue', '-')], ylabel='TFLOPS',
+                             plot_name=f'blocksparse-matmul-{mode}-block{block}', args={
+                                 'Z': 4,
+                                 'H': 8,
+                                 'M': 2048,
+                                 'N': 2048,
+                                 'K': 2048,
+                                 'block': block,
+                                 'mode': mode,
+                             }) for mode in ['sdd', 'dsd'] for block in [32, 64]
+]
+
+
+@triton.testing.perf_report(bench_configs)
+def bench_matmul(Z, H, M, N, K, block, mode, sparsity, provider, dtype=torch.float16, device="cuda"):
+    torch.manual_seed(0)
+    a = torch.randn((Z, H, M, K), dtype=dtype, device=device)
+    b = torch.randn((Z, H, K, N), dtype=dtype, device=device)
+    shape = (M, N) if mode == "sdd" else (M, K)
+    layout = (torch.rand((H, shape[0] // block, shape[1] // block)) >= sparsity).long()
+    # flops of the non-zero blocks, so that both providers compute the same work
+    flops = 2 * Z * block * block * layout.sum().item() * (K if mode == "sdd" else N)
+    if provider == "triton":
+        op = triton.ops.blocksparse.matmul(layout, block, mode, device=device)
+        if mode == "dsd":
+            a = sparsify_tensor(a, layout, block)
+        fn = lambda: op(a, b)
+    else:
+        fn = lambda: torch.matmul(a, b)
+    ms = triton.testing.do_bench(fn)
+    return flops / ms * 1e-9
@@ -0,0 +1,40 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+@pytest.mark.parametrize("shapes", [
+    [(128, 128, 128)],
+    [(1, 64, 32), (300, 256, 96), (77, 30, 40)],
+    # a group without rows
+    [(0, 128, 64), (256, 128, 64)],
+])
+@pytest.mark.parametrize("dtype", [torch.float16, torch.bfloat16])
+def test_grouped_matmul(shapes, dtype, device):
+    torch.manual_seed(0)
+    group_a = [torch.randn((M, K), device=device, dtype=dtype) for M, N, K in shapes]
+    group_b = [torch.randn((K, N), device=device, dtype=dtype) for M, N, K in shapes]
+    group_c = triton.ops.grouped_matmul(group_a, group_b)
+    for a, b, c in zip(group_a, group_b, group_c):
+        torch.testing.assert_close(c, (a.float() @ b.float()).to(dtype), atol=5e-2, rtol=1e-2)
+
+
+@pytest.mark.parametrize("num_experts, K, N", [(8, 128, 256), (5, 96, 72)])
+@pytest.mark.parametrize("skew", [False, True])
+def test_expert_matmul(num_experts, K, N, skew, device):
+    torch.manual_seed(0)
+    T = 1000
+    # with skew the router sends most of the rows to the first expert and none to some others
+    weights = torch.tensor([50.0 if e == 0 else float(e % 2) for e in range(num_experts)]) if skew else None
+    experts = torch.multinomial(weights, T, replacement=True) if skew else torch.randint(0, num_experts, (T, ))
+    counts = torch.bincount(experts, minlength=num_experts)
+    expert_offsets = torch.cat([torch.zeros(1, dtype=torch.int64), counts.cumsum(0)]).to(torch.int32).to(device)
+    x = torch.randn((T, K), device=device, dtype=torch.float16)
+    w = torch.randn((num_experts, K, N), device=device, dtype=torch.float16)
+    out = triton.ops.expert_matmul(x, w, expert_offsets)
+    offsets = expert_offsets.tolist()
+    for e in range(num_experts):
+        rows = slice(offsets[e], offsets[e + 1])
+        torch.testing.assert_close(out[rows], (x[rows].float() @ w[e].float()).half(), atol=5e-2, rtol=1e-2)
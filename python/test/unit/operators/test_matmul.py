@@ -103,6 +103,11 @@ def is_hip():
             ("bfloat16", "float32"),
             ("float32", "bfloat16"),
         ] for AT in [False, True] for BT in [False, True]],
+        # split-k
+        *[[
+            (64, 64, 16, 4, 4, 2, 64, 64, 1024, AT, BT, DTYPE, DTYPE, None, True, None, None),
+            (32, 32, 32, 8, 2, 2, 77, 55, 1000, AT, BT, DTYPE, DTYPE, None, True, None, None),
+        ] for DTYPE in ["float16", "bfloat16", "float32"] for AT in [False, True] for BT in [False, True]],
         # acc-out-dtype and output_dtype
         *[[
             (32, 32, 32, 1, 1, 2, None, None, None, False, False, "float16", "float16", None, True, ACC_DTYPE,
@@ -121,13 +126,10 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
         pytest.skip("Only test bfloat16 on devices with sm >= 80")
     if capability[0] < 9 and capability[1] < 9 and (ADTYPE == "float8e4nv" or BDTYPE == "float8e4nv"):
         pytest.skip("Only test float8e4nv on devices with sm >= 89")
-    if (ADTYPE == "bfloat16" or BDTYPE == "bfloat16") and SPLIT_K != 1:
-        pytest.skip("bfloat16 matmuls don't allow split_k for now")
     torch.manual_seed(0)
     # nuke kernel decorators -- will set meta-parameters manually
     kwargs = {'BLOCK_M': BLOCK_M, 'BLOCK_N': BLOCK_N, 'BLOCK_K': BLOCK_K, 'SPLIT_K': SPLIT_K}
-    pre_hook = None if SPLIT_K == 1 else lambda nargs: nargs['C'].zero_()
-    configs = [triton.Config(kwargs=kwargs, num_warps=NWARP, num_stages=NSTAGE, pre_hook=pre_hook)]
+    configs = [triton.Config(kwargs=kwargs, num_warps=NWARP, num_stages=NSTAGE)]
     kernel = triton.ops._matmul.kernel
     kernel.configs = configs
     # kernel.run = kernel.run.run.run
@@ -199,3 +201,37 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
         torch.testing.assert_close(th_c, tt_c)
     except triton.OutOfResources as e:
         pytest.skip(str(e))
+
+
+@pytest.mark.parametrize("SPLIT_K", [2, 8])
+def test_split_k_deterministic(SPLIT_K, device):
+    kwargs = {'BLOCK_M': 32, 'BLOCK_N': 32, 'BLOCK_K': 32, 'SPLIT_K': SPLIT_K}
+    kernel = triton.ops._matmul.kernel
+    kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    torch.manual_seed(0)
+    a = torch.randn((64, 4096), device=device, dtype=torch.float16)
+    b = torch.randn((4096, 64), device=device, dtype=torch.float16)
+    ref = triton.ops.matmul(a, b)
+    for _ in range(10):
+        assert torch.equal(triton.ops.matmul(a, b), ref)
+
+
+def test_split_k_streams(device):
+    kwargs = {'BLOCK_M': 32, 'BLOCK_N': 32, 'BLOCK_K': 32, 'SPLIT_K': 4}
+    kernel = triton.ops._matmul.kernel
+    kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    torch.manual_seed(0)
+    inputs = [(torch.randn((64, 4096), device=device, dtype=torch.float16),
+               torch.randn((4096, 64), device=device, dtype=torch.float16)) for _ in range(2)]
+    refs = [triton.ops.matmul(a, b) for a, b in inputs]
+    # the matmuls of different streams run at the same time, each with its own workspace and counters
+    streams = [torch.cuda.Stream() for _ in inputs]
+    torch.cuda.synchronize()
+    for _ in range(10):
+        outs = []
+        for stream, (a, b) in zip(streams, inputs):
+            with torch.cuda.stream(stream):
+                outs.append(triton.ops.matmul(a, b))
+        torch.cuda.synchronize()
+        for out, ref in zip(outs, refs):
+            assert torch.equal(out, ref)
@@ -0,0 +1,151 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+def ref_attention(q, k, v, sm_scale, causal=True, window=0):
+    # q: (len_q, num_heads, head_dim), k and v: (len_k, num_kv_heads, head_dim)
+    group_size = q.shape[1] // k.shape[1]
+    k = k.repeat_interleave(group_size, dim=1).float()
+    v = v.repeat_interleave(group_size, dim=1).float()
+    scores = torch.einsum("qhd,khd->hqk", q.float(), k) * sm_scale
+    len_q, len_k = q.shape[0], k.shape[0]
+    rows = torch.arange(len_q, device=q.device)[:, None] + len_k - len_q
+    cols = torch.arange(len_k, device=q.device)[None, :]
+    visible = torch.ones((len_q, len_k), dtype=torch.bool, device=q.device)
+    if causal:
+        visible &= cols <= rows
+    if window > 0:
+        visible &= cols > rows - window
+    scores = scores.masked_fill(~visible, float("-inf"))
+    p = torch.softmax(scores, dim=-1).nan_to_num(0.0)
+    return torch.einsum("hqk,khd->qhd", p, v).to(q.dtype)
+
+
+@pytest.mark.parametrize("num_heads, num_kv_heads", [(8, 8), (8, 2)])
+@pytest.mark.parametrize("head_dim", [64, 128])
+@pytest.mark.parametrize("causal, window", [(False, 0), (True, 0), (True, 96)])
+@pytest.mark.parametrize("dtype", [torch.float16, torch.bfloat16])
+def test_varlen_attention(num_heads, num_kv_heads, head_dim, causal, window, dtype, device):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Attention kernels only supported for compute capability >= 80")
+    torch.manual_seed(20)
+    # some sequences extend a prefix of cached keys
+    q_lens = [1, 77, 128, 300]
+    k_lens = [1, 87, 128, 364]
+    cu_seqlens_q = torch.tensor([0] + q_lens, device=device).cumsum(0).to(torch.int32)
+    cu_seqlens_k = torch.tensor([0] + k_lens, device=device).cumsum(0).to(torch.int32)
+    q = torch.randn((sum(q_lens), num_heads, head_dim), dtype=dtype, device=device)
+    k = torch.randn((sum(k_lens), num_kv_heads, head_dim), dtype=dtype, device=device)
+    v = torch.randn((sum(k_lens), num_kv_heads, head_dim), dtype=dtype, device=device)
+    sm_scale = 0.3
+    tri_out = triton.ops.varlen_attention(q, k, v, cu_seqlens_q, cu_seqlens_k, max(q_lens), causal=causal,
+                                          window=window, sm_scale=sm_scale)
+    for i in range(len(q_lens)):
+        qs, qe = cu_seqlens_q[i], cu_seqlens_q[i + 1]
+        ks, ke = cu_seqlens_k[i], cu_seqlens_k[i + 1]
+        ref_out = ref_attention(q[qs:qe], k[ks:ke], v[ks:ke], sm_scale, causal, window)
+        atol = 5e-2 if dtype == torch.bfloat16 else 1e-2
+        torch.testing.assert_close(tri_out[qs:qe], ref_out, atol=atol, rtol=0)
+
+
+@pytest.mark.parametrize("num_heads, num_kv_heads", [(8, 8), (8, 1)])
+@pytest.mark.parametrize("page_size", [16, 64])
+@pytest.mark.parametrize("num_splits", [None, 1, 4])
+@pytest.mark.parametrize("window", [0, 128])
+def test_paged_attention(num_heads, num_kv_heads, page_size, num_splits, window, device):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Attention kernels only supported for compute capability >= 80")
+    torch.manual_seed(20)
+    dtype, head_dim = torch.float16, 128
+    seq_lens = [1, 100, 513, 1000]
+    max_pages = triton.cdiv(max(seq_lens), page_size)
+    num_pages = len(seq_lens) * max_pages
+    k_cache = torch.randn((num_pages, page_size, num_kv_heads, head_dim), dtype=dtype, device=device)
+    v_cache = torch.randn((num_pages, page_size, num_kv_heads, head_dim), dtype=dtype, device=device)
+    # the pages of the sequences are scattered in the cache
+    block_tables = torch.randperm(num_pages, device=device).to(torch.int32).view(len(seq_lens), max_pages)
+    q = torch.randn((len(seq_lens), num_heads, head_dim), dtype=dtype, device=device)
+    sm_scale = head_dim**-0.5
+    tri_out = triton.ops.paged_attention(q, k_cache, v_cache, block_tables,
+                                         torch.tensor(seq_lens, dtype=torch.int32, device=device), sm_scale=sm_scale,
+                                         window=window, num_splits=num_splits)
+    for i, seq_len in enumerate(seq_lens):
+        pages = block_tables[i, :triton.cdiv(seq_len, page_size)].long()
+        k = k_cache[pages].flatten(0, 1)[:seq_len]
+        v = v_cache[pages].flatten(0, 1)[:seq_len]
+        ref_out = ref_attention(q[i:i + 1], k, v, sm_scale, window=window)
+        torch.testing.assert_close(tri_out[i:i + 1], ref_out, atol=1e-2, rtol=0)
+
+
+BATCH, N_HEADS, N_KV_HEADS, D_HEAD = 16, 32, 8, 128
+configs = [
+    triton.testing.Benchmark(
+        x_names=['N_CTX'], x_vals=[2**i for i in range(9, 15)], line_arg='provider',
+        line_vals=['triton', 'triton-no-split', 'torch'], line_names=['Triton', 'Triton (no split)', 'Torch'],
+        styles=[('red', '-'), ('red', '--'), ('blue', '-')], ylabel='ms',
+        plot_name=f'paged-attention-batch{BATCH}-head{N_HEADS}-kv{N_KV_HEADS}-d{D_HEAD}-page{page_size}',
+        args={'page_size': page_size}) for page_size in [16, 128]
+]
+
+
+@triton.testing.perf_report(configs)
+def bench_paged_attention(N_CTX, page_size, provider, dtype=torch.float16, device="cuda"):
+    max_pages = triton.cdiv(N_CTX, page_size)
+    k_cache = torch.randn((BATCH * max_pages, page_size, N_KV_HEADS, D_HEAD), dtype=dtype, device=device)
+    v_cache = torch.randn_like(k_cache)
+    block_tables = torch.randperm(BATCH * max_pages, device=device).to(torch.int32).view(BATCH, max_pages)
+    seq_lens = torch.full((BATCH, ), N_CTX, dtype=torch.int32, device=device)
+    q = torch.randn((BATCH, N_HEADS, D_HEAD), dtype=dtype, device=device)
+    if provider.startswith("triton"):
+        num_splits = 1 if provider == "triton-no-split" else None
+        fn = lambda: triton.ops.paged_attention(q, k_cache, v_cache, block_tables, seq_lens, num_splits=num_splits)
+    if provider == "torch":
+        k = k_cache[block_tables.long()].flatten(1, 2)[:, :N_CTX].transpose(1, 2)
+        v = v_cache[block_tables.long()].flatten(1, 2)[:, :N_CTX].transpose(1, 2)
+        k = k.repeat_interleave(N_HEADS // N_KV_HEADS, dim=1)
+        v = v.repeat_interleave(N_HEADS // N_KV_HEADS, dim=1)
+        fn = lambda: torch.nn.functional.scaled_dot_product_attention(q[:, :, None], k, v)
+    return triton.testing.do_bench(fn)
+
+
+prefill_configs = [
+    triton.testing.Benchmark(
+        x_names=['N_CTX'], x_vals=[2**i for i in range(10, 15)], line_arg='provider', line_vals=['triton', 'torch'],
+        line_names=['Triton', 'Torch'], styles=[('red', '-'), ('blue', '-')], ylabel='ms',
+        plot_name=f'varlen-attention-head{N_HEADS}-kv{N_KV_HEADS}-d{D_HEAD}-window{window}', args={'window': window})
+    for window in [0, 4096]
+]
+
+
+@triton.testing.perf_report(prefill_configs)
+def bench_varlen_attention(N_CTX, window, provider, dtype=torch.float16, device="cuda"):
+    # a batch of 4 causal sequences of N_CTX tokens
+    batch = 4
+    cu_seqlens = torch.arange(0, batch + 1, dtype=torch.int32, device=device) * N_CTX
+    q = torch.randn((batch * N_CTX, N_HEADS, D_HEAD), dtype=dtype, device=device)
+    k = torch.randn((batch * N_CTX, N_KV_HEADS, D_HEAD), dtype=dtype, device=device)
+    v = torch.randn_like(k)
+    if provider == "triton":
+        fn = lambda: triton.ops.varlen_attention(q, k, v, cu_seqlens, cu_seqlens, N_CTX, window=window)
+    if provider == "torch":
+        group_size = N_HEADS // N_KV_HEADS
+        qt = q.view(batch, N_CTX, N_HEADS, D_HEAD).transpose(1, 2)
+        kt = k.view(batch, N_CTX, N_KV_HEADS, D_HEAD).transpose(1, 2).repeat_interleave(group_size, dim=1)
+        vt = v.view(batch, N_CTX, N_KV_HEADS, D_HEAD).transpose(1, 2).repeat_interleave(group_size, dim=1)
+        rows = torch.arange(N_CTX, device=device)[:, None]
+        cols = torch.arange(N_CTX, device=device)[None, :]
+        mask = cols <= rows
+        if window > 0:
+            mask &= cols > rows - window
+        fn = lambda: torch.nn.functional.scaled_dot_product_attention(qt, kt, vt, attn_mask=mask)
+    return triton.testing.do_bench(fn)
+
+
+# only works on post-Ampere GPUs right now
+# bench_paged_attention.run(save_path='.', print_data=True)
+# bench_varlen_attention.run(save_path='.', print_data=True)
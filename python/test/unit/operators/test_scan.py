@@ -0,0 +1,29 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+@pytest.mark.parametrize("N, dtype", [  #
+    (N, dtype)
+    for N in [1, 1000, 4096, 4097, 100003, 1 << 22]
+    for dtype in ['int32', 'float32']
+])
+def test_cumsum(N, dtype, device):
+    if dtype == 'int32':
+        x = torch.randint(-100, 100, (N, ), dtype=torch.int32, device=device)
+        torch.testing.assert_close(triton.ops.cumsum(x), torch.cumsum(x, 0, dtype=torch.int32))
+    else:
+        x = torch.randn(N, dtype=torch.float32, device=device)
+        ref = torch.cumsum(x.to(torch.float64), 0).to(torch.float32)
+        torch.testing.assert_close(triton.ops.cumsum(x), ref, rtol=1e-4, atol=1e-2)
+
+
+@pytest.mark.parametrize("dtype", ['float16', 'bfloat16'])
+def test_cumsum_16bit(dtype, device):
+    dtype = getattr(torch, dtype)
+    x = torch.randint(-2, 3, (50000, ), device=device).to(dtype)
+    # Partial sums are exact in float32; only the result is rounded.
+    ref = torch.cumsum(x.to(torch.float32), 0).to(dtype)
+    torch.testing.assert_close(triton.ops.cumsum(x), ref, rtol=0, atol=0)
@@ -1,3 +1,5 @@
+import threading
+
 import torch
 
 import triton
@@ -130,3 +132,193 @@ def test_prune_configs(with_perf_model: bool):
         assert records['run_early_config_prune']
         assert records['capture_kwargs']
         assert records['capture_named_args']
+
+
+def test_parallel_compile(monkeypatch):
+    monkeypatch.setenv("TRITON_AUTOTUNE_COMPILE_THREADS", "4")
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    compiled = []
+
+    def cache_hook(*args, **kwargs):
+        compiled.append((kwargs["compile"]["constants"]["BLOCK_SIZE"], threading.current_thread().name))
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': block_size}) for block_size in [32, 64, 128, 256]]
+
+    @triton.autotune(configs=configs, key=['N'], warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    triton.runtime.jit.JITFunction.cache_hook = cache_hook
+    try:
+        _kernel[grid](dst, src, N)
+    finally:
+        triton.runtime.jit.JITFunction.cache_hook = None
+    torch.testing.assert_close(src, dst)
+    # Every config is compiled once, by the compilation threads
+    assert sorted(block_size for block_size, _ in compiled) == [32, 64, 128, 256]
+    assert all(thread != threading.main_thread().name for _, thread in compiled)
+
+
+def test_cache_results(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    num_benchmarks = {"count": 0}
+
+    def _pre_hook(args, reset_only=False):
+        if not reset_only:
+            num_benchmarks["count"] += 1
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    # A new autotuner starts with an empty in-memory cache, as in a new process
+    tuned = triton.autotune(configs=configs, key=['N'], warmup=1, rep=1, pre_hook=_pre_hook, cache_results=True)
+    tuned(_kernel)[grid](dst, src, N)
+    assert num_benchmarks["count"] > 0
+    num_benchmarks["count"] = 0
+    tuned(_kernel)[grid](dst, src, N)
+    assert num_benchmarks["count"] == 0
+    torch.testing.assert_close(src, dst)
+    assert len(list(tmp_path.glob("*/_kernel.autotune.json"))) == 1
+
+
+def test_kernel_prune():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    records = {}
+
+    def kernel_prune(kernels, named_args, **kwargs):
+        records['num_kernels'] = len(kernels)
+        assert all(kernel.metadata.num_warps == config.num_warps for config, kernel in kernels.items())
+        return [config for config in kernels if config.kwargs['BLOCK_SIZE'] == 128]
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'kernel_prune': kernel_prune}, warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    torch.testing.assert_close(src, dst)
+    assert records['num_kernels'] == 2
+    assert [config.kwargs['BLOCK_SIZE'] for config in _kernel.configs_timings] == [128]
+
+
+def test_prune_spilling_configs():
+    N = 8192
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    records = {}
+
+    def kernel_prune(kernels, named_args, **kwargs):
+        records['kernels'] = dict(kernels)
+        return triton.runtime.prune_spilling_configs(kernels, named_args, **kwargs)
+
+    # the sum keeps the 256 elements of each thread of the first config live
+    configs = [
+        triton.Config(kwargs={'BLOCK_SIZE': 8192}, num_warps=1, maxnreg=32),
+        triton.Config(kwargs={'BLOCK_SIZE': 1024}, num_warps=4)
+    ]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'kernel_prune': kernel_prune}, warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x * tl.sum(x, axis=0), mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    spilling, fitting = (records['kernels'][config].metadata for config in configs)
+    assert spilling.n_spills > 0 and fitting.n_spills == 0
+    assert 0 < fitting.n_regs <= 255
+    assert spilling.estimated_regs > fitting.estimated_regs
+    assert [config.kwargs['BLOCK_SIZE'] for config in _kernel.configs_timings] == [1024]
+
+
+def test_compiler_options_configs():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    records = {}
+
+    def kernel_prune(kernels, named_args, **kwargs):
+        records['kernels'] = dict(kernels)
+        return list(kernels.keys())
+
+    is_cuda = triton.runtime.driver.active.get_current_target().backend == "cuda"
+    options = {'ptxas_options': ['-O1'], 'fast_math': True} if is_cuda else {'fast_math': True}
+    configs = [
+        triton.Config(kwargs={'BLOCK_SIZE': 128}),
+        triton.Config(kwargs={'BLOCK_SIZE': 128}, options={'llvm_opt_level': 0}),
+        triton.Config(kwargs={'BLOCK_SIZE': 128}, options=options),
+    ]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'kernel_prune': kernel_prune}, warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, tl.exp(x), mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    torch.testing.assert_close(torch.exp(src), dst)
+    default, unoptimized, tuned = (records['kernels'][config].metadata for config in configs)
+    assert default.llvm_opt_level == 3 and unoptimized.llvm_opt_level == 0
+    assert tuned.fast_math and not default.fast_math
+    # the options are part of the key of the kernels
+    assert len({default.hash, unoptimized.hash, tuned.hash}) == 3
+    assert len({str(config) for config in configs}) == 3
+
+
+def test_cluster_dims_configs():
+    if torch.cuda.get_device_capability()[0] < 9:
+        pytest.skip("clusters are only supported on sm90+")
+    N = 4096
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+    records = {}
+
+    def kernel_prune(kernels, named_args, **kwargs):
+        records['kernels'] = dict(kernels)
+        return list(kernels.keys())
+
+    # clusters have at most 16 blocks, so the second config can't be launched
+    configs = [
+        triton.Config(kwargs={'BLOCK_SIZE': 128}, cluster_dims=(2, 1, 1)),
+        triton.Config(kwargs={'BLOCK_SIZE': 128}, cluster_dims=(32, 1, 1)),
+    ]
+
+    @triton.autotune(configs=configs, key=['N'], prune_configs_by={'kernel_prune': kernel_prune}, warmup=1, rep=1)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']), )
+    _kernel[grid](dst, src, N)
+    torch.testing.assert_close(src, dst)
+    assert records['kernels'][configs[0]].metadata.cluster_dims == (2, 1, 1)
+    assert "cluster_dims: (2, 1, 1)" in str(configs[0])
+    assert list(_kernel.configs_timings) == [configs[0]]
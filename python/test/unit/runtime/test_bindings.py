@@ -103,3 +103,34 @@ def test_python_func_in_visit_call(device):
     x = torch.randn(4, device=device)
     out = torch.zeros_like(x)
     test_py_call_const_kernel[(4, )](x, out, 4, 4)
+
+
+def test_function_passes_deterministic(tmp_path):
+    from triton._C.libtriton import ir, passes
+
+    # the functions of the module are canonicalized on several threads
+    funcs = "\n".join(f"""
+  tt.func public @kernel_{i}(%arg0: !tt.ptr<i32>) {{
+    %c{i} = arith.constant {i} : i32
+    %0 = arith.addi %c{i}, %c{i} : i32
+    tt.store %arg0, %0 : !tt.ptr<i32>
+    tt.return
+  }}""" for i in range(16))
+    path = tmp_path / "kernels.ttir"
+    path.write_text(f"module {{{funcs}\n}}\n")
+
+    def optimize():
+        context = ir.context()
+        ir.load_dialects(context)
+        mod = ir.parse_mlir_module(str(path), context)
+        mod.context = context
+        pm = ir.pass_manager(context)
+        passes.common.add_func_canonicalizer(pm)
+        passes.common.add_func_cse(pm)
+        pm.run(mod)
+        return mod.str()
+
+    ir_text = optimize()
+    assert "arith.addi" not in ir_text
+    assert "arith.constant 30 : i32" in ir_text
+    assert all(optimize() == ir_text for _ in range(4))
@@ -3,6 +3,7 @@ import itertools
 import os
 import shutil
 import tempfile
+import threading
 
 import pytest
 import torch
@@ -97,6 +98,19 @@ def test_nested2_change():
     assert baseline != updated
 
 
+def test_cached_dependencies(monkeypatch):
+    baseline = kernel.cache_key
+    for fn in [kernel, function_0, function_1, function_2]:
+        fn.hash = None
+
+    def parse(self):
+        raise AssertionError(f"{self.__name__} was parsed again")
+
+    # The lookups of the first visit are replayed from the cache
+    monkeypatch.setattr(JITFunction, "parse", parse)
+    assert kernel.cache_key == baseline
+
+
 def test_combine_fn_change():
     # Test that tl.reduce and associative_scan calls include
     # the combine_fn in the hash
@@ -547,3 +561,376 @@ def test_preload() -> None:
     # test that we can't preload a mismatched kernel
     with pytest.raises(RuntimeError, match="Specialization data is for"):
         kernel_sub.preload(specialization_data)
+
+
+def test_cache_archive(tmp_path, monkeypatch) -> None:
+    from triton.compiler import compiler
+    from triton.runtime.cache import build_cache_archive
+
+    monkeypatch.setattr(compiler, "_cache_archives", [])
+    monkeypatch.setattr(compiler, "_preloaded_handles", {})
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    hash = kernel[(1, )](x, 1, BLOCK=1024).hash
+    archive_path = str(tmp_path / "kernels.tca")
+    assert build_cache_archive(archive_path) >= 1
+
+    # the kernel is loaded from the archive instead of the cache directory
+    reset_tmp_dir()
+    kernel.cache[device].clear()
+    assert triton.compiler.preload_cache_archive(archive_path, background=False) is None
+    assert hash in compiler._preloaded_handles
+    x.zero_()
+    assert kernel[(1, )](x, 1, BLOCK=1024).hash == hash
+    assert x.item() == 4
+    assert not os.path.exists(os.path.join(tmpdir, hash))
+    # but it is compiled again when its IR is dumped
+    monkeypatch.setenv("TRITON_KERNEL_DUMP", "1")
+    monkeypatch.setenv("TRITON_HOME", str(tmp_path))
+    kernel.cache[device].clear()
+    assert kernel[(1, )](x, 1, BLOCK=1024).hash == hash
+    assert os.path.exists(os.path.join(tmpdir, hash))
+    assert os.listdir(tmp_path / ".triton" / "dump")
+
+
+def test_stage_cache() -> None:
+    reset_tmp_dir()
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    k0 = kernel[(1, )](x, 1, BLOCK=1024, num_warps=4)
+    assert {"make_ir", "ttir", "ttgir"} <= k0.metadata.stage_times.keys()
+    # only the stages after ttir depend on num_warps
+    k1 = kernel[(1, )](x, 1, BLOCK=1024, num_warps=8)
+    assert k1.hash != k0.hash
+    assert "make_ir" not in k1.metadata.stage_times
+    assert "ttir" not in k1.metadata.stage_times
+    assert "ttgir" in k1.metadata.stage_times
+    assert k1.asm["ttir"] == k0.asm["ttir"]
+    assert x.item() == 4
+
+
+def test_stage_cache_cluster_dims() -> None:
+    if torch.cuda.get_device_capability()[0] < 9:
+        pytest.skip("cluster_reduce requires clusters of CTAs")
+
+    @triton.jit
+    def kernel_cluster(X, Z, BLOCK: tl.constexpr):
+        pid = tl.program_id(0)
+        offs = tl.arange(0, BLOCK)
+        x = tl.load(X + pid * BLOCK + offs)
+        tl.store(Z + pid * BLOCK + offs, tl.cluster_reduce(x, "sum"))
+
+    reset_tmp_dir()
+    BLOCK = 128
+    x = torch.arange(2 * BLOCK, dtype=torch.float32, device="cuda")
+    z = torch.empty_like(x)
+    k0 = kernel_cluster[(2, )](x, z, BLOCK=BLOCK, cluster_dims=(1, 1, 1))
+    assert torch.equal(z, x)
+    # the frontend emits the cluster reduction from cluster_dims, so the ttir can't be reused
+    k1 = kernel_cluster[(2, )](x, z, BLOCK=BLOCK, cluster_dims=(2, 1, 1))
+    assert "ttir" in k1.metadata.stage_times
+    assert k1.asm["ttir"] != k0.asm["ttir"]
+    assert torch.equal(z, x.view(2, BLOCK).sum(0).repeat(2))
+
+
+def test_dedup_kernels(monkeypatch) -> None:
+    from triton.compiler import compiler
+
+    @triton.jit
+    def kernel_unused(X, UNUSED: tl.constexpr):
+        tl.store(X, 1)
+
+    monkeypatch.setenv("TRITON_DEDUP_KERNELS", "1")
+    monkeypatch.setattr(compiler, "_dedup_handles", {})
+    reset_tmp_dir()
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    k0 = kernel_unused[(1, )](x, UNUSED=0)
+    # the value of UNUSED doesn't change the LLVM IR, so the specializations share the binary
+    k1 = kernel_unused[(1, )](x, UNUSED=1)
+    assert k1.hash != k0.hash
+    assert k1.metadata.dedup_key == k0.metadata.dedup_key
+    assert "llir" in k1.metadata.stage_times
+    assert "ptx" not in k1.metadata.stage_times
+    assert k1.asm["cubin"] == k0.asm["cubin"]
+    assert k1.module == k0.module
+    assert x.item() == 1
+
+
+def test_context_reuse(monkeypatch) -> None:
+    from triton.compiler import compiler
+
+    contexts = []
+    make_context = compiler.ir.context
+
+    def context():
+        contexts.append(make_context())
+        return contexts[-1]
+
+    monkeypatch.setenv("TRITON_CONTEXT_REUSE", "2")
+    monkeypatch.setattr(compiler.ir, "context", context)
+    monkeypatch.setattr(compiler, "_thread_contexts", threading.local())
+    reset_tmp_dir()
+    kernel.cache[torch.cuda.current_device()].clear()
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    for num_warps in (1, 2, 4):
+        kernel[(1, )](x, 1, BLOCK=1024, num_warps=num_warps)
+    # the third compilation replaces the context used twice
+    assert len(contexts) == 2
+    assert x.item() == 4
+
+
+def test_compile_time_budget(monkeypatch) -> None:
+    from triton.compiler import compiler
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    num_compilations = []
+    compile_and_cache = compiler._compile_and_cache
+
+    def counting_compile_and_cache(*args):
+        num_compilations.append(1)
+        return compile_and_cache(*args)
+
+    monkeypatch.setattr(compiler, "_compile_and_cache", counting_compile_and_cache)
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    k0 = kernel[(1, )](x, 1, BLOCK=1024)
+    assert k0.metadata.skipped_passes == []
+    assert not k0.metadata.budget_exceeded
+    # every optional pass is over a budget of zero seconds
+    k1 = kernel[(1, )](x, 1, BLOCK=1024, compile_time_budget=0.0)
+    assert "add_remove_layout_conversions" in k1.metadata.skipped_passes
+    assert k1.metadata.budget_exceeded
+    assert x.item() == 4
+    assert len(num_compilations) == 2
+    # the kernel that ran out of its budget isn't persisted, unlike the complete one
+    kernel.cache[device].clear()
+    kernel[(1, )](x, 1, BLOCK=1024)
+    kernel[(1, )](x, 1, BLOCK=1024, compile_time_budget=0.0)
+    assert len(num_compilations) == 3
+
+
+def test_pass_timing_json(tmp_path, monkeypatch) -> None:
+    import json
+
+    reset_tmp_dir()
+    path = tmp_path / "timing.jsonl"
+    monkeypatch.setenv("TRITON_PASS_TIMING_JSON", str(path))
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    kernel[(1, )](x, 1, BLOCK=1024)
+    lines = [json.loads(line) for line in path.read_text().splitlines()]
+    assert all(line["kernel"] == "kernel" for line in lines)
+    passes = [p for line in lines for p in line["passes"]]
+    assert "tritongpu-remove-layout-conversions" in {p["pass"] for p in passes}
+    assert all(p["time"] >= 0 for p in passes)
+
+
+def test_warmup_async() -> None:
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    futures = [
+        kernel.warmup_async(torch.int32, 1, BLOCK=1024, grid=(1, ), num_warps=num_warps) for num_warps in [1, 2, 4, 8]
+    ]
+    kernels = [future.result() for future in futures]
+    assert len({k.hash for k in kernels}) == 4
+    assert len(kernel.cache[device]) == 4
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    kernel[(1, )](x, 1, BLOCK=1024, num_warps=2)
+    assert x.item() == 4
+
+
+def test_compile_server(tmp_path, monkeypatch) -> None:
+    from triton.runtime import compile_server
+
+    requests = []
+    compile_request = compile_server._compile_request
+
+    def count_request(request):
+        requests.append(request["name"])
+        return compile_request(request)
+
+    monkeypatch.setattr(compile_server, "_compile_request", count_request)
+    reset_tmp_dir()
+    address = str(tmp_path / "triton.sock")
+    server = compile_server.CompileServer(address)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    try:
+        monkeypatch.setenv("TRITON_COMPILE_SERVER", address)
+        kernel.cache[torch.cuda.current_device()].clear()
+        x = torch.empty(1, dtype=torch.int32, device="cuda")
+        k = kernel[(1, )](x, 1, BLOCK=1024)
+        assert requests == ["kernel"]
+        assert "cubin" in k.asm or "hsaco" in k.asm
+        assert x.item() == 4
+    finally:
+        server.close()
+    # kernels are compiled locally once the server is gone
+    kernel.cache[torch.cuda.current_device()].clear()
+    with pytest.warns(UserWarning, match="Compiling locally"):
+        kernel[(1, )](x, 2, BLOCK=1024, num_warps=2)
+    assert requests == ["kernel"]
+    assert x.item() == 5
+    # and the server isn't tried again for a while
+    connections = []
+    monkeypatch.setattr(compile_server, "Client", lambda *args, **kwargs: connections.append(args))
+    kernel[(1, )](x, 3, BLOCK=1024, num_warps=1)
+    assert connections == []
+    assert x.item() == 6
+
+
+def test_async_compile() -> None:
+    reset_tmp_dir()
+    fallback_calls = []
+
+    def fallback(X, i, BLOCK, grid):
+        fallback_calls.append(i)
+        X.fill_(i + 3)
+
+    @triton.jit(async_compile=True, fallback=fallback)
+    def async_kernel(X, i, BLOCK: tl.constexpr):
+        tl.store(X, i + 3)
+
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device="cuda")
+    # i = 3 is the general specialization of the i32 signature
+    async_kernel[(1, )](x, 3, BLOCK=1024)
+    assert x.item() == 6
+    for future in list(async_kernel.pending_compiles.values()):
+        future.result()
+    # The general kernel, added to the cache by the next launch, serves i = 16 until its specialization is compiled
+    async_kernel[(1, )](x, 16, BLOCK=1024)
+    assert x.item() == 19
+    assert len(async_kernel.cache[device]) == 1
+    for future in list(async_kernel.pending_compiles.values()):
+        future.result()
+    async_kernel[(1, )](x, 32, BLOCK=1024)
+    assert x.item() == 35
+    assert len(async_kernel.cache[device]) == 2
+    assert not async_kernel.pending_compiles
+    assert all(i == 3 for i in fallback_calls)
+
+
+def test_specialization_policy() -> None:
+    reset_tmp_dir()
+
+    @triton.jit(specialize={"i": "divisibility", "N": "pow2", "M": [8, 32]})
+    def bucketed_kernel(X, i, N, M, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(X + offs, i + M, mask=(offs < N) & (offs < M))
+
+    device = torch.cuda.current_device()
+    x = torch.zeros(64, dtype=torch.int32, device="cuda")
+    bucketed_kernel[(1, )](x, 1, 5, 3, BLOCK=32)
+    # the kernel receives the values, not their buckets
+    assert x[:8].tolist() == [1 + 3] * 3 + [0] * 5
+    for i, N, M in [(2, 7, 5), (3, 8, 8)]:
+        bucketed_kernel[(1, )](x, i, N, M, BLOCK=32)
+    # i = 1 isn't specialized, N = 5, 7 and 8 round up to 8, and M = 3, 5 and 8 to 8
+    assert len(bucketed_kernel.cache[device]) == 1
+    assert x[:9].tolist() == [3 + 8] * 8 + [0]
+    bucketed_kernel[(1, )](x, 3, 20, 9, BLOCK=32)
+    assert len(bucketed_kernel.cache[device]) == 2
+    assert x[:10].tolist() == [3 + 9] * 9 + [0]
+    stats = bucketed_kernel.cache_stats
+    assert (stats.hits, stats.misses) == (2, 2)
+    assert stats.compile_time > 0
+
+    with pytest.raises(ValueError):
+        triton.jit(specialize={"BLOCK": "divisibility"})(bucketed_kernel.fn)
+    with pytest.raises(ValueError):
+        triton.jit(specialize={"BLOCK": "pow2"})(bucketed_kernel.fn)
+
+
+def test_cache_size() -> None:
+    reset_tmp_dir()
+
+    @triton.jit(cache_size=2)
+    def kernel(X, N: tl.constexpr):
+        tl.store(X, N)
+
+    device = torch.cuda.current_device()
+    x = torch.zeros(1, dtype=torch.int32, device="cuda")
+    kernel[(1, )](x, 1)
+    kernel[(1, )](x, 2)
+    first = next(iter(kernel.cache[device].values()))
+    # launching N = 1 again makes N = 2 the least recently used kernel
+    kernel[(1, )](x, 1)
+    kernel[(1, )](x, 3)
+    assert len(kernel.cache[device]) == 2
+    assert first in kernel.cache[device].values()
+    stats = kernel.cache_stats
+    assert (stats.evictions, stats.resident_kernels) == (1, 2)
+    assert stats.resident_bytes == sum(len(k.kernel) for k in kernel.cache[device].values())
+    # the evicted kernel comes back from the on-disk cache
+    kernel[(1, )](x, 2)
+    assert x.item() == 2
+    assert first not in kernel.cache[device].values()
+    assert first.module is None
+    assert kernel.cache_stats.evictions == 2
+
+
+class DictRemoteCacheBackend(triton.runtime.RemoteCacheBackend):
+    files = {}
+    num_round_trips = 0
+
+    def __init__(self, key):
+        self._key = key
+
+    def get(self, filenames):
+        DictRemoteCacheBackend.num_round_trips += 1
+        return {f: self.files[(self._key, f)] for f in filenames if (self._key, f) in self.files}
+
+    def put(self, filename, data):
+        self.files[(self._key, filename)] = data
+
+    @classmethod
+    def get_many(cls, requests):
+        cls.num_round_trips += 1
+        return {key: {f: cls.files[(key, f)]
+                      for f in filenames
+                      if (key, f) in cls.files}
+                for key, filenames in requests.items()}
+
+
+def test_prefetch_remote_cache(tmp_path, monkeypatch) -> None:
+    from triton.runtime.cache import RemoteCacheManager, prefetch_remote_cache
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    monkeypatch.setenv("TRITON_REMOTE_CACHE_BACKEND", f"{__name__}:DictRemoteCacheBackend")
+    keys = [f"key{i}" for i in range(8)]
+    for key in keys:
+        RemoteCacheManager(key).put_group("kernel.json", {"kernel.json": "", "kernel.cubin": ""})
+        DictRemoteCacheBackend.files[(key, "kernel.json")] = b"{}"
+        DictRemoteCacheBackend.files[(key, "kernel.cubin")] = key.encode()
+    shutil.rmtree(tmp_path)
+    DictRemoteCacheBackend.num_round_trips = 0
+
+    future = prefetch_remote_cache([(key, "kernel.json") for key in keys + ["missing"]])
+    assert future.result() == 9
+    # one lookup for the groups and one for their files
+    assert DictRemoteCacheBackend.num_round_trips == 2
+    for key in keys:
+        group = RemoteCacheManager(key).get_group("kernel.json")
+        with open(group["kernel.cubin"], "rb") as f:
+            assert f.read() == key.encode()
+    assert RemoteCacheManager("missing").get_group("kernel.json") is None
+    assert DictRemoteCacheBackend.num_round_trips == 2
+
+
+def test_compile_lock(monkeypatch) -> None:
+    from triton.compiler import compiler
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    num_compilations = []
+    compile_and_cache = compiler._compile_and_cache
+
+    def counting_compile_and_cache(*args):
+        num_compilations.append(1)
+        return compile_and_cache(*args)
+
+    monkeypatch.setattr(compiler, "_compile_and_cache", counting_compile_and_cache)
+    # the threads lock the cache directory like processes do
+    futures = [kernel.warmup_async(torch.int32, 1, BLOCK=1024, grid=(1, )) for _ in range(4)]
+    assert len({future.result().hash for future in futures}) == 1
+    assert len(num_compilations) == 1
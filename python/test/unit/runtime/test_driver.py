@@ -1,3 +1,4 @@
+import struct
 import sys
 
 import triton
@@ -12,3 +13,67 @@ def test_is_lazy():
     assert triton.runtime.driver.active._obj is None
     utils = triton.runtime.driver.active.utils  # noqa: F841
     assert issubclass(triton.runtime.driver.active._obj.__class__, getattr(triton.backends.driver, "DriverBase"))
+
+
+def test_compute_occupancy():
+    from triton.runtime.occupancy import compute_occupancy
+
+    # the limits of an sm_80 multiprocessor
+    props = {
+        "max_threads_per_sm": 2048, "max_blocks_per_sm": 32, "max_regs_per_sm": 65536, "max_shared_mem_per_sm": 167936,
+        "reserved_shared_mem": 1024, "multiprocessor_count": 108
+    }
+    # 4 warps of 128 registers per thread fill the register file with 4 blocks
+    occupancy = compute_occupancy(props, num_warps=4, warp_size=32, n_regs=125, shared=0)
+    assert occupancy["limiter"] == "registers"
+    assert occupancy["blocks_per_sm"] == 4 and occupancy["warps_per_sm"] == 16
+    assert occupancy["warp_occupancy"] == 0.25
+    # 3 blocks with 48KB of shared memory fit
+    occupancy = compute_occupancy(props, num_warps=4, warp_size=32, n_regs=32, shared=49152)
+    assert occupancy["limiter"] == "shared_memory" and occupancy["blocks_per_sm"] == 3
+    occupancy = compute_occupancy(props, num_warps=1, warp_size=32, n_regs=16, shared=0, cluster_dims=(2, 1, 1))
+    assert occupancy["limiter"] == "blocks" and occupancy["max_active_clusters"] == 32 * 108 // 2
+
+
+def test_kernel_occupancy_metadata():
+    import torch
+    import triton.language as tl
+
+    @triton.jit
+    def kernel(X):
+        tl.store(X + tl.arange(0, 128), tl.arange(0, 128))
+
+    x = torch.empty(128, dtype=torch.int32, device="cuda")
+    compiled = kernel[(1, )](x)
+    occupancy = compiled.metadata.occupancy
+    assert occupancy["blocks_per_sm"] > 0
+    assert occupancy["warps_per_sm"] == occupancy["blocks_per_sm"] * compiled.metadata.num_warps
+
+
+def test_decode_device_prints():
+    from triton.backends.nvidia.driver import decode_device_prints
+
+    device_prints = [
+        {"prefix": " x: ", "hex": False, "operands": [{"type": "f32", "shape": [4, 2]}]},
+        {"prefix": " ", "hex": True, "operands": [{"type": "i16", "shape": []}, {"type": "i16", "shape": []}]},
+        {"prefix": " done", "hex": False, "operands": []},
+    ]
+
+    def ring(cursor, records, num_records=4):
+        data = bytearray(4 + 32 * num_records)
+        struct.pack_into("<I", data, 0, cursor)
+        for k, record in enumerate(records, start=cursor - len(records)):
+            struct.pack_into("<8I", data, 4 + 32 * (k % num_records), *record)
+        return bytes(data)
+
+    bits = struct.unpack("<I", struct.pack("<f", 1.5))[0]
+    # the index is linearized with dim 0 fastest
+    records = [(0, 0, 1, 0, 0, 5, bits, 0), (1, 1, 0, 2, 0, 0, 0xfffe, 0), (2, 0, 3, 0, 0, 0, 0, 0)]
+    assert decode_device_prints(ring(3, records), device_prints) == [
+        "pid (1, 0, 0) idx (1, 1) x: 1.500000",
+        "pid (0, 2, 0) idx () (operand 1) 0xfffe",
+        "pid (3, 0, 0) done",
+    ]
+    # the ring size is taken from the global, which only keeps its last records once it wrapped around
+    records = [(2, 0, x, 0, 0, 0, 0, 0) for x in range(5)]
+    assert decode_device_prints(ring(5, records), device_prints) == [f"pid ({x}, 0, 0) done" for x in range(1, 5)]
@@ -7,6 +7,7 @@ import gc
 # import time
 import tracemalloc
 
+import pytest
 import torch
 
 import triton
@@ -71,6 +72,141 @@ def test_memory_leak() -> None:
         tracemalloc.stop()
 
 
+@pytest.mark.parametrize("tile_scheduler", ["data-parallel", "grouped"])
+def test_persistent(tile_scheduler) -> None:
+
+    @triton.jit
+    def kernel(out_ptr, BLOCK: tl.constexpr):
+        pid_m = tl.program_id(0)
+        pid_n = tl.program_id(1)
+        num_m = tl.num_programs(0)
+        offs = tl.arange(0, BLOCK)
+        tl.store(out_ptr + (pid_n * num_m + pid_m) * BLOCK + offs, pid_m * 1000 + pid_n + offs * 0)
+
+    grid = (37, 1000)
+    out = torch.full((grid[0] * grid[1] * 16, ), -1, dtype=torch.int32, device='cuda')
+    kernel[grid](out, BLOCK=16, persistent=True, tile_scheduler=tile_scheduler, group_size=8)
+    pid_m = torch.arange(grid[0], device='cuda').view(1, -1, 1)
+    pid_n = torch.arange(grid[1], device='cuda').view(-1, 1, 1)
+    ref = (pid_m * 1000 + pid_n).expand(grid[1], grid[0], 16).reshape(-1).to(torch.int32)
+    assert torch.equal(out, ref)
+
+
+def test_cooperative() -> None:
+
+    @triton.jit
+    def kernel(counter_ptr, out_ptr):
+        # every program waits for all of them to arrive, which only terminates if they are resident together
+        num_programs = tl.num_programs(0)
+        tl.atomic_add(counter_ptr, 1)
+        arrived = tl.atomic_add(counter_ptr, 0)
+        while arrived < num_programs:
+            arrived = tl.atomic_add(counter_ptr, 0)
+        tl.store(out_ptr + tl.program_id(0), arrived)
+
+    device = triton.runtime.driver.active.get_current_device()
+    num_sms = triton.runtime.driver.active.utils.get_device_properties(device)["multiprocessor_count"]
+    counter = torch.zeros(1, dtype=torch.int32, device='cuda')
+    out = torch.zeros(num_sms, dtype=torch.int32, device='cuda')
+    kernel[(num_sms, )](counter, out, cooperative=True)
+    assert torch.all(out == num_sms)
+
+
+def test_workspace() -> None:
+
+    @triton.jit
+    def kernel(out_ptr):
+        # each launch finds the counter zeroed, although the previous one left the number of programs in it
+        counter = tl.workspace(1, tl.int32)
+        scratch = tl.workspace(128, tl.float32, zeroed=False)
+        tl.store(scratch + tl.program_id(0), 1.0)
+        tl.store(out_ptr + tl.program_id(0), tl.atomic_add(counter, 1))
+
+    out = torch.empty(64, dtype=torch.int32, device='cuda')
+    for _ in range(3):
+        compiled = kernel[(64, )](out)
+        assert sorted(out.tolist()) == list(range(64))
+    # the zeroed counter comes first, and the scratch starts on the next 128 bytes
+    assert compiled.metadata.workspace_zeroed_size == 4
+    assert compiled.metadata.workspace_size == 128 + 128 * 4
+
+
+def test_workspace_graph() -> None:
+    from triton.backends.driver import workspaces
+
+    @triton.jit
+    def kernel(out_ptr, N: tl.constexpr):
+        scratch = tl.workspace(N, tl.float32, zeroed=False)
+        offsets = tl.arange(0, N)
+        tl.store(scratch + offsets, offsets.to(tl.float32))
+        tl.store(out_ptr + offsets, tl.load(scratch + offsets))
+
+    out = torch.zeros(64, device='cuda')
+    kernel[(1, )](out, 64)
+    graph = torch.cuda.CUDAGraph()
+    with torch.cuda.graph(graph):
+        kernel[(1, )](out, 64)
+    # the buffer the graph replays stays allocated once the pool lets go of it
+    workspaces.clear()
+    assert workspaces.retained
+    garbage = torch.full((1 << 20, ), -1.0, device='cuda')
+    out.zero_()
+    graph.replay()
+    torch.cuda.synchronize()
+    torch.testing.assert_close(out, torch.arange(64, dtype=torch.float32, device='cuda'))
+    del garbage
+
+
+@pytest.mark.skipif(torch.cuda.get_device_capability()[0] < 9, reason="requires sm_90 or later")
+def test_launch_pdl() -> None:
+
+    @triton.jit
+    def kernel(x_ptr, y_ptr, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        # x is written by the previous kernel of the stream, which may still be running
+        tl.griddep_wait()
+        x = tl.load(x_ptr + offs)
+        tl.griddep_launch_dependents()
+        tl.store(y_ptr + offs, x + 1)
+
+    BLOCK = 1024
+    bufs = [torch.zeros(256 * BLOCK, dtype=torch.int32, device='cuda') for _ in range(2)]
+    for i in range(8):
+        compiled = kernel[(256, )](bufs[i % 2], bufs[(i + 1) % 2], BLOCK=BLOCK, launch_pdl=True)
+    assert compiled.metadata.launch_pdl
+    torch.cuda.synchronize()
+    assert torch.all(bufs[0] == 8)
+
+
+@pytest.mark.skipif(torch.version.hip is not None or torch.cuda.get_device_capability()[0] < 8,
+                    reason="requires sm_80 or later")
+def test_l2_persist() -> None:
+
+    @triton.jit
+    def kernel(w_ptr, x_ptr, y_ptr, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.store(y_ptr + offs, tl.load(w_ptr + offs) * tl.load(x_ptr + offs))
+
+    BLOCK = 1024
+    w = torch.randn(64 * BLOCK, device='cuda')
+    x = torch.randn(64 * BLOCK, device='cuda')
+    y = torch.empty_like(x)
+    utils = triton.runtime.driver.active.utils
+    reserved = utils.reserve_persisting_l2(w.nbytes)
+    assert reserved > 0
+    try:
+        compiled = kernel[(64, )](w, x, y, BLOCK=BLOCK, l2_persist="w_ptr")
+        assert compiled.metadata.l2_persist == "w_ptr"
+        torch.testing.assert_close(y, w * x)
+        # launches without a carve-out run without the window
+        assert utils.reserve_persisting_l2(0) == 0
+        kernel[(64, )](w, x + 1, y, BLOCK=BLOCK, l2_persist="w_ptr")
+        torch.testing.assert_close(y, w * (x + 1))
+    finally:
+        utils.reserve_persisting_l2(0)
+    with pytest.raises(ValueError, match="l2_persist"):
+        kernel[(64, )](w, x, y, BLOCK=BLOCK, l2_persist="BLOCK")
+
 # LATENCY_THRESHOLD_US = 46
 
 # def test_kernel_launch_latency() -> None:
@@ -132,3 +268,194 @@ def test_memory_leak() -> None:
 
 #     # Run empty, which would run empty_kernel internally
 #     empty(*kernel_args)
+
+
+def test_native_dispatch() -> None:
+
+    @triton.jit
+    def kernel(out_ptr, value, n, BLOCK: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.store(out_ptr + offsets, value, mask=offsets < n)
+
+    out = torch.zeros(64, device="cuda", dtype=torch.int32)
+    grid = lambda meta: (triton.cdiv(meta["n"], meta["BLOCK"]), )
+    compiled = kernel[grid](out, 2, 64, BLOCK=32)
+    assert kernel.dispatcher is not None and len(kernel.dispatcher) == 1
+    # Same specialization, launched natively
+    assert kernel[grid](out, 3, 64, BLOCK=32) is compiled
+    assert len(kernel.dispatcher) == 1
+    assert torch.all(out == 3)
+    # The specialization of value, the constexpr, and the alignment of out_ptr all select other kernels
+    assert kernel[grid](out, 0, 64, BLOCK=32) is not compiled
+    assert kernel[grid](out, 7, 64, BLOCK=16) is not compiled
+    assert kernel[grid](out[1:], 5, 63, BLOCK=32) is not compiled
+    assert len(kernel.dispatcher) == 4
+    assert out[0].item() == 7 and torch.all(out[1:] == 5)
+    # Clearing the cache recompiles
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    assert kernel[grid](out, 2, 64, BLOCK=32) is not compiled
+
+
+def test_bind() -> None:
+
+    @triton.jit
+    def axpy_kernel(x_ptr, y_ptr, alpha, n, BLOCK: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offsets < n
+        tl.store(y_ptr + offsets, tl.load(y_ptr + offsets, mask=mask) + alpha * tl.load(x_ptr + offsets, mask=mask),
+                 mask=mask)
+
+    xs = [torch.randn(1000, device="cuda") for _ in range(3)]
+    y = torch.zeros(1000, device="cuda")
+    grid = lambda meta: (triton.cdiv(meta["n"], meta["BLOCK"]), )
+    bound = axpy_kernel.bind(grid, xs[0], y, 2.0, 1000, BLOCK=256)
+    for x in xs:
+        bound.set_arg(0, x)
+        bound()
+    torch.testing.assert_close(y, 2.0 * sum(xs))
+    bound.set_arg(2, -1.0)
+    bound()
+    torch.testing.assert_close(y, 2.0 * sum(xs) - xs[-1])
+    with pytest.raises(IndexError):
+        bound.set_arg(4, 0)
+    # the kernel was specialized on the 16-byte alignment of x_ptr
+    with pytest.raises(ValueError):
+        bound.set_arg(0, xs[0][1:])
+
+    # the bound launch is captured in a graph like other launches
+    y.zero_()
+    stream = torch.cuda.Stream()
+    graph = torch.cuda.CUDAGraph()
+    with torch.cuda.stream(stream):
+        bound = axpy_kernel.bind(grid, xs[0], y, 1.0, 1000, BLOCK=256)
+        bound()
+        with torch.cuda.graph(graph, stream=stream):
+            bound()
+    graph.replay()
+    torch.cuda.synchronize()
+    torch.testing.assert_close(y, 2.0 * xs[0])
+
+
+def test_unload_bound() -> None:
+    from triton.compiler.compiler import _deferred_unloads
+
+    @triton.jit
+    def add_one_kernel(x_ptr, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(x_ptr + offsets, tl.load(x_ptr + offsets) + 1)
+
+    x = torch.zeros(64, device="cuda")
+    compiled = add_one_kernel[(1, )](x, BLOCK=64)
+    bound = compiled.bind((1, ), x)
+    module = compiled.module
+    # the bound launch keeps the module loaded until it is released
+    compiled.unload()
+    assert module in _deferred_unloads
+    bound()
+    torch.cuda.synchronize()
+    assert torch.all(x == 2)
+    del bound
+    assert module not in _deferred_unloads
+
+
+def test_unload_captured() -> None:
+
+    @triton.jit
+    def add_one_kernel(x_ptr, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(x_ptr + offsets, tl.load(x_ptr + offsets) + 1)
+
+    x = torch.zeros(64, device="cuda")
+    stream = torch.cuda.Stream()
+    graph = torch.cuda.CUDAGraph()
+    with torch.cuda.stream(stream):
+        compiled = add_one_kernel[(1, )](x, BLOCK=64)
+        with torch.cuda.graph(graph, stream=stream):
+            add_one_kernel[(1, )](x, BLOCK=64)
+    torch.cuda.synchronize()
+    # the graph still runs the function of the kernel, so its module stays loaded
+    function = compiled.function
+    compiled.unload()
+    assert function in compiled.run.captured_functions()
+    graph.replay()
+    torch.cuda.synchronize()
+    assert torch.all(x == 2)
+
+
+@pytest.mark.parametrize("use_graph", [False, True])
+def test_launch_queue(use_graph) -> None:
+
+    @triton.jit
+    def add_kernel(x_ptr, value, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(x_ptr + offsets, tl.load(x_ptr + offsets) + value)
+
+    @triton.jit
+    def mul_kernel(x_ptr, value, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        tl.store(x_ptr + offsets, tl.load(x_ptr + offsets) * value)
+
+    x = torch.ones((4, 16), device="cuda", dtype=torch.float32)
+    queue = triton.runtime.LaunchQueue(use_graph=use_graph)
+    for _ in range(2):
+        with queue:
+            for i in range(4):
+                add_kernel[(1, )](x[i], i, BLOCK=16)
+                mul_kernel[(1, )](x[i], 2, BLOCK=16)
+        assert len(queue) == 8
+        queue.submit()
+        assert len(queue) == 0
+    expected = torch.ones((4, 16), device="cuda", dtype=torch.float32)
+    for _ in range(2):
+        for i in range(4):
+            expected[i] = (expected[i] + i) * 2
+    torch.testing.assert_close(x, expected)
+    if use_graph:
+        assert len(queue.graphs) == 1
+
+
+def test_multi_tensor_apply() -> None:
+
+    @triton.jit
+    def axpy_kernel(Table, alpha, CHUNK_SIZE: tl.constexpr):
+        row = Table + tl.program_id(0) * 3
+        x = tl.load(row).to(tl.pointer_type(tl.float32))
+        y = tl.load(row + 1).to(tl.pointer_type(tl.float32))
+        offsets = tl.arange(0, CHUNK_SIZE)
+        mask = offsets < tl.load(row + 2)
+        tl.store(y + offsets, tl.load(y + offsets, mask=mask) + alpha * tl.load(x + offsets, mask=mask), mask=mask)
+
+    # an empty tensor, tensors smaller than a chunk and tensors of several chunks
+    shapes = [(3, ), (0, ), (1000, ), (8, 128), (4097, )]
+    xs = [torch.randn(shape, device="cuda") for shape in shapes]
+    ys = [torch.randn(shape, device="cuda") for shape in shapes]
+    expected = [y + 0.5 * x for x, y in zip(xs, ys)]
+    num_chunks = triton.runtime.multi_tensor_apply(axpy_kernel, [xs, ys], 0.5, chunk_size=512)
+    assert num_chunks == 1 + 2 + 2 + 9
+    for y, ref in zip(ys, expected):
+        torch.testing.assert_close(y, ref)
+
+    with pytest.raises(ValueError):
+        triton.runtime.multi_tensor_apply(axpy_kernel, [xs, ys[:1] + ys[2:]], 0.5)
+
+
+@pytest.mark.skipif(torch.version.hip is not None, reason="requires CUDA")
+def test_dynamic_program_ids() -> None:
+
+    @triton.jit
+    def kernel(out_ptr):
+        pid = tl.program_id(1) * tl.num_programs(0) + tl.program_id(0)
+        tl.atomic_add(out_ptr + pid, 1)
+
+    # launches on other streams, which may run concurrently, take their ids from counters of their own
+    streams = [torch.cuda.Stream() for _ in range(2)]
+    outs = [torch.zeros(4 * 256, dtype=torch.int32, device='cuda') for _ in streams]
+    for _ in range(8):
+        for stream, out in zip(streams, outs):
+            with torch.cuda.stream(stream):
+                compiled = kernel[(256, 4)](out, dynamic_program_ids=True)
+    torch.cuda.synchronize()
+    assert compiled.metadata.workspace_zeroed_size == 4
+    for out in outs:
+        assert torch.all(out == 8)
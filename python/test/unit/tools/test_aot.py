@@ -1,4 +1,5 @@
 import glob
+import json
 import os
 import subprocess
 import sys
@@ -9,6 +10,7 @@ import numpy as np
 import triton
 from triton.backends.compiler import GPUTarget
 from triton.backends.nvidia.driver import include_dir, library_dirs
+from triton.tools.tuning_table import make_tuning_table
 
 kernel_utils_src = """
 import triton
@@ -112,7 +114,7 @@ def gen_kernel_library(dir, libname):
     subprocess.run(command, check=True, cwd=dir)
 
 
-def gen_test_bin(dir, M, N, K, exe="test", algo_id=0):
+def gen_test_bin(dir, M, N, K, exe="test", algo_id=0, tuned=False):
     test_src = f"""
 int main(int argc, char **argv) {{
   int M = {M}, N = {N}, K = {K};
@@ -146,7 +148,9 @@ int main(int argc, char **argv) {{
   cuStreamSynchronize(stream);
   CUresult ret;
   int algo_id = {algo_id};
-  if (algo_id == 0) {{
+  if ({int(tuned)}) {{
+    ret = matmul_fp16_tuned(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1);
+  }} else if (algo_id == 0) {{
     ret = matmul_fp16_default(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1);
   }} else {{
     ret = matmul_fp16(stream, C, A, B, M, N, K, N, 1, K, 1, N, 1, {algo_id});
@@ -195,8 +199,9 @@ def write_triton_kernels(dir, src, util_src):
     return kernel_path
 
 
-def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps, grid, kernel_path):
+def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps, grid, kernel_path, targets=()):
     compiler_path = os.path.join(triton.tools.__path__[0], "compile.py")
+    target_args = [arg for target in targets for arg in ["--target", target]]
 
     subprocess.run(
         [
@@ -214,6 +219,7 @@ def _compile_kernel(dir, signature, kernel_name, out_name, out_path, num_warps,
             str(num_warps),
             "-g",
             grid,
+            *target_args,
             kernel_path,
         ],
         check=True,
@@ -239,7 +245,7 @@ def compile_aot_kernel_no_specialization(dir, kernel_path, dtype, BM, BN, BK):
     )
 
 
-def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints):
+def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints, targets=()):
     # compile all desired configs
     for ha in ha_hb_hints:
         for hb in ha_hb_hints:
@@ -255,15 +261,17 @@ def compile_aot_kernels(dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints):
                 num_warps=1,
                 grid=grid,
                 kernel_path=kernel_path,
+                targets=targets,
             )
 
 
-def link_aot_kernels(dir):
+def link_aot_kernels(dir, tuning_table=None):
     linker_path = os.path.join(triton.tools.__path__[0], "link.py")
+    table_args = ["--tuning-table", tuning_table] if tuning_table else []
 
     # link all desired configs
     h_files = glob.glob(os.path.join(dir, "*.h"))
-    subprocess.run([sys.executable, linker_path] + h_files + ["-o", "kernel"], check=True, cwd=dir)
+    subprocess.run([sys.executable, linker_path] + h_files + ["-o", "kernel", *table_args], check=True, cwd=dir)
 
 
 def generate_matmul_test_data(dir, M, N, K):
@@ -340,6 +348,45 @@ def test_compile_link_matmul():
         np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
 
 
+def test_compile_link_matmul_multi_target():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        # the device runs the cubin of its own capability, the other one is only embedded
+        capability = triton.runtime.driver.active.get_current_target().arch
+        other = 80 if capability != 80 else 90
+        targets = [f"cuda:{cc}" for cc in sorted({capability, other})]
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=["", ":16"], targets=targets)
+        link_aot_kernels(tmp_dir)
+        for c_file in glob.glob(os.path.join(tmp_dir, "matmul_*.c")):
+            with open(c_file) as f:
+                src = f.read()
+            assert src.count("static unsigned char") == len(targets) + 1
+
+        # compile test case
+        M, N, K = 16, 16, 16
+        gen_kernel_library(tmp_dir, "libkernel.so")
+        gen_test_bin(tmp_dir, M, N, K)
+
+        # initialize test data
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+
+        # run test case
+        env = os.environ.copy()
+        env["LD_LIBRARY_PATH"] = tmp_dir
+        subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+        # read data and compare against reference
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
+
+
 def test_launcher_has_no_available_kernel():
     np.random.seed(3)
 
@@ -424,6 +471,126 @@ def test_compile_link_autotune_matmul():
             np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=1e-4)
 
 
+def test_compile_link_tuned_matmul():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        tile_sizes = [[16, 16, 16], [64, 64, 32]]
+        for BM, BN, BK in tile_sizes:
+            compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=["", ":16"])
+
+        # small shapes run the small tiles, large shapes the large ones
+        tuned = {(16, 16): "16x16x16_warps1xstages3", (64, 64): "64x64x32_warps1xstages3"}
+        table = make_tuning_table(["M", "N"], tuned)
+        assert table["buckets"] == [[32], [32]]
+        table_path = os.path.join(tmp_dir, "table.json")
+        with open(table_path, "w") as f:
+            json.dump(table, f)
+        link_aot_kernels(tmp_dir, tuning_table=table_path)
+        with open(os.path.join(tmp_dir, "kernel.c")) as f:
+            assert "(M > 32)" in f.read()
+
+        gen_kernel_library(tmp_dir, "libkernel.so")
+        for M in [16, 64]:
+            N = K = M
+            a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+            test_name = f"test_tuned_{M}"
+            gen_test_bin(tmp_dir, M, N, K, exe=test_name, tuned=True)
+
+            env = os.environ.copy()
+            env["LD_LIBRARY_PATH"] = tmp_dir
+            subprocess.run([f"./{test_name}", a_path, b_path, c_path], check=True, cwd=tmp_dir, env=env)
+
+            # read data and compare against reference
+            c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+            c_tri = c.reshape((M, N)).view(np.float32)
+            c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+            np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=1e-4)
+
+
+def test_aot_runtime_graph_launch():
+    np.random.seed(3)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        kernel_path = write_triton_kernels(tmp_dir, kernel_src, kernel_utils_src)
+        compile_aot_kernels(tmp_dir, kernel_path, dtype, BM, BN, BK, ha_hb_hints=["", ":16"])
+        link_aot_kernels(tmp_dir)
+        gen_kernel_library(tmp_dir, "libkernel.so")
+
+        # the kernels are preloaded in the primary context, then launched twice through a graph
+        M, N, K = 16, 16, 16
+        test_src = f"""
+#include "triton_aot_runtime.h"
+
+int main(int argc, char **argv) {{
+  int M = {M}, N = {N}, K = {K};
+  CUdevice dev;
+  CUcontext ctx;
+  CUstream stream;
+  CUdeviceptr A, B, C;
+  cuInit(0);
+  cuDeviceGet(&dev, 0);
+  cuDevicePrimaryCtxRetain(&ctx, dev);
+  cuCtxSetCurrent(ctx);
+  cuMemAlloc(&A, M * K * 2);
+  cuMemAlloc(&B, K * N * 2);
+  cuMemAlloc(&C, M * N * 4);
+  cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING);
+  assert(triton::aot::preload({{load_matmul_fp16}}) == CUDA_SUCCESS);
+
+  int16_t hA[M*K];
+  int16_t hB[K*N];
+  read_csv_to_buffer(argv[1], hA, M*K);
+  read_csv_to_buffer(argv[2], hB, K*N);
+  cuMemcpyHtoD(A, hA, M*K*2);
+  cuMemcpyHtoD(B, hB, K*N*2);
+
+  triton::aot::LaunchBatch batch;
+  batch.add([&](CUstream s) {{ return matmul_fp16_default(s, C, A, B, M, N, K, N, 1, K, 1, N, 1); }});
+  for (int i = 0; i < 2; i++) {{
+    CUresult ret = batch.launch(stream);
+    if (ret != 0) fprintf(stderr, "graph launch failed\\n");
+    assert(ret == 0);
+  }}
+  cuStreamSynchronize(stream);
+
+  int32_t hC[M*N];
+  cuMemcpyDtoH(hC, C, M*N*4);
+  write_buffer_to_csv(argv[3], hC, M*N);
+  cuMemFree(A);
+  cuMemFree(B);
+  cuMemFree(C);
+  cuDevicePrimaryCtxRelease(dev);
+}}
+"""
+        with open(os.path.join(tmp_dir, "test.cc"), "w") as file:
+            file.write(test_utils_src + test_src)
+        runtime_dir = os.path.join(triton.tools.__path__[0], "runtime")
+        command = ["g++", "-std=c++17", "test.cc", os.path.join(runtime_dir, "triton_aot_runtime.cc"), "-I", runtime_dir]
+        for inc_dir in include_dir:
+            command.extend(["-I", inc_dir])
+        for lib_dir in library_dirs():
+            command.extend(["-L", lib_dir])
+        command.extend(["-l", "cuda", "-L", tmp_dir, "-l", "kernel", "-o", "test"])
+        subprocess.run(command, check=True, cwd=tmp_dir)
+
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+        env = os.environ.copy()
+        env["LD_LIBRARY_PATH"] = tmp_dir
+        subprocess.run(["./test", a_path, b_path, c_path], env=env, check=True, cwd=tmp_dir)
+
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.0)
+
+
 def test_ttgir_to_ptx():
     src = """
 module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32, "triton_gpu.num-ctas" = 1 : i32} {
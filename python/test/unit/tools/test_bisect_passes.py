@@ -0,0 +1,26 @@
+from triton.backends.compiler import BudgetedPassManager
+from triton.tools import bisect_passes
+
+
+def add_cse(pm):
+    pass
+
+
+def add_prefetch(pm):
+    pass
+
+
+def test_disabled_passes():
+    # every pass is disabled, so no pass manager is created
+    pm = BudgetedPassManager(None, disabled=("add_cse", "add_prefetch@0"))
+    pm.add(add_cse)
+    pm.add(add_prefetch)
+    pm.add(add_cse)
+    assert pm.pipeline == ["add_cse@0", "add_prefetch@0", "add_cse@1"]
+    assert pm.skipped_passes == ["add_cse", "add_prefetch", "add_cse"]
+
+
+def test_find_suspects():
+    variants = {"add_cse@0": 1.0, "add_prefetch@0": 0.8, "add_cse@1": 0.9, "add_coalesce@0": None}
+    assert bisect_passes.find_suspects(1.0, variants) == [("add_prefetch@0", 0.8), ("add_cse@1", 0.9)]
+    assert bisect_passes.find_suspects(1.0, variants, threshold=0.15) == [("add_prefetch@0", 0.8)]
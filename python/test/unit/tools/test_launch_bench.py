@@ -0,0 +1,13 @@
+import json
+
+from triton.tools import launch_bench
+
+
+def test_launch_bench(tmp_path):
+    path = tmp_path / "launch.json"
+    assert launch_bench.main(["-n", "1", "8", "--reps", "2", "--calls", "4", "-o", str(path)]) == 0
+    results = json.loads(path.read_text())
+    assert list(results["results"]) == ["1", "8"]
+    for steps in results["results"].values():
+        assert set(steps) == set(launch_bench.STEPS)
+        assert all(t >= 0 for t in steps.values())
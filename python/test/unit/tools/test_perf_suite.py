@@ -0,0 +1,30 @@
+import json
+
+import pytest
+
+from triton.tools import perf_suite
+
+
+def _results(times, device="cuda-90"):
+    return {"device": device, "results": {name: {"ms": ms} for name, ms in times.items()}}
+
+
+def test_compare():
+    baseline = _results({"a": 1.0, "b": 1.0, "c": 1.0})
+    current = _results({"a": 1.02, "b": 1.05, "c": 0.5, "d": 3.0})
+    assert perf_suite.compare(baseline, current) == {"b": (1.0, 1.05)}
+    assert perf_suite.compare(baseline, current, threshold=0.01) == {"a": (1.0, 1.02), "b": (1.0, 1.05)}
+    with pytest.raises(ValueError):
+        perf_suite.compare(baseline, _results({}, device="hip-gfx942"))
+
+
+def test_baseline(tmp_path):
+    # a case that runs on every device
+    args = ["run", "-k", "^row_sum-1024x", "--baseline-dir", str(tmp_path)]
+    assert perf_suite.main(args + ["--update-baseline", "-o", str(tmp_path / "results.json")]) == 0
+    results = json.loads((tmp_path / "results.json").read_text())
+    assert list(results["results"]) == ["row_sum-1024x65536"]
+    baseline = tmp_path / f"{results['device']}.json"
+    assert baseline.exists()
+    # against itself, nothing regresses
+    assert perf_suite.main(["compare", str(baseline), str(tmp_path / "results.json")]) == 0
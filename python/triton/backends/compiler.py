@@ -1,6 +1,7 @@
 import os
 import re
 import subprocess
+import time
 
 from abc import ABCMeta, abstractmethod, abstractclassmethod
 from dataclasses import dataclass
@@ -16,6 +17,52 @@ class GPUTarget(object):
     warp_size: int
 
 
+class BudgetedPassManager:
+    """
+    Builds a pipeline like `ir.pass_manager`, except that optional passes are skipped once `budget` seconds have been
+    spent since its creation, so that kernels that are slow to compile fall back to a cheaper pipeline. With a budget,
+    every pass is run as soon as it is added. Without one, the passes are run at once by `run`.
+
+    The passes named in `disabled` are never run. A name such as `add_cse` disables every instance of the pass, while
+    `add_cse@1` only disables its second one. `pipeline` lists the instances that were added, run or not.
+    `budget_exceeded` tells whether passes were skipped for the budget.
+    """
+
+    def __init__(self, mod, budget=None, disabled=()):
+        self.mod = mod
+        self.budget = budget
+        self.disabled = set(disabled)
+        self.start = time.time()
+        self.skipped_passes = []
+        self.budget_exceeded = False
+        self.pipeline = []
+        self.pm = None
+
+    def add(self, add_pass, *args, optional=False):
+        name = add_pass.__name__
+        instance = f"{name}@{sum(p.startswith(name + '@') for p in self.pipeline)}"
+        self.pipeline.append(instance)
+        if name in self.disabled or instance in self.disabled:
+            self.skipped_passes.append(name)
+            return
+        if self.budget is not None and optional and time.time() - self.start > self.budget:
+            self.skipped_passes.append(name)
+            self.budget_exceeded = True
+            return
+        if self.pm is None:
+            from .._C.libtriton import ir
+            self.pm = ir.pass_manager(self.mod.context)
+            self.pm.enable_debug()
+        add_pass(self.pm, *args)
+        if self.budget is not None:
+            self.run()
+
+    def run(self):
+        if self.pm is not None:
+            self.pm.run(self.mod)
+            self.pm = None
+
+
 class BaseBackend(metaclass=ABCMeta):
 
     def __init__(self, target: GPUTarget) -> None:
@@ -39,6 +86,20 @@ class BaseBackend(metaclass=ABCMeta):
                         return p, version.group(1)
         raise RuntimeError(f"Cannot find {binary}")
 
+    @staticmethod
+    def uses_grid_sync(mod) -> bool:
+        """
+        Returns whether the module syncs its grid, in which case it has to be launched cooperatively.
+        """
+        found = False
+
+        def visit(op):
+            nonlocal found
+            found = found or op.get_name() == "tt.grid_sync"
+
+        mod.walk(visit)
+        return found
+
     @abstractclassmethod
     def supports_target(target: GPUTarget):
         raise NotImplementedError
@@ -68,6 +129,14 @@ class BaseBackend(metaclass=ABCMeta):
         """
         raise NotImplementedError
 
+    def get_stage_options(self, options: object, stage: str) -> dict:
+        """
+        Returns the options that the stages up to and including `stage` depend on. The output of `stage` is cached by
+        these options, so that it is reused by the kernels which only differ in the options of the later stages.
+        Defaults to all the options.
+        """
+        return dict(options.__dict__)
+
     @abstractmethod
     def load_dialects(self, context):
         """
@@ -15,6 +15,63 @@ class DriverBase(metaclass=ABCMeta):
         pass
 
 
+class WorkspacePool(object):
+    """
+    The buffers that the launchers pass to the kernels that request workspaces, one per device and stream. A buffer is
+    reused by all the launches of its stream, which run one after the other, and grows to the largest workspace that
+    they request. The buffers handed out while the current stream is being captured are replayed by the graphs, whose
+    lifetime the pool doesn't know, so they are never released.
+    """
+
+    MIN_SIZE = 1 << 16
+
+    def __init__(self):
+        self.buffers = {}
+        # The addresses of the buffers used by captured launches, and the buffers replaced or cleared since then
+        self.captured = set()
+        self.retained = []
+
+    def get(self, stream, size):
+        """
+        Returns the address of a buffer of at least `size` bytes for the launches on `stream` of the current device.
+        """
+        return self.get_buffer(stream, size).data_ptr()
+
+    def get_buffer(self, stream, size):
+        """
+        Returns the buffer whose address `get` returns, for the launches that keep it beyond the current one.
+        """
+        import torch
+        key = (torch.cuda.current_device(), stream)
+        buffer = self.buffers.get(key)
+        capturing = torch.cuda.is_current_stream_capturing()
+        if buffer is not None and buffer.numel() >= size:
+            if capturing:
+                self.captured.add(buffer.data_ptr())
+            return buffer
+        if buffer is not None and (capturing or buffer.data_ptr() in self.captured):
+            self.retained.append(buffer)
+        # Allocated on the stream of the launches, so that the caching allocator only hands the previous buffer out
+        # again to work that is ordered after them.
+        size = max(1 << (size - 1).bit_length(), self.MIN_SIZE)
+        with torch.cuda.stream(torch.cuda.ExternalStream(stream)):
+            buffer = torch.empty(size, dtype=torch.uint8, device="cuda")
+        if capturing:
+            self.captured.add(buffer.data_ptr())
+        self.buffers[key] = buffer
+        return buffer
+
+    def clear(self):
+        """
+        Releases the buffers that no captured launch used, once the launches that use them are done.
+        """
+        self.retained.extend(buffer for buffer in self.buffers.values() if buffer.data_ptr() in self.captured)
+        self.buffers.clear()
+
+
+workspaces = WorkspacePool()
+
+
 class GPUDriver(DriverBase):
 
     def __init__(self):
@@ -28,6 +85,7 @@ class GPUDriver(DriverBase):
             self.get_current_stream = lambda idx: torch.cuda.current_stream(idx).cuda_stream
         self.get_current_device = torch.cuda.current_device
         self.set_current_device = torch.cuda.set_device
+        self.workspaces = workspaces
 
     # TODO: remove once TMA is cleaned up
     def assemble_tensormap_to_arg(self, tensormaps_info, args):
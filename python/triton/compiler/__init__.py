@@ -1,4 +1,8 @@
-from .compiler import CompiledKernel, ASTSource, compile, AttrsDescriptor, make_backend, LazyDict
+from .compiler import (CompiledKernel, ASTSource, compile, compile_async, get_compile_executor, AttrsDescriptor,
+                       make_backend, LazyDict, preload_cache_archive)
 from .errors import CompilationError
 
-__all__ = ["compile", "make_backend", "ASTSource", "AttrsDescriptor", "CompiledKernel", "CompilationError", "LazyDict"]
+__all__ = [
+    "compile", "compile_async", "get_compile_executor", "make_backend", "ASTSource", "AttrsDescriptor",
+    "CompiledKernel", "CompilationError", "LazyDict", "preload_cache_archive"
+]
@@ -234,6 +234,8 @@ class CodeGenerator(ast.NodeVisitor):
         self.is_kernel = is_kernel
         self.cur_node = None
         self.debug = options.debug if debug is None else debug
+        # recorded asserts don't trap, and are compiled without debug too
+        self.record_asserts = getattr(options, "record_asserts", False)
         self.noinline = noinline
         self.scf_stack = []
         self.ret_type = None
@@ -903,6 +905,7 @@ class CodeGenerator(ast.NodeVisitor):
                     ast.NodeVisitor.generic_visit(self, stmt)
             return
         num_stages = None
+        loop_unroll_factor = None
         if IteratorClass is language.range:
             iterator = IteratorClass(*iter_args, **iter_kwargs)
             # visit iterator arguments
@@ -912,6 +915,7 @@ class CodeGenerator(ast.NodeVisitor):
             ub = iterator.end
             step = iterator.step
             num_stages = iterator.num_stages
+            loop_unroll_factor = iterator.loop_unroll_factor
         elif IteratorClass is range:
             # visit iterator arguments
             # note: only `range` iterator is supported now
@@ -985,6 +989,8 @@ class CodeGenerator(ast.NodeVisitor):
             for_op = self.builder.create_for_op(lb, ub, step, [arg.handle for arg in init_args])
             if num_stages is not None:
                 for_op.set_attr("tt.num_stages", self.builder.get_int32_attr(num_stages))
+            if loop_unroll_factor is not None:
+                for_op.set_attr("tt.loop_unroll_factor", self.builder.get_int32_attr(loop_unroll_factor))
 
             self.scf_stack.append(node)
             self.builder.set_insertion_point_to_start(for_op.get_body(0))
@@ -1036,7 +1042,7 @@ class CodeGenerator(ast.NodeVisitor):
         return node.arg, self.visit(node.value)
 
     def visit_Assert(self, node) -> Any:
-        if not self.debug:
+        if not self.debug and not self.record_asserts:
             return
         test = self.visit(node.test)
         msg = self.visit(node.msg) if node.msg is not None else ""
@@ -1099,7 +1105,7 @@ class CodeGenerator(ast.NodeVisitor):
         kws = dict(self.visit(keyword) for keyword in node.keywords)
         args = [self.visit(arg) for arg in node.args]
         if fn is language.core.device_assert:  # TODO: this should not be so hardcoded
-            if not self.debug:
+            if not self.debug and not self.record_asserts:
                 return
         if isinstance(fn, JITFunction):
             _check_fn_args(node, fn, args)
@@ -1281,6 +1287,13 @@ def ast_to_ttir(fn, specialization, context, options, codegen_fns):
     tys = list(specialization.signature.values())
     new_constants = {k: True if k in tys and tys[k] == "i1" else 1 for k in attrs.equal_to_1}
     new_attrs = {k: [("tt.divisibility", 16)] for k in attrs.divisible_by_16}
+    for param in getattr(fn, "params", []):
+        if param.max_size is not None:
+            new_attrs.setdefault(param.num, []).append(("tt.max_size", param.max_size))
+        if param.specialization == "divisor":
+            new_attrs.setdefault(param.num, []).append(("tt.divisor", 1))
+        if param.value_range is not None:
+            new_attrs.setdefault(param.num, []).append(("tt.range", list(param.value_range)))
 
     all_constants = constants.copy()
     all_constants.update(new_constants)
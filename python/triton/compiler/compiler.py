@@ -6,8 +6,9 @@ from ..backends import backends
 from ..backends.compiler import GPUTarget
 from .. import __version__
 from ..runtime.autotuner import OutOfResources
-from ..runtime.cache import get_cache_manager, get_dump_manager, get_override_manager
+from ..runtime.cache import CacheArchive, get_cache_manager, get_dump_manager, get_override_manager
 from ..runtime.driver import driver
+from ..runtime.occupancy import compute_occupancy
 # TODO: this shouldn't be here
 from dataclasses import dataclass
 from .code_generator import ast_to_ttir
@@ -15,6 +16,11 @@ from pathlib import Path
 import re
 import functools
 import os
+import threading
+import time
+import weakref
+from collections.abc import Mapping
+from concurrent.futures import Future, ThreadPoolExecutor
 
 
 @dataclass
@@ -223,6 +229,58 @@ def filter_traceback(e: BaseException):
         e.__traceback__ = frames[0]
 
 
+# Stages whose outputs are cached on their own, see `BaseBackend.get_stage_options`
+_cached_stages = ("ttir", "ttgir")
+# With TRITON_DEDUP_KERNELS=1, the kernels whose IR of this stage is identical share the stages after it
+_dedup_stage = "llir"
+
+
+# The MLIR contexts that the compilations of each thread reuse, see `_get_context`
+_thread_contexts = threading.local()
+
+
+def _get_context(backend):
+    """
+    Returns an MLIR context with the dialects of `backend` loaded. With TRITON_CONTEXT_REUSE=<n>, every thread reuses
+    a context for `n` compilations, which skips creating it and registering the dialects. The types and attributes
+    a context uniques are only freed along with it, so that it is recreated after `n` compilations.
+    """
+    max_uses = int(os.environ.get("TRITON_CONTEXT_REUSE", "0"))
+    # the diagnostic handlers of `pass_manager.enable_debug` would pile up on a reused context
+    if max_uses <= 0 or os.environ.get("MLIR_ENABLE_DIAGNOSTICS", "0") == "1":
+        context = ir.context()
+        ir.load_dialects(context)
+        backend.load_dialects(context)
+        return context
+    if not hasattr(_thread_contexts, "contexts"):
+        _thread_contexts.contexts = dict()
+    # the backends load different dialects
+    key = type(backend)
+    context, uses = _thread_contexts.contexts.get(key, (None, 0))
+    if context is None or uses >= max_uses:
+        context = ir.context()
+        ir.load_dialects(context)
+        backend.load_dialects(context)
+        uses = 0
+    _thread_contexts.contexts[key] = (context, uses + 1)
+    return context
+
+
+def _get_occupancy(target, metadata):
+    # the occupancy on the current device, if the kernel is compiled for it
+    try:
+        if driver.active.get_current_target() != target:
+            return None
+        props = driver.active.utils.get_device_properties(driver.active.get_current_device())
+    except Exception:
+        # e.g. kernels compiled ahead of time on a machine without the device
+        return None
+    if "max_threads_per_sm" not in props:
+        return None
+    return compute_occupancy(props, metadata["num_warps"], target.warp_size, metadata.get("n_regs", 0),
+                             metadata["shared"], metadata["cluster_dims"])
+
+
 def compile(src, target=None, options=None):
     if target is None:
         target = driver.active.get_current_target()
@@ -239,21 +297,47 @@ def compile(src, target=None, options=None):
     env_vars = get_cache_invalidating_env_vars()
     key = f"{triton_key()}-{src.hash()}-{backend.hash()}-{options.hash()}-{str(sorted(env_vars.items()))}"
     hash = hashlib.sha256(key.encode("utf-8")).hexdigest()
+    always_compile = os.environ.get("TRITON_ALWAYS_COMPILE", "0") == "1"
+    # Kernels of preloaded archives skip the file system
+    archived_group = _get_archived_group(hash) if _use_cache_archives() else None
+    if archived_group is not None:
+        return CompiledKernel(src, archived_group, hash)
     fn_cache_manager = get_cache_manager(hash)
-    # For dumping/overriding only hash the source as we want it to be independent of triton
-    # core changes to make it easier to track kernels by hash.
-    enable_override = os.environ.get("TRITON_KERNEL_OVERRIDE", "0") == "1"
-    enable_ir_dump = os.environ.get("TRITON_KERNEL_DUMP", "0") == "1"
-    fn_override_manager = get_override_manager(src.hash()) if enable_override else None
-    fn_dump_manager = get_dump_manager(src.hash()) if enable_ir_dump else None
     metadata_filename = f"{src.name}.json"
     metadata_group = fn_cache_manager.get_group(metadata_filename) or {}
     metadata_path = metadata_group.get(metadata_filename)
-    always_compile = os.environ.get("TRITON_ALWAYS_COMPILE", "0") == "1"
     if not always_compile and metadata_path is not None:
         # cache hit!
-        metadata = json.loads(Path(metadata_path).read_text())
         return CompiledKernel(src, metadata_group, hash)
+    if always_compile:
+        return _compile_and_cache(src, target, backend, options, env_vars, hash, fn_cache_manager, metadata_group)
+    # Processes and threads sharing the cache directory compile every kernel once, the others wait for the first
+    # compilation and find the kernel in the cache
+    with fn_cache_manager.compile_lock():
+        metadata_group = fn_cache_manager.get_group(metadata_filename) or {}
+        if metadata_filename in metadata_group:
+            return CompiledKernel(src, metadata_group, hash)
+        # With TRITON_COMPILE_SERVER=<socket>, the stages of the backend run in the server, see `compile_server`
+        server_address = os.environ.get("TRITON_COMPILE_SERVER", "").strip()
+        if server_address and not ir_source:
+            from ..runtime.compile_server import compile_on_server
+            if compile_on_server(server_address, src, target, backend, options, hash, fn_cache_manager):
+                metadata_group = fn_cache_manager.get_group(metadata_filename) or {}
+                if metadata_filename in metadata_group:
+                    return CompiledKernel(src, metadata_group, hash)
+        return _compile_and_cache(src, target, backend, options, env_vars, hash, fn_cache_manager, metadata_group)
+
+
+def _compile_and_cache(src, target, backend, options, env_vars, hash, fn_cache_manager, metadata_group):
+    ir_source = isinstance(src, IRSource)
+    always_compile = os.environ.get("TRITON_ALWAYS_COMPILE", "0") == "1"
+    metadata_filename = f"{src.name}.json"
+    # For dumping/overriding only hash the source as we want it to be independent of triton
+    # core changes to make it easier to track kernels by hash.
+    enable_override = os.environ.get("TRITON_KERNEL_OVERRIDE", "0") == "1"
+    enable_ir_dump = os.environ.get("TRITON_KERNEL_DUMP", "0") == "1"
+    fn_override_manager = get_override_manager(src.hash()) if enable_override else None
+    fn_dump_manager = get_dump_manager(src.hash()) if enable_ir_dump else None
     # initialize metadata
     metadata = {
         "hash": hash,
@@ -261,6 +345,7 @@ def compile(src, target=None, options=None):
         **options.__dict__,
         **env_vars,
     }
+    initial_metadata = dict(metadata)
     # run compilation pipeline  and populate metadata
     stages = dict()
     backend.add_stages(stages, options)
@@ -268,20 +353,69 @@ def compile(src, target=None, options=None):
     # when the source is an IR file, don't apply the passes related to this stage. This makes it easier to write IR level tests.
     if ir_source:
         first_stage += 1
-    context = ir.context()
-    ir.load_dialects(context)
-    backend.load_dialects(context)
+    context = _get_context(backend)
     codegen_fns = backend.get_codegen_implementation()
-    try:
-        module = src.make_ir(options, codegen_fns, context)
-    except Exception as e:
-        filter_traceback(e)
-        raise
     use_ttgir_loc = os.environ.get("USE_TTGIR_LOC", "0") == "1"
+    enable_dedup = not always_compile and os.environ.get("TRITON_DEDUP_KERNELS", "0") == "1"
+    # The outputs of the MLIR stages are cached by the options they depend on, so that kernels which only differ in
+    # the options of later stages share the beginning of the pipeline. Skip them when the IR is dumped or rewritten.
+    stage_keys = dict()
+    if not (ir_source or always_compile or enable_override or enable_ir_dump or use_ttgir_loc):
+        for ext in _cached_stages:
+            if ext not in stages:
+                continue
+            stage_options = sorted(backend.get_stage_options(options, ext).items())
+            stage_key = f"{triton_key()}-{src.hash()}-{backend.hash()}-{ext}-{stage_options}-{sorted(env_vars.items())}"
+            stage_keys[ext] = hashlib.sha256(stage_key.encode("utf-8")).hexdigest()
+    stage_metadata_filename = f"{src.name}.stage.json"
+    dedup_metadata_filename = f"{src.name}.dedup.json"
+    dedup_metadata = None
+    stage_times = dict()
+    module = None
+    # resume from the last cached stage
+    for ext in reversed(list(stage_keys.keys())):
+        stage_group = get_cache_manager(stage_keys[ext]).get_group(stage_metadata_filename)
+        if stage_group is None or not {f"{src.name}.{ext}", stage_metadata_filename} <= stage_group.keys():
+            continue
+        module = parse(stage_group[f"{src.name}.{ext}"], ext, context)
+        metadata.update(json.loads(Path(stage_group[stage_metadata_filename]).read_text()))
+        for ir_filename, ir_path in stage_group.items():
+            if ir_filename != stage_metadata_filename:
+                metadata_group[ir_filename] = fn_cache_manager.put(Path(ir_path).read_text(), ir_filename)
+        first_stage = list(stages.keys()).index(ext) + 1
+        break
+    if module is None:
+        start = time.time()
+        try:
+            module = src.make_ir(options, codegen_fns, context)
+        except Exception as e:
+            filter_traceback(e)
+            raise
+        stage_times["make_ir"] = time.time() - start
     for ext, compile_ir in list(stages.items())[first_stage:]:
+        start = time.time()
         next_module = compile_ir(module, metadata)
+        stage_times[ext] = time.time() - start
         ir_filename = f"{src.name}.{ext}"
         metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
+        # a pipeline cut short by the compile time budget depends on how long the passes took, not only on the key
+        if ext in stage_keys and not metadata.get("budget_exceeded", False):
+            stage_cache_manager = get_cache_manager(stage_keys[ext])
+            # the IR of this stage and of the ones before it, along with the metadata they populated
+            stage_group = dict()
+            for prev_ext in list(stages.keys())[:list(stages.keys()).index(ext) + 1]:
+                filename = f"{src.name}.{prev_ext}"
+                if filename in metadata_group:
+                    stage_ir = Path(metadata_group[filename]).read_text()
+                    stage_group[filename] = stage_cache_manager.put(stage_ir, filename)
+            stage_metadata = {
+                k: v
+                for k, v in metadata.items()
+                if k not in initial_metadata or initial_metadata[k] != v
+            }
+            stage_group[stage_metadata_filename] = stage_cache_manager.put(json.dumps(stage_metadata, default=vars),
+                                                                           stage_metadata_filename, binary=False)
+            stage_cache_manager.put_group(stage_metadata_filename, stage_group)
         if fn_dump_manager is not None:
             fn_dump_manager.put(next_module, ir_filename)
         if (fn_override_manager is not None and fn_override_manager.has_file(ir_filename)):
@@ -294,14 +428,75 @@ def compile(src, target=None, options=None):
             next_module.create_location_snapshot(ttgir_full_name)
             print(f"Create new locations for {ttgir_full_name}")
         module = next_module
+        if enable_dedup and ext == _dedup_stage:
+            # Specializations often lower to the same IR, e.g. when a divisibility hint did not change the code
+            dedup_key = f"{triton_key()}-{backend.hash()}-{options.hash()}-{sorted(env_vars.items())}-{module}"
+            metadata["dedup_key"] = hashlib.sha256(dedup_key.encode("utf-8")).hexdigest()
+            dedup_group = get_cache_manager(metadata["dedup_key"]).get_group(dedup_metadata_filename)
+            if dedup_group is not None and dedup_metadata_filename in dedup_group:
+                metadata.update(json.loads(Path(dedup_group[dedup_metadata_filename]).read_text()))
+                for filename, path in dedup_group.items():
+                    if filename != dedup_metadata_filename:
+                        metadata_group[filename] = fn_cache_manager.put(Path(path).read_bytes(), filename)
+                break
+            dedup_metadata = dict(metadata)
+    if dedup_metadata is not None:
+        # the outputs of the stages after `_dedup_stage`, along with the metadata they populated
+        dedup_cache_manager = get_cache_manager(metadata["dedup_key"])
+        dedup_group = dict()
+        for ext in list(stages.keys())[list(stages.keys()).index(_dedup_stage) + 1:]:
+            filename = f"{src.name}.{ext}"
+            dedup_group[filename] = dedup_cache_manager.put(Path(metadata_group[filename]).read_bytes(), filename)
+        later_metadata = {k: v for k, v in metadata.items() if k not in dedup_metadata or dedup_metadata[k] != v}
+        dedup_group[dedup_metadata_filename] = dedup_cache_manager.put(json.dumps(later_metadata, default=vars),
+                                                                       dedup_metadata_filename, binary=False)
+        dedup_cache_manager.put_group(dedup_metadata_filename, dedup_group)
+    occupancy = _get_occupancy(target, metadata)
+    if occupancy is not None:
+        metadata["occupancy"] = occupancy
+    # seconds spent in the stages that were run, the ones restored from the stage cache are missing
+    metadata["stage_times"] = stage_times
     # write-back metadata
     metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata, default=vars), metadata_filename,
                                                              binary=False)
-    fn_cache_manager.put_group(metadata_filename, metadata_group)
+    # kernels that ran out of their compile time budget aren't found by later compilations, which may have the time
+    # to optimize them
+    if not metadata.get("budget_exceeded", False):
+        fn_cache_manager.put_group(metadata_filename, metadata_group)
     # return handle to compiled kernel
     return CompiledKernel(src, metadata_group, hash)
 
 
+_compile_executor = None
+_compile_executor_lock = threading.Lock()
+
+
+def get_compile_executor():
+    """
+    Returns the thread pool shared by `compile_async` and `JITFunction.warmup_async`. Its size is set by
+    TRITON_COMPILE_THREADS and defaults to the number of CPUs.
+    """
+    global _compile_executor
+    with _compile_executor_lock:
+        if _compile_executor is None:
+            num_threads = os.getenv("TRITON_COMPILE_THREADS", None)
+            num_threads = int(num_threads) if num_threads is not None else (os.cpu_count() or 1)
+            _compile_executor = ThreadPoolExecutor(max_workers=num_threads, thread_name_prefix="triton-compile")
+    return _compile_executor
+
+
+def compile_async(src, target=None, options=None) -> Future:
+    """
+    Compile `src` on the compile thread pool and return a future of the `CompiledKernel`.
+
+    The MLIR and LLVM pipelines and the translation to assembly release the GIL, and every compilation has MLIR and
+    LLVM contexts of its own, so that kernels are compiled in parallel, along with their ptxas processes.
+    """
+    if target is None:
+        target = driver.active.get_current_target()
+    return get_compile_executor().submit(compile, src, target=target, options=options)
+
+
 def make_backend(target):
     actives = [x.compiler for x in backends.values() if x.compiler.supports_target(target)]
     if len(actives) != 1:
@@ -326,6 +521,127 @@ class LazyDict:
         self.extras.append((func, args))
 
 
+# Archives registered by preload_cache_archive
+_cache_archives = []
+# Hash -> (device, handles returned by load_binary) of the archived kernels loaded so far
+_preloaded_handles = {}
+# (device, dedup key) -> handles returned by load_binary, shared by the kernels deduplicated by TRITON_DEDUP_KERNELS
+_dedup_handles = {}
+# Module -> number of the bound launches, queued launches and captured graphs that still launch its kernels
+_module_users = {}
+# Modules whose kernels were unloaded while they were still used or while the current stream was being captured
+_deferred_unloads = set()
+
+
+def _retain_module(module):
+    _module_users[module] = _module_users.get(module, 0) + 1
+
+
+def _release_module(module):
+    users = _module_users.pop(module) - 1
+    if users:
+        _module_users[module] = users
+    elif _deferred_unloads:
+        _unload_deferred_modules()
+
+
+def _unload_deferred_modules():
+    if not hasattr(driver.active.utils, "unload_binary"):
+        _deferred_unloads.clear()
+        return
+    stream = driver.active.get_current_stream(driver.active.get_current_device())
+    for module in list(_deferred_unloads):
+        if module in _module_users:
+            continue
+        _deferred_unloads.discard(module)
+        if not driver.active.utils.unload_binary(module, stream):
+            # the stream is being captured, the modules are unloaded by a later unload or release
+            _deferred_unloads.add(module)
+            return
+
+
+def _read_cache_file(file, binary):
+    # Files of cache archives are views of the archive
+    if isinstance(file, memoryview):
+        return bytes(file) if binary else str(file, "utf-8")
+    return Path(file).read_bytes() if binary else Path(file).read_text()
+
+
+def _use_cache_archives():
+    # The kernels that are always compiled, or whose IR is dumped or overridden, don't come from archives
+    return not any(
+        os.environ.get(var, "0") == "1"
+        for var in ("TRITON_ALWAYS_COMPILE", "TRITON_KERNEL_OVERRIDE", "TRITON_KERNEL_DUMP"))
+
+
+def _get_archived_group(hash):
+    for archive in _cache_archives:
+        group = archive.get_group(hash)
+        if group is not None:
+            return group
+    return None
+
+
+def preload_cache_archive(path, background=True):
+    """
+    Register a cache archive built by `triton.runtime.cache.build_cache_archive`, whose kernels are then compiled
+    without reading the cache directory, and load the binaries of its kernels for the current target and device.
+
+    :param background: Load the binaries on a background thread, which is returned. Kernels launched before their
+        binary is loaded load it themselves.
+    """
+    archive = CacheArchive(path)
+    _cache_archives.append(archive)
+    device = driver.active.get_current_device()
+    target = driver.active.get_current_target()
+    binary_ext = make_backend(target).binary_ext
+
+    def load():
+        # The current device is per thread
+        driver.active.set_current_device(device)
+        max_shared = driver.active.utils.get_device_properties(device)["max_shared_mem"]
+        for key in archive.keys():
+            group = archive.get_group(key)
+            metadata_file = next((c for c in group if c.endswith(".json")), None)
+            binary_file = next((c for c in group if c.endswith(f".{binary_ext}")), None)
+            if metadata_file is None or binary_file is None:
+                continue
+            metadata = json.loads(_read_cache_file(group[metadata_file], binary=False))
+            # Kernels that don't fit raise OutOfResources when they are launched
+            if GPUTarget(**metadata["target"]) != target or metadata["shared"] > max_shared:
+                continue
+            binary = _read_cache_file(group[binary_file], binary=True)
+            handles = driver.active.utils.load_binary(metadata["name"], binary, metadata["shared"], device)
+            _preloaded_handles[key] = (device, handles)
+
+    if not background:
+        load()
+        return None
+    thread = threading.Thread(target=load, name="triton-preload", daemon=True)
+    thread.start()
+    return thread
+
+
+class _AsmFiles(Mapping):
+    """
+    The text of each level of IR of a kernel, read from its cache files when it is looked up rather than kept in
+    memory for the lifetime of the kernel.
+    """
+
+    def __init__(self, files, binary_ext):
+        self.files = files
+        self.binary_ext = binary_ext
+
+    def __getitem__(self, ext):
+        return _read_cache_file(self.files[ext], binary=ext == self.binary_ext)
+
+    def __iter__(self):
+        return iter(self.files)
+
+    def __len__(self):
+        return len(self.files)
+
+
 class CompiledKernel:
 
     # Hooks for external tools to monitor the execution of triton kernels
@@ -335,8 +651,8 @@ class CompiledKernel:
 
     def __init__(self, src, metadata_group, hash):
         from collections import namedtuple
-        metadata_path = next((Path(p) for c, p in metadata_group.items() if c.endswith(".json")))
-        metadata = json.loads(metadata_path.read_text())
+        metadata_file = next((p for c, p in metadata_group.items() if c.endswith(".json")))
+        metadata = json.loads(_read_cache_file(metadata_file, binary=False))
         metadata['cluster_dims'] = tuple(metadata['cluster_dims'])
         # JSON serialization dumps the target as a dict. Restore it to a GPUTarget.
         target = metadata['target']
@@ -348,33 +664,65 @@ class CompiledKernel:
         self.src = src
         self.hash = hash
         self.name = self.metadata.name
-        # stores the text of each level of IR that was generated during compilation
-        asm_files = [Path(p) for c, p in metadata_group.items() if not c.endswith(".json")]
+        # the text of each level of IR that was generated during compilation, read on demand
+        asm_files = {Path(c).suffix[1:]: p for c, p in metadata_group.items() if not c.endswith(".json")}
         binary_ext = backend.binary_ext
-        self.asm = {
-            file.suffix[1:]: file.read_bytes() if file.suffix[1:] == binary_ext else file.read_text()
-            for file in asm_files
-        }
+        self.asm = _AsmFiles(asm_files, binary_ext)
         self.kernel = self.asm[binary_ext]
         # binaries are lazily initialized
         # because it involves doing runtime things
         # (e.g., checking amount of shared memory on current device)
         self.module = None
         self.function = None
+        # whether the module is this kernel's own, rather than shared with the kernels of a preloaded archive or
+        # deduplicated by TRITON_DEDUP_KERNELS
+        self._owns_module = False
 
     def _init_handles(self):
         if self.module is not None:
             return
         device = driver.active.get_current_device()
         # create launcher
-        self.run = driver.active.launcher_cls(self.src, self.metadata)
+        if self.__dict__.get("run") is None:
+            self.run = driver.active.launcher_cls(self.src, self.metadata)
         # not enough shared memory to run the kernel
         max_shared = driver.active.utils.get_device_properties(device)["max_shared_mem"]
         if self.metadata.shared > max_shared:
             raise OutOfResources(self.metadata.shared, max_shared, "shared memory")
-        # TODO: n_regs, n_spills should be metadata generated when calling `ptxas`
+        preloaded = _preloaded_handles.get(self.hash, None) if _use_cache_archives() else None
+        if preloaded is not None and preloaded[0] == device:
+            self.module, self.function, self.n_regs, self.n_spills = preloaded[1]
+            return
+        dedup_key = getattr(self.metadata, "dedup_key", None)
+        if dedup_key is not None and (device, dedup_key) in _dedup_handles:
+            self.module, self.function, self.n_regs, self.n_spills = _dedup_handles[(device, dedup_key)]
+            return
+        # the assembler reports n_regs and n_spills in the metadata too, these are the ones the driver allocates
         self.module, self.function, self.n_regs, self.n_spills = driver.active.utils.load_binary(
             self.name, self.kernel, self.metadata.shared, device)
+        if dedup_key is not None:
+            _dedup_handles[(device, dedup_key)] = (self.module, self.function, self.n_regs, self.n_spills)
+        else:
+            self._owns_module = True
+
+    def unload(self):
+        """
+        Unloads the module of the kernel from the device, once the kernels in flight are done. The kernel loads it
+        again if it is launched later. Modules shared with other kernels are left loaded. The module stays loaded as
+        long as bound launches, queued launches or captured graphs of the kernel are alive, and while the current
+        stream is being captured, and is unloaded by the first unload or release after that. The modules of kernels
+        launched while their stream was being captured are never unloaded, since the graphs may still run them.
+        """
+        if self.module is None:
+            return
+        launcher = self.__dict__.get("run")
+        captured = getattr(launcher, "captured_functions", None)
+        if self._owns_module and not (captured is not None and self.function in captured()):
+            _deferred_unloads.add(self.module)
+            _unload_deferred_modules()
+        self.module = None
+        self.function = None
+        self._owns_module = False
 
     def __getattribute__(self, name):
         if name == 'run':
@@ -385,6 +733,9 @@ class CompiledKernel:
         if CompiledKernel.launch_enter_hook is None:
             return None
         ret = LazyDict({"name": self.name, "function": self.function, "stream": stream})
+        occupancy = getattr(self.metadata, "occupancy", None)
+        if occupancy is not None:
+            ret.data["occupancy"] = occupancy
         if not isinstance(self.src, ASTSource) or self.src.fn.launch_metadata is None:
             return ret
         arg_dict = {}
@@ -410,3 +761,25 @@ class CompiledKernel:
                      CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, *args)
 
         return runner
+
+    def bind(self, grid, *args, stream=None):
+        """
+        Resolves the grid, the metadata and the arguments of a launch once, for loops that launch the kernel with the
+        same shapes again and again. Returns a handle that launches the kernel on `stream`, the current stream by
+        default, with a single native call, and whose :code:`set_arg(index, value)` replaces the argument at `index`
+        in place, e.g. the pointers that change from one iteration to the next. The arguments are the ones of
+        :code:`kernel[grid](*args)`. Bound launches don't call the launch hooks, which makes them cheap to capture
+        in CUDA graphs too.
+        """
+        self._init_handles()
+        if not hasattr(self.run, "bind"):
+            raise NotImplementedError(f"the launcher of {self.metadata.target.backend} doesn't bind launches")
+        if stream is None:
+            device = driver.active.get_current_device()
+            stream = driver.active.get_current_stream(device)
+        grid = tuple(grid) + (1, ) * (3 - len(grid))
+        bound = self.run.bind(grid, stream, self.function, self.packed_metadata, args)
+        # the module can't be unloaded while the handle launches its kernel
+        _retain_module(self.module)
+        weakref.finalize(bound, _release_module, self.module)
+        return bound
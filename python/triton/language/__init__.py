@@ -16,7 +16,6 @@ from .standard import (
     ravel,
     sigmoid,
     softmax,
-    sort,
     sum,
     swizzle2d,
     xor_sum,
@@ -46,6 +45,7 @@ from .core import (
     cat,
     cast,
     clamp,
+    cluster_reduce,
     const,
     const_pointer_type,
     constexpr,
@@ -53,6 +53,7 @@ from .core import (
     device_assert,
     device_print,
     dot,
+    dot_scaled,
     dtype,
     expand_dims,
     float16,
@@ -65,6 +66,10 @@ from .core import (
     float8e5b16,
     full,
     function_type,
+    gather,
+    grid_sync,
+    griddep_launch_dependents,
+    griddep_wait,
     histogram,
     inline_asm_elementwise,
     int1,
@@ -88,20 +93,30 @@ from .core import (
     range,
     reduce,
     reshape,
+    segmented_reduce,
+    segmented_scan,
+    signal,
+    signal_wait,
+    sort,
+    sparse_dot,
     split,
     static_assert,
     static_print,
     static_range,
     store,
     tensor,
+    topk,
     trans,
     uint16,
     uint32,
     uint64,
     uint8,
+    unlikely,
+    unpack,
     view,
     void,
     where,
+    workspace,
 )
 from .math import (umulhi, exp, exp2, fma, log, log2, cos, rsqrt, sin, sqrt, sqrt_rn, abs, fdiv, div_rn, erf, floor,
                    ceil)
@@ -147,6 +162,7 @@ __all__ = [
     "cdiv",
     "ceil",
     "clamp",
+    "cluster_reduce",
     "const",
     "const_pointer_type",
     "constexpr",
@@ -158,6 +174,7 @@ __all__ = [
     "device_print",
     "div_rn",
     "dot",
+    "dot_scaled",
     "dtype",
     "erf",
     "exp",
@@ -178,6 +195,10 @@ __all__ = [
     "fma",
     "full",
     "function_type",
+    "gather",
+    "grid_sync",
+    "griddep_launch_dependents",
+    "griddep_wait",
     "histogram",
     "inline_asm_elementwise",
     "interleave",
@@ -219,10 +240,15 @@ __all__ = [
     "reduce",
     "reshape",
     "rsqrt",
+    "segmented_reduce",
+    "segmented_scan",
     "sigmoid",
+    "signal",
+    "signal_wait",
     "sin",
     "softmax",
     "sort",
+    "sparse_dot",
     "split",
     "sqrt",
     "sqrt_rn",
@@ -233,6 +259,7 @@ __all__ = [
     "sum",
     "swizzle2d",
     "tensor",
+    "topk",
     "trans",
     "triton",
     "uint16",
@@ -241,9 +268,12 @@ __all__ = [
     "uint8",
     "uint_to_uniform_float",
     "umulhi",
+    "unlikely",
+    "unpack",
     "view",
     "void",
     "where",
+    "workspace",
     "xor_sum",
     "zeros",
     "zeros_like",
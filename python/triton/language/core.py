@@ -994,7 +994,8 @@ class tensor:
         assert False, "Transposition must be created by the AST Visitor"
 
     @builtin
-    def to(self, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcast: bool = False, _builder=None):
+    def to(self, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcast: bool = False, rbits=None,
+           _builder=None):
         """
         Alias for :py:func:`tensor.cast`.
         """
@@ -1004,7 +1005,9 @@ class tensor:
         bitcast = _unwrap_if_constexpr(bitcast)
         if bitcast:
             return semantic.bitcast(self, dtype, _builder)
-        return semantic.cast(self, dtype, _builder, fp_downcast_rounding)
+        if rbits is not None:
+            rbits = _to_tensor(rbits, _builder)
+        return semantic.cast(self, dtype, _builder, fp_downcast_rounding, rbits)
 
     # Type stubs for functions added by the _tensor_member_fn decorator.
     # (Unfortunately these can't be created automatically.)
@@ -1134,9 +1137,15 @@ class tensor:
     def sort(self, dim: constexpr = None, descending: constexpr = CONSTEXPR_0) -> tensor:
         ...
 
+    def topk(self, k: constexpr, dim: constexpr = None, return_indices: constexpr = False) -> tensor:
+        ...
+
     def flip(self, dim=None) -> tensor:
         ...
 
+    def gather(self, index, axis) -> tensor:
+        ...
+
 
 def get_bool_env_var(var_name):
     v = os.getenv(var_name, "0")
@@ -1491,7 +1500,8 @@ def expand_dims(input, axis, _builder=None):
 
 @_tensor_member_fn
 @builtin
-def cast(input, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcast: bool = False, _builder=None):
+def cast(input, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcast: bool = False, rbits=None,
+         _builder=None):
     """
     Casts a tensor to the given :code:`dtype`.
 
@@ -1500,16 +1510,52 @@ def cast(input, dtype: dtype, fp_downcast_rounding: Optional[str] = None, bitcas
         floating-point values.  This parameter is only used when self is a
         floating-point tensor and dtype is a floating-point type with a
         smaller bitwidth. Supported values are :code:`"rtne"` (round to
-        nearest, ties to even) and :code:`"rtz"` (round towards zero).
+        nearest, ties to even), :code:`"rtz"` (round towards zero) and
+        :code:`"rs"` (stochastic rounding, from float32, float16 and
+        bfloat16).
     :param bitcast: If true, the tensor is bitcasted to the given
         :code:`dtype`, instead of being numerically casted.
+    :param rbits: The uniformly random 32-bit integers, e.g. from
+        :code:`randint`, that stochastic rounding uses for each element.
     """
     input = _to_tensor(input, _builder)
     if isinstance(bitcast, constexpr):
         bitcast = bitcast.value
     if bitcast:
         return semantic.bitcast(input, dtype, _builder)
-    return semantic.cast(input, dtype, _builder, fp_downcast_rounding)
+    if rbits is not None:
+        rbits = _to_tensor(rbits, _builder)
+    return semantic.cast(input, dtype, _builder, fp_downcast_rounding, rbits)
+
+
+@_tensor_member_fn
+@builtin
+def unpack(input, format, axis=-1, dtype=float16, _builder=None):
+    """
+    Unpacks the two 4-bit elements held in each byte of :code:`input`, the
+    lower nibble first, and converts them to :code:`dtype`. The :code:`axis`
+    dimension of the result is twice that of :code:`input`.
+
+    The bytes are kept packed, eight elements in 32 bits, until they are
+    converted, so e.g. int4 weights take half the registers of the int8
+    tensors they would otherwise be loaded as.
+
+    :param input: The packed elements.
+    :type input: Block of int8 or uint8
+    :param format: The type of the packed elements.
+    :type format: str, one of :code:`"int4"`, :code:`"uint4"` or :code:`"e2m1"`
+    :param axis: The dimension along which the elements of a byte are next to
+        each other.
+    :type axis: int
+    :param dtype: The element type of the result, :code:`float16`,
+        :code:`bfloat16` or :code:`float32`, or :code:`int8` for integers.
+    :type dtype: dtype
+    """
+    input = _to_tensor(input, _builder)
+    format = _constexpr_to_value(format)
+    axis = _constexpr_to_value(axis)
+    dtype = _constexpr_to_value(dtype)
+    return semantic.unpack(input, format, axis, dtype, _builder)
 
 
 # -----------------------
@@ -1536,11 +1582,20 @@ def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_i
     :param input_precision: How to exercise the Tensor Cores for f32 x f32. If
       the device does not have Tensor Cores or the inputs are not of dtype f32,
       this option is ignored. For devices that do have tensor cores, the
-      default precision is tf32.
-    :type input_precision: string. Available options for nvidia: :code:`"tf32"`, :code:`"tf32x3"`, :code:`"ieee"`. Default: :code:`"tf32"`. Avaliable options for amd: :code:`"ieee"`.
+      default precision is tf32. :code:`"tf32x3"` and :code:`"bf16x3"`,
+      :code:`"bf16x6"`, :code:`"bf16x9"` split the inputs in several tf32 or
+      bf16 terms and sum the dots of the terms, which trades throughput for
+      accuracy: bf16x9 is about as accurate as ieee.
+    :type input_precision: string. Available options for nvidia: :code:`"tf32"`, :code:`"tf32x3"`, :code:`"bf16x3"`, :code:`"bf16x6"`, :code:`"bf16x9"`, :code:`"ieee"`. Default: :code:`"tf32"`. Avaliable options for amd: :code:`"bf16x3"`, :code:`"bf16x6"`, :code:`"bf16x9"`, :code:`"ieee"`.
     :param allow_tf32: *Deprecated.* If true, input_precision is set to "tf32".
       Only one of :code:`input_precision` and :code:`allow_tf32` can be
       specified (i.e. at least one must be :code:`None`).
+    :param out_dtype: The dtype the products are accumulated in, for
+      :code:`float16` and :code:`float8` inputs. :code:`float16` accumulation
+      has twice the throughput of :code:`float32` on some GPUs. A
+      :code:`float32` acc is then accumulated in :code:`float16` and the
+      result is returned as :code:`float32`.
+    :type out_dtype: :code:`float32` or :code:`float16`. Default: :code:`float32`.
     """
     assert input_precision is None or allow_tf32 is None, "Only one of input_precision and allow_tf32 can be specified"
     if input_precision is None:
@@ -1554,6 +1609,64 @@ def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_i
     return semantic.dot(input, other, acc, input_precision, max_num_imprecise_acc, out_dtype, _builder)
 
 
+@builtin
+def dot_scaled(lhs, lhs_scale, lhs_format, rhs, rhs_scale, rhs_format, acc=None, out_dtype=float32, _builder=None):
+    """
+    Returns the matrix product of two blocks in microscaling formats.
+
+    Each operand is given in :code:`lhs_format`/:code:`rhs_format` with a
+    shared exponent per block of 32 elements along K. The scales are
+    :code:`uint8` e8m0 exponents of shape :code:`(M, K // 32)` for
+    :code:`lhs` and :code:`(N, K // 32)` for :code:`rhs`.
+
+    :param lhs: The first tensor to be multiplied. :code:`"e2m1"` values are
+      packed two per byte along K, low nibble first, so :code:`lhs` is
+      :code:`(M, K // 2)`.
+    :type lhs: 2D tensor of :code:`float8_e4m3fn`, :code:`float8_e5m2`, :code:`uint8` or :code:`bfloat16`
+    :param lhs_scale: The scales of :code:`lhs`, or None for :code:`"bf16"`.
+    :type lhs_scale: 2D tensor of :code:`uint8`
+    :param lhs_format: The format of :code:`lhs`.
+    :type lhs_format: str, one of :code:`"e4m3"`, :code:`"e5m2"`, :code:`"e2m1"`, :code:`"bf16"`
+    :param rhs: The second tensor to be multiplied, packed along K like :code:`lhs`.
+    :type rhs: 2D tensor of :code:`float8_e4m3fn`, :code:`float8_e5m2`, :code:`uint8` or :code:`bfloat16`
+    :param rhs_scale: The scales of :code:`rhs`, or None for :code:`"bf16"`.
+    :type rhs_scale: 2D tensor of :code:`uint8`
+    :param rhs_format: The format of :code:`rhs`.
+    :type rhs_format: str, one of :code:`"e4m3"`, :code:`"e5m2"`, :code:`"e2m1"`, :code:`"bf16"`
+    :param acc: The accumulator tensor. If not None, the result is added to this tensor.
+    :type acc: 2D tensor of :code:`float32`
+    """
+    out_dtype = _constexpr_to_value(out_dtype)
+    assert out_dtype == float32, "Only float32 is supported for out_dtype at the moment"
+    lhs_format = _constexpr_to_value(lhs_format)
+    rhs_format = _constexpr_to_value(rhs_format)
+    return semantic.dot_scaled(lhs, lhs_scale, lhs_format, rhs, rhs_scale, rhs_format, acc, out_dtype, _builder)
+
+
+@builtin
+def sparse_dot(input, input_meta, other, acc=None, _builder=None):
+    """
+    Returns the matrix product of a 2:4 structured-sparse block and a dense
+    block, on the sparse tensor cores of sm_80 and later.
+
+    Every group of four consecutive elements along K of the sparse operand
+    holds at most two non-zero values. :code:`input` holds these two values
+    of every group, so it is :code:`(M, K // 2)`, and :code:`input_meta` their
+    2-bit indices within the group: each :code:`int16` covers four groups,
+    i.e. 16 columns, starting from the low bits, so it is :code:`(M, K // 16)`.
+
+    :param input: The compressed values of the sparse operand.
+    :type input: 2D tensor of :code:`float16` or :code:`bfloat16`
+    :param input_meta: The metadata of the sparse operand.
+    :type input_meta: 2D tensor of :code:`int16`
+    :param other: The dense operand, of shape :code:`(K, N)` with K a multiple of 32.
+    :type other: 2D tensor of the dtype of :code:`input`
+    :param acc: The accumulator tensor. If not None, the result is added to this tensor.
+    :type acc: 2D tensor of :code:`float32`
+    """
+    return semantic.sparse_dot(input, input_meta, other, acc, _builder)
+
+
 # -----------------------
 # Non-Atomic Memory Operations
 # -----------------------
@@ -1561,7 +1674,7 @@ def dot(input, other, acc=None, input_precision=None, allow_tf32=None, max_num_i
 
 @builtin
 def load(pointer, mask=None, other=None, boundary_check=(), padding_option="", cache_modifier="", eviction_policy="",
-         volatile=False, _builder=None):
+         volatile=False, num_stages=None, _builder=None):
     """
     Return a tensor of data whose values are loaded from memory at location defined by `pointer`:
 
@@ -1604,6 +1717,9 @@ def load(pointer, mask=None, other=None, boundary_check=(), padding_option="", c
     :type eviction_policy: str, optional
     :param volatile: changes volatile option in NVIDIA PTX
     :type volatile: bool, optional
+    :param num_stages: the number of stages to pipeline this load with in a loop, at most the number of stages of the
+        loop. A value of 1 keeps the load from being pipelined, which saves its shared memory buffers.
+    :type num_stages: int, optional
     """
     # `mask` and `other` can be constexpr
     mask = _constexpr_to_value(mask)
@@ -1616,31 +1732,39 @@ def load(pointer, mask=None, other=None, boundary_check=(), padding_option="", c
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
     volatile = _constexpr_to_value(volatile)
+    num_stages = _constexpr_to_value(num_stages)
     return semantic.load(pointer, mask, other, boundary_check, padding_option, cache_modifier, eviction_policy,
-                         volatile, _builder)
+                         volatile, num_stages, _builder)
 
 
 @builtin
-def _experimental_descriptor_load(desc_pointer, offsets, shape, dtype, _builder=None):
+def _experimental_descriptor_load(desc_pointer, offsets, shape, dtype, im2col_offsets=None, _builder=None):
     """
     Experimental feature to access TMA descriptors loads. This is an escape hatch to easily exercise TTGIR operations.
     This will be removed in the future and shouldn't be used in production code.
 
-    This loads a tensor of data based on the descriptor and offsets.
+    This loads a tensor of data based on the descriptor and offsets. Descriptors of up to 5 dims are supported. With
+    :code:`im2col_offsets`, the descriptor must be an im2col one and the load gathers a 2D block of pixels by
+    channels, with one 16 bit offset per spatial dim.
     """
     type = block_type(dtype, shape)
-    return semantic.descriptor_load(desc_pointer, offsets, "", "", type, _builder)
+    return semantic.descriptor_load(desc_pointer, offsets, "", "", type, _builder, im2col_offsets)
 
 
 @builtin
-def _experimental_descriptor_store(desc_pointer, value, offsets, _builder=None):
+def _experimental_descriptor_store(desc_pointer, value, offsets, reduce=None, _builder=None):
     """
     Experimental feature to access TMA descriptors stores. This is an escape hatch to easily exercise TTGIR operations.
     This will be removed in the future and shouldn't be used in production code.
 
-    This stores a tensor of data based on the descriptor and offsets.
+    This stores a tensor of data based on the descriptor and offsets. With :code:`reduce` set to one of
+    :code:`"add"`, :code:`"min"`, :code:`"max"`, :code:`"and"`, :code:`"or"` or :code:`"xor"`, the tensor is instead
+    combined element-wise with the data in memory by the TMA unit, atomically per element, e.g. to accumulate the
+    partial results of split-K matmuls. The elements are combined as the element type of the descriptor, which must
+    be created with the type of :code:`value`, e.g. :code:`fill_2d_tma_descriptor(..., "fp32")`.
     """
-    return semantic.descriptor_store(desc_pointer, value, offsets, _builder)
+    reduce = _constexpr_to_value(reduce)
+    return semantic.descriptor_store(desc_pointer, value, offsets, _builder, reduce)
 
 
 @_tensor_member_fn
@@ -1845,6 +1969,50 @@ def atomic_xor(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     return semantic.atomic_xor(pointer, val, mask, sem, scope, _builder)
 
 
+@builtin
+def signal(pointer, value, op="set", scope="sys", _builder=None):
+    """
+    Sets the int32 flag at :code:`pointer` to :code:`value`, or adds :code:`value` to it, after all the stores of the
+    program so far. The programs that wait for the flag with :code:`signal_wait` then see these stores. With the
+    default system scope the flag and the stores may be in the memory of a peer device, mapped with
+    :code:`triton.runtime.driver.active.utils.enable_peer_access`, so that kernels on several devices can exchange
+    partial results over NVLink or xGMI while they compute.
+
+    :param pointer: a pointer to the flag
+    :type pointer: pointer to int32
+    :param value: the value to set the flag to, or to add to it
+    :param op: :code:`"set"` or :code:`"add"`
+    :type op: str
+    :param scope: the scope of the programs that wait for the flag, one of :code:`"cta"`, :code:`"gpu"` and :code:`"sys"`
+    :type scope: str
+    """
+    value = _to_tensor(value, _builder)
+    op = _constexpr_to_value(op)
+    scope = _constexpr_to_value(scope)
+    return semantic.signal(pointer, value, op, scope, _builder)
+
+
+@builtin
+def signal_wait(pointer, value, cmp="ge", scope="sys", _builder=None):
+    """
+    Waits until the int32 flag at :code:`pointer` compares to :code:`value` with :code:`cmp`, as unsigned integers.
+    The loads of the program after the wait see the stores that the programs released with :code:`signal` before
+    updating the flag.
+
+    :param pointer: a pointer to the flag
+    :type pointer: pointer to int32
+    :param value: the value to compare the flag to
+    :param cmp: one of :code:`"eq"`, :code:`"ne"` and :code:`"ge"`
+    :type cmp: str
+    :param scope: the scope of the programs that signal the flag, one of :code:`"cta"`, :code:`"gpu"` and :code:`"sys"`
+    :type scope: str
+    """
+    value = _to_tensor(value, _builder)
+    cmp = _constexpr_to_value(cmp)
+    scope = _constexpr_to_value(scope)
+    return semantic.signal_wait(pointer, value, cmp, scope, _builder)
+
+
 # -----------------------
 # Conditioning
 # -----------------------
@@ -2132,6 +2300,111 @@ def associative_scan(input, axis, combine_fn, reverse=False, _builder=None, _gen
     return semantic.associative_scan(input, axis, make_combine_region, reverse, _builder)
 
 
+def _segment_flags(flags, shape, _builder):
+    flags = _to_tensor(flags, _builder)
+    if not flags.dtype.is_int1():
+        flags = semantic.not_equal(flags, _to_tensor(0, _builder), _builder)
+    return semantic.broadcast_impl_shape(flags, shape, _builder)
+
+
+@builtin
+def segmented_scan(input, flags, axis, combine_fn, reverse=False, _builder=None, _generator=None):
+    """Like :code:`associative_scan`, but restarts the scan at the elements where :code:`flags` is true, so that
+    each segment of packed ragged sequences is scanned on its own.
+
+    :param input: the input tensor, or tuple of tensors
+    :type input: Tensor
+    :param flags: true at the first element of each segment in the scan order, i.e. at the last element of each
+        segment in memory when :code:`reverse` is true
+    :type flags: Tensor
+    :param axis: the dimension along which the scan should be done
+    :type axis: int
+    :param combine_fn: a function to combine two groups of scalar tensors (must be marked with @triton.jit)
+    :type combine_fn: Callable
+    :param reverse: whether to apply the scan in the reverse direction along axis
+    :type reverse: bool
+
+    """
+    if isinstance(input, tensor):
+        return segmented_scan((input, ), flags, axis, combine_fn, reverse, _builder=_builder,
+                              _generator=_generator)[0]
+    flags = _segment_flags(flags, input[0].shape, _builder)
+    n = len(input)
+
+    # (start_a, a) + (start_b, b) = (start_a | start_b, b if start_b else a + b)
+    def make_combine_region(scan_op):
+        in_scalar_tys = [int1] + [t.type.scalar for t in input]
+        prototype = function_type(in_scalar_tys, in_scalar_tys * 2)
+
+        region = scan_op.get_region(0)
+        with _insertion_guard(_builder):
+            param_types = [ty.to_ir(_builder) for ty in prototype.param_types]
+            block = _builder.create_block_with_parent(region, param_types)
+            args = [tensor(block.arg(i), ty) for i, ty in enumerate(prototype.param_types)]
+            start_a, a, start_b, b = args[0], args[1:n + 1], args[n + 1], args[n + 2:]
+            results = _generator.call_JitFunction(combine_fn, a + b, kwargs={})
+            if isinstance(results, tensor):
+                results = [results]
+            handles = [semantic.or_(start_a, start_b, _builder).handle]
+            handles += [semantic.where(start_b, y, r, _builder).handle for y, r in zip(b, results)]
+            _builder.create_scan_ret(*handles)
+
+    axis = _constexpr_to_value(axis)
+    if axis is not None:
+        axis = _wrap_axis(axis, len(input[0].shape))
+    reverse = _constexpr_to_value(reverse)
+    return semantic.associative_scan((flags, ) + tuple(input), axis, make_combine_region, reverse, _builder)[1:]
+
+
+@builtin
+def segmented_reduce(input, flags, axis, combine_fn, _builder=None, _generator=None):
+    """Reduces each segment of :code:`input` along the provided :code:`axis`, where :code:`flags` is true at the
+    first element of each segment, e.g. the sequences of a packed ragged batch. Unlike :code:`reduce`, the result
+    keeps the shape of the input and holds at every element the reduction of its segment.
+
+    :param input: the input tensor, or tuple of tensors
+    :type input: Tensor
+    :param flags: true at the first element of each segment
+    :type flags: Tensor
+    :param axis: the dimension along which the reduction should be done
+    :type axis: int
+    :param combine_fn: a function to combine two groups of scalar tensors (must be marked with @triton.jit)
+    :type combine_fn: Callable
+
+    """
+    if isinstance(input, tensor):
+        return segmented_reduce((input, ), flags, axis, combine_fn, _builder=_builder, _generator=_generator)[0]
+    flags = _segment_flags(flags, input[0].shape, _builder)
+    prefixes = segmented_scan(tuple(input), flags, axis, combine_fn, _builder=_builder, _generator=_generator)
+    n = len(input)
+
+    # The reverse scan then carries the prefix at the end of each segment back to its start. It combines the
+    # summaries of adjacent ranges, the right one first: whether the range starts a segment, whether a segment
+    # starts after its first element, and the prefix at the end of the segment of its first element.
+    def make_combine_region(scan_op):
+        in_scalar_tys = [int1, int1] + [t.type.scalar for t in input]
+        prototype = function_type(in_scalar_tys, in_scalar_tys * 2)
+
+        region = scan_op.get_region(0)
+        with _insertion_guard(_builder):
+            param_types = [ty.to_ir(_builder) for ty in prototype.param_types]
+            block = _builder.create_block_with_parent(region, param_types)
+            args = [tensor(block.arg(i), ty) for i, ty in enumerate(prototype.param_types)]
+            right, left = args[:n + 2], args[n + 2:]
+            # the segment of the left range ends within it
+            ends = semantic.or_(left[1], right[0], _builder)
+            handles = [left[0].handle, semantic.or_(ends, right[1], _builder).handle]
+            handles += [semantic.where(ends, l, r, _builder).handle for l, r in zip(left[2:], right[2:])]
+            _builder.create_scan_ret(*handles)
+
+    axis = _constexpr_to_value(axis)
+    if axis is not None:
+        axis = _wrap_axis(axis, len(input[0].shape))
+    no_starts = semantic.full(input[0].shape, 0, int1, _builder)
+    return semantic.associative_scan((flags, no_starts) + tuple(prefixes), axis, make_combine_region, True,
+                                     _builder)[2:]
+
+
 @_tensor_member_fn
 @builtin
 def histogram(input, num_bins, _builder=None, _generator=None):
@@ -2147,6 +2420,98 @@ def histogram(input, num_bins, _builder=None, _generator=None):
     return semantic.histogram(input, num_bins, _builder)
 
 
+def _check_sort_dim(x, dim):
+    dim = _constexpr_to_value(dim)
+    if dim is None:
+        return
+    if dim < 0:
+        dim += len(x.shape)
+    assert dim == len(x.shape) - 1, "only minor dimension is currently supported"
+
+
+@_tensor_member_fn
+@builtin
+def sort(x, dim: constexpr = None, descending: constexpr = CONSTEXPR_0, _builder=None):
+    """
+    Sorts a tensor along a specified dimension.
+
+    The sort is a bitonic network, whose exchanges are done in registers and with warp shuffles as far as the layout of
+    :code:`x` allows, and through shared memory between warps. The order of equal elements is unspecified.
+
+    :param x: The input tensor to be sorted.
+    :type x: Tensor
+    :param dim: The dimension along which to sort the tensor. If None, the tensor is sorted along the last dimension. Currently, only sorting along the last dimension is supported.
+    :type dim: int, optional
+    :param descending: If set to True, the tensor is sorted in descending order. If set to False, the tensor is sorted in ascending order.
+    :type descending: bool, optional
+    """
+    _check_sort_dim(x, dim)
+    return semantic.sort([x], bool(_constexpr_to_value(descending)), _builder)[0]
+
+
+@_tensor_member_fn
+@builtin
+def topk(x, k: constexpr, dim: constexpr = None, return_indices: constexpr = False, _builder=None):
+    """
+    Returns the :code:`k` largest elements of a tensor along a specified dimension, in descending order.
+
+    This is useful for routing tokens to experts and for top-k sampling. The order of equal elements is unspecified.
+
+    :param x: The input tensor.
+    :type x: Tensor
+    :param k: The number of elements to keep, a power of two no larger than the size of the dimension.
+    :type k: int
+    :param dim: The dimension along which to select the elements. If None, the last dimension is used. Currently, only the last dimension is supported.
+    :type dim: int, optional
+    :param return_indices: If set to True, the int32 indices of the elements along the dimension are returned too.
+    :type return_indices: bool, optional
+    """
+    _check_sort_dim(x, dim)
+    return semantic.topk(x, _constexpr_to_value(k), _constexpr_to_value(return_indices), _builder)
+
+
+@_tensor_member_fn
+@builtin
+def gather(src, index, axis, _builder=None):
+    """
+    Gathers the elements of :code:`src` along :code:`axis` at the positions given by :code:`index`, like
+    :code:`numpy.take_along_axis`.
+
+    :code:`index` must have the rank of :code:`src` and match its size in every dimension but :code:`axis`, and the
+    result has the shape of :code:`index`. The gather is done in registers, with warp shuffles when the layout of
+    :code:`src` keeps the axis within a warp and through shared memory otherwise. Out of range indices give
+    undefined values.
+
+    :param src: The tensor to gather from.
+    :type src: Tensor
+    :param index: The integer positions along :code:`axis`.
+    :type index: Tensor
+    :param axis: The dimension to gather along.
+    :type axis: int
+    """
+    axis = _constexpr_to_value(axis)
+    return semantic.gather(src, index, axis, _builder)
+
+
+@builtin
+def cluster_reduce(input, kind, _builder=None):
+    """Combines :code:`input` with the same tensor of the other programs of the cluster, which all get the result.
+
+    The programs must be launched in clusters with :code:`cluster_dims` and :code:`num_ctas=1`, and each of them must
+    call :code:`cluster_reduce` in the same order. The tensors are exchanged through distributed shared memory, so
+    split reductions, like the partial softmax statistics of split-KV attention, can be combined within one kernel.
+    The position of a program in its cluster is given by its program ids modulo :code:`cluster_dims`.
+    With a cluster of one program, this returns :code:`input`.
+
+    :param input: the partial tensor of this program
+    :type input: Tensor
+    :param kind: the reduction, one of :code:`"sum"`, :code:`"max"` and :code:`"min"`
+    :type kind: str
+    """
+    kind = _constexpr_to_value(kind)
+    return semantic.cluster_reduce(input, kind, _builder)
+
+
 # -----------------------
 # Compiler Hint Ops
 # -----------------------
@@ -2160,6 +2525,64 @@ def debug_barrier(_builder=None):
     return semantic.debug_barrier(_builder)
 
 
+@builtin
+def grid_sync(barrier, _builder=None):
+    """
+    Waits until all the programs of the grid call :code:`grid_sync`, after which the stores of every program are
+    visible to the loads of every other one. Kernels that call it are launched cooperatively, which fails if the
+    programs of the grid can't all be resident on the device at once, so their grid is usually sized from the
+    occupancy of the kernel, as with persistent kernels.
+
+    :param barrier: a pointer to an int32 counter of the arrivals, which must be zero before the launch and is left
+        holding a multiple of the number of programs. The same counter can be used for several calls to
+        :code:`grid_sync` within a launch.
+    :type barrier: pointer to int32
+    """
+    return semantic.grid_sync(barrier, _builder)
+
+
+@builtin
+def workspace(size, dtype, zeroed=True, _builder=None):
+    """
+    Returns a pointer to :code:`size` elements of :code:`dtype` in global memory, which the launcher provides and all
+    the programs of the grid share, e.g. for the partial results of split-K or the flags of a decoupled look-back
+    scan. The launcher reuses the same buffer for the launches of a stream, so the contents don't survive the launch.
+
+    :param size: the number of elements.
+    :type size: int
+    :param dtype: the type of the elements.
+    :type dtype: tl.dtype
+    :param zeroed: whether the elements are zero when the kernel starts, which costs a memset before each launch.
+    :type zeroed: bool
+    """
+    size = _constexpr_to_value(size)
+    dtype = _constexpr_to_value(dtype)
+    zeroed = _constexpr_to_value(zeroed)
+    return semantic.workspace(size, dtype, zeroed, _builder)
+
+
+@builtin
+def griddep_wait(_builder=None):
+    """
+    Waits until the previous kernel of the stream completes and its stores are visible, when the kernel is launched
+    with :code:`launch_pdl` and may start before it. Call it before the first access to the memory that the previous
+    kernel writes; the loads of weights or the index math before it overlap with the tail of that kernel. Without a
+    programmatic dependent launch, or on devices that don't support it, it does nothing.
+    """
+    return semantic.griddep_wait(_builder)
+
+
+@builtin
+def griddep_launch_dependents(_builder=None):
+    """
+    Lets the next kernel of the stream, if it is launched with :code:`launch_pdl`, start once every program of the
+    grid calls :code:`griddep_launch_dependents` or exits. The next kernel still observes all the stores of this one
+    when its :code:`griddep_wait` returns, so the call can come before the last stores. It does nothing on devices
+    that don't support programmatic dependent launches.
+    """
+    return semantic.griddep_launch_dependents(_builder)
+
+
 @builtin
 def multiple_of(input, values, _builder=None):
     """
@@ -2211,6 +2634,19 @@ def max_constancy(input, values, _builder=None):
     return semantic.max_constancy(input, values)
 
 
+@builtin
+def unlikely(cond, _builder=None):
+    """
+    Let the compiler know that the scalar :code:`cond` is rarely true, e.g. for error handling or the last tiles of a
+    problem. When the body of an :code:`if` on it is large, it's moved into a function of its own, so that the rarely
+    run code doesn't take room in the instruction cache next to the hot one.
+    """
+    cond = _constexpr_to_value(cond)
+    if not isinstance(cond, tensor):
+        return cond
+    return semantic.unlikely(cond, _builder)
+
+
 # -----------------------
 # Debugging functions
 # -----------------------
@@ -2535,9 +2971,13 @@ class range:
         kernel argument.  The kernel argument only pipelines loads that feed
         into :code:`dot` operations, while this attribute tries to pipeline most
         (though not all) loads in this loop.
+    :param loop_unroll_factor: unroll the loop this many times and interleave
+        the loads of the copies, so that the loads of several iterations are
+        in flight without the shared memory of pipelining. A factor of 1
+        keeps the loop from being unrolled.
     """
 
-    def __init__(self, arg1, arg2=None, step=None, num_stages=None):
+    def __init__(self, arg1, arg2=None, step=None, num_stages=None, loop_unroll_factor=None):
         if step is None:
             self.step = constexpr(1)
         else:
@@ -2549,6 +2989,7 @@ class range:
             self.start = arg1
             self.end = arg2
         self.num_stages = num_stages
+        self.loop_unroll_factor = loop_unroll_factor
 
     def __iter__(self):
         raise RuntimeError("tl.range can only be used in @triton.jit'd functions")
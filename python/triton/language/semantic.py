@@ -705,7 +705,10 @@ def _str_to_rounding_mode(rounding_mode: Optional[str]):
         return ir.ROUNDING_MODE.RTNE
     if rounding_mode == 'rtz':
         return ir.ROUNDING_MODE.RTZ
-    raise ValueError(f"Invalid rounding mode: {rounding_mode}. Supported rounding modes are 'rtne' and 'rtz'.")
+    if rounding_mode == 'rs':
+        return ir.ROUNDING_MODE.RS
+    raise ValueError(
+        f"Invalid rounding mode: {rounding_mode}. Supported rounding modes are 'rtne', 'rtz' and 'rs'.")
 
 
 def bitcast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder) -> tl.tensor:
@@ -727,8 +730,24 @@ def bitcast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder) -> tl.tenso
     return tl.tensor(builder.create_bitcast(input.handle, dst_ty.to_ir(builder)), dst_ty)
 
 
-def cast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder,
-         fp_downcast_rounding: Optional[str] = None) -> tl.tensor:
+def unpack(input: tl.tensor, format: str, axis: int, dst_ty: tl.dtype, builder: ir.builder) -> tl.tensor:
+    formats = {"int4": ir.PACKED_ELEM_TYPE.I4, "uint4": ir.PACKED_ELEM_TYPE.U4, "e2m1": ir.PACKED_ELEM_TYPE.E2M1}
+    if format not in formats:
+        raise ValueError(f"Invalid packed format: {format}. Supported formats are {list(formats)}")
+    if not input.type.is_block() or input.dtype not in (tl.int8, tl.uint8):
+        raise ValueError(f"unpack expects a tensor of int8 or uint8, got {input.type}")
+    if not (dst_ty in (tl.float16, tl.bfloat16, tl.float32) or format != "e2m1" and dst_ty == tl.int8):
+        raise ValueError(f"Cannot unpack {format} to {dst_ty}")
+    shape = [s.value for s in input.shape]
+    axis = axis + len(shape) if axis < 0 else axis
+    assert 0 <= axis < len(shape), f"invalid axis {axis} for a tensor of rank {len(shape)}"
+    shape[axis] *= 2
+    ret_ty = tl.block_type(dst_ty, shape)
+    return tl.tensor(builder.create_unpack(input.handle, formats[format], axis, ret_ty.to_ir(builder)), ret_ty)
+
+
+def cast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder, fp_downcast_rounding: Optional[str] = None,
+         rbits: Optional[tl.tensor] = None) -> tl.tensor:
     src_ty = input.type
     if isinstance(dst_ty, tl.constexpr):
         dst_ty = dst_ty.value
@@ -746,8 +765,10 @@ def cast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder,
     # not be set
     fp_downcast_rounding = _str_to_rounding_mode(fp_downcast_rounding)
     use_custom_rounding = False
-    if dst_sca_ty.is_floating() and src_sca_ty.is_floating(
-    ) and dst_sca_ty.primitive_bitwidth < src_sca_ty.primitive_bitwidth:
+    # Conversions between fp8 types narrow either the exponent or the mantissa
+    if dst_sca_ty.is_floating() and src_sca_ty.is_floating() and (
+            dst_sca_ty.primitive_bitwidth < src_sca_ty.primitive_bitwidth or
+        (dst_sca_ty.is_fp8() and src_sca_ty.is_fp8())):
         if fp_downcast_rounding is None: fp_downcast_rounding = ir.ROUNDING_MODE.RTNE
         elif fp_downcast_rounding != ir.ROUNDING_MODE.RTNE: use_custom_rounding = True
     else:
@@ -758,6 +779,20 @@ def cast(input: tl.tensor, dst_ty: tl.dtype, builder: ir.builder,
     if (src_sca_ty.is_fp8e4nv() or dst_sca_ty.is_fp8e4nv()):
         assert builder.options.allow_fp8e4nv, "fp8e4nv data type is not supported on CUDA arch < 89"
 
+    # Stochastic rounding takes random bits for each element
+    if fp_downcast_rounding == ir.ROUNDING_MODE.RS:
+        if not (src_sca_ty.is_fp32() or src_sca_ty.is_fp16() or src_sca_ty.is_bf16()) or \
+           dst_sca_ty.fp_mantissa_width >= src_sca_ty.fp_mantissa_width or dst_sca_ty.is_fp8e4b15():
+            raise ValueError(f"Stochastic rounding is not supported from {src_sca_ty} to {dst_sca_ty}")
+        if rbits is None or not rbits.dtype.is_int() or rbits.dtype.primitive_bitwidth != 32:
+            raise ValueError("Stochastic rounding requires rbits, a tensor of random 32-bit integers")
+        if src_ty.is_block():
+            rbits = broadcast_impl_shape(rbits, src_ty.get_block_shapes(), builder)
+        return tl.tensor(
+            builder.create_fp_to_fp(input.handle, dst_ty.to_ir(builder), fp_downcast_rounding, rbits.handle), dst_ty)
+    elif rbits is not None:
+        raise ValueError("rbits should be set only for stochastic rounding")
+
     if (src_sca_ty.is_fp8e4b15() or dst_sca_ty.is_fp8e4b15()):
         assert builder.codegen_fns.get(
             "convert_custom_types") is not None, "target doesn't provide conversion for this type."
@@ -941,7 +976,14 @@ def _canonicalize_boundary_check(boundary_check, block_shape):
     return ()
 
 
-def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder):
+def _set_num_stages(load, num_stages, builder):
+    # The stage count is read by the pipeliner from the load op itself
+    if num_stages is not None:
+        load.set_attr("tt.num_stages", builder.get_int32_attr(num_stages))
+    return load
+
+
+def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, num_stages, builder):
     # Load by a block pointer: `pointer_type<block_type<>>`
     # Block pointer can not have `mask` and `other` arguments
     if mask is not None or other is not None:
@@ -959,11 +1001,11 @@ def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, evicti
     boundary_check = _canonicalize_boundary_check(boundary_check, dst_ty.get_block_shapes())
 
     # Build IR
-    return tl.tensor(
-        builder.create_tensor_pointer_load(ptr.handle, boundary_check, padding, cache, eviction, is_volatile), dst_ty)
+    load = builder.create_tensor_pointer_load(ptr.handle, boundary_check, padding, cache, eviction, is_volatile)
+    return tl.tensor(_set_num_stages(load, num_stages, builder), dst_ty)
 
 
-def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder):
+def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, num_stages, builder):
     # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
     if not ptr.type.scalar.is_ptr():
         raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.load`")
@@ -1014,41 +1056,81 @@ def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_
 
     # Build IR
     if mask is None:
-        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile), dst_ty)
+        load = builder.create_load(ptr.handle, cache, eviction, is_volatile)
     else:
-        return tl.tensor(
-            builder.create_masked_load(ptr.handle, mask.handle, other.handle if other else None, cache, eviction,
-                                       is_volatile), dst_ty)
+        load = builder.create_masked_load(ptr.handle, mask.handle, other.handle if other else None, cache, eviction,
+                                          is_volatile)
+    return tl.tensor(_set_num_stages(load, num_stages, builder), dst_ty)
 
 
 def load(ptr: tl.tensor, mask: Optional[tl.tensor], other: Optional[tl.tensor], boundary_check: Tuple,
-         padding_option: str, cache_modifier: str, eviction_policy: str, is_volatile: bool,
+         padding_option: str, cache_modifier: str, eviction_policy: str, is_volatile: bool, num_stages: Optional[int],
          builder: ir.builder) -> tl.tensor:
     # Cache, eviction and padding options
     cache = _str_to_load_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
     padding = _str_to_padding_option(padding_option)
+    if num_stages is not None and num_stages < 1:
+        raise ValueError(f"num_stages must be at least 1, got {num_stages}")
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
         # Load by a block pointer: `pointer_type<block_type<>>`
-        return _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
+        return _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, num_stages,
+                                   builder)
     else:
         # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
-        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
+        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, num_stages,
+                            builder)
+
+
+def _convert_to_im2col_offset(builder, elem):
+    if isinstance(elem, tl.constexpr):
+        elem = elem.value
+    if isinstance(elem, int):
+        assert -2**15 <= elem < 2**15, f"im2col offsets are 16 bit, got {elem}"
+        return builder.get_int16(elem)
+    assert isinstance(elem, tl.tensor) and elem.numel.value == 1 and elem.dtype.is_int(), \
+        "Expected an integer scalar im2col offset"
+    return cast(elem, tl.int16, builder).handle
 
 
 def descriptor_load(desc_ptr: tl.tensor, offsets, cache_modifier: str, eviction_policy: str, type,
-                    builder: ir.builder) -> tl.tensor:
+                    builder: ir.builder, im2col_offsets=None) -> tl.tensor:
     offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
-    x = builder.create_descriptor_load(desc_ptr.handle, offsets, type.to_ir(builder),
+    im2col_offsets = [_convert_to_im2col_offset(builder, elem) for elem in im2col_offsets or []]
+    if im2col_offsets:
+        assert len(type.shape) == 2, "im2col loads produce 2D blocks of pixels by channels"
+        assert len(im2col_offsets) == len(offsets) - 2, "im2col needs an offset per spatial dim"
+    x = builder.create_descriptor_load(desc_ptr.handle, offsets, im2col_offsets, type.to_ir(builder),
                                        _str_to_load_cache_modifier(cache_modifier),
                                        _str_to_eviction_policy(eviction_policy))
     return tl.tensor(x, type)
 
 
-def descriptor_store(desc_ptr: tl.tensor, value: tl.tensor, offsets, builder: ir.builder) -> tl.tensor:
+def _str_to_descriptor_reduce_kind(kind: str, dtype: tl.dtype):
+    if kind is None:
+        return None
+    kinds = {"add": "ADD", "min": "MIN", "max": "MAX", "and": "AND", "or": "OR", "xor": "XOR"}
+    if kind not in kinds:
+        raise ValueError(f"descriptor store reduce must be one of {list(kinds)}, got {kind}")
+    # The types the TMA reduces, as the element type of the descriptor, which must be `dtype`
+    supported = {
+        "add": (tl.int32, tl.uint32, tl.uint64, tl.float16, tl.bfloat16, tl.float32),
+        "min": (tl.int32, tl.uint32, tl.int64, tl.uint64, tl.float16, tl.bfloat16),
+        "max": (tl.int32, tl.uint32, tl.int64, tl.uint64, tl.float16, tl.bfloat16),
+        "and": (tl.int32, tl.uint32, tl.int64, tl.uint64),
+        "or": (tl.int32, tl.uint32, tl.int64, tl.uint64),
+        "xor": (tl.int32, tl.uint32, tl.int64, tl.uint64),
+    }
+    if dtype not in supported[kind]:
+        raise ValueError(f"descriptor store reduce {kind} does not support {dtype}")
+    return getattr(ir.DESCRIPTOR_REDUCE_KIND, kinds[kind])
+
+
+def descriptor_store(desc_ptr: tl.tensor, value: tl.tensor, offsets, builder: ir.builder, reduce=None) -> tl.tensor:
     offsets = _convert_to_ir_values(builder, offsets, require_i64=False)
-    return tl.tensor(builder.create_descriptor_store(desc_ptr.handle, value.handle, offsets), tl.void)
+    reduce_kind = _str_to_descriptor_reduce_kind(reduce, value.dtype)
+    return tl.tensor(builder.create_descriptor_store(desc_ptr.handle, value.handle, offsets, reduce_kind), tl.void)
 
 
 def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builder):
@@ -1311,8 +1393,8 @@ def _str_to_dot_input_precision(input_precision, builder):
     assert input_precision.lower() in builder.options.allowed_dot_input_precisions, \
         f"input_precision must be one of {builder.options.allowed_dot_input_precisions}. Got {input_precision}"
     input_precision = input_precision.upper()
-    if input_precision == "TF32X3":
-        input_precision = "TF32x3"
+    if input_precision in ("TF32X3", "BF16X3", "BF16X6", "BF16X9"):
+        input_precision = input_precision.replace("X", "x")
     return getattr(ir.INPUT_PRECISION, input_precision)
 
 
@@ -1325,6 +1407,11 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
             ), "Dot op does not support fp8e4nv on CUDA arch < 90"
             if lhs_dtype.is_fp8() and rhs_dtype.is_fp8():
                 return
+            if options.allow_mixed_fp8_dot and (lhs_dtype.is_fp8() or rhs_dtype.is_fp8()):
+                other_dtype = rhs_dtype if lhs_dtype.is_fp8() else lhs_dtype
+                assert other_dtype.is_fp16() or other_dtype.is_bf16(
+                ), f"fp8 operands can only be mixed with fp16 or bf16 operands. Got {lhs_dtype} and {rhs_dtype}"
+                return
             assert lhs_dtype == rhs_dtype, f"First input ({lhs_dtype}) and second input ({rhs_dtype}) must have the same dtype!"
         else:
             if lhs_dtype.is_int() or rhs_dtype.is_int():
@@ -1356,6 +1443,11 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
     if lhs.dtype.is_fp8e4b15() or rhs.dtype.is_fp8e4b15():
         lhs = cast(lhs, tl.float16, builder)
         rhs = cast(rhs, tl.float16, builder)
+    elif lhs.dtype.is_fp8() != rhs.dtype.is_fp8():
+        # The backend moves the upcast after the load from shared memory, so
+        # the fp8 operand is still staged at its original width.
+        lhs = cast(lhs, rhs.dtype, builder) if lhs.dtype.is_fp8() else lhs
+        rhs = cast(rhs, lhs.dtype, builder) if rhs.dtype.is_fp8() else rhs
 
     if input_precision is None:
         input_precision = builder.options.default_dot_input_precision
@@ -1367,9 +1459,11 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
     assert lhs_rank == rhs_rank == 2 or lhs_rank == rhs_rank == 3, f"Both inputs must be either 2D or 3D; (lhs: {lhs.shape} vs rhs: {rhs.shape})"
     assert lhs.shape[-1].value == rhs.shape[
         -2].value, f"First input shape ({lhs.shape}) and second input shape {rhs.shape} are not compatible for matmul (second index of first shape ({lhs.shape[-1].value}) must be equal to first index of second shape ({rhs.shape[-2].value})"
-    assert lhs.shape[-2].value >= 16 and lhs.shape[-1].value >= 16 \
-        and rhs.shape[-1].value >= 16, \
-        f"All non-batch values in both first input shape ({lhs.shape}) and second input shape ({rhs.shape}) must be >= 16!"
+    # 2D dots with fewer rows or columns, like GEMVs, are split along K instead of using MMAs
+    assert lhs.shape[-1].value >= 16, f"The inner dimension of the first input ({lhs.shape}) must be >= 16!"
+    if lhs_rank == 3:
+        assert lhs.shape[-2].value >= 16 and rhs.shape[-1].value >= 16, \
+            f"All non-batch values in both first input shape ({lhs.shape}) and second input shape ({rhs.shape}) must be >= 16!"
     if lhs.type.scalar.is_int():
         assert lhs.type.scalar == tl.int8, "only int8 supported!"
         # TODO: This is CUDA specific, check if ROCm has the same limitation
@@ -1390,9 +1484,15 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
     N = rhs.type.shape[-1]
     B = lhs.type.shape[0] if lhs_rank == 3 else None
     ret_ty = tl.block_type(ret_scalar_ty, [B, M, N] if B else [M, N])
+    acc_dtype = ret_scalar_ty
     if acc is None:
         acc_handle = builder.create_splat(_0, [B, M, N] if B else [M, N])
     else:
+        acc_dtype = acc.dtype
+        if ret_scalar_ty.is_fp16() and acc_dtype.is_fp32():
+            # Accumulate in fp16 and return the dtype of acc. The conversions
+            # of the accumulators carried by loops are removed by the compiler.
+            acc = cast(acc, tl.float16, builder)
         acc_handle = acc.handle
         assert acc.type == ret_ty
 
@@ -1403,8 +1503,79 @@ def dot(lhs: tl.tensor, rhs: tl.tensor, acc: tl.tensor, input_precision: Optiona
         else:
             max_num_imprecise_acc = 0
 
-    return tl.tensor(builder.create_dot(lhs.handle, rhs.handle, acc_handle, input_precision, max_num_imprecise_acc),
-                     ret_ty)
+    ret = tl.tensor(builder.create_dot(lhs.handle, rhs.handle, acc_handle, input_precision, max_num_imprecise_acc),
+                    ret_ty)
+    return cast(ret, acc_dtype, builder)
+
+
+def _str_to_scale_dot_elem_type(format: str) -> ir.SCALE_DOT_ELEM_TYPE:
+    formats = {
+        "e4m3": ir.SCALE_DOT_ELEM_TYPE.E4M3,
+        "e5m2": ir.SCALE_DOT_ELEM_TYPE.E5M2,
+        "e2m1": ir.SCALE_DOT_ELEM_TYPE.E2M1,
+        "bf16": ir.SCALE_DOT_ELEM_TYPE.BF16,
+    }
+    if format not in formats:
+        raise ValueError(f"format must be one of {', '.join(formats)}. Got {format}")
+    return formats[format]
+
+
+def dot_scaled(lhs: tl.tensor, lhs_scale: Optional[tl.tensor], lhs_format: str, rhs: tl.tensor,
+               rhs_scale: Optional[tl.tensor], rhs_format: str, acc: Optional[tl.tensor], out_dtype: tl.dtype,
+               builder: ir.builder) -> tl.tensor:
+    dtypes = {"e4m3": tl.float8e4nv, "e5m2": tl.float8e5, "e2m1": tl.uint8, "bf16": tl.bfloat16}
+
+    def check_operand(name, x, scale, format, k_axis):
+        elem_type = _str_to_scale_dot_elem_type(format)
+        assert x.type.is_block() and len(x.shape) == 2, f"{name} must be a 2D tensor"
+        assert x.dtype == dtypes[format] or format == "e2m1" and x.dtype == tl.int8, \
+            f"{name} in {format} must be of type {dtypes[format]}. Got {x.dtype}"
+        k = x.shape[k_axis].value * (2 if format == "e2m1" else 1)
+        if format == "bf16":
+            assert scale is None, f"{name} in bf16 can't be scaled"
+            return elem_type, None, k
+        assert scale is not None, f"{name} in {format} must be scaled"
+        non_k = x.shape[1 - k_axis].value
+        assert k % 32 == 0 and scale.dtype in (tl.uint8, tl.int8) and scale.type.shape == [non_k, k // 32], \
+            f"the scale of {name} must be a uint8 tensor of shape [{non_k}, {k // 32}]. Got {scale.type.shape}"
+        return elem_type, scale.handle, k
+
+    lhs_type, lhs_scale_handle, lhs_k = check_operand("lhs", lhs, lhs_scale, lhs_format, 1)
+    rhs_type, rhs_scale_handle, rhs_k = check_operand("rhs", rhs, rhs_scale, rhs_format, 0)
+    assert lhs_k == rhs_k, f"lhs ({lhs.shape}) and rhs ({rhs.shape}) must have the same size along K"
+    M = lhs.type.shape[0]
+    N = rhs.type.shape[1]
+    assert M >= 16 and N >= 16 and lhs_k >= 32, f"M and N must be >= 16 and K >= 32. Got {M}, {N} and {lhs_k}"
+    ret_ty = tl.block_type(out_dtype, [M, N])
+    if acc is None:
+        acc_handle = builder.create_splat(builder.get_fp32(0), [M, N])
+    else:
+        assert acc.type == ret_ty, f"acc must be of type {ret_ty}. Got {acc.type}"
+        acc_handle = acc.handle
+    return tl.tensor(
+        builder.create_dot_scaled(lhs.handle, lhs_scale_handle, lhs_type, rhs.handle, rhs_scale_handle, rhs_type,
+                                  acc_handle), ret_ty)
+
+
+def sparse_dot(lhs: tl.tensor, lhs_meta: tl.tensor, rhs: tl.tensor, acc: tl.tensor, builder: ir.builder) -> tl.tensor:
+    assert lhs.type.is_block() and rhs.type.is_block() and lhs_meta.type.is_block()
+    assert len(lhs.shape) == len(rhs.shape) == len(lhs_meta.shape) == 2, "Sparse dots only support 2D inputs"
+    assert lhs.dtype == rhs.dtype and (lhs.dtype.is_fp16() or lhs.dtype.is_bf16()), \
+        f"Sparse dots only support float16 and bfloat16 inputs of the same dtype. Got {lhs.dtype} and {rhs.dtype}"
+    M, K = lhs.shape[0].value, rhs.shape[0].value
+    N = rhs.shape[1].value
+    assert lhs.shape[1].value * 2 == K, \
+        f"The compressed first input ({lhs.shape}) must hold half of the inner dimension of the second input ({rhs.shape})"
+    assert K % 32 == 0, f"The inner dimension ({K}) must be a multiple of 32"
+    assert lhs_meta.dtype == tl.int16 and lhs_meta.shape[0].value == M and lhs_meta.shape[1].value == K // 16, \
+        f"The metadata must be an int16 tensor of shape [{M}, {K // 16}]. Got {lhs_meta.type}"
+    ret_ty = tl.block_type(tl.float32, [M, N])
+    if acc is None:
+        acc_handle = builder.create_splat(builder.get_fp32(0), [M, N])
+    else:
+        assert acc.type == ret_ty, f"acc must be of type {ret_ty}. Got {acc.type}"
+        acc_handle = acc.handle
+    return tl.tensor(builder.create_sparse_dot(lhs.handle, rhs.handle, acc_handle, lhs_meta.handle), ret_ty)
 
 
 # ===----------------------------------------------------------------------===//
@@ -1494,6 +1665,110 @@ def histogram(input: tl.tensor, num_bins: int, builder: ir.builder) -> tl.tensor
     return tl.tensor(builder.create_histogram(input.handle, num_bins), tl.block_type(tl.int32, (num_bins, )))
 
 
+# ===----------------------------------------------------------------------===
+#                               Sort
+# ===----------------------------------------------------------------------===
+
+
+def sort(inputs: Sequence[tl.tensor], descending: bool, builder: ir.builder) -> Tuple[tl.tensor, ...]:
+    keys = inputs[0]
+    assert keys.type.is_block(), "sort only supports tensors"
+    shape = keys.type.shape
+    n = tl._constexpr_to_value(shape[-1])
+    assert n & (n - 1) == 0, f"the size of the sorted dimension must be a power of 2, got {n}"
+    for t in inputs:
+        assert t.type.shape == shape, "all sort inputs must have the same shape"
+        assert t.dtype.is_floating() or t.dtype.is_int(), "sort only supports numeric tensors"
+    assert not keys.dtype.is_fp8(), "sort does not support fp8 keys"
+    # The op compares integers as signed, which orders unsigned integers right once their top bits are flipped
+    sign_bit = None
+    if keys.dtype.is_int_unsigned() or keys.dtype.is_bool():
+        value = True if keys.dtype.is_bool() else 1 << (keys.dtype.primitive_bitwidth - 1)
+        sign_bit = full(shape, value, keys.dtype, builder)
+        keys = xor_(keys, sign_bit, builder)
+    handles = builder.create_sort([keys.handle] + [t.handle for t in inputs[1:]], descending)
+    ret = [tl.tensor(handle, t.type) for handle, t in zip(handles, inputs)]
+    if sign_bit is not None:
+        ret[0] = xor_(ret[0], sign_bit, builder)
+    return tuple(ret)
+
+
+def _take_prefix(input: tl.tensor, k: int, builder: ir.builder) -> tl.tensor:
+    # Split the last dimension into [2, ..., 2, k], move the 2s last and keep the first half of each of them
+    outer = [tl._constexpr_to_value(s) for s in input.shape[:-1]]
+    num_halvings = (tl._constexpr_to_value(input.shape[-1]) // k).bit_length() - 1
+    if num_halvings == 0:
+        return input
+    rank = len(outer)
+    input = reshape(input, outer + [2] * num_halvings + [k], False, builder)
+    input = permute(input, list(range(rank)) + [rank + num_halvings] + list(range(rank, rank + num_halvings)), builder)
+    for _ in range(num_halvings):
+        input, _ = split(input, builder)
+    return input
+
+
+def topk(input: tl.tensor, k: int, return_indices: bool, builder: ir.builder):
+    assert input.type.is_block(), "topk only supports tensors"
+    shape = [tl._constexpr_to_value(s) for s in input.shape]
+    n = shape[-1]
+    assert k > 0 and k & (k - 1) == 0, f"k must be a power of 2, got {k}"
+    assert k <= n, f"k ({k}) must not be larger than the size of the dimension ({n})"
+    inputs = [input]
+    if return_indices:
+        indices = reshape(arange(0, n, builder), [1] * (len(shape) - 1) + [n], False, builder)
+        inputs.append(broadcast_impl_shape(indices, shape, builder))
+    ret = [_take_prefix(t, k, builder) for t in sort(inputs, True, builder)]
+    return tuple(ret) if return_indices else ret[0]
+
+
+# ===----------------------------------------------------------------------===
+#                               Gather
+# ===----------------------------------------------------------------------===
+
+
+def gather(src: tl.tensor, index: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
+    assert src.type.is_block() and index.type.is_block(), "gather only supports tensors"
+    assert index.dtype.is_int(), f"gather index must be an integer tensor, got {index.dtype}"
+    rank = len(src.shape)
+    assert len(index.shape) == rank, "gather source and index must have the same rank"
+    if axis < 0:
+        axis += rank
+    assert 0 <= axis < rank, f"gather axis {axis} is out of range for a tensor of rank {rank}"
+    for d, (s, i) in enumerate(zip(src.shape, index.shape)):
+        if d != axis:
+            assert s == i, f"gather source and index must match in dimension {d}, got {s} and {i}"
+    if index.dtype != tl.int32:
+        index = cast(index, tl.int32, builder)
+    ret_ty = tl.block_type(src.type.scalar, index.shape)
+    return tl.tensor(builder.create_gather(src.handle, index.handle, axis), ret_ty)
+
+
+# ===----------------------------------------------------------------------===
+#                               Cluster Reduce
+# ===----------------------------------------------------------------------===
+
+
+def cluster_reduce(input: tl.tensor, kind: str, builder: ir.builder) -> tl.tensor:
+    assert input.type.is_block(), "cluster_reduce only supports tensors"
+    assert input.dtype.is_floating() or input.dtype.is_int(), "cluster_reduce only supports numeric tensors"
+    kinds = {"sum": "ADD", "max": "MAX", "min": "MIN"}
+    if kind not in kinds:
+        raise ValueError(f"cluster_reduce kind must be one of {list(kinds)}, got {kind}")
+    op = kinds[kind]
+    if kind != "sum" and input.dtype.is_int_unsigned():
+        op = "U" + op
+    cluster_size = 1
+    for dim in builder.options.cluster_dims:
+        cluster_size *= dim
+    if cluster_size == 1:
+        return input
+    if builder.options.num_ctas != 1:
+        raise ValueError("cluster_reduce combines independent programs and requires num_ctas == 1, "
+                         f"got num_ctas={builder.options.num_ctas}")
+    return tl.tensor(builder.create_cluster_reduce(input.handle, getattr(ir.CLUSTER_REDUCE_KIND, op), cluster_size),
+                     input.type)
+
+
 ##
 
 
@@ -1518,10 +1793,69 @@ def max_constancy(x: tl.tensor, values: List[int]) -> tl.tensor:
     return x
 
 
+def unlikely(cond: tl.tensor, builder: ir.builder) -> tl.tensor:
+    if cond.type.is_block():
+        raise ValueError("unlikely expects a scalar condition, got a tensor")
+    cond = cast(cond, tl.int1, builder)
+    cond.handle.set_attr("tt.unlikely", ir.make_unit_attr(cond.handle.get_context()))
+    return cond
+
+
 def debug_barrier(builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_barrier(), tl.void)
 
 
+def _check_flag_pointer(ptr: tl.tensor, op: str) -> None:
+    if ptr.type.is_block() or not ptr.dtype.is_ptr() or ptr.dtype.element_ty != tl.int32:
+        raise ValueError(f"{op} expects a scalar pointer to int32, got {ptr.type}")
+
+
+def grid_sync(barrier: tl.tensor, builder: ir.builder) -> tl.tensor:
+    _check_flag_pointer(barrier, "grid_sync")
+    return tl.tensor(builder.create_grid_sync(barrier.handle), tl.void)
+
+
+def workspace(size: int, dtype: tl.dtype, zeroed: bool, builder: ir.builder) -> tl.tensor:
+    if not isinstance(size, int) or size <= 0:
+        raise ValueError(f"workspace size must be a positive constexpr int, got {size}")
+    if not isinstance(dtype, tl.dtype) or dtype.is_ptr() or dtype.is_block():
+        raise ValueError(f"workspace dtype must be a scalar type, got {dtype}")
+    ptr_ty = tl.pointer_type(dtype)
+    nbytes = size * max(dtype.primitive_bitwidth // 8, 1)
+    return tl.tensor(builder.create_workspace(ptr_ty.to_ir(builder), nbytes, bool(zeroed)), ptr_ty)
+
+
+def griddep_wait(builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_griddep_wait(), tl.void)
+
+
+def griddep_launch_dependents(builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_griddep_launch_dependents(), tl.void)
+
+
+def signal(ptr: tl.tensor, value: tl.tensor, op: str, scope: str, builder: ir.builder) -> tl.tensor:
+    _check_flag_pointer(ptr, "signal")
+    if op not in ("set", "add"):
+        raise ValueError(f"signal op must be one of ['set', 'add'], got {op}")
+    # the barrier orders the stores of all the threads before the release of the one that updates the flag
+    debug_barrier(builder)
+    update = atomic_xchg if op == "set" else atomic_add
+    update(ptr, value, None, "release", scope, builder)
+    return tl.tensor(None, tl.void)
+
+
+def signal_wait(ptr: tl.tensor, value: tl.tensor, cmp: str, scope: str, builder: ir.builder) -> tl.tensor:
+    _check_flag_pointer(ptr, "signal_wait")
+    cmps = {"eq": ir.SIGNAL_WAIT_CMP.EQ, "ne": ir.SIGNAL_WAIT_CMP.NE, "ge": ir.SIGNAL_WAIT_CMP.GE}
+    if cmp not in cmps:
+        raise ValueError(f"signal_wait cmp must be one of {list(cmps)}, got {cmp}")
+    if value.type.is_block():
+        raise ValueError("signal_wait expects a scalar value")
+    value = cast(value, tl.int32, builder)
+    builder.create_signal_wait(ptr.handle, value.handle, cmps[cmp], _str_to_scope(scope))
+    return tl.tensor(None, tl.void)
+
+
 def device_print(prefix: str, args: List[tl.tensor], hex: bool, builder: ir.builder) -> tl.tensor:
     # It makes sense visually for prefix to end in ": "; make it so.  Also,
     # non-empty prefixes should start with " ".
@@ -2,6 +2,12 @@
 from . import blocksparse
 from .cross_entropy import _cross_entropy, cross_entropy
 from .flash_attention import attention
+from .grouped_matmul import expert_matmul, grouped_matmul
 from .matmul import _matmul, get_higher_dtype, matmul
+from .paged_attention import paged_attention, varlen_attention
+from .scan import cumsum
 
-__all__ = ["blocksparse", "_cross_entropy", "cross_entropy", "_matmul", "matmul", "attention", "get_higher_dtype"]
+__all__ = [
+    "blocksparse", "_cross_entropy", "cross_entropy", "_matmul", "matmul", "attention", "get_higher_dtype", "cumsum",
+    "paged_attention", "varlen_attention", "grouped_matmul", "expert_matmul"
+]
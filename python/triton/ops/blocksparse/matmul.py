@@ -22,8 +22,7 @@ def _sdd_kernel(A, B, C,  #
                 stride_zb, stride_hb, stride_bk, stride_nb,  #
                 stride_zc, stride_hc, stride_mc, stride_nc,  #
                 K, grid_offset, lut,  #
-                TILE_M: tl.constexpr, TILE_N: tl.constexpr, TILE_K: tl.constexpr,  #
-                BLOCK: tl.constexpr, EVEN_K: tl.constexpr  #
+                TILE_K: tl.constexpr, BLOCK: tl.constexpr, EVEN_K: tl.constexpr  #
                 ):
     # ------------ #
     # - Prologue - #
@@ -33,51 +32,41 @@ def _sdd_kernel(A, B, C,  #
     # offsets
     off_z = tl.program_id(2)  # batch
     off_h = tl.load(lut + 0)  # head
-
-    # initialize pointers to A
     start_am = tl.load(lut + 1)
-    offs_am = start_am * BLOCK + (tl.arange(0, TILE_M) % BLOCK)
-    offs_ak = tl.arange(0, TILE_K)
-    a_ptrs = A \
-        + off_z * stride_za \
-        + off_h * stride_ha \
-        + offs_am[:, None] * stride_ma \
-        + offs_ak[None, :] * stride_ak
-    # initialize pointers to B
     start_bn = tl.load(lut + 2)
-    offs_bn = start_bn * BLOCK + (tl.arange(0, TILE_N) % BLOCK)
-    offs_bk = tl.arange(0, TILE_K)
-    b_ptrs = B \
-        + off_z * stride_zb \
-        + off_h * stride_hb \
-        + offs_bn[None, :] * stride_nb \
-        + offs_bk[:, None] * stride_bk
+    # block pointers to the rows of A and the columns of B of the block
+    a_ptr = tl.make_block_ptr(base=A + off_z * stride_za + off_h * stride_ha, shape=((start_am + 1) * BLOCK, K),
+                              strides=(stride_ma, stride_ak), offsets=(start_am * BLOCK, 0),
+                              block_shape=(BLOCK, TILE_K), order=(1, 0))
+    b_ptr = tl.make_block_ptr(base=B + off_z * stride_zb + off_h * stride_hb, shape=(K, (start_bn + 1) * BLOCK),
+                              strides=(stride_bk, stride_nb), offsets=(0, start_bn * BLOCK),
+                              block_shape=(TILE_K, BLOCK), order=(0, 1))
     # ---------------- #
     #    Inner Loop    #
     # ---------------- #
-    acc = tl.zeros((TILE_M, TILE_N), dtype=tl.float32)
-    for k in range(K, 0, -TILE_K):
+    acc = tl.zeros((BLOCK, BLOCK), dtype=tl.float32)
+    for k in range(0, K, TILE_K):
         if EVEN_K:
-            a = tl.load(a_ptrs)
-            b = tl.load(b_ptrs)
+            a = tl.load(a_ptr)
+            b = tl.load(b_ptr)
         else:
-            a = tl.load(a_ptrs, mask=offs_ak[None, :] < k, other=0.)
-            b = tl.load(b_ptrs, mask=offs_bk[:, None] < k, other=0.)
+            a = tl.load(a_ptr, boundary_check=(1, ), padding_option="zero")
+            b = tl.load(b_ptr, boundary_check=(0, ), padding_option="zero")
         acc += tl.dot(a, b, out_dtype=tl.float32)
-        a_ptrs += TILE_K * stride_ak
-        b_ptrs += TILE_K * stride_bk
+        a_ptr = tl.advance(a_ptr, (0, TILE_K))
+        b_ptr = tl.advance(b_ptr, (TILE_K, 0))
     c = acc.to(C.dtype.element_ty)
     # ---------------- #
     #    Epilogue      #
     # ---------------- #
-    offs_cm = tl.arange(0, TILE_M) % BLOCK
-    offs_cn = tl.arange(0, TILE_N) % BLOCK
+    offs_cm = tl.arange(0, BLOCK)
+    offs_cn = tl.arange(0, BLOCK)
     pc = C \
         + off_z * stride_zc \
         + block_id * stride_hc \
         + offs_cm[:, None] * stride_mc \
         + offs_cn[None, :] * stride_nc
-    tl.store(pc, c, mask=True)
+    tl.store(pc, c)
 
 
 def sdd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, widths, out=None):
@@ -108,8 +97,7 @@ def sdd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, widths, out=
         b.stride(0), b.stride(1), b.stride(3 if trans_b else 2), b.stride(2 if trans_b else 3),  #
         c.stride(0), c.stride(1), c.stride(2), c.stride(3),  #
         Ka, 0, lut,  #
-        TILE_M=block, TILE_N=block, TILE_K=32, BLOCK=block, num_stages=4,  #
-        num_warps=4  #
+        TILE_K=32, BLOCK=block, num_stages=4, num_warps=4  #
     )
     return c
 
@@ -122,8 +110,10 @@ def sdd_lut(layout, block, device):
 
 # -----------------------------
 # Dense = Sparse x Dense (DSD)
-# This operation uses a look-up table that contains pre-computed pointer increments
-# in order to minimize computations in the inner loop of the matmul kernel.
+# This operation uses a look-up table that contains the position of the
+# non-zero blocks of each column of the output. The entries are loaded in the
+# inner loop, so that the pipeliner prefetches them a stage ahead of the loads
+# of A and B whose addresses they give.
 # -----------------------------
 
 
@@ -147,49 +137,33 @@ def _dsd_kernel(A, B, C,  #
     pidz = tl.program_id(2)
     header = lut + pid_n * 4
     offset = tl.load(header + 0)
+    offset = tl.multiple_of(offset, 2)  # compiler hint
     K = tl.load(header + 1)
     column = tl.load(header + 2)
     off_h = tl.load(header + 3)
-    pinc = lut + offset
-    # initialize pointers to A (sparse)
-    block_id = tl.load(pinc + 1)
-    block_id = tl.multiple_of(block_id, 8)  # compiler hint
+    # the entries of the non-zero blocks of the column, made of the index of
+    # their first row in B and of their index in the sparse layout of A
+    pentry = lut + offset + tl.arange(0, 2)
     offs_am = tl.arange(0, TILE_M)
-    offs_ak = tl.arange(0, TILE_K)
-    pa = A + pidz * stride_az \
-        + block_id * stride_ha \
-        + offs_am[:, None] * stride_am \
-        + offs_ak[None, :] * stride_ak
-    # initialize pointers to B (dense)
     offs_bn = pid_m * TILE_N + tl.arange(0, TILE_N)
     offs_bn = tl.max_contiguous(tl.multiple_of(offs_bn % DS0, TILE_N), TILE_N)
-    start_bk = tl.load(pinc)
-    start_bk = tl.multiple_of(start_bk, 8)  # compiler hint
-    offs_bk = start_bk + tl.arange(0, TILE_K)
-    pb = B + pidz * stride_zb \
-        + off_h * stride_hb \
-        + offs_bn[None, :] * stride_bn \
-        + offs_bk[:, None] * stride_bk
+    A += pidz * stride_az
+    B += pidz * stride_zb + off_h * stride_hb
     # ---------------- #
     #    Inner Loop    #
     # ---------------- #
     acc = tl.zeros((TILE_M, TILE_N), dtype=tl.float32)
-    pinc += 2
-    inc_a = tl.load(pinc + 1)
-    inc_a = tl.multiple_of(inc_a, 8)
-    inc_b = tl.load(pinc)
-    inc_b = tl.multiple_of(inc_b, 8)
-    for k in range(K, 0, -TILE_K):
+    for k in range(0, K, TILE_K):
+        start_bk, block_id = tl.split(tl.load(pentry + 2 * (k // BLOCK)))
+        offs_k = k % BLOCK + tl.arange(0, TILE_K)
+        pa = A + block_id * stride_ha \
+            + offs_am[:, None] * stride_am \
+            + offs_k[None, :] * stride_ak
+        pb = B + offs_bn[None, :] * stride_bn \
+            + (start_bk + offs_k[:, None]) * stride_bk
         a = tl.load(pa)
         b = tl.load(pb)
         acc += tl.dot(a, b, out_dtype=tl.float32)
-        pa += inc_a
-        pb += inc_b * stride_bk
-        pinc += 2
-        inc_a = tl.load(pinc + 1)
-        inc_a = tl.multiple_of(inc_a, 8)
-        inc_b = tl.load(pinc)
-        inc_b = tl.multiple_of(inc_b, 8)
     c = acc.to(C.dtype.element_ty)
     # initialize pointers to C
     offs_cm = column * TILE_M + tl.arange(0, TILE_M)
@@ -240,35 +214,25 @@ def dsd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, width, out=N
     return c
 
 
-def dsd_lut(layout, block, step, trans, device):
+def dsd_lut(layout, block, trans, device):
     """
-    Generates the look-up table for incrementing pointers in the DSD/DDS matmul.
-    Example (BLOCK=32, STEP=16)
+    Generates the look-up table of the non-zero blocks in the DSD/DDS matmul.
+    Example (BLOCK=32)
     [[1, 0, 0, 1, 0],
      [0, 1, 1, 0, 1],
      [1, 0, 1, 0, 0]]
 
-    Then the offsets for A are
-     [0 , 16, 32, 48] <- row 0
-      \\----/  \\----/
-      col=0   col=3
-     [64, 80, 96, 112, 128, 144] <- row 1
-      \\----/   \\----/  \\------/
-       col=1    col=2    col=3
-     [160, 176, 192, 208]
-    which leads to increments table
-    [0, 16, 16, 16, || 64, 16, 16, 16, 16, 16, || 160, 16, 16, 16]
-
-    Because B is dense, the offsets are
-    [0, 16, 96, 112] <- row 0
-    [32, 48, 64, 80]  <- row 1
-    [0, 16, 64, 80]   <- row 2
+    The table starts with a header of 4 entries per column of the output,
+    i.e. per row of the layout when `trans` is set:
+    [offset of the first block in the table, reduction size, column, head]
+    followed by 2 entries per non-zero block:
+    [first row of the block in the dense input, index of the block in the sparse input]
+    e.g. for the first row, whose blocks are the 1st and 4th of A,
+    [0, 0, 96, 1, ...]
     """
     sizes = torch.sum(layout, 2 if trans else 1)
     head_id, col_id = torch.ones_like(sizes).nonzero(as_tuple=True)
     sizes = sizes.flatten()
-    segments = sizes * step
-    # pointer increments
     if trans:
         nnz = layout.nonzero(as_tuple=False)
     else:
@@ -277,26 +241,9 @@ def dsd_lut(layout, block, step, trans, device):
     offsets = torch.zeros_like(sizes)
     offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
     offsets = torch.min(offsets, (num_blocks - 1) * torch.ones_like(offsets))
-    # -------------------------------
-    # dense input pointer increments
-    # -------------------------------
-    # Note that the inner loop matmul kernel may have a fixed step size (e.g., TILE_K)
-    # that is smaller than the block size, so we need to do a bit of extra work
-    # to handle this case
+    # first row of the blocks of the dense input
     B_idx = nnz[:, 2] * block
-    B_incs = B_idx.clone()
-    B_incs[1:] -= B_idx[:-1]
-    div = block // step
-    B_incs = B_incs.view(-1, 1).repeat(1, div)
-    B_incs[:, 1:] = step
-    B_incs[:, 0] -= (div - 1) * step
-    # first increment for each reduction is actually the offset
-    B_incs[offsets[segments > 0], 0] = B_idx[offsets[segments > 0]]
-    B_incs = B_incs.view(-1)
-    # -------------------------------
-    # sparse input pointer increments
-    # -------------------------------
-    # same as above, except that the increments are in the sparse memory layout
+    # index of the blocks in the memory layout of the sparse input
     if trans:
         A_idx = torch.arange(num_blocks, device=layout.device)
     else:
@@ -308,32 +255,16 @@ def dsd_lut(layout, block, step, trans, device):
             layoutw[layoutw > 0] = 1 + torch.arange(msum, device=layout.device)
             A_idx = torch.cat((A_idx, current_offset + layoutw.T[layoutw.T > 0] - 1))
             current_offset += msum
-    A_incs = A_idx * block * block
-    A_incs[1:] -= A_idx[:-1] * block * block
-    A_incs = A_incs.view(-1, 1).repeat(1, div)
-    if trans:
-        A_incs[:, 1:] = step
-        A_incs[:, 0] -= (div - 1) * step
-    else:
-        A_incs[:, 1:] = step * block
-        A_incs[:, 0] -= (div - 1) * step * block
-    A_incs[offsets[segments > 0], 0] = A_idx[offsets[segments > 0]]
-    A_incs = A_incs.view(-1)
     # create header
     width = col_id.size(0)
-    offsets = offsets * 2 * div + 4 * width
-    segments = segments * div
+    offsets = offsets * 2 + 4 * width
+    segments = sizes * block
     header = torch.stack((offsets, segments, col_id, head_id), dim=1).view(-1).contiguous()
-    # create increments
-    incs = torch.stack((B_incs, A_incs), dim=1).view(-1).contiguous()
-    # pad by a factor 2*MAX_NUM_STAGES
-    # to accommodate pre-fetching inside the kernel
-    pad = torch.zeros(20, device=incs.device, dtype=incs.dtype)
-    incs = torch.cat((incs, pad))
+    # create entries
+    entries = torch.stack((B_idx, A_idx), dim=1).view(-1).contiguous()
     # create lut
-    lut = torch.cat((header, incs))
+    lut = torch.cat((header, entries))
     lut = lut.type(torch.int32).to(device)
-    # create locks
     return lut, width
 
 
@@ -409,18 +340,17 @@ class matmul:
         self.trans_c = trans_c
         self.layout = layout
         self.spdims = layout.shape
-        step = min(block, 32)
         if self.mode == 'sdd':
             self.c_lut, self.c_width = sdd_lut(layout, block, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, True, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, False, device)
+            self.da_lut, self.da_width = dsd_lut(layout, block, True, device)
+            self.db_lut, self.db_width = dsd_lut(layout, block, False, device)
         if self.mode == 'dsd':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, not self.trans_a, device)
+            self.c_lut, self.c_width = dsd_lut(layout, block, not self.trans_a, device)
             self.da_lut, self.da_width = sdd_lut(layout, block, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, self.trans_a, device)
+            self.db_lut, self.db_width = dsd_lut(layout, block, self.trans_a, device)
         if self.mode == 'dds':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, self.trans_b, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, not self.trans_b, device)
+            self.c_lut, self.c_width = dsd_lut(layout, block, self.trans_b, device)
+            self.da_lut, self.da_width = dsd_lut(layout, block, not self.trans_b, device)
             self.db_lut, self.db_width = sdd_lut(layout, block, device)
 
     def __call__(self, a, b, out=None):
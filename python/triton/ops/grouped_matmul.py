@@ -0,0 +1,178 @@
+"""
+Grouped Matmul
+==============
+Matmuls of groups of different shapes in a single launch, such as the experts
+of a mixture-of-experts layer. The groups are described on the device by
+arrays of pointers, shapes and strides, so that their shapes may come from a
+router kernel without synchronizing with the host.
+
+The output tiles of all the groups form a single sequence, which a persistent
+kernel strides over, so that every SM computes about as many tiles however the
+rows are split between the groups. When only an upper bound of the number of
+tiles is known on the host, the surplus programs find no tile and exit.
+
+The per-group pointers are loaded from memory, so they can't be turned into
+the TMA descriptors that `tma_block_pointers` encodes at launch from kernel
+arguments. The kernel uses regular pipelined loads instead, and hints the
+alignment of the loaded pointers and strides to vectorize them.
+"""
+
+import torch
+
+from .. import cdiv, jit
+from .. import language as tl
+from .flash_attention import is_hip
+
+_TL_DTYPES = {torch.float16: tl.float16, torch.bfloat16: tl.bfloat16, torch.float32: tl.float32}
+
+
+@jit
+def _grouped_matmul_kernel(A, B, C, Sizes, Strides, num_groups,  #
+                           DTYPE: tl.constexpr, PTR_ALIGN: tl.constexpr, STRIDE_ALIGN: tl.constexpr,  #
+                           BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+    # Find the group of the tile, the tiles of each group following those of
+    # the previous one with the columns of a row of tiles next to each other.
+    tile = tl.program_id(0)
+    group = num_groups
+    group_start = 0
+    num_n_tiles = 1
+    start = 0
+    for g in range(num_groups):
+        g_n_tiles = tl.cdiv(tl.load(Sizes + 3 * g + 1), BLOCK_N)
+        end = start + tl.cdiv(tl.load(Sizes + 3 * g), BLOCK_M) * g_n_tiles
+        found = (tile >= start) & (tile < end)
+        group = tl.where(found, g, group)
+        group_start = tl.where(found, start, group_start)
+        num_n_tiles = tl.where(found, g_n_tiles, num_n_tiles)
+        start = end
+    if group < num_groups:
+        M = tl.load(Sizes + 3 * group)
+        N = tl.load(Sizes + 3 * group + 1)
+        K = tl.load(Sizes + 3 * group + 2)
+        lda = tl.multiple_of(tl.load(Strides + 3 * group), STRIDE_ALIGN)
+        ldb = tl.multiple_of(tl.load(Strides + 3 * group + 1), STRIDE_ALIGN)
+        ldc = tl.multiple_of(tl.load(Strides + 3 * group + 2), STRIDE_ALIGN)
+        a_base = tl.multiple_of(tl.load(A + group), PTR_ALIGN).to(tl.pointer_type(DTYPE))
+        b_base = tl.multiple_of(tl.load(B + group), PTR_ALIGN).to(tl.pointer_type(DTYPE))
+        c_base = tl.multiple_of(tl.load(C + group), PTR_ALIGN).to(tl.pointer_type(DTYPE))
+
+        tile_m = (tile - group_start) // num_n_tiles
+        tile_n = (tile - group_start) % num_n_tiles
+        rm = tile_m * BLOCK_M + tl.arange(0, BLOCK_M)
+        rn = tile_n * BLOCK_N + tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        # the rows and columns past the edges wrap around and aren't stored
+        ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+        rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+        a_ptrs = a_base + ram[:, None] * lda + rk[None, :]
+        b_ptrs = b_base + rk[:, None] * ldb + rbn[None, :]
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, tl.cdiv(K, BLOCK_K)):
+            k_remaining = K - k * BLOCK_K
+            a = tl.load(a_ptrs, mask=rk[None, :] < k_remaining, other=0.)
+            b = tl.load(b_ptrs, mask=rk[:, None] < k_remaining, other=0.)
+            acc += tl.dot(a, b)
+            a_ptrs += BLOCK_K
+            b_ptrs += BLOCK_K * ldb
+        c_ptrs = c_base + rm[:, None] * ldc + rn[None, :]
+        tl.store(c_ptrs, acc.to(DTYPE), mask=(rm[:, None] < M) & (rn[None, :] < N))
+
+
+def _launch(a_ptrs, b_ptrs, c_ptrs, sizes, strides, num_tiles, dtype, aligned, BLOCK_M, BLOCK_N, BLOCK_K, num_warps,
+            num_stages):
+    # with 16-byte aligned pointers and strides, the rows of the blocks are loaded with vectors
+    num_groups = sizes.shape[0]
+    elem_size = torch.finfo(dtype).bits // 8
+    _grouped_matmul_kernel[(num_tiles, )](
+        a_ptrs, b_ptrs, c_ptrs, sizes, strides, num_groups,  #
+        DTYPE=_TL_DTYPES[dtype], PTR_ALIGN=16 if aligned else 1, STRIDE_ALIGN=16 // elem_size if aligned else 1,  #
+        BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N, BLOCK_K=BLOCK_K,  #
+        num_warps=num_warps, num_stages=num_stages, persistent=not is_hip())
+
+
+def _is_aligned(ptrs, strides, elem_size):
+    return all(ptr % 16 == 0 for ptr in ptrs) and all(stride * elem_size % 16 == 0 for stride in strides)
+
+
+def grouped_matmul(group_a, group_b, BLOCK_M=128, BLOCK_N=128, BLOCK_K=32, num_warps=4, num_stages=3):
+    """
+    Computes :code:`group_a[i] @ group_b[i]` for every :code:`i` in a single
+    launch. The matrices may have different shapes, but must share their
+    dtype and be contiguous along their last dimension.
+
+    :param group_a: the (M_i, K_i) left-hand sides.
+    :param group_b: the (K_i, N_i) right-hand sides.
+    :returns: the list of the (M_i, N_i) products.
+    """
+    assert len(group_a) == len(group_b) and len(group_a) > 0
+    dtype = group_a[0].dtype
+    device = group_a[0].device
+    group_c = []
+    sizes, strides = [], []
+    num_tiles = 0
+    for a, b in zip(group_a, group_b):
+        assert a.dtype == dtype and b.dtype == dtype, "the matrices of the groups must share their dtype"
+        assert a.shape[1] == b.shape[0], "incompatible dimensions"
+        assert a.stride(1) == 1 and b.stride(1) == 1, "the matrices must be contiguous along their last dimension"
+        M, K = a.shape
+        N = b.shape[1]
+        c = torch.empty((M, N), device=device, dtype=dtype)
+        group_c.append(c)
+        sizes += [M, N, K]
+        strides += [a.stride(0), b.stride(0), c.stride(0)]
+        num_tiles += cdiv(M, BLOCK_M) * cdiv(N, BLOCK_N)
+    if num_tiles == 0:
+        return group_c
+
+    def ptrs(tensors):
+        return torch.tensor([t.data_ptr() for t in tensors], device=device, dtype=torch.int64)
+
+    sizes_t = torch.tensor(sizes, device=device, dtype=torch.int32).view(-1, 3)
+    strides_t = torch.tensor(strides, device=device, dtype=torch.int32).view(-1, 3)
+    aligned = _is_aligned([t.data_ptr() for t in group_a + group_b + group_c], strides, group_a[0].element_size())
+    _launch(ptrs(group_a), ptrs(group_b), ptrs(group_c), sizes_t, strides_t, num_tiles, dtype, aligned, BLOCK_M,
+            BLOCK_N, BLOCK_K, num_warps, num_stages)
+    return group_c
+
+
+def expert_matmul(x, weights, expert_offsets, BLOCK_M=128, BLOCK_N=128, BLOCK_K=32, num_warps=4, num_stages=3):
+    """
+    Multiplies the rows of :code:`x` routed to each expert by the weights of
+    the expert, as in the expert layers of a mixture of experts. The rows of
+    expert :code:`e` are :code:`x[expert_offsets[e]:expert_offsets[e + 1]]`.
+
+    The offsets stay on the device: the launch is sized for the worst split
+    of the rows between the experts, so it doesn't wait for the router.
+
+    :param x: the (T, K) rows, sorted by expert.
+    :param weights: the (E, K, N) weights of the experts.
+    :param expert_offsets: the (E + 1, ) int32 offsets of the rows of each
+        expert in :code:`x`, on the device.
+    :returns: the (T, N) outputs.
+    """
+    T, K = x.shape
+    E, _, N = weights.shape
+    assert weights.shape[1] == K, "incompatible dimensions"
+    assert weights.dtype == x.dtype, "the rows and the weights must share their dtype"
+    assert expert_offsets.shape == (E + 1, )
+    x = x.contiguous()
+    weights = weights.contiguous()
+    out = torch.empty((T, N), device=x.device, dtype=x.dtype)
+    if T == 0:
+        return out
+    offsets = expert_offsets.to(torch.int64)
+    elem_size = x.element_size()
+    experts = torch.arange(E, device=x.device, dtype=torch.int64)
+    a_ptrs = x.data_ptr() + offsets[:-1] * (K * elem_size)
+    b_ptrs = weights.data_ptr() + experts * (K * N * elem_size)
+    c_ptrs = out.data_ptr() + offsets[:-1] * (N * elem_size)
+    rows = (offsets[1:] - offsets[:-1]).to(torch.int32)
+    sizes = torch.stack([rows, torch.full_like(rows, N), torch.full_like(rows, K)], dim=1)
+    strides = torch.tensor([K, N, N], device=x.device, dtype=torch.int32).expand(E, 3).contiguous()
+    # each expert has at most one partial row of tiles
+    num_tiles = (cdiv(T, BLOCK_M) + E) * cdiv(N, BLOCK_N)
+    # the rows of the experts start at multiples of the strides
+    aligned = _is_aligned([x.data_ptr(), weights.data_ptr(), out.data_ptr()], [K, N], elem_size)
+    _launch(a_ptrs, b_ptrs, c_ptrs, sizes, strides, num_tiles, x.dtype, aligned, BLOCK_M, BLOCK_N, BLOCK_K, num_warps,
+            num_stages)
+    return out
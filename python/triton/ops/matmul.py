@@ -2,7 +2,7 @@ import torch
 
 from .. import Config, autotune, cdiv, heuristics, jit
 from .. import language as tl
-from .matmul_perf_model import early_config_prune, estimate_matmul_time
+from .matmul_perf_model import early_config_prune, estimate_matmul_time, kernel_stats_prune
 
 _ordered_datatypes = [torch.int8, torch.float16, torch.bfloat16, torch.float32]
 
@@ -29,10 +29,6 @@ def get_higher_dtype(a, b):
             return a
 
 
-def init_to_zero(name):
-    return lambda nargs: nargs[name].zero_()
-
-
 def get_configs_io_bound():
     configs = []
     for num_stages in [2, 3, 4, 5, 6]:
@@ -47,7 +43,7 @@ def get_configs_io_bound():
                     for split_k in [2, 4, 8, 16]:
                         configs.append(
                             Config({'BLOCK_M': block_m, 'BLOCK_N': block_n, 'BLOCK_K': block_k, 'SPLIT_K': split_k},
-                                   num_stages=num_stages, num_warps=num_warps, pre_hook=init_to_zero('C')))
+                                   num_stages=num_stages, num_warps=num_warps))
     return configs
 
 
@@ -79,13 +75,14 @@ def get_configs_io_bound():
         'early_config_prune': early_config_prune,
         'perf_model': estimate_matmul_time,
         'top_k': 10,
+        'kernel_prune': kernel_stats_prune,
     },
 )
 @heuristics({
     'EVEN_K': lambda args: args['K'] % (args['BLOCK_K'] * args['SPLIT_K']) == 0,
 })
 @jit
-def _kernel(A, B, C, M, N, K,  #
+def _kernel(A, B, C, W, Counters, M, N, K,  #
             stride_am, stride_ak,  #
             stride_bk, stride_bn,  #
             stride_cm, stride_cn,  #
@@ -134,23 +131,58 @@ def _kernel(A, B, C, M, N, K,  #
             acc += tl.dot(a, b, out_dtype=acc_dtype, input_precision=input_precision)
         A += BLOCK_K * SPLIT_K * stride_ak
         B += BLOCK_K * SPLIT_K * stride_bk
-    acc = acc.to(C.dtype.element_ty)
     # rematerialize rm and rn to save registers
     rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
     rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
     C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
     mask = (rm < M)[:, None] & (rn < N)[None, :]
-    # handles write-back with reduction-splitting
-    if SPLIT_K == 1:
-        tl.store(C, acc, mask=mask)
+    # handles write-back with reduction-splitting: every split stores its
+    # partial sum of the tile in its slice of the accumulator-typed workspace
+    # W and takes a ticket from the counter of the tile. The last split to
+    # arrive, whichever it is, adds the slices in pid_z order, so the result
+    # does not depend on the order in which programs run, and no program
+    # waits for another one to be scheduled.
+    if SPLIT_K > 1:
+        counter = Counters + pid
+        W = W + (rm[:, None] * N + rn[None, :])
+        tl.store(W + pid_z * M * N, acc, mask=mask)
+        tl.debug_barrier()
+        if tl.atomic_add(counter, 1, sem="acq_rel") == SPLIT_K - 1:
+            acc = tl.load(W, mask=mask, cache_modifier=".cg")
+            for z in tl.static_range(1, SPLIT_K):
+                acc += tl.load(W + z * M * N, mask=mask, cache_modifier=".cg")
+            tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+            # leave the counter cleared for the next launch
+            tl.atomic_xchg(counter, 0)
     else:
-        tl.atomic_add(C, acc, mask=mask)
+        tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
 
 
 class _matmul(torch.autograd.Function):
     kernel = _kernel
 
+    # the split-k counters and workspaces of each device and stream, since the launches of different streams may run
+    # at the same time
     _locks = {}
+    _workspaces = {}
+    # bytes of the split-k workspace of a device, stream and accumulator type at most
+    max_workspace_size = 1 << 26
+
+    @staticmethod
+    def _get_locks(device, stream, size):
+        locks = _matmul._locks.get((device, stream))
+        if locks is None or locks.numel() < size:
+            locks = torch.zeros(size, device=device, dtype=torch.int32)
+            _matmul._locks[(device, stream)] = locks
+        return locks
+
+    @staticmethod
+    def _get_workspace(device, stream, dtype, size):
+        workspace = _matmul._workspaces.get((device, stream, dtype))
+        if workspace is None or workspace.numel() < size:
+            workspace = torch.empty(size, device=device, dtype=dtype)
+            _matmul._workspaces[(device, stream, dtype)] = workspace
+        return workspace
 
     @staticmethod
     def _call(a, b, acc_dtype, input_precision, fp8_fast_accum, output_dtype):
@@ -187,6 +219,19 @@ class _matmul(torch.autograd.Function):
             assert acc_dtype in supported_acc_dtypes[a.dtype], "acc_dtype not compatible with the type of a"
             assert acc_dtype in supported_acc_dtypes[b.dtype], "acc_dtype not compatible with the type of b"
 
+        # split-k partial sums are reduced through a workspace that holds the
+        # ones of every split, which early_config_prune keeps the split factor
+        # within, and a counter per output tile; the smallest tile gives the
+        # most tiles. Both are kept across the calls on the same stream.
+        max_split_k = max(config.kwargs['SPLIT_K'] for config in _kernel.configs)
+        workspace_size = 1
+        if max_split_k > 1:
+            workspace_size = min(max_split_k * M * N, _matmul.max_workspace_size // acc_dtype.itemsize)
+        stream = torch.cuda.current_stream(device).cuda_stream
+        workspace = _matmul._get_workspace(device, stream, acc_dtype, workspace_size)
+        min_block = 16
+        locks = _matmul._get_locks(device, stream, cdiv(M, min_block) * cdiv(N, min_block))
+
         def to_tl_type(ty):
             return getattr(tl, str(ty).split(".")[-1])
 
@@ -198,9 +243,12 @@ class _matmul(torch.autograd.Function):
         if a.dtype in [tl.float8e4nv, tl.float8e5] and b.dtype in [tl.float8e4nv, tl.float8e5]:
             ab_dtype = None
         # launch kernel
-        grid = lambda META: (cdiv(M, META['BLOCK_M']) * cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
+        def grid(META):
+            assert META['SPLIT_K'] == 1 or META['SPLIT_K'] * M * N <= workspace.numel(), "split-k workspace too small"
+            return (cdiv(M, META['BLOCK_M']) * cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
+
         _kernel[grid](
-            a, b, c, M, N, K,  #
+            a, b, c, workspace, locks, M, N, K,  #
             a.stride(0), a.stride(1),  #
             b.stride(0), b.stride(1),  #
             c.stride(0), c.stride(1),  #
@@ -1,10 +1,13 @@
 import functools
 import heapq
+import math
 
 import torch
 
 from .. import cdiv
 from ..runtime import driver
+from ..runtime.errors import OutOfResources
+from ..runtime.occupancy import compute_occupancy
 from ..testing import (get_dram_gbps, get_max_simd_tflops, get_max_tensorcore_tflops, nvsmi)
 
 
@@ -133,6 +136,13 @@ def early_config_prune(configs, named_args, **kwargs):
     if dtype not in [torch.float16, torch.float32]:
         configs = [config for config in configs if config.kwargs['SPLIT_K'] == 1]
 
+    # the partial sums of every split must fit in the split-k workspace
+    M, N = named_args['M'], named_args['N']
+    configs = [
+        config for config in configs
+        if config.kwargs['SPLIT_K'] == 1 or config.kwargs['SPLIT_K'] * M * N <= named_args['W'].numel()
+    ]
+
     # group configs by (BLOCK_M,_N,_K, SPLIT_K, num_warps)
     configs_map = {}
     for config in configs:
@@ -169,3 +179,45 @@ def early_config_prune(configs, named_args, **kwargs):
             random_config.num_stages = 2
             pruned_configs.append(random_config)
     return pruned_configs
+
+
+def estimate_occupancy(kernel, device):
+    ''' return the number of CTAs of a compiled kernel that fit on an SM '''
+    props = driver.active.utils.get_device_properties(device)
+    occupancy = compute_occupancy(props, kernel.metadata.num_warps, kernel.metadata.target.warp_size, kernel.n_regs,
+                                  kernel.metadata.shared, kernel.metadata.cluster_dims)
+    return occupancy["blocks_per_sm"]
+
+
+def kernel_stats_prune(kernels, named_args, slack=2.0, **kwargs):
+    ''' prune compiled configs that are clearly losing:
+          - kernels that can't be launched (shared memory, registers)
+          - kernels that spill registers if others don't
+          - kernels whose estimated time, accounting for the waves of CTAs
+            given their occupancy, is more than `slack` times the best one '''
+    device = torch.cuda.current_device()
+    num_sm = driver.active.utils.get_device_properties(device)["multiprocessor_count"]
+    loaded = {}
+    for config, kernel in kernels.items():
+        try:
+            kernel._init_handles()
+        except OutOfResources:
+            continue
+        occupancy = estimate_occupancy(kernel, device)
+        if occupancy > 0:
+            loaded[config] = (kernel, occupancy)
+    if any(kernel.n_spills == 0 for kernel, _ in loaded.values()):
+        loaded = {config: value for config, value in loaded.items() if value[0].n_spills == 0}
+
+    est_timing = {}
+    for config, (kernel, occupancy) in loaded.items():
+        kw = config.kwargs
+        num_ctas = cdiv(named_args['M'], kw['BLOCK_M']) * cdiv(named_args['N'], kw['BLOCK_N']) * kw['SPLIT_K']
+        # the last wave of CTAs leaves SMs idle
+        waves = num_ctas / (num_sm * occupancy)
+        efficiency = waves / math.ceil(waves)
+        est_timing[config] = estimate_matmul_time(**named_args, **kwargs, **config.all_kwargs()) / efficiency
+    if not est_timing:
+        return list(kernels.keys())
+    best = min(est_timing.values())
+    return [config for config, timing in est_timing.items() if timing <= slack * best]
@@ -0,0 +1,380 @@
+"""
+Inference Attention
+===================
+Forward attention kernels for serving:
+
+- `varlen_attention` runs the prefill of a batch of sequences of different
+  lengths packed along the token dimension, with grouped-query attention and
+  causal or sliding-window masks. The blocks of keys that no query of a tile
+  sees are skipped, and only the blocks on the edges of the masks are masked.
+- `paged_attention` runs the decoding step of a batch of sequences whose keys
+  and values live in a paged cache addressed by block tables. The keys of each
+  sequence are split between several programs, whose partial outputs are then
+  merged by a reduction kernel (see: Dao et al., Flash-Decoding,
+  https://crfm.stanford.edu/2023/10/12/flashdecoding.html). On Hopper, the
+  splits of a sequence run as the CTAs of a cluster and merge their partials
+  through distributed shared memory instead, in the same kernel.
+
+The query heads that share a key/value head are computed by the same program,
+so that the keys and values are loaded once per group.
+"""
+
+import torch
+import triton
+
+from .. import cdiv, jit, next_power_of_2
+from .. import language as tl
+from .flash_attention import is_hip
+
+
+@jit
+def _online_softmax(qk, m_i, l_i, acc):
+    # the scores are in the log2 domain; rows that haven't seen a key yet use a
+    # zero max to avoid computing -inf - -inf
+    m_new = tl.maximum(m_i, tl.max(qk, 1))
+    m_safe = tl.where(m_new == float("-inf"), 0.0, m_new)
+    alpha = tl.math.exp2(m_i - m_safe)
+    p = tl.math.exp2(qk - m_safe[:, None])
+    return p, m_new, l_i * alpha + tl.sum(p, 1), acc * alpha[:, None]
+
+
+@jit
+def _varlen_fwd_inner(acc, l_i, m_i, q, K, V, stride_kt, stride_vt, qk_scale,  #
+                      offs_m, lo, hi, k_len, shift,  #
+                      MASKED: tl.constexpr, IS_CAUSAL: tl.constexpr, WINDOW: tl.constexpr,  #
+                      BLOCK_N: tl.constexpr, HEAD_DIM: tl.constexpr):
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_d = tl.arange(0, HEAD_DIM)
+    for start_n in range(lo, hi, BLOCK_N):
+        cols = start_n + offs_n
+        k_ptrs = K + cols[None, :] * stride_kt + offs_d[:, None]
+        v_ptrs = V + cols[:, None] * stride_vt + offs_d[None, :]
+        if MASKED:
+            k = tl.load(k_ptrs, mask=cols[None, :] < k_len, other=0.0)
+        else:
+            k = tl.load(k_ptrs)
+        qk = tl.dot(q, k) * qk_scale
+        if MASKED:
+            visible = cols[None, :] < k_len
+            if IS_CAUSAL:
+                visible = visible & (cols[None, :] <= offs_m[:, None] + shift)
+            if WINDOW > 0:
+                visible = visible & (cols[None, :] > offs_m[:, None] + shift - WINDOW)
+            qk = tl.where(visible, qk, float("-inf"))
+        p, m_i, l_i, acc = _online_softmax(qk, m_i, l_i, acc)
+        if MASKED:
+            v = tl.load(v_ptrs, mask=cols[:, None] < k_len, other=0.0)
+        else:
+            v = tl.load(v_ptrs)
+        acc += tl.dot(p.to(V.dtype.element_ty), v)
+    return acc, l_i, m_i
+
+
+@jit
+def _varlen_fwd_kernel(Q, K, V, Out, qk_scale,  #
+                       cu_seqlens_q, cu_seqlens_k,  #
+                       stride_qt, stride_qh,  #
+                       stride_kt, stride_kh,  #
+                       stride_vt, stride_vh,  #
+                       stride_ot, stride_oh,  #
+                       GROUP_SIZE: tl.constexpr,  #
+                       IS_CAUSAL: tl.constexpr, WINDOW: tl.constexpr,  #
+                       BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,  #
+                       HEAD_DIM: tl.constexpr  #
+                       ):
+    start_m = tl.program_id(0)
+    off_h = tl.program_id(1)
+    seq = tl.program_id(2)
+    q_start = tl.load(cu_seqlens_q + seq)
+    q_len = tl.load(cu_seqlens_q + seq + 1) - q_start
+    if start_m * BLOCK_M >= q_len:
+        return
+    k_start = tl.load(cu_seqlens_k + seq)
+    k_len = tl.load(cu_seqlens_k + seq + 1) - k_start
+    off_kh = off_h // GROUP_SIZE
+
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_d = tl.arange(0, HEAD_DIM)
+    Q += q_start.to(tl.int64) * stride_qt + off_h * stride_qh
+    K += k_start.to(tl.int64) * stride_kt + off_kh * stride_kh
+    V += k_start.to(tl.int64) * stride_vt + off_kh * stride_vh
+    q = tl.load(Q + offs_m[:, None] * stride_qt + offs_d[None, :], mask=offs_m[:, None] < q_len, other=0.0)
+
+    # The queries are the last tokens of the sequence: query i sees the keys up
+    # to i + shift, as when the keys of a prefix are already cached.
+    shift = k_len - q_len
+    first_row = start_m * BLOCK_M + shift
+    last_row = first_row + BLOCK_M - 1
+    # Some row of the tile sees the keys in [lo, hi) and every row sees the
+    # blocks of keys in [full_lo, full_hi), which are computed without masks.
+    lo = 0
+    hi = k_len
+    full_lo = 0
+    full_hi = k_len // BLOCK_N * BLOCK_N
+    if IS_CAUSAL:
+        hi = tl.minimum(hi, last_row + 1)
+        full_hi = tl.minimum(full_hi, tl.maximum(first_row + 1, 0) // BLOCK_N * BLOCK_N)
+    if WINDOW > 0:
+        lo = tl.maximum(first_row - WINDOW + 1, 0) // BLOCK_N * BLOCK_N
+        full_lo = tl.cdiv(tl.maximum(last_row - WINDOW + 1, 0), BLOCK_N) * BLOCK_N
+    full_lo = tl.minimum(tl.maximum(full_lo, lo), hi)
+    full_hi = tl.maximum(full_hi, full_lo)
+
+    m_i = tl.zeros([BLOCK_M], dtype=tl.float32) - float("inf")
+    l_i = tl.zeros([BLOCK_M], dtype=tl.float32)
+    acc = tl.zeros([BLOCK_M, HEAD_DIM], dtype=tl.float32)
+    acc, l_i, m_i = _varlen_fwd_inner(acc, l_i, m_i, q, K, V, stride_kt, stride_vt, qk_scale,  #
+                                      offs_m, lo, full_lo, k_len, shift,  #
+                                      True, IS_CAUSAL, WINDOW, BLOCK_N, HEAD_DIM)
+    acc, l_i, m_i = _varlen_fwd_inner(acc, l_i, m_i, q, K, V, stride_kt, stride_vt, qk_scale,  #
+                                      offs_m, full_lo, full_hi, k_len, shift,  #
+                                      False, IS_CAUSAL, WINDOW, BLOCK_N, HEAD_DIM)
+    acc, l_i, m_i = _varlen_fwd_inner(acc, l_i, m_i, q, K, V, stride_kt, stride_vt, qk_scale,  #
+                                      offs_m, full_hi, hi, k_len, shift,  #
+                                      True, IS_CAUSAL, WINDOW, BLOCK_N, HEAD_DIM)
+    # rows that see no key, e.g. when there are fewer keys than queries, are zero
+    acc = acc / tl.where(l_i == 0.0, 1.0, l_i)[:, None]
+    o_ptrs = Out + q_start.to(tl.int64) * stride_ot + off_h * stride_oh + offs_m[:, None] * stride_ot + offs_d[None, :]
+    tl.store(o_ptrs, acc.to(Out.dtype.element_ty), mask=offs_m[:, None] < q_len)
+
+
+@jit
+def _paged_decode_kernel(Q, K_cache, V_cache, Block_tables, Seq_lens, Out,  #
+                         Out_partial, Lse_partial, qk_scale, kv_per_split,  #
+                         stride_qb, stride_qh,  #
+                         stride_kp, stride_kt, stride_kh,  #
+                         stride_vp, stride_vt, stride_vh,  #
+                         stride_tb,  #
+                         stride_b, stride_h,  #
+                         stride_ob, stride_oh, stride_os,  #
+                         stride_lb, stride_lh,  #
+                         GROUP_SIZE: tl.constexpr, BLOCK_G: tl.constexpr,  #
+                         PAGE_SIZE: tl.constexpr, WINDOW: tl.constexpr,  #
+                         BLOCK_N: tl.constexpr, HEAD_DIM: tl.constexpr,  #
+                         CLUSTER_REDUCE: tl.constexpr  #
+                         ):
+    seq = tl.program_id(0)
+    off_kh = tl.program_id(1)
+    split = tl.program_id(2)
+    seq_len = tl.load(Seq_lens + seq)
+    # the splits divide the keys seen by the query
+    first = 0
+    if WINDOW > 0:
+        first = tl.maximum(seq_len - WINDOW, 0)
+    start = first + split * kv_per_split
+    end = tl.minimum(start + kv_per_split, seq_len)
+
+    # the query heads of the group are the rows of the dots
+    offs_g = tl.arange(0, BLOCK_G)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_d = tl.arange(0, HEAD_DIM)
+    heads = off_kh * GROUP_SIZE + offs_g
+    in_group = offs_g < GROUP_SIZE
+    q = tl.load(Q + seq * stride_qb + heads[:, None] * stride_qh + offs_d[None, :], mask=in_group[:, None], other=0.0)
+    Block_tables += seq * stride_tb
+    K_cache += off_kh * stride_kh
+    V_cache += off_kh * stride_vh
+
+    m_i = tl.zeros([BLOCK_G], dtype=tl.float32) - float("inf")
+    l_i = tl.zeros([BLOCK_G], dtype=tl.float32)
+    acc = tl.zeros([BLOCK_G, HEAD_DIM], dtype=tl.float32)
+    for start_n in range(start, end, BLOCK_N):
+        cols = start_n + offs_n
+        in_seq = cols < end
+        pages = tl.load(Block_tables + cols // PAGE_SIZE, mask=in_seq, other=0).to(tl.int64)
+        slots = cols % PAGE_SIZE
+        k_ptrs = K_cache + pages[None, :] * stride_kp + slots[None, :] * stride_kt + offs_d[:, None]
+        k = tl.load(k_ptrs, mask=in_seq[None, :], other=0.0)
+        qk = tl.dot(q, k) * qk_scale
+        qk = tl.where(in_seq[None, :], qk, float("-inf"))
+        p, m_i, l_i, acc = _online_softmax(qk, m_i, l_i, acc)
+        v_ptrs = V_cache + pages[:, None] * stride_vp + slots[:, None] * stride_vt + offs_d[None, :]
+        v = tl.load(v_ptrs, mask=in_seq[:, None], other=0.0)
+        acc += tl.dot(p.to(V_cache.dtype.element_ty), v)
+
+    if CLUSTER_REDUCE:
+        # the splits of the sequence are the programs of a cluster; splits
+        # without keys have a zero weight
+        m = tl.cluster_reduce(m_i, "max")
+        alpha = tl.math.exp2(m_i - tl.where(m == float("-inf"), 0.0, m))
+        l_sum = tl.cluster_reduce(l_i * alpha, "sum")
+        acc = tl.cluster_reduce(acc * alpha[:, None], "sum")
+        if split == 0:
+            out = acc / tl.where(l_sum == 0.0, 1.0, l_sum)[:, None]
+            o_ptrs = Out + seq * stride_b + heads[:, None] * stride_h + offs_d[None, :]
+            tl.store(o_ptrs, out.to(Out.dtype.element_ty), mask=in_group[:, None])
+    else:
+        # splits without keys have a zero output and don't count in the reduction
+        lse = tl.where(l_i == 0.0, float("-inf"), m_i + tl.math.log2(l_i))
+        acc = acc / tl.where(l_i == 0.0, 1.0, l_i)[:, None]
+        o_ptrs = Out_partial + seq * stride_ob + heads[:, None] * stride_oh + split * stride_os + offs_d[None, :]
+        tl.store(o_ptrs, acc, mask=in_group[:, None])
+        tl.store(Lse_partial + seq * stride_lb + heads * stride_lh + split, lse, mask=in_group)
+
+
+@jit
+def _paged_decode_reduce_kernel(Out_partial, Lse_partial, Out, num_splits,  #
+                                stride_ob, stride_oh, stride_os,  #
+                                stride_lb, stride_lh,  #
+                                stride_b, stride_h,  #
+                                BLOCK_S: tl.constexpr, HEAD_DIM: tl.constexpr  #
+                                ):
+    seq = tl.program_id(0)
+    head = tl.program_id(1)
+    offs_s = tl.arange(0, BLOCK_S)
+    offs_d = tl.arange(0, HEAD_DIM)
+    in_splits = offs_s < num_splits
+    lse = tl.load(Lse_partial + seq * stride_lb + head * stride_lh + offs_s, mask=in_splits, other=float("-inf"))
+    m = tl.max(lse, 0)
+    m = tl.where(m == float("-inf"), 0.0, m)
+    weights = tl.math.exp2(lse - m)
+    o_ptrs = Out_partial + seq * stride_ob + head * stride_oh + offs_s[:, None] * stride_os + offs_d[None, :]
+    o = tl.load(o_ptrs, mask=in_splits[:, None], other=0.0)
+    total = tl.sum(weights, 0)
+    out = tl.sum(o * weights[:, None], 0) / tl.where(total == 0.0, 1.0, total)
+    tl.store(Out + seq * stride_b + head * stride_h + offs_d, out.to(Out.dtype.element_ty))
+
+
+def _check_heads(q, k, v):
+    head_dim = q.shape[-1]
+    assert head_dim in {16, 32, 64, 128, 256}, "head dimension must be a power of two between 16 and 256"
+    assert k.shape == v.shape and k.shape[-1] == head_dim
+    assert q.shape[-2] % k.shape[-2] == 0, "query heads must be a multiple of key/value heads"
+    assert q.stride(-1) == 1 and k.stride(-1) == 1 and v.stride(-1) == 1
+    return head_dim, q.shape[-2] // k.shape[-2]
+
+
+def _prefill_config(head_dim):
+    # BLOCK_M, BLOCK_N, num_warps, num_stages: the dots are lowered to
+    # wgmma on Hopper and to MFMA on CDNA, both fed by the software pipeliner
+    block_n = 64 if head_dim <= 128 else 32
+    num_warps = 4 if head_dim <= 64 else 8
+    if is_hip():
+        return 128, block_n, num_warps, 2
+    return 128, block_n, num_warps, 3 if head_dim <= 128 else 2
+
+
+def varlen_attention(q, k, v, cu_seqlens_q, cu_seqlens_k, max_seqlen_q, causal=True, window=0, sm_scale=None):
+    """
+    Computes the attention of sequences packed along the first dimension.
+
+    :param q: queries of shape (total_q, num_heads, head_dim)
+    :param k: keys of shape (total_k, num_kv_heads, head_dim)
+    :param v: values of shape (total_k, num_kv_heads, head_dim)
+    :param cu_seqlens_q: int32 offsets of the sequences in `q`, of shape (batch + 1,)
+    :param cu_seqlens_k: int32 offsets of the sequences in `k` and `v`, of shape (batch + 1,)
+    :param max_seqlen_q: length of the longest query sequence
+    :param causal: whether query i only sees the keys up to i + len(k) - len(q)
+    :param window: if positive, number of keys seen by each query, ending with its own position
+    :param sm_scale: scale of the scores, defaults to 1 / sqrt(head_dim)
+    """
+    head_dim, group_size = _check_heads(q, k, v)
+    if sm_scale is None:
+        sm_scale = head_dim**-0.5
+    o = torch.empty_like(q)
+    block_m, block_n, num_warps, num_stages = _prefill_config(head_dim)
+    batch = cu_seqlens_q.numel() - 1
+    grid = (cdiv(max_seqlen_q, block_m), q.shape[1], batch)
+    _varlen_fwd_kernel[grid](
+        q, k, v, o, sm_scale * 1.44269504,  #
+        cu_seqlens_q, cu_seqlens_k,  #
+        q.stride(0), q.stride(1),  #
+        k.stride(0), k.stride(1),  #
+        v.stride(0), v.stride(1),  #
+        o.stride(0), o.stride(1),  #
+        GROUP_SIZE=group_size,  #
+        IS_CAUSAL=causal, WINDOW=window,  #
+        BLOCK_M=block_m, BLOCK_N=block_n,  #
+        HEAD_DIM=head_dim,  #
+        num_warps=num_warps,  #
+        num_stages=num_stages  #
+    )
+    return o
+
+
+# the largest cluster that every Hopper GPU can schedule
+MAX_CLUSTER_SIZE = 8
+
+
+def _use_cluster_reduce(num_splits):
+    if is_hip() or num_splits == 1:
+        return False
+    return num_splits <= MAX_CLUSTER_SIZE and torch.cuda.get_device_capability()[0] >= 9
+
+
+def _num_splits(programs, max_kv, block_n):
+    # enough programs to fill the device twice, with at least a block of keys each
+    num_sms = triton.runtime.driver.active.utils.get_device_properties(
+        torch.cuda.current_device())["multiprocessor_count"]
+    max_splits = 64
+    if not is_hip() and torch.cuda.get_device_capability()[0] >= 9:
+        max_splits = MAX_CLUSTER_SIZE
+    return max(1, min(cdiv(2 * num_sms, programs), cdiv(max_kv, block_n), max_splits))
+
+
+def paged_attention(q, k_cache, v_cache, block_tables, seq_lens, sm_scale=None, window=0, num_splits=None):
+    """
+    Computes the attention of the last token of each sequence to the keys and
+    values of the sequence, which are stored in pages of a cache.
+
+    :param q: queries of shape (batch, num_heads, head_dim)
+    :param k_cache: keys of shape (num_pages, page_size, num_kv_heads, head_dim)
+    :param v_cache: values of shape (num_pages, page_size, num_kv_heads, head_dim)
+    :param block_tables: int32 pages of each sequence, of shape (batch, max_pages)
+    :param seq_lens: int32 number of keys of each sequence, of shape (batch,)
+    :param sm_scale: scale of the scores, defaults to 1 / sqrt(head_dim)
+    :param window: if positive, number of keys seen by the query, ending with its own position
+    :param num_splits: number of programs the keys of each sequence are split between,
+        chosen from the batch size and the size of the device by default. On Hopper, up
+        to 8 splits are merged within the kernel.
+    """
+    head_dim, group_size = _check_heads(q, k_cache, v_cache)
+    if sm_scale is None:
+        sm_scale = head_dim**-0.5
+    batch, num_heads = q.shape[0], q.shape[1]
+    num_kv_heads, page_size = k_cache.shape[2], k_cache.shape[1]
+    block_n = 64
+    # the longest sequence the block tables can hold, which avoids a sync
+    max_kv = block_tables.shape[1] * page_size
+    if window > 0:
+        max_kv = min(max_kv, window)
+    if num_splits is None:
+        num_splits = _num_splits(batch * num_kv_heads, max_kv, block_n)
+    kv_per_split = cdiv(cdiv(max_kv, num_splits), block_n) * block_n
+    o = torch.empty_like(q)
+    cluster_reduce = _use_cluster_reduce(num_splits)
+    if cluster_reduce:
+        # the partials never leave the cluster
+        o_partial = torch.empty((0, 0, 0), device=q.device, dtype=torch.float32)
+        lse_partial = torch.empty((0, 0), device=q.device, dtype=torch.float32)
+    else:
+        o_partial = torch.empty((batch, num_heads, num_splits, head_dim), device=q.device, dtype=torch.float32)
+        lse_partial = torch.empty((batch, num_heads, num_splits), device=q.device, dtype=torch.float32)
+    _paged_decode_kernel[(batch, num_kv_heads, num_splits)](
+        q, k_cache, v_cache, block_tables, seq_lens, o,  #
+        o_partial, lse_partial, sm_scale * 1.44269504, kv_per_split,  #
+        q.stride(0), q.stride(1),  #
+        k_cache.stride(0), k_cache.stride(1), k_cache.stride(2),  #
+        v_cache.stride(0), v_cache.stride(1), v_cache.stride(2),  #
+        block_tables.stride(0),  #
+        o.stride(0), o.stride(1),  #
+        o_partial.stride(0), o_partial.stride(1), o_partial.stride(2),  #
+        lse_partial.stride(0), lse_partial.stride(1),  #
+        GROUP_SIZE=group_size, BLOCK_G=max(16, next_power_of_2(group_size)),  #
+        PAGE_SIZE=page_size, WINDOW=window,  #
+        BLOCK_N=block_n, HEAD_DIM=head_dim,  #
+        CLUSTER_REDUCE=cluster_reduce,  #
+        num_warps=4,  #
+        num_stages=2,  #
+        cluster_dims=(1, 1, num_splits if cluster_reduce else 1)  #
+    )
+    if cluster_reduce:
+        return o
+    _paged_decode_reduce_kernel[(batch, num_heads)](
+        o_partial, lse_partial, o, num_splits,  #
+        o_partial.stride(0), o_partial.stride(1), o_partial.stride(2),  #
+        lse_partial.stride(0), lse_partial.stride(1),  #
+        o.stride(0), o.stride(1),  #
+        BLOCK_S=next_power_of_2(num_splits), HEAD_DIM=head_dim  #
+    )
+    return o
@@ -0,0 +1,74 @@
+import torch
+
+from .. import cdiv, jit
+from .. import language as tl
+
+# Status of a tile in the look-back workspace. Each tile publishes a single
+# 64-bit word holding its status in the upper half and a 32-bit value in the
+# lower half, so that status and value always become visible together.
+_INVALID = tl.constexpr(0)
+_AGGREGATE = tl.constexpr(1)
+_PREFIX = tl.constexpr(2)
+
+
+@jit
+def _pack(value, status):
+    bits = value.to(tl.int32, bitcast=True).to(tl.uint32, bitcast=True).to(tl.int64)
+    return bits | (status.to(tl.int64) << 32)
+
+
+@jit
+def _unpack(word, dtype: tl.constexpr):
+    return word.to(tl.int32).to(dtype, bitcast=True)
+
+
+@jit
+def _cumsum_kernel(X, Y, State, Counter, N, BLOCK: tl.constexpr):
+    # Tiles are numbered in the order in which they start, so a tile only ever
+    # waits on tiles that are already running.
+    tile = tl.atomic_add(Counter, 1)
+    offs = tile * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    x = tl.load(X + offs, mask=mask, other=0)
+    if x.dtype.is_floating():
+        x = x.to(tl.float32)
+    aggregate = tl.sum(x, 0)
+    # Publish the aggregate of this tile right away so that the following
+    # tiles can make progress; the first tile knows its inclusive prefix.
+    status = tl.where(tile == 0, _PREFIX, _AGGREGATE)
+    tl.atomic_xchg(State + tile, _pack(aggregate, status))
+    # Decoupled look-back: walk the preceding tiles, adding their aggregates,
+    # until one of them has published its inclusive prefix. A tile that has
+    # not published anything yet reads as zero and is polled again.
+    prefix = tl.zeros_like(aggregate)
+    pred = tile - 1
+    while pred >= 0:
+        word = tl.atomic_add(State + pred, 0)
+        pred_status = (word >> 32).to(tl.int32)
+        prefix += _unpack(word, aggregate.dtype)
+        pred = tl.where(pred_status == _PREFIX, -1, tl.where(pred_status == _AGGREGATE, pred - 1, pred))
+    if tile > 0:
+        tl.atomic_xchg(State + tile, _pack(prefix + aggregate, _PREFIX))
+    y = tl.cumsum(x, 0) + prefix
+    tl.store(Y + offs, y.to(Y.dtype.element_ty), mask=mask)
+
+
+def cumsum(x, BLOCK=4096, num_warps=8):
+    """
+    Inclusive prefix sum of the 1D tensor :code:`x` in a single pass over
+    memory, using decoupled look-back across program ids. Floating point
+    inputs are accumulated in float32.
+    """
+    assert x.dim() == 1, "only 1D tensors are supported"
+    assert x.dtype in [torch.float16, torch.bfloat16, torch.float32, torch.int32], \
+        f"unsupported dtype {x.dtype}"
+    x = x.contiguous()
+    y = torch.empty_like(x)
+    N = x.numel()
+    if N == 0:
+        return y
+    num_tiles = cdiv(N, BLOCK)
+    state = torch.zeros(num_tiles, device=x.device, dtype=torch.int64)
+    counter = torch.zeros(1, device=x.device, dtype=torch.int32)
+    _cumsum_kernel[(num_tiles, )](x, y, state, counter, N, BLOCK=BLOCK, num_warps=num_warps)
+    return y
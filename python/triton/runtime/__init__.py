@@ -1,8 +1,11 @@
-from .autotuner import (Autotuner, Config, Heuristics, autotune, heuristics)
+from .autotuner import (Autotuner, Config, Heuristics, autotune, heuristics, prune_clustered_configs,
+                        prune_spilling_configs)
 from .cache import RedisRemoteCacheBackend, RemoteCacheBackend
 from .driver import driver
 from .jit import JITFunction, KernelInterface, MockTensor, TensorWrapper, reinterpret
 from .errors import OutOfResources, InterpreterError
+from .launch_queue import LaunchQueue
+from .multi_tensor import multi_tensor_apply
 
 __all__ = [
     "autotune",
@@ -14,8 +17,12 @@ __all__ = [
     "InterpreterError",
     "JITFunction",
     "KernelInterface",
+    "LaunchQueue",
     "MockTensor",
+    "multi_tensor_apply",
     "OutOfResources",
+    "prune_clustered_configs",
+    "prune_spilling_configs",
     "RedisRemoteCacheBackend",
     "reinterpret",
     "RemoteCacheBackend",
@@ -1,12 +1,17 @@
 from __future__ import annotations
 
 import builtins
+import hashlib
+import json
+import math
 import os
 import time
 import inspect
+from concurrent.futures import ThreadPoolExecutor
 from typing import Dict
 
 from ..testing import do_bench, do_bench_cudagraph
+from .driver import driver
 from .jit import KernelInterface
 from .errors import OutOfResources
 
@@ -27,12 +32,14 @@ class Autotuner(KernelInterface):
         warmup=25,
         rep=100,
         use_cuda_graph=False,
+        cache_results=False,
     ):
         """
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It takes configs:List[Config] as its input, and returns pruned configs.
+            'kernel_prune'(optional): a function used to prune configs once they are compiled. It takes kernels:Dict[Config, CompiledKernel] as its input, and returns pruned configs.
         """
         if not configs:
             self.configs = [Config({}, num_warps=4, num_stages=2, num_ctas=1)]
@@ -79,10 +86,12 @@ class Autotuner(KernelInterface):
         self.perf_model = None
         self.configs_top_k = 1.0
         self.early_config_prune = None
+        self.kernel_prune = None
         if prune_configs_by:
             self.perf_model = prune_configs_by.get("perf_model", self.perf_model)
             self.configs_top_k = prune_configs_by.get("top_k", self.configs_top_k)
             self.early_config_prune = prune_configs_by.get("early_config_prune", self.early_config_prune)
+            self.kernel_prune = prune_configs_by.get("kernel_prune", self.kernel_prune)
 
         self.fn = fn
         self.base_fn = fn
@@ -92,13 +101,14 @@ class Autotuner(KernelInterface):
         self.num_reps = rep
         import torch
         self.use_cuda_graph = use_cuda_graph and torch.cuda.is_available()
+        self.cache_results = cache_results or os.getenv("TRITON_CACHE_AUTOTUNING", None) == "1"
 
     def _bench(self, *args, config, **meta):
         from ..compiler.errors import CompileTimeAssertionFailure
 
         # check for conflicts, i.e. meta-parameters both provided
         # as kwargs and by the autotuner
-        conflicts = meta.keys() & config.kwargs.keys()
+        conflicts = meta.keys() & (config.kwargs.keys() | config.options.keys())
         if conflicts:
             raise ValueError(f"Conflicting meta-parameters: {', '.join(conflicts)}."
                              " Make sure that you don't re-define auto-tuned symbols.")
@@ -134,6 +144,97 @@ class Autotuner(KernelInterface):
         except (OutOfResources, CompileTimeAssertionFailure):
             return float("inf") if self.use_cuda_graph else [float("inf"), float("inf"), float("inf")]
 
+    def _check_disk_cache(self, tuning_key, configs, benchmark):
+        """
+        Look up the best config of `tuning_key` in the cache of compiled kernels, or call `benchmark` and record it.
+        Returns True if the result was found in the cache.
+        """
+        from .._C.libtriton import get_cache_invalidating_env_vars
+        from ..compiler.compiler import make_backend, triton_key
+        from .cache import get_cache_manager
+        from .jit import JITFunction
+        import torch
+
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        device = driver.active.get_current_device()
+        env_vars = get_cache_invalidating_env_vars()
+        cache_key = [
+            triton_key(),
+            make_backend(driver.active.get_current_target()).hash(),
+            torch.cuda.get_device_name(device),
+            fn.cache_key,
+            str(sorted(env_vars.items())),
+            str(tuning_key),
+        ] + [str(config) for config in configs]
+        cache_key = hashlib.sha256("-".join(cache_key).encode("utf-8")).hexdigest()
+        # Shared with compiled kernels, so that TRITON_CACHE_MANAGER also selects a remote cache for tuning results
+        cache = get_cache_manager(cache_key)
+        file_name = f"{fn.__name__[:150]}.autotune.json"
+        path = cache.get_file(file_name)
+        if path is not None:
+            with open(path) as f:
+                cached = json.load(f)
+            # Configs are matched by their string, so that the configs found keep their pre_hook
+            configs_by_name = {str(config): config for config in configs}
+            timings = {
+                configs_by_name[name]: timing
+                for name, timing in cached["configs_timings"]
+                if name in configs_by_name
+            }
+            if cached["best_config"] in configs_by_name:
+                self.cache[tuning_key] = configs_by_name[cached["best_config"]]
+                self.configs_timings = timings
+                return True
+        benchmark()
+        cache.put(
+            json.dumps({
+                "key": str(tuning_key),
+                "best_config": str(self.cache[tuning_key]),
+                "configs_timings": [(str(config), timing) for config, timing in self.configs_timings.items()],
+            }), file_name, binary=False)
+        return False
+
+    def _precompile(self, *args, configs, **kwargs):
+        # Compile the configs concurrently so that they are benchmarked from the cache.
+        # The MLIR and LLVM pipelines release the GIL, which lets the threads scale.
+        # Returns the compiled kernel of every config that compiles.
+        num_threads = os.getenv("TRITON_AUTOTUNE_COMPILE_THREADS", None)
+        num_threads = int(num_threads) if num_threads is not None else (os.cpu_count() or 1)
+        num_threads = builtins.min(num_threads, len(configs))
+        if num_threads <= 1 and not self.kernel_prune and not any(config.is_clustered() for config in configs):
+            return {}
+        # The current device is per thread
+        device = driver.active.get_current_device()
+
+        def compile_config(config):
+            driver.active.set_current_device(device)
+            try:
+                return self.fn.run(*args, **dict(kwargs, warmup=True), **config.all_kwargs())
+            except Exception:
+                # The error is raised again, and handled, when the config is benchmarked
+                return None
+
+        if num_threads <= 1:
+            kernels = [compile_config(config) for config in configs]
+        else:
+            with ThreadPoolExecutor(max_workers=num_threads) as executor:
+                kernels = list(executor.map(compile_config, configs))
+        return {config: kernel for config, kernel in zip(configs, kernels) if kernel is not None}
+
+    def _prune_compiled_configs(self, configs, kernels, kwargs):
+        if not kernels:
+            return configs
+        kept = set(kernels.keys())
+        if any(config.is_clustered() for config in kernels):
+            kept = set(prune_clustered_configs(kernels, self.nargs, **kwargs))
+        if self.kernel_prune:
+            kept &= set(self.kernel_prune({config: kernels[config] for config in kept}, self.nargs, **kwargs))
+        # Configs that failed to compile are benchmarked to report their errors
+        pruned_configs = [config for config in configs if config in kept or config not in kernels]
+        return pruned_configs if pruned_configs else configs
+
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
         used_cached_result = True
@@ -152,13 +253,22 @@ class Autotuner(KernelInterface):
                 # prune configs
                 used_cached_result = False
                 pruned_configs = self.prune_configs(kwargs)
-                bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs) for config in pruned_configs}
-                bench_end = time.time()
-                self.bench_time = bench_end - bench_start
-                self.cache[key] = builtins.min(timings, key=timings.get)
-                self.pre_hook(args, reset_only=True)
-                self.configs_timings = timings
+
+                def benchmark():
+                    bench_start = time.time()
+                    kernels = self._precompile(*args, configs=pruned_configs, **kwargs)
+                    bench_configs = self._prune_compiled_configs(pruned_configs, kernels, kwargs)
+                    timings = {config: self._bench(*args, config=config, **kwargs) for config in bench_configs}
+                    bench_end = time.time()
+                    self.bench_time = bench_end - bench_start
+                    self.cache[key] = builtins.min(timings, key=timings.get)
+                    self.pre_hook(args, reset_only=True)
+                    self.configs_timings = timings
+
+                if self.cache_results:
+                    used_cached_result = self._check_disk_cache(key, pruned_configs, benchmark)
+                else:
+                    benchmark()
             config = self.cache[key]
         else:
             config = self.configs[0]
@@ -223,30 +333,45 @@ class Config:
                        Mostly useful for matrix multiplication workloads on SM80+ GPUs.
     :type num_ctas: int
     :ivar num_ctas: number of blocks in a block cluster. SM90+ only.
+    :type cluster_dims: Optional[tuple[int, int, int]]
+    :ivar cluster_dims: the programs per cluster when :code:`num_ctas` is 1. SM90+ only. Clustered configs whose
+                        clusters are not resident together as much as their blocks alone are pruned before they are
+                        benchmarked, see :code:`triton.runtime.prune_clustered_configs`.
     :type maxnreg: Optional[int]
     :ivar maxnreg: maximum number of registers one thread can use.  Corresponds
                        to ptx .maxnreg directive.  Not supported on all platforms.
     :ivar pre_hook: a function that will be called before the kernel is called. Parameters of this
                     function are args.
+    :type options: Optional[dict[Str, Any]]
+    :ivar options: options of the backend that override their defaults when the kernel is compiled, e.g.
+                   :code:`{"ptxas_options": ("-O2",), "llvm_opt_level": 2, "fast_math": True}` on NVIDIA GPUs.
+                   They are part of the key of the compiled kernel like the other options.
     """
 
-    def __init__(self, kwargs, num_warps=4, num_stages=2, num_ctas=1, maxnreg=None, pre_hook=None):
+    def __init__(self, kwargs, num_warps=4, num_stages=2, num_ctas=1, maxnreg=None, pre_hook=None,
+                 cluster_dims=None, options=None):
         self.kwargs = kwargs
         self.num_warps = num_warps
         self.num_ctas = num_ctas
         self.num_stages = num_stages
         self.maxnreg = maxnreg
         self.pre_hook = pre_hook
+        self.cluster_dims = tuple(cluster_dims) if cluster_dims is not None else None
+        self.options = {k: tuple(v) if isinstance(v, list) else v for k, v in (options or {}).items()}
+
+    def is_clustered(self):
+        return (self.num_ctas or 1) > 1 or (self.cluster_dims is not None and math.prod(self.cluster_dims) > 1)
 
     def all_kwargs(self):
         return {
-            **self.kwargs, **{
+            **self.kwargs, **self.options, **{
                 k: v
                 for (k, v) in (
                     ("num_warps", self.num_warps),
                     ("num_ctas", self.num_ctas),
                     ("num_stages", self.num_stages),
                     ("maxnreg", self.maxnreg),
+                    ("cluster_dims", self.cluster_dims),
                 ) if v is not None
             }
         }
@@ -259,11 +384,15 @@ class Config:
         res.append(f"num_ctas: {self.num_ctas}")
         res.append(f"num_stages: {self.num_stages}")
         res.append(f"maxnreg: {self.maxnreg}")
+        if self.cluster_dims is not None:
+            res.append(f"cluster_dims: {self.cluster_dims}")
+        for k, v in sorted(self.options.items()):
+            res.append(f"{k}: {v}")
         return ", ".join(res)
 
 
 def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_value=None, pre_hook=None, post_hook=None,
-             warmup=25, rep=100, use_cuda_graph=False):
+             warmup=25, rep=100, use_cuda_graph=False, cache_results=False):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
 
@@ -289,6 +418,11 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :code:`"1"`, Triton will print a message to stdout after autotuning each
     kernel, including the time spent autotuning and the best configuration.
 
+    The configurations are compiled concurrently before they are benchmarked.
+    The environment variable :code:`TRITON_AUTOTUNE_COMPILE_THREADS` sets the
+    number of compilation threads, which defaults to the number of CPUs. Set it
+    to :code:`"1"` to compile the configurations one by one.
+
     :param configs: a list of :code:`triton.Config` objects
     :type configs: list[triton.Config]
     :param key: a list of argument names whose change in value will trigger the evaluation of all provided configs.
@@ -297,6 +431,10 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
         'perf_model': performance model used to predicate running time with different configs, returns running time
         'top_k': number of configs to bench
         'early_config_prune'(optional): a function used to do early prune (eg, num_stages). It takes configs:List[Config] as its input, and returns pruned configs.
+        'kernel_prune'(optional): a function used to prune configs once they are compiled, before they are benchmarked, e.g. with the statistics of their kernels
+        (shared memory, registers, spills). It takes kernels:Dict[Config, CompiledKernel], named_args, and kwargs as its input, and returns pruned configs.
+        :code:`triton.runtime.prune_spilling_configs` prunes the configs that spill registers.
+        The clustered configs are pruned with :code:`triton.runtime.prune_clustered_configs` before.
     :param reset_to_zero: a list of argument names whose value will be reset to zero before evaluating any configs.
     :type reset_to_zero: list[str]
     :param restore_value: a list of argument names whose value will be restored after evaluating any configs.
@@ -315,16 +453,67 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, restore_va
     :type warmup: int
     :param rep: Repetition time (in ms) to pass to benchmarking, defaults to 100.
     :type rep: int
+    :param cache_results: Whether to cache the autotuning results on disk, next to the compiled kernels, so that
+        other processes with the same kernel, configs, device and Triton version skip the benchmarks.
+        The remote cache selected by :code:`TRITON_CACHE_MANAGER` is used as well. Setting the environment
+        variable :code:`TRITON_CACHE_AUTOTUNING` to :code:`"1"` enables it for all kernels. Defaults to False.
+    :type cache_results: bool
     """
 
     def decorator(fn):
         return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, restore_value, pre_hook=pre_hook,
                          post_hook=post_hook, prune_configs_by=prune_configs_by, warmup=warmup, rep=rep,
-                         use_cuda_graph=use_cuda_graph)
+                         use_cuda_graph=use_cuda_graph, cache_results=cache_results)
 
     return decorator
 
 
+def prune_spilling_configs(kernels, named_args, **kwargs):
+    """
+    A :code:`kernel_prune` function that drops the configs whose kernels spill registers, as reported by the
+    assembler, unless all of them do. The configs whose kernels the backend reports no spills for are kept.
+    """
+    spills = {config: getattr(kernel.metadata, "n_spills", 0) for config, kernel in kernels.items()}
+    kept = [config for config, n_spills in spills.items() if n_spills == 0]
+    return kept if kept else list(kernels.keys())
+
+
+def prune_clustered_configs(kernels, named_args, min_residency=0.5, **kwargs):
+    """
+    Drops the configs whose kernels run in clusters of blocks that can't be launched, or whose clusters, which are
+    scheduled together on a group of multiprocessors, leave fewer than :code:`min_residency` times the blocks
+    resident on the device that the kernels would have without clusters, as reported by the driver. The configs
+    whose kernels don't run in clusters, or on drivers that can't report their clusters, are kept.
+    """
+    utils = driver.active.utils
+    if not hasattr(utils, "cuOccupancyMaxActiveClusters"):
+        return list(kernels.keys())
+    kept = []
+    for config, kernel in kernels.items():
+        cluster_dims = tuple(kernel.metadata.cluster_dims)
+        cluster_size = math.prod(cluster_dims)
+        if cluster_size == 1:
+            kept.append(config)
+            continue
+        try:
+            kernel._init_handles()
+            max_active_clusters = utils.cuOccupancyMaxActiveClusters(kernel.function, kernel.metadata.shared,
+                                                                     *cluster_dims)
+        except Exception:
+            # e.g. out of resources, or clusters larger than the device supports
+            continue
+        if max_active_clusters == 0:
+            continue
+        # Without clusters, every multiprocessor holds the blocks its resources allow
+        occupancy = getattr(kernel.metadata, "occupancy", None)
+        if occupancy is not None:
+            unclustered_blocks = occupancy["max_active_clusters"] * cluster_size
+            if max_active_clusters * cluster_size < min_residency * unclustered_blocks:
+                continue
+        kept.append(config)
+    return kept if kept else list(kernels.keys())
+
+
 class Heuristics(KernelInterface):
 
     def __init__(self, fn, arg_names, values) -> None:
@@ -1,10 +1,16 @@
+import contextlib
 import importlib
 import json
+import mmap
 import os
+import struct
+import threading
 import uuid
 from abc import ABC, abstractmethod
+from collections import defaultdict
+from concurrent.futures import Future, ThreadPoolExecutor
 from pathlib import Path
-from typing import Dict, List, Optional
+from typing import Dict, Iterable, List, Optional, Tuple, Union
 import hashlib
 
 
@@ -45,6 +51,13 @@ class CacheManager(ABC):
     def put_group(self, filename: str, group: Dict[str, str]):
         pass
 
+    def compile_lock(self):
+        """
+        Returns a context manager held while compiling the kernel of the key, so that the processes sharing the cache
+        compile it once: the others wait for it, then find the kernel in the cache.
+        """
+        return contextlib.nullcontext()
+
 
 class FileCacheManager(CacheManager):
 
@@ -100,6 +113,23 @@ class FileCacheManager(CacheManager):
                 result[c] = p
         return result
 
+    @contextlib.contextmanager
+    def compile_lock(self):
+        # An advisory lock of the key directory, which is released when its holder exits or dies
+        try:
+            import fcntl
+        except ImportError:
+            fcntl = None
+        if self.lock_path is None or fcntl is None:
+            yield
+            return
+        with open(self.lock_path, "a") as f:
+            fcntl.flock(f, fcntl.LOCK_EX)
+            try:
+                yield
+            finally:
+                fcntl.flock(f, fcntl.LOCK_UN)
+
     # Note a group of pushed files as being part of a group
     def put_group(self, filename: str, group: Dict[str, str]) -> str:
         if not self.cache_dir:
@@ -147,6 +177,14 @@ class RemoteCacheBackend:
     def put(self, filename: str, data: bytes):
         pass
 
+    @classmethod
+    def get_many(cls, requests: Dict[str, List[str]]) -> Dict[str, Dict[str, bytes]]:
+        """
+        Returns the files found for many cache keys, by key, given the filenames to look up for each key. Backends
+        that can should override it to make a single round trip.
+        """
+        return {key: cls(key).get(filenames) for key, filenames in requests.items()}
+
 
 class RedisRemoteCacheBackend(RemoteCacheBackend):
 
@@ -169,16 +207,40 @@ class RedisRemoteCacheBackend(RemoteCacheBackend):
     def put(self, filename: str, data: bytes) -> Dict[str, bytes]:
         self._redis.set(self._get_key(filename), data)
 
+    @classmethod
+    def get_many(cls, requests: Dict[str, List[str]]) -> Dict[str, Dict[str, bytes]]:
+        if not requests:
+            return {}
+        # All the keys are on the same server, a single MGET looks them all up
+        backend = cls(next(iter(requests)))
+        lookups = [(key, filename) for key, filenames in requests.items() for filename in filenames]
+        results = backend._redis.mget(
+            [backend._key_fmt.format(key=key, filename=filename) for key, filename in lookups])
+        found = {key: {} for key in requests}
+        for (key, filename), result in zip(lookups, results):
+            if result is not None:
+                found[key][filename] = result
+        return found
+
+
+def get_remote_cache_backend_cls():
+    # Backend pointed to by `TRITON_REMOTE_CACHE_BACKEND`.
+    remote_cache_manager = os.environ["TRITON_REMOTE_CACHE_BACKEND"]
+    module_path, clz_nme = remote_cache_manager.split(":")
+    module = importlib.import_module(module_path)
+    return getattr(module, clz_nme)
+
+
+# (key, filename) -> future of the group prefetched by `prefetch_remote_cache`, None if it isn't in the remote cache
+_prefetched_groups: Dict[Tuple[str, str], Future] = {}
+_prefetched_groups_lock = threading.Lock()
+
 
 class RemoteCacheManager(CacheManager):
 
     def __init__(self, key, override=False, dump=False):
-        # Setup backend pointed too by `TRITON_REMOTE_CACHE_BACKEND`.
-        remote_cache_manager = os.environ["TRITON_REMOTE_CACHE_BACKEND"]
-        module_path, clz_nme = remote_cache_manager.split(":")
-        module = importlib.import_module(module_path)
-        remote_cache_cls = getattr(module, clz_nme)
-        self._backend = remote_cache_cls(key)
+        self._key = key
+        self._backend = get_remote_cache_backend_cls()(key)
 
         self._override = override
         self._dump = dump
@@ -186,6 +248,10 @@ class RemoteCacheManager(CacheManager):
         # Use a `FileCacheManager` to materialize remote cache paths locally.
         self._file_cache_manager = FileCacheManager(key, override=override, dump=dump)
 
+    def compile_lock(self):
+        # Only the processes sharing the local cache directory are serialized
+        return self._file_cache_manager.compile_lock()
+
     def _materialize(self, filename: str, data: bytes):
         # We use a backing `FileCacheManager` to provide the materialized data.
         return self._file_cache_manager.put(data, filename, binary=True)
@@ -219,6 +285,15 @@ class RemoteCacheManager(CacheManager):
         if self._dump or self._override:
             return self._file_cache_manager.get_group(filename)
 
+        with _prefetched_groups_lock:
+            prefetched = _prefetched_groups.pop((self._key, filename), None)
+        if prefetched is not None:
+            try:
+                return prefetched.result()
+            except Exception:
+                # The prefetch failed, look the group up again
+                pass
+
         grp_filename = f"__grp__{filename}"
         grp_filepath = self.get_file(grp_filename)
         if grp_filepath is None:
@@ -247,6 +322,188 @@ class RemoteCacheManager(CacheManager):
         return self.put(grp_contents, grp_filename)
 
 
+def write_cache_manifest(path, cache_dir=None) -> int:
+    """
+    Write the list of the kernels of a cache directory, which defaults to the directory of `FileCacheManager`, for
+    `prefetch_remote_cache` to fetch them at the start of later processes. Returns the number of kernels.
+    """
+    cache_dir = cache_dir or os.getenv("TRITON_CACHE_DIR", "").strip() or default_cache_dir()
+    entries = []
+    for key in sorted(os.listdir(cache_dir)):
+        key_dir = os.path.join(cache_dir, key)
+        if not os.path.isdir(key_dir):
+            continue
+        for filename in sorted(os.listdir(key_dir)):
+            # The outputs of intermediate stages are only needed to compile new kernels
+            if filename.startswith("__grp__") and not filename.endswith(".stage.json"):
+                entries.append([key, filename[len("__grp__"):]])
+    temp_path = f"{path}.tmp.pid_{os.getpid()}_{uuid.uuid4()}"
+    with open(temp_path, "w") as f:
+        json.dump(entries, f)
+    os.replace(temp_path, path)
+    return len(entries)
+
+
+def prefetch_remote_cache(manifest: Union[str, Iterable[Tuple[str, str]]], background=True,
+                          num_threads=16) -> Optional[Future]:
+    """
+    Fetch many kernels from the remote cache of `TRITON_REMOTE_CACHE_BACKEND`, and materialize their files in the
+    local cache directory in parallel. `manifest` is a file written by `write_cache_manifest`, or (key, filename)
+    pairs of the groups to fetch. The groups are looked up in one batch, then their files in another one, with the
+    `get_many` of the backend. The `RemoteCacheManager.get_group` calls for these groups then wait for the prefetch
+    instead of going to the remote cache.
+
+    With `background`, the prefetch runs on a thread of its own, and a future that is done once every group is
+    materialized is returned, so that it can be kicked off at the start of the process.
+    """
+    if isinstance(manifest, str):
+        with open(manifest) as f:
+            manifest = json.load(f)
+    entries = list(dict.fromkeys((key, filename) for key, filename in manifest))
+    futures = {}
+    with _prefetched_groups_lock:
+        for entry in entries:
+            if entry not in _prefetched_groups:
+                futures[entry] = _prefetched_groups[entry] = Future()
+
+    def prefetch():
+        try:
+            backend_cls = get_remote_cache_backend_cls()
+            grp_requests = defaultdict(list)
+            for key, filename in futures:
+                grp_requests[key].append(f"__grp__{filename}")
+            grp_files = backend_cls.get_many(grp_requests)
+            child_requests = defaultdict(list)
+            for (key, filename) in futures:
+                grp_data = grp_files[key].get(f"__grp__{filename}", None)
+                if grp_data is not None:
+                    child_requests[key] += json.loads(grp_data).get("child_paths", None) or []
+            child_files = backend_cls.get_many(child_requests)
+
+            def materialize(key):
+                manager = FileCacheManager(key)
+                files = {**grp_files[key], **child_files.get(key, {})}
+                return {filename: manager.put(data, filename) for filename, data in files.items()}
+
+            with ThreadPoolExecutor(max_workers=num_threads) as executor:
+                paths = dict(zip(grp_requests, executor.map(materialize, grp_requests)))
+            for (key, filename), future in futures.items():
+                grp_data = grp_files[key].get(f"__grp__{filename}", None)
+                if grp_data is None:
+                    future.set_result(None)
+                    continue
+                child_paths = json.loads(grp_data).get("child_paths", None) or []
+                future.set_result({child: paths[key][child] for child in child_paths if child in paths[key]})
+        except Exception as e:
+            for future in futures.values():
+                if not future.done():
+                    future.set_exception(e)
+            raise
+
+    if not background:
+        prefetch()
+        return None
+    done = Future()
+
+    def run():
+        try:
+            prefetch()
+            done.set_result(len(futures))
+        except Exception as e:
+            done.set_exception(e)
+
+    threading.Thread(target=run, name="triton-remote-cache-prefetch", daemon=True).start()
+    return done
+
+
+class CacheArchive:
+    """
+    A read-only pack of cached kernels, memory-mapped from a single file.
+
+    The file starts with a magic string and the size of a JSON index, which maps the key of every kernel to the
+    offsets and sizes of its files in the blobs that follow the index. Archives are built with `build_cache_archive`.
+    """
+
+    MAGIC = b"TRITONCA"
+    HEADER = struct.Struct("<8sQ")
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, index_size = CacheArchive.HEADER.unpack_from(self._mmap)
+        if magic != CacheArchive.MAGIC:
+            raise RuntimeError(f"{path} is not a Triton cache archive")
+        index_start = CacheArchive.HEADER.size
+        self._index = json.loads(self._mmap[index_start:index_start + index_size])
+        self._blobs_start = index_start + index_size
+
+    def keys(self):
+        return self._index.keys()
+
+    def get_group(self, key: str) -> Optional[Dict[str, memoryview]]:
+        """
+        Returns the files of a kernel, which are views of the mapped archive, or None if it isn't archived.
+        """
+        files = self._index.get(key, None)
+        if files is None:
+            return None
+        view = memoryview(self._mmap)
+        return {
+            filename: view[self._blobs_start + offset:self._blobs_start + offset + size]
+            for filename, (offset, size) in files.items()
+        }
+
+
+def build_cache_archive(path, cache_dir=None) -> int:
+    """
+    Pack the kernels of a cache directory, which defaults to the directory of `FileCacheManager`, into an archive.
+    Returns the number of archived kernels.
+    """
+    cache_dir = cache_dir or os.getenv("TRITON_CACHE_DIR", "").strip() or default_cache_dir()
+    index = {}
+    blobs = []
+    offset = 0
+    for key in sorted(os.listdir(cache_dir)):
+        key_dir = os.path.join(cache_dir, key)
+        if not os.path.isdir(key_dir):
+            continue
+        # Only compiled kernels have groups, launchers and utilities are shared objects that are loaded from disk.
+        # The outputs of intermediate stages are only needed to compile new kernels.
+        groups = [
+            filename for filename in os.listdir(key_dir)
+            if filename.startswith("__grp__") and not filename.endswith(".stage.json")
+        ]
+        if not groups:
+            continue
+        files = {}
+        for group in groups:
+            with open(os.path.join(key_dir, group)) as f:
+                child_paths = json.load(f).get("child_paths", None)
+            # Groups of remote caches only list their files
+            if not isinstance(child_paths, dict):
+                continue
+            for child, child_path in child_paths.items():
+                if not os.path.exists(child_path):
+                    continue
+                with open(child_path, "rb") as f:
+                    data = f.read()
+                files[child] = (offset, len(data))
+                blobs.append(data)
+                offset += len(data)
+        if files:
+            index[key] = files
+    index_data = json.dumps(index).encode("utf-8")
+    temp_path = f"{path}.tmp.pid_{os.getpid()}_{uuid.uuid4()}"
+    with open(temp_path, "wb") as f:
+        f.write(CacheArchive.HEADER.pack(CacheArchive.MAGIC, len(index_data)))
+        f.write(index_data)
+        for data in blobs:
+            f.write(data)
+    os.replace(temp_path, path)
+    return len(index)
+
+
 __cache_cls = FileCacheManager
 __cache_cls_nme = "DEFAULT"
 
@@ -0,0 +1,194 @@
+"""
+A local process compiling kernels for the processes that share its cache directory, e.g. the ranks of a distributed
+job, which then only run the frontend of every kernel and load it from the cache.
+
+.. highlight:: bash
+.. code-block:: bash
+
+    python -m triton.runtime.compile_server /tmp/triton.sock &
+    TRITON_COMPILE_SERVER=/tmp/triton.sock torchrun ...
+
+Clients generate the TTIR of their kernels, since the Python functions of kernels can't be sent to another process,
+and the server runs the stages of the backend on its compile thread pool, writing the kernels to the cache directory
+as a local compilation would. Kernels are compiled locally whenever the server can't be reached or compiles them for
+a different Triton build, cache directory or environment.
+"""
+import argparse
+import os
+import tempfile
+import threading
+import time
+import warnings
+from multiprocessing.connection import Client, Listener
+
+from .cache import FileCacheManager, get_cache_manager
+
+
+def _authkey():
+    # Requests are pickled, the socket is only accessible to its owner unless the clients share a key with the server
+    authkey = os.environ.get("TRITON_COMPILE_SERVER_AUTHKEY", "").strip()
+    return authkey.encode("utf-8") if authkey else None
+
+
+class _TTIRSource:
+    # The TTIR generated by a client for an `ASTSource` with hash `src_hash`, whose stages are cached by that hash
+
+    def __init__(self, name, src_hash, ttir, path):
+        self.ext = "ttir"
+        self.name = name
+        self.src_hash = src_hash
+        self.path = path
+        with open(path, "w") as f:
+            f.write(ttir)
+
+    def hash(self):
+        return self.src_hash
+
+    def make_ir(self, options, codegen_fns, context):
+        from .._C.libtriton import ir
+        module = ir.parse_mlir_module(self.path, context)
+        module.context = context
+        return module
+
+
+def _compile_request(request):
+    import hashlib
+    from .._C.libtriton import get_cache_invalidating_env_vars
+    from ..compiler.compiler import _compile_and_cache, make_backend, triton_key
+
+    target = request["target"]
+    backend = make_backend(target)
+    options = backend.parse_options(request["options"])
+    env_vars = get_cache_invalidating_env_vars()
+    # the kernel is the one the client asked for only if everything it is hashed by is the same here
+    key = f"{triton_key()}-{request['src_hash']}-{backend.hash()}-{options.hash()}-{str(sorted(env_vars.items()))}"
+    hash = hashlib.sha256(key.encode("utf-8")).hexdigest()
+    if hash != request["hash"]:
+        return "the kernel hashes differently on the server"
+    fn_cache_manager = get_cache_manager(hash)
+    if not isinstance(fn_cache_manager, FileCacheManager) or fn_cache_manager.cache_dir != request["cache_dir"]:
+        return "the server uses another cache directory"
+    # the client holds the compile lock of the kernel while it waits
+    metadata_filename = f"{request['name']}.json"
+    metadata_group = fn_cache_manager.get_group(metadata_filename) or {}
+    if metadata_filename in metadata_group:
+        return None
+    with tempfile.TemporaryDirectory() as tmpdir:
+        src = _TTIRSource(request["name"], request["src_hash"], request["ttir"],
+                          os.path.join(tmpdir, f"{request['name']}.ttir"))
+        _compile_and_cache(src, target, backend, options, env_vars, hash, fn_cache_manager, metadata_group)
+    return None
+
+
+class CompileServer:
+    """
+    Compiles the kernels sent to the Unix socket at `address`. Every connection is served by a thread of its own,
+    which submits the compilations to :code:`get_compile_executor`.
+    """
+
+    def __init__(self, address):
+        self.address = address
+        if os.path.exists(address):
+            os.unlink(address)
+        # without a key, the socket is only accessible to its owner from the moment it is bound
+        umask = os.umask(0o177) if _authkey() is None else None
+        try:
+            self.listener = Listener(address, family="AF_UNIX", authkey=_authkey())
+        finally:
+            if umask is not None:
+                os.umask(umask)
+        self.closed = False
+
+    def serve_forever(self):
+        while not self.closed:
+            try:
+                conn = self.listener.accept()
+            except OSError:
+                if self.closed:
+                    break
+                continue
+            threading.Thread(target=self._serve, args=(conn, ), daemon=True).start()
+
+    def close(self):
+        self.closed = True
+        self.listener.close()
+
+    def _serve(self, conn):
+        from ..compiler.compiler import get_compile_executor
+        with conn:
+            while True:
+                try:
+                    request = conn.recv()
+                except (EOFError, OSError):
+                    return
+                try:
+                    error = get_compile_executor().submit(_compile_request, request).result()
+                except Exception as e:
+                    error = f"{type(e).__name__}: {e}"
+                conn.send({"error": error})
+
+
+# Seconds during which a server that couldn't be reached isn't tried again
+_RETRY_INTERVAL = 60
+# Address -> time at which the server at that address couldn't be reached
+_unreachable_addresses = {}
+
+
+def compile_on_server(address, src, target, backend, options, hash, fn_cache_manager):
+    """
+    Generates the TTIR of the `ASTSource` `src` and has the server at `address` compile it into the cache directory
+    of `fn_cache_manager`. Returns whether the server compiled the kernel.
+    """
+    from ..compiler.compiler import _get_context, filter_traceback
+    if not isinstance(fn_cache_manager, FileCacheManager):
+        return False
+    down_since = _unreachable_addresses.get(address)
+    if down_since is not None and time.monotonic() - down_since < _RETRY_INTERVAL:
+        return False
+    context = _get_context(backend)
+    codegen_fns = backend.get_codegen_implementation()
+    try:
+        module = src.make_ir(options, codegen_fns, context)
+    except Exception as e:
+        filter_traceback(e)
+        raise
+    request = {
+        "hash": hash,
+        "name": src.name,
+        "src_hash": src.hash(),
+        "ttir": str(module),
+        "target": target,
+        "options": options.__dict__,
+        "cache_dir": fn_cache_manager.cache_dir,
+    }
+    try:
+        with Client(address, family="AF_UNIX", authkey=_authkey()) as conn:
+            conn.send(request)
+            response = conn.recv()
+    except Exception as e:
+        if address not in _unreachable_addresses:
+            warnings.warn(f"Compiling locally, the compile server at {address} can't be reached: {e}")
+        _unreachable_addresses[address] = time.monotonic()
+        return False
+    _unreachable_addresses.pop(address, None)
+    return response["error"] is None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compiles the Triton kernels of local processes")
+    parser.add_argument("address", nargs="?", default=os.environ.get("TRITON_COMPILE_SERVER"),
+                        help="path of the Unix socket, TRITON_COMPILE_SERVER by default")
+    args = parser.parse_args()
+    if not args.address:
+        parser.error("the address of the server is missing")
+    server = CompileServer(args.address)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,7 @@
 import inspect
+import os
+import threading
+from concurrent.futures import ThreadPoolExecutor
 from typing import Tuple
 
 import math
@@ -76,8 +79,9 @@ class InterpreterOptions:
     arch: str = None
     allow_fp8e4nv: bool = True
     allow_fp8e4b15: bool = True
+    allow_mixed_fp8_dot: bool = False
     default_dot_input_precision: str = "tf32"
-    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee")
+    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "bf16x3", "bf16x6", "bf16x9", "ieee")
     max_num_imprecise_acc_default: int = 0
 
 
@@ -126,67 +130,30 @@ def _get_np_dtype(tt_dtype):
 
 
 def _convert_float(input, input_dtype, output_dtype, rounding_mode):
-    input_uint_dtype = getattr(np, f"uint{input_dtype.primitive_bitwidth}")
-    output_unint_dtype = getattr(np, f"uint{output_dtype.primitive_bitwidth}")
-    input_bin = np.frombuffer(input.tobytes(), dtype=input_uint_dtype)
-    sign = (input_bin >> (input_dtype.primitive_bitwidth - 1)) & 0x01
-    input_exponent_width = input_dtype.primitive_bitwidth - input_dtype.fp_mantissa_width - 1
-    output_exponent_width = output_dtype.primitive_bitwidth - output_dtype.fp_mantissa_width - 1
-    significand = input_bin & ((1 << input_dtype.fp_mantissa_width) - 1)
-    bias_input = input_dtype.exponent_bias
-    bias_output = output_dtype.exponent_bias
-    exponent = ((input_bin >> input_dtype.fp_mantissa_width) & ((1 << input_exponent_width) - 1)).astype(np.int32)
-    subnormal_index = exponent == 0
-    if np.any(subnormal_index):
-        # Credit to Phil: phil@openai.com
-        # subnormal repr: ((-1.0)**sign) * (2.0**(1 - exp_bias)) * (2^(m0) + 2^(m1) + ... + 2^(mn))
-        # where m0, m1, ..., mn are the 1-bit of the mantissa
-        # convert it to normal repr: ((-1.0)**sign) * (2.0**(1 + m0 - exp_bias)) * (1 + 2^(m1 - m0) + ... + 2^(mn - m0))
-        bit_pos = np.zeros_like(input_bin, dtype=np.int32)
-        # Find the most significant bit of the mantissa in the significand
-        for i in range(input_dtype.fp_mantissa_width):
-            bit_index = ((significand >> i) & 0x01)
-            # pos should be >= 1
-            bit_pos[bit_index == 1] = input_dtype.fp_mantissa_width - i
-        zero_significand_index = significand == 0
-        exponent[subnormal_index] = 1 - bit_pos[subnormal_index]
-        # 0 significand and subnormal should be treated as 0
-        exponent[zero_significand_index & subnormal_index] = bias_input - bias_output
-        significand[subnormal_index] = (significand[subnormal_index] << bit_pos[subnormal_index]) & (
-            (1 << input_dtype.fp_mantissa_width) - 1)
-    # Prevent overflow and underflow
-    exponent_output = np.maximum(0, np.minimum((exponent - bias_input + bias_output), (1 << output_exponent_width) - 1))
-    exponent_output = exponent_output.astype(output_unint_dtype)
-    sign_output = sign.astype(output_unint_dtype)
-    if input_dtype.primitive_bitwidth > output_dtype.primitive_bitwidth:  # Downcast
-        significand_output = (significand >> (input_dtype.fp_mantissa_width - output_dtype.fp_mantissa_width)) & (
-            (1 << output_dtype.fp_mantissa_width) - 1)
-        if rounding_mode == _ir.ROUNDING_MODE.RTNE:  # Round to nearst even
-            # find the cut-off bit
-            cut_off = significand & (1 << (input_dtype.fp_mantissa_width - output_dtype.fp_mantissa_width - 1))
-            significand_output = significand_output + (cut_off > 0)
-        significand_output = significand_output.astype(output_unint_dtype)
-    else:  # Upcast
-        significand_output = (significand.astype(output_unint_dtype) <<
-                              (output_dtype.fp_mantissa_width - input_dtype.fp_mantissa_width)) & (
-                                  (1 << output_dtype.fp_mantissa_width) - 1)
-    subnormal_index = exponent_output == 0
-    if np.any(subnormal_index):  # underflow
-        # normal repr: ((-1.0)**sign) * (2.0**(exp - exp_bias_input)) * (1 + 2^(m0) + 2^(m1) + ... + 2^(mn))
-        # where m0, m1, ..., mn are the 1-bit of the mantissa
-        # shift = (1 - exp_bias_output) - (exp - exp_bias_input)
-        # convert it to subnormal repr: ((-1.0)**sign) * (2.0**(1 - exp_bias_output)) * (2^(-shift) + 2^(m0 - shift) + 2^(m1 - shift) + ... + 2^(mn - shift))
-        exponent = ((input_bin >> input_dtype.fp_mantissa_width) & ((1 << input_exponent_width) - 1)).astype(np.int32)
-        non_zero_exponent_index = exponent != 0
-        # If the original exponent is not zero, we still need to shift the significand and consider the 1.0 part in mantissa
-        subnormal_index = subnormal_index & non_zero_exponent_index
-        shift = np.zeros_like(input_bin, dtype=np.int32)
-        shift[subnormal_index] = (1 - bias_output) - (exponent[subnormal_index] - bias_input)
-        significand_output[subnormal_index] = (significand_output[subnormal_index] >> shift[subnormal_index]) | (
-            1 << (output_dtype.fp_mantissa_width - shift[subnormal_index]))
-    output = (sign_output << (output_dtype.primitive_bitwidth - 1)) | (
-        exponent_output << output_dtype.fp_mantissa_width) | significand_output
-    return output.reshape(input.shape)
+    # rounds to nearest even unless rounding_mode is RTZ, like GPUs
+    rtz = rounding_mode == _ir.ROUNDING_MODE.RTZ
+    return _interpreter.convert_float(np.asarray(input), input_dtype.name, output_dtype.name, rtz)
+
+
+def _is_emulated_float(dtype):
+    # bfloat16 and float8 types, which numpy lacks
+    return dtype.is_floating() and _get_np_dtype(dtype).kind == "u"
+
+
+def _to_native_float(data, dtype):
+    # Emulated floats are computed on in float32, which holds them exactly
+    if _is_emulated_float(dtype):
+        return _convert_float(data, dtype, tl.float32, None).view(np.float32)
+    return data
+
+
+def _from_native_float(data, dtype):
+    # Rounds the float32 results of computations on emulated floats once, as the GPU does
+    data = np.asarray(data)
+    if data.dtype.kind != "f":
+        data = data.astype(np.float64)
+    src_dtype = {np.float16: tl.float16, np.float32: tl.float32, np.float64: tl.float64}[data.dtype.type]
+    return _convert_float(data, src_dtype, dtype, None).view(_get_np_dtype(dtype))
 
 
 def _erf(x):
@@ -238,6 +205,19 @@ class InterpreterBuilder:
         self.options = InterpreterOptions()
         self.codegen_fns = {}
         self.codegen_fns["convert_custom_types"] = ExtraFunctions._convert_custom_types
+        # program instances may run on several threads, each with its own index
+        self._program_state = threading.local()
+        # whether program instances run concurrently, otherwise atomics don't
+        # need atomic instructions
+        self.concurrent = False
+
+    @property
+    def grid_idx(self):
+        return getattr(self._program_state, "grid_idx", None)
+
+    @grid_idx.setter
+    def grid_idx(self, value):
+        self._program_state.grid_idx = value
 
     def set_grid_idx(self, x, y, z):
         if not x < self.grid_dim[0]:
@@ -313,6 +293,9 @@ class InterpreterBuilder:
     def get_int1(self, value):
         return TensorHandle(np.array([value], dtype=np.bool_), tl.int1)
 
+    def get_int32_attr(self, value):
+        return value
+
     def get_uint8(self, value):
         return TensorHandle(np.array([value], dtype=np.uint8), tl.uint8)
 
@@ -360,19 +343,19 @@ class InterpreterBuilder:
 
     # memory ops
     def create_load(self, ptr, _0, _1, is_volatile):
-        mask = TensorHandle(np.ones_like(ptr.data, dtype=bool), tl.int1)
+        mask = TensorHandle(np.broadcast_to(True, ptr.data.shape), tl.int1)
         other = None
         return self.create_masked_load(ptr, mask, other, _0, _1, is_volatile)
 
     def create_store(self, ptr, val, _0, _1):
-        mask = TensorHandle(np.ones_like(ptr.data, dtype=bool), tl.int1)
+        mask = TensorHandle(np.broadcast_to(True, ptr.data.shape), tl.int1)
         return self.create_masked_store(ptr, val, mask, None, None)
 
     def create_masked_load(self, ptrs, mask, other, cache_modifier, eviction_policy, is_volatile):
         dtype_tt = ptrs.get_element_ty()
         dtype_np = _get_np_dtype(dtype_tt)
         if other is None:
-            other = TensorHandle(np.zeros_like(ptrs.data, dtype=dtype_np), dtype_tt)
+            other = TensorHandle(np.broadcast_to(np.zeros((), dtype=dtype_np), ptrs.data.shape), dtype_tt)
         ret = _interpreter.load(ptrs.data, mask.data, other.data, dtype_np)
         return TensorHandle(ret, dtype_tt)
 
@@ -383,12 +366,13 @@ class InterpreterBuilder:
     def cast_impl(self, src, dst_type):
         src_element_type = src.dtype.scalar
         dst_element_type = dst_type.scalar
-        if (src_element_type == tl.bfloat16 and dst_element_type == tl.float32) or \
-           (src_element_type == tl.float32 and dst_element_type == tl.bfloat16):
+        if src_element_type.is_floating() and dst_element_type.is_floating():
             data = _convert_float(src.data, src_element_type, dst_element_type, None).view(_get_np_dtype(dst_type))
-            return TensorHandle(data, dst_type.scalar)
+        elif _is_emulated_float(dst_element_type):
+            data = _from_native_float(src.data, dst_element_type)
         else:
-            return TensorHandle(src.data.astype(_get_np_dtype(dst_type)), dst_type.scalar)
+            data = _to_native_float(src.data, src_element_type).astype(_get_np_dtype(dst_type))
+        return TensorHandle(data, dst_type.scalar)
 
     create_si_to_fp = lambda self, src, dst_type: self.cast_impl(src, dst_type)
     create_ui_to_fp = lambda self, src, dst_type: self.cast_impl(src, dst_type)
@@ -398,18 +382,57 @@ class InterpreterBuilder:
     create_fp_trunc = lambda self, src, dst_type: self.cast_impl(src, dst_type)
     create_int_cast = lambda self, src, dst_type, is_signed: self.cast_impl(src, dst_type)
 
-    def create_fp_to_fp(self, src, dst_type, rounding_mode):
+    def create_fp_to_fp(self, src, dst_type, rounding_mode, rbits=None):
         src_element_type = src.dtype.scalar
         dst_element_type = dst_type.scalar
-        data = _convert_float(src.data, src_element_type, dst_element_type, rounding_mode).view(_get_np_dtype(dst_type))
+        src_data = src.data
+        if rounding_mode == _ir.ROUNDING_MODE.RS:
+            # Add the random bits below the kept mantissa bits and drop them, which leaves values that convert
+            # exactly, except NaNs
+            uint_dtype = getattr(np, f"uint{src_element_type.primitive_bitwidth}")
+            bits = np.frombuffer(src_data.tobytes(), dtype=uint_dtype).reshape(src_data.shape)
+            drop_mask = (1 << (src_element_type.fp_mantissa_width - dst_element_type.fp_mantissa_width)) - 1
+            noise = (rbits.data.astype(np.uint32) & drop_mask).astype(uint_dtype)
+            rounded = (bits + noise) & uint_dtype(~drop_mask & ((1 << src_element_type.primitive_bitwidth) - 1))
+            abs_mask = (1 << (src_element_type.primitive_bitwidth - 1)) - 1
+            inf_bits = abs_mask & ~((1 << src_element_type.fp_mantissa_width) - 1)
+            bits = np.where((bits & abs_mask) > inf_bits, bits, rounded).astype(uint_dtype)
+            src_data = bits.view(src_data.dtype)
+            rounding_mode = _ir.ROUNDING_MODE.RTZ
+        data = _convert_float(src_data, src_element_type, dst_element_type, rounding_mode).view(_get_np_dtype(dst_type))
         return TensorHandle(data, dst_type.scalar)
 
     def create_bitcast(self, src, dst_type):
         return TensorHandle(src.data.view(_get_np_dtype(dst_type)), dst_type.scalar)
 
+    def create_unpack(self, src, format, axis, dst_type):
+        data = src.data.view(np.uint8)
+        shape = list(data.shape)
+        shape[axis] *= 2
+        # the lower nibble of each byte first
+        nibbles = np.stack([data & 0xf, data >> 4], axis=axis + 1).reshape(shape)
+        if format == _ir.PACKED_ELEM_TYPE.E2M1:
+            values = np.array([0, 0.5, 1, 1.5, 2, 3, 4, 6, -0.0, -0.5, -1, -1.5, -2, -3, -4, -6],
+                              dtype=np.float32)[nibbles]
+        elif format == _ir.PACKED_ELEM_TYPE.I4:
+            values = nibbles.astype(np.int8) - (nibbles >= 8).astype(np.int8) * 16
+        else:
+            values = nibbles
+        if dst_type.scalar == tl.bfloat16:
+            # the values are exact in bf16
+            data = (values.astype(np.float32).view(np.uint32) >> 16).astype(np.uint16)
+        else:
+            data = values.astype(_get_np_dtype(dst_type.scalar))
+        return TensorHandle(data, dst_type.scalar)
+
     # binary operators
     def binary_op(self, lhs, rhs, op):
-        return TensorHandle(op(lhs.data, rhs.data), lhs.dtype.scalar)
+        dtype = lhs.dtype.scalar
+        if _is_emulated_float(dtype):
+            data = op(_to_native_float(lhs.data, dtype), _to_native_float(rhs.data, rhs.dtype.scalar))
+            # comparisons give booleans
+            return TensorHandle(data if data.dtype == np.bool_ else _from_native_float(data, dtype), dtype)
+        return TensorHandle(op(lhs.data, rhs.data), dtype)
 
     create_fadd = lambda self, lhs, rhs: self.binary_op(lhs, rhs, np.add)
     create_fmul = lambda self, lhs, rhs: self.binary_op(lhs, rhs, np.multiply)
@@ -490,17 +513,27 @@ class InterpreterBuilder:
 
     # ternary functions
     def ternary_op(self, lhs, rhs, other, op):
-        return TensorHandle(op(lhs.data, rhs.data, other.data), other.dtype.scalar)
+        dtype = other.dtype.scalar
+        if _is_emulated_float(dtype):
+            data = op(*(_to_native_float(arg.data, arg.dtype.scalar) for arg in (lhs, rhs, other)))
+            return TensorHandle(_from_native_float(data, dtype), dtype)
+        return TensorHandle(op(lhs.data, rhs.data, other.data), dtype)
 
     create_clampf = lambda self, arg, lo, hi, propagate_nans: self.ternary_op(arg, lo, hi, np.clip)
-    create_select = lambda self, cond, lhs, rhs: self.ternary_op(cond, lhs, rhs, np.where)
+
+    def create_select(self, cond, lhs, rhs):
+        # selecting the bits of emulated floats needs no conversions
+        return TensorHandle(np.where(cond.data, lhs.data, rhs.data), rhs.dtype.scalar)
 
     def create_fma(self, x, y, z):
-        return TensorHandle(x.data * y.data + z.data, z.dtype.scalar)
+        return self.ternary_op(x, y, z, lambda x, y, z: x * y + z)
 
     # unary functions
     def unary_op(self, arg, op):
-        return TensorHandle(op(arg.data), arg.dtype.scalar)
+        dtype = arg.dtype.scalar
+        if _is_emulated_float(dtype):
+            return TensorHandle(_from_native_float(op(_to_native_float(arg.data, dtype)), dtype), dtype)
+        return TensorHandle(op(arg.data), dtype)
 
     def create_fabs(self, arg):
         # Mask out the sign bit based on the primitive length
@@ -525,11 +558,10 @@ class InterpreterBuilder:
     create_sin = lambda self, arg: self.unary_op(arg, np.sin)
 
     def create_erf(self, arg):
-        ret = np_erf_fp32(arg.data) if arg.data.dtype == np.float32 else np_erf_fp64(arg.data)
-        return TensorHandle(ret, arg.dtype.scalar)
+        return self.unary_op(arg, lambda x: np_erf_fp32(x) if x.dtype == np.float32 else np_erf_fp64(x))
 
     def create_rsqrt(self, arg):
-        return TensorHandle(1 / np.sqrt(arg.data), arg.dtype.scalar)
+        return self.unary_op(arg, lambda x: 1 / np.sqrt(x))
 
     # tensor operators
     create_reshape = lambda self, arg, shape, allow_reorder: TensorHandle(arg.data.reshape(shape), arg.dtype.scalar)
@@ -538,13 +570,14 @@ class InterpreterBuilder:
         return TensorHandle(np.transpose(arg.data, perm), arg.dtype.scalar)
 
     def create_dot(self, a, b, d, input_precision, max_num_imprecise_acc):
-        a_data = a.data
-        b_data = b.data
-        if (a.dtype.primitive_bitwidth == 8 and a.dtype.is_floating()) or \
-           (b.dtype.primitive_bitwidth == 8 and b.dtype.is_floating()):
-            a_data = _convert_float(a_data, a.dtype, tl.float16, None).view(np.float16)
-            b_data = _convert_float(b_data, b.dtype, tl.float16, None).view(np.float16)
-        return TensorHandle(np.matmul(a_data, b_data, dtype=d.data.dtype) + d.data, d.dtype.scalar)
+        a_data = _to_native_float(a.data, a.dtype.scalar)
+        b_data = _to_native_float(b.data, b.dtype.scalar)
+        d_dtype = d.dtype.scalar
+        d_data = _to_native_float(d.data, d_dtype)
+        ret = np.matmul(a_data, b_data, dtype=d_data.dtype) + d_data
+        if _is_emulated_float(d_dtype):
+            ret = _from_native_float(ret, d_dtype)
+        return TensorHandle(ret, d_dtype)
 
     def create_make_range(self, start, stop):
         return TensorHandle(np.arange(start, stop, dtype=np.int32), tl.int32)
@@ -552,6 +585,21 @@ class InterpreterBuilder:
     def create_histogram(self, data, bins):
         return TensorHandle(np.histogram(data.data, bins=bins, range=(0, bins))[0], tl.int32)
 
+    def create_sort(self, srcs, descending):
+        # Like the compiled op, compare the keys as signed integers
+        keys = srcs[0].data
+        if keys.dtype == np.bool_:
+            keys = -keys.astype(np.int8)
+        elif np.issubdtype(keys.dtype, np.unsignedinteger):
+            keys = keys.view(np.dtype(f"int{keys.dtype.itemsize * 8}"))
+        order = np.argsort(keys, axis=-1, kind="stable")
+        if descending:
+            order = np.flip(order, axis=-1)
+        return [TensorHandle(np.take_along_axis(src.data, order, axis=-1), src.dtype.scalar) for src in srcs]
+
+    def create_gather(self, src, indices, axis):
+        return TensorHandle(np.take_along_axis(src.data, indices.data, axis=axis), src.dtype.scalar)
+
     # pointer arithmetic
 
     def create_addptr(self, ptr, offset):
@@ -598,16 +646,18 @@ class InterpreterBuilder:
         return (TensorHandle(val.data[..., 0], val.dtype.scalar), TensorHandle(val.data[..., 1], val.dtype.scalar))
 
     def create_splat(self, arg, shape):
-        if isinstance(arg.dtype, tl.block_type):
-            return TensorHandle(np.full(shape, arg.data[0], dtype=_get_np_dtype(arg.dtype)), arg.dtype.scalar)
-        else:  # scalar
-            return TensorHandle(np.full(shape, arg.data, dtype=_get_np_dtype(arg.dtype)), arg.dtype.scalar)
+        # a read-only view of the value, like broadcasts, which the loads and stores don't materialize either
+        value = arg.data[0] if isinstance(arg.dtype, tl.block_type) else arg.data
+        value = np.asarray(value, dtype=_get_np_dtype(arg.dtype)).reshape(())
+        return TensorHandle(np.broadcast_to(value, shape), arg.dtype.scalar)
 
     def create_atomic_cas(self, ptr, cmp, val, sem, scope):
         if sem not in self.ir_sem_to_interpreter_sem:
             raise ValueError(f"unsupported semantic {sem}")
         sem = self.ir_sem_to_interpreter_sem[sem]
-        return TensorHandle(_interpreter.atomic_cas(ptr.data, cmp.data, val.data, sem), cmp.dtype.scalar)
+        # the atomics read their operands linearly, which splats only hold one element of
+        ptr_data, cmp_data, val_data = (np.ascontiguousarray(x.data) for x in (ptr, cmp, val))
+        return TensorHandle(_interpreter.atomic_cas(ptr_data, cmp_data, val_data, sem), cmp.dtype.scalar)
 
     def create_atomic_rmw(self, rmwOp, ptr, val, mask, sem, scope):
         if rmwOp not in self.ir_rmw_op_to_interpreter_rmw_op:
@@ -616,7 +666,10 @@ class InterpreterBuilder:
             raise ValueError(f"unsupported semantic {sem}")
         rmwOp = self.ir_rmw_op_to_interpreter_rmw_op[rmwOp]
         sem = self.ir_sem_to_interpreter_sem[sem]
-        return TensorHandle(_interpreter.atomic_rmw(rmwOp, ptr.data, val.data, mask.data, sem), val.dtype.scalar)
+        # the atomics read their operands linearly, which splats only hold one element of
+        ptr_data, val_data, mask_data = (np.ascontiguousarray(x.data) for x in (ptr, val, mask))
+        ret = _interpreter.atomic_rmw(rmwOp, ptr_data, val_data, mask_data, sem, self.concurrent)
+        return TensorHandle(ret, val.dtype.scalar)
 
     def create_extern_elementwise(self, libName, libPath, symbol, argList, retType, isPure):
         raise NotImplementedError("extern_elementwise not supported in interpreter mode")
@@ -841,6 +894,9 @@ class ScanOps(ReduceScanOpIneterface):
     def cumprod(self, input):
         return [self.to_tensor(np.cumprod(input.handle.data, axis=self.axis), dtype=input.dtype)]
 
+    def starts_segment(self, index):
+        return index[self.axis] == 0
+
     def generic_scan(self, input):
         input_data = []
         output_data = []
@@ -853,7 +909,7 @@ class ScanOps(ReduceScanOpIneterface):
             # Recover index from i using shape
             index = np.unravel_index(i, shape)
             data = tuple(self.to_tensor(d[index], input[ii].dtype) for ii, d in enumerate(input_data))
-            if index[self.axis] == 0:
+            if self.starts_segment(index):
                 # First element
                 for j in range(len(output_data)):
                     output_data[j][index] = data[j].handle.data.item()
@@ -891,6 +947,45 @@ class ScanOps(ReduceScanOpIneterface):
         return len(ret) == 1 and ret[0] or tuple(ret)
 
 
+class SegmentedScanOps(ScanOps):
+
+    def __init__(self, axis, flags, combine_fn, reverse):
+        super().__init__(axis, combine_fn, reverse)
+        self.flags = flags
+
+    def starts_segment(self, index):
+        return index[self.axis] == 0 or self.flags[index]
+
+    def apply_impl(self, input):
+        shape = input[0].handle.data.shape
+        self.flags = np.broadcast_to(np.asarray(self.flags.handle.data) != 0, shape)
+        if self.reverse:
+            input = tuple(self.to_tensor(np.flip(arg.handle.data, axis=self.axis), arg.dtype) for arg in input)
+            self.flags = np.flip(self.flags, axis=self.axis)
+        ret = self.generic_scan(input)
+        if self.reverse:
+            for arg in ret:
+                arg.handle.data = np.flip(arg.handle.data, axis=self.axis)
+        return len(ret) == 1 and ret[0] or tuple(ret)
+
+
+class SegmentedReduceOps(SegmentedScanOps):
+
+    def __init__(self, axis, flags, combine_fn):
+        super().__init__(axis, flags, combine_fn, False)
+
+    def apply_impl(self, input):
+        ret = super().apply_impl(input)
+        ret = (ret, ) if not isinstance(ret, tuple) else ret
+        # Carry the prefix at the end of each segment back to its start
+        flags = np.moveaxis(self.flags, self.axis, 0)
+        for arg in ret:
+            data = np.moveaxis(arg.handle.data, self.axis, 0)
+            for i in range(data.shape[0] - 2, -1, -1):
+                data[i] = np.where(flags[i + 1], data[i], data[i + 1])
+        return len(ret) == 1 and ret[0] or ret
+
+
 def _patch_reduce_scan():
     # Because interpreter doesn't support region_builder_fn, we cannot patch the builder
     # to use the new reduce and scan functions.
@@ -901,10 +996,20 @@ def _patch_reduce_scan():
     def _new_scan(input, axis, combine_fn, reverse=False, **kwargs):
         return ScanOps(axis, combine_fn, reverse).apply(input)
 
+    def _new_segmented_scan(input, flags, axis, combine_fn, reverse=False, **kwargs):
+        return SegmentedScanOps(axis, flags, combine_fn, reverse).apply(input)
+
+    def _new_segmented_reduce(input, flags, axis, combine_fn, **kwargs):
+        return SegmentedReduceOps(axis, flags, combine_fn).apply(input)
+
     tl.reduce = _new_reduce
     tl.associative_scan = _new_scan
+    tl.segmented_scan = _new_segmented_scan
+    tl.segmented_reduce = _new_segmented_reduce
     tl.core.reduce = _new_reduce
     tl.core.associative_scan = _new_scan
+    tl.core.segmented_scan = _new_segmented_scan
+    tl.core.segmented_reduce = _new_segmented_reduce
 
 
 def _patch_lang_core(lang):
@@ -981,6 +1086,7 @@ def _patch_lang_core(lang):
     lang.multiple_of = partial(_set_attr, name="tt.divisiblity")
     lang.max_contiguous = partial(_set_attr, name="tt.contiguity")
     lang.max_constancy = partial(_set_attr, name="tt.constancy")
+    lang.unlikely = lambda cond: cond
 
     _patch_reduce_scan()
 
@@ -1064,6 +1170,19 @@ class GridExecutor:
             if hasattr(kwarg_dev, "data_ptr"):
                 kwarg_dev.data.copy_(kwarg_hst.to(kwarg_dev.device).data)
 
+    def _run_parallel(self, args, grid, num_threads):
+        # Program instances are independent, so they can run on a thread pool.
+        # The native load, store and atomics release the GIL and the atomics
+        # stay atomic across threads, as they are on the GPU.
+        def run(idx):
+            interpreter_builder.set_grid_idx(*idx)
+            self.fn(**args)
+
+        indices = [(x, y, z) for x in range(grid[0]) for y in range(grid[1]) for z in range(grid[2])]
+        with ThreadPoolExecutor(max_workers=num_threads) as executor:
+            for future in [executor.submit(run, idx) for idx in indices]:
+                future.result()
+
     def __call__(self, *args_dev, **kwargs):
         # removes reserved keywords from kwargs
         kwargs = {k: v for k, v in kwargs.items() if k not in RESERVED_KWS}
@@ -1082,14 +1201,23 @@ class GridExecutor:
         assert len(grid) <= 3, "grid must have at most 3 dimensions"
         grid = grid + (1, ) * (3 - len(grid))
         interpreter_builder.set_grid_dim(*grid)
+        # counted so that the atomics of concurrent launches from other Python threads stay atomic
+        _interpreter.enter_launch()
         try:
-            for x in range(grid[0]):
-                for y in range(grid[1]):
-                    for z in range(grid[2]):
-                        interpreter_builder.set_grid_idx(x, y, z)
-                        self.fn(**args)
+            num_threads = int(os.getenv("TRITON_INTERPRET_THREADS", "1"))
+            interpreter_builder.concurrent = num_threads > 1
+            if num_threads > 1:
+                self._run_parallel(args, grid, num_threads)
+            else:
+                for x in range(grid[0]):
+                    for y in range(grid[1]):
+                        for z in range(grid[2]):
+                            interpreter_builder.set_grid_idx(x, y, z)
+                            self.fn(**args)
         except Exception as e:
             raise InterpreterError(repr(e)) from e
+        finally:
+            _interpreter.exit_launch()
         # copy arguments back to propagate side-effects
         self._restore_args_dev(args_dev, args_hst, kwargs, kwargs_hst)
 
@@ -3,12 +3,15 @@ import ast
 import hashlib
 import inspect
 import itertools
+import json
 import os
 import re
 import textwrap
-from collections import defaultdict
+import time
+from collections import OrderedDict, defaultdict
+from dataclasses import dataclass
 from functools import cached_property
-from typing import Callable, Generic, Iterable, Optional, TypeVar, Union, overload, Dict, Any, Tuple
+from typing import Callable, Generic, Iterable, Optional, Sequence, TypeVar, Union, overload, Dict, Any, Tuple
 from ..runtime.driver import driver
 from types import ModuleType
 
@@ -16,6 +19,9 @@ TRITON_MODULE = __name__[:-len(".runtime.jit")]
 
 T = TypeVar("T")
 
+# Bump when DependenciesFinder looks up globals differently, so that lookups cached on disk are redone.
+DEPENDENCIES_FORMAT_VERSION = 1
+
 # -----------------------------------------------------------------------------
 # Dependencies Finder
 # -----------------------------------------------------------------------------
@@ -69,6 +75,13 @@ class DependenciesFinder(ast.NodeVisitor):
 
         self.visiting_arg_default_value = False
 
+        # The global lookups of the visit in order, so that a later visit of the same source can replay them against
+        # the globals of the time without parsing the source.  A lookup is either ("name", name, in_default_value)
+        # or ("attr", index of the lookup of the value, attribute name).
+        self.lookups = []
+        self.lookup_of_node = {}
+        self.replayable = True
+
     @property
     def ret(self):
         return self.hasher.hexdigest()
@@ -105,7 +118,12 @@ class DependenciesFinder(ast.NodeVisitor):
             # The global name is hidden by the local name.
             return None
 
-        val = self.globals.get(node.id, None)
+        self.lookup_of_node[node] = len(self.lookups)
+        self.lookups.append(("name", node.id, self.visiting_arg_default_value))
+        return self._visit_global(node.id)
+
+    def _visit_global(self, name):
+        val = self.globals.get(name, None)
 
         # Only keep track of "interesting" global variables, that non-evil users
         # might change.  Don't consider functions, modules, builtins, etc.  This
@@ -121,9 +139,9 @@ class DependenciesFinder(ast.NodeVisitor):
                 # It would be pretty evil if we used function `foo` inside of
                 # `bar` and then someone did `foo = baz`.
                 and not isinstance(val, JITFunction) and not getattr(val, "__triton_builtin__", False)  #
-                and node.id not in self.supported_python_builtins  #
+                and name not in self.supported_python_builtins  #
             ):
-            self.used_global_vals[(node.id, id(self.globals))] = (val, self.globals)
+            self.used_global_vals[(name, id(self.globals))] = (val, self.globals)
 
         self._update_hash(val)
         return val
@@ -137,12 +155,36 @@ class DependenciesFinder(ast.NodeVisitor):
         lhs = self.visit(node.value)
         while isinstance(lhs, ast.Attribute):
             lhs = self.visit(lhs.value)
+        if node.value in self.lookup_of_node:
+            self.lookup_of_node[node] = len(self.lookups)
+            self.lookups.append(("attr", self.lookup_of_node[node.value], node.attr))
+        elif lhs is not None:
+            # The value doesn't come from the globals, e.g. it is a tuple.
+            self.replayable = False
+        return self._visit_attribute(lhs, node.attr)
+
+    def _visit_attribute(self, lhs, attr):
         if lhs is None or (getattr(lhs, "__name__", "") == TRITON_MODULE):
             return None
-        ret = getattr(lhs, node.attr)
+        ret = getattr(lhs, attr)
         self._update_hash(ret)
         return ret
 
+    def replay(self, lookups):
+        """
+        Redoes the global lookups of an earlier visit of the same source, which has the same result as visiting the
+        source again.
+        """
+        values = []
+        for kind, arg, name in lookups:
+            if kind == "name":
+                self.visiting_arg_default_value = name
+                values.append(self._visit_global(arg))
+                self.visiting_arg_default_value = False
+            else:
+                values.append(self._visit_attribute(values[arg], name))
+        self.lookups = lookups
+
     def visit_FunctionDef(self, node):
         # Save the local name, which may hide the global name.
         self.local_names = {arg.arg for arg in node.args.args}
@@ -231,10 +273,51 @@ def _normalize_ty(ty) -> str:
 class KernelParam:
     """Represents a parameter (name plus metadata) to a @jit'ed function."""
 
-    def __init__(self, num: int, param: inspect.Parameter, do_not_specialize: bool):
+    def __init__(self, num: int, param: inspect.Parameter, do_not_specialize: bool, specialization=None,
+                 max_size=None, value_range=None):
         self.num = num
         self._param = param
-        self.do_not_specialize = do_not_specialize
+        self.do_not_specialize = do_not_specialize or specialization == "none"
+        # "divisibility" drops the equal-to-1 specialization of an integer argument; "divisor" has the launcher pass
+        # the magic numbers that the kernel divides by an integer argument with; "pow2" or a list of buckets keys the
+        # kernels of an integer argument by its value rounded up to the next power of two or bucket, while the kernel
+        # still receives the value itself.
+        self.specialization = specialization
+        if specialization in ("none", "divisibility", "divisor") and self.is_constexpr:
+            raise ValueError(f"constexpr parameter {self.name} can't use the {specialization} specialization")
+        if self.is_bucketed and self.is_constexpr:
+            raise ValueError(
+                f"bucketed parameters are passed to the kernel at runtime, {self.name} can't be a constexpr")
+        if not (specialization in (None, "none", "divisibility", "divisor") or self.is_bucketed):
+            raise ValueError(f"unknown specialization {specialization!r} of parameter {self.name}")
+        # The number of elements a pointer parameter addresses at most, which lets the compiler compute the offsets of
+        # its accesses in 32 bits when it fits
+        self.max_size = max_size
+        if max_size is not None and not (isinstance(max_size, int) and 0 < max_size < 2**31):
+            raise ValueError(f"the max_size of parameter {self.name} must be an int in [1, 2**31), got {max_size!r}")
+        # The [min, max] values of an integer parameter, which lets the compiler decide the comparisons of the offsets
+        # computed from it, e.g. drop the masks that are true for every value in the range
+        self.value_range = None if value_range is None else tuple(value_range)
+        if self.value_range is not None and not (len(self.value_range) == 2 and all(
+                isinstance(v, int) for v in self.value_range) and self.value_range[0] <= self.value_range[1]):
+            raise ValueError(f"the value_range of parameter {self.name} must be a (min, max) pair of ints, "
+                             f"got {value_range!r}")
+        if self.value_range is not None and self.is_constexpr:
+            raise ValueError(f"constexpr parameter {self.name} can't have a value_range")
+
+    @cached_property
+    def is_bucketed(self):
+        return self.specialization == "pow2" or (isinstance(self.specialization, Sequence)
+                                                 and not isinstance(self.specialization, str))
+
+    def bucket(self, v):
+        """Returns the key of the kernels that the launches with the parameter equal to `v` share."""
+        if not self.is_bucketed or not isinstance(v, int) or isinstance(v, bool):
+            return v
+        if self.specialization == "pow2":
+            return 1 << (v - 1).bit_length() if v > 1 else v
+        # Values above the largest bucket get kernels of their own
+        return min((b for b in self.specialization if b >= v), default=v)
 
     @cached_property
     def name(self):
@@ -274,6 +357,14 @@ class KernelParam:
         return self._param.default != inspect.Parameter.empty
 
 
+def compute_divisibility_key(v):
+    if hasattr(v, "data_ptr") and (v.data_ptr() % 16 == 0):
+        return "D"
+    elif isinstance(v, int) and v % 16 == 0:
+        return "D"
+    return "N"
+
+
 def compute_spec_key(v):
 
     if hasattr(v, "data_ptr") and (v.data_ptr() % 16 == 0):
@@ -368,7 +459,11 @@ def create_function_from_signature(sig, kparams):
             constexpr_vals.append(name)
         else:
             non_constexpr_vals.append(name)
-            if not kp.do_not_specialize:
+            if kp.is_bucketed:
+                specialisations.append('str(bucket_%s(%s))' % (name, name))
+            elif kp.specialization == "divisibility":
+                specialisations.append('compute_divisibility_key(%s)' % name)
+            elif not kp.do_not_specialize:
                 specialisations.append('compute_spec_key(%s)' % name)
             if kp.annotation_type:
                 signature_types.append('"%s"' % kp.annotation_type)
@@ -394,8 +489,13 @@ def create_function_from_signature(sig, kparams):
         if param.default is not inspect.Parameter.empty
     }
 
+    for kp in kparams:
+        if kp.is_bucketed:
+            func_namespace[f"bucket_{kp.name}"] = kp.bucket
+
     func_namespace['mangle_type'] = mangle_type
     func_namespace['compute_spec_key'] = compute_spec_key
+    func_namespace['compute_divisibility_key'] = compute_divisibility_key
 
     # Execute the function string in func_namespace to create the function
     exec(func_body, func_namespace)
@@ -433,9 +533,68 @@ for v in list(type_canonicalisation_dict.values()):
     type_canonicalisation_dict[v] = v
 
 
+@dataclass
+class CacheStats:
+    """Kernel cache statistics of a JITFunction."""
+    # Launches and warmups that found their kernel in the cache
+    hits: int = 0
+    # Launches and warmups that had to compile their kernel
+    misses: int = 0
+    # Seconds spent compiling the missed kernels, until they were ready in the case of background compilations
+    compile_time: float = 0.0
+    # Kernels in the cache, and the bytes of their binaries
+    resident_kernels: int = 0
+    resident_bytes: int = 0
+    # Kernels evicted from the cache by its `cache_size`
+    evictions: int = 0
+
+
+class KernelCache(OrderedDict):
+    """
+    The kernels of a JITFunction on a device, by key. When it holds more than `capacity()` kernels, the least recently
+    used one is evicted: `on_evict(key, kernel)` is called, which unloads its module. Lookups with `get`, which the
+    native dispatcher makes too, count as uses.
+    """
+
+    def __init__(self, capacity, on_evict):
+        super().__init__()
+        self.capacity = capacity
+        self.on_evict = on_evict
+
+    def get(self, key, default=None):
+        if key not in self:
+            return default
+        self.move_to_end(key)
+        return super().__getitem__(key)
+
+    def __setitem__(self, key, kernel):
+        super().__setitem__(key, kernel)
+        self.move_to_end(key)
+        capacity = self.capacity()
+        while capacity and len(self) > capacity:
+            evicted_key, evicted = self.popitem(last=False)
+            self.on_evict(evicted_key, evicted)
+
+
+class _KernelCaches(defaultdict):
+    # the kernel cache of each device, bounded by the cache_size of the JITFunction
+
+    def __init__(self, fn):
+        super().__init__()
+        self.fn = fn
+
+    def __missing__(self, device):
+        cache = KernelCache(lambda: self.fn.cache_size,
+                            lambda key, kernel: self.fn._evict(device, key, kernel))
+        self[device] = cache
+        return cache
+
+
 class JITFunction(KernelInterface[T]):
     # Hook for inspecting compiled functions and modules
     cache_hook = None
+    # LaunchQueue recording the launches instead of making them
+    launch_queue = None
     divisibility = 16
 
     @staticmethod
@@ -481,12 +640,13 @@ class JITFunction(KernelInterface[T]):
         divisible_by_16 = {
             param.num
             for param, arg in zip(self.params, args)
-            if is_divisible_by_16(arg) and not param.do_not_specialize
+            if is_divisible_by_16(arg) and not param.do_not_specialize and not param.is_bucketed
         }
         equal_to_1 = {
             param.num
             for param, arg in zip(self.params, args)
             if isinstance(arg, int) and not isinstance(arg, bool) and arg == 1 and not param.do_not_specialize
+            and param.specialization != "divisibility" and not param.is_bucketed
         }
         # folded equal_to_1 and None
         # TODO: method to collect all folded args
@@ -584,10 +744,48 @@ class JITFunction(KernelInterface[T]):
             i for (i, p) in enumerate(self.params) if (not p.do_not_specialize) and (not p.is_constexpr)
         ]
 
+    def _register_native(self, args, kwargs, key, kernel):
+        # Later launches with the same specialization skip the binder
+        if self.dispatcher is None:
+            from .._C.libtriton import dispatcher
+            params = [
+                dispatcher.param(p.name, p.is_constexpr, p.do_not_specialize, p.has_default, p.default,
+                                 p.bucket if p.is_bucketed else None)
+                for p in self.params
+            ]
+            used_globals = [(name, val, globals_dict)
+                            for (name, _), (val, globals_dict) in self.used_global_vals.items()]
+            self.dispatcher = dispatcher.dispatcher(params, self.cache, driver.active.get_current_device,
+                                                    driver.active.get_current_stream, used_globals)
+        self.dispatcher.register(args, kwargs, self.debug, kernel, key)
+
+    def bind(self, grid, *args, **kwargs):
+        """
+        Compiles the kernel for `args` and returns a launch of it whose grid and arguments are resolved once, see
+        :code:`CompiledKernel.bind`. The indices of :code:`set_arg` are the ones of the arguments that aren't
+        :code:`tl.constexpr`.
+        """
+        stream = kwargs.pop("stream", None)
+        kernel = self.run(*args, grid=grid, warmup=True, **kwargs)
+        bound_args, _, _, non_constexpr_vals, _ = self.binder(*args, **kwargs)
+        if callable(grid):
+            grid = grid(bound_args)
+        return kernel.bind(grid, *non_constexpr_vals, stream=stream)
+
     def run(self, *args, grid, warmup, **kwargs):
+        if not warmup and self.dispatcher is not None and not self.pre_run_hooks and JITFunction.launch_queue is None \
+                and self.CompiledKernel.launch_enter_hook is None and self.CompiledKernel.launch_exit_hook is None:
+            kernel = self.dispatcher.launch(grid, args, kwargs, self.debug)
+            if kernel is not None:
+                return kernel
+
+        if self.pending_compiles:
+            self._install_background_compiles()
+
         # parse options
         device = driver.active.get_current_device()
         stream = driver.active.get_current_stream(device)
+        fallback_kwargs = dict(kwargs) if self.fallback is not None else None
         kwargs["debug"] = self.debug
 
         # Execute pre run hooks with args and kwargs
@@ -602,8 +800,13 @@ class JITFunction(KernelInterface[T]):
         # compute cache key
         key = ''.join(sig_and_spec) + str((constexpr_vals, excess_kwargs))
         kernel = self.cache[device].get(key, None)
+        # Whether kernel is a more general specialization launched until the one of key is compiled
+        is_general_kernel = False
 
-        if kernel is None:
+        if kernel is not None:
+            self._cache_stats.hits += 1
+        else:
+            self._cache_stats.misses += 1
             # Kernel is not cached; we have to compile.
             target = driver.active.get_current_target()
             backend = self.make_backend(target)
@@ -641,12 +844,33 @@ class JITFunction(KernelInterface[T]):
                 return None
             # compile the kernel
             src = self.ASTSource(self, signature, constants, configs[0])
-            kernel = self.compile(
-                src,
-                target=target,
-                options=options.__dict__,
-            )
-            self.cache[device][key] = kernel
+            if self.async_compile and not warmup:
+                future = self._compile_in_background(device, key, src, target, options)
+                if not future.done():
+                    # The same signature without divisibility or equal-to-1 assumptions
+                    num_sig = len(sigkeys)
+                    general_key = ''.join(sig_and_spec[:num_sig]) + "N" * (len(sig_and_spec) - num_sig) + str(
+                        (constexpr_vals, excess_kwargs))
+                    kernel = self.cache[device].get(general_key, None)
+                    is_general_kernel = kernel is not None
+                    if kernel is None and self.fallback is not None:
+                        return self.fallback(*args, grid=grid, **fallback_kwargs)
+                if kernel is None:
+                    self.pending_compiles.pop((device, key), None)
+                    kernel = future.result()
+                    # the done callback may not have run yet when the result is waited for
+                    compile_time = getattr(future, "compile_time", time.perf_counter() - future.start)
+                    self._cache_stats.compile_time += compile_time
+                    self.cache[device][key] = kernel
+            else:
+                start = time.perf_counter()
+                kernel = self.compile(
+                    src,
+                    target=target,
+                    options=options.__dict__,
+                )
+                self._cache_stats.compile_time += time.perf_counter() - start
+                self.cache[device][key] = kernel
 
         # Check that used global values have not changed.
         not_present = object()
@@ -670,13 +894,70 @@ class JITFunction(KernelInterface[T]):
 
             # launch kernel
             launch_metadata = kernel.launch_metadata(grid, stream, *non_constexpr_vals)
+            if JITFunction.launch_queue is not None:
+                JITFunction.launch_queue.record(kernel, (grid_0, grid_1, grid_2), launch_metadata, non_constexpr_vals)
+                return kernel
             kernel.run(grid_0, grid_1, grid_2, stream, kernel.function, kernel.packed_metadata, launch_metadata,
                        self.CompiledKernel.launch_enter_hook, self.CompiledKernel.launch_exit_hook, *non_constexpr_vals)
+            if not is_general_kernel:
+                self._register_native(args, kwargs, key, kernel)
         return kernel
 
+    def _compile_in_background(self, device, key, src, target, options):
+        """
+        Returns the future of the kernel of `key`, compiled on the compile thread pool. The next launch after it is
+        compiled adds the kernel to the cache, see `_install_background_compiles`. A failed compilation stays pending,
+        so that the next launch of `key` raises its error.
+        """
+        future = self.pending_compiles.get((device, key), None)
+        if future is not None:
+            return future
+        from ..compiler import compile_async
+        start = time.perf_counter()
+        future = compile_async(src, target=target, options=options.__dict__)
+        future.start = start
+        self.pending_compiles[(device, key)] = future
+
+        def done(future):
+            future.compile_time = time.perf_counter() - future.start
+
+        future.add_done_callback(done)
+        return future
+
+    def _install_background_compiles(self):
+        # The kernel caches are only updated by the launching thread: an insertion can evict and unload a kernel that
+        # a launch has just looked up, so the compile threads leave the compiled kernels in their futures.
+        for (device, key), future in list(self.pending_compiles.items()):
+            if not future.done() or future.exception() is not None:
+                continue
+            del self.pending_compiles[(device, key)]
+            self._cache_stats.compile_time += future.compile_time
+            self.cache[device][key] = future.result()
+
+    @property
+    def cache_stats(self) -> CacheStats:
+        """Statistics of the kernel cache, including the launches made by the native dispatcher."""
+        hits = self._cache_stats.hits + (self.dispatcher.num_launches if self.dispatcher is not None else 0)
+        # kernels cached under several keys count once
+        kernels = {id(kernel): kernel for cache in self.cache.values() for kernel in cache.values()}.values()
+        return CacheStats(hits, self._cache_stats.misses, self._cache_stats.compile_time, len(kernels),
+                          sum(len(kernel.kernel) for kernel in kernels), self._cache_stats.evictions)
+
+    def _evict(self, device, key, kernel):
+        self._cache_stats.evictions += 1
+        if self.dispatcher is not None:
+            self.dispatcher.evict(key)
+        if any(other is kernel for other in self.cache[device].values()):
+            return
+        kernel.unload()
+
     def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None, repr=None,
-                 launch_metadata=None):
+                 launch_metadata=None, async_compile=False, fallback=None, specialize=None, max_size=None,
+                 value_range=None, cache_size=None):
         do_not_specialize = do_not_specialize if do_not_specialize else []
+        specialize = specialize if specialize else {}
+        max_size = max_size if max_size else {}
+        value_range = value_range if value_range else {}
 
         self.fn = fn
         self.module = fn.__module__
@@ -686,19 +967,32 @@ class JITFunction(KernelInterface[T]):
         self.starting_line_number = inspect.getsourcelines(fn)[1]
         self.repr = lambda _: fn.__name__ if repr is None else repr(_)
         self.launch_metadata = launch_metadata
+        self.async_compile = async_compile
+        self.fallback = fallback
+        # Kernels compiled in the background in async_compile mode, by (device, key)
+        self.pending_compiles = {}
+        self._cache_stats = CacheStats()
 
         self.binder = None
+        # Native launcher of the kernels compiled so far
+        self.dispatcher = None
 
         self.params = []
         for i, param in enumerate(self.signature.parameters.values()):
             dns = do_not_specialize and (i in do_not_specialize or param.name in do_not_specialize)
-            self.params.append(KernelParam(i, param, dns))
+            specialization = specialize.get(i, specialize.get(param.name, None))
+            self.params.append(
+                KernelParam(i, param, dns, specialization, max_size.get(i, max_size.get(param.name, None)),
+                            value_range.get(i, value_range.get(param.name, None))))
 
         # function source code (without decorators)
         self.src = textwrap.dedent(inspect.getsource(fn))
         self.src = self.src[re.search(r"^def\s+\w+\s*\(", self.src, re.MULTILINE).start():]
-        # cache of just-in-time compiled kernels
-        self.cache = defaultdict(dict)
+        # cache of just-in-time compiled kernels, by device
+        if cache_size is None and os.getenv("TRITON_KERNEL_CACHE_SIZE"):
+            cache_size = int(os.getenv("TRITON_KERNEL_CACHE_SIZE"))
+        self.cache_size = cache_size
+        self.cache = _KernelCaches(self)
         self.hash = None
 
         # Map of global variables used by the function and any functions it
@@ -736,15 +1030,61 @@ class JITFunction(KernelInterface[T]):
     def cache_key(self):
         # TODO : hash should be attribute of `self`
         if self.hash is None:
-            dependencies_finder = DependenciesFinder(name=self.__name__, globals=self.__globals__, src=self.src)
-            dependencies_finder.visit(self.parse())
+            dependencies_finder = self._find_dependencies()
             self.hash = dependencies_finder.ret + str(self.starting_line_number)
+            max_sizes = [p.max_size for p in self.params]
+            if any(max_sizes):
+                self.hash += str(max_sizes)
+            value_ranges = [p.value_range for p in self.params]
+            if any(value_ranges):
+                self.hash += f"ranges{value_ranges}"
+            divisors = [p.num for p in self.params if p.specialization == "divisor"]
+            if divisors:
+                self.hash += f"divisors{divisors}"
             self.used_global_vals = dict(sorted(dependencies_finder.used_global_vals.items()))
         return self.hash
 
+    def _find_dependencies(self):
+        # Which globals the source looks up doesn't depend on their values, so the lookups are cached on disk per
+        # source and only redone against the current globals, which saves parsing and visiting large kernel
+        # libraries on every import.
+        from .cache import FileCacheManager
+        new_finder = lambda: DependenciesFinder(name=self.__name__, globals=self.__globals__, src=self.src)
+        dependencies_finder = new_finder()
+        key = hashlib.sha256(f"dependencies-{DEPENDENCIES_FORMAT_VERSION}-{self.src}".encode("utf-8")).hexdigest()
+        cache_manager = FileCacheManager(key)
+        path = cache_manager.get_file("dependencies.json")
+        if path is not None:
+            try:
+                with open(path) as f:
+                    dependencies_finder.replay([tuple(lookup) for lookup in json.load(f)])
+                return dependencies_finder
+            except Exception:
+                # A broken cache entry or a global that can't be looked up anymore, which the visit reports.
+                dependencies_finder = new_finder()
+        dependencies_finder.visit(self.parse())
+        if dependencies_finder.replayable:
+            cache_manager.put(json.dumps(dependencies_finder.lookups), "dependencies.json", binary=False)
+        return dependencies_finder
+
     def warmup(self, *args, grid, **kwargs):
         return self.run(grid=grid, warmup=True, *map(MockTensor.wrap_dtype, args), **kwargs)
 
+    def warmup_async(self, *args, grid, **kwargs):
+        """
+        Like `warmup`, but compiles the kernel on the compile thread pool and returns a future of the compiled kernel,
+        so that many specializations can be warmed up in parallel.
+        """
+        from ..compiler import get_compile_executor
+        # The current device is per thread
+        device = driver.active.get_current_device()
+
+        def warmup():
+            driver.active.set_current_device(device)
+            return self.warmup(*args, grid=grid, **kwargs)
+
+        return get_compile_executor().submit(warmup)
+
     def preload(self, specialization_data):
         from ..compiler import AttrsDescriptor, compile, ASTSource
         import json
@@ -788,6 +1128,7 @@ class JITFunction(KernelInterface[T]):
         #   to be reinitialized
         if name == "src":
             self.hash = None
+            self.dispatcher = None
 
     def __repr__(self):
         return f"JITFunction({self.module}:{self.fn.__name__})"
@@ -812,6 +1153,12 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    async_compile: bool = False,
+    fallback: Optional[Callable] = None,
+    specialize: Optional[Dict[Union[int, str], Union[str, Sequence[int]]]] = None,
+    max_size: Optional[Dict[Union[int, str], int]] = None,
+    value_range: Optional[Dict[Union[int, str], Tuple[int, int]]] = None,
+    cache_size: Optional[int] = None,
 ) -> Callable[[T], JITFunction[T]]:
     ...
 
@@ -825,6 +1172,12 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    async_compile: bool = False,
+    fallback: Optional[Callable] = None,
+    specialize: Optional[Dict[Union[int, str], Union[str, Sequence[int]]]] = None,
+    max_size: Optional[Dict[Union[int, str], int]] = None,
+    value_range: Optional[Dict[Union[int, str], Tuple[int, int]]] = None,
+    cache_size: Optional[int] = None,
 ) -> Union[JITFunction[T], Callable[[T], JITFunction[T]]]:
     """
     Decorator for JIT-compiling a function using the Triton compiler.
@@ -842,6 +1195,34 @@ def jit(
 
     :param fn: the function to be jit-compiled
     :type fn: Callable
+    :param async_compile: compile new specializations on the compile thread pool instead of blocking the launch.
+        Until a specialization is compiled, its launches use the kernel compiled for the same signature without
+        divisibility or equal-to-1 assumptions if there is one, or else `fallback`, and otherwise wait.
+    :type async_compile: bool
+    :param fallback: called as `fallback(*args, grid=grid, **kwargs)` in place of the launches that
+        `async_compile` can't serve yet.
+    :type fallback: Callable, optional
+    :param specialize: specialization policy of parameters, by name or index, to bound the number of kernels:
+        `"none"` (like `do_not_specialize`) or `"divisibility"` (no equal-to-1 specialization) for integer and
+        pointer arguments, `"divisor"` for integer arguments that the kernel divides by, which must be positive:
+        the launcher computes magic numbers from their values so that `//` and `%` of non-negative int32 values by
+        them become a multiplication and a shift, `"pow2"` or a sorted list of buckets for integer arguments, e.g.
+        sequence lengths, which aren't specialized on their divisibility or equality to 1 but on their value
+        rounded up to the next power of two or bucket. The launches of a bucket share a kernel, which receives the
+        actual value. Values above the largest bucket get kernels of their own.
+    :type specialize: dict, optional
+    :param max_size: the number of elements that pointer parameters, by name or index, address at most. The offsets
+        of the accesses to such pointers are computed in 32 bits when the bound is below 2**31, the launches must not
+        access elements beyond it.
+    :type max_size: dict, optional
+    :param value_range: the (min, max) values of integer parameters, by name or index, which the launches must stay
+        within. The compiler uses them to decide the comparisons of the values computed from them, e.g. to drop the
+        masks that hold for all of them.
+    :type value_range: dict, optional
+    :param cache_size: the number of kernels kept per device, for processes that compile new specializations for
+        days. The least recently used kernel is evicted, and its module unloaded, when a new one is compiled.
+        Defaults to :code:`TRITON_KERNEL_CACHE_SIZE`, or no bound. :code:`cache_stats` reports the resident kernels.
+    :type cache_size: int, optional
     """
 
     def decorator(fn: T) -> JITFunction[T]:
@@ -858,6 +1239,12 @@ def jit(
                 noinline=noinline,
                 repr=repr,
                 launch_metadata=launch_metadata,
+                async_compile=async_compile,
+                fallback=fallback,
+                specialize=specialize,
+                max_size=max_size,
+                value_range=value_range,
+                cache_size=cache_size,
             )
 
     if fn is not None:
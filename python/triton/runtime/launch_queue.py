@@ -0,0 +1,108 @@
+import weakref
+
+from .driver import driver
+from .jit import JITFunction
+
+
+def _release_modules(modules):
+    from ..compiler.compiler import _release_module
+    for module in modules:
+        _release_module(module)
+
+
+class LaunchQueue:
+    """
+    Records the kernel launches made in its context, which are all made by one native call to :code:`submit`.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        queue = triton.runtime.LaunchQueue(use_graph=True)
+        for step in range(num_steps):
+            with queue:
+                for expert in range(num_experts):
+                    kernel[grid](x[expert], y[expert], ...)
+            queue.submit()
+
+    Kernels are compiled as they are recorded. Launches made by other threads are recorded as well while a queue is
+    active, and queues can't be nested.
+
+    :param use_graph: Capture every distinct batch of launches into a CUDA graph, or a HIP graph, the first time it is
+        submitted and replay the graph when it is submitted again. Batches are the same if they launch the same kernels
+        with the same grids and arguments. The graphs read and write the same memory every time, so the tensors passed
+        to the kernels must stay alive as long as the queue is used.
+    :type use_graph: bool
+    """
+
+    def __init__(self, use_graph=False):
+        self.use_graph = use_graph
+        self.launches = []
+        # the modules of the recorded kernels, which are kept loaded until the launches are submitted
+        self.modules = []
+        self.graphs = {}
+
+    def __enter__(self):
+        if JITFunction.launch_queue is not None:
+            raise RuntimeError("Launch queues can't be nested")
+        JITFunction.launch_queue = self
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        JITFunction.launch_queue = None
+
+    def __len__(self):
+        return len(self.launches)
+
+    def record(self, kernel, grid, launch_metadata, args):
+        from ..compiler import CompiledKernel
+        from ..compiler.compiler import _retain_module
+        # Skip the __call__ of the launcher objects
+        launcher = getattr(kernel.run, "launch", kernel.run)
+        # The stream is set when the launches are submitted
+        launch_args = (*grid, None, kernel.function, kernel.packed_metadata, launch_metadata,
+                       CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, *args)
+        self.launches.append((launcher, launch_args))
+        _retain_module(kernel.module)
+        self.modules.append(kernel.module)
+
+    def _get_graph_key(self):
+        key = []
+        for _, launch_args in self.launches:
+            # function and grid, then the kernel arguments
+            key.append(launch_args[:3] + launch_args[4:5] +
+                       tuple(arg.data_ptr() if hasattr(arg, "data_ptr") else arg for arg in launch_args[9:]))
+        return tuple(key)
+
+    def submit(self, stream=None):
+        """
+        Launch the recorded kernels, in the order they were recorded, and clear the queue.
+
+        :param stream: The stream to launch the kernels on. Defaults to the current stream. Graphs are replayed on the
+            current stream.
+        """
+        from .._C.libtriton import dispatcher
+        if not self.launches:
+            return
+        modules, self.modules = self.modules, []
+        if not self.use_graph:
+            if stream is None:
+                stream = driver.active.get_current_stream(driver.active.get_current_device())
+            dispatcher.launch_batch(self.launches, stream)
+            self.launches = []
+            _release_modules(modules)
+            return
+        import torch
+        key = self._get_graph_key()
+        graph = self.graphs.get(key, None)
+        if graph is None:
+            graph = torch.cuda.CUDAGraph()
+            with torch.cuda.graph(graph):
+                dispatcher.launch_batch(self.launches, torch.cuda.current_stream().cuda_stream)
+            self.graphs[key] = graph
+            # the graph launches the kernels for as long as it is alive
+            weakref.finalize(graph, _release_modules, modules)
+        else:
+            _release_modules(modules)
+        self.launches = []
+        # Capturing doesn't run the kernels
+        graph.replay()
@@ -0,0 +1,52 @@
+def multi_tensor_apply(kernel, tensor_lists, *args, chunk_size=2048, **kwargs):
+    """
+    Launches an elementwise kernel once over lists of tensors, such as the parameters and the gradients of an
+    optimizer step, instead of once per tensor.
+
+    The tensors are split into chunks of at most :code:`chunk_size` elements, and the kernel is launched with a program
+    per chunk. It's passed a table of the chunks on the device, then :code:`args`, then :code:`chunk_size` as the
+    :code:`CHUNK_SIZE` constexpr, then :code:`kwargs`. The row of a chunk holds, as int64s, the address of the chunk in
+    the tensor of each list, followed by the number of elements of the chunk.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        @triton.jit
+        def axpy_kernel(Table, alpha, CHUNK_SIZE: tl.constexpr):
+            row = Table + tl.program_id(0) * 3
+            x = tl.load(row).to(tl.pointer_type(tl.float32))
+            y = tl.load(row + 1).to(tl.pointer_type(tl.float32))
+            offsets = tl.arange(0, CHUNK_SIZE)
+            mask = offsets < tl.load(row + 2)
+            tl.store(y + offsets, tl.load(y + offsets, mask=mask) + alpha * tl.load(x + offsets, mask=mask), mask=mask)
+
+        triton.runtime.multi_tensor_apply(axpy_kernel, [grads, params], -lr)
+
+    The table is built natively and copied to the device asynchronously, so the host only goes through the Python
+    launch path once. The tensors must be contiguous, and the tensors at the same index in the lists must have the same
+    number of elements. A tensor list should hold a single dtype, which the kernel casts the addresses to.
+
+    :param kernel: The :code:`@triton.jit` kernel.
+    :param tensor_lists: The lists of tensors.
+    :param chunk_size: The number of elements of the chunks. Keep it a multiple of 16 so that the chunks of aligned
+        tensors are aligned too.
+    :returns: The number of programs launched.
+    """
+    import torch
+    from .._C.libtriton import dispatcher
+    tensor_lists = [list(tensors) for tensors in tensor_lists]
+    if not tensor_lists or not tensor_lists[0]:
+        return 0
+    device = tensor_lists[0][0].device
+
+    # The caching host allocator holds the pinned buffer until the copy is done
+    def allocate(size):
+        return torch.empty(size, dtype=torch.int64, pin_memory=True)
+
+    host_table = dispatcher.build_chunk_table(tensor_lists, chunk_size, allocate)
+    num_chunks = host_table.numel() // (len(tensor_lists) + 1)
+    if num_chunks == 0:
+        return 0
+    table = host_table.to(device, non_blocking=True)
+    kernel[(num_chunks, )](table, *args, CHUNK_SIZE=chunk_size, **kwargs)
+    return num_chunks
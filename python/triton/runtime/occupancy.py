@@ -0,0 +1,38 @@
+import math
+
+# registers are allocated to threads in units of 8, i.e. 256 per warp of 32
+_REGISTER_GRANULARITY = 8
+
+
+def compute_occupancy(props, num_warps, warp_size, n_regs, shared, cluster_dims=(1, 1, 1)):
+    """
+    Computes the theoretical occupancy of a kernel on the multiprocessors of a device.
+
+    :param props: the properties of the device, from :code:`driver.active.utils.get_device_properties`
+    :param n_regs: the registers per thread of the kernel, 0 if they are unknown
+    :param shared: the bytes of shared memory per block of the kernel
+    :param cluster_dims: the blocks per cluster of the kernel
+    :return: a dict with the blocks and warps that are resident on a multiprocessor, the ratio of the warps to the
+        most warps a multiprocessor runs, the resource that limits the blocks, and the most clusters that are
+        resident on the device.
+    """
+    max_warps_per_sm = props["max_threads_per_sm"] // warp_size
+    limits = dict()
+    if n_regs > 0:
+        regs_per_warp = math.ceil(n_regs / _REGISTER_GRANULARITY) * _REGISTER_GRANULARITY * warp_size
+        limits["registers"] = props["max_regs_per_sm"] // regs_per_warp // num_warps
+    if shared > 0:
+        limits["shared_memory"] = props["max_shared_mem_per_sm"] // (shared + props["reserved_shared_mem"])
+    limits["warps"] = max_warps_per_sm // num_warps
+    limits["blocks"] = props["max_blocks_per_sm"]
+    limiter = min(limits, key=limits.get)
+    blocks_per_sm = limits[limiter]
+    cluster_size = math.prod(cluster_dims)
+    return {
+        "blocks_per_sm": blocks_per_sm,
+        "warps_per_sm": blocks_per_sm * num_warps,
+        "warp_occupancy": blocks_per_sm * num_warps / max_warps_per_sm,
+        "limiter": limiter,
+        # the blocks of a cluster are resident together, on several multiprocessors
+        "max_active_clusters": blocks_per_sm * props["multiprocessor_count"] // cluster_size,
+    }
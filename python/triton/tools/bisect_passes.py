@@ -0,0 +1,114 @@
+"""
+Performance bisection of the TTGIR pipeline.
+
+When a compiler change slows a kernel down, this looks for the passes of the `make_ttgir` pipeline that the slowdown
+comes from, by compiling and timing the kernel with each of them disabled in turn:
+
+    python -m triton.tools.bisect_passes harness.py --reference 0.42
+
+The harness is a Python file defining `setup()`. It allocates the inputs and returns a function that launches the
+kernel with the compile options it is given:
+
+    def setup():
+        x = torch.randn(1 << 20, device="cuda")
+        y = torch.empty_like(x)
+        return lambda **options: kernel[(256, )](x, y, BLOCK=4096, **options)
+
+The passes are toggled through the `disabled_passes` compile option, one instance at a time. A pass that is added
+several times, such as `add_remove_layout_conversions`, is reported for each of its positions in the pipeline, so
+disabling an early instance tells whether the pass only hurts before the passes that follow it. A pass is a suspect
+when disabling it makes the kernel more than the threshold, 3% by default, faster. `--reference` gives the time of
+the kernel with a known good compiler, in ms, and reports how much of the slowdown each variant recovers. Variants
+that fail to compile are reported as required.
+"""
+import argparse
+import importlib.util
+import json
+import sys
+from typing import Callable, Dict, List, Optional, Tuple
+
+import triton
+
+DEFAULT_THRESHOLD = 0.03
+
+
+def load_harness(path: str) -> Callable:
+    spec = importlib.util.spec_from_file_location("bisect_harness", path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module.setup()
+
+
+def _time(launch: Callable, disabled: Tuple[str, ...]) -> Optional[float]:
+    try:
+        launch(disabled_passes=disabled)
+    except Exception:
+        return None
+    return triton.testing.do_bench(lambda: launch(disabled_passes=disabled), quantiles=[0.5])
+
+
+def bisect(launch: Callable) -> dict:
+    """
+    Times the kernel launched by `launch` with the full pipeline, then with each pass instance of the pipeline
+    disabled. Returns the pipeline, the baseline time and the time of each variant in ms, None if it failed to compile.
+    """
+    kernel = launch()
+    pipeline = list(getattr(kernel.metadata, "ttgir_pipeline", ()))
+    if not pipeline:
+        raise RuntimeError("the backend doesn't report its TTGIR pipeline")
+    return {
+        "pipeline": pipeline,
+        "baseline": _time(launch, ()),
+        "variants": {instance: _time(launch, (instance, )) for instance in pipeline},
+    }
+
+
+def find_suspects(baseline: float, variants: Dict[str, Optional[float]],
+                  threshold: float = DEFAULT_THRESHOLD) -> List[Tuple[str, float]]:
+    """
+    Returns the pass instances whose removal makes the kernel more than `threshold` faster than `baseline`, with the
+    time without them, fastest first.
+    """
+    limit = baseline * (1 - threshold)
+    suspects = [(instance, ms) for instance, ms in variants.items() if ms is not None and ms < limit]
+    return sorted(suspects, key=lambda suspect: suspect[1])
+
+
+def _report(results, threshold, reference):
+    baseline = results["baseline"]
+    suspects = dict(find_suspects(baseline, results["variants"], threshold))
+    print(f"{'full pipeline':45} {baseline:10.4f} ms")
+    for instance in results["pipeline"]:
+        ms = results["variants"][instance]
+        if ms is None:
+            print(f"{'-' + instance:45} {'':>13} required")
+            continue
+        status = "SUSPECT" if instance in suspects else ""
+        recovered = ""
+        if reference is not None and baseline > reference:
+            recovered = f"{(baseline - ms) / (baseline - reference):7.0%} recovered"
+        print(f"{'-' + instance:45} {ms:10.4f} ms {ms / baseline - 1:+8.1%} {recovered} {status}")
+    if reference is not None:
+        print(f"reference {reference:.4f} ms, full pipeline {baseline / reference - 1:+.1%}")
+    print(f"{len(suspects)} suspects above {threshold:.0%}")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("harness", help="Python file whose setup() returns the function launching the kernel")
+    parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD,
+                        help="Relative speedup that makes a pass a suspect")
+    parser.add_argument("--reference", type=float, default=None, help="Time of the kernel with a good compiler, in ms")
+    parser.add_argument("-o", "--output", default=None, help="Path of the timings as JSON")
+    args = parser.parse_args(argv)
+
+    results = bisect(load_harness(args.harness))
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2)
+    _report(results, args.threshold, args.reference)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,19 @@
+import argparse
+
+from triton.runtime.cache import build_cache_archive
+
+desc = """
+Pack the kernels of a Triton cache directory into an archive, which is loaded at startup with
+`triton.compiler.preload_cache_archive`:
+
+    python build_cache_archive.py kernels.tca --cache-dir ~/.triton/cache
+"""
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=desc, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("path", help="Path of the archive")
+    parser.add_argument("--cache-dir", default=None,
+                        help="Cache directory to pack, defaults to the directory of the file cache manager")
+    args = parser.parse_args()
+    num_kernels = build_cache_archive(args.path, args.cache_dir)
+    print(f"Archived {num_kernels} kernels into {args.path}")
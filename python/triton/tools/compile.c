@@ -11,6 +11,12 @@
     gpuAssert((ans), __FILE__, __LINE__);\
   }}\
 
+#define CUDA_RETURN_IF_ERROR(ans) {{\
+    CUresult err_ = (ans);\
+    if (err_ != CUDA_SUCCESS)\
+      return err_;\
+  }}\
+
 static inline void gpuAssert(CUresult code, const char *file, int line) {{
   if (code != CUDA_SUCCESS) {{
     const char *prefix = "Triton Error [CUDA]: ";
@@ -24,44 +30,145 @@ static inline void gpuAssert(CUresult code, const char *file, int line) {{
   }}
 }}
 
-// globals
-#define CUBIN_NAME {kernel_name}_cubin
-CUmodule {kernel_name}_mod = NULL;
-CUfunction {kernel_name}_func = NULL;
-unsigned char CUBIN_NAME[{bin_size}] = {{ {bin_data} }};
+// binaries, each of which runs on the devices of compute capability
+// min_cc to max_cc, from the most to the least specific
+typedef struct {{
+  int min_cc;
+  int max_cc;
+  const void *data;
+  int shared;
+}} binary_t;
+
+{bin_data}
+static const binary_t binaries[{num_bins}] = {{
+  {bin_table}
+}};
+
+// modules, loaded once in each context that launches the kernel; the loads
+// are serialized, the launches only read the published entries
+#define MAX_CONTEXTS 64
+typedef struct {{
+  CUcontext ctx;
+  CUmodule mod;
+  CUfunction func;
+  int shared;
+}} module_t;
+
+static module_t modules[MAX_CONTEXTS];
+static int num_modules = 0;
+static int modules_lock = 0;
+
+static void lock_modules(void) {{
+  while (__atomic_exchange_n(&modules_lock, 1, __ATOMIC_ACQUIRE))
+    ;
+}}
+
+static void unlock_modules(void) {{
+  __atomic_store_n(&modules_lock, 0, __ATOMIC_RELEASE);
+}}
 
+static module_t *find_module(CUcontext ctx) {{
+  int n = __atomic_load_n(&num_modules, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < n; i++)
+    if (modules[i].ctx == ctx)
+      return &modules[i];
+  return NULL;
+}}
+
+static CUresult select_binary(CUdevice dev, int *index) {{
+  int major, minor;
+  CUDA_RETURN_IF_ERROR(cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, dev));
+  CUDA_RETURN_IF_ERROR(cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, dev));
+  int cc = major * 10 + minor;
+  for (int i = 0; i < {num_bins}; i++) {{
+    if (binaries[i].min_cc <= cc && cc <= binaries[i].max_cc) {{
+      *index = i;
+      return CUDA_SUCCESS;
+    }}
+  }}
+  return CUDA_ERROR_NO_BINARY_FOR_GPU;
+}}
+
+static CUresult load_module_locked(CUcontext ctx, module_t **out) {{
+  module_t *m = find_module(ctx);
+  if (m && m->func) {{
+    *out = m;
+    return CUDA_SUCCESS;
+  }}
+  if (!m && num_modules == MAX_CONTEXTS)
+    return CUDA_ERROR_OUT_OF_MEMORY;
+  CUdevice dev;
+  int index;
+  CUmodule mod;
+  CUfunction func;
+  CUDA_RETURN_IF_ERROR(cuCtxGetDevice(&dev));
+  CUDA_RETURN_IF_ERROR(select_binary(dev, &index));
+  CUDA_RETURN_IF_ERROR(cuModuleLoadData(&mod, binaries[index].data));
+  CUDA_RETURN_IF_ERROR(cuModuleGetFunction(&func, mod, "{triton_kernel_name}"));
+  // set dynamic shared memory if necessary
+  int shared = binaries[index].shared;
+  int shared_optin;
+  CUDA_RETURN_IF_ERROR(cuDeviceGetAttribute(&shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, dev));
+  if (shared > 49152 && shared_optin > 49152) {{
+    CUDA_RETURN_IF_ERROR(cuFuncSetCacheConfig(func, CU_FUNC_CACHE_PREFER_SHARED));
+    CUDA_RETURN_IF_ERROR(cuFuncSetAttribute(func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, shared_optin));
+  }}
+  int is_new = m == NULL;
+  if (is_new)
+    m = &modules[num_modules];
+  m->ctx = ctx;
+  m->mod = mod;
+  m->shared = shared;
+  __atomic_store_n(&m->func, func, __ATOMIC_RELEASE);
+  if (is_new)
+    __atomic_store_n(&num_modules, num_modules + 1, __ATOMIC_RELEASE);
+  *out = m;
+  return CUDA_SUCCESS;
+}}
+
+// returns the module of the current context, loading it on first use
+static CUresult load_module(module_t **out) {{
+  CUcontext ctx;
+  CUDA_RETURN_IF_ERROR(cuCtxGetCurrent(&ctx));
+  module_t *m = find_module(ctx);
+  if (m && __atomic_load_n(&m->func, __ATOMIC_ACQUIRE)) {{
+    *out = m;
+    return CUDA_SUCCESS;
+  }}
+  lock_modules();
+  CUresult err = load_module_locked(ctx, out);
+  unlock_modules();
+  return err;
+}}
 
 void unload_{kernel_name}(void) {{
-    CUDA_CHECK(cuModuleUnload({kernel_name}_mod));
+  CUcontext ctx;
+  CUDA_CHECK(cuCtxGetCurrent(&ctx));
+  lock_modules();
+  module_t *m = find_module(ctx);
+  if (m && m->func) {{
+    __atomic_store_n(&m->func, NULL, __ATOMIC_RELEASE);
+    CUDA_CHECK(cuModuleUnload(m->mod));
+  }}
+  unlock_modules();
 }}
 
-// TODO: some code duplication with `runtime/backend/cuda.c`
 void load_{kernel_name}() {{
-    int dev = 0;
-    void *bin = (void *)&CUBIN_NAME;
-    int shared = {shared};
-    CUDA_CHECK(cuModuleLoadData(&{kernel_name}_mod, bin));
-    CUDA_CHECK(cuModuleGetFunction(&{kernel_name}_func, {kernel_name}_mod, "{triton_kernel_name}"));
-    // set dynamic shared memory if necessary
-    int shared_optin;
-    CUDA_CHECK(cuDeviceGetAttribute(&shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, dev));
-    if (shared > 49152 && shared_optin > 49152) {{
-      CUDA_CHECK(cuFuncSetCacheConfig({kernel_name}_func, CU_FUNC_CACHE_PREFER_SHARED));
-      CUDA_CHECK(cuFuncSetAttribute({kernel_name}_func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, shared_optin))
-    }}
+  module_t *m;
+  CUDA_CHECK(load_module(&m));
 }}
 
 /*
 {kernel_docstring}
 */
 CUresult {kernel_name}(CUstream stream, {signature}) {{
-    if ({kernel_name}_func == NULL)
-       load_{kernel_name}();
+    module_t *m;
+    CUDA_RETURN_IF_ERROR(load_module(&m));
     unsigned int gX = {gridX};
     unsigned int gY = {gridY};
     unsigned int gZ = {gridZ};
     void *args[{num_args}] = {{ {arg_pointers} }};
-    // TODO: shared memory
     if(gX * gY * gZ > 0)
-      return cuLaunchKernel({kernel_name}_func, gX, gY, gZ, {num_warps} * 32, 1, 1, {shared}, stream, args, NULL);
+      return cuLaunchKernel(m->func, gX, gY, gZ, {num_warps} * 32, 1, 1, m->shared, stream, args, NULL);
+    return CUDA_SUCCESS;
 }}
@@ -10,5 +10,6 @@
 
 void unload_{kernel_name}(void);
 void load_{kernel_name}(void);
+// tt-linker-backend: cuda
 // tt-linker: {kernel_name}:{full_signature}:{algo_info}
 CUresult{_placeholder} {kernel_name}(CUstream stream, {signature});
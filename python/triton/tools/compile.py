@@ -7,8 +7,8 @@ from pathlib import Path
 from typing import List
 
 import triton
+from triton.backends.compiler import GPUTarget
 from triton.compiler.code_generator import kernel_suffix
-from triton.backends.nvidia.driver import ty_to_cpp
 
 desc = """
 Triton ahead-of-time compiler:
@@ -17,6 +17,14 @@ This program compiles the kernel with name `kernel-name` in the file at the
 provided `path` into self-contained C source-code that embeds the `cubin`
 data along with utilities to load, unload and launch the kernel.
 
+The kernel is compiled for the active device, or for each of the targets given
+with `--target`, e.g. `--target cuda:80 --target cuda:90` or `--target hip:gfx942`.
+The binaries of all the targets are embedded in the same source, and the one that
+matches the device of the current context is loaded the first time the kernel is
+launched in that context. CUDA sources also embed the PTX of the newest target
+that isn't architecture-specific, which the driver compiles for newer devices.
+All the targets of one invocation must share a backend.
+
 signature is provided as a list of (optionally divisibility-hinted) types
 or constexpr values, e.g.
 
@@ -30,12 +38,42 @@ The resulting entry point will have signature
 
 CUresult kernel_{specialization_suffix}(CUstream stream, unsigned gX, unsigned gY, unsigned gZ, float* arg0, int32_t arg1, int32_t arg2)
 
+or, for HIP targets, the same entry point taking a hipStream_t and returning a hipError_t.
+
 Different such specialized entry points can be combined using the `linker.py` script.
 
 NOTE: when resolving the scope of /path/to/kernel.py, the file will be executed from within its parent directory with the python interpreter
 used to run this `compile.py` script
 """
 
+
+def parse_target(target: str) -> GPUTarget:
+    backend, _, arch = target.partition(":")
+    if backend == "cuda" and arch.isdigit():
+        return GPUTarget("cuda", int(arch), 32)
+    if backend == "hip" and arch.startswith("gfx"):
+        # RDNA GPUs run waves of 32 work-items, CDNA GPUs waves of 64
+        return GPUTarget("hip", arch, 32 if arch.startswith(("gfx10", "gfx11", "gfx12")) else 64)
+    raise ValueError(f"invalid target {target}, expected cuda:<capability> or hip:<gfx arch>")
+
+
+def cuda_binaries(kernels):
+    """
+    Returns the (min_cc, max_cc, data, ccinfo) of the binaries embedded for the CUDA `kernels`, pairs of targets
+    and compiled kernels, from the most to the least specific. Cubins run on the devices of the same major version
+    and of a greater or equal minor version, except the sm_90a ones that only run on sm_90. The PTX of the newest
+    other target comes last.
+    """
+    binaries = []
+    ptx = None
+    for target, ccinfo in sorted(kernels, key=lambda k: -k[0].arch):
+        cc = target.arch
+        binaries.append((cc, cc if cc == 90 else cc // 10 * 10 + 9, ccinfo.kernel, ccinfo))
+        if ptx is None and cc != 90:
+            ptx = (cc, 2**30, ccinfo.asm["ptx"].encode() + b"\0", ccinfo)
+    return binaries + ([ptx] if ptx else [])
+
+
 if __name__ == "__main__":
 
     # command-line arguments
@@ -51,7 +89,19 @@ if __name__ == "__main__":
     parser.add_argument("--out-path", "-o", type=Path, default=None, help="Out filename")
     parser.add_argument("--signature", "-s", type=str, help="Signature of the kernel", required=True)
     parser.add_argument("--grid", "-g", type=str, help="Launch grid of the kernel", required=True)
+    parser.add_argument("--target", "-t", type=parse_target, action="append", default=None,
+                        help="Target to compile the kernel for, as cuda:<capability> or hip:<gfx arch>. "
+                        "Can be repeated, defaults to the active device")
     args = parser.parse_args()
+    targets = args.target or [triton.runtime.driver.active.get_current_target()]
+    backends = {target.backend for target in targets}
+    if len(backends) > 1:
+        parser.error(f"all the targets must share a backend, got {', '.join(sorted(backends))}")
+    backend = backends.pop()
+    if backend == "cuda":
+        from triton.backends.nvidia.driver import ty_to_cpp
+    else:
+        from triton.backends.amd.driver import ty_to_cpp
 
     out_name = args.out_name if args.out_name else args.kernel_name
     out_path = args.out_path if args.out_path else Path(out_name)
@@ -98,6 +148,7 @@ if __name__ == "__main__":
     const_sig = 'x'.join([str(v) for v in constants.values()])
     doc_string = [f"{kernel.arg_names[i]}={constants[i]}" for i in constants.keys()]
     doc_string += [f"num_warps={args.num_warps}", f"num_stages={args.num_stages}"]
+    doc_string += [f"targets={','.join(f'{t.backend}:{t.arch}' for t in targets)}"]
 
     # compile ast into cubin
     for h in hints.values():
@@ -109,7 +160,7 @@ if __name__ == "__main__":
         constants.update({i: 1})
     src = triton.compiler.ASTSource(fn=kernel, constants=constants, signature=signature, attrs=attrs)
     opts = {"num_warps": args.num_warps, "num_stages": args.num_stages}
-    ccinfo = triton.compile(src, options=opts)
+    kernels = [(target, triton.compile(src, target=target, options=opts)) for target in targets]
     arg_names = []
     arg_types = []
     for i in signature.keys():
@@ -120,18 +171,35 @@ if __name__ == "__main__":
     # dump C stub code
     suffix = kernel_suffix(signature.values(), attrs)
     func_name = '_'.join([out_name, sig_hash, suffix])
-    hex_ = str(binascii.hexlify(ccinfo.asm["cubin"]))[2:-1]
+
+    def bin_data(name, data):
+        hex_ = str(binascii.hexlify(data))[2:-1]
+        bytes_ = ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])])
+        return f"static unsigned char {name}[{len(data)}] = {{ {bytes_} }};"
+
+    # the binaries and the entries of the table the loader selects from
+    if backend == "cuda":
+        binaries = cuda_binaries(kernels)
+        entries = [f"{{ {lo}, {hi}, {func_name}_bin{i}, {ccinfo.metadata.shared} }}"
+                   for i, (lo, hi, _, ccinfo) in enumerate(binaries)]
+        binaries = [data for _, _, data, _ in binaries]
+    else:
+        entries = [
+            f"{{ \"{target.arch}\", {func_name}_bin{i}, {ccinfo.metadata.shared}, {target.warp_size} }}"
+            for i, (target, ccinfo) in enumerate(kernels)
+        ]
+        binaries = [ccinfo.kernel for _, ccinfo in kernels]
     params = {
         "kernel_name": func_name,
         "triton_kernel_name": args.kernel_name,
-        "bin_size": len(hex_),
-        "bin_data": ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])]),
+        "bin_data": "\n".join(bin_data(f"{func_name}_bin{i}", data) for i, data in enumerate(binaries)),
+        "bin_table": ",\n  ".join(entries),
+        "num_bins": len(binaries),
         "signature": ", ".join([f"{ty_to_cpp(ty)} {name}" for name, ty in zip(arg_names, arg_types)]),
         "full_signature": ", ".join([f"{ty_to_cpp(signature[i])} {kernel.arg_names[i]}" for i in signature.keys()]),
         "arg_pointers": ", ".join([f"&{arg}" for arg in arg_names]),
         "num_args": len(arg_names),
         "kernel_docstring": doc_string,
-        "shared": ccinfo.metadata.shared,
         "num_warps": args.num_warps,
         "algo_info": '_'.join([const_sig, meta_sig]),
         "gridX": grid[0],
@@ -139,7 +207,8 @@ if __name__ == "__main__":
         "gridZ": grid[2],
         "_placeholder": "",
     }
+    template = "compile" if backend == "cuda" else "compile_hip"
     for ext in ['h', 'c']:
-        template_path = Path(__file__).parent / f"compile.{ext}"
+        template_path = Path(__file__).parent / f"{template}.{ext}"
         with out_path.with_suffix(f".{sig_hash}_{suffix}.{ext}").open("w") as fp:
             fp.write(Path(template_path).read_text().format(**params))
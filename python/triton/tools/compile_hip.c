@@ -0,0 +1,142 @@
+/* clang-format off */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <hip/hip_runtime.h>
+
+
+// helpers to check for hip errors
+#define HIP_CHECK(ans) {{\
+    gpuAssert((ans), __FILE__, __LINE__);\
+  }}\
+
+#define HIP_RETURN_IF_ERROR(ans) {{\
+    hipError_t err_ = (ans);\
+    if (err_ != hipSuccess)\
+      return err_;\
+  }}\
+
+static inline void gpuAssert(hipError_t code, const char *file, int line) {{
+  if (code != hipSuccess) {{
+    printf("Triton Error [HIP]: %s\n", hipGetErrorString(code));
+    exit(code);
+  }}
+}}
+
+// binaries, one per gfx architecture
+typedef struct {{
+  const char *arch;
+  const void *data;
+  int shared;
+  int warp_size;
+}} binary_t;
+
+{bin_data}
+static const binary_t binaries[{num_bins}] = {{
+  {bin_table}
+}};
+
+// modules, loaded once on each device that launches the kernel; the loads
+// are serialized, the launches only read the published entries
+#define MAX_DEVICES 64
+typedef struct {{
+  hipModule_t mod;
+  hipFunction_t func;
+  int shared;
+  int warp_size;
+}} module_t;
+
+static module_t modules[MAX_DEVICES];
+static int modules_lock = 0;
+
+static void lock_modules(void) {{
+  while (__atomic_exchange_n(&modules_lock, 1, __ATOMIC_ACQUIRE))
+    ;
+}}
+
+static void unlock_modules(void) {{
+  __atomic_store_n(&modules_lock, 0, __ATOMIC_RELEASE);
+}}
+
+static hipError_t select_binary(int dev, int *index) {{
+  hipDeviceProp_t props;
+  HIP_RETURN_IF_ERROR(hipGetDeviceProperties(&props, dev));
+  // gcnArchName carries the target features, e.g. gfx942:sramecc+:xnack-
+  for (int i = 0; i < {num_bins}; i++) {{
+    size_t n = strlen(binaries[i].arch);
+    if (strncmp(props.gcnArchName, binaries[i].arch, n) == 0 &&
+        (props.gcnArchName[n] == '\0' || props.gcnArchName[n] == ':')) {{
+      *index = i;
+      return hipSuccess;
+    }}
+  }}
+  return hipErrorNoBinaryForGpu;
+}}
+
+static hipError_t load_module_locked(int dev) {{
+  module_t *m = &modules[dev];
+  if (m->func)
+    return hipSuccess;
+  int index;
+  hipModule_t mod;
+  hipFunction_t func;
+  HIP_RETURN_IF_ERROR(select_binary(dev, &index));
+  HIP_RETURN_IF_ERROR(hipModuleLoadData(&mod, binaries[index].data));
+  HIP_RETURN_IF_ERROR(hipModuleGetFunction(&func, mod, "{triton_kernel_name}"));
+  m->mod = mod;
+  m->shared = binaries[index].shared;
+  m->warp_size = binaries[index].warp_size;
+  __atomic_store_n(&m->func, func, __ATOMIC_RELEASE);
+  return hipSuccess;
+}}
+
+// returns the module of the current device, loading it on first use
+static hipError_t load_module(module_t **out) {{
+  int dev;
+  HIP_RETURN_IF_ERROR(hipGetDevice(&dev));
+  if (dev >= MAX_DEVICES)
+    return hipErrorInvalidDevice;
+  *out = &modules[dev];
+  if (__atomic_load_n(&modules[dev].func, __ATOMIC_ACQUIRE))
+    return hipSuccess;
+  lock_modules();
+  hipError_t err = load_module_locked(dev);
+  unlock_modules();
+  return err;
+}}
+
+void unload_{kernel_name}(void) {{
+  int dev;
+  HIP_CHECK(hipGetDevice(&dev));
+  if (dev >= MAX_DEVICES)
+    return;
+  lock_modules();
+  module_t *m = &modules[dev];
+  if (m->func) {{
+    __atomic_store_n(&m->func, NULL, __ATOMIC_RELEASE);
+    HIP_CHECK(hipModuleUnload(m->mod));
+  }}
+  unlock_modules();
+}}
+
+void load_{kernel_name}() {{
+  module_t *m;
+  HIP_CHECK(load_module(&m));
+}}
+
+/*
+{kernel_docstring}
+*/
+hipError_t {kernel_name}(hipStream_t stream, {signature}) {{
+    module_t *m;
+    HIP_RETURN_IF_ERROR(load_module(&m));
+    unsigned int gX = {gridX};
+    unsigned int gY = {gridY};
+    unsigned int gZ = {gridZ};
+    void *args[{num_args}] = {{ {arg_pointers} }};
+    if(gX * gY * gZ > 0)
+      return hipModuleLaunchKernel(m->func, gX, gY, gZ, {num_warps} * m->warp_size, 1, 1, m->shared, stream, args, NULL);
+    return hipSuccess;
+}}
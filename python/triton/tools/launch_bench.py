@@ -0,0 +1,173 @@
+"""
+Launch overhead benchmark.
+
+Times the host side of launching kernels with 1 to 64 arguments, which
+dominates the runtime of short kernels, along with the steps of the launch
+path of `JITFunction.run`:
+
+    python -m triton.tools.launch_bench -o launch.json
+
+- `launch`: `kernel[grid](...)`, through the native dispatcher
+- `launch_python`: the same launch through `JITFunction.run`
+- `binder`: binding the arguments and computing their specialization
+- `key`: building the key of the kernel cache
+- `cache_lookup`: looking the key up in the kernel cache
+- `kernel_init`: creating the `CompiledKernel` from the cached metadata
+- `init_handles`: creating the launcher and loading the binary
+- `launcher_args`: the generated launcher, without launching (empty grid)
+- `driver_launch`: `cuLaunchKernelEx` or `hipModuleLaunchKernel`, i.e. the
+  launcher less its argument extraction
+
+Times are medians in microseconds per call. Half of the arguments are
+tensors, the other half integers.
+"""
+import argparse
+import importlib.util
+import json
+import os
+import statistics
+import sys
+import tempfile
+import time
+from typing import Dict, List, Optional
+
+import torch
+
+import triton
+from triton.compiler import CompiledKernel
+from triton.runtime.cache import get_cache_manager
+from triton.runtime.driver import driver
+
+NUM_ARGS = [1, 2, 4, 8, 16, 32, 64]
+
+STEPS = [
+    "launch", "launch_python", "binder", "key", "cache_lookup", "kernel_init", "init_handles", "launcher_args",
+    "driver_launch"
+]
+
+
+def _make_kernel(num_args, dirname):
+    # `triton.jit` reads the source of kernels, so they are written to a module
+    params = [f"a{i}" for i in range(num_args)]
+    path = os.path.join(dirname, f"launch_bench_{num_args}.py")
+    with open(path, "w") as f:
+        f.write("import triton\n"
+                "import triton.language as tl\n\n\n"
+                "@triton.jit\n"
+                f"def kernel_{num_args}({', '.join(params)}):\n"
+                "    tl.store(a0 + tl.program_id(0), 1.0)\n")
+    spec = importlib.util.spec_from_file_location(f"launch_bench_{num_args}", path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return getattr(module, f"kernel_{num_args}")
+
+
+def _time_us(fn, reps, calls):
+    # median over `reps` batches of `calls` calls, the launches of each batch are done before the next one
+    times = []
+    for _ in range(reps):
+        start = time.perf_counter_ns()
+        for _ in range(calls):
+            fn()
+        times.append((time.perf_counter_ns() - start) / calls / 1e3)
+        torch.cuda.synchronize()
+    return statistics.median(times)
+
+
+def _time_init_handles_us(kernel, metadata_group, reps):
+    times = []
+    for _ in range(reps):
+        fresh = CompiledKernel(kernel.src, metadata_group, kernel.hash)
+        start = time.perf_counter_ns()
+        fresh._init_handles()
+        times.append((time.perf_counter_ns() - start) / 1e3)
+        fresh.unload()
+    return statistics.median(times)
+
+
+def bench_launch(num_args, dirname, reps=20, calls=100) -> Dict[str, float]:
+    """
+    Returns the time of each step of `STEPS` for a kernel with `num_args` arguments.
+    """
+    fn = _make_kernel(num_args, dirname)
+    x = torch.zeros(1024, dtype=torch.float32, device="cuda")
+    args = [x if i % 2 == 0 else 3 for i in range(num_args)]
+    grid = (1, )
+    # compile, and register the kernel with the native dispatcher
+    fn[grid](*args)
+    fn[grid](*args)
+    device = driver.active.get_current_device()
+    stream = driver.active.get_current_stream(device)
+    bound_args, sig_and_spec, constexpr_vals, non_constexpr_vals, excess_kwargs = fn.binder(*args, debug=fn.debug)
+    key = ''.join(sig_and_spec) + str((constexpr_vals, excess_kwargs))
+    kernel = fn.cache[device][key]
+    metadata_group = get_cache_manager(kernel.hash).get_group(f"{kernel.src.name}.json")
+    run = kernel.run
+
+    results = {}
+    results["launch"] = _time_us(lambda: fn[grid](*args), reps, calls)
+    # pre-run hooks keep launches off the native dispatcher
+    fn.add_pre_run_hook(lambda *args, **kwargs: None)
+    try:
+        results["launch_python"] = _time_us(lambda: fn[grid](*args), reps, calls)
+    finally:
+        fn.pre_run_hooks.pop()
+    results["binder"] = _time_us(lambda: fn.binder(*args, debug=fn.debug), reps, calls)
+    results["key"] = _time_us(lambda: ''.join(sig_and_spec) + str((constexpr_vals, excess_kwargs)), reps, calls)
+    results["cache_lookup"] = _time_us(lambda: fn.cache[device].get(key, None), reps, calls)
+    if metadata_group is not None:
+        results["kernel_init"] = _time_us(lambda: CompiledKernel(kernel.src, metadata_group, kernel.hash), reps,
+                                          calls)
+        results["init_handles"] = _time_init_handles_us(kernel, metadata_group, reps)
+    # the launchers skip the driver for empty grids
+    results["launcher_args"] = _time_us(
+        lambda: run(0, 1, 1, stream, kernel.function, kernel.packed_metadata, None, None, None, *non_constexpr_vals),
+        reps, calls)
+    launcher = _time_us(
+        lambda: run(1, 1, 1, stream, kernel.function, kernel.packed_metadata, None, None, None, *non_constexpr_vals),
+        reps, calls)
+    results["driver_launch"] = max(launcher - results["launcher_args"], 0.)
+    return results
+
+
+def run_bench(num_args: Optional[List[int]] = None, reps=20, calls=100) -> dict:
+    """
+    Returns the launch overheads of the current device for kernels with each number of arguments in `num_args`.
+    """
+    target = driver.active.get_current_target()
+    results = {}
+    with tempfile.TemporaryDirectory() as dirname:
+        for n in num_args or NUM_ARGS:
+            results[str(n)] = bench_launch(n, dirname, reps, calls)
+    return {
+        "device": f"{target.backend}-{target.arch}",
+        "device_name": torch.cuda.get_device_name(),
+        "triton_version": triton.__version__,
+        "results": results,
+    }
+
+
+def _report(results):
+    print(f"{'args':>6} " + " ".join(f"{step:>14}" for step in STEPS))
+    for n, steps in results["results"].items():
+        print(f"{n:>6} " + " ".join(f"{steps[step]:>14.2f}" if step in steps else f"{'-':>14}" for step in STEPS))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", default=None, help="Path of the JSON results")
+    parser.add_argument("-n", "--num-args", type=int, nargs="+", default=None,
+                        help="Numbers of kernel arguments, 1 to 64 by powers of 2 by default")
+    parser.add_argument("--reps", type=int, default=20, help="Number of batches each step is timed over")
+    parser.add_argument("--calls", type=int, default=100, help="Number of calls per batch")
+    args = parser.parse_args(argv)
+    results = run_bench(args.num_args, args.reps, args.calls)
+    _report(results)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,3 +1,4 @@
+import json
 from collections import defaultdict
 from pathlib import Path
 from typing import Sequence, Union
@@ -13,6 +14,14 @@ class LinkerError(Exception):
     pass
 
 
+# the C types and error codes of the entry points of each backend
+BACKEND_TYPES = {
+    "cuda": {"result": "CUresult", "stream": "CUstream", "invalid": "CUDA_ERROR_INVALID_VALUE", "include": "cuda.h"},
+    "hip": {"result": "hipError_t", "stream": "hipStream_t", "invalid": "hipErrorInvalidValue",
+            "include": "hip/hip_runtime.h"},
+}
+
+
 @dataclass
 class KernelLinkerMeta:
     orig_kernel_name: str
@@ -24,6 +33,11 @@ class KernelLinkerMeta:
     suffix: str
     num_specs: int
     """ number of specialized arguments """
+    backend: str = "cuda"
+
+    @property
+    def types(self):
+        return BACKEND_TYPES[self.backend]
 
 
 class HeaderParser:
@@ -33,6 +47,8 @@ class HeaderParser:
 
         # [kernel_name, c signature]
         self.linker_directives = re.compile("//[\\s]*tt-linker:[\\s]*([\\w]+):(.+):(.+)")
+        # [backend]
+        self.backend_directive = re.compile("//[\\s]*tt-linker-backend:[\\s]*([\\w]+)")
         # [name, hash, suffix]
         self.kernel_name = re.compile("^([\\w]+)_([\\w]+)_([\\w]+)$")
         # [(type, name)]
@@ -43,8 +59,16 @@ class HeaderParser:
         self.kernels = defaultdict(list)
 
     def extract_linker_meta(self, header: str):
+        # headers without a backend directive predate HIP support
+        backend = "cuda"
         for ln in header.splitlines():
             if ln.startswith("//"):
+                m = self.backend_directive.match(ln)
+                if _exists(m):
+                    backend = m.group(1)
+                    if backend not in BACKEND_TYPES:
+                        raise LinkerError(f"{backend} is not a supported backend")
+                    continue
                 m = self.linker_directives.match(ln)
                 if _exists(m):
                     ker_name, c_sig, algo_info = m.group(1), m.group(2), m.group(3)
@@ -62,6 +86,7 @@ class HeaderParser:
                             triton_suffix=suffix,
                             suffix=suffix,
                             num_specs=num_specs,
+                            backend=backend,
                         ),
                     )
 
@@ -110,6 +135,8 @@ class HeaderParser:
         if name in self.kernels:
             last: KernelLinkerMeta = self.kernels[name][-1]
 
+            if last.backend != ker.backend:
+                raise LinkerError(f"Mismatched backends for kernel {name}: {last.backend} and {ker.backend}")
             for cur, new_ in zip(last.arg_ctypes, ker.arg_ctypes):
                 if cur != new_:
                     raise LinkerError(
@@ -132,8 +159,9 @@ def gen_signature(m):
 
 # generate declarations of kernels with meta-parameter and constant values
 def make_algo_decls(name: str, metas: Sequence[KernelLinkerMeta]) -> str:
+    types = metas[-1].types
     return f"""
-CUresult {name}(CUstream stream, {gen_signature_with_full_args(metas[-1])});
+{types["result"]} {name}({types["stream"]} stream, {gen_signature_with_full_args(metas[-1])});
 void load_{name}();
 void unload_{name}();
     """
@@ -141,9 +169,10 @@ void unload_{name}();
 
 # generate declarations of kernels with meta-parameter and constant values
 def make_global_decl(meta: KernelLinkerMeta) -> str:
+    result, stream = meta.types["result"], meta.types["stream"]
     return f"""
-CUresult {meta.orig_kernel_name}_default(CUstream stream, {gen_signature_with_full_args(meta)});
-CUresult {meta.orig_kernel_name}(CUstream stream, {gen_signature_with_full_args(meta)}, int algo_id);
+{result} {meta.orig_kernel_name}_default({stream} stream, {gen_signature_with_full_args(meta)});
+{result} {meta.orig_kernel_name}({stream} stream, {gen_signature_with_full_args(meta)}, int algo_id);
 void load_{meta.orig_kernel_name}();
 void unload_{meta.orig_kernel_name}();
     """
@@ -151,7 +180,8 @@ void unload_{meta.orig_kernel_name}();
 
 # generate dispatcher function for kernels with different meta-parameter and constant values
 def make_default_algo_kernel(meta: KernelLinkerMeta) -> str:
-    src = f"CUresult {meta.orig_kernel_name}_default(CUstream stream, {gen_signature_with_full_args(meta)}){{\n"
+    result, stream = meta.types["result"], meta.types["stream"]
+    src = f"{result} {meta.orig_kernel_name}_default({stream} stream, {gen_signature_with_full_args(meta)}){{\n"
     src += (f"  return {meta.orig_kernel_name}(stream, {', '.join(meta.arg_names)}, 0);\n")
     src += "}\n"
     return src
@@ -159,12 +189,15 @@ def make_default_algo_kernel(meta: KernelLinkerMeta) -> str:
 
 # generate dispatcher function for kernels with different integer value hints
 def make_kernel_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -> str:
+    types = metas[-1].types
+    result, stream = types["result"], types["stream"]
     src = f"// launcher for: {name}\n"
     for meta in sorted(metas, key=lambda m: -m.num_specs):
-        src += f"CUresult {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(CUstream stream, {gen_signature(meta)});\n"
+        kernel_name = f"{meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}"
+        src += f"{result} {kernel_name}({stream} stream, {gen_signature(meta)});\n"
     src += "\n"
 
-    src += (f"CUresult {name}(CUstream stream, {gen_signature_with_full_args(metas[-1])}){{")
+    src += (f"{result} {name}({stream} stream, {gen_signature_with_full_args(metas[-1])}){{")
     src += "\n"
     for meta in sorted(metas, key=lambda m: -m.num_specs):
         cond_fn = (  #
@@ -173,9 +206,10 @@ def make_kernel_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -
             else f"({val} == {hint})"  #
             if hint == 1  #
             else None)
+        # HIP device pointers are pointers rather than integers
         conds = " && ".join([  #
-            cond_fn(val, hint)  #
-            for val, hint in zip(meta.arg_names, meta.sizes)  #
+            cond_fn(f"(uintptr_t){val}" if ty == "hipDeviceptr_t" else val, hint)  #
+            for val, ty, hint in zip(meta.arg_names, meta.arg_ctypes, meta.sizes)  #
             if hint is not None
         ])
         src += (f"  if ({conds})\n" if any(meta.sizes) else "if (1)\n"
@@ -183,7 +217,7 @@ def make_kernel_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -
         arg_names = [arg for arg, hint in zip(meta.arg_names, meta.sizes) if hint != 1]
         src += f"    return {meta.orig_kernel_name}_{meta.sig_hash}_{meta.suffix}(stream, {', '.join(arg_names)});\n"
     src += "\n"
-    src += "  return CUDA_ERROR_INVALID_VALUE;\n"
+    src += f"  return {types['invalid']};\n"
     src += "}\n"
 
     for mode in ["load", "unload"]:
@@ -200,7 +234,8 @@ def make_kernel_hints_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -
 
 # generate dispatcher function for kernels with different meta-parameter and constant values
 def make_kernel_meta_const_dispatcher(meta: KernelLinkerMeta) -> str:
-    src = f"CUresult {meta.orig_kernel_name}(CUstream stream, {gen_signature_with_full_args(meta)}, int algo_id){{\n"
+    result, stream = meta.types["result"], meta.types["stream"]
+    src = f"{result} {meta.orig_kernel_name}({stream} stream, {gen_signature_with_full_args(meta)}, int algo_id){{\n"
     src += f"  assert (algo_id < (int)sizeof({meta.orig_kernel_name}_kernels));\n"
     src += f"  return {meta.orig_kernel_name}_kernels[algo_id](stream, {', '.join(meta.arg_names)});\n"
     src += "}\n"
@@ -210,7 +245,8 @@ def make_kernel_meta_const_dispatcher(meta: KernelLinkerMeta) -> str:
 # generate definition of function pointers of kernel dispatchers based on meta-parameter and constant values
 def make_func_pointers(names: str, meta: KernelLinkerMeta) -> str:
     # the table of hint dispatchers
-    src = f"typedef CUresult (*kernel_func_t)(CUstream stream, {gen_signature_with_full_args(meta)});\n"
+    result, stream = meta.types["result"], meta.types["stream"]
+    src = f"typedef {result} (*kernel_func_t)({stream} stream, {gen_signature_with_full_args(meta)});\n"
     src += f"kernel_func_t {meta.orig_kernel_name}_kernels[] = {{\n"
     for name in names:
         src += f"  {name},\n"
@@ -241,15 +277,64 @@ def make_get_num_algos_def(meta: KernelLinkerMeta) -> str:
     return src
 
 
+def make_tuned_decl(meta: KernelLinkerMeta) -> str:
+    result, stream = meta.types["result"], meta.types["stream"]
+    return f"{result} {meta.orig_kernel_name}_tuned({stream} stream, {gen_signature_with_full_args(meta)});\n"
+
+
+# generate dispatcher function for kernels with the configs of a tuning table, see tools/tuning_table.py
+def make_tuned_dispatcher(table: dict, names: Sequence[str], meta: KernelLinkerMeta) -> str:
+    keys, buckets, algos = table["keys"], table["buckets"], table["algos"]
+    for key in keys:
+        if key not in meta.arg_names:
+            raise LinkerError(f"tuning table key {key} is not an argument of {meta.orig_kernel_name}")
+    num_cells = 1
+    for thresholds in buckets:
+        num_cells *= len(thresholds) + 1
+    if len(keys) != len(buckets) or len(algos) != num_cells:
+        raise LinkerError(f"tuning table has {len(algos)} configs for {num_cells} buckets")
+    algo_ids = {name[len(meta.orig_kernel_name) + 1:]: i for i, name in enumerate(names)}
+    missing = sorted(set(algos) - set(algo_ids))
+    if missing:
+        raise LinkerError(f"tuning table configs {', '.join(missing)} were not compiled")
+
+    result, stream = meta.types["result"], meta.types["stream"]
+    src = f"// dispatcher over the shape buckets of {', '.join(keys)}\n"
+    src += f"static const int {meta.orig_kernel_name}_tuned_algos[{num_cells}] = {{ "
+    src += ", ".join(str(algo_ids[algo]) for algo in algos)
+    src += " };\n\n"
+    src += f"{result} {meta.orig_kernel_name}_tuned({stream} stream, {gen_signature_with_full_args(meta)}){{\n"
+    src += "  int bucket = 0;\n"
+    for key, thresholds in zip(keys, buckets):
+        if thresholds:
+            # the bucket of a value is the number of thresholds below it
+            compares = " + ".join(f"({key} > {t})" for t in thresholds)
+            src += f"  bucket = bucket * {len(thresholds) + 1} + {compares};\n"
+    src += f"  int algo_id = {meta.orig_kernel_name}_tuned_algos[bucket];\n"
+    src += f"  return {meta.orig_kernel_name}_kernels[algo_id](stream, {', '.join(meta.arg_names)});\n"
+    src += "}\n"
+    return src
+
+
 desc = """
 Triton ahead-of-time linker:
 
 This program takes in header files generated by compile.py, and generates a
 single entry-point responsible for dispatching the user's input to the right
-kernel given the specializations that were compiled.
+kernel given the specializations that were compiled. The headers of one link
+must share a backend; the binary of each target embedded by compile.py is
+selected by the generated sources when the kernels are loaded.
+
+With `--tuning-table`, the linker also generates a `<kernel>_tuned` entry point
+that picks the config of the bucket of its shape arguments in a table written
+by `tuning_table.export_tuning_table` from the results of an autotuner.
 
 Example usage:
 python link.py /path/to/headers/*.h -o kernel_name
+python link.py /path/to/headers/*.h -o kernel_name --tuning-table matmul.json
+
+The generated header can be included from C++, see tools/runtime for the
+library that preloads the kernels and launches them through graphs.
 """
 
 if __name__ == "__main__":
@@ -268,7 +353,14 @@ if __name__ == "__main__":
         default="",
         help="String to prefix kernel dispatcher names",
     )
+    parser.add_argument(
+        "--tuning-table",
+        type=Path,
+        default=None,
+        help="Path to a tuning table of the configs to dispatch to for buckets of shapes",
+    )
     args = parser.parse_args()
+    tuning_table = json.loads(args.tuning_table.read_text()) if args.tuning_table else None
 
     # metadata
     parser = HeaderParser()
@@ -283,15 +375,30 @@ if __name__ == "__main__":
     algo_decls = [make_algo_decls(name, meta) for name, meta in parser.kernels.items()]
     meta_lists = [meta for name, meta in parser.kernels.items()]
     meta = meta_lists[0][0]
+    backends = {m.backend for metas in meta_lists for m in metas}
+    if len(backends) > 1:
+        raise LinkerError(f"the headers of one link must share a backend, got {', '.join(sorted(backends))}")
+    include = meta.types["include"]
     get_num_algos_decl = make_get_num_algos_decl(meta)
     global_decl = make_global_decl(meta)
     with args.out.with_suffix(".h").open("w") as fp:
-        out = "#include <cuda.h>\n"
+        out = f"#include <{include}>\n"
+        out += "\n"
+        out += "#ifdef __cplusplus\n"
+        out += "extern \"C\" {\n"
+        out += "#endif\n"
         out += "\n".join(algo_decls)
         out += "\n"
         out += get_num_algos_decl
         out += "\n"
         out += global_decl
+        if tuning_table:
+            out += "\n"
+            out += make_tuned_decl(meta)
+        out += "\n"
+        out += "#ifdef __cplusplus\n"
+        out += "}\n"
+        out += "#endif\n"
         fp.write(out)
 
     # generate source
@@ -304,7 +411,7 @@ if __name__ == "__main__":
     default_algo_kernel = make_default_algo_kernel(meta)
     with args.out.with_suffix(".c").open("w") as fp:
         out = ""
-        out += "#include <cuda.h>\n"
+        out += f"#include <{include}>\n"
         out += "#include <stdint.h>\n"
         out += "#include <assert.h>\n"
         out += "\n"
@@ -319,4 +426,7 @@ if __name__ == "__main__":
         out += load_unload_def
         out += "\n"
         out += default_algo_kernel
+        if tuning_table:
+            out += "\n"
+            out += make_tuned_dispatcher(tuning_table, names, meta)
         fp.write(out)
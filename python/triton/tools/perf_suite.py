@@ -0,0 +1,338 @@
+"""
+Kernel benchmark regression suite.
+
+Runs a fixed set of kernels (GEMMs in fp16, fp8 and int8, attention, layer
+norm, softmax, reductions, scans and histograms), writes their timings as JSON
+and compares them to the baseline stored for the device:
+
+    python -m triton.tools.perf_suite run -o results.json --baseline-dir baselines
+    python -m triton.tools.perf_suite compare baselines/cuda-90.json results.json
+
+`run --update-baseline` stores the results as the baseline of the device, which
+is named after the backend and architecture of the target, e.g. `cuda-90` or
+`hip-gfx942`. A benchmark regresses when its median time is more than the
+threshold, 3% by default, above the baseline; `compare` and `run` exit with a
+non-zero status if any does.
+"""
+import argparse
+import json
+import os
+import re
+import sys
+from typing import Callable, Dict, List, NamedTuple, Optional
+
+import torch
+
+import triton
+import triton.language as tl
+import triton.ops
+
+DEFAULT_THRESHOLD = 0.03
+
+
+class Case(NamedTuple):
+    # `setup` allocates the inputs and returns the function to time, along
+    # with the flops and bytes of a call that the throughputs are derived from
+    name: str
+    setup: Callable
+    supported: Callable = lambda: True
+
+
+def is_hip():
+    return triton.runtime.driver.active.get_current_target().backend == "hip"
+
+
+def get_device_key():
+    target = triton.runtime.driver.active.get_current_target()
+    return f"{target.backend}-{target.arch}"
+
+
+#######################
+# Kernels
+#######################
+
+
+@triton.jit
+def _softmax_kernel(X, Y, stride, N, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    offs = tl.arange(0, BLOCK)
+    mask = offs < N
+    x = tl.load(X + row * stride + offs, mask=mask, other=-float("inf")).to(tl.float32)
+    x = x - tl.max(x, axis=0)
+    num = tl.exp(x)
+    tl.store(Y + row * stride + offs, num / tl.sum(num, axis=0), mask=mask)
+
+
+@triton.jit
+def _layer_norm_kernel(X, Y, W, B, stride, N, eps, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    offs = tl.arange(0, BLOCK)
+    mask = offs < N
+    x = tl.load(X + row * stride + offs, mask=mask, other=0.).to(tl.float32)
+    mean = tl.sum(x, axis=0) / N
+    diff = tl.where(mask, x - mean, 0.)
+    rstd = 1 / tl.sqrt(tl.sum(diff * diff, axis=0) / N + eps)
+    w = tl.load(W + offs, mask=mask)
+    b = tl.load(B + offs, mask=mask)
+    tl.store(Y + row * stride + offs, diff * rstd * w + b, mask=mask)
+
+
+@triton.jit
+def _row_sum_kernel(X, Y, stride, N, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    acc = tl.zeros((BLOCK, ), dtype=tl.float32)
+    for start in range(0, N, BLOCK):
+        offs = start + tl.arange(0, BLOCK)
+        acc += tl.load(X + row * stride + offs, mask=offs < N, other=0.).to(tl.float32)
+    tl.store(Y + row, tl.sum(acc, axis=0))
+
+
+@triton.jit
+def _histogram_kernel(X, Y, N, NUM_BINS: tl.constexpr, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    # out of range elements fall in the last bin, which is kept out of the output
+    x = tl.load(X + offs, mask=offs < N, other=NUM_BINS - 1)
+    hist = tl.histogram(x, NUM_BINS)
+    bins = tl.arange(0, NUM_BINS)
+    tl.atomic_add(Y + bins, hist, mask=bins < NUM_BINS - 1)
+
+
+#######################
+# Cases
+#######################
+
+
+def _matmul_case(M, N, K, dtype):
+
+    def setup():
+        if dtype == "int8":
+            a = torch.randint(-128, 127, (M, K), dtype=torch.int8, device="cuda")
+            b = torch.randint(-128, 127, (N, K), dtype=torch.int8, device="cuda").t()
+            fn = lambda: triton.ops.matmul(a, b)
+        elif dtype == "fp8":
+            a = triton.reinterpret(torch.randint(-128, 127, (M, K), dtype=torch.int8, device="cuda"), tl.float8e4nv)
+            b = triton.reinterpret(torch.randint(-128, 127, (K, N), dtype=torch.int8, device="cuda"), tl.float8e4nv)
+            fn = lambda: triton.ops.matmul(a, b, None, None, True, torch.float16)
+        else:
+            a = torch.randn((M, K), dtype=torch.float16, device="cuda")
+            b = torch.randn((K, N), dtype=torch.float16, device="cuda")
+            fn = lambda: triton.ops.matmul(a, b)
+        in_size = 2 if dtype == "fp16" else 1
+        out_size = 1 if dtype == "int8" else 2
+        return fn, 2. * M * N * K, (M * K + K * N) * in_size + M * N * out_size
+
+    def supported():
+        if dtype != "fp8":
+            return True
+        return not is_hip() and torch.cuda.get_device_capability() >= (8, 9)
+
+    return Case(f"matmul-{dtype}-{M}x{N}x{K}", setup, supported)
+
+
+def _attention_case(Z, H, N_CTX, D_HEAD, causal):
+
+    def setup():
+        q, k, v = (torch.randn((Z, H, N_CTX, D_HEAD), dtype=torch.float16, device="cuda") for _ in range(3))
+        fn = lambda: triton.ops.attention(q, k, v, causal, 1.3)
+        flops = 4. * Z * H * N_CTX * N_CTX * D_HEAD * (0.5 if causal else 1)
+        return fn, flops, 4 * Z * H * N_CTX * D_HEAD * 2
+
+    # the attention of triton.ops needs the tensor cores of sm80 and later
+    return Case(f"attention-{'causal' if causal else 'full'}-{Z}x{H}x{N_CTX}x{D_HEAD}", setup,
+                lambda: torch.cuda.get_device_capability()[0] >= 8)
+
+
+def _softmax_case(M, N):
+
+    def setup():
+        x = torch.randn((M, N), dtype=torch.float16, device="cuda")
+        y = torch.empty_like(x)
+        fn = lambda: _softmax_kernel[(M, )](x, y, x.stride(0), N, BLOCK=triton.next_power_of_2(N))
+        return fn, 0., 2 * M * N * 2
+
+    return Case(f"softmax-{M}x{N}", setup)
+
+
+def _layer_norm_case(M, N):
+
+    def setup():
+        x = torch.randn((M, N), dtype=torch.float16, device="cuda")
+        w = torch.rand((N, ), dtype=torch.float16, device="cuda")
+        b = torch.rand((N, ), dtype=torch.float16, device="cuda")
+        y = torch.empty_like(x)
+        fn = lambda: _layer_norm_kernel[(M, )](x, y, w, b, x.stride(0), N, 1e-5, BLOCK=triton.next_power_of_2(N))
+        return fn, 0., 2 * M * N * 2
+
+    return Case(f"layer_norm-{M}x{N}", setup)
+
+
+def _reduction_case(M, N):
+
+    def setup():
+        x = torch.randn((M, N), dtype=torch.float32, device="cuda")
+        y = torch.empty((M, ), dtype=torch.float32, device="cuda")
+        fn = lambda: _row_sum_kernel[(M, )](x, y, x.stride(0), N, BLOCK=1024)
+        return fn, float(M * N), M * N * 4
+
+    return Case(f"row_sum-{M}x{N}", setup)
+
+
+def _scan_case(N):
+
+    def setup():
+        x = torch.randn((N, ), dtype=torch.float32, device="cuda")
+        fn = lambda: triton.ops.cumsum(x)
+        return fn, float(N), 2 * N * 4
+
+    return Case(f"cumsum-{N}", setup)
+
+
+def _histogram_case(N, num_bins):
+
+    def setup():
+        x = torch.randint(0, num_bins - 1, (N, ), dtype=torch.int32, device="cuda")
+        y = torch.zeros((num_bins - 1, ), dtype=torch.int32, device="cuda")
+        block = 1024
+        fn = lambda: _histogram_kernel[(triton.cdiv(N, block), )](x, y, N, NUM_BINS=num_bins, BLOCK=block)
+        return fn, 0., N * 4
+
+    return Case(f"histogram-{N}x{num_bins}", setup)
+
+
+CASES: List[Case] = [
+    *[
+        _matmul_case(M, N, K, dtype)
+        for M, N, K in [(1024, 1024, 1024), (4096, 4096, 4096), (8192, 8192, 8192), (16, 4096, 4096),
+                        (64, 8192, 8192), (8192, 64, 8192), (8192, 8192, 8176)]
+        for dtype in ["fp16", "fp8", "int8"]
+    ],
+    *[_attention_case(4, 48, 4096, 64, causal) for causal in [False, True]],
+    *[_softmax_case(4096, N) for N in [1024, 4096, 10000]],
+    *[_layer_norm_case(4096, N) for N in [1024, 4096, 8192]],
+    *[_reduction_case(M, N) for M, N in [(1024, 65536), (65536, 1024)]],
+    *[_scan_case(N) for N in [1 << 20, 1 << 26]],
+    *[_histogram_case(1 << 24, num_bins) for num_bins in [64, 1024]],
+]
+
+#######################
+# Running and comparing
+#######################
+
+
+def _bench(fn):
+    try:
+        import triton.profiler as proton
+    except ImportError:
+        # without proton, event timing still works for the kernels that run long enough
+        ms = triton.testing.do_bench(fn, quantiles=[0.5])
+        return {"ms": ms}
+    result = proton.bench.do_bench(fn)
+    return {"ms": result.median, "ci": list(result.ci)}
+
+
+def run_suite(pattern: Optional[str] = None) -> dict:
+    """
+    Runs the cases whose names match the regular expression `pattern`, or all of them, and returns the results of
+    the current device.
+    """
+    results = {}
+    for case in CASES:
+        if pattern is not None and not re.search(pattern, case.name):
+            continue
+        if not case.supported():
+            continue
+        torch.manual_seed(0)
+        fn, flops, nbytes = case.setup()
+        result = _bench(fn)
+        ms = result["ms"]
+        if flops:
+            result["tflops"] = flops / ms * 1e-9
+        result["gbps"] = nbytes / ms * 1e-6
+        results[case.name] = result
+    return {
+        "device": get_device_key(),
+        "device_name": torch.cuda.get_device_name(),
+        "triton_version": triton.__version__,
+        "results": results,
+    }
+
+
+def compare(baseline: dict, current: dict, threshold: float = DEFAULT_THRESHOLD) -> Dict[str, tuple]:
+    """
+    Returns the benchmarks of `current` whose median time is more than `threshold` above the one of `baseline`,
+    mapped to their baseline and current times in ms.
+    """
+    if baseline["device"] != current["device"]:
+        raise ValueError(f"results of {current['device']} can't be compared to a baseline of {baseline['device']}")
+    regressions = {}
+    for name, result in current["results"].items():
+        base = baseline["results"].get(name)
+        if base is not None and result["ms"] > base["ms"] * (1 + threshold):
+            regressions[name] = (base["ms"], result["ms"])
+    return regressions
+
+
+def _report(baseline, current, threshold):
+    regressions = compare(baseline, current, threshold)
+    for name, result in current["results"].items():
+        base = baseline["results"].get(name)
+        status = "REGRESSED" if name in regressions else "new" if base is None else "ok"
+        delta = "" if base is None else f"{result['ms'] / base['ms'] - 1:+.1%}"
+        print(f"{name:40} {result['ms']:10.4f} ms {delta:>8} {status}")
+    missing = set(baseline["results"]) - set(current["results"])
+    for name in sorted(missing):
+        print(f"{name:40} missing from the results")
+    print(f"{len(regressions)} regressions above {threshold:.0%}")
+    return 1 if regressions else 0
+
+
+def _load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def _dump(results, path):
+    with open(path, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers(dest="command", required=True)
+    run = subparsers.add_parser("run", help="Run the suite on the current device")
+    run.add_argument("-o", "--output", default=None, help="Path of the results, printed if omitted")
+    run.add_argument("-k", "--filter", default=None, help="Regular expression selecting the cases by name")
+    run.add_argument("--baseline-dir", default=None, help="Directory of the baselines of each device")
+    run.add_argument("--update-baseline", action="store_true",
+                     help="Store the results as the baseline of the device instead of comparing them")
+    run.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD, help="Relative slowdown that regresses")
+    cmp = subparsers.add_parser("compare", help="Compare results to a baseline")
+    cmp.add_argument("baseline", help="Path of the baseline")
+    cmp.add_argument("results", help="Path of the results")
+    cmp.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD, help="Relative slowdown that regresses")
+    args = parser.parse_args(argv)
+
+    if args.command == "compare":
+        return _report(_load(args.baseline), _load(args.results), args.threshold)
+
+    results = run_suite(args.filter)
+    if args.output:
+        _dump(results, args.output)
+    else:
+        json.dump(results, sys.stdout, indent=2, sort_keys=True)
+        print()
+    if args.baseline_dir is None:
+        return 0
+    baseline_path = os.path.join(args.baseline_dir, f"{results['device']}.json")
+    if args.update_baseline:
+        os.makedirs(args.baseline_dir, exist_ok=True)
+        _dump(results, baseline_path)
+        return 0
+    if not os.path.exists(baseline_path):
+        print(f"no baseline for {results['device']} in {args.baseline_dir}")
+        return 0
+    return _report(_load(baseline_path), results, args.threshold)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
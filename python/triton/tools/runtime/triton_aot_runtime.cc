@@ -0,0 +1,246 @@
+#include "triton_aot_runtime.h"
+
+#define RETURN_IF_ERROR(expr)                                                  \
+  do {                                                                         \
+    Result err_ = (expr);                                                      \
+    if (err_ != kSuccess)                                                      \
+      return err_;                                                             \
+  } while (0)
+
+namespace triton {
+namespace aot {
+
+namespace {
+
+#ifdef TRITON_AOT_HIP
+
+using GraphHandle = hipGraph_t;
+
+Result beginCapture(Stream stream) {
+  return hipStreamBeginCapture(stream, hipStreamCaptureModeThreadLocal);
+}
+
+Result endCapture(Stream stream, GraphHandle *graph) {
+  return hipStreamEndCapture(stream, graph);
+}
+
+Result instantiate(GraphExec *exec, GraphHandle graph) {
+  return hipGraphInstantiate(exec, graph, nullptr, nullptr, 0);
+}
+
+bool update(GraphExec exec, GraphHandle graph) {
+  hipGraphNode_t errorNode;
+  hipGraphExecUpdateResult result;
+  return hipGraphExecUpdate(exec, graph, &errorNode, &result) == hipSuccess;
+}
+
+Result launchGraph(GraphExec exec, Stream stream) {
+  return hipGraphLaunch(exec, stream);
+}
+
+void destroyGraph(GraphHandle graph) { (void)hipGraphDestroy(graph); }
+
+void destroyExec(GraphExec exec) { (void)hipGraphExecDestroy(exec); }
+
+#else
+
+using GraphHandle = CUgraph;
+
+Result beginCapture(Stream stream) {
+  return cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL);
+}
+
+Result endCapture(Stream stream, GraphHandle *graph) {
+  return cuStreamEndCapture(stream, graph);
+}
+
+Result instantiate(GraphExec *exec, GraphHandle graph) {
+  return cuGraphInstantiateWithFlags(exec, graph, 0);
+}
+
+bool update(GraphExec exec, GraphHandle graph) {
+#if CUDA_VERSION >= 12000
+  CUgraphExecUpdateResultInfo info;
+  return cuGraphExecUpdate(exec, graph, &info) == CUDA_SUCCESS;
+#else
+  CUgraphNode errorNode;
+  CUgraphExecUpdateResult result;
+  return cuGraphExecUpdate(exec, graph, &errorNode, &result) == CUDA_SUCCESS;
+#endif
+}
+
+Result launchGraph(GraphExec exec, Stream stream) {
+  return cuGraphLaunch(exec, stream);
+}
+
+void destroyGraph(GraphHandle graph) { (void)cuGraphDestroy(graph); }
+
+void destroyExec(GraphExec exec) { (void)cuGraphExecDestroy(exec); }
+
+#endif
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Devices
+//===----------------------------------------------------------------------===//
+
+#ifdef TRITON_AOT_HIP
+
+Result getDeviceCount(int *count) { return hipGetDeviceCount(count); }
+
+Result getCurrentDevice(int *device) { return hipGetDevice(device); }
+
+Result preload(const std::vector<LoadFn> &loaders,
+               const std::vector<int> &devices) {
+  std::vector<int> targets = devices;
+  if (targets.empty()) {
+    int count;
+    RETURN_IF_ERROR(getDeviceCount(&count));
+    for (int device = 0; device < count; ++device)
+      targets.push_back(device);
+  }
+  int current;
+  RETURN_IF_ERROR(hipGetDevice(&current));
+  for (int device : targets) {
+    Result err = hipSetDevice(device);
+    if (err != kSuccess) {
+      (void)hipSetDevice(current);
+      return err;
+    }
+    for (LoadFn load : loaders)
+      load();
+  }
+  return hipSetDevice(current);
+}
+
+#else
+
+Result getDeviceCount(int *count) {
+  RETURN_IF_ERROR(cuInit(0));
+  return cuDeviceGetCount(count);
+}
+
+Result getCurrentDevice(int *device) {
+  CUdevice dev;
+  RETURN_IF_ERROR(cuCtxGetDevice(&dev));
+  *device = static_cast<int>(dev);
+  return CUDA_SUCCESS;
+}
+
+Result preload(const std::vector<LoadFn> &loaders,
+               const std::vector<int> &devices) {
+  std::vector<int> targets = devices;
+  if (targets.empty()) {
+    int count;
+    RETURN_IF_ERROR(getDeviceCount(&count));
+    for (int device = 0; device < count; ++device)
+      targets.push_back(device);
+  }
+  CUcontext current;
+  RETURN_IF_ERROR(cuCtxGetCurrent(&current));
+  for (int device : targets) {
+    // the primary contexts stay retained for the modules loaded in them
+    CUdevice dev;
+    CUcontext ctx;
+    Result err = cuDeviceGet(&dev, device);
+    if (err == CUDA_SUCCESS)
+      err = cuDevicePrimaryCtxRetain(&ctx, dev);
+    if (err == CUDA_SUCCESS)
+      err = cuCtxSetCurrent(ctx);
+    if (err != CUDA_SUCCESS) {
+      (void)cuCtxSetCurrent(current);
+      return err;
+    }
+    for (LoadFn load : loaders)
+      load();
+  }
+  return cuCtxSetCurrent(current);
+}
+
+#endif
+
+//===----------------------------------------------------------------------===//
+// Graph
+//===----------------------------------------------------------------------===//
+
+Graph::Graph(Graph &&other) noexcept : exec(other.exec) {
+  other.exec = nullptr;
+}
+
+Graph &Graph::operator=(Graph &&other) noexcept {
+  if (this != &other) {
+    reset();
+    exec = other.exec;
+    other.exec = nullptr;
+  }
+  return *this;
+}
+
+Graph::~Graph() { reset(); }
+
+void Graph::reset() {
+  if (exec)
+    destroyExec(exec);
+  exec = nullptr;
+}
+
+Result Graph::capture(Stream stream,
+                      const std::function<Result(Stream)> &launches) {
+  RETURN_IF_ERROR(beginCapture(stream));
+  // the capture must be ended even if a launch failed
+  Result err = launches(stream);
+  GraphHandle graph = nullptr;
+  Result endErr = endCapture(stream, &graph);
+  if (err == kSuccess)
+    err = endErr;
+  if (err != kSuccess) {
+    if (graph)
+      destroyGraph(graph);
+    return err;
+  }
+  if (!exec || !update(exec, graph)) {
+    reset();
+    err = instantiate(&exec, graph);
+    if (err != kSuccess)
+      exec = nullptr;
+  }
+  destroyGraph(graph);
+  return err;
+}
+
+Result Graph::launch(Stream stream) const { return launchGraph(exec, stream); }
+
+//===----------------------------------------------------------------------===//
+// LaunchBatch
+//===----------------------------------------------------------------------===//
+
+void LaunchBatch::add(LaunchFn launch) {
+  launches.push_back(std::move(launch));
+  captured = false;
+}
+
+void LaunchBatch::clear() {
+  launches.clear();
+  captured = false;
+}
+
+Result LaunchBatch::launch(Stream stream) {
+  if (launches.empty())
+    return kSuccess;
+  if (!captured) {
+    RETURN_IF_ERROR(graph.capture(
+        stream, [this](Stream stream) { return launchEager(stream); }));
+    captured = true;
+  }
+  return graph.launch(stream);
+}
+
+Result LaunchBatch::launchEager(Stream stream) const {
+  for (const LaunchFn &launch : launches)
+    RETURN_IF_ERROR(launch(stream));
+  return kSuccess;
+}
+
+} // namespace aot
+} // namespace triton
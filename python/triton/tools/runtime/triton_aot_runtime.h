@@ -0,0 +1,166 @@
+#ifndef TRITON_AOT_RUNTIME_H
+#define TRITON_AOT_RUNTIME_H
+
+// Runtime for the kernels generated by compile.py and link.py, for C++
+// applications that launch them without Python.
+//
+// The generated kernels load their modules on the first launch in each
+// context. `preload` does it up front on every device, so that no launch pays
+// for the load and kernels can be captured in CUDA/HIP graphs, which forbid
+// module loads while capturing. `Graph` captures the launches of a callback
+// on a stream and replays them with a single launch, and `LaunchBatch` builds
+// such a graph from a list of launches.
+//
+// Define TRITON_AOT_HIP to build against HIP instead of the CUDA driver API.
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifdef TRITON_AOT_HIP
+#include <hip/hip_runtime.h>
+#else
+#include <cuda.h>
+#endif
+
+namespace triton {
+namespace aot {
+
+#ifdef TRITON_AOT_HIP
+using Result = hipError_t;
+using Stream = hipStream_t;
+using GraphExec = hipGraphExec_t;
+constexpr Result kSuccess = hipSuccess;
+#else
+using Result = CUresult;
+using Stream = CUstream;
+using GraphExec = CUgraphExec;
+constexpr Result kSuccess = CUDA_SUCCESS;
+#endif
+
+// The `load_<kernel>` functions generated by the linker.
+using LoadFn = void (*)(void);
+
+// Runs `loaders` with each of `devices` current, all devices when empty, and
+// makes the device or context that was current before current again. On CUDA
+// the modules are loaded in the primary contexts of the devices, the kernels
+// launched in other contexts still load their modules on the first launch.
+Result preload(const std::vector<LoadFn> &loaders,
+               const std::vector<int> &devices = {});
+
+// Returns the number of devices, used as the cache size of `DeviceCache`.
+Result getDeviceCount(int *count);
+
+// Returns the current device.
+Result getCurrentDevice(int *device);
+
+// Per-device cache of handles, e.g. of the graphs of a model, created on the
+// first lookup on each device. Lookups don't lock, so the cache must be
+// filled by `init` before it is shared between threads.
+template <typename T> class DeviceCache {
+public:
+  using CreateFn = std::function<Result(int device, T *value)>;
+
+  explicit DeviceCache(CreateFn create) : create(std::move(create)) {}
+
+  // Creates the values of all devices.
+  Result init() {
+    int count;
+    Result err = getDeviceCount(&count);
+    if (err != kSuccess)
+      return err;
+    for (int device = 0; device < count; ++device) {
+      T *value;
+      if ((err = get(device, &value)) != kSuccess)
+        return err;
+    }
+    return kSuccess;
+  }
+
+  Result get(int device, T **value) {
+    if (device >= static_cast<int>(entries.size()))
+      entries.resize(device + 1);
+    Entry &entry = entries[device];
+    if (!entry.valid) {
+      Result err = create(device, &entry.value);
+      if (err != kSuccess)
+        return err;
+      entry.valid = true;
+    }
+    *value = &entry.value;
+    return kSuccess;
+  }
+
+  // Returns the value of the current device.
+  Result get(T **value) {
+    int device;
+    Result err = getCurrentDevice(&device);
+    if (err != kSuccess)
+      return err;
+    return get(device, value);
+  }
+
+private:
+  struct Entry {
+    T value{};
+    bool valid = false;
+  };
+  CreateFn create;
+  std::vector<Entry> entries;
+};
+
+// Executable graph of the launches captured on a stream. The kernels must be
+// preloaded before the capture; the arguments of the launches, including the
+// pointers, are the ones they were captured with.
+class Graph {
+public:
+  Graph() = default;
+  Graph(const Graph &) = delete;
+  Graph &operator=(const Graph &) = delete;
+  Graph(Graph &&other) noexcept;
+  Graph &operator=(Graph &&other) noexcept;
+  ~Graph();
+
+  // Captures the launches of `launches` on `stream`. A graph that was already
+  // captured is updated in place when the launches only differ in their
+  // arguments, and instantiated again otherwise.
+  Result capture(Stream stream, const std::function<Result(Stream)> &launches);
+
+  Result launch(Stream stream) const;
+
+  bool empty() const { return exec == nullptr; }
+
+private:
+  void reset();
+
+  GraphExec exec = nullptr;
+};
+
+// Launches that run together, e.g. the kernels of a layer. The first launch
+// of a batch captures its launches into a graph, which the next launches
+// replay until the batch changes.
+class LaunchBatch {
+public:
+  using LaunchFn = std::function<Result(Stream)>;
+
+  void add(LaunchFn launch);
+  void clear();
+  size_t size() const { return launches.size(); }
+
+  // Launches the batch on `stream` through its graph.
+  Result launch(Stream stream);
+
+  // Launches the batch on `stream` one kernel after another.
+  Result launchEager(Stream stream) const;
+
+private:
+  std::vector<LaunchFn> launches;
+  Graph graph;
+  bool captured = false;
+};
+
+} // namespace aot
+} // namespace triton
+
+#endif // TRITON_AOT_RUNTIME_H
@@ -0,0 +1,93 @@
+"""
+Tuning tables of ahead-of-time kernels.
+
+A tuning table maps buckets of the shape arguments of a kernel to the config
+the kernel is launched with. It is written from the configs an `Autotuner` has
+picked at runtime and linked into the `<kernel>_tuned` entry point of link.py:
+
+    export_tuning_table(matmul_kernel, "matmul.json", constants={"GROUP_M": 8})
+    python link.py /path/to/headers/*.h -o matmul --tuning-table matmul.json
+
+The table is a JSON object with fields:
+    keys: the names of the arguments the shapes are bucketed by
+    buckets: for each key, the increasing thresholds between its buckets
+    algos: the config of each combination of buckets, in row-major order,
+           named like the kernels compiled by compile.py
+"""
+import json
+import math
+from typing import Dict, Optional, Sequence
+
+from triton.runtime.autotuner import Autotuner, Config
+
+
+def bucket_thresholds(values: Sequence[int]) -> list:
+    # a value falls in the bucket of the tuned value nearest to it in log scale
+    values = sorted(set(values))
+    return [int(math.sqrt(lo * hi)) if lo > 0 else lo for lo, hi in zip(values, values[1:])]
+
+
+def get_bucket(value: int, thresholds: Sequence[int]) -> int:
+    return sum(value > t for t in thresholds)
+
+
+def config_algo_info(config: Config, arg_names: Sequence[str], constants: Optional[Dict] = None) -> str:
+    # constexpr values in argument order, see `algo_info` in compile.py
+    values = {**(constants or {}), **config.kwargs}
+    const_sig = "x".join(str(int(v) if isinstance(v, bool) else v) for _, v in
+                         sorted(values.items(), key=lambda item: arg_names.index(item[0])))
+    return f"{const_sig}_warps{config.num_warps}xstages{config.num_stages}"
+
+
+def make_tuning_table(keys: Sequence[str], tuned: Dict[tuple, str]) -> dict:
+    """
+    Builds the table of the configs `tuned` picked for tuples of values of `keys`.
+    The buckets that no tuned shape falls in get the config of the nearest tuned bucket.
+    """
+    if not tuned:
+        raise ValueError("no tuned configs to build a tuning table from")
+    buckets = [bucket_thresholds([shape[i] for shape in tuned]) for i in range(len(keys))]
+    cells = {}
+    for shape, algo in tuned.items():
+        cell = tuple(get_bucket(v, t) for v, t in zip(shape, buckets))
+        if cells.setdefault(cell, algo) != algo:
+            raise ValueError(f"shapes of bucket {cell} were tuned to different configs {cells[cell]} and {algo}")
+    algos = []
+    for cell in _cells([len(t) + 1 for t in buckets]):
+        nearest = min(cells, key=lambda c: sum(abs(a - b) for a, b in zip(c, cell)))
+        algos.append(cells[nearest])
+    return {"keys": list(keys), "buckets": buckets, "algos": algos}
+
+
+def _cells(sizes):
+    if not sizes:
+        yield ()
+        return
+    for i in range(sizes[0]):
+        for rest in _cells(sizes[1:]):
+            yield (i, ) + rest
+
+
+def export_tuning_table(autotuner: Autotuner, path: str, constants: Optional[Dict] = None,
+                        dtypes: Optional[Sequence[str]] = None) -> dict:
+    """
+    Writes the configs `autotuner` has picked to the tuning table `path`.
+
+    :param constants: constexpr arguments of the kernel that are not set by the configs
+    :param dtypes: the dtypes of the tensor arguments of the compiled kernels, the shapes
+        tuned for other dtypes are left out
+    """
+    keys = [autotuner.arg_names[i] for i in autotuner.key_idx]
+    tuned = {}
+    for key, config in autotuner.cache.items():
+        shape, key_dtypes = key[:len(keys)], key[len(keys):]
+        if dtypes is not None and list(key_dtypes) != list(dtypes):
+            continue
+        algo = config_algo_info(config, autotuner.arg_names, constants)
+        if tuned.setdefault(shape, algo) != algo:
+            raise ValueError(f"shape {shape} was tuned to different configs for different dtypes, "
+                             "pass the dtypes of the compiled kernels")
+    table = make_tuning_table(keys, tuned)
+    with open(path, "w") as f:
+        json.dump(table, f, indent=2)
+    return table
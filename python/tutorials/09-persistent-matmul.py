@@ -10,7 +10,6 @@ Users can pass command-line arguments to specify matrix dimensions and iteration
 import argparse
 import time
 
-import numpy as np
 import torch
 import triton
 import triton.language as tl
@@ -334,21 +333,12 @@ def matmul_tma_persistent(a, b):
 
     c = torch.zeros((M, N), device=a.device, dtype=dtype)
 
-    TMA_SIZE = 128
-
-    desc_a = np.empty(TMA_SIZE, dtype=np.int8)
-    desc_b = np.empty(TMA_SIZE, dtype=np.int8)
-    desc_c = np.empty(TMA_SIZE, dtype=np.int8)
-    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(a.data_ptr(), M, K, configs[dtype]["BLOCK_SIZE_M"],
-                                                              configs[dtype]["BLOCK_SIZE_K"], a.element_size(), desc_a)
-    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(b.data_ptr(), N, K, configs[dtype]["BLOCK_SIZE_N"],
-                                                              configs[dtype]["BLOCK_SIZE_K"], b.element_size(), desc_b)
-    triton.runtime.driver.active.utils.fill_2d_tma_descriptor(c.data_ptr(), M, N, configs[dtype]["BLOCK_SIZE_M"],
-                                                              configs[dtype]["BLOCK_SIZE_N"], c.element_size(), desc_c)
-
-    desc_a = torch.tensor(desc_a, device="cuda")
-    desc_b = torch.tensor(desc_b, device="cuda")
-    desc_c = torch.tensor(desc_c, device="cuda")
+    # The descriptors are cached by the driver, later calls with the same tensors don't make them again.
+    get_tma_descriptor = triton.runtime.driver.active.utils.get_tma_descriptor
+    BLOCK_M, BLOCK_N, BLOCK_K = (configs[dtype][f"BLOCK_SIZE_{dim}"] for dim in "MNK")
+    desc_a = get_tma_descriptor(a.data_ptr(), [M, K], [K, 1], [BLOCK_M, BLOCK_K], a.element_size())
+    desc_b = get_tma_descriptor(b.data_ptr(), [N, K], [K, 1], [BLOCK_N, BLOCK_K], b.element_size())
+    desc_c = get_tma_descriptor(c.data_ptr(), [M, N], [N, 1], [BLOCK_M, BLOCK_N], c.element_size())
 
     NUM_SMS = torch.cuda.get_device_properties("cuda").multi_processor_count
 
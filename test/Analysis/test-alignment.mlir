@@ -235,11 +235,11 @@ tt.func @cmp_all_contiguous() {
   %2 = arith.cmpi eq, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %3 = arith.cmpi ne, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 0
   %4 = arith.cmpi slt, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %5 = arith.cmpi sle, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
   %6 = arith.cmpi sge, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %7 = arith.cmpi sgt, %0, %1 : tensor<128xi32>
@@ -249,11 +249,11 @@ tt.func @cmp_all_contiguous() {
   %9 = arith.cmpi ne, %1, %0 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %10 = arith.cmpi slt, %1, %0 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
   %11 = arith.cmpi sle, %1, %0 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %12 = arith.cmpi sge, %1, %0 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 0
   %13 = arith.cmpi sgt, %1, %0 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [8], constancy = [128], constant_value = 8
   %14 = arith.constant dense<8> : tensor<128xi32>
@@ -368,7 +368,7 @@ tt.func @select(%arg0 : i1, %arg1 : tensor<4xi1>) {
   %1 = arith.constant dense<0> : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %2 = arith.cmpi eq, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 0
   %3 = arith.cmpi slt, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [1], constant_value = 0
   %4 = arith.constant 0 : i1
@@ -380,7 +380,7 @@ tt.func @select(%arg0 : i1, %arg1 : tensor<4xi1>) {
   %8 = arith.select %7, %3, %2 : tensor<128xi1>, tensor<128xi1>
   // CHECK-NEXT: contiguity = [1, 1], divisibility = [1, 1], constancy = [1, 1], constant_value = <none>
   %9 = tt.expand_dims %2 {axis = 1 : i32} : tensor<128xi1> -> tensor<128x1xi1>
-  // CHECK-NEXT: contiguity = [1, 1], divisibility = [1, 1], constancy = [128, 1], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1, 1], divisibility = [1, 4611686018427387904], constancy = [128, 1], constant_value = 0
   %10 = tt.expand_dims %3 {axis = 1 : i32} : tensor<128xi1> -> tensor<128x1xi1>
   // CHECK-NEXT: contiguity = [1, 1], divisibility = [1, 1], constancy = [1, 1], constant_value = <none>
   %11 = arith.select %arg0, %9, %10 : tensor<128x1xi1>
@@ -857,3 +857,48 @@ tt.func public @chained_for(%8: tensor<128x64x!tt.ptr<bf16>> {tt.divisibility =
   }
   tt.return
 }
+
+// -----
+
+// CHECK-LABEL: @range_mask
+tt.func @range_mask(%arg0: i32 {tt.range = dense<[0, 1024]> : tensor<2xi32>}) {
+  %c0_i32 = arith.constant 0 : i32
+  %c16_i32 = arith.constant 16 : i32
+  %c64_i32 = arith.constant 64 : i32
+  // CHECK: tt.make_range {{.*}} => contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>, range = [0, 127]
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK: tt.splat {{.*}} => contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>, range = [0, 1024]
+  %1 = tt.splat %arg0 : i32 -> tensor<128xi32>
+  // CHECK: arith.addi {{.*}} => contiguity = [128], divisibility = [1], constancy = [1], constant_value = <none>, range = [0, 1151]
+  %2 = arith.addi %1, %0 : tensor<128xi32>
+  %cst = arith.constant dense<2048> : tensor<128xi32>
+  // CHECK: arith.cmpi slt, {{.*}} => contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
+  %3 = arith.cmpi slt, %2, %cst : tensor<128xi32>
+  // CHECK: arith.cmpi sge, {{.*}} => contiguity = [1], divisibility = [1], constancy = [128], constant_value = 0
+  %4 = arith.cmpi sge, %2, %cst : tensor<128xi32>
+  %cst_0 = arith.constant dense<176> : tensor<128xi32>
+  %cst_1 = arith.constant dense<175> : tensor<128xi32>
+  scf.for %iv = %c0_i32 to %c64_i32 step %c16_i32 : i32 {
+    // CHECK: tt.splat {{.*}} => contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>, range = [0, 48]
+    %5 = tt.splat %iv : i32 -> tensor<128xi32>
+    // CHECK: arith.addi {{.*}} => contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>, range = [0, 175]
+    %6 = arith.addi %5, %0 : tensor<128xi32>
+    // CHECK: arith.cmpi slt, {{.*}} => contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
+    %7 = arith.cmpi slt, %6, %cst_0 : tensor<128xi32>
+    // CHECK: arith.cmpi slt, {{.*}} => contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
+    %8 = arith.cmpi slt, %6, %cst_1 : tensor<128xi32>
+  }
+  tt.return
+}
+
+// -----
+
+// The divisibility of addresses loaded as integers carries over to pointers.
+// CHECK-LABEL: @int_to_ptr
+tt.func @int_to_ptr(%arg0: i64 {tt.divisibility = 16 : i32}) {
+  // CHECK: tt.int_to_ptr {{.*}} => contiguity = [1], divisibility = [16], constancy = [1]
+  %0 = tt.int_to_ptr %arg0 : i64 -> !tt.ptr<f16>
+  // CHECK: tt.ptr_to_int {{.*}} => contiguity = [1], divisibility = [16], constancy = [1]
+  %1 = tt.ptr_to_int %0 : !tt.ptr<f16> -> i64
+  tt.return
+}
@@ -0,0 +1,30 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-allocation 2>&1 | FileCheck %s
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory="strategy=best-fit report-fragmentation=true" 2>&1 | FileCheck %s --check-prefix=REMARK
+
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.allocation-strategy" = "best-fit"} {
+
+// The largest buffers are placed first, and the small buffers fill the gaps
+// left between them, so the allocation matches the peak liveness.
+// CHECK-LABEL: best_fit
+// REMARK: remark: shared memory: 5120 bytes allocated, 5120 bytes peak live
+// REMARK: triton_gpu.shared = 5120 : i32
+tt.func @best_fit(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 2048, size = 1024
+  %a = triton_gpu.local_alloc : () -> !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NEXT: offset = 4096, size = 1024
+  %b = triton_gpu.local_alloc : () -> !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NEXT: offset = 0, size = 2048
+  %c = triton_gpu.local_alloc : () -> !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  triton_gpu.local_dealloc %a : !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NEXT: offset = 2048, size = 2048
+  %d = triton_gpu.local_alloc : () -> !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  triton_gpu.local_dealloc %b : !tt.memdesc<32x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  triton_gpu.local_dealloc %c : !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  triton_gpu.local_dealloc %d : !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  tt.return
+  // CHECK-NEXT: size = 5120
+}
+
+}
@@ -3,12 +3,15 @@
 #AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 #sliceAd0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
 #BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#SL = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 #A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #A_SHARED_T = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
 #B_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #C = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
 #A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth = 2}>
 #B_DOT = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth = 2}>
+#RL1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
+#RL8 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
 
 module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
 
@@ -20,6 +23,14 @@ tt.func @empty(%A : !tt.ptr<f16>) {
   // CHECK: size = 0
 }
 
+// CHECK-LABEL: convert_layout_register_permutation
+tt.func @convert_layout_register_permutation(%arg0: tensor<128x4xf16, #RL1>) {
+  %0 = triton_gpu.convert_layout %arg0 : tensor<128x4xf16, #RL1> -> tensor<128x4xf16, #RL8>
+  %1 = triton_gpu.convert_layout %0 : tensor<128x4xf16, #RL8> -> tensor<128x4xf16, #RL1>
+  tt.return
+  // CHECK: size = 0
+}
+
 // CHECK-LABEL: matmul_loop
 tt.func @matmul_loop(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>) {
   %a_ptr_init = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
@@ -268,6 +279,26 @@ tt.func @alloc(%A : !tt.ptr<f16>) {
   // CHECK-NEXT: size = 512
 }
 
+// Sorts exchange elements through shared memory only when the partners are in
+// other warps, and then every thread stores all its elements.
+// CHECK-LABEL: scratch_sort
+tt.func @scratch_sort(%keys : tensor<256xf32, #SL>, %values : tensor<256xi16, #SL>, %rows : tensor<4x128xf32, #BL>) {
+  // CHECK: scratch offset = 0, size = 1536
+  %0:2 = tt.sort %keys, %values {descending = false} : tensor<256xf32, #SL>, tensor<256xi16, #SL>
+  %1 = tt.sort %rows {descending = true} : tensor<4x128xf32, #BL>
+  tt.return
+  // CHECK-NEXT: size = 1536
+}
+
+// Gathers along an axis with elements in registers stage the whole source.
+// CHECK-LABEL: scratch_gather
+tt.func @scratch_gather(%src : tensor<4x128xf32, #BL>, %indices : tensor<4x128xi32, #BL>) {
+  // CHECK: scratch offset = 0, size = 2048
+  %0 = tt.gather %src[%indices] {axis = 1 : i32} : (tensor<4x128xf32, #BL>, tensor<4x128xi32, #BL>) -> tensor<4x128xf32, #BL>
+  tt.return
+  // CHECK-NEXT: size = 2048
+}
+
 
 // CHECK-LABEL: dealloc
 tt.func @dealloc(%A : !tt.ptr<f16>) {
@@ -293,6 +324,44 @@ tt.func @scratch() {
   // CHECK-NEXT: size = 128
 }
 
+// The constant weights of a Welford reduction are the same in every thread and
+// get no scratch.
+// CHECK-LABEL: scratch_welford
+tt.func @scratch_welford(%mean : tensor<16x16xf32, #AL>, %m2 : tensor<16x16xf32, #AL>) {
+  %weight = arith.constant dense<1.000000e+00> : tensor<16x16xf32, #AL>
+  // CHECK: scratch offset = 0, size = 512
+  %b:3 = "tt.reduce" (%mean, %m2, %weight) ({
+  ^bb0(%mean1: f32, %m2_1: f32, %w1: f32, %mean2: f32, %m2_2: f32, %w2: f32):
+    %delta = arith.subf %mean2, %mean1 : f32
+    %w = arith.addf %w1, %w2 : f32
+    %ratio = arith.divf %w2, %w : f32
+    %0 = arith.mulf %delta, %ratio : f32
+    %mean3 = arith.addf %mean1, %0 : f32
+    %1 = arith.mulf %delta, %delta : f32
+    %2 = arith.mulf %1, %w1 : f32
+    %3 = arith.mulf %2, %ratio : f32
+    %4 = arith.addf %m2_1, %m2_2 : f32
+    %m2_3 = arith.addf %4, %3 : f32
+    tt.reduce.return %mean3, %m2_3, %w : f32, f32, f32
+  }) {axis = 0 : i32} : (tensor<16x16xf32, #AL>, tensor<16x16xf32, #AL>, tensor<16x16xf32, #AL>) -> (tensor<16xf32, #sliceAd0>, tensor<16xf32, #sliceAd0>, tensor<16xf32, #sliceAd0>)
+  tt.return
+  // CHECK-NEXT: size = 512
+}
+
+// Scratch buffers reuse the storage of dead explicit buffers, and conversions
+// of a single row are not padded.
+// CHECK-LABEL: scratch_reuse_dead_alloc
+tt.func @scratch_reuse_dead_alloc(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 0, size = 2048
+  %a = triton_gpu.local_alloc : () -> !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  triton_gpu.local_dealloc %a : !tt.memdesc<64x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  %cst = arith.constant dense<0.000000e+00> : tensor<1x128xf16, #AL>
+  // CHECK-NEXT: scratch offset = 0, size = 256
+  %0 = triton_gpu.convert_layout %cst : tensor<1x128xf16, #AL> -> tensor<1x128xf16, #BL>
+  tt.return
+  // CHECK-NEXT: size = 2048
+}
+
 // CHECK-LABEL: trans
 tt.func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
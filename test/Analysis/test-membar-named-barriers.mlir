@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading --convert-scf-to-cf --allocate-shared-memory -test-print-membar="named-barriers=true" 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#CL = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// CHECK-LABEL: same_warps
+// Every warp reads back the elements it stored.
+tt.func @same_warps(%A : tensor<128x32xf16, #AL>, %B : tensor<128x32xf16, #AL>) {
+  %0 = triton_gpu.local_alloc %A : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.named_barrier 1
+  // CHECK-NEXT: triton_gpu.local_load
+  %1 = triton_gpu.local_load %0 : !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<128x32xf16, #AL>
+  // CHECK: triton_gpu.named_barrier 1
+  // CHECK-NEXT: triton_gpu.local_store
+  triton_gpu.local_store %B, %0 : tensor<128x32xf16, #AL> -> !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.named_barrier 1
+  // CHECK-NEXT: triton_gpu.local_load
+  %2 = triton_gpu.local_load %0 : !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<128x32xf16, #AL>
+  tt.return
+}
+
+// CHECK-LABEL: other_warps
+// The elements are read by other warps than the ones storing them.
+tt.func @other_warps(%A : tensor<128x32xf16, #AL>) {
+  %0 = triton_gpu.local_alloc %A : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NOT: triton_gpu.named_barrier
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.local_load
+  %1 = triton_gpu.local_load %0 : !tt.memdesc<128x32xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<128x32xf16, #CL>
+  tt.return
+}
+
+}
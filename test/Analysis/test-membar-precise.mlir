@@ -0,0 +1,57 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading --convert-scf-to-cf --allocate-shared-memory -test-print-membar="precise=true print-barrier-count=true" 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#A_SHARED_3D = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [2, 1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// Accesses to different slices of a multi-buffered allocation are disjoint.
+// CHECK: remark: inserted 1 barriers
+// CHECK-LABEL: disjoint_slices
+tt.func @disjoint_slices(%arg : tensor<16x16xf16, #AL>) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %alloc = triton_gpu.local_alloc : () -> !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable>
+  %s0 = triton_gpu.memdesc_subview %alloc[%c0, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %s1 = triton_gpu.memdesc_subview %alloc[%c1, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.local_store
+  // CHECK-NOT: gpu.barrier
+  // CHECK: triton_gpu.local_load
+  triton_gpu.local_store %arg, %s0 : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %s1 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.local_load
+  %1 = triton_gpu.local_load %s0 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#A_SHARED_3D = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [2, 1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32} {
+
+// Slices selected by a non-constant index, such as the loop-carried stage
+// index of the pipeliner, cover the whole allocation.
+// CHECK: remark: inserted 1 barriers
+// CHECK-LABEL: dynamic_slices
+tt.func @dynamic_slices(%arg : tensor<16x16xf16, #AL>, %idx : i32) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %alloc = triton_gpu.local_alloc : () -> !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable>
+  %s0 = triton_gpu.memdesc_subview %alloc[%idx, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %s1 = triton_gpu.memdesc_subview %alloc[%c1, %c0, %c0] : !tt.memdesc<2x16x16xf16, #A_SHARED_3D, #triton_gpu.shared_memory, mutable> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.local_load
+  triton_gpu.local_store %arg, %s0 : tensor<16x16xf16, #AL> -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable>
+  %0 = triton_gpu.local_load %s1 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory, mutable> -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
+}
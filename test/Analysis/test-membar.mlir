@@ -656,4 +656,31 @@ tt.func @call_graph_2(%A : !tt.ptr<f16>, %cond : i1) {
   tt.return
 }
 
+// CHECK-LABEL: sync_on_entry
+tt.func @sync_on_entry() {
+  gpu.barrier
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %0 = triton_gpu.local_alloc %cst : (tensor<16x16xf16, #AL>) -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK: triton_gpu.local_alloc
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.local_load
+  %1 = triton_gpu.local_load %0 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
+// The callee synchronizes before touching its buffer, which lives after %0,
+// so neither the write before the call nor the read after it needs a barrier.
+// CHECK-LABEL: call_sync_on_entry
+tt.func @call_sync_on_entry() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %0 = triton_gpu.local_alloc %cst : (tensor<16x16xf16, #AL>) -> !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory>
+  // CHECK-NOT: gpu.barrier
+  // CHECK: tt.call
+  // CHECK-NOT: gpu.barrier
+  // CHECK: tt.return
+  tt.call @sync_on_entry() : () -> ()
+  %1 = triton_gpu.local_load %0 : !tt.memdesc<16x16xf16, #A_SHARED, #triton_gpu.shared_memory> -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
 }
@@ -0,0 +1,40 @@
+// RUN: triton-opt %s --mlir-disable-threading -test-print-register-pressure 2>&1 | FileCheck %s
+
+// 64x64 tensors distributed to 128 threads hold 32 elements per thread.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+
+// CHECK-LABEL: straight_line
+tt.func @straight_line(%arg0: tensor<64x64x!tt.ptr<f16>, #blocked>) {
+  // pointers take 64 registers, f16 values 16
+  // CHECK-NEXT: tt.load: 80
+  %0 = tt.load %arg0 : tensor<64x64x!tt.ptr<f16>, #blocked>
+  // CHECK-NEXT: arith.addf: 96
+  %1 = arith.addf %0, %0 : tensor<64x64xf16, #blocked>
+  // CHECK-NEXT: tt.store: 80
+  tt.store %arg0, %1 : tensor<64x64x!tt.ptr<f16>, #blocked>
+  // CHECK-NEXT: tt.return: 0
+  tt.return
+  // CHECK-NEXT: max = 96
+}
+
+// The values live across a loop are live in its body too.
+// CHECK-LABEL: loop
+tt.func @loop(%arg0: tensor<64x64x!tt.ptr<f16>, #blocked>, %lb: i32, %ub: i32, %step: i32) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+  %0 = tt.load %arg0 : tensor<64x64x!tt.ptr<f16>, #blocked>
+  %1 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<64x64xf32, #blocked>) : i32 {
+    %2 = arith.addf %acc, %acc : tensor<64x64xf32, #blocked>
+    // %2, and %arg0, %0, %cst and the bounds live across the loop
+    // CHECK: scf.yield: 147
+    scf.yield %2 : tensor<64x64xf32, #blocked>
+  }
+  // CHECK: arith.truncf: 128
+  %3 = arith.truncf %1 : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+  %4 = arith.addf %3, %0 : tensor<64x64xf16, #blocked>
+  tt.store %arg0, %4 : tensor<64x64x!tt.ptr<f16>, #blocked>
+  tt.return
+}
+
+}
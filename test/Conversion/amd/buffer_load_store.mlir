@@ -0,0 +1,106 @@
+// RUN: env AMDGCN_USE_BUFFER_OPS=1 triton-opt %s -split-input-file --convert-triton-amdgpu-to-llvm=arch=gfx942 | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The offsets from the base pointers are non-negative and fit in 32 bits
+  // CHECK-LABEL: buffer_load_store
+  tt.func @buffer_load_store(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32) {
+    %c256_i32 = arith.constant 256 : i32
+    %0 = tt.get_program_id x : i32
+    %1 = arith.muli %0, %c256_i32 : i32
+    %2 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %3 = tt.splat %1 : i32 -> tensor<256xi32, #blocked0>
+    %4 = arith.addi %3, %2 : tensor<256xi32, #blocked0>
+    %5 = tt.splat %arg2 : i32 -> tensor<256xi32, #blocked0>
+    %mask = arith.cmpi slt, %4, %5 : tensor<256xi32, #blocked0>
+    %6 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %7 = tt.addptr %6, %4 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %8 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %9 = tt.addptr %8, %4 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // CHECK: rocdl.make.buffer.rsrc
+    // CHECK: llvm.select {{.*}}, {{.*}}, %{{.*}} : i1, i32
+    // CHECK: rocdl.raw.ptr.buffer.load {{.*}} : vector<4xi32>
+    // CHECK-NOT: llvm.cond_br
+    %10 = tt.load %7, %mask : tensor<256x!tt.ptr<f32>, #blocked0>
+    // CHECK: rocdl.make.buffer.rsrc
+    // CHECK: rocdl.raw.ptr.buffer.store
+    tt.store %9, %10, %mask : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The offsets of an argument may be negative
+  // CHECK-LABEL: global_load_signed_offsets
+  tt.func @global_load_signed_offsets(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<256xi32, #blocked0>) {
+    %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %1 = tt.addptr %0, %arg1 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // CHECK-NOT: rocdl.raw.ptr.buffer.load
+    // CHECK: llvm.load
+    %2 = tt.load %1 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.store %1, %2 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The result of the atomic is unused
+  // CHECK-LABEL: buffer_atomic_fadd
+  tt.func @buffer_atomic_fadd(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<64xf32, #blocked0>) {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xi32, #blocked0>
+    // CHECK: llvm.fence syncscope("agent") release
+    // CHECK: rocdl.raw.ptr.buffer.atomic.fadd
+    // CHECK: llvm.fence syncscope("agent") acquire
+    // CHECK-NOT: llvm.atomicrmw
+    %3 = tt.atomic_rmw fadd, acq_rel, gpu, %2, %arg1 : (tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xf32, #blocked0>) -> tensor<64xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The fences are at the scope of the atomic
+  // CHECK-LABEL: buffer_atomic_fadd_cta
+  tt.func @buffer_atomic_fadd_cta(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<64xf32, #blocked0>) {
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xi32, #blocked0>
+    // CHECK: llvm.fence syncscope("workgroup") release
+    // CHECK: rocdl.raw.ptr.buffer.atomic.fadd
+    // CHECK: llvm.fence syncscope("workgroup") acquire
+    %3 = tt.atomic_rmw fadd, acq_rel, cta, %2, %arg1 : (tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xf32, #blocked0>) -> tensor<64xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // The byte offsets may not fit in 31 bits, the atomics stay global ones
+  // CHECK-LABEL: buffer_atomic_fadd_unbounded
+  tt.func @buffer_atomic_fadd_unbounded(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<64xf32, #blocked0>) {
+    %c1048576_i32 = arith.constant 1048576 : i32
+    %pid = tt.get_program_id x : i32
+    %base = arith.muli %pid, %c1048576_i32 : i32
+    %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked0>
+    %1 = tt.splat %base : i32 -> tensor<64xi32, #blocked0>
+    %2 = arith.addi %1, %0 : tensor<64xi32, #blocked0>
+    %3 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked0>
+    %4 = tt.addptr %3, %2 : tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xi32, #blocked0>
+    // CHECK-NOT: rocdl.raw.ptr.buffer.atomic.fadd
+    // CHECK: llvm.atomicrmw fadd
+    %5 = tt.atomic_rmw fadd, acq_rel, gpu, %4, %arg1 : (tensor<64x!tt.ptr<f32>, #blocked0>, tensor<64xf32, #blocked0>) -> tensor<64xf32, #blocked0>
+    tt.return
+  }
+}
@@ -0,0 +1,89 @@
+// RUN: triton-opt %s -split-input-file -triton-amdgpu-insert-instruction-sched-hints | FileCheck %s
+// RUN: triton-opt %s -split-input-file -triton-amdgpu-insert-instruction-sched-hints=variant=none | FileCheck %s --check-prefix=NONE
+
+// Each 32x32x8 MFMA hides up to eight memory instructions, so the four LDS
+// reads, two global reads and two LDS writes split evenly over both MFMAs.
+
+// NONE-NOT: llvm.amdgcn.sched.group.barrier
+// CHECK-LABEL: llvm.func @interleave_mfma_block
+// CHECK: llvm.store
+// CHECK: llvm.mlir.constant(8 : i32)
+// CHECK-NEXT: llvm.mlir.constant(1 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NEXT: llvm.mlir.constant(256 : i32)
+// CHECK-NEXT: llvm.mlir.constant(2 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NEXT: llvm.mlir.constant(32 : i32)
+// CHECK-NEXT: llvm.mlir.constant(1 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NEXT: llvm.mlir.constant(512 : i32)
+// CHECK-NEXT: llvm.mlir.constant(1 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NEXT: llvm.mlir.constant(8 : i32)
+// CHECK-COUNT-4: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NOT: llvm.call_intrinsic
+// CHECK: llvm.return
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  llvm.func @__predicated_load_v4f16(!llvm.ptr<1>, i1, vector<4xf16>) -> vector<4xf16>
+  llvm.func @interleave_mfma_block(%gptr: !llvm.ptr<1>, %sptr: !llvm.ptr<3>, %pred: i1, %acc: vector<16xf32>) -> vector<16xf32> {
+    %zero = llvm.mlir.constant(0 : i32) : i32
+    %other = llvm.mlir.zero : vector<4xf16>
+    %g0 = llvm.call @__predicated_load_v4f16(%gptr, %pred, %other) : (!llvm.ptr<1>, i1, vector<4xf16>) -> vector<4xf16>
+    %g1 = llvm.call @__predicated_load_v4f16(%gptr, %pred, %other) : (!llvm.ptr<1>, i1, vector<4xf16>) -> vector<4xf16>
+    %a0 = llvm.load %sptr : !llvm.ptr<3> -> vector<4xf16>
+    %b0 = llvm.load %sptr : !llvm.ptr<3> -> vector<4xf16>
+    %a1 = llvm.load %sptr : !llvm.ptr<3> -> vector<4xf16>
+    %b1 = llvm.load %sptr : !llvm.ptr<3> -> vector<4xf16>
+    %c0 = rocdl.mfma.f32.32x32x8f16 %a0, %b0, %acc, %zero, %zero, %zero : (vector<4xf16>, vector<4xf16>, vector<16xf32>, i32, i32, i32) -> vector<16xf32>
+    %c1 = rocdl.mfma.f32.32x32x8f16 %a1, %b1, %c0, %zero, %zero, %zero : (vector<4xf16>, vector<4xf16>, vector<16xf32>, i32, i32, i32) -> vector<16xf32>
+    llvm.store %g0, %sptr : vector<4xf16>, !llvm.ptr<3>
+    llvm.store %g1, %sptr : vector<4xf16>, !llvm.ptr<3>
+    llvm.return %c1 : vector<16xf32>
+  }
+}
+
+// -----
+
+// Blocks without memory accesses are left alone.
+
+// CHECK-LABEL: llvm.func @mfma_only_block
+// CHECK-NOT: llvm.amdgcn.sched.group.barrier
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  llvm.func @mfma_only_block(%a: vector<4xf16>, %b: vector<4xf16>, %acc: vector<16xf32>) -> vector<16xf32> {
+    %zero = llvm.mlir.constant(0 : i32) : i32
+    %c = rocdl.mfma.f32.32x32x8f16 %a, %b, %acc, %zero, %zero, %zero : (vector<4xf16>, vector<4xf16>, vector<16xf32>, i32, i32, i32) -> vector<16xf32>
+    llvm.return %c : vector<16xf32>
+  }
+}
+
+// -----
+
+// Calls other than predicated accesses, e.g. to math libraries, are not
+// counted, whatever the type of their first argument.
+
+// CHECK-LABEL: llvm.func @math_call_block
+// CHECK: llvm.call @__ocml_exp_f32
+// CHECK: llvm.mlir.constant(8 : i32)
+// CHECK-NEXT: llvm.mlir.constant(1 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NEXT: llvm.mlir.constant(256 : i32)
+// CHECK-NEXT: llvm.mlir.constant(1 : i32)
+// CHECK-NEXT: llvm.mlir.constant(0 : i32)
+// CHECK-NEXT: llvm.call_intrinsic "llvm.amdgcn.sched.group.barrier"
+// CHECK-NOT: llvm.call_intrinsic
+// CHECK: llvm.return
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  llvm.func @__ocml_exp_f32(f32) -> f32
+  llvm.func @math_call_block(%sptr: !llvm.ptr<3>, %x: f32, %b: vector<4xf16>, %acc: vector<16xf32>) -> vector<16xf32> {
+    %zero = llvm.mlir.constant(0 : i32) : i32
+    %e = llvm.call @__ocml_exp_f32(%x) : (f32) -> f32
+    %a = llvm.load %sptr : !llvm.ptr<3> -> vector<4xf16>
+    %c = rocdl.mfma.f32.32x32x8f16 %a, %b, %acc, %zero, %zero, %zero : (vector<4xf16>, vector<4xf16>, vector<16xf32>, i32, i32, i32) -> vector<16xf32>
+    llvm.return %c : vector<16xf32>
+  }
+}
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s --allocate-shared-memory --convert-triton-amdgpu-to-llvm=arch="gfx942" --convert-builtin-func-to-llvm -split-input-file | FileCheck %s
+
+// Each lane holds four rows in one column of the mfma tile and needs four
+// columns of one row; the transpose takes one permute per register.
+
+#mfma = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [1, 1], instrShape = [32, 32], isTransposed = false}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: mfma_to_blocked_permute
+  tt.func public @mfma_to_blocked_permute(%arg0: tensor<32x32xbf16, #mfma>) {
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-16: rocdl.ds_bpermute
+    // CHECK-NOT: rocdl.ds_bpermute
+    // CHECK-NOT: llvm.load
+    %0 = triton_gpu.convert_layout %arg0 : tensor<32x32xbf16, #mfma> -> tensor<32x32xbf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// Sixteen consecutive columns per lane would need too many selects per
+// permute, so the conversion goes through shared memory.
+
+#mfma = #triton_gpu.amd_mfma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [1, 1], instrShape = [32, 32], isTransposed = false}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 16], threadsPerWarp = [32, 2], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: mfma_to_blocked_shared
+  tt.func public @mfma_to_blocked_shared(%arg0: tensor<32x32xbf16, #mfma>) {
+    // CHECK-NOT: rocdl.ds_bpermute
+    // CHECK: llvm.store {{.*}} !llvm.ptr<3>
+    // CHECK: llvm.load {{.*}} !llvm.ptr<3>
+    %0 = triton_gpu.convert_layout %arg0 : tensor<32x32xbf16, #mfma> -> tensor<32x32xbf16, #blocked>
+    tt.return
+  }
+}
@@ -35,3 +35,74 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [64], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: packed_f16_arith
+  tt.func @packed_f16_arith(%arg0: tensor<512xf16, #blocked>) -> tensor<512xf16, #blocked> {
+    // CHECK: llvm.fmul %{{.*}}, %{{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fmul
+    %0 = arith.mulf %arg0, %arg0 : tensor<512xf16, #blocked>
+    tt.return %0 : tensor<512xf16, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  // CHECK-LABEL: int4_to_f16
+  tt.func @int4_to_f16(%arg0: tensor<1024xi8, #blocked>) -> tensor<1024xf16, #blocked> {
+    %c4 = arith.constant dense<4> : tensor<1024xi8, #blocked>
+    // CHECK: %[[BIAS:.*]] = llvm.mlir.constant(dense<1.032000e+03> : vector<2xf16>) : vector<2xf16>
+    // CHECK-COUNT-2: llvm.fsub %{{.*}}, %[[BIAS]] : vector<2xf16>
+    // CHECK-NOT: llvm.sitofp
+    %0 = arith.shrsi %arg0, %c4 : tensor<1024xi8, #blocked>
+    %1 = arith.sitofp %0 : tensor<1024xi8, #blocked> to tensor<1024xf16, #blocked>
+    tt.return %1 : tensor<1024xf16, #blocked>
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: grid_sync
+  tt.func @grid_sync(%arg0: !tt.ptr<i32>) {
+    // CHECK: rocdl.barrier
+    // CHECK: llvm.cond_br %{{.*}}, ^[[ARRIVE:.*]], ^[[END:.*]]
+    // CHECK: ^[[ARRIVE]]:
+    // CHECK: llvm.atomicrmw add %{{.*}}, %{{.*}} syncscope("agent") release
+    // CHECK: llvm.udiv
+    // CHECK: llvm.br ^[[SPIN:.*]](%{{.*}} : i32)
+    // CHECK: ^[[SPIN]](%[[TARGET:.*]]: i32):
+    // CHECK: llvm.atomicrmw add %{{.*}}, %{{.*}} syncscope("agent") acquire
+    // CHECK: llvm.cond_br %{{.*}}, ^[[SPIN]](%[[TARGET]] : i32), ^[[END]]
+    // CHECK: ^[[END]]:
+    // CHECK-NEXT: rocdl.barrier
+    tt.grid_sync %arg0 : !tt.ptr<i32>
+    tt.return
+  }
+
+  // CHECK-LABEL: signal_wait
+  tt.func @signal_wait(%arg0: !tt.ptr<i32>, %arg1: i32) {
+    // CHECK: llvm.cond_br %{{.*}}, ^[[SPIN:.*]], ^[[END:.*]]
+    // CHECK: ^[[SPIN]]:
+    // CHECK: llvm.atomicrmw add %{{.*}}, %{{.*}} acquire
+    // CHECK: %[[DONE:.*]] = llvm.icmp "eq"
+    // CHECK: llvm.cond_br %[[DONE]], ^[[END]], ^[[SPIN]]
+    // CHECK: ^[[END]]:
+    // CHECK-NEXT: rocdl.barrier
+    tt.signal_wait eq, sys, %arg0, %arg1 : !tt.ptr<i32>
+    tt.return
+  }
+
+  // CHECK-LABEL: griddep_control
+  tt.func @griddep_control() {
+    // CHECK-NEXT: llvm.return
+    tt.griddep_wait
+    tt.griddep_launch_dependents
+    tt.return
+  }
+}
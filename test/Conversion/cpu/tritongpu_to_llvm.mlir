@@ -0,0 +1,47 @@
+// RUN: triton-opt %s -split-input-file --decompose-unsupported-cpu-conversions --allocate-shared-memory --convert-triton-cpu-to-llvm | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [1], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 1 : i32} {
+  // CHECK: llvm.mlir.global internal thread_local @global_smem
+  // CHECK-LABEL: llvm.func @masked_copy
+  // CHECK-SAME: (%{{.*}}: !llvm.ptr, %{{.*}}: !llvm.ptr, %{{.*}}: i32, %[[PID_X:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32)
+  tt.func public @masked_copy(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32) {
+    %c4_i32 = arith.constant 4 : i32
+    %0 = tt.get_program_id x : i32
+    // CHECK: llvm.mul %[[PID_X]]
+    %1 = arith.muli %0, %c4_i32 : i32
+    %2 = tt.make_range {end = 4 : i32, start = 0 : i32} : tensor<4xi32, #blocked>
+    %3 = tt.splat %1 : i32 -> tensor<4xi32, #blocked>
+    %4 = arith.addi %3, %2 : tensor<4xi32, #blocked>
+    %5 = tt.splat %arg2 : i32 -> tensor<4xi32, #blocked>
+    %6 = arith.cmpi slt, %4, %5 : tensor<4xi32, #blocked>
+    %7 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<4x!tt.ptr<f32>, #blocked>
+    %8 = tt.addptr %7, %4 : tensor<4x!tt.ptr<f32>, #blocked>, tensor<4xi32, #blocked>
+    // CHECK: llvm.intr.masked.load {{.*}} -> vector<4xf32>
+    %9 = tt.load %8, %6 : tensor<4x!tt.ptr<f32>, #blocked>
+    %10 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<4x!tt.ptr<f32>, #blocked>
+    %11 = tt.addptr %10, %4 : tensor<4x!tt.ptr<f32>, #blocked>, tensor<4xi32, #blocked>
+    // CHECK: llvm.intr.masked.store {{.*}}vector<4xf32>
+    tt.store %11, %9, %6 : tensor<4x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [1], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 1 : i32} {
+  // CHECK-LABEL: llvm.func @num_programs_mulhi
+  // CHECK-SAME: (%{{.*}}: !llvm.ptr, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32, %[[NUM_Y:.*]]: i32, %{{.*}}: i32)
+  tt.func public @num_programs_mulhi(%arg0: !tt.ptr<i32>, %arg1: i32) {
+    // CHECK-NOT: __nv_umulhi
+    // CHECK: llvm.zext %{{.*}} : i32 to i64
+    // CHECK: llvm.mul %{{.*}} : i64
+    // CHECK: llvm.lshr
+    // CHECK: llvm.trunc %{{.*}} : i64 to i32
+    %0 = tt.get_num_programs y : i32
+    %1 = tt.mulhiui %0, %arg1 : i32
+    tt.store %arg0, %1 : !tt.ptr<i32>
+    tt.return
+  }
+}
@@ -95,3 +95,29 @@ tt.func public @select_op(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg
   tt.return
 }
 }
+
+// -----
+
+// CHECK-DAG: #[[SRC:.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [{{.*}}], warpsPerCTA = [{{.*}}], order = [0, 1]}>
+// CHECK-DAG: #[[DST:.*]] = #triton_gpu.blocked<{sizePerThread = [2, 1], threadsPerWarp = [{{.*}}], warpsPerCTA = [{{.*}}], order = [0, 1]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+tt.func @unpack(%arg0: tensor<16x32xi8>) -> tensor<32x32xf16> {
+  // CHECK-LABEL: unpack
+  // CHECK: %[[CVT:.*]] = triton_gpu.convert_layout %{{.*}} -> tensor<16x32xi8, #[[SRC]]>
+  // CHECK: tt.unpack %[[CVT]], i4 {axis = 0 : i32} : tensor<16x32xi8, #[[SRC]]> -> tensor<32x32xf16, #[[DST]]>
+  %0 = tt.unpack %arg0, i4 {axis = 0 : i32} : tensor<16x32xi8> -> tensor<32x32xf16>
+  tt.return %0 : tensor<32x32xf16>
+}
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 2 : i32} {
+tt.func @sparse_dot(%a: tensor<64x32xf16>, %b: tensor<64x64xf16>, %meta: tensor<64x4xi16>) -> tensor<64x64xf32> {
+  // CHECK-LABEL: sparse_dot
+  // CHECK: triton_gpu.sparse_dot {{.*}} : tensor<64x32xf16, #{{.*}}> meta tensor<64x4xi16, #{{.*}}> * tensor<64x64xf16, #{{.*}}> -> tensor<64x64xf32, #{{.*}}>
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32>
+  %0 = triton_gpu.sparse_dot %a, %b, %cst, %meta : tensor<64x32xf16> meta tensor<64x4xi16> * tensor<64x64xf16> -> tensor<64x64xf32>
+  tt.return %0 : tensor<64x64xf32>
+}
+}
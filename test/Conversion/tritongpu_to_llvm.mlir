@@ -773,28 +773,35 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_register_permutation
+  tt.func @convert_layout_register_permutation(%arg0: tensor<128x4xf32, #blocked0>) {
+    // Every thread holds the same elements in both layouts, twice in the
+    // destination, so the conversion only renames registers.
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-COUNT-4: llvm.extractvalue
+    // CHECK-COUNT-8: llvm.insertvalue
+    // CHECK-NOT: llvm.load
+    %0 = triton_gpu.convert_layout %arg0 : tensor<128x4xf32, #blocked0> -> tensor<128x4xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
-  // CHECK: llvm.mlir.global external @global_smem
   // CHECK-LABEL: convert_layout_blocked_blocked_multi_rep
   tt.func @convert_layout_blocked_blocked_multi_rep(%arg0: tensor<16x16xf32, #blocked0>) {
-    // CHECK: llvm.mlir.addressof @global_smem
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<3>
+    // The conversion stays within the warp, so it is lowered to shuffles.
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-COUNT-8: nvvm.shfl.sync idx
+    // CHECK-NOT: llvm.load
     %0 = triton_gpu.convert_layout %arg0 : tensor<16x16xf32, #blocked0> -> tensor<16x16xf32, #blocked1>
     tt.return
   }
@@ -922,7 +929,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked1d_to_slice0
   tt.func @convert_blocked1d_to_slice0(%src:tensor<32xi32, #blocked0>) {
-    // CHECK: llvm.load {{.*}} : !llvm.ptr<3> -> vector<4xi32>
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-4: nvvm.shfl.sync idx
+    // CHECK-NOT: llvm.load
     %cvt = triton_gpu.convert_layout %src : tensor<32xi32, #blocked0> -> tensor<32xi32, #triton_gpu.slice<{dim = 0, parent = #blocked1}>>
     tt.return
   }
@@ -935,7 +944,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked1d_to_slice1
   tt.func @convert_blocked1d_to_slice1(%src:tensor<32xi32, #blocked0>) {
-    // CHECK-COUNT-8: llvm.load {{.*}} : !llvm.ptr<3>
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-8: nvvm.shfl.sync idx
+    // CHECK-NOT: llvm.load
     %cvt = triton_gpu.convert_layout %src : tensor<32xi32, #blocked0> -> tensor<32xi32, #triton_gpu.slice<{dim = 1, parent = #blocked1}>>
     tt.return
   }
@@ -948,9 +959,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked_to_blocked_ptr
   tt.func @convert_blocked_to_blocked_ptr(%src:tensor<32x!tt.ptr<f32>, #blocked0>) {
+    // CHECK-NOT: llvm.store
     // CHECK: llvm.ptrtoint
-    // CHECK: llvm.store
-    // CHECK: nvvm.barrier0
+    // CHECK: nvvm.shfl.sync idx
     // CHECK: llvm.inttoptr
     // CHECK-COUNT-4: llvm.insertvalue
     %cvt = triton_gpu.convert_layout %src : tensor<32x!tt.ptr<f32>, #blocked0> -> tensor<32x!tt.ptr<f32>, #blocked1>
@@ -1080,6 +1091,29 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, gpu, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg0, %0 : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+
+  // The updates whose result is unused don't return it.
+  // CHECK-LABEL: reduce_add_f32
+  tt.func @reduce_add_f32(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.cta.release.add.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.cta.release.add.f32
+    %0 = tt.atomic_rmw fadd, release, cta, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return
+  }
+
+  // Acquiring updates and exchanges have no reduction.
+  // CHECK-LABEL: unused_atomic_acquire
+  tt.func @unused_atomic_acquire(%arg0 : tensor<256x!tt.ptr<i32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xi32, #blocked0>) {
+    // CHECK: atom.global.gpu.acq_rel.add.u32
+    // CHECK: atom.global.gpu.relaxed.exch.b32
+    // CHECK-NOT: red.global
+    %0 = tt.atomic_rmw add, acq_rel, gpu, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<i32>, #blocked0>, tensor<256xi32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xi32, #blocked0>
+    %1 = tt.atomic_rmw exch, relaxed, gpu, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<i32>, #blocked0>, tensor<256xi32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xi32, #blocked0>
     tt.return
   }
 }
@@ -1091,7 +1125,7 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
   tt.func @atomic_add_f32_scalar(%arg0 : !tt.ptr<f32>, %arg1 : i1, %arg2 : f32) {
     // CHECK: llvm.icmp "eq"
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, gpu, %arg0, %arg2, %arg1 : (!tt.ptr<f32>, f32, i1) -> f32
     tt.return
   }
@@ -1104,9 +1138,9 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
   // CHECK-LABEL: atomic_add_f32
   tt.func @atomic_add_f32_sys_scope(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.sys.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.sys.relaxed.add.f32
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: @$3 atom.global.sys.relaxed.add.f32
+    // CHECK-SAME: @$2 red.global.sys.relaxed.add.f32
     %0 = tt.atomic_rmw fadd, relaxed, sys, %arg0, %arg2, %arg1 : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
     tt.return
   }
@@ -1269,6 +1303,28 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 :
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: test_index_hoisted_to_entry
+  tt.func @test_index_hoisted_to_entry(%arg0: i1) {
+    // The thread-dependent part of the indices is computed in the entry block,
+    // and the registers only xor in a constant.
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.cond_br
+    // CHECK-NOT: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.xor %{{.*}}, %{{.*}} : i32
+    // CHECK-NOT: nvvm.read.ptx.sreg.tid.x
+    cf.cond_br %arg0, ^bb1, ^bb2
+    ^bb1:  // pred: ^bb0
+      %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+      cf.br ^bb2
+    ^bb2:  // 2 preds: ^bb0, ^bb1
+      tt.return
+  }
+}
+
+// -----
+
 #mma = #triton_gpu.nvidia_mma<{versionMajor=2, warpsPerCTA=[2, 2], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1], instrShape = [16, 8]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
@@ -1362,14 +1418,43 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
 }
 
 // -----
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: test_int4_to_fp_vectorized_conversion
+  tt.func @test_int4_to_fp_vectorized_conversion(%in: tensor<128xi8, #blocked>) -> (tensor<128xf16, #blocked>, tensor<128xbf16, #blocked>, tensor<128xf16, #blocked>) {
+    %c4 = arith.constant dense<4> : tensor<128xi8, #blocked>
+    %c15 = arith.constant dense<15> : tensor<128xi8, #blocked>
+    // The signed int4 are offset by 8 and placed in the mantissa of 1024.
+    // CHECK-NOT: llvm.sitofp
+    // CHECK: %[[F16_BIAS:.*]] = llvm.mlir.constant(dense<1.032000e+03> : vector<2xf16>) : vector<2xf16>
+    // CHECK: llvm.xor %{{.*}}, %{{.*}} : i32
+    // CHECK: llvm.fsub %{{.*}}, %[[F16_BIAS]] : vector<2xf16>
+    // CHECK: llvm.fsub %{{.*}}, %[[F16_BIAS]] : vector<2xf16>
+    // CHECK-NOT: llvm.fsub %{{.*}}, %[[F16_BIAS]]
+    %0 = arith.shli %in, %c4 : tensor<128xi8, #blocked>
+    %1 = arith.shrsi %0, %c4 : tensor<128xi8, #blocked>
+    %2 = arith.sitofp %1 : tensor<128xi8, #blocked> to tensor<128xf16, #blocked>
+    // CHECK: %[[BF16_BIAS:.*]] = llvm.mlir.constant(dense<1.280000e+02> : vector<2xbf16>) : vector<2xbf16>
+    // CHECK-COUNT-2: llvm.fsub %{{.*}}, %[[BF16_BIAS]] : vector<2xbf16>
+    %3 = arith.andi %in, %c15 : tensor<128xi8, #blocked>
+    %4 = arith.sitofp %3 : tensor<128xi8, #blocked> to tensor<128xbf16, #blocked>
+    // Any i8 fits in the mantissa of 1024 in f16.
+    // CHECK-COUNT-2: llvm.fsub %{{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.sitofp
+    %5 = arith.sitofp %in : tensor<128xi8, #blocked> to tensor<128xf16, #blocked>
+    tt.return %2, %4, %5 : tensor<128xf16, #blocked>, tensor<128xbf16, #blocked>, tensor<128xf16, #blocked>
+  }
+}
 
+// -----
+
+// The partial sums of the 4 warps are loaded and added by every thread.
 // CHECK-LABEL: sum_reduction
 //       CHECK:  %[[M:.+]] = llvm.mlir.constant(-1 : i32) : i32
 //       CHECK:   nvvm.redux.sync  add %{{.*}}, %[[M]]
 //       CHECK:   nvvm.barrier0
-//       CHECK:   nvvm.shfl.sync bfly
-//       CHECK:   nvvm.shfl.sync bfly
-//       CHECK:   nvvm.barrier0
+//   CHECK-NOT:   nvvm.shfl.sync
+// CHECK-COUNT-4:   llvm.load %{{.*}} : !llvm.ptr<3> -> i32
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [0, 1]}>
 #blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
 module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
@@ -1399,6 +1484,99 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
   }
 }
 
+// -----
+
+// Each thread holds 64 results, so the partial sums of the 8 warps are
+// combined by a round of shuffles in shared memory instead.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 8], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32} {
+  // CHECK-LABEL: reduce_inter_warps_in_shared_memory
+  tt.func @reduce_inter_warps_in_shared_memory(%arg0: tensor<64x256xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>> {
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-3: nvvm.shfl.sync bfly
+    // CHECK: st.shared
+    // CHECK: nvvm.barrier0
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) : (tensor<64x256xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return %0 : tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+  }
+}
+
+// -----
+
+// The 8 rows of each warp store their partial sums to swizzled slots, and every
+// thread combines the 4 partials of a row as a tree.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_swizzled_partials
+  tt.func @reduce_swizzled_partials(%arg0: tensor<64x64xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>> {
+    // CHECK: llvm.xor
+    // CHECK: st.shared
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-4: llvm.load %{{.*}} : !llvm.ptr<3> -> f32
+    // CHECK: %[[A:.+]] = llvm.fadd
+    // CHECK: %[[B:.+]] = llvm.fadd
+    // CHECK: llvm.fadd %[[A]], %[[B]]
+    // CHECK-NOT: nvvm.barrier0
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) : (tensor<64x64xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return %0 : tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+  }
+}
+
+// -----
+
+// The constant weights of the Welford reduction are the same in every lane, so
+// only the means and the sums of squares are shuffled.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: reduce_welford
+  tt.func @reduce_welford(%mean: tensor<32xf32, #blocked>, %m2: tensor<32xf32, #blocked>) -> (f32, f32, f32) {
+    %weight = arith.constant dense<1.000000e+00> : tensor<32xf32, #blocked>
+    // CHECK-COUNT-10: nvvm.shfl.sync bfly
+    // CHECK-NOT: nvvm.shfl.sync
+    %0:3 = "tt.reduce"(%mean, %m2, %weight) <{axis = 0 : i32}> ({
+    ^bb0(%mean1: f32, %m2_1: f32, %w1: f32, %mean2: f32, %m2_2: f32, %w2: f32):
+      %delta = arith.subf %mean2, %mean1 : f32
+      %w = arith.addf %w1, %w2 : f32
+      %ratio = arith.divf %w2, %w : f32
+      %1 = arith.mulf %delta, %ratio : f32
+      %mean3 = arith.addf %mean1, %1 : f32
+      %2 = arith.mulf %delta, %delta : f32
+      %3 = arith.mulf %2, %w1 : f32
+      %4 = arith.mulf %3, %ratio : f32
+      %5 = arith.addf %m2_1, %m2_2 : f32
+      %m2_3 = arith.addf %5, %4 : f32
+      tt.reduce.return %mean3, %m2_3, %w : f32, f32, f32
+    }) : (tensor<32xf32, #blocked>, tensor<32xf32, #blocked>, tensor<32xf32, #blocked>) -> (f32, f32, f32)
+    tt.return %0#0, %0#1, %0#2 : f32, f32, f32
+  }
+}
+
+// -----
+
+// The two rows of each thread are reduced with one shuffle per step.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: reduce_f16_packed_shuffles
+  tt.func @reduce_f16_packed_shuffles(%arg0: tensor<2x32xf16, #blocked>) -> tensor<2xf16, #triton_gpu.slice<{dim = 1, parent = #blocked}>> {
+    // CHECK-COUNT-5: nvvm.shfl.sync bfly
+    // CHECK-NOT: nvvm.shfl.sync
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f16, %arg2: f16):
+      %1 = arith.addf %arg1, %arg2 : f16
+      tt.reduce.return %1 : f16
+    }) : (tensor<2x32xf16, #blocked>) -> tensor<2xf16, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return %0 : tensor<2xf16, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+  }
+}
+
 // -----
 #blocked = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 2], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
 #slice = #triton_gpu.slice<{dim = 1, parent = #blocked}>
@@ -1478,8 +1656,8 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
 //  CHECK-LABEL: reduce_md_slice
 //  CHECK: st.shared
 //  CHECK: st.shared
-//  CHECK: ld.shared
-//  CHECK: st.shared
+//  CHECK: nvvm.barrier0
+//  CHECK-NOT: st.shared
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 1, 1], threadsPerWarp = [1, 1, 32], warpsPerCTA = [1, 2, 2], order = [2, 1, 0]}>
 #sliced = #triton_gpu.slice<{dim = 2, parent = #blocked}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:80", "triton_gpu.threads-per-warp" = 32 : i32} {
@@ -1577,6 +1755,22 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
 
 // -----
 
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [2, 4], threadsPerWarp = [32, 1], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The two rows of each thread are contiguous in shared memory.
+  // CHECK-LABEL: @vectorize_shmem_store_across_rows
+  // CHECK: llvm.store
+  // CHECK-SAME: {alignment = 16 : i64} : vector<8xf16>, !llvm.ptr<3>
+  // CHECK-NOT: llvm.store
+  tt.func public @vectorize_shmem_store_across_rows(%block : tensor<64x4xf16, #blocked>) {
+    %0 = triton_gpu.local_alloc %block : (tensor<64x4xf16, #blocked>) -> !tt.memdesc<64x4xf16, #shared, #triton_gpu.shared_memory>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: abs_is_int_min_poison
@@ -1643,3 +1837,236 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0], CTAsPerCGA = [1, 2], CTASplitNum = [1, 2], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_across_cluster
+  tt.func @reduce_across_cluster(%arg0: tensor<1x1024xf32, #blocked>) {
+    // CHECK: nvvm.barrier0
+    // CHECK: nvgpu.cluster_id
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK-NEXT: nvgpu.cluster_wait
+    // CHECK-COUNT-2: mapa.shared::cluster.u32
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK-NEXT: nvgpu.cluster_wait
+    %0 = "tt.reduce"(%arg0) <{axis = 1 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) : (tensor<1x1024xf32, #blocked>) -> tensor<1xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: cluster_reduce
+  tt.func @cluster_reduce(%arg0: tensor<256xf32, #blocked>) -> tensor<256xf32, #blocked> {
+    // CHECK-COUNT-2: st.shared.b32
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK-NEXT: nvgpu.cluster_wait
+    // CHECK-COUNT-8: mapa.shared::cluster.u32
+    // CHECK: nvgpu.cluster_arrive
+    // CHECK-NEXT: nvgpu.cluster_wait
+    %0 = tt.cluster_reduce add, %arg0 {cluster_size = 4 : i32} : tensor<256xf32, #blocked>
+    tt.return %0 : tensor<256xf32, #blocked>
+  }
+
+  // CHECK-LABEL: cluster_reduce_single
+  // CHECK-NOT: nvgpu.cluster_arrive
+  // CHECK: llvm.return
+  tt.func @cluster_reduce_single(%arg0: tensor<256xf32, #blocked>) -> tensor<256xf32, #blocked> {
+    %0 = tt.cluster_reduce max, %arg0 {cluster_size = 1 : i32} : tensor<256xf32, #blocked>
+    tt.return %0 : tensor<256xf32, #blocked>
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: grid_sync
+  tt.func @grid_sync(%arg0: !tt.ptr<i32>) {
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.cond_br %{{.*}}, ^[[ARRIVE:.*]], ^[[END:.*]]
+    // CHECK: ^[[ARRIVE]]:
+    // CHECK-COUNT-3: %nctaid
+    // CHECK: atom.release.gpu.global.add.u32
+    // CHECK: llvm.udiv
+    // CHECK: llvm.br ^[[SPIN:.*]](%{{.*}} : i32)
+    // CHECK: ^[[SPIN]](%[[TARGET:.*]]: i32):
+    // CHECK: ld.acquire.gpu.global.u32
+    // CHECK: %[[LT:.*]] = llvm.icmp "ult" %{{.*}}, %[[TARGET]]
+    // CHECK: llvm.cond_br %[[LT]], ^[[SPIN]](%[[TARGET]] : i32), ^[[END]]
+    // CHECK: ^[[END]]:
+    // CHECK-NEXT: nvvm.barrier0
+    tt.grid_sync %arg0 : !tt.ptr<i32>
+    tt.return
+  }
+
+  // CHECK-LABEL: signal_wait
+  tt.func @signal_wait(%arg0: !tt.ptr<i32>, %arg1: i32) {
+    // CHECK: llvm.cond_br %{{.*}}, ^[[SPIN:.*]], ^[[END:.*]]
+    // CHECK: ^[[SPIN]]:
+    // CHECK: ld.acquire.sys.global.u32
+    // CHECK: %[[DONE:.*]] = llvm.icmp "uge"
+    // CHECK: llvm.cond_br %[[DONE]], ^[[END]], ^[[SPIN]]
+    // CHECK: ^[[END]]:
+    // CHECK-NEXT: nvvm.barrier0
+    tt.signal_wait ge, sys, %arg0, %arg1 : !tt.ptr<i32>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // With 1024 bins every lane would own 32 bins of the ballot based histogram,
+  // so lanes hitting the same bin are grouped and their leader adds the count.
+  // CHECK-LABEL: histogram_warp_aggregated
+  tt.func @histogram_warp_aggregated(%arg0: tensor<4096xi32, #blocked>) {
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-10: nvvm.vote.ballot.sync
+    // CHECK: llvm.intr.ctpop
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.atomicrmw add {{.*}} monotonic
+    // CHECK: nvvm.barrier0
+    %0 = tt.histogram %arg0 : tensor<4096xi32, #blocked> -> tensor<1024xi32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The first bit of the position is in registers, the next five in lanes and
+  // the last two in warps.
+  // CHECK-LABEL: sort_across_warps
+  tt.func @sort_across_warps(%arg0: tensor<256xf32, #blocked>, %arg1: tensor<256xi32, #blocked>) -> (tensor<256xf32, #blocked>, tensor<256xi32, #blocked>) {
+    // CHECK: llvm.fcmp "olt"
+    // CHECK: nvvm.shfl.sync bfly
+    // CHECK: llvm.store {{.*}} : f32, !llvm.ptr<3>
+    // CHECK: llvm.store {{.*}} : i32, !llvm.ptr<3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<3> -> f32
+    // CHECK: nvvm.barrier0
+    %0:2 = tt.sort %arg0, %arg1 {descending = true} : tensor<256xf32, #blocked>, tensor<256xi32, #blocked>
+    tt.return %0#0, %0#1 : tensor<256xf32, #blocked>, tensor<256xi32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // Rows held by single warps are sorted without shared memory.
+  // CHECK-LABEL: sort_within_warps
+  tt.func @sort_within_warps(%arg0: tensor<4x128xi32, #blocked>) -> tensor<4x128xi32, #blocked> {
+    // CHECK: llvm.icmp "slt"
+    // CHECK: nvvm.shfl.sync bfly
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = tt.sort %arg0 {descending = false} : tensor<4x128xi32, #blocked>
+    tt.return %0 : tensor<4x128xi32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // The gathered axis of the source is spread over the lanes of a warp, so
+  // each index picks the lane to read from.
+  // CHECK-LABEL: gather_within_warps
+  tt.func @gather_within_warps(%arg0: tensor<4x32xf32, #blocked>, %arg1: tensor<4x64xi32, #blocked1>) -> tensor<4x64xf32, #blocked1> {
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = tt.gather %arg0[%arg1] {axis = 1 : i32} : (tensor<4x32xf32, #blocked>, tensor<4x64xi32, #blocked1>) -> tensor<4x64xf32, #blocked1>
+    tt.return %0 : tensor<4x64xf32, #blocked1>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // Elements of the gathered axis are in registers, so the source is staged
+  // in shared memory.
+  // CHECK-LABEL: gather_in_shared
+  tt.func @gather_in_shared(%arg0: tensor<4x128xi1, #blocked>, %arg1: tensor<4x128xi64, #blocked>) -> tensor<4x128xi1, #blocked> {
+    // CHECK: llvm.trunc {{.*}} : i64 to i32
+    // CHECK: llvm.store {{.*}} : i8, !llvm.ptr<3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<3> -> i8
+    // CHECK-NOT: nvvm.shfl.sync
+    %0 = tt.gather %arg0[%arg1] {axis = 1 : i32} : (tensor<4x128xi1, #blocked>, tensor<4x128xi64, #blocked>) -> tensor<4x128xi1, #blocked>
+    tt.return %0 : tensor<4x128xi1, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: packed_half_arith
+  tt.func @packed_half_arith(%arg0: tensor<256xf16, #blocked>, %arg1: tensor<256xbf16, #blocked>) -> (tensor<256xf16, #blocked>, tensor<256xbf16, #blocked>) {
+    // CHECK: llvm.fadd %{{.*}}, %{{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fadd
+    %0 = arith.addf %arg0, %arg0 : tensor<256xf16, #blocked>
+    // CHECK: fma.rn.bf16x2 $0, $1, $2, c;
+    // CHECK-NOT: fma.rn.bf16
+    %1 = arith.mulf %arg1, %arg1 : tensor<256xbf16, #blocked>
+    tt.return %0, %1 : tensor<256xf16, #blocked>, tensor<256xbf16, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], instrShape = [16, 8]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: sparse_dot
+  tt.func @sparse_dot(%A: tensor<16x32xf16, #dot_operand_a>, %B: tensor<64x16xf16, #dot_operand_b>, %C: tensor<16x16xf32, #mma>, %meta: tensor<16x4xi16, #blocked>) -> tensor<16x16xf32, #mma> {
+    %M = triton_gpu.local_alloc %meta : (tensor<16x4xi16, #blocked>) -> !tt.memdesc<16x4xi16, #shared, #triton_gpu.shared_memory>
+    // Each K chunk of 32 loads the metadata of rows lane / 4 and lane / 4 + 8
+    // once for the two instructions of N.
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i16
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i16
+    // CHECK-COUNT-2: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i16
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<3> -> i16
+    // CHECK-COUNT-2: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK-NOT: mma.sp
+    %D = triton_gpu.sparse_dot %A, %B, %C, %M : tensor<16x32xf16, #dot_operand_a> meta !tt.memdesc<16x4xi16, #shared, #triton_gpu.shared_memory> * tensor<64x16xf16, #dot_operand_b> -> tensor<16x16xf32, #mma>
+    tt.return %D : tensor<16x16xf32, #mma>
+  }
+}
+
+// -----
+
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0, 1]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: local_load_ldmatrix
+  tt.func @local_load_ldmatrix(%arg0: !tt.memdesc<16x16xf16, #shared, #triton_gpu.shared_memory>, %arg1: !tt.memdesc<16x16xf16, #shared1, #triton_gpu.shared_memory>) {
+    // CHECK: ldmatrix.sync.aligned.m8n8.x4.shared.b16
+    // CHECK-NOT: llvm.load
+    %0 = triton_gpu.local_load %arg0 : !tt.memdesc<16x16xf16, #shared, #triton_gpu.shared_memory> -> tensor<16x16xf16, #mma>
+    // CHECK: ldmatrix.sync.aligned.m8n8.x4.trans.shared.b16
+    // CHECK-NOT: llvm.load
+    %1 = triton_gpu.local_load %arg1 : !tt.memdesc<16x16xf16, #shared1, #triton_gpu.shared_memory> -> tensor<16x16xf16, #mma>
+    tt.return
+  }
+}
@@ -0,0 +1,26 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="binary-prints=true" | FileCheck %s
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="binary-prints=true binary-print-records=1024" | FileCheck %s --check-prefix=SMALL
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK: module attributes {{.*}}tt.device_prints = "[{\22hex\22:false,\22operands\22:[{\22shape\22:[128],\22type\22:\22i32\22}],\22prefix\22:\22 x: \22},{\22hex\22:false,\22operands\22:[],\22prefix\22:\22 done\22}]"
+// CHECK: llvm.mlir.global external @triton_print_ring() {addr_space = 1 : i32, alignment = 16 : i64} : !llvm.struct<(i32, array<65536 x array<8 x i32>>)>
+// CHECK-NEXT: llvm.mlir.zero
+// SMALL: llvm.mlir.global external @triton_print_ring() {{.*}} : !llvm.struct<(i32, array<1024 x array<8 x i32>>)>
+// SMALL: llvm.mlir.constant(1023 : i32)
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: @binary_prints
+  // CHECK-NOT: vprintf
+  // CHECK: %[[FIRST:.*]] = llvm.atomicrmw add %{{.*}}, %{{.*}} monotonic : !llvm.ptr<1>, i32
+  // CHECK: %[[NEXT:.*]] = llvm.add %[[FIRST]], %{{.*}} : i32
+  // CHECK: %[[SLOT:.*]] = llvm.and %[[NEXT]], %{{.*}} : i32
+  // CHECK: %[[FIELD:.*]] = llvm.getelementptr %{{.*}}[0, 1, %[[SLOT]], 0]
+  // CHECK: llvm.store %{{.*}}, %[[FIELD]]
+  // CHECK: llvm.getelementptr %{{.*}}[0, 1, %[[SLOT]], 7]
+  // CHECK: llvm.atomicrmw add
+  // CHECK-NOT: vprintf
+  tt.func public @binary_prints(%x: tensor<128xi32, #blocked>) {
+    tt.print " x: " {hex = false} : %x : tensor<128xi32, #blocked>
+    tt.print " done" {hex = false}
+    tt.return
+  }
+}
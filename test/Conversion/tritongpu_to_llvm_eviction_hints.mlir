@@ -0,0 +1,22 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=80 l2-eviction-hints=true" | FileCheck %s
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=80" | FileCheck %s --check-prefix=NOHINT
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0], CTAsPerCGA = [1], CTASplitNum = [1], CTAOrder = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: load_with_l2_evict_policy
+  // NOHINT-LABEL: load_with_l2_evict_policy
+  tt.func @load_with_l2_evict_policy(%a_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>) {
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: createpolicy.fractional.L2::evict_first.b64 $0, 1.0;
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.global.L1::evict_first.L2::cache_hint.b32
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.global.L1::evict_first.L2::cache_hint.b32
+    // NOHINT-NOT: createpolicy
+    // NOHINT-NOT: L2::cache_hint
+    //     NOHINT: ld.global.L1::evict_first.b32
+    // NOHINT-NOT: L2::cache_hint
+    %0 = tt.load %a_ptr_init evictionPolicy = evict_first : tensor<256x!tt.ptr<f32>, #blocked0>
+    tt.return
+  }
+}
@@ -0,0 +1,37 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=90 fast-math=true" 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_f32
+  tt.func @fast_math_f32(%arg0: tensor<128xf32, #blocked>, %arg1: tensor<128xf32, #blocked>) -> (tensor<128xf32, #blocked>, tensor<128xf32, #blocked>, tensor<128xf32, #blocked>, tensor<128xf32, #blocked>) {
+    // CHECK: %[[LOG2E:.*]] = llvm.mlir.constant(1.44269502 : f32) : f32
+    // CHECK: llvm.fmul %{{.*}}, %[[LOG2E]]
+    // CHECK: ex2.approx.ftz.f32 $0, $1;
+    %0 = math.exp %arg0 : tensor<128xf32, #blocked>
+    // CHECK: lg2.approx.ftz.f32 $0, $1;
+    // CHECK: %[[LN2:.*]] = llvm.mlir.constant(0.693147182 : f32) : f32
+    // CHECK: llvm.fmul %{{.*}}, %[[LN2]]
+    %1 = math.log %arg0 : tensor<128xf32, #blocked>
+    // CHECK: rsqrt.approx.ftz.f32 $0, $1;
+    %2 = math.rsqrt %arg0 : tensor<128xf32, #blocked>
+    // CHECK: div.approx.ftz.f32 $0, $1, $2;
+    %3 = arith.divf %arg0, %arg1 : tensor<128xf32, #blocked>
+    tt.return %0, %1, %2, %3 : tensor<128xf32, #blocked>, tensor<128xf32, #blocked>, tensor<128xf32, #blocked>, tensor<128xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_exp2_packed
+  tt.func @fast_exp2_packed(%arg0: tensor<256xf16, #blocked>, %arg1: tensor<256xbf16, #blocked>) -> (tensor<256xf16, #blocked>, tensor<256xbf16, #blocked>) {
+    // CHECK: ex2.approx.f16x2 $0, $1;
+    // CHECK-NOT: ex2.approx.f16x2
+    %0 = math.exp2 %arg0 : tensor<256xf16, #blocked>
+    // CHECK: ex2.approx.ftz.bf16x2 $0, $1;
+    // CHECK-NOT: ex2.approx.ftz.bf16x2
+    %1 = math.exp2 %arg1 : tensor<256xbf16, #blocked>
+    tt.return %0, %1 : tensor<256xf16, #blocked>, tensor<256xbf16, #blocked>
+  }
+}
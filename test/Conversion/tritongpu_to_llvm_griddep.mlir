@@ -0,0 +1,16 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm=compute-capability=90 | FileCheck %s --check-prefix=SM90
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm=compute-capability=80 | FileCheck %s --check-prefix=SM80
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // SM90-LABEL: griddep_control
+  // SM90: griddepcontrol.wait;
+  // SM90: griddepcontrol.launch_dependents;
+  // SM80-LABEL: griddep_control
+  // SM80-NOT: griddepcontrol
+  // SM80: llvm.return
+  tt.func public @griddep_control() {
+    tt.griddep_wait
+    tt.griddep_launch_dependents
+    tt.return
+  }
+}
@@ -106,6 +106,20 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
 
 // -----
 
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 16, 16]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: @dot_wait_reg_operand_A
+  // The fp16 lhs is waited on in i32s.
+  // CHECK: nvgpu.wgmma_wait_group %{{.*}} {pendings = 0 : i32} : !llvm.struct<(f32, f32, f32, f32, f32, f32, f32, f32, i32, i32, i32, i32)>
+  // CHECK-COUNT-4: llvm.bitcast %{{.*}} : i32 to vector<2xf16>
+  tt.func @dot_wait_reg_operand_A(%c: tensor<64x16xf32, #mma>, %a: tensor<64x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>) {
+    %r:2 = triton_nvidia_gpu.warp_group_dot_wait %c, %a {pendings = 0 : i32} : tensor<64x16xf32, #mma>, tensor<64x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+    tt.return
+  }
+}
+
+// -----
+
 #mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 128, 32]}>
 #mma1 = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 256, 32]}>
 #shared = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
@@ -147,6 +161,11 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     %out5 = tt.fp_to_fp %in3, rounding = rtne : tensor<128xf32, #blocked> -> tensor<128xf8E5M2, #blocked>
     // CHECK-COUNT-2: cvt.rn.satfinite.e4m3x2.f32 {{.*}} "=h,r,r" %{{.*}}, %{{.*}} : (i32, i32) -> vector<2xi8>
     %out6 = tt.fp_to_fp %in3, rounding = rtne : tensor<128xf32, #blocked> -> tensor<128xf8E4M3FNUZ, #blocked>
+
+    // CHECK-COUNT-2: cvt.rn.f16x2.e4m3x2 a, $1;{{.*}}cvt.rn.satfinite.e5m2x2.f16x2 $0, a;{{.*}} "=h,h" %{{.*}} : (i16) -> vector<2xi8>
+    %out7 = tt.fp_to_fp %in1, rounding = rtne : tensor<128xf8E4M3FNUZ, #blocked> -> tensor<128xf8E5M2, #blocked>
+    // CHECK-COUNT-2: cvt.rn.f16x2.e5m2x2 a, $1;{{.*}}cvt.rn.satfinite.e4m3x2.f16x2 $0, a;{{.*}} "=h,h" %{{.*}} : (i16) -> vector<2xi8>
+    %out8 = tt.fp_to_fp %in0, rounding = rtne : tensor<128xf8E5M2, #blocked> -> tensor<128xf8E4M3FNUZ, #blocked>
     tt.return
   }
 }
@@ -228,3 +247,46 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: vectorized_reduce_add
+  tt.func @vectorized_reduce_add(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: tensor<512xf32, #blocked0>) {
+    // CHECK: @$5 red.global.gpu.relaxed.add.v4.f32
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked0>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    %3 = tt.atomic_rmw fadd, relaxed, gpu, %2, %arg1 : (tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xf32, #blocked0>) -> tensor<512xf32, #blocked0>
+    tt.return
+  }
+
+  // CHECK-LABEL: vectorized_atomic_add_f16
+  tt.func @vectorized_atomic_add_f16(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: tensor<1024xf16, #blocked1>) {
+    // CHECK: @$9 atom.global.gpu.relaxed.add.noftz.v4.f16x2
+    // CHECK-COUNT-4: llvm.extractvalue
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked1>
+    %1 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<1024x!tt.ptr<f16>, #blocked1>
+    %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f16>, #blocked1>, tensor<1024xi32, #blocked1>
+    %3 = tt.atomic_rmw fadd, relaxed, gpu, %2, %arg1 : (tensor<1024x!tt.ptr<f16>, #blocked1>, tensor<1024xf16, #blocked1>) -> tensor<1024xf16, #blocked1>
+    tt.store %2, %3 : tensor<1024x!tt.ptr<f16>, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [1, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: local_store_stmatrix
+  tt.func @local_store_stmatrix(%arg0: tensor<16x16xf16, #mma>) {
+    %0 = triton_gpu.local_alloc {allocation.offset = 0 : i32} : () -> !tt.memdesc<16x16xf16, #shared, #triton_gpu.shared_memory, mutable>
+    // CHECK: nvgpu.stmatrix
+    // CHECK-NOT: llvm.store
+    triton_gpu.local_store %arg0, %0 : tensor<16x16xf16, #mma> -> !tt.memdesc<16x16xf16, #shared, #triton_gpu.shared_memory, mutable>
+    tt.return
+  }
+}
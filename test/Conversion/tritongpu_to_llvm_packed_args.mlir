@@ -0,0 +1,31 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=90 pack-kernel-args=true" | FileCheck %s
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: llvm.func @packed_args
+  // CHECK-SAME: (%[[PARAMS:.*]]: !llvm.ptr {llvm.align = 64 : i64, llvm.byval = !llvm.struct<packed (ptr<1>, i1, array<3 x i8>, i32, array<48 x i8>, array<128 x i8>, i64)>, nvvm.grid_constant})
+  // CHECK: %[[PTR_FIELD:.*]] = llvm.getelementptr %[[PARAMS]][0, 0]
+  // CHECK: llvm.load %[[PTR_FIELD]] {alignment = 8 : i64} : !llvm.ptr -> !llvm.ptr<1>
+  // CHECK: %[[I1_FIELD:.*]] = llvm.getelementptr %[[PARAMS]][0, 1]
+  // CHECK: llvm.load %[[I1_FIELD]] {alignment = 1 : i64} : !llvm.ptr -> i1
+  // CHECK: %[[I32_FIELD:.*]] = llvm.getelementptr %[[PARAMS]][0, 3]
+  // CHECK: llvm.load %[[I32_FIELD]] {alignment = 4 : i64} : !llvm.ptr -> i32
+  // CHECK: %[[DESC_FIELD:.*]] = llvm.getelementptr %[[PARAMS]][0, 5]
+  // CHECK: %[[DESC_ADDR:.*]] = llvm.ptrtoint %[[DESC_FIELD]] : !llvm.ptr to i64
+  // CHECK: llvm.inttoptr %[[DESC_ADDR]] : i64 to !llvm.ptr<1>
+  // CHECK: %[[I64_FIELD:.*]] = llvm.getelementptr %[[PARAMS]][0, 6]
+  // CHECK: llvm.load %[[I64_FIELD]] {alignment = 8 : i64} : !llvm.ptr -> i64
+  tt.func public @packed_args(%arg0: !tt.ptr<f32>, %arg1: i1, %arg2: i32, %arg3: !tt.ptr<i8> {tt.nv_tma_desc}, %arg4: i64) {
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // Only kernels are packed
+  // CHECK-LABEL: llvm.func internal @device_fn
+  // CHECK-SAME: (%{{.*}}: i32, %{{.*}}: !llvm.ptr<3>)
+  tt.func private @device_fn(%arg0: i32) {
+    tt.return
+  }
+}
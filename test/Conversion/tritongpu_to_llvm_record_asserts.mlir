@@ -0,0 +1,38 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="record-asserts=true" | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK: module attributes {{.*}}tt.device_asserts = "[{\22file\22:\22test.py\22,\22func\22:\22kernel\22,\22line\22:12,\22message\22:\22x > 0\22},{\22file\22:\22test.py\22,\22func\22:\22kernel\22,\22line\22:14,\22message\22:\22x < 8\22}]"
+// CHECK: llvm.mlir.global external @triton_assert_failures() {addr_space = 1 : i32, alignment = 16 : i64} : !llvm.struct<(i32, array<16 x array<5 x i32>>)>
+// CHECK-NEXT: llvm.mlir.zero
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: @record_asserts
+  // CHECK-NOT: __assertfail
+  // CHECK: llvm.cond_br %{{.*}} weights([1, 2000]), ^[[FAILED:bb[0-9]+]], ^[[CONTINUE:bb[0-9]+]]
+  // CHECK: ^[[FAILED]]:
+  // CHECK: %[[SLOT:.*]] = llvm.atomicrmw add %{{.*}}, %{{.*}} monotonic : !llvm.ptr<1>, i32
+  // CHECK: %[[RECORDED:.*]] = llvm.icmp "ult" %[[SLOT]], %{{.*}} : i32
+  // CHECK: llvm.cond_br %[[RECORDED]], ^[[RECORD:bb[0-9]+]], ^[[CONTINUE]]
+  // CHECK: ^[[RECORD]]:
+  // CHECK: %[[ID:.*]] = llvm.mlir.constant(0 : i32) : i32
+  // CHECK: mov.u32 $0, %ctaid.x;
+  // CHECK: mov.u32 $0, %ctaid.y;
+  // CHECK: mov.u32 $0, %ctaid.z;
+  // CHECK: %[[FIELD:.*]] = llvm.getelementptr %{{.*}}[0, 1, %[[SLOT]], 0]
+  // CHECK: llvm.store %[[ID]], %[[FIELD]]
+  // CHECK: %[[INDEX_FIELD:.*]] = llvm.getelementptr %{{.*}}[0, 1, %[[SLOT]], 4]
+  // CHECK: llvm.store %{{.*}}, %[[INDEX_FIELD]]
+  // CHECK: llvm.br ^[[CONTINUE]]
+  // CHECK: ^[[CONTINUE]]:
+  // CHECK: llvm.atomicrmw add
+  // CHECK: llvm.mlir.constant(1 : i32) : i32
+  // CHECK-NOT: __assertfail
+  tt.func public @record_asserts(%x: tensor<128xi32, #blocked>) {
+    %c0 = arith.constant dense<0> : tensor<128xi32, #blocked>
+    %c8 = arith.constant dense<8> : tensor<128xi32, #blocked>
+    %0 = arith.cmpi sgt, %x, %c0 : tensor<128xi32, #blocked>
+    tt.assert %0, "x > 0", "test.py", "kernel", 12 : tensor<128xi1, #blocked>
+    %1 = arith.cmpi slt, %x, %c8 : tensor<128xi32, #blocked>
+    tt.assert %1, "x < 8", "test.py", "kernel", 14 : tensor<128xi1, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=100 ptx-version=87 arch-specific=true" 2>&1 | FileCheck %s --check-prefix=CVT
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=100 ptx-version=87" 2>&1 | FileCheck %s --check-prefix=SOFT
+// RUN: triton-opt %s -split-input-file --allocate-shared-memory --convert-triton-gpu-to-llvm="compute-capability=100 ptx-version=86 arch-specific=true" 2>&1 | FileCheck %s --check-prefix=SOFT
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CVT-LABEL: stochastic_rounding_f32_to_f16
+  // SOFT-LABEL: stochastic_rounding_f32_to_f16
+  tt.func public @stochastic_rounding_f32_to_f16(%in: tensor<256xf32, #blocked>, %rbits: tensor<256xi32, #blocked>) {
+    // CVT: cvt.rs.f16x2.f32 {{.*}} "=r,r,r,r"
+    // CVT-NOT: cvt.rn.f16.f32
+    // SOFT-NOT: cvt.rs
+    // SOFT: llvm.add
+    // SOFT: llvm.and
+    // SOFT: cvt.rn.f16.f32
+    // SOFT: cvt.rn.f16.f32
+    %out = tt.fp_to_fp %in, rbits = %rbits : tensor<256xi32, #blocked>, rounding = rs : tensor<256xf32, #blocked> -> tensor<256xf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CVT-LABEL: stochastic_rounding_f32_to_bf16
+  // SOFT-LABEL: stochastic_rounding_f32_to_bf16
+  tt.func public @stochastic_rounding_f32_to_bf16(%in: tensor<256xf32, #blocked>, %rbits: tensor<256xi32, #blocked>) {
+    // CVT: cvt.rs.bf16x2.f32 {{.*}} "=r,r,r,r"
+    // SOFT-NOT: cvt.rs
+    // SOFT: llvm.add
+    // SOFT: llvm.and
+    %out = tt.fp_to_fp %in, rbits = %rbits : tensor<256xi32, #blocked>, rounding = rs : tensor<256xf32, #blocked> -> tensor<256xbf16, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,21 @@
+// RUN: triton-opt %s --enable-line-info --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s
+// RUN: triton-opt %s --enable-line-info=inlined-scopes=false --mlir-print-debuginfo --mlir-print-local-scope | FileCheck %s --check-prefix=LINES
+
+// CHECK-LABEL: llvm.func @kernel
+// CHECK: llvm.add {{.*}}callsite(fused<#llvm.di_lexical_block_file<{{.*}}"helper.py"{{.*}}>>["helper.py":3:4] at "kernel.py":10:2)
+// CHECK: llvm.return {{.*}}loc("kernel.py":11:2)
+// CHECK: di_subprogram
+
+// The operations inlined from helper.py take the line of the call
+// LINES-LABEL: llvm.func @kernel
+// LINES-NOT: di_lexical_block_file
+// LINES: llvm.add %arg0, %arg0 : i32 loc("kernel.py":10:2)
+// LINES: llvm.return {{.*}}loc("kernel.py":11:2)
+// LINES: di_subprogram
+
+module {
+  llvm.func @kernel(%arg0: i32) -> i32 {
+    %0 = llvm.add %arg0, %arg0 : i32 loc(callsite("helper.py":3:4 at "kernel.py":10:2))
+    llvm.return %0 : i32 loc("kernel.py":11:2)
+  } loc("kernel.py":8:0)
+}
@@ -0,0 +1,82 @@
+; RUN: triton-llvm-opt -scalarize-structs %s | FileCheck %s
+
+; The loop carries the elements, the structs built in its body are removed.
+; CHECK-LABEL: @loop(
+define float @loop(float %x, i32 %n) {
+entry:
+  br label %loop
+
+; CHECK: loop:
+; CHECK-NEXT: %i = phi i32
+; CHECK-NEXT: %acc.elt0 = phi float [ 0.000000e+00, %entry ], [ %a.next, %loop ]
+; CHECK-NEXT: %acc.elt1 = phi float [ 1.000000e+00, %entry ], [ %b.next, %loop ]
+; CHECK-NEXT: %a.next = fadd float %acc.elt0, %x
+; CHECK-NEXT: %b.next = fmul float %acc.elt1, %x
+; CHECK-NOT: insertvalue
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi { float, float } [ { float 0.0, float 1.0 }, %entry ], [ %acc.next, %loop ]
+  %a = extractvalue { float, float } %acc, 0
+  %b = extractvalue { float, float } %acc, 1
+  %a.next = fadd float %a, %x
+  %b.next = fmul float %b, %x
+  %s = insertvalue { float, float } undef, float %a.next, 0
+  %acc.next = insertvalue { float, float } %s, float %b.next, 1
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+; CHECK: exit:
+; CHECK-NEXT: %r.elt0 = phi float [ %a.next, %loop ]
+; CHECK-NEXT: %r.elt1 = phi float [ %b.next, %loop ]
+; CHECK-NEXT: %sum = fadd float %r.elt0, %r.elt1
+; CHECK-NEXT: ret float %sum
+exit:
+  %r = phi { float, float } [ %acc.next, %loop ]
+  %r0 = extractvalue { float, float } %r, 0
+  %r1 = extractvalue { float, float } %r, 1
+  %sum = fadd float %r0, %r1
+  ret float %sum
+}
+
+; CHECK-LABEL: @select(
+; CHECK-NEXT: %sel.elt0 = select i1 %c, i32 %x, i32 %y
+; CHECK-NEXT: %sel.elt1 = select i1 %c, i32 %y, i32 %x
+; CHECK-NEXT: %r = sub i32 %sel.elt0, %sel.elt1
+; CHECK-NEXT: ret i32 %r
+define i32 @select(i1 %c, i32 %x, i32 %y) {
+  %s0 = insertvalue { i32, i32 } undef, i32 %x, 0
+  %s1 = insertvalue { i32, i32 } %s0, i32 %y, 1
+  %t0 = insertvalue { i32, i32 } undef, i32 %y, 0
+  %t1 = insertvalue { i32, i32 } %t0, i32 %x, 1
+  %sel = select i1 %c, { i32, i32 } %s1, { i32, i32 } %t1
+  %e0 = extractvalue { i32, i32 } %sel, 0
+  %e1 = extractvalue { i32, i32 } %sel, 1
+  %r = sub i32 %e0, %e1
+  ret i32 %r
+}
+
+; Nested structs are split into their innermost elements, and the struct is
+; rebuilt for the users that take it as a whole.
+; CHECK-LABEL: @nested(
+; CHECK: entry:
+; CHECK-DAG: [[A0:%.*]] = extractvalue { { i32, i32 }, i32 } %a, 0, 0
+; CHECK-DAG: [[A1:%.*]] = extractvalue { { i32, i32 }, i32 } %a, 0, 1
+; CHECK-DAG: [[A2:%.*]] = extractvalue { { i32, i32 }, i32 } %a, 1
+; CHECK: exit:
+; CHECK-NEXT: %r.elt0.elt0 = phi i32 [ [[A0]], %entry ], [ 1, %true ]
+; CHECK-NEXT: %r.elt0.elt1 = phi i32 [ [[A1]], %entry ], [ 2, %true ]
+; CHECK-NEXT: %r.elt1 = phi i32 [ [[A2]], %entry ], [ 3, %true ]
+; CHECK-NOT: phi
+; CHECK: ret { { i32, i32 }, i32 }
+define { { i32, i32 }, i32 } @nested(i1 %c, { { i32, i32 }, i32 } %a) {
+entry:
+  br i1 %c, label %true, label %exit
+
+true:
+  br label %exit
+
+exit:
+  %r = phi { { i32, i32 }, i32 } [ %a, %entry ], [ { { i32, i32 } { i32 1, i32 2 }, i32 3 }, %true ]
+  ret { { i32, i32 }, i32 } %r
+}
@@ -355,3 +355,103 @@ tt.func @test_nested_transpose(%arg0: tensor<2x4x8xf32>) -> (tensor<8x2x4xf32>)
     // CHECK: tt.return %[[res]]
     tt.return %b : tensor<8x2x4xf32>
 }
+
+// CHECK-LABEL: @test_combine_trunc_ext_loop_carried
+tt.func @test_combine_trunc_ext_loop_carried(%a: tensor<32x32xf16>, %b: tensor<32x32xf16>, %lb: index, %ub: index, %step: index) -> tensor<32x32xf32> {
+    // CHECK: %[[init:.*]] = arith.constant dense<0.000000e+00> : tensor<32x32xf16>
+    %init = arith.constant dense<0.0> : tensor<32x32xf32>
+    // CHECK: %[[loop:.*]] = scf.for {{.*}} iter_args(%[[acc:.*]] = %[[init]]) -> (tensor<32x32xf16>)
+    %res = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<32x32xf32>) {
+        // CHECK-NOT: arith.truncf
+        // CHECK: %[[d:.*]] = tt.dot %{{.*}}, %{{.*}}, %[[acc]] : tensor<32x32xf16> * tensor<32x32xf16> -> tensor<32x32xf16>
+        // CHECK-NEXT: scf.yield %[[d]]
+        %c = arith.truncf %acc : tensor<32x32xf32> to tensor<32x32xf16>
+        %d = tt.dot %a, %b, %c : tensor<32x32xf16> * tensor<32x32xf16> -> tensor<32x32xf16>
+        %e = arith.extf %d : tensor<32x32xf16> to tensor<32x32xf32>
+        scf.yield %e : tensor<32x32xf32>
+    }
+    // CHECK: %[[res:.*]] = arith.extf %[[loop]] : tensor<32x32xf16> to tensor<32x32xf32>
+    // CHECK: tt.return %[[res]]
+    tt.return %res : tensor<32x32xf32>
+}
+
+// The init isn't exact in fp16, and is the result of loops without iterations.
+// CHECK-LABEL: @test_combine_trunc_ext_loop_carried_inexact_init
+tt.func @test_combine_trunc_ext_loop_carried_inexact_init(%a: tensor<32x32xf16>, %b: tensor<32x32xf16>, %lb: index, %ub: index, %step: index) -> tensor<32x32xf32> {
+    %init = arith.constant dense<0.1> : tensor<32x32xf32>
+    // CHECK: scf.for {{.*}} -> (tensor<32x32xf32>)
+    %res = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<32x32xf32>) {
+        %c = arith.truncf %acc : tensor<32x32xf32> to tensor<32x32xf16>
+        %d = tt.dot %a, %b, %c : tensor<32x32xf16> * tensor<32x32xf16> -> tensor<32x32xf16>
+        %e = arith.extf %d : tensor<32x32xf16> to tensor<32x32xf32>
+        scf.yield %e : tensor<32x32xf32>
+    }
+    tt.return %res : tensor<32x32xf32>
+}
+
+// CHECK-LABEL: @test_combine_reduce_broadcast
+tt.func @test_combine_reduce_broadcast(%arg0: tensor<1x32xf32>, %arg1: tensor<1x32xi32>, %arg2: tensor<32xf32>) -> (tensor<32xf32>, tensor<32xi32>, tensor<32xf32>) {
+    // CHECK-DAG: %[[cst:.*]] = arith.constant dense<1.600000e+01> : tensor<32xf32>
+    // CHECK-DAG: %[[x:.*]] = tt.reshape %arg0 {allow_reorder = false} : tensor<1x32xf32> -> tensor<32xf32>
+    // CHECK-DAG: %[[sum:.*]] = arith.mulf %[[x]], %[[cst]] : tensor<32xf32>
+    %0 = tt.broadcast %arg0 : tensor<1x32xf32> -> tensor<16x32xf32>
+    %1 = "tt.reduce"(%0) <{axis = 0 : i32}> ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) : (tensor<16x32xf32>) -> tensor<32xf32>
+    // CHECK-DAG: %[[y:.*]] = tt.reshape %arg1 {allow_reorder = false} : tensor<1x32xi32> -> tensor<32xi32>
+    %2 = tt.broadcast %arg1 : tensor<1x32xi32> -> tensor<16x32xi32>
+    %3 = "tt.reduce"(%2) <{axis = 0 : i32}> ({
+    ^bb0(%a: i32, %b: i32):
+      %m = arith.maxsi %a, %b : i32
+      tt.reduce.return %m : i32
+    }) : (tensor<16x32xi32>) -> tensor<32xi32>
+    %4 = tt.expand_dims %arg2 {axis = 1 : i32} : tensor<32xf32> -> tensor<32x1xf32>
+    %5 = "tt.reduce"(%4) <{axis = 1 : i32}> ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) : (tensor<32x1xf32>) -> tensor<32xf32>
+    // CHECK-NOT: tt.reduce
+    // CHECK: tt.return %[[sum]], %[[y]], %arg2
+    tt.return %1, %3, %5 : tensor<32xf32>, tensor<32xi32>, tensor<32xf32>
+}
+
+// CHECK-LABEL: @test_combine_dot_ones
+tt.func @test_combine_dot_ones(%arg0: tensor<32x64xf16>, %arg1: tensor<32x16xf32>) -> tensor<32x16xf32> {
+    %ones = arith.constant dense<1.0> : tensor<64x16xf16>
+    // CHECK: %[[ext:.*]] = arith.extf %arg0 : tensor<32x64xf16> to tensor<32x64xf32>
+    // CHECK: %[[sum:.*]] = "tt.reduce"(%[[ext]]) <{axis = 1 : i32}>
+    // CHECK: arith.addf
+    // CHECK: %[[exp:.*]] = tt.expand_dims %[[sum]] {axis = 1 : i32} : tensor<32xf32> -> tensor<32x1xf32>
+    // CHECK: %[[bc:.*]] = tt.broadcast %[[exp]] : tensor<32x1xf32> -> tensor<32x16xf32>
+    // CHECK: %[[res:.*]] = arith.addf %arg1, %[[bc]] : tensor<32x16xf32>
+    // CHECK-NOT: tt.dot
+    // CHECK: tt.return %[[res]]
+    %0 = tt.dot %arg0, %ones, %arg1 : tensor<32x64xf16> * tensor<64x16xf16> -> tensor<32x16xf32>
+    tt.return %0 : tensor<32x16xf32>
+}
+
+// CHECK-LABEL: @test_combine_trans_splat
+tt.func @test_combine_trans_splat(%arg0: f32) -> tensor<32x16xf32> {
+    // CHECK: %[[splat:.*]] = tt.splat %arg0 : f32 -> tensor<32x16xf32>
+    // CHECK-NOT: tt.trans
+    // CHECK: tt.return %[[splat]]
+    %0 = tt.splat %arg0 : f32 -> tensor<16x32xf32>
+    %1 = tt.trans %0 {order = array<i32: 1, 0>} : tensor<16x32xf32> -> tensor<32x16xf32>
+    tt.return %1 : tensor<32x16xf32>
+}
+
+// Only inverse math ops that assume finite values cancel.
+// CHECK-LABEL: @test_combine_inverse_math
+tt.func @test_combine_inverse_math(%arg0: tensor<32xf32>) -> (tensor<32xf32>, tensor<32xf32>) {
+    %0 = math.exp %arg0 fastmath<nnan,ninf> : tensor<32xf32>
+    %1 = math.log %0 fastmath<nnan,ninf> : tensor<32xf32>
+    // CHECK: %[[log:.*]] = math.log2 %arg0 : tensor<32xf32>
+    // CHECK: %[[exp:.*]] = math.exp2 %[[log]] : tensor<32xf32>
+    %2 = math.log2 %arg0 : tensor<32xf32>
+    %3 = math.exp2 %2 : tensor<32xf32>
+    // CHECK: tt.return %arg0, %[[exp]]
+    tt.return %1, %3 : tensor<32xf32>, tensor<32xf32>
+}
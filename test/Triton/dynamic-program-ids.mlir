@@ -0,0 +1,37 @@
+// RUN: triton-opt %s -split-input-file -triton-dynamic-program-ids | FileCheck %s
+
+// CHECK-LABEL: @dynamic_program_ids
+tt.func public @dynamic_program_ids(%arg0: !tt.ptr<i32>) {
+  // CHECK: %[[COUNTER:.*]] = tt.workspace {size = 4 : i64, zeroed = true} : !tt.ptr<i32>
+  // CHECK: %[[ID:.*]] = tt.atomic_rmw add, relaxed, gpu, %[[COUNTER]], %{{.*}} : (!tt.ptr<i32>, i32) -> i32
+  // CHECK: %[[NX:.*]] = tt.get_num_programs x
+  // CHECK: %[[NY:.*]] = tt.get_num_programs y
+  // CHECK: %[[YZ:.*]] = arith.divui %[[ID]], %[[NX]]
+  // CHECK: %[[X:.*]] = arith.remui %[[ID]], %[[NX]]
+  // CHECK: %[[Y:.*]] = arith.remui %[[YZ]], %[[NY]]
+  // CHECK: %[[Z:.*]] = arith.divui %[[YZ]], %[[NY]]
+  // CHECK-NOT: tt.get_program_id
+  // CHECK: tt.addptr %arg0, %[[X]]
+  // CHECK: tt.store %{{.*}}, %[[Y]]
+  // CHECK: tt.store %{{.*}}, %[[Z]]
+  %0 = tt.get_program_id x : i32
+  %1 = tt.get_program_id y : i32
+  %2 = tt.get_program_id z : i32
+  %3 = tt.addptr %arg0, %0 : !tt.ptr<i32>, i32
+  tt.store %3, %1 : !tt.ptr<i32>
+  tt.store %3, %2 : !tt.ptr<i32>
+  tt.return
+}
+
+// -----
+
+// Functions that aren't kernels get their program ids from the kernel that
+// calls them once inlined.
+// CHECK-LABEL: @callee
+tt.func private @callee(%arg0: !tt.ptr<i32>) {
+  // CHECK-NOT: tt.workspace
+  // CHECK: tt.get_program_id x
+  %0 = tt.get_program_id x : i32
+  tt.store %arg0, %0 : !tt.ptr<i32>
+  tt.return
+}
@@ -0,0 +1,67 @@
+// RUN: triton-opt %s -split-input-file -triton-eviction-hints | FileCheck %s
+
+// CHECK-LABEL: @scale
+tt.func public @scale(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>, %arg2: !tt.ptr<f32>) {
+  %c128_i32 = arith.constant 128 : i32
+  %0 = tt.get_program_id x : i32
+  %1 = arith.muli %0, %c128_i32 : i32
+  %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %3 = tt.splat %1 : i32 -> tensor<128xi32>
+  %4 = arith.addi %3, %2 : tensor<128xi32>
+  %5 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %6 = tt.addptr %5, %4 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.load %{{.*}} evictionPolicy = evict_first
+  %7 = tt.load %6 : tensor<128x!tt.ptr<f32>>
+  %8 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %9 = tt.addptr %8, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.load %{{.*}} evictionPolicy = evict_last
+  %10 = tt.load %9 : tensor<128x!tt.ptr<f32>>
+  // The hints of the user are kept
+  // CHECK: tt.load %{{.*}} evictionPolicy = evict_first
+  %11 = tt.load %9 evictionPolicy = evict_first : tensor<128x!tt.ptr<f32>>
+  %12 = arith.mulf %7, %10 : tensor<128xf32>
+  %13 = arith.addf %12, %11 : tensor<128xf32>
+  %14 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %15 = tt.addptr %14, %4 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  tt.store %15, %13 : tensor<128x!tt.ptr<f32>>
+  tt.return
+}
+
+// -----
+
+// Loads that are shared by some of the programs are left alone: the tiles of
+// a 1D grid split into rows and columns, dot operands and gathers. The
+// indices of the gather are streamed.
+// CHECK-LABEL: @shared_tiles
+// CHECK: tt.load %{{.*}} : tensor<16x!tt.ptr<f16>>
+// CHECK: tt.load %{{.*}} : tensor<16x16x!tt.ptr<f16>>
+// CHECK: tt.load %{{.*}} evictionPolicy = evict_first : tensor<16x!tt.ptr<i32>>
+// CHECK: tt.load %{{.*}} : tensor<16x!tt.ptr<f16>>
+tt.func public @shared_tiles(%arg0: !tt.ptr<f16>, %arg1: !tt.ptr<i32>, %arg2: i32) -> (tensor<16x16xf32>, tensor<16xf16>) {
+  %c16_i32 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32>
+  %0 = tt.get_program_id x : i32
+  %1 = arith.divsi %0, %arg2 : i32
+  %2 = arith.muli %1, %c16_i32 : i32
+  %3 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %4 = tt.splat %2 : i32 -> tensor<16xi32>
+  %5 = arith.addi %4, %3 : tensor<16xi32>
+  %6 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x!tt.ptr<f16>>
+  %7 = tt.addptr %6, %5 : tensor<16x!tt.ptr<f16>>, tensor<16xi32>
+  %8 = tt.load %7 : tensor<16x!tt.ptr<f16>>
+  %9 = tt.splat %0 : i32 -> tensor<16xi32>
+  %10 = arith.addi %9, %3 : tensor<16xi32>
+  %11 = tt.expand_dims %10 {axis = 1 : i32} : tensor<16xi32> -> tensor<16x1xi32>
+  %12 = tt.broadcast %11 : tensor<16x1xi32> -> tensor<16x16xi32>
+  %13 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %14 = tt.addptr %13, %12 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %15 = tt.load %14 : tensor<16x16x!tt.ptr<f16>>
+  %16 = tt.dot %15, %15, %cst : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+  %17 = tt.splat %arg1 : !tt.ptr<i32> -> tensor<16x!tt.ptr<i32>>
+  %18 = tt.addptr %17, %10 : tensor<16x!tt.ptr<i32>>, tensor<16xi32>
+  %19 = tt.load %18 : tensor<16x!tt.ptr<i32>>
+  %20 = tt.addptr %6, %19 : tensor<16x!tt.ptr<f16>>, tensor<16xi32>
+  %21 = tt.load %20 : tensor<16x!tt.ptr<f16>>
+  %22 = arith.addf %8, %21 : tensor<16xf16>
+  tt.return %16, %22 : tensor<16x16xf32>, tensor<16xf16>
+}
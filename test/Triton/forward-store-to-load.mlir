@@ -0,0 +1,184 @@
+// RUN: triton-opt %s -split-input-file -triton-forward-store-to-load | FileCheck %s
+
+// CHECK-LABEL: @forward_masked
+// CHECK-SAME: %{{.*}}: !tt.ptr<f32>, %[[VAL:.*]]: tensor<128xf32>, %[[MASK:.*]]: tensor<128xi1>
+tt.func @forward_masked(%arg0: !tt.ptr<f32>, %arg1: tensor<128xf32>, %arg2: tensor<128xi1>) -> tensor<128xf32> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf32>
+  %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %2 = tt.addptr %0, %1 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.store %[[PTRS:.*]], %[[VAL]], %[[MASK]]
+  // CHECK-NOT: tt.load
+  // CHECK: %[[SEL:.*]] = arith.select %[[MASK]], %[[VAL]], %{{.*}} : tensor<128xi1>, tensor<128xf32>
+  // CHECK: tt.return %[[SEL]]
+  tt.store %2, %arg1, %arg2 : tensor<128x!tt.ptr<f32>>
+  %3 = tt.load %2, %arg2, %cst : tensor<128x!tt.ptr<f32>>
+  tt.return %3 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @forward_unmasked
+tt.func @forward_unmasked(%arg0: !tt.ptr<f32>, %arg1: tensor<32x64xf32>, %arg2: tensor<32x64x!tt.ptr<f32>>, %arg3: i32) -> tensor<32x64xf32> {
+  %0 = tt.make_range {end = 2048 : i32, start = 0 : i32} : tensor<2048xi32>
+  %1 = tt.splat %arg3 : i32 -> tensor<2048xi32>
+  %2 = arith.addi %0, %1 : tensor<2048xi32>
+  %3 = tt.reshape %2 {allow_reorder = false} : tensor<2048xi32> -> tensor<32x64xi32>
+  %4 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<32x64x!tt.ptr<f32>>
+  %5 = tt.addptr %4, %3 : tensor<32x64x!tt.ptr<f32>>, tensor<32x64xi32>
+  // CHECK: tt.load %arg2
+  // CHECK-NOT: tt.load
+  // CHECK: %[[MUL:.*]] = arith.mulf %arg1, %arg1
+  // CHECK: arith.addf %{{.*}}, %[[MUL]]
+  tt.store %5, %arg1 : tensor<32x64x!tt.ptr<f32>>
+  %6 = tt.load %arg2 : tensor<32x64x!tt.ptr<f32>>
+  %7 = tt.load %5 : tensor<32x64x!tt.ptr<f32>>
+  %8 = arith.mulf %7, %7 : tensor<32x64xf32>
+  %9 = arith.addf %6, %8 : tensor<32x64xf32>
+  tt.return %9 : tensor<32x64xf32>
+}
+
+// -----
+
+// Stores to other pointers, which may alias, and masks that don't cover the
+// load are not forwarded.
+// CHECK-LABEL: @no_forward
+tt.func @no_forward(%arg0: !tt.ptr<f32>, %arg1: tensor<128x!tt.ptr<f32>>, %arg2: tensor<128xf32>, %arg3: tensor<128xi1>) -> (tensor<128xf32>, tensor<128xf32>) {
+  %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %2 = tt.addptr %0, %1 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %3 = tt.addptr %2, %1 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.load %[[PTRS:.*]] :
+  // CHECK: tt.load %[[PTRS]] :
+  tt.store %3, %arg2 : tensor<128x!tt.ptr<f32>>
+  tt.store %arg1, %arg2 : tensor<128x!tt.ptr<f32>>
+  %4 = tt.load %3 : tensor<128x!tt.ptr<f32>>
+  tt.store %3, %arg2, %arg3 : tensor<128x!tt.ptr<f32>>
+  %5 = tt.load %3 : tensor<128x!tt.ptr<f32>>
+  tt.return %4, %5 : tensor<128xf32>, tensor<128xf32>
+}
+
+// -----
+
+// Pointers that may repeat across lanes read back the value of only one of
+// the lanes that stored to them, so they are not forwarded.
+// CHECK-LABEL: @no_forward_duplicate_pointers
+tt.func @no_forward_duplicate_pointers(%arg0: !tt.ptr<f32>, %arg1: tensor<128x!tt.ptr<f32>>, %arg2: tensor<32x64xf32>, %arg3: tensor<128xf32>) -> (tensor<32x64xf32>, tensor<128xf32>) {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %1 = tt.expand_dims %0 {axis = 0 : i32} : tensor<64xi32> -> tensor<1x64xi32>
+  %2 = tt.broadcast %1 : tensor<1x64xi32> -> tensor<32x64xi32>
+  %3 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<32x64x!tt.ptr<f32>>
+  %4 = tt.addptr %3, %2 : tensor<32x64x!tt.ptr<f32>>, tensor<32x64xi32>
+  // CHECK: tt.load %{{.*}} : tensor<32x64x!tt.ptr<f32>>
+  // CHECK: tt.load %arg1 :
+  tt.store %4, %arg2 : tensor<32x64x!tt.ptr<f32>>
+  %5 = tt.load %4 : tensor<32x64x!tt.ptr<f32>>
+  tt.store %arg1, %arg3 : tensor<128x!tt.ptr<f32>>
+  %6 = tt.load %arg1 : tensor<128x!tt.ptr<f32>>
+  tt.return %5, %6 : tensor<32x64xf32>, tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @no_forward_across_call
+tt.func @no_forward_across_call(%arg0: !tt.ptr<f32>, %arg1: tensor<128xf32>) -> tensor<128xf32> {
+  %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %2 = tt.addptr %0, %1 : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK: tt.call
+  // CHECK: tt.load
+  tt.store %2, %arg1 : tensor<128x!tt.ptr<f32>>
+  tt.call @callee() : () -> ()
+  %3 = tt.load %2 : tensor<128x!tt.ptr<f32>>
+  tt.return %3 : tensor<128xf32>
+}
+tt.func private @callee()
+
+// -----
+
+// The rows of a 2D tile are 64 apart, more than the span of its columns, so
+// no two lanes hold the same pointer.
+// CHECK-LABEL: @forward_2d
+// CHECK-SAME: %{{.*}}: !tt.ptr<f32>, %[[VAL:.*]]: tensor<32x64xf32>
+tt.func @forward_2d(%arg0: !tt.ptr<f32>, %arg1: tensor<32x64xf32>) -> tensor<32x64xf32> {
+  %cst = arith.constant dense<64> : tensor<32x1xi32>
+  %0 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+  %1 = tt.expand_dims %0 {axis = 1 : i32} : tensor<32xi32> -> tensor<32x1xi32>
+  %2 = arith.muli %1, %cst : tensor<32x1xi32>
+  %3 = tt.broadcast %2 : tensor<32x1xi32> -> tensor<32x64xi32>
+  %4 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %5 = tt.expand_dims %4 {axis = 0 : i32} : tensor<64xi32> -> tensor<1x64xi32>
+  %6 = tt.broadcast %5 : tensor<1x64xi32> -> tensor<32x64xi32>
+  %7 = arith.addi %3, %6 : tensor<32x64xi32>
+  %8 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<32x64x!tt.ptr<f32>>
+  %9 = tt.addptr %8, %7 : tensor<32x64x!tt.ptr<f32>>, tensor<32x64xi32>
+  // CHECK: tt.store
+  // CHECK-NOT: tt.load
+  // CHECK: tt.return %[[VAL]]
+  tt.store %9, %arg1 : tensor<32x64x!tt.ptr<f32>>
+  %10 = tt.load %9 : tensor<32x64x!tt.ptr<f32>>
+  tt.return %10 : tensor<32x64xf32>
+}
+
+// -----
+
+// Rows 32 apart overlap the 64 columns of the previous row.
+// CHECK-LABEL: @no_forward_2d_overlapping_rows
+tt.func @no_forward_2d_overlapping_rows(%arg0: !tt.ptr<f32>, %arg1: tensor<32x64xf32>) -> tensor<32x64xf32> {
+  %cst = arith.constant dense<32> : tensor<32x1xi32>
+  %0 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+  %1 = tt.expand_dims %0 {axis = 1 : i32} : tensor<32xi32> -> tensor<32x1xi32>
+  %2 = arith.muli %1, %cst : tensor<32x1xi32>
+  %3 = tt.broadcast %2 : tensor<32x1xi32> -> tensor<32x64xi32>
+  %4 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %5 = tt.expand_dims %4 {axis = 0 : i32} : tensor<64xi32> -> tensor<1x64xi32>
+  %6 = tt.broadcast %5 : tensor<1x64xi32> -> tensor<32x64xi32>
+  %7 = arith.addi %3, %6 : tensor<32x64xi32>
+  %8 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<32x64x!tt.ptr<f32>>
+  %9 = tt.addptr %8, %7 : tensor<32x64x!tt.ptr<f32>>, tensor<32x64xi32>
+  // CHECK: tt.store
+  // CHECK-NOT: scf.if
+  // CHECK: tt.load
+  tt.store %9, %arg1 : tensor<32x64x!tt.ptr<f32>>
+  %10 = tt.load %9 : tensor<32x64x!tt.ptr<f32>>
+  tt.return %10 : tensor<32x64xf32>
+}
+
+// -----
+
+// With a runtime row stride, the load is only skipped when 63 < |stride|,
+// so that the rows don't overlap, and the offsets of the 31 rows fit in i32.
+// CHECK-LABEL: @forward_2d_runtime_stride
+// CHECK-SAME: %{{.*}}: !tt.ptr<f32>, %[[VAL:.*]]: tensor<32x64xf32>, %[[STRIDE:.*]]: i32
+tt.func @forward_2d_runtime_stride(%arg0: !tt.ptr<f32>, %arg1: tensor<32x64xf32>, %arg2: i32) -> tensor<32x64xf32> {
+  %0 = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32>
+  %1 = tt.expand_dims %0 {axis = 1 : i32} : tensor<32xi32> -> tensor<32x1xi32>
+  %2 = tt.splat %arg2 : i32 -> tensor<32x1xi32>
+  %3 = arith.muli %1, %2 : tensor<32x1xi32>
+  %4 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %5 = tt.expand_dims %4 {axis = 0 : i32} : tensor<64xi32> -> tensor<1x64xi32>
+  %6 = tt.broadcast %3 : tensor<32x1xi32> -> tensor<32x64xi32>
+  %7 = tt.broadcast %5 : tensor<1x64xi32> -> tensor<32x64xi32>
+  %8 = arith.addi %6, %7 : tensor<32x64xi32>
+  %9 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<32x64x!tt.ptr<f32>>
+  %10 = tt.addptr %9, %8 : tensor<32x64x!tt.ptr<f32>>, tensor<32x64xi32>
+  // CHECK: tt.store %[[PTRS:.*]], %[[VAL]]
+  // CHECK-DAG: %[[LO:.*]] = arith.constant 63 : i32
+  // CHECK-DAG: %[[HI:.*]] = arith.constant 69273664 : i32
+  // CHECK-DAG: %[[NLO:.*]] = arith.constant -63 : i32
+  // CHECK-DAG: %[[NHI:.*]] = arith.constant -69273664 : i32
+  // CHECK-DAG: arith.cmpi sgt, %[[STRIDE]], %[[LO]]
+  // CHECK-DAG: arith.cmpi sle, %[[STRIDE]], %[[HI]]
+  // CHECK-DAG: arith.cmpi slt, %[[STRIDE]], %[[NLO]]
+  // CHECK-DAG: arith.cmpi sge, %[[STRIDE]], %[[NHI]]
+  // CHECK: %[[COND:.*]] = arith.ori
+  // CHECK: %[[RES:.*]] = scf.if %[[COND]]
+  // CHECK-NEXT: scf.yield %[[VAL]]
+  // CHECK-NEXT: } else {
+  // CHECK-NEXT: %[[LOAD:.*]] = tt.load %[[PTRS]]
+  // CHECK-NEXT: scf.yield %[[LOAD]]
+  // CHECK: tt.return %[[RES]]
+  tt.store %10, %arg1 : tensor<32x64x!tt.ptr<f32>>
+  %11 = tt.load %10 : tensor<32x64x!tt.ptr<f32>>
+  tt.return %11 : tensor<32x64xf32>
+}
@@ -336,3 +336,19 @@ tt.func public @fn(%arg0: tensor<16x32x64xf32, #shared>) {
     tt.return
 }
 }  // end module
+
+// -----
+
+tt.func public @fn(%a: tensor<64x32xi8>, %scale: tensor<64x1xi8>, %b: tensor<64x64xbf16>, %c: tensor<64x64xf32>) {
+    // expected-error @+1 {{the scale of lhs must have a byte per block of 32 elements along K}}
+    %0 = tt.dot_scaled %a scale %scale, %b, %c lhs = e2m1 rhs = bf16 : tensor<64x32xi8>, tensor<64x1xi8> * tensor<64x64xbf16> -> tensor<64x64xf32>
+    tt.return
+}
+
+// -----
+
+tt.func public @fn(%a: tensor<64x64xf8E5M2>, %b: tensor<64x64xbf16>, %c: tensor<64x64xf32>) {
+    // expected-error @+1 {{lhs must be scaled unless it's bf16}}
+    %0 = tt.dot_scaled %a, %b, %c lhs = e5m2 rhs = bf16 : tensor<64x64xf8E5M2> * tensor<64x64xbf16> -> tensor<64x64xf32>
+    tt.return
+}
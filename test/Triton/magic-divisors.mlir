@@ -0,0 +1,65 @@
+// RUN: triton-opt %s -split-input-file -triton-magic-divisors | FileCheck %s
+
+// CHECK: module attributes {tt.magic_divisors = "[1]"}
+// CHECK-LABEL: @non_negative
+// CHECK-SAME: %arg1: i32 {tt.divisor = 1 : i32, tt.range = dense<[1, 2147483647]> : tensor<2xi32>}, %[[MAGIC:.*]]: i32, %[[SHIFT:.*]]: i32)
+tt.func public @non_negative(%arg0: !tt.ptr<i32>, %arg1: i32 {tt.divisor = 1 : i32}) {
+  // CHECK: %[[PID:.*]] = tt.get_program_id x : i32
+  // CHECK: %[[Q:.*]] = tt.magic_divui %[[PID]], %arg1, %[[MAGIC]], %[[SHIFT]] : i32
+  // CHECK: %[[R:.*]] = tt.magic_remui %[[PID]], %arg1, %[[MAGIC]], %[[SHIFT]] : i32
+  // CHECK: arith.addi %[[Q]], %[[R]] : i32
+  %0 = tt.get_program_id x : i32
+  %1 = arith.divsi %0, %arg1 : i32
+  %2 = arith.remsi %0, %arg1 : i32
+  %3 = arith.addi %1, %2 : i32
+  tt.store %arg0, %3 : !tt.ptr<i32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @signed
+tt.func public @signed(%arg0: !tt.ptr<i32>, %arg1: i32, %arg2: i32 {tt.divisor = 1 : i32}) {
+  // CHECK: %[[ZERO:.*]] = arith.constant 0 : i32
+  // CHECK: %[[NEG:.*]] = arith.cmpi slt, %arg1, %[[ZERO]] : i32
+  // CHECK: %[[MINUS:.*]] = arith.subi %[[ZERO]], %arg1 : i32
+  // CHECK: %[[ABS:.*]] = arith.select %[[NEG]], %[[MINUS]], %arg1 : i32
+  // CHECK: %[[Q:.*]] = tt.magic_divui %[[ABS]], %arg2, %arg3, %arg4 : i32
+  // CHECK: %[[MINUS_Q:.*]] = arith.subi %[[ZERO]], %[[Q]] : i32
+  // CHECK: arith.select %[[NEG]], %[[MINUS_Q]], %[[Q]] : i32
+  %0 = arith.divsi %arg1, %arg2 : i32
+  tt.store %arg0, %0 : !tt.ptr<i32>
+  tt.return
+}
+
+// -----
+
+// The quotient of the unknown dividends is constant over blocks of 16, which
+// its absolute value would hide
+// CHECK-LABEL: @keeps_axis_info
+tt.func public @keeps_axis_info(%arg0: tensor<128x!tt.ptr<i32>>, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: i32 {tt.divisor = 1 : i32, tt.divisibility = 16 : i32}) {
+  // CHECK-NOT: tt.magic_divui
+  // CHECK: arith.divsi
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg1 : i32 -> tensor<128xi32>
+  %2 = arith.addi %1, %0 : tensor<128xi32>
+  %3 = tt.splat %arg2 : i32 -> tensor<128xi32>
+  %4 = arith.divsi %2, %3 : tensor<128xi32>
+  tt.store %arg0, %4 : tensor<128x!tt.ptr<i32>>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @tensor
+tt.func public @tensor(%arg0: tensor<128x!tt.ptr<i32>>, %arg1: i32 {tt.divisor = 1 : i32}) {
+  // CHECK: %[[RANGE:.*]] = tt.make_range
+  // CHECK-DAG: %[[MAGIC:.*]] = tt.splat %arg2 : i32 -> tensor<128xi32>
+  // CHECK-DAG: %[[SHIFT:.*]] = tt.splat %arg3 : i32 -> tensor<128xi32>
+  // CHECK: tt.magic_remui %[[RANGE]], %{{.*}}, %[[MAGIC]], %[[SHIFT]] : tensor<128xi32>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = tt.splat %arg1 : i32 -> tensor<128xi32>
+  %2 = arith.remui %0, %1 : tensor<128xi32>
+  tt.store %arg0, %2 : tensor<128x!tt.ptr<i32>>
+  tt.return
+}
@@ -0,0 +1,64 @@
+// RUN: triton-opt %s -split-input-file -triton-narrow-offsets | FileCheck %s
+
+// CHECK-LABEL: @range_hint
+tt.func public @range_hint(%arg0: !tt.ptr<f32>, %arg1: i64 {tt.range = dense<[0, 4096]> : tensor<2xi64>}) -> tensor<128xf32> {
+  // CHECK: %[[STRIDE:.*]] = arith.trunci %arg1 : i64 to i32
+  // CHECK: %[[RANGE:.*]] = tt.make_range
+  // CHECK: %[[SPLAT:.*]] = tt.splat %[[STRIDE]] : i32 -> tensor<128xi32>
+  // CHECK: %[[OFFS:.*]] = arith.muli %[[RANGE]], %[[SPLAT]] : tensor<128xi32>
+  // CHECK: tt.addptr %{{.*}}, %[[OFFS]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  // CHECK-NOT: i64
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = arith.extsi %0 : tensor<128xi32> to tensor<128xi64>
+  %2 = tt.splat %arg1 : i64 -> tensor<128xi64>
+  %3 = arith.muli %1, %2 : tensor<128xi64>
+  %4 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %5 = tt.addptr %4, %3 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %6 = tt.load %5 : tensor<128x!tt.ptr<f32>>
+  tt.return %6 : tensor<128xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @max_size_hint
+tt.func public @max_size_hint(%arg0: !tt.ptr<f32> {tt.max_size = 1048576 : i32}, %arg1: i64, %arg2: i32) -> tensor<128xf32> {
+  // CHECK-DAG: %[[STRIDE:.*]] = arith.trunci %arg1 : i64 to i32
+  // CHECK-DAG: %[[PID:.*]] = tt.get_program_id x : i32
+  // CHECK: %[[ROW:.*]] = arith.muli %[[PID]], %[[STRIDE]] : i32
+  // CHECK: %[[SPLAT:.*]] = tt.splat %[[ROW]] : i32 -> tensor<128xi32>
+  // CHECK: %[[OFFS:.*]] = arith.addi %[[SPLAT]], %{{.*}} : tensor<128xi32>
+  // CHECK: tt.addptr %{{.*}}, %[[OFFS]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %0 = tt.get_program_id x : i32
+  %1 = arith.extsi %0 : i32 to i64
+  %2 = arith.muli %1, %arg1 : i64
+  %3 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %4 = arith.extsi %3 : tensor<128xi32> to tensor<128xi64>
+  %5 = tt.splat %2 : i64 -> tensor<128xi64>
+  %6 = arith.addi %5, %4 : tensor<128xi64>
+  %7 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  %8 = tt.addptr %7, %6 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %9 = tt.splat %arg2 : i32 -> tensor<128xi32>
+  %10 = arith.cmpi slt, %3, %9 : tensor<128xi32>
+  %11 = tt.load %8, %10 : tensor<128x!tt.ptr<f32>>
+  tt.return %11 : tensor<128xf32>
+}
+
+// -----
+
+// The offsets of pointers that aren't accessed directly aren't bounded by the
+// hint, and the others have no range.
+// CHECK-LABEL: @no_bound
+tt.func public @no_bound(%arg0: !tt.ptr<f32> {tt.max_size = 1048576 : i32}, %arg1: !tt.ptr<f32>, %arg2: i64) -> (tensor<128x!tt.ptr<f32>>, tensor<128xf32>) {
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %1 = arith.extsi %0 : tensor<128xi32> to tensor<128xi64>
+  %2 = tt.splat %arg2 : i64 -> tensor<128xi64>
+  %3 = arith.muli %1, %2 : tensor<128xi64>
+  %4 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %{{.*}} : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %5 = tt.addptr %4, %3 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %6 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %{{.*}} : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %7 = tt.addptr %6, %3 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  %8 = tt.load %7 : tensor<128x!tt.ptr<f32>>
+  tt.return %5, %8 : tensor<128x!tt.ptr<f32>>, tensor<128xf32>
+}
@@ -0,0 +1,57 @@
+// RUN: triton-opt %s -split-input-file -triton-persistent-kernel | FileCheck %s
+// RUN: triton-opt %s -split-input-file -triton-persistent-kernel="scheduler=grouped group-size=4" | FileCheck %s --check-prefix=GROUPED
+
+// CHECK-LABEL: tt.func public @store_pid
+// CHECK-SAME: %[[PTR:.*]]: !tt.ptr<f32>, %[[GX:.*]]: i32, %[[GY:.*]]: i32, %[[GZ:.*]]: i32)
+// CHECK: %[[PID:.*]] = tt.get_program_id x : i32
+// CHECK: %[[NUM:.*]] = tt.get_num_programs x : i32
+// CHECK: %[[GXY:.*]] = arith.muli %[[GX]], %[[GY]] : i32
+// CHECK: %[[TILES:.*]] = arith.muli %[[GXY]], %[[GZ]] : i32
+// CHECK: scf.for %[[TILE:.*]] = %[[PID]] to %[[TILES]] step %[[NUM]] : i32 {
+// CHECK-NEXT: %[[X:.*]] = arith.remsi %[[TILE]], %[[GX]] : i32
+// CHECK-NEXT: %[[YZ:.*]] = arith.divsi %[[TILE]], %[[GX]] : i32
+// CHECK-NEXT: %[[Y:.*]] = arith.remsi %[[YZ]], %[[GY]] : i32
+// CHECK-NEXT: %[[Z:.*]] = arith.divsi %[[YZ]], %[[GY]] : i32
+// CHECK-NOT: tt.get_program_id
+// CHECK: %[[OFF:.*]] = arith.addi %[[X]], %[[Y]] : i32
+// CHECK: %[[PTRX:.*]] = tt.addptr %[[PTR]], %[[OFF]] : !tt.ptr<f32>, i32
+// CHECK: %[[VAL:.*]] = arith.sitofp %[[GZ]] : i32 to f32
+// CHECK: tt.store %[[PTRX]], %[[VAL]] : !tt.ptr<f32>
+// CHECK: }
+// CHECK-NEXT: tt.return
+
+// GROUPED-LABEL: tt.func public @store_pid
+// GROUPED: scf.for %[[TILE:.*]] = %{{.*}} to %{{.*}} step %{{.*}} : i32 {
+// GROUPED: %[[GROUP:.*]] = arith.constant 4 : i32
+// GROUPED: arith.minsi %{{.*}}, %[[GROUP]] : i32
+// GROUPED-NOT: tt.get_program_id
+// GROUPED: tt.store
+tt.func public @store_pid(%arg0: !tt.ptr<f32>) {
+  %0 = tt.get_program_id x : i32
+  %1 = tt.get_program_id y : i32
+  %2 = arith.addi %0, %1 : i32
+  %3 = tt.addptr %arg0, %2 : !tt.ptr<f32>, i32
+  %4 = tt.get_num_programs z : i32
+  %5 = arith.sitofp %4 : i32 to f32
+  tt.store %3, %5 : !tt.ptr<f32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: tt.func private @helper
+// CHECK-NOT: scf.for
+// CHECK-LABEL: tt.func public @calls_helper
+// CHECK-SAME: %{{.*}}: i32, %{{.*}}: i32, %{{.*}}: i32)
+// CHECK: scf.for
+// CHECK: tt.call @helper
+tt.func private @helper(%arg0: !tt.ptr<f32>) {
+  %cst = arith.constant 1.000000e+00 : f32
+  tt.store %arg0, %cst : !tt.ptr<f32>
+  tt.return
+}
+
+tt.func public @calls_helper(%arg0: !tt.ptr<f32>) {
+  tt.call @helper(%arg0) : (!tt.ptr<f32>) -> ()
+  tt.return
+}
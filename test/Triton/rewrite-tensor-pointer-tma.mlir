@@ -0,0 +1,54 @@
+// RUN: triton-opt %s -split-input-file -triton-rewrite-tensor-pointer=tma-descriptors=true | FileCheck %s
+
+// CHECK: module attributes {tt.tma_descriptors = "[{\22base\22:{\22arg\22:0},\22block\22:[64,64],\22elem_bytes\22:2,\22shape\22:[{\22arg\22:2},{\22arg\22:3}],\22strides\22:[{\22arg\22:4},{\22value\22:1}]},{\22base\22:{\22arg\22:1},
+// CHECK-LABEL: tt.func public @copy
+// CHECK-SAME: %arg5: !tt.ptr<i8> {tt.nv_tma_desc}, %arg6: !tt.ptr<i8> {tt.nv_tma_desc})
+tt.func public @copy(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg2: i32, %arg3: i32, %arg4: i32 {tt.divisibility = 16 : i32}) {
+  %c0_i32 = arith.constant 0 : i32
+  %c64_i32 = arith.constant 64 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %0 = tt.get_program_id x : i32
+  %1 = arith.muli %0, %c64_i32 : i32
+  %2 = arith.extsi %arg2 : i32 to i64
+  %3 = arith.extsi %arg3 : i32 to i64
+  %4 = arith.extsi %arg4 : i32 to i64
+  %5 = tt.make_tensor_ptr %arg0, [%2, %3], [%4, %c1_i64], [%1, %c0_i32] {order = array<i32: 1, 0>} : <tensor<64x64xf16>>
+  %6 = tt.make_tensor_ptr %arg1, [%2, %3], [%4, %c1_i64], [%1, %c0_i32] {order = array<i32: 1, 0>} : <tensor<64x64xf16>>
+  // CHECK: scf.for
+  // CHECK: %[[ROW:.*]] = arith.trunci %{{.*}} : i64 to i32
+  // CHECK: %[[COL:.*]] = arith.trunci %{{.*}} : i64 to i32
+  // CHECK: %[[VAL:.*]] = tt.experimental_descriptor_load %arg5[%[[ROW]], %[[COL]]] : !tt.ptr<i8> -> tensor<64x64xf16>
+  // CHECK: tt.experimental_descriptor_store %arg6[%{{.*}}, %{{.*}}], %[[VAL]] : !tt.ptr<i8>, tensor<64x64xf16>
+  // CHECK-NOT: tt.load
+  // CHECK-NOT: tt.store
+  %7:2 = scf.for %arg5 = %c0_i32 to %arg3 step %c64_i32 iter_args(%arg6 = %5, %arg7 = %6) -> (!tt.ptr<tensor<64x64xf16>>, !tt.ptr<tensor<64x64xf16>>)  : i32 {
+    %8 = tt.load %arg6 {boundaryCheck = array<i32: 0, 1>, padding = 1 : i32} : !tt.ptr<tensor<64x64xf16>>
+    tt.store %arg7, %8 {boundaryCheck = array<i32: 0, 1>} : !tt.ptr<tensor<64x64xf16>>
+    %9 = tt.advance %arg6, [%c0_i32, %c64_i32] : <tensor<64x64xf16>>
+    %10 = tt.advance %arg7, [%c0_i32, %c64_i32] : <tensor<64x64xf16>>
+    scf.yield %9, %10 : !tt.ptr<tensor<64x64xf16>>, !tt.ptr<tensor<64x64xf16>>
+  }
+  tt.return
+}
+
+// -----
+
+// Strides that may not be 16-byte aligned and NaN padding can't use TMA
+// CHECK-NOT: tt.tma_descriptors
+// CHECK-LABEL: tt.func public @no_tma
+// CHECK-SAME: %arg3: i32)
+// CHECK-NOT: tt.experimental_descriptor_load
+// CHECK-COUNT-2: tt.load %{{.*}}, %{{.*}}, %{{.*}} : tensor<64x64x!tt.ptr<f16>>
+tt.func public @no_tma(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32, %arg3: i32) -> (tensor<64x64xf16>, tensor<64x64xf16>) {
+  %c0_i32 = arith.constant 0 : i32
+  %c64_i64 = arith.constant 64 : i64
+  %c1_i64 = arith.constant 1 : i64
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.extsi %arg2 : i32 to i64
+  %2 = arith.extsi %arg3 : i32 to i64
+  %3 = tt.make_tensor_ptr %arg0, [%0, %1], [%2, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : <tensor<64x64xf16>>
+  %4 = tt.load %3 {boundaryCheck = array<i32: 0, 1>, padding = 1 : i32} : !tt.ptr<tensor<64x64xf16>>
+  %5 = tt.make_tensor_ptr %arg0, [%0, %1], [%c64_i64, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : <tensor<64x64xf16>>
+  %6 = tt.load %5 {boundaryCheck = array<i32: 0, 1>, padding = 2 : i32} : !tt.ptr<tensor<64x64xf16>>
+  tt.return %4, %6 : tensor<64x64xf16>, tensor<64x64xf16>
+}
@@ -0,0 +1,155 @@
+// RUN: triton-opt %s -split-input-file -triton-tile-swizzle | FileCheck %s
+// RUN: triton-opt %s -split-input-file -triton-tile-swizzle=group-size=4 | FileCheck %s --check-prefix=GROUP4
+
+// A 1D grid split into rows and columns of tiles by `pid / n` and `pid % n`,
+// with the pointers of the operands carried by the loop.
+// CHECK-LABEL: @matmul_1d
+// CHECK: %[[PID:.*]] = tt.get_program_id x
+// CHECK: %[[NUM:.*]] = tt.get_num_programs x
+// CHECK: %[[FULL:.*]] = arith.divsi %[[NUM]], %arg2
+// CHECK: %[[ROWS:.*]] = arith.maxsi %[[FULL]]
+// CHECK: %[[TILES:.*]] = arith.muli %[[ROWS]], %arg2
+// CHECK: %[[IN:.*]] = arith.cmpi slt, %[[PID]], %[[TILES]]
+// CHECK: %[[TILE:.*]] = arith.select %[[IN]], %[[PID]]
+// CHECK: %[[GROUP:.*]] = arith.constant 8 : i32
+// CHECK: %[[PER_GROUP:.*]] = arith.muli %[[GROUP]], %arg2
+// CHECK: arith.divsi %[[TILE]], %[[PER_GROUP]]
+// CHECK: %[[M:.*]] = arith.addi
+// CHECK: %[[N:.*]] = arith.divsi
+// CHECK: %[[START:.*]] = arith.muli %[[M]], %arg2
+// CHECK: %[[SWIZZLED:.*]] = arith.addi %[[START]], %[[N]]
+// CHECK: %[[NEW:.*]] = arith.select %[[IN]], %[[SWIZZLED]], %[[PID]]
+// CHECK: arith.divsi %[[NEW]], %arg2
+// CHECK: arith.remsi %[[NEW]], %arg2
+// GROUP4-LABEL: @matmul_1d
+// GROUP4: arith.constant 4 : i32
+tt.func public @matmul_1d(%arg0: !tt.ptr<f16>, %arg1: !tt.ptr<f16>, %arg2: i32, %arg3: i32) -> tensor<16x16xf32> {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %c16_i32 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32>
+  %cst_0 = arith.constant dense<16> : tensor<16x16xi32>
+  %0 = tt.get_program_id x : i32
+  %1 = arith.divsi %0, %arg2 : i32
+  %2 = arith.remsi %0, %arg2 : i32
+  %3 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %4 = arith.muli %1, %c16_i32 : i32
+  %5 = tt.splat %4 : i32 -> tensor<16xi32>
+  %6 = arith.addi %5, %3 : tensor<16xi32>
+  %7 = tt.expand_dims %6 {axis = 1 : i32} : tensor<16xi32> -> tensor<16x1xi32>
+  %8 = tt.broadcast %7 : tensor<16x1xi32> -> tensor<16x16xi32>
+  %9 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %10 = tt.addptr %9, %8 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %11 = arith.muli %2, %c16_i32 : i32
+  %12 = tt.splat %11 : i32 -> tensor<16xi32>
+  %13 = arith.addi %12, %3 : tensor<16xi32>
+  %14 = tt.expand_dims %13 {axis = 0 : i32} : tensor<16xi32> -> tensor<1x16xi32>
+  %15 = tt.broadcast %14 : tensor<1x16xi32> -> tensor<16x16xi32>
+  %16 = tt.splat %arg1 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %17 = tt.addptr %16, %15 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %18:3 = scf.for %arg4 = %c0_i32 to %arg3 step %c1_i32 iter_args(%arg5 = %cst, %arg6 = %10, %arg7 = %17) -> (tensor<16x16xf32>, tensor<16x16x!tt.ptr<f16>>, tensor<16x16x!tt.ptr<f16>>) : i32 {
+    %19 = tt.load %arg6 : tensor<16x16x!tt.ptr<f16>>
+    %20 = tt.load %arg7 : tensor<16x16x!tt.ptr<f16>>
+    %21 = tt.dot %19, %20, %arg5 : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+    %22 = tt.addptr %arg6, %cst_0 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+    %23 = tt.addptr %arg7, %cst_0 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+    scf.yield %21, %22, %23 : tensor<16x16xf32>, tensor<16x16x!tt.ptr<f16>>, tensor<16x16x!tt.ptr<f16>>
+  }
+  tt.return %18#0 : tensor<16x16xf32>
+}
+
+// -----
+
+// The x program ids index the columns of b, so the groups are made of rows of
+// tiles along y.
+// CHECK-LABEL: @matmul_2d
+// CHECK-DAG: %[[PID_X:.*]] = tt.get_program_id x
+// CHECK-DAG: %[[PID_Y:.*]] = tt.get_program_id y
+// CHECK: %[[GX:.*]] = tt.get_num_programs x
+// CHECK: %[[GY:.*]] = tt.get_num_programs y
+// CHECK: %[[GX64:.*]] = arith.extsi %[[GX]] : i32 to i64
+// CHECK: %[[PID_Y64:.*]] = arith.extsi %[[PID_Y]] : i32 to i64
+// CHECK: %[[START:.*]] = arith.muli %[[PID_Y64]], %[[GX64]] : i64
+// CHECK: %[[PID_X64:.*]] = arith.extsi %[[PID_X]] : i32 to i64
+// CHECK: %[[TILE:.*]] = arith.addi %[[START]], %[[PID_X64]] : i64
+// CHECK: %[[GROUP:.*]] = arith.constant 8 : i64
+// CHECK: arith.muli %[[GROUP]], %[[GX64]]
+// CHECK: %[[Y64:.*]] = arith.addi
+// CHECK: %[[X64:.*]] = arith.divsi
+// CHECK: %[[X:.*]] = arith.trunci %[[X64]] : i64 to i32
+// CHECK: %[[Y:.*]] = arith.trunci %[[Y64]] : i64 to i32
+// CHECK: arith.muli %[[Y]], %c16_i32
+// CHECK: arith.muli %[[X]], %c16_i32
+tt.func public @matmul_2d(%arg0: !tt.ptr<f16>, %arg1: !tt.ptr<f16>) -> tensor<16x16xf32> {
+  %c16_i32 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32>
+  %0 = tt.get_program_id x : i32
+  %1 = tt.get_program_id y : i32
+  %2 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %3 = arith.muli %1, %c16_i32 : i32
+  %4 = tt.splat %3 : i32 -> tensor<16xi32>
+  %5 = arith.addi %4, %2 : tensor<16xi32>
+  %6 = tt.expand_dims %5 {axis = 1 : i32} : tensor<16xi32> -> tensor<16x1xi32>
+  %7 = tt.broadcast %6 : tensor<16x1xi32> -> tensor<16x16xi32>
+  %8 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %9 = tt.addptr %8, %7 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %10 = arith.muli %0, %c16_i32 : i32
+  %11 = tt.splat %10 : i32 -> tensor<16xi32>
+  %12 = arith.addi %11, %2 : tensor<16xi32>
+  %13 = tt.expand_dims %12 {axis = 0 : i32} : tensor<16xi32> -> tensor<1x16xi32>
+  %14 = tt.broadcast %13 : tensor<1x16xi32> -> tensor<16x16xi32>
+  %15 = tt.splat %arg1 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %16 = tt.addptr %15, %14 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %17 = tt.load %9 : tensor<16x16x!tt.ptr<f16>>
+  %18 = tt.load %16 : tensor<16x16x!tt.ptr<f16>>
+  %19 = tt.dot %17, %18, %cst : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+  tt.return %19 : tensor<16x16xf32>
+}
+
+// -----
+
+// Tiles that are already grouped by the kernel and grids that don't index both
+// dot operands are left alone.
+// CHECK-LABEL: @grouped_by_hand
+// CHECK-NOT: tt.get_num_programs
+// CHECK-LABEL: @same_operand
+// CHECK-NOT: tt.get_num_programs
+tt.func public @grouped_by_hand(%arg0: !tt.ptr<f16>, %arg1: i32, %arg2: i32) -> tensor<16x16xf32> {
+  %c16_i32 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32>
+  %0 = tt.get_program_id x : i32
+  %1 = arith.divsi %0, %arg1 : i32
+  %2 = arith.remsi %0, %arg1 : i32
+  %3 = arith.remsi %2, %arg2 : i32
+  %4 = arith.addi %1, %3 : i32
+  %5 = arith.divsi %2, %arg2 : i32
+  %6 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %7 = arith.muli %4, %c16_i32 : i32
+  %8 = tt.splat %7 : i32 -> tensor<16xi32>
+  %9 = arith.addi %8, %6 : tensor<16xi32>
+  %10 = tt.expand_dims %9 {axis = 1 : i32} : tensor<16xi32> -> tensor<16x1xi32>
+  %11 = tt.broadcast %10 : tensor<16x1xi32> -> tensor<16x16xi32>
+  %12 = arith.muli %5, %c16_i32 : i32
+  %13 = tt.splat %12 : i32 -> tensor<16x16xi32>
+  %14 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %15 = tt.addptr %14, %11 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %16 = tt.addptr %14, %13 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %17 = tt.load %15 : tensor<16x16x!tt.ptr<f16>>
+  %18 = tt.load %16 : tensor<16x16x!tt.ptr<f16>>
+  %19 = tt.dot %17, %18, %cst : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+  tt.return %19 : tensor<16x16xf32>
+}
+
+tt.func public @same_operand(%arg0: !tt.ptr<f16>, %arg1: i32) -> tensor<16x16xf32> {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32>
+  %0 = tt.get_program_id x : i32
+  %1 = arith.divsi %0, %arg1 : i32
+  %2 = arith.remsi %0, %arg1 : i32
+  %3 = arith.addi %1, %2 : i32
+  %4 = tt.splat %3 : i32 -> tensor<16x16xi32>
+  %5 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<16x16x!tt.ptr<f16>>
+  %6 = tt.addptr %5, %4 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  %7 = tt.load %6 : tensor<16x16x!tt.ptr<f16>>
+  %8 = tt.dot %7, %7, %cst : tensor<16x16xf16> * tensor<16x16xf16> -> tensor<16x16xf32>
+  tt.return %8 : tensor<16x16xf32>
+}
@@ -0,0 +1,50 @@
+// RUN: triton-opt %s -split-input-file -verify-diagnostics -triton-allocate-workspace | FileCheck %s
+
+// CHECK: module attributes {tt.workspace_size = 388 : i64, tt.workspace_zeroed_size = 260 : i64}
+// CHECK-LABEL: tt.func public @workspaces
+// CHECK-SAME: %[[ARG:.*]]: !tt.ptr<f32>, %[[BUF:.*]]: !tt.ptr<i8> {tt.divisibility = 128 : i32})
+// CHECK: %[[PARTIALS:.*]] = tt.bitcast %[[BUF]] : !tt.ptr<i8> -> !tt.ptr<f32>
+// CHECK: %[[OFF:.*]] = arith.constant 384 : i64
+// CHECK: %[[SCRATCH:.*]] = tt.addptr %[[BUF]], %[[OFF]] : !tt.ptr<i8>, i64
+// CHECK: %[[SCRATCH_I32:.*]] = tt.bitcast %[[SCRATCH]] : !tt.ptr<i8> -> !tt.ptr<i32>
+// CHECK: %[[OFF:.*]] = arith.constant 256 : i64
+// CHECK: %[[FLAGS:.*]] = tt.addptr %[[BUF]], %[[OFF]] : !tt.ptr<i8>, i64
+// CHECK: tt.load %[[PARTIALS]]
+// CHECK: tt.store %[[SCRATCH_I32]]
+// CHECK: tt.store %[[FLAGS]]
+// CHECK-NOT: tt.workspace
+module {
+  tt.func public @workspaces(%arg0: !tt.ptr<f32>) {
+    %0 = tt.workspace {size = 200 : i64, zeroed = true} : !tt.ptr<f32>
+    %1 = tt.workspace {size = 4 : i64, zeroed = false} : !tt.ptr<i32>
+    %2 = tt.workspace {size = 4 : i64, zeroed = true} : !tt.ptr<i8>
+    %3 = tt.load %0 : !tt.ptr<f32>
+    tt.store %arg0, %3 : !tt.ptr<f32>
+    %c1_i32 = arith.constant 1 : i32
+    tt.store %1, %c1_i32 : !tt.ptr<i32>
+    %c1_i8 = arith.constant 1 : i8
+    tt.store %2, %c1_i8 : !tt.ptr<i8>
+    tt.return
+  }
+}
+
+// -----
+
+// CHECK: module {
+// CHECK-LABEL: tt.func public @no_workspace
+// CHECK-SAME: (%{{.*}}: !tt.ptr<f32>)
+module {
+  tt.func public @no_workspace(%arg0: !tt.ptr<f32>) {
+    tt.return
+  }
+}
+
+// -----
+
+module {
+  tt.func private @helper() -> !tt.ptr<i32> {
+    // expected-error @+1 {{workspaces can't be requested by functions that aren't inlined}}
+    %0 = tt.workspace {size = 4 : i64, zeroed = true} : !tt.ptr<i32>
+    tt.return %0 : !tt.ptr<i32>
+  }
+}
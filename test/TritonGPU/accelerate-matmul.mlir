@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file --tritongpu-accelerate-matmul | FileCheck %s
+// RUN: triton-opt %s -split-input-file --tritongpu-accelerate-matmul=reduce-threshold=128 | FileCheck %s --check-prefix=REDUCE
 
 // CHECK: #[[MMA:.+]] = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 16, 16]}>
 // CHECK: #[[MMA1:.+]] = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 64, 16]}>
@@ -142,3 +143,74 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+// CHECK-DAG: #[[$MMA:.+]] = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2], instrShape = [16, 8]}>
+// CHECK-DAG: #[[$SHARED:.+]] = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: sparse_dot
+  tt.func @sparse_dot(%a: tensor<64x32xf16, #blocked>, %b: tensor<64x64xf16, #blocked>, %meta: tensor<64x4xi16, #blocked>) -> tensor<64x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    // CHECK-DAG: %[[A:.+]] = triton_gpu.convert_layout %{{.*}} : tensor<64x32xf16, #blocked> -> tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[$MMA]], kWidth = 2}>>
+    // CHECK-DAG: %[[B:.+]] = triton_gpu.convert_layout %{{.*}} : tensor<64x64xf16, #blocked> -> tensor<64x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[$MMA]], kWidth = 2}>>
+    // CHECK-DAG: %[[META:.+]] = triton_gpu.local_alloc %{{.*}} : (tensor<64x4xi16, #blocked>) -> !tt.memdesc<64x4xi16, #[[$SHARED]], #triton_gpu.shared_memory>
+    // CHECK: triton_gpu.sparse_dot %[[A]], %[[B]], %{{.*}}, %[[META]] : {{.*}} -> tensor<64x64xf32, #[[$MMA]]>
+    %0 = triton_gpu.sparse_dot %a, %b, %cst, %meta : tensor<64x32xf16, #blocked> meta tensor<64x4xi16, #blocked> * tensor<64x64xf16, #blocked> -> tensor<64x64xf32, #blocked>
+    tt.return %0 : tensor<64x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// CHECK: #[[PROD:.+]] = #triton_gpu.blocked<{sizePerThread = [1, 8, 1], threadsPerWarp = [1, 16, 2], warpsPerCTA = [1, 1, 4], order = [1, 2, 0]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: @gemv
+  tt.func @gemv(%a: tensor<1x128xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>, %b: tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>) -> tensor<1x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<1x64xf32, #blocked>
+    // CHECK: arith.extf %{{.*}} : tensor<1x128xf16, #triton_gpu.slice<{dim = 2, parent = #[[PROD]]}>>
+    // CHECK: tt.broadcast %{{.*}} : tensor<1x128x1xf32, #[[PROD]]> -> tensor<1x128x64xf32, #[[PROD]]>
+    // CHECK: arith.extf %{{.*}} : tensor<128x64xf16, #triton_gpu.slice<{dim = 0, parent = #[[PROD]]}>>
+    // CHECK: tt.expand_dims %{{.*}} {axis = 0 : i32} : tensor<128x64xf32, #triton_gpu.slice<{dim = 0, parent = #[[PROD]]}>> -> tensor<1x128x64xf32, #[[PROD]]>
+    // CHECK: arith.mulf %{{.*}} : tensor<1x128x64xf32, #[[PROD]]>
+    // CHECK: "tt.reduce"(%{{.*}}) <{axis = 1 : i32}>
+    // CHECK: arith.addf
+    // CHECK-NOT: tt.dot
+    // CHECK-NOT: warp_group_dot
+    %d = tt.dot %a, %b, %cst : tensor<1x128xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<1x64xf32, #blocked>
+    tt.return %d : tensor<1x64xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The wide sum is taken on tensor cores with a reduce threshold, the narrow one isn't.
+  // REDUCE-LABEL: @sum_on_tensor_cores
+  // CHECK-LABEL: @sum_on_tensor_cores
+  tt.func @sum_on_tensor_cores(%arg0: tensor<64x256xf16, #blocked>, %arg1: tensor<64x64xf16, #blocked>) -> (tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>, tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>) {
+    // REDUCE: %[[ones:.*]] = arith.constant dense<1.000000e+00> : tensor<256x16xf16
+    // REDUCE: %[[dot:.*]] = tt.dot %{{.*}}, %{{.*}}, %{{.*}} : tensor<64x256xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>> * tensor<256x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>> -> tensor<64x16xf32, #mma>
+    // REDUCE: "tt.reduce"(%{{.*}}) <{axis = 1 : i32}>
+    // REDUCE: arith.maximumf
+    // REDUCE: "tt.reduce"(%{{.*}}) <{axis = 1 : i32}>
+    // REDUCE: arith.addf
+    // CHECK-NOT: tt.dot
+    %0 = arith.extf %arg0 : tensor<64x256xf16, #blocked> to tensor<64x256xf32, #blocked>
+    %1 = "tt.reduce"(%0) <{axis = 1 : i32}> ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) : (tensor<64x256xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    %2 = arith.extf %arg1 : tensor<64x64xf16, #blocked> to tensor<64x64xf32, #blocked>
+    %3 = "tt.reduce"(%2) <{axis = 1 : i32}> ({
+    ^bb0(%a: f32, %b: f32):
+      %s = arith.addf %a, %b : f32
+      tt.reduce.return %s : f32
+    }) : (tensor<64x64xf32, #blocked>) -> tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return %1, %3 : tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>, tensor<64xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+  }
+}
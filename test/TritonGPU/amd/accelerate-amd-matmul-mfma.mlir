@@ -0,0 +1,25 @@
+// RUN: triton-opt %s -split-input-file --tritonamdgpu-accelerate-matmul='arch-generation-name=gfx942 matrix-instruction-size=0' | FileCheck %s --check-prefix=MFMA3
+// RUN: triton-opt %s -split-input-file --tritonamdgpu-accelerate-matmul='arch-generation-name=gfx90a matrix-instruction-size=0' | FileCheck %s --check-prefix=MFMA2
+
+// fp8 dots run natively on MFMA3 and are upcast to f16 on older matrix cores.
+
+// MFMA3-LABEL: mfma_dot_fp8_fp8
+// MFMA3-NOT: tt.fp_to_fp
+// MFMA3: tt.dot {{.+}} : tensor<128x64xf8E4M3FNUZ, {{.+}}> * tensor<64x128xf8E4M3FNUZ, {{.+}}> -> tensor<128x128xf32, #triton_gpu.amd_mfma<{{.+}}>>
+// MFMA2-LABEL: mfma_dot_fp8_fp8
+// MFMA2: %[[A:.+]] = triton_gpu.convert_layout %{{.+}} -> tensor<128x64xf8E4M3FNUZ, #triton_gpu.dot_op<{{.+}}>>
+// MFMA2: tt.fp_to_fp %[[A]] : tensor<128x64xf8E4M3FNUZ, {{.+}}> -> tensor<128x64xf16, {{.+}}>
+// MFMA2: tt.fp_to_fp %{{.+}} : tensor<64x128xf8E4M3FNUZ, {{.+}}> -> tensor<64x128xf16, {{.+}}>
+// MFMA2: tt.dot {{.+}} : tensor<128x64xf16, {{.+}}> * tensor<64x128xf16, {{.+}}> -> tensor<128x128xf32, #triton_gpu.amd_mfma<{{.+}}>>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func public @mfma_dot_fp8_fp8(
+      %arg0: tensor<128x64xf8E4M3FNUZ, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>>,
+      %arg1: tensor<64x128xf8E4M3FNUZ, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>>,
+      %arg2: tensor<128x128x!tt.ptr<f32>, #blocked>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+    %0 = tt.dot %arg0, %arg1, %cst : tensor<128x64xf8E4M3FNUZ, #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>> * tensor<64x128xf8E4M3FNUZ, #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>> -> tensor<128x128xf32, #blocked>
+    tt.store %arg2, %0 : tensor<128x128x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
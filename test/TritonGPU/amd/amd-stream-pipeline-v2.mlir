@@ -0,0 +1,78 @@
+// RUN: triton-opt %s -split-input-file -tritonamdgpu-stream-pipeline-v2=num_stages=3 | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritonamdgpu-stream-pipeline-v2 | FileCheck %s --check-prefix=TWO
+
+// With three stages one tile is kept in flight in registers: the loads of
+// iteration i + 2 are issued while the tile of iteration i + 1 is stored into
+// the double-buffered LDS allocation and the tile of iteration i is consumed.
+
+// CHECK-LABEL: tt.func @matmul_loop
+// CHECK: %[[ABUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<2x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// CHECK: %[[BBUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<2x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// CHECK: tt.load
+// CHECK: tt.load
+// CHECK: tt.load
+// CHECK: tt.load
+// CHECK: scf.if
+// CHECK:   triton_gpu.local_store
+// CHECK: scf.if
+// CHECK:   triton_gpu.local_store
+// CHECK: scf.for
+// CHECK:   tt.load
+// CHECK:   tt.load
+// CHECK:   triton_gpu.memdesc_subview %[[ABUFFER]]
+// CHECK:   scf.if
+// CHECK:     triton_gpu.local_store
+// CHECK:   triton_gpu.memdesc_subview %[[BBUFFER]]
+// CHECK:   scf.if
+// CHECK:     triton_gpu.local_store
+// CHECK:   triton_gpu.local_load
+// CHECK:   triton_gpu.local_load
+// CHECK:   tt.dot
+// CHECK:   scf.yield
+// CHECK: triton_gpu.local_dealloc %[[ABUFFER]]
+// CHECK: triton_gpu.local_dealloc %[[BBUFFER]]
+
+// With two stages the next tile is stored into a single LDS buffer after the
+// current one has been consumed, as in the legacy stream pipeliner.
+
+// TWO-LABEL: tt.func @matmul_loop
+// TWO: %[[ABUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<1x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// TWO: %[[BBUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<1x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// TWO: tt.load
+// TWO: tt.load
+// TWO: scf.if
+// TWO:   triton_gpu.local_store
+// TWO: scf.if
+// TWO:   triton_gpu.local_store
+// TWO: scf.for
+// TWO:   tt.load
+// TWO:   tt.load
+// TWO:   triton_gpu.local_load
+// TWO:   triton_gpu.local_load
+// TWO:   tt.dot
+// TWO:   scf.if
+// TWO:     triton_gpu.local_store
+// TWO:   scf.if
+// TWO:     triton_gpu.local_store
+// TWO:   scf.yield
+// TWO: triton_gpu.local_dealloc %[[ABUFFER]]
+// TWO: triton_gpu.local_dealloc %[[BBUFFER]]
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [16, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#mma = #triton_gpu.amd_mfma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 1], instrShape = [32, 32], isTransposed = false}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, triton_gpu.target = "hip:gfx90a", "triton_gpu.threads-per-warp" = 64 : i32} {
+  tt.func @matmul_loop(%lb : index, %ub : index, %step : index, %A : tensor<32x32x!tt.ptr<f16>, #blocked>, %B : tensor<32x32x!tt.ptr<f16>, #blocked>) -> tensor<32x32xf32, #mma> {
+    %cst = arith.constant dense<32> : tensor<32x32xi32, #blocked>
+    %acc_init = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %A, %b_ptr = %B, %acc = %acc_init) -> (tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xf32, #mma>) {
+      %a = tt.load %a_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %b = tt.load %b_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %a_op = triton_gpu.convert_layout %a : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+      %b_op = triton_gpu.convert_layout %b : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+      %c = tt.dot %a_op, %b_op, %acc : tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<32x32xf32, #mma>
+      %next_a_ptr = tt.addptr %a_ptr, %cst : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      %next_b_ptr = tt.addptr %b_ptr, %cst : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xf32, #mma>
+    }
+    tt.return %loop#2 : tensor<32x32xf32, #mma>
+  }
+}
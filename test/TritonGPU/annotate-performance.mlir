@@ -0,0 +1,28 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-annotate-performance | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: @local_alloc
+  // CHECK: triton_gpu.local_alloc %{{.*}} {triton_gpu.perf = {conflict_ways = 2 : i32, live_registers = {{[0-9]+}} : i32, shared_bytes = 4096 : i64, vector_bits = 128 : i32}}
+  tt.func @local_alloc(%arg0: tensor<32x32xf32, #blocked>) {
+    %0 = triton_gpu.local_alloc %arg0 : (tensor<32x32xf32, #blocked>) -> !tt.memdesc<32x32xf32, #shared, #triton_gpu.shared_memory>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [0, 1]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: @convert_layout
+  // CHECK: triton_gpu.convert_layout %{{.*}} {triton_gpu.perf = {conversion = "shared memory", live_registers = {{[0-9]+}} : i32, shared_bytes = {{[0-9]+}} : i64}}
+  // CHECK: triton_gpu.convert_layout %{{.*}} {triton_gpu.perf = {conversion = "registers", live_registers = {{[0-9]+}} : i32}}
+  tt.func @convert_layout(%arg0: tensor<128x128xf16, #blocked0>) -> tensor<128x128xf16, #blocked0> {
+    %0 = triton_gpu.convert_layout %arg0 : tensor<128x128xf16, #blocked0> -> tensor<128x128xf16, #blocked1>
+    %1 = triton_gpu.convert_layout %0 : tensor<128x128xf16, #blocked1> -> tensor<128x128xf16, #blocked0>
+    %2 = triton_gpu.convert_layout %1 : tensor<128x128xf16, #blocked0> -> tensor<128x128xf16, #blocked0>
+    tt.return %2 : tensor<128x128xf16, #blocked0>
+  }
+}
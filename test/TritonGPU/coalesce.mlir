@@ -131,3 +131,22 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+
+// Gathers without a contiguous dimension keep the order of their layout
+// CHECK: [[GATHER_LAYOUT:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [2, 2], order = [1, 0]}>
+// CHECK-LABEL: @gather_keeps_order
+// CHECK: [[PTR:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f16>, [[GATHER_LAYOUT]]>
+// CHECK: tt.load [[PTR]] : tensor<64x64x!tt.ptr<f16>, [[GATHER_LAYOUT]]>
+tt.func public @gather_keeps_order(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: tensor<64x64xi32, #blocked>) -> tensor<64x64xf16, #blocked> {
+  %0 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<64x64x!tt.ptr<f16>, #blocked>
+  %1 = tt.addptr %0, %arg1 : tensor<64x64x!tt.ptr<f16>, #blocked>, tensor<64x64xi32, #blocked>
+  %2 = tt.load %1 : tensor<64x64x!tt.ptr<f16>, #blocked>
+  tt.return %2 : tensor<64x64xf16, #blocked>
+}
+
+}
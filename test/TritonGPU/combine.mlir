@@ -2468,3 +2468,106 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return %5#1, %5#2 : tensor<128xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>, tensor<128xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+// The exp chain is still needed in #blocked for the first store, so
+// rematerializing it would compute it twice. The conversion is cheaper.
+// CHECK-LABEL: @keep_convert_over_expensive_remat
+// CHECK-COUNT-3: math.exp
+// CHECK-NOT: math.exp
+// CHECK: triton_gpu.convert_layout
+tt.func @keep_convert_over_expensive_remat(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked>
+  %1 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %2 = tt.addptr %0, %1 : tensor<64x!tt.ptr<f32>, #blocked>, tensor<64xi32, #blocked>
+  %3 = tt.load %2 : tensor<64x!tt.ptr<f32>, #blocked>
+  %4 = math.exp %3 : tensor<64xf32, #blocked>
+  %5 = math.exp %4 : tensor<64xf32, #blocked>
+  %6 = math.exp %5 : tensor<64xf32, #blocked>
+  tt.store %2, %6 : tensor<64x!tt.ptr<f32>, #blocked>
+  %7 = triton_gpu.convert_layout %6 : tensor<64xf32, #blocked> -> tensor<64xf32, #blocked1>
+  %8 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked1>
+  %9 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked1>
+  %10 = tt.addptr %8, %9 : tensor<64x!tt.ptr<f32>, #blocked1>, tensor<64xi32, #blocked1>
+  tt.store %10, %7 : tensor<64x!tt.ptr<f32>, #blocked1>
+  tt.return
+}
+
+// Without other users the chain is moved to the new layout for free.
+// CHECK-LABEL: @remat_single_use_chain
+// CHECK-COUNT-3: math.exp
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: tt.return
+tt.func @remat_single_use_chain(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %0 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked>
+  %1 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %2 = tt.addptr %0, %1 : tensor<64x!tt.ptr<f32>, #blocked>, tensor<64xi32, #blocked>
+  %3 = tt.load %2 : tensor<64x!tt.ptr<f32>, #blocked>
+  %4 = math.exp %3 : tensor<64xf32, #blocked>
+  %5 = math.exp %4 : tensor<64xf32, #blocked>
+  %6 = math.exp %5 : tensor<64xf32, #blocked>
+  %7 = triton_gpu.convert_layout %6 : tensor<64xf32, #blocked> -> tensor<64xf32, #blocked1>
+  %8 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked1>
+  %9 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked1>
+  %10 = tt.addptr %8, %9 : tensor<64x!tt.ptr<f32>, #blocked1>, tensor<64xi32, #blocked1>
+  tt.store %10, %7 : tensor<64x!tt.ptr<f32>, #blocked1>
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The amax of an accumulator is reduced along each axis of the MMA layout
+  // instead of converting the accumulator for the 1D reshape.
+  // CHECK-LABEL: @full_reduction_of_mma
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK-NOT: tt.reshape
+  // CHECK: "tt.reduce"(%{{.*}}) <{axis = 1 : i32}>
+  // CHECK: arith.maxnumf
+  // CHECK: (tensor<128x64xf32, #mma>) -> tensor<128xf32, #triton_gpu.slice<{dim = 1, parent = #mma}>>
+  // CHECK: "tt.reduce"(%{{.*}}) <{axis = 0 : i32}>
+  // CHECK: arith.maxnumf
+  // CHECK: (tensor<128xf32, #triton_gpu.slice<{dim = 1, parent = #mma}>>) -> f32
+  tt.func public @full_reduction_of_mma(%arg0: tensor<128x64xf32, #mma>) -> f32 {
+    %0 = math.absf %arg0 : tensor<128x64xf32, #mma>
+    %1 = triton_gpu.convert_layout %0 : tensor<128x64xf32, #mma> -> tensor<128x64xf32, #blocked>
+    %2 = tt.reshape %1 {allow_reorder = true} : tensor<128x64xf32, #blocked> -> tensor<8192xf32, #blocked1>
+    %3 = "tt.reduce"(%2) <{axis = 0 : i32}> ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %4 = arith.maxnumf %arg1, %arg2 : f32
+      tt.reduce.return %4 : f32
+    }) : (tensor<8192xf32, #blocked1>) -> f32
+    tt.return %3 : f32
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The add can take either layout at the same local cost, which picks mma.
+  // Its blocked operand and its store would then need two conversions, the
+  // joint refinement keeps it blocked and converts the mma operand only.
+  // CHECK-LABEL: @conflict_refined_by_neighbours
+  // CHECK: %[[CVT:.*]] = triton_gpu.convert_layout %{{.*}} : tensor<64x64xf32, #mma> -> tensor<64x64xf32, #blocked>
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: %[[ADD:.*]] = arith.addf %{{.*}}, %[[CVT]] : tensor<64x64xf32, #blocked>
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.store %{{.*}}, %[[ADD]] : tensor<64x64x!tt.ptr<f32>, #blocked>
+  tt.func public @conflict_refined_by_neighbours(%arg0: tensor<64x64xf32, #blocked>, %arg1: tensor<64x64xf32, #mma>, %arg2: tensor<64x64x!tt.ptr<f32>, #blocked>) {
+    %0 = triton_gpu.convert_layout %arg1 : tensor<64x64xf32, #mma> -> tensor<64x64xf32, #blocked>
+    %1 = arith.addf %arg0, %0 : tensor<64x64xf32, #blocked>
+    tt.store %arg2, %1 : tensor<64x64x!tt.ptr<f32>, #blocked>
+    tt.return
+  }
+}
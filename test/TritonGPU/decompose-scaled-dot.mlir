@@ -0,0 +1,34 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-decompose-scaled-dot | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: @dot_scaled_e5m2_bf16
+  tt.func @dot_scaled_e5m2_bf16(%a: tensor<128x64xf8E5M2, #blocked>, %scale: tensor<128x2xi8, #blocked>, %b: tensor<64x128xbf16, #blocked>, %c: tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #mma> {
+    // CHECK-NOT: tt.dot_scaled
+    // CHECK: tt.bitcast %{{.*}} : tensor<128x64xf8E5M2, #{{.*}}> -> tensor<128x64xi8, #{{.*}}>
+    // CHECK: tt.reshape %{{.*}} : tensor<128x64xbf16, #{{.*}}> -> tensor<128x2x32xbf16, #{{.*}}>
+    // CHECK: tt.broadcast %{{.*}} : tensor<128x2x1xbf16, #{{.*}}> -> tensor<128x2x32xbf16, #{{.*}}>
+    // CHECK: arith.mulf %{{.*}} : tensor<128x2x32xbf16, #{{.*}}>
+    // CHECK: tt.dot %{{.*}} : tensor<128x64xbf16, #triton_gpu.dot_op<{opIdx = 0, parent = #{{.*}}}>> * tensor<64x128xbf16, #triton_gpu.dot_op<{opIdx = 1, parent = #{{.*}}}>> -> tensor<128x128xf32, #{{.*}}>
+    // CHECK-NOT: tt.dot_scaled
+    %0 = tt.dot_scaled %a scale %scale, %b, %c lhs = e5m2 rhs = bf16 : tensor<128x64xf8E5M2, #blocked>, tensor<128x2xi8, #blocked> * tensor<64x128xbf16, #blocked> -> tensor<128x128xf32, #mma>
+    tt.return %0 : tensor<128x128xf32, #mma>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 8]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: @dot_scaled_e2m1_bf16
+  tt.func @dot_scaled_e2m1_bf16(%a: tensor<128x32xi8, #blocked>, %scale: tensor<128x2xi8, #blocked>, %b: tensor<64x128xbf16, #blocked>, %c: tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #mma> {
+    // CHECK: tt.join %{{.*}} : tensor<128x32xbf16, #{{.*}}> -> tensor<128x32x2xbf16, #{{.*}}>
+    // CHECK: tt.reshape %{{.*}} : tensor<128x32x2xbf16, #{{.*}}> -> tensor<128x64xbf16, #{{.*}}>
+    // CHECK: tt.dot %{{.*}} : tensor<128x64xbf16, #{{.*}}> * tensor<64x128xbf16, #{{.*}}> -> tensor<128x128xf32, #{{.*}}>
+    // CHECK-NOT: tt.dot_scaled
+    %0 = tt.dot_scaled %a scale %scale, %b, %c lhs = e2m1 rhs = bf16 : tensor<128x32xi8, #blocked>, tensor<128x2xi8, #blocked> * tensor<64x128xbf16, #blocked> -> tensor<128x128xf32, #mma>
+    tt.return %0 : tensor<128x128xf32, #mma>
+  }
+}
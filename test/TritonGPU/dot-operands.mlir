@@ -159,6 +159,45 @@ tt.func @update_kwidth_slice(
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.target" = "cuda:80"} {
+
+// The loop-invariant scale of the dequantized weight is converted to the dot
+// operand layout once, before the loop, while the int8 weight is converted
+// right after its load and upcast in registers.
+
+// CHECK: tt.func @dequant_weight_loop_invariant_scale
+// CHECK: %[[SCALE:.*]] = tt.broadcast
+// CHECK: %[[SCALE_CVT:.*]] = triton_gpu.convert_layout %[[SCALE]] : tensor<32x64xbf16, #{{.*}}> -> tensor<32x64xbf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+// CHECK: scf.for
+// CHECK:   %[[W:.*]] = tt.load
+// CHECK:   %[[W_CVT:.*]] = triton_gpu.convert_layout %[[W]] : tensor<32x64xi8, #{{.*}}> -> tensor<32x64xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+// CHECK:   %[[W_BF16:.*]] = arith.sitofp %[[W_CVT]]
+// CHECK:   %[[B:.*]] = arith.mulf %[[W_BF16]], %[[SCALE_CVT]]
+// CHECK:   tt.dot %{{.*}}, %[[B]], %{{.*}}
+tt.func @dequant_weight_loop_invariant_scale(
+                   %a: tensor<16x32xbf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>,
+                   %pw: tensor<32x64x!tt.ptr<i8>, #blocked>,
+                   %scale: tensor<1x64xbf16, #blocked>,
+                   %lb: index, %ub: index, %step: index) -> tensor<16x64xf32, #mma> {
+  %c = arith.constant dense<0.000000e+00> : tensor<16x64xf32, #mma>
+  %s = tt.broadcast %scale : tensor<1x64xbf16, #blocked> -> tensor<32x64xbf16, #blocked>
+  %r = scf.for %iv = %lb to %ub step %step iter_args(%acc = %c) -> (tensor<16x64xf32, #mma>) {
+    %w = tt.load %pw : tensor<32x64x!tt.ptr<i8>, #blocked>
+    %wf = arith.sitofp %w : tensor<32x64xi8, #blocked> to tensor<32x64xbf16, #blocked>
+    %ws = arith.mulf %wf, %s : tensor<32x64xbf16, #blocked>
+    %b = triton_gpu.convert_layout %ws : tensor<32x64xbf16, #blocked> -> tensor<32x64xbf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+    %d = tt.dot %a, %b, %acc : tensor<16x32xbf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<32x64xbf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<16x64xf32, #mma>
+    scf.yield %d : tensor<16x64xf32, #mma>
+  }
+  tt.return %r : tensor<16x64xf32, #mma>
+}
+
+}
+
+// -----
+
 #mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 64, 16]}>
 #shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
 #shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
@@ -189,6 +228,56 @@ tt.func @mma_v3_reg_operand_A_fp8(%arg0: tensor<128x64xf8E5M2, #mma>, %arg1: !tt
 }
 }
 
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK: tt.func @mma_v3_reg_operand_A_dequantized
+//    CHECK: %[[CVT:.+]] = triton_gpu.convert_layout %{{.*}} : tensor<128x64xf16, #blocked> -> tensor<128x64xf16, #mma>
+//    CHECK: %[[A:.+]] = triton_gpu.convert_layout %[[CVT]] : tensor<128x64xf16, #mma> -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+//    CHECK: triton_nvidia_gpu.warp_group_dot %[[A]], {{.*}} : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+tt.func @mma_v3_reg_operand_A_dequantized(%arg0: tensor<128x64x!tt.ptr<i8>, #blocked>, %arg1: !tt.memdesc<64x64xf16, #shared>, %arg2: tensor<128x64xf32, #mma>, %arg3: f16) -> tensor<128x64xf32, #mma>{
+  %0 = tt.load %arg0 : tensor<128x64x!tt.ptr<i8>, #blocked>
+  %1 = arith.sitofp %0 : tensor<128x64xi8, #blocked> to tensor<128x64xf16, #blocked>
+  %2 = tt.splat %arg3 : f16 -> tensor<128x64xf16, #blocked>
+  %3 = arith.mulf %1, %2 : tensor<128x64xf16, #blocked>
+  %A = triton_gpu.local_alloc %3 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared>
+  %r = triton_nvidia_gpu.warp_group_dot %A, %arg1, %arg2 : !tt.memdesc<128x64xf16, #shared> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+  tt.return %r : tensor<128x64xf32, #mma>
+}
+
+// An lhs allocated before the loop stays in shmem.
+// CHECK: tt.func @mma_v3_shmem_operand_A_loop_invariant
+//    CHECK: %[[A:.+]] = triton_gpu.local_alloc
+//    CHECK: scf.for
+//    CHECK: triton_nvidia_gpu.warp_group_dot %[[A]], {{.*}} : !tt.memdesc<128x64xf16, #shared> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+tt.func @mma_v3_shmem_operand_A_loop_invariant(%arg0: tensor<128x64x!tt.ptr<i8>, #blocked>, %arg1: !tt.memdesc<64x64xf16, #shared>, %arg2: tensor<128x64xf32, #mma>, %lb: i32, %ub: i32, %step: i32) -> tensor<128x64xf32, #mma>{
+  %0 = tt.load %arg0 : tensor<128x64x!tt.ptr<i8>, #blocked>
+  %1 = arith.sitofp %0 : tensor<128x64xi8, #blocked> to tensor<128x64xf16, #blocked>
+  %A = triton_gpu.local_alloc %1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared>
+  %r = scf.for %iv = %lb to %ub step %step iter_args(%acc = %arg2) -> (tensor<128x64xf32, #mma>) : i32 {
+    %d = triton_nvidia_gpu.warp_group_dot %A, %arg1, %acc : !tt.memdesc<128x64xf16, #shared> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+    scf.yield %d : tensor<128x64xf32, #mma>
+  }
+  tt.return %r : tensor<128x64xf32, #mma>
+}
+
+// Loads of fp16 are better read by the wgmma from shmem.
+// CHECK: tt.func @mma_v3_shmem_operand_A_scaled
+//    CHECK: %[[A:.+]] = triton_gpu.local_alloc
+//    CHECK: triton_nvidia_gpu.warp_group_dot %[[A]], {{.*}} : !tt.memdesc<128x64xf16, #shared> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+tt.func @mma_v3_shmem_operand_A_scaled(%arg0: tensor<128x64x!tt.ptr<f16>, #blocked>, %arg1: !tt.memdesc<64x64xf16, #shared>, %arg2: tensor<128x64xf32, #mma>, %arg3: f16) -> tensor<128x64xf32, #mma>{
+  %0 = tt.load %arg0 : tensor<128x64x!tt.ptr<f16>, #blocked>
+  %1 = tt.splat %arg3 : f16 -> tensor<128x64xf16, #blocked>
+  %2 = arith.mulf %0, %1 : tensor<128x64xf16, #blocked>
+  %A = triton_gpu.local_alloc %2 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared>
+  %r = triton_nvidia_gpu.warp_group_dot %A, %arg1, %arg2 : !tt.memdesc<128x64xf16, #shared> * !tt.memdesc<64x64xf16, #shared> -> tensor<128x64xf32, #mma>
+  tt.return %r : tensor<128x64xf32, #mma>
+}
+}
+
 // -----
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
 #mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2], instrShape = [16, 8]}>
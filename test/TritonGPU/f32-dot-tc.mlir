@@ -0,0 +1,37 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-F32DotTC | FileCheck %s
+
+// CHECK-LABEL: @dot_bf16x3
+tt.func @dot_bf16x3(%a: tensor<16x16xf32>, %b: tensor<16x16xf32>, %c: tensor<16x16xf32>) -> tensor<16x16xf32> {
+  // CHECK: %[[A_HI:.*]] = arith.truncf %{{.*}} : tensor<16x16xf32> to tensor<16x16xbf16>
+  // CHECK: %[[A_HI_F32:.*]] = arith.extf %[[A_HI]]
+  // CHECK: %[[A_REM:.*]] = arith.subf %{{.*}}, %[[A_HI_F32]]
+  // CHECK: %[[A_LO:.*]] = arith.truncf %[[A_REM]]
+  // CHECK: %[[B_HI:.*]] = arith.truncf
+  // CHECK: %[[B_LO:.*]] = arith.truncf
+  // CHECK: %[[D0:.*]] = tt.dot %[[A_HI]], %[[B_LO]], %{{.*}} : tensor<16x16xbf16> * tensor<16x16xbf16> -> tensor<16x16xf32>
+  // CHECK: %[[D1:.*]] = tt.dot %[[A_LO]], %[[B_HI]], %[[D0]]
+  // CHECK: tt.dot %[[A_HI]], %[[B_HI]], %[[D1]]
+  // CHECK-NOT: tt.dot
+  %0 = tt.dot %a, %b, %c, inputPrecision = bf16x3 : tensor<16x16xf32> * tensor<16x16xf32> -> tensor<16x16xf32>
+  tt.return %0 : tensor<16x16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @dot_bf16x6
+tt.func @dot_bf16x6(%a: tensor<16x16xf32>, %b: tensor<16x16xf32>, %c: tensor<16x16xf32>) -> tensor<16x16xf32> {
+  // CHECK-COUNT-6: tt.dot {{.*}} : tensor<16x16xbf16> * tensor<16x16xbf16> -> tensor<16x16xf32>
+  // CHECK-NOT: tt.dot
+  %0 = tt.dot %a, %b, %c, inputPrecision = bf16x6 : tensor<16x16xf32> * tensor<16x16xf32> -> tensor<16x16xf32>
+  tt.return %0 : tensor<16x16xf32>
+}
+
+// -----
+
+// CHECK-LABEL: @dot_bf16x9
+tt.func @dot_bf16x9(%a: tensor<16x16xf32>, %b: tensor<16x16xf32>, %c: tensor<16x16xf32>) -> tensor<16x16xf32> {
+  // CHECK-COUNT-9: tt.dot {{.*}} : tensor<16x16xbf16> * tensor<16x16xbf16> -> tensor<16x16xf32>
+  // CHECK-NOT: tt.dot
+  %0 = tt.dot %a, %b, %c, inputPrecision = bf16x9 : tensor<16x16xf32> * tensor<16x16xf32> -> tensor<16x16xf32>
+  tt.return %0 : tensor<16x16xf32>
+}
@@ -45,3 +45,68 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [2, 16], warpsPerCTA = [8, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // The buffers are only written before the loop, so a single fence after the
+  // writes covers both wgmmas.
+  // CHECK-LABEL: fence_per_buffer
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: triton_nvidia_gpu.fence_async_shared
+  // CHECK-NEXT: scf.for
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: triton_nvidia_gpu.warp_group_dot
+  // CHECK-NOT: triton_nvidia_gpu.fence_async_shared
+  // CHECK: triton_nvidia_gpu.warp_group_dot
+  tt.func public @fence_per_buffer(%arg0: tensor<128x128xf16, #blocked>, %arg1: tensor<128x64xf16, #blocked>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %0 = triton_gpu.local_alloc : () -> !tt.memdesc<2x128x128xf16, #shared, mutable>
+    %1 = triton_gpu.local_alloc %arg1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared1>
+    %2 = triton_gpu.memdesc_subview %0[%c0_i32, %c0_i32, %c0_i32] : !tt.memdesc<2x128x128xf16, #shared, mutable> -> !tt.memdesc<128x128xf16, #shared, mutable>
+    triton_gpu.local_store %arg0, %2 : tensor<128x128xf16, #blocked> -> !tt.memdesc<128x128xf16, #shared, mutable>
+    %3 = scf.for %iv = %c0_i32 to %c64_i32 step %c1_i32 iter_args(%acc = %cst) -> (tensor<128x64xf32, #mma>) : i32 {
+      %idx = arith.remsi %iv, %c1_i32 : i32
+      %4 = triton_gpu.memdesc_subview %0[%idx, %c0_i32, %c0_i32] : !tt.memdesc<2x128x128xf16, #shared, mutable> -> !tt.memdesc<128x128xf16, #shared, mutable>
+      %5 = triton_nvidia_gpu.warp_group_dot %4, %1, %acc : !tt.memdesc<128x128xf16, #shared, mutable> * !tt.memdesc<128x64xf16, #shared1> -> tensor<128x64xf32, #mma>
+      %6 = triton_nvidia_gpu.warp_group_dot %4, %1, %5 : !tt.memdesc<128x128xf16, #shared, mutable> * !tt.memdesc<128x64xf16, #shared1> -> tensor<128x64xf32, #mma>
+      scf.yield %6 : tensor<128x64xf32, #mma>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [2, 16], warpsPerCTA = [8, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [8, 1], instrShape = [16, 64, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 8 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: fence_in_writing_loop
+  // CHECK: scf.for
+  // CHECK: triton_gpu.local_store
+  // CHECK-NEXT: triton_nvidia_gpu.fence_async_shared
+  // CHECK-NEXT: triton_nvidia_gpu.warp_group_dot
+  tt.func public @fence_in_writing_loop(%arg0: tensor<128x128xf16, #blocked>, %arg1: tensor<128x64xf16, #blocked>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32, #mma>
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %0 = triton_gpu.local_alloc : () -> !tt.memdesc<128x128xf16, #shared, mutable>
+    %1 = triton_gpu.local_alloc %arg1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared1>
+    %2 = scf.for %iv = %c0_i32 to %c64_i32 step %c1_i32 iter_args(%acc = %cst) -> (tensor<128x64xf32, #mma>) : i32 {
+      triton_gpu.local_store %arg0, %0 : tensor<128x128xf16, #blocked> -> !tt.memdesc<128x128xf16, #shared, mutable>
+      %3 = triton_nvidia_gpu.warp_group_dot %0, %1, %acc : !tt.memdesc<128x128xf16, #shared, mutable> * !tt.memdesc<128x64xf16, #shared1> -> tensor<128x64xf32, #mma>
+      scf.yield %3 : tensor<128x64xf32, #mma>
+    }
+    tt.return
+  }
+}
@@ -81,3 +81,13 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
     tt.return
   }
 }
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  tt.func @sparse_dot_meta_shape(%A: tensor<16x16xf16>, %B: tensor<32x16xf16>, %C: tensor<16x16xf32>, %M: tensor<16x1xi16>) {
+    // expected-error@+1 {{expected the metadata to be of shape [M, K / 16]}}
+    %D = triton_gpu.sparse_dot %A, %B, %C, %M : tensor<16x16xf16> meta tensor<16x1xi16> * tensor<32x16xf16> -> tensor<16x16xf32>
+    tt.return
+  }
+}
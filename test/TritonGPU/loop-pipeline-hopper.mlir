@@ -692,16 +692,59 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
   }
 }
 
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#mma1 = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 16, 16]}>
+#shared1 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [0, 1], hasLeadingOffset = true}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // An lhs in registers that is recomputed by the loop must not be rewritten
+  // by the next iteration while the dot reads it, so the dot isn't async and
+  // the lhs is threaded through its wait.
+  // CHECK-LABEL: dot_reg_operand_A_in_loop
+  tt.func @dot_reg_operand_A_in_loop(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: f16) -> tensor<128x16xf32, #mma1> {
+    %cst = arith.constant dense<0> : tensor<64x16xi32, #blocked>
+    %c0_i32 = arith.constant 0 : i32
+    %cst_2 = arith.constant dense<0.000000e+00> : tensor<128x16xf32, #mma1>
+    %c1_i32 = arith.constant 1 : i32
+    %c8_i32 = arith.constant 8 : i32
+    %10 = tt.splat %arg0 : !tt.ptr<f16> -> tensor<1x16x!tt.ptr<f16>, #blocked>
+    %12 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    %13 = tt.expand_dims %12 {axis = 1 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>> -> tensor<64x1xi32, #blocked>
+    %14 = tt.broadcast %10 : tensor<1x16x!tt.ptr<f16>, #blocked> -> tensor<64x16x!tt.ptr<f16>, #blocked>
+    %15 = tt.broadcast %13 : tensor<64x1xi32, #blocked> -> tensor<64x16xi32, #blocked>
+    %16 = tt.addptr %14, %15 : tensor<64x16x!tt.ptr<f16>, #blocked>, tensor<64x16xi32, #blocked>
+    // CHECK: scf.for
+    // CHECK:   %[[A:.+]] = tt.splat %{{.*}} : f16 -> tensor<128x64xf16
+    // CHECK:   %[[DOT:.+]] = triton_nvidia_gpu.warp_group_dot %[[A]]
+    // CHECK-NEXT: triton_nvidia_gpu.warp_group_dot_wait %[[DOT]], %{{.*}}, %[[A]] {pendings = 0 : i32}
+    // CHECK:   scf.yield
+    %17:3 = scf.for %arg3 = %c0_i32 to %c8_i32 step %c1_i32 iter_args(%arg4 = %cst_2, %arg5 = %16, %arg6 = %arg1) -> (tensor<128x16xf32, #mma1>, tensor<64x16x!tt.ptr<f16>, #blocked>, f16)  : i32 {
+      %18 = tt.load %arg5 : tensor<64x16x!tt.ptr<f16>, #blocked>
+      %20 = triton_gpu.local_alloc %18 : (tensor<64x16xf16, #blocked>) -> !tt.memdesc<64x16xf16, #shared1, #triton_gpu.shared_memory>
+      %21 = tt.splat %arg6 : f16 -> tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma1}>>
+      %acc = triton_nvidia_gpu.warp_group_dot %21, %20, %arg4 : tensor<128x64xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma1}>> * !tt.memdesc<64x16xf16, #shared1, #triton_gpu.shared_memory> -> tensor<128x16xf32, #mma1>
+      %22 = tt.addptr %arg5, %cst : tensor<64x16x!tt.ptr<f16>, #blocked>, tensor<64x16xi32, #blocked>
+      %23 = arith.addf %arg6, %arg1 : f16
+      scf.yield %acc, %22, %23 : tensor<128x16xf32, #mma1>, tensor<64x16x!tt.ptr<f16>, #blocked>, f16
+    }
+    tt.return %17#0 : tensor<128x16xf32, #mma1>
+  }
+}
+
 // -----
 // Test pipelining of experimental_descriptor_store
 #blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
   // CHECK-LABEL: tma_store_pipeline
+  // CHECK: %[[ALLOC:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<2x1xf32
+  // CHECK: scf.for
+  // CHECK: %[[BUF:.*]] = triton_gpu.memdesc_subview %[[ALLOC]]
   tt.func public @tma_store_pipeline(%arg0: tensor<1xf32, #blocked>, %arg1: !tt.ptr<i8>, %arg2: i32, %arg3: i32) attributes {noinline = false} {
     %c0_i32 = arith.constant 0 : i32
     scf.for %arg4 = %c0_i32 to %arg3 step %arg2  : i32 {
       %1 = arith.divsi %arg4, %arg2 : i32
-      // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+      // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 1 : i32}
       // CHECK-NEXT: triton_gpu.local_store
       // CHECK-NEXT: triton_nvidia_gpu.fence_async_shared
       // CHECK-NEXT: triton_nvidia_gpu.async_tma_copy_local_to_global
@@ -710,3 +753,51 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+// Double-buffered TMA stores: each store waits only for the copy that last
+// used its buffer, two iterations ago.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: tma_store_pipeline_multi
+  // CHECK-COUNT-2: triton_gpu.local_alloc  : () -> !tt.memdesc<2x1xf32
+  // CHECK: scf.for
+  // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 3 : i32}
+  // CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+  // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 3 : i32}
+  // CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global
+  // CHECK: }
+  // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+  // CHECK-COUNT-2: triton_gpu.local_dealloc
+  tt.func public @tma_store_pipeline_multi(%arg0: tensor<1xf32, #blocked>, %arg1: !tt.ptr<i8>, %arg2: !tt.ptr<i8>, %arg3: i32, %arg4: i32) attributes {noinline = false} {
+    %c0_i32 = arith.constant 0 : i32
+    scf.for %arg5 = %c0_i32 to %arg4 step %arg3  : i32 {
+      %1 = arith.divsi %arg5, %arg3 : i32
+      tt.experimental_descriptor_store %arg1[%1], %arg0 : !tt.ptr<i8>, tensor<1xf32, #blocked>
+      tt.experimental_descriptor_store %arg2[%1], %arg0 : !tt.ptr<i8>, tensor<1xf32, #blocked>
+    }
+    tt.return
+  }
+}
+
+// -----
+// A conditional TMA store keeps a single buffer and waits for all copies.
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: tma_store_pipeline_cond
+  // CHECK: triton_gpu.local_alloc  : () -> !tt.memdesc<1xf32
+  // CHECK: scf.for
+  // CHECK: scf.if
+  // CHECK: triton_nvidia_gpu.async_tma_store_wait {pendings = 0 : i32}
+  // CHECK-NEXT: triton_gpu.local_store
+  tt.func public @tma_store_pipeline_cond(%arg0: tensor<1xf32, #blocked>, %arg1: !tt.ptr<i8>, %arg2: i32, %arg3: i32, %arg4: i1) attributes {noinline = false} {
+    %c0_i32 = arith.constant 0 : i32
+    scf.for %arg5 = %c0_i32 to %arg3 step %arg2  : i32 {
+      %1 = arith.divsi %arg5, %arg2 : i32
+      scf.if %arg4 {
+        tt.experimental_descriptor_store %arg1[%1], %arg0 : !tt.ptr<i8>, tensor<1xf32, #blocked>
+      }
+    }
+    tt.return
+  }
+}
@@ -0,0 +1,55 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=3 | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=2 | FileCheck %s --check-prefix=TWO
+
+// Without cp.async the loads are staged through registers: the loads of
+// iteration i + 2 are issued while the tile of iteration i + 1 is stored into
+// the double-buffered shared memory and the tile of iteration i is consumed.
+
+// CHECK-LABEL: tt.func @matmul_loop
+// CHECK: %[[ABUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<2x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// CHECK: %[[BBUFFER:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<2x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// CHECK-NOT: triton_gpu.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK:   tt.load
+// CHECK:   tt.load
+// CHECK:   triton_gpu.memdesc_subview %[[ABUFFER]]
+// CHECK:   triton_gpu.local_store
+// CHECK:   triton_gpu.memdesc_subview %[[BBUFFER]]
+// CHECK:   triton_gpu.local_store
+// CHECK:   triton_gpu.local_load
+// CHECK:   triton_gpu.local_load
+// CHECK:   tt.dot
+// CHECK:   scf.yield
+// CHECK: triton_gpu.local_dealloc %[[ABUFFER]]
+// CHECK: triton_gpu.local_dealloc %[[BBUFFER]]
+
+// TWO-LABEL: tt.func @matmul_loop
+// TWO: triton_gpu.local_alloc  : () -> !tt.memdesc<1x32x32xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// TWO: scf.for
+// TWO:   tt.load
+// TWO:   tt.load
+// TWO:   triton_gpu.local_load
+// TWO:   triton_gpu.local_load
+// TWO:   tt.dot
+// TWO:   triton_gpu.local_store
+// TWO:   triton_gpu.local_store
+// TWO:   scf.yield
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 1, versionMinor = 0, warpsPerCTA = [1, 1]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32, triton_gpu.target = "cuda:70", "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func @matmul_loop(%lb : index, %ub : index, %step : index, %A : tensor<32x32x!tt.ptr<f16>, #blocked>, %B : tensor<32x32x!tt.ptr<f16>, #blocked>) -> tensor<32x32xf32, #mma> {
+    %cst = arith.constant dense<32> : tensor<32x32xi32, #blocked>
+    %acc_init = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %A, %b_ptr = %B, %acc = %acc_init) -> (tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xf32, #mma>) {
+      %a = tt.load %a_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %b = tt.load %b_ptr : tensor<32x32x!tt.ptr<f16>, #blocked>
+      %a_op = triton_gpu.convert_layout %a : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+      %b_op = triton_gpu.convert_layout %b : tensor<32x32xf16, #blocked> -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>>
+      %c = tt.dot %a_op, %b_op, %acc : tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>> * tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>> -> tensor<32x32xf32, #mma>
+      %next_a_ptr = tt.addptr %a_ptr, %cst : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      %next_b_ptr = tt.addptr %b_ptr, %cst : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xi32, #blocked>
+      scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32x!tt.ptr<f16>, #blocked>, tensor<32x32xf32, #mma>
+    }
+    tt.return %loop#2 : tensor<32x32xf32, #mma>
+  }
+}
@@ -1559,6 +1559,172 @@ module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 :
   }
 }
 
+// -----
+
+// A while loop counting up to a dynamic bound is pipelined as a for loop.
+// CHECK-LABEL: @while_add_kernel
+// CHECK-NOT: scf.while
+// CHECK: triton_gpu.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK: triton_gpu.local_load
+// CHECK: triton_gpu.async_copy_global_to_local
+// CHECK: scf.yield
+// CHECK: tt.return %{{.*}} : i32
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:90", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @while_add_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg3: i32 {tt.divisibility = 16 : i32, tt.max_divisibility = 16 : i32}) -> i32 attributes {noinline = false} {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg3 : i32 -> tensor<1024xi32, #blocked>
+    %2 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %3 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %4 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %5 = scf.while (%arg4 = %c0_i32) : (i32) -> i32 {
+      %6 = arith.cmpi slt, %arg4, %arg3 : i32
+      scf.condition(%6) %arg4 : i32
+    } do {
+    ^bb0(%arg4: i32):
+      %7 = tt.splat %arg4 : i32 -> tensor<1024xi32, #blocked>
+      %8 = arith.addi %7, %0 : tensor<1024xi32, #blocked>
+      %9 = arith.cmpi slt, %8, %1 : tensor<1024xi32, #blocked>
+      %10 = tt.addptr %2, %8 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %11 = tt.load %10, %9, %cst : tensor<1024x!tt.ptr<f32>, #blocked>
+      %12 = tt.addptr %3, %8 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %13 = tt.load %12, %9, %cst : tensor<1024x!tt.ptr<f32>, #blocked>
+      %14 = arith.addf %11, %13 : tensor<1024xf32, #blocked>
+      %15 = tt.addptr %4, %8 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      tt.store %15, %14, %9 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %16 = arith.addi %arg4, %c1024_i32 : i32
+      scf.yield %16 : i32
+    }
+    tt.return %5 : i32
+  }
+}
+
+// -----
+
+// Loads streamed into a reduction are pipelined without a num_stages
+// attribute on the loop.
+// CHECK-LABEL: @row_sum_kernel
+// CHECK: triton_gpu.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK: triton_gpu.local_load
+// CHECK: "tt.reduce"
+// CHECK: triton_gpu.async_copy_global_to_local
+// CHECK: scf.yield
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @row_sum_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32 {tt.divisibility = 16 : i32}) attributes {noinline = false} {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %cst = arith.constant 0.000000e+00 : f32
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %2 = scf.for %arg3 = %c0_i32 to %arg2 step %c1024_i32 iter_args(%arg4 = %cst) -> (f32)  : i32 {
+      %3 = tt.splat %arg3 : i32 -> tensor<1024xi32, #blocked>
+      %4 = arith.addi %3, %0 : tensor<1024xi32, #blocked>
+      %5 = tt.addptr %1, %4 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %6 = tt.load %5 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %7 = "tt.reduce"(%6) <{axis = 0 : i32}> ({
+      ^bb0(%arg5: f32, %arg6: f32):
+        %9 = arith.addf %arg5, %arg6 : f32
+        tt.reduce.return %9 : f32
+      }) : (tensor<1024xf32, #blocked>) -> f32
+      %8 = arith.addf %arg4, %7 : f32
+      scf.yield %8 : f32
+    }
+    tt.store %arg1, %2 : !tt.ptr<f32>
+    tt.return
+  }
+}
+
+// -----
+
+// Streaming loops that store to global memory are not pipelined, their next
+// loads could read the stores of the current iteration.
+// CHECK-LABEL: @in_place_scale_kernel
+// CHECK-NOT: triton_gpu.async_copy_global_to_local
+// CHECK: scf.for
+// CHECK: tt.load
+// CHECK: tt.store
+// CHECK: scf.yield
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @in_place_scale_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}) attributes {noinline = false} {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %cst = arith.constant dense<2.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    scf.for %arg2 = %c0_i32 to %arg1 step %c1024_i32  : i32 {
+      %2 = tt.splat %arg2 : i32 -> tensor<1024xi32, #blocked>
+      %3 = arith.addi %2, %0 : tensor<1024xi32, #blocked>
+      %4 = tt.addptr %1, %3 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %5 = tt.load %4 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %6 = arith.mulf %5, %cst : tensor<1024xf32, #blocked>
+      tt.store %4, %6 : tensor<1024x!tt.ptr<f32>, #blocked>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+// Loads asked for fewer stages get fewer buffers, and small tiles are
+// prefetched in registers.
+// CHECK-LABEL: @mixed_stages_kernel
+// CHECK-DAG: triton_gpu.local_alloc  : () -> !tt.memdesc<2x1024xf32
+// CHECK-DAG: triton_gpu.local_alloc  : () -> !tt.memdesc<1x1024xf32
+// CHECK-NOT: triton_gpu.local_alloc
+// CHECK: tt.load {{.*}} : tensor<128x!tt.ptr<f32>
+// CHECK: scf.for
+// CHECK: tt.load {{.*}} : tensor<128x!tt.ptr<f32>
+// CHECK: scf.yield
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @mixed_stages_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg3: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg4: i32 {tt.divisibility = 16 : i32}) attributes {noinline = false} {
+    %c1024_i32 = arith.constant 1024 : i32
+    %c128_i32 = arith.constant 128 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<128xf32, #blocked1>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked1>
+    %2 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %3 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %4 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<128x!tt.ptr<f32>, #blocked1>
+    %5 = tt.splat %arg3 : !tt.ptr<f32> -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %6 = scf.for %arg5 = %c0_i32 to %arg4 step %c1_i32 iter_args(%arg6 = %cst) -> (tensor<128xf32, #blocked1>)  : i32 {
+      %7 = arith.muli %arg5, %c1024_i32 : i32
+      %8 = tt.splat %7 : i32 -> tensor<1024xi32, #blocked>
+      %9 = arith.addi %8, %0 : tensor<1024xi32, #blocked>
+      %10 = tt.addptr %2, %9 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %11 = tt.load %10 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %12 = tt.addptr %3, %9 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      %13 = tt.load %12 {tt.num_stages = 2 : i32} : tensor<1024x!tt.ptr<f32>, #blocked>
+      %14 = arith.addf %11, %13 : tensor<1024xf32, #blocked>
+      %15 = tt.addptr %5, %9 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+      tt.store %15, %14 : tensor<1024x!tt.ptr<f32>, #blocked>
+      %16 = arith.muli %arg5, %c128_i32 : i32
+      %17 = tt.splat %16 : i32 -> tensor<128xi32, #blocked1>
+      %18 = arith.addi %17, %1 : tensor<128xi32, #blocked1>
+      %19 = tt.addptr %4, %18 : tensor<128x!tt.ptr<f32>, #blocked1>, tensor<128xi32, #blocked1>
+      %20 = tt.load %19 : tensor<128x!tt.ptr<f32>, #blocked1>
+      %21 = arith.addf %arg6, %20 : tensor<128xf32, #blocked1>
+      scf.yield %21 : tensor<128xf32, #blocked1>
+    } {tt.num_stages = 3 : i32}
+    tt.store %4, %6 : tensor<128x!tt.ptr<f32>, #blocked1>
+    tt.return
+  }
+}
+
 
 // -----
 
@@ -1596,3 +1762,70 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return %0#0 : tensor<128x256xf32, #mma>
   }
 }
+
+// -----
+
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:80", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Both branches commit a group, so one group is committed after the one
+// waited for on every path
+// CHECK-LABEL: @wait_across_branches
+// CHECK: scf.for
+// CHECK: triton_gpu.async_wait %{{.*}} {num = 1 : i32}
+// CHECK: scf.if
+  tt.func @wait_across_branches(%lb: i32, %ub: i32, %step: i32, %cond: i1) {
+    %t0 = triton_gpu.async_commit_group
+    %t1 = triton_gpu.async_commit_group
+    %r:2 = scf.for %i = %lb to %ub step %step iter_args(%a = %t0, %b = %t1) -> (!triton_gpu.async.token, !triton_gpu.async.token) : i32 {
+      %w = triton_gpu.async_wait %a {num = 0 : i32}
+      %n = scf.if %cond -> (!triton_gpu.async.token) {
+        %x = triton_gpu.async_commit_group
+        scf.yield %x : !triton_gpu.async.token
+      } else {
+        %y = triton_gpu.async_commit_group
+        scf.yield %y : !triton_gpu.async.token
+      }
+      scf.yield %b, %n : !triton_gpu.async.token, !triton_gpu.async.token
+    }
+    tt.return
+  }
+
+// The inner loop runs at least once and commits a group every iteration
+// CHECK-LABEL: @wait_across_inner_loop
+// CHECK: scf.for
+// CHECK: triton_gpu.async_wait %{{.*}} {num = 1 : i32}
+  tt.func @wait_across_inner_loop(%lb: i32, %ub: i32, %step: i32) {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %c4_i32 = arith.constant 4 : i32
+    %t0 = triton_gpu.async_commit_group
+    %t1 = triton_gpu.async_commit_group
+    %r:2 = scf.for %i = %lb to %ub step %step iter_args(%a = %t0, %b = %t1) -> (!triton_gpu.async.token, !triton_gpu.async.token) : i32 {
+      %w = triton_gpu.async_wait %a {num = 0 : i32}
+      %inner = scf.for %j = %c0_i32 to %c4_i32 step %c1_i32 iter_args(%t = %b) -> (!triton_gpu.async.token) : i32 {
+        %x = triton_gpu.async_commit_group
+        scf.yield %x : !triton_gpu.async.token
+      }
+      scf.yield %b, %inner : !triton_gpu.async.token, !triton_gpu.async.token
+    }
+    tt.return
+  }
+
+// Only one branch commits a group, and the wait nested in a branch is reached
+// after none
+// CHECK-LABEL: @wait_in_branch
+// CHECK: scf.for
+// CHECK: scf.if
+// CHECK: triton_gpu.async_wait %{{.*}} {num = 0 : i32}
+  tt.func @wait_in_branch(%lb: i32, %ub: i32, %step: i32, %cond: i1) {
+    %t0 = triton_gpu.async_commit_group
+    %r = scf.for %i = %lb to %ub step %step iter_args(%a = %t0) -> (!triton_gpu.async.token) : i32 {
+      scf.if %cond {
+        %w = triton_gpu.async_wait %a {num = 3 : i32}
+        %x = triton_gpu.async_commit_group
+      }
+      %n = triton_gpu.async_commit_group
+      scf.yield %n : !triton_gpu.async.token
+    }
+    tt.return
+  }
+}
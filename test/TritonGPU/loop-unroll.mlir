@@ -0,0 +1,89 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-loop-unroll=auto-unroll=true | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-loop-unroll | FileCheck %s --check-prefix=NOAUTO
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @unroll_by_attr
+// CHECK: %[[C4:.*]] = arith.constant 4 : i32
+// CHECK: scf.for %{{.*}} = %{{.*}} to %{{.*}} step %[[C4]]
+// CHECK: tt.load
+// CHECK: tt.addptr
+// CHECK: tt.load
+// CHECK: tt.addptr
+// CHECK: tt.load
+// CHECK: tt.addptr
+// CHECK: tt.load
+// CHECK: arith.addf
+// CHECK: arith.addf
+// CHECK: arith.addf
+// CHECK: arith.addf
+// CHECK: scf.yield
+// CHECK-NOT: tt.loop_unroll_factor
+// CHECK: tt.store
+tt.func @unroll_by_attr(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: tensor<128x!tt.ptr<f32>, #blocked>) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c16 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf32, #blocked>
+  %offsets = arith.constant dense<128> : tensor<128xi32, #blocked>
+  %res:2 = scf.for %i = %c0 to %c16 step %c1 iter_args(%acc = %cst, %ptrs = %arg0) -> (tensor<128xf32, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>) : i32 {
+    %x = tt.load %ptrs : tensor<128x!tt.ptr<f32>, #blocked>
+    %sum = arith.addf %acc, %x : tensor<128xf32, #blocked>
+    %next = tt.addptr %ptrs, %offsets : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    scf.yield %sum, %next : tensor<128xf32, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>
+  } {tt.loop_unroll_factor = 4 : i32}
+  tt.store %arg1, %res#0 : tensor<128x!tt.ptr<f32>, #blocked>
+  tt.return
+}
+
+// With auto-unroll, small loads are unrolled by two, and loads are not
+// hoisted above stores.
+// CHECK-LABEL: @unroll_by_default
+// CHECK: %[[C2:.*]] = arith.constant 2 : i32
+// CHECK: scf.for %{{.*}} = %{{.*}} to %{{.*}} step %[[C2]]
+// CHECK: tt.load
+// CHECK: tt.store
+// CHECK: tt.load
+// CHECK: tt.store
+// CHECK: scf.yield
+// NOAUTO-LABEL: @unroll_by_default
+// NOAUTO: scf.for %{{.*}} = %{{.*}} to %{{.*}} step %c1_i32
+// NOAUTO: tt.load
+// NOAUTO-NOT: tt.load
+// NOAUTO: scf.yield
+tt.func @unroll_by_default(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: tensor<128x!tt.ptr<f32>, #blocked>) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c16 = arith.constant 16 : i32
+  %offsets = arith.constant dense<128> : tensor<128xi32, #blocked>
+  %res:2 = scf.for %i = %c0 to %c16 step %c1 iter_args(%src = %arg0, %dst = %arg1) -> (tensor<128x!tt.ptr<f32>, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>) : i32 {
+    %x = tt.load %src : tensor<128x!tt.ptr<f32>, #blocked>
+    tt.store %dst, %x : tensor<128x!tt.ptr<f32>, #blocked>
+    %next_src = tt.addptr %src, %offsets : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    %next_dst = tt.addptr %dst, %offsets : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    scf.yield %next_src, %next_dst : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>
+  }
+  tt.return
+}
+
+// CHECK-LABEL: @unroll_disabled
+// CHECK: scf.for %{{.*}} = %{{.*}} to %{{.*}} step %c1_i32
+// CHECK: tt.load
+// CHECK-NOT: tt.load
+// CHECK: scf.yield
+tt.func @unroll_disabled(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: tensor<128x!tt.ptr<f32>, #blocked>) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %c16 = arith.constant 16 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<128xf32, #blocked>
+  %offsets = arith.constant dense<128> : tensor<128xi32, #blocked>
+  %res:2 = scf.for %i = %c0 to %c16 step %c1 iter_args(%acc = %cst, %ptrs = %arg0) -> (tensor<128xf32, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>) : i32 {
+    %x = tt.load %ptrs : tensor<128x!tt.ptr<f32>, #blocked>
+    %sum = arith.addf %acc, %x : tensor<128xf32, #blocked>
+    %next = tt.addptr %ptrs, %offsets : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    scf.yield %sum, %next : tensor<128xf32, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>
+  } {tt.loop_unroll_factor = 1 : i32}
+  tt.store %arg1, %res#0 : tensor<128x!tt.ptr<f32>, #blocked>
+  tt.return
+}
+}
@@ -623,3 +623,69 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 :
     tt.return
   }
 }
+
+// -----
+
+// CHECK-LABEL: reduce_both_axes
+// CHECK: %[[INIT:.*]] = arith.constant dense<0.000000e+00> : tensor<32x128xf32
+// CHECK: %[[LOOP_OUTPUT:.*]] = scf.for {{.*}} iter_args(%[[FOR_ARG:.*]] = %[[INIT]]) -> (tensor<32x128xf32
+// CHECK: %[[LOAD:.*]] = tt.load
+// CHECK-NOT: tt.reduce
+// CHECK: %[[ACC:.*]] = arith.addf %[[FOR_ARG]], %[[LOAD]] : tensor<32x128xf32
+// CHECK-NEXT: scf.yield %[[ACC]]
+// CHECK: %[[ROWS:.*]] = "tt.reduce"(%[[LOOP_OUTPUT]]) <{axis = 1 : i32}>
+// CHECK: %[[TOTAL:.*]] = "tt.reduce"(%[[ROWS]]) <{axis = 0 : i32}>
+// CHECK: arith.addf %{{.*}}, %[[TOTAL]] : f32
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @reduce_both_axes(%arg0: tensor<32x128x!tt.ptr<f32>, #blocked>, %arg1: !tt.ptr<f32>, %arg2: i32, %arg3: f32) {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %0 = scf.for %iv = %c0_i32 to %arg2 step %c1_i32 iter_args(%acc = %arg3) -> (f32) : i32 {
+      %1 = tt.load %arg0 : tensor<32x128x!tt.ptr<f32>, #blocked>
+      %2 = "tt.reduce"(%1) <{axis = 1 : i32}> ({
+      ^bb0(%a: f32, %b: f32):
+        %5 = arith.addf %a, %b : f32
+        tt.reduce.return %5 : f32
+      }) : (tensor<32x128xf32, #blocked>) -> tensor<32xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+      %3 = "tt.reduce"(%2) <{axis = 0 : i32}> ({
+      ^bb0(%a: f32, %b: f32):
+        %5 = arith.addf %a, %b : f32
+        tt.reduce.return %5 : f32
+      }) : (tensor<32xf32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>) -> f32
+      %4 = arith.addf %acc, %3 : f32
+      scf.yield %4 : f32
+    }
+    tt.store %arg1, %0 : !tt.ptr<f32>
+    tt.return
+  }
+}
+
+// -----
+
+// CHECK-LABEL: accumulate_scan
+// CHECK: %[[LOOP_OUTPUT:.*]] = scf.for {{.*}} -> (tensor<128xi32
+// CHECK-NOT: tt.scan
+// CHECK: arith.addi
+// CHECK-NEXT: scf.yield
+// CHECK: %[[SCAN:.*]] = "tt.scan"(%[[LOOP_OUTPUT]]) <{axis = 0 : i32, reverse = false}>
+// CHECK: arith.addi %{{.*}}, %[[SCAN]] : tensor<128xi32
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @accumulate_scan(%arg0: tensor<128x!tt.ptr<i32>, #blocked>, %arg1: tensor<128x!tt.ptr<i32>, #blocked>, %arg2: i32, %arg3: tensor<128xi32, #blocked>) {
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %0 = scf.for %iv = %c0_i32 to %arg2 step %c1_i32 iter_args(%acc = %arg3) -> (tensor<128xi32, #blocked>) : i32 {
+      %1 = tt.load %arg0 : tensor<128x!tt.ptr<i32>, #blocked>
+      %2 = "tt.scan"(%1) <{axis = 0 : i32, reverse = false}> ({
+      ^bb0(%a: i32, %b: i32):
+        %4 = arith.addi %a, %b : i32
+        tt.scan.return %4 : i32
+      }) : (tensor<128xi32, #blocked>) -> tensor<128xi32, #blocked>
+      %3 = arith.addi %acc, %2 : tensor<128xi32, #blocked>
+      scf.yield %3 : tensor<128xi32, #blocked>
+    }
+    tt.store %arg1, %0 : tensor<128x!tt.ptr<i32>, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,86 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-outline-cold-regions=min-ops=4 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @unlikely_branch
+// CHECK: %[[COND:.*]] = arith.cmpi eq, %arg2, %{{.*}} {tt.unlikely} : i32
+// CHECK: %[[RES:.*]] = scf.if %[[COND]] -> (tensor<128xf32, #blocked>) {
+// CHECK-NEXT: %[[CALL:.*]] = tt.call @unlikely_branch__cold(%arg0, %arg1) : (tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xf32, #blocked>) -> tensor<128xf32, #blocked>
+// CHECK-NEXT: scf.yield %[[CALL]]
+// CHECK-NEXT: } else {
+// CHECK-NEXT: scf.yield %arg1
+// CHECK: tt.return %[[RES]]
+// CHECK: tt.func private @unlikely_branch__cold(%[[PTR:.*]]: tensor<128x!tt.ptr<f32>, #blocked>, %[[X:.*]]: tensor<128xf32, #blocked>) -> tensor<128xf32, #blocked> attributes {noinline = true}
+// CHECK: %[[LOAD:.*]] = tt.load %[[PTR]]
+// CHECK: %[[ADD:.*]] = arith.addf %[[X]], %[[LOAD]]
+// CHECK: %[[MUL:.*]] = arith.mulf %[[ADD]], %[[ADD]]
+// CHECK: tt.store %[[PTR]], %[[MUL]]
+// CHECK: tt.return %[[MUL]]
+  tt.func public @unlikely_branch(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: tensor<128xf32, #blocked>, %arg2: i32) -> tensor<128xf32, #blocked> {
+    %c0_i32 = arith.constant 0 : i32
+    %0 = arith.cmpi eq, %arg2, %c0_i32 {tt.unlikely} : i32
+    %1 = scf.if %0 -> (tensor<128xf32, #blocked>) {
+      %2 = tt.load %arg0 : tensor<128x!tt.ptr<f32>, #blocked>
+      %3 = arith.addf %arg1, %2 : tensor<128xf32, #blocked>
+      %4 = arith.mulf %3, %3 : tensor<128xf32, #blocked>
+      tt.store %arg0, %4 : tensor<128x!tt.ptr<f32>, #blocked>
+      scf.yield %4 : tensor<128xf32, #blocked>
+    } else {
+      scf.yield %arg1 : tensor<128xf32, #blocked>
+    }
+    tt.return %1 : tensor<128xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The masked boundary tiles of tile versioning run in a function
+// CHECK-LABEL: @boundary_tiles
+// CHECK: scf.if %arg3 {
+// CHECK-NEXT: tt.load %arg0 :
+// CHECK: } else {
+// CHECK-NEXT: tt.call @boundary_tiles__cold(%arg0, %arg1, %arg2) : (tensor<128x!tt.ptr<f32>, #blocked>, tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi1, #blocked>) -> ()
+// CHECK-NEXT: } {tt.cold_region = 1 : i32}
+// CHECK: tt.func private @boundary_tiles__cold
+// CHECK: tt.load %{{.*}}, %{{.*}} :
+// CHECK: tt.store %{{.*}}, %{{.*}}, %{{.*}} :
+// CHECK: tt.return
+  tt.func public @boundary_tiles(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: tensor<128x!tt.ptr<f32>, #blocked>, %arg2: tensor<128xi1, #blocked>, %arg3: i1) {
+    scf.if %arg3 {
+      %0 = tt.load %arg0 : tensor<128x!tt.ptr<f32>, #blocked>
+      %1 = arith.mulf %0, %0 : tensor<128xf32, #blocked>
+      tt.store %arg1, %1 : tensor<128x!tt.ptr<f32>, #blocked>
+    } else {
+      %0 = tt.load %arg0, %arg2 : tensor<128x!tt.ptr<f32>, #blocked>
+      %1 = arith.mulf %0, %0 : tensor<128xf32, #blocked>
+      tt.store %arg1, %1, %arg2 : tensor<128x!tt.ptr<f32>, #blocked>
+    } {tt.cold_region = 1 : i32}
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Short regions and the ones using shared memory descriptors of the caller stay
+// CHECK-LABEL: @not_outlined
+// CHECK-NOT: tt.call
+// CHECK-NOT: tt.func private
+  tt.func public @not_outlined(%arg0: tensor<128x!tt.ptr<f32>, #blocked>, %arg1: !tt.memdesc<128xf32, #shared, #triton_gpu.shared_memory, mutable>, %arg2: i1 {tt.unlikely}) {
+    scf.if %arg2 {
+      %0 = triton_gpu.local_load %arg1 : !tt.memdesc<128xf32, #shared, #triton_gpu.shared_memory, mutable> -> tensor<128xf32, #blocked>
+      %1 = arith.mulf %0, %0 : tensor<128xf32, #blocked>
+      %2 = arith.addf %1, %0 : tensor<128xf32, #blocked>
+      tt.store %arg0, %2 : tensor<128x!tt.ptr<f32>, #blocked>
+    }
+    scf.if %arg2 {
+      %0 = tt.load %arg0 : tensor<128x!tt.ptr<f32>, #blocked>
+      tt.store %arg0, %0 : tensor<128x!tt.ptr<f32>, #blocked>
+    }
+    tt.return
+  }
+}
@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-prefetch -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-prefetch=prefetch-depth=2 -canonicalize | FileCheck %s --check-prefix=DEPTH2
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -125,3 +126,162 @@ tt.func @matmul_loop_mixed(%lb : index, %ub : index, %step : index, %A : !tt.ptr
   tt.return %loop#4 : tensor<128x128xf32, #C>
 }
 }  // end module
+
+// -----
+
+// The two slices of K are both carried to the next iteration in registers.
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#C = #triton_gpu.nvidia_mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth = 2}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth = 2}>
+
+// DEPTH2-LABEL: tt.func @matmul_loop_depth
+// DEPTH2-DAG: %[[C0:.+]] = arith.constant 0 : i32
+// DEPTH2-DAG: %[[C16:.+]] = arith.constant 16 : i32
+// DEPTH2:     scf.for {{.*}} iter_args({{.*}}, %[[a0:[a-z0-9_]+]] = %{{[a-z0-9_]+}}, %[[a1:[a-z0-9_]+]] = %{{[a-z0-9_]+}}, %[[b0:[a-z0-9_]+]] = %{{[a-z0-9_]+}}, %[[b1:[a-z0-9_]+]] = %{{[a-z0-9_]+}})
+// DEPTH2-NOT:   triton_gpu.local_load
+// DEPTH2:       %[[D0:.*]] = tt.dot %[[a0]], %[[b0]], {{.*}}
+// DEPTH2-DAG:   triton_gpu.memdesc_subview {{.*}}[%[[C0]], %[[C0]]]
+// DEPTH2-DAG:   triton_gpu.memdesc_subview {{.*}}[%[[C0]], %[[C16]]]
+// DEPTH2-DAG:   triton_gpu.memdesc_subview {{.*}}[%[[C16]], %[[C0]]]
+// DEPTH2:       tt.dot %[[a1]], %[[b1]], %[[D0]]
+// DEPTH2:     scf.yield
+module attributes { "triton_gpu.num-warps" = 4 : i32 } {
+tt.func @matmul_loop_depth(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>) -> tensor<128x128xf32, #C>{
+  %a_ptr_init = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %b_ptr_init = tt.splat %B : !tt.ptr<f16> -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_off = arith.constant dense<4> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+
+  %a_ = tt.load %a_ptr_init : tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_init = triton_gpu.local_alloc %a_ : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A>
+  %b_ = tt.load %b_ptr_init : tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_init = triton_gpu.local_alloc %b_ : (tensor<32x128xf16, #BL>) -> !tt.memdesc<32x128xf16, #B>
+
+  %loop:5 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %a = %a_init, %b = %b_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, !tt.memdesc<128x32xf16, #A>, !tt.memdesc<32x128xf16, #B>, tensor<128x128xf32, #C>) {
+    %a_op = triton_gpu.local_load %a : !tt.memdesc<128x32xf16, #A> -> tensor<128x32xf16, #A_OP>
+    %b_op = triton_gpu.local_load %b : !tt.memdesc<32x128xf16, #B> -> tensor<32x128xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c : tensor<128x32xf16, #A_OP> * tensor<32x128xf16, #B_OP> -> tensor<128x128xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    %next_a_ = tt.load %next_a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>
+    %next_a = triton_gpu.local_alloc %next_a_ : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A>
+    %next_b_ = tt.load %next_b_ptr : tensor<32x128x!tt.ptr<f16>, #BL>
+    %next_b = triton_gpu.local_alloc %next_b_ : (tensor<32x128xf16, #BL>) -> !tt.memdesc<32x128xf16, #B>
+
+    scf.yield %next_a_ptr, %next_b_ptr, %next_a, %next_b, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, !tt.memdesc<128x32xf16, #A>, !tt.memdesc<32x128xf16, #B>, tensor<128x128xf32, #C>
+  }
+  tt.return %loop#4 : tensor<128x128xf32, #C>
+}
+}  // end module
+
+// -----
+
+// MFMA operands are prefetched in slices of the K of the instruction.
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [0, 1]}>
+#C = #triton_gpu.amd_mfma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [32, 32], isTransposed = false}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth = 4}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth = 4}>
+
+// CHECK-LABEL: tt.func @matmul_loop_mfma
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : i32
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : i32
+// CHECK-DAG: %[[A0_PREFETCH_SMEM:.*]] = triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C0]]] : {{.*}} -> !tt.memdesc<128x8xf16, #{{.*}}>
+// CHECK-DAG: %[[A0_PREFETCH:.*]] = triton_gpu.local_load %[[A0_PREFETCH_SMEM]] : {{.*}} -> tensor<128x8xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #{{.*}}, kWidth = 4}>>
+// CHECK-DAG: %[[B0_PREFETCH_SMEM:.*]] = triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C0]]] : {{.*}} -> !tt.memdesc<8x128xf16, #{{.*}}>
+// CHECK:     scf.for
+// CHECK:       triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C8]]]
+// CHECK:       tt.dot
+// CHECK-COUNT-3: tt.dot
+// CHECK:     scf.yield
+module attributes { "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32 } {
+tt.func @matmul_loop_mfma(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>) -> tensor<128x128xf32, #C>{
+  %a_ptr_init = tt.splat %A : !tt.ptr<f16> -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %b_ptr_init = tt.splat %B : !tt.ptr<f16> -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_off = arith.constant dense<4> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+
+  %a_ = tt.load %a_ptr_init : tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_init = triton_gpu.local_alloc %a_ : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A>
+  %b_ = tt.load %b_ptr_init : tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_init = triton_gpu.local_alloc %b_ : (tensor<32x128xf16, #BL>) -> !tt.memdesc<32x128xf16, #B>
+
+  %loop:5 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %a = %a_init, %b = %b_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, !tt.memdesc<128x32xf16, #A>, !tt.memdesc<32x128xf16, #B>, tensor<128x128xf32, #C>) {
+    %a_op = triton_gpu.local_load %a : !tt.memdesc<128x32xf16, #A> -> tensor<128x32xf16, #A_OP>
+    %b_op = triton_gpu.local_load %b : !tt.memdesc<32x128xf16, #B> -> tensor<32x128xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c : tensor<128x32xf16, #A_OP> * tensor<32x128xf16, #B_OP> -> tensor<128x128xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    %next_a_ = tt.load %next_a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>
+    %next_a = triton_gpu.local_alloc %next_a_ : (tensor<128x32xf16, #AL>) -> !tt.memdesc<128x32xf16, #A>
+    %next_b_ = tt.load %next_b_ptr : tensor<32x128x!tt.ptr<f16>, #BL>
+    %next_b = triton_gpu.local_alloc %next_b_ : (tensor<32x128xf16, #BL>) -> !tt.memdesc<32x128xf16, #B>
+
+    scf.yield %next_a_ptr, %next_b_ptr, %next_a, %next_b, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, !tt.memdesc<128x32xf16, #A>, !tt.memdesc<32x128xf16, #B>, tensor<128x128xf32, #C>
+  }
+  tt.return %loop#4 : tensor<128x128xf32, #C>
+}
+}  // end module
+
+// -----
+
+// WMMA operands are prefetched in slices of the K of the instruction.
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#B = #triton_gpu.shared<{vec = 4, perPhase = 1, maxPhase = 8, order = [0, 1]}>
+#C = #triton_gpu.amd_wmma<{warpsPerCTA = [2, 2]}>
+#A_OP = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth = 16}>
+#B_OP = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth = 16}>
+
+// CHECK-LABEL: tt.func @matmul_loop_wmma
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : i32
+// CHECK-DAG: %[[C16:.+]] = arith.constant 16 : i32
+// CHECK-DAG: %[[A0_PREFETCH_SMEM:.*]] = triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C0]]] : {{.*}} -> !tt.memdesc<64x16xf16, #{{.*}}>
+// CHECK-DAG: %[[A0_PREFETCH:.*]] = triton_gpu.local_load %[[A0_PREFETCH_SMEM]] : {{.*}} -> tensor<64x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #{{.*}}, kWidth = 16}>>
+// CHECK-DAG: %[[B0_PREFETCH_SMEM:.*]] = triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C0]]] : {{.*}} -> !tt.memdesc<16x64xf16, #{{.*}}>
+// CHECK:     scf.for
+// CHECK:       triton_gpu.memdesc_subview %{{.*}}[%[[C0]], %[[C16]]]
+// CHECK:       tt.dot
+// CHECK-COUNT-3: tt.dot
+// CHECK:     scf.yield
+module attributes { "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32 } {
+tt.func @matmul_loop_wmma(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>) -> tensor<64x64xf32, #C>{
+  %a_ptr_init = tt.splat %A : !tt.ptr<f16> -> tensor<64x64x!tt.ptr<f16>, #AL>
+  %b_ptr_init = tt.splat %B : !tt.ptr<f16> -> tensor<64x64x!tt.ptr<f16>, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<64x64xf32, #C>
+  %a_off = arith.constant dense<4> : tensor<64x64xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<64x64xi32, #BL>
+
+  %a_ = tt.load %a_ptr_init : tensor<64x64x!tt.ptr<f16>, #AL>
+  %a_init = triton_gpu.local_alloc %a_ : (tensor<64x64xf16, #AL>) -> !tt.memdesc<64x64xf16, #A>
+  %b_ = tt.load %b_ptr_init : tensor<64x64x!tt.ptr<f16>, #BL>
+  %b_init = triton_gpu.local_alloc %b_ : (tensor<64x64xf16, #BL>) -> !tt.memdesc<64x64xf16, #B>
+
+  %loop:5 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %a = %a_init, %b = %b_init, %prev_c = %c_init) -> (tensor<64x64x!tt.ptr<f16>, #AL>, tensor<64x64x!tt.ptr<f16>, #BL>, !tt.memdesc<64x64xf16, #A>, !tt.memdesc<64x64xf16, #B>, tensor<64x64xf32, #C>) {
+    %a_op = triton_gpu.local_load %a : !tt.memdesc<64x64xf16, #A> -> tensor<64x64xf16, #A_OP>
+    %b_op = triton_gpu.local_load %b : !tt.memdesc<64x64xf16, #B> -> tensor<64x64xf16, #B_OP>
+    %c = tt.dot %a_op, %b_op, %prev_c : tensor<64x64xf16, #A_OP> * tensor<64x64xf16, #B_OP> -> tensor<64x64xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<64x64x!tt.ptr<f16>, #AL>, tensor<64x64xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<64x64x!tt.ptr<f16>, #BL>, tensor<64x64xi32, #BL>
+    %next_a_ = tt.load %next_a_ptr : tensor<64x64x!tt.ptr<f16>, #AL>
+    %next_a = triton_gpu.local_alloc %next_a_ : (tensor<64x64xf16, #AL>) -> !tt.memdesc<64x64xf16, #A>
+    %next_b_ = tt.load %next_b_ptr : tensor<64x64x!tt.ptr<f16>, #BL>
+    %next_b = triton_gpu.local_alloc %next_b_ : (tensor<64x64xf16, #BL>) -> !tt.memdesc<64x64xf16, #B>
+
+    scf.yield %next_a_ptr, %next_b_ptr, %next_a, %next_b, %c : tensor<64x64x!tt.ptr<f16>, #AL>, tensor<64x64x!tt.ptr<f16>, #BL>, !tt.memdesc<64x64xf16, #A>, !tt.memdesc<64x64xf16, #B>, tensor<64x64xf32, #C>
+  }
+  tt.return %loop#4 : tensor<64x64xf32, #C>
+}
+}  // end module
@@ -12,3 +12,24 @@ module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 2], warpsPerCTA = [1, 4], order = [0, 1]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4], instrShape = [16, 8]}>
+module attributes {"triton_gpu.target" = "cuda:80", "triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // CHECK-LABEL: hoist_invariant_alloc
+  //       CHECK:   %[[ALLOC:.*]] = triton_gpu.local_alloc %arg0
+  //   CHECK-NOT:   triton_gpu.local_alloc
+  //       CHECK:   scf.for
+  //       CHECK:     triton_gpu.local_load %[[ALLOC]]
+  //       CHECK:     triton_gpu.local_load %[[ALLOC]]
+  //   CHECK-NOT:   triton_gpu.local_alloc
+  tt.func @hoist_invariant_alloc(%arg0: tensor<16x256xf16, #blocked>, %lb: i32, %ub: i32, %step: i32) {
+    scf.for %iv = %lb to %ub step %step : i32 {
+      %0 = triton_gpu.convert_layout %arg0 : tensor<16x256xf16, #blocked> -> tensor<16x256xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+      %1 = triton_gpu.convert_layout %arg0 : tensor<16x256xf16, #blocked> -> tensor<16x256xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+    }
+    tt.return
+  }
+}
@@ -100,3 +100,32 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
     tt.return
   }
 }
+
+// -----
+
+// check that a loop-invariant dot operand used by several dots is loaded
+// again next to each of them
+// CHECK-LABEL: repeat_invariant_load_in_loop
+//       CHECK: %[[AS:.+]] = triton_gpu.local_alloc
+//       CHECK: scf.for
+//       CHECK:   triton_gpu.local_load %[[AS]]
+//  CHECK-NEXT:   tt.dot
+//       CHECK:   triton_gpu.local_load %[[AS]]
+//  CHECK-NEXT:   tt.dot
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [1, 4], order = [0, 1]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 4, order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @repeat_invariant_load_in_loop(%arg0: tensor<32x32x!tt.ptr<f32>, #blocked>, %B0: tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 1}>>, %B1: tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 1}>>, %lb: i32, %ub: i32, %step: i32) -> tensor<32x32xf32, #mma> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    %A = tt.load %arg0 : tensor<32x32x!tt.ptr<f32>, #blocked>
+    %AS = triton_gpu.local_alloc %A : (tensor<32x32xf32, #blocked>) -> !tt.memdesc<32x32xf32, #shared>
+    %AD = triton_gpu.local_load %AS : !tt.memdesc<32x32xf32, #shared> -> tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 1}>>
+    %res = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<32x32xf32, #mma>) : i32 {
+      %0 = tt.dot %AD, %B0, %acc : tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 1}>> * tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 1}>> -> tensor<32x32xf32, #mma>
+      %1 = tt.dot %AD, %B1, %0 : tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 1}>> * tensor<32x32xf32, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 1}>> -> tensor<32x32xf32, #mma>
+      scf.yield %1 : tensor<32x32xf32, #mma>
+    }
+    tt.return %res : tensor<32x32xf32, #mma>
+  }
+}
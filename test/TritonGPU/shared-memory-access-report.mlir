@@ -0,0 +1,32 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-report-shared-memory-access | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-report-shared-memory-access 2>&1 >/dev/null | FileCheck %s --check-prefix=REMARK
+
+// Each quarter warp stores rows r and r+1, which hit the same 16 banks.
+
+// REMARK: remark: 128-bit vectors, 2-way bank conflicts (64 wavefronts, 32 without conflicts)
+// CHECK: triton_gpu.shared_memory_report = "[{\22conflict_ways\22:2,\22ideal_wavefronts\22:32,\22loc\22:\22{{.*}}\22,\22op\22:\22triton_gpu.local_alloc\22,\22vector_bits\22:128,\22wavefronts\22:64}]"
+// CHECK-LABEL: @unswizzled_store
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  tt.func @unswizzled_store(%arg0: tensor<32x32xf32, #blocked>) {
+    %0 = triton_gpu.local_alloc %arg0 : (tensor<32x32xf32, #blocked>) -> !tt.memdesc<32x32xf32, #shared, #triton_gpu.shared_memory>
+    tt.return
+  }
+}
+
+// -----
+
+// Odd rows are swizzled into the other half of the banks.
+
+// REMARK: remark: 128-bit vectors, 1-way bank conflicts (32 wavefronts, 32 without conflicts)
+// CHECK: triton_gpu.shared_memory_report = "[{\22conflict_ways\22:1,{{.*}}\22op\22:\22triton_gpu.local_load\22,\22vector_bits\22:128,\22wavefronts\22:32}]"
+// CHECK-LABEL: @swizzled_load
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 16, perPhase = 1, maxPhase = 2, order = [1, 0], CTAsPerCGA = [1, 1], CTASplitNum = [1, 1], CTAOrder = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 1 : i32} {
+  tt.func @swizzled_load(%arg0: !tt.memdesc<32x32xf32, #shared, #triton_gpu.shared_memory>) {
+    %0 = triton_gpu.local_load %arg0 : !tt.memdesc<32x32xf32, #shared, #triton_gpu.shared_memory> -> tensor<32x32xf32, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,125 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-tile-versioning | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @vecadd
+tt.func public @vecadd(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>, %arg2: !tt.ptr<f32>, %arg3: i32) {
+  %c64_i32 = arith.constant 64 : i32
+  %0 = tt.get_program_id x : i32
+  // CHECK: %[[START:.*]] = arith.muli
+  %1 = arith.muli %0, %c64_i32 : i32
+  %2 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %3 = tt.splat %1 : i32 -> tensor<64xi32, #blocked>
+  %4 = arith.addi %3, %2 : tensor<64xi32, #blocked>
+  %5 = tt.splat %arg3 : i32 -> tensor<64xi32, #blocked>
+  // CHECK: %[[MASK:.*]] = arith.cmpi slt
+  %6 = arith.cmpi slt, %4, %5 : tensor<64xi32, #blocked>
+  %7 = tt.splat %arg0 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked>
+  %8 = tt.addptr %7, %4 : tensor<64x!tt.ptr<f32>, #blocked>, tensor<64xi32, #blocked>
+  // CHECK: %[[C63:.*]] = arith.constant 63 : i64
+  // CHECK: %[[BASE:.*]] = arith.extsi %[[START]] : i32 to i64
+  // CHECK: %[[LAST:.*]] = arith.addi %[[BASE]], %[[C63]] : i64
+  // CHECK: %[[BOUND:.*]] = arith.extsi %arg3 : i32 to i64
+  // CHECK: %[[INTERIOR:.*]] = arith.cmpi slt, %[[LAST]], %[[BOUND]] : i64
+  // CHECK: scf.if %[[INTERIOR]] {
+  // CHECK: tt.load %{{[^,]+}} : tensor<64x!tt.ptr<f32>, #blocked>
+  // CHECK: tt.load %{{[^,]+}} : tensor<64x!tt.ptr<f32>, #blocked>
+  // CHECK: tt.store %{{[^,]+}}, %{{[^,]+}} : tensor<64x!tt.ptr<f32>, #blocked>
+  // CHECK: } else {
+  // CHECK: tt.load %{{.*}}, %[[MASK]] :
+  // CHECK: tt.load %{{.*}}, %[[MASK]] :
+  // CHECK: tt.store %{{.*}}, %{{.*}}, %[[MASK]] :
+  // CHECK: } {tt.cold_region = 1 : i32}
+  // CHECK-NEXT: tt.return
+  %9 = tt.load %8, %6 : tensor<64x!tt.ptr<f32>, #blocked>
+  %10 = tt.splat %arg1 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked>
+  %11 = tt.addptr %10, %4 : tensor<64x!tt.ptr<f32>, #blocked>, tensor<64xi32, #blocked>
+  %12 = tt.load %11, %6 : tensor<64x!tt.ptr<f32>, #blocked>
+  %13 = arith.addf %9, %12 : tensor<64xf32, #blocked>
+  %14 = tt.splat %arg2 : !tt.ptr<f32> -> tensor<64x!tt.ptr<f32>, #blocked>
+  %15 = tt.addptr %14, %4 : tensor<64x!tt.ptr<f32>, #blocked>, tensor<64xi32, #blocked>
+  tt.store %15, %13, %6 : tensor<64x!tt.ptr<f32>, #blocked>
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The checks don't depend on the loop, the whole loop is versioned
+// CHECK-LABEL: @loop_invariant_mask
+tt.func public @loop_invariant_mask(%arg0: tensor<64x!tt.ptr<f32>, #blocked>, %arg1: i32, %arg2: i32, %arg3: i32) -> tensor<64xf32, #blocked> {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i32 = arith.constant 1 : i32
+  %cst = arith.constant dense<0.000000e+00> : tensor<64xf32, #blocked>
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %1 = tt.splat %arg1 : i32 -> tensor<64xi32, #blocked>
+  %2 = arith.addi %1, %0 : tensor<64xi32, #blocked>
+  %3 = tt.splat %arg2 : i32 -> tensor<64xi32, #blocked>
+  %4 = arith.cmpi sgt, %3, %2 : tensor<64xi32, #blocked>
+  // CHECK: %[[RES:.*]] = scf.if %{{.*}} -> (tensor<64xf32, #blocked>) {
+  // CHECK: %[[FAST:.*]] = scf.for
+  // CHECK: tt.load %{{[^,]+}} : tensor<64x!tt.ptr<f32>, #blocked>
+  // CHECK: scf.yield %[[FAST]]
+  // CHECK: } else {
+  // CHECK: %[[SLOW:.*]] = scf.for
+  // CHECK: tt.load %{{.*}}, %{{.*}}, %{{.*}} :
+  // CHECK: scf.yield %[[SLOW]]
+  // CHECK: tt.return %[[RES]]
+  %5 = scf.for %arg4 = %c0_i32 to %arg3 step %c1_i32 iter_args(%arg5 = %cst) -> (tensor<64xf32, #blocked>)  : i32 {
+    %6 = tt.load %arg0, %4, %cst : tensor<64x!tt.ptr<f32>, #blocked>
+    %7 = arith.addf %arg5, %6 : tensor<64xf32, #blocked>
+    scf.yield %7 : tensor<64xf32, #blocked>
+  }
+  tt.return %5 : tensor<64xf32, #blocked>
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// The checks depend on the induction variable, the loop body is versioned
+// CHECK-LABEL: @loop_variant_mask
+tt.func public @loop_variant_mask(%arg0: tensor<64x!tt.ptr<f32>, #blocked>, %arg1: tensor<64x!tt.ptr<f32>, #blocked>, %arg2: i32) {
+  %c0_i32 = arith.constant 0 : i32
+  %c64_i32 = arith.constant 64 : i32
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %1 = tt.splat %arg2 : i32 -> tensor<64xi32, #blocked>
+  // CHECK: scf.for %[[IV:.*]] = {{.*}} : i32 {
+  scf.for %arg3 = %c0_i32 to %arg2 step %c64_i32 : i32 {
+    %2 = tt.splat %arg3 : i32 -> tensor<64xi32, #blocked>
+    %3 = arith.addi %2, %0 : tensor<64xi32, #blocked>
+    %4 = arith.cmpi slt, %3, %1 : tensor<64xi32, #blocked>
+    // CHECK: %[[BASE:.*]] = arith.extsi %[[IV]] : i32 to i64
+    // CHECK: %[[VAL:.*]] = scf.if %{{.*}} -> (tensor<64xf32, #blocked>) {
+    // CHECK: %[[FAST:.*]] = tt.load %arg0 : tensor<64x!tt.ptr<f32>, #blocked>
+    // CHECK: scf.yield %[[FAST]]
+    // CHECK: } else {
+    // CHECK: %[[SLOW:.*]] = tt.load %arg0, %{{.*}} :
+    // CHECK: scf.yield %[[SLOW]]
+    // CHECK: }
+    // CHECK: tt.store %arg1, %[[VAL]] :
+    %5 = tt.load %arg0, %4 : tensor<64x!tt.ptr<f32>, #blocked>
+    tt.store %arg1, %5 : tensor<64x!tt.ptr<f32>, #blocked>
+  }
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Masks that are not bounds checks are left alone
+// CHECK-LABEL: @unknown_mask
+tt.func public @unknown_mask(%arg0: tensor<64x!tt.ptr<f32>, #blocked>, %arg1: tensor<64xi32, #blocked>) -> tensor<64xf32, #blocked> {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #blocked>
+  %1 = arith.cmpi slt, %0, %arg1 : tensor<64xi32, #blocked>
+  // CHECK-NOT: scf.if
+  // CHECK: tt.load %arg0, %{{.*}} :
+  %2 = tt.load %arg0, %1 : tensor<64x!tt.ptr<f32>, #blocked>
+  tt.return %2 : tensor<64xf32, #blocked>
+}
+}
@@ -29,3 +29,44 @@ module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 :
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1, 1], threadsPerWarp = [1, 1, 32], warpsPerCTA = [1, 1, 4], order = [2, 1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// Buffers of more than 2 dims are not swizzled
+// CHECK: #[[SHARED:.*]] = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [2, 1, 0]
+// CHECK-LABEL: tma_load_3d
+// CHECK: %[[ALLOC:.*]] = triton_gpu.local_alloc  : () -> !tt.memdesc<4x16x64xf16, #[[SHARED]]
+// CHECK: triton_nvidia_gpu.async_tma_copy_global_to_local %arg0[%arg1, %arg1, %arg1] %[[ALLOC]]
+  tt.func public @tma_load_3d(%arg0: !tt.ptr<i8>, %arg1: i32) -> tensor<4x16x64xf16, #blocked> {
+    %l = tt.experimental_descriptor_load %arg0[%arg1, %arg1, %arg1] : !tt.ptr<i8> -> tensor<4x16x64xf16, #blocked>
+    tt.return %l : tensor<4x16x64xf16, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: tma_load_im2col
+// CHECK: triton_nvidia_gpu.async_tma_copy_global_to_local %arg0[%arg1, %arg1, %arg1, %arg1] im2col [%arg2, %arg2]
+  tt.func public @tma_load_im2col(%arg0: !tt.ptr<i8>, %arg1: i32, %arg2: i16) -> tensor<128x64xf16, #blocked> {
+    %l = tt.experimental_descriptor_load %arg0[%arg1, %arg1, %arg1, %arg1] im2col [%arg2, %arg2] : !tt.ptr<i8> -> tensor<128x64xf16, #blocked>
+    tt.return %l : tensor<128x64xf16, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: tma_store_reduce
+//       CHECK: triton_gpu.local_alloc
+//       CHECK: triton_nvidia_gpu.async_tma_copy_local_to_global %arg0[%arg1, %arg1] %{{.*}} reduce add
+//       CHECK: triton_nvidia_gpu.async_tma_store_wait
+  tt.func public @tma_store_reduce(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: tensor<128x256xf32, #blocked>) {
+    tt.experimental_descriptor_store %arg0[%arg1, %arg1], %arg2 reduce add : !tt.ptr<i8>, tensor<128x256xf32, #blocked>
+    tt.return
+  }
+}
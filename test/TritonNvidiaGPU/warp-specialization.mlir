@@ -0,0 +1,80 @@
+// RUN: triton-opt %s -split-input-file --triton-nvidia-gpu-warp-specialization=num-buffers=3 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [2, 2], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+#mma = #triton_gpu.nvidia_mma<{versionMajor = 3, versionMinor = 0, warpsPerCTA = [4, 1], instrShape = [16, 256, 16]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0], hasLeadingOffset = true}>
+// CHECK: module attributes {{.*}}"triton_gpu.num-producer-warps" = 4 : i32
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+//   CHECK-LABEL: @matmul_tma
+//     CHECK-DAG:   triton_gpu.local_alloc  : () -> !tt.memdesc<3x128x64xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+//     CHECK-DAG:   triton_gpu.local_alloc  : () -> !tt.memdesc<3x64x256xf16, #{{.+}}, #triton_gpu.shared_memory, mutable>
+// CHECK-COUNT-6:   triton_nvidia_gpu.init_barrier
+//         CHECK:   gpu.barrier {bar_id = 0 : i32, num_threads = 256 : i32}
+//         CHECK:   %[[TID:.*]] = arith.index_cast
+//         CHECK:   %[[PRODUCER:.*]] = arith.cmpi uge, %[[TID]], %c128_i32
+//         CHECK:   scf.if %[[PRODUCER]]
+//         CHECK:     triton_nvidia_gpu.reg_dealloc 40
+//         CHECK:     scf.for
+//         CHECK:       arith.addi
+//         CHECK:       triton_nvidia_gpu.wait_barrier
+//         CHECK:       triton_nvidia_gpu.barrier_expect %{{.*}}, 49152
+// CHECK-COUNT-2:       triton_nvidia_gpu.async_tma_copy_global_to_local
+//     CHECK-NOT:       triton_nvidia_gpu.warp_group_dot
+//         CHECK:       scf.yield
+//         CHECK:   } else {
+//         CHECK:     triton_nvidia_gpu.reg_alloc 232
+//         CHECK:     scf.for
+//         CHECK:       triton_nvidia_gpu.wait_barrier
+//     CHECK-NOT:       tt.experimental_descriptor_load
+//         CHECK:       triton_nvidia_gpu.warp_group_dot
+//         CHECK:       triton_nvidia_gpu.arrive_barrier
+//         CHECK:       scf.yield
+// CHECK-COUNT-6:     triton_nvidia_gpu.inval_barrier
+//         CHECK:     tt.experimental_descriptor_store
+  tt.func public @matmul_tma(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<i8> {tt.divisibility = 16 : i32}) {
+    %c256_i32 = arith.constant 256 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %c64_i32 = arith.constant 64 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x256xf32, #mma>
+    %0:2 = scf.for %arg3 = %c0_i32 to %c256_i32 step %c1_i32 iter_args(%arg4 = %cst, %arg5 = %c0_i32) -> (tensor<128x256xf32, #mma>, i32)  : i32 {
+      %1 = tt.experimental_descriptor_load %arg0[%c0_i32, %arg5] : !tt.ptr<i8> -> tensor<128x64xf16, #blocked>
+      %2 = triton_gpu.local_alloc %1 : (tensor<128x64xf16, #blocked>) -> !tt.memdesc<128x64xf16, #shared, #triton_gpu.shared_memory>
+      %3 = tt.experimental_descriptor_load %arg1[%arg5, %c0_i32] : !tt.ptr<i8> -> tensor<64x256xf16, #blocked1>
+      %4 = triton_gpu.local_alloc %3 : (tensor<64x256xf16, #blocked1>) -> !tt.memdesc<64x256xf16, #shared, #triton_gpu.shared_memory>
+      %5 = triton_nvidia_gpu.warp_group_dot %2, %4, %arg4 { inputPrecision = 0 : i32 } : !tt.memdesc<128x64xf16, #shared, #triton_gpu.shared_memory> * !tt.memdesc<64x256xf16, #shared, #triton_gpu.shared_memory> -> tensor<128x256xf32, #mma>
+      %6 = arith.addi %arg5, %c64_i32 : i32
+      scf.yield %5, %6 : tensor<128x256xf32, #mma>, i32
+    }
+    tt.experimental_descriptor_store %arg2[%c0_i32, %c0_i32], %0#0 : !tt.ptr<i8>, tensor<128x256xf32, #mma>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [1, 4], order = [1, 0]}>
+// The coordinates of the loads depend on a loaded tensor, the loop is left to
+// the pipeliner.
+// CHECK-NOT: triton_gpu.num-producer-warps
+module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, triton_gpu.target = "cuda:90", "triton_gpu.threads-per-warp" = 32 : i32} {
+// CHECK-LABEL: @indirect_tma
+//   CHECK-NOT:   triton_nvidia_gpu.reg_dealloc
+//       CHECK:   tt.experimental_descriptor_load
+  tt.func public @indirect_tma(%arg0: !tt.ptr<i8> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<i32>, %arg2: !tt.ptr<i8> {tt.divisibility = 16 : i32}) {
+    %c8_i32 = arith.constant 8 : i32
+    %c0_i32 = arith.constant 0 : i32
+    %c1_i32 = arith.constant 1 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf16, #blocked>
+    %0 = scf.for %arg3 = %c0_i32 to %c8_i32 step %c1_i32 iter_args(%arg4 = %cst) -> (tensor<128x64xf16, #blocked>)  : i32 {
+      %1 = tt.addptr %arg1, %arg3 : !tt.ptr<i32>, i32
+      %2 = tt.load %1 : !tt.ptr<i32>
+      %3 = tt.experimental_descriptor_load %arg0[%2, %c0_i32] : !tt.ptr<i8> -> tensor<128x64xf16, #blocked>
+      %4 = arith.addf %arg4, %3 : tensor<128x64xf16, #blocked>
+      scf.yield %4 : tensor<128x64xf16, #blocked>
+    }
+    tt.experimental_descriptor_store %arg2[%c0_i32, %c0_i32], %0 : !tt.ptr<i8>, tensor<128x64xf16, #blocked>
+    tt.return
+  }
+}
@@ -15,18 +15,41 @@ struct TestMembarPass
 
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestMembarPass);
 
+  TestMembarPass() = default;
+  TestMembarPass(const TestMembarPass &other) : PassWrapper(other) {}
+
   StringRef getArgument() const final { return "test-print-membar"; }
   StringRef getDescription() const final {
     return "print the result of the allocation pass";
   }
 
+  Option<bool> precise{*this, "precise",
+                       llvm::cl::desc("track the accessed slices of "
+                                      "multi-buffered allocations"),
+                       llvm::cl::init(false)};
+  Option<bool> namedBarriers{
+      *this, "named-barriers",
+      llvm::cl::desc("synchronize only the warps exchanging data when known"),
+      llvm::cl::init(false)};
+  Option<bool> printBarrierCount{
+      *this, "print-barrier-count",
+      llvm::cl::desc("emit a remark with the number of inserted barriers"),
+      llvm::cl::init(false)};
+
   void runOnOperation() override {
     Operation *operation = getOperation();
     ModuleOp moduleOp = cast<ModuleOp>(operation);
     // Print all ops after membar pass
     ModuleAllocation allocation(moduleOp);
-    ModuleMembarAnalysis membarPass(&allocation);
+    ModuleMembarAnalysis membarPass(&allocation, precise, namedBarriers);
     membarPass.run();
+    if (!printBarrierCount)
+      return;
+    moduleOp.walk([&](FunctionOpInterface funcOp) {
+      funcOp.emitRemark() << "inserted "
+                          << membarPass.getNumInsertedBarriers(funcOp)
+                          << " barriers";
+    });
   }
 };
 
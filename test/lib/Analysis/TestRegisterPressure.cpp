@@ -0,0 +1,44 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestRegisterPressurePass
+    : public PassWrapper<TestRegisterPressurePass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestRegisterPressurePass);
+
+  StringRef getArgument() const final { return "test-print-register-pressure"; }
+  StringRef getDescription() const final {
+    return "print the registers per thread of the values live at each op";
+  }
+
+  void runOnOperation() override {
+    auto &os = llvm::errs();
+    ModuleOp moduleOp = getOperation();
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
+      os << opName << "\n";
+      RegisterPressureAnalysis analysis(funcOp);
+      funcOp.walk([&](Operation *op) {
+        if (op == funcOp.getOperation())
+          return;
+        os << op->getName() << ": " << analysis.getRegisters(op) << "\n";
+      });
+      os << "max = " << analysis.getMaxRegisters() << "\n";
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestRegisterPressurePass() {
+  PassRegistration<TestRegisterPressurePass>();
+}
+} // namespace test
+} // namespace mlir
@@ -0,0 +1,229 @@
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// Links relocatable code objects into executables in process with the Code
+// Object Manager, which saves the temporary files and the subprocess of lld.
+// The library is loaded with dlopen, so only the parts of its interface that
+// are used here are declared.
+
+typedef enum {
+  AMD_COMGR_STATUS_SUCCESS = 0x0,
+  AMD_COMGR_STATUS_ERROR = 0x1,
+} amd_comgr_status_t;
+
+typedef enum {
+  AMD_COMGR_DATA_KIND_LOG = 0x5,
+  AMD_COMGR_DATA_KIND_RELOCATABLE = 0x7,
+  AMD_COMGR_DATA_KIND_EXECUTABLE = 0x8,
+} amd_comgr_data_kind_t;
+
+typedef enum {
+  AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE = 0x9,
+} amd_comgr_action_kind_t;
+
+typedef struct {
+  uint64_t handle;
+} amd_comgr_data_t;
+
+typedef struct {
+  uint64_t handle;
+} amd_comgr_data_set_t;
+
+typedef struct {
+  uint64_t handle;
+} amd_comgr_action_info_t;
+
+#define COMGR_SYMBOL_LIST(FOR_EACH)                                            \
+  FOR_EACH(amd_comgr_create_data, amd_comgr_data_kind_t, amd_comgr_data_t *)   \
+  FOR_EACH(amd_comgr_release_data, amd_comgr_data_t)                           \
+  FOR_EACH(amd_comgr_set_data, amd_comgr_data_t, size_t, const char *)         \
+  FOR_EACH(amd_comgr_set_data_name, amd_comgr_data_t, const char *)            \
+  FOR_EACH(amd_comgr_get_data, amd_comgr_data_t, size_t *, char *)             \
+  FOR_EACH(amd_comgr_create_data_set, amd_comgr_data_set_t *)                  \
+  FOR_EACH(amd_comgr_destroy_data_set, amd_comgr_data_set_t)                   \
+  FOR_EACH(amd_comgr_data_set_add, amd_comgr_data_set_t, amd_comgr_data_t)     \
+  FOR_EACH(amd_comgr_action_data_get_data, amd_comgr_data_set_t,               \
+           amd_comgr_data_kind_t, size_t, amd_comgr_data_t *)                  \
+  FOR_EACH(amd_comgr_create_action_info, amd_comgr_action_info_t *)            \
+  FOR_EACH(amd_comgr_destroy_action_info, amd_comgr_action_info_t)             \
+  FOR_EACH(amd_comgr_action_info_set_isa_name, amd_comgr_action_info_t,        \
+           const char *)                                                       \
+  FOR_EACH(amd_comgr_action_info_set_logging, amd_comgr_action_info_t, bool)   \
+  FOR_EACH(amd_comgr_do_action, amd_comgr_action_kind_t,                       \
+           amd_comgr_action_info_t, amd_comgr_data_set_t,                      \
+           amd_comgr_data_set_t)
+
+#define DEFINE_EACH_ERR_FIELD(comgrSymbolName, ...)                            \
+  amd_comgr_status_t (*comgrSymbolName)(__VA_ARGS__);
+
+static struct ComgrSymbolTable {
+  COMGR_SYMBOL_LIST(DEFINE_EACH_ERR_FIELD)
+} comgrSymbolTable;
+
+static bool initSymbolTable(const char *libPath) {
+  static void *lib = NULL;
+  if (lib != NULL)
+    return true;
+  void *handle = dlopen(libPath, RTLD_LAZY | RTLD_LOCAL);
+  if (handle == NULL) {
+    PyErr_Format(PyExc_RuntimeError, "cannot open %s", libPath);
+    return false;
+  }
+  // Resets all existing errors
+  dlerror();
+#define QUERY_EACH_FN(comgrSymbolName, ...)                                    \
+  comgrSymbolTable.comgrSymbolName = dlsym(handle, #comgrSymbolName);        \
+  if (comgrSymbolTable.comgrSymbolName == NULL) {                              \
+    PyErr_Format(PyExc_RuntimeError, "cannot query " #comgrSymbolName          \
+                                     " from %s",                               \
+                 libPath);                                                     \
+    dlclose(handle);                                                           \
+    return false;                                                              \
+  }
+
+  COMGR_SYMBOL_LIST(QUERY_EACH_FN)
+  lib = handle;
+  return true;
+}
+
+// Returns a malloc'ed copy of the data, whose size is stored in size.
+static char *getData(amd_comgr_data_t data, size_t *size) {
+  if (comgrSymbolTable.amd_comgr_get_data(data, size, NULL) !=
+      AMD_COMGR_STATUS_SUCCESS)
+    return NULL;
+  char *bytes = malloc(*size + 1);
+  if (bytes == NULL)
+    return NULL;
+  bytes[*size] = '\0';
+  if (comgrSymbolTable.amd_comgr_get_data(data, size, bytes) !=
+      AMD_COMGR_STATUS_SUCCESS) {
+    free(bytes);
+    return NULL;
+  }
+  return bytes;
+}
+
+static PyObject *linkExecutable(PyObject *self, PyObject *args) {
+  const char *libPath;
+  const char *isaName;
+  const char *relocatable;
+  Py_ssize_t relocatableSize;
+  if (!PyArg_ParseTuple(args, "ssy#", &libPath, &isaName, &relocatable,
+                        &relocatableSize))
+    return NULL;
+  if (!initSymbolTable(libPath))
+    return NULL;
+
+  struct ComgrSymbolTable *comgr = &comgrSymbolTable;
+  amd_comgr_data_t input = {0}, output = {0}, log = {0};
+  amd_comgr_data_set_t inputSet = {0}, outputSet = {0};
+  amd_comgr_action_info_t info = {0};
+  bool haveInput = false, haveOutput = false, haveLog = false;
+  bool haveInputSet = false, haveOutputSet = false, haveInfo = false;
+  amd_comgr_status_t status;
+  char *executable = NULL;
+  size_t executableSize = 0;
+  char *errorLog = NULL;
+  size_t errorLogSize = 0;
+
+  Py_BEGIN_ALLOW_THREADS;
+  status = comgr->amd_comgr_create_data(AMD_COMGR_DATA_KIND_RELOCATABLE,
+                                        &input);
+  haveInput = status == AMD_COMGR_STATUS_SUCCESS;
+  if (status == AMD_COMGR_STATUS_SUCCESS)
+    status = comgr->amd_comgr_set_data(input, relocatableSize, relocatable);
+  if (status == AMD_COMGR_STATUS_SUCCESS)
+    status = comgr->amd_comgr_set_data_name(input, "kernel.o");
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = comgr->amd_comgr_create_data_set(&inputSet);
+    haveInputSet = status == AMD_COMGR_STATUS_SUCCESS;
+  }
+  if (status == AMD_COMGR_STATUS_SUCCESS)
+    status = comgr->amd_comgr_data_set_add(inputSet, input);
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = comgr->amd_comgr_create_data_set(&outputSet);
+    haveOutputSet = status == AMD_COMGR_STATUS_SUCCESS;
+  }
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = comgr->amd_comgr_create_action_info(&info);
+    haveInfo = status == AMD_COMGR_STATUS_SUCCESS;
+  }
+  if (status == AMD_COMGR_STATUS_SUCCESS)
+    status = comgr->amd_comgr_action_info_set_isa_name(info, isaName);
+  if (status == AMD_COMGR_STATUS_SUCCESS)
+    status = comgr->amd_comgr_action_info_set_logging(info, true);
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = comgr->amd_comgr_do_action(
+        AMD_COMGR_ACTION_LINK_RELOCATABLE_TO_EXECUTABLE, info, inputSet,
+        outputSet);
+    if (status != AMD_COMGR_STATUS_SUCCESS) {
+      haveLog = comgr->amd_comgr_action_data_get_data(
+                    outputSet, AMD_COMGR_DATA_KIND_LOG, 0, &log) ==
+                AMD_COMGR_STATUS_SUCCESS;
+      if (haveLog)
+        errorLog = getData(log, &errorLogSize);
+    }
+  }
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = comgr->amd_comgr_action_data_get_data(
+        outputSet, AMD_COMGR_DATA_KIND_EXECUTABLE, 0, &output);
+    haveOutput = status == AMD_COMGR_STATUS_SUCCESS;
+  }
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    executable = getData(output, &executableSize);
+    if (executable == NULL)
+      status = AMD_COMGR_STATUS_ERROR;
+  }
+  if (haveLog)
+    comgr->amd_comgr_release_data(log);
+  if (haveOutput)
+    comgr->amd_comgr_release_data(output);
+  if (haveInput)
+    comgr->amd_comgr_release_data(input);
+  if (haveInfo)
+    comgr->amd_comgr_destroy_action_info(info);
+  if (haveOutputSet)
+    comgr->amd_comgr_destroy_data_set(outputSet);
+  if (haveInputSet)
+    comgr->amd_comgr_destroy_data_set(inputSet);
+  Py_END_ALLOW_THREADS;
+
+  if (status != AMD_COMGR_STATUS_SUCCESS) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "amd_comgr failed to link the code object: \n%s",
+                 errorLog ? errorLog : "");
+    free(errorLog);
+    return NULL;
+  }
+  free(errorLog);
+  PyObject *ret = PyBytes_FromStringAndSize(executable, executableSize);
+  free(executable);
+  return ret;
+}
+
+static PyMethodDef ModuleMethods[] = {
+    {"link_executable", linkExecutable, METH_VARARGS,
+     "Link a relocatable code object into an executable one with the Code "
+     "Object Manager library at the given path"},
+    {NULL, NULL, 0, NULL} // sentinel
+};
+
+static struct PyModuleDef ModuleDef = {PyModuleDef_HEAD_INIT, "hip_comgr",
+                                       NULL, // documentation
+                                       -1,   // size
+                                       ModuleMethods};
+
+PyMODINIT_FUNC PyInit_hip_comgr(void) {
+  PyObject *m = PyModule_Create(&ModuleDef);
+  if (m == NULL) {
+    return NULL;
+  }
+
+  PyModule_AddFunctions(m, ModuleMethods);
+
+  return m;
+}
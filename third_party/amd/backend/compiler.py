@@ -1,8 +1,9 @@
-from triton.backends.compiler import BaseBackend, GPUTarget
+from triton.backends.compiler import BaseBackend, BudgetedPassManager, GPUTarget
 from triton._C.libtriton import ir, passes, llvm, amd
 from dataclasses import dataclass
-from typing import Any, Tuple
+from typing import Any, Optional, Tuple
 import hashlib
+import json
 import tempfile
 import os
 import re
@@ -11,11 +12,55 @@ import functools
 from pathlib import Path
 
 
+@functools.lru_cache()
+def get_comgr():
+    """
+    Get the module that links code objects in process with the Code Object Manager library, and the path of the
+    library, or None if it is not found.
+    """
+    if os.environ.get("TRITON_HIP_LINK_IN_PROCESS", "1") != "1":
+        return None
+    lib = os.getenv("TRITON_LIBCOMGR_PATH")
+    if not lib:
+        # The library is installed next to the HIP runtime
+        from triton.backends.amd.driver import _get_path_to_hip_runtime_dylib
+        try:
+            lib_dir = os.path.dirname(_get_path_to_hip_runtime_dylib())
+        except RuntimeError:
+            return None
+        libs = [os.path.join(lib_dir, f"libamd_comgr.so{suffix}") for suffix in ("", ".3", ".2")]
+        lib = next((path for path in libs if os.path.exists(path)), None)
+        if lib is None:
+            return None
+    from triton.backends.amd.driver import compile_module_from_src
+    try:
+        mod = compile_module_from_src(Path(os.path.join(os.path.dirname(__file__), "comgr.c")).read_text(),
+                                      "hip_comgr")
+    except Exception:
+        return None
+    return mod, lib
+
+
+def parse_amdgcn_resource_usage(amdgcn: str):
+    """
+    Get the registers and spills of the kernel from the comments and the metadata of its assembly.
+    """
+    vgprs = re.search(r"; TotalNumVgprs: (\d+)", amdgcn) or re.search(r"; NumVgprs: (\d+)", amdgcn)
+    spills = re.search(r"\.vgpr_spill_count:\s+(\d+)", amdgcn)
+    return {"n_regs": int(vgprs.group(1)) if vgprs else 0, "n_spills": int(spills.group(1)) if spills else 0}
+
+
 @dataclass(frozen=True)
 class HIPOptions:
     num_warps: int = 4
     waves_per_eu: int = 1
+    # num_stages == 0, the default, selects the legacy two-stage stream pipeliner,
+    # other values the multi-stage one.
     num_stages: int = 0
+    # prefetch_depth is the number of K slices of the MFMA/WMMA operands of the next
+    # loop iteration that are loaded from LDS into registers during the current
+    # one.
+    prefetch_depth: int = 1
     num_ctas: int = 1
     extern_libs: dict = None
     cluster_dims: tuple = (1, 1, 1)
@@ -23,13 +68,48 @@ class HIPOptions:
     arch: str = None
     allow_fp8e4nv: bool = False
     allow_fp8e4b15: bool = False
+    # fp8 x fp16/bf16 dots keep the fp8 operand narrow in LDS and upcast it
+    # after it is loaded into registers.
+    allow_mixed_fp8_dot: bool = True
     default_dot_input_precision: str = "ieee"
-    allowed_dot_input_precisions: Tuple[str] = ("ieee", )
+    allowed_dot_input_precisions: Tuple[str] = ("bf16x3", "bf16x6", "bf16x9", "ieee")
     enable_fp_fusion: bool = True
     matrix_instr_nonkdim: int = 0
     kpack: int = 1
     allow_flush_denorm: bool = False
     max_num_imprecise_acc_default: int = 0
+    # Instruction scheduling hints emitted around MFMA/WMMA instructions:
+    # 'none' keeps the current order, 'interleave' spreads LDS and global
+    # memory accesses between matrix instructions.
+    instruction_sched_variant: str = 'none'
+    # tile_swizzle remaps the program ids of matmul kernels that don't group
+    # their tiles themselves, so that consecutive programs visit group_size
+    # rows of output tiles column by column and share operands in L2.
+    tile_swizzle: bool = True
+    group_size: int = 8
+    # forward_store_to_load replaces loads of tensors stored earlier in the
+    # same block through provably distinct pointers with the stored values.
+    forward_store_to_load: bool = False
+    # auto_unroll unrolls by two the small loops that only load small tiles
+    # and have no loop_unroll_factor, interleaving the loads of the copies.
+    auto_unroll: bool = False
+    # compile_time_budget is the number of seconds the TTGIR optimizations may
+    # take before the optional ones are skipped, defaults to no budget.
+    compile_time_budget: Optional[float] = None
+    # disabled_passes names the TTGIR passes that are not run, as the name of
+    # their `add_` function, e.g. `add_prefetch`, optionally followed by
+    # `@<n>` to only disable its n-th instance. See triton.tools.bisect_passes.
+    disabled_passes: tuple = ()
+    # cooperative kernels are launched with hipModuleLaunchCooperativeKernel,
+    # which guarantees that all their blocks are resident at once so that they
+    # may synchronize across the grid, and fails if the grid is too large.
+    # Kernels that call grid_sync always are.
+    cooperative: bool = False
+    # llvm_opt_level is the level, from 0 to 3, of the LLVM optimizations of
+    # make_llir. fast_math lets the device libraries use their approximate
+    # math functions and sqrt. Both may be tuned per Config.
+    llvm_opt_level: int = 3
+    fast_math: bool = False
     backend_name: str = 'hip'
 
     def __post_init__(self):
@@ -44,6 +124,7 @@ class HIPOptions:
         object.__setattr__(self, 'extern_libs', tuple(extern_libs.items()))
         assert self.num_warps > 0 and (self.num_warps & (self.num_warps - 1)) == 0, \
                "num_warps must be a power of 2"
+        assert self.llvm_opt_level in (0, 1, 2, 3), "llvm_opt_level must be between 0 and 3"
 
     def hash(self):
         key = '_'.join([f'{name}-{val}' for name, val in self.__dict__.items()])
@@ -66,6 +147,11 @@ class HIPBackend(BaseBackend):
         if not "enable_fp_fusion" in args:
             args["enable_fp_fusion"] = os.getenv("TRITON_DEFAULT_FP_FUSION", "1") == "1"
         args.update({k: opts[k] for k in HIPOptions.__dataclass_fields__.keys() if k in opts})
+        if "compile_time_budget" not in args and os.getenv("TRITON_COMPILE_TIME_BUDGET"):
+            args["compile_time_budget"] = float(os.getenv("TRITON_COMPILE_TIME_BUDGET"))
+        if "disabled_passes" not in args and os.getenv("TRITON_DISABLE_PASSES"):
+            args["disabled_passes"] = os.getenv("TRITON_DISABLE_PASSES").split(",")
+        args["disabled_passes"] = tuple(args.get("disabled_passes", ()))
         return HIPOptions(**args)
 
     def pack_metadata(self, metadata):
@@ -76,6 +162,7 @@ class HIPBackend(BaseBackend):
             metadata.cluster_dims[0],
             metadata.cluster_dims[1],
             metadata.cluster_dims[2],
+            int(metadata.cooperative),
         )
 
     def get_codegen_implementation(self):
@@ -111,13 +198,25 @@ class HIPBackend(BaseBackend):
         pm.enable_debug()
         passes.common.add_inliner(pm)
         passes.ttir.add_rewrite_tensor_pointer(pm)
+        passes.ttir.add_allocate_workspace(pm)
+        if options.tile_swizzle:
+            passes.ttir.add_tile_swizzle(pm, options.group_size)
+        passes.ttir.add_magic_divisors(pm)
         passes.ttir.add_combine(pm)
-        passes.common.add_canonicalizer(pm)
+        # canonicalization, CSE and LICM run on the functions of the module in parallel
+        passes.common.add_func_canonicalizer(pm)
         passes.ttir.add_reorder_broadcast(pm)
-        passes.common.add_cse(pm)
-        passes.common.add_licm(pm)
+        passes.common.add_func_cse(pm)
+        if options.forward_store_to_load:
+            passes.ttir.add_forward_store_to_load(pm)
+        passes.ttir.add_narrow_offsets(pm)
+        passes.common.add_func_licm(pm)
         passes.common.add_symbol_dce(pm)
         pm.run(mod)
+        metadata["cooperative"] = options.cooperative or HIPBackend.uses_grid_sync(mod)
+        metadata["workspace_size"] = mod.get_int_attr("tt.workspace_size") or 0
+        metadata["workspace_zeroed_size"] = mod.get_int_attr("tt.workspace_zeroed_size") or 0
+        metadata["magic_divisors"] = json.loads(mod.get_str_attr("tt.magic_divisors") or "[]")
         return mod
 
     @staticmethod
@@ -127,31 +226,43 @@ class HIPBackend(BaseBackend):
         passes.ttir.add_convert_to_ttgpuir(pm, f"hip:{options.arch}", options.num_warps, options.warp_size,
                                            options.num_ctas)
         pm.run(mod)
-        pm = ir.pass_manager(mod.context)
-        pm.enable_debug()
-        passes.ttgpuir.add_coalesce(pm)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_optimize_thread_locality(pm)
-        amd.passes.ttgpuir.add_accelerate_matmul(pm, options.arch, options.matrix_instr_nonkdim, options.kpack)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        amd.passes.ttgpuir.add_optimize_epilogue(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, True)
-        if options.num_stages == 0 and amd.has_matrix_core_feature(options.arch):
-            amd.passes.ttgpuir.add_stream_pipeline(pm)
-            passes.common.add_canonicalizer(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, True)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_reduce_data_duplication(pm)
+        # the optional passes are skipped once the compile time budget is spent
+        pm = BudgetedPassManager(mod, options.compile_time_budget, options.disabled_passes)
+        pm.add(passes.ttgpuir.add_coalesce)
+        pm.add(passes.ttgpuir.add_decompose_scaled_dot)
+        if amd.has_matrix_core_feature(options.arch):
+            pm.add(passes.ttgpuir.add_f32_dot_tc)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(passes.ttgpuir.add_optimize_thread_locality, optional=True)
+        pm.add(amd.passes.ttgpuir.add_accelerate_matmul, options.arch, options.matrix_instr_nonkdim, options.kpack)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(amd.passes.ttgpuir.add_optimize_epilogue, optional=True)
+        pm.add(passes.ttgpuir.add_optimize_dot_operands, True, optional=True)
+        pm.add(passes.ttgpuir.add_loop_unroll, options.auto_unroll, optional=True)
+        if amd.has_matrix_core_feature(options.arch):
+            if options.num_stages == 0:
+                pm.add(amd.passes.ttgpuir.add_stream_pipeline)
+            else:
+                pm.add(amd.passes.ttgpuir.add_stream_pipelinev2, options.num_stages)
+            pm.add(passes.common.add_canonicalizer)
+            pm.add(passes.ttgpuir.add_prefetch, options.prefetch_depth)
+        pm.add(passes.ttgpuir.add_optimize_dot_operands, True, optional=True)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(passes.ttgpuir.add_reduce_data_duplication)
         if options.num_stages != 0:
-            amd.passes.ttgpuir.add_reorder_instructions(pm)
-        passes.common.add_cse(pm)
-        passes.common.add_symbol_dce(pm)
-        pm.run(mod)
+            pm.add(amd.passes.ttgpuir.add_reorder_instructions, optional=True)
+        pm.add(passes.common.add_cse)
+        pm.add(passes.common.add_symbol_dce)
+        pm.run()
+        metadata["skipped_passes"] = pm.skipped_passes
+        metadata["budget_exceeded"] = pm.budget_exceeded
+        metadata["ttgir_pipeline"] = pm.pipeline
         return mod
 
     @staticmethod
     def make_llir(src, metadata, options):
         mod = src
+        metadata["estimated_regs"] = mod.estimate_registers_per_thread()
         # TritonGPU -> LLVM-IR (MLIR)
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
@@ -178,12 +289,16 @@ class HIPBackend(BaseBackend):
         passes.common.add_cse(pm)
         passes.common.add_symbol_dce(pm)
         if os.environ.get("TRITON_DISABLE_LINE_INFO", "0") == "0":
-            passes.llvmir.add_di_scope(pm)
+            # the line table of the kernel only, without the scopes of the inlined functions
+            inlined_scopes = os.environ.get("TRITON_LINE_TABLES_ONLY", "0") == "0"
+            passes.llvmir.add_di_scope(pm, inlined_scopes)
         # This pass (`add_builtin_func_to_llvmir`) serves as a temporary workaround to address the issue of excessive basic block
         # count caused by predicated loads/stores. In certain kernels, the addition of these blocks can cause the MLIR
         # canonicalizer to never finish when attempting to merge blocks. The permanent solution under consideration
         # involves using MUBUF instructions that have built-in out-of-bounds checks, which would eliminate the need
         # for conditional branching around memory accesses.
+        if options.instruction_sched_variant != 'none':
+            amd.passes.ttgpuir.add_insert_instruction_sched_hints(pm, options.instruction_sched_variant)
         amd.passes.ttgpuir.add_builtin_func_to_llvmir(pm)
         pm.run(mod)
 
@@ -197,8 +312,8 @@ class HIPBackend(BaseBackend):
         amd.set_isa_version(llvm_mod, options.arch)
         amd.set_abi_version(llvm_mod, 400)
         amd.set_bool_control_constant(llvm_mod, "__oclc_finite_only_opt", False)
-        amd.set_bool_control_constant(llvm_mod, "__oclc_correctly_rounded_sqrt32", True)
-        amd.set_bool_control_constant(llvm_mod, "__oclc_unsafe_math_opt", False)
+        amd.set_bool_control_constant(llvm_mod, "__oclc_correctly_rounded_sqrt32", not options.fast_math)
+        amd.set_bool_control_constant(llvm_mod, "__oclc_unsafe_math_opt", options.fast_math)
         amd.set_bool_control_constant(llvm_mod, "__oclc_wavefrontsize64", options.warp_size == 64)
 
         # Set kernel attributes first given this may affect later optimizations.
@@ -214,7 +329,7 @@ class HIPBackend(BaseBackend):
             paths = [path for (name, path) in options.extern_libs if amd.need_extern_lib(llvm_mod, name)]
             llvm.link_extern_libs(llvm_mod, paths)
 
-        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3, amd.TARGET_TRIPLE)
+        llvm.optimize_module(llvm_mod, getattr(llvm, f"OPTIMIZE_O{options.llvm_opt_level}"), amd.TARGET_TRIPLE)
 
         # Get some metadata
         metadata["shared"] = src.get_int_attr("triton_gpu.shared")
@@ -235,12 +350,22 @@ class HIPBackend(BaseBackend):
         if os.environ.get("AMDGCN_ENABLE_DUMP", "0") == "1":
             print("// -----// AMDGCN Dump //----- //")
             print(amdgcn)
+        metadata.update(parse_amdgcn_resource_usage(amdgcn))
         return amdgcn
 
     @staticmethod
     def make_hsaco(src, metadata, options):
         hsaco = amd.assemble_amdgcn(src, options.arch, '')
 
+        comgr = get_comgr()
+        if comgr is not None:
+            mod, lib = comgr
+            try:
+                return mod.link_executable(lib, f"amdgcn-amd-amdhsa--{options.arch}", hsaco)
+            except RuntimeError:
+                # lld reports the errors
+                pass
+
         rocm_path = HIPBackend.path_to_rocm_lld()
         with tempfile.NamedTemporaryFile() as tmp_out:
             with tempfile.NamedTemporaryFile() as tmp_in:
@@ -251,6 +376,16 @@ class HIPBackend(BaseBackend):
                 ret = fd_out.read()
         return ret
 
+    # Options that are only read after the given stage
+    late_stage_options = {
+        # the frontend reads num_ctas and cluster_dims
+        "ttir": ("num_warps", "waves_per_eu", "num_stages", "prefetch_depth", "enable_fp_fusion",
+                 "matrix_instr_nonkdim", "kpack", "allow_flush_denorm", "instruction_sched_variant",
+                 "compile_time_budget", "disabled_passes", "llvm_opt_level", "fast_math", "auto_unroll"),
+        "ttgir": ("waves_per_eu", "enable_fp_fusion", "allow_flush_denorm", "instruction_sched_variant",
+                  "llvm_opt_level", "fast_math"),
+    }
+
     def add_stages(self, stages, options):
         stages["ttir"] = lambda src, metadata: self.make_ttir(src, metadata, options)
         stages["ttgir"] = lambda src, metadata: self.make_ttgir(src, metadata, options)
@@ -258,6 +393,10 @@ class HIPBackend(BaseBackend):
         stages["amdgcn"] = lambda src, metadata: self.make_amdgcn(src, metadata, options)
         stages["hsaco"] = lambda src, metadata: self.make_hsaco(src, metadata, options)
 
+    def get_stage_options(self, options, stage):
+        late_options = self.late_stage_options.get(stage, ())
+        return {name: value for name, value in options.__dict__.items() if name not in late_options}
+
     @functools.lru_cache()
     def hash(self):
         version = subprocess.check_output([HIPBackend.path_to_rocm_lld(), "--version"], encoding='utf-8')
@@ -41,8 +41,19 @@ static const char *hipLibSearchPaths[] = {"/*py_libhip_search_path*/"};
                   void **optionValues)                                         \
   FOR_EACH_ERR_FN(hipModuleGetFunction, hipFunction_t *function,               \
                   hipModule_t module, const char *kname)                       \
+  FOR_EACH_ERR_FN(hipModuleUnload, hipModule_t module)                         \
+  FOR_EACH_ERR_FN(hipDeviceSynchronize, void)                                  \
+  FOR_EACH_ERR_FN(hipStreamIsCapturing, hipStream_t stream,                    \
+                  hipStreamCaptureStatus *pCaptureStatus)                      \
   FOR_EACH_ERR_FN(hipFuncGetAttribute, int *, hipFunction_attribute attr,      \
-                  hipFunction_t function)
+                  hipFunction_t function)                                      \
+  FOR_EACH_ERR_FN(hipDeviceGetAttribute, int *, hipDeviceAttribute_t attr,     \
+                  int deviceId)                                                \
+  FOR_EACH_ERR_FN(hipGetDevice, int *deviceId)                                 \
+  FOR_EACH_ERR_FN(hipDeviceCanAccessPeer, int *canAccessPeer, int deviceId,    \
+                  int peerDeviceId)                                            \
+  FOR_EACH_ERR_FN(hipDeviceEnablePeerAccess, int peerDeviceId,                 \
+                  unsigned int flags)
 
 // The HIP symbol table for holding resolved dynamic library symbols.
 struct HIPSymbolTable {
@@ -130,14 +141,23 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   hipDeviceProp_tR0000 props;
   HIP_CHECK(hipSymbolTable.hipGetDeviceProperties(&props, device_id));
 
+  // The VGPR file of a CU is split between its 4 SIMDs, with 512 registers
+  // per lane each. A block takes at least a wave.
+  int max_regs_per_sm = 4 * 512 * props.warpSize;
+  int max_blocks_per_sm = props.maxThreadsPerMultiProcessor / props.warpSize;
+
   // create a struct to hold device properties
   return Py_BuildValue(
-      "{s:i, s:i, s:i, s:i, s:i, s:i, s:s, s:i}", "max_shared_mem",
-      props.sharedMemPerBlock, "max_num_regs", props.regsPerBlock,
-      "multiprocessor_count", props.multiProcessorCount, "sm_clock_rate",
-      props.clockRate, "mem_clock_rate", props.memoryClockRate, "mem_bus_width",
-      props.memoryBusWidth, "arch", props.gcnArchName, "warpSize",
-      props.warpSize);
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:s, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem", props.sharedMemPerBlock, "max_num_regs",
+      props.regsPerBlock, "multiprocessor_count", props.multiProcessorCount,
+      "sm_clock_rate", props.clockRate, "mem_clock_rate",
+      props.memoryClockRate, "mem_bus_width", props.memoryBusWidth, "arch",
+      props.gcnArchName, "warpSize", props.warpSize, "max_threads_per_sm",
+      props.maxThreadsPerMultiProcessor, "max_blocks_per_sm",
+      max_blocks_per_sm, "max_regs_per_sm", max_regs_per_sm,
+      "max_shared_mem_per_sm", (int)props.maxSharedMemoryPerMultiProcessor,
+      "reserved_shared_mem", 0);
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -176,6 +196,18 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
   hipSymbolTable.hipFuncGetAttribute(&n_spills,
                                      HIP_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES, fun);
   n_spills /= 4;
+  // hipFuncSetAttribute takes the host stubs of the runtime API, not the
+  // functions of modules, whose dynamic LDS limit is the one of the device.
+  // Check it once, when the function is loaded, rather than on every launch.
+  int shared_max;
+  HIP_CHECK(hipSymbolTable.hipFuncGetAttribute(
+      &shared_max, HIP_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, fun));
+  if (shared > shared_max) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "kernel %s needs %d bytes of LDS, the function allows %d",
+                 name, shared, shared_max);
+    return NULL;
+  }
   if (PyErr_Occurred()) {
     return NULL;
   }
@@ -183,11 +215,58 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+// Waits for the kernels in flight and unloads the module. Synchronizing would
+// invalidate a capture of the given stream, so returns False without unloading
+// while it is being captured.
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  uint64_t mod;
+  uint64_t stream;
+  if (!PyArg_ParseTuple(args, "KK", &mod, &stream))
+    return NULL;
+  hipStreamCaptureStatus status;
+  HIP_CHECK(hipSymbolTable.hipStreamIsCapturing((hipStream_t)stream, &status));
+  if (status != hipStreamCaptureStatusNone)
+    Py_RETURN_FALSE;
+  HIP_CHECK(hipSymbolTable.hipDeviceSynchronize());
+  HIP_CHECK(hipSymbolTable.hipModuleUnload((hipModule_t)mod));
+  Py_RETURN_TRUE;
+}
+
+// Maps the memory of a peer device into the current device, so that kernels
+// can load from and store to the tensors of the peer through their pointers.
+static PyObject *enablePeerAccess(PyObject *self, PyObject *args) {
+  int peer;
+  if (!PyArg_ParseTuple(args, "i", &peer))
+    return NULL;
+  int device;
+  HIP_CHECK(hipSymbolTable.hipGetDevice(&device));
+  if (device == peer)
+    Py_RETURN_NONE;
+  int canAccessPeer = 0;
+  HIP_CHECK(
+      hipSymbolTable.hipDeviceCanAccessPeer(&canAccessPeer, device, peer));
+  if (!canAccessPeer) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "device %d can't access the memory of device %d", device,
+                 peer);
+    return NULL;
+  }
+  hipError_t err = hipSymbolTable.hipDeviceEnablePeerAccess(peer, 0);
+  if (err != hipErrorPeerAccessAlreadyEnabled)
+    HIP_CHECK(err);
+  Py_RETURN_NONE;
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided hsaco into HIP driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module returned by load_binary, unless the given stream is "
+     "being captured"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"enable_peer_access", enablePeerAccess, METH_VARARGS,
+     "Map the memory of the given peer device into the current device"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
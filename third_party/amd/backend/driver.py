@@ -7,7 +7,7 @@ from pathlib import Path
 from triton.runtime.build import _build
 from triton.runtime.cache import get_cache_manager
 from triton.backends.compiler import GPUTarget
-from triton.backends.driver import GPUDriver
+from triton.backends.driver import GPUDriver, workspaces
 
 dirname = os.path.dirname(os.path.realpath(__file__))
 include_dir = [os.path.join(dirname, "include")]
@@ -100,7 +100,9 @@ class HIPUtils(object):
         src = src.replace('/*py_libhip_search_path*/', libhip_path, 1)
         mod = compile_module_from_src(src, "hip_utils")
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
         self.get_device_properties = mod.get_device_properties
+        self.enable_peer_access = mod.enable_peer_access
 
 
 # -------------------- Launcher ----------------------------
@@ -126,10 +128,13 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def make_launcher(constants, signature, ids, warp_size):
+def make_launcher(constants, signature, ids, warp_size, workspace_zeroed_size=0, magic_divisors=()):
     start_desc = len(signature)
     #signature = generate_cu_signature(constants, signature, ids)
-    arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    # The magic numbers of the divisor arguments come last, the launcher computes them from the divisors.
+    arg_decls = ', '.join([f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items()] +
+                          [f"uint32_t magic{i}, uint32_t shift{i}" for i in magic_divisors])
+    magic_args = ''.join(f", magic{i}, shift{i}" for i in magic_divisors)
 
     def _extracted_type(ty):
         if ty[0] == '*':
@@ -176,6 +181,10 @@ def make_launcher(constants, signature, ids, warp_size):
 
     # generate glue code
     params = [i for i in signature.keys() if i not in constants]
+    # the workspace buffer is the last argument, and its zeroed workspaces are cleared before each launch
+    clear_workspace = ""
+    if workspace_zeroed_size:
+        clear_workspace = f"HIP_CHECK(hipSymbolTable.hipMemsetD8Async(arg{max(signature)}, 0, {workspace_zeroed_size}, stream));"
     src = f"""
 #define __HIP_PLATFORM_AMD__
 #include <hip/hip_runtime.h>
@@ -199,7 +208,11 @@ static const char *hipLibSearchPaths[] = {{"{libhip_path}"}};
                   unsigned int sharedMemBytes, hipStream_t stream,            \\
                   void **kernelParams, void **extra)                          \\
   FOR_EACH_ERR_FN(hipPointerGetAttribute, void *data,                         \\
-                  hipPointer_attribute attribute, hipDeviceptr_t ptr)
+                  hipPointer_attribute attribute, hipDeviceptr_t ptr)         \\
+  FOR_EACH_ERR_FN(hipMemsetD8Async, hipDeviceptr_t dest, unsigned char value, \\
+                  size_t count, hipStream_t stream)                           \\
+  FOR_EACH_ERR_FN(hipStreamIsCapturing, hipStream_t stream,                   \\
+                  hipStreamCaptureStatus *pCaptureStatus)
 
 // The HIP symbol table for holding resolved dynamic library symbols.
 struct HIPSymbolTable {{
@@ -213,6 +226,15 @@ struct HIPSymbolTable {{
 
 static struct HIPSymbolTable hipSymbolTable;
 
+// hipModuleLaunchCooperativeKernel is missing from older HIP runtimes, so it is
+// resolved separately and only required by cooperative launches.
+typedef hipError_t (*hipModuleLaunchCooperativeKernel_t)(
+    hipFunction_t f, unsigned int gridDimX, unsigned int gridDimY,
+    unsigned int gridDimZ, unsigned int blockDimX, unsigned int blockDimY,
+    unsigned int blockDimZ, unsigned int sharedMemBytes, hipStream_t stream,
+    void **kernelParams);
+static hipModuleLaunchCooperativeKernel_t launchCooperativeKernel = NULL;
+
 bool initSymbolTable() {{
   // Use the HIP runtime library loaded into the existing process if it exits.
   void *lib = dlopen("libamdhip64.so", RTLD_NOLOAD);
@@ -252,6 +274,10 @@ bool initSymbolTable() {{
 
   HIP_SYMBOL_LIST(QUERY_EACH_FN, QUERY_EACH_FN)
 
+  *(void **)&launchCooperativeKernel =
+      dlsym(lib, "hipModuleLaunchCooperativeKernel");
+  dlerror();
+
   return true;
 }}
 
@@ -269,13 +295,22 @@ static inline void gpuAssert(hipError_t code, const char *file, int line)
 
 #define HIP_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
 
-static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, hipStream_t stream, hipFunction_t function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, int cooperative, hipStream_t stream, hipFunction_t function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
   // printf("_launch hip kernel\\n");
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in params)} }};
+  void *params[] = {{ {', '.join([f"&arg{i}" for i in params] + [f"&magic{i}, &shift{i}" for i in magic_divisors])} }};
   if (gridX*gridY*gridZ > 0) {{
+    {clear_workspace}
+    if (cooperative) {{
+      if (!launchCooperativeKernel) {{
+        PyErr_SetString(PyExc_RuntimeError, "cooperative launches need hipModuleLaunchCooperativeKernel, which libamdhip64.so lacks");
+        return;
+      }}
+      HIP_CHECK(launchCooperativeKernel(function, gridX, gridY, gridZ, {warp_size}*num_warps, 1, 1, shared_memory, stream, params));
+    }} else {{
       HIP_CHECK(hipSymbolTable.hipModuleLaunchKernel(function, gridX, gridY, gridZ, {warp_size}*num_warps, 1, 1, shared_memory, stream, params, 0));
     }}
   }}
+}}
 
 typedef struct _DevicePtrInfo {{
     hipDeviceptr_t dev_ptr;
@@ -323,6 +358,46 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
   return ptr_info;
 }}
 
+// The magic number and shift of a divisor argument, with which the kernel
+// divides x <= 2^31 as (umulhi(x, magic) + x) >> shift.
+static inline bool getMagicNumbers(int32_t divisor, int idx, uint32_t *magic, uint32_t *shift) {{
+  if (divisor <= 0) {{
+    PyErr_Format(PyExc_ValueError, "Divisor argument (at %d) must be positive, got %d", idx, divisor);
+    return false;
+  }}
+  uint32_t l = 0;
+  while (((uint64_t)1 << l) < (uint64_t)divisor)
+    ++l;
+  *magic = (uint32_t)(((((uint64_t)1 << l) - divisor) << 32) / divisor + 1);
+  *shift = l;
+  return true;
+}}
+
+// Functions launched while their stream was being captured. The captured
+// graphs keep running them after the launch returns, so their modules are never
+// unloaded, see CompiledKernel.unload.
+static PyObject *capturedFunctions = NULL;
+
+static void recordCapturedLaunch(hipStream_t stream, uint64_t function) {{
+  hipStreamCaptureStatus status = hipStreamCaptureStatusNone;
+  HIP_CHECK(hipSymbolTable.hipStreamIsCapturing(stream, &status));
+  if (status == hipStreamCaptureStatusNone)
+    return;
+  if (!capturedFunctions && !(capturedFunctions = PySet_New(NULL)))
+    return;
+  PyObject *key = PyLong_FromUnsignedLongLong(function);
+  if (key) {{
+    PySet_Add(capturedFunctions, key);
+    Py_DECREF(key);
+  }}
+}}
+
+static PyObject* captured_functions(PyObject* self, PyObject* args) {{
+  if (!capturedFunctions && !(capturedFunctions = PySet_New(NULL)))
+    return NULL;
+  return PyFrozenSet_New(capturedFunctions);
+}}
+
 static PyObject* launch(PyObject* self, PyObject* args) {{
    // printf("launch\\n");
   int gridX, gridY, gridZ;
@@ -340,8 +415,8 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   }}
 
   // extract kernel metadata
-  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ;
-  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ)) {{
+  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ, cooperative;
+  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ, &cooperative)) {{
     return NULL;
   }}
   // extract launch metadata
@@ -356,7 +431,11 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
   // raise exception asap
   {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, (hipStream_t)_stream, (hipFunction_t)_function{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()) if len(signature) > 0 else ''});
+  {" ".join([f"uint32_t magic{i}, shift{i}; if (!getMagicNumbers(_arg{i}, {i}, &magic{i}, &shift{i})) return NULL;" for i in magic_divisors])}
+  recordCapturedLaunch((hipStream_t)_stream, _function);
+  if (PyErr_Occurred())
+    return NULL;
+  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, cooperative, (hipStream_t)_stream, (hipFunction_t)_function{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()) if len(signature) > 0 else ''}{magic_args});
 
   if(launch_exit_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
@@ -376,6 +455,7 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
 static PyMethodDef ModuleMethods[] = {{
   {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"captured_functions", captured_functions, METH_NOARGS, "The functions launched while their stream was being captured"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
@@ -410,12 +490,27 @@ class HIPLauncher(object):
         cst_key = lambda i: src.fn.arg_names.index(i) if isinstance(i, str) else i
         constants = {cst_key(key): value for key, value in constants.items()}
         signature = {cst_key(key): value for key, value in src.signature.items()}
-        src = make_launcher(constants, signature, ids, metadata.warp_size)
+        kernel_args = [i for i in signature if i not in constants]
+        magic_divisors = [kernel_args[arg] for arg in getattr(metadata, "magic_divisors", [])]
+        # the buffer of the workspaces follows the kernel arguments
+        self.workspace_size = getattr(metadata, "workspace_size", 0)
+        if self.workspace_size:
+            signature[max(signature, default=-1) + 1] = "*i8"
+        src = make_launcher(constants, signature, ids, metadata.warp_size,
+                            getattr(metadata, "workspace_zeroed_size", 0), magic_divisors)
         mod = compile_module_from_src(src, "__triton_launcher")
-        self.launch = mod.launch
+        self.captured_functions = mod.captured_functions
+        if self.workspace_size:
+            # keep the native dispatcher from skipping __call__
+            self._launch = mod.launch
+        else:
+            self.launch = mod.launch
 
     def __call__(self, *args, **kwargs):
-        self.launch(*args, **kwargs)
+        if not self.workspace_size:
+            return self.launch(*args, **kwargs)
+        # the launch arguments start with the grid, stream, function, metadata and hooks
+        self._launch(*args, workspaces.get(args[3], self.workspace_size), **kwargs)
 
 
 class HIPDriver(GPUDriver):
@@ -86,7 +86,13 @@ public:
   unsigned getNDim();
   StringRef getInsnName();
   unsigned getKBase();
+  unsigned getLatencyCycles();
 };
+
+// Returns the number of cycles the matrix core is busy issuing the MFMA
+// instruction named `insnName`, or std::nullopt if it is not one of the
+// instructions in the selection table.
+std::optional<unsigned> getMfmaLatencyCycles(StringRef insnName);
 } // namespace mlir
 
 #endif // TRITON_DIALECT_TRITONAMDGPU_TRANSFORMS_MFMAGROUP_H_
@@ -8,6 +8,8 @@ namespace mlir {
 
 std::unique_ptr<Pass> createTritonAMDGPUStreamPipelinePass();
 
+std::unique_ptr<Pass> createTritonAMDGPUStreamPipelineV2Pass(int numStages = 2);
+
 std::unique_ptr<Pass>
 createTritonAMDGPUAccelerateMatmulPass(std::string archGenName = std::string(),
                                        int matrixInstructionSize = 0,
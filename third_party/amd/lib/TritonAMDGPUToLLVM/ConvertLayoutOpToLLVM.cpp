@@ -7,6 +7,7 @@
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::triton::gpu::AMDMfmaEncodingAttr;
 using ::mlir::triton::gpu::AMDWmmaEncodingAttr;
+using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 using ::mlir::triton::gpu::SharedEncodingAttr;
@@ -129,6 +130,10 @@ public:
         isa<DotOperandEncodingAttr>(dstLayout)) {
       return lowerMfmaToDotOperand(op, adaptor, rewriter);
     }
+    if (isa<AMDMfmaEncodingAttr>(srcLayout) &&
+        isa<BlockedEncodingAttr>(dstLayout)) {
+      return lowerMfmaToBlocked(op, adaptor, rewriter);
+    }
     return failure();
   }
 
@@ -158,6 +163,62 @@ private:
     }
     return failure();
   }
+
+  // Transposes mfma results into a blocked layout with one ds_bpermute per
+  // destination register when getMfmaToBlockedLanePermute accepts the
+  // conversion. Other conversions go through shared memory.
+  LogicalResult
+  lowerMfmaToBlocked(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    std::optional<LanePermuteConversion> permute =
+        getMfmaToBlockedLanePermute(op.getSrc().getType(), op.getType());
+    if (!permute.has_value())
+      return failure();
+
+    auto mod = op->getParentOfType<ModuleOp>();
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(threadsPerWarp));
+    SmallVector<Value> laneBits;
+    Value permutedLane = i32_val(0);
+    for (auto [i, lane] : llvm::enumerate(permute->laneLane)) {
+      laneBits.push_back(icmp_ne(and_(laneId, i32_val(1 << i)), i32_val(0)));
+      permutedLane =
+          xor_(permutedLane, select(laneBits[i], i32_val(lane), i32_val(0)));
+    }
+
+    // Returns vals[base ^ offset(laneId)], where `offsets` gives the offset
+    // for each lane bit.
+    std::function<Value(ArrayRef<Value>, ArrayRef<int32_t>, int32_t, unsigned)>
+        selectByLane = [&](ArrayRef<Value> vals, ArrayRef<int32_t> offsets,
+                           int32_t base, unsigned bit) -> Value {
+      if (bit == offsets.size())
+        return vals[base];
+      Value unset = selectByLane(vals, offsets, base, bit + 1);
+      if (offsets[bit] == 0)
+        return unset;
+      Value set = selectByLane(vals, offsets, base ^ offsets[bit], bit + 1);
+      return select(laneBits[bit], set, unset);
+    };
+
+    auto inVals = unpackLLElements(loc, adaptor.getSrc(), rewriter);
+    int numRounds = 1 << permute->roundLane.size();
+    SmallVector<Value> received;
+    for (int k = 0; k < numRounds; ++k) {
+      int32_t srcReg = LanePermuteConversion::apply(permute->roundSrcReg, k);
+      Value val = selectByLane(inVals, permute->senderReg, srcReg, 0);
+      int32_t laneOffset = LanePermuteConversion::apply(permute->roundLane, k);
+      Value srcLane = xor_(permutedLane, i32_val(laneOffset));
+      received.push_back(LLVM::AMD::shuffleIdx(loc, rewriter, val, srcLane));
+    }
+    SmallVector<Value> outVals;
+    for (int r = 0; r < numRounds; ++r)
+      outVals.push_back(selectByLane(received, permute->dstReg, r, 0));
+    Value result = packLLElements(loc, getTypeConverter(), outVals, rewriter,
+                                  op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
 };
 } // namespace
 
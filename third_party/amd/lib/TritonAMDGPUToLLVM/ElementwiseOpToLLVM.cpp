@@ -913,28 +913,30 @@ struct FpToFpOpConversion
     auto dstElementType = getElementType(op.getResult());
     auto roundingMode = op.getRounding();
 
+    // The random bits of stochastic rounding are added in software, after
+    // which the values convert exactly.
+    bool isStochastic = roundingMode == RoundingMode::RS;
+    if (isStochastic)
+      roundingMode = RoundingMode::RTNE;
+    auto getSrc = [&](unsigned i) -> Value {
+      if (!isStochastic)
+        return operands[i][0];
+      return applyStochasticRounding(
+          loc, rewriter, operands[i][0], operands[i][1],
+          cast<FloatType>(srcElementType), cast<FloatType>(dstElementType));
+    };
+
     if (srcElementType.isF32() && dstElementType.isF16()) {
       assert(roundingMode.has_value() &&
              "rounding mode must be specified for fp32->fp16 conversion");
-      SmallVector<Value> outVals;
-      outVals.reserve(operands[0].size());
-      for (Value v : operands[0]) {
-        outVals.push_back(
-            cvtFp32ToFp16(loc, rewriter, v, roundingMode.value()));
-      }
-      return outVals;
+      return {cvtFp32ToFp16(loc, rewriter, getSrc(0), roundingMode.value())};
     }
 
     if (srcElementType.isF32() && dstElementType.isBF16()) {
       assert(roundingMode.has_value() &&
              "rounding mode must be specified for fp32->bf16 conversion");
-      SmallVector<Value> outVals;
-      outVals.reserve(operands[0].size());
-      for (Value v : operands[0]) {
-        outVals.push_back(
-            convertFp32ToBf16(loc, rewriter, v, roundingMode.value()));
-      }
-      return outVals;
+      return {
+          convertFp32ToBf16(loc, rewriter, getSrc(0), roundingMode.value())};
     }
 
     size_t numElements = 4;
@@ -954,7 +956,7 @@ struct FpToFpOpConversion
     SmallVector<Value> inVals;
     inVals.reserve(std::min(numElements, operands.size()));
     for (unsigned i = 0; i < std::min(numElements, operands.size()); i++) {
-      inVals.push_back(operands[i][0]);
+      inVals.push_back(getSrc(i));
     }
     if (useFP16IntermediateSrc)
       for (Value &v : inVals)
@@ -1035,6 +1037,9 @@ struct FMulOpConversion
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FMulOp>(loc, rewriter, operands)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      // Selected to v_pk_* on the targets with packed math
+      return createPackedOp<LLVM::FMulOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FMulOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -1057,6 +1062,8 @@ struct FAddOpConversion
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FAddOp>(loc, rewriter, operands)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return createPackedOp<LLVM::FAddOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FAddOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -1079,6 +1086,8 @@ struct FSubOpConversion
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
       return {EmitDualBF16ElementwiseOp<LLVM::FSubOp>(loc, rewriter, operands)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return createPackedOp<LLVM::FSubOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FSubOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -1123,7 +1132,16 @@ struct SIToFPOpConversion
                                    Location loc) const {
     Type inElemTy = getElementType(op.getIn());
     Type outElemTy = getElementType(op.getOut());
-    if (outElemTy.isBF16() && inElemTy.isInteger(8) && operands.size() >= 4) {
+    std::optional<bool> int4Signed = getUnpackedInt4Signedness(op.getIn());
+    if (inElemTy.isInteger(8) && operands.size() >= 4 &&
+        (outElemTy.isF16() || (outElemTy.isBF16() && int4Signed))) {
+      SmallVector<Value> inVals = {operands[0][0], operands[1][0],
+                                   operands[2][0], operands[3][0]};
+      return convertPackedIntToFp(loc, rewriter, inVals, outElemTy,
+                                  int4Signed ? 4 : 8,
+                                  int4Signed.value_or(true));
+    } else if (outElemTy.isBF16() && inElemTy.isInteger(8) &&
+               operands.size() >= 4) {
       SmallVector<Value> inVals = {operands[0][0], operands[1][0],
                                    operands[2][0], operands[3][0]};
       auto outVals = S8_to_Bf16(loc, rewriter, inVals);
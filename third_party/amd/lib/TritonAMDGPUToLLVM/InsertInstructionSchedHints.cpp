@@ -0,0 +1,187 @@
+#include "TritonAMDGPUToLLVM/Passes.h"
+
+#include "TritonAMDGPUTransforms/MfmaGroup.h"
+#include "Utility.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Pass/Pass.h"
+
+#include <algorithm>
+
+namespace mlir {
+namespace triton {
+#define GEN_PASS_DEF_INSERTINSTRUCTIONSCHEDHINTS
+#include "TritonAMDGPUToLLVM/Passes.h.inc"
+} // namespace triton
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+// Instruction classes accepted by llvm.amdgcn.sched.group.barrier.
+enum SchedGroupMask : int32_t {
+  MFMA = 0x008,
+  VMEM_READ = 0x020,
+  DS_READ = 0x100,
+  DS_WRITE = 0x200,
+};
+
+constexpr int kSharedAddrSpace = 3;
+
+// Issue cycles budgeted per memory instruction. A wave can issue a memory
+// instruction every four cycles; the other half of the slots is left for the
+// VALU address arithmetic that feeds them.
+constexpr unsigned kMemIssueCycles = 8;
+// gfx11 WMMA instructions are not in the MFMA selection table; they occupy the
+// matrix core for as long as a 16x16 MFMA.
+constexpr unsigned kWmmaCycles = 32;
+
+struct BlockInstructionCounts {
+  // Issue latency of every matrix core instruction, in program order.
+  SmallVector<unsigned> matrixCycles;
+  unsigned dsReads = 0;
+  unsigned dsWrites = 0;
+  unsigned globalReads = 0;
+};
+
+unsigned getAddrSpace(Value ptr) {
+  return cast<LLVM::LLVMPointerType>(ptr.getType()).getAddressSpace();
+}
+
+bool isSharedPtr(Value ptr) {
+  auto ptrTy = dyn_cast<LLVM::LLVMPointerType>(ptr.getType());
+  return ptrTy && ptrTy.getAddressSpace() == kSharedAddrSpace;
+}
+
+BlockInstructionCounts countInstructions(Block &block) {
+  BlockInstructionCounts counts;
+  for (Operation &op : block) {
+    StringRef name = op.getName().getStringRef();
+    if (name.starts_with("rocdl.mfma.")) {
+      counts.matrixCycles.push_back(
+          getMfmaLatencyCycles(name).value_or(kWmmaCycles));
+    } else if (name.starts_with("rocdl.wmma.")) {
+      counts.matrixCycles.push_back(kWmmaCycles);
+    } else if (auto load = dyn_cast<LLVM::LoadOp>(op)) {
+      if (getAddrSpace(load.getAddr()) == kSharedAddrSpace)
+        ++counts.dsReads;
+      else
+        ++counts.globalReads;
+    } else if (auto store = dyn_cast<LLVM::StoreOp>(op)) {
+      if (getAddrSpace(store.getAddr()) == kSharedAddrSpace)
+        ++counts.dsWrites;
+    } else if (auto call = dyn_cast<LLVM::CallOp>(op)) {
+      // Predicated accesses are still calls at this point; their pointer is
+      // always the first argument.
+      // Other calls, e.g. to math libraries, are not counted.
+      std::optional<StringRef> callee = call.getCallee();
+      if (!callee || call.getNumOperands() == 0)
+        continue;
+      if (callee->contains(LLVM::AMD::Predicated_Load)) {
+        if (isSharedPtr(call.getOperand(0)))
+          ++counts.dsReads;
+        else
+          ++counts.globalReads;
+      } else if (callee->contains(LLVM::AMD::Predicated_Store) &&
+                 isSharedPtr(call.getOperand(0))) {
+        ++counts.dsWrites;
+      }
+    }
+  }
+  return counts;
+}
+
+// Spreads `count` instructions as evenly as possible over the matrix
+// instruction slots without exceeding each slot's remaining `capacity`.
+// Instructions that do not fit are left to the backend scheduler.
+SmallVector<unsigned> distribute(unsigned count,
+                                 SmallVectorImpl<unsigned> &capacity) {
+  SmallVector<unsigned> sizes(capacity.size(), 0);
+  unsigned perSlot = llvm::divideCeil(count, capacity.size());
+  for (auto [size, cap] : llvm::zip(sizes, capacity)) {
+    size = std::min({perSlot, cap, count});
+    cap -= size;
+    count -= size;
+  }
+  return sizes;
+}
+
+void createSchedGroupBarrier(OpBuilder &builder, Location loc, int32_t mask,
+                             unsigned size) {
+  auto i32Ty = builder.getI32Type();
+  auto cst = [&](int32_t v) -> Value {
+    return builder.create<LLVM::ConstantOp>(loc, i32Ty,
+                                            builder.getI32IntegerAttr(v));
+  };
+  auto op = builder.create<LLVM::CallIntrinsicOp>(
+      loc, TypeRange{}, ValueRange{cst(mask), cst(size), cst(/*syncID=*/0)});
+  op.setIntrinAttr(builder.getStringAttr("llvm.amdgcn.sched.group.barrier"));
+}
+
+// Asks the scheduler to issue one matrix instruction, then the LDS reads,
+// global reads and LDS writes assigned to it, and so on for every matrix
+// instruction of the block. LDS reads are placed first since they feed the
+// next matrix instructions.
+void interleave(Block &block, const BlockInstructionCounts &counts) {
+  SmallVector<unsigned> capacity;
+  for (unsigned cycles : counts.matrixCycles)
+    capacity.push_back(std::max(1u, cycles / kMemIssueCycles));
+  SmallVector<unsigned> dsReads = distribute(counts.dsReads, capacity);
+  SmallVector<unsigned> globalReads = distribute(counts.globalReads, capacity);
+  SmallVector<unsigned> dsWrites = distribute(counts.dsWrites, capacity);
+
+  Operation *terminator = block.getTerminator();
+  OpBuilder builder(terminator);
+  Location loc = terminator->getLoc();
+  for (unsigned i = 0; i < counts.matrixCycles.size(); ++i) {
+    createSchedGroupBarrier(builder, loc, MFMA, 1);
+    if (dsReads[i])
+      createSchedGroupBarrier(builder, loc, DS_READ, dsReads[i]);
+    if (globalReads[i])
+      createSchedGroupBarrier(builder, loc, VMEM_READ, globalReads[i]);
+    if (dsWrites[i])
+      createSchedGroupBarrier(builder, loc, DS_WRITE, dsWrites[i]);
+  }
+}
+
+struct InsertInstructionSchedHints
+    : public triton::impl::InsertInstructionSchedHintsBase<
+          InsertInstructionSchedHints> {
+  explicit InsertInstructionSchedHints(StringRef variant) {
+    this->variant = variant.str();
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    if (variant == "none")
+      return;
+    if (variant != "interleave") {
+      mod.emitError("unknown instruction scheduling variant: ") << variant;
+      return signalPassFailure();
+    }
+
+    mod.walk([&](LLVM::LLVMFuncOp func) {
+      for (Block &block : func.getBody()) {
+        BlockInstructionCounts counts = countInstructions(block);
+        if (counts.matrixCycles.empty())
+          continue;
+        if (counts.dsReads + counts.dsWrites + counts.globalReads == 0)
+          continue;
+        interleave(block, counts);
+      }
+    });
+  }
+};
+
+} // anonymous namespace
+
+namespace mlir {
+namespace triton {
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createInsertInstructionSchedHintsPass(StringRef variant) {
+  return std::make_unique<InsertInstructionSchedHints>(variant);
+}
+
+} // namespace triton
+} // namespace mlir
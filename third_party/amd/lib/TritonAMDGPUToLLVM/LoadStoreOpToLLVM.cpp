@@ -2,12 +2,20 @@
 #include "TargetInfo.h"
 #include "Utility.h"
 #include "triton/Dialect/TritonGPU/Transforms/Utility.h"
+#include "triton/Tools/Sys/GetEnv.hpp"
+#include "llvm/ADT/TypeSwitch.h"
 
 using namespace mlir;
 using namespace mlir::triton::gpu;
 
 using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::getSharedMemoryBase;
+using ::mlir::LLVM::AMD::createBufferResource;
+using ::mlir::LLVM::AMD::kBufferNumRecords;
+using ::mlir::LLVM::AMD::kBufferOutOfBoundsOffset;
+using ::mlir::LLVM::AMD::llBufferAtomicFAdd;
+using ::mlir::LLVM::AMD::llBufferLoad;
+using ::mlir::LLVM::AMD::llBufferStore;
 using ::mlir::LLVM::AMD::llLoad;
 using ::mlir::LLVM::AMD::llStore;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
@@ -86,6 +94,43 @@ Value redundantDataMask(Type valueTy, ConversionPatternRewriter &rewriter,
   }
   return mask;
 }
+// Returns whether the i32 values of `value` are non-negative, when it is
+// computed from non-negative values by operations keeping them non-negative.
+// Like the offsets of the pointers, the computations are assumed not to
+// overflow.
+bool isNonNegative(Value value) {
+  APInt constant;
+  if (matchPattern(value, m_ConstantInt(&constant)))
+    return constant.isNonNegative();
+  Operation *op = value.getDefiningOp();
+  if (!op)
+    return false;
+  return llvm::TypeSwitch<Operation *, bool>(op)
+      .Case<triton::MakeRangeOp, triton::GetProgramIdOp,
+            triton::GetNumProgramsOp, arith::ExtUIOp>(
+          [](Operation *) { return true; })
+      .Case<triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+            triton::ReshapeOp, triton::gpu::ConvertLayoutOp>(
+          [](Operation *op) { return isNonNegative(op->getOperand(0)); })
+      .Case<arith::AddIOp, arith::MulIOp, arith::DivSIOp, arith::DivUIOp,
+            arith::RemSIOp, arith::RemUIOp, arith::MaxSIOp, arith::MinSIOp,
+            arith::AndIOp>([](Operation *op) {
+        return llvm::all_of(op->getOperands(), isNonNegative);
+      })
+      .Case<arith::SelectOp>([](arith::SelectOp op) {
+        return isNonNegative(op.getTrueValue()) &&
+               isNonNegative(op.getFalseValue());
+      })
+      .Default([](Operation *) { return false; });
+}
+
+// The uniform base pointer and the byte offsets of the buffer accesses of a
+// tensor of pointers.
+struct BufferOperands {
+  Value base;
+  SmallVector<Value> offsets;
+};
+
 // Contains some helper functions for both Load and Store conversions.
 struct LoadStoreConversionBase {
   explicit LoadStoreConversionBase(const AMD::TargetInfo &targetInfo,
@@ -113,6 +158,58 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  // A mask that is true for all the elements needs no predication
+  bool isMaskAlwaysTrue(Value mask) const {
+    auto *axisInfo = axisAnalysisPass.getAxisInfo(mask);
+    return axisInfo && axisInfo->getConstantValue() == 1;
+  }
+
+  // With AMDGCN_USE_BUFFER_OPS=1, the accesses of a tensor of pointers
+  // `addptr(splat(base), offsets)` on CDNA use buffer instructions, when the
+  // i32 offsets are non-negative. The resource of the buffer spans 2 GiB, so
+  // the byte offsets must fit in 31 bits, which is assumed like the absence of
+  // overflows in the offset computation unless `provenRange` is set. Returns
+  // the LLVM values of the base and of the byte offsets of the elements, or
+  // nullopt if they can't be used.
+  std::optional<BufferOperands>
+  getBufferOperands(Value ptr, Type elemTy, Location loc,
+                    ConversionPatternRewriter &rewriter,
+                    bool provenRange = false) const {
+    auto family = targetInfo.getISAFamily();
+    if (!triton::tools::getBoolEnv("AMDGCN_USE_BUFFER_OPS") ||
+        (family != AMD::ISAFamily::CDNA1 && family != AMD::ISAFamily::CDNA2 &&
+         family != AMD::ISAFamily::CDNA3))
+      return std::nullopt;
+    auto addPtr = ptr.getDefiningOp<triton::AddPtrOp>();
+    if (!addPtr)
+      return std::nullopt;
+    auto splat = addPtr.getPtr().getDefiningOp<triton::SplatOp>();
+    auto offsetTy = dyn_cast<RankedTensorType>(addPtr.getOffset().getType());
+    if (!splat || !offsetTy || !offsetTy.getElementType().isInteger(32))
+      return std::nullopt;
+    auto basePtrTy = dyn_cast<triton::PointerType>(splat.getSrc().getType());
+    if (!basePtrTy || basePtrTy.getAddressSpace() != 1 ||
+        !isNonNegative(addPtr.getOffset()))
+      return std::nullopt;
+    int64_t elemBytes = std::max(8u, elemTy.getIntOrFloatBitWidth()) / 8;
+    if (provenRange) {
+      // The last element must end within the records of the resource.
+      auto *axisInfo = axisAnalysisPass.getAxisInfo(addPtr.getOffset());
+      if (!axisInfo || !axisInfo->getRange() ||
+          axisInfo->getRange()->first < 0 ||
+          (axisInfo->getRange()->second + 1) * elemBytes > kBufferNumRecords)
+        return std::nullopt;
+    }
+    Value base = rewriter.getRemappedValue(splat.getSrc());
+    Value offsets = rewriter.getRemappedValue(addPtr.getOffset());
+    if (!base || !offsets)
+      return std::nullopt;
+    BufferOperands operands{base, {}};
+    for (Value offset : unpackLLElements(loc, offsets, rewriter))
+      operands.offsets.push_back(mul(offset, i32_val(elemBytes)));
+    return operands;
+  }
+
 protected:
   const AMD::TargetInfo &targetInfo;
   ModuleAxisInfoAnalysis &axisAnalysisPass;
@@ -146,6 +243,8 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     Value llPtr = adaptor.getPtr();
     Value llMask = adaptor.getMask();
     Value llOther = adaptor.getOther();
+    if (mask && isMaskAlwaysTrue(mask))
+      mask = other = llMask = llOther = Value();
 
     // Determine the vectorization size
     Type valueTy = op.getType();
@@ -189,6 +288,13 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
     const int numVecs = numElems / vec;
 
+    // The masked-out elements of buffer loads are read out of bounds, as
+    // zeros, instead of branching around the loads
+    auto bufferOperands = getBufferOperands(ptr, valueElemTy, loc, rewriter);
+    Value rsrc;
+    if (bufferOperands)
+      rsrc = createBufferResource(rewriter, loc, bufferOperands->base);
+
     SmallVector<Value> loadedVals;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
       // TODO: optimization when ptr is GEP with constant offset
@@ -224,7 +330,17 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
         falseVal = v;
       }
 
-      auto loadVal = llLoad(rewriter, loc, ptr, vecTy, pred, falseVal);
+      Value loadVal;
+      if (bufferOperands) {
+        Value offset = bufferOperands->offsets[vecStart];
+        if (mask)
+          offset = select(pred, offset, i32_val(kBufferOutOfBoundsOffset));
+        loadVal = llBufferLoad(rewriter, loc, rsrc, offset, vecTy);
+        if (otherElems.size() != 0)
+          loadVal = select(pred, loadVal, falseVal);
+      } else {
+        loadVal = llLoad(rewriter, loc, ptr, vecTy, pred, falseVal);
+      }
       for (size_t ii = 0; ii < vec; ++ii) {
         Value vecIdx = createIndexAttrConstant(
             rewriter, loc, this->getTypeConverter()->getIndexType(), ii % vec);
@@ -261,6 +377,8 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
     Value llPtr = adaptor.getPtr();
     Value llMask = adaptor.getMask();
     Value llValue = adaptor.getValue();
+    if (llMask && isMaskAlwaysTrue(op.getMask()))
+      llMask = Value();
 
     auto loc = op->getLoc();
     MLIRContext *ctx = rewriter.getContext();
@@ -292,6 +410,13 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
         std::max<int>(1, valueElemTy.getIntOrFloatBitWidth() / 8);
     const size_t valueElemNBits = dtsize * 8;
 
+    // The masked-out elements of buffer stores are stored out of bounds,
+    // where they are dropped
+    auto bufferOperands = getBufferOperands(ptr, valueElemTy, loc, rewriter);
+    Value rsrc;
+    if (bufferOperands)
+      rsrc = createBufferResource(rewriter, loc, bufferOperands->base);
+
     const int numVecs = elemsPerThread / vec;
     for (size_t vecStart = 0; vecStart < elemsPerThread; vecStart += vec) {
       // TODO: optimization when ptr is AddPtr with constant offset
@@ -327,7 +452,15 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
         }
         llWord = bitcast(llWord, valArgTy);
         Value maskVal = llMask ? and_(mask, maskElems[vecStart]) : mask;
-        auto address = ptrElems[vecStart + wordIdx * wordNElems];
+        const size_t wordStart = vecStart + wordIdx * wordNElems;
+        if (bufferOperands) {
+          Value offset =
+              select(maskVal, bufferOperands->offsets[wordStart],
+                     i32_val(kBufferOutOfBoundsOffset));
+          llBufferStore(rewriter, loc, rsrc, offset, llWord);
+          continue;
+        }
+        auto address = ptrElems[wordStart];
         llStore(rewriter, loc, address, llWord, maskVal);
       }
     }
@@ -336,6 +469,19 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
   }
 };
 
+// The system scope is the default one of LLVM.
+static StringRef getSyncScope(MemSyncScope scope) {
+  switch (scope) {
+  case MemSyncScope::CTA:
+    return "workgroup";
+  case MemSyncScope::GPU:
+    return "agent";
+  case MemSyncScope::SYSTEM:
+    return "";
+  }
+  llvm_unreachable("Invalid MemSyncScope");
+}
+
 static LLVM::AtomicOrdering getMemoryOrdering(MemSemantic memOrdering) {
   switch (memOrdering) {
   case MemSemantic::RELAXED:
@@ -576,6 +722,40 @@ struct AtomicRMWOpConversion
     auto vecTy = vec_ty(valueElemTy, vec);
     auto retType = vec == 1 ? valueElemTy : vecTy;
     SmallVector<Value> resultVals(elemsPerThread);
+
+    // The buffer atomics without return mask the elements out of bounds
+    // instead of branching around the atomics. They are relaxed, so fences at
+    // the scope of the op order them as a whole with the other accesses. A
+    // wrong offset would lose the update, so the offsets must be proven to
+    // fit in the resource.
+    if (tensorTy && opResult.use_empty() && atomicRmwAttr == RMWOp::FADD &&
+        valueElemTy.isF32()) {
+      if (auto bufferOperands = getBufferOperands(
+              ptr, valueElemTy, loc, rewriter, /*provenRange=*/true)) {
+        Value rsrc = createBufferResource(rewriter, loc, bufferOperands->base);
+        bool relaxed = memOrdering == MemSemantic::RELAXED;
+        StringRef syncScope = getSyncScope(op.getScope());
+        if (!relaxed)
+          rewriter.create<LLVM::FenceOp>(loc, LLVM::AtomicOrdering::release,
+                                         syncScope);
+        for (size_t i = 0; i < elemsPerThread; ++i) {
+          Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
+          Value offset = select(rmwMask, bufferOperands->offsets[i],
+                                i32_val(kBufferOutOfBoundsOffset));
+          llBufferAtomicFAdd(rewriter, loc, rsrc, offset, valElements[i]);
+          resultVals[i] = undef(valueElemTy);
+        }
+        if (!relaxed)
+          rewriter.create<LLVM::FenceOp>(loc, LLVM::AtomicOrdering::acquire,
+                                         syncScope);
+        Type structTy = getTypeConverter()->convertType(tensorTy);
+        Value resultStruct = packLLElements(loc, getTypeConverter(),
+                                            resultVals, rewriter, structTy);
+        rewriter.replaceOp(op, {resultStruct});
+        return success();
+      }
+    }
+
     const bool f16v2 = vec == 2 && valueElemTy.isF16();
     for (size_t i = 0; i < elemsPerThread; i += vec) {
       Value rmwPtr = ptrElements[i];
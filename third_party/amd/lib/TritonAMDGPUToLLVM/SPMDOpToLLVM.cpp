@@ -25,10 +25,153 @@ struct GetNumProgramsOpConversion
   }
 };
 
+// Reads the flag at `ptr` with acquire semantics at `scope`. The flag is read
+// with an atomic, which bypasses the non-coherent caches that a plain load
+// could keep hitting.
+Value loadAcquire(ConversionPatternRewriter &rewriter, Location loc, Value ptr,
+                  triton::MemSyncScope scope) {
+  StringRef syncScope;
+  switch (scope) {
+  case triton::MemSyncScope::CTA:
+    syncScope = "workgroup";
+    break;
+  case triton::MemSyncScope::GPU:
+    syncScope = "agent";
+    break;
+  case triton::MemSyncScope::SYSTEM:
+    // The system scope is the default one of LLVM.
+    break;
+  }
+  return rewriter.create<LLVM::AtomicRMWOp>(loc, LLVM::AtomicBinOp::add, ptr,
+                                            i32_val(0),
+                                            LLVM::AtomicOrdering::acquire,
+                                            syncScope);
+}
+
+// The first thread of each workgroup adds the arrival of the workgroup to the
+// counter and spins until the counter reaches the next multiple of the number
+// of workgroups, so that the counter never has to be reset between syncs. The
+// release of the add and the acquire of the reads at agent scope order the
+// memory accesses of the workgroups, and the workgroup barriers around them
+// extend that to all their threads.
+struct GridSyncOpConversion
+    : public ConvertOpToLLVMPattern<triton::GridSyncOp> {
+  using ConvertOpToLLVMPattern<triton::GridSyncOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GridSyncOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    Value ptr = adaptor.getBarrier();
+    // #prev:   barrier; if (tid == 0) goto #arrive; else goto #end
+    // #arrive: target = (atomic_add(ptr, 1) / numCTAs + 1) * numCTAs
+    // #spin:   if (atomic_add(ptr, 0) < target) goto #spin; else goto #end
+    // #end:    barrier
+    Block *prevBlock = op->getBlock();
+    Block *endBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *arriveBlock = rewriter.createBlock(endBlock);
+    Block *spinBlock = rewriter.createBlock(endBlock, {i32_ty}, {loc});
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    barrier();
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    rewriter.create<LLVM::CondBrOp>(loc, isLeader, arriveBlock, endBlock);
+
+    rewriter.setInsertionPointToStart(arriveBlock);
+    Value numCTAs = i32_val(1);
+    for (auto dim : {mlir::gpu::Dimension::x, mlir::gpu::Dimension::y,
+                     mlir::gpu::Dimension::z}) {
+      Value gridDim = rewriter.create<::mlir::gpu::GridDimOp>(loc, dim);
+      numCTAs =
+          mul(numCTAs, rewriter.create<arith::TruncIOp>(loc, i32_ty, gridDim));
+    }
+    Value old = rewriter.create<LLVM::AtomicRMWOp>(
+        loc, LLVM::AtomicBinOp::add, ptr, i32_val(1),
+        LLVM::AtomicOrdering::release, StringRef("agent"));
+    Value target = mul(add(udiv(old, numCTAs), i32_val(1)), numCTAs);
+    rewriter.create<LLVM::BrOp>(loc, target, spinBlock);
+
+    rewriter.setInsertionPointToStart(spinBlock);
+    Value count = loadAcquire(rewriter, loc, ptr, triton::MemSyncScope::GPU);
+    target = spinBlock->getArgument(0);
+    rewriter.create<LLVM::CondBrOp>(loc, icmp_ult(count, target), spinBlock,
+                                    ValueRange{target}, endBlock,
+                                    ValueRange{});
+
+    rewriter.setInsertionPointToStart(endBlock);
+    barrier();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+// The first thread of the workgroup polls the flag, and the others wait for it
+// at a barrier, which extends the acquire of its reads to them.
+struct SignalWaitOpConversion
+    : public ConvertOpToLLVMPattern<triton::SignalWaitOp> {
+  using ConvertOpToLLVMPattern<triton::SignalWaitOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SignalWaitOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    // #prev: if (tid == 0) goto #spin; else goto #end
+    // #spin: if (!cmp(atomic_add(flag, 0), value)) goto #spin; else goto #end
+    // #end:  barrier
+    Block *prevBlock = op->getBlock();
+    Block *endBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *spinBlock = rewriter.createBlock(endBlock);
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    rewriter.create<LLVM::CondBrOp>(loc, isLeader, spinBlock, endBlock);
+
+    rewriter.setInsertionPointToStart(spinBlock);
+    Value flag = loadAcquire(rewriter, loc, adaptor.getFlag(), op.getScope());
+    Value value = adaptor.getValue();
+    Value done;
+    switch (op.getCmp()) {
+    case triton::SignalWaitCmp::EQ:
+      done = icmp_eq(flag, value);
+      break;
+    case triton::SignalWaitCmp::NE:
+      done = icmp_ne(flag, value);
+      break;
+    case triton::SignalWaitCmp::GE:
+      done = icmp_uge(flag, value);
+      break;
+    }
+    rewriter.create<LLVM::CondBrOp>(loc, done, endBlock, spinBlock);
+
+    rewriter.setInsertionPointToStart(endBlock);
+    barrier();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+// HIP has no programmatic dependent launches: the kernels of a stream never
+// overlap, so the grid dependency ops have nothing to order.
+template <typename SourceOp>
+struct GridDepControlOpConversion : public ConvertOpToLLVMPattern<SourceOp> {
+  using ConvertOpToLLVMPattern<SourceOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(SourceOp op, typename SourceOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 } // namespace
 
 void mlir::triton::AMD::populateSPMDOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     PatternBenefit benefit) {
-  patterns.add<GetNumProgramsOpConversion>(typeConverter, benefit);
+  patterns.add<GetNumProgramsOpConversion, GridSyncOpConversion,
+               SignalWaitOpConversion,
+               GridDepControlOpConversion<triton::GridDepWaitOp>,
+               GridDepControlOpConversion<triton::GridDepLaunchDependentsOp>>(
+      typeConverter, benefit);
 }
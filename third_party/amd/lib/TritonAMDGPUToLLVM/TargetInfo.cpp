@@ -77,6 +77,11 @@ Value TargetInfo::ballot(RewriterBase &rewriter, Location loc, Type type,
   return asmResult;
 }
 
+void TargetInfo::clusterBarrier(RewriterBase &rewriter, Location loc) const {
+  // Without CTA clusters the cluster is the workgroup itself.
+  barrier();
+}
+
 void TargetInfo::storeDShared(RewriterBase &rewriter, Location loc, Value ptr,
                               std::optional<Value> ctaId, Value val,
                               Value pred) const {
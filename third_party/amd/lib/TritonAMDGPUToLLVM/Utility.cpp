@@ -180,4 +180,56 @@ void llStore(RewriterBase &rewriter, Location loc, Value ptr, Value val,
   rewriter.create<LLVM::CallOp>(loc, funcOp, ValueRange({ptr, val, pred}));
 }
 
+Value createBufferResource(RewriterBase &rewriter, Location loc, Value base) {
+  auto ctx = rewriter.getContext();
+  Value stride = int_val(16, 0);
+  Value numRecords = i32_val(kBufferNumRecords);
+  // DATA_FORMAT = 32 bits and NUM_FORMAT = float in the last word of the
+  // descriptor, the format the raw buffer instructions of CDNA expect
+  Value flags = i32_val((7 << 12) | (4 << 15));
+  return rewriter.create<ROCDL::MakeBufferRsrcOp>(
+      loc, ptr_ty(ctx, 8), base, stride, numRecords, flags);
+}
+
+namespace {
+// The buffer instructions access bytes, shorts or dwords
+Type getBufferWordType(MLIRContext *ctx, Type type) {
+  unsigned bits = type.getIntOrFloatBitWidth();
+  if (auto vecTy = dyn_cast<VectorType>(type))
+    bits = vecTy.getNumElements() *
+           vecTy.getElementType().getIntOrFloatBitWidth();
+  if (bits <= 32)
+    return IntegerType::get(ctx, bits);
+  assert(bits % 32 == 0 && bits <= 128 && "unsupported buffer access width");
+  return vec_ty(i32_ty, bits / 32);
+}
+} // namespace
+
+Value llBufferLoad(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Type type) {
+  Type wordTy = getBufferWordType(rewriter.getContext(), type);
+  Value soffset = i32_val(0);
+  Value aux = i32_val(0);
+  Value word = rewriter.create<ROCDL::RawPtrBufferLoadOp>(loc, wordTy, rsrc,
+                                                          offset, soffset, aux);
+  return bitcast(word, type);
+}
+
+void llBufferStore(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Value val) {
+  Type wordTy = getBufferWordType(rewriter.getContext(), val.getType());
+  Value soffset = i32_val(0);
+  Value aux = i32_val(0);
+  rewriter.create<ROCDL::RawPtrBufferStoreOp>(loc, bitcast(val, wordTy), rsrc,
+                                              offset, soffset, aux);
+}
+
+void llBufferAtomicFAdd(RewriterBase &rewriter, Location loc, Value rsrc,
+                        Value offset, Value val) {
+  Value soffset = i32_val(0);
+  Value aux = i32_val(0);
+  rewriter.create<ROCDL::RawPtrBufferAtomicFaddOp>(loc, val, rsrc, offset,
+                                                   soffset, aux);
+}
+
 } // namespace mlir::LLVM::AMD
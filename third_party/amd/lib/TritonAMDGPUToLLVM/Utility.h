@@ -8,6 +8,9 @@
 #include "triton/Analysis/Utility.h"
 #include "triton/Conversion/MLIRTypes.h"
 #include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+
+#include <limits>
+
 namespace mlir::LLVM::AMD {
 
 const char Predicated_Load[] = "__predicated_load";
@@ -29,6 +32,28 @@ Value llLoad(RewriterBase &rewriter, Location loc, Value ptr, Type elemTy,
 // Stores to shared or global memory with predication.
 void llStore(RewriterBase &rewriter, Location loc, Value ptr, Value val,
              Value pred);
+
+// Buffer instructions address the bytes of a resource built from a uniform
+// base pointer with 32-bit offsets. The accesses past the records of the
+// resource read zeros and drop their stores, which masks them in hardware.
+const int32_t kBufferNumRecords = std::numeric_limits<int32_t>::max() - 1;
+const int32_t kBufferOutOfBoundsOffset = std::numeric_limits<int32_t>::max();
+
+// Creates the resource of the buffer starting at the global pointer `base`.
+Value createBufferResource(RewriterBase &rewriter, Location loc, Value base);
+
+// Loads a value of `type` from the byte `offset` of the buffer `rsrc`.
+Value llBufferLoad(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Type type);
+
+// Stores `val` to the byte `offset` of the buffer `rsrc`.
+void llBufferStore(RewriterBase &rewriter, Location loc, Value rsrc,
+                   Value offset, Value val);
+
+// Atomically adds `val` to the f32 at the byte `offset` of the buffer `rsrc`,
+// without returning the previous value.
+void llBufferAtomicFAdd(RewriterBase &rewriter, Location loc, Value rsrc,
+                        Value offset, Value val);
 } // namespace mlir::LLVM::AMD
 
 #endif
@@ -182,6 +182,28 @@ Value convertAndCastTensor(mlir::PatternRewriter &rewriter, Value value,
   return castedTensor;
 }
 
+static bool isNativeFp8(Type type) {
+  return type.isFloat8E4M3FNUZ() || type.isFloat8E5M2FNUZ();
+}
+
+/// @brief Choose the element types MFMA instructions consume for a dot
+///
+/// fp8 operands run natively on MFMA3 (gfx940+) and are upcast to f16 on
+/// older matrix cores. The upcast is done after the conversion to the dot
+/// operand layout, so that shared memory keeps the operands in fp8.
+///
+/// @return pair {A, B} of MFMA operand element types
+static std::pair<Type, Type> getMfmaOperandTypes(Type aElemTy, Type bElemTy,
+                                                 int mfmaVersion) {
+  if (isNativeFp8(aElemTy) && isNativeFp8(bElemTy)) {
+    if (mfmaVersion >= 3)
+      return {aElemTy, bElemTy};
+    Type f16Ty = Float16Type::get(aElemTy.getContext());
+    return {f16Ty, f16Ty};
+  }
+  return {aElemTy, bElemTy};
+}
+
 class BlockedToMFMA : public mlir::RewritePattern {
   int mfmaVersion;
   int enforcedNonKDim;
@@ -228,16 +250,15 @@ public:
 
   /// @brief Choose MFMA instruction parameters
   /// @param dot target dot operation
+  /// @param dataTypeA element type of operand A consumed by the instruction
+  /// @param dataTypeB element type of operand B consumed by the instruction
   /// @return pair {mDim, nDim, kDim, kBase} sizes of one MFMA instruction
   /// arguments
   std::tuple<unsigned, unsigned, unsigned, unsigned>
-  chooseMfmaDimensions(tt::DotOp dot) const {
+  chooseMfmaDimensions(tt::DotOp dot, Type dataTypeA, Type dataTypeB) const {
     // number of matrix elements along k dim per one MFMA intruction
     unsigned kDim = 0;
     auto opType = cast<RankedTensorType>(dot.getA().getType());
-    auto dataTypeA = opType.getElementType();
-    auto dataTypeB =
-        cast<RankedTensorType>(dot.getB().getType()).getElementType();
 
     auto resType = cast<RankedTensorType>(dot.getD().getType());
     auto resShape = resType.getShape();
@@ -302,7 +323,11 @@ public:
         !isa<ttg::BlockedEncodingAttr>(oldRetType.getEncoding()))
       return failure();
 
-    if (!supportMFMA(dotOp))
+    auto [mfmaElemTyA, mfmaElemTyB] =
+        getMfmaOperandTypes(dotOp.getA().getType().getElementType(),
+                            dotOp.getB().getType().getElementType(),
+                            mfmaVersion);
+    if (!supportMFMA(dotOp, mfmaElemTyA, mfmaElemTyB))
       return failure();
 
     auto CTALayout = ttg::getCTALayout(oldRetType.getEncoding());
@@ -315,13 +340,12 @@ public:
     // operands
     Value a = dotOp.getA();
     Value b = dotOp.getB();
-    auto oldAType = cast<RankedTensorType>(a.getType());
-    auto oldBType = cast<RankedTensorType>(b.getType());
-    auto ctx = oldAType.getContext();
+    auto ctx = a.getType().getContext();
 
     ttg::AMDMfmaEncodingAttr mfmaEnc;
 
-    auto [mDim, nDim, kDim, kBase] = chooseMfmaDimensions(dotOp);
+    auto [mDim, nDim, kDim, kBase] =
+        chooseMfmaDimensions(dotOp, mfmaElemTyA, mfmaElemTyB);
 
     auto warpsPerTile =
         warpsPerTileMFMA(dotOp, retShape, numWarps, {mDim, nDim});
@@ -382,14 +406,14 @@ public:
     if (!isSecondDot(dotOp))
       kWidth *= kPack;
 
-    auto newAType = RankedTensorType::get(
-        oldAType.getShape(), oldAType.getElementType(),
-        ttg::DotOperandEncodingAttr::get(ctx, 0, mfmaEnc, kWidth));
-    auto newBType = RankedTensorType::get(
-        oldBType.getShape(), oldBType.getElementType(),
-        ttg::DotOperandEncodingAttr::get(ctx, 1, mfmaEnc, kWidth));
-    a = rewriter.create<ttg::ConvertLayoutOp>(a.getLoc(), newAType, a);
-    b = rewriter.create<ttg::ConvertLayoutOp>(b.getLoc(), newBType, b);
+    // Operands are upcast after the layout conversion, i.e. after they are
+    // read from shared memory.
+    a = convertAndCastTensor(
+        rewriter, a, ttg::DotOperandEncodingAttr::get(ctx, 0, mfmaEnc, kWidth),
+        mfmaElemTyA);
+    b = convertAndCastTensor(
+        rewriter, b, ttg::DotOperandEncodingAttr::get(ctx, 1, mfmaEnc, kWidth),
+        mfmaElemTyB);
     auto newDot = rewriter.create<tt::DotOp>(
         dotOp.getLoc(), newAcc.getType(), a, b, newAcc,
         dotOp.getInputPrecision(), dotOp.getMaxNumImpreciseAcc());
@@ -629,6 +653,9 @@ public:
     } else if (matrixCoreVer == MatrixCoreVersion::RDNA_WMMA) {
       patterns.add<::BlockedToWMMA>(context);
     }
+    // Skinny dots are split along K across the lanes rather than getting 4x4
+    // or 4x64 MFMAs
+    mlir::populateDotToGemvPatterns(patterns, /*benefit=*/3);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
     }
@@ -205,6 +205,26 @@ auto getMfmaInsnGroupAttrMap = []() -> const MfmaInsnGroupMap & {
   return MfmaInsnMap;
 };
 
+// Number of cycles the matrix core is busy with one instruction: 32x32
+// instructions take 16 passes, 16x16 take 8 and 4x4 (including the 4x64 and
+// 64x4 multi-block forms) take 2. Each pass is four cycles.
+static unsigned getMfmaCycles(const MfmaInsnAttr &attr) {
+  unsigned passes = 8;
+  if (attr.m == 32 && attr.n == 32)
+    passes = 16;
+  else if (std::min(attr.m, attr.n) == 4)
+    passes = 2;
+  return passes * 4;
+}
+
+std::optional<unsigned> getMfmaLatencyCycles(StringRef insnName) {
+  for (const auto &entry : getMfmaInsnGroupAttrMap()) {
+    if (entry.second.insn == insnName)
+      return getMfmaCycles(entry.second);
+  }
+  return std::nullopt;
+}
+
 FailureOr<MfmaInsn> MfmaInsn::selectMfma(unsigned mDim, unsigned nDim,
                                          Type elementTypeA, Type elementTypeB,
                                          int mfmaVersion) {
@@ -226,4 +246,5 @@ unsigned MfmaInsn::getMDim() { return attr.m; }
 unsigned MfmaInsn::getNDim() { return attr.n; }
 StringRef MfmaInsn::getInsnName() { return attr.insn; }
 unsigned MfmaInsn::getKBase() { return attr.kBase; }
+unsigned MfmaInsn::getLatencyCycles() { return getMfmaCycles(attr); }
 } // namespace mlir
@@ -0,0 +1,90 @@
+#include "TritonAMDGPUTransforms/Passes.h"
+#include "mlir/Support/LLVM.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipelineExpander.h"
+#include "triton/Dialect/TritonGPU/Transforms/PipeliningUtility.h"
+#include "triton/Dialect/TritonGPU/Transforms/Schedule.h"
+
+//===----------------------------------------------------------------------===//
+// This file implements stream software pipelining with the register-staged
+// schedule of the common loop pipeliner, which allows any number of stages.
+//
+// Global loads feeding dot operands are issued into registers stages ahead,
+// then stored to LDS and read back by the dots in the last stage. With two
+// stages this is the same shape as the legacy stream pipeliner: the next tile
+// is prefetched into registers and stored into a single LDS buffer once the
+// current tile has been consumed.
+//===----------------------------------------------------------------------===//
+
+#define GEN_PASS_CLASSES
+#include "TritonAMDGPUTransforms/Passes.h.inc"
+
+using namespace mlir;
+namespace tt = mlir::triton;
+
+// Return true if the preconditions for pipelining the loop are met.
+static bool preCondition(scf::ForOp forOp) {
+  // Skip loop with distance > 1 for now.
+  if (llvm::any_of(forOp.getBody()->getTerminator()->getOperands(),
+                   [](Value operand) { return !operand.getDefiningOp(); }))
+    return false;
+  // Don't pipeline outer loops.
+  if (forOp
+          ->walk([&](Operation *op) {
+            if (forOp.getOperation() == op)
+              return WalkResult::advance();
+            if (isa<scf::ForOp, scf::WhileOp>(op))
+              return WalkResult::interrupt();
+            return WalkResult::advance();
+          })
+          .wasInterrupted())
+    return false;
+  return true;
+}
+
+static bool pipelineLoop(scf::ForOp forOp, int numStages) {
+  if (!preCondition(forOp))
+    return false;
+
+  tt::PipeliningOption options;
+  if (!tt::getRegisterStagedSchedule(forOp, numStages, options))
+    return false;
+
+  IRRewriter rewriter(forOp->getContext());
+  rewriter.setInsertionPoint(forOp);
+  return succeeded(tt::pipelineForLoop(rewriter, forOp, options));
+}
+
+namespace {
+
+struct PipelinePass : public TritonAMDGPUStreamPipelineV2Base<PipelinePass> {
+  PipelinePass() = default;
+  PipelinePass(int32_t numStages) { this->numStages = numStages; }
+
+  int getNumStagesOrDefault(scf::ForOp forOp) {
+    // Use the attribute attached to the loop if it exists otherwise use the
+    // global control.
+    if (auto attr = forOp->getAttrOfType<IntegerAttr>(tt::kNumStagesAttrName))
+      return attr.getInt();
+    return numStages;
+  }
+
+  void runOnOperation() override {
+    SmallVector<scf::ForOp> loops;
+    getOperation()->walk([&](scf::ForOp forOp) {
+      // Bail out for loops with num_stage <= 1.
+      if (getNumStagesOrDefault(forOp) > 1)
+        loops.push_back(forOp);
+    });
+
+    for (scf::ForOp forOp : loops)
+      pipelineLoop(forOp, getNumStagesOrDefault(forOp));
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass>
+mlir::createTritonAMDGPUStreamPipelineV2Pass(int numStages) {
+  return std::make_unique<PipelinePass>(numStages);
+}
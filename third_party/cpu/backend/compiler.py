@@ -0,0 +1,189 @@
+from triton.backends.compiler import BaseBackend, GPUTarget
+from triton._C.libtriton import ir, passes, llvm, cpu
+from dataclasses import dataclass
+from typing import Any, Tuple
+import functools
+import hashlib
+import json
+import os
+import re
+import subprocess
+import sysconfig
+import tempfile
+
+
+@dataclass(frozen=True)
+class CPUOptions:
+    # A program runs as a single thread that holds all the elements of its
+    # tensors, num_warps and num_ctas are only accepted for the kernels tuned
+    # for the GPUs and ignored.
+    num_warps: int = 1
+    num_ctas: int = 1
+    num_stages: int = 0
+    cluster_dims: tuple = (1, 1, 1)
+    extern_libs: dict = None
+    debug: bool = False
+    enable_fp_fusion: bool = True
+    allow_fp8e4nv: bool = False
+    allow_fp8e4b15: bool = False
+    allow_mixed_fp8_dot: bool = False
+    default_dot_input_precision: str = "ieee"
+    allowed_dot_input_precisions: Tuple[str] = ("ieee", )
+    max_num_imprecise_acc_default: int = 0
+    # llvm_opt_level is the level, from 0 to 3, of the LLVM optimizations of
+    # make_llir.
+    llvm_opt_level: int = 3
+    backend_name: str = 'cpu'
+
+    def __post_init__(self):
+        assert self.extern_libs is None, "extern_libs are not supported on CPUs"
+        assert self.llvm_opt_level in (0, 1, 2, 3), "llvm_opt_level must be between 0 and 3"
+
+    def hash(self):
+        key = '_'.join([f'{name}-{val}' for name, val in self.__dict__.items()])
+        return hashlib.sha256(key.encode("utf-8")).hexdigest()
+
+
+class CPUBackend(BaseBackend):
+    """
+    Compiles kernels for the host CPU into shared objects. The tensors of a program are held by a single thread, so
+    that the generic lowering of TritonGPU applies, and the programs of a launch are calls of the kernel. Atomics,
+    TMA descriptors, workspaces and the extern libraries of the GPUs are not supported.
+    """
+
+    @staticmethod
+    def supports_target(target: GPUTarget):
+        return target.backend == 'cpu'
+
+    def __init__(self, target: GPUTarget) -> None:
+        super().__init__(target)
+        self.binary_ext = "so"
+
+    def parse_options(self, opts) -> Any:
+        args = {k: opts[k] for k in CPUOptions.__dataclass_fields__.keys() if k in opts}
+        if "enable_fp_fusion" not in args:
+            args["enable_fp_fusion"] = os.getenv("TRITON_DEFAULT_FP_FUSION", "1") == "1"
+        return CPUOptions(**args)
+
+    def pack_metadata(self, metadata):
+        return (
+            metadata.num_warps,
+            metadata.num_ctas,
+            metadata.shared,
+            metadata.cluster_dims[0],
+            metadata.cluster_dims[1],
+            metadata.cluster_dims[2],
+        )
+
+    def get_codegen_implementation(self):
+        codegen_fns = dict()
+        return codegen_fns
+
+    def load_dialects(self, ctx):
+        cpu.load_dialects(ctx)
+
+    @staticmethod
+    def make_ttir(mod, metadata, options):
+        pm = ir.pass_manager(mod.context)
+        pm.enable_debug()
+        passes.common.add_inliner(pm)
+        passes.ttir.add_rewrite_tensor_pointer(pm)
+        passes.ttir.add_combine(pm)
+        passes.common.add_canonicalizer(pm)
+        passes.ttir.add_reorder_broadcast(pm)
+        passes.common.add_cse(pm)
+        passes.common.add_licm(pm)
+        passes.common.add_symbol_dce(pm)
+        pm.run(mod)
+        return mod
+
+    @staticmethod
+    def make_ttgir(mod, metadata, options):
+        pm = ir.pass_manager(mod.context)
+        pm.enable_debug()
+        # one warp of one thread
+        passes.ttir.add_convert_to_ttgpuir(pm, "cpu", 1, 1, 1)
+        passes.ttgpuir.add_coalesce(pm)
+        passes.ttgpuir.add_remove_layout_conversions(pm)
+        passes.ttgpuir.add_optimize_dot_operands(pm, True)
+        passes.ttgpuir.add_remove_layout_conversions(pm)
+        passes.ttgpuir.add_reduce_data_duplication(pm)
+        passes.common.add_cse(pm)
+        passes.common.add_symbol_dce(pm)
+        pm.run(mod)
+        metadata["num_warps"] = 1
+        metadata["num_ctas"] = 1
+        return mod
+
+    @staticmethod
+    def make_llir(src, metadata, options):
+        mod = src
+        # TritonGPU -> LLVM-IR (MLIR)
+        pm = ir.pass_manager(mod.context)
+        pm.enable_debug()
+        cpu.passes.ttgpuir.add_decompose_unsupported_conversions(pm)
+        passes.convert.add_scf_to_cf(pm)
+        passes.convert.add_index_to_llvmir(pm)
+        passes.ttgpuir.add_allocate_shared_memory(pm)
+        cpu.passes.ttgpuir.add_to_llvmir(pm)
+        passes.convert.add_arith_to_llvmir(pm)
+        passes.common.add_canonicalizer(pm)
+        passes.common.add_cse(pm)
+        passes.common.add_symbol_dce(pm)
+        if os.environ.get("TRITON_DISABLE_LINE_INFO", "0") == "0":
+            passes.llvmir.add_di_scope(pm, True)
+        pm.run(mod)
+        # LLVM-IR (MLIR) -> LLVM-IR (LLVM)
+        llvm.init_targets()
+        context = llvm.context()
+        llvm_mod = llvm.to_module(mod, context)
+        llvm.optimize_module(llvm_mod, getattr(llvm, f"OPTIMIZE_O{options.llvm_opt_level}"),
+                             cpu.get_default_target_triple())
+        metadata["shared"] = src.get_int_attr("triton_gpu.shared")
+        ret = str(llvm_mod)
+        del llvm_mod
+        del context
+        return ret
+
+    @staticmethod
+    def make_asm(src, metadata, options):
+        # the kernel is the only function of the module that is not internal
+        names = re.findall(r"^define (?:dso_local )?void @([a-zA-Z_][a-zA-Z0-9_]*)\(", src, re.MULTILINE)
+        assert len(names) == 1
+        metadata["name"] = names[0]
+        return llvm.translate_to_asm(src, cpu.get_default_target_triple(), cpu.get_host_cpu_name(), '', [],
+                                     options.enable_fp_fusion, False)
+
+    @staticmethod
+    def make_so(src, metadata, options):
+        cc = os.environ.get("CC") or sysconfig.get_config_var("CC") or "cc"
+        with tempfile.TemporaryDirectory() as tmpdir:
+            asm_path = os.path.join(tmpdir, "kernel.s")
+            so_path = os.path.join(tmpdir, "kernel.so")
+            with open(asm_path, "w") as f:
+                f.write(src)
+            # the math functions of the kernel are the ones of the C library
+            subprocess.check_call(cc.split() + ["-shared", "-fPIC", asm_path, "-o", so_path, "-lm"])
+            with open(so_path, "rb") as f:
+                return f.read()
+
+    # Options that are only read after the given stage
+    late_stage_options = {
+        "ttir": ("num_warps", "num_stages", "num_ctas", "cluster_dims", "enable_fp_fusion", "llvm_opt_level"),
+        "ttgir": ("enable_fp_fusion", "llvm_opt_level"),
+    }
+
+    def add_stages(self, stages, options):
+        stages["ttir"] = lambda src, metadata: self.make_ttir(src, metadata, options)
+        stages["ttgir"] = lambda src, metadata: self.make_ttgir(src, metadata, options)
+        stages["llir"] = lambda src, metadata: self.make_llir(src, metadata, options)
+        stages["asm"] = lambda src, metadata: self.make_asm(src, metadata, options)
+        stages["so"] = lambda src, metadata: self.make_so(src, metadata, options)
+
+    def get_stage_options(self, options, stage):
+        late_options = self.late_stage_options.get(stage, ())
+        return {name: value for name, value in options.__dict__.items() if name not in late_options}
+
+    @functools.lru_cache()
+    def hash(self):
+        return f'{cpu.get_host_cpu_name()}-{self.target}'
@@ -0,0 +1,136 @@
+import ctypes
+import os
+import tempfile
+from triton.backends.compiler import GPUTarget
+from triton.backends.driver import DriverBase
+
+
+class CPUUtils(object):
+
+    def __new__(cls):
+        if not hasattr(cls, "instance"):
+            cls.instance = super(CPUUtils, cls).__new__(cls)
+        return cls.instance
+
+    def __init__(self):
+        # handle -> library of the loaded kernels, which keeps them loaded
+        self.libraries = {}
+
+    def load_binary(self, name, kernel, shared, device):
+        """
+        Loads the shared object of a kernel, returns its handle and the address of the kernel. The kernels have no
+        register file, their number of registers and spills are 0.
+        """
+        with tempfile.NamedTemporaryFile(suffix=".so", delete=False) as f:
+            f.write(kernel)
+        try:
+            lib = ctypes.CDLL(f.name)
+        finally:
+            os.unlink(f.name)
+        self.libraries[lib._handle] = lib
+        function = ctypes.cast(getattr(lib, name), ctypes.c_void_p).value
+        return lib._handle, function, 0, 0
+
+    def unload_binary(self, module, stream):
+        """
+        Unloads the shared object of a kernel. The kernels run synchronously, none of them is in flight.
+        """
+        if self.libraries.pop(module, None) is not None:
+            import _ctypes
+            _ctypes.dlclose(module)
+        return True
+
+    def get_device_properties(self, device):
+        # The shared memory of a program is a buffer of its thread
+        return {"max_shared_mem": 1 << 30, "multiprocessor_count": os.cpu_count()}
+
+
+# -------------------- Launcher ----------------------------
+def ty_to_ctype(ty):
+    if ty[0] == '*':
+        return ctypes.c_void_p
+    if ty in ("fp16", "bf16"):
+        raise NotImplementedError(f"scalar arguments of type {ty} are not supported on CPUs")
+    return {
+        "i1": ctypes.c_bool,
+        "i8": ctypes.c_int8,
+        "i16": ctypes.c_int16,
+        "i32": ctypes.c_int32,
+        "i64": ctypes.c_int64,
+        "u1": ctypes.c_bool,
+        "u8": ctypes.c_uint8,
+        "u16": ctypes.c_uint16,
+        "u32": ctypes.c_uint32,
+        "u64": ctypes.c_uint64,
+        "fp32": ctypes.c_float,
+        "f32": ctypes.c_float,
+        "fp64": ctypes.c_double,
+    }[ty]
+
+
+def _pointer(arg):
+    if arg is None:
+        return None
+    if hasattr(arg, "data_ptr"):
+        return arg.data_ptr()
+    return int(arg)
+
+
+class CPULauncher(object):
+    """
+    Launches a kernel as one call per program, in the order of their linear ids, on the calling thread. The program
+    ids and the numbers of programs follow the arguments of the kernel, see `cpu.NUM_LAUNCH_ARGS`.
+    """
+
+    def __init__(self, src, metadata):
+        from triton._C.libtriton import cpu
+        cst_key = lambda i: src.fn.arg_names.index(i) if isinstance(i, str) else i
+        signature = {cst_key(key): value for key, value in src.signature.items()}
+        self.pointer_args = [ty[0] == '*' for ty in signature.values()]
+        arg_types = [ty_to_ctype(ty) for ty in signature.values()]
+        self.kernel_type = ctypes.CFUNCTYPE(None, *arg_types, *([ctypes.c_int32] * cpu.NUM_LAUNCH_ARGS))
+        self.kernels = {}
+
+    def __call__(self, gridX, gridY, gridZ, stream, function, packed_metadata, launch_metadata, launch_enter_hook,
+                 launch_exit_hook, *args):
+        kernel = self.kernels.get(function)
+        if kernel is None:
+            kernel = self.kernels[function] = self.kernel_type(function)
+        args = [_pointer(arg) if is_pointer else arg for arg, is_pointer in zip(args, self.pointer_args)]
+        if launch_enter_hook is not None:
+            launch_enter_hook(launch_metadata)
+        for z in range(gridZ):
+            for y in range(gridY):
+                for x in range(gridX):
+                    kernel(*args, x, y, z, gridX, gridY, gridZ)
+        if launch_exit_hook is not None:
+            launch_exit_hook(launch_metadata)
+
+
+class CPUDriver(DriverBase):
+    """
+    Runs the kernels on the host CPU, when TRITON_CPU_BACKEND=1. The host is the only device, and its only stream is
+    the calling thread.
+    """
+
+    def __init__(self):
+        super().__init__()
+        self.utils = CPUUtils()
+        self.launcher_cls = CPULauncher
+
+    @staticmethod
+    def is_active():
+        return os.environ.get("TRITON_CPU_BACKEND", "0") == "1"
+
+    def get_current_target(self):
+        from triton._C.libtriton import cpu
+        return GPUTarget("cpu", cpu.get_host_cpu_name(), 1)
+
+    def get_current_device(self):
+        return 0
+
+    def set_current_device(self, device):
+        assert device == 0, "the host is the only device of the CPU backend"
+
+    def get_current_stream(self, device=None):
+        return 0
@@ -0,0 +1,39 @@
+#ifndef TRITONCPU_CONVERSION_PASSES_H
+#define TRITONCPU_CONVERSION_PASSES_H
+
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/DialectConversion.h"
+
+#include <memory>
+
+namespace mlir {
+
+class ModuleOp;
+template <typename T> class OperationPass;
+
+namespace triton {
+
+#define GEN_PASS_DECL
+#include "cpu/include/TritonCPUToLLVM/Passes.h.inc"
+
+namespace CPU {
+std::unique_ptr<OperationPass<ModuleOp>>
+createDecomposeUnsupportedConversionsPass();
+
+// Number of the trailing i32 arguments of the kernels: the x, y and z program
+// ids followed by the x, y and z numbers of programs.
+constexpr int kNumLaunchArgs = 6;
+} // namespace CPU
+
+std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonCPUToLLVMPass();
+
+#define GEN_PASS_REGISTRATION
+#include "cpu/include/TritonCPUToLLVM/Passes.h.inc"
+
+} // namespace triton
+
+} // namespace mlir
+
+#endif
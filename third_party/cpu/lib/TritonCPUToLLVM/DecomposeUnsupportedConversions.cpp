@@ -0,0 +1,64 @@
+#include "TritonCPUToLLVM/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Conversion/TritonGPUToLLVM/Patterns.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+using namespace mlir;
+
+namespace mlir {
+namespace triton {
+#define GEN_PASS_DEF_DECOMPOSEUNSUPPORTEDCPUCONVERSIONS
+#include "TritonCPUToLLVM/Passes.h.inc"
+} // namespace triton
+} // namespace mlir
+
+namespace {
+
+// The GPU backends lower mulhiui to a call of their device library, expand it
+// to the high half of the product of the operands extended to twice their
+// width instead.
+void expandMulhiUI(ModuleOp mod) {
+  mod.walk([](triton::MulhiUIOp op) {
+    OpBuilder b(op);
+    auto loc = op.getLoc();
+    Type type = op.getType();
+    unsigned width = getElementTypeOrSelf(type).getIntOrFloatBitWidth();
+    Type wideElemTy = b.getIntegerType(2 * width);
+    Type wideTy = wideElemTy;
+    TypedAttr shift = b.getIntegerAttr(wideElemTy, width);
+    if (auto tensorTy = dyn_cast<RankedTensorType>(type)) {
+      wideTy = tensorTy.clone(wideElemTy);
+      shift = DenseElementsAttr::get(cast<ShapedType>(wideTy), shift);
+    }
+    Value x = b.create<arith::ExtUIOp>(loc, wideTy, op.getX());
+    Value y = b.create<arith::ExtUIOp>(loc, wideTy, op.getY());
+    Value prod = b.create<arith::MulIOp>(loc, x, y);
+    Value hi = b.create<arith::ShRUIOp>(
+        loc, prod, b.create<arith::ConstantOp>(loc, shift));
+    op.replaceAllUsesWith(b.create<arith::TruncIOp>(loc, type, hi));
+    op.erase();
+  });
+}
+
+struct DecomposeUnsupportedConversions
+    : public mlir::triton::impl::DecomposeUnsupportedCPUConversionsBase<
+          DecomposeUnsupportedConversions> {
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    triton::gpu::decomposeSplatOpToSharedLayoutConversion(mod);
+    triton::gpu::decomposeBlockedToDotLayoutConversion(mod);
+    expandMulhiUI(mod);
+  }
+};
+} // namespace
+
+namespace mlir::triton::CPU {
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createDecomposeUnsupportedConversionsPass() {
+  return std::make_unique<DecomposeUnsupportedConversions>();
+}
+
+} // namespace mlir::triton::CPU
@@ -0,0 +1,29 @@
+#include "PatternTritonCPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace {
+// The dots of a single thread are its FMA dots.
+struct DotOpConversion : public ConvertOpToLLVMPattern<triton::DotOp> {
+  using ConvertOpToLLVMPattern<triton::DotOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::DotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (!isa<BlockedEncodingAttr>(op.getD().getType().getEncoding()))
+      return op.emitError("dots are only supported with blocked layouts on "
+                          "CPUs");
+    return convertFMADot(op, adaptor, getTypeConverter(), rewriter);
+  }
+};
+} // namespace
+
+namespace mlir::triton::CPU {
+void populateDotOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                 RewritePatternSet &patterns,
+                                 PatternBenefit benefit) {
+  patterns.add<DotOpConversion>(typeConverter, benefit);
+}
+} // namespace mlir::triton::CPU
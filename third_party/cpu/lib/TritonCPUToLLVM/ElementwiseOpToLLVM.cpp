@@ -0,0 +1,67 @@
+#include "PatternTritonCPUOpToLLVM.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "triton/Conversion/TritonGPUToLLVM/ElementwiseOpToLLVMBase.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using mlir::triton::gpu::ElementwiseOpConversionBase;
+using mlir::triton::gpu::MultipleOperandsRange;
+
+namespace {
+// The floating point ops that the GPU backends lower to instructions of their
+// own map to the LLVM ops of the same name, which the host target lowers to
+// its instructions or to calls of the C math library.
+template <typename SourceOp, typename DestOp>
+struct ElementwiseOpConversion
+    : public ElementwiseOpConversionBase<
+          SourceOp, ElementwiseOpConversion<SourceOp, DestOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp,
+                                  ElementwiseOpConversion<SourceOp, DestOp>>;
+  using Base::Base;
+  using OpAdaptor = typename Base::OpAdaptor;
+
+  SmallVector<DestOp> createDestOps(SourceOp op, OpAdaptor adaptor,
+                                    ConversionPatternRewriter &rewriter,
+                                    Type elemTy, MultipleOperandsRange operands,
+                                    Location loc) const {
+    return {rewriter.create<DestOp>(loc, elemTy, operands[0])};
+  }
+};
+} // namespace
+
+namespace mlir::triton::CPU {
+void populateElementwiseOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAxisInfoAnalysis &axisInfoAnalysis, const TargetInfo &targetInfo,
+    PatternBenefit benefit) {
+#define POPULATE_OP(SRC_OP, DST_OP)                                            \
+  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(                       \
+      typeConverter, axisInfoAnalysis, benefit);
+
+  POPULATE_OP(arith::AddFOp, LLVM::FAddOp)
+  POPULATE_OP(arith::SubFOp, LLVM::FSubOp)
+  POPULATE_OP(arith::MulFOp, LLVM::FMulOp)
+  POPULATE_OP(arith::DivFOp, LLVM::FDivOp)
+  POPULATE_OP(arith::NegFOp, LLVM::FNegOp)
+  POPULATE_OP(arith::ExtFOp, LLVM::FPExtOp)
+  POPULATE_OP(arith::TruncFOp, LLVM::FPTruncOp)
+  POPULATE_OP(arith::FPToSIOp, LLVM::FPToSIOp)
+  POPULATE_OP(arith::SIToFPOp, LLVM::SIToFPOp)
+  POPULATE_OP(triton::PreciseDivFOp, LLVM::FDivOp)
+  POPULATE_OP(triton::PreciseSqrtOp, LLVM::SqrtOp)
+#undef POPULATE_OP
+
+  mlir::triton::populateElementwiseOpToLLVMPatterns(
+      typeConverter, patterns, axisInfoAnalysis, targetInfo, benefit);
+  mlir::triton::populateMinMaxFOpToLLVMPattern(
+      typeConverter, patterns, axisInfoAnalysis,
+      /*hwNanPropagationSupported=*/targetInfo.supportMaximumMinimum(),
+      benefit);
+  mlir::triton::populateClampFOpToLLVMPattern(
+      typeConverter, patterns, axisInfoAnalysis, targetInfo, benefit);
+}
+} // namespace mlir::triton::CPU
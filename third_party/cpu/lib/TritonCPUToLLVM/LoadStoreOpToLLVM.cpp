@@ -0,0 +1,146 @@
+#include "PatternTritonCPUOpToLLVM.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+namespace {
+
+unsigned getElemBytes(Type elemTy) {
+  if (isa<LLVM::LLVMPointerType>(elemTy))
+    return sizeof(void *);
+  return std::max<unsigned>(elemTy.getIntOrFloatBitWidth() / 8, 1);
+}
+
+Value packVector(ConversionPatternRewriter &rewriter, Location loc,
+                 Type vecTy, ArrayRef<Value> elems) {
+  Value vec = undef(vecTy);
+  for (auto [i, elem] : llvm::enumerate(elems))
+    vec = insert_element(vecTy, vec, elem, i32_val(i));
+  return vec;
+}
+
+// The elements of a tensor are all held by the single thread of the program,
+// so its loads and stores access vectors of the contiguous elements, with the
+// masked load and store intrinsics of LLVM when the elements are masked.
+struct LoadStoreConversionBase {
+  explicit LoadStoreConversionBase(ModuleAxisInfoAnalysis &axisAnalysisPass)
+      : axisAnalysisPass(axisAnalysisPass) {}
+
+  unsigned getVectorSize(Value ptr, unsigned numElems) const {
+    return std::min<unsigned>(axisAnalysisPass.getPtrContiguity(ptr),
+                              numElems);
+  }
+
+protected:
+  ModuleAxisInfoAnalysis &axisAnalysisPass;
+};
+
+struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
+                          public LoadStoreConversionBase {
+  LoadOpConversion(LLVMTypeConverter &converter,
+                   ModuleAxisInfoAnalysis &axisAnalysisPass,
+                   PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<triton::LoadOp>(converter, benefit),
+        LoadStoreConversionBase(axisAnalysisPass) {}
+
+  LogicalResult
+  matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    Type valueElemTy =
+        getTypeConverter()->convertType(getElementTypeOrSelf(op.getType()));
+    auto ptrElems = unpackLLElements(loc, adaptor.getPtr(), rewriter);
+    SmallVector<Value> maskElems, otherElems;
+    if (adaptor.getMask())
+      maskElems = unpackLLElements(loc, adaptor.getMask(), rewriter);
+    if (adaptor.getOther())
+      otherElems = unpackLLElements(loc, adaptor.getOther(), rewriter);
+
+    unsigned numElems = ptrElems.size();
+    unsigned vec = getVectorSize(op.getPtr(), numElems);
+    unsigned alignment = vec * getElemBytes(valueElemTy);
+    Type vecTy = LLVM::getFixedVectorType(valueElemTy, vec);
+
+    SmallVector<Value> loadedVals;
+    for (unsigned vecStart = 0; vecStart < numElems; vecStart += vec) {
+      Value ptr = ptrElems[vecStart];
+      Value loaded;
+      if (maskElems.empty()) {
+        loaded = load(vecTy, ptr, alignment);
+      } else {
+        Value mask = packVector(rewriter, loc, vec_ty(i1_ty, vec),
+                                ArrayRef(maskElems).slice(vecStart, vec));
+        Value passThru =
+            otherElems.empty()
+                ? Value(null(vecTy))
+                : packVector(rewriter, loc, vecTy,
+                             ArrayRef(otherElems).slice(vecStart, vec));
+        loaded = rewriter.create<LLVM::MaskedLoadOp>(
+            loc, vecTy, ptr, mask, ValueRange{passThru}, alignment);
+      }
+      for (unsigned i = 0; i < vec; ++i)
+        loadedVals.push_back(extract_element(valueElemTy, loaded, i32_val(i)));
+    }
+
+    Value result = packLLElements(loc, getTypeConverter(), loadedVals,
+                                  rewriter, op.getType());
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
+struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
+                           public LoadStoreConversionBase {
+  StoreOpConversion(LLVMTypeConverter &converter,
+                    ModuleAxisInfoAnalysis &axisAnalysisPass,
+                    PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<triton::StoreOp>(converter, benefit),
+        LoadStoreConversionBase(axisAnalysisPass) {}
+
+  LogicalResult
+  matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    Type valueElemTy = getTypeConverter()->convertType(
+        getElementTypeOrSelf(op.getValue().getType()));
+    auto ptrElems = unpackLLElements(loc, adaptor.getPtr(), rewriter);
+    auto valueElems = unpackLLElements(loc, adaptor.getValue(), rewriter);
+    SmallVector<Value> maskElems;
+    if (adaptor.getMask())
+      maskElems = unpackLLElements(loc, adaptor.getMask(), rewriter);
+
+    unsigned numElems = ptrElems.size();
+    unsigned vec = getVectorSize(op.getPtr(), numElems);
+    unsigned alignment = vec * getElemBytes(valueElemTy);
+    Type vecTy = LLVM::getFixedVectorType(valueElemTy, vec);
+
+    for (unsigned vecStart = 0; vecStart < numElems; vecStart += vec) {
+      Value ptr = ptrElems[vecStart];
+      Value value = packVector(rewriter, loc, vecTy,
+                               ArrayRef(valueElems).slice(vecStart, vec));
+      if (maskElems.empty()) {
+        store(value, ptr, alignment);
+        continue;
+      }
+      Value mask = packVector(rewriter, loc, vec_ty(i1_ty, vec),
+                              ArrayRef(maskElems).slice(vecStart, vec));
+      rewriter.create<LLVM::MaskedStoreOp>(loc, value, ptr, mask, alignment);
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+} // namespace
+
+namespace mlir::triton::CPU {
+void populateLoadStoreOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                       RewritePatternSet &patterns,
+                                       ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                       PatternBenefit benefit) {
+  patterns.add<LoadOpConversion, StoreOpConversion>(
+      typeConverter, axisInfoAnalysis, benefit);
+}
+} // namespace mlir::triton::CPU
@@ -0,0 +1,170 @@
+#include "TargetInfo.h"
+#include "TritonCPUToLLVM/Passes.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+
+using namespace mlir;
+
+namespace {
+LLVM::LLVMFuncOp getOrInsertFuncDeclaration(RewriterBase &rewriter,
+                                            StringRef funcName,
+                                            LLVM::LLVMFunctionType funcType) {
+  auto moduleOp = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+  if (Operation *funcOp = moduleOp.lookupSymbol(funcName))
+    return cast<LLVM::LLVMFuncOp>(*funcOp);
+  RewriterBase::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(moduleOp.getBody());
+  return rewriter.create<LLVM::LLVMFuncOp>(
+      UnknownLoc::get(rewriter.getContext()), funcName, funcType);
+}
+
+// extend integer to int32, extend float to float64, as the C default argument
+// promotions of the variadic arguments of printf do.
+Value printfPromoteValue(RewriterBase &rewriter, Value value) {
+  auto loc = UnknownLoc::get(rewriter.getContext());
+  auto type = value.getType();
+  if (type.isIntOrIndex() && type.getIntOrFloatBitWidth() < 32)
+    return type.isUnsignedInteger() ? Value(zext(i32_ty, value))
+                                    : Value(sext(i32_ty, value));
+  if (type.isBF16() || type.isF16() || type.isF32())
+    return fpext(f64_ty, value);
+  return value;
+}
+} // namespace
+
+namespace mlir::triton::CPU {
+
+Value getLaunchArg(RewriterBase &rewriter, int index) {
+  auto funcOp = rewriter.getInsertionBlock()
+                    ->getParent()
+                    ->getParentOfType<LLVM::LLVMFuncOp>();
+  assert(funcOp && LLVM::isKernel(funcOp) &&
+         "the launch arguments are only passed to the kernels");
+  return funcOp.getArgument(funcOp.getNumArguments() - kNumLaunchArgs + index);
+}
+
+bool TargetInfo::supportMaximumMinimum() const { return true; }
+
+Value TargetInfo::getClusterCTAId(RewriterBase &rewriter, Location loc) const {
+  return i32_val(0);
+}
+
+Value TargetInfo::ballot(RewriterBase &rewriter, Location loc, Type type,
+                         Value cmp) const {
+  return zext(type, cmp);
+}
+
+void TargetInfo::clusterBarrier(RewriterBase &rewriter, Location loc) const {}
+
+void TargetInfo::storeDShared(RewriterBase &rewriter, Location loc, Value ptr,
+                              std::optional<Value> ctaId, Value val,
+                              Value pred) const {
+  if (ctaId.has_value())
+    llvm::report_fatal_error(
+        "CPUs do not support cross-CTA shared memory transfers");
+  // The shared memory of a program is only accessed by its own thread, so the
+  // store of the predicated-off elements may write back the value they had.
+  Value old = load(val.getType(), ptr);
+  store(select(pred, val, old), ptr);
+}
+
+Value TargetInfo::loadDShared(RewriterBase &rewriter, Location loc, Value ptr,
+                              std::optional<Value> ctaId, Type elemTy,
+                              Value pred) const {
+  if (ctaId.has_value())
+    llvm::report_fatal_error(
+        "CPUs do not support cross-CTA shared memory transfers");
+  // The addresses are in the shared memory buffer even when pred is false.
+  Value zero = rewriter.create<LLVM::ZeroOp>(loc, elemTy);
+  return select(pred, load(elemTy, ptr), zero);
+}
+
+Value TargetInfo::shuffleXor(RewriterBase &rewriter, Location loc, Value val,
+                             int i) const {
+  return val;
+}
+
+Value TargetInfo::shuffleUp(RewriterBase &rewriter, Location loc, Value val,
+                            int i) const {
+  return val;
+}
+
+Value TargetInfo::shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
+                             int i) const {
+  return val;
+}
+
+Value TargetInfo::shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
+                             Value i) const {
+  return val;
+}
+
+Value TargetInfo::programId(RewriterBase &rewriter, Location loc,
+                            ModuleOp moduleOp, int axis) const {
+  return getLaunchArg(rewriter, axis);
+}
+
+bool TargetInfo::warpReduce(RewriterBase &rewriter, Location loc,
+                            SmallVector<Value> &acc, triton::ReduceOp op,
+                            unsigned numLaneToReduce,
+                            unsigned interleave) const {
+  return false;
+}
+
+bool TargetInfo::processReplicaUsingStMatrix(
+    RewriterBase &rewriter, Location loc, Value smemBase,
+    SmallVector<Value> &vals, RankedTensorType srcTy, Type elemTy,
+    ArrayRef<unsigned> paddedRepShape, ArrayRef<unsigned> origRepShape,
+    ArrayRef<unsigned> outOrd, unsigned accumNumReplicates,
+    int swizzleByteWidth) const {
+  return false;
+}
+
+std::string TargetInfo::getMulhiFuncName(Type resultElementTy) const {
+  llvm_unreachable("tt.mulhiui is expanded by "
+                   "decompose-unsupported-cpu-conversions");
+}
+
+void TargetInfo::printf(RewriterBase &rewriter, Value formatStrStart,
+                        int /*formatStrByteCount*/, ValueRange args) const {
+  auto *ctx = rewriter.getContext();
+  auto loc = UnknownLoc::get(ctx);
+  // int printf(const char *format, ...);
+  auto funcType = LLVM::LLVMFunctionType::get(i32_ty, {ptr_ty(ctx)},
+                                              /*isVarArg=*/true);
+  auto funcOp = getOrInsertFuncDeclaration(rewriter, "printf", funcType);
+  SmallVector<Value> operands{formatStrStart};
+  for (auto arg : args)
+    operands.push_back(printfPromoteValue(rewriter, arg));
+  call(funcOp, operands);
+}
+
+void TargetInfo::assertFail(RewriterBase &rewriter, Location loc,
+                            StringRef message, StringRef file, StringRef func,
+                            int line) const {
+  auto *ctx = rewriter.getContext();
+  // void __assert_fail(const char *assertion, const char *file,
+  //                    unsigned int line, const char *function);
+  auto funcType = LLVM::LLVMFunctionType::get(
+      void_ty(ctx), {ptr_ty(ctx), ptr_ty(ctx), i32_ty, ptr_ty(ctx)});
+  auto funcOp = getOrInsertFuncDeclaration(rewriter, "__assert_fail", funcType);
+  funcOp.setPassthroughAttr(
+      ArrayAttr::get(ctx, {StringAttr::get(ctx, "noreturn"),
+                           StringAttr::get(ctx, "cold")}));
+  llvm::SmallString<64> messageString(message), fileString(file),
+      funcString(func);
+  messageString.push_back('\0');
+  fileString.push_back('\0');
+  funcString.push_back('\0');
+  Value messageStringVal =
+      LLVM::addStringToModule(loc, rewriter, "assertMessage_", messageString);
+  Value fileStringVal =
+      LLVM::addStringToModule(loc, rewriter, "assertFile_", fileString);
+  Value funcStringVal =
+      LLVM::addStringToModule(loc, rewriter, "assertFunc_", funcString);
+  SmallVector<Value> operands = {messageStringVal, fileStringVal,
+                                 i32_val(line), funcStringVal};
+  call(funcOp, operands);
+}
+
+} // namespace mlir::triton::CPU
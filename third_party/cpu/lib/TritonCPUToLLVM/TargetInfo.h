@@ -0,0 +1,67 @@
+#ifndef TRITON_CONVERSION_TRITONGPU_TO_LLVM_TARGETINFOCPU_H
+#define TRITON_CONVERSION_TRITONGPU_TO_LLVM_TARGETINFOCPU_H
+
+#include "triton/Conversion/TritonGPUToLLVM/TargetInfoBase.h"
+#include <string>
+
+namespace mlir::triton::CPU {
+// A program runs as a single thread, whose warp has a single lane, so the
+// shuffles and the reductions across lanes are the identity and the barriers
+// are no-ops.
+class TargetInfo : public mlir::triton::TargetInfoBase {
+public:
+  bool supportMaximumMinimum() const override;
+
+  Value getClusterCTAId(RewriterBase &rewriter, Location loc) const override;
+
+  Value ballot(RewriterBase &rewriter, Location loc, Type type,
+               Value cmp) const override;
+
+  void clusterBarrier(RewriterBase &rewriter, Location loc) const override;
+
+  void storeDShared(RewriterBase &rewriter, Location loc, Value ptr,
+                    std::optional<Value> ctaId, Value val,
+                    Value pred) const override;
+  Value loadDShared(RewriterBase &rewriter, Location loc, Value ptr,
+                    std::optional<Value> ctaId, Type elemTy,
+                    Value pred) const override;
+
+  Value shuffleXor(RewriterBase &rewriter, Location loc, Value val,
+                   int i) const override;
+  Value shuffleUp(RewriterBase &rewriter, Location loc, Value val,
+                  int i) const override;
+  Value shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
+                   int i) const override;
+  Value shuffleIdx(RewriterBase &rewriter, Location loc, Value val,
+                   Value i) const override;
+
+  Value programId(RewriterBase &rewriter, Location loc, ModuleOp moduleOp,
+                  int axis) const override;
+
+  bool warpReduce(RewriterBase &rewriter, Location loc, SmallVector<Value> &acc,
+                  triton::ReduceOp op, unsigned numLaneToReduce,
+                  unsigned interleave) const override;
+
+  bool processReplicaUsingStMatrix(RewriterBase &rewriter, Location loc,
+                                   Value smemBase, SmallVector<Value> &vals,
+                                   RankedTensorType srcTy, Type elemTy,
+                                   ArrayRef<unsigned> paddedRepShape,
+                                   ArrayRef<unsigned> origRepShape,
+                                   ArrayRef<unsigned> outOrd,
+                                   unsigned accumNumReplicates,
+                                   int swizzleByteWidth) const override;
+
+  std::string getMulhiFuncName(Type resultElementTy) const override;
+
+  void printf(RewriterBase &rewriter, Value formatStrStart,
+              int formatStrByteCount, ValueRange args) const override;
+  void assertFail(RewriterBase &rewriter, Location loc, StringRef message,
+                  StringRef file, StringRef func, int line) const override;
+};
+
+// Returns the `index`-th of the launch arguments of the kernel that is being
+// lowered, see kNumLaunchArgs.
+Value getLaunchArg(RewriterBase &rewriter, int index);
+} // namespace mlir::triton::CPU
+
+#endif // TRITON_CONVERSION_TRITONGPU_TO_LLVM_TARGETINFOCPU_H
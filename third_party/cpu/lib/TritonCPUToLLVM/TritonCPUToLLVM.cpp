@@ -0,0 +1,232 @@
+#include "TritonCPUToLLVM/Passes.h"
+
+#include "PatternTritonCPUOpToLLVM.h"
+#include "TargetInfo.h"
+#include "mlir/Conversion/ArithToLLVM/ArithToLLVM.h"
+#include "mlir/Conversion/ControlFlowToLLVM/ControlFlowToLLVM.h"
+#include "mlir/Conversion/MathToLLVM/MathToLLVM.h"
+#include "mlir/Dialect/Index/IR/IndexDialect.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/AttrTypeSubElements.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Conversion/TritonGPUToLLVM/PatternTritonGPUOpToLLVM.h"
+#include "triton/Conversion/TritonGPUToLLVM/TypeConverter.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
+
+namespace mlir {
+namespace triton {
+#define GEN_PASS_DEF_CONVERTTRITONCPUTOLLVM
+#include "TritonCPUToLLVM/Passes.h.inc"
+} // namespace triton
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+class TritonLLVMFunctionConversionTarget : public ConversionTarget {
+public:
+  explicit TritonLLVMFunctionConversionTarget(MLIRContext &ctx)
+      : ConversionTarget(ctx) {
+    addLegalDialect<index::IndexDialect>();
+    addLegalDialect<LLVM::LLVMDialect>();
+    addLegalDialect<mlir::scf::SCFDialect>();
+    addLegalOp<mlir::UnrealizedConversionCastOp>();
+  }
+};
+
+class TritonLLVMConversionTarget : public ConversionTarget {
+public:
+  explicit TritonLLVMConversionTarget(MLIRContext &ctx)
+      : ConversionTarget(ctx) {
+    addLegalDialect<LLVM::LLVMDialect>();
+    addLegalDialect<mlir::scf::SCFDialect>();
+    addIllegalDialect<triton::TritonDialect>();
+    addIllegalDialect<triton::gpu::TritonGPUDialect>();
+    addIllegalDialect<triton::nvidia_gpu::TritonNvidiaGPUDialect>();
+    addIllegalDialect<mlir::gpu::GPUDialect>();
+    addLegalOp<mlir::UnrealizedConversionCastOp>();
+  }
+};
+
+struct ConvertTritonCPUToLLVM
+    : public triton::impl::ConvertTritonCPUToLLVMBase<ConvertTritonCPUToLLVM> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<LLVM::LLVMDialect>();
+  }
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    ModuleOp mod = getOperation();
+
+    if (triton::gpu::TritonGPUDialect::getNumWarps(mod) != 1 ||
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod) != 1 ||
+        triton::gpu::TritonGPUDialect::getNumCTAs(mod) != 1) {
+      mod.emitError("CPU kernels must have a single warp of a single thread");
+      return signalPassFailure();
+    }
+    if (failed(addLaunchArgs()))
+      return signalPassFailure();
+
+    triton::CPU::TargetInfo targetInfo;
+    mlir::LowerToLLVMOptions option(context);
+    option.overrideIndexBitwidth(32);
+    TritonGPUToLLVMTypeConverter typeConverter(context, option);
+    TritonLLVMConversionTarget convTarget(*context);
+
+    // Lower functions
+    {
+      mlir::LowerToLLVMOptions option(context);
+      TritonGPUToLLVMTypeConverter typeConverter(context, option);
+      TritonLLVMFunctionConversionTarget funcTarget(*context);
+      RewritePatternSet funcPatterns(context);
+      mlir::triton::populateFuncOpConversionPattern(
+          typeConverter, funcPatterns, /*numWarps=*/1, patternBenefitDefault);
+      mlir::cf::populateControlFlowToLLVMConversionPatterns(typeConverter,
+                                                            funcPatterns);
+      if (failed(
+              applyPartialConversion(mod, funcTarget, std::move(funcPatterns))))
+        return signalPassFailure();
+    }
+
+    // initSharedMemory is run before the conversion of call and ret ops,
+    // because the call op has to know the shared memory base address of each
+    // function
+    initSharedMemory(typeConverter);
+
+    ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+
+    RewritePatternSet patterns(context);
+    int commonBenefit = patternBenefitPrioritizeOverLLVMConversions;
+    // Make benefit for CPU specific patterns higher so they apply before common
+    // patterns
+    int CPUBenefit = commonBenefit + 1;
+
+    triton::CPU::populateDotOpToLLVMPatterns(typeConverter, patterns,
+                                             CPUBenefit);
+    triton::CPU::populateElementwiseOpToLLVMPatterns(
+        typeConverter, patterns, axisInfoAnalysis, targetInfo, CPUBenefit);
+    triton::CPU::populateLoadStoreOpToLLVMPatterns(typeConverter, patterns,
+                                                   axisInfoAnalysis, CPUBenefit);
+    triton::CPU::populateSPMDOpToLLVMPattern(typeConverter, patterns,
+                                             CPUBenefit);
+    mlir::triton::populateConvertLayoutOpToLLVMPatterns(
+        typeConverter, targetInfo, patterns, commonBenefit);
+    mlir::triton::populateReduceOpToLLVMPatterns(typeConverter, patterns,
+                                                 targetInfo, commonBenefit);
+    mlir::triton::populateScanOpToLLVMPatterns(typeConverter, patterns,
+                                               targetInfo, commonBenefit);
+    mlir::triton::populateViewOpToLLVMPatterns(typeConverter, patterns,
+                                               commonBenefit);
+    mlir::triton::populateHistogramOpToLLVMPatterns(typeConverter, patterns,
+                                                    targetInfo, commonBenefit);
+    mlir::triton::populateSortOpToLLVMPatterns(typeConverter, patterns,
+                                               targetInfo, commonBenefit);
+    mlir::triton::populateGatherOpToLLVMPatterns(typeConverter, patterns,
+                                                 targetInfo, commonBenefit);
+    mlir::triton::populateMemoryOpToLLVMPattern(typeConverter, targetInfo,
+                                                patterns, commonBenefit);
+    mlir::triton::populateMakeRangeOpToLLVMPattern(typeConverter, targetInfo,
+                                                   patterns, commonBenefit);
+    mlir::triton::populateAssertOpToLLVMPattern(typeConverter, patterns,
+                                                targetInfo, commonBenefit);
+    mlir::triton::populateControlFlowOpToLLVMPattern(typeConverter, patterns,
+                                                     commonBenefit);
+    mlir::triton::populateSPMDOpToLLVMPattern(typeConverter, patterns,
+                                              targetInfo, commonBenefit);
+    mlir::arith::populateArithToLLVMConversionPatterns(typeConverter, patterns);
+    mlir::populateMathToLLVMConversionPatterns(typeConverter, patterns);
+    mlir::cf::populateControlFlowToLLVMConversionPatterns(typeConverter,
+                                                          patterns);
+    mlir::triton::populatePrintOpToLLVMPattern(typeConverter, patterns,
+                                               targetInfo, commonBenefit);
+    if (failed(applyPartialConversion(mod, convTarget, std::move(patterns))))
+      return signalPassFailure();
+
+    lowerToHostAddressSpace();
+  }
+
+private:
+  // Appends the launch arguments to the kernels. The other functions are
+  // inlined into them unless they are noinline, which the launch arguments
+  // are not passed to.
+  LogicalResult addLaunchArgs() {
+    ModuleOp mod = getOperation();
+    auto i32Ty = IntegerType::get(mod.getContext(), 32);
+    auto emptyAttrs = DictionaryAttr::get(mod.getContext());
+    bool hasUnsupportedFunc = false;
+    mod.walk([&](triton::FuncOp funcOp) {
+      if (!LLVM::isKernel(funcOp)) {
+        funcOp.walk([&](Operation *op) {
+          if (isa<triton::GetProgramIdOp, triton::GetNumProgramsOp>(op)) {
+            op->emitError("program ids are only supported in the kernels "
+                          "and the functions inlined into them on CPUs");
+            hasUnsupportedFunc = true;
+          }
+        });
+        return;
+      }
+      for (int i = 0; i < triton::CPU::kNumLaunchArgs; ++i)
+        funcOp.insertArgument(funcOp.getNumArguments(), i32Ty, emptyAttrs,
+                              funcOp.getLoc());
+    });
+    return failure(hasUnsupportedFunc);
+  }
+
+  void initSharedMemory(LLVMTypeConverter &typeConverter) {
+    ModuleOp mod = getOperation();
+    OpBuilder b(mod.getBodyRegion());
+    auto loc = mod.getLoc();
+    auto elemTy = typeConverter.convertType(b.getIntegerType(8));
+    // The shared memory of a program is a buffer of the thread that runs it,
+    // sized by the allocation of the module, so that the programs may run on
+    // several threads at once.
+    auto sharedAttr = mod->getAttrOfType<IntegerAttr>("triton_gpu.shared");
+    int64_t size = sharedAttr ? sharedAttr.getInt() : 0;
+    auto arrayTy = LLVM::LLVMArrayType::get(elemTy, size);
+    auto global = b.create<LLVM::GlobalOp>(
+        loc, arrayTy, /*isConstant=*/false, LLVM::Linkage::Internal,
+        "global_smem", /*value=*/Attribute(), /*alignment=*/16,
+        // The generic patterns access it in the shared address space, see
+        // lowerToHostAddressSpace.
+        /*addrSpace=*/3, /*dsoLocal=*/true, /*thread_local_=*/true);
+    b.createBlock(&global.getInitializerRegion());
+    b.create<LLVM::ReturnOp>(loc, b.create<LLVM::ZeroOp>(loc, arrayTy));
+  }
+
+  // The generic patterns and the type converter put shared memory and global
+  // memory in the address spaces of the GPUs, which are all the single address
+  // space of the host.
+  void lowerToHostAddressSpace() {
+    ModuleOp mod = getOperation();
+    mod.walk([](LLVM::GlobalOp global) { global.setAddrSpace(0); });
+    mod.walk([](LLVM::LLVMFuncOp funcOp) {
+      funcOp->removeAttr("nvvm.kernel");
+      funcOp->removeAttr("nvvm.maxntid");
+    });
+    AttrTypeReplacer replacer;
+    replacer.addReplacement(
+        [](LLVM::LLVMPointerType type) -> std::optional<Type> {
+          return LLVM::LLVMPointerType::get(type.getContext());
+        });
+    replacer.recursivelyReplaceElementsIn(mod, /*replaceAttrs=*/true,
+                                          /*replaceLocs=*/false,
+                                          /*replaceTypes=*/true);
+  }
+};
+
+} // anonymous namespace
+
+namespace mlir {
+namespace triton {
+
+std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonCPUToLLVMPass() {
+  return std::make_unique<ConvertTritonCPUToLLVM>();
+}
+
+} // namespace triton
+} // namespace mlir
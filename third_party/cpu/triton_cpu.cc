@@ -0,0 +1,34 @@
+#include "TritonCPUToLLVM/Passes.h"
+#include "mlir/Pass/PassManager.h"
+#include "llvm/TargetParser/Host.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+void init_triton_cpu_passes_ttgpuir(py::module &&m) {
+  using namespace mlir::triton;
+  m.def("add_decompose_unsupported_conversions", [](mlir::PassManager &pm) {
+    pm.addPass(CPU::createDecomposeUnsupportedConversionsPass());
+  });
+  m.def("add_to_llvmir", [](mlir::PassManager &pm) {
+    pm.addPass(createConvertTritonCPUToLLVMPass());
+  });
+}
+
+void init_triton_cpu(py::module &&m) {
+  auto passes = m.def_submodule("passes");
+  init_triton_cpu_passes_ttgpuir(passes.def_submodule("ttgpuir"));
+
+  m.attr("NUM_LAUNCH_ARGS") = mlir::triton::CPU::kNumLaunchArgs;
+
+  m.def("get_default_target_triple",
+        []() { return llvm::sys::getDefaultTargetTriple(); });
+  m.def("get_host_cpu_name",
+        []() { return llvm::sys::getHostCPUName().str(); });
+
+  m.def("load_dialects", [](mlir::MLIRContext &context) {
+    // The kernels only use the dialects of the common passes
+    context.loadAllAvailableDialects();
+  });
+}
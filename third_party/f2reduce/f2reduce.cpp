@@ -416,6 +416,36 @@ void inplace_rref_strided_heap(uint64_t *matrix, uint64_t rows, uint64_t cols, u
     free(cache_raw);
 }
 
+// Triton change: the pivot row is removed from the other rows without
+// branches, so that the loop vectorises across rows. Triton is not built with
+// -march=native, so on x86-64 the loop is also compiled for AVX2 and AVX-512
+// and the best version is selected when the library is loaded. NEON is part
+// of the aarch64 baseline and needs no dispatch.
+#if defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define F2REDUCE_TARGET_CLONES \
+    __attribute__ ((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef F2REDUCE_TARGET_CLONES
+#define F2REDUCE_TARGET_CLONES
+#endif
+
+F2REDUCE_TARGET_CLONES
+void eliminate_pivot(uint64_t* __restrict__ matrix, uint64_t rows, uint64_t r) {
+    uint64_t m = matrix[r];
+    uint64_t ml = m & (-m);
+
+    for (uint64_t s = 0; s < rows; s++) {
+        matrix[s] ^= m & (0 - (uint64_t) ((matrix[s] & ml) != 0));
+    }
+
+    // the pivot row has been cleared along with the others:
+    matrix[r] = m;
+}
+
+#undef F2REDUCE_TARGET_CLONES
+
 void inplace_rref_small(uint64_t *matrix, uint64_t rows, uint64_t cols) {
 
     uint64_t final_b = (1ull << (cols - 1)) - 1;
@@ -440,13 +470,7 @@ void inplace_rref_small(uint64_t *matrix, uint64_t rows, uint64_t cols) {
 
         if (b == ((uint64_t) -1)) { break; }
 
-        uint64_t m = matrix[r];
-        uint64_t ml = m & (-m);
-
-        for (uint64_t s = 0; s < rows; s++) {
-            if (s == r) { continue; }
-            if (matrix[s] & ml) { matrix[s] ^= m; }
-        }
+        eliminate_pivot(matrix, rows, r);
 
         next_b = (b << 1) + 1;
         if (b == final_b) { break; }
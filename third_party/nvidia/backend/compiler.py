@@ -1,18 +1,28 @@
-from triton.backends.compiler import BaseBackend, GPUTarget
+from triton.backends.compiler import BaseBackend, BudgetedPassManager, GPUTarget
 from triton._C.libtriton import ir, passes, llvm, nvidia
 
 from dataclasses import dataclass
 import functools
-from typing import Any, Tuple, Optional
+from typing import Any, Tuple, Optional, Union
 import hashlib
+import json
 import re
 import tempfile
+import shlex
 import signal
 import os
 import subprocess
 from pathlib import Path
 
 
+def parse_ptxas_resource_usage(log: str):
+    # the registers and spills `ptxas -v` reports for the kernel; spills are
+    # counted in 32-bit registers like `n_spills` of the loaded kernels
+    regs = [int(n) for n in re.findall(r"Used (\d+) registers", log)]
+    spill_stores = [int(n) for n in re.findall(r"(\d+) bytes spill stores", log)]
+    return {"n_regs": max(regs, default=0), "n_spills": sum(spill_stores) // 4}
+
+
 @functools.lru_cache()
 def _path_to_binary(binary: str):
     paths = [
@@ -36,6 +46,35 @@ def get_ptxas_version():
     return version
 
 
+@functools.lru_cache()
+def get_ptx_compiler():
+    '''
+    Get the module that compiles PTX in process with the static ptxas library of the backend, or None if it is not
+    available or doesn't match the version of ptxas.
+    '''
+    if os.environ.get("TRITON_PTXAS_IN_PROCESS", "1") != "1":
+        return None
+    lib_dir = os.path.join(os.path.dirname(__file__), "lib")
+    lib = os.path.join(lib_dir, "libnvptxcompiler_static.a")
+    if not os.path.exists(lib):
+        return None
+    from triton.backends.nvidia.driver import compile_module_from_src
+    # Rebuild the module when the library is updated
+    lib_stat = os.stat(lib)
+    src = Path(os.path.join(os.path.dirname(__file__), "ptx_compiler.c")).read_text()
+    src += f"// {lib_stat.st_size}-{lib_stat.st_mtime_ns}\n"
+    try:
+        mod = compile_module_from_src(src, "ptx_compiler", libs=["nvptxcompiler_static", "pthread", "m"],
+                                      lib_dirs=[lib_dir])
+        version = "%d.%d" % mod.get_version()
+    except Exception:
+        return None
+    # The PTX version follows the version of ptxas
+    if version != _path_to_binary("ptxas")[1]:
+        return None
+    return mod
+
+
 @functools.lru_cache()
 def ptx_get_version(cuda_version) -> int:
     '''
@@ -63,6 +102,10 @@ class CUDAOptions:
     num_warps: int = 4
     num_ctas: int = 1
     num_stages: int = 3
+    # prefetch_depth is the number of K slices of the mma operands of the next
+    # loop iteration that are loaded from shared memory into registers during
+    # the current one.
+    prefetch_depth: int = 1
     # maxnreg corresponds to the ptx parameter .maxnreg, which controls the
     # maximum number of 32-bit registers used by one thread.
     maxnreg: Optional[int] = None
@@ -71,11 +114,105 @@ class CUDAOptions:
     enable_fp_fusion: bool = True
     allow_fp8e4nv: bool = False
     allow_fp8e4b15: bool = False
+    allow_mixed_fp8_dot: bool = False
     default_dot_input_precision: str = "tf32"
-    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "ieee")
+    allowed_dot_input_precisions: Tuple[str] = ("tf32", "tf32x3", "bf16x3", "bf16x6", "bf16x9", "ieee")
     max_num_imprecise_acc_default: bool = None
     extern_libs: dict = None
     debug: bool = False
+    # persistent launches at most one wave of CTAs, each of which loops over
+    # the tiles of the requested grid in the order given by tile_scheduler.
+    persistent: bool = False
+    tile_scheduler: str = "data-parallel"
+    # tile_swizzle remaps the program ids of matmul kernels that don't group
+    # their tiles themselves, so that consecutive programs visit group_size
+    # rows of output tiles column by column and share operands in L2.
+    tile_swizzle: bool = True
+    group_size: int = 8
+    # compile_time_budget is the number of seconds the TTGIR optimizations may
+    # take before the optional ones are skipped, defaults to no budget.
+    compile_time_budget: Optional[float] = None
+    # disabled_passes names the TTGIR passes that are not run, as the name of
+    # their `add_` function, e.g. `add_prefetch`, optionally followed by
+    # `@<n>` to only disable its n-th instance. See triton.tools.bisect_passes.
+    disabled_passes: tuple = ()
+    # tile_versioning runs the loads and stores of the tiles that are known to
+    # be in bounds at runtime without their masks, at the cost of code size.
+    # The masked copy for the boundary tiles is outlined when it's large.
+    tile_versioning: bool = False
+    # report_shared_memory models the shared memory accesses of the kernel and
+    # records their vector width and bank conflicts in the shared_memory_report
+    # metadata, as well as in remarks.
+    report_shared_memory: bool = False
+    # auto_unroll unrolls by two the small loops that only load small tiles
+    # and have no loop_unroll_factor, interleaving the loads of the copies.
+    auto_unroll: bool = False
+    # tma_block_pointers loads and stores the block pointers built from kernel
+    # arguments with TMA copies on Hopper, using descriptors made at launch.
+    tma_block_pointers: bool = False
+    # eviction_hints evicts the loads that a single program reads first and
+    # keeps the ones that every program reads, unless they have a policy.
+    # From sm_80, the eviction policies of loads apply to L2 too.
+    eviction_hints: bool = False
+    # forward_store_to_load replaces loads of tensors stored earlier in the
+    # same block through provably distinct pointers with the stored values.
+    forward_store_to_load: bool = False
+    # fast_math lowers exp, log, sqrt, rsqrt and division to the approximate
+    # PTX instructions, flushing subnormals to zero. They are within a few ulp,
+    # see the NVIDIA ElementwiseOpToLLVM.cpp for the bound of each op.
+    fast_math: bool = False
+    # cooperative kernels are launched with the cooperative attribute, which
+    # guarantees that all their CTAs are resident at once so that they may
+    # synchronize across the grid. Kernels that call grid_sync always are.
+    cooperative: bool = False
+    # launch_pdl launches the kernel as a programmatic dependent launch on sm_90
+    # and later, so that it may start before the previous kernel of the stream
+    # completes. It must call griddep_wait before it accesses what the previous
+    # kernel writes, which the previous kernel can bring forward by calling
+    # griddep_launch_dependents.
+    launch_pdl: bool = False
+    # l2_persist names a pointer argument, by name or position, whose tensor
+    # the launch keeps in the persisting L2 carve-out set aside with
+    # CudaUtils.reserve_persisting_l2, through an access-policy window over
+    # its nbytes. The other accesses of the kernel stream through L2 without
+    # evicting it, e.g. the activations of a decode step that rereads weights.
+    l2_persist: Optional[Union[str, int]] = None
+    # pack_kernel_args passes the arguments in a single __grid_constant__
+    # struct that the launcher builds, holding the TMA descriptors of
+    # tma_block_pointers in place instead of in global memory.
+    pack_kernel_args: bool = False
+    # record_asserts compiles the device asserts even without debug, and
+    # records their first failures in a device buffer that the launcher reports
+    # on stderr once the stream reaches them, instead of trapping.
+    record_asserts: bool = False
+    # binary_prints appends the values of device_print to a ring of binary
+    # records in device memory instead of formatting them with printf, which
+    # serializes on its fifo. CudaUtils.read_device_prints formats them later.
+    # The ring keeps the last binary_print_records records, a power of two.
+    binary_prints: bool = False
+    binary_print_records: int = 1 << 16
+    # dynamic_program_ids hands out the program ids from a counter in the order
+    # the CTAs start rather than by their position in the grid, so that the
+    # lowest ids, e.g. the heaviest tiles of a sorted schedule, run first.
+    dynamic_program_ids: bool = False
+    # llvm_opt_level is the level, from 0 to 3, of the LLVM optimizations of
+    # make_llir, and ptxas_options are extra options of ptxas, e.g. `-O2` or
+    # `--allow-expensive-optimizations=true`. Both may be tuned per Config.
+    llvm_opt_level: int = 3
+    ptxas_options: tuple = ()
+    # tensor_core_reduce_threshold takes the fp16 and bf16 sums over at least
+    # this many elements, e.g. the row sums of wide tiles, on tensor cores as
+    # dots with ones accumulating in fp32, instead of shuffling partial sums
+    # between threads. 0 never does.
+    tensor_core_reduce_threshold: int = 0
+    # num_consumer_groups > 0 warp-specializes the TMA loads of the top-level
+    # loop on sm_90: a producer warp group issues them into num_stages buffers
+    # while the num_warps warps, num_consumer_groups groups of 4, compute. The
+    # producer gives up registers down to reg_dec_producer per thread and the
+    # consumers take them up to reg_inc_consumer.
+    num_consumer_groups: int = 0
+    reg_dec_producer: int = 40
+    reg_inc_consumer: int = 232
     backend_name: str = 'cuda'
 
     def __post_init__(self):
@@ -86,6 +223,13 @@ class CUDAOptions:
         object.__setattr__(self, 'extern_libs', tuple(extern_libs.items()))
         assert self.num_warps > 0 and (self.num_warps & (self.num_warps - 1)) == 0, \
                "num_warps must be a power of 2"
+        assert not self.persistent or self.num_ctas == 1, \
+               "persistent kernels do not support num_ctas > 1"
+        assert self.llvm_opt_level in (0, 1, 2, 3), "llvm_opt_level must be between 0 and 3"
+        assert self.binary_print_records > 0 and (self.binary_print_records & (self.binary_print_records - 1)) == 0, \
+               "binary_print_records must be a power of 2"
+        assert self.num_consumer_groups == 0 or self.num_warps == 4 * self.num_consumer_groups, \
+               "num_warps must be 4 warps per consumer group"
 
     def hash(self):
         hash_dict = dict(self.__dict__)
@@ -113,6 +257,16 @@ class CUDABackend(BaseBackend):
         if not "enable_fp_fusion" in args:
             args["enable_fp_fusion"] = os.getenv("TRITON_DEFAULT_FP_FUSION", "1") == "1"
         args["max_num_imprecise_acc_default"] = 2**30 if self.capability == 90 else 0
+        if self.capability < 90:
+            args["tma_block_pointers"] = False
+        if "compile_time_budget" not in args and os.getenv("TRITON_COMPILE_TIME_BUDGET"):
+            args["compile_time_budget"] = float(os.getenv("TRITON_COMPILE_TIME_BUDGET"))
+        if "disabled_passes" not in args and os.getenv("TRITON_DISABLE_PASSES"):
+            args["disabled_passes"] = os.getenv("TRITON_DISABLE_PASSES").split(",")
+        args["disabled_passes"] = tuple(args.get("disabled_passes", ()))
+        if isinstance(args.get("ptxas_options", ()), str):
+            args["ptxas_options"] = args["ptxas_options"].split()
+        args["ptxas_options"] = tuple(args.get("ptxas_options", ()))
         return CUDAOptions(**args)
 
     def pack_metadata(self, metadata):
@@ -123,6 +277,9 @@ class CUDABackend(BaseBackend):
             metadata.cluster_dims[0],
             metadata.cluster_dims[1],
             metadata.cluster_dims[2],
+            int(metadata.persistent),
+            int(metadata.cooperative),
+            int(metadata.launch_pdl),
         )
 
     def get_codegen_implementation(self):
@@ -141,14 +298,39 @@ class CUDABackend(BaseBackend):
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
         passes.common.add_inliner(pm)
-        passes.ttir.add_rewrite_tensor_pointer(pm)
+        # the descriptor and workspace arguments come before the grid arguments of persistent kernels
+        passes.ttir.add_rewrite_tensor_pointer(pm, opt.tma_block_pointers)
+        # the CTAs of a cluster would have to agree on their ids, persistent kernels loop over theirs
+        if opt.dynamic_program_ids and opt.num_ctas == 1 and not opt.persistent:
+            passes.ttir.add_dynamic_program_ids(pm)
+        passes.ttir.add_allocate_workspace(pm)
+        if opt.tile_swizzle:
+            passes.ttir.add_tile_swizzle(pm, opt.group_size)
+        # after the tile swizzle, which matches the divisions of the program ids
+        passes.ttir.add_magic_divisors(pm)
+        if opt.persistent:
+            passes.ttir.add_persistent_kernel(pm, opt.tile_scheduler, opt.group_size)
         passes.ttir.add_combine(pm)
-        passes.common.add_canonicalizer(pm)
+        # canonicalization, CSE and LICM run on the functions of the module in parallel
+        passes.common.add_func_canonicalizer(pm)
         passes.ttir.add_reorder_broadcast(pm)
-        passes.common.add_cse(pm)
-        passes.common.add_licm(pm)
+        passes.common.add_func_cse(pm)
+        if opt.forward_store_to_load:
+            passes.ttir.add_forward_store_to_load(pm)
+        passes.ttir.add_narrow_offsets(pm)
+        if opt.eviction_hints:
+            passes.ttir.add_eviction_hints(pm)
+        passes.common.add_func_licm(pm)
         passes.common.add_symbol_dce(pm)
         pm.run(mod)
+        metadata["tma_descriptors"] = json.loads(mod.get_str_attr("tt.tma_descriptors") or "[]")
+        metadata["workspace_size"] = mod.get_int_attr("tt.workspace_size") or 0
+        metadata["workspace_zeroed_size"] = mod.get_int_attr("tt.workspace_zeroed_size") or 0
+        metadata["magic_divisors"] = json.loads(mod.get_str_attr("tt.magic_divisors") or "[]")
+        metadata["cooperative"] = opt.cooperative or CUDABackend.uses_grid_sync(mod)
+        if metadata["cooperative"] and opt.persistent:
+            raise ValueError("persistent kernels can't be launched cooperatively, "
+                             "size the grid of kernels that call grid_sync from their occupancy instead")
         return mod
 
     @staticmethod
@@ -159,63 +341,98 @@ class CUDABackend(BaseBackend):
             cluster_info.clusterDimY = opt.cluster_dims[1]
             cluster_info.clusterDimZ = opt.cluster_dims[2]
         # TTIR -> TTGIR
-        pm = ir.pass_manager(mod.context)
-        pm.enable_debug()
-        passes.ttir.add_convert_to_ttgpuir(pm, f"cuda:{capability}", opt.num_warps, 32, opt.num_ctas)
-        # optimize TTGIR
-        passes.ttgpuir.add_coalesce(pm)
+        pm = BudgetedPassManager(mod, opt.compile_time_budget, opt.disabled_passes)
+        pm.add(passes.ttir.add_convert_to_ttgpuir, f"cuda:{capability}", opt.num_warps, 32, opt.num_ctas)
+        # optimize TTGIR, the optional passes are skipped once the compile time budget is spent
+        pm.add(passes.ttgpuir.add_coalesce)
+        pm.add(passes.ttgpuir.add_decompose_scaled_dot)
         if capability // 10 >= 8:
-            passes.ttgpuir.add_f32_dot_tc(pm)
+            pm.add(passes.ttgpuir.add_f32_dot_tc)
         # TODO(Qingyi): Move PlanCTAPass to the front of CoalescePass
-        nvidia.passes.ttnvgpuir.add_plan_cta(pm, cluster_info)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_optimize_thread_locality(pm)
-        passes.ttgpuir.add_accelerate_matmul(pm)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, capability >= 80)
-        passes.common.add_cse(pm)
-        if capability // 10 >= 8:
-            passes.ttgpuir.add_combine_tensor_select_and_if(pm)
-            passes.ttgpuir.add_pipeline(pm, opt.num_stages)
-        passes.ttgpuir.add_prefetch(pm)
-        passes.ttgpuir.add_optimize_dot_operands(pm, capability >= 80)
-        passes.ttgpuir.add_remove_layout_conversions(pm)
-        passes.ttgpuir.add_reduce_data_duplication(pm)
-        passes.ttgpuir.add_reorder_instructions(pm)
-        passes.common.add_cse(pm)
-        passes.common.add_symbol_dce(pm)
+        pm.add(nvidia.passes.ttnvgpuir.add_plan_cta, cluster_info)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(passes.ttgpuir.add_optimize_thread_locality, optional=True)
+        pm.add(passes.ttgpuir.add_accelerate_matmul, opt.tensor_core_reduce_threshold)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(passes.ttgpuir.add_optimize_dot_operands, capability >= 80, optional=True)
+        pm.add(passes.common.add_cse)
+        if opt.tile_versioning:
+            pm.add(passes.ttgpuir.add_tile_versioning, optional=True)
+        pm.add(passes.ttgpuir.add_combine_tensor_select_and_if)
+        pm.add(passes.ttgpuir.add_loop_unroll, opt.auto_unroll, optional=True)
+        if opt.num_consumer_groups > 0 and capability // 10 == 9:
+            # the pipeliner leaves the specialized loop alone
+            pm.add(nvidia.passes.ttnvgpuir.add_warp_specialization, opt.num_consumer_groups, max(opt.num_stages, 2),
+                   opt.reg_dec_producer, opt.reg_inc_consumer)
+        # before sm80 the pipeliner stages the loads through registers
+        pm.add(passes.ttgpuir.add_pipeline, opt.num_stages)
+        pm.add(passes.ttgpuir.add_prefetch, opt.prefetch_depth)
+        pm.add(passes.ttgpuir.add_optimize_dot_operands, capability >= 80, optional=True)
+        pm.add(passes.ttgpuir.add_remove_layout_conversions, optional=True)
+        pm.add(passes.ttgpuir.add_reduce_data_duplication)
+        pm.add(passes.ttgpuir.add_reorder_instructions, optional=True)
+        pm.add(passes.common.add_cse)
+        pm.add(passes.common.add_symbol_dce)
         if capability // 10 >= 9:
-            nvidia.passes.ttnvgpuir.add_fence_insertion(pm)
-            nvidia.passes.ttnvgpuir.add_tma_lowering(pm)
-        passes.common.add_canonicalizer(pm)
-        pm.run(mod)
+            pm.add(nvidia.passes.ttnvgpuir.add_fence_insertion)
+            pm.add(nvidia.passes.ttnvgpuir.add_tma_lowering)
+        pm.add(passes.common.add_canonicalizer)
+        if opt.report_shared_memory:
+            pm.add(passes.ttgpuir.add_report_shared_memory_access)
+        pm.run()
         metadata["cluster_dims"] = (cluster_info.clusterDimX, cluster_info.clusterDimY, cluster_info.clusterDimZ)
+        # clusters of independent programs need sm_90, before it the cluster dims are ignored as they used to be
+        if opt.num_ctas == 1 and capability < 90:
+            metadata["cluster_dims"] = (1, 1, 1)
+        # before sm_90 the grid dependency ops are dropped and the launch is a regular one
+        metadata["launch_pdl"] = opt.launch_pdl and capability >= 90
+        metadata["shared_memory_report"] = json.loads(mod.get_str_attr("triton_gpu.shared_memory_report") or "[]")
+        metadata["skipped_passes"] = pm.skipped_passes
+        metadata["budget_exceeded"] = pm.budget_exceeded
+        metadata["ttgir_pipeline"] = pm.pipeline
         return mod
 
     @staticmethod
     def make_llir(src, metadata, options, capability):
-        # warp-specialization mutates num_warps
-        num_warp_groups = src.get_int_attr("triton_gpu.num-warp-groups-per-cta")
-        if num_warp_groups is not None:
-            metadata["num_warps"] *= num_warp_groups
+        # warp-specialized kernels are launched with their producer warps too
+        num_producer_warps = src.get_int_attr("triton_gpu.num-producer-warps")
+        if num_producer_warps is not None:
+            metadata["num_warps"] += num_producer_warps
         mod = src
+        metadata["estimated_regs"] = mod.estimate_registers_per_thread()
         # TritonGPU -> LLVM-IR (MLIR)
         pm = ir.pass_manager(mod.context)
         pm.enable_debug()
+        # the unlikely branches and the boundary tiles move into functions of their own
+        passes.ttgpuir.add_outline_cold_regions(pm)
         nvidia.passes.ttgpuir.add_decompose_unsupported_conversions(pm)
         passes.ttgpuir.add_combine_tensor_select_and_if(pm)
         passes.convert.add_scf_to_cf(pm)
         passes.convert.add_index_to_llvmir(pm)
         passes.ttgpuir.add_allocate_shared_memory(pm)
-        nvidia.passes.ttgpuir.add_to_llvmir(pm, capability)
+        ptx_version = options.ptx_version
+        if ptx_version is None:
+            _, cuda_version = _path_to_binary("ptxas")
+            ptx_version = ptx_get_version(cuda_version)
+        # make_ptx targets sm_90a rather than sm_90, and the generic targets of the other capabilities
+        nvidia.passes.ttgpuir.add_to_llvmir(pm, capability, fast_math=options.fast_math,
+                                            pack_kernel_args=options.pack_kernel_args,
+                                            record_asserts=options.record_asserts, binary_prints=options.binary_prints,
+                                            binary_print_records=options.binary_print_records,
+                                            ptx_version=ptx_version, arch_specific=capability == 90,
+                                            l2_eviction_hints=options.eviction_hints)
         nvidia.passes.ttnvgpuir.add_nvgpu_to_llvm(pm)
         passes.convert.add_arith_to_llvmir(pm)
         passes.common.add_canonicalizer(pm)
         passes.common.add_cse(pm)
         passes.common.add_symbol_dce(pm)
         if os.environ.get("TRITON_DISABLE_LINE_INFO", "0") == "0":
-            passes.llvmir.add_di_scope(pm)
+            # the line table of the kernel only, without the scopes of the inlined functions
+            inlined_scopes = os.environ.get("TRITON_LINE_TABLES_ONLY", "0") == "0"
+            passes.llvmir.add_di_scope(pm, inlined_scopes)
         pm.run(mod)
+        metadata["device_asserts"] = json.loads(mod.get_str_attr("tt.device_asserts") or "[]")
+        metadata["device_prints"] = json.loads(mod.get_str_attr("tt.device_prints") or "[]")
         # LLVM-IR (MLIR) -> LLVM-IR (LLVM)
         llvm.init_targets()
         context = llvm.context()
@@ -232,7 +449,7 @@ class CUDABackend(BaseBackend):
             paths = [path for (name, path) in options.extern_libs]
             llvm.link_extern_libs(llvm_mod, paths)
 
-        llvm.optimize_module(llvm_mod, llvm.OPTIMIZE_O3)
+        llvm.optimize_module(llvm_mod, getattr(llvm, f"OPTIMIZE_O{options.llvm_opt_level}"))
 
         # Get some metadata
         metadata["shared"] = src.get_int_attr("triton_gpu.shared")
@@ -275,6 +492,24 @@ class CUDABackend(BaseBackend):
 
     @staticmethod
     def make_cubin(src, metadata, opt, capability):
+        ptx_compiler = get_ptx_compiler()
+        if ptx_compiler is not None:
+            options = [f"--gpu-name=sm_{capability}{'a' if capability == 90 else ''}"]
+            if not os.environ.get('TRITON_DISABLE_LINE_INFO'):
+                options.append("-lineinfo")
+            if not opt.enable_fp_fusion:
+                options.append("--fmad=false")
+            if os.environ.get("DISABLE_PTXAS_OPT", "0") == "1":
+                options.append("--opt-level=0")
+            options.extend(opt.ptxas_options)
+            options.append("--verbose")
+            try:
+                cubin, log = ptx_compiler.compile(src, options)
+                metadata.update(parse_ptxas_resource_usage(log))
+                return cubin
+            except RuntimeError:
+                # ptxas reports the errors
+                pass
         ptxas, _ = _path_to_binary("ptxas")
         with tempfile.NamedTemporaryFile(delete=False, mode='w', suffix='.ptx') as fsrc, \
             tempfile.NamedTemporaryFile(delete=False, mode='r', suffix='.log') as flog:
@@ -285,13 +520,16 @@ class CUDABackend(BaseBackend):
             line_info = '' if os.environ.get('TRITON_DISABLE_LINE_INFO') else ' -lineinfo'
             fmad = '' if opt.enable_fp_fusion else ' --fmad=false'
             suffix = 'a ' if capability == 90 else ' '
+            extra = ''.join(f' {shlex.quote(option)}' for option in opt.ptxas_options)
             if os.environ.get("DISABLE_PTXAS_OPT", "0") == "1":
-                cmd = f'{ptxas}{line_info}{fmad} -v --opt-level 0 --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
+                cmd = f'{ptxas}{line_info}{fmad}{extra} -v --opt-level 0 --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
             else:
-                cmd = f'{ptxas}{line_info}{fmad} -v --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
+                cmd = f'{ptxas}{line_info}{fmad}{extra} -v --gpu-name=sm_{capability}{suffix}{fsrc.name} -o {fbin} 2> {flog.name}'
 
             try:
                 subprocess.run(cmd, shell=True, check=True)
+                with open(flog.name) as log_file:
+                    metadata.update(parse_ptxas_resource_usage(log_file.read()))
             except subprocess.CalledProcessError as e:
                 with open(flog.name) as log_file:
                     log = log_file.read()
@@ -314,6 +552,16 @@ class CUDABackend(BaseBackend):
                 os.remove(fbin)
         return cubin
 
+    # Options that are only read after the given stage
+    late_stage_options = {
+        # the frontend and make_ttir read num_ctas and cluster_dims
+        "ttir": ("num_warps", "num_stages", "prefetch_depth", "maxnreg", "ptx_version", "enable_fp_fusion",
+                 "compile_time_budget", "disabled_passes", "llvm_opt_level", "ptxas_options",
+                 "tensor_core_reduce_threshold", "num_consumer_groups", "reg_dec_producer", "reg_inc_consumer",
+                 "auto_unroll", "report_shared_memory"),
+        "ttgir": ("maxnreg", "ptx_version", "enable_fp_fusion", "llvm_opt_level", "ptxas_options"),
+    }
+
     def add_stages(self, stages, options):
         stages["ttir"] = lambda src, metadata: self.make_ttir(src, metadata, options)
         stages["ttgir"] = lambda src, metadata: self.make_ttgir(src, metadata, options, self.capability)
@@ -321,6 +569,10 @@ class CUDABackend(BaseBackend):
         stages["ptx"] = lambda src, metadata: self.make_ptx(src, metadata, options, self.capability)
         stages["cubin"] = lambda src, metadata: self.make_cubin(src, metadata, options, self.capability)
 
+    def get_stage_options(self, options, stage):
+        late_options = self.late_stage_options.get(stage, ())
+        return {name: value for name, value in options.__dict__.items() if name not in late_options}
+
     @functools.lru_cache()
     def hash(self):
         version = get_ptxas_version()
@@ -55,6 +55,11 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   int sm_clock_rate;
   int mem_clock_rate;
   int mem_bus_width;
+  int max_threads_per_sm;
+  int max_blocks_per_sm;
+  int max_regs_per_sm;
+  int max_shared_mem_per_sm;
+  int reserved_shared_mem;
   CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
       &max_shared_mem, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
       device));
@@ -70,13 +75,32 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
       &mem_clock_rate, CU_DEVICE_ATTRIBUTE_MEMORY_CLOCK_RATE, device));
   CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
       &mem_bus_width, CU_DEVICE_ATTRIBUTE_GLOBAL_MEMORY_BUS_WIDTH, device));
-
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       max_shared_mem, "max_num_regs", max_num_regs,
-                       "multiprocessor_count", multiprocessor_count, "warpSize",
-                       warp_size, "sm_clock_rate", sm_clock_rate,
-                       "mem_clock_rate", mem_clock_rate, "mem_bus_width",
-                       mem_bus_width);
+  // the per-SM limits that bound the occupancy of a kernel
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_threads_per_sm, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_blocks_per_sm, CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_regs_per_sm, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &max_shared_mem_per_sm,
+      CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &reserved_shared_mem,
+      CU_DEVICE_ATTRIBUTE_RESERVED_SHARED_MEMORY_PER_BLOCK, device));
+
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem", max_shared_mem, "max_num_regs", max_num_regs,
+      "multiprocessor_count", multiprocessor_count, "warpSize", warp_size,
+      "sm_clock_rate", sm_clock_rate, "mem_clock_rate", mem_clock_rate,
+      "mem_bus_width", mem_bus_width, "max_threads_per_sm",
+      max_threads_per_sm, "max_blocks_per_sm", max_blocks_per_sm,
+      "max_regs_per_sm", max_regs_per_sm, "max_shared_mem_per_sm",
+      max_shared_mem_per_sm, "reserved_shared_mem", reserved_shared_mem);
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -140,6 +164,25 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+// Waits for the kernels in flight and unloads the module. Synchronizing would
+// invalidate a capture of the given stream, so returns False without unloading
+// while it is being captured.
+static PyObject *unloadBinary(PyObject *self, PyObject *args) {
+  uint64_t mod;
+  uint64_t stream;
+  if (!PyArg_ParseTuple(args, "KK", &mod, &stream))
+    return NULL;
+  CUstreamCaptureStatus status;
+  CUDA_CHECK_AND_RETURN_NULL(cuStreamIsCapturing((CUstream)stream, &status));
+  if (status != CU_STREAM_CAPTURE_STATUS_NONE)
+    Py_RETURN_FALSE;
+  Py_BEGIN_ALLOW_THREADS;
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuCtxSynchronize());
+  CUDA_CHECK_AND_RETURN_NULL_ALLOW_THREADS(cuModuleUnload((CUmodule)mod));
+  Py_END_ALLOW_THREADS;
+  Py_RETURN_TRUE;
+}
+
 typedef CUresult (*cuOccupancyMaxActiveClusters_t)(
     int *numClusters, CUfunction func, const CUlaunchConfig *config);
 
@@ -256,6 +299,66 @@ static PyObject *setPrintfFifoSize(PyObject *self, PyObject *args) {
   return Py_None;
 }
 
+// The element type of the descriptors. Copies only move bits, so by default
+// it is the unsigned integer of the element size. The reduce-stores combine
+// the elements in the type of the descriptor, which `dtype`, a Triton type
+// name like "fp32" or "i64", sets.
+static bool getDataType(int elementSize, const char *dtype,
+                        CUtensorMapDataType *type) {
+  if (dtype) {
+    static const struct {
+      const char *name;
+      int size;
+      CUtensorMapDataType type;
+    } dtypes[] = {
+        {"i8", 1, CU_TENSOR_MAP_DATA_TYPE_UINT8},
+        {"u8", 1, CU_TENSOR_MAP_DATA_TYPE_UINT8},
+        {"fp8e4nv", 1, CU_TENSOR_MAP_DATA_TYPE_UINT8},
+        {"fp8e5", 1, CU_TENSOR_MAP_DATA_TYPE_UINT8},
+        {"i16", 2, CU_TENSOR_MAP_DATA_TYPE_UINT16},
+        {"u16", 2, CU_TENSOR_MAP_DATA_TYPE_UINT16},
+        {"fp16", 2, CU_TENSOR_MAP_DATA_TYPE_FLOAT16},
+        {"bf16", 2, CU_TENSOR_MAP_DATA_TYPE_BFLOAT16},
+        {"i32", 4, CU_TENSOR_MAP_DATA_TYPE_INT32},
+        {"u32", 4, CU_TENSOR_MAP_DATA_TYPE_UINT32},
+        {"fp32", 4, CU_TENSOR_MAP_DATA_TYPE_FLOAT32},
+        {"i64", 8, CU_TENSOR_MAP_DATA_TYPE_INT64},
+        {"u64", 8, CU_TENSOR_MAP_DATA_TYPE_UINT64},
+        {"fp64", 8, CU_TENSOR_MAP_DATA_TYPE_FLOAT64},
+    };
+    for (size_t i = 0; i < sizeof(dtypes) / sizeof(dtypes[0]); i++) {
+      if (strcmp(dtype, dtypes[i].name) != 0)
+        continue;
+      if (dtypes[i].size != elementSize) {
+        PyErr_Format(PyExc_ValueError, "%s elements are not %d bytes", dtype,
+                     elementSize);
+        return false;
+      }
+      *type = dtypes[i].type;
+      return true;
+    }
+    PyErr_Format(PyExc_ValueError, "unsupported TMA element type %s", dtype);
+    return false;
+  }
+  switch (elementSize) {
+  case 1:
+    *type = CU_TENSOR_MAP_DATA_TYPE_UINT8;
+    return true;
+  case 2:
+    *type = CU_TENSOR_MAP_DATA_TYPE_UINT16;
+    return true;
+  case 4:
+    *type = CU_TENSOR_MAP_DATA_TYPE_UINT32;
+    return true;
+  case 8:
+    *type = CU_TENSOR_MAP_DATA_TYPE_UINT64;
+    return true;
+  default:
+    PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, 4 or 8");
+    return false;
+  }
+}
+
 // Simple helper to experiment creating TMA descriptors on the host.
 // This is a useful to test TMA operations independently.
 static PyObject *fill1DTMADescriptor(PyObject *self, PyObject *args) {
@@ -264,8 +367,9 @@ static PyObject *fill1DTMADescriptor(PyObject *self, PyObject *args) {
   uint32_t tensorDim;
   int elementSize;
   Py_buffer desc_buffer;
-  if (!PyArg_ParseTuple(args, "KKiiy*", &global_address, &dim, &tensorDim,
-                        &elementSize, &desc_buffer)) {
+  const char *dtype = NULL;
+  if (!PyArg_ParseTuple(args, "KKiiy*|z", &global_address, &dim, &tensorDim,
+                        &elementSize, &desc_buffer, &dtype)) {
     return NULL;
   }
   char *desc = (char *)desc_buffer.buf;
@@ -274,18 +378,9 @@ static PyObject *fill1DTMADescriptor(PyObject *self, PyObject *args) {
   uint32_t boxDim[1] = {tensorDim};
   uint32_t elementStrides[1] = {1};
   CUtensorMapDataType type;
-  switch (elementSize) {
-  case 1:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT8;
-    break;
-  case 2:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT16;
-    break;
-  case 4:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT32;
-    break;
-  default:
-    PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, or 4");
+  if (!getDataType(elementSize, dtype, &type)) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
   }
   assert((elementSize * tensorDim) >= 32 && "block size too small.");
   int rank = 1;
@@ -306,9 +401,10 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
   uint32_t tensorDims[2];
   int elementSize;
   Py_buffer desc_buffer;
-  if (!PyArg_ParseTuple(args, "KKKiiiy*", &global_address, &dims[1], &dims[0],
-                        &tensorDims[1], &tensorDims[0], &elementSize,
-                        &desc_buffer)) {
+  const char *dtype = NULL;
+  if (!PyArg_ParseTuple(args, "KKKiiiy*|z", &global_address, &dims[1],
+                        &dims[0], &tensorDims[1], &tensorDims[0], &elementSize,
+                        &desc_buffer, &dtype)) {
     return NULL;
   }
   char *desc = (char *)desc_buffer.buf;
@@ -316,18 +412,9 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
                                dims[0] * dims[1] * elementSize};
   uint32_t elementStrides[2] = {1, 1};
   CUtensorMapDataType type;
-  switch (elementSize) {
-  case 1:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT8;
-    break;
-  case 2:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT16;
-    break;
-  case 4:
-    type = CU_TENSOR_MAP_DATA_TYPE_UINT32;
-    break;
-  default:
-    PyErr_SetString(PyExc_ValueError, "elementSize must be 1, 2, or 4");
+  if (!getDataType(elementSize, dtype, &type)) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
   }
   int rank = 2;
   // Swizzling should be picked in codegen but since we need to set it on the
@@ -359,9 +446,266 @@ static PyObject *fill2DTMADescriptor(PyObject *self, PyObject *args) {
   return Py_None;
 }
 
+// The swizzling of a 2D box with `*contigDim` elements in the contiguous dim,
+// which is clamped to the 128B that the swizzling allows. The codegen emits
+// multiple copy operations for the wider boxes.
+static CUtensorMapSwizzle getSwizzle(int elementSize, uint32_t *contigDim) {
+  uint32_t contigDimSizeInByte = elementSize * *contigDim;
+  if (contigDimSizeInByte > 128)
+    *contigDim = 128 / elementSize;
+  if (contigDimSizeInByte >= 128)
+    return CU_TENSOR_MAP_SWIZZLE_128B;
+  if (contigDimSizeInByte >= 64)
+    return CU_TENSOR_MAP_SWIZZLE_64B;
+  return CU_TENSOR_MAP_SWIZZLE_32B;
+}
+
+// Read the `rank` dims and strides of a tensor, given outermost dim first, in
+// the innermost first order of the descriptors.
+static bool getTensorDims(PyObject *dimsObj, PyObject *stridesObj, int rank,
+                          int elementSize, uint64_t *dims,
+                          uint64_t *globalStrides) {
+  if (PySequence_Size(dimsObj) != rank ||
+      PySequence_Size(stridesObj) != rank) {
+    PyErr_SetString(PyExc_ValueError, "dims and strides must have rank dims");
+    return false;
+  }
+  for (int i = 0; i < rank; i++) {
+    PyObject *dim = PySequence_GetItem(dimsObj, rank - 1 - i);
+    PyObject *stride = PySequence_GetItem(stridesObj, rank - 1 - i);
+    if (dim)
+      dims[i] = PyLong_AsUnsignedLongLong(dim);
+    // The innermost dim is contiguous, it has no stride.
+    if (stride && i > 0)
+      globalStrides[i - 1] = PyLong_AsUnsignedLongLong(stride) * elementSize;
+    Py_XDECREF(dim);
+    Py_XDECREF(stride);
+  }
+  return !PyErr_Occurred();
+}
+
+// Fill the descriptor of a tensor of up to 5 dims tiled by boxes of
+// `boxDims`, given outermost dim first. `strides` are in elements and the
+// innermost dim must be contiguous. Follows the swizzling convention of
+// fill2DTMADescriptor, which codegen relies on: only the 2D boxes are
+// swizzled.
+static PyObject *fillTMADescriptor(PyObject *self, PyObject *args) {
+  unsigned long long global_address;
+  PyObject *dimsObj, *stridesObj, *boxDimsObj;
+  int elementSize;
+  Py_buffer desc_buffer;
+  const char *dtype = NULL;
+  if (!PyArg_ParseTuple(args, "KOOOiy*|z", &global_address, &dimsObj,
+                        &stridesObj, &boxDimsObj, &elementSize, &desc_buffer,
+                        &dtype)) {
+    return NULL;
+  }
+  char *desc = (char *)desc_buffer.buf;
+  Py_ssize_t rank = PySequence_Size(dimsObj);
+  if (rank < 1 || rank > 5 || PySequence_Size(boxDimsObj) != rank) {
+    PyBuffer_Release(&desc_buffer);
+    PyErr_SetString(PyExc_ValueError,
+                    "dims, strides and boxDims must have the same rank <= 5");
+    return NULL;
+  }
+  uint64_t dims[5];
+  uint64_t globalStrides[5];
+  uint32_t boxDims[5];
+  uint32_t elementStrides[5] = {1, 1, 1, 1, 1};
+  CUtensorMapDataType type;
+  if (!getTensorDims(dimsObj, stridesObj, rank, elementSize, dims,
+                     globalStrides) ||
+      !getDataType(elementSize, dtype, &type)) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
+  }
+  for (Py_ssize_t i = 0; i < rank; i++) {
+    PyObject *boxDim = PySequence_GetItem(boxDimsObj, rank - 1 - i);
+    if (boxDim)
+      boxDims[i] = PyLong_AsUnsignedLong(boxDim);
+    Py_XDECREF(boxDim);
+  }
+  if (PyErr_Occurred()) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
+  }
+  if (elementSize * boxDims[0] < 32) {
+    PyBuffer_Release(&desc_buffer);
+    PyErr_SetString(PyExc_ValueError, "block size too small.");
+    return NULL;
+  }
+  CUtensorMapSwizzle swizzle = CU_TENSOR_MAP_SWIZZLE_NONE;
+  if (rank == 2)
+    swizzle = getSwizzle(elementSize, &boxDims[0]);
+  CUresult result = cuTensorMapEncodeTiled(
+      (CUtensorMap *)desc, type, rank, (void *)global_address, dims,
+      globalStrides, boxDims, elementStrides, CU_TENSOR_MAP_INTERLEAVE_NONE,
+      swizzle,
+      rank > 1 ? CU_TENSOR_MAP_L2_PROMOTION_L2_128B
+               : CU_TENSOR_MAP_L2_PROMOTION_NONE,
+      CU_TENSOR_MAP_FLOAT_OOB_FILL_NONE);
+  PyBuffer_Release(&desc_buffer);
+  CUDA_CHECK_AND_RETURN_NULL(result);
+  Py_RETURN_NONE;
+}
+
+// Fill the im2col descriptor of a tensor of 3 to 5 dims, given outermost dim
+// first and channels innermost, e.g. NHWC. Each copy gathers
+// `pixelsPerColumn` pixels of `channelsPerPixel` channels, starting from the
+// pixel at the copy coordinates offset by `lowerCorner` and moving through the
+// bounding box that `upperCorner` ends. The corners list the spatial dims,
+// outermost first. The channels are swizzled like the 2D boxes since the
+// copies land in a 2D buffer.
+static PyObject *fillIm2colTMADescriptor(PyObject *self, PyObject *args) {
+  unsigned long long global_address;
+  PyObject *dimsObj, *stridesObj, *lowerObj, *upperObj;
+  unsigned int channelsPerPixel, pixelsPerColumn;
+  int elementSize;
+  Py_buffer desc_buffer;
+  if (!PyArg_ParseTuple(args, "KOOOOIIiy*", &global_address, &dimsObj,
+                        &stridesObj, &lowerObj, &upperObj, &channelsPerPixel,
+                        &pixelsPerColumn, &elementSize, &desc_buffer)) {
+    return NULL;
+  }
+  char *desc = (char *)desc_buffer.buf;
+  Py_ssize_t rank = PySequence_Size(dimsObj);
+  if (rank < 3 || rank > 5 || PySequence_Size(lowerObj) != rank - 2 ||
+      PySequence_Size(upperObj) != rank - 2) {
+    PyBuffer_Release(&desc_buffer);
+    PyErr_SetString(PyExc_ValueError,
+                    "im2col needs 3 to 5 dims and corners of rank - 2 dims");
+    return NULL;
+  }
+  uint64_t dims[5];
+  uint64_t globalStrides[5];
+  uint32_t elementStrides[5] = {1, 1, 1, 1, 1};
+  int lowerCorner[3];
+  int upperCorner[3];
+  CUtensorMapDataType type;
+  if (!getTensorDims(dimsObj, stridesObj, rank, elementSize, dims,
+                     globalStrides) ||
+      !getDataType(elementSize, NULL, &type)) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
+  }
+  for (Py_ssize_t i = 0; i < rank - 2; i++) {
+    PyObject *lower = PySequence_GetItem(lowerObj, rank - 3 - i);
+    PyObject *upper = PySequence_GetItem(upperObj, rank - 3 - i);
+    if (lower)
+      lowerCorner[i] = PyLong_AsLong(lower);
+    if (upper)
+      upperCorner[i] = PyLong_AsLong(upper);
+    Py_XDECREF(lower);
+    Py_XDECREF(upper);
+  }
+  if (PyErr_Occurred()) {
+    PyBuffer_Release(&desc_buffer);
+    return NULL;
+  }
+  if (elementSize * channelsPerPixel < 32) {
+    PyBuffer_Release(&desc_buffer);
+    PyErr_SetString(PyExc_ValueError, "block size too small.");
+    return NULL;
+  }
+  CUtensorMapSwizzle swizzle = getSwizzle(elementSize, &channelsPerPixel);
+  CUresult result = cuTensorMapEncodeIm2col(
+      (CUtensorMap *)desc, type, rank, (void *)global_address, dims,
+      globalStrides, lowerCorner, upperCorner, channelsPerPixel,
+      pixelsPerColumn, elementStrides, CU_TENSOR_MAP_INTERLEAVE_NONE, swizzle,
+      CU_TENSOR_MAP_L2_PROMOTION_L2_128B, CU_TENSOR_MAP_FLOAT_OOB_FILL_NONE);
+  PyBuffer_Release(&desc_buffer);
+  CUDA_CHECK_AND_RETURN_NULL(result);
+  Py_RETURN_NONE;
+}
+
+// Maps the memory of a peer device into the current context, so that kernels
+// can load from and store to the tensors of the peer through their pointers.
+static PyObject *enablePeerAccess(PyObject *self, PyObject *args) {
+  int peer_id;
+  if (!PyArg_ParseTuple(args, "i", &peer_id))
+    return NULL;
+  CUdevice device, peer;
+  CUDA_CHECK_AND_RETURN_NULL(cuCtxGetDevice(&device));
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGet(&peer, peer_id));
+  if (device == peer)
+    Py_RETURN_NONE;
+  int canAccessPeer = 0;
+  CUDA_CHECK_AND_RETURN_NULL(
+      cuDeviceCanAccessPeer(&canAccessPeer, device, peer));
+  if (!canAccessPeer) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "device %d can't access the memory of device %d",
+                 (int)device, peer_id);
+    return NULL;
+  }
+  // The primary context of the peer is kept alive for as long as its memory
+  // is mapped, i.e. for the lifetime of the process.
+  CUcontext peerCtx;
+  CUDA_CHECK_AND_RETURN_NULL(cuDevicePrimaryCtxRetain(&peerCtx, peer));
+  CUresult result = cuCtxEnablePeerAccess(peerCtx, 0);
+  if (result != CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED)
+    CUDA_CHECK_AND_RETURN_NULL(result);
+  Py_RETURN_NONE;
+}
+
+// Copies the device global `name` of a loaded module to a bytes object, and
+// zeroes it when `reset` is set so that the next launches start from scratch.
+static PyObject *readGlobal(PyObject *self, PyObject *args) {
+  unsigned long long module;
+  const char *name;
+  int reset;
+  if (!PyArg_ParseTuple(args, "Ksp", &module, &name, &reset))
+    return NULL;
+  CUdeviceptr ptr;
+  size_t size;
+  CUDA_CHECK_AND_RETURN_NULL(
+      cuModuleGetGlobal(&ptr, &size, (CUmodule)module, name));
+  PyObject *bytes = PyBytes_FromStringAndSize(NULL, size);
+  if (!bytes)
+    return NULL;
+  CUresult result = cuMemcpyDtoH(PyBytes_AS_STRING(bytes), ptr, size);
+  if (result == CUDA_SUCCESS && reset)
+    result = cuMemsetD8(ptr, 0, size);
+  if (!gpuAssert(result, __FILE__, __LINE__)) {
+    Py_DECREF(bytes);
+    return NULL;
+  }
+  return bytes;
+}
+
+// Sets aside `size` bytes of L2 for the persisting accesses of the current
+// context, at most the largest carve-out of the device, and returns the size
+// set aside. A size of 0 also demotes the persisting lines to normal ones.
+static PyObject *setPersistingL2CacheSize(PyObject *self, PyObject *args) {
+  unsigned long long size;
+  if (!PyArg_ParseTuple(args, "K", &size))
+    return NULL;
+  CUdevice device;
+  CUDA_CHECK_AND_RETURN_NULL(cuCtxGetDevice(&device));
+  int maxSize = 0;
+  CUDA_CHECK_AND_RETURN_NULL(cuDeviceGetAttribute(
+      &maxSize, CU_DEVICE_ATTRIBUTE_MAX_PERSISTING_L2_CACHE_SIZE, device));
+  // Devices before sm_80 have no carve-out
+  if (maxSize <= 0)
+    return PyLong_FromLong(0);
+  if (size > (unsigned long long)maxSize)
+    size = maxSize;
+  if (size == 0)
+    CUDA_CHECK_AND_RETURN_NULL(cuCtxResetPersistingL2Cache());
+  CUDA_CHECK_AND_RETURN_NULL(
+      cuCtxSetLimit(CU_LIMIT_PERSISTING_L2_CACHE_SIZE, size));
+  size_t reserved = 0;
+  CUDA_CHECK_AND_RETURN_NULL(
+      cuCtxGetLimit(&reserved, CU_LIMIT_PERSISTING_L2_CACHE_SIZE));
+  return PyLong_FromSize_t(reserved);
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided cubin into CUDA driver"},
+    {"unload_binary", unloadBinary, METH_VARARGS,
+     "Unload a module returned by load_binary, unless the given stream is "
+     "being captured"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
     {"cuOccupancyMaxActiveClusters", occupancyMaxActiveClusters, METH_VARARGS,
@@ -374,6 +718,17 @@ static PyMethodDef ModuleMethods[] = {
      "that calls printf()."},
     {"fill_1d_tma_descriptor", fill1DTMADescriptor, METH_VARARGS, "doc"},
     {"fill_2d_tma_descriptor", fill2DTMADescriptor, METH_VARARGS, "doc"},
+    {"fill_tma_descriptor", fillTMADescriptor, METH_VARARGS, "doc"},
+    {"fill_im2col_tma_descriptor", fillIm2colTMADescriptor, METH_VARARGS,
+     "doc"},
+    {"enable_peer_access", enablePeerAccess, METH_VARARGS,
+     "Map the memory of the given peer device into the current context"},
+    {"read_global", readGlobal, METH_VARARGS,
+     "Copy a device global of a loaded module to the host, optionally zeroing "
+     "it"},
+    {"set_persisting_l2_cache_size", setPersistingL2CacheSize, METH_VARARGS,
+     "Python interface for cuCtxSetLimit(CU_LIMIT_PERSISTING_L2_CACHE_SIZE, "
+     "x), returning the size set aside"},
 
     {NULL, NULL, 0, NULL} // sentinel
 };
@@ -1,18 +1,25 @@
 import functools
+import math
 import os
 import hashlib
+import struct
 import subprocess
 import tempfile
+from collections import OrderedDict
 from pathlib import Path
 from triton.runtime.build import _build
 from triton.runtime.cache import get_cache_manager
 from triton.backends.compiler import GPUTarget
-from triton.backends.driver import GPUDriver
+from triton.backends.driver import GPUDriver, workspaces
 
 dirname = os.path.dirname(os.path.realpath(__file__))
 include_dir = [os.path.join(dirname, "include")]
 libdevice_dir = os.path.join(dirname, "lib")
 libraries = ['cuda']
+# size in bytes of a CUtensorMap
+TMA_DESCRIPTOR_SIZE = 128
+# failures of the recorded asserts whose assert and program ids are kept, see PatternTritonGPUOpToLLVM.h
+MAX_RECORDED_ASSERT_FAILURES = 16
 
 
 @functools.lru_cache()
@@ -45,16 +52,18 @@ def library_dirs():
     return [libdevice_dir, *libcuda_dirs()]
 
 
-def compile_module_from_src(src, name):
+def compile_module_from_src(src, name, libs=None, lib_dirs=None):
     key = hashlib.sha256(src.encode("utf-8")).hexdigest()
     cache = get_cache_manager(key)
     cache_path = cache.get_file(f"{name}.so")
     if cache_path is None:
+        lib_dirs = library_dirs() if lib_dirs is None else lib_dirs
+        libs = libraries if libs is None else libs
         with tempfile.TemporaryDirectory() as tmpdir:
             src_path = os.path.join(tmpdir, "main.c")
             with open(src_path, "w") as f:
                 f.write(src)
-            so = _build(name, src_path, tmpdir, library_dirs(), include_dir, libraries)
+            so = _build(name, src_path, tmpdir, lib_dirs, include_dir, libs)
             with open(so, "rb") as f:
                 cache_path = cache.put(f.read(), f"{name}.so", binary=True)
     import importlib.util
@@ -79,11 +88,126 @@ class CudaUtils(object):
     def __init__(self):
         mod = compile_module_from_src(Path(os.path.join(dirname, "driver.c")).read_text(), "cuda_utils")
         self.load_binary = mod.load_binary
+        self.unload_binary = mod.unload_binary
         self.get_device_properties = mod.get_device_properties
         self.cuOccupancyMaxActiveClusters = mod.cuOccupancyMaxActiveClusters
         self.set_printf_fifo_size = mod.set_printf_fifo_size
         self.fill_1d_tma_descriptor = mod.fill_1d_tma_descriptor
         self.fill_2d_tma_descriptor = mod.fill_2d_tma_descriptor
+        self.fill_tma_descriptor = mod.fill_tma_descriptor
+        self.fill_im2col_tma_descriptor = mod.fill_im2col_tma_descriptor
+        self.enable_peer_access = mod.enable_peer_access
+        self.get_tma_descriptor = TmaDescriptorCache(mod.fill_tma_descriptor).get
+        # the descriptors passed to kernels in their packed arguments
+        self.get_host_tma_descriptor = TmaDescriptorCache(mod.fill_tma_descriptor, on_device=False).get
+        self.read_global = mod.read_global
+        self.set_persisting_l2_cache_size = mod.set_persisting_l2_cache_size
+
+    def reserve_persisting_l2(self, num_bytes, device=None):
+        """
+        Sets aside `num_bytes` of the L2 cache of `device`, or of the current device, for the persisting accesses of
+        the kernels compiled with `l2_persist`, and returns the number of bytes set aside, which the device may round
+        or cap. The rest of L2 is shared by the other accesses, so the carve-out should only hold the tensors that are
+        read again by the next kernels, e.g. the weights of a decode step. 0 gives the carve-out back.
+        """
+        import torch
+        with torch.cuda.device(device if device is not None else torch.cuda.current_device()):
+            return self.set_persisting_l2_cache_size(num_bytes)
+
+    def read_device_prints(self, kernel):
+        """
+        Returns the lines of the binary device prints of `kernel` since the last call, formatted as printf would have,
+        and empties its ring. Only the last binary_print_records records are kept, the earlier ones are overwritten.
+        """
+        device_prints = getattr(kernel.metadata, "device_prints", [])
+        if not device_prints:
+            return []
+        kernel._init_handles()
+        ring = self.read_global(kernel.module, "triton_print_ring", True)
+        return decode_device_prints(ring, device_prints)
+
+
+class TmaDescriptorCache(object):
+    """
+    Device copies of TMA descriptors, keyed on what they encode. Launches with the same tensors and blocks reuse the
+    descriptors instead of encoding them and copying them to the device every time. Without `on_device`, the host
+    descriptors are kept instead, for the launches that pass them by value.
+    """
+
+    def __init__(self, fill_tma_descriptor, capacity=1024, on_device=True):
+        self.fill_tma_descriptor = fill_tma_descriptor
+        self.on_device = on_device
+        self.capacity = capacity
+        self.descriptors = OrderedDict()
+
+    def get(self, ptr, shape, strides, box, element_size, dtype=None):
+        """
+        Returns a device tensor, or a host bytearray without `on_device`, holding the descriptor of the tensor at
+        `ptr`, with `shape` and `strides` in elements, tiled by `box`, outermost dim first. `dtype`, a Triton type
+        name like "fp32", sets the element type that reduce-stores combine the elements in. The descriptors live
+        until `capacity` newer ones have been made, so the launches captured in a CUDA graph should keep using a
+        bounded set of tensors.
+        """
+        import torch
+        key = (torch.cuda.current_device(), ptr, tuple(shape), tuple(strides), tuple(box), element_size, dtype)
+        desc = self.descriptors.get(key)
+        if desc is not None:
+            self.descriptors.move_to_end(key)
+            return desc
+        host_desc = bytearray(TMA_DESCRIPTOR_SIZE)
+        self.fill_tma_descriptor(ptr, shape, strides, box, element_size, host_desc, dtype)
+        # copied on the current stream, which the launches use unless told otherwise
+        desc = torch.frombuffer(host_desc, dtype=torch.uint8).cuda() if self.on_device else host_desc
+        self.descriptors[key] = desc
+        if len(self.descriptors) > self.capacity:
+            self.descriptors.popitem(last=False)
+        return desc
+
+
+def format_print_value(bits, ty, hex):
+    if ty.startswith("!tt.ptr"):
+        return f"0x{bits:x}"
+    width = 64 if ty == "f64" else int(ty[1:]) if ty[1:].isdigit() else 32
+    bits &= (1 << width) - 1
+    if hex:
+        return f"0x{bits:0{width // 4}x}"
+    if ty == "f16":
+        return f"{struct.unpack('<e', struct.pack('<H', bits))[0]:f}"
+    if ty == "bf16":
+        return f"{struct.unpack('<f', struct.pack('<I', bits << 16))[0]:f}"
+    if ty == "f32":
+        return f"{struct.unpack('<f', struct.pack('<I', bits))[0]:f}"
+    if ty == "f64":
+        return f"{struct.unpack('<d', struct.pack('<Q', bits))[0]:f}"
+    # integers are signless, which printf shows as unsigned
+    return f"{bits}"
+
+
+def decode_device_prints(ring, device_prints):
+    # the records of the triton_print_ring global: a cursor, then a power of two of records of 8 u32 each, see
+    # PatternTritonGPUOpToLLVM.h
+    cursor, = struct.unpack_from("<I", ring)
+    num_records = (len(ring) - 4) // 32
+    first = max(0, cursor - num_records)
+    lines = []
+    for k in range(first, cursor):
+        print_id, operand, x, y, z, index, lo, hi = struct.unpack_from("<8I", ring, 4 + 32 * (k % num_records))
+        desc = device_prints[print_id]
+        line = f"pid ({x}, {y}, {z})"
+        if not desc["operands"]:
+            lines.append(line + desc["prefix"])
+            continue
+        operand_desc = desc["operands"][operand]
+        # the index was linearized with dim 0 fastest
+        idx = []
+        for dim in operand_desc["shape"]:
+            idx.append(f"{index % dim:{math.ceil(math.log10(dim)) if dim > 0 else 0}}")
+            index //= max(dim, 1)
+        line += f" idx ({', '.join(idx)}){desc['prefix']}"
+        if len(desc["operands"]) > 1:
+            line += f"(operand {operand}) "
+        lines.append(line + format_print_value(lo | hi << 32, operand_desc["type"], desc["hex"]))
+    return lines
 
 
 # ------------------------
@@ -94,6 +218,8 @@ class CudaUtils(object):
 def ty_to_cpp(ty):
     if ty[0] == '*':
         return "CUdeviceptr"
+    if ty == "nvTmaDesc":
+        return "const void*"
     return {
         "i1": "int32_t",
         "i8": "int8_t",
@@ -113,13 +239,269 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def make_launcher(constants, signature, ids):
+def ty_to_packed_cpp(ty):
+    # the field of the argument in the struct of packed kernel arguments, with the size of its LLVM type
+    if ty == "nvTmaDesc":
+        return "CUtensorMap"
+    return {
+        "i1": "uint8_t",
+        "u1": "uint8_t",
+        "fp16": "uint16_t",
+        "bf16": "uint16_t",
+    }.get(ty) or ty_to_cpp(ty)
+
+
+def c_string(text):
+    # a C string literal of the UTF-8 bytes of text, with octal escapes
+    chars = (chr(b) if 32 <= b < 127 and chr(b) not in '"\\?' else f"\\{b:03o}" for b in text.encode())
+    return '"' + ''.join(chars) + '"'
+
+
+def make_assert_report(device_asserts):
+    # the failures recorded by the asserts, in the triton_assert_failures global of the kernel
+    if not device_asserts:
+        return "", ""
+    descriptions = ', '.join(
+        c_string(f"{a['file']}:{a['line']}: {a['func']}: Assertion `{a['message']}` failed") for a in device_asserts)
+    decls = f"""
+#define MAX_RECORDED_ASSERT_FAILURES {MAX_RECORDED_ASSERT_FAILURES}
+
+typedef struct {{
+  uint32_t count;
+  // assert id, x, y and z program ids, and row-major index of the failing element
+  uint32_t records[MAX_RECORDED_ASSERT_FAILURES][5];
+}} AssertFailures;
+
+static const char *assertDescriptions[] = {{ {descriptions} }};
+
+// A host copy of the failures of a kernel, and how many of them were reported.
+typedef struct AssertReport {{
+  CUfunction function;
+  CUdeviceptr failures;
+  AssertFailures *hostFailures;
+  uint32_t reported;
+  struct AssertReport *next;
+}} AssertReport;
+
+// The failures of the kernel, which are never reset, so each of them is
+// reported once. Racing launches may report them late, but not lose them.
+// The host functions of launches on different streams may run concurrently,
+// so the failures to report are claimed by advancing `reported` atomically.
+// Records below the count never change, so any copy of them is up to date.
+static void CUDA_CB reportAssertFailures(void *data) {{
+  AssertReport *report = (AssertReport *)data;
+  uint32_t count = __atomic_load_n(&report->hostFailures->count, __ATOMIC_RELAXED);
+  uint32_t reported = __atomic_load_n(&report->reported, __ATOMIC_RELAXED);
+  do {{
+    if (count <= reported)
+      return;
+  }} while (!__atomic_compare_exchange_n(&report->reported, &reported, count, false, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED));
+  for (uint32_t i = reported; i < count && i < MAX_RECORDED_ASSERT_FAILURES; ++i) {{
+    uint32_t *record = report->hostFailures->records[i];
+    fprintf(stderr, "%s on program (%u, %u, %u) at element %u\\n", assertDescriptions[record[0]], record[1],
+            record[2], record[3], record[4]);
+  }}
+  if (count > MAX_RECORDED_ASSERT_FAILURES)
+    fprintf(stderr, "%u device assertion failures, the first %d were reported\\n", count, MAX_RECORDED_ASSERT_FAILURES);
+}}
+
+// The reports of the kernels launched by this launcher. They are only looked
+// up and added with the GIL held, and never freed, since the host functions of
+// pending launches read them.
+static AssertReport *assertReports = NULL;
+
+static AssertReport *getAssertReport(CUfunction function) {{
+  for (AssertReport *report = assertReports; report; report = report->next) {{
+    if (report->function == function)
+      return report;
+  }}
+  CUmodule module;
+  CUdeviceptr failures;
+  size_t bytes;
+  AssertFailures *hostFailures;
+  CUDA_CHECK(cuFuncGetModule(&module, function));
+  CUDA_CHECK(cuModuleGetGlobal(&failures, &bytes, module, "triton_assert_failures"));
+  if (PyErr_Occurred())
+    return NULL;
+  CUDA_CHECK(cuMemAllocHost((void **)&hostFailures, sizeof(AssertFailures)));
+  if (PyErr_Occurred())
+    return NULL;
+  AssertReport *report = (AssertReport *)calloc(1, sizeof(AssertReport));
+  if (!report) {{
+    cuMemFreeHost(hostFailures);
+    PyErr_NoMemory();
+    return NULL;
+  }}
+  memset(hostFailures, 0, sizeof(AssertFailures));
+  report->function = function;
+  report->failures = failures;
+  report->hostFailures = hostFailures;
+  report->next = assertReports;
+  assertReports = report;
+  return report;
+}}
+
+// Reports the failures of `function` once its launch on `stream` is done.
+// Called with the GIL held, after the launch.
+static bool reportAssertFailuresAfter(CUfunction function, CUstream stream) {{
+  AssertReport *report = getAssertReport(function);
+  if (!report)
+    return false;
+  CUDA_CHECK(cuMemcpyDtoHAsync(report->hostFailures, report->failures, sizeof(AssertFailures), stream));
+  CUDA_CHECK(cuLaunchHostFunc(stream, reportAssertFailures, report));
+  return !PyErr_Occurred();
+}}
+"""
+    # placed after the GIL is taken back, formatted with the grid size, function and stream of the launch
+    report = """if ({grid} > 0 && !reportAssertFailuresAfter({function}, {stream}))
+    return NULL;"""
+    return decls, report
+
+
+def make_bound_launch(signature, magic_divisors, l2_persist_arg=None, assert_report=""):
+    # A bound launch keeps the arguments of `_launch` that `launch` resolves from Python objects, so that it is
+    # launched again with a single call. Its arguments are replaced by their position in the launch arguments.
+    if "nvTmaDesc" in signature.values():
+        # the descriptors are copied from Python objects at launch
+        unsupported = 'PyErr_SetString(PyExc_NotImplementedError, "kernels with TMA descriptors can\'t be bound"); ' \
+                      'return NULL;'
+        return f"""
+static PyObject* bind(PyObject* self, PyObject* args) {{ {unsupported} }}
+static PyObject* set_bound_arg(PyObject* self, PyObject* args) {{ {unsupported} }}
+static PyObject* launch_bound(PyObject* self, PyObject* args) {{ {unsupported} }}
+"""
+    fields = ' '.join(f"{ty_to_cpp(ty)} arg{i};" for i, ty in signature.items())
+    fields += ''.join(f" uint32_t magic{i}; uint32_t shift{i};" for i in magic_divisors)
+
+    def set_arg(pos, i, ty):
+        if ty[0] == '*':
+            ret = f"DevicePtrInfo info = getPointer(obj, {i}); if (!info.valid) return false; bound->arg{i} = info.dev_ptr;"
+            if i == l2_persist_arg:
+                ret += f" bound->l2Base = info.dev_ptr; if (!getByteSize(obj, {i}, &bound->l2Bytes)) return false;"
+            return ret
+        cpp_ty = ty_to_cpp(ty)
+        if cpp_ty in ("float", "double"):
+            value = "PyFloat_AsDouble(obj)"
+        elif cpp_ty.startswith("uint"):
+            value = "PyLong_AsUnsignedLongLongMask(obj)"
+        else:
+            value = "PyLong_AsLongLong(obj)"
+        ret = f"bound->arg{i} = ({cpp_ty}){value}; if (PyErr_Occurred()) return false;"
+        if i in magic_divisors:
+            ret += f" if (!getMagicNumbers(bound->arg{i}, {i}, &bound->magic{i}, &bound->shift{i})) return false;"
+        return ret
+
+    cases = '\n    '.join(f"case {pos}: {{ {set_arg(pos, i, ty)} return true; }}"
+                          for pos, (i, ty) in enumerate(signature.items()))
+    report = assert_report.format(grid="bound->gridX*bound->gridY*bound->gridZ", function="bound->function",
+                                  stream="(CUstream)_stream")
+    launch_args = ''.join(f", bound->arg{i}" for i in signature) + ''.join(f", bound->magic{i}, bound->shift{i}"
+                                                                          for i in magic_divisors)
+    return f"""
+typedef struct {{
+  int gridX, gridY, gridZ;
+  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ, persistent, cooperative, launch_pdl;
+  CUfunction function;
+  CUdeviceptr l2Base;
+  size_t l2Bytes;
+  {fields}
+}} BoundLaunch;
+
+static void freeBoundLaunch(PyObject *capsule) {{
+  free(PyCapsule_GetPointer(capsule, "BoundLaunch"));
+}}
+
+static bool setBoundArg(BoundLaunch *bound, int pos, PyObject *obj) {{
+  switch (pos) {{
+    {cases}
+  }}
+  PyErr_Format(PyExc_IndexError, "launch argument %d out of range", pos);
+  return false;
+}}
+
+static PyObject* bind(PyObject* self, PyObject* args) {{
+  int gridX, gridY, gridZ;
+  uint64_t _function;
+  PyObject *kernel_metadata = NULL;
+  PyObject *launch_args = NULL;
+  if (!PyArg_ParseTuple(args, "iiiKOO!", &gridX, &gridY, &gridZ, &_function, &kernel_metadata, &PyTuple_Type,
+                        &launch_args)) {{
+    return NULL;
+  }}
+  if (PyTuple_Size(launch_args) != {len(signature)}) {{
+    PyErr_Format(PyExc_TypeError, "expected {len(signature)} launch arguments, got %d", (int)PyTuple_Size(launch_args));
+    return NULL;
+  }}
+  BoundLaunch *bound = (BoundLaunch*)calloc(1, sizeof(BoundLaunch));
+  bound->gridX = gridX; bound->gridY = gridY; bound->gridZ = gridZ;
+  bound->function = (CUfunction)_function;
+  if (!PyArg_ParseTuple(kernel_metadata, "iiiiiiiii", &bound->num_warps, &bound->num_ctas, &bound->shared_memory,
+                        &bound->clusterDimX, &bound->clusterDimY, &bound->clusterDimZ, &bound->persistent,
+                        &bound->cooperative, &bound->launch_pdl)) {{
+    free(bound);
+    return NULL;
+  }}
+  for (int pos = 0; pos < {len(signature)}; ++pos) {{
+    if (!setBoundArg(bound, pos, PyTuple_GetItem(launch_args, pos))) {{
+      free(bound);
+      return NULL;
+    }}
+  }}
+  return PyCapsule_New(bound, "BoundLaunch", freeBoundLaunch);
+}}
+
+static PyObject* set_bound_arg(PyObject* self, PyObject* args) {{
+  PyObject *capsule = NULL;
+  PyObject *obj = NULL;
+  int pos;
+  if (!PyArg_ParseTuple(args, "OiO", &capsule, &pos, &obj))
+    return NULL;
+  BoundLaunch *bound = (BoundLaunch*)PyCapsule_GetPointer(capsule, "BoundLaunch");
+  if (!bound || !setBoundArg(bound, pos, obj))
+    return NULL;
+  Py_RETURN_NONE;
+}}
+
+static PyObject* launch_bound(PyObject* self, PyObject* args) {{
+  PyObject *capsule = NULL;
+  uint64_t _stream;
+  if (!PyArg_ParseTuple(args, "OK", &capsule, &_stream))
+    return NULL;
+  BoundLaunch *bound = (BoundLaunch*)PyCapsule_GetPointer(capsule, "BoundLaunch");
+  if (!bound)
+    return NULL;
+  int maxResidentCTAs = bound->persistent || bound->cooperative ?
+      getMaxResidentCTAs(bound->function, bound->num_warps, bound->shared_memory) : 0;
+  CUaccessPolicyWindow l2Window;
+  bool useL2Window = bound->l2Bytes > 0 && getL2Window(bound->l2Base, bound->l2Bytes, &l2Window);
+  if (PyErr_Occurred())
+    return NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  _launch(bound->gridX, bound->gridY, bound->gridZ, bound->num_warps, bound->num_ctas, bound->clusterDimX,
+          bound->clusterDimY, bound->clusterDimZ, bound->shared_memory, bound->persistent, bound->cooperative,
+          bound->launch_pdl, (CUstream)_stream, bound->function, useL2Window ? &l2Window : NULL,
+          maxResidentCTAs{launch_args});
+  Py_END_ALLOW_THREADS;
+  if (PyErr_Occurred())
+    return NULL;
+  {report}
+  Py_RETURN_NONE;
+}}
+"""
+
+
+def make_launcher(constants, signature, ids, pack_args=False, device_asserts=(), workspace_zeroed_size=0,
+                  magic_divisors=(), l2_persist_arg=None):
     # Record the end of regular arguments;
     # subsequent arguments are architecture-specific descriptors, such as tensor descriptors for CUDA.
-    arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    # The magic numbers of the divisor arguments come last, the launcher computes them from the divisors.
+    arg_decls = ', '.join([f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items()] +
+                          [f"uint32_t magic{i}, uint32_t shift{i}" for i in magic_divisors])
+    magic_args = ''.join(f", magic{i}, shift{i}" for i in magic_divisors)
 
     def _extracted_type(ty):
-        if ty[0] == '*':
+        if ty[0] == '*' or ty == "nvTmaDesc":
             return "PyObject*"
         return ty_to_cpp(ty)
 
@@ -145,6 +527,48 @@ def make_launcher(constants, signature, ids):
 
     # generate glue code
     params = [i for i in signature.keys() if i not in constants]
+    if pack_args:
+        # Persistent kernels take the requested grid as the three last fields,
+        # regular kernels don't read them.
+        packed_fields = ' '.join(f"{ty_to_packed_cpp(signature[i])} arg{i};" for i in params)
+        packed_fields += ''.join(f" uint32_t magic{i}; uint32_t shift{i};" for i in magic_divisors)
+        packed_fields += " int32_t gridX; int32_t gridY; int32_t gridZ;"
+        kernel_args_decl = f"typedef struct {{ {packed_fields} }} KernelArgs;"
+
+        def pack_arg(i):
+            ty = signature[i]
+            if ty == "nvTmaDesc":
+                return f"memcpy(&kernelArgs.arg{i}, arg{i}, sizeof(CUtensorMap));"
+            if ty in ("fp16", "bf16"):
+                return f"kernelArgs.arg{i} = fp32_to_{ty}(arg{i});"
+            return f"kernelArgs.arg{i} = arg{i};"
+
+        params_init = f"""KernelArgs kernelArgs;
+  {' '.join(pack_arg(i) for i in params)}
+  {' '.join(f"kernelArgs.magic{i} = magic{i}; kernelArgs.shift{i} = shift{i};" for i in magic_divisors)}
+  kernelArgs.gridX = gridX; kernelArgs.gridY = gridY; kernelArgs.gridZ = gridZ;
+  void *params[] = {{ &kernelArgs }};"""
+    else:
+        kernel_args_decl = ""
+        # Persistent kernels take the requested grid as three trailing arguments;
+        # the driver ignores them for regular kernels.
+        params_init = f"void *params[] = {{ {''.join(f'&arg{i}, ' for i in params)}" \
+                      f"{''.join(f'&magic{i}, &shift{i}, ' for i in magic_divisors)}&gridX, &gridY, &gridZ }};"
+    assert_report_decls, assert_report = make_assert_report(device_asserts)
+    bound_launch = make_bound_launch(signature, magic_divisors, l2_persist_arg, assert_report)
+    assert_report = assert_report.format(grid="gridX*gridY*gridZ", function="(CUfunction)_function",
+                                         stream="(CUstream)_stream")
+    # the tensor of the argument kept in the persisting L2 carve-out covers the access-policy window of the launch
+    l2_window = ""
+    if l2_persist_arg is not None:
+        l2_window = f"l2Base = ptr_info{l2_persist_arg}.dev_ptr; " \
+                    f"if (!getByteSize(_arg{l2_persist_arg}, {l2_persist_arg}, &l2Bytes)) return NULL;"
+    # the workspace buffer is the last argument, and its zeroed workspaces are cleared on the stream of each launch,
+    # a word at a time as the workspaces span whole words
+    clear_workspace = ""
+    if workspace_zeroed_size:
+        words = (workspace_zeroed_size + 3) // 4
+        clear_workspace = f"CUDA_CHECK(cuMemsetD32Async(arg{max(signature)}, 0, {words}, stream));"
     src = f"""
 #include \"cuda.h\"
 #include <stdbool.h>
@@ -191,30 +615,154 @@ static cuLaunchKernelEx_t getLaunchKernelExHandle() {{
   return cuLaunchKernelExHandle;
 }}
 
-static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, CUstream stream, CUfunction function{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in params)} }};
+// Number of CTAs of `function` that can be resident on the device at once.
+// Called with the GIL held, which guards the cache.
+static int getMaxResidentCTAs(CUfunction function, int num_warps, int shared_memory) {{
+  static CUfunction cachedFunction = NULL;
+  static int cachedCTAs = 1;
+  if (function != cachedFunction) {{
+    CUdevice device;
+    int numSMs = 0, ctasPerSM = 0;
+    CUDA_CHECK(cuCtxGetDevice(&device));
+    CUDA_CHECK(cuDeviceGetAttribute(&numSMs, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, device));
+    CUDA_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(&ctasPerSM, function, 32*num_warps, shared_memory));
+    cachedCTAs = numSMs * ctasPerSM > 0 ? numSMs * ctasPerSM : 1;
+    cachedFunction = function;
+  }}
+  return cachedCTAs;
+}}
+
+// The scalars are passed as float, rounded to nearest even.
+static inline uint16_t fp32_to_fp16(float value) {{
+  uint32_t f;
+  memcpy(&f, &value, sizeof(f));
+  uint16_t sign = (f >> 16) & 0x8000;
+  f &= 0x7fffffff;
+  if (f >= 0x47800000) // overflow, inf or nan
+    return sign | (f > 0x7f800000 ? 0x7e00 : 0x7c00);
+  if (f < 0x38800000) {{ // subnormal or zero, rounded by the fp32 addition
+    uint32_t magicBits = (127 - 15 + 23 - 10 + 1) << 23;
+    float magic, sum;
+    memcpy(&magic, &magicBits, sizeof(magic));
+    memcpy(&sum, &f, sizeof(sum));
+    sum += magic;
+    memcpy(&f, &sum, sizeof(f));
+    return sign | (uint16_t)(f - magicBits);
+  }}
+  uint32_t mantissaOdd = (f >> 13) & 1;
+  f += ((uint32_t)(15 - 127) << 23) + 0xfff + mantissaOdd;
+  return sign | (uint16_t)(f >> 13);
+}}
+
+static inline uint16_t fp32_to_bf16(float value) {{
+  uint32_t f;
+  memcpy(&f, &value, sizeof(f));
+  if ((f & 0x7fffffff) > 0x7f800000) // quiet nan
+    return (f >> 16) | 0x40;
+  return (f + 0x7fff + ((f >> 16) & 1)) >> 16;
+}}
+
+{kernel_args_decl}
+{assert_report_decls}
+// The access-policy window of the `numBytes` at `base`, clamped to the
+// largest window of the device. Its hit ratio is the share of the window that
+// fits in the persisting L2 carve-out of the context, so that its persisting
+// lines don't evict each other. There is none without a carve-out.
+// Called with the GIL held, which guards the cache.
+static bool getL2Window(CUdeviceptr base, size_t numBytes, CUaccessPolicyWindow *window) {{
+  static CUdevice cachedDevice = -1;
+  static int maxWindow = 0;
+  size_t carveOut = 0;
+  if (cuCtxGetLimit(&carveOut, CU_LIMIT_PERSISTING_L2_CACHE_SIZE) != CUDA_SUCCESS || carveOut == 0)
+    return false;
+  CUdevice device;
+  CUDA_CHECK(cuCtxGetDevice(&device));
+  if (device != cachedDevice) {{
+    CUDA_CHECK(cuDeviceGetAttribute(&maxWindow, CU_DEVICE_ATTRIBUTE_MAX_ACCESS_POLICY_WINDOW_SIZE, device));
+    cachedDevice = device;
+  }}
+  if (maxWindow <= 0)
+    return false;
+  if (numBytes > (size_t)maxWindow)
+    numBytes = maxWindow;
+  window->base_ptr = (void*)base;
+  window->num_bytes = numBytes;
+  window->hitRatio = carveOut >= numBytes ? 1.0f : (float)carveOut / numBytes;
+  window->hitProp = CU_ACCESS_PROPERTY_PERSISTING;
+  window->missProp = CU_ACCESS_PROPERTY_STREAMING;
+  return true;
+}}
+
+static void _launch(int gridX, int gridY, int gridZ, int num_warps, int num_ctas, int clusterDimX, int clusterDimY, int clusterDimZ, int shared_memory, int persistent, int cooperative, int launch_pdl, CUstream stream, CUfunction function, const CUaccessPolicyWindow *l2Window, int maxResidentCTAs{', ' + arg_decls if len(arg_decls) > 0 else ''}) {{
+  {params_init}
   if (gridX*gridY*gridZ > 0) {{
-    if (num_ctas == 1) {{
-      CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
+    {clear_workspace}
+    // With num_ctas > 1 a program is a cluster of CTAs, otherwise the
+    // programs themselves are grouped in clusters.
+    int programDimX = num_ctas == 1 ? 1 : clusterDimX;
+    int programDimY = num_ctas == 1 ? 1 : clusterDimY;
+    int programDimZ = num_ctas == 1 ? 1 : clusterDimZ;
+    int launchGridX = gridX, launchGridY = gridY, launchGridZ = gridZ;
+    if (persistent) {{
+      int numTiles = gridX*gridY*gridZ;
+      launchGridX = numTiles < maxResidentCTAs ? numTiles : maxResidentCTAs;
+      launchGridY = launchGridZ = 1;
+    }}
+    if (!cooperative && !launch_pdl && !l2Window && num_ctas == 1 && clusterDimX*clusterDimY*clusterDimZ == 1) {{
+      CUDA_CHECK(cuLaunchKernel(function, launchGridX, launchGridY, launchGridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
     }} else {{
-      CUlaunchAttribute launchAttr[2];
-      launchAttr[0].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
-      launchAttr[0].value.clusterDim.x = clusterDimX;
-      launchAttr[0].value.clusterDim.y = clusterDimY;
-      launchAttr[0].value.clusterDim.z = clusterDimZ;
-      launchAttr[1].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_SCHEDULING_POLICY_PREFERENCE;
-      launchAttr[1].value.clusterSchedulingPolicyPreference = CU_CLUSTER_SCHEDULING_POLICY_SPREAD;
+      if (cooperative) {{
+        // The driver rejects cooperative grids that can't be resident at once
+        // with a generic error, so say how large they may be.
+        int numCTAs = gridX*programDimX * gridY*programDimY * gridZ*programDimZ;
+        if (numCTAs > maxResidentCTAs) {{
+          PyErr_Format(PyExc_RuntimeError, "cooperative launch of %d CTAs, but at most %d of them can be resident at once", numCTAs, maxResidentCTAs);
+          return;
+        }}
+      }}
+      CUlaunchAttribute launchAttr[5];
+      int numAttrs = 0;
+      if (num_ctas != 1 || clusterDimX*clusterDimY*clusterDimZ != 1) {{
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+        launchAttr[numAttrs].value.clusterDim.x = clusterDimX;
+        launchAttr[numAttrs].value.clusterDim.y = clusterDimY;
+        launchAttr[numAttrs].value.clusterDim.z = clusterDimZ;
+        ++numAttrs;
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_CLUSTER_SCHEDULING_POLICY_PREFERENCE;
+        launchAttr[numAttrs].value.clusterSchedulingPolicyPreference = CU_CLUSTER_SCHEDULING_POLICY_SPREAD;
+        ++numAttrs;
+      }}
+      if (cooperative) {{
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_COOPERATIVE;
+        launchAttr[numAttrs].value.cooperative = 1;
+        ++numAttrs;
+      }}
+      if (launch_pdl) {{
+        // The kernel may start once the previous kernel of the stream called
+        // griddepcontrol.launch_dependents, and waits for it with
+        // griddepcontrol.wait.
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_PROGRAMMATIC_STREAM_SERIALIZATION;
+        launchAttr[numAttrs].value.programmaticStreamSerializationAllowed = 1;
+        ++numAttrs;
+      }}
+      if (l2Window) {{
+        // The hits of the kernel in the window persist in L2, its other
+        // accesses stream through without evicting them.
+        launchAttr[numAttrs].id = CU_LAUNCH_ATTRIBUTE_ACCESS_POLICY_WINDOW;
+        launchAttr[numAttrs].value.accessPolicyWindow = *l2Window;
+        ++numAttrs;
+      }}
       CUlaunchConfig config;
-      config.gridDimX = gridX * clusterDimX;
-      config.gridDimY = gridY * clusterDimY;
-      config.gridDimZ = gridZ * clusterDimZ;
+      config.gridDimX = launchGridX * programDimX;
+      config.gridDimY = launchGridY * programDimY;
+      config.gridDimZ = launchGridZ * programDimZ;
       config.blockDimX = 32 * num_warps;
       config.blockDimY = 1;
       config.blockDimZ = 1;
       config.sharedMemBytes = shared_memory;
       config.hStream = stream;
       config.attrs = launchAttr;
-      config.numAttrs = 2;
+      config.numAttrs = numAttrs;
       static cuLaunchKernelEx_t cuLaunchKernelExHandle = NULL;
       if (cuLaunchKernelExHandle == NULL) {{
         cuLaunchKernelExHandle = getLaunchKernelExHandle();
@@ -271,6 +819,69 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
   return ptr_info;
 }}
 
+// The size in bytes of the tensor of a pointer argument.
+static inline bool getByteSize(PyObject *obj, int idx, size_t *size) {{
+  PyObject *nbytes = PyObject_GetAttrString(obj, "nbytes");
+  if (!nbytes) {{
+    PyErr_Clear();
+    PyErr_Format(PyExc_TypeError, "L2 persisting argument (at %d) must have an nbytes attribute", idx);
+    return false;
+  }}
+  *size = PyLong_AsSize_t(nbytes);
+  Py_DECREF(nbytes);
+  return !PyErr_Occurred();
+}}
+
+// The magic number and shift of a divisor argument, with which the kernel
+// divides x <= 2^31 as (umulhi(x, magic) + x) >> shift.
+static inline bool getMagicNumbers(int32_t divisor, int idx, uint32_t *magic, uint32_t *shift) {{
+  if (divisor <= 0) {{
+    PyErr_Format(PyExc_ValueError, "Divisor argument (at %d) must be positive, got %d", idx, divisor);
+    return false;
+  }}
+  uint32_t l = 0;
+  while (((uint64_t)1 << l) < (uint64_t)divisor)
+    ++l;
+  *magic = (uint32_t)(((((uint64_t)1 << l) - divisor) << 32) / divisor + 1);
+  *shift = l;
+  return true;
+}}
+
+// The host TMA descriptors of packed kernel arguments, copied at launch.
+static inline const void* getTmaDesc(PyObject *obj, int idx) {{
+  if (!PyByteArray_Check(obj) || PyByteArray_Size(obj) != sizeof(CUtensorMap)) {{
+    PyErr_Format(PyExc_TypeError, "TMA descriptor argument (at %d) must be a bytearray of %d bytes", idx, (int)sizeof(CUtensorMap));
+    return NULL;
+  }}
+  return PyByteArray_AsString(obj);
+}}
+
+// Functions launched while their stream was being captured. The captured
+// graphs keep running them after the launch returns, so their modules are never
+// unloaded, see CompiledKernel.unload. Called with the GIL held, which guards
+// the set.
+static PyObject *capturedFunctions = NULL;
+
+static void recordCapturedLaunch(CUstream stream, uint64_t function) {{
+  CUstreamCaptureStatus status = CU_STREAM_CAPTURE_STATUS_NONE;
+  CUDA_CHECK(cuStreamIsCapturing(stream, &status));
+  if (status == CU_STREAM_CAPTURE_STATUS_NONE)
+    return;
+  if (!capturedFunctions && !(capturedFunctions = PySet_New(NULL)))
+    return;
+  PyObject *key = PyLong_FromUnsignedLongLong(function);
+  if (key) {{
+    PySet_Add(capturedFunctions, key);
+    Py_DECREF(key);
+  }}
+}}
+
+static PyObject* captured_functions(PyObject* self, PyObject* args) {{
+  if (!capturedFunctions && !(capturedFunctions = PySet_New(NULL)))
+    return NULL;
+  return PyFrozenSet_New(capturedFunctions);
+}}
+
 static PyObject* launch(PyObject* self, PyObject* args) {{
   int gridX, gridY, gridZ;
   uint64_t _stream;
@@ -286,8 +897,8 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
     return NULL;
   }}
 
-  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ;
-  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ)) {{
+  int num_warps, num_ctas, shared_memory, clusterDimX, clusterDimY, clusterDimZ, persistent, cooperative, launch_pdl;
+  if (!PyArg_ParseTuple(kernel_metadata, \"iiiiiiiii\", &num_warps, &num_ctas, &shared_memory, &clusterDimX, &clusterDimY, &clusterDimZ, &persistent, &cooperative, &launch_pdl)) {{
     PyErr_SetString(PyExc_TypeError, "kernel_metadata must be a tuple");
     return NULL;
   }}
@@ -303,12 +914,25 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
   // raise exception asap
   {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
+  {" ".join([f"const void* tma_desc{i} = getTmaDesc(_arg{i}, {i}); if (!tma_desc{i}) return NULL;" for i, ty in signature.items() if ty == "nvTmaDesc"])}
+  {" ".join([f"uint32_t magic{i}, shift{i}; if (!getMagicNumbers(_arg{i}, {i}, &magic{i}, &shift{i})) return NULL;" for i in magic_divisors])}
+  CUdeviceptr l2Base = 0;
+  size_t l2Bytes = 0;
+  {l2_window}
+  // the occupancy and the L2 window are computed with the GIL held, see getMaxResidentCTAs
+  int maxResidentCTAs = persistent || cooperative ? getMaxResidentCTAs((CUfunction)_function, num_warps, shared_memory) : 0;
+  CUaccessPolicyWindow l2Window;
+  bool useL2Window = l2Bytes > 0 && getL2Window(l2Base, l2Bytes, &l2Window);
+  recordCapturedLaunch((CUstream)_stream, _function);
+  if (PyErr_Occurred())
+    return NULL;
   Py_BEGIN_ALLOW_THREADS;
-  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, (CUstream)_stream, (CUfunction)_function{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()) if len(signature) > 0 else ''});
+  _launch(gridX, gridY, gridZ, num_warps, num_ctas, clusterDimX, clusterDimY, clusterDimZ, shared_memory, persistent, cooperative, launch_pdl, (CUstream)_stream, (CUfunction)_function, useL2Window ? &l2Window : NULL, maxResidentCTAs{', ' + ', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"tma_desc{i}" if ty == "nvTmaDesc" else f"_arg{i}" for i, ty in signature.items()) if len(signature) > 0 else ''}{magic_args});
   Py_END_ALLOW_THREADS;
   if (PyErr_Occurred()) {{
     return NULL;
   }}
+  {assert_report}
 
   if(launch_exit_hook != Py_None){{
     PyObject* args = Py_BuildValue("(O)", launch_metadata);
@@ -324,8 +948,14 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
   return Py_None;
 }}
 
+{bound_launch}
+
 static PyMethodDef ModuleMethods[] = {{
   {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"bind", bind, METH_VARARGS, "Resolves the grid, metadata and arguments of a launch once"}},
+  {{"set_bound_arg", set_bound_arg, METH_VARARGS, "Replaces an argument of a bound launch"}},
+  {{"launch_bound", launch_bound, METH_VARARGS, "Launches a bound launch on a stream"}},
+  {{"captured_functions", captured_functions, METH_NOARGS, "The functions launched while their stream was being captured"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
@@ -357,12 +987,129 @@ class CudaLauncher(object):
         cst_key = lambda i: src.fn.arg_names.index(i) if isinstance(i, str) else i
         constants = {cst_key(key): value for key, value in constants.items()}
         signature = {cst_key(key): value for key, value in src.signature.items()}
-        src = make_launcher(constants, signature, ids)
+        # the launch arguments, and the constants and divisibility by 16 that the kernel was specialized on, which
+        # the arguments that set_arg replaces in bound launches must keep
+        self.launch_arg_indices = list(signature)
+        self.constants = constants
+        attrs = getattr(src, "attrs", None)
+        self.divisible_by_16 = {cst_key(i) for i in attrs.divisible_by_16} if attrs is not None else set()
+        # position in the launch arguments of each kernel argument
+        self.arg_positions = [pos for pos, i in enumerate(signature) if i not in constants]
+        kernel_args = [i for i in signature if i not in constants]
+        magic_divisors = [kernel_args[arg] for arg in getattr(metadata, "magic_divisors", [])]
+        # the TMA descriptors of the block pointers are passed after the kernel arguments,
+        # by value when the arguments are packed and as device pointers otherwise
+        self.tma_descriptors = getattr(metadata, "tma_descriptors", [])
+        self.pack_args = getattr(metadata, "pack_kernel_args", False)
+        first_desc = max(signature, default=-1) + 1
+        for i in range(len(self.tma_descriptors)):
+            signature[first_desc + i] = "nvTmaDesc" if self.pack_args else "*i8"
+        # then the buffer of the workspaces
+        self.workspace_size = getattr(metadata, "workspace_size", 0)
+        if self.workspace_size:
+            signature[first_desc + len(self.tma_descriptors)] = "*i8"
+        l2_persist_arg = getattr(metadata, "l2_persist", None)
+        if l2_persist_arg is not None:
+            l2_persist_arg = cst_key(l2_persist_arg)
+            if l2_persist_arg in constants or not signature.get(l2_persist_arg, " ").startswith("*"):
+                raise ValueError(f"l2_persist must name a pointer argument, got {metadata.l2_persist}")
+        src = make_launcher(constants, signature, ids, self.pack_args, getattr(metadata, "device_asserts", []),
+                            getattr(metadata, "workspace_zeroed_size", 0), magic_divisors, l2_persist_arg)
         mod = compile_module_from_src(src, "__triton_launcher")
-        self.launch = mod.launch
+        self._bind = mod.bind
+        self._set_bound_arg = mod.set_bound_arg
+        self._launch_bound = mod.launch_bound
+        self.captured_functions = mod.captured_functions
+        if self.tma_descriptors or self.workspace_size:
+            # keep the native dispatcher from skipping __call__
+            self._launch = mod.launch
+        else:
+            self.launch = mod.launch
+
+    def make_tma_descriptors(self, args):
+
+        def launch_value(source):
+            return source["value"] if "value" in source else args[self.arg_positions[source["arg"]]]
+
+        get_tma_descriptor = CudaUtils().get_host_tma_descriptor if self.pack_args else CudaUtils().get_tma_descriptor
+        descs = []
+        for desc in self.tma_descriptors:
+            base = launch_value(desc["base"])
+            ptr = base.data_ptr() if hasattr(base, "data_ptr") else base
+            shape = [launch_value(size) for size in desc["shape"]]
+            strides = [launch_value(stride) for stride in desc["strides"]]
+            descs.append(get_tma_descriptor(ptr, shape, strides, desc["block"], desc["elem_bytes"]))
+        return descs
 
     def __call__(self, *args, **kwargs):
-        self.launch(*args, **kwargs)
+        if not self.tma_descriptors and not self.workspace_size:
+            return self.launch(*args, **kwargs)
+        # the launch arguments start with the grid, stream, function, metadata and hooks
+        extra_args = self.make_tma_descriptors(args[9:])
+        if self.workspace_size:
+            extra_args.append(workspaces.get(args[3], self.workspace_size))
+        self._launch(*args, *extra_args, **kwargs)
+
+    def check_bound_arg(self, pos, value):
+        """Raises a ValueError if `value` doesn't match the specialization of the launch argument at `pos`."""
+        if not 0 <= pos < len(self.launch_arg_indices):
+            # the native launcher raises the IndexError
+            return
+        i = self.launch_arg_indices[pos]
+        if i in self.constants:
+            constant = self.constants[i]
+            if constant is None:
+                matches = value is None
+            else:
+                matches = isinstance(value, int) and not isinstance(value, bool) and value == constant
+            if not matches:
+                raise ValueError(f"launch argument {pos} was specialized as the constant {constant!r}, got {value!r}")
+        elif i in self.divisible_by_16:
+            ptr = value.data_ptr() if hasattr(value, "data_ptr") else value
+            if isinstance(ptr, int) and ptr % 16 != 0:
+                kind = "16-byte aligned" if hasattr(value, "data_ptr") else "divisible by 16"
+                raise ValueError(f"launch argument {pos} was specialized as {kind}, got {value!r}")
+
+    def bind(self, grid, stream, function, kernel_metadata, args):
+        if self.tma_descriptors:
+            raise NotImplementedError("kernels whose block pointers are loaded with TMA can't be bound")
+        args = tuple(args)
+        for pos, arg in enumerate(args):
+            self.check_bound_arg(pos, arg)
+        if self.workspace_size:
+            args += (workspaces.get_buffer(stream, self.workspace_size), )
+        handle = self._bind(grid[0], grid[1], grid[2], function, kernel_metadata, args)
+        return BoundLaunch(self._launch_bound, self._set_bound_arg, self.check_bound_arg, handle, stream, args)
+
+
+class BoundLaunch(object):
+    """
+    A launch whose grid, metadata and arguments were resolved once, see :code:`CompiledKernel.bind`. Calling it
+    launches the kernel on the stream it was bound to with a single native call, and :code:`set_arg` replaces an
+    argument in place, e.g. the pointers of the buffers of a steady-state loop.
+    """
+
+    def __init__(self, launch_bound, set_bound_arg, check_bound_arg, handle, stream, args):
+        self._set_bound_arg = set_bound_arg
+        self._check_bound_arg = check_bound_arg
+        self._handle = handle
+        # the native handle only holds the device pointers, the buffers they point to, including the workspace
+        # buffer that comes last, are kept alive with it
+        self._args = list(args)
+        self.stream = stream
+        self.launch = functools.partial(launch_bound, handle, stream)
+
+    def set_arg(self, index, value):
+        """
+        Replaces the launch argument at `index`, in the order they were bound. The value must keep the
+        specialization that the kernel was compiled for, e.g. the 16-byte alignment of pointers.
+        """
+        self._check_bound_arg(index, value)
+        self._set_bound_arg(self._handle, index, value)
+        self._args[index] = value
+
+    def __call__(self):
+        self.launch()
 
 
 class CudaDriver(GPUDriver):
@@ -0,0 +1,162 @@
+#include "nvPTXCompiler.h"
+#include <stdlib.h>
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// Compiles PTX to a cubin in process with the static ptxas library, which
+// saves the temporary files and the subprocess of ptxas.
+
+static const char *resultString(nvPTXCompileResult result) {
+  switch (result) {
+  case NVPTXCOMPILE_SUCCESS:
+    return "success";
+  case NVPTXCOMPILE_ERROR_INVALID_COMPILER_HANDLE:
+    return "invalid compiler handle";
+  case NVPTXCOMPILE_ERROR_INVALID_INPUT:
+    return "invalid input";
+  case NVPTXCOMPILE_ERROR_COMPILATION_FAILURE:
+    return "compilation failure";
+  case NVPTXCOMPILE_ERROR_INTERNAL:
+    return "internal error";
+  case NVPTXCOMPILE_ERROR_OUT_OF_MEMORY:
+    return "out of memory";
+  case NVPTXCOMPILE_ERROR_UNSUPPORTED_PTX_VERSION:
+    return "unsupported PTX version";
+  default:
+    return "unknown error";
+  }
+}
+
+// Returns a malloc'ed copy of the error log, or NULL if there is none.
+static char *getErrorLog(nvPTXCompilerHandle compiler) {
+  size_t size = 0;
+  if (nvPTXCompilerGetErrorLogSize(compiler, &size) != NVPTXCOMPILE_SUCCESS ||
+      size == 0)
+    return NULL;
+  char *log = malloc(size + 1);
+  if (log == NULL)
+    return NULL;
+  log[size] = '\0';
+  if (nvPTXCompilerGetErrorLog(compiler, log) != NVPTXCOMPILE_SUCCESS) {
+    free(log);
+    return NULL;
+  }
+  return log;
+}
+
+// Returns a malloc'ed copy of the info log, e.g. the resource usage reported
+// with --verbose, or an empty string if there is none.
+static char *getInfoLog(nvPTXCompilerHandle compiler) {
+  size_t size = 0;
+  if (nvPTXCompilerGetInfoLogSize(compiler, &size) != NVPTXCOMPILE_SUCCESS)
+    size = 0;
+  char *log = malloc(size + 1);
+  if (log == NULL)
+    return NULL;
+  log[0] = '\0';
+  log[size] = '\0';
+  if (size > 0 &&
+      nvPTXCompilerGetInfoLog(compiler, log) != NVPTXCOMPILE_SUCCESS)
+    log[0] = '\0';
+  return log;
+}
+
+static PyObject *compilePTX(PyObject *self, PyObject *args) {
+  const char *ptx;
+  Py_ssize_t ptxSize;
+  PyObject *optionList;
+  if (!PyArg_ParseTuple(args, "s#O!", &ptx, &ptxSize, &PyList_Type,
+                        &optionList))
+    return NULL;
+  Py_ssize_t numOptions = PyList_Size(optionList);
+  const char **options = malloc(sizeof(const char *) * (numOptions + 1));
+  if (options == NULL)
+    return PyErr_NoMemory();
+  for (Py_ssize_t i = 0; i < numOptions; i++) {
+    options[i] = PyUnicode_AsUTF8(PyList_GetItem(optionList, i));
+    if (options[i] == NULL) {
+      free(options);
+      return NULL;
+    }
+  }
+
+  nvPTXCompilerHandle compiler = NULL;
+  nvPTXCompileResult result;
+  char *cubin = NULL;
+  size_t cubinSize = 0;
+  char *errorLog = NULL;
+  char *infoLog = NULL;
+  Py_BEGIN_ALLOW_THREADS;
+  result = nvPTXCompilerCreate(&compiler, ptxSize, ptx);
+  if (result == NVPTXCOMPILE_SUCCESS) {
+    result = nvPTXCompilerCompile(compiler, numOptions, options);
+    if (result == NVPTXCOMPILE_ERROR_COMPILATION_FAILURE)
+      errorLog = getErrorLog(compiler);
+  }
+  if (result == NVPTXCOMPILE_SUCCESS)
+    result = nvPTXCompilerGetCompiledProgramSize(compiler, &cubinSize);
+  if (result == NVPTXCOMPILE_SUCCESS) {
+    cubin = malloc(cubinSize);
+    if (cubin == NULL)
+      result = NVPTXCOMPILE_ERROR_OUT_OF_MEMORY;
+  }
+  if (result == NVPTXCOMPILE_SUCCESS)
+    result = nvPTXCompilerGetCompiledProgram(compiler, cubin);
+  if (result == NVPTXCOMPILE_SUCCESS) {
+    infoLog = getInfoLog(compiler);
+    if (infoLog == NULL)
+      result = NVPTXCOMPILE_ERROR_OUT_OF_MEMORY;
+  }
+  if (compiler != NULL)
+    nvPTXCompilerDestroy(&compiler);
+  Py_END_ALLOW_THREADS;
+  free(options);
+
+  if (result != NVPTXCOMPILE_SUCCESS) {
+    PyErr_Format(PyExc_RuntimeError, "nvPTXCompiler failed with %s: \n%s",
+                 resultString(result), errorLog ? errorLog : "");
+    free(errorLog);
+    free(cubin);
+    return NULL;
+  }
+  PyObject *ret = Py_BuildValue("(y#s)", cubin, (Py_ssize_t)cubinSize, infoLog);
+  free(cubin);
+  free(infoLog);
+  return ret;
+}
+
+static PyObject *getVersion(PyObject *self, PyObject *args) {
+  unsigned int major, minor;
+  nvPTXCompileResult result = nvPTXCompilerGetVersion(&major, &minor);
+  if (result != NVPTXCOMPILE_SUCCESS) {
+    PyErr_Format(PyExc_RuntimeError, "nvPTXCompiler failed with %s",
+                 resultString(result));
+    return NULL;
+  }
+  return Py_BuildValue("(II)", major, minor);
+}
+
+static PyMethodDef ModuleMethods[] = {
+    {"compile", compilePTX, METH_VARARGS,
+     "Compile PTX with the given ptxas options and return the cubin and the "
+     "info log"},
+    {"get_version", getVersion, METH_VARARGS,
+     "Return the (major, minor) CUDA version of the compiler"},
+    {NULL, NULL, 0, NULL} // sentinel
+};
+
+static struct PyModuleDef ModuleDef = {PyModuleDef_HEAD_INIT, "ptx_compiler",
+                                       NULL, // documentation
+                                       -1,   // size
+                                       ModuleMethods};
+
+PyMODINIT_FUNC PyInit_ptx_compiler(void) {
+  PyObject *m = PyModule_Create(&ModuleDef);
+  if (m == NULL) {
+    return NULL;
+  }
+
+  PyModule_AddFunctions(m, ModuleMethods);
+
+  return m;
+}
@@ -334,21 +334,15 @@ public:
 
   std::string getPtxAsm(ttn::StoreMatrixOp op) const {
     auto datas = op.getDatas();
-    std::string ptxAsm;
-    switch (datas.size()) {
-    case 1:
-      ptxAsm = "stmatrix.sync.aligned.m8n8.x1.shared.b16 [$0], {$1};";
-      break;
-    case 2:
-      ptxAsm = "stmatrix.sync.aligned.m8n8.x2.shared.b16 [$0], {$1, $2};";
-      break;
-    case 4:
-      ptxAsm =
-          "stmatrix.sync.aligned.m8n8.x4.shared.b16 [$0], {$1, $2, $3, $4};";
-      break;
-    default:
-      assert(false && "Invalid size");
-    }
+    assert((datas.size() == 1 || datas.size() == 2 || datas.size() == 4) &&
+           "Invalid size");
+    std::string ptxAsm = "stmatrix.sync.aligned.m8n8.x" +
+                         std::to_string(datas.size()) +
+                         (op.getTrans() ? ".trans" : "") +
+                         ".shared.b16 [$0], {";
+    for (unsigned i = 0; i < datas.size(); i++)
+      ptxAsm += (i ? ", $" : "$") + std::to_string(i + 1);
+    ptxAsm += "};";
     return ptxAsm;
   }
 };
@@ -364,10 +358,11 @@ public:
   std::vector<std::string>
   getOutputConstraints(ttn::WGMMAWaitGroupOp op) const {
     auto outputStructType = cast<LLVM::LLVMStructType>(op.getType());
-    uint32_t numOutputRegs = outputStructType.getBody().size();
-    std::string output =
-        outputStructType.getBody().front().isF32() ? "=f" : "=r";
-    return std::vector<std::string>(numOutputRegs, output);
+    // The accumulators may be waited on with an lhs packed in i32s.
+    std::vector<std::string> outputs;
+    for (Type type : outputStructType.getBody())
+      outputs.push_back(type.isF32() ? "=f" : "=r");
+    return outputs;
   }
 
   OperandsAndConstraints
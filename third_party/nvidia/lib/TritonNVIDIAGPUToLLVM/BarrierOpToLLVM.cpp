@@ -37,6 +37,12 @@ struct BarrierOpConversion
     : public ConvertOpToLLVMPattern<mlir::gpu::BarrierOp> {
   using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
 
+  // The named barriers of the groups of consumer warps are numbered from 1,
+  // there are at most 8 of them for the at most 16 consumer warps. The
+  // producer warps use the last barrier.
+  static constexpr int kProducerBarrierId =
+      triton::gpu::NamedBarrierOp::kMaxNumGroups;
+
   LogicalResult
   matchAndRewrite(mlir::gpu::BarrierOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -50,11 +56,65 @@ struct BarrierOpConversion
       rewriter.eraseOp(op);
       return success();
     }
+    auto mod = op->getParentOfType<ModuleOp>();
+    if (int numProducerWarps =
+            triton::gpu::TritonGPUDialect::getNumProducerWarps(mod)) {
+      // The producer and the consumer warps of warp-specialized kernels run
+      // different code, each of them synchronizes on a barrier of its own.
+      unsigned threadsPerWarp =
+          triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+      int numConsumerThreads =
+          triton::gpu::TritonGPUDialect::getNumWarps(mod) * threadsPerWarp;
+      Value tid = getThreadIdInCTA(rewriter, loc);
+      Value isProducer = icmp_uge(tid, i32_val(numConsumerThreads));
+      Value barId = select(isProducer, i32_val(kProducerBarrierId), i32_val(0));
+      Value numThreads =
+          select(isProducer, i32_val(numProducerWarps * threadsPerWarp),
+                 i32_val(numConsumerThreads));
+      PTXBuilder ptxBuilder;
+      auto &barSync = *ptxBuilder.create<>("bar.sync");
+      barSync(ptxBuilder.newOperand(barId, "r"),
+              ptxBuilder.newOperand(numThreads, "r"));
+      ptxBuilder.launch(rewriter, loc, void_ty(op->getContext()));
+      rewriter.eraseOp(op);
+      return success();
+    }
     // Otherwise we let the default lowering handle it
     return failure();
   }
 };
 
+struct NamedBarrierOpConversion
+    : public ConvertOpToLLVMPattern<triton::gpu::NamedBarrierOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::NamedBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto mod = op->getParentOfType<ModuleOp>();
+    unsigned threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    unsigned numWarps = op.getNumWarps();
+    PTXBuilder ptxBuilder;
+    if (numWarps == 1) {
+      auto &barWarpSync = *ptxBuilder.create<>("bar.warp.sync");
+      barWarpSync(ptxBuilder.newConstantOperand(-1));
+    } else {
+      // Barrier 0 is used by the barriers of the whole CTA, each group of
+      // warps uses the next ones.
+      Value warpId = udiv(getThreadId(rewriter, loc), i32_val(threadsPerWarp));
+      Value barId = add(udiv(warpId, i32_val(numWarps)), i32_val(1));
+      auto &barSync = *ptxBuilder.create<>("bar.sync");
+      barSync(ptxBuilder.newOperand(barId, "r"),
+              ptxBuilder.newConstantOperand(numWarps * threadsPerWarp));
+    }
+    ptxBuilder.launch(rewriter, loc, void_ty(op->getContext()));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct FenceAsyncSharedOpConversion
     : public ConvertOpToLLVMPattern<triton::nvidia_gpu::FenceAsyncSharedOp> {
   using ConvertOpToLLVMPattern<
@@ -83,7 +143,9 @@ struct InitBarrierOpConversion
         typeConverter->convertType(op.getAlloc().getType().getElementType()),
         rewriter);
 
-    auto id = getThreadId(rewriter, loc);
+    // A single thread of the CTA initializes the barrier, even if it's shared
+    // by the producer and the consumer warps of a warp-specialized kernel.
+    auto id = getThreadIdInCTA(rewriter, loc);
     auto pred = icmp_eq(id, i32_val(0));
     ::mlir::triton::PTXBuilder ptxBuilder;
     const std::string ptx = "@$0 mbarrier.init.shared::cta.b64 [$1], " +
@@ -188,15 +250,68 @@ struct WaitBarrierOpConversion
     return success();
   }
 };
+
+struct ArriveBarrierOpConversion
+    : public ConvertOpToLLVMPattern<triton::nvidia_gpu::ArriveBarrierOp> {
+  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::nvidia_gpu::ArriveBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto smemObj = LLVM::getSharedMemoryObjectFromStruct(
+        loc, adaptor.getAlloc(),
+        typeConverter->convertType(op.getAlloc().getType().getElementType()),
+        rewriter);
+
+    ::mlir::triton::PTXBuilder ptxBuilder;
+    const std::string ptx = "@$0 mbarrier.arrive.shared::cta.b64 _, [$1], " +
+                            std::to_string(op.getCount()) + ";";
+    auto &arriveOp = *ptxBuilder.create<>(ptx);
+    arriveOp({ptxBuilder.newOperand(adaptor.getPred(), "b"),
+              ptxBuilder.newOperand(smemObj.getBase(), "r")},
+             /*onlyAttachMLIRArgs=*/true);
+    auto voidTy = void_ty(op->getContext());
+    ptxBuilder.launch(rewriter, loc, voidTy);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+template <typename OpTy>
+struct SetMaxNRegOpConversion : public ConvertOpToLLVMPattern<OpTy> {
+  using ConvertOpToLLVMPattern<OpTy>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(OpTy op, typename OpTy::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    constexpr bool isInc = std::is_same_v<OpTy, triton::nvidia_gpu::RegAllocOp>;
+    ::mlir::triton::PTXBuilder ptxBuilder;
+    const std::string ptx = std::string("setmaxnreg.") +
+                            (isInc ? "inc" : "dec") + ".sync.aligned.u32 " +
+                            std::to_string(op.getRegCount()) + ";";
+    auto &setMaxNReg = *ptxBuilder.create<>(ptx);
+    setMaxNReg({}, /*onlyAttachMLIRArgs=*/true);
+    auto voidTy = void_ty(op->getContext());
+    ptxBuilder.launch(rewriter, op->getLoc(), voidTy);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
 } // namespace
 
 void mlir::triton::NVIDIA::populateBarrierOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     PatternBenefit benefit) {
   patterns.add<BarrierOpConversion>(typeConverter, benefit);
+  patterns.add<NamedBarrierOpConversion>(typeConverter, benefit);
   patterns.add<FenceAsyncSharedOpConversion>(typeConverter, benefit);
   patterns.add<InitBarrierOpConversion, InvalBarrierOpConversion>(typeConverter,
                                                                   benefit);
   patterns.add<WaitBarrierOpConversion>(typeConverter, benefit);
   patterns.add<BarrierExpectConversion>(typeConverter, benefit);
+  patterns.add<ArriveBarrierOpConversion>(typeConverter, benefit);
+  patterns.add<SetMaxNRegOpConversion<triton::nvidia_gpu::RegAllocOp>,
+               SetMaxNRegOpConversion<triton::nvidia_gpu::RegDeallocOp>>(
+      typeConverter, benefit);
 }
@@ -24,6 +24,7 @@
 #include "Dialect/NVGPU/IR/Dialect.h"
 #include "PatternTritonGPUOpToLLVM.h"
 #include "mlir/Conversion/LLVMCommon/Pattern.h"
+#include "triton/Conversion/TritonGPUToLLVM/Utility.h"
 #include "triton/Dialect/TritonNvidiaGPU/IR/Dialect.h"
 
 using namespace mlir;
@@ -56,12 +57,97 @@ struct ClusterWaitOpConversion
     return success();
   }
 };
+
+struct ClusterReduceOpConversion
+    : public ConvertOpToLLVMPattern<triton::ClusterReduceOp> {
+  explicit ClusterReduceOpConversion(LLVMTypeConverter &typeConverter,
+                                     const NVIDIA::TargetInfo &targetInfo,
+                                     PatternBenefit benefit)
+      : ConvertOpToLLVMPattern(typeConverter, benefit), targetInfo(targetInfo) {
+  }
+
+  LogicalResult
+  matchAndRewrite(triton::ClusterReduceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    unsigned clusterSize = op.getClusterSize();
+    if (clusterSize == 1) {
+      rewriter.replaceOp(op, adaptor.getSrc());
+      return success();
+    }
+    if (targetInfo.getComputeCapability() < 90)
+      return op.emitError("cluster_reduce requires clusters of programs, "
+                          "which need compute capability 90 or higher");
+    Location loc = op.getLoc();
+    auto srcTy = op.getSrc().getType();
+    auto mod = op->getParentOfType<ModuleOp>();
+    int numThreads = triton::gpu::TritonGPUDialect::getNumWarps(mod) *
+                     triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    Type elemTy = getTypeConverter()->convertType(srcTy.getElementType());
+    SmallVector<Value> srcValues =
+        unpackLLElements(loc, adaptor.getSrc(), rewriter);
+
+    // The CTAs of the cluster run the same program with the same layout, so
+    // the i-th element of a thread in a peer is the same element of the
+    // tensor: the elements are stored at [i][threadId] and read back from the
+    // same offset in the shared memory of every peer.
+    Value threadId = getThreadId(rewriter, loc);
+    Value smemBase = LLVM::getSharedMemoryBase(loc, rewriter, op);
+    SmallVector<Value> ptrs;
+    for (auto [i, value] : llvm::enumerate(srcValues)) {
+      Value offset = add(i32_val(i * numThreads), threadId);
+      ptrs.push_back(gep(smemBase.getType(), elemTy, smemBase, offset));
+      targetInfo.storeShared(rewriter, loc, ptrs.back(), value, true_val());
+    }
+    targetInfo.clusterBarrier(rewriter, loc);
+
+    SmallVector<Value> resultValues;
+    for (Value ptr : ptrs) {
+      Value acc;
+      for (unsigned rank = 0; rank < clusterSize; ++rank) {
+        Value cur = targetInfo.loadDShared(rewriter, loc, ptr, i32_val(rank),
+                                           elemTy, true_val());
+        acc = acc ? combine(rewriter, loc, op.getKind(), acc, cur) : cur;
+      }
+      resultValues.push_back(acc);
+    }
+    // The peers must not overwrite or release their shared memory until
+    // every CTA is done reading it.
+    targetInfo.clusterBarrier(rewriter, loc);
+
+    Value result = packLLElements(loc, getTypeConverter(), resultValues,
+                                  rewriter, srcTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
+private:
+  static Value combine(ConversionPatternRewriter &rewriter, Location loc,
+                       triton::ClusterReduceKind kind, Value lhs, Value rhs) {
+    bool isFloat = isa<FloatType>(lhs.getType());
+    switch (kind) {
+    case triton::ClusterReduceKind::ADD:
+      return isFloat ? fadd(lhs, rhs) : add(lhs, rhs);
+    case triton::ClusterReduceKind::MAX:
+      return isFloat ? fmax(lhs, rhs) : smax(lhs, rhs);
+    case triton::ClusterReduceKind::MIN:
+      return isFloat ? fmin(lhs, rhs) : smin(lhs, rhs);
+    case triton::ClusterReduceKind::UMAX:
+      return umax(lhs, rhs);
+    case triton::ClusterReduceKind::UMIN:
+      return umin(lhs, rhs);
+    }
+    llvm_unreachable("unknown cluster reduce kind");
+  }
+
+  const NVIDIA::TargetInfo &targetInfo;
+};
 } // namespace
 
 void mlir::triton::NVIDIA::populateClusterOpsToLLVMPatterns(
-    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
-    PatternBenefit benefit) {
+    LLVMTypeConverter &typeConverter, const TargetInfo &targetInfo,
+    RewritePatternSet &patterns, PatternBenefit benefit) {
   patterns.add<ClusterArriveOpConversion>(typeConverter, benefit);
   patterns.add<ClusterWaitOpConversion>(typeConverter, benefit);
+  patterns.add<ClusterReduceOpConversion>(typeConverter, targetInfo, benefit);
   return;
 }
@@ -23,6 +23,12 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               const LLVMTypeConverter *typeConverter,
                               ConversionPatternRewriter &rewriter);
 
+LogicalResult convertSparseMMA16832(triton::gpu::SparseDotOp op,
+                                    triton::gpu::SparseDotOp::Adaptor adaptor,
+                                    const LLVMTypeConverter *typeConverter,
+                                    ConversionPatternRewriter &rewriter,
+                                    Value thread);
+
 LogicalResult convertWGMMA(triton::nvidia_gpu::WarpGroupDotOp op,
                            triton::nvidia_gpu::WarpGroupDotOp::Adaptor adaptor,
                            const LLVMTypeConverter *typeConverter,
@@ -68,6 +74,25 @@ struct DotOpConversion : public ConvertOpToLLVMPattern<triton::DotOp> {
   }
 };
 
+struct SparseDotOpConversion
+    : public ConvertOpToLLVMPattern<triton::gpu::SparseDotOp> {
+  using ConvertOpToLLVMPattern<
+      triton::gpu::SparseDotOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto mmaLayout =
+        dyn_cast<NvidiaMmaEncodingAttr>(op.getD().getType().getEncoding());
+    if (!mmaLayout || !mmaLayout.isAmpere() ||
+        !isa<MemDescType>(op.getAMeta().getType()))
+      return op.emitError("sparse dots are only supported with MMAv2 layouts "
+                          "and metadata in shared memory");
+    return convertSparseMMA16832(op, adaptor, getTypeConverter(), rewriter,
+                                 getThreadId(rewriter, op.getLoc()));
+  }
+};
+
 struct WarpGroupDotOpConversion
     : public ConvertOpToLLVMPattern<triton::nvidia_gpu::WarpGroupDotOp> {
   using ConvertOpToLLVMPattern<
@@ -122,43 +147,68 @@ struct WarpGroupDotWaitOpConversion
                                                                    pendings);
       return success();
     }
-    std::vector<Type> types;
-    // Pack the inputs into a single struct.
+    // Pack the inputs into a single struct. The wait only ties 32-bit
+    // registers, so narrower elements, e.g. of an fp16 lhs kept in registers,
+    // are packed into i32s.
+    auto getNumElemsPer32Bits = [](LLVM::LLVMStructType structType) {
+      Type elemTy = structType.getBody().front();
+      if (!elemTy.isIntOrFloat() || elemTy.getIntOrFloatBitWidth() >= 32)
+        return 1u;
+      return 32 / elemTy.getIntOrFloatBitWidth();
+    };
+    SmallVector<Value> packedValues;
     for (Value input : adaptor.getInputs()) {
       auto structType = dyn_cast<LLVM::LLVMStructType>(input.getType());
       if (!structType)
         return failure();
-      for (Type type : structType.getBody())
-        types.push_back(type);
+      unsigned numElemsPer32Bits = getNumElemsPer32Bits(structType);
+      auto elems = unpackLLElements(loc, input, rewriter);
+      if (elems.size() % numElemsPer32Bits != 0)
+        return failure();
+      for (unsigned i = 0; i < elems.size(); i += numElemsPer32Bits) {
+        if (numElemsPer32Bits == 1) {
+          packedValues.push_back(elems[i]);
+          continue;
+        }
+        Type vecTy = vec_ty(elems[i].getType(), numElemsPer32Bits);
+        Value vec = undef(vecTy);
+        for (unsigned j = 0; j < numElemsPer32Bits; ++j)
+          vec = insert_element(vecTy, vec, elems[i + j], i32_val(j));
+        packedValues.push_back(bitcast(vec, i32_ty));
+      }
     }
+    std::vector<Type> types;
+    for (Value value : packedValues)
+      types.push_back(value.getType());
     auto packedType =
         LLVM::LLVMStructType::getLiteral(rewriter.getContext(), types);
-    Value packed = rewriter.create<LLVM::UndefOp>(loc, packedType);
-    unsigned outputStructIndex = 0;
-    for (Value input : adaptor.getInputs()) {
-      auto structType = dyn_cast<LLVM::LLVMStructType>(input.getType());
-      for (unsigned i = 0; i < structType.getBody().size(); ++i) {
-        Value value = rewriter.create<LLVM::ExtractValueOp>(
-            loc, structType.getBody()[i], input, i);
-        packed = rewriter.create<LLVM::InsertValueOp>(
-            loc, packedType, packed, value, outputStructIndex++);
-      }
-    }
+    Value packed = undef(packedType);
+    for (auto [i, value] : llvm::enumerate(packedValues))
+      packed = insert_val(packedType, packed, value, i);
     Value packedOutput =
         rewriter.create<triton::nvgpu::WGMMAWaitGroupOp>(loc, packed, pendings);
     // Unpack the output into the original struct types.
     SmallVector<Value> outputs;
-    outputStructIndex = 0;
+    unsigned outputStructIndex = 0;
     for (Value input : adaptor.getInputs()) {
       auto structType = cast<LLVM::LLVMStructType>(input.getType());
-      Value unpacked = rewriter.create<LLVM::UndefOp>(loc, structType);
-      for (unsigned i = 0; i < structType.getBody().size(); ++i) {
-        Value value = rewriter.create<LLVM::ExtractValueOp>(
-            loc, packedType.getBody()[outputStructIndex], packedOutput,
-            outputStructIndex);
+      unsigned numElemsPer32Bits = getNumElemsPer32Bits(structType);
+      Type elemTy = structType.getBody().front();
+      Value unpacked = undef(structType);
+      for (unsigned i = 0; i < structType.getBody().size();
+           i += numElemsPer32Bits) {
+        Value value = extract_val(types[outputStructIndex], packedOutput,
+                                  outputStructIndex);
         outputStructIndex++;
-        unpacked = rewriter.create<LLVM::InsertValueOp>(loc, structType,
-                                                        unpacked, value, i);
+        if (numElemsPer32Bits == 1) {
+          unpacked = insert_val(structType, unpacked, value, i);
+          continue;
+        }
+        Value vec = bitcast(value, vec_ty(elemTy, numElemsPer32Bits));
+        for (unsigned j = 0; j < numElemsPer32Bits; ++j)
+          unpacked = insert_val(structType, unpacked,
+                                extract_element(elemTy, vec, i32_val(j)),
+                                i + j);
       }
       outputs.push_back(unpacked);
     }
@@ -172,6 +222,7 @@ void mlir::triton::NVIDIA::populateDotOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     PatternBenefit benefit) {
   patterns.add<DotOpConversion>(typeConverter, benefit);
+  patterns.add<SparseDotOpConversion>(typeConverter, benefit);
   patterns.add<WarpGroupDotOpConversion>(typeConverter, benefit);
   patterns.add<WarpGroupDotWaitOpConversion>(typeConverter, benefit);
 }
@@ -432,3 +432,118 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               ConversionPatternRewriter &rewriter) {
   return convertMMA(op, adaptor, typeConverter, rewriter, false /*isTuring*/);
 }
+
+// Convert a 2:4 sparse dot to mma.sp.m16n8k32. Each instruction takes the 16
+// compressed columns of one tile of A, i.e. 32 columns of B, and 32 bits of
+// metadata in the threads 0 and 1 of every quad: the lower half holds the 16
+// columns of row lane / 4 starting at 16 * (lane % 2), the upper half the same
+// columns of row lane / 4 + 8.
+LogicalResult convertSparseMMA16832(triton::gpu::SparseDotOp op,
+                                    triton::gpu::SparseDotOp::Adaptor adaptor,
+                                    const LLVMTypeConverter *typeConverter,
+                                    ConversionPatternRewriter &rewriter,
+                                    Value thread) {
+  Location loc = op.getLoc();
+  MLIRContext *ctx = op.getContext();
+  auto aTensorTy = op.getA().getType();
+  auto bTensorTy = op.getB().getType();
+  auto dTensorTy = op.getD().getType();
+  auto aShapePerCTA = triton::gpu::getShapePerCTA(aTensorTy);
+  auto bShapePerCTA = triton::gpu::getShapePerCTA(bTensorTy);
+  auto dShapePerCTA = triton::gpu::getShapePerCTA(dTensorTy);
+
+  int bitwidth = aTensorTy.getElementType().getIntOrFloatBitWidth();
+  auto mmaLayout = cast<NvidiaMmaEncodingAttr>(dTensorTy.getEncoding());
+  auto repA = mmaLayout.getMMAv2Rep(aShapePerCTA, bitwidth, 0);
+  auto repB = mmaLayout.getMMAv2Rep(bShapePerCTA, bitwidth, 1);
+  assert(repB[1] == 2 * repA[2]);
+  int repM = repA[1], repN = repB[2], repK = repA[2];
+
+  auto ha = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getA(), 1, repM, repK, aTensorTy);
+  auto hb = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getB(), 1, std::max(repN / 2, 1),
+      repB[1], bTensorTy);
+  Value loadedC =
+      loadC(op.getC(), adaptor.getC(), typeConverter, loc, rewriter);
+  auto fc = unpackLLElements(loc, loadedC, rewriter);
+
+  // The rows of the metadata read by this thread in the first tile of M.
+  auto metaObj = getSharedMemoryObjectFromStruct(loc, adaptor.getAMeta(),
+                                                 i16_ty, rewriter);
+  auto warpsPerCTA = mmaLayout.getWarpsPerCTA();
+  Value warp = udiv(thread, i32_val(32));
+  Value lane = urem(thread, i32_val(32));
+  SmallVector<Value> multiDimWarpId = LLVM::delinearize(
+      rewriter, loc, warp, warpsPerCTA, triton::gpu::getOrder(mmaLayout));
+  int warpsPerTile = std::min<int>(warpsPerCTA[0], dShapePerCTA[0] / 16);
+  Value warpM = urem(multiDimWarpId[0], i32_val(dShapePerCTA[0] / 16));
+  Value metaRow = add(mul(warpM, i32_val(16)), udiv(lane, i32_val(4)));
+  Value metaCol = urem(lane, i32_val(2));
+  Value metaOffset = add(mul(metaRow, metaObj.strides[0]),
+                         mul(metaCol, metaObj.strides[1]));
+  // The metadata of all the instructions is loaded up front, so that the
+  // shared memory loads are not serialized with the mma.sp chain.
+  Value rowStride = metaObj.strides[0];
+  Value tileRowStride = mul(i32_val(warpsPerTile * 16), rowStride);
+  Value tileColStride = mul(i32_val(2), metaObj.strides[1]);
+  Value hiOffset = mul(i32_val(8), rowStride);
+  SmallVector<Value> metas(repM * repK);
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m) {
+      Value offset =
+          add(metaOffset, add(mul(i32_val(m), tileRowStride),
+                              mul(i32_val(k), tileColStride)));
+      Value lo = load(
+          i16_ty, gep(metaObj.base.getType(), i16_ty, metaObj.base, offset));
+      offset = add(offset, hiOffset);
+      Value hi = load(
+          i16_ty, gep(metaObj.base.getType(), i16_ty, metaObj.base, offset));
+      metas[k * repM + m] =
+          or_(zext(i32_ty, lo), shl(zext(i32_ty, hi), i32_val(16)));
+    }
+
+  StringRef eltName = aTensorTy.getElementType().isBF16() ? "bf16" : "f16";
+  std::string instr = ("mma.sp.sync.aligned.m16n8k32.row.col.f32." + eltName +
+                       "." + eltName + ".f32")
+                          .str();
+  Type retTy =
+      LLVM::LLVMStructType::getLiteral(ctx, SmallVector<Type>(4, f32_ty));
+  unsigned colsPerThread = repN * 2;
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m) {
+      Value meta = metas[k * repM + m];
+      for (int n = 0; n < repN; ++n) {
+        PTXBuilder builder;
+        auto &mma = *builder.create(instr);
+        unsigned cOffset = 2 * m * colsPerThread + 4 * n;
+        auto retArgs = builder.newListOperand(4, "=f");
+        auto cArgs = builder.newListOperand();
+        for (int i = 0; i < 4; ++i)
+          cArgs->listAppend(
+              builder.newOperand(fc[cOffset + i], std::to_string(i)));
+        auto aArgs = builder.newListOperand({
+            {ha[{0, 2 * m, 2 * k}], "r"},
+            {ha[{0, 2 * m + 1, 2 * k}], "r"},
+            {ha[{0, 2 * m, 2 * k + 1}], "r"},
+            {ha[{0, 2 * m + 1, 2 * k + 1}], "r"},
+        });
+        auto bArgs = builder.newListOperand({
+            {hb[{0, n, 4 * k}], "r"},
+            {hb[{0, n, 4 * k + 1}], "r"},
+            {hb[{0, n, 4 * k + 2}], "r"},
+            {hb[{0, n, 4 * k + 3}], "r"},
+        });
+        auto metaArg = builder.newOperand(meta, "r");
+        auto selectorArg = builder.newConstantOperand(0);
+        mma(retArgs, aArgs, bArgs, cArgs, metaArg, selectorArg);
+        Value mmaOut = builder.launch(rewriter, loc, retTy);
+        for (int i = 0; i < 4; ++i)
+          fc[cOffset + i] = extract_val(f32_ty, mmaOut, i);
+      }
+    }
+
+  Value res = packLLElements(loc, typeConverter, fc, rewriter, dTensorTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
@@ -221,6 +221,22 @@ static const Fp8ConversionDesc Fp32_to_Fp8E4M3Nv = {
 static const Fp8ConversionDesc Fp32_to_Fp8E5M2 = {
     "cvt.rn.satfinite.e5m2x2.f32 $0, $2, $1; \n", 32, 16, 2};
 
+// Fp8E4M3 (x2) <-> Fp8E5M2 (x2) (packed), through f16 which holds both exactly
+static const Fp8ConversionDesc Fp8E4M3Nv_to_Fp8E5M2 = {
+    "{                                       \n"
+    ".reg .b32 a;                            \n"
+    "cvt.rn.f16x2.e4m3x2 a, $1;              \n"
+    "cvt.rn.satfinite.e5m2x2.f16x2 $0, a;    \n"
+    "}",
+    16, 16, 2};
+static const Fp8ConversionDesc Fp8E5M2_to_Fp8E4M3Nv = {
+    "{                                       \n"
+    ".reg .b32 a;                            \n"
+    "cvt.rn.f16x2.e5m2x2 a, $1;              \n"
+    "cvt.rn.satfinite.e4m3x2.f16x2 $0, a;    \n"
+    "}",
+    16, 16, 2};
+
 /* ----- Packed integer to BF16 ------ */
 static const std::string S8_to_Bf16 =
     "{                                           \n"
@@ -310,9 +326,11 @@ struct FpToFpOpConversion
   explicit FpToFpOpConversion(LLVMTypeConverter &typeConverter,
                               ModuleAxisInfoAnalysis &axisAnalysisPass,
                               int computeCapability,
+                              bool hasStochasticRoundingCvt,
                               PatternBenefit benefit = patternBenefitDefault)
       : ElementwiseOpConversionBase(typeConverter, axisAnalysisPass, benefit),
-        computeCapability(computeCapability) {}
+        computeCapability(computeCapability),
+        hasStochasticRoundingCvt(hasStochasticRoundingCvt) {}
 
   static Value convertBf16ToFp32(Location loc,
                                  ConversionPatternRewriter &rewriter,
@@ -383,6 +401,35 @@ struct FpToFpOpConversion
     return builder.launch(rewriter, loc, f16_ty, false);
   }
 
+  // Converts pairs of elements with the stochastic rounding of sm100. Each
+  // half of the random bits rounds the element in the same half of the
+  // result, and only the 16 low bits of each random i32 are used, which are
+  // more than f32 drops for f16 or bf16.
+  static SmallVector<Value>
+  convertFp32ToFp16x2RS(Location loc, ConversionPatternRewriter &rewriter,
+                        MultipleOperandsRange operands, Type dstElemTy) {
+    SmallVector<Value> outVals;
+    for (unsigned i = 0; i < operands.size(); i += 2) {
+      bool isPair = i + 1 < operands.size();
+      Value lo = operands[i][0];
+      Value hi = isPair ? operands[i + 1][0] : f32_val(0);
+      Value rbits = and_(operands[i][1], i32_val(0xffff));
+      if (isPair)
+        rbits = or_(rbits, shl(operands[i + 1][1], i32_val(16)));
+      PTXBuilder builder;
+      auto &cvt = *builder.create(dstElemTy.isF16() ? "cvt.rs.f16x2.f32"
+                                                    : "cvt.rs.bf16x2.f32");
+      auto res = builder.newOperand("=r");
+      cvt(res, builder.newOperand(hi, "r"), builder.newOperand(lo, "r"),
+          builder.newOperand(rbits, "r"));
+      auto pair = builder.launch(rewriter, loc, vec_ty(dstElemTy, 2), false);
+      outVals.push_back(extract_element(dstElemTy, pair, i32_val(0)));
+      if (isPair)
+        outVals.push_back(extract_element(dstElemTy, pair, i32_val(1)));
+    }
+    return outVals;
+  }
+
   std::pair<ConverterT, size_t>
   getConversionFunc(Type srcTy, Type dstTy,
                     std::optional<RoundingMode> roundingMode) const {
@@ -416,6 +463,11 @@ struct FpToFpOpConversion
             // F32 -> F8
             {{F32TyID, F8E4M3TyID, RoundingMode::RTNE}, Fp32_to_Fp8E4M3Nv},
             {{F32TyID, F8E5M2TyID, RoundingMode::RTNE}, Fp32_to_Fp8E5M2},
+            // F8 -> F8
+            {{F8E4M3TyID, F8E5M2TyID, RoundingMode::RTNE},
+             Fp8E4M3Nv_to_Fp8E5M2},
+            {{F8E5M2TyID, F8E4M3TyID, RoundingMode::RTNE},
+             Fp8E5M2_to_Fp8E4M3Nv},
         };
     std::tuple<TypeID, TypeID, RoundingMode> key = {
         srcTy.getTypeID(), dstTy.getTypeID(),
@@ -452,6 +504,23 @@ struct FpToFpOpConversion
     auto dstElementType = getElementType(op.getResult());
     auto roundingMode = op.getRounding();
 
+    // Unless the target has cvt.rs, the random bits of stochastic rounding
+    // are added in software, after which the values convert exactly.
+    bool isStochastic = roundingMode == RoundingMode::RS;
+    if (isStochastic) {
+      if (hasStochasticRoundingCvt && srcElementType.isF32() &&
+          (dstElementType.isF16() || dstElementType.isBF16()))
+        return convertFp32ToFp16x2RS(loc, rewriter, operands, dstElementType);
+      roundingMode = RoundingMode::RTNE;
+    }
+    auto getSrc = [&](unsigned i) -> Value {
+      if (!isStochastic)
+        return operands[i][0];
+      return applyStochasticRounding(
+          loc, rewriter, operands[i][0], operands[i][1],
+          cast<FloatType>(srcElementType), cast<FloatType>(dstElementType));
+    };
+
     if (dstElementType.isFloat8E5M2() || dstElementType.isFloat8E4M3FNUZ()) {
       assert(roundingMode.has_value() &&
              "Rounding mode must be specified for convertsions to fp8");
@@ -468,23 +537,15 @@ struct FpToFpOpConversion
     if (srcElementType.isF32() && dstElementType.isF16()) {
       assert(roundingMode.has_value() &&
              "rounding mode must be specified for fp32->fp16 conversion");
-      SmallVector<Value> outVals;
-      for (Value v : operands[0]) {
-        outVals.push_back(
-            convertFp32ToFp16(loc, rewriter, v, roundingMode.value()));
-      }
-      return outVals;
+      return {
+          convertFp32ToFp16(loc, rewriter, getSrc(0), roundingMode.value())};
     }
 
     if (srcElementType.isF32() && dstElementType.isBF16()) {
       assert(roundingMode.has_value() &&
              "rounding mode must be specified for fp32->bf16 conversion");
-      SmallVector<Value> outVals;
-      for (Value v : operands[0]) {
-        outVals.push_back(
-            convertFp32ToBf16(loc, rewriter, v, roundingMode.value()));
-      }
-      return outVals;
+      return {
+          convertFp32ToBf16(loc, rewriter, getSrc(0), roundingMode.value())};
     }
 
     bool useFP16IntermediateSrc =
@@ -499,7 +560,7 @@ struct FpToFpOpConversion
         getConversionFunc(srcType, dstType, roundingMode);
     SmallVector<Value> inVals;
     for (unsigned i = 0; i < std::min(numElements, operands.size()); i++) {
-      inVals.push_back(operands[i][0]);
+      inVals.push_back(getSrc(i));
     }
     if (useFP16IntermediateSrc)
       for (Value &v : inVals)
@@ -517,6 +578,7 @@ struct FpToFpOpConversion
 
 private:
   int computeCapability;
+  bool hasStochasticRoundingCvt;
 };
 
 struct FDivOpConversion
@@ -552,6 +614,34 @@ struct FDivOpConversion
   }
 };
 
+// Computes the bf16 `ptxAsm` of lhs $1 and rhs $2 into $0. Two operand sets
+// are computed at once with `packedAsm`, which takes the pairs of elements in
+// b32 registers.
+SmallVector<Value> emitBF16Asm(ConversionPatternRewriter &rewriter,
+                               Location loc, MultipleOperandsRange operands,
+                               const char *ptxAsm, const char *packedAsm) {
+  PTXBuilder builder;
+  if (operands.size() < 2) {
+    auto &asmOp = *builder.create<PTXInstr>(ptxAsm);
+    auto res = builder.newOperand("=h");
+    auto lhs = builder.newOperand(operands[0][0], "h");
+    auto rhs = builder.newOperand(operands[0][1], "h");
+    asmOp({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
+    return {builder.launch(rewriter, loc, bf16_ty, false)};
+  }
+  auto &asmOp = *builder.create<PTXInstr>(packedAsm);
+  auto res = builder.newOperand("=r");
+  auto lhs = builder.newOperand(
+      bitcast(packOperandPair(loc, rewriter, bf16_ty, operands, 0), i32_ty),
+      "r");
+  auto rhs = builder.newOperand(
+      bitcast(packOperandPair(loc, rewriter, bf16_ty, operands, 1), i32_ty),
+      "r");
+  asmOp({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
+  Value ret = builder.launch(rewriter, loc, i32_ty, false);
+  return unpackPair(loc, rewriter, bf16_ty, bitcast(ret, vec_ty(bf16_ty, 2)));
+}
+
 struct FMulOpConversion
     : ElementwiseOpConversionBase<arith::MulFOp, FMulOpConversion> {
   using Base = ElementwiseOpConversionBase<arith::MulFOp, FMulOpConversion>;
@@ -565,16 +655,15 @@ struct FMulOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
-      PTXBuilder builder;
-      auto ptxAsm = " { .reg .b16 c;        \n"
-                    "    mov.b16 c, 0x8000U; \n" // 0.0
-                    "    fma.rn.bf16 $0, $1, $2, c; } \n";
-      auto &fMul = *builder.create<PTXInstr>(ptxAsm);
-      auto res = builder.newOperand("=h");
-      auto lhs = builder.newOperand(operands[0][0], "h");
-      auto rhs = builder.newOperand(operands[0][1], "h");
-      fMul({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
-      return {builder.launch(rewriter, loc, bf16_ty, false)};
+      return emitBF16Asm(rewriter, loc, operands,
+                         " { .reg .b16 c;        \n"
+                         "    mov.b16 c, 0x8000U; \n" // 0.0
+                         "    fma.rn.bf16 $0, $1, $2, c; } \n",
+                         " { .reg .b32 c;            \n"
+                         "    mov.b32 c, 0x80008000U; \n"
+                         "    fma.rn.bf16x2 $0, $1, $2, c; } \n");
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return createPackedOp<LLVM::FMulOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FMulOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -595,16 +684,15 @@ struct FAddOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
-      PTXBuilder builder;
-      auto ptxAsm = "{ .reg .b16 c;         \n"
-                    "   mov.b16 c, 0x3f80U; \n" // 1.0
-                    "   fma.rn.bf16 $0, $1, c, $2; } \n";
-      auto &fAdd = *builder.create<PTXInstr>(ptxAsm);
-      auto res = builder.newOperand("=h");
-      auto lhs = builder.newOperand(operands[0][0], "h");
-      auto rhs = builder.newOperand(operands[0][1], "h");
-      fAdd({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
-      return {builder.launch(rewriter, loc, bf16_ty, false)};
+      return emitBF16Asm(rewriter, loc, operands,
+                         "{ .reg .b16 c;         \n"
+                         "   mov.b16 c, 0x3f80U; \n" // 1.0
+                         "   fma.rn.bf16 $0, $1, c, $2; } \n",
+                         "{ .reg .b32 c;             \n"
+                         "   mov.b32 c, 0x3f803f80U; \n"
+                         "   fma.rn.bf16x2 $0, $1, c, $2; } \n");
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return createPackedOp<LLVM::FAddOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FAddOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -625,16 +713,15 @@ struct FSubOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
-      PTXBuilder builder;
-      auto ptxAsm = " { .reg .b16 c;         \n"
-                    "    mov.b16 c, 0xbf80U; \n" // -1.0
-                    "    fma.rn.bf16 $0, $2, c, $1;} \n";
-      auto &fSub = *builder.create<PTXInstr>(ptxAsm);
-      auto res = builder.newOperand("=h");
-      auto lhs = builder.newOperand(operands[0][0], "h");
-      auto rhs = builder.newOperand(operands[0][1], "h");
-      fSub({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
-      return {builder.launch(rewriter, loc, bf16_ty, false)};
+      return emitBF16Asm(rewriter, loc, operands,
+                         " { .reg .b16 c;         \n"
+                         "    mov.b16 c, 0xbf80U; \n" // -1.0
+                         "    fma.rn.bf16 $0, $2, c, $1;} \n",
+                         " { .reg .b32 c;             \n"
+                         "    mov.b32 c, 0xbf80bf80U; \n"
+                         "    fma.rn.bf16x2 $0, $2, c, $1;} \n");
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return createPackedOp<LLVM::FSubOp>(loc, rewriter, elemTy, operands);
     } else {
       return {rewriter.create<LLVM::FSubOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -655,7 +742,16 @@ struct SIToFPOpConversion
                                    Location loc) const {
     Type inElemTy = getElementType(op.getIn());
     Type outElemTy = getElementType(op.getOut());
-    if (outElemTy.isBF16() && inElemTy.isInteger(8) && operands.size() >= 4) {
+    std::optional<bool> int4Signed = getUnpackedInt4Signedness(op.getIn());
+    if (inElemTy.isInteger(8) && operands.size() >= 4 &&
+        (outElemTy.isF16() || (outElemTy.isBF16() && int4Signed))) {
+      SmallVector<Value> inVals = {operands[0][0], operands[1][0],
+                                   operands[2][0], operands[3][0]};
+      return convertPackedIntToFp(loc, rewriter, inVals, outElemTy,
+                                  int4Signed ? 4 : 8,
+                                  int4Signed.value_or(true));
+    } else if (outElemTy.isBF16() && inElemTy.isInteger(8) &&
+               operands.size() >= 4) {
       auto cvtFunc = makeConverterFromPtx(
           S8_to_Bf16, getTypeConverter()->convertType(inElemTy),
           getTypeConverter()->convertType(outElemTy));
@@ -766,6 +862,104 @@ struct ExpOpConversionApprox
   }
 };
 
+// Lowers an f32 op to the approximate PTX instruction `instr`, flushing
+// subnormals to zero, as in
+//
+//   instr.approx.ftz.f32 $0, inputScale * $1[, $2]; result = outputScale * $0
+//
+// f16 and bf16 operands are computed in f32.
+template <typename SourceOp>
+struct FastMathOpConversion
+    : ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  explicit FastMathOpConversion(LLVMTypeConverter &typeConverter,
+                                ModuleAxisInfoAnalysis &axisAnalysisPass,
+                                StringRef instr, double inputScale,
+                                double outputScale, PatternBenefit benefit)
+      : Base::ElementwiseOpConversionBase(typeConverter, axisAnalysisPass,
+                                          benefit),
+        instr(instr), inputScale(inputScale), outputScale(outputScale) {}
+
+  SmallVector<Value> createDestOps(SourceOp op, Adaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    if (!elemTy.isF32() && !elemTy.isF16() && !elemTy.isBF16())
+      return {};
+    PTXBuilder ptxBuilder;
+    auto &approx =
+        ptxBuilder.create<PTXInstr>(instr.str())->o("approx").o("ftz").o("f32");
+    SmallVector<PTXInstr::Operand *> oprs = {ptxBuilder.newOperand("=f")};
+    for (Value operand : operands[0]) {
+      if (!elemTy.isF32())
+        operand = fpext(f32_ty, operand);
+      if (inputScale != 1.0)
+        operand = fmul(f32_ty, operand, f32_val(inputScale));
+      oprs.push_back(ptxBuilder.newOperand(operand, "f"));
+    }
+    approx(oprs, /*onlyAttachMLIRArgs=*/false);
+    Value ret = ptxBuilder.launch(rewriter, loc, f32_ty, false);
+    if (outputScale != 1.0)
+      ret = fmul(f32_ty, ret, f32_val(outputScale));
+    if (!elemTy.isF32())
+      ret = rewriter.create<LLVM::FPTruncOp>(loc, elemTy, ret);
+    return {ret};
+  }
+
+private:
+  StringRef instr;
+  double inputScale;
+  double outputScale;
+};
+
+// Lowers pairs of f16 (sm_75+) or bf16 (sm_90+) elements to ex2.approx on
+// f16x2 or bf16x2, which computes them in a single instruction. Odd numbers of
+// elements per thread are left to FastMathOpConversion.
+struct FastExp2PackedOpConversion
+    : ElementwiseOpConversionBase<math::Exp2Op, FastExp2PackedOpConversion> {
+  using Base =
+      ElementwiseOpConversionBase<math::Exp2Op, FastExp2PackedOpConversion>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  explicit FastExp2PackedOpConversion(LLVMTypeConverter &typeConverter,
+                                      ModuleAxisInfoAnalysis &axisAnalysisPass,
+                                      int computeCapability,
+                                      PatternBenefit benefit)
+      : Base::ElementwiseOpConversionBase(typeConverter, axisAnalysisPass,
+                                          benefit),
+        computeCapability(computeCapability) {}
+
+  SmallVector<Value> createDestOps(math::Exp2Op op, Adaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    std::string instr;
+    if (elemTy.isF16() && computeCapability >= 75)
+      instr = "ex2.approx.f16x2";
+    else if (elemTy.isBF16() && computeCapability >= 90)
+      instr = "ex2.approx.ftz.bf16x2";
+    if (instr.empty() || operands.size() < 2)
+      return {};
+    auto vecTy = vec_ty(elemTy, 2);
+    Value packed = undef(vecTy);
+    for (int i = 0; i < 2; i++)
+      packed = insert_element(vecTy, packed, operands[i][0], i32_val(i));
+    PTXBuilder ptxBuilder;
+    auto &exp2 = *ptxBuilder.create<PTXInstr>(instr);
+    exp2(ptxBuilder.newOperand("=r"),
+         ptxBuilder.newOperand(bitcast(packed, i32_ty), "r"));
+    Value ret = bitcast(ptxBuilder.launch(rewriter, loc, i32_ty, false), vecTy);
+    return {extract_element(elemTy, ret, i32_val(0)),
+            extract_element(elemTy, ret, i32_val(1))};
+  }
+
+private:
+  int computeCapability;
+};
+
 struct ClampFOpConversion
     : ElementwiseOpConversionBase<ClampFOp, ClampFOpConversion> {
   using Base = ElementwiseOpConversionBase<ClampFOp, ClampFOpConversion>;
@@ -932,8 +1126,13 @@ void mlir::triton::NVIDIA::populateElementwiseOpToLLVMPatterns(
   patterns.add<FPToSIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   patterns.add<SIToFPOpConversion>(typeConverter, axisInfoAnalysis, benefit);
 
+  // cvt.rs is an sm_100a instruction of PTX 8.7
+  bool hasStochasticRoundingCvt = computeCapability >= 100 &&
+                                  targetInfo.isArchSpecific() &&
+                                  targetInfo.getPtxVersion() >= 87;
   patterns.add<FpToFpOpConversion>(typeConverter, axisInfoAnalysis,
-                                   computeCapability, benefit);
+                                   computeCapability, hasStochasticRoundingCvt,
+                                   benefit);
 
   // ExpOpConversionApprox will try using ex2.approx if the input type is
   // FP32. For other input types, ExpOpConversionApprox will return failure and
@@ -948,6 +1147,47 @@ void mlir::triton::NVIDIA::populateElementwiseOpToLLVMPatterns(
       typeConverter, patterns, axisInfoAnalysis, targetInfo, benefit);
 }
 
+// The approximations and their accuracy on f32, following the PTX ISA:
+//
+//   math.exp    ex2(x * log2(e))  2 ulp of ex2, plus the rounding of the
+//                                 product, about 1.2 * |x| ulp overall
+//   math.exp2   ex2(x)            2 ulp; f16x2 and bf16x2 are within the
+//                                 precision of their type
+//   math.log    lg2(x) * ln(2)    2^-22 absolute error for x in [0.5, 2],
+//   math.log2   lg2(x)            2 ulp (plus the product for log) otherwise
+//   math.sqrt   sqrt(x)           2^-23 relative error
+//   math.rsqrt  rsqrt(x)          2^-22.9 relative error
+//   arith.divf  div(x, y)         2 ulp for |y| in [2^-126, 2^126], 0 for
+//                                 larger |y| and infinite x
+//
+// All of them flush subnormal inputs and results to zero.
+void mlir::triton::NVIDIA::populateFastMathOpToLLVMPatterns(
+    LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    ModuleAxisInfoAnalysis &axisInfoAnalysis, int computeCapability,
+    PatternBenefit benefit) {
+  using namespace mlir::triton::gpu;
+
+  const double log2e = 1.4426950408889634;
+  const double ln2 = 0.6931471805599453;
+  patterns.add<FastMathOpConversion<math::ExpOp>>(
+      typeConverter, axisInfoAnalysis, "ex2", log2e, 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::Exp2Op>>(
+      typeConverter, axisInfoAnalysis, "ex2", 1.0, 1.0, benefit);
+  patterns.add<FastExp2PackedOpConversion>(typeConverter, axisInfoAnalysis,
+                                           computeCapability,
+                                           benefit.getBenefit() + 1);
+  patterns.add<FastMathOpConversion<math::LogOp>>(
+      typeConverter, axisInfoAnalysis, "lg2", 1.0, ln2, benefit);
+  patterns.add<FastMathOpConversion<math::Log2Op>>(
+      typeConverter, axisInfoAnalysis, "lg2", 1.0, 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::SqrtOp>>(
+      typeConverter, axisInfoAnalysis, "sqrt", 1.0, 1.0, benefit);
+  patterns.add<FastMathOpConversion<math::RsqrtOp>>(
+      typeConverter, axisInfoAnalysis, "rsqrt", 1.0, 1.0, benefit);
+  patterns.add<FastMathOpConversion<arith::DivFOp>>(
+      typeConverter, axisInfoAnalysis, "div", 1.0, 1.0, benefit);
+}
+
 void mlir::triton::NVIDIA::populateClampFOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAxisInfoAnalysis &axisInfoAnalysis, int computeCapability,
@@ -127,19 +127,40 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  // A mask that is true for all the elements needs no predication
+  bool isMaskAlwaysTrue(Value mask) const {
+    auto *axisInfo = axisAnalysisPass.getAxisInfo(mask);
+    return axisInfo && axisInfo->getConstantValue() == 1;
+  }
+
 protected:
   const NVIDIA::TargetInfo &targetInfo;
   ModuleAxisInfoAnalysis &axisAnalysisPass;
 };
 
+// Creates the L2 cache policy that evicts all the lines accessed with it
+// according to `evict`.
+Value createL2EvictPolicy(ConversionPatternRewriter &rewriter, Location loc,
+                          triton::EvictionPolicy evict) {
+  PTXBuilder ptxBuilder;
+  std::string priority = evict == triton::EvictionPolicy::EVICT_FIRST
+                             ? "L2::evict_first"
+                             : "L2::evict_last";
+  auto &policy =
+      *ptxBuilder.create<>("createpolicy.fractional." + priority + ".b64");
+  policy(ptxBuilder.newOperand("=l"), ptxBuilder.newConstantOperand("1.0"));
+  return ptxBuilder.launch(rewriter, loc, i64_ty);
+}
+
 struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
                           public LoadStoreConversionBase {
   LoadOpConversion(LLVMTypeConverter &converter,
                    const NVIDIA::TargetInfo &targetInfo,
                    ModuleAxisInfoAnalysis &axisAnalysisPass,
-                   PatternBenefit benefit)
+                   bool l2EvictionHints, PatternBenefit benefit)
       : ConvertOpToLLVMPattern<triton::LoadOp>(converter, benefit),
-        LoadStoreConversionBase(targetInfo, axisAnalysisPass) {}
+        LoadStoreConversionBase(targetInfo, axisAnalysisPass),
+        l2EvictionHints(l2EvictionHints) {}
 
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
@@ -160,6 +181,8 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     Value llPtr = adaptor.getPtr();
     Value llMask = adaptor.getMask();
     Value llOther = adaptor.getOther();
+    if (mask && isMaskAlwaysTrue(mask))
+      mask = other = llMask = llOther = Value();
 
     // Determine the vectorization size
     Type valueElemTy =
@@ -209,6 +232,13 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     LDBG("LoadOp numElems = " << numElems << " vec = " << vec
                               << " valueElemNBits = " << valueElemNBits << " "
                               << op.getType());
+    // With eviction_hints, the hints also apply to L2 from sm_80, so that the
+    // streamed data doesn't evict the data reused by other programs.
+    Value l2Policy;
+    if (l2EvictionHints && op.getEvict() != triton::EvictionPolicy::NORMAL &&
+        targetInfo.getComputeCapability() >= 80)
+      l2Policy = createL2EvictPolicy(rewriter, loc, op.getEvict());
+
     SmallVector<Value> loadedVals;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
       // TODO: optimization when ptr is GEP with constant offset
@@ -223,8 +253,7 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
       assert(wordNElems * nWords * numVecs == numElems);
 
       // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
+      const bool hasL2EvictPolicy = static_cast<bool>(l2Policy);
 
       PTXBuilder ptxBuilder;
 
@@ -256,15 +285,13 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
                         op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
                      .o("L1::evict_last",
                         op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
+                     .o("L2::cache_hint", hasL2EvictPolicy)
                      .v(nWords)
                      .b(width);
 
       PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
+      if (hasL2EvictPolicy)
+        evictOpr = ptxBuilder.newOperand(l2Policy, "l");
 
       if (!evictOpr)
         ld(dstsOpr, addrOpr).predicate(pred, "b");
@@ -342,6 +369,9 @@ struct LoadOpConversion : public ConvertOpToLLVMPattern<triton::LoadOp>,
     rewriter.replaceOp(op, {resultStruct});
     return success();
   }
+
+private:
+  bool l2EvictionHints;
 };
 
 struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
@@ -362,6 +392,8 @@ struct StoreOpConversion : public ConvertOpToLLVMPattern<triton::StoreOp>,
     Value llPtr = adaptor.getPtr();
     Value llMask = adaptor.getMask();
     Value llValue = adaptor.getValue();
+    if (llMask && isMaskAlwaysTrue(op.getMask()))
+      llMask = Value();
 
     auto loc = op->getLoc();
     MLIRContext *ctx = rewriter.getContext();
@@ -641,35 +673,71 @@ struct AtomicRMWOpConversion
     // tensor
     if (tensorTy) {
       auto valTy = cast<RankedTensorType>(val.getType());
-      vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      Type elemTy = valTy.getElementType();
+      if (llMask)
+        vec = std::min<unsigned>(vec, getMaskAlignment(op.getMask()));
+      // sm90 adds vectors of floats of up to 128 bits, e.g. with
+      // red.add.v4.f32, before that only pairs of f16 are added together.
+      bool vectorized = targetInfo.getComputeCapability() >= 90 &&
+                        atomicRmwAttr == RMWOp::FADD &&
+                        (elemTy.isF32() || elemTy.isF16() || elemTy.isBF16());
+      if (!vectorized)
+        vec = std::min<unsigned>(vec, elemTy.isF16() ? 2 : 1);
       // mask
       numElems = tensorTy.getNumElements();
     }
     Value mask = redundantDataMask(valueTy, rewriter, loc, targetInfo);
 
-    auto vecTy = vec_ty(valueElemTy, vec);
+    // The updates whose result is unused don't wait for it with red, which
+    // has no acquiring semantics and no exchange.
+    auto sem = op.getSem();
+    bool useRed = op->use_empty() && atomicRmwAttr != RMWOp::XCHG &&
+                  (sem == MemSemantic::RELAXED || sem == MemSemantic::RELEASE);
+
+    // 16-bit elements are added in pairs, e.g. with f16x2, and the pairs or
+    // wider elements in vectors of up to 4 registers.
+    const unsigned packed = valueElemNBits == 16 && vec > 1 ? 2 : 1;
+    const unsigned numRegs = vec / packed;
+    const unsigned regNBits = valueElemNBits * packed;
+    std::string tyId = regNBits == 64 ? "l" : (regNBits == 32 ? "r" : "h");
+    auto regTy = vec_ty(valueElemTy, packed);
     SmallVector<Value> resultVals(elemsPerThread);
     for (size_t i = 0; i < elemsPerThread; i += vec) {
-      Value rmwVal = undef(vecTy);
+      SmallVector<Value> rmwVals(numRegs, undef(regTy));
       for (int ii = 0; ii < vec; ++ii) {
         Value iiVal = createIndexAttrConstant(
-            rewriter, loc, getTypeConverter()->getIndexType(), ii);
-        rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
+            rewriter, loc, getTypeConverter()->getIndexType(), ii % packed);
+        Value &rmwVal = rmwVals[ii / packed];
+        rmwVal = insert_element(regTy, rmwVal, valElements[i + ii], iiVal);
       }
 
       Value rmwPtr = ptrElements[i];
       Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
       std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
-      std::string tyId = valueElemNBits * vec == 64
-                             ? "l"
-                             : (valueElemNBits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
+      PTXBuilder::Operand *dstOpr = nullptr;
+      if (!useRed && numRegs == 1) {
+        dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
+      } else if (!useRed) {
+        dstOpr = ptxBuilderAtomicRMW.newListOperand();
+        for (unsigned r = 0; r < numRegs; ++r)
+          dstOpr->listAppend(
+              ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true));
+      }
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
-      auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
+      PTXBuilder::Operand *valOpr;
+      if (numRegs == 1) {
+        valOpr = ptxBuilderAtomicRMW.newOperand(rmwVals[0], tyId);
+      } else {
+        valOpr = ptxBuilderAtomicRMW.newListOperand();
+        for (Value rmwVal : rmwVals)
+          valOpr->listAppend(ptxBuilderAtomicRMW.newOperand(rmwVal, tyId));
+      }
 
       auto scope = stringifyMemSyncScope(op.getScope()).str();
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o(scope);
+      auto &atom = ptxBuilderAtomicRMW.create<>(useRed ? "red" : "atom")
+                       ->global()
+                       .o(scope);
       auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
       auto sBits = std::to_string(valueElemNBits);
       switch (atomicRmwAttr) {
@@ -688,8 +756,8 @@ struct AtomicRMWOpConversion
       case RMWOp::FADD:
         rmwOp = "add";
         rmwOp += (valueElemNBits == 16 ? ".noftz" : "");
-        sTy = "f" + sBits;
-        sTy += (vec == 2 && valueElemNBits == 16) ? "x2" : "";
+        sTy = (valueElemTy.isBF16() ? "bf" : "f") + sBits;
+        sTy += packed == 2 ? "x2" : "";
         break;
       case RMWOp::MAX:
         sTy = "s" + sBits;
@@ -713,18 +781,26 @@ struct AtomicRMWOpConversion
       }
       std::string semStr;
       llvm::raw_string_ostream os(semStr);
-      os << op.getSem();
-      atom.o(semStr).o(rmwOp).o(sTy);
-      if (tensorTy) {
+      os << sem;
+      atom.o(semStr).o(rmwOp).v(numRegs).o(sTy);
+      if (useRed) {
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+      } else if (tensorTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
-        auto retType = vec == 1 ? valueElemTy : vecTy;
+        SmallVector<Type> retTys(numRegs, packed == 1 ? valueElemTy : regTy);
+        Type retType = numRegs > 1
+                           ? LLVM::LLVMStructType::getLiteral(ctx, retTys)
+                           : retTys[0];
         auto ret = ptxBuilderAtomicRMW.launch(rewriter, loc, retType);
         for (int ii = 0; ii < vec; ++ii) {
+          Value reg = numRegs > 1 ? extract_val(retTys[0], ret, ii / packed)
+                                  : ret;
           resultVals[i + ii] =
-              vec == 1 ? ret : extract_element(valueElemTy, ret, i32_val(ii));
+              packed == 1 ? reg
+                          : extract_element(valueElemTy, reg, i32_val(ii % 2));
         }
       } else {
-        auto ASMReturnTy = void_ty(ctx);
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto old = ptxBuilderAtomicRMW.launch(rewriter, loc, valueElemTy);
         if (op->user_begin() == op->user_end()) {
@@ -748,6 +824,13 @@ struct AtomicRMWOpConversion
         rewriter.replaceOp(op, {ret});
       }
     }
+    if (useRed) {
+      // The result is unused, so nothing reads the undefined values.
+      Type resultTy = tensorTy ? getTypeConverter()->convertType(tensorTy)
+                               : valueElemTy;
+      rewriter.replaceOp(op, undef(resultTy));
+      return success();
+    }
     if (tensorTy) {
       Type structTy = getTypeConverter()->convertType(tensorTy);
       Value resultStruct = packLLElements(loc, getTypeConverter(), resultVals,
@@ -909,7 +992,10 @@ struct AsyncCopyGlobalToLocalOpConversion
 struct AsyncTMACopyGlobalToLocalOpConversion
     : public ConvertOpToLLVMPattern<
           triton::nvidia_gpu::AsyncTMACopyGlobalToLocalOp> {
-  using ConvertOpToLLVMPattern::ConvertOpToLLVMPattern;
+  AsyncTMACopyGlobalToLocalOpConversion(LLVMTypeConverter &converter,
+                                        const NVIDIA::TargetInfo &targetInfo,
+                                        PatternBenefit benefit)
+      : ConvertOpToLLVMPattern(converter, benefit), targetInfo(targetInfo) {}
 
   LogicalResult
   matchAndRewrite(triton::nvidia_gpu::AsyncTMACopyGlobalToLocalOp op,
@@ -933,6 +1019,10 @@ struct AsyncTMACopyGlobalToLocalOpConversion
 
     auto mod = op->getParentOfType<ModuleOp>();
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    // The copies of warp-specialized kernels are issued by the producer warps.
+    if (int numProducerWarps =
+            triton::gpu::TritonGPUDialect::getNumProducerWarps(mod))
+      numWarps = std::min(numWarps, numProducerWarps);
     int warpSize = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
     Value warpID = udiv(id, i32_val(warpSize));
     warpID = LLVM::NVIDIA::shuffleIdx(loc, rewriter, warpID, 0);
@@ -941,6 +1031,23 @@ struct AsyncTMACopyGlobalToLocalOpConversion
     // figure out that the op is uniform.
     pred = and_(pred, LLVM::NVIDIA::createElectPredicate(loc, rewriter));
 
+    // A buffer that every CTA of the cluster holds in full is fetched once by
+    // the first CTA and multicast to the others. Each CTA still expects the
+    // whole tile on its own barrier, since the copy completes on the barrier
+    // at the same offset in every destination CTA.
+    auto CTALayout = getCTALayout(op.getResult().getType().getEncoding());
+    unsigned numCTAs = product<unsigned>(CTALayout.getCTAsPerCGA());
+    bool multicast =
+        numCTAs > 1 && llvm::all_of(CTALayout.getCTASplitNum(),
+                                    [](unsigned n) { return n == 1; });
+    if (multicast) {
+      // The peers must have initialized their barrier and be done reading the
+      // previous contents of the buffer before the copy overwrites it.
+      createBarrier(rewriter, loc, numCTAs);
+      Value clusterCTAId = targetInfo.getClusterCTAId(rewriter, loc);
+      pred = and_(pred, icmp_eq(clusterCTAId, i32_val(0)));
+    }
+
     int elementSizeInBytes =
         op.getResult().getType().getElementType().getIntOrFloatBitWidth() / 8;
     int totalNumElements = product(op.getResult().getType().getShape());
@@ -950,8 +1057,11 @@ struct AsyncTMACopyGlobalToLocalOpConversion
     int contigDimSizeInByte = innerBlockSize * elementSizeInBytes;
     int numCopies = 1;
     int rank = op.getCoord().size();
-    if (rank > 1)
+    // Only 2D buffers are swizzled, including the pixels by channels of the
+    // im2col copies.
+    if (op.getResult().getType().getRank() == 2)
       numCopies = ceil<int>(contigDimSizeInByte, 128);
+    bool im2col = !op.getIm2colOffsets().empty();
 
     // The bounding box inner dimension must be less than or equal to the
     // swizzle size.
@@ -977,7 +1087,9 @@ struct AsyncTMACopyGlobalToLocalOpConversion
           ptxBuilderTMA.newOperand(adaptor.getDescPtr(), "l")};
       std::string tmaInst =
           "@$0 cp.async.bulk.tensor." + std::to_string(rank) +
-          "d.shared::cluster.global.mbarrier::complete_tx::bytes [$1], [$2, {";
+          "d.shared::cluster.global" + (im2col ? ".im2col" : "") +
+          ".mbarrier::complete_tx::bytes" +
+          (multicast ? ".multicast::cluster" : "") + " [$1], [$2, {";
       int operandIdx = 3;
       for (int i = 0; i < rank; i++) {
         Value coord = adaptor.getCoord()[rank - i - 1];
@@ -992,7 +1104,27 @@ struct AsyncTMACopyGlobalToLocalOpConversion
       }
       operands.push_back(
           ptxBuilderTMA.newOperand(barrierMemObj.getBase(), "r"));
-      tmaInst += "}], [$" + std::to_string(operandIdx++) + "];";
+      tmaInst += "}], [$" + std::to_string(operandIdx++) + "]";
+      if (im2col) {
+        // The offsets are given innermost spatial dim first, like the
+        // coordinates.
+        auto offsets = adaptor.getIm2colOffsets();
+        tmaInst += ", {";
+        for (size_t i = 0; i < offsets.size(); i++) {
+          Value offset = offsets[offsets.size() - i - 1];
+          operands.push_back(ptxBuilderTMA.newOperand(offset, "h"));
+          tmaInst += "$" + std::to_string(operandIdx++);
+          if (i != offsets.size() - 1)
+            tmaInst += ", ";
+        }
+        tmaInst += "}";
+      }
+      if (multicast) {
+        Value ctaMask = int_val(16, (1u << numCTAs) - 1);
+        operands.push_back(ptxBuilderTMA.newOperand(ctaMask, "h"));
+        tmaInst += ", $" + std::to_string(operandIdx++);
+      }
+      tmaInst += ";";
       auto &tma = *ptxBuilderTMA.create<>(tmaInst);
       tma(operands, /*onlyAttachMLIRArgs=*/true);
       ptxBuilderTMA.launch(rewriter, loc, voidTy);
@@ -1000,6 +1132,9 @@ struct AsyncTMACopyGlobalToLocalOpConversion
     rewriter.eraseOp(op);
     return success();
   }
+
+private:
+  const NVIDIA::TargetInfo &targetInfo;
 };
 
 struct AsyncTMACopyLocalToGlobalOpConversion
@@ -1035,7 +1170,8 @@ struct AsyncTMACopyLocalToGlobalOpConversion
     int contigDimSizeInByte = innerBlockSize * elementSizeInBytes;
     int numCopies = 1;
     int rank = op.getCoord().size();
-    if (rank > 1)
+    // Only 2D buffers are swizzled.
+    if (rank == 2)
       numCopies = ceil<int>(contigDimSizeInByte, 128);
 
     // The bounding box inner dimension must be less than or equal to the
@@ -1059,8 +1195,15 @@ struct AsyncTMACopyLocalToGlobalOpConversion
       SmallVector<PTXBuilder::Operand *> operands = {
           ptxBuilderTMA.newOperand(boxPred, "b"),
           ptxBuilderTMA.newOperand(adaptor.getDescPtr(), "l")};
-      std::string tmaInst = "@$0 cp.async.bulk.tensor." + std::to_string(rank) +
-                            "d.global.shared::cta.bulk_group [$1, {";
+      std::string tmaInst;
+      if (auto reduceKind = op.getReduceKind())
+        tmaInst = "@$0 cp.reduce.async.bulk.tensor." + std::to_string(rank) +
+                  "d.global.shared::cta." +
+                  stringifyDescriptorReduceKind(*reduceKind).str() +
+                  ".tile.bulk_group [$1, {";
+      else
+        tmaInst = "@$0 cp.async.bulk.tensor." + std::to_string(rank) +
+                  "d.global.shared::cta.bulk_group [$1, {";
       int operandIdx = 2;
       for (int i = 0; i < rank; i++) {
         Value coord = adaptor.getCoord()[rank - i - 1];
@@ -1167,13 +1310,16 @@ struct TMAStoreWaitConversion
 void mlir::triton::NVIDIA::populateLoadStoreOpToLLVMPatterns(
     LLVMTypeConverter &typeConverter, const TargetInfo &targetInfo,
     RewritePatternSet &patterns, ModuleAxisInfoAnalysis &axisInfoAnalysis,
-    PatternBenefit benefit) {
+    bool l2EvictionHints, PatternBenefit benefit) {
   patterns.add<AsyncCopyGlobalToLocalOpConversion, AtomicCASOpConversion,
-               AtomicRMWOpConversion, LoadOpConversion, StoreOpConversion>(
+               AtomicRMWOpConversion, StoreOpConversion>(
       typeConverter, targetInfo, axisInfoAnalysis, benefit);
+  patterns.add<LoadOpConversion>(typeConverter, targetInfo, axisInfoAnalysis,
+                                 l2EvictionHints, benefit);
   patterns.add<AsyncCommitGroupOpConversion>(typeConverter, benefit);
   patterns.add<AsyncWaitOpConversion>(typeConverter, benefit);
-  patterns.add<AsyncTMACopyGlobalToLocalOpConversion,
-               AsyncTMACopyLocalToGlobalOpConversion, TMAStoreWaitConversion>(
+  patterns.add<AsyncTMACopyGlobalToLocalOpConversion>(typeConverter,
+                                                      targetInfo, benefit);
+  patterns.add<AsyncTMACopyLocalToGlobalOpConversion, TMAStoreWaitConversion>(
       typeConverter, benefit);
 }
@@ -15,6 +15,7 @@ void populateBarrierOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
                                      PatternBenefit benefit);
 
 void populateClusterOpsToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                      const TargetInfo &targetInfo,
                                       RewritePatternSet &patterns,
                                       PatternBenefit benefit);
 
@@ -40,6 +41,7 @@ void populateLoadStoreOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
                                        const TargetInfo &targetInfo,
                                        RewritePatternSet &patterns,
                                        ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                       bool l2EvictionHints,
                                        PatternBenefit benefit);
 
 void populateTensorPtrOpsToLLVMPatterns(LLVMTypeConverter &typeConverter,
@@ -48,7 +50,15 @@ void populateTensorPtrOpsToLLVMPatterns(LLVMTypeConverter &typeConverter,
 
 void populateSPMDOpToLLVMPattern(LLVMTypeConverter &typeConverter,
                                  RewritePatternSet &patterns,
-                                 PatternBenefit benefit);
+                                 int computeCapability, PatternBenefit benefit);
+
+// Lowers f32 math to the approximate PTX instructions, see the accuracy of
+// each op in ElementwiseOpToLLVM.cpp.
+void populateFastMathOpToLLVMPatterns(LLVMTypeConverter &typeConverter,
+                                      RewritePatternSet &patterns,
+                                      ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                      int computeCapability,
+                                      PatternBenefit benefit);
 
 void populateClampFOpToLLVMPattern(LLVMTypeConverter &typeConverter,
                                    RewritePatternSet &patterns,
@@ -1,4 +1,5 @@
 #include "PatternTritonGPUOpToLLVM.h"
+#include "TritonNVIDIAGPUToLLVM/PTXAsmFormat.h"
 #include "Utility.h"
 
 namespace {
@@ -33,10 +34,154 @@ struct GetNumProgramsOpConversion
   }
 };
 
+// Loads the flag at `ptr` with acquire semantics at `scope`.
+Value loadAcquire(ConversionPatternRewriter &rewriter, Location loc, Value ptr,
+                  MemSyncScope scope) {
+  PTXBuilder builder;
+  auto &ld = *builder.create<>("ld");
+  ld.o("acquire").o(stringifyMemSyncScope(scope).str()).global().o("u32");
+  ld(builder.newOperand("=r"), builder.newAddrOperand(ptr, "l"));
+  return builder.launch(rewriter, loc, i32_ty);
+}
+
+// The first thread of each CTA adds the arrival of the CTA to the counter and
+// spins until the counter reaches the next multiple of the number of CTAs, so
+// that the counter never has to be reset between syncs. The release of the
+// add and the acquire of the loads order the memory accesses of the CTAs,
+// which the CTA barriers around them extend to all their threads.
+struct GridSyncOpConversion
+    : public ConvertOpToLLVMPattern<triton::GridSyncOp> {
+  using ConvertOpToLLVMPattern<triton::GridSyncOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GridSyncOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    Value ptr = adaptor.getBarrier();
+    // #prev:   barrier; if (tid == 0) goto #arrive; else goto #end
+    // #arrive: target = (atom.add(ptr, 1) / numCTAs + 1) * numCTAs
+    // #spin:   if (ld(ptr) < target) goto #spin; else goto #end
+    // #end:    barrier
+    Block *prevBlock = op->getBlock();
+    Block *endBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *arriveBlock = rewriter.createBlock(endBlock);
+    Block *spinBlock = rewriter.createBlock(endBlock, {i32_ty}, {loc});
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    barrier();
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    rewriter.create<LLVM::CondBrOp>(loc, isLeader, arriveBlock, endBlock);
+
+    rewriter.setInsertionPointToStart(arriveBlock);
+    Value numCTAs = i32_val(1);
+    for (const char *sreg : {"%nctaid.x", "%nctaid.y", "%nctaid.z"})
+      numCTAs = mul(numCTAs, LLVM::NVIDIA::getSRegValue(rewriter, loc, sreg));
+    PTXBuilder arriveBuilder;
+    auto &atom = *arriveBuilder.create<>("atom");
+    atom.o("release").o("gpu").global().o("add").o("u32");
+    atom(arriveBuilder.newOperand("=r"), arriveBuilder.newAddrOperand(ptr, "l"),
+         arriveBuilder.newOperand(i32_val(1), "r"));
+    Value old = arriveBuilder.launch(rewriter, loc, i32_ty);
+    Value target = mul(add(udiv(old, numCTAs), i32_val(1)), numCTAs);
+    rewriter.create<LLVM::BrOp>(loc, target, spinBlock);
+
+    rewriter.setInsertionPointToStart(spinBlock);
+    Value count = loadAcquire(rewriter, loc, ptr, MemSyncScope::GPU);
+    target = spinBlock->getArgument(0);
+    rewriter.create<LLVM::CondBrOp>(loc, icmp_ult(count, target), spinBlock,
+                                    ValueRange{target}, endBlock,
+                                    ValueRange{});
+
+    rewriter.setInsertionPointToStart(endBlock);
+    barrier();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+// The first thread of the CTA polls the flag, and the others wait for it at a
+// barrier, which extends the acquire of its loads to them.
+struct SignalWaitOpConversion
+    : public ConvertOpToLLVMPattern<triton::SignalWaitOp> {
+  using ConvertOpToLLVMPattern<triton::SignalWaitOp>::ConvertOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SignalWaitOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    // #prev: if (tid == 0) goto #spin; else goto #end
+    // #spin: if (!cmp(ld(flag), value)) goto #spin; else goto #end
+    // #end:  barrier
+    Block *prevBlock = op->getBlock();
+    Block *endBlock = rewriter.splitBlock(prevBlock, op->getIterator());
+    Block *spinBlock = rewriter.createBlock(endBlock);
+
+    rewriter.setInsertionPointToEnd(prevBlock);
+    Value isLeader = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    rewriter.create<LLVM::CondBrOp>(loc, isLeader, spinBlock, endBlock);
+
+    rewriter.setInsertionPointToStart(spinBlock);
+    Value flag = loadAcquire(rewriter, loc, adaptor.getFlag(), op.getScope());
+    Value value = adaptor.getValue();
+    Value done;
+    switch (op.getCmp()) {
+    case SignalWaitCmp::EQ:
+      done = icmp_eq(flag, value);
+      break;
+    case SignalWaitCmp::NE:
+      done = icmp_ne(flag, value);
+      break;
+    case SignalWaitCmp::GE:
+      done = icmp_uge(flag, value);
+      break;
+    }
+    rewriter.create<LLVM::CondBrOp>(loc, done, endBlock, spinBlock);
+
+    rewriter.setInsertionPointToStart(endBlock);
+    barrier();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+// Lowers the grid dependency ops to griddepcontrol, which Hopper introduced
+// for programmatic dependent launches. The ops order nothing without such a
+// launch, so they are dropped on the earlier GPUs.
+template <typename SourceOp>
+struct GridDepControlOpConversion : public ConvertOpToLLVMPattern<SourceOp> {
+  GridDepControlOpConversion(LLVMTypeConverter &typeConverter,
+                             const char *control, int computeCapability,
+                             PatternBenefit benefit)
+      : ConvertOpToLLVMPattern<SourceOp>(typeConverter, benefit),
+        control(control), computeCapability(computeCapability) {}
+
+  LogicalResult
+  matchAndRewrite(SourceOp op, typename SourceOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (computeCapability >= 90) {
+      PTXBuilder builder;
+      auto &griddepcontrol = *builder.create<>("griddepcontrol");
+      griddepcontrol.o(control)();
+      builder.launch(rewriter, op->getLoc(), void_ty(op->getContext()));
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+private:
+  const char *control;
+  int computeCapability;
+};
+
 } // namespace
 
 void mlir::triton::NVIDIA::populateSPMDOpToLLVMPattern(
     LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
-    PatternBenefit benefit) {
-  patterns.add<GetNumProgramsOpConversion>(typeConverter, benefit);
+    int computeCapability, PatternBenefit benefit) {
+  patterns.add<GetNumProgramsOpConversion, GridSyncOpConversion,
+               SignalWaitOpConversion>(typeConverter, benefit);
+  patterns.add<GridDepControlOpConversion<triton::GridDepWaitOp>>(
+      typeConverter, "wait", computeCapability, benefit);
+  patterns.add<GridDepControlOpConversion<triton::GridDepLaunchDependentsOp>>(
+      typeConverter, "launch_dependents", computeCapability, benefit);
 }
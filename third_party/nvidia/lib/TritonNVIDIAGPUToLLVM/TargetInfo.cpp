@@ -205,8 +205,10 @@ LLVM::LLVMFuncOp getAssertfailDeclaration(RewriterBase &rewriter) {
   auto funcOp = rewriter.create<LLVM::LLVMFuncOp>(UnknownLoc::get(ctx),
                                                   funcName, funcType);
 
+  // Cold keeps the failure paths out of the way of the code of the kernel
   funcOp.setPassthroughAttr(
-      ArrayAttr::get(ctx, StringAttr::get(ctx, "noreturn")));
+      ArrayAttr::get(ctx, {StringAttr::get(ctx, "noreturn"),
+                           StringAttr::get(ctx, "cold")}));
   return funcOp;
 }
 } // namespace
@@ -266,6 +268,11 @@ Value TargetInfo::ballot(RewriterBase &rewriter, Location loc, Type type,
   return rewriter.create<NVVM::VoteBallotOp>(loc, type, threadMask, cmp);
 }
 
+void TargetInfo::clusterBarrier(RewriterBase &rewriter, Location loc) const {
+  rewriter.create<triton::nvgpu::ClusterArriveOp>(loc, /*relaxed=*/false);
+  rewriter.create<triton::nvgpu::ClusterWaitOp>(loc);
+}
+
 static Value mapa(RewriterBase &rewriter, Location loc, Value ptr, Value ctaid,
                   Value pred) {
   PTXBuilder builder;
@@ -331,7 +338,7 @@ void TargetInfo::storeDShared(RewriterBase &rewriter, Location loc, Value ptr,
 
   PTXBuilder builder;
   auto st = builder.create<>("st")
-                ->o("shared::cta", ctaId.has_value())
+                ->o("shared::cluster", ctaId.has_value())
                 .o("shared", !ctaId.has_value())
                 .b(bitwidth)
                 .v(vec, /*predicate=*/vec > 1);
@@ -387,7 +394,7 @@ Value TargetInfo::loadDShared(RewriterBase &rewriter, Location loc, Value ptr,
 
   PTXBuilder builder;
   auto ld = builder.create<>("ld")
-                ->o("shared::cta", ctaId.has_value())
+                ->o("shared::cluster", ctaId.has_value())
                 .o("shared", !ctaId.has_value())
                 .b(bitwidth)
                 .v(vec, /*predicate=*/vec > 1);
@@ -502,6 +509,77 @@ bool TargetInfo::processReplicaUsingStMatrix(
   return false;
 }
 
+std::optional<SmallVector<Value>> TargetInfo::loadMatricesFromShared(
+    RewriterBase &rewriter, Location loc, RankedTensorType registerTy,
+    MemDescType sharedTy, Type elemLlvmTy, Value shmemBase,
+    ArrayRef<Value> shmemStrides) const {
+  // ldmatrix was added in sm_75.
+  if (computeCapability < 75)
+    return std::nullopt;
+  MLIRContext *ctx = rewriter.getContext();
+  SmallVector<Value> vals;
+  bool success = emitTransferBetweenRegistersAndSharedWithMatrices(
+      registerTy, sharedTy, elemLlvmTy, shmemBase, shmemStrides, loc, rewriter,
+      [&](int numMatrices, bool trans, ArrayRef<int> regs, Value shmemAddr) {
+        PTXBuilder builder;
+        auto resArgs = builder.newListOperand(numMatrices, "=r");
+        auto addrArg = builder.newAddrOperand(shmemAddr, "r");
+        auto ldmatrix = builder.create("ldmatrix.sync.aligned.m8n8")
+                             ->o("x" + std::to_string(numMatrices))
+                             .o("trans", trans)
+                             .o("shared.b16");
+        ldmatrix(resArgs, addrArg);
+        Type resTy = numMatrices == 1
+                         ? i32_ty
+                         : struct_ty(SmallVector<Type>(numMatrices, i32_ty));
+        Value res = builder.launch(rewriter, loc, resTy);
+
+        int elemsPerReg = regs.size() / numMatrices;
+        auto vecTy = vec_ty(elemLlvmTy, elemsPerReg);
+        for (int matrix = 0; matrix < numMatrices; matrix++) {
+          Value reg =
+              numMatrices == 1 ? res : extract_val(i32_ty, res, matrix);
+          Value vec = bitcast(reg, vecTy);
+          for (int elem = 0; elem < elemsPerReg; elem++) {
+            int idx = regs[matrix * elemsPerReg + elem];
+            if (idx >= vals.size())
+              vals.resize(idx + 1);
+            vals[idx] = extract_element(elemLlvmTy, vec, i32_val(elem));
+          }
+        }
+      });
+  if (!success)
+    return std::nullopt;
+  return vals;
+}
+
+bool TargetInfo::storeMatricesToShared(
+    RewriterBase &rewriter, Location loc, RankedTensorType registerTy,
+    MemDescType sharedTy, Type elemLlvmTy, ArrayRef<Value> vals,
+    Value shmemBase, ArrayRef<Value> shmemStrides) const {
+  // stmatrix was added in sm_90.
+  if (computeCapability < 90)
+    return false;
+  return emitTransferBetweenRegistersAndSharedWithMatrices(
+      registerTy, sharedTy, elemLlvmTy, shmemBase, shmemStrides, loc, rewriter,
+      [&](int numMatrices, bool trans, ArrayRef<int> regs, Value shmemAddr) {
+        int elemsPerReg = regs.size() / numMatrices;
+        auto vecTy = vec_ty(elemLlvmTy, elemsPerReg);
+        SmallVector<Value> inputs;
+        for (int matrix = 0; matrix < numMatrices; matrix++) {
+          Value vec = undef(vecTy);
+          for (int elem = 0; elem < elemsPerReg; elem++) {
+            vec = insert_element(vecTy, vec,
+                                 vals[regs[matrix * elemsPerReg + elem]],
+                                 i32_val(elem));
+          }
+          inputs.push_back(bitcast(vec, i32_ty));
+        }
+        rewriter.create<triton::nvgpu::StoreMatrixOp>(loc, shmemAddr, inputs,
+                                                      trans);
+      });
+}
+
 std::string TargetInfo::getMulhiFuncName(Type resultElementTy) const {
   std::string funcName =
       resultElementTy.isInteger(32) ? "__nv_umulhi" : "__nv_umul64hi";
@@ -7,7 +7,19 @@ namespace mlir::triton::NVIDIA {
 
 class TargetInfo : public mlir::triton::TargetInfoBase {
 public:
-  TargetInfo(int computeCapability) : computeCapability(computeCapability) {}
+  TargetInfo(int computeCapability, int ptxVersion = 0,
+             bool archSpecific = false)
+      : computeCapability(computeCapability), ptxVersion(ptxVersion),
+        archSpecific(archSpecific) {}
+
+  int getComputeCapability() const { return computeCapability; }
+
+  // 0 if the PTX version of the target is unknown
+  int getPtxVersion() const { return ptxVersion; }
+
+  // Whether the target is e.g. sm_100a rather than sm_100, which the
+  // architecture-specific instructions require
+  bool isArchSpecific() const { return archSpecific; }
 
   bool supportMaximumMinimum() const override;
 
@@ -16,6 +28,8 @@ public:
   Value ballot(RewriterBase &rewriter, Location loc, Type type,
                Value cmp) const override;
 
+  void clusterBarrier(RewriterBase &rewriter, Location loc) const override;
+
   void storeDShared(RewriterBase &rewriter, Location loc, Value ptr,
                     std::optional<Value> ctaId, Value val,
                     Value pred) const override;
@@ -48,6 +62,17 @@ public:
                                    unsigned accumNumReplicates,
                                    int swizzleByteWidth) const override;
 
+  std::optional<SmallVector<Value>>
+  loadMatricesFromShared(RewriterBase &rewriter, Location loc,
+                         RankedTensorType registerTy, MemDescType sharedTy,
+                         Type elemLlvmTy, Value shmemBase,
+                         ArrayRef<Value> shmemStrides) const override;
+  bool storeMatricesToShared(RewriterBase &rewriter, Location loc,
+                             RankedTensorType registerTy, MemDescType sharedTy,
+                             Type elemLlvmTy, ArrayRef<Value> vals,
+                             Value shmemBase,
+                             ArrayRef<Value> shmemStrides) const override;
+
   std::string getMulhiFuncName(Type resultElementTy) const override;
 
   void printf(RewriterBase &rewriter, Value formatStrStart,
@@ -57,6 +82,8 @@ public:
 
 private:
   int computeCapability;
+  int ptxVersion;
+  bool archSpecific;
 };
 
 } // namespace mlir::triton::NVIDIA
@@ -95,9 +95,11 @@ struct ConvertTritonGPUToLLVM
     int numCTAs = triton::gpu::TritonGPUDialect::getNumCTAs(mod);
     int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
 
-    // Allocate shared memory and set barrier
+    // Allocate shared memory and set barrier. Accesses to different stages of
+    // the multi-buffered allocations of the pipeliner don't need barriers.
     ModuleAllocation allocation(mod);
-    ModuleMembarAnalysis membarPass(&allocation);
+    ModuleMembarAnalysis membarPass(&allocation, /*precise=*/true,
+                                    /*namedBarriers=*/true);
     membarPass.run();
 
     // Lower functions
@@ -106,8 +108,11 @@ struct ConvertTritonGPUToLLVM
       TritonGPUToLLVMTypeConverter typeConverter(context, option);
       TritonLLVMFunctionConversionTarget funcTarget(*context);
       RewritePatternSet funcPatterns(context);
+      // The producer warps of warp-specialized kernels are launched too.
+      int numLaunchedWarps =
+          numWarps + triton::gpu::TritonGPUDialect::getNumProducerWarps(mod);
       mlir::triton::populateFuncOpConversionPattern(
-          typeConverter, funcPatterns, numWarps, patternBenefitDefault);
+          typeConverter, funcPatterns, numLaunchedWarps, patternBenefitDefault);
       mlir::cf::populateControlFlowToLLVMConversionPatterns(typeConverter,
                                                             funcPatterns);
       if (failed(
@@ -119,11 +124,20 @@ struct ConvertTritonGPUToLLVM
     // because the call op has to know the shared memory base address of each
     // function
     initSharedMemory(typeConverter);
+    if (recordAsserts)
+      mlir::triton::prepareRecordedAsserts(mod);
+    if (binaryPrints) {
+      if (!llvm::isPowerOf2_32(binaryPrintRecords)) {
+        mod.emitError("binary-print-records must be a power of two");
+        return signalPassFailure();
+      }
+      mlir::triton::prepareBinaryPrints(mod, binaryPrintRecords);
+    }
     ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
     OpBuilder::InsertPoint indexInsertPoint;
 
     RewritePatternSet patterns(context);
-    TargetInfo targetInfo(computeCapability);
+    TargetInfo targetInfo(computeCapability, ptxVersion, archSpecific);
     int benefit = patternBenefitPrioritizeOverLLVMConversions;
     mlir::triton::NVIDIA::populateConvertLayoutOpToLLVMOptimizedPatterns(
         typeConverter, targetInfo, patterns,
@@ -137,23 +151,33 @@ struct ConvertTritonGPUToLLVM
     populateClampFOpToLLVMPattern(typeConverter, patterns, axisInfoAnalysis,
                                   computeCapability,
                                   patternBenefitClampOptimizedPattern);
+    if (fastMath)
+      populateFastMathOpToLLVMPatterns(typeConverter, patterns,
+                                       axisInfoAnalysis, computeCapability,
+                                       patternBenefitFastMathPattern);
     populateLoadStoreOpToLLVMPatterns(typeConverter, targetInfo, patterns,
-                                      axisInfoAnalysis, benefit);
+                                      axisInfoAnalysis, l2EvictionHints,
+                                      benefit);
     mlir::triton::populateReduceOpToLLVMPatterns(typeConverter, patterns,
                                                  targetInfo, benefit);
     mlir::triton::populateScanOpToLLVMPatterns(typeConverter, patterns,
                                                targetInfo, benefit);
     populateBarrierOpToLLVMPatterns(typeConverter, patterns, benefit);
     populateTensorPtrOpsToLLVMPatterns(typeConverter, patterns, benefit);
-    populateClusterOpsToLLVMPatterns(typeConverter, patterns, benefit);
+    populateClusterOpsToLLVMPatterns(typeConverter, targetInfo, patterns,
+                                     benefit);
     mlir::triton::populateHistogramOpToLLVMPatterns(typeConverter, patterns,
                                                     targetInfo, benefit);
+    mlir::triton::populateSortOpToLLVMPatterns(typeConverter, patterns,
+                                               targetInfo, benefit);
+    mlir::triton::populateGatherOpToLLVMPatterns(typeConverter, patterns,
+                                                 targetInfo, benefit);
     mlir::triton::populatePrintOpToLLVMPattern(typeConverter, patterns,
                                                targetInfo, benefit);
     mlir::triton::populateControlFlowOpToLLVMPattern(typeConverter, patterns,
                                                      benefit);
-    mlir::triton::NVIDIA::populateSPMDOpToLLVMPattern(typeConverter, patterns,
-                                                      benefit);
+    mlir::triton::NVIDIA::populateSPMDOpToLLVMPattern(
+        typeConverter, patterns, computeCapability, benefit);
     mlir::triton::populateSPMDOpToLLVMPattern(typeConverter, patterns,
                                               targetInfo, benefit);
     // TODO(thomas): this should probably be done in a separate step to not
@@ -183,6 +207,12 @@ struct ConvertTritonGPUToLLVM
         id.replaceAllUsesWith(zero);
       });
     }
+
+    if (packKernelArgs) {
+      for (auto funcOp : mod.getOps<LLVM::LLVMFuncOp>())
+        if (funcOp->hasAttr("nvvm.kernel"))
+          packKernelArguments(funcOp);
+    }
   }
 
 private:
@@ -205,6 +235,86 @@ private:
         static_cast<unsigned>(NVVM::NVVMMemorySpace::kSharedMemorySpace));
   }
 
+  // Size and alignment of the TMA descriptors, CUtensorMap in the driver API.
+  static constexpr int64_t kTmaDescriptorBytes = 128;
+  static constexpr int64_t kTmaDescriptorAlign = 64;
+
+  static int64_t getSizeInBytes(Value arg) {
+    Type type = arg.getType();
+    if (isa<LLVM::LLVMPointerType>(type))
+      return 8;
+    return llvm::divideCeil(type.getIntOrFloatBitWidth(), 8);
+  }
+
+  // Replace the arguments of the kernel with a single struct holding all of
+  // them, passed as a grid constant. The launcher builds the struct as a C
+  // struct with the same fields, so every field is at an offset aligned to its
+  // size, and the TMA descriptors marked `tt.nv_tma_desc` are held in place,
+  // 64-byte aligned, instead of pointing to a copy in global memory.
+  static void packKernelArguments(LLVM::LLVMFuncOp funcOp) {
+    MLIRContext *ctx = funcOp.getContext();
+    Block &entry = funcOp.getBody().front();
+    unsigned numArgs = entry.getNumArguments();
+    if (numArgs == 0)
+      return;
+    Type i8Ty = IntegerType::get(ctx, 8);
+    SmallVector<Type> fieldTys;
+    SmallVector<int32_t> fieldIdxs;
+    SmallVector<bool> isDescriptor;
+    int64_t offset = 0;
+    for (BlockArgument arg : entry.getArguments()) {
+      bool desc = static_cast<bool>(
+          funcOp.getArgAttr(arg.getArgNumber(), "tt.nv_tma_desc"));
+      int64_t size = desc ? kTmaDescriptorBytes : getSizeInBytes(arg);
+      int64_t padding =
+          llvm::alignTo(offset, desc ? kTmaDescriptorAlign : size) - offset;
+      if (padding > 0)
+        fieldTys.push_back(LLVM::LLVMArrayType::get(i8Ty, padding));
+      fieldIdxs.push_back(fieldTys.size());
+      fieldTys.push_back(
+          desc ? LLVM::LLVMArrayType::get(i8Ty, kTmaDescriptorBytes)
+               : arg.getType());
+      isDescriptor.push_back(desc);
+      offset += padding + size;
+    }
+    auto structTy =
+        LLVM::LLVMStructType::getLiteral(ctx, fieldTys, /*isPacked=*/true);
+
+    Location loc = funcOp.getLoc();
+    auto ptrTy = LLVM::LLVMPointerType::get(ctx);
+    OpBuilder b = OpBuilder::atBlockBegin(&entry);
+    Value params = entry.insertArgument(0u, ptrTy, loc);
+    for (unsigned i = 0; i < numArgs; ++i) {
+      BlockArgument arg = entry.getArgument(i + 1);
+      Value field = b.create<LLVM::GEPOp>(
+          loc, ptrTy, structTy, params,
+          ArrayRef<LLVM::GEPArg>{0, fieldIdxs[i]});
+      Value value;
+      if (isDescriptor[i]) {
+        // TMA copies take the generic address of the descriptor in the
+        // parameter space, keep its bits rather than casting it to global.
+        Value addr = b.create<LLVM::PtrToIntOp>(loc, b.getI64Type(), field);
+        value = b.create<LLVM::IntToPtrOp>(loc, arg.getType(), addr);
+      } else {
+        value = b.create<LLVM::LoadOp>(loc, arg.getType(), field,
+                                       getSizeInBytes(arg));
+      }
+      arg.replaceAllUsesWith(value);
+    }
+    entry.eraseArguments(1, numArgs);
+
+    Type retTy = funcOp.getFunctionType().getReturnType();
+    funcOp.setFunctionType(LLVM::LLVMFunctionType::get(retTy, {ptrTy}));
+    NamedAttribute paramAttrs[] = {
+        b.getNamedAttr(LLVM::LLVMDialect::getByValAttrName(),
+                       TypeAttr::get(structTy)),
+        b.getNamedAttr(LLVM::LLVMDialect::getAlignAttrName(),
+                       b.getI64IntegerAttr(kTmaDescriptorAlign)),
+        b.getNamedAttr("nvvm.grid_constant", b.getUnitAttr())};
+    funcOp.setArgAttrsAttr(
+        b.getArrayAttr({b.getDictionaryAttr(paramAttrs)}));
+  }
+
   static Value promoteOperand(OpBuilder &builder, Location loc, Value operand,
                               Type promotedType) {
     Type tensorPromotedType = cast<RankedTensorType>(operand.getType())
@@ -225,6 +335,10 @@ std::unique_ptr<OperationPass<ModuleOp>>
 createConvertTritonGPUToLLVMPass(int32_t computeCapability) {
   return std::make_unique<ConvertTritonGPUToLLVM>(computeCapability);
 }
+std::unique_ptr<OperationPass<ModuleOp>>
+createConvertTritonGPUToLLVMPass(const ConvertTritonGPUToLLVMOptions &options) {
+  return std::make_unique<ConvertTritonGPUToLLVM>(options);
+}
 
 } // namespace triton
 } // namespace mlir
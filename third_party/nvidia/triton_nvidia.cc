@@ -18,9 +18,29 @@ void init_triton_nvidia_passes_ttgpuir(py::module &&m) {
   using namespace mlir::triton;
   // TODO: it is weird to pass mlir::triton::NVVM here since the conversion is
   // nvidia-specificontext
-  m.def("add_to_llvmir", [](mlir::PassManager &pm, int32_t capability) {
-    pm.addPass(mlir::triton::createConvertTritonGPUToLLVMPass(capability));
-  });
+  m.def(
+      "add_to_llvmir",
+      [](mlir::PassManager &pm, int32_t capability, bool fastMath,
+         bool packKernelArgs, bool recordAsserts, bool binaryPrints,
+         int32_t binaryPrintRecords, int32_t ptxVersion, bool archSpecific,
+         bool l2EvictionHints) {
+        ConvertTritonGPUToLLVMOptions options;
+        options.computeCapability = capability;
+        options.fastMath = fastMath;
+        options.packKernelArgs = packKernelArgs;
+        options.recordAsserts = recordAsserts;
+        options.binaryPrints = binaryPrints;
+        options.binaryPrintRecords = binaryPrintRecords;
+        options.ptxVersion = ptxVersion;
+        options.archSpecific = archSpecific;
+        options.l2EvictionHints = l2EvictionHints;
+        pm.addPass(mlir::triton::createConvertTritonGPUToLLVMPass(options));
+      },
+      py::arg("pm"), py::arg("capability"), py::arg("fast_math") = false,
+      py::arg("pack_kernel_args") = false, py::arg("record_asserts") = false,
+      py::arg("binary_prints") = false,
+      py::arg("binary_print_records") = 1 << 16, py::arg("ptx_version") = 0,
+      py::arg("arch_specific") = false, py::arg("l2_eviction_hints") = false);
   m.def("add_decompose_unsupported_conversions", [](mlir::PassManager &pm) {
     pm.addPass(NVIDIA::createDecomposeUnsupportedConversionsPass());
   });
@@ -33,6 +53,9 @@ void init_triton_nvidia_passes_ttnvgpuir(py::module &&m) {
                      mlir::createTritonNvidiaGPUFenceInsertionPass);
   ADD_PASS_WRAPPER_0("add_tma_lowering",
                      mlir::createTritonNvidiaGPUTMALoweringPass);
+  ADD_PASS_WRAPPER_4("add_warp_specialization",
+                     mlir::createTritonNvidiaGPUWarpSpecializationPass, int,
+                     int, int, int);
   ADD_PASS_WRAPPER_0("add_nvgpu_to_llvm",
                      mlir::triton::createConvertNVGPUToLLVMPass);
 }
@@ -23,6 +23,48 @@ void initProton(pybind11::module &&m) {
           return sessionId;
         });
 
+  m.def("set_buffer_options",
+        [](const std::string &profilerName, size_t bufferSize,
+           size_t numBuffers, bool hugePages) {
+          SessionManager::instance().setBufferOptions(
+              profilerName, BufferOptions{bufferSize, numBuffers, hugePages});
+        });
+
+  m.def("set_counter_options",
+        [](const std::string &profilerName,
+           const std::vector<std::string> &metrics,
+           const std::string &kernelFilter) {
+          SessionManager::instance().setCounterOptions(
+              profilerName, CounterOptions{metrics, kernelFilter});
+        });
+
+  m.def("set_sampling_options",
+        [](const std::string &profilerName, size_t interval) {
+          SessionManager::instance().setSamplingOptions(
+              profilerName, SamplingOptions{interval});
+        });
+
+  m.def("set_pc_sampling_options",
+        [](const std::string &profilerName, bool enabled,
+           const std::string &kernelFilter) {
+          SessionManager::instance().setPCSamplingOptions(
+              profilerName, PCSamplingOptions{enabled, kernelFilter});
+        });
+
+  m.def("set_memory_options",
+        [](const std::string &profilerName, bool enabled) {
+          SessionManager::instance().setMemoryOptions(profilerName,
+                                                      MemoryOptions{enabled});
+        });
+
+  m.def("get_num_dropped_records", [](const std::string &profilerName) {
+    return SessionManager::instance().getNumDroppedRecords(profilerName);
+  });
+
+  m.def("get_num_dropped_samples", [](const std::string &profilerName) {
+    return SessionManager::instance().getNumDroppedSamples(profilerName);
+  });
+
   m.def("activate", [](size_t sessionId) {
     SessionManager::instance().activateSession(sessionId);
   });
@@ -41,6 +83,16 @@ void initProton(pybind11::module &&m) {
     SessionManager::instance().finalizeAllSessions(outputFormatEnum);
   });
 
+  m.def("flush", [](size_t sessionId, const std::string &outputFormat) {
+    auto outputFormatEnum = parseOutputFormat(outputFormat);
+    SessionManager::instance().flushSession(sessionId, outputFormatEnum);
+  });
+
+  m.def("flush_all", [](const std::string &outputFormat) {
+    auto outputFormatEnum = parseOutputFormat(outputFormat);
+    SessionManager::instance().flushAllSessions(outputFormatEnum);
+  });
+
   m.def("record_scope", []() { return Scope::getNewScopeId(); });
 
   m.def("enter_scope", [](size_t scopeId, const std::string &name) {
@@ -3,12 +3,38 @@
 
 #include "Context.h"
 
+#include <map>
+#include <thread>
+#include <utility>
+
 namespace proton {
 
 /// Unwind the Python stack and early return a list of contexts.
+/// Frames are interned by their (code object, line) pair, so their names are
+/// only built the first time they are seen, and the contexts of each thread
+/// are only rebuilt when its stack changes.
 class PythonContextSource : public ContextSource {
 public:
+  PythonContextSource() = default;
+  ~PythonContextSource();
+
   std::vector<Context> getContexts() override;
+
+private:
+  // (PyCodeObject *, line number)
+  using FrameKey = std::pair<const void *, int>;
+
+  struct Stack {
+    std::vector<size_t> frameIds;
+    std::vector<Context> contexts;
+  };
+
+  // Accessed with the GIL held.
+  // The interned code objects are referenced until the source is destroyed,
+  // so that their addresses can't be reused by other code objects.
+  std::map<FrameKey, size_t> frameKeyToId;
+  std::vector<std::string> frameNames;
+  std::map<std::thread::id, Stack> threadStacks;
 };
 
 } // namespace proton
@@ -2,24 +2,32 @@
 #define PROTON_CONTEXT_SHADOW_H_
 
 #include "Context.h"
+#include <atomic>
+#include <map>
 #include <vector>
 
 namespace proton {
 
 /// Incrementally build a list of contexts by shadowing the stack with
 /// user-defined scopes.
+/// Each thread has its own stack, so the scopes of threads launching kernels
+/// concurrently don't interleave.
 class ShadowContextSource : public ContextSource, public ScopeInterface {
 public:
   ShadowContextSource() = default;
 
-  std::vector<Context> getContexts() override { return contextStack; }
+  std::vector<Context> getContexts() override;
 
   void enterScope(const Scope &scope) override;
 
   void exitScope(const Scope &scope) override;
 
 private:
-  std::vector<Context> contextStack;
+  // Identifies the source in the stacks of the threads, which outlive it
+  const size_t id{nextId++};
+  static inline std::atomic<size_t> nextId{0};
+  // source id -> context stack of this thread
+  static thread_local std::map<size_t, std::vector<Context>> threadStacks;
 };
 
 } // namespace proton
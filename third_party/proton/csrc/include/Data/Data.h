@@ -7,10 +7,11 @@
 #include <memory>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 namespace proton {
 
-enum class OutputFormat { Hatchet, Count };
+enum class OutputFormat { Hatchet, HatchetMsgPack, ChromeTrace, Count };
 
 class Data : public ThreadLocalOpInterface {
 public:
@@ -23,6 +24,19 @@ public:
   /// [MT] The implementation must be thread-safe.
   virtual size_t addScope(size_t scopeId, const std::string &name = {}) = 0;
 
+  /// Add a copy of the path of the scope `pathScopeId` under the scope
+  /// `scopeId` and return the scope of the copy.
+  /// If either scope is not present, `scopeId` is returned.
+  /// [MT] The implementation must be thread-safe.
+  virtual size_t addScopePath(size_t scopeId, size_t pathScopeId) = 0;
+
+  /// Remove a scope that no more kernel metrics are added to, e.g., the scope
+  /// of a launch after its last kernel, so that the scopes don't grow with the
+  /// number of launches. By default the scopes are kept, since other metrics
+  /// such as sampled instructions may still be added to them.
+  /// [MT] The implementation must be thread-safe.
+  virtual void removeScope(size_t scopeId) {}
+
   /// Add a single metric to the data.
   /// [MT] The implementation must be thread-safe.
   virtual void addMetric(size_t scopeId, std::shared_ptr<Metric> metric) = 0;
@@ -35,13 +49,27 @@ public:
 
   /// Dump the data to the given output format.
   /// [MT] Thread-safe.
-  void dump(OutputFormat outputFormat);
+  virtual void dump(OutputFormat outputFormat);
+
+  /// Write out the data collected so far and keep collecting.
+  /// By default the output is rewritten as a whole.
+  /// [MT] Thread-safe.
+  virtual void flush(OutputFormat outputFormat) { dump(outputFormat); }
 
 protected:
   /// The actual implementation of the dump operation.
   /// [MT] Thread-safe.
   virtual void doDump(std::ostream &os, OutputFormat outputFormat) const = 0;
 
+  /// The contexts of the calling thread, or none without a context source.
+  /// Implementations call it before taking the mutex, so that threads only
+  /// serialize on updating the data, not on unwinding their stacks.
+  std::vector<Context> getContexts() const {
+    if (contextSource == nullptr)
+      return {};
+    return contextSource->getContexts();
+  }
+
   mutable std::shared_mutex mutex;
   const std::string path{};
   ContextSource *contextSource{};
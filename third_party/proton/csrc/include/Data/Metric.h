@@ -2,12 +2,14 @@
 #define PROTON_DATA_METRIC_H_
 
 #include "Utility/Traits.h"
+#include <algorithm>
+#include <string>
 #include <variant>
 #include <vector>
 
 namespace proton {
 
-enum class MetricKind { Flexible, Kernel, Count };
+enum class MetricKind { Flexible, Kernel, Counter, Memory, Count };
 
 using MetricValueType = std::variant<uint64_t, int64_t, double, std::string>;
 
@@ -16,7 +18,8 @@ using MetricValueType = std::variant<uint64_t, int64_t, double, std::string>;
 /// Each `Metric` has a name and a set of values.
 /// Each value could be of type `uint64_t`, `int64_t`, or `double`,
 /// Each value also has its own name and is either aggregable or not.
-/// Currently the only aggregation operation is `addition`.
+/// Aggregable values are added up, except for maxima, e.g., peaks, which
+/// keep the largest value.
 class Metric {
 public:
   Metric(MetricKind kind, size_t size) : kind(kind), values(size) {}
@@ -29,6 +32,8 @@ public:
 
   virtual bool isAggregable(int valueId) const = 0;
 
+  virtual bool isMaximum(int valueId) const { return false; }
+
   std::vector<MetricValueType> getValues() const { return values; }
 
   MetricValueType getValue(int valueId) { return values[valueId]; }
@@ -44,7 +49,9 @@ public:
             using CurrentType = std::decay_t<decltype(currentValue)>;
             using ValueType = std::decay_t<decltype(otherValue)>;
             if constexpr (std::is_same_v<ValueType, CurrentType>) {
-              if (isAggregable(valueId)) {
+              if (isMaximum(valueId)) {
+                currentValue = std::max(currentValue, otherValue);
+              } else if (isAggregable(valueId)) {
                 currentValue += otherValue;
               } else {
                 currentValue = otherValue;
@@ -115,20 +122,25 @@ public:
     Duration,
     DeviceId,
     DeviceType,
+    StreamId,
     Count,
   };
 
   KernelMetric() : Metric(MetricKind::Kernel, kernelMetricKind::Count) {}
 
+  /// `invocations` is the number of launches the kernel stands for, which is
+  /// more than one if launches are sampled. The duration is extrapolated to
+  /// all of them.
   KernelMetric(uint64_t startTime, uint64_t endTime, uint64_t invocations,
-               uint64_t deviceId, uint64_t deviceType)
+               uint64_t deviceId, uint64_t deviceType, uint64_t streamId)
       : KernelMetric() {
     this->values[StartTime] = startTime;
     this->values[EndTime] = endTime;
     this->values[Invocations] = invocations;
-    this->values[Duration] = endTime - startTime;
+    this->values[Duration] = (endTime - startTime) * invocations;
     this->values[DeviceId] = deviceId;
     this->values[DeviceType] = deviceType;
+    this->values[StreamId] = streamId;
   }
 
   virtual const std::string getName() const { return "KernelMetric"; }
@@ -141,10 +153,79 @@ public:
 
 private:
   const static inline bool AGGREGABLE[kernelMetricKind::Count] = {
-      false, false, true, true, false, false};
+      false, false, true, true, false, false, false};
   const static inline std::string VALUE_NAMES[kernelMetricKind::Count] = {
       "StartTime (ns)", "EndTime (ns)", "Count",
       "Time (ns)",      "DeviceId",     "DeviceType",
+      "StreamId",
+  };
+};
+
+/// A counter metric holds the hardware counters collected for a kernel.
+/// Each value is named after the profiler library metric it is evaluated
+/// from, e.g., "dram__bytes.sum", and is summed over invocations.
+/// Metrics that are not sums, e.g., percentages, are averaged over the
+/// invocations when the profile is viewed.
+class CounterMetric : public Metric {
+public:
+  CounterMetric(const std::vector<std::string> &valueNames,
+                const std::vector<double> &values)
+      : Metric(MetricKind::Counter, valueNames.size()),
+        valueNames(valueNames) {
+    for (size_t i = 0; i < values.size(); ++i)
+      this->values[i] = values[i];
+  }
+
+  const std::string getName() const override { return "CounterMetric"; }
+
+  const std::string getValueName(int valueId) const override {
+    return valueNames[valueId];
+  }
+
+  bool isAggregable(int valueId) const override { return true; }
+
+private:
+  const std::vector<std::string> valueNames;
+};
+
+/// A memory metric holds the device memory allocated and freed in a context.
+/// The peak is the largest amount of tracked memory in use right after an
+/// allocation of the context, across all devices.
+class MemoryMetric : public Metric {
+public:
+  enum memoryMetricKind : int {
+    AllocatedBytes,
+    FreedBytes,
+    Allocations,
+    PeakBytes,
+    Count,
+  };
+
+  MemoryMetric(uint64_t allocatedBytes, uint64_t freedBytes,
+               uint64_t allocations, uint64_t peakBytes)
+      : Metric(MetricKind::Memory, memoryMetricKind::Count) {
+    this->values[AllocatedBytes] = allocatedBytes;
+    this->values[FreedBytes] = freedBytes;
+    this->values[Allocations] = allocations;
+    this->values[PeakBytes] = peakBytes;
+  }
+
+  const std::string getName() const override { return "MemoryMetric"; }
+
+  const std::string getValueName(int valueId) const override {
+    return VALUE_NAMES[valueId];
+  }
+
+  bool isAggregable(int valueId) const override { return true; }
+
+  bool isMaximum(int valueId) const override { return valueId == PeakBytes; }
+
+private:
+  const static inline std::string VALUE_NAMES[memoryMetricKind::Count] = {
+      "Allocated Memory (bytes)",
+      "Freed Memory (bytes)",
+      "Allocations",
+      "Peak Memory (bytes)",
   };
 };
 
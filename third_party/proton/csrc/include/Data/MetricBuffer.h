@@ -0,0 +1,86 @@
+#ifndef PROTON_DATA_METRIC_BUFFER_H_
+#define PROTON_DATA_METRIC_BUFFER_H_
+
+#include "Data.h"
+#include "Utility/RingBuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace proton {
+
+/// A metric buffer decouples the profiler callbacks that produce kernel
+/// metrics from the data objects that store them.
+/// Each producer thread appends compact records to its own lock-free ring
+/// buffer, and a background aggregator thread merges them into their data
+/// objects, so the callbacks never wait on the data locks.
+class MetricBuffer {
+public:
+  struct KernelRecord {
+    /// Not owned. Profilers flush the buffer before they unregister a data
+    /// object, so it outlives its pending records.
+    Data *data{};
+    size_t scopeId{};
+    /// If set, the path of this scope is copied under scopeId first, e.g.,
+    /// the scope a graph kernel was captured in under the graph launch.
+    size_t pathScopeId{Scope::DummyScopeId};
+    /// If not empty, the metric is added to a new child scope with this name.
+    std::string scopeName{};
+    uint64_t startTime{};
+    uint64_t endTime{};
+    uint64_t deviceId{};
+    uint64_t deviceType{};
+    uint64_t streamId{};
+    /// Number of launches the kernel stands for.
+    uint64_t invocations{1};
+    /// If set, this is the last kernel of scopeId, which is removed after it.
+    bool lastOfScope{};
+  };
+
+  MetricBuffer() = default;
+  ~MetricBuffer() { stop(); }
+
+  /// Start the aggregator thread.
+  /// If it is already running, this function does nothing.
+  void start();
+
+  /// Merge the pending records and stop the aggregator thread.
+  void stop();
+
+  /// Append a record to the calling thread's ring buffer. If the buffer is
+  /// full the pending records are merged on the calling thread.
+  /// [MT] Thread-safe.
+  void push(KernelRecord &record);
+
+  /// Merge all the records pushed so far into their data objects.
+  /// [MT] Thread-safe.
+  void flush();
+
+private:
+  using RingBuffer = SpscRingBuffer<KernelRecord>;
+
+  static constexpr size_t RingBufferSize = 16 * 1024;
+
+  RingBuffer &getThreadBuffer();
+
+  void aggregate();
+
+  size_t drain();
+
+  // Guards the list of ring buffers, taken once per producer thread.
+  std::mutex buffersMutex;
+  std::vector<std::unique_ptr<RingBuffer>> buffers;
+  // Serializes the consumers of the ring buffers.
+  std::mutex drainMutex;
+  std::atomic<bool> running{false};
+  std::thread aggregator;
+};
+
+} // namespace proton
+
+#endif // PROTON_DATA_METRIC_BUFFER_H_
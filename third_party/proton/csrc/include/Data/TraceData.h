@@ -3,28 +3,88 @@
 
 #include "Data.h"
 
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace proton {
 
+/// Trace data records every kernel as a timeline event instead of
+/// aggregating it into a tree.
+/// Events are appended to a chunk that is written out in the Chrome trace
+/// event format whenever it fills up, so the memory footprint stays bounded
+/// on long runs. The output can be loaded by chrome://tracing and Perfetto.
 class TraceData : public Data {
 public:
-  using Data::Data;
-  virtual ~TraceData() = default;
+  TraceData(const std::string &path, ContextSource *contextSource);
+  virtual ~TraceData();
+
+  TraceData(const std::string &path) : TraceData(path, nullptr) {}
 
   size_t addScope(size_t scopeId, const std::string &name) override;
 
+  size_t addScopePath(size_t scopeId, size_t pathScopeId) override;
+
+  /// Kernel metrics are the only ones on the timeline, so the scope of a
+  /// launch is dropped after its last kernel.
+  void removeScope(size_t scopeId) override;
+
   void addMetric(size_t scopeId, std::shared_ptr<Metric> metric) override;
 
   void addMetrics(size_t scopeId,
                   const std::map<std::string, MetricValueType> &metrics,
                   bool aggregable) override;
 
+  /// Write the pending events and close the trace.
+  /// Trace data is always written in the chrome_trace format, whatever
+  /// outputFormat is.
+  /// [MT] Thread-safe.
+  void dump(OutputFormat outputFormat) override;
+
+  /// Write the pending events and keep the trace open.
+  /// [MT] Thread-safe.
+  void flush(OutputFormat outputFormat) override;
+
+  /// Number of events buffered in memory before they are written out.
+  static constexpr size_t ChunkSize = 4096;
+
 protected:
+  // OpInterface
   void startOp(const Scope &scope) override final;
 
   void stopOp(const Scope &scope) override final;
 
 private:
+  struct TraceContext {
+    std::string name;
+    std::string path;
+    size_t parentId;
+  };
+
+  size_t addContext(const std::vector<Context> &contexts);
+  size_t addContext(const Context &context, size_t parentContextId);
+  bool hasScope(size_t scopeId) const;
+  void writeChunk();
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
+
+  // Interned call paths, indexed by context id
+  std::vector<TraceContext> traceContexts;
+  std::map<std::string, size_t> pathToContextId;
+  // ScopeId -> ContextId
+  std::unordered_map<size_t, size_t> scopeIdToContextId;
+  // Devices and (DeviceId, StreamId) pairs that already have their metadata
+  // events
+  std::set<uint64_t> devices;
+  std::set<std::pair<uint64_t, uint64_t>> streams;
+  // Serialized events that are not written out yet
+  std::vector<std::string> chunk;
+  std::unique_ptr<std::ostream> out;
+  size_t numWrittenEvents{};
+  bool closed{};
 };
 
 } // namespace proton
@@ -5,6 +5,7 @@
 #include "Data.h"
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 namespace proton {
 
@@ -17,12 +18,21 @@ public:
 
   size_t addScope(size_t scopeId, const std::string &name) override;
 
+  size_t addScopePath(size_t scopeId, size_t pathScopeId) override;
+
   void addMetric(size_t scopeId, std::shared_ptr<Metric> metric) override;
 
   void addMetrics(size_t scopeId,
                   const std::map<std::string, MetricValueType> &metrics,
                   bool aggregable) override;
 
+  /// Dump the data to the given output format.
+  /// The hatchet_msgpack output is incremental: every dump appends a frame
+  /// with the nodes added or changed since the previous dump, so that
+  /// periodic flushes only write what is new.
+  /// [MT] Thread-safe.
+  void dump(OutputFormat outputFormat) override;
+
 protected:
   // OpInterface
   void startOp(const Scope &scope) override;
@@ -31,13 +41,18 @@ protected:
 
 private:
   void init();
+  bool hasScope(size_t scopeId) const;
   void dumpHatchet(std::ostream &os) const;
+  void dumpHatchetMsgPack(std::ostream &os,
+                          const std::vector<size_t> &contextIds) const;
   void doDump(std::ostream &os, OutputFormat outputFormat) const override;
 
   class Tree;
   std::unique_ptr<Tree> tree;
   // ScopeId -> ContextId
   std::unordered_map<size_t, size_t> scopeIdToContextId;
+  // Number of incremental hatchet_msgpack dumps written so far
+  size_t numMsgPackDumps{};
 };
 
 } // namespace proton
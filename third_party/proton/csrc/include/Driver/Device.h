@@ -43,6 +43,14 @@ Device getDevice(DeviceType type, uint64_t index);
 
 const std::string getDeviceTypeString(DeviceType type);
 
+/// Peak tensor core throughput of the device for 8-bit operands in ops/s.
+/// Wider operands have a proportionally lower peak, e.g., half for 16-bit.
+/// Returns 0 for unknown architectures.
+double getPeakFlops(const Device &device);
+
+/// Peak DRAM bandwidth of the device in bytes/s.
+double getPeakBandwidth(const Device &device);
+
 }; // namespace proton
 
 #endif // PROTON_DRIVER_DEVICE_H_
@@ -2,6 +2,8 @@
 #define PROTON_DRIVER_GPU_CUPTI_H_
 
 #include "cupti.h"
+#include "cupti_pcsampling.h"
+#include "cupti_profiler_target.h"
 
 namespace proton {
 
@@ -42,6 +44,10 @@ template <bool CheckSuccess>
 CUptiResult activityGetNextRecord(uint8_t *buffer, size_t validBufferSizeBytes,
                                   CUpti_Activity **record);
 
+template <bool CheckSuccess>
+CUptiResult activityGetNumDroppedRecords(CUcontext context, uint32_t streamId,
+                                         size_t *dropped);
+
 template <bool CheckSuccess>
 CUptiResult
 activityPushExternalCorrelationId(CUpti_ExternalCorrelationKind kind,
@@ -66,6 +72,100 @@ CUptiResult getGraphExecId(CUgraphExec graph, uint32_t *pId);
 template <bool CheckSuccess>
 CUptiResult getGraphId(CUgraph graph, uint32_t *pId);
 
+template <bool CheckSuccess>
+CUptiResult getGraphNodeId(CUgraphNode node, uint64_t *nodeId);
+
+template <bool CheckSuccess>
+CUptiResult getCubinCrc(CUpti_GetCubinCrcParams *params);
+
+template <bool CheckSuccess>
+CUptiResult
+getSassToSourceCorrelation(CUpti_GetSassToSourceCorrelationParams *params);
+
+// PC sampling API
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingEnable(CUpti_PCSamplingEnableParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingDisable(CUpti_PCSamplingDisableParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingGetNumStallReasons(
+    CUpti_PCSamplingGetNumStallReasonsParams *params);
+
+template <bool CheckSuccess>
+CUptiResult
+pcSamplingGetStallReasons(CUpti_PCSamplingGetStallReasonsParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingSetConfigurationAttribute(
+    CUpti_PCSamplingConfigurationInfoParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingStart(CUpti_PCSamplingStartParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingStop(CUpti_PCSamplingStopParams *params);
+
+template <bool CheckSuccess>
+CUptiResult pcSamplingGetData(CUpti_PCSamplingGetDataParams *params);
+
+// Profiler API
+
+template <bool CheckSuccess>
+CUptiResult profilerInitialize(CUpti_Profiler_Initialize_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerDeInitialize(CUpti_Profiler_DeInitialize_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult deviceGetChipName(CUpti_Device_GetChipName_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerGetCounterAvailability(
+    CUpti_Profiler_GetCounterAvailability_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerCounterDataImageCalculateSize(
+    CUpti_Profiler_CounterDataImage_CalculateSize_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerCounterDataImageInitialize(
+    CUpti_Profiler_CounterDataImage_Initialize_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerCounterDataImageCalculateScratchBufferSize(
+    CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerCounterDataImageInitializeScratchBuffer(
+    CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerBeginSession(CUpti_Profiler_BeginSession_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerEndSession(CUpti_Profiler_EndSession_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerSetConfig(CUpti_Profiler_SetConfig_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult profilerUnsetConfig(CUpti_Profiler_UnsetConfig_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult
+profilerEnableProfiling(CUpti_Profiler_EnableProfiling_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult
+profilerDisableProfiling(CUpti_Profiler_DisableProfiling_Params *params);
+
+template <bool CheckSuccess>
+CUptiResult
+profilerFlushCounterData(CUpti_Profiler_FlushCounterData_Params *params);
+
 } // namespace cupti
 
 } // namespace proton
@@ -0,0 +1,100 @@
+#ifndef PROTON_DRIVER_GPU_NVPERF_H_
+#define PROTON_DRIVER_GPU_NVPERF_H_
+
+#include "nvperf_cuda_host.h"
+#include "nvperf_host.h"
+
+namespace proton {
+
+/// Host side of the CUPTI profiler: translates metric names to the raw
+/// counters to collect and evaluates the collected counter data.
+namespace nvperf {
+
+template <bool CheckSuccess>
+NVPA_Status initializeHost(NVPW_InitializeHost_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorCalculateScratchBufferSize(
+    NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorInitialize(
+    NVPW_CUDA_MetricsEvaluator_Initialize_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorDestroy(
+    NVPW_MetricsEvaluator_Destroy_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorConvertMetricNameToMetricEvalRequest(
+    NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorGetMetricRawDependencies(
+    NVPW_MetricsEvaluator_GetMetricRawDependencies_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorSetDeviceAttributes(
+    NVPW_MetricsEvaluator_SetDeviceAttributes_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status metricsEvaluatorEvaluateToGpuValues(
+    NVPW_MetricsEvaluator_EvaluateToGpuValues_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigCreate(
+    NVPW_CUDA_RawMetricsConfig_Create_V2_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigSetCounterAvailability(
+    NVPW_RawMetricsConfig_SetCounterAvailability_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigBeginPassGroup(
+    NVPW_RawMetricsConfig_BeginPassGroup_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigAddMetrics(
+    NVPW_RawMetricsConfig_AddMetrics_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigEndPassGroup(
+    NVPW_RawMetricsConfig_EndPassGroup_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigGenerateConfigImage(
+    NVPW_RawMetricsConfig_GenerateConfigImage_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigGetConfigImage(
+    NVPW_RawMetricsConfig_GetConfigImage_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status rawMetricsConfigDestroy(
+    NVPW_RawMetricsConfig_Destroy_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status counterDataBuilderCreate(
+    NVPW_CUDA_CounterDataBuilder_Create_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status counterDataBuilderAddMetrics(
+    NVPW_CounterDataBuilder_AddMetrics_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status counterDataBuilderGetCounterDataPrefix(
+    NVPW_CounterDataBuilder_GetCounterDataPrefix_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status counterDataBuilderDestroy(
+    NVPW_CounterDataBuilder_Destroy_Params *params);
+
+template <bool CheckSuccess>
+NVPA_Status counterDataGetNumRanges(
+    NVPW_CounterData_GetNumRanges_Params *params);
+
+} // namespace nvperf
+
+} // namespace proton
+
+#endif // PROTON_DRIVER_GPU_NVPERF_H_
@@ -0,0 +1,93 @@
+#ifndef PROTON_PROFILER_CUPTI_PC_SAMPLING_H_
+#define PROTON_PROFILER_CUPTI_PC_SAMPLING_H_
+
+#include "Data/Data.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct CUctx_st;
+
+namespace proton {
+
+/// Samples the program counters of selected kernels with the CUPTI PC
+/// sampling API.
+/// Sampled kernels are serialized and their samples are attributed to the
+/// source lines of the kernel with the line table of its cubin. Each line is
+/// a child scope of the kernel's scope, named "<file>:<line>", with the
+/// number of samples in total and per stall reason.
+class CuptiPCSampling {
+public:
+  CuptiPCSampling();
+  ~CuptiPCSampling();
+
+  /// Prepare the sampling of the kernels selected by the options.
+  /// Each sampled kernel stands for `invocations` launches when launches are
+  /// sampled.
+  /// If sampling is not enabled, the other functions do nothing.
+  void start(const PCSamplingOptions &options, size_t invocations);
+
+  /// Disable the sampling on every context.
+  void stop();
+
+  bool isEnabled() const { return enabled; }
+
+  /// Called when a module is loaded, so that the PCs of its kernels can be
+  /// mapped to source lines. The PCs of the modules loaded before the
+  /// sampling starts are attributed to their function instead.
+  /// [MT] Thread-safe.
+  void loadModule(const void *cubin, size_t cubinSize);
+
+  /// Called when a module is unloaded.
+  /// [MT] Thread-safe.
+  void unloadModule(const void *cubin, size_t cubinSize);
+
+  /// Called when a kernel launch API is entered on the calling thread.
+  /// The kernel is sampled if its name matches the kernel filter. Graph
+  /// launches pass a null kernel name and are never sampled.
+  /// [MT] Thread-safe. Sampled kernels are serialized across threads.
+  void enterKernel(CUctx_st *context, const char *kernelName, size_t scopeId,
+                   bool isAPI, const std::set<Data *> &dataSet);
+
+  /// Called when the kernel launch API entered last returns. The samples of
+  /// the kernel are added to the data objects.
+  /// Returns the number of samples of the kernel that were dropped.
+  /// [MT] Thread-safe.
+  size_t exitKernel();
+
+private:
+  struct ContextSession;
+  struct LaunchState;
+
+  static thread_local LaunchState launchState;
+
+  ContextSession &getSession(CUctx_st *context);
+
+  std::string getSourceLine(uint64_t cubinCrc, const char *functionName,
+                            uint64_t pcOffset);
+
+  std::regex kernelFilter;
+  size_t invocations{1};
+  std::atomic<bool> enabled{false};
+  // Held from the entry to the exit of a sampled kernel launch
+  std::mutex mutex;
+  std::map<CUctx_st *, std::unique_ptr<ContextSession>> sessions;
+  // Cubins of the loaded modules by their CRC, and the source lines of the
+  // PCs sampled so far
+  std::mutex moduleMutex;
+  std::map<uint64_t, std::vector<char>> cubins;
+  std::map<std::tuple<uint64_t, std::string, uint64_t>, std::string>
+      sourceLines;
+};
+
+} // namespace proton
+
+#endif // PROTON_PROFILER_CUPTI_PC_SAMPLING_H_
@@ -0,0 +1,88 @@
+#ifndef PROTON_PROFILER_CUPTI_RANGE_PROFILER_H_
+#define PROTON_PROFILER_CUPTI_RANGE_PROFILER_H_
+
+#include "Data/Data.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+struct CUctx_st;
+
+namespace proton {
+
+/// Collects the hardware counters of selected kernels with the CUPTI range
+/// profiler.
+/// Every selected kernel is profiled as a range of its own and replayed until
+/// all the counters are collected. The ranges are evaluated in batches and
+/// their counters are added to the kernels' scopes as CounterMetrics.
+class CuptiRangeProfiler {
+public:
+  CuptiRangeProfiler();
+  ~CuptiRangeProfiler();
+
+  /// Prepare the collection of the given counters.
+  /// Each profiled kernel stands for `invocations` launches when launches are
+  /// sampled.
+  /// If no counters are requested, the other functions do nothing.
+  void start(const CounterOptions &options, size_t invocations);
+
+  /// Evaluate the ranges collected so far and add their counters to the data
+  /// objects.
+  /// [MT] Thread-safe.
+  void flush(const std::set<Data *> &dataSet);
+
+  /// Flush and release the profiler sessions.
+  void stop(const std::set<Data *> &dataSet);
+
+  bool isEnabled() const { return enabled; }
+
+  /// Called when a kernel launch API is entered on the calling thread.
+  /// The kernel is profiled if its name matches the kernel filter. Graph
+  /// launches pass a null kernel name and are never profiled.
+  /// Nested launch APIs are only counted, so a runtime launch and the driver
+  /// launch it calls form a single range.
+  /// [MT] Thread-safe. Profiled kernels are serialized across threads.
+  void enterKernel(CUctx_st *context, const char *kernelName, size_t scopeId,
+                   bool isAPI, const std::set<Data *> &dataSet);
+
+  /// Called when the kernel launch API entered last returns.
+  /// [MT] Thread-safe.
+  void exitKernel();
+
+private:
+  struct Range {
+    size_t scopeId;
+    // Kernels launched by other APIs than Triton get a child scope named
+    // after the kernel.
+    bool isAPI;
+    std::string kernelName;
+  };
+  struct ContextSession;
+  struct LaunchState;
+
+  static thread_local LaunchState launchState;
+
+  ContextSession &getSession(CUctx_st *context);
+
+  void evaluate(ContextSession &session, const std::set<Data *> &dataSet);
+
+  std::vector<std::string> metrics;
+  std::regex kernelFilter;
+  size_t maxRanges{};
+  size_t invocations{1};
+  std::atomic<bool> enabled{false};
+  // Held from the entry to the exit of a profiled kernel launch
+  std::mutex mutex;
+  std::map<CUctx_st *, std::unique_ptr<ContextSession>> sessions;
+};
+
+} // namespace proton
+
+#endif // PROTON_PROFILER_CUPTI_RANGE_PROFILER_H_
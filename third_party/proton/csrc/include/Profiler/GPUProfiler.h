@@ -2,13 +2,16 @@
 #define PROTON_PROFILER_GPU_PROFILER_H_
 
 #include "Context/Context.h"
+#include "Data/MetricBuffer.h"
 #include "Profiler.h"
 #include "Utility/Atomic.h"
 #include "Utility/Map.h"
 #include "Utility/Set.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -39,15 +42,42 @@ protected:
   void stopOp(const Scope &scope) override { this->correlation.popExternId(); }
 
   // Profiler
-  virtual void doStart() override { pImpl->doStart(); }
+  virtual void doStart() override {
+    samplingInterval = std::max<size_t>(samplingOptions.interval, 1);
+    pImpl->doStart();
+  }
   virtual void doFlush() override { pImpl->doFlush(); }
   virtual void doStop() override { pImpl->doStop(); }
+  // The pending kernel records point to their data objects
+  virtual void doUnregisterData(Data *data) override { metricBuffer.flush(); }
 
   struct ThreadState {
     ConcreteProfilerT &profiler;
 
+    // Sampling state of the kernel launch APIs on this thread
+    size_t launchDepth{};
+    size_t numLaunches{};
+    bool launchSampled{true};
+
     ThreadState(ConcreteProfilerT &profiler) : profiler(profiler) {}
 
+    // Return true if the kernel launch API being entered is profiled.
+    // Nested launch APIs, e.g., the driver API called by a runtime API,
+    // follow the outermost one.
+    bool enterLaunch() {
+      if (launchDepth++ == 0) {
+        auto interval = profiler.samplingInterval;
+        launchSampled = interval == 1 || numLaunches++ % interval == 0;
+      }
+      return launchSampled;
+    }
+
+    // Return true if the kernel launch API being exited is profiled.
+    bool exitLaunch() {
+      --launchDepth;
+      return launchSampled;
+    }
+
     void record(size_t scopeId) {
       if (profiler.isOpInProgress())
         return;
@@ -70,6 +100,33 @@ protected:
       profiler.correlation.popExternId();
       profiler.setOpInProgress(false);
     }
+
+    void recordAllocation(uint64_t address, uint64_t bytes) {
+      auto bytesInUse = profiler.memory.allocate(address, bytes);
+      addMemoryMetric(bytes, 0, 1, bytesInUse);
+    }
+
+    void recordFree(uint64_t address) {
+      auto bytes = profiler.memory.free(address);
+      if (bytes > 0)
+        addMemoryMetric(0, bytes, 0, 0);
+    }
+
+    // Attribute the memory to the op in progress on this thread, e.g., the
+    // launch that allocates its workspace, or else to the current context
+    void addMemoryMetric(uint64_t allocatedBytes, uint64_t freedBytes,
+                         uint64_t allocations, uint64_t peakBytes) {
+      auto &externIdQueue = profiler.correlation.externIdQueue;
+      auto inOp = !externIdQueue.empty();
+      auto scopeId = inOp ? externIdQueue.back() : Scope::getNewScopeId();
+      for (auto data : profiler.getDataSet()) {
+        if (!inOp)
+          data->addScope(scopeId);
+        data->addMetric(scopeId, std::make_shared<MemoryMetric>(
+                                     allocatedBytes, freedBytes, allocations,
+                                     peakBytes));
+      }
+    }
   };
 
   struct Correlation {
@@ -119,8 +176,48 @@ protected:
     }
   };
 
+  // The device memory allocated while the memory is tracked
+  struct Memory {
+    std::mutex mutex;
+    // address -> bytes of the allocations not freed yet
+    std::unordered_map<uint64_t, uint64_t> allocations;
+    uint64_t bytesInUse{};
+
+    // Return the bytes in use after the allocation
+    uint64_t allocate(uint64_t address, uint64_t bytes) {
+      std::lock_guard<std::mutex> lock(mutex);
+      allocations[address] = bytes;
+      bytesInUse += bytes;
+      return bytesInUse;
+    }
+
+    // Return the bytes freed, which are zero for memory allocated before the
+    // tracking started
+    uint64_t free(uint64_t address) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = allocations.find(address);
+      if (it == allocations.end())
+        return 0;
+      auto bytes = it->second;
+      allocations.erase(it);
+      bytesInUse -= bytes;
+      return bytes;
+    }
+
+    void clear() {
+      std::lock_guard<std::mutex> lock(mutex);
+      allocations.clear();
+      bytesInUse = 0;
+    }
+  };
+
   static thread_local ThreadState threadState;
   Correlation correlation;
+  Memory memory;
+  // Number of kernel launches each profiled launch stands for.
+  size_t samplingInterval{1};
+  // Kernel metrics waiting to be merged into the data objects.
+  MetricBuffer metricBuffer;
 
   // Use the pimpl idiom to hide the implementation details. This lets us avoid
   // including the cupti header from this header. The cupti header and the
@@ -12,9 +12,56 @@
 #include <set>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 namespace proton {
 
+/// Options of the host buffers that receive the activity records.
+struct BufferOptions {
+  /// Size of each buffer in bytes.
+  size_t bufferSize = 64 * 1024 * 1024;
+  /// Number of completed buffers kept for reuse.
+  size_t numBuffers = 4;
+  /// Back the buffers with transparent huge pages.
+  bool hugePages = false;
+};
+
+/// Options of the hardware counter collection.
+struct CounterOptions {
+  /// Names of the counters to collect, e.g., "dram__bytes.sum".
+  /// No counters are collected if it is empty.
+  std::vector<std::string> metrics;
+  /// Only kernels whose name matches this regular expression are profiled.
+  std::string kernelFilter = ".*";
+  /// Number of profiled kernels kept on the device before their counters are
+  /// evaluated.
+  size_t maxRanges = 64;
+};
+
+/// Options of the kernel launch sampling.
+struct SamplingOptions {
+  /// Profile one in every `interval` kernel launches of each thread.
+  /// A profiled launch stands for the launches skipped after it, so its
+  /// count and time are scaled by the interval.
+  size_t interval = 1;
+};
+
+/// Options of the program counter sampling.
+struct PCSamplingOptions {
+  /// Sample the program counters of the profiled kernels and attribute the
+  /// samples to the source lines of the kernels.
+  bool enabled = false;
+  /// Only kernels whose name matches this regular expression are sampled.
+  std::string kernelFilter = ".*";
+};
+
+/// Options of the device memory tracking.
+struct MemoryOptions {
+  /// Record the device memory allocated and freed through the driver in the
+  /// context of the allocating thread.
+  bool enabled = false;
+};
+
 /// A profiler contains utilities provided by the profiler library to
 /// collect and analyze performance data.
 class Profiler {
@@ -61,9 +108,52 @@ public:
   }
 
   /// Unregister a data object from the profiler.
+  /// The metrics the profiler still holds for the data object are added to
+  /// it first, so that it can be destroyed once this returns.
   Profiler *unregisterData(Data *data) {
     std::unique_lock<std::shared_mutex> lock(mutex);
     dataSet.erase(data);
+    this->doUnregisterData(data);
+    return this;
+  }
+
+  /// Set the activity buffer options.
+  /// They take effect the next time the profiler is started.
+  Profiler *setBufferOptions(const BufferOptions &options) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    bufferOptions = options;
+    return this;
+  }
+
+  /// Set the hardware counter options.
+  /// They take effect the next time the profiler is started.
+  Profiler *setCounterOptions(const CounterOptions &options) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    counterOptions = options;
+    return this;
+  }
+
+  /// Set the kernel launch sampling options.
+  /// They take effect the next time the profiler is started.
+  Profiler *setSamplingOptions(const SamplingOptions &options) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    samplingOptions = options;
+    return this;
+  }
+
+  /// Set the program counter sampling options.
+  /// They take effect the next time the profiler is started.
+  Profiler *setPCSamplingOptions(const PCSamplingOptions &options) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    pcSamplingOptions = options;
+    return this;
+  }
+
+  /// Set the device memory tracking options.
+  /// They take effect the next time the profiler is started.
+  Profiler *setMemoryOptions(const MemoryOptions &options) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    memoryOptions = options;
     return this;
   }
 
@@ -73,13 +163,31 @@ public:
     return dataSet;
   }
 
+  /// Get the number of activity records dropped since the profiler was last
+  /// started, because no buffer was available to receive them in time.
+  size_t getNumDroppedRecords() const { return numDroppedRecords; }
+
+  /// Get the number of PC samples dropped since the profiler was last
+  /// started, because the sampling buffers of a kernel overflowed.
+  size_t getNumDroppedSamples() const { return numDroppedSamples; }
+
 protected:
   virtual void doStart() = 0;
   virtual void doFlush() = 0;
   virtual void doStop() = 0;
+  virtual void doUnregisterData(Data *data) {}
 
   mutable std::shared_mutex mutex;
   std::set<Data *> dataSet;
+  BufferOptions bufferOptions;
+  CounterOptions counterOptions;
+  SamplingOptions samplingOptions;
+  PCSamplingOptions pcSamplingOptions;
+  MemoryOptions memoryOptions;
+  // Reset when the profiler is started and kept after it is stopped, so
+  // that the caller can check it once the session is finalized.
+  std::atomic<size_t> numDroppedRecords{0};
+  std::atomic<size_t> numDroppedSamples{0};
   bool isInitialized{false};
 };
 
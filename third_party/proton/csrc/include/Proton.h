@@ -4,6 +4,7 @@
 #include "Context/Context.h"
 #include "Data/Data.h"
 #include "Data/Metric.h"
+#include "Profiler/Profiler.h"
 #include "Session/Session.h"
 
 #endif // PROTON_H_
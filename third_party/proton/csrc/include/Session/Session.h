@@ -4,6 +4,8 @@
 #include "Context/Context.h"
 #include "Data/Metric.h"
 #include "Utility/Singleton.h"
+#include "Utility/Snapshot.h"
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
@@ -15,6 +17,11 @@ namespace proton {
 
 class Profiler;
 class Data;
+struct BufferOptions;
+struct CounterOptions;
+struct SamplingOptions;
+struct PCSamplingOptions;
+struct MemoryOptions;
 enum class OutputFormat;
 
 /// A session is a collection of profiler, context source, and data objects.
@@ -28,6 +35,8 @@ public:
 
   void deactivate();
 
+  void flush(OutputFormat outputFormat);
+
   void finalize(OutputFormat outputFormat);
 
 private:
@@ -75,6 +84,10 @@ public:
 
   void finalizeAllSessions(OutputFormat outputFormat);
 
+  void flushSession(size_t sessionId, OutputFormat outputFormat);
+
+  void flushAllSessions(OutputFormat outputFormat);
+
   void activateSession(size_t sesssionId);
 
   void deactivateSession(size_t sessionId);
@@ -91,6 +104,25 @@ public:
                   const std::map<std::string, MetricValueType> &metrics,
                   bool aggregable);
 
+  void setBufferOptions(const std::string &profilerName,
+                        const BufferOptions &options);
+
+  void setCounterOptions(const std::string &profilerName,
+                         const CounterOptions &options);
+
+  void setSamplingOptions(const std::string &profilerName,
+                          const SamplingOptions &options);
+
+  void setPCSamplingOptions(const std::string &profilerName,
+                            const PCSamplingOptions &options);
+
+  void setMemoryOptions(const std::string &profilerName,
+                        const MemoryOptions &options);
+
+  size_t getNumDroppedRecords(const std::string &profilerName);
+
+  size_t getNumDroppedSamples(const std::string &profilerName);
+
 private:
   std::unique_ptr<Session> makeSession(size_t id, const std::string &path,
                                        const std::string &profilerName,
@@ -113,20 +145,40 @@ private:
 
   void removeSession(size_t sessionId);
 
-  template <typename Interface, typename Counter>
-  void registerInterface(size_t sessionId, Counter &interfaceCounts) {
+  template <typename Interface>
+  void registerInterface(size_t sessionId,
+                         std::map<Interface *, size_t> &interfaceCounts,
+                         Snapshot<std::vector<Interface *>> &activeInterfaces) {
     auto interfaces = sessions[sessionId]->getInterfaces<Interface>();
     for (auto *interface : interfaces) {
       interfaceCounts[interface] += 1;
     }
+    publishInterfaces(interfaceCounts, activeInterfaces);
   }
 
-  template <typename Interface, typename Counter>
-  void unregisterInterface(size_t sessionId, Counter &interfaceCounts) {
+  template <typename Interface>
+  void
+  unregisterInterface(size_t sessionId,
+                      std::map<Interface *, size_t> &interfaceCounts,
+                      Snapshot<std::vector<Interface *>> &activeInterfaces) {
     auto interfaces = sessions[sessionId]->getInterfaces<Interface>();
     for (auto *interface : interfaces) {
       interfaceCounts[interface] -= 1;
     }
+    publishInterfaces(interfaceCounts, activeInterfaces);
+  }
+
+  template <typename Interface>
+  static void
+  publishInterfaces(const std::map<Interface *, size_t> &interfaceCounts,
+                    Snapshot<std::vector<Interface *>> &activeInterfaces) {
+    std::vector<Interface *> interfaces;
+    for (auto [interface, count] : interfaceCounts) {
+      if (count > 0) {
+        interfaces.push_back(interface);
+      }
+    }
+    activeInterfaces.publish(std::move(interfaces));
   }
 
   mutable std::shared_mutex mutex;
@@ -142,6 +194,12 @@ private:
   std::map<ScopeInterface *, size_t> scopeInterfaceCounts;
   // op -> active count
   std::map<OpInterface *, size_t> opInterfaceCounts;
+  // The scope and op hooks don't take the mutex. They return right away when
+  // no session is active and otherwise iterate over a snapshot of the
+  // interfaces with a positive count.
+  std::atomic<size_t> numActiveSessions{};
+  Snapshot<std::vector<ScopeInterface *>> activeScopeInterfaces;
+  Snapshot<std::vector<OpInterface *>> activeOpInterfaces;
 };
 
 } // namespace proton
@@ -0,0 +1,109 @@
+#ifndef PROTON_UTILITY_BUFFER_POOL_H_
+#define PROTON_UTILITY_BUFFER_POOL_H_
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace proton {
+
+/// A thread safe pool of equally sized host buffers.
+/// Up to `capacity` released buffers are kept for reuse, the others are freed.
+class BufferPool {
+public:
+  BufferPool() = default;
+  ~BufferPool() { clear(); }
+
+  /// Free the cached buffers and use the new configuration for the next
+  /// allocations. All buffers must have been released.
+  void reset(size_t bufferSize, size_t capacity, bool hugePages) {
+    clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    this->bufferSize = bufferSize;
+    this->capacity = capacity;
+    this->hugePages = hugePages;
+    numAllocations = 0;
+    numReuses = 0;
+  }
+
+  /// Free the cached buffers.
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto *buffer : freeBuffers)
+      deallocate(buffer);
+    freeBuffers.clear();
+  }
+
+  uint8_t *acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!freeBuffers.empty()) {
+        auto *buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        ++numReuses;
+        return buffer;
+      }
+      ++numAllocations;
+    }
+    return allocate();
+  }
+
+  void release(uint8_t *buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.size() < capacity)
+      freeBuffers.push_back(buffer);
+    else
+      deallocate(buffer);
+  }
+
+  size_t getBufferSize() const { return bufferSize; }
+
+  /// Number of buffers that had to be allocated rather than reused.
+  size_t getNumAllocations() const { return numAllocations; }
+
+  size_t getNumReuses() const { return numReuses; }
+
+private:
+  static constexpr size_t AlignSize = 8;
+
+  uint8_t *allocate() const {
+    void *buffer = nullptr;
+    if (hugePages) {
+      buffer = mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (buffer == MAP_FAILED)
+        throw std::runtime_error("mmap failed");
+      // Best effort: fall back to regular pages if THP is unavailable.
+      madvise(buffer, bufferSize, MADV_HUGEPAGE);
+    } else {
+      buffer = aligned_alloc(AlignSize, bufferSize);
+      if (buffer == nullptr)
+        throw std::runtime_error("aligned_alloc failed");
+    }
+    return reinterpret_cast<uint8_t *>(buffer);
+  }
+
+  void deallocate(uint8_t *buffer) const {
+    if (hugePages)
+      munmap(buffer, bufferSize);
+    else
+      std::free(buffer);
+  }
+
+  std::mutex mutex;
+  std::vector<uint8_t *> freeBuffers;
+  size_t bufferSize{};
+  size_t capacity{};
+  bool hugePages{};
+  std::atomic<size_t> numAllocations{0};
+  std::atomic<size_t> numReuses{0};
+};
+
+} // namespace proton
+
+#endif // PROTON_UTILITY_BUFFER_POOL_H_
@@ -0,0 +1,54 @@
+#ifndef PROTON_UTILITY_RING_BUFFER_H_
+#define PROTON_UTILITY_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace proton {
+
+/// A lock-free ring buffer with a single producer and a single consumer.
+/// The capacity must be a power of two.
+template <typename T> class SpscRingBuffer {
+public:
+  explicit SpscRingBuffer(size_t capacity)
+      : buffer(capacity), mask(capacity - 1) {
+    if (capacity == 0 || (capacity & mask) != 0)
+      throw std::invalid_argument("capacity must be a power of two");
+  }
+
+  /// Move `value` into the buffer unless it is full.
+  /// [MT] Producer only.
+  bool tryPush(T &value) {
+    auto currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail - head.load(std::memory_order_acquire) == buffer.size())
+      return false;
+    buffer[currentTail & mask] = std::move(value);
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pass every available value to `fn` and return how many there were.
+  /// [MT] Consumer only.
+  template <typename FnT> size_t consume(FnT &&fn) {
+    auto currentHead = head.load(std::memory_order_relaxed);
+    auto currentTail = tail.load(std::memory_order_acquire);
+    for (auto i = currentHead; i != currentTail; ++i)
+      fn(buffer[i & mask]);
+    head.store(currentTail, std::memory_order_release);
+    return currentTail - currentHead;
+  }
+
+private:
+  std::vector<T> buffer;
+  const size_t mask;
+  // Keep the indices on separate cache lines so that the producer and the
+  // consumer don't contend on them.
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+};
+
+} // namespace proton
+
+#endif // PROTON_UTILITY_RING_BUFFER_H_
@@ -0,0 +1,40 @@
+#ifndef PROTON_UTILITY_SNAPSHOT_H_
+#define PROTON_UTILITY_SNAPSHOT_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace proton {
+
+/// A value that is read without locking, in the style of RCU.
+/// Readers take a snapshot of the value, which stays valid while they hold it.
+/// Writers publish a new value and wait until no reader holds the previous
+/// one, so that whatever it refers to can be released once publish returns.
+/// Writers must be serialized by the caller.
+template <typename T> class Snapshot {
+public:
+  Snapshot() : value(std::make_shared<const T>()) {}
+
+  std::shared_ptr<const T> get() const {
+    return std::atomic_load_explicit(&value, std::memory_order_acquire);
+  }
+
+  void publish(T newValue) {
+    auto previous = std::atomic_exchange_explicit(
+        &value, std::make_shared<const T>(std::move(newValue)),
+        std::memory_order_acq_rel);
+    // Grace period: the readers that loaded the previous value are done with
+    // it once we hold the last reference.
+    while (previous.use_count() > 1)
+      std::this_thread::yield();
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+
+private:
+  std::shared_ptr<const T> value;
+};
+
+} // namespace proton
+
+#endif // PROTON_UTILITY_SNAPSHOT_H_
@@ -2,6 +2,7 @@
 #include "pybind11/pybind11.h"
 #include <algorithm>
 #include <string>
+#include <thread>
 
 namespace proton {
 
@@ -71,27 +72,54 @@ std::string unpackPyobject(PyObject *pyObject) {
 
 } // namespace
 
+PythonContextSource::~PythonContextSource() {
+  // The interpreter may already be finalized when the session manager is
+  // destroyed at exit
+  if (!Py_IsInitialized())
+    return;
+  pybind11::gil_scoped_acquire gil;
+  for (auto &[frameKey, frameId] : frameKeyToId)
+    Py_DECREF((PyObject *)(frameKey.first));
+}
+
 std::vector<Context> PythonContextSource::getContexts() {
   pybind11::gil_scoped_acquire gil;
 
+  auto &stack = threadStacks[std::this_thread::get_id()];
+  std::vector<size_t> frameIds;
+  frameIds.reserve(stack.frameIds.size());
+
   PyFrameObject *frame = PyEval_GetFrame();
   Py_XINCREF(frame);
-
-  std::vector<Context> contexts;
   while (frame != nullptr) {
     PyCodeObject *f_code = getFrameCodeObject(frame);
-    size_t lineno = PyFrame_GetLineNumber(frame);
-    size_t firstLineNo = f_code->co_firstlineno;
-    std::string file = unpackPyobject(f_code->co_filename);
-    std::string function = unpackPyobject(f_code->co_name);
-    auto pythonFrame = file + ":" + function + "@" + std::to_string(lineno);
-    contexts.push_back(Context(pythonFrame));
+    int lineno = PyFrame_GetLineNumber(frame);
+    auto [it, inserted] = frameKeyToId.try_emplace(
+        FrameKey{f_code, lineno}, frameNames.size());
+    if (inserted) {
+      // Keep the reference returned by getFrameCodeObject
+      std::string file = unpackPyobject(f_code->co_filename);
+      std::string function = unpackPyobject(f_code->co_name);
+      frameNames.push_back(file + ":" + function + "@" +
+                           std::to_string(lineno));
+    } else {
+      Py_DECREF(f_code);
+    }
+    frameIds.push_back(it->second);
     auto newFrame = getFrameBack(frame);
     Py_DECREF(frame);
     frame = newFrame;
   }
-  std::reverse(contexts.begin(), contexts.end());
-  return contexts;
+  std::reverse(frameIds.begin(), frameIds.end());
+
+  if (frameIds != stack.frameIds) {
+    stack.contexts.clear();
+    stack.contexts.reserve(frameIds.size());
+    for (auto frameId : frameIds)
+      stack.contexts.push_back(Context(frameNames[frameId]));
+    stack.frameIds = std::move(frameIds);
+  }
+  return stack.contexts;
 }
 
 } // namespace proton
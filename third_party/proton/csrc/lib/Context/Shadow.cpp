@@ -4,18 +4,33 @@
 
 namespace proton {
 
+thread_local std::map<size_t, std::vector<Context>>
+    ShadowContextSource::threadStacks{};
+
+std::vector<Context> ShadowContextSource::getContexts() {
+  auto it = threadStacks.find(id);
+  if (it == threadStacks.end())
+    return {};
+  return it->second;
+}
+
 void ShadowContextSource::enterScope(const Scope &scope) {
-  contextStack.push_back(scope);
+  threadStacks[id].push_back(scope);
 }
 
 void ShadowContextSource::exitScope(const Scope &scope) {
-  if (contextStack.empty()) {
+  auto it = threadStacks.find(id);
+  if (it == threadStacks.end() || it->second.empty()) {
     throw std::runtime_error("Context stack is empty");
   }
+  auto &contextStack = it->second;
   if (contextStack.back() != scope) {
     throw std::runtime_error("Context stack is not balanced");
   }
   contextStack.pop_back();
+  // Don't keep the stacks of finished sources around
+  if (contextStack.empty())
+    threadStacks.erase(it);
 }
 
 } // namespace proton
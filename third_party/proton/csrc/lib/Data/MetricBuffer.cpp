@@ -0,0 +1,103 @@
+#include "Data/MetricBuffer.h"
+#include "Data/Metric.h"
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace proton {
+
+namespace {
+
+void apply(MetricBuffer::KernelRecord &record) {
+  auto *data = record.data;
+  // The scopes added for this record only hold its metric
+  std::vector<size_t> recordScopeIds;
+  auto scopeId = record.scopeId;
+  if (record.pathScopeId != Scope::DummyScopeId) {
+    scopeId = data->addScopePath(scopeId, record.pathScopeId);
+    recordScopeIds.push_back(scopeId);
+  }
+  if (!record.scopeName.empty()) {
+    scopeId = data->addScope(scopeId, record.scopeName);
+    recordScopeIds.push_back(scopeId);
+  }
+  // Skip invalid kernel activities
+  if (record.startTime < record.endTime)
+    data->addMetric(scopeId, std::make_shared<KernelMetric>(
+                                 record.startTime, record.endTime,
+                                 record.invocations, record.deviceId,
+                                 record.deviceType, record.streamId));
+  for (auto recordScopeId : recordScopeIds)
+    if (recordScopeId != record.scopeId)
+      data->removeScope(recordScopeId);
+  if (record.lastOfScope)
+    data->removeScope(record.scopeId);
+  record.scopeName.clear();
+}
+
+} // namespace
+
+void MetricBuffer::start() {
+  if (running.exchange(true))
+    return;
+  aggregator = std::thread([this]() { aggregate(); });
+}
+
+void MetricBuffer::stop() {
+  if (running.exchange(false))
+    aggregator.join();
+  flush();
+}
+
+void MetricBuffer::push(KernelRecord &record) {
+  auto &buffer = getThreadBuffer();
+  while (!buffer.tryPush(record)) {
+    // The aggregator is lagging behind; merge on this thread rather than
+    // dropping the record.
+    flush();
+  }
+}
+
+void MetricBuffer::flush() {
+  std::lock_guard<std::mutex> lock(drainMutex);
+  drain();
+}
+
+MetricBuffer::RingBuffer &MetricBuffer::getThreadBuffer() {
+  static thread_local std::map<MetricBuffer *, RingBuffer *> threadBuffers;
+  auto it = threadBuffers.find(this);
+  if (it != threadBuffers.end())
+    return *it->second;
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  buffers.push_back(std::make_unique<RingBuffer>(RingBufferSize));
+  threadBuffers[this] = buffers.back().get();
+  return *buffers.back();
+}
+
+void MetricBuffer::aggregate() {
+  while (running.load()) {
+    size_t numRecords = 0;
+    {
+      std::lock_guard<std::mutex> lock(drainMutex);
+      numRecords = drain();
+    }
+    if (numRecords == 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+size_t MetricBuffer::drain() {
+  std::vector<RingBuffer *> currentBuffers;
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto &buffer : buffers)
+      currentBuffers.push_back(buffer.get());
+  }
+  size_t numRecords = 0;
+  for (auto *buffer : currentBuffers)
+    numRecords += buffer->consume(apply);
+  return numRecords;
+}
+
+} // namespace proton
@@ -1,30 +1,217 @@
 #include "Data/TraceData.h"
+#include "Context/Context.h"
+#include "Data/Metric.h"
+#include "Driver/Device.h"
 #include "Utility/Errors.h"
+#include "nlohmann/json.hpp"
 
+#include <fstream>
+#include <iostream>
+#include <mutex>
 #include <stdexcept>
 
+using json = nlohmann::json;
+
 namespace proton {
 
-void TraceData::startOp(const Scope &scope) { throw NotImplemented(); }
+namespace {
 
-void TraceData::stopOp(const Scope &scope) { throw NotImplemented(); }
+constexpr size_t RootContextId = 0;
 
-size_t TraceData::addScope(size_t scopeId, const std::string &name) {
-  throw NotImplemented();
+// Chrome trace timestamps are in microseconds
+double toMicroseconds(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+} // namespace
+
+size_t TraceData::addContext(const Context &context, size_t parentContextId) {
+  auto &parent = traceContexts[parentContextId];
+  auto path = parentContextId == RootContextId
+                  ? context.name
+                  : parent.path + "/" + context.name;
+  auto it = pathToContextId.find(path);
+  if (it != pathToContextId.end())
+    return it->second;
+  auto contextId = traceContexts.size();
+  traceContexts.push_back({context.name, path, parentContextId});
+  pathToContextId[path] = contextId;
+  return contextId;
+}
+
+size_t TraceData::addContext(const std::vector<Context> &contexts) {
+  auto contextId = RootContextId;
+  for (const auto &context : contexts)
+    contextId = addContext(context, contextId);
+  return contextId;
+}
+
+bool TraceData::hasScope(size_t scopeId) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return scopeIdToContextId.find(scopeId) != scopeIdToContextId.end();
+}
+
+void TraceData::startOp(const Scope &scope) {
+  auto contexts = getContexts();
+  contexts.push_back(Context(scope.name));
+  // enterOp and addMetric maybe called from different threads
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  scopeIdToContextId[scope.scopeId] = addContext(contexts);
+}
+
+void TraceData::stopOp(const Scope &scope) {}
+
+size_t TraceData::addScope(size_t parentScopeId, const std::string &name) {
+  std::vector<Context> contexts;
+  if (!hasScope(parentScopeId))
+    contexts = getContexts();
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToContextId.find(parentScopeId);
+  auto scopeId = parentScopeId;
+  if (scopeIdIt == scopeIdToContextId.end()) {
+    // Record the parent context
+    scopeIdToContextId[parentScopeId] = addContext(contexts);
+  } else {
+    // Add a new context under it for a single kernel
+    scopeId = Scope::getNewScopeId();
+    scopeIdToContextId[scopeId] = addContext(Context(name), scopeIdIt->second);
+  }
+  return scopeId;
+}
+
+size_t TraceData::addScopePath(size_t scopeId, size_t pathScopeId) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToContextId.find(scopeId);
+  auto pathScopeIdIt = scopeIdToContextId.find(pathScopeId);
+  if (scopeIdIt == scopeIdToContextId.end() ||
+      pathScopeIdIt == scopeIdToContextId.end())
+    return scopeId;
+  std::vector<Context> path;
+  for (auto contextId = pathScopeIdIt->second; contextId != RootContextId;
+       contextId = traceContexts[contextId].parentId)
+    path.push_back(Context(traceContexts[contextId].name));
+  auto contextId = scopeIdIt->second;
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    contextId = addContext(*it, contextId);
+  auto newScopeId = Scope::getNewScopeId();
+  scopeIdToContextId[newScopeId] = contextId;
+  return newScopeId;
+}
+
+void TraceData::removeScope(size_t scopeId) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  scopeIdToContextId.erase(scopeId);
 }
 
 void TraceData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
-  throw NotImplemented();
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToContextId.find(scopeId);
+  // The profile data is deactived or closed, ignore the metric
+  if (scopeIdIt == scopeIdToContextId.end() || closed)
+    return;
+  // Only kernel metrics have a place on the timeline
+  if (metric->getKind() != MetricKind::Kernel)
+    return;
+  auto &context = traceContexts[scopeIdIt->second];
+  // A scope receives at most one kernel metric. Kernels launched under the
+  // same parent scope get child scopes of their own, so dropping the scope
+  // keeps the map from growing with the number of launches.
+  scopeIdToContextId.erase(scopeIdIt);
+
+  auto getValue = [&](int valueId) {
+    return std::get<uint64_t>(metric->getValue(valueId));
+  };
+  auto deviceId = getValue(KernelMetric::DeviceId);
+  auto streamId = getValue(KernelMetric::StreamId);
+  if (devices.insert(deviceId).second) {
+    auto deviceType =
+        static_cast<DeviceType>(getValue(KernelMetric::DeviceType));
+    json event = {{"name", "process_name"},
+                  {"ph", "M"},
+                  {"pid", deviceId},
+                  {"args",
+                   {{"name", getDeviceTypeString(deviceType) + " " +
+                                 std::to_string(deviceId)}}}};
+    chunk.push_back(event.dump());
+  }
+  if (streams.insert({deviceId, streamId}).second) {
+    json event = {{"name", "thread_name"},
+                  {"ph", "M"},
+                  {"pid", deviceId},
+                  {"tid", streamId},
+                  {"args", {{"name", "Stream " + std::to_string(streamId)}}}};
+    chunk.push_back(event.dump());
+  }
+  json event = {
+      {"name", context.name.empty() ? "ROOT" : context.name},
+      {"cat", "kernel"},
+      {"ph", "X"},
+      {"ts", toMicroseconds(getValue(KernelMetric::StartTime))},
+      // Duration is extrapolated if launches are sampled
+      {"dur", toMicroseconds(getValue(KernelMetric::EndTime) -
+                             getValue(KernelMetric::StartTime))},
+      {"pid", deviceId},
+      {"tid", streamId},
+      {"args", {{"call_stack", context.path}}}};
+  chunk.push_back(event.dump());
+  if (chunk.size() >= ChunkSize)
+    writeChunk();
 }
 
 void TraceData::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics,
     bool aggregable) {
-  throw NotImplemented();
+  // Flexible metrics have no timestamps, so they have no place on the
+  // timeline.
+}
+
+void TraceData::writeChunk() {
+  if (!out) {
+    if (path.empty() || path == "-") {
+      out.reset(new std::ostream(std::cout.rdbuf())); // Redirecting to cout
+    } else {
+      out.reset(new std::ofstream(
+          path + "." + outputFormatToString(OutputFormat::ChromeTrace)));
+    }
+    // JSON array format, which stays readable even if the closing bracket
+    // is never written
+    *out << "[" << std::endl;
+  }
+  for (const auto &event : chunk) {
+    if (numWrittenEvents++ > 0)
+      *out << "," << std::endl;
+    *out << event;
+  }
+  chunk.clear();
+  out->flush();
+}
+
+void TraceData::dump(OutputFormat outputFormat) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (closed)
+    return;
+  writeChunk();
+  *out << std::endl << "]" << std::endl;
+  out.reset();
+  closed = true;
+}
+
+void TraceData::flush(OutputFormat outputFormat) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (closed)
+    return;
+  writeChunk();
 }
 
 void TraceData::doDump(std::ostream &os, OutputFormat outputFormat) const {
+  // Events are written out as they are added, see dump
   throw NotImplemented();
 }
 
+TraceData::TraceData(const std::string &path, ContextSource *contextSource)
+    : Data(path, contextSource) {
+  traceContexts.push_back(
+      {/*name=*/"", /*path=*/"", /*parentId=*/RootContextId});
+}
+
+TraceData::~TraceData() {}
+
 } // namespace proton
@@ -4,6 +4,9 @@
 #include "Driver/Device.h"
 #include "nlohmann/json.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
 #include <limits>
 #include <map>
 #include <mutex>
@@ -37,16 +40,75 @@ public:
       return children.at(context);
     }
 
+    // Call fn(valueName, value, isHint) for every metric value written out.
+    // Hints are the names of the numeric values, which are listed on the
+    // root so that every metric column is available.
+    template <typename FnT> void forEachValue(FnT &&fn) const {
+      for (auto [metricKind, metric] : metrics) {
+        if (metricKind == MetricKind::Kernel) {
+          auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
+          auto getValue = [&](int valueId) {
+            return std::get<uint64_t>(kernelMetric->getValue(valueId));
+          };
+          auto deviceType =
+              static_cast<DeviceType>(getValue(KernelMetric::DeviceType));
+          fn(kernelMetric->getValueName(KernelMetric::Duration),
+             json(getValue(KernelMetric::Duration)), /*isHint=*/true);
+          fn(kernelMetric->getValueName(KernelMetric::Invocations),
+             json(getValue(KernelMetric::Invocations)), /*isHint=*/true);
+          fn(kernelMetric->getValueName(KernelMetric::DeviceId),
+             json(std::to_string(getValue(KernelMetric::DeviceId))),
+             /*isHint=*/false);
+          fn(kernelMetric->getValueName(KernelMetric::DeviceType),
+             json(getDeviceTypeString(deviceType)), /*isHint=*/false);
+        } else if (metricKind == MetricKind::Counter) {
+          auto values = metric->getValues();
+          for (size_t i = 0; i < values.size(); ++i)
+            fn(metric->getValueName(i), json(std::get<double>(values[i])),
+               /*isHint=*/true);
+        } else if (metricKind == MetricKind::Memory) {
+          auto values = metric->getValues();
+          for (size_t i = 0; i < values.size(); ++i)
+            fn(metric->getValueName(i), json(std::get<uint64_t>(values[i])),
+               /*isHint=*/true);
+        } else {
+          throw std::runtime_error("MetricKind not supported");
+        }
+      }
+      for (auto [_, flexibleMetric] : flexibleMetrics) {
+        auto valueName = flexibleMetric.getValueName(0);
+        std::visit([&](auto &&value) { fn(valueName, json(value), true); },
+                   flexibleMetric.getValues()[0]);
+      }
+    }
+
+    // Collect the devices the kernels of this node ran on
+    void getDeviceIds(
+        std::map<uint64_t, std::set<uint64_t>> &deviceTypeToIds) const {
+      auto it = metrics.find(MetricKind::Kernel);
+      if (it == metrics.end())
+        return;
+      auto &metric = it->second;
+      auto deviceType =
+          std::get<uint64_t>(metric->getValue(KernelMetric::DeviceType));
+      auto deviceId =
+          std::get<uint64_t>(metric->getValue(KernelMetric::DeviceId));
+      deviceTypeToIds[deviceType].insert(deviceId);
+    }
+
     size_t parentId = DummyId;
     size_t id = DummyId;
     std::map<Context, size_t> children = {};
     std::map<MetricKind, std::shared_ptr<Metric>> metrics = {};
     std::map<std::string, FlexibleMetric> flexibleMetrics = {};
+    // Whether the node is added or updated since the last incremental dump
+    bool changed = false;
     friend class Tree;
   };
 
   Tree() {
     treeNodeMap.try_emplace(TreeNode::RootId, TreeNode::RootId, "ROOT");
+    markChanged(getNode(TreeNode::RootId));
   }
 
   size_t addNode(const Context &context, size_t parentId) {
@@ -56,6 +118,7 @@ public:
     auto id = nextContextId++;
     treeNodeMap.try_emplace(id, id, parentId, context.name);
     treeNodeMap[parentId].addChild(context, id);
+    markChanged(getNode(id));
     return id;
   }
 
@@ -69,6 +132,32 @@ public:
 
   TreeNode &getNode(size_t id) { return treeNodeMap.at(id); }
 
+  void markChanged(TreeNode &node) {
+    if (node.changed)
+      return;
+    node.changed = true;
+    changedIds.push_back(node.id);
+  }
+
+  // Return the ids of the nodes changed since the last call, parents first.
+  std::vector<size_t> takeChangedIds() {
+    std::vector<size_t> ids;
+    ids.swap(changedIds);
+    for (auto id : ids)
+      getNode(id).changed = false;
+    // A child is always added after its parent
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  std::vector<size_t> getIds() const {
+    std::vector<size_t> ids;
+    ids.reserve(treeNodeMap.size());
+    for (auto &[id, _] : treeNodeMap)
+      ids.push_back(id);
+    return ids;
+  }
+
   enum class WalkPolicy { PreOrder, PostOrder };
 
   template <WalkPolicy walkPolicy, typename FnT> void walk(FnT &&fn) {
@@ -95,19 +184,23 @@ public:
 
 private:
   size_t nextContextId = TreeNode::RootId + 1;
+  std::vector<size_t> changedIds;
   // tree node id->tree node
   std::map<size_t, TreeNode> treeNodeMap;
 };
 
 void TreeData::init() { tree = std::make_unique<Tree>(); }
 
+bool TreeData::hasScope(size_t scopeId) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return scopeIdToContextId.find(scopeId) != scopeIdToContextId.end();
+}
+
 void TreeData::startOp(const Scope &scope) {
+  auto contexts = getContexts();
+  contexts.push_back(Context(scope.name));
   // enterOp and addMetric maybe called from different threads
   std::unique_lock<std::shared_mutex> lock(mutex);
-  std::vector<Context> contexts;
-  if (contextSource != nullptr)
-    contexts = contextSource->getContexts();
-  contexts.push_back(Context(scope.name));
   auto contextId = tree->addNode(contexts);
   scopeIdToContextId[scope.scopeId] = contextId;
 }
@@ -115,13 +208,13 @@ void TreeData::startOp(const Scope &scope) {
 void TreeData::stopOp(const Scope &scope) {}
 
 size_t TreeData::addScope(size_t parentScopeId, const std::string &name) {
+  std::vector<Context> contexts;
+  if (!hasScope(parentScopeId))
+    contexts = getContexts();
   std::unique_lock<std::shared_mutex> lock(mutex);
   auto scopeIdIt = scopeIdToContextId.find(parentScopeId);
   auto scopeId = parentScopeId;
   if (scopeIdIt == scopeIdToContextId.end()) {
-    std::vector<Context> contexts;
-    if (contextSource != nullptr)
-      contexts = contextSource->getContexts();
     // Record the parent context
     scopeIdToContextId[parentScopeId] = tree->addNode(contexts);
   } else {
@@ -133,6 +226,26 @@ size_t TreeData::addScope(size_t parentScopeId, const std::string &name) {
   return scopeId;
 }
 
+size_t TreeData::addScopePath(size_t scopeId, size_t pathScopeId) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto scopeIdIt = scopeIdToContextId.find(scopeId);
+  auto pathScopeIdIt = scopeIdToContextId.find(pathScopeId);
+  if (scopeIdIt == scopeIdToContextId.end() ||
+      pathScopeIdIt == scopeIdToContextId.end())
+    return scopeId;
+  std::vector<Context> path;
+  for (auto contextId = pathScopeIdIt->second;
+       contextId != Tree::TreeNode::RootId;
+       contextId = tree->getNode(contextId).parentId)
+    path.push_back(Context(tree->getNode(contextId).name));
+  auto contextId = scopeIdIt->second;
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    contextId = tree->addNode(*it, contextId);
+  auto newScopeId = Scope::getNewScopeId();
+  scopeIdToContextId[newScopeId] = contextId;
+  return newScopeId;
+}
+
 void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
   std::unique_lock<std::shared_mutex> lock(mutex);
   auto scopeIdIt = scopeIdToContextId.find(scopeId);
@@ -141,6 +254,7 @@ void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
     return;
   auto contextId = scopeIdIt->second;
   auto &node = tree->getNode(contextId);
+  tree->markChanged(node);
   if (node.metrics.find(metric->getKind()) == node.metrics.end())
     node.metrics.emplace(metric->getKind(), metric);
   else
@@ -150,19 +264,23 @@ void TreeData::addMetric(size_t scopeId, std::shared_ptr<Metric> metric) {
 void TreeData::addMetrics(size_t scopeId,
                           const std::map<std::string, MetricValueType> &metrics,
                           bool aggregable) {
+  std::vector<Context> contexts;
+  if (!hasScope(scopeId)) {
+    if (contextSource == nullptr)
+      throw std::runtime_error("ContextSource is not set");
+    contexts = getContexts();
+  }
   std::unique_lock<std::shared_mutex> lock(mutex);
   auto scopeIdIt = scopeIdToContextId.find(scopeId);
   auto contextId = Tree::TreeNode::DummyId;
   if (scopeIdIt == scopeIdToContextId.end()) {
-    if (contextSource == nullptr)
-      throw std::runtime_error("ContextSource is not set");
     // Attribute the metric to the last context
-    std::vector<Context> contexts = contextSource->getContexts();
     contextId = tree->addNode(contexts);
   } else {
     contextId = scopeIdIt->second;
   }
   auto &node = tree->getNode(contextId);
+  tree->markChanged(node);
   for (auto [metricName, metricValue] : metrics) {
     if (node.flexibleMetrics.find(metricName) == node.flexibleMetrics.end())
       node.flexibleMetrics.emplace(
@@ -173,13 +291,44 @@ void TreeData::addMetrics(size_t scopeId,
   }
 }
 
+namespace {
+
+// Prepare the device information
+// Note that this is done from the application thread,
+// query device information from the tool thread (e.g., CUPTI) will have
+// problems
+json getDeviceJson(
+    const std::map<uint64_t, std::set<uint64_t>> &deviceTypeToIds) {
+  json deviceJson = json::object();
+  for (auto [deviceType, deviceIds] : deviceTypeToIds) {
+    auto deviceTypeName =
+        getDeviceTypeString(static_cast<DeviceType>(deviceType));
+    if (!deviceJson.contains(deviceTypeName))
+      deviceJson[deviceTypeName] = json::object();
+    for (auto deviceId : deviceIds) {
+      Device device = getDevice(static_cast<DeviceType>(deviceType), deviceId);
+      deviceJson[deviceTypeName][std::to_string(deviceId)] = {
+          {"clock_rate", device.clockRate},
+          {"memory_clock_rate", device.memoryClockRate},
+          {"bus_width", device.busWidth},
+          {"arch", device.arch},
+          {"num_sms", device.numSms},
+          {"peak_flops", getPeakFlops(device)},
+          {"peak_bandwidth", getPeakBandwidth(device)}};
+    }
+  }
+  return deviceJson;
+}
+
+} // namespace
+
 void TreeData::dumpHatchet(std::ostream &os) const {
   std::map<size_t, json *> jsonNodes;
   json output = json::array();
   output.push_back(json::object());
   jsonNodes[Tree::TreeNode::RootId] = &(output.back());
   std::set<std::string> valueNames;
-  std::map<uint64_t, std::set<uint64_t>> deviceIds;
+  std::map<uint64_t, std::set<uint64_t>> deviceTypeToIds;
   this->tree->template walk<Tree::WalkPolicy::PreOrder>(
       [&](Tree::TreeNode &treeNode) {
         const auto contextName = treeNode.name;
@@ -187,47 +336,13 @@ void TreeData::dumpHatchet(std::ostream &os) const {
         json *jsonNode = jsonNodes[contextId];
         (*jsonNode)["frame"] = {{"name", contextName}, {"type", "function"}};
         (*jsonNode)["metrics"] = json::object();
-        for (auto [metricKind, metric] : treeNode.metrics) {
-          if (metricKind == MetricKind::Kernel) {
-            auto kernelMetric = std::dynamic_pointer_cast<KernelMetric>(metric);
-            auto duration = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::Duration));
-            auto invocations = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::Invocations));
-            auto deviceId = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::DeviceId));
-            auto deviceType = std::get<uint64_t>(
-                kernelMetric->getValue(KernelMetric::DeviceType));
-            auto deviceTypeName =
-                getDeviceTypeString(static_cast<DeviceType>(deviceType));
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::Duration)] =
-                           duration;
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::Invocations)] =
-                           invocations;
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::DeviceId)] =
-                           std::to_string(deviceId);
-            (*jsonNode)["metrics"]
-                       [kernelMetric->getValueName(KernelMetric::DeviceType)] =
-                           deviceTypeName;
-            valueNames.insert(
-                kernelMetric->getValueName(KernelMetric::Duration));
-            valueNames.insert(
-                kernelMetric->getValueName(KernelMetric::Invocations));
-            deviceIds.insert({deviceType, {deviceId}});
-          } else {
-            throw std::runtime_error("MetricKind not supported");
-          }
-        }
-        for (auto [_, flexibleMetric] : treeNode.flexibleMetrics) {
-          auto valueName = flexibleMetric.getValueName(0);
-          valueNames.insert(valueName);
-          std::visit(
-              [&](auto &&value) { (*jsonNode)["metrics"][valueName] = value; },
-              flexibleMetric.getValues()[0]);
-        }
+        treeNode.forEachValue(
+            [&](const std::string &valueName, json value, bool isHint) {
+              (*jsonNode)["metrics"][valueName] = std::move(value);
+              if (isHint)
+                valueNames.insert(valueName);
+            });
+        treeNode.getDeviceIds(deviceTypeToIds);
         (*jsonNode)["children"] = json::array();
         auto children = treeNode.children;
         for (auto _ : children) {
@@ -244,36 +359,79 @@ void TreeData::dumpHatchet(std::ostream &os) const {
   for (auto valueName : valueNames) {
     output[Tree::TreeNode::RootId]["metrics"][valueName] = 0;
   }
-  // Prepare the device information
-  // Note that this is done from the application thread,
-  // query device information from the tool thread (e.g., CUPTI) will have
-  // problems
-  output.push_back(json::object());
-  auto &deviceJson = output.back();
-  for (auto [deviceType, deviceIds] : deviceIds) {
-    auto deviceTypeName =
-        getDeviceTypeString(static_cast<DeviceType>(deviceType));
-    if (!deviceJson.contains(deviceTypeName))
-      deviceJson[deviceTypeName] = json::object();
-    for (auto deviceId : deviceIds) {
-      Device device = getDevice(static_cast<DeviceType>(deviceType), deviceId);
-      deviceJson[deviceTypeName][std::to_string(deviceId)] = {
-          {"clock_rate", device.clockRate},
-          {"memory_clock_rate", device.memoryClockRate},
-          {"bus_width", device.busWidth},
-          {"arch", device.arch},
-          {"num_sms", device.numSms}};
-    }
-  }
+  output.push_back(getDeviceJson(deviceTypeToIds));
   os << std::endl << output.dump(4) << std::endl;
 }
 
+void TreeData::dumpHatchetMsgPack(std::ostream &os,
+                                  const std::vector<size_t> &contextIds) const {
+  // The nodes are stored column by column, and so is every metric value:
+  // {"ids": [...], "parent_ids": [...], "names": [...],
+  //  "metrics": {valueName: [[id, ...], [value, ...]]},
+  //  "value_names": [...], "devices": {...}}
+  json ids = json::array();
+  json parentIds = json::array();
+  json names = json::array();
+  json metrics = json::object();
+  std::set<std::string> valueNames;
+  std::map<uint64_t, std::set<uint64_t>> deviceTypeToIds;
+  for (auto contextId : contextIds) {
+    auto &treeNode = tree->getNode(contextId);
+    ids.push_back(treeNode.id);
+    // The root has no parent and is written as its own parent
+    parentIds.push_back(treeNode.id == Tree::TreeNode::RootId
+                            ? Tree::TreeNode::RootId
+                            : treeNode.parentId);
+    names.push_back(treeNode.name);
+    treeNode.forEachValue(
+        [&](const std::string &valueName, json value, bool isHint) {
+          auto &column = metrics[valueName];
+          if (column.is_null())
+            column = {json::array(), json::array()};
+          column[0].push_back(treeNode.id);
+          column[1].push_back(std::move(value));
+          if (isHint)
+            valueNames.insert(valueName);
+        });
+    treeNode.getDeviceIds(deviceTypeToIds);
+  }
+  json output = {{"ids", std::move(ids)},
+                 {"parent_ids", std::move(parentIds)},
+                 {"names", std::move(names)},
+                 {"metrics", std::move(metrics)},
+                 {"value_names", valueNames},
+                 {"devices", getDeviceJson(deviceTypeToIds)}};
+  json::to_msgpack(output, os);
+}
+
+void TreeData::dump(OutputFormat outputFormat) {
+  if (outputFormat != OutputFormat::HatchetMsgPack) {
+    Data::dump(outputFormat);
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  // Every dump appends the nodes changed since the previous one
+  std::unique_ptr<std::ostream> out;
+  if (path.empty() || path == "-") {
+    out.reset(new std::ostream(std::cout.rdbuf())); // Redirecting to cout
+  } else {
+    auto mode = std::ios::binary |
+                (numMsgPackDumps == 0 ? std::ios::trunc : std::ios::app);
+    out.reset(new std::ofstream(
+        path + "." + outputFormatToString(outputFormat), mode));
+  }
+  dumpHatchetMsgPack(*out, tree->takeChangedIds());
+  ++numMsgPackDumps;
+}
+
 void TreeData::doDump(std::ostream &os, OutputFormat outputFormat) const {
   std::shared_lock<std::shared_mutex> lock(mutex);
   if (outputFormat == OutputFormat::Hatchet) {
     dumpHatchet(os);
+  } else if (outputFormat == OutputFormat::HatchetMsgPack) {
+    dumpHatchetMsgPack(os, tree->getIds());
   } else {
-    std::logic_error("OutputFormat not supported");
+    throw std::logic_error("OutputFormat not supported");
   }
 }
 
@@ -25,4 +25,28 @@ const std::string getDeviceTypeString(DeviceType type) {
   throw std::runtime_error("DeviceType not supported");
 }
 
+double getPeakFlops(const Device &device) {
+  if (device.type == DeviceType::CUDA) {
+    if (device.arch == "80")
+      return 624e12;
+    if (device.arch == "89")
+      return 330.3e12;
+    if (device.arch == "90") {
+      // Scaled from the 114 SMs and 1755 MHz base clock of the H100 PCIe
+      return device.numSms / 114.0 * device.clockRate / 1755e3 * 1513e12;
+    }
+  } else if (device.type == DeviceType::HIP) {
+    if (device.arch == "gfx90a")
+      return 383e12;
+    if (device.arch == "gfx941" || device.arch == "gfx942")
+      return 2614.9e12;
+  }
+  return 0;
+}
+
+double getPeakBandwidth(const Device &device) {
+  // Double data rate over a bus width in bits
+  return 2.0 * device.busWidth * device.memoryClockRate * 1e3 / 8;
+}
+
 } // namespace proton
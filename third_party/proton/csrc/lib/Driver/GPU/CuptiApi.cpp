@@ -48,6 +48,10 @@ DEFINE_DISPATCH(ExternLibCupti, activityGetNextRecord,
                 cuptiActivityGetNextRecord, uint8_t *, size_t,
                 CUpti_Activity **)
 
+DEFINE_DISPATCH(ExternLibCupti, activityGetNumDroppedRecords,
+                cuptiActivityGetNumDroppedRecords, CUcontext, uint32_t,
+                size_t *)
+
 DEFINE_DISPATCH(ExternLibCupti, activityPushExternalCorrelationId,
                 cuptiActivityPushExternalCorrelationId,
                 CUpti_ExternalCorrelationKind, uint64_t)
@@ -70,6 +74,98 @@ DEFINE_DISPATCH(ExternLibCupti, getGraphExecId, cuptiGetGraphExecId,
 DEFINE_DISPATCH(ExternLibCupti, getGraphId, cuptiGetGraphId, CUgraph,
                 uint32_t *);
 
+DEFINE_DISPATCH(ExternLibCupti, getGraphNodeId, cuptiGetGraphNodeId,
+                CUgraphNode, uint64_t *);
+
+DEFINE_DISPATCH(ExternLibCupti, getCubinCrc, cuptiGetCubinCrc,
+                CUpti_GetCubinCrcParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, getSassToSourceCorrelation,
+                cuptiGetSassToSourceCorrelation,
+                CUpti_GetSassToSourceCorrelationParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingEnable, cuptiPCSamplingEnable,
+                CUpti_PCSamplingEnableParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingDisable, cuptiPCSamplingDisable,
+                CUpti_PCSamplingDisableParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingGetNumStallReasons,
+                cuptiPCSamplingGetNumStallReasons,
+                CUpti_PCSamplingGetNumStallReasonsParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingGetStallReasons,
+                cuptiPCSamplingGetStallReasons,
+                CUpti_PCSamplingGetStallReasonsParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingSetConfigurationAttribute,
+                cuptiPCSamplingSetConfigurationAttribute,
+                CUpti_PCSamplingConfigurationInfoParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingStart, cuptiPCSamplingStart,
+                CUpti_PCSamplingStartParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingStop, cuptiPCSamplingStop,
+                CUpti_PCSamplingStopParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, pcSamplingGetData, cuptiPCSamplingGetData,
+                CUpti_PCSamplingGetDataParams *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerInitialize, cuptiProfilerInitialize,
+                CUpti_Profiler_Initialize_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerDeInitialize,
+                cuptiProfilerDeInitialize, CUpti_Profiler_DeInitialize_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, deviceGetChipName, cuptiDeviceGetChipName,
+                CUpti_Device_GetChipName_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerGetCounterAvailability,
+                cuptiProfilerGetCounterAvailability,
+                CUpti_Profiler_GetCounterAvailability_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerCounterDataImageCalculateSize,
+                cuptiProfilerCounterDataImageCalculateSize,
+                CUpti_Profiler_CounterDataImage_CalculateSize_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerCounterDataImageInitialize,
+                cuptiProfilerCounterDataImageInitialize,
+                CUpti_Profiler_CounterDataImage_Initialize_Params *)
+
+DEFINE_DISPATCH(
+    ExternLibCupti, profilerCounterDataImageCalculateScratchBufferSize,
+    cuptiProfilerCounterDataImageCalculateScratchBufferSize,
+    CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params *)
+
+DEFINE_DISPATCH(
+    ExternLibCupti, profilerCounterDataImageInitializeScratchBuffer,
+    cuptiProfilerCounterDataImageInitializeScratchBuffer,
+    CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerBeginSession, cuptiProfilerBeginSession,
+                CUpti_Profiler_BeginSession_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerEndSession, cuptiProfilerEndSession,
+                CUpti_Profiler_EndSession_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerSetConfig, cuptiProfilerSetConfig,
+                CUpti_Profiler_SetConfig_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerUnsetConfig, cuptiProfilerUnsetConfig,
+                CUpti_Profiler_UnsetConfig_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerEnableProfiling,
+                cuptiProfilerEnableProfiling,
+                CUpti_Profiler_EnableProfiling_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerDisableProfiling,
+                cuptiProfilerDisableProfiling,
+                CUpti_Profiler_DisableProfiling_Params *)
+
+DEFINE_DISPATCH(ExternLibCupti, profilerFlushCounterData,
+                cuptiProfilerFlushCounterData,
+                CUpti_Profiler_FlushCounterData_Params *)
+
 } // namespace cupti
 
 } // namespace proton
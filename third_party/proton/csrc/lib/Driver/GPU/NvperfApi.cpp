@@ -0,0 +1,104 @@
+#include "Driver/GPU/NvperfApi.h"
+#include "Driver/Dispatch.h"
+
+namespace proton {
+
+namespace nvperf {
+
+struct ExternLibNvperf : public ExternLibBase {
+  using RetType = NVPA_Status;
+  // Shipped with CUPTI
+  static constexpr const char *name = "libnvperf_host.so";
+  static constexpr RetType success = NVPA_STATUS_SUCCESS;
+  static void *lib;
+};
+
+void *ExternLibNvperf::lib = nullptr;
+
+DEFINE_DISPATCH(ExternLibNvperf, initializeHost, NVPW_InitializeHost,
+                NVPW_InitializeHost_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorCalculateScratchBufferSize,
+                NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize,
+                NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorInitialize,
+                NVPW_CUDA_MetricsEvaluator_Initialize,
+                NVPW_CUDA_MetricsEvaluator_Initialize_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorDestroy,
+                NVPW_MetricsEvaluator_Destroy,
+                NVPW_MetricsEvaluator_Destroy_Params *)
+
+DEFINE_DISPATCH(
+    ExternLibNvperf, metricsEvaluatorConvertMetricNameToMetricEvalRequest,
+    NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest,
+    NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorGetMetricRawDependencies,
+                NVPW_MetricsEvaluator_GetMetricRawDependencies,
+                NVPW_MetricsEvaluator_GetMetricRawDependencies_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorSetDeviceAttributes,
+                NVPW_MetricsEvaluator_SetDeviceAttributes,
+                NVPW_MetricsEvaluator_SetDeviceAttributes_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, metricsEvaluatorEvaluateToGpuValues,
+                NVPW_MetricsEvaluator_EvaluateToGpuValues,
+                NVPW_MetricsEvaluator_EvaluateToGpuValues_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigCreate,
+                NVPW_CUDA_RawMetricsConfig_Create_V2,
+                NVPW_CUDA_RawMetricsConfig_Create_V2_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigSetCounterAvailability,
+                NVPW_RawMetricsConfig_SetCounterAvailability,
+                NVPW_RawMetricsConfig_SetCounterAvailability_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigBeginPassGroup,
+                NVPW_RawMetricsConfig_BeginPassGroup,
+                NVPW_RawMetricsConfig_BeginPassGroup_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigAddMetrics,
+                NVPW_RawMetricsConfig_AddMetrics,
+                NVPW_RawMetricsConfig_AddMetrics_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigEndPassGroup,
+                NVPW_RawMetricsConfig_EndPassGroup,
+                NVPW_RawMetricsConfig_EndPassGroup_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigGenerateConfigImage,
+                NVPW_RawMetricsConfig_GenerateConfigImage,
+                NVPW_RawMetricsConfig_GenerateConfigImage_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigGetConfigImage,
+                NVPW_RawMetricsConfig_GetConfigImage,
+                NVPW_RawMetricsConfig_GetConfigImage_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, rawMetricsConfigDestroy,
+                NVPW_RawMetricsConfig_Destroy,
+                NVPW_RawMetricsConfig_Destroy_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, counterDataBuilderCreate,
+                NVPW_CUDA_CounterDataBuilder_Create,
+                NVPW_CUDA_CounterDataBuilder_Create_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, counterDataBuilderAddMetrics,
+                NVPW_CounterDataBuilder_AddMetrics,
+                NVPW_CounterDataBuilder_AddMetrics_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, counterDataBuilderGetCounterDataPrefix,
+                NVPW_CounterDataBuilder_GetCounterDataPrefix,
+                NVPW_CounterDataBuilder_GetCounterDataPrefix_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, counterDataBuilderDestroy,
+                NVPW_CounterDataBuilder_Destroy,
+                NVPW_CounterDataBuilder_Destroy_Params *)
+
+DEFINE_DISPATCH(ExternLibNvperf, counterDataGetNumRanges,
+                NVPW_CounterData_GetNumRanges,
+                NVPW_CounterData_GetNumRanges_Params *)
+
+} // namespace nvperf
+
+} // namespace proton
@@ -0,0 +1,329 @@
+#include "Profiler/CuptiPCSampling.h"
+#include "Driver/GPU/CudaApi.h"
+#include "Driver/GPU/CuptiApi.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace proton {
+
+namespace {
+
+// Number of PCs copied out of CUPTI's buffers at a time
+constexpr size_t MaxNumPcs = 4096;
+
+constexpr char PCSamplesMetricName[] = "pc_samples";
+
+// CUPTI names the stall reasons after their counters, e.g.,
+// "smsp__pcsamp_warps_issue_stalled_long_scoreboard".
+constexpr char StallReasonPrefix[] = "smsp__pcsamp_warps_issue_stalled_";
+
+std::string getStallReasonMetricName(const std::string &stallReason) {
+  auto name = stallReason;
+  if (name.rfind(StallReasonPrefix, 0) == 0)
+    name = name.substr(sizeof(StallReasonPrefix) - 1);
+  return "stall_" + name;
+}
+
+uint64_t getCubinCrc(const void *cubin, size_t cubinSize) {
+  CUpti_GetCubinCrcParams crcParams = {CUpti_GetCubinCrcParamsSize};
+  crcParams.cubin = cubin;
+  crcParams.cubinSize = cubinSize;
+  cupti::getCubinCrc<true>(&crcParams);
+  return crcParams.cubinCrc;
+}
+
+} // namespace
+
+struct CuptiPCSampling::ContextSession {
+  CUcontext context{};
+  std::vector<uint32_t> stallReasonIndices;
+  // Stall reason index -> metric name
+  std::map<uint32_t, std::string> stallReasonNames;
+  // The buffer CUPTI copies the samples to, with room for MaxNumPcs PCs
+  CUpti_PCSamplingData samplingData{};
+  std::vector<CUpti_PCSamplingPCData> pcData;
+  std::vector<CUpti_PCSamplingStallReason> pcStallReasons;
+
+  void configure() {
+    CUpti_PCSamplingEnableParams enableParams = {
+        CUpti_PCSamplingEnableParamsSize};
+    enableParams.ctx = context;
+    cupti::pcSamplingEnable<true>(&enableParams);
+
+    size_t numStallReasons = 0;
+    CUpti_PCSamplingGetNumStallReasonsParams numParams = {
+        CUpti_PCSamplingGetNumStallReasonsParamsSize};
+    numParams.ctx = context;
+    numParams.numStallReasons = &numStallReasons;
+    cupti::pcSamplingGetNumStallReasons<true>(&numParams);
+
+    std::vector<char> nameBuffer(numStallReasons *
+                                 CUPTI_STALL_REASON_STRING_SIZE);
+    std::vector<char *> names(numStallReasons);
+    for (size_t i = 0; i < numStallReasons; ++i)
+      names[i] = nameBuffer.data() + i * CUPTI_STALL_REASON_STRING_SIZE;
+    stallReasonIndices.resize(numStallReasons);
+    CUpti_PCSamplingGetStallReasonsParams reasonParams = {
+        CUpti_PCSamplingGetStallReasonsParamsSize};
+    reasonParams.ctx = context;
+    reasonParams.numStallReasons = numStallReasons;
+    reasonParams.stallReasonIndex = stallReasonIndices.data();
+    reasonParams.stallReasons = names.data();
+    cupti::pcSamplingGetStallReasons<true>(&reasonParams);
+    for (size_t i = 0; i < numStallReasons; ++i)
+      stallReasonNames[stallReasonIndices[i]] =
+          getStallReasonMetricName(names[i]);
+
+    pcData.resize(MaxNumPcs);
+    pcStallReasons.resize(MaxNumPcs * numStallReasons);
+    for (size_t i = 0; i < MaxNumPcs; ++i) {
+      pcData[i].size = sizeof(CUpti_PCSamplingPCData);
+      pcData[i].stallReason = pcStallReasons.data() + i * numStallReasons;
+    }
+    samplingData.size = sizeof(CUpti_PCSamplingData);
+    samplingData.collectNumPcs = MaxNumPcs;
+    samplingData.pPcData = pcData.data();
+
+    std::vector<CUpti_PCSamplingConfigurationInfo> configs(5);
+    configs[0].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_STALL_REASON;
+    configs[0].attributeData.stallReasonData.stallReasonCount =
+        numStallReasons;
+    configs[0].attributeData.stallReasonData.pStallReasonIndex =
+        stallReasonIndices.data();
+    configs[1].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_SAMPLING_DATA_BUFFER;
+    configs[1].attributeData.samplingDataBufferData.samplingDataBuffer =
+        &samplingData;
+    // Only the sampled kernel runs while it is sampled, so that every sample
+    // belongs to it.
+    configs[2].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_COLLECTION_MODE;
+    configs[2].attributeData.collectionModeData.collectionMode =
+        CUPTI_PC_SAMPLING_COLLECTION_MODE_KERNEL_SERIALIZED;
+    configs[3].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_ENABLE_START_STOP_CONTROL;
+    configs[3].attributeData.enableStartStopControlData.enableStartStopControl =
+        1;
+    configs[4].attributeType =
+        CUPTI_PC_SAMPLING_CONFIGURATION_ATTR_TYPE_OUTPUT_DATA_FORMAT;
+    configs[4].attributeData.outputDataFormatData.outputDataFormat =
+        CUPTI_PC_SAMPLING_OUTPUT_DATA_FORMAT_PARSED;
+    CUpti_PCSamplingConfigurationInfoParams configParams = {
+        CUpti_PCSamplingConfigurationInfoParamsSize};
+    configParams.ctx = context;
+    configParams.numAttributes = configs.size();
+    configParams.pPCSamplingConfigurationInfo = configs.data();
+    cupti::pcSamplingSetConfigurationAttribute<true>(&configParams);
+  }
+
+  void disable() {
+    CUpti_PCSamplingDisableParams disableParams = {
+        CUpti_PCSamplingDisableParamsSize};
+    disableParams.ctx = context;
+    cupti::pcSamplingDisable<false>(&disableParams);
+  }
+};
+
+struct CuptiPCSampling::LaunchState {
+  // Number of launch APIs entered on this thread
+  size_t depth{};
+  // Set while a kernel is sampled
+  ContextSession *session{};
+  size_t scopeId{};
+  // Kernels launched by other APIs than Triton get a child scope named after
+  // the kernel.
+  bool isAPI{};
+  std::string kernelName;
+  std::set<Data *> dataSet;
+  std::unique_lock<std::mutex> lock;
+};
+
+thread_local CuptiPCSampling::LaunchState CuptiPCSampling::launchState{};
+
+CuptiPCSampling::CuptiPCSampling() = default;
+
+CuptiPCSampling::~CuptiPCSampling() = default;
+
+void CuptiPCSampling::start(const PCSamplingOptions &options,
+                            size_t invocations) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!options.enabled || enabled)
+    return;
+  this->invocations = invocations;
+  kernelFilter = std::regex(options.kernelFilter);
+  enabled = true;
+}
+
+void CuptiPCSampling::stop() {
+  if (!enabled)
+    return;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &[context, session] : sessions)
+    session->disable();
+  sessions.clear();
+  std::lock_guard<std::mutex> moduleLock(moduleMutex);
+  cubins.clear();
+  sourceLines.clear();
+  enabled = false;
+}
+
+void CuptiPCSampling::loadModule(const void *cubin, size_t cubinSize) {
+  if (!enabled || cubin == nullptr)
+    return;
+  auto crc = getCubinCrc(cubin, cubinSize);
+  std::lock_guard<std::mutex> lock(moduleMutex);
+  auto *bytes = static_cast<const char *>(cubin);
+  cubins[crc].assign(bytes, bytes + cubinSize);
+}
+
+void CuptiPCSampling::unloadModule(const void *cubin, size_t cubinSize) {
+  if (!enabled || cubin == nullptr)
+    return;
+  auto crc = getCubinCrc(cubin, cubinSize);
+  std::lock_guard<std::mutex> lock(moduleMutex);
+  cubins.erase(crc);
+}
+
+std::string CuptiPCSampling::getSourceLine(uint64_t cubinCrc,
+                                           const char *functionName,
+                                           uint64_t pcOffset) {
+  std::lock_guard<std::mutex> lock(moduleMutex);
+  auto key = std::make_tuple(cubinCrc, std::string(functionName), pcOffset);
+  auto lineIt = sourceLines.find(key);
+  if (lineIt != sourceLines.end())
+    return lineIt->second;
+  std::string line;
+  auto cubinIt = cubins.find(cubinCrc);
+  if (cubinIt != cubins.end()) {
+    CUpti_GetSassToSourceCorrelationParams correlationParams = {
+        CUpti_GetSassToSourceCorrelationParamsSize};
+    correlationParams.cubin = cubinIt->second.data();
+    correlationParams.cubinSize = cubinIt->second.size();
+    correlationParams.functionName = functionName;
+    correlationParams.pcOffset = pcOffset;
+    // Fails if the cubin has no line table
+    if (cupti::getSassToSourceCorrelation<false>(&correlationParams) ==
+        CUPTI_SUCCESS) {
+      if (correlationParams.fileName != nullptr)
+        line = std::string(correlationParams.fileName) + ":" +
+               std::to_string(correlationParams.lineNumber);
+      // CUPTI allocates the names and the caller frees them
+      std::free(correlationParams.fileName);
+      std::free(correlationParams.dirName);
+    }
+  }
+  if (line.empty()) {
+    std::stringstream ss;
+    ss << functionName << "+0x" << std::hex << pcOffset;
+    line = ss.str();
+  }
+  sourceLines[key] = line;
+  return line;
+}
+
+CuptiPCSampling::ContextSession &
+CuptiPCSampling::getSession(CUcontext context) {
+  auto &session = sessions[context];
+  if (session)
+    return *session;
+  session = std::make_unique<ContextSession>();
+  session->context = context;
+  session->configure();
+  return *session;
+}
+
+void CuptiPCSampling::enterKernel(CUcontext context, const char *kernelName,
+                                  size_t scopeId, bool isAPI,
+                                  const std::set<Data *> &dataSet) {
+  if (!enabled)
+    return;
+  if (launchState.depth++ > 0)
+    return;
+  if (kernelName == nullptr || !std::regex_search(kernelName, kernelFilter))
+    return;
+  launchState.lock = std::unique_lock<std::mutex>(mutex);
+  auto &session = getSession(context);
+  CUpti_PCSamplingStartParams startParams = {CUpti_PCSamplingStartParamsSize};
+  startParams.ctx = context;
+  cupti::pcSamplingStart<true>(&startParams);
+  launchState.session = &session;
+  launchState.scopeId = scopeId;
+  launchState.isAPI = isAPI;
+  launchState.kernelName = kernelName;
+  launchState.dataSet = dataSet;
+}
+
+size_t CuptiPCSampling::exitKernel() {
+  if (launchState.depth == 0 || --launchState.depth > 0)
+    return 0;
+  auto *session = launchState.session;
+  if (session == nullptr)
+    return 0;
+  CUpti_PCSamplingStopParams stopParams = {CUpti_PCSamplingStopParamsSize};
+  stopParams.ctx = session->context;
+  cupti::pcSamplingStop<true>(&stopParams);
+
+  // Source line -> samples in total and per stall reason
+  std::map<std::string, std::map<std::string, MetricValueType>> lineSamples;
+  auto &samplingData = session->samplingData;
+  auto addSamples = [](std::map<std::string, MetricValueType> &samples,
+                       const std::string &name, uint64_t count) {
+    auto it = samples.try_emplace(name, uint64_t{0}).first;
+    it->second = std::get<uint64_t>(it->second) + count;
+  };
+  while (true) {
+    for (size_t i = 0; i < samplingData.totalNumPcs; ++i) {
+      auto &pc = samplingData.pPcData[i];
+      if (pc.functionName == nullptr)
+        continue;
+      auto line = getSourceLine(pc.cubinCrc, pc.functionName, pc.pcOffset);
+      // CUPTI allocates the function names and the caller frees them
+      std::free(pc.functionName);
+      pc.functionName = nullptr;
+      auto &samples = lineSamples[line];
+      for (size_t j = 0; j < pc.stallReasonCount; ++j) {
+        auto &stallReason = pc.stallReason[j];
+        if (stallReason.samples == 0)
+          continue;
+        // Extrapolate to the launches that are not sampled
+        uint64_t count = stallReason.samples * invocations;
+        addSamples(samples, PCSamplesMetricName, count);
+        addSamples(
+            samples,
+            session->stallReasonNames[stallReason.pcSamplingStallReasonIndex],
+            count);
+      }
+    }
+    if (samplingData.remainingNumPcs == 0)
+      break;
+    // The buffer was full, copy out the rest of the samples
+    CUpti_PCSamplingGetDataParams dataParams = {
+        CUpti_PCSamplingGetDataParamsSize};
+    dataParams.ctx = session->context;
+    dataParams.pcSamplingData = &samplingData;
+    cupti::pcSamplingGetData<true>(&dataParams);
+  }
+  size_t droppedSamples = samplingData.droppedSamples;
+  if (droppedSamples > 0)
+    std::cerr << "[PROTON] " << droppedSamples << " PC samples of "
+              << launchState.kernelName << " were dropped." << std::endl;
+  samplingData.totalNumPcs = 0;
+
+  for (auto *data : launchState.dataSet) {
+    auto scopeId = launchState.scopeId;
+    if (launchState.isAPI)
+      scopeId = data->addScope(scopeId, launchState.kernelName);
+    for (auto &[line, samples] : lineSamples)
+      data->addMetrics(data->addScope(scopeId, line), samples,
+                       /*aggregable=*/true);
+  }
+  launchState.session = nullptr;
+  launchState.dataSet.clear();
+  launchState.lock.unlock();
+  return droppedSamples;
+}
+
+} // namespace proton
@@ -4,6 +4,9 @@
 #include "Driver/Device.h"
 #include "Driver/GPU/CudaApi.h"
 #include "Driver/GPU/CuptiApi.h"
+#include "Profiler/CuptiPCSampling.h"
+#include "Profiler/CuptiRangeProfiler.h"
+#include "Utility/BufferPool.h"
 #include "Utility/Map.h"
 
 #include <cstdlib>
@@ -23,46 +26,68 @@ thread_local std::deque<size_t>
 
 namespace {
 
-std::shared_ptr<Metric> convertActivityToMetric(CUpti_Activity *activity) {
-  std::shared_ptr<Metric> metric;
+/// The scope a graph node was created in, and whether it was created by a
+/// runtime API other than Triton's.
+struct GraphNodeScope {
+  size_t scopeId;
+  bool isAPI;
+};
+
+using GraphNodeIdToScopeMap =
+    ThreadSafeMap<uint64_t, GraphNodeScope,
+                  std::unordered_map<uint64_t, GraphNodeScope>>;
+
+MetricBuffer::KernelRecord convertActivityToRecord(Data *data, size_t scopeId,
+                                                  uint64_t invocations,
+                                                  CUpti_Activity *activity) {
+  MetricBuffer::KernelRecord record;
+  record.data = data;
+  record.scopeId = scopeId;
+  record.invocations = invocations;
   switch (activity->kind) {
   case CUPTI_ACTIVITY_KIND_KERNEL:
   case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
     auto *kernel = reinterpret_cast<CUpti_ActivityKernel5 *>(activity);
-    if (kernel->start < kernel->end) {
-      metric = std::make_shared<KernelMetric>(
-          static_cast<uint64_t>(kernel->start),
-          static_cast<uint64_t>(kernel->end), 1,
-          static_cast<uint64_t>(kernel->deviceId),
-          static_cast<uint64_t>(DeviceType::CUDA));
-    } // else: not a valid kernel activity
+    // A kernel with start >= end is not a valid activity and only gets its
+    // scope.
+    record.startTime = static_cast<uint64_t>(kernel->start);
+    record.endTime = static_cast<uint64_t>(kernel->end);
+    record.deviceId = static_cast<uint64_t>(kernel->deviceId);
+    record.deviceType = static_cast<uint64_t>(DeviceType::CUDA);
+    record.streamId = static_cast<uint64_t>(kernel->streamId);
     break;
   }
   default:
     break;
   }
-  return metric;
+  return record;
 }
 
 uint32_t
 processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
                       CuptiProfiler::ApiExternIdSet &apiExternIds,
-                      std::set<Data *> &dataSet, CUpti_Activity *activity) {
+                      GraphNodeIdToScopeMap &graphNodeIdToScope,
+                      MetricBuffer &metricBuffer, std::set<Data *> &dataSet,
+                      uint64_t invocations, CUpti_Activity *activity) {
   // Support CUDA >= 11.0
   auto *kernel = reinterpret_cast<CUpti_ActivityKernel5 *>(activity);
   auto correlationId = kernel->correlationId;
   if (/*Not a valid context*/ !corrIdToExternId.contain(correlationId))
     return correlationId;
   auto [parentId, numInstances] = corrIdToExternId.at(correlationId);
+  // The scope of the launch is done after its last kernel
+  auto lastOfScope = numInstances == 1;
   if (kernel->graphId == 0) {
     // Non-graph kernels
+    // It's triggered by a CUDA op but not triton op
+    auto isAPI = apiExternIds.contain(parentId);
     for (auto *data : dataSet) {
-      auto scopeId = parentId;
-      if (apiExternIds.contain(scopeId)) {
-        // It's triggered by a CUDA op but not triton op
-        scopeId = data->addScope(parentId, kernel->name);
-      }
-      data->addMetric(scopeId, convertActivityToMetric(activity));
+      auto record =
+          convertActivityToRecord(data, parentId, invocations, activity);
+      record.lastOfScope = lastOfScope;
+      if (isAPI)
+        record.scopeName = kernel->name;
+      metricBuffer.push(record);
     }
   } else {
     // Graph kernels
@@ -73,9 +98,23 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
     // 2. graphExecId -> graphId
     // --- CUPTI thread ---
     // 3. corrId -> numKernels
+    // Kernels captured from streams are attributed to the path of the scope
+    // they were captured in, under the graph launch.
+    auto pathScopeId = Scope::DummyScopeId;
+    auto isAPI = true;
+    if (graphNodeIdToScope.contain(kernel->graphNodeId)) {
+      auto nodeScope = graphNodeIdToScope.at(kernel->graphNodeId);
+      pathScopeId = nodeScope.scopeId;
+      isAPI = nodeScope.isAPI;
+    }
     for (auto *data : dataSet) {
-      auto externId = data->addScope(parentId, kernel->name);
-      data->addMetric(externId, convertActivityToMetric(activity));
+      auto record =
+          convertActivityToRecord(data, parentId, invocations, activity);
+      record.lastOfScope = lastOfScope;
+      record.pathScopeId = pathScopeId;
+      if (isAPI)
+        record.scopeName = kernel->name;
+      metricBuffer.push(record);
     }
   }
   apiExternIds.erase(parentId);
@@ -90,13 +129,16 @@ processActivityKernel(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
 
 uint32_t processActivity(CuptiProfiler::CorrIdToExternIdMap &corrIdToExternId,
                          CuptiProfiler::ApiExternIdSet &apiExternIds,
-                         std::set<Data *> &dataSet, CUpti_Activity *activity) {
+                         GraphNodeIdToScopeMap &graphNodeIdToScope,
+                         MetricBuffer &metricBuffer, std::set<Data *> &dataSet,
+                         uint64_t invocations, CUpti_Activity *activity) {
   auto correlationId = 0;
   switch (activity->kind) {
   case CUPTI_ACTIVITY_KIND_KERNEL:
   case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
     correlationId = processActivityKernel(corrIdToExternId, apiExternIds,
-                                          dataSet, activity);
+                                          graphNodeIdToScope, metricBuffer,
+                                          dataSet, invocations, activity);
     break;
   }
   default:
@@ -147,6 +189,34 @@ void setDriverCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
 #undef CALLBACK_ENABLE
 }
 
+void setMemoryCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
+#define CALLBACK_ENABLE(id)                                                    \
+  cupti::enableCallback<true>(static_cast<uint32_t>(enable), subscriber,       \
+                              CUPTI_CB_DOMAIN_DRIVER_API, id)
+
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2);
+  CALLBACK_ENABLE(CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync);
+#undef CALLBACK_ENABLE
+}
+
+bool isMemoryCbId(CUpti_CallbackId cbId) {
+  switch (cbId) {
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2:
+  case CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync:
+    return true;
+  default:
+    return false;
+  }
+}
+
 void setGraphCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
 
 #define CALLBACK_ENABLE(id)                                                    \
@@ -162,6 +232,16 @@ void setGraphCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
 #undef CALLBACK_ENABLE
 }
 
+void setModuleCallbacks(CUpti_SubscriberHandle subscriber, bool enable) {
+#define CALLBACK_ENABLE(id)                                                    \
+  cupti::enableCallback<true>(static_cast<uint32_t>(enable), subscriber,       \
+                              CUPTI_CB_DOMAIN_RESOURCE, id)
+
+  CALLBACK_ENABLE(CUPTI_CBID_RESOURCE_MODULE_LOADED);
+  CALLBACK_ENABLE(CUPTI_CBID_RESOURCE_MODULE_UNLOAD_STARTING);
+#undef CALLBACK_ENABLE
+}
+
 } // namespace
 
 struct CuptiProfiler::CuptiProfilerPimpl
@@ -181,26 +261,33 @@ struct CuptiProfiler::CuptiProfilerPimpl
   static void callbackFn(void *userData, CUpti_CallbackDomain domain,
                          CUpti_CallbackId cbId, const void *cbData);
 
-  static constexpr size_t AlignSize = 8;
-  static constexpr size_t BufferSize = 64 * 1024 * 1024;
   static constexpr size_t AttributeSize = sizeof(size_t);
 
   CUpti_SubscriberHandle subscriber{};
 
+  // Activity buffers are reused across completions.
+  BufferPool bufferPool;
+  // Collects hardware counters if they are requested.
+  CuptiRangeProfiler rangeProfiler;
+  // Samples the PCs of the kernels if it is requested.
+  CuptiPCSampling pcSampling;
+
   ThreadSafeMap<uint32_t, size_t, std::unordered_map<uint32_t, size_t>>
       graphIdToNumInstances;
   ThreadSafeMap<uint32_t, uint32_t, std::unordered_map<uint32_t, uint32_t>>
       graphExecIdToGraphId;
+  // Graph node id -> the scope the node was captured in, inherited by the
+  // nodes cloned from it when the graph is instantiated.
+  GraphNodeIdToScopeMap graphNodeIdToScope;
 };
 
 void CuptiProfiler::CuptiProfilerPimpl::allocBuffer(uint8_t **buffer,
                                                     size_t *bufferSize,
                                                     size_t *maxNumRecords) {
-  *buffer = reinterpret_cast<uint8_t *>(aligned_alloc(AlignSize, BufferSize));
-  if (*buffer == nullptr) {
-    throw std::runtime_error("aligned_alloc failed");
-  }
-  *bufferSize = BufferSize;
+  CuptiProfiler &profiler = threadState.profiler;
+  auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+  *buffer = pImpl->bufferPool.acquire();
+  *bufferSize = pImpl->bufferPool.getBufferSize();
   *maxNumRecords = 0;
 }
 
@@ -210,6 +297,7 @@ void CuptiProfiler::CuptiProfilerPimpl::completeBuffer(CUcontext ctx,
                                                        size_t size,
                                                        size_t validSize) {
   CuptiProfiler &profiler = threadState.profiler;
+  auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
   auto &dataSet = profiler.dataSet;
   uint32_t maxCorrelationId = 0;
   CUptiResult status;
@@ -217,9 +305,10 @@ void CuptiProfiler::CuptiProfilerPimpl::completeBuffer(CUcontext ctx,
   do {
     status = cupti::activityGetNextRecord<false>(buffer, validSize, &activity);
     if (status == CUPTI_SUCCESS) {
-      auto correlationId =
-          processActivity(profiler.correlation.corrIdToExternId,
-                          profiler.correlation.apiExternIds, dataSet, activity);
+      auto correlationId = processActivity(
+          profiler.correlation.corrIdToExternId,
+          profiler.correlation.apiExternIds, pImpl->graphNodeIdToScope,
+          profiler.metricBuffer, dataSet, profiler.samplingInterval, activity);
       maxCorrelationId = std::max(maxCorrelationId, correlationId);
     } else if (status == CUPTI_ERROR_MAX_LIMIT_REACHED) {
       break;
@@ -228,7 +317,10 @@ void CuptiProfiler::CuptiProfilerPimpl::completeBuffer(CUcontext ctx,
     }
   } while (true);
 
-  std::free(buffer);
+  pImpl->bufferPool.release(buffer);
+  size_t dropped = 0;
+  cupti::activityGetNumDroppedRecords<false>(ctx, streamId, &dropped);
+  profiler.numDroppedRecords += dropped;
 
   profiler.correlation.complete(maxCorrelationId);
 }
@@ -238,7 +330,53 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
                                                    CUpti_CallbackId cbId,
                                                    const void *cbData) {
   CuptiProfiler &profiler = threadState.profiler;
-  if (domain == CUPTI_CB_DOMAIN_RESOURCE) {
+  if (domain == CUPTI_CB_DOMAIN_RESOURCE &&
+      (cbId == CUPTI_CBID_RESOURCE_MODULE_LOADED ||
+       cbId == CUPTI_CBID_RESOURCE_MODULE_UNLOAD_STARTING)) {
+    auto *resourceData =
+        reinterpret_cast<CUpti_ResourceData *>(const_cast<void *>(cbData));
+    auto *moduleData =
+        reinterpret_cast<CUpti_ModuleResourceData *>(
+            resourceData->resourceDescriptor);
+    auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
+    if (cbId == CUPTI_CBID_RESOURCE_MODULE_LOADED)
+      pImpl->pcSampling.loadModule(moduleData->pCubin, moduleData->cubinSize);
+    else
+      pImpl->pcSampling.unloadModule(moduleData->pCubin,
+                                     moduleData->cubinSize);
+  } else if (domain == CUPTI_CB_DOMAIN_DRIVER_API && isMemoryCbId(cbId)) {
+    const CUpti_CallbackData *callbackData =
+        reinterpret_cast<const CUpti_CallbackData *>(cbData);
+    const void *params = callbackData->functionParams;
+    if (callbackData->callbackSite == CUPTI_API_ENTER) {
+      if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemFree_v2)
+        threadState.recordFree(
+            static_cast<const cuMemFree_v2_params *>(params)->dptr);
+      else if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemFreeAsync)
+        threadState.recordFree(
+            static_cast<const cuMemFreeAsync_params *>(params)->dptr);
+      return;
+    }
+    // Allocations are recorded once they succeed
+    if (*static_cast<const CUresult *>(callbackData->functionReturnValue) !=
+        CUDA_SUCCESS)
+      return;
+    if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2) {
+      auto *allocParams = static_cast<const cuMemAlloc_v2_params *>(params);
+      threadState.recordAllocation(*allocParams->dptr, allocParams->bytesize);
+    } else if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemAllocManaged) {
+      auto *allocParams =
+          static_cast<const cuMemAllocManaged_params *>(params);
+      threadState.recordAllocation(*allocParams->dptr, allocParams->bytesize);
+    } else if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemAllocAsync) {
+      auto *allocParams = static_cast<const cuMemAllocAsync_params *>(params);
+      threadState.recordAllocation(*allocParams->dptr, allocParams->bytesize);
+    } else if (cbId == CUPTI_DRIVER_TRACE_CBID_cuMemAllocFromPoolAsync) {
+      auto *allocParams =
+          static_cast<const cuMemAllocFromPoolAsync_params *>(params);
+      threadState.recordAllocation(*allocParams->dptr, allocParams->bytesize);
+    }
+  } else if (domain == CUPTI_CB_DOMAIN_RESOURCE) {
     auto *resourceData =
         reinterpret_cast<CUpti_ResourceData *>(const_cast<void *>(cbData));
     auto *graphData =
@@ -256,8 +394,29 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
         pImpl->graphIdToNumInstances[graphId] = 1;
       else
         pImpl->graphIdToNumInstances[graphId]++;
+      uint64_t nodeId = 0;
+      cupti::getGraphNodeId<true>(graphData->node, &nodeId);
+      if (cbId == CUPTI_CBID_RESOURCE_GRAPHNODE_CREATED) {
+        // Nodes captured from a stream are created inside the launch API,
+        // whose scope is the last one on this thread
+        auto &externIdQueue = profiler.correlation.externIdQueue;
+        if (!externIdQueue.empty()) {
+          auto scopeId = externIdQueue.back();
+          pImpl->graphNodeIdToScope[nodeId] = {
+              scopeId, profiler.correlation.apiExternIds.contain(scopeId)};
+        }
+      } else {
+        uint64_t originalNodeId = 0;
+        cupti::getGraphNodeId<true>(graphData->originalNode, &originalNodeId);
+        if (pImpl->graphNodeIdToScope.contain(originalNodeId))
+          pImpl->graphNodeIdToScope[nodeId] =
+              pImpl->graphNodeIdToScope.at(originalNodeId);
+      }
     } else if (cbId == CUPTI_CBID_RESOURCE_GRAPHNODE_DESTROY_STARTING) {
       pImpl->graphIdToNumInstances[graphId]--;
+      uint64_t nodeId = 0;
+      cupti::getGraphNodeId<true>(graphData->node, &nodeId);
+      pImpl->graphNodeIdToScope.erase(nodeId);
     } else if (cbId == CUPTI_CBID_RESOURCE_GRAPHEXEC_CREATED) {
       pImpl->graphExecIdToGraphId[graphExecId] = graphId;
     } else if (cbId == CUPTI_CBID_RESOURCE_GRAPHEXEC_DESTROY_STARTING) {
@@ -268,14 +427,24 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
   } else {
     const CUpti_CallbackData *callbackData =
         reinterpret_cast<const CUpti_CallbackData *>(cbData);
+    auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
     if (callbackData->callbackSite == CUPTI_API_ENTER) {
+      // Launches that are not sampled are neither correlated nor submitted, so
+      // their activity records are dropped.
+      if (!threadState.enterLaunch())
+        return;
       auto scopeId = Scope::getNewScopeId();
       threadState.record(scopeId);
       threadState.enterOp(scopeId);
       size_t numInstances = 1;
+      auto isGraphLaunch =
+          domain == CUPTI_CB_DOMAIN_DRIVER_API
+              ? (cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch ||
+                 cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch_ptsz)
+              : (cbId == CUPTI_RUNTIME_TRACE_CBID_cudaGraphLaunch_v10000 ||
+                 cbId == CUPTI_RUNTIME_TRACE_CBID_cudaGraphLaunch_ptsz_v10000);
       if (cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch ||
           cbId == CUPTI_DRIVER_TRACE_CBID_cuGraphLaunch_ptsz) {
-        auto *pImpl = dynamic_cast<CuptiProfilerPimpl *>(profiler.pImpl.get());
         auto graphExec = reinterpret_cast<const cuGraphLaunch_params *>(
                              callbackData->functionParams)
                              ->hGraph;
@@ -298,7 +467,30 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
                     << std::endl;
       }
       profiler.correlation.correlate(callbackData->correlationId, numInstances);
+      auto &externIdQueue = profiler.correlation.externIdQueue;
+      if (pImpl->rangeProfiler.isEnabled() && !externIdQueue.empty()) {
+        // Graph kernels are not replayed
+        auto externId = externIdQueue.back();
+        pImpl->rangeProfiler.enterKernel(
+            callbackData->context,
+            isGraphLaunch ? nullptr : callbackData->symbolName, externId,
+            profiler.correlation.apiExternIds.contain(externId),
+            profiler.getDataSet());
+      }
+      if (pImpl->pcSampling.isEnabled() && !externIdQueue.empty()) {
+        // Graph kernels are not sampled
+        auto externId = externIdQueue.back();
+        pImpl->pcSampling.enterKernel(
+            callbackData->context,
+            isGraphLaunch ? nullptr : callbackData->symbolName, externId,
+            profiler.correlation.apiExternIds.contain(externId),
+            profiler.getDataSet());
+      }
     } else if (callbackData->callbackSite == CUPTI_API_EXIT) {
+      if (!threadState.exitLaunch())
+        return;
+      pImpl->rangeProfiler.exitKernel();
+      profiler.numDroppedSamples += pImpl->pcSampling.exitKernel();
       threadState.exitOp();
       profiler.correlation.submit(callbackData->correlationId);
     }
@@ -306,6 +498,13 @@ void CuptiProfiler::CuptiProfilerPimpl::callbackFn(void *userData,
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doStart() {
+  auto &options = profiler.bufferOptions;
+  bufferPool.reset(options.bufferSize, options.numBuffers, options.hugePages);
+  profiler.numDroppedRecords = 0;
+  profiler.numDroppedSamples = 0;
+  profiler.metricBuffer.start();
+  rangeProfiler.start(profiler.counterOptions, profiler.samplingInterval);
+  pcSampling.start(profiler.pcSamplingOptions, profiler.samplingInterval);
   cupti::activityRegisterCallbacks<true>(allocBuffer, completeBuffer);
   cupti::activityEnable<true>(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL);
   // TODO: switch to directly subscribe the APIs and measure overhead
@@ -313,6 +512,10 @@ void CuptiProfiler::CuptiProfilerPimpl::doStart() {
   setGraphCallbacks(subscriber, /*enable=*/true);
   setRuntimeCallbacks(subscriber, /*enable=*/true);
   setDriverCallbacks(subscriber, /*enable=*/true);
+  if (pcSampling.isEnabled())
+    setModuleCallbacks(subscriber, /*enable=*/true);
+  if (profiler.memoryOptions.enabled)
+    setMemoryCallbacks(subscriber, /*enable=*/true);
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doFlush() {
@@ -338,15 +541,31 @@ void CuptiProfiler::CuptiProfilerPimpl::doFlush() {
   // activities are flushed so that the next profiling session can start with
   // new activities.
   cupti::activityFlushAll<true>(/*flag=*/CUPTI_ACTIVITY_FLAG_FLUSH_FORCED);
+  // Make the flushed activities visible in the data objects.
+  profiler.metricBuffer.flush();
+  rangeProfiler.flush(profiler.dataSet);
 }
 
 void CuptiProfiler::CuptiProfilerPimpl::doStop() {
+  rangeProfiler.stop(profiler.dataSet);
   cupti::activityDisable<true>(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL);
   setGraphCallbacks(subscriber, /*enable=*/false);
   setRuntimeCallbacks(subscriber, /*enable=*/false);
   setDriverCallbacks(subscriber, /*enable=*/false);
+  if (pcSampling.isEnabled())
+    setModuleCallbacks(subscriber, /*enable=*/false);
+  setMemoryCallbacks(subscriber, /*enable=*/false);
+  profiler.memory.clear();
+  pcSampling.stop();
   cupti::unsubscribe<true>(subscriber);
   cupti::finalize<true>();
+  profiler.metricBuffer.stop();
+  if (profiler.numDroppedRecords > 0)
+    std::cerr << "[PROTON] " << profiler.numDroppedRecords
+              << " activity records were dropped. Consider increasing the "
+                 "buffer size or count."
+              << std::endl;
+  bufferPool.clear();
 }
 
 CuptiProfiler::CuptiProfiler() {
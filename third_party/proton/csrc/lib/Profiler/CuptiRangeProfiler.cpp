@@ -0,0 +1,522 @@
+#include "Profiler/CuptiRangeProfiler.h"
+#include "Data/Metric.h"
+#include "Driver/GPU/CudaApi.h"
+#include "Driver/GPU/CuptiApi.h"
+#include "Driver/GPU/NvperfApi.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace proton {
+
+namespace {
+
+constexpr size_t MaxRangeNameLength = 64;
+
+template <typename T> const uint8_t *getDataOrNull(const T &image) {
+  return image.empty() ? nullptr : image.data();
+}
+
+// Translates metric names into the raw counters to collect, and evaluates the
+// metrics from the collected counter data.
+class MetricsEvaluator {
+public:
+  MetricsEvaluator(const std::string &chipName,
+                   const std::vector<uint8_t> &counterAvailabilityImage,
+                   const std::vector<uint8_t> &counterDataImage) {
+    NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params sizeParams = {
+        NVPW_CUDA_MetricsEvaluator_CalculateScratchBufferSize_Params_STRUCT_SIZE};
+    sizeParams.pChipName = chipName.c_str();
+    sizeParams.pCounterAvailabilityImage =
+        getDataOrNull(counterAvailabilityImage);
+    nvperf::metricsEvaluatorCalculateScratchBufferSize<true>(&sizeParams);
+    scratchBuffer.resize(sizeParams.scratchBufferSize);
+
+    NVPW_CUDA_MetricsEvaluator_Initialize_Params initParams = {
+        NVPW_CUDA_MetricsEvaluator_Initialize_Params_STRUCT_SIZE};
+    initParams.scratchBufferSize = scratchBuffer.size();
+    initParams.pScratchBuffer = scratchBuffer.data();
+    initParams.pChipName = chipName.c_str();
+    initParams.pCounterAvailabilityImage =
+        getDataOrNull(counterAvailabilityImage);
+    initParams.pCounterDataImage = getDataOrNull(counterDataImage);
+    initParams.counterDataImageSize = counterDataImage.size();
+    nvperf::metricsEvaluatorInitialize<true>(&initParams);
+    evaluator = initParams.pMetricsEvaluator;
+  }
+
+  ~MetricsEvaluator() {
+    NVPW_MetricsEvaluator_Destroy_Params destroyParams = {
+        NVPW_MetricsEvaluator_Destroy_Params_STRUCT_SIZE};
+    destroyParams.pMetricsEvaluator = evaluator;
+    nvperf::metricsEvaluatorDestroy<false>(&destroyParams);
+  }
+
+  std::vector<NVPW_MetricEvalRequest>
+  getEvalRequests(const std::vector<std::string> &metrics) {
+    std::vector<NVPW_MetricEvalRequest> requests(metrics.size());
+    for (size_t i = 0; i < metrics.size(); ++i) {
+      NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params
+          convertParams = {
+              NVPW_MetricsEvaluator_ConvertMetricNameToMetricEvalRequest_Params_STRUCT_SIZE};
+      convertParams.pMetricsEvaluator = evaluator;
+      convertParams.pMetricName = metrics[i].c_str();
+      convertParams.pMetricEvalRequest = &requests[i];
+      convertParams.metricEvalRequestStructSize =
+          NVPW_MetricEvalRequest_STRUCT_SIZE;
+      if (nvperf::metricsEvaluatorConvertMetricNameToMetricEvalRequest<false>(
+              &convertParams) != NVPA_STATUS_SUCCESS)
+        throw std::runtime_error("Unknown counter: " + metrics[i]);
+    }
+    return requests;
+  }
+
+  std::vector<std::string>
+  getRawDependencies(std::vector<NVPW_MetricEvalRequest> &requests) {
+    NVPW_MetricsEvaluator_GetMetricRawDependencies_Params dependencyParams = {
+        NVPW_MetricsEvaluator_GetMetricRawDependencies_Params_STRUCT_SIZE};
+    dependencyParams.pMetricsEvaluator = evaluator;
+    dependencyParams.pMetricEvalRequests = requests.data();
+    dependencyParams.numMetricEvalRequests = requests.size();
+    dependencyParams.metricEvalRequestStructSize =
+        NVPW_MetricEvalRequest_STRUCT_SIZE;
+    dependencyParams.metricEvalRequestStrideSize =
+        sizeof(NVPW_MetricEvalRequest);
+    // The first call only returns the number of dependencies
+    nvperf::metricsEvaluatorGetMetricRawDependencies<true>(&dependencyParams);
+    std::vector<const char *> dependencies(dependencyParams.numRawDependencies);
+    dependencyParams.ppRawDependencies = dependencies.data();
+    nvperf::metricsEvaluatorGetMetricRawDependencies<true>(&dependencyParams);
+    return std::vector<std::string>(dependencies.begin(), dependencies.end());
+  }
+
+  void setDeviceAttributes(const std::vector<uint8_t> &counterDataImage) {
+    NVPW_MetricsEvaluator_SetDeviceAttributes_Params attributeParams = {
+        NVPW_MetricsEvaluator_SetDeviceAttributes_Params_STRUCT_SIZE};
+    attributeParams.pMetricsEvaluator = evaluator;
+    attributeParams.pCounterDataImage = counterDataImage.data();
+    attributeParams.counterDataImageSize = counterDataImage.size();
+    nvperf::metricsEvaluatorSetDeviceAttributes<true>(&attributeParams);
+  }
+
+  std::vector<double>
+  evaluate(std::vector<NVPW_MetricEvalRequest> &requests,
+           const std::vector<uint8_t> &counterDataImage, size_t rangeIndex) {
+    std::vector<double> values(requests.size());
+    NVPW_MetricsEvaluator_EvaluateToGpuValues_Params evaluateParams = {
+        NVPW_MetricsEvaluator_EvaluateToGpuValues_Params_STRUCT_SIZE};
+    evaluateParams.pMetricsEvaluator = evaluator;
+    evaluateParams.pMetricEvalRequests = requests.data();
+    evaluateParams.numMetricEvalRequests = requests.size();
+    evaluateParams.metricEvalRequestStructSize =
+        NVPW_MetricEvalRequest_STRUCT_SIZE;
+    evaluateParams.metricEvalRequestStrideSize = sizeof(NVPW_MetricEvalRequest);
+    evaluateParams.pCounterDataImage = counterDataImage.data();
+    evaluateParams.counterDataImageSize = counterDataImage.size();
+    evaluateParams.rangeIndex = rangeIndex;
+    evaluateParams.isolated = true;
+    evaluateParams.pMetricValues = values.data();
+    nvperf::metricsEvaluatorEvaluateToGpuValues<true>(&evaluateParams);
+    return values;
+  }
+
+private:
+  std::vector<uint8_t> scratchBuffer;
+  NVPW_MetricsEvaluator *evaluator{};
+};
+
+std::vector<NVPA_RawMetricRequest>
+getRawMetricRequests(const std::vector<std::string> &rawMetrics) {
+  std::vector<NVPA_RawMetricRequest> requests;
+  for (const auto &rawMetric : rawMetrics) {
+    NVPA_RawMetricRequest request = {NVPA_RAW_METRIC_REQUEST_STRUCT_SIZE};
+    request.pMetricName = rawMetric.c_str();
+    request.isolated = true;
+    request.keepInstances = true;
+    requests.push_back(request);
+  }
+  return requests;
+}
+
+std::vector<uint8_t>
+createConfigImage(const std::string &chipName,
+                  const std::vector<uint8_t> &counterAvailabilityImage,
+                  std::vector<NVPA_RawMetricRequest> &requests) {
+  NVPW_CUDA_RawMetricsConfig_Create_V2_Params createParams = {
+      NVPW_CUDA_RawMetricsConfig_Create_V2_Params_STRUCT_SIZE};
+  createParams.activityKind = NVPA_ACTIVITY_KIND_PROFILER;
+  createParams.pChipName = chipName.c_str();
+  createParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+  nvperf::rawMetricsConfigCreate<true>(&createParams);
+  auto *config = createParams.pRawMetricsConfig;
+
+  NVPW_RawMetricsConfig_SetCounterAvailability_Params availabilityParams = {
+      NVPW_RawMetricsConfig_SetCounterAvailability_Params_STRUCT_SIZE};
+  availabilityParams.pRawMetricsConfig = config;
+  availabilityParams.pCounterAvailabilityImage =
+      counterAvailabilityImage.data();
+  nvperf::rawMetricsConfigSetCounterAvailability<true>(&availabilityParams);
+
+  NVPW_RawMetricsConfig_BeginPassGroup_Params beginParams = {
+      NVPW_RawMetricsConfig_BeginPassGroup_Params_STRUCT_SIZE};
+  beginParams.pRawMetricsConfig = config;
+  nvperf::rawMetricsConfigBeginPassGroup<true>(&beginParams);
+
+  NVPW_RawMetricsConfig_AddMetrics_Params addParams = {
+      NVPW_RawMetricsConfig_AddMetrics_Params_STRUCT_SIZE};
+  addParams.pRawMetricsConfig = config;
+  addParams.pRawMetricRequests = requests.data();
+  addParams.numMetricRequests = requests.size();
+  nvperf::rawMetricsConfigAddMetrics<true>(&addParams);
+
+  NVPW_RawMetricsConfig_EndPassGroup_Params endParams = {
+      NVPW_RawMetricsConfig_EndPassGroup_Params_STRUCT_SIZE};
+  endParams.pRawMetricsConfig = config;
+  nvperf::rawMetricsConfigEndPassGroup<true>(&endParams);
+
+  NVPW_RawMetricsConfig_GenerateConfigImage_Params generateParams = {
+      NVPW_RawMetricsConfig_GenerateConfigImage_Params_STRUCT_SIZE};
+  generateParams.pRawMetricsConfig = config;
+  nvperf::rawMetricsConfigGenerateConfigImage<true>(&generateParams);
+
+  NVPW_RawMetricsConfig_GetConfigImage_Params imageParams = {
+      NVPW_RawMetricsConfig_GetConfigImage_Params_STRUCT_SIZE};
+  imageParams.pRawMetricsConfig = config;
+  // The first call only returns the size of the image
+  nvperf::rawMetricsConfigGetConfigImage<true>(&imageParams);
+  std::vector<uint8_t> configImage(imageParams.bytesCopied);
+  imageParams.bytesAllocated = configImage.size();
+  imageParams.pBuffer = configImage.data();
+  nvperf::rawMetricsConfigGetConfigImage<true>(&imageParams);
+
+  NVPW_RawMetricsConfig_Destroy_Params destroyParams = {
+      NVPW_RawMetricsConfig_Destroy_Params_STRUCT_SIZE};
+  destroyParams.pRawMetricsConfig = config;
+  nvperf::rawMetricsConfigDestroy<true>(&destroyParams);
+  return configImage;
+}
+
+std::vector<uint8_t>
+createCounterDataPrefix(const std::string &chipName,
+                        const std::vector<uint8_t> &counterAvailabilityImage,
+                        std::vector<NVPA_RawMetricRequest> &requests) {
+  NVPW_CUDA_CounterDataBuilder_Create_Params createParams = {
+      NVPW_CUDA_CounterDataBuilder_Create_Params_STRUCT_SIZE};
+  createParams.pChipName = chipName.c_str();
+  createParams.pCounterAvailabilityImage = counterAvailabilityImage.data();
+  nvperf::counterDataBuilderCreate<true>(&createParams);
+  auto *builder = createParams.pCounterDataBuilder;
+
+  NVPW_CounterDataBuilder_AddMetrics_Params addParams = {
+      NVPW_CounterDataBuilder_AddMetrics_Params_STRUCT_SIZE};
+  addParams.pCounterDataBuilder = builder;
+  addParams.pRawMetricRequests = requests.data();
+  addParams.numMetricRequests = requests.size();
+  nvperf::counterDataBuilderAddMetrics<true>(&addParams);
+
+  NVPW_CounterDataBuilder_GetCounterDataPrefix_Params prefixParams = {
+      NVPW_CounterDataBuilder_GetCounterDataPrefix_Params_STRUCT_SIZE};
+  prefixParams.pCounterDataBuilder = builder;
+  // The first call only returns the size of the prefix
+  nvperf::counterDataBuilderGetCounterDataPrefix<true>(&prefixParams);
+  std::vector<uint8_t> prefix(prefixParams.bytesCopied);
+  prefixParams.bytesAllocated = prefix.size();
+  prefixParams.pBuffer = prefix.data();
+  nvperf::counterDataBuilderGetCounterDataPrefix<true>(&prefixParams);
+
+  NVPW_CounterDataBuilder_Destroy_Params destroyParams = {
+      NVPW_CounterDataBuilder_Destroy_Params_STRUCT_SIZE};
+  destroyParams.pCounterDataBuilder = builder;
+  nvperf::counterDataBuilderDestroy<true>(&destroyParams);
+  return prefix;
+}
+
+} // namespace
+
+struct CuptiRangeProfiler::ContextSession {
+  CUcontext context{};
+  std::string chipName;
+  std::vector<uint8_t> configImage;
+  std::vector<uint8_t> counterDataPrefix;
+  std::vector<uint8_t> counterDataImage;
+  std::vector<uint8_t> counterDataScratchBuffer;
+  // Ranges collected in the counter data image, in launch order
+  std::vector<Range> ranges;
+  bool inSession{};
+
+  void initializeCounterData(size_t maxRanges) {
+    CUpti_Profiler_CounterDataImageOptions options = {
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE};
+    options.pCounterDataPrefix = counterDataPrefix.data();
+    options.counterDataPrefixSize = counterDataPrefix.size();
+    options.maxNumRanges = maxRanges;
+    options.maxNumRangeTreeNodes = maxRanges;
+    options.maxRangeNameLength = MaxRangeNameLength;
+
+    CUpti_Profiler_CounterDataImage_CalculateSize_Params sizeParams = {
+        CUpti_Profiler_CounterDataImage_CalculateSize_Params_STRUCT_SIZE};
+    sizeParams.sizeofCounterDataImageOptions =
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE;
+    sizeParams.pOptions = &options;
+    cupti::profilerCounterDataImageCalculateSize<true>(&sizeParams);
+    counterDataImage.assign(sizeParams.counterDataImageSize, 0);
+
+    CUpti_Profiler_CounterDataImage_Initialize_Params initParams = {
+        CUpti_Profiler_CounterDataImage_Initialize_Params_STRUCT_SIZE};
+    initParams.sizeofCounterDataImageOptions =
+        CUpti_Profiler_CounterDataImageOptions_STRUCT_SIZE;
+    initParams.pOptions = &options;
+    initParams.counterDataImageSize = counterDataImage.size();
+    initParams.pCounterDataImage = counterDataImage.data();
+    cupti::profilerCounterDataImageInitialize<true>(&initParams);
+
+    CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params
+        scratchSizeParams = {
+            CUpti_Profiler_CounterDataImage_CalculateScratchBufferSize_Params_STRUCT_SIZE};
+    scratchSizeParams.counterDataImageSize = counterDataImage.size();
+    scratchSizeParams.pCounterDataImage = counterDataImage.data();
+    cupti::profilerCounterDataImageCalculateScratchBufferSize<true>(
+        &scratchSizeParams);
+    counterDataScratchBuffer.assign(
+        scratchSizeParams.counterDataScratchBufferSize, 0);
+
+    CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params
+        scratchParams = {
+            CUpti_Profiler_CounterDataImage_InitializeScratchBuffer_Params_STRUCT_SIZE};
+    scratchParams.counterDataImageSize = counterDataImage.size();
+    scratchParams.pCounterDataImage = counterDataImage.data();
+    scratchParams.counterDataScratchBufferSize =
+        counterDataScratchBuffer.size();
+    scratchParams.pCounterDataScratchBuffer = counterDataScratchBuffer.data();
+    cupti::profilerCounterDataImageInitializeScratchBuffer<true>(
+        &scratchParams);
+  }
+
+  void beginSession(size_t maxRanges) {
+    CUpti_Profiler_BeginSession_Params beginParams = {
+        CUpti_Profiler_BeginSession_Params_STRUCT_SIZE};
+    beginParams.ctx = context;
+    beginParams.counterDataImageSize = counterDataImage.size();
+    beginParams.pCounterDataImage = counterDataImage.data();
+    beginParams.counterDataScratchBufferSize = counterDataScratchBuffer.size();
+    beginParams.pCounterDataScratchBuffer = counterDataScratchBuffer.data();
+    // Every kernel is a range and is replayed until all the counters are
+    // collected.
+    beginParams.range = CUPTI_AutoRange;
+    beginParams.replayMode = CUPTI_KernelReplay;
+    beginParams.maxRangesPerPass = maxRanges;
+    beginParams.maxLaunchesPerPass = maxRanges;
+    cupti::profilerBeginSession<true>(&beginParams);
+
+    CUpti_Profiler_SetConfig_Params configParams = {
+        CUpti_Profiler_SetConfig_Params_STRUCT_SIZE};
+    configParams.ctx = context;
+    configParams.pConfig = configImage.data();
+    configParams.configSize = configImage.size();
+    configParams.passIndex = 0;
+    configParams.minNestingLevel = 1;
+    configParams.numNestingLevels = 1;
+    configParams.targetNestingLevel = 1;
+    cupti::profilerSetConfig<true>(&configParams);
+    inSession = true;
+  }
+
+  void endSession() {
+    if (!inSession)
+      return;
+    CUpti_Profiler_FlushCounterData_Params flushParams = {
+        CUpti_Profiler_FlushCounterData_Params_STRUCT_SIZE};
+    flushParams.ctx = context;
+    cupti::profilerFlushCounterData<true>(&flushParams);
+    CUpti_Profiler_UnsetConfig_Params unsetParams = {
+        CUpti_Profiler_UnsetConfig_Params_STRUCT_SIZE};
+    unsetParams.ctx = context;
+    cupti::profilerUnsetConfig<true>(&unsetParams);
+    CUpti_Profiler_EndSession_Params endParams = {
+        CUpti_Profiler_EndSession_Params_STRUCT_SIZE};
+    endParams.ctx = context;
+    cupti::profilerEndSession<true>(&endParams);
+    inSession = false;
+  }
+};
+
+struct CuptiRangeProfiler::LaunchState {
+  // Number of launch APIs entered on this thread
+  size_t depth{};
+  // Set while a kernel is profiled
+  ContextSession *session{};
+  Range range{};
+  std::set<Data *> dataSet;
+  std::unique_lock<std::mutex> lock;
+};
+
+thread_local CuptiRangeProfiler::LaunchState CuptiRangeProfiler::launchState{};
+
+CuptiRangeProfiler::CuptiRangeProfiler() = default;
+
+CuptiRangeProfiler::~CuptiRangeProfiler() = default;
+
+void CuptiRangeProfiler::start(const CounterOptions &options,
+                               size_t invocations) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (options.metrics.empty() || enabled)
+    return;
+  metrics = options.metrics;
+  this->invocations = invocations;
+  kernelFilter = std::regex(options.kernelFilter);
+  maxRanges = std::max<size_t>(options.maxRanges, 1);
+  static std::once_flag hostInitialized;
+  std::call_once(hostInitialized, []() {
+    NVPW_InitializeHost_Params initParams = {
+        NVPW_InitializeHost_Params_STRUCT_SIZE};
+    nvperf::initializeHost<true>(&initParams);
+  });
+  CUpti_Profiler_Initialize_Params initParams = {
+      CUpti_Profiler_Initialize_Params_STRUCT_SIZE};
+  cupti::profilerInitialize<true>(&initParams);
+  enabled = true;
+}
+
+void CuptiRangeProfiler::flush(const std::set<Data *> &dataSet) {
+  if (!enabled)
+    return;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &[context, session] : sessions)
+    evaluate(*session, dataSet);
+}
+
+void CuptiRangeProfiler::stop(const std::set<Data *> &dataSet) {
+  if (!enabled)
+    return;
+  flush(dataSet);
+  std::lock_guard<std::mutex> lock(mutex);
+  sessions.clear();
+  CUpti_Profiler_DeInitialize_Params deinitParams = {
+      CUpti_Profiler_DeInitialize_Params_STRUCT_SIZE};
+  cupti::profilerDeInitialize<true>(&deinitParams);
+  enabled = false;
+}
+
+CuptiRangeProfiler::ContextSession &
+CuptiRangeProfiler::getSession(CUcontext context) {
+  auto &session = sessions[context];
+  if (session)
+    return *session;
+  session = std::make_unique<ContextSession>();
+  session->context = context;
+
+  // The context is current in the launch callbacks
+  CUdevice device;
+  cuda::ctxGetDevice<true>(&device);
+  CUpti_Device_GetChipName_Params chipNameParams = {
+      CUpti_Device_GetChipName_Params_STRUCT_SIZE};
+  chipNameParams.deviceIndex = static_cast<size_t>(device);
+  cupti::deviceGetChipName<true>(&chipNameParams);
+  session->chipName = chipNameParams.pChipName;
+
+  CUpti_Profiler_GetCounterAvailability_Params availabilityParams = {
+      CUpti_Profiler_GetCounterAvailability_Params_STRUCT_SIZE};
+  availabilityParams.ctx = context;
+  // The first call only returns the size of the image
+  cupti::profilerGetCounterAvailability<true>(&availabilityParams);
+  std::vector<uint8_t> counterAvailabilityImage(
+      availabilityParams.counterAvailabilityImageSize);
+  availabilityParams.pCounterAvailabilityImage =
+      counterAvailabilityImage.data();
+  cupti::profilerGetCounterAvailability<true>(&availabilityParams);
+
+  MetricsEvaluator evaluator(session->chipName, counterAvailabilityImage,
+                             /*counterDataImage=*/{});
+  auto evalRequests = evaluator.getEvalRequests(metrics);
+  auto rawMetrics = evaluator.getRawDependencies(evalRequests);
+  auto rawRequests = getRawMetricRequests(rawMetrics);
+  session->configImage = createConfigImage(
+      session->chipName, counterAvailabilityImage, rawRequests);
+  session->counterDataPrefix = createCounterDataPrefix(
+      session->chipName, counterAvailabilityImage, rawRequests);
+  session->initializeCounterData(maxRanges);
+  return *session;
+}
+
+void CuptiRangeProfiler::evaluate(ContextSession &session,
+                                  const std::set<Data *> &dataSet) {
+  session.endSession();
+  if (session.ranges.empty())
+    return;
+
+  NVPW_CounterData_GetNumRanges_Params rangeParams = {
+      NVPW_CounterData_GetNumRanges_Params_STRUCT_SIZE};
+  rangeParams.pCounterDataImage = session.counterDataImage.data();
+  nvperf::counterDataGetNumRanges<true>(&rangeParams);
+  auto numRanges = std::min(rangeParams.numRanges, session.ranges.size());
+  if (numRanges < session.ranges.size())
+    std::cerr << "[PROTON] Counters of " << session.ranges.size() - numRanges
+              << " kernels were not collected." << std::endl;
+
+  MetricsEvaluator evaluator(session.chipName,
+                             /*counterAvailabilityImage=*/{},
+                             session.counterDataImage);
+  evaluator.setDeviceAttributes(session.counterDataImage);
+  auto evalRequests = evaluator.getEvalRequests(metrics);
+  for (size_t i = 0; i < numRanges; ++i) {
+    auto values =
+        evaluator.evaluate(evalRequests, session.counterDataImage, i);
+    // Extrapolate to the launches that are not sampled
+    for (auto &value : values)
+      value *= invocations;
+    auto &range = session.ranges[i];
+    for (auto *data : dataSet) {
+      auto scopeId = range.scopeId;
+      if (range.isAPI)
+        scopeId = data->addScope(range.scopeId, range.kernelName);
+      data->addMetric(scopeId,
+                      std::make_shared<CounterMetric>(metrics, values));
+    }
+  }
+  session.ranges.clear();
+  // Start the next batch with an empty image
+  session.initializeCounterData(maxRanges);
+}
+
+void CuptiRangeProfiler::enterKernel(CUcontext context, const char *kernelName,
+                                     size_t scopeId, bool isAPI,
+                                     const std::set<Data *> &dataSet) {
+  if (!enabled)
+    return;
+  if (launchState.depth++ > 0)
+    return;
+  if (kernelName == nullptr || !std::regex_search(kernelName, kernelFilter))
+    return;
+  launchState.lock = std::unique_lock<std::mutex>(mutex);
+  auto &session = getSession(context);
+  if (!session.inSession)
+    session.beginSession(maxRanges);
+  CUpti_Profiler_EnableProfiling_Params enableParams = {
+      CUpti_Profiler_EnableProfiling_Params_STRUCT_SIZE};
+  enableParams.ctx = context;
+  cupti::profilerEnableProfiling<true>(&enableParams);
+  launchState.session = &session;
+  launchState.range = {scopeId, isAPI, kernelName};
+  launchState.dataSet = dataSet;
+}
+
+void CuptiRangeProfiler::exitKernel() {
+  if (launchState.depth == 0 || --launchState.depth > 0)
+    return;
+  auto *session = launchState.session;
+  if (session == nullptr)
+    return;
+  CUpti_Profiler_DisableProfiling_Params disableParams = {
+      CUpti_Profiler_DisableProfiling_Params_STRUCT_SIZE};
+  disableParams.ctx = session->context;
+  cupti::profilerDisableProfiling<true>(&disableParams);
+  session->ranges.push_back(launchState.range);
+  if (session->ranges.size() >= maxRanges)
+    evaluate(*session, launchState.dataSet);
+  launchState.session = nullptr;
+  launchState.dataSet.clear();
+  launchState.lock.unlock();
+}
+
+} // namespace proton
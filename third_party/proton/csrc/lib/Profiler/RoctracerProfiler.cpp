@@ -13,6 +13,7 @@
 #include <deque>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <tuple>
 
 #include <cxxabi.h>
@@ -70,16 +71,18 @@ private:
 };
 
 std::shared_ptr<Metric>
-convertActivityToMetric(const roctracer_record_t *activity) {
+convertActivityToMetric(const roctracer_record_t *activity,
+                        uint64_t invocations) {
   std::shared_ptr<Metric> metric;
   switch (activity->kind) {
   case kHipVdiCommandKernel: {
     metric = std::make_shared<KernelMetric>(
         static_cast<uint64_t>(activity->begin_ns),
-        static_cast<uint64_t>(activity->end_ns), 1,
+        static_cast<uint64_t>(activity->end_ns), invocations,
         static_cast<uint64_t>(
             DeviceInfo::instance().mapDeviceId(activity->device_id)),
-        static_cast<uint64_t>(DeviceType::HIP));
+        static_cast<uint64_t>(DeviceType::HIP),
+        static_cast<uint64_t>(activity->queue_id));
     break;
   }
   default:
@@ -89,7 +92,8 @@ convertActivityToMetric(const roctracer_record_t *activity) {
 }
 
 void processActivityKernel(size_t externId, std::set<Data *> &dataSet,
-                           const roctracer_record_t *activity, bool isAPI) {
+                           const roctracer_record_t *activity, bool isAPI,
+                           uint64_t invocations) {
   if (externId == Scope::DummyScopeId)
     return;
   auto correlationId = activity->correlation_id;
@@ -97,16 +101,19 @@ void processActivityKernel(size_t externId, std::set<Data *> &dataSet,
     auto scopeId = externId;
     if (isAPI)
       scopeId = data->addScope(/*parentId=*/externId, activity->kernel_name);
-    data->addMetric(scopeId, convertActivityToMetric(activity));
+    data->addMetric(scopeId, convertActivityToMetric(activity, invocations));
+    // The correlation of the launch is erased after its kernel
+    data->removeScope(externId);
   }
 }
 
 void processActivity(size_t externId, std::set<Data *> &dataSet,
-                     const roctracer_record_t *record, bool isAPI) {
+                     const roctracer_record_t *record, bool isAPI,
+                     uint64_t invocations) {
   switch (record->kind) {
   case 0x11F1: // Task - kernel enqueued by graph launch
   case kHipVdiCommandKernel: {
-    processActivityKernel(externId, dataSet, record, isAPI);
+    processActivityKernel(externId, dataSet, record, isAPI, invocations);
     break;
   }
   default:
@@ -143,6 +150,19 @@ std::pair<bool, bool> matchKernelCbId(uint32_t cbId) {
   return std::make_pair(isRuntimeApi, isDriverApi);
 }
 
+bool isMemoryCbId(uint32_t cbId) {
+  switch (cbId) {
+  case HIP_API_ID_hipMalloc:
+  case HIP_API_ID_hipMallocManaged:
+  case HIP_API_ID_hipMallocAsync:
+  case HIP_API_ID_hipFree:
+  case HIP_API_ID_hipFreeAsync:
+    return true;
+  default:
+    return false;
+  }
+}
+
 } // namespace
 
 struct RoctracerProfiler::RoctracerProfilerPimpl
@@ -159,28 +179,68 @@ struct RoctracerProfiler::RoctracerProfilerPimpl
                           const void *callbackData, void *arg);
   static void activityCallback(const char *begin, const char *end, void *arg);
 
-  static constexpr size_t BufferSize = 64 * 1024 * 1024;
+  static void trackMemory(uint32_t cid, const hip_api_data_t *data);
+
+  // Whether the memory allocation APIs are tracked since the profiler started
+  bool memoryTracked{false};
 };
 
-void RoctracerProfiler::RoctracerProfilerPimpl::apiCallback(
-    uint32_t domain, uint32_t cid, const void *callbackData, void *arg) {
-  auto [isRuntimeAPI, isDriverAPI] = matchKernelCbId(cid);
-  if (!(isRuntimeAPI || isDriverAPI)) {
+void RoctracerProfiler::RoctracerProfilerPimpl::trackMemory(
+    uint32_t cid, const hip_api_data_t *data) {
+  auto toAddress = [](const void *ptr) {
+    return reinterpret_cast<uint64_t>(ptr);
+  };
+  if (data->phase == ACTIVITY_API_PHASE_ENTER) {
+    if (cid == HIP_API_ID_hipFree)
+      threadState.recordFree(toAddress(data->args.hipFree.ptr));
+    else if (cid == HIP_API_ID_hipFreeAsync)
+      threadState.recordFree(toAddress(data->args.hipFreeAsync.dev_ptr));
     return;
   }
+  // A failed allocation leaves the pointer null
+  if (cid == HIP_API_ID_hipMalloc && *data->args.hipMalloc.ptr)
+    threadState.recordAllocation(toAddress(*data->args.hipMalloc.ptr),
+                                 data->args.hipMalloc.size);
+  else if (cid == HIP_API_ID_hipMallocManaged &&
+           *data->args.hipMallocManaged.dev_ptr)
+    threadState.recordAllocation(
+        toAddress(*data->args.hipMallocManaged.dev_ptr),
+        data->args.hipMallocManaged.size);
+  else if (cid == HIP_API_ID_hipMallocAsync &&
+           *data->args.hipMallocAsync.dev_ptr)
+    threadState.recordAllocation(toAddress(*data->args.hipMallocAsync.dev_ptr),
+                                 data->args.hipMallocAsync.size);
+}
+
+void RoctracerProfiler::RoctracerProfilerPimpl::apiCallback(
+    uint32_t domain, uint32_t cid, const void *callbackData, void *arg) {
   auto &profiler =
       dynamic_cast<RoctracerProfiler &>(RoctracerProfiler::instance());
   auto &pImpl = dynamic_cast<RoctracerProfiler::RoctracerProfilerPimpl &>(
       *profiler.pImpl);
+  if (domain == ACTIVITY_DOMAIN_HIP_API && pImpl.memoryTracked &&
+      isMemoryCbId(cid)) {
+    trackMemory(cid, static_cast<const hip_api_data_t *>(callbackData));
+    return;
+  }
+  auto [isRuntimeAPI, isDriverAPI] = matchKernelCbId(cid);
+  if (!(isRuntimeAPI || isDriverAPI)) {
+    return;
+  }
   if (domain == ACTIVITY_DOMAIN_HIP_API) {
     const hip_api_data_t *data = (const hip_api_data_t *)(callbackData);
     if (data->phase == ACTIVITY_API_PHASE_ENTER) {
+      // Launches that are not sampled are dropped with their activities
+      if (!threadState.enterLaunch())
+        return;
       // Valid context and outermost level of the kernel launch
       auto scopeId = Scope::getNewScopeId();
       threadState.record(scopeId);
       threadState.enterOp(scopeId);
       profiler.correlation.correlate(data->correlation_id);
     } else if (data->phase == ACTIVITY_API_PHASE_EXIT) {
+      if (!threadState.exitLaunch())
+        return;
       threadState.exitOp();
       // Track outstanding op for flush
       profiler.correlation.submit(data->correlation_id);
@@ -212,7 +272,8 @@ void RoctracerProfiler::RoctracerProfilerPimpl::activityCallback(
             ? correlation.corrIdToExternId.at(record->correlation_id).first
             : Scope::DummyScopeId;
     auto isAPI = correlation.apiExternIds.contain(externId);
-    processActivity(externId, dataSet, record, isAPI);
+    processActivity(externId, dataSet, record, isAPI,
+                    profiler.samplingInterval);
     // Track correlation ids from the same stream and erase those <
     // correlationId
     correlation.corrIdToExternId.erase(record->correlation_id);
@@ -223,11 +284,16 @@ void RoctracerProfiler::RoctracerProfilerPimpl::activityCallback(
 }
 
 void RoctracerProfiler::RoctracerProfilerPimpl::doStart() {
+  if (!profiler.counterOptions.metrics.empty())
+    throw std::runtime_error(
+        "Hardware counters are not supported by the roctracer profiler");
+  memoryTracked = profiler.memoryOptions.enabled;
   roctracer::enableDomainCallback<true>(ACTIVITY_DOMAIN_HIP_API, apiCallback,
                                         nullptr);
   // Activity Records
   roctracer_properties_t properties{0};
-  properties.buffer_size = BufferSize;
+  // Roctracer manages its own pool; only the buffer size applies.
+  properties.buffer_size = profiler.bufferOptions.bufferSize;
   properties.buffer_callback_fun = activityCallback;
   roctracer::openPool<true>(&properties);
   roctracer::enableDomainActivity<true>(ACTIVITY_DOMAIN_HIP_OPS);
@@ -251,6 +317,8 @@ void RoctracerProfiler::RoctracerProfilerPimpl::doStop() {
   roctracer::disableDomainCallback<true>(ACTIVITY_DOMAIN_HIP_API);
   roctracer::disableDomainActivity<true>(ACTIVITY_DOMAIN_HIP_OPS);
   roctracer::closePool<true>();
+  memoryTracked = false;
+  profiler.memory.clear();
 }
 
 RoctracerProfiler::RoctracerProfiler() {
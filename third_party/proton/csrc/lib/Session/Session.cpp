@@ -1,6 +1,7 @@
 #include "Session/Session.h"
 #include "Context/Python.h"
 #include "Context/Shadow.h"
+#include "Data/TraceData.h"
 #include "Data/TreeData.h"
 #include "Profiler/CuptiProfiler.h"
 #include "Profiler/RoctracerProfiler.h"
@@ -24,6 +25,8 @@ std::unique_ptr<Data> makeData(const std::string &dataName,
                                ContextSource *contextSource) {
   if (toLower(dataName) == "tree") {
     return std::make_unique<TreeData>(path, contextSource);
+  } else if (toLower(dataName) == "trace") {
+    return std::make_unique<TraceData>(path, contextSource);
   }
   throw std::runtime_error("Unknown data: " + dataName);
 }
@@ -49,6 +52,11 @@ void Session::deactivate() {
   profiler->unregisterData(data.get());
 }
 
+void Session::flush(OutputFormat outputFormat) {
+  profiler->flush();
+  data->flush(outputFormat);
+}
+
 void Session::finalize(OutputFormat outputFormat) {
   profiler->stop();
   data->dump(outputFormat);
@@ -80,8 +88,9 @@ void SessionManager::activateSessionImpl(size_t sessionId) {
     return;
   activeSessions[sessionId] = true;
   sessions[sessionId]->activate();
-  registerInterface<ScopeInterface>(sessionId, scopeInterfaceCounts);
-  registerInterface<OpInterface>(sessionId, opInterfaceCounts);
+  registerInterface(sessionId, scopeInterfaceCounts, activeScopeInterfaces);
+  registerInterface(sessionId, opInterfaceCounts, activeOpInterfaces);
+  numActiveSessions.fetch_add(1, std::memory_order_release);
 }
 
 void SessionManager::deActivateSessionImpl(size_t sessionId) {
@@ -89,9 +98,11 @@ void SessionManager::deActivateSessionImpl(size_t sessionId) {
     return;
   }
   activeSessions[sessionId] = false;
+  numActiveSessions.fetch_sub(1, std::memory_order_release);
+  // Stop the hooks from reaching the session before deactivating it
+  unregisterInterface(sessionId, scopeInterfaceCounts, activeScopeInterfaces);
+  unregisterInterface(sessionId, opInterfaceCounts, activeOpInterfaces);
   sessions[sessionId]->deactivate();
-  unregisterInterface<ScopeInterface>(sessionId, scopeInterfaceCounts);
-  unregisterInterface<OpInterface>(sessionId, opInterfaceCounts);
 }
 
 void SessionManager::removeSession(size_t sessionId) {
@@ -144,49 +155,101 @@ void SessionManager::finalizeAllSessions(OutputFormat outputFormat) {
   }
 }
 
-void SessionManager::enterScope(const Scope &scope) {
+void SessionManager::flushSession(size_t sessionId,
+                                  OutputFormat outputFormat) {
   std::shared_lock<std::shared_mutex> lock(mutex);
-  for (auto iter : scopeInterfaceCounts) {
-    auto [scopeInterface, count] = iter;
-    if (count > 0) {
-      scopeInterface->enterScope(scope);
-    }
+  if (!hasSession(sessionId)) {
+    return;
   }
+  sessions[sessionId]->flush(outputFormat);
 }
 
-void SessionManager::exitScope(const Scope &scope) {
+void SessionManager::flushAllSessions(OutputFormat outputFormat) {
   std::shared_lock<std::shared_mutex> lock(mutex);
-  for (auto iter : scopeInterfaceCounts) {
-    auto [scopeInterface, count] = iter;
-    if (count > 0) {
-      scopeInterface->exitScope(scope);
-    }
+  for (auto &[sessionId, session] : sessions) {
+    session->flush(outputFormat);
+  }
+}
+
+void SessionManager::setBufferOptions(const std::string &profilerName,
+                                      const BufferOptions &options) {
+  getProfiler(profilerName)->setBufferOptions(options);
+}
+
+void SessionManager::setCounterOptions(const std::string &profilerName,
+                                       const CounterOptions &options) {
+  getProfiler(profilerName)->setCounterOptions(options);
+}
+
+void SessionManager::setSamplingOptions(const std::string &profilerName,
+                                        const SamplingOptions &options) {
+  getProfiler(profilerName)->setSamplingOptions(options);
+}
+
+void SessionManager::setPCSamplingOptions(const std::string &profilerName,
+                                          const PCSamplingOptions &options) {
+  getProfiler(profilerName)->setPCSamplingOptions(options);
+}
+
+void SessionManager::setMemoryOptions(const std::string &profilerName,
+                                      const MemoryOptions &options) {
+  getProfiler(profilerName)->setMemoryOptions(options);
+}
+
+size_t SessionManager::getNumDroppedRecords(const std::string &profilerName) {
+  return getProfiler(profilerName)->getNumDroppedRecords();
+}
+
+size_t SessionManager::getNumDroppedSamples(const std::string &profilerName) {
+  return getProfiler(profilerName)->getNumDroppedSamples();
+}
+
+void SessionManager::enterScope(const Scope &scope) {
+  if (numActiveSessions.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  auto interfaces = activeScopeInterfaces.get();
+  for (auto *scopeInterface : *interfaces) {
+    scopeInterface->enterScope(scope);
+  }
+}
+
+void SessionManager::exitScope(const Scope &scope) {
+  if (numActiveSessions.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  auto interfaces = activeScopeInterfaces.get();
+  for (auto *scopeInterface : *interfaces) {
+    scopeInterface->exitScope(scope);
   }
 }
 
 void SessionManager::enterOp(const Scope &scope) {
-  std::shared_lock<std::shared_mutex> lock(mutex);
-  for (auto iter : opInterfaceCounts) {
-    auto [opInterface, count] = iter;
-    if (count > 0) {
-      opInterface->enterOp(scope);
-    }
+  if (numActiveSessions.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  auto interfaces = activeOpInterfaces.get();
+  for (auto *opInterface : *interfaces) {
+    opInterface->enterOp(scope);
   }
 }
 
 void SessionManager::exitOp(const Scope &scope) {
-  std::shared_lock<std::shared_mutex> lock(mutex);
-  for (auto iter : opInterfaceCounts) {
-    auto [opInterface, count] = iter;
-    if (count > 0) {
-      opInterface->exitOp(scope);
-    }
+  if (numActiveSessions.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  auto interfaces = activeOpInterfaces.get();
+  for (auto *opInterface : *interfaces) {
+    opInterface->exitOp(scope);
   }
 }
 
 void SessionManager::addMetrics(
     size_t scopeId, const std::map<std::string, MetricValueType> &metrics,
     bool aggregable) {
+  if (numActiveSessions.load(std::memory_order_acquire) == 0) {
+    return;
+  }
   std::shared_lock<std::shared_mutex> lock(mutex);
   for (auto [sessionId, active] : activeSessions) {
     if (active) {
@@ -4,7 +4,12 @@ from .profile import (
     start,
     activate,
     deactivate,
+    flush,
     finalize,
+    get_dropped_records,
+    get_dropped_samples,
     profile,
     DEFAULT_PROFILE_NAME,
+    DEFAULT_COUNTERS,
 )
+from . import bench
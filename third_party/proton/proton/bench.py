@@ -0,0 +1,216 @@
+"""
+A benchmark harness that times kernels with the activity records of the profiler backends instead of events.
+"""
+import json
+import math
+import os
+import re
+import statistics
+import subprocess
+import tempfile
+from typing import Callable, List, NamedTuple, Optional
+
+import triton
+
+from .flags import get_profiling_on, set_profiling_off, is_command_line
+from .profile import start, finalize
+from .scope import scope
+
+# Scopes of the iterations, which have to be told apart from the scopes of the benchmarked function
+_ITERATION_SCOPE = "__bench_iter"
+
+
+class BenchResult(NamedTuple):
+    """
+    The kernel durations of a benchmark, in milliseconds.
+
+    Attributes:
+        median (float): The median duration of the iterations kept.
+        mean (float): The mean duration of the iterations kept.
+        std (float): The standard deviation of the iterations kept.
+        ci (tuple[float, float]): The confidence interval of the mean.
+        times (List[float]): The durations of the iterations kept.
+        num_rejected (int): The number of iterations rejected as outliers.
+        sm_clock (tuple[int, int], optional): The SM clock in MHz before and after the iterations, if it was checked.
+    """
+    median: float
+    mean: float
+    std: float
+    ci: tuple
+    times: List[float]
+    num_rejected: int
+    sm_clock: Optional[tuple] = None
+
+
+def get_sm_clock(device: Optional[int] = None) -> int:
+    """
+    Returns the current SM clock of a device in MHz, from nvidia-smi or rocm-smi.
+
+    Args:
+        device (int, optional): The device index. Defaults to the current device.
+    """
+    if device is None:
+        device = triton.runtime.driver.active.get_current_device()
+    if triton.runtime.driver.active.get_current_target().backend == "hip":
+        out = subprocess.check_output(["rocm-smi", "-d", str(device), "--showgpuclocks", "--json"], encoding="utf-8")
+        for card in json.loads(out).values():
+            for key, value in card.items():
+                if key.startswith("sclk"):
+                    return int(re.search(r"(\d+)", value).group(1))
+        raise RuntimeError("rocm-smi reported no SM clock")
+    out = subprocess.check_output(
+        ["nvidia-smi", "-i", str(device), "--query-gpu=clocks.current.sm", "--format=csv,noheader,nounits"],
+        encoding="utf-8")
+    return int(out.strip())
+
+
+def reject_outliers(times: List[float], threshold: float = 3.0) -> List[float]:
+    """
+    Removes the times further from the median than `threshold` scaled median absolute deviations, which estimate
+    the standard deviation of normally distributed times without being swayed by the outliers themselves.
+    """
+    median = statistics.median(times)
+    mad = statistics.median(abs(t - median) for t in times) * 1.4826
+    if mad == 0:
+        return list(times)
+    return [t for t in times if abs(t - median) <= threshold * mad]
+
+
+def confidence_interval(times: List[float], confidence: float = 0.95) -> tuple:
+    """
+    Returns the normal approximation of the confidence interval of the mean of `times`.
+    """
+    mean = statistics.fmean(times)
+    if len(times) < 2:
+        return mean, mean
+    z = statistics.NormalDist().inv_cdf(0.5 + confidence / 2)
+    half_width = z * statistics.stdev(times) / math.sqrt(len(times))
+    return mean - half_width, mean + half_width
+
+
+def do_bench(
+    fn: Callable,
+    *,
+    warmup: int = 25,
+    rep: int = 100,
+    grad_to_none=None,
+    flush_l2: bool = True,
+    outlier_threshold: Optional[float] = 3.0,
+    confidence: float = 0.95,
+    sm_clock: Optional[int] = None,
+    clock_tolerance: int = 10,
+    backend: Optional[str] = None,
+) -> BenchResult:
+    """
+    Benchmark the kernels launched by `fn`.
+
+    The duration of an iteration is the sum of the durations of the kernels `fn` launches, as recorded by the
+    profiler backend, so it excludes the launch gaps between the kernels and the L2 flush before each iteration.
+    This keeps the comparisons of kernels of a few microseconds reliable, which event timing doesn't.
+
+    Usage:
+
+        ```python
+        result = proton.bench.do_bench(lambda: matmul(a, b))
+        print(result.median, result.ci)
+        ```
+
+    Args:
+        fn (Callable): The function to benchmark.
+        warmup (int, optional): Warmup time in ms. Defaults to 25.
+        rep (int, optional): Repetition time in ms, which sets the number of iterations. Defaults to 100.
+        grad_to_none (List[torch.Tensor], optional): Tensors whose gradients are reset before each iteration.
+        flush_l2 (bool, optional): Whether to flush the L2 cache before each iteration. Defaults to True.
+        outlier_threshold (float, optional): Reject the iterations further from the median than this many standard
+                                             deviations, estimated from the median absolute deviation.
+                                             Defaults to 3. None keeps all the iterations.
+        confidence (float, optional): The confidence level of the interval of the mean. Defaults to 0.95.
+        sm_clock (int, optional): The SM clock in MHz the device is expected to be locked to, e.g., with
+                                  `triton.testing.set_gpu_clock`. If provided, the clock is checked before and after
+                                  the iterations and a RuntimeError is raised if it is off by more than
+                                  `clock_tolerance` MHz. Defaults to None, which doesn't check the clock.
+        clock_tolerance (int, optional): The tolerance of the clock check in MHz. Defaults to 10.
+        backend (str, optional): The profiler backend. Defaults to the one matching the active runtime.
+
+    Returns:
+        result (BenchResult): The statistics of the kernel durations.
+    """
+    import torch
+
+    if is_command_line():
+        raise RuntimeError("do_bench can't be used when the script is run from the proton command line")
+
+    device = triton.runtime.driver.active.get_current_device()
+    fn()
+    torch.cuda.synchronize()
+
+    # Zeroing a buffer larger than the L2 cache evicts the inputs of the previous iteration
+    cache = torch.empty(256 * 1024 * 1024 // 4, dtype=torch.int, device=device) if flush_l2 else None
+
+    def prepare():
+        if grad_to_none is not None:
+            for x in grad_to_none:
+                x.grad = None
+        if cache is not None:
+            cache.zero_()
+
+    # Estimate the number of iterations with events, which is good enough for that
+    start_event = torch.cuda.Event(enable_timing=True)
+    end_event = torch.cuda.Event(enable_timing=True)
+    start_event.record()
+    for _ in range(5):
+        prepare()
+        fn()
+    end_event.record()
+    torch.cuda.synchronize()
+    estimate_ms = start_event.elapsed_time(end_event) / 5
+    n_warmup = max(1, int(warmup / estimate_ms))
+    n_repeat = max(1, int(rep / estimate_ms))
+    for _ in range(n_warmup):
+        fn()
+
+    clocks = None
+    if sm_clock is not None:
+        clocks = (get_sm_clock(device), )
+
+    profiling_on = get_profiling_on()
+    with tempfile.TemporaryDirectory() as tmpdir:
+        name = os.path.join(tmpdir, "bench")
+        session = start(name, data="trace", backend=backend)
+        try:
+            for i in range(n_repeat):
+                prepare()
+                with scope(f"{_ITERATION_SCOPE}{i}"):
+                    fn()
+            torch.cuda.synchronize()
+        finally:
+            finalize(session, "chrome_trace")
+            if not profiling_on:
+                set_profiling_off()
+        with open(f"{name}.chrome_trace") as f:
+            events = json.load(f)
+
+    if clocks is not None:
+        clocks = (*clocks, get_sm_clock(device))
+        if any(abs(clock - sm_clock) > clock_tolerance for clock in clocks):
+            raise RuntimeError(f"SM clock was {clocks[0]} and {clocks[1]} MHz, expected {sm_clock} MHz")
+
+    times = [0.0] * n_repeat
+    for event in events:
+        if event["ph"] != "X":
+            continue
+        for frame in event["args"]["call_stack"].split("/"):
+            if frame.startswith(_ITERATION_SCOPE):
+                # Trace durations are in microseconds
+                times[int(frame[len(_ITERATION_SCOPE):])] += event["dur"] / 1000
+                break
+    kept = times if outlier_threshold is None else reject_outliers(times, outlier_threshold)
+    return BenchResult(
+        median=statistics.median(kept),
+        mean=statistics.fmean(kept),
+        std=statistics.stdev(kept) if len(kept) > 1 else 0.0,
+        ci=confidence_interval(kept, confidence),
+        times=kept,
+        num_rejected=len(times) - len(kept),
+        sm_clock=clocks,
+    )
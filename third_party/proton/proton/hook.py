@@ -14,7 +14,9 @@ class TritonHook:
         metadata = lazy_dict.get()
         exit_scope()
         fn_metrics = {k: metadata[k] for k in TritonHook.metrics if k in metadata}
-        enter_scope(metadata["name"], triton_op=True, metrics=fn_metrics)
+        # the theoretical occupancy of the kernel, which doesn't add up over launches
+        fn_properties = metadata.get("occupancy", None)
+        enter_scope(metadata["name"], triton_op=True, metrics=fn_metrics, properties=fn_properties)
 
     @staticmethod
     def exit(lazy_dict: LazyDict) -> None:
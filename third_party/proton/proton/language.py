@@ -0,0 +1,190 @@
+"""
+Intra-kernel instrumentation.
+
+Regions of a Triton kernel are marked with `enter_scope` and `exit_scope`, which record a timestamp into a ring buffer
+in global memory:
+
+    ```python
+    import triton.profiler.language as pl
+
+    @triton.jit
+    def matmul_kernel(..., profile_buffer):
+        pl.enter_scope(profile_buffer, "mainloop")
+        for k in range(...):
+            ...
+        pl.exit_scope(profile_buffer, "mainloop")
+        pl.enter_scope(profile_buffer, "epilogue")
+        ...
+        pl.exit_scope(profile_buffer, "epilogue")
+
+    buffer = pl.alloc_buffer(num_ctas)
+    matmul_kernel[grid](..., buffer)
+    pl.add_metrics(buffer, "matmul_kernel")
+    ```
+
+The timestamps are read by the first thread of each CTA: %globaltimer in nanoseconds on NVIDIA GPUs and s_memtime in
+shader cycles on AMD GPUs. Every CTA owns a ring buffer of `capacity` events, so the latest events are kept if a CTA
+records more of them.
+"""
+
+import zlib
+from typing import Dict, Tuple
+
+import triton
+import triton.language as tl
+from triton.language import core
+
+from .flags import get_profiling_on
+from triton._C.libproton import proton as libproton
+
+# Scope id -> scope name of the scopes marked in the kernels compiled by this process
+_scope_names: Dict[int, str] = {}
+
+
+def _get_scope_id(name: str) -> int:
+    # Stable across processes so that cached kernels record the same ids
+    scope_id = zlib.crc32(name.encode()) & 0x3FFFFFFF
+    _scope_names[scope_id] = name
+    return scope_id
+
+
+@core.builtin
+def _scope_tag(name, is_exit, _builder=None):
+    name = core._constexpr_to_value(name)
+    is_exit = core._constexpr_to_value(is_exit)
+    return core.constexpr(_get_scope_id(name) * 2 + int(is_exit))
+
+
+@core.extern
+def _timestamp(_builder=None):
+    if _builder.options.backend_name == "hip":
+        return core.inline_asm_elementwise("s_memtime $0\ns_waitcnt lgkmcnt(0)", "=s", [], dtype=core.int64,
+                                           is_pure=False, pack=1, _builder=_builder)
+    return core.inline_asm_elementwise("mov.u64 $0, %globaltimer;", "=l", [], dtype=core.int64, is_pure=False, pack=1,
+                                       _builder=_builder)
+
+
+@triton.jit
+def _record(buffer, tag, time):
+    # Layout: [capacity, CTA 0: [count, (tag, time) * capacity], CTA 1: ...]
+    capacity = tl.load(buffer)
+    cta_id = tl.program_id(0) + tl.num_programs(0) * (tl.program_id(1) + tl.num_programs(1) * tl.program_id(2))
+    region = buffer + 1 + cta_id.to(tl.int64) * (1 + 2 * capacity)
+    # Scalars are stored by a single thread, which also sees its own updates of the count
+    count = tl.load(region)
+    slot = region + 1 + 2 * (count % capacity)
+    tl.store(slot, tag)
+    tl.store(slot + 1, time)
+    tl.store(region, count + 1)
+
+
+@triton.jit
+def enter_scope(buffer, name: tl.constexpr):
+    """
+    Record the entry of the scope `name` into `buffer`, which is allocated by `alloc_buffer`.
+    """
+    time = _timestamp()
+    _record(buffer, _scope_tag(name, False), time)
+
+
+@triton.jit
+def exit_scope(buffer, name: tl.constexpr):
+    """
+    Record the exit of the scope `name` into `buffer`, which is allocated by `alloc_buffer`.
+    """
+    time = _timestamp()
+    _record(buffer, _scope_tag(name, True), time)
+
+
+def alloc_buffer(num_ctas: int, capacity: int = 256, device: str = "cuda"):
+    """
+    Allocate the ring buffers of a kernel launch.
+
+    Args:
+        num_ctas (int): The number of CTAs of the launch grid.
+        capacity (int, optional): The number of events kept for each CTA. Defaults to 256.
+        device (str, optional): The device of the buffer. Defaults to "cuda", which is also used by HIP.
+
+    Returns:
+        buffer (torch.Tensor): The buffer to pass to the kernel.
+    """
+    import torch
+    buffer = torch.zeros(1 + num_ctas * (1 + 2 * capacity), dtype=torch.int64, device=device)
+    buffer[0] = capacity
+    return buffer
+
+
+def decode(buffer) -> Tuple[Dict[Tuple[str, ...], Tuple[int, int]], int]:
+    """
+    Decode the events recorded in a buffer.
+
+    Returns:
+        scopes (dict): Maps the path of every scope, from the outermost one, to its total time over the CTAs and the
+                       number of times it was executed.
+        num_lost_events (int): The number of events overwritten in the ring buffers or left unmatched.
+    """
+    values = buffer.tolist()
+    capacity = values[0]
+    region_size = 1 + 2 * capacity
+    scopes = {}
+    num_lost_events = 0
+    for start in range(1, len(values), region_size):
+        count = values[start]
+        events = values[start + 1:start + region_size]
+        events = [(events[2 * i], events[2 * i + 1]) for i in range(capacity)]
+        if count > capacity:
+            # The ring buffer wrapped around, the oldest event is the next one to be overwritten
+            first = count % capacity
+            events = events[first:] + events[:first]
+            num_lost_events += count - capacity
+        else:
+            events = events[:count]
+        stack = []
+        for tag, time in events:
+            scope_id, is_exit = tag // 2, tag % 2
+            name = _scope_names.get(scope_id, f"scope_{scope_id:#x}")
+            if not is_exit:
+                stack.append((name, time))
+                continue
+            if not stack or stack[-1][0] != name:
+                # The entry was overwritten or the scopes are not nested
+                num_lost_events += 1 + len(stack)
+                stack = []
+                continue
+            path = tuple(scope_name for scope_name, _ in stack)
+            _, enter_time = stack.pop()
+            total, num = scopes.get(path, (0, 0))
+            scopes[path] = (total + time - enter_time, num + 1)
+        num_lost_events += len(stack)
+    return scopes, num_lost_events
+
+
+def add_metrics(buffer, kernel: str, reset: bool = True) -> None:
+    """
+    Decode a buffer and add its scopes as child nodes of the kernel in the current profiling context.
+
+    Every scope gets the total time summed over the CTAs, "cta_time (ns)" on NVIDIA GPUs and "cta_cycles" on AMD GPUs,
+    and "cta_count", the number of times it was executed.
+
+    Args:
+        buffer (torch.Tensor): The buffer passed to the kernel.
+        kernel (str): The name of the kernel, which has to match the name of its node for the scopes to be its children.
+        reset (bool, optional): Clear the buffer so that it can be passed to the next launch. Defaults to True.
+    """
+    scopes, num_lost_events = decode(buffer)
+    if reset:
+        buffer[1:] = 0
+    if num_lost_events > 0:
+        print(f"[PROTON] {num_lost_events} intra-kernel events were lost. Consider increasing the buffer capacity.")
+    if not get_profiling_on():
+        return
+    backend = triton.runtime.driver.active.get_current_target().backend
+    time_name = "cta_cycles" if backend == "hip" else "cta_time (ns)"
+    for path, (total, num) in scopes.items():
+        ids = []
+        for name in (kernel, ) + path:
+            ids.append(libproton.record_scope())
+            libproton.enter_scope(ids[-1], name)
+        libproton.add_metrics(ids[-1], {time_name: total, "cta_count": num})
+        for id, name in reversed(list(zip(ids, (kernel, ) + path))):
+            libproton.exit_scope(id, name)
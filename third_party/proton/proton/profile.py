@@ -4,10 +4,19 @@ import triton
 from triton._C.libproton import proton as libproton
 from .hook import register_triton_hook, unregister_triton_hook
 from .flags import set_profiling_off, set_profiling_on, is_command_line
-from typing import Optional
+from typing import List, Optional
 
 DEFAULT_PROFILE_NAME = "proton"
 
+# Hardware counters that tell bandwidth bound kernels from compute bound ones:
+# DRAM traffic, achieved occupancy, L2 hit rate and tensor core utilization.
+DEFAULT_COUNTERS = [
+    "dram__bytes.sum",
+    "sm__warps_active.avg.pct_of_peak_sustained_active",
+    "lts__t_sector_hit_rate.pct",
+    "sm__pipe_tensor_op_hmma_cycles_active.avg.pct_of_peak_sustained_active",
+]
+
 
 def _select_backend() -> str:
     backend = triton.runtime.driver.active.get_current_target().backend
@@ -26,6 +35,15 @@ def start(
     data: Optional[str] = "tree",
     backend: Optional[str] = None,
     hook: Optional[str] = None,
+    buffer_size: int = 64 * 1024 * 1024,
+    buffer_count: int = 4,
+    huge_pages: bool = False,
+    counters: Optional[List[str]] = None,
+    counter_kernels: str = ".*",
+    pc_sampling: bool = False,
+    memory: bool = False,
+    sampling_interval: int = 1,
+    rank: Optional[int] = None,
 ):
     """
     Start profiling with the given name and backend.
@@ -48,11 +66,47 @@ def start(
                                  Available options are ["shadow", "python"].
                                  Defaults to "shadow".
         data (str, optional): The data structure to use for profiling.
-                              Available options are ["tree"].
+                              Available options are ["tree", "trace"].
+                              "trace" streams every kernel to a Chrome trace file ("<name>.chrome_trace")
+                              that can be opened with chrome://tracing or Perfetto.
                               Defaults to "tree".
         hook (str, optional): The hook to use for profiling.
                               Available options are [None, "triton"].
                               Defaults to None.
+        buffer_size (int, optional): The size in bytes of each host buffer receiving activity records.
+                                     Defaults to 64MB.
+        buffer_count (int, optional): The number of completed buffers kept for reuse instead of being freed.
+                                      Only used by the cupti backend. Defaults to 4.
+        huge_pages (bool, optional): Whether to back the buffers with transparent huge pages.
+                                     Only used by the cupti backend. Defaults to False.
+                                     The buffer options apply when the backend starts, i.e., they are ignored if
+                                     another session already uses it.
+        counters (List[str], optional): The hardware counters to collect for each kernel, e.g., ["dram__bytes.sum",
+                                        "lts__t_sector_hit_rate.pct"]. Defaults to None, which collects no counters.
+                                        See DEFAULT_COUNTERS for a set of counters telling bandwidth bound kernels
+                                        from compute bound ones. Only supported by the cupti backend.
+                                        Profiled kernels are replayed until all the counters are collected, so their
+                                        time metrics are not representative.
+        counter_kernels (str, optional): A regular expression selecting the kernels whose counters are collected.
+                                         It is searched in the kernel names. Defaults to all kernels.
+                                         It also selects the kernels sampled by `pc_sampling`.
+        pc_sampling (bool, optional): Whether to sample the program counters of the kernels and attribute the samples
+                                      and their stall reasons to the source lines of the kernels, e.g.,
+                                      "kernel.py:42", which appear as children of the kernel. Defaults to False.
+                                      Only supported by the cupti backend, and not together with `counters`.
+                                      Sampled kernels are serialized, so their time metrics are not representative.
+        memory (bool, optional): Whether to track the device memory allocated and freed through the driver, e.g., by
+                                 cuMemAlloc or hipMalloc. The bytes allocated and freed, the number of allocations and
+                                 the peak of the memory in use are recorded in the context of the allocating thread.
+                                 Memory allocated before the backend starts is ignored. Note that the PyTorch caching
+                                 allocator only allocates from the driver when its cache runs out. Defaults to False.
+        sampling_interval (int, optional): Profile one in every `sampling_interval` kernel launches of each thread to
+                                           bound the profiling overhead, e.g., when profiling is always on.
+                                           The counts and times of the profiled kernels are scaled by the interval
+                                           to estimate the totals. Defaults to 1, which profiles every launch.
+        rank (int, optional): The rank of the process in a multi-process job. If provided, the profile is written to
+                              "<name>.rank<rank>", so that the ranks of a job can be compared with
+                              `proton-viewer --ranks`. Defaults to None.
     Returns:
         session (int): The session ID of the profiling session.
     """
@@ -63,12 +117,29 @@ def start(
     if name is None:
         name = DEFAULT_PROFILE_NAME
 
+    if rank is not None:
+        name = f"{name}.rank{rank}"
+
     if backend is None:
         backend = _select_backend()
 
+    if sampling_interval < 1:
+        raise ValueError("sampling_interval must be positive")
+
+    if pc_sampling and backend != "cupti":
+        raise ValueError("pc_sampling is only supported by the cupti backend")
+
+    if pc_sampling and counters:
+        raise ValueError("pc_sampling can't be combined with counters")
+
     set_profiling_on()
     if hook and hook == "triton":
         register_triton_hook()
+    libproton.set_buffer_options(backend, buffer_size, buffer_count, huge_pages)
+    libproton.set_counter_options(backend, counters or [], counter_kernels)
+    libproton.set_pc_sampling_options(backend, pc_sampling, counter_kernels)
+    libproton.set_memory_options(backend, memory)
+    libproton.set_sampling_options(backend, sampling_interval)
     return libproton.start(name, context, data, backend)
 
 
@@ -104,6 +175,29 @@ def deactivate(session: Optional[int] = 0) -> None:
     libproton.deactivate(session)
 
 
+def flush(session: Optional[int] = None, output_format: str = "hatchet") -> None:
+    """
+    Write the profiling data collected so far to the file specified by the session name.
+    The session keeps recording, so it can be flushed periodically and finalized later.
+
+    Args:
+        session (int, optional): The session ID to flush. If None, all sessions are flushed. Defaults to None.
+        output_format (str, optional): The output format for the profiling results.
+                                       Available options are ["hatchet", "hatchet_msgpack", "chrome_trace"].
+                                       "hatchet" rewrites the whole profile, while "hatchet_msgpack" only appends
+                                       the nodes changed since the last flush.
+
+    Returns:
+        None
+    """
+    if session is None:
+        libproton.flush_all(output_format)
+    else:
+        if is_command_line() and session != 0:
+            raise ValueError("Only one session can be flushed when running from the command line.")
+        libproton.flush(session, output_format)
+
+
 def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> None:
     """
     Finalizes a profiling session.
@@ -112,7 +206,10 @@ def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> N
     Args:
         session (int, optional): The session ID to finalize. If None, all sessions are finalized. Defaults to None.
         output_format (str, optional): The output format for the profiling results.
-                                       Aavailable options are ["hatchet"].
+                                       Aavailable options are ["hatchet", "hatchet_msgpack", "chrome_trace"].
+                                       "hatchet_msgpack" is a compact binary format that is faster to write and read
+                                       for large profiles. It requires the msgpack package to be viewed.
+                                       Sessions using the "trace" data are always written as "chrome_trace".
 
     Returns:
         None
@@ -127,6 +224,42 @@ def finalize(session: Optional[int] = None, output_format: str = "hatchet") -> N
         libproton.finalize(session, output_format)
 
 
+def get_dropped_records(backend: Optional[str] = None) -> int:
+    """
+    Get the number of activity records the backend dropped since the last session was started.
+    Records are dropped when no buffer is available to receive them in time, in which case
+    the buffer_size or buffer_count of the session should be increased.
+    The count is kept after the session is finalized.
+
+    Args:
+        backend (str, optional): The backend of the session. If None, it is selected based on the current target.
+
+    Returns:
+        int: The number of dropped activity records.
+    """
+    if backend is None:
+        backend = _select_backend()
+    return libproton.get_num_dropped_records(backend)
+
+
+def get_dropped_samples(backend: Optional[str] = None) -> int:
+    """
+    Get the number of PC samples the backend dropped since the last session was started.
+    Samples are dropped when the sampling buffers of a kernel overflow, in which case
+    the line attribution of the kernel undercounts its samples.
+    The count is kept after the session is finalized.
+
+    Args:
+        backend (str, optional): The backend of the session. If None, it is selected based on the current target.
+
+    Returns:
+        int: The number of dropped PC samples.
+    """
+    if backend is None:
+        backend = _select_backend()
+    return libproton.get_num_dropped_samples(backend)
+
+
 def _profiling(
     func,
     name: Optional[str] = None,
@@ -16,7 +16,7 @@ def parse_arguments():
     parser.add_argument("-b", "--backend", type=str, help="Profiling backend", default=None, choices=["cupti"])
     parser.add_argument("-c", "--context", type=str, help="Profiling context", default="shadow",
                         choices=["shadow", "python"])
-    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree", choices=["tree"])
+    parser.add_argument("-d", "--data", type=str, help="Profiling data", default="tree", choices=["tree", "trace"])
     parser.add_argument("-k", "--hook", type=str, help="Profiling hook", default=None, choices=[None, "triton"])
     args, target_args = parser.parse_known_args()
     return args, target_args
@@ -1,6 +1,8 @@
 import argparse
 from collections import namedtuple
 import json
+import os
+import re
 import pandas as pd
 
 import hatchet as ht
@@ -22,42 +24,90 @@ def match_available_metrics(metrics, raw_metrics):
     return ret
 
 
+def load_msgpack_database(file):
+    try:
+        import msgpack
+    except ImportError:
+        raise ImportError("Reading hatchet_msgpack profiles requires the msgpack package")
+    # Each frame holds the nodes added or changed since the previous frame, so later values win
+    nodes = {}
+    value_names = set()
+    device_info = {}
+    for frame in msgpack.Unpacker(file, raw=False):
+        for node_id, parent_id, name in zip(frame["ids"], frame["parent_ids"], frame["names"]):
+            if node_id not in nodes:
+                nodes[node_id] = {"frame": {"name": name, "type": "function"}, "metrics": {}, "children": []}
+                if node_id != parent_id:
+                    nodes[parent_id]["children"].append(nodes[node_id])
+        for value_name, (node_ids, values) in frame["metrics"].items():
+            for node_id, value in zip(node_ids, values):
+                nodes[node_id]["metrics"][value_name] = value
+        value_names.update(frame["value_names"])
+        for device_type, devices in frame["devices"].items():
+            device_info.setdefault(device_type, {}).update(devices)
+    root = nodes[0]
+    # Hints for all available metrics
+    for value_name in value_names:
+        root["metrics"].setdefault(value_name, 0)
+    return [root, device_info]
+
+
 def get_raw_metrics(file):
-    database = json.load(file)
+    if getattr(file, "name", "").endswith(".hatchet_msgpack"):
+        database = load_msgpack_database(file)
+    else:
+        database = json.load(file)
     device_info = database.pop(1)
     gf = ht.GraphFrame.from_literal(database)
     return gf, gf.show_metric_columns(), device_info
 
 
+def get_peak_flops(device_type, device):
+    """
+    Returns the peak tensor core throughput of the device for 8-bit operands in ops/s.
+    Profiles dumped by older versions of proton don't record it, in which case it is looked up by architecture.
+    """
+    if "peak_flops" in device:
+        return device["peak_flops"]
+    arch = device["arch"]
+    if device_type == "CUDA":
+        if arch == "80":
+            return 624e12
+        elif arch == "89":
+            # TODO(Keren): Implement fp16 acc-> 660.6 fp8
+            return 330.3e12
+        elif arch == "90":
+            # 114 sms and 1755mhz is the base number of sms and clock rate of H100 pcie
+            return (device["num_sms"] / 114 * device["clock_rate"] / (1755 * 1e3) * 1513) * 1e12
+    elif device_type == "HIP":
+        if arch == "gfx90a":
+            return 383e12
+        elif arch == "gfx941" or arch == "gfx942":
+            return 2614.9e12
+    else:
+        raise ValueError(f"Unsupported device type: {device_type}")
+    return 0
+
+
+def get_peak_bandwidth(device):
+    if "peak_bandwidth" in device:
+        return device["peak_bandwidth"]
+    memory_clock_rate = device["memory_clock_rate"]  # in khz
+    bus_width = device["bus_width"]  # in bits
+    return 2 * bus_width * memory_clock_rate * 1e3 / 8
+
+
 def get_min_time_flops(df, device_info):
     min_time_flops = pd.DataFrame(0.0, index=df.index, columns=["min_time"])
     for device_type in device_info:
         for device_index in device_info[device_type]:
-            arch = device_info[device_type][device_index]["arch"]
-            num_sms = device_info[device_type][device_index]["num_sms"]
-            clock_rate = device_info[device_type][device_index]["clock_rate"]
+            peak_flops = get_peak_flops(device_type, device_info[device_type][device_index])
             for width in TritonHook.flops_width:
                 idx = df["DeviceId"] == device_index
                 device_frames = df[idx]
                 if f"flops{width}" not in device_frames.columns:
                     continue
-                max_flops = 0
-                if device_type == "CUDA":
-                    if arch == "80":
-                        max_flops = 624e12 / (width / 8)
-                    elif arch == "89":
-                        # TODO(Keren): Implement fp16 acc-> 660.6 fp8
-                        max_flops = (330.3 * 1e12) / (width / 8)
-                    elif arch == "90":
-                        # 114 sms and 1755mhz is the base number of sms and clock rate of H100 pcie
-                        max_flops = ((num_sms / 114 * clock_rate / (1755 * 1e3) * 1513) * 1e12) / (width / 8)
-                elif device_type == "HIP":
-                    if arch == "gfx90a":
-                        max_flops = 383e12 / (width / 8)
-                    elif arch == "gfx941" or arch == "gfx942":
-                        max_flops = 2614.9e12 / (width / 8)
-                else:
-                    raise ValueError(f"Unsupported device type: {device_type}")
+                max_flops = peak_flops / (width / 8)
                 min_time_flops.loc[idx, "min_time"] += device_frames[f"flops{width}"].fillna(0) / max_flops
     return min_time_flops
 
@@ -68,9 +118,7 @@ def get_min_time_bytes(df, device_info):
         for device_index in device_info[device_type]:
             idx = df["DeviceId"] == device_index
             device_frames = df[idx]
-            memory_clock_rate = device_info[device_type][device_index]["memory_clock_rate"]  # in khz
-            bus_width = device_info[device_type][device_index]["bus_width"]  # in bits
-            peak_bandwidth = 2 * bus_width * memory_clock_rate * 1e3 / 8
+            peak_bandwidth = get_peak_bandwidth(device_info[device_type][device_index])
             min_time_bytes.loc[idx, "min_time"] += device_frames["bytes"] / peak_bandwidth
     return min_time_bytes
 
@@ -87,6 +135,30 @@ derivable_metrics = {
        for key in bytes_factor_dict.factor.keys()},
 }
 
+# Achieved throughput as a percentage of the device peaks
+roofline_metrics = ["flop/s%", "byte/s%", "roofline%"]
+
+
+def is_averaged_counter(metric):
+    # Hardware counters are named like "dram__bytes.sum". Counters other than sums, e.g., percentages, are summed
+    # over the kernel invocations when collected and have to be averaged.
+    return "__" in metric and not metric.endswith(".sum")
+
+
+# Metrics that keep the maximum over the children instead of the sum
+peak_metrics = ["Peak Memory (bytes)"]
+
+
+def update_peak_columns(gf):
+    for metric in peak_metrics:
+        if metric not in gf.dataframe.columns:
+            continue
+        exclusive = gf.dataframe[metric].fillna(0)
+        peaks = {}
+        for node in gf.graph.traverse(order="post"):
+            peaks[node] = max([exclusive[node]] + [peaks[child] for child in node.children])
+        gf.dataframe[f"{metric} (inc)"] = [peaks[node] for node in gf.dataframe.index]
+
 
 def derive_metrics(gf, metrics, raw_metrics, device_info):
     derived_metrics = []
@@ -94,13 +166,21 @@ def derive_metrics(gf, metrics, raw_metrics, device_info):
     time_metric_name = match_available_metrics([time_factor_dict.name], raw_metrics)[0]
     time_unit = (time_factor_dict.name + "/" + time_metric_name.split("(")[1].split(")")[0])
     for metric in metrics:
-        if metric == "util":  # Tensor core only
-            min_time_bytes = get_min_time_bytes(gf.dataframe, device_info)
-            min_time_flops = get_min_time_flops(gf.dataframe, device_info)
+        if metric == "util" or metric in roofline_metrics:  # Tensor core only
+            min_time_bytes = get_min_time_bytes(gf.dataframe, device_info)["min_time"]
+            min_time_flops = get_min_time_flops(gf.dataframe, device_info)["min_time"]
             time_sec = gf.dataframe[time_metric_name] * (time_factor_dict.factor[time_unit] /
                                                          time_factor_dict.factor["time/s"])
-            gf.dataframe["util (inc)"] = min_time_flops["min_time"].combine(min_time_bytes["min_time"], max) / time_sec
-            derived_metrics.append("util (inc)")
+            if metric == "util":
+                gf.dataframe["util (inc)"] = min_time_flops.combine(min_time_bytes, max) / time_sec
+            elif metric == "flop/s%":
+                gf.dataframe[f"{metric} (inc)"] = min_time_flops / time_sec * 100
+            elif metric == "byte/s%":
+                gf.dataframe[f"{metric} (inc)"] = min_time_bytes / time_sec * 100
+            else:
+                # The attainable throughput of the roofline is bound by the slower of compute and memory
+                gf.dataframe[f"{metric} (inc)"] = min_time_flops.combine(min_time_bytes, max) / time_sec * 100
+            derived_metrics.append(f"{metric} (inc)")
         elif metric in derivable_metrics:
             deriveable_metric = derivable_metrics[metric]
             metric_name = deriveable_metric.name
@@ -110,6 +190,11 @@ def derive_metrics(gf, metrics, raw_metrics, device_info):
                                                (gf.dataframe[time_metric_name] * time_factor_dict.factor[time_unit]) /
                                                metric_factor_dict[metric])
             derived_metrics.append(f"{metric} (inc)")
+        elif is_averaged_counter(metric):
+            counter_metric_name = match_available_metrics([metric], raw_metrics)[0]
+            count_metric_name = match_available_metrics(["count"], raw_metrics)[0]
+            gf.dataframe[f"{metric} (avg)"] = gf.dataframe[counter_metric_name] / gf.dataframe[count_metric_name]
+            derived_metrics.append(f"{metric} (avg)")
         elif metric in time_factor_dict.factor:
             metric_time_unit = time_factor_dict.name + "/" + metric.split("/")[1]
             gf.dataframe[f"{metric} (inc)"] = gf.dataframe[time_metric_name] * (
@@ -124,10 +209,11 @@ def derive_metrics(gf, metrics, raw_metrics, device_info):
 
 
 def parse(metrics, filename, include, exclude, threshold, depth):
-    with open(filename, "r") as f:
+    with open(filename, "rb") as f:
         gf, raw_metrics, device_info = get_raw_metrics(f)
         assert len(raw_metrics) > 0, "No metrics found in the input file"
         gf.update_inclusive_columns()
+        update_peak_columns(gf)
         metrics = derive_metrics(gf, metrics, raw_metrics, device_info)
         if include or exclude:
             # make regex do negative match
@@ -144,8 +230,60 @@ def parse(metrics, filename, include, exclude, threshold, depth):
         print(gf.tree(metric_column=metrics, expand_name=True, depth=depth, render_header=False))
 
 
+def get_rank(file_name, default):
+    match = re.search(r"\.rank(\d+)\b", os.path.basename(file_name))
+    return int(match.group(1)) if match else default
+
+
+def get_frame_metrics(file_name, metric):
+    # Map the call path of every frame to the inclusive value of the metric
+    with open(file_name, "rb") as f:
+        gf, raw_metrics, device_info = get_raw_metrics(f)
+        assert len(raw_metrics) > 0, "No metrics found in the input file"
+        gf.update_inclusive_columns()
+        update_peak_columns(gf)
+        metric = derive_metrics(gf, [metric], raw_metrics, device_info)[0]
+        frame_metrics = {}
+        for node, value in gf.dataframe[metric].items():
+            path = "/".join(path_node.frame["name"] for path_node in node.path())
+            if COMPUTE_METADATA_SCOPE_NAME not in path:
+                frame_metrics[path] = frame_metrics.get(path, 0) + value
+        return metric, frame_metrics
+
+
+def get_rank_table(metric, file_names):
+    """
+    Compare a metric of the frames across the profiles of the ranks of a job.
+    Frames are matched by their call paths. The frames whose slowest rank is the furthest from the mean come first.
+    """
+    columns = {}
+    for i, file_name in enumerate(file_names):
+        metric_name, frame_metrics = get_frame_metrics(file_name, metric)
+        columns[f"rank{get_rank(file_name, i)}"] = pd.Series(frame_metrics, dtype=float)
+    table = pd.DataFrame(columns).fillna(0)
+    table = table[sorted(table.columns, key=lambda column: int(column[len("rank"):]))]
+    ranks = table.copy()
+    table["min"] = ranks.min(axis=1)
+    table["max"] = ranks.max(axis=1)
+    table["mean"] = ranks.mean(axis=1)
+    table["max/mean"] = table["max"] / table["mean"]
+    table["slowest"] = ranks.idxmax(axis=1)
+    table = table.loc[(table["max"] - table["mean"]).sort_values(ascending=False).index]
+    table.index.name = metric_name
+    return table
+
+
+def parse_ranks(metrics, file_names, threshold, depth):
+    table = get_rank_table(metrics[0], file_names)
+    if threshold:
+        table = table[table["mean"] >= threshold]
+    table = table[table.index.map(lambda path: path.count("/") < depth)]
+    with pd.option_context("display.max_rows", None, "display.max_columns", None, "display.width", None):
+        print(table)
+
+
 def show_metrics(file_name):
-    with open(file_name, "r") as f:
+    with open(file_name, "rb") as f:
         _, raw_metrics, _ = get_raw_metrics(f)
         print("Available metrics:")
         if raw_metrics:
@@ -170,6 +308,11 @@ Derived metrics can be created when source metrics are available.
 - flop/s, gflop/s, tflop/s: flops / time
 - byte/s, gbyte/s, tbyte/s: bytes / time
 - util: max(sum(flops<width>) / peak_flops<width>_time, bytes / peak_bandwidth_time))
+- flop/s%: sum(flops<width> / peak_flops<width>) / time, as a percentage
+- byte/s%: bytes / peak_bandwidth / time, as a percentage
+- roofline%: achieved throughput as a percentage of the roofline, i.e., util as a percentage
+- <counter>: hardware counters, e.g., dram__bytes.sum, lts__t_sector_hit_rate.pct
+  Counters other than sums are averaged over the kernel invocations.
 """,
     )
     argparser.add_argument(
@@ -215,8 +358,20 @@ There are two modes:
         help="The depth of the tree to display",
     )
 
+    argparser.add_argument(
+        "-r",
+        "--ranks",
+        action="store_true",
+        help="""Compare the first metric across the profiles of the ranks of a job, e.g., prof.rank0.hatchet
+prof.rank1.hatchet ... Frames are matched by their call paths, and the ones whose slowest rank is the furthest from
+the mean are listed first.""",
+    )
+
     args, target_args = argparser.parse_known_args()
-    assert len(target_args) == 1, "Must specify a file to read"
+    if args.ranks:
+        assert len(target_args) > 0, "Must specify the files of the ranks to read"
+    else:
+        assert len(target_args) == 1, "Must specify a file to read"
 
     file_name = target_args[0]
     metrics = args.metrics.split(",") if args.metrics else None
@@ -228,6 +383,8 @@ There are two modes:
         raise ValueError("Cannot specify both include and exclude")
     if args.list:
         show_metrics(file_name)
+    elif args.ranks:
+        parse_ranks(metrics or ["time/ns"], target_args, threshold, depth)
     elif metrics:
         parse(metrics, file_name, include, exclude, threshold, depth)
 
@@ -0,0 +1,41 @@
+import pytest
+import torch
+import triton
+import triton.profiler as proton
+import triton.language as tl
+
+
+def test_do_bench():
+
+    @triton.jit
+    def foo(x, y, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(y + offs, tl.load(x + offs))
+
+    x = torch.ones(1024, device="cuda")
+    y = torch.zeros_like(x)
+
+    def fn():
+        # Two kernels per iteration, whose durations are summed
+        foo[(1, )](x, y, BLOCK=1024)
+        foo[(1, )](y, x, BLOCK=1024)
+
+    result = proton.bench.do_bench(fn, warmup=5, rep=20)
+    assert len(result.times) + result.num_rejected > 1
+    assert all(t > 0 for t in result.times)
+    assert result.ci[0] <= result.mean <= result.ci[1]
+    # Kernels this small take microseconds, far less than the iteration with the L2 flush
+    assert result.median < 0.1
+    assert not proton.flags.get_profiling_on()
+
+
+def test_reject_outliers():
+    times = [1.0, 1.1, 0.9, 1.0, 1.05, 0.95, 10.0]
+    assert proton.bench.reject_outliers(times) == times[:-1]
+    assert proton.bench.reject_outliers([1.0] * 4) == [1.0] * 4
+
+
+def test_confidence_interval():
+    low, high = proton.bench.confidence_interval([1.0, 2.0, 3.0], confidence=0.95)
+    assert low < 2.0 < high
+    assert high - 2.0 == pytest.approx(1.96 / 3**0.5, rel=1e-3)
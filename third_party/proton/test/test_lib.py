@@ -1,6 +1,7 @@
 import triton._C.libproton.proton as libproton
 import tempfile
 import pathlib
+import threading
 from triton.profiler.profile import _select_backend
 
 
@@ -44,3 +45,27 @@ def test_add_metrics():
         libproton.exit_scope(id1, "one")
         libproton.finalize_all("hatchet")
         assert pathlib.Path(f.name).exists()
+
+
+def test_scope_threads():
+    # Scopes are entered concurrently while the session is toggled
+    def annotate():
+        for _ in range(1000):
+            scope_id = libproton.record_scope()
+            libproton.enter_scope(scope_id, "thread")
+            libproton.enter_op(scope_id, "thread")
+            libproton.exit_op(scope_id, "thread")
+            libproton.exit_scope(scope_id, "thread")
+
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        session_id = libproton.start(f.name.split(".")[0], "shadow", "tree", _select_backend())
+        threads = [threading.Thread(target=annotate) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for _ in range(10):
+            libproton.deactivate(session_id)
+            libproton.activate(session_id)
+        for thread in threads:
+            thread.join()
+        libproton.finalize(session_id, "hatchet")
+        assert pathlib.Path(f.name).exists()
@@ -2,6 +2,7 @@ import torch
 import triton
 import triton.profiler as proton
 import tempfile
+import threading
 import json
 import pytest
 from typing import NamedTuple
@@ -37,6 +38,35 @@ def test_torch(context):
             assert "elementwise_kernel" in prev_frame[0]["frame"]["name"]
 
 
+def test_python_context_cache():
+
+    def launch():
+        return torch.ones((2, 2), device="cuda")
+
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], context="python")
+        for _ in range(3):
+            launch()
+            launch()
+        proton.finalize()
+        data = json.load(f)
+
+    # Both call sites of launch are distinct frames, however often the stack goes back to them
+    def find_frames(frame, path):
+        path = path + [frame["frame"]["name"]]
+        if not frame["children"]:
+            yield path, frame["metrics"]["Count"]
+        for child in frame["children"]:
+            yield from find_frames(child, path)
+
+    call_sites = {}
+    for path, count in find_frames(data[0], []):
+        caller = next(name for name in path if "test_python_context_cache@" in name)
+        call_sites[caller] = call_sites.get(caller, 0) + count
+    assert len(call_sites) == 2
+    assert all(count == 3 for count in call_sites.values())
+
+
 def test_triton():
 
     @triton.jit
@@ -61,6 +91,253 @@ def test_triton():
         assert data[0]["children"][1]["frame"]["name"] == "test2"
 
 
+def test_trace():
+
+    @triton.jit
+    def foo(x, y):
+        tl.store(y, tl.load(x))
+
+    x = torch.tensor([2], device="cuda")
+    y = torch.zeros_like(x)
+    # More launches than a single chunk holds, so the trace is written in pieces
+    num_launches = 5000
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".chrome_trace") as f:
+        proton.start(f.name.split(".")[0], data="trace")
+        with proton.scope("test0"):
+            for _ in range(num_launches):
+                foo[(1, )](x, y)
+        torch.ones((2, 2), device="cuda")
+        proton.finalize()
+        events = json.load(f)
+        kernels = [event for event in events if event["ph"] == "X"]
+        assert len(kernels) == num_launches + 1
+        assert all(kernel["dur"] > 0 for kernel in kernels)
+        assert sum(kernel["args"]["call_stack"].startswith("test0") for kernel in kernels) == num_launches
+        assert sum("elementwise_kernel" in kernel["name"] for kernel in kernels) == 1
+        metadata = {event["name"] for event in events if event["ph"] == "M"}
+        assert metadata == {"process_name", "thread_name"}
+
+
+def test_trace_api_launches():
+    # The scope of a launch is dropped after its kernel, which must not detach
+    # the kernels of later launches from their call stacks
+    num_launches = 100
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".chrome_trace") as f:
+        proton.start(f.name.split(".")[0], data="trace")
+        with proton.scope("test0"):
+            for _ in range(num_launches):
+                torch.ones((2, 2), device="cuda")
+        proton.finalize()
+        events = json.load(f)
+        kernels = [event for event in events if event["ph"] == "X"]
+        assert len(kernels) == num_launches
+        assert all(kernel["args"]["call_stack"].startswith("test0/") for kernel in kernels)
+        assert all("elementwise_kernel" in kernel["name"] for kernel in kernels)
+
+
+def test_counters():
+    if is_hip():
+        pytest.skip("HIP backend does not support hardware counters")
+
+    @triton.jit
+    def foo(x, y):
+        tl.store(y, tl.load(x))
+
+    x = torch.tensor([2], device="cuda")
+    y = torch.zeros_like(x)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], counters=["dram__bytes.sum"], counter_kernels="foo")
+        with proton.scope("test0"):
+            foo[(1, )](x, y)
+        # Not matched by the kernel filter
+        torch.ones((2, 2), device="cuda")
+        proton.finalize()
+        data = json.load(f)
+        children = data[0]["children"]
+        assert len(children) == 2
+        profiled = [child for child in children if child["frame"]["name"] == "test0"][0]
+        assert "dram__bytes.sum" in profiled["metrics"]
+        assert profiled["metrics"]["Count"] == 1
+        unprofiled = [child for child in children if child["frame"]["name"] != "test0"][0]
+        assert "dram__bytes.sum" not in unprofiled["metrics"]
+
+
+def test_pc_sampling():
+    if is_hip():
+        pytest.skip("HIP backend does not support pc sampling")
+
+    @triton.jit
+    def foo(x, y, N: tl.constexpr):
+        offs = tl.arange(0, N)
+        tl.store(y + offs, tl.exp(tl.load(x + offs)))
+
+    x = torch.randn(1024, device="cuda")
+    y = torch.zeros_like(x)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], pc_sampling=True, counter_kernels="foo")
+        with proton.scope("test0"):
+            foo[(1, )](x, y, N=1024)
+        proton.finalize()
+        data = json.load(f)
+        profiled = [child for child in data[0]["children"] if child["frame"]["name"] == "test0"][0]
+
+        def lines(node):
+            found = [node] if "test_profile.py:" in node["frame"]["name"] else []
+            for child in node["children"]:
+                found += lines(child)
+            return found
+
+        sampled = lines(profiled)
+        assert len(sampled) > 0
+        assert all("pc_samples" in line["metrics"] for line in sampled)
+        assert proton.get_dropped_samples() == 0
+
+
+def test_pc_sampling_with_counters():
+    if is_hip():
+        pytest.skip("HIP backend does not support pc sampling")
+
+    with pytest.raises(ValueError):
+        proton.start("test", pc_sampling=True, counters=["dram__bytes.sum"])
+
+
+def test_memory():
+    torch.cuda.empty_cache()
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], memory=True)
+        with proton.scope("test0"):
+            x = torch.empty(64 * 1024 * 1024, dtype=torch.uint8, device="cuda")
+        del x
+        torch.cuda.empty_cache()
+        proton.finalize()
+        data = json.load(f)
+
+        def metrics(node, name):
+            return node["metrics"].get(name, 0) + sum(metrics(child, name) for child in node["children"])
+
+        profiled = [child for child in data[0]["children"] if child["frame"]["name"] == "test0"][0]
+        assert metrics(profiled, "Allocated Memory (bytes)") >= 64 * 1024 * 1024
+        assert metrics(profiled, "Allocations") >= 1
+        assert metrics(data[0], "Freed Memory (bytes)") >= 64 * 1024 * 1024
+
+
+def test_threads():
+
+    @triton.jit
+    def foo(x, y):
+        tl.store(y, tl.load(x))
+
+    x = torch.tensor([2], device="cuda")
+    y = torch.zeros_like(x)
+    foo[(1, )](x, y)
+    # Both threads are inside their scopes at the same time
+    barrier = threading.Barrier(2)
+
+    def launch(i):
+        with proton.scope(f"thread{i}"):
+            barrier.wait()
+            for _ in range(10):
+                foo[(1, )](x, y)
+            barrier.wait()
+
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0])
+        threads = [threading.Thread(target=launch, args=(i, )) for i in range(2)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        proton.finalize()
+        data = json.load(f)
+        children = {child["frame"]["name"]: child for child in data[0]["children"]}
+        for i in range(2):
+            scope = children[f"thread{i}"]
+            assert [child["frame"]["name"] for child in scope["children"]] == ["foo"]
+            assert scope["children"][0]["metrics"]["Count"] == 10
+
+
+def test_sampling():
+
+    @triton.jit
+    def foo(x, y):
+        tl.store(y, tl.load(x))
+
+    x = torch.tensor([2], device="cuda")
+    y = torch.zeros_like(x)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], sampling_interval=10)
+        with proton.scope("test0"):
+            for _ in range(100):
+                foo[(1, )](x, y)
+        proton.finalize()
+        data = json.load(f)
+        test_frame = data[0]["children"][0]
+        assert test_frame["frame"]["name"] == "test0"
+        # Ten launches are profiled and each stands for ten
+        assert test_frame["metrics"]["Count"] == 100
+        assert test_frame["metrics"]["Time (ns)"] > 0
+
+
+def test_flush_msgpack():
+    pytest.importorskip("msgpack")
+    from triton.profiler.viewer import get_raw_metrics
+
+    @triton.jit
+    def foo(x, y):
+        tl.store(y, tl.load(x))
+
+    x = torch.tensor([2], device="cuda")
+    y = torch.zeros_like(x)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet_msgpack") as f:
+        proton.start(f.name.split(".")[0])
+        with proton.scope("test0"):
+            foo[(1, )](x, y)
+        proton.flush(output_format="hatchet_msgpack")
+        with proton.scope("test1"):
+            foo[(1, )](x, y)
+        with proton.scope("test0"):
+            foo[(1, )](x, y)
+        proton.finalize(output_format="hatchet_msgpack")
+        gf, _, _ = get_raw_metrics(f)
+        df = gf.dataframe.set_index("name")
+        assert df.loc["test0", "Count"] == 2
+        assert df.loc["test1", "Count"] == 1
+
+
+def test_intra_kernel():
+    import triton.profiler.language as pl
+
+    @triton.jit
+    def foo(x, y, buffer, N: tl.constexpr):
+        pl.enter_scope(buffer, "mainloop")
+        acc = 0.0
+        for i in range(N):
+            acc += tl.load(x + i)
+        pl.exit_scope(buffer, "mainloop")
+        pl.enter_scope(buffer, "epilogue")
+        tl.store(y + tl.program_id(0), acc)
+        pl.exit_scope(buffer, "epilogue")
+
+    num_ctas = 4
+    x = torch.ones(16, device="cuda")
+    y = torch.zeros(num_ctas, device="cuda")
+    buffer = pl.alloc_buffer(num_ctas)
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0])
+        foo[(num_ctas, )](x, y, buffer, 16)
+        pl.add_metrics(buffer, "foo")
+        proton.finalize()
+        data = json.load(f)
+        kernel_frame = data[0]["children"][0]
+        assert kernel_frame["frame"]["name"] == "foo"
+        assert kernel_frame["metrics"]["Count"] == 1
+        scopes = {child["frame"]["name"]: child["metrics"] for child in kernel_frame["children"]}
+        assert set(scopes) == {"mainloop", "epilogue"}
+        for metrics in scopes.values():
+            assert metrics["cta_count"] == num_ctas
+        assert torch.all(buffer[1:] == 0)
+
+
 def test_cudagraph():
     if is_hip():
         pytest.skip("HIP backend does not support profiling CUDA graphs")
@@ -113,6 +390,87 @@ def test_cudagraph():
         assert test_frame["children"][0]["metrics"]["Time (ns)"] > 0
 
 
+def test_cudagraph_capture_scope():
+    if is_hip():
+        pytest.skip("HIP backend does not support profiling CUDA graphs")
+
+    stream = torch.cuda.Stream()
+    torch.cuda.set_stream(stream)
+
+    @triton.jit
+    def foo(x):
+        tl.store(x, tl.load(x) + 1)
+
+    x = torch.zeros((1, ), device="cuda")
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], context="shadow")
+        g = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(g):
+            with proton.scope("capture0"):
+                foo[(1, )](x)
+            with proton.scope("capture1"):
+                x.add_(1)
+        with proton.scope("replay"):
+            for _ in range(10):
+                g.replay()
+            torch.cuda.synchronize()
+        proton.finalize()
+        data = json.load(f)
+        replay_frame = next(child for child in data[0]["children"] if child["frame"]["name"] == "replay")
+        # Each kernel is attributed to the scope it was captured in
+        capture_frames = {child["frame"]["name"]: child for child in replay_frame["children"]}
+        assert "capture0" in capture_frames and "capture1" in capture_frames
+        foo_frame = capture_frames["capture0"]["children"][0]
+        assert foo_frame["frame"]["name"] == "foo"
+        assert foo_frame["metrics"]["Count"] == 10
+        assert capture_frames["capture1"]["children"][0]["metrics"]["Count"] == 10
+
+
+def test_buffer_options():
+    x = torch.zeros((16, ), device="cuda")
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        # A small buffer fills up after a few records, so buffers are reused
+        proton.start(f.name.split(".")[0], buffer_size=64 * 1024, buffer_count=2, huge_pages=True)
+        with proton.scope("test"):
+            for _ in range(1000):
+                x.add_(1)
+        proton.finalize()
+        assert proton.get_dropped_records() == 0
+        data = json.load(f)
+        test_frame = next(child for child in data[0]["children"] if child["frame"]["name"] == "test")
+        assert test_frame["children"][0]["metrics"]["Count"] == 1000
+
+
+def test_cudagraph_replay_count():
+    if is_hip():
+        pytest.skip("HIP backend does not support profiling CUDA graphs")
+
+    stream = torch.cuda.Stream()
+    torch.cuda.set_stream(stream)
+
+    x = torch.zeros((16, ), device="cuda")
+    num_kernels, num_replays = 100, 100
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], context="shadow")
+        g = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(g):
+            for _ in range(num_kernels):
+                x.add_(1)
+        with proton.scope("test"):
+            for _ in range(num_replays):
+                g.replay()
+            torch.cuda.synchronize()
+        proton.finalize()
+        data = json.load(f)
+        test_frame = next(child for child in data[0]["children"] if child["frame"]["name"] == "test")
+
+        def count(frame):
+            return frame["metrics"].get("Count", 0) + sum(count(child) for child in frame["children"])
+
+        # Every kernel record has to make it to the tree
+        assert count(test_frame) == num_kernels * num_replays
+
+
 def test_metrics():
 
     @triton.jit
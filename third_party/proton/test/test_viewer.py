@@ -1,5 +1,8 @@
 import subprocess
-from triton.profiler.viewer import get_min_time_flops, get_min_time_bytes, get_raw_metrics
+import pytest
+from triton.profiler.viewer import (derive_metrics, get_min_time_flops, get_min_time_bytes, get_raw_metrics,
+                                   get_rank_table, update_peak_columns)
+import json
 import numpy as np
 
 file_path = __file__
@@ -53,3 +56,94 @@ def test_min_time_bytes():
         np.testing.assert_allclose(ret[device0_idx].to_numpy(), [[6.10351e-06]], atol=1e-6)
         # MI300
         np.testing.assert_allclose(ret[device1_idx].to_numpy(), [[1.93378e-05]], atol=1e-6)
+
+
+def test_recorded_peaks(tmp_path):
+    with open(cuda_example_file, "r") as f:
+        database = json.load(f)
+    # The peaks recorded by proton take precedence over the architecture table
+    database[1]["CUDA"]["0"].update({"peak_flops": 1e15, "peak_bandwidth": 1e12})
+    file_name = tmp_path / "test.hatchet"
+    with open(file_name, "w") as f:
+        json.dump(database, f)
+    with open(file_name, "r") as f:
+        gf, _, device_info = get_raw_metrics(f)
+        device0_idx = gf.dataframe["DeviceId"] == "0"
+        ret = get_min_time_flops(gf.dataframe, device_info)
+        np.testing.assert_allclose(ret[device0_idx].to_numpy(), [[1e-5]])
+        ret = get_min_time_bytes(gf.dataframe, device_info)
+        np.testing.assert_allclose(ret[device0_idx].to_numpy(), [[1e-5]])
+
+
+def test_roofline():
+    with open(cuda_example_file, "r") as f:
+        gf, raw_metrics, device_info = get_raw_metrics(f)
+        gf.update_inclusive_columns()
+        metrics = derive_metrics(gf, ["flop/s%", "byte/s%", "roofline%", "util"], raw_metrics, device_info)
+        assert metrics == ["flop/s% (inc)", "byte/s% (inc)", "roofline% (inc)", "util (inc)"]
+        df = gf.dataframe[gf.dataframe["DeviceId"].notna()]
+        np.testing.assert_allclose(df["roofline% (inc)"], df["util (inc)"] * 100)
+        np.testing.assert_allclose(df["roofline% (inc)"], np.maximum(df["flop/s% (inc)"], df["byte/s% (inc)"]))
+
+
+def test_peak_memory(tmp_path):
+    with open(cuda_example_file, "r") as f:
+        database = json.load(f)
+    for child, peak in zip(database[0]["children"], [100, 300]):
+        child["metrics"]["Peak Memory (bytes)"] = peak
+    database[0]["metrics"]["Peak Memory (bytes)"] = 0
+    file_name = tmp_path / "test.hatchet"
+    with open(file_name, "w") as f:
+        json.dump(database, f)
+    with open(file_name, "r") as f:
+        gf, _, _ = get_raw_metrics(f)
+        gf.update_inclusive_columns()
+        update_peak_columns(gf)
+        # The peak of a frame is the largest of its children's, not their sum
+        assert gf.dataframe["Peak Memory (bytes) (inc)"].max() == 300
+
+
+def test_msgpack(tmp_path):
+    msgpack = pytest.importorskip("msgpack")
+
+    def frame(ids, parent_ids, names, times, counts):
+        return msgpack.packb({
+            "ids": ids, "parent_ids": parent_ids, "names": names, "metrics": {
+                "Time (ns)": [ids[1:], times],
+                "Count": [ids[1:], counts],
+            }, "value_names": ["Count", "Time (ns)"], "devices": {}
+        })
+
+    file_name = tmp_path / "test.hatchet_msgpack"
+    with open(file_name, "wb") as f:
+        f.write(frame([0, 1], [0, 0], ["ROOT", "foo"], [10], [1]))
+        # Updates foo and adds bar under it
+        f.write(frame([0, 1, 2], [0, 0, 1], ["ROOT", "foo", "bar"], [30, 5], [2, 1]))
+    with open(file_name, "rb") as f:
+        gf, raw_metrics, device_info = get_raw_metrics(f)
+        assert device_info == {}
+        assert "Time (ns)" in raw_metrics
+        df = gf.dataframe.set_index("name")
+        assert df.loc["foo", "Time (ns)"] == 30
+        assert df.loc["foo", "Count"] == 2
+        assert df.loc["bar", "Time (ns)"] == 5
+
+
+def test_rank_table(tmp_path):
+    with open(cuda_example_file, "r") as f:
+        database = json.load(f)
+    file_names = []
+    for rank in range(2):
+        # foo0 is twice as slow on rank 1
+        database[0]["children"][0]["metrics"]["Time (ns)"] = 204800 * (rank + 1)
+        file_name = tmp_path / f"test.rank{rank}.hatchet"
+        with open(file_name, "w") as f:
+            json.dump(database, f)
+        file_names.append(str(file_name))
+    table = get_rank_table("time/ns", file_names)
+    assert list(table.columns[:2]) == ["rank0", "rank1"]
+    # foo1 is balanced
+    assert table.index[-1] == "ROOT/foo1"
+    assert table.loc["ROOT/foo0", "slowest"] == "rank1"
+    assert table.loc["ROOT/foo0", "max/mean"] == pytest.approx(2 / 1.5)
+    assert table.loc["ROOT/foo1", "max/mean"] == 1
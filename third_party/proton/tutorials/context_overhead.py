@@ -0,0 +1,51 @@
+"""
+Measures the host overhead that each context source adds to a kernel launch.
+
+Tiny kernels are launched from a few levels of Python calls, as in a decoding loop, without proton and with every
+context source. The overhead is the difference of the time per launch with the baseline.
+"""
+import argparse
+import tempfile
+import time
+
+import torch
+
+import triton.profiler as proton
+
+
+def launch(x, depth):
+    if depth == 0:
+        x.add_(1)
+    else:
+        launch(x, depth - 1)
+
+
+def time_per_launch(x, num_launches, depth):
+    torch.cuda.synchronize()
+    start = time.perf_counter()
+    for _ in range(num_launches):
+        launch(x, depth)
+    torch.cuda.synchronize()
+    return (time.perf_counter() - start) / num_launches
+
+
+def run(num_launches, depth):
+    x = torch.zeros((16, ), device="cuda")
+    # Warm up the allocator, the kernel, and CUPTI
+    time_per_launch(x, num_launches, depth)
+    baseline = time_per_launch(x, num_launches, depth)
+    print(f"{'none':>8}: {baseline * 1e6:.2f} us/launch")
+    for context in ["shadow", "python"]:
+        with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+            proton.start(f.name.split(".")[0], context=context)
+            elapsed = time_per_launch(x, num_launches, depth)
+            proton.finalize()
+        print(f"{context:>8}: {elapsed * 1e6:.2f} us/launch, overhead {(elapsed - baseline) * 1e6:.2f} us/launch")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--launches", type=int, default=100000, help="number of kernel launches")
+    parser.add_argument("--depth", type=int, default=16, help="number of Python calls above each launch")
+    args = parser.parse_args()
+    run(args.launches, args.depth)
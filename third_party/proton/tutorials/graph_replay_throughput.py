@@ -0,0 +1,47 @@
+"""
+Measures how many kernel records per second proton ingests while a CUDA graph
+of tiny kernels is replayed, and how many of them reach the profile.
+"""
+import argparse
+import json
+import tempfile
+import time
+
+import torch
+
+import triton.profiler as proton
+
+
+def count_kernels(frame):
+    return frame["metrics"].get("Count", 0) + sum(count_kernels(child) for child in frame["children"])
+
+
+def run(num_kernels, num_replays):
+    stream = torch.cuda.Stream()
+    torch.cuda.set_stream(stream)
+    x = torch.zeros((16, ), device="cuda")
+    g = torch.cuda.CUDAGraph()
+    with tempfile.NamedTemporaryFile(delete=True, suffix=".hatchet") as f:
+        proton.start(f.name.split(".")[0], context="shadow")
+        with torch.cuda.graph(g):
+            for _ in range(num_kernels):
+                x.add_(1)
+        start = time.perf_counter()
+        for _ in range(num_replays):
+            g.replay()
+        torch.cuda.synchronize()
+        proton.finalize()
+        elapsed = time.perf_counter() - start
+        data = json.load(f)
+    launched = num_kernels * num_replays
+    recorded = count_kernels(data[0])
+    print(f"{launched} kernels in {elapsed:.3f} s: {launched / elapsed:.0f} records/s, "
+          f"{recorded} recorded ({100 * recorded / launched:.1f}%)")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--kernels", type=int, default=1000, help="kernels per graph")
+    parser.add_argument("--replays", type=int, default=200, help="number of graph replays")
+    args = parser.parse_args()
+    run(args.kernels, args.replays)
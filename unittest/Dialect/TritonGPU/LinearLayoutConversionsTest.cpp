@@ -532,6 +532,25 @@ TEST_F(LinearLayoutConversionsTest, MFMA32_2x4Warps) {
                  {S("warp"), {{32, 0}, {0, 32}, {0, 64}}},
                  {S("block"), {}}},
                 {S("dim0"), S("dim1")}));
+  // The registers repeat the tile along N before M, as in the non-transposed
+  // layout.
+  EXPECT_EQ(toLinearLayout({128, 256}, mfmaT),
+            LinearLayout(
+                {{S("register"),
+                  {{0, 1}, {0, 2}, {0, 8}, {0, 16}, {0, 128}, {64, 0}}},
+                 {S("lane"), {{1, 0}, {2, 0}, {4, 0}, {8, 0}, {16, 0}, {0, 4}}},
+                 {S("warp"), {{32, 0}, {0, 32}, {0, 64}}},
+                 {S("block"), {}}},
+                {S("dim0"), S("dim1")}));
+}
+
+TEST_F(LinearLayoutConversionsTest, MFMA4_Unsupported) {
+  EXPECT_EQ(toLinearLayout({64, 64}, mfma(/*warps=*/{1, 1}, /*mDim=*/4,
+                                          /*nDim=*/4, /*isTransposed=*/false)),
+            std::nullopt);
+  EXPECT_EQ(toLinearLayout({64, 64}, mfma(/*warps=*/{1, 1}, /*mDim=*/64,
+                                          /*nDim=*/4, /*isTransposed=*/false)),
+            std::nullopt);
 }
 
 TEST_F(LinearLayoutConversionsTest, MFMA16_2x4Warps) {
@@ -993,6 +1012,57 @@ TEST_F(LinearLayoutConversionsTest, Shared1DSwizzle) {
                 LinearLayout::identity1D(1, S("block"), S("dim0")));
 }
 
+TEST_F(LinearLayoutConversionsTest, CachedConversion) {
+  auto src = blocked({1, 4}, {4, 8}, {4, 1}, {1, 1}, {1, 1}, {1, 0}, {1, 0});
+  auto dst = blocked({4, 1}, {8, 4}, {1, 4}, {1, 1}, {1, 1}, {0, 1}, {1, 0});
+  auto conversion = toLinearLayoutConversion({64, 64}, src, dst);
+  ASSERT_TRUE(conversion.has_value());
+  EXPECT_EQ(*conversion, toLinearLayout({64, 64}, src)->invertAndCompose(
+                             *toLinearLayout({64, 64}, dst)));
+  // Repeated queries return the interned results.
+  EXPECT_EQ(toLinearLayoutConversion({64, 64}, src, dst), conversion);
+  EXPECT_EQ(toLinearLayout({64, 64}, src), toLinearLayout({64, 64}, src));
+  EXPECT_NE(toLinearLayout({32, 64}, src), toLinearLayout({64, 64}, src));
+}
+
+TEST_F(LinearLayoutConversionsTest, ReshapeLayout) {
+  auto src = blocked({1}, {32}, {4}, {1}, {1}, {0}, {0});
+  auto dst = blocked({1, 1}, {1, 32}, {4, 1}, {1, 1}, {1, 1}, {1, 0}, {1, 0});
+  EXPECT_EQ(reshapeLayout(*toLinearLayout({128}, src), {4, 32}),
+            toLinearLayout({4, 32}, dst));
+  EXPECT_EQ(reshapeLayout(*toLinearLayout({4, 32}, dst), {128}),
+            toLinearLayout({128}, src));
+  EXPECT_EQ(reshapeLayout(*toLinearLayout({128}, src), {3, 32}), std::nullopt);
+}
+
+TEST_F(LinearLayoutConversionsTest, ToBlockedEncoding) {
+  auto layout =
+      blocked({2, 4}, {8, 4}, {2, 2}, {1, 1}, {1, 1}, {1, 0}, {0, 1});
+  EXPECT_EQ(toBlockedEncoding(*toLinearLayout({64, 64}, layout), {64, 64}),
+            layout);
+  // The tile of the encoding is larger than the shape, so the warps hold
+  // copies.  Any encoding with the same layout will do.
+  auto small = toBlockedEncoding(*toLinearLayout({16, 16}, layout), {16, 16});
+  ASSERT_TRUE(small.has_value());
+  EXPECT_EQ(toLinearLayout({16, 16}, *small), toLinearLayout({16, 16}, layout));
+}
+
+TEST_F(LinearLayoutConversionsTest, ToBlockedEncodingOfSlice) {
+  auto parent =
+      blocked({1, 1}, {32, 1}, {4, 1}, {1, 1}, {1, 1}, {0, 1}, {1, 0});
+  auto reshaped = reshapeLayout(*toLinearLayout({128}, slice(parent, 1)),
+                                {4, 32});
+  ASSERT_TRUE(reshaped.has_value());
+  EXPECT_EQ(toBlockedEncoding(*reshaped, {4, 32}),
+            blocked({1, 1}, {1, 32}, {4, 1}, {1, 1}, {1, 1}, {1, 0}, {0, 1}));
+}
+
+TEST_F(LinearLayoutConversionsTest, ToBlockedEncodingOfMma) {
+  auto layout = mma(2, 0, {16, 8}, {1, 1}, {1, 1}, {1, 1}, {1, 0});
+  EXPECT_EQ(toBlockedEncoding(*toLinearLayout({16, 16}, layout), {16, 16}),
+            std::nullopt);
+}
+
 } // anonymous namespace
 } // namespace mlir::triton::gpu
 
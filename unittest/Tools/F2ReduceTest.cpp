@@ -0,0 +1,126 @@
+#include "third_party/f2reduce/f2reduce.h"
+#include "triton/Tools/LinearLayout.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "llvm/Support/Signals.h"
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+
+namespace mlir::triton {
+namespace {
+
+// Reference Gaussian elimination, one uint64_t per row.
+int referenceRank(std::vector<uint64_t> m) {
+  int rank = 0;
+  for (int c = 0; c < 64; c++) {
+    auto pivot = std::find_if(m.begin() + rank, m.end(),
+                              [&](uint64_t row) { return (row >> c) & 1; });
+    if (pivot == m.end())
+      continue;
+    std::swap(*pivot, m[rank]);
+    for (int r = 0; r < static_cast<int>(m.size()); r++) {
+      if (r != rank && ((m[r] >> c) & 1))
+        m[r] ^= m[rank];
+    }
+    rank++;
+  }
+  return rank;
+}
+
+std::vector<uint64_t> randomMatrix(std::mt19937_64 &rng, int rows, int cols,
+                                   int rank) {
+  // Random combinations of `rank` random rows have at most that rank.
+  uint64_t colMask = cols == 64 ? ~uint64_t(0) : (uint64_t(1) << cols) - 1;
+  std::vector<uint64_t> basis(rank);
+  for (uint64_t &row : basis)
+    row = rng() & colMask;
+  std::vector<uint64_t> m(rows);
+  for (uint64_t &row : m) {
+    uint64_t coeffs = rng();
+    for (int i = 0; i < rank; i++) {
+      if ((coeffs >> i) & 1)
+        row ^= basis[i];
+    }
+  }
+  return m;
+}
+
+TEST(F2ReduceTest, SmallMatricesAreInRref) {
+  std::mt19937_64 rng(0);
+  for (int iter = 0; iter < 1000; iter++) {
+    int rows = 1 + rng() % 64;
+    int cols = 1 + rng() % 64;
+    std::vector<uint64_t> m = randomMatrix(rng, rows, cols, 1 + rng() % 64);
+    int rank = referenceRank(m);
+    f2reduce::inplace_rref_strided(m.data(), rows, cols, /*stride=*/1);
+    EXPECT_EQ(referenceRank(m), rank);
+    // The nonzero rows come first, with increasing pivots that are cleared in
+    // every other row.
+    for (int r = 0; r < rows; r++) {
+      if (r >= rank) {
+        EXPECT_EQ(m[r], uint64_t(0));
+        continue;
+      }
+      ASSERT_NE(m[r], uint64_t(0));
+      uint64_t pivot = m[r] & -m[r];
+      if (r > 0)
+        EXPECT_LT(m[r - 1] & -m[r - 1], pivot);
+      for (int s = 0; s < rows; s++) {
+        if (s != r)
+          EXPECT_EQ(m[s] & pivot, uint64_t(0));
+      }
+    }
+  }
+}
+
+// Throughput of the F2 work done by LinearLayout, to track the cost of layout
+// queries with many in-dims.  Run with --gtest_also_run_disabled_tests.
+TEST(F2ReduceTest, DISABLED_Benchmark) {
+  using Clock = std::chrono::steady_clock;
+  auto report = [](const char *name, Clock::time_point start, int iters) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  Clock::now() - start)
+                  .count();
+    std::cout << name << ": " << ns / iters << " ns/iter\n";
+  };
+
+  constexpr int kIters = 100000;
+  std::mt19937_64 rng(0);
+  std::vector<std::vector<uint64_t>> matrices;
+  for (int i = 0; i < 64; i++)
+    matrices.push_back(randomMatrix(rng, 64, 64, 48));
+  auto start = Clock::now();
+  for (int i = 0; i < kIters; i++) {
+    std::vector<uint64_t> m = matrices[i % matrices.size()];
+    f2reduce::inplace_rref_strided(m.data(), 64, 64, /*stride=*/1);
+  }
+  report("rref 64x64", start, kIters);
+
+  // A 2^14-element layout spread over register, lane and warp, and its
+  // transpose.
+  MLIRContext ctx;
+  auto S = [&](StringRef str) { return StringAttr::get(&ctx, str); };
+  LinearLayout src = LinearLayout::identity1D(16, S("register"), S("dim1")) *
+                     LinearLayout::identity1D(32, S("lane"), S("dim1")) *
+                     LinearLayout::identity1D(32, S("warp"), S("dim0"));
+  LinearLayout dst = LinearLayout::identity1D(16, S("register"), S("dim1")) *
+                     LinearLayout::identity1D(32, S("lane"), S("dim0")) *
+                     LinearLayout::identity1D(32, S("warp"), S("dim1"));
+  dst = dst.transposeOuts(llvm::to_vector(src.getOutDimNames()));
+  start = Clock::now();
+  for (int i = 0; i < kIters / 10; i++)
+    EXPECT_TRUE(src.invertAndCompose(dst).isSurjective());
+  report("invertAndCompose", start, kIters / 10);
+}
+
+} // anonymous namespace
+} // namespace mlir::triton
+
+int main(int argc, char *argv[]) {
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -628,6 +628,78 @@ TEST_F(LinearLayoutTest, DivideRight_Assertion) {
   EXPECT_EQ(l1.divideRight(l2), std::nullopt);
 }
 
+class SharedMemoryWavefrontsTest : public LinearLayoutTest {
+public:
+  // A 32x32 row-major tile.  Each row of 32 f32 elements spans all 32 banks.
+  LinearLayout unswizzled() {
+    return LinearLayout::identity1D(32, S("offset"), S("dim1")) *
+           LinearLayout::identity1D(32, S("offset"), S("dim0"));
+  }
+
+  // Same as unswizzled(), but the 16-byte chunks of row r are xor'ed with
+  // r % 8.
+  LinearLayout swizzled() {
+    return LinearLayout({{S("offset"),
+                          {{0, 1},
+                           {0, 2},
+                           {0, 4},
+                           {0, 8},
+                           {0, 16},
+                           {1, 4},
+                           {2, 8},
+                           {4, 16},
+                           {8, 0},
+                           {16, 0}}}},
+                        {S("dim0"), S("dim1")});
+  }
+
+  // Lane i reads row i, four registers at a time.
+  LinearLayout rowPerLane() {
+    return LinearLayout::identity1D(32, S("lane"), S("dim0")) *
+           LinearLayout::identity1D(32, S("register"), S("dim1"));
+  }
+
+  // Lane i reads column i, one register at a time.
+  LinearLayout columnPerLane() {
+    return LinearLayout::identity1D(32, S("lane"), S("dim1")) *
+           LinearLayout::identity1D(32, S("register"), S("dim0"));
+  }
+};
+
+TEST_F(SharedMemoryWavefrontsTest, ColumnPerLane) {
+  EXPECT_EQ(getNumSharedMemoryWavefronts(columnPerLane(), unswizzled(), 32),
+            32);
+  EXPECT_EQ(getNumSharedMemoryWavefronts(columnPerLane(), swizzled(), 32), 32);
+}
+
+TEST_F(SharedMemoryWavefrontsTest, RowPerLane) {
+  // 8 vectorized accesses, each split into 4 phases of 8 lanes that all hit
+  // the same 4 banks.
+  EXPECT_EQ(getNumSharedMemoryWavefronts(rowPerLane(), unswizzled(), 32),
+            8 * 4 * 8);
+  EXPECT_EQ(getNumSharedMemoryWavefronts(rowPerLane(), swizzled(), 32), 8 * 4);
+}
+
+TEST_F(SharedMemoryWavefrontsTest, Broadcast) {
+  // All lanes read the same element of column 0.
+  LinearLayout access = LinearLayout::zeros1D(32, S("lane"), S("dim1")) *
+                        LinearLayout::identity1D(32, S("register"), S("dim0"));
+  EXPECT_EQ(getNumSharedMemoryWavefronts(access, unswizzled(), 32), 32);
+}
+
+TEST_F(SharedMemoryWavefrontsTest, FindMinBankConflictLayout) {
+  EXPECT_EQ(
+      findMinBankConflictLayout({rowPerLane()}, {unswizzled(), swizzled()}, 32),
+      1);
+  EXPECT_EQ(findMinBankConflictLayout({columnPerLane(), rowPerLane()},
+                                      {unswizzled(), swizzled()}, 32),
+            1);
+  // Ties go to the first candidate.
+  EXPECT_EQ(findMinBankConflictLayout({columnPerLane()},
+                                      {swizzled(), unswizzled()}, 32),
+            0);
+}
+
 } // anonymous namespace
 } // namespace mlir::triton
 